@@ -0,0 +1,19 @@
+#!/usr/bin/env bash
+# runs the music_bench micro and macro benchmarks and keeps the results of
+# every commit in benchmark/results, the last run is compared with the
+# previous one (see utilities/compare_music_bench.py)
+
+export OMP_NUM_THREADS=16
+export OMP_PROC_BIND=true
+export OMP_PLACES=threads
+
+export MUSIC_BENCH_COMMIT=$(git rev-parse --short HEAD)
+mkdir -p benchmark/results
+previous=$(ls -t benchmark/results/*.json 2> /dev/null | head -n 1)
+result=benchmark/results/$(date +%Y-%m-%d_%H%M)_${MUSIC_BENCH_COMMIT}.json
+
+echo "doing music_bench for commit ${MUSIC_BENCH_COMMIT} ..."
+./music_bench ${result} "$@" > benchmark/music_bench.log
+if [ -n "${previous}" ]; then
+    ../utilities/compare_music_bench.py ${previous} ${result}
+fi
@@ -0,0 +1,20 @@
+#!/usr/bin/env bash
+# compares the collapsed (grid_traversal 0), the tiled (grid_traversal 1)
+# and the static row (grid_traversal 2) loop order of the hydro update on
+# the Gubser benchmarks
+
+export OMP_NUM_THREADS=16
+export OMP_PROC_BIND=true
+export OMP_PLACES=threads
+
+
+for size in small middle large; do
+    for traversal in 0 1 2; do
+        input=benchmark/music_input_Gubser_${size}_traversal${traversal}
+        sed "s/^EndOfData/grid_traversal ${traversal}\nEndOfData/" \
+            benchmark/music_input_Gubser_${size} > ${input}
+        echo "doing benchmark ${size} with grid_traversal ${traversal} ..."
+        time ./mpihydro ${input} > benchmark/${size}_traversal${traversal}.log
+        rm ${input}
+    done
+done
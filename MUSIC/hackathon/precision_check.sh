@@ -0,0 +1,19 @@
+#!/usr/bin/env bash
+# runs the same input with the double build (mpihydro) and the build with
+# float dissipative fields (mpihydro_float, compiled with
+# -DMUSIC_FLOAT_DISSIPATIVE) and compares their outputs
+# (see utilities/compare_music_precision.py)
+#
+# usage: ./precision_check.sh input_file [tolerance]
+
+input=$(realpath ${1:-benchmark/music_input_Gubser_small})
+tolerance=${2:-1e-3}
+
+for build in mpihydro mpihydro_float; do
+    mkdir -p precision_check/${build}
+    echo "running ${build} ..."
+    (cd precision_check/${build} && rm -f *.dat \
+     && ../../${build} ${input} > run.log)
+done
+../utilities/compare_music_precision.py precision_check/mpihydro \
+    precision_check/mpihydro_float ${tolerance}
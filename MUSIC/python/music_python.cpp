@@ -0,0 +1,275 @@
+// Python bindings of the MUSIC class with pybind11. The module "music"
+// runs MUSIC in the Python process: the fluid cells of every time step,
+// the in-memory freeze-out surface and the spectra of Cooper-Frye are
+// NumPy arrays viewing the memory of MUSIC, without copies or files.
+//
+// The module is built from this file and the MUSIC sources without
+// main.cpp, with -DGSL for Cooper-Frye, e.g.
+//     c++ -O3 -fopenmp -shared -fPIC -std=c++17 -DGSL \
+//         $(python3 -m pybind11 --includes) -I../src music_python.cpp \
+//         <the MUSIC objects> -lgsl -lgslcblas \
+//         -o music$(python3-config --extension-suffix)
+//
+//     import music
+//     hydro = music.MUSIC({"mode": 2, "freeze_surface_single_file": 1})
+//     hydro.initialize_hydro()
+//     def step(it, tau, grid):
+//         print(tau, grid.epsilon.max())
+//         return tau < 5.
+//     hydro.run_hydro(step)
+//     surface = hydro.get_freezeout_surface(0)
+//
+// The arrays are read-only and in the internal units of MUSIC (epsilon in
+// 1/fm^4, the dissipative fields in 1/fm^4). The grid arrays of a step are
+// indexed [ieta, iy, ix] and only valid during the step callback, copy
+// them to keep them.
+
+#include <pybind11/functional.h>
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "music.h"
+#ifdef GSL
+    #include "freeze.h"
+#endif
+
+namespace py = pybind11;
+
+namespace {
+
+//! a read-only NumPy view of memory owned by base
+template <class T>
+py::array make_view(const T *data, const std::vector<py::ssize_t> &shape,
+                    const std::vector<py::ssize_t> &strides, py::handle base) {
+    py::array view(py::dtype::of<T>(), shape, strides, data, base);
+    view.attr("setflags")(py::arg("write") = false);
+    return(view);
+}
+
+//! a capsule holding a reference to the shared object, the base of the
+//! views of its memory
+template <class T>
+py::capsule make_owner(std::shared_ptr<const T> object) {
+    auto *owner = new std::shared_ptr<const T>(std::move(object));
+    return(py::capsule(owner, [](void *p) {
+        delete static_cast<std::shared_ptr<const T>*>(p);
+    }));
+}
+
+//! the fluid cells of a time step, handed to the step callback. The views
+//! are strided over the Cell_small of the grid, the grid pointer is
+//! cleared when the callback returns.
+class GridView {
+ private:
+    const SCGrid *arena_;
+
+    const SCGrid &get_arena() const {
+        if (arena_ == nullptr) {
+            throw std::runtime_error(
+                    "the grid is only valid during the step callback");
+        }
+        return(*arena_);
+    }
+
+    //! the view of field of the first cell strided over the grid, with
+    //! n_components components as the last index
+    template <class T>
+    py::array get_field(const T &field, const int n_components,
+                        py::handle base) const {
+        const SCGrid &arena = get_arena();
+        const py::ssize_t cell_size = sizeof(Cell_small);
+        const py::ssize_t nx   = arena.nX();
+        const py::ssize_t ny   = arena.nY();
+        const py::ssize_t neta = arena.nEta();
+        std::vector<py::ssize_t> shape = {neta, ny, nx};
+        std::vector<py::ssize_t> strides = {nx*ny*cell_size, nx*cell_size,
+                                            cell_size};
+        if (n_components > 1) {
+            shape.push_back(n_components);
+            strides.push_back(sizeof(T));
+        }
+        return(make_view(&field, shape, strides, base));
+    }
+
+ public:
+    explicit GridView(const SCGrid &arena) : arena_(&arena) {}
+    void release() {arena_ = nullptr;}
+
+    const Cell_small &get_first_cell() const {return(get_arena()(0, 0, 0));}
+    int get_nx()   const {return(get_arena().nX());}
+    int get_ny()   const {return(get_arena().nY());}
+    int get_neta() const {return(get_arena().nEta());}
+
+    py::array get_epsilon(py::handle self) const {
+        return(get_field(get_first_cell().epsilon, 1, self));
+    }
+    py::array get_rhob(py::handle self) const {
+        return(get_field(get_first_cell().rhob, 1, self));
+    }
+    py::array get_u(py::handle self) const {
+        return(get_field(get_first_cell().u[0], 4, self));
+    }
+    py::array get_Wmunu(py::handle self) const {
+        const int n_components = get_first_cell().Wmunu.size();
+        return(get_field(get_first_cell().Wmunu[0], n_components, self));
+    }
+    py::array get_pi_b(py::handle self) const {
+        return(get_field(get_first_cell().pi_b, 1, self));
+    }
+};
+
+}  // namespace
+
+
+PYBIND11_MODULE(music, m) {
+    m.doc() = "MUSIC viscous hydrodynamics with NumPy views of its state";
+
+    py::class_<GridView>(m, "Grid",
+            "The fluid cells of a time step, indexed [ieta, iy, ix]. "
+            "Only valid during the step callback.")
+        .def_property_readonly("nx", &GridView::get_nx)
+        .def_property_readonly("ny", &GridView::get_ny)
+        .def_property_readonly("neta", &GridView::get_neta)
+        .def_property_readonly("epsilon", [](py::object self) {
+            return(self.cast<const GridView&>().get_epsilon(self));
+        }, "energy density [1/fm^4]")
+        .def_property_readonly("rhob", [](py::object self) {
+            return(self.cast<const GridView&>().get_rhob(self));
+        }, "net baryon density [1/fm^3]")
+        .def_property_readonly("u", [](py::object self) {
+            return(self.cast<const GridView&>().get_u(self));
+        }, "flow velocity u^mu, [..., mu]")
+        .def_property_readonly("Wmunu", [](py::object self) {
+            return(self.cast<const GridView&>().get_Wmunu(self));
+        }, "shear stress pi^{mu nu} and diffusion q^mu, [..., 14]")
+        .def_property_readonly("pi_b", [](py::object self) {
+            return(self.cast<const GridView&>().get_pi_b(self));
+        }, "bulk pressure [1/fm^4]");
+
+    py::class_<MUSIC>(m, "MUSIC")
+        .def(py::init<std::string>(), py::arg("input_file"))
+        .def(py::init([](const py::dict &parameters) {
+                ParameterRegistry registry;
+                for (const auto &item : parameters) {
+                    registry.set(py::str(item.first),
+                                 std::string(py::str(item.second)));
+                }
+                return(new MUSIC(registry));
+            }), py::arg("parameters"),
+            "sets up MUSIC from a dict of the input file parameters")
+        .def("initialize_hydro", &MUSIC::initialize_hydro,
+             py::call_guard<py::gil_scoped_release>())
+        .def("set_parameter", &MUSIC::set_parameter,
+             py::arg("name"), py::arg("value"))
+        .def("run_hydro", [](MUSIC &music, py::object step_callback) {
+                if (!step_callback.is_none()) {
+                    // the callback sees the cells of every step, which it
+                    // can stop by returning False
+                    music.set_step_callback(
+                        [step_callback](const int it, const double tau,
+                                        const SCGrid &arena) {
+                            py::gil_scoped_acquire gil;
+                            py::object grid = py::cast(
+                                        GridView(arena),
+                                        py::return_value_policy::move);
+                            py::object result;
+                            try {
+                                result = step_callback(it, tau, grid);
+                            } catch (...) {
+                                grid.cast<GridView&>().release();
+                                throw;
+                            }
+                            grid.cast<GridView&>().release();
+                            return(   result.is_none()
+                                   || static_cast<bool>(py::bool_(result)));
+                        });
+                } else {
+                    music.set_step_callback(EvolutionStepCallback());
+                }
+                py::gil_scoped_release no_gil;
+                return(music.run_hydro());
+            }, py::arg("step_callback") = py::none(),
+            "runs the hydro, calling step_callback(it, tau, grid) at every "
+            "time step; the evolution stops if it returns False")
+        .def("run_Cooper_Frye", &MUSIC::run_Cooper_Frye,
+             py::call_guard<py::gil_scoped_release>())
+        .def("get_freezeout_surface_field_names", [](const MUSIC &music) {
+                const auto surface = music.get_freezeout_surface();
+                if (surface == nullptr) return(std::string());
+                return(FreezeoutSurface::get_field_names(
+                                        surface->get_number_of_fields()));
+            })
+        .def("get_number_of_isotherms", [](const MUSIC &music) {
+                const auto surface = music.get_freezeout_surface();
+                return(surface == nullptr
+                       ? 0 : surface->get_number_of_isotherms());
+            })
+        .def("get_freezeout_surface", [](const MUSIC &music, const int isurf) {
+                const auto surface = music.get_freezeout_surface();
+                if (surface == nullptr) {
+                    throw std::runtime_error(
+                        "the surface is kept in memory only with "
+                        "freeze_surface_single_file = 1");
+                }
+                if (isurf < 0 || isurf >= surface->get_number_of_isotherms()) {
+                    throw py::index_error("no such isotherm");
+                }
+                const py::ssize_t n_fields = surface->get_number_of_fields();
+                const py::ssize_t n_elements = (
+                        surface->get_number_of_elements(isurf));
+                return(make_view(
+                        surface->get_elements(isurf).data(),
+                        {n_elements, n_fields},
+                        {n_fields*static_cast<py::ssize_t>(sizeof(float)),
+                         static_cast<py::ssize_t>(sizeof(float))},
+                        make_owner(surface)));
+            }, py::arg("isurf"),
+            "the surface elements of the isotherm isurf, one row of "
+            "get_freezeout_surface_field_names() per element")
+#ifdef GSL
+        .def("get_number_of_particles", [](const MUSIC &music) {
+                const auto cooper_frye = music.get_cooper_frye();
+                return(cooper_frye == nullptr
+                       ? 0 : cooper_frye->get_number_of_particles());
+            })
+        .def("get_particle", [](const MUSIC &music, const int j) {
+                const auto cooper_frye = music.get_cooper_frye();
+                if (   cooper_frye == nullptr || j < 0
+                    || j >= cooper_frye->get_number_of_particles()) {
+                    throw py::index_error("no such particle");
+                }
+                const Particle &particle = cooper_frye->get_particle(j);
+                const py::capsule owner = make_owner(cooper_frye);
+                const ParticleSpectrum &spectrum = particle.dNdydptdphi;
+                const py::ssize_t npt  = spectrum.get_npt();
+                const py::ssize_t nphi = spectrum.get_nphi();
+                const py::ssize_t ny   = (
+                    npt*nphi > 0 ? spectrum.size()/(npt*nphi) : 0);
+                const py::ssize_t entry = sizeof(double);
+                py::dict result;
+                result["number"]  = particle.number;
+                result["name"]    = std::string(particle.name);
+                result["mass"]    = particle.mass;
+                result["baryon"]  = particle.baryon;
+                result["charge"]  = particle.charge;
+                result["pt"] = make_view(particle.pt, {npt}, {entry}, owner);
+                result["y"]  = make_view(particle.y, {ny}, {entry}, owner);
+                result["phimin"] = particle.phimin;
+                result["phimax"] = particle.phimax;
+                result["dNdydptdphi"] = make_view(
+                        spectrum.data(), {ny, npt, nphi},
+                        {npt*nphi*entry, nphi*entry, entry}, owner);
+                return(result);
+            }, py::arg("j"),
+            "the species j of the particle table of the last "
+            "run_Cooper_Frye, with its spectrum dN/(dy pT dpT dphi) "
+            "[iy, ipt, iphi]")
+#endif
+        ;
+}
@@ -1,11 +1,19 @@
 // Copyright Chun Shen @ 2018
 
 #include "util.h"
+#include "float_codec.h"
 #include "HydroinfoMUSIC.h"
 
-HydroinfoMUSIC::HydroinfoMUSIC() {
+HydroinfoMUSIC::HydroinfoMUSIC() : memory_(MemorySubsystem::hydro_history) {
     hydroTauMax = 0.0;
     itaumax = 0;
+    ixmax = 0;
+    iymax = 0;
+    ietamax = 0;
+    T_cut_ = 0.;
+    n_memory_slices_ = 0;
+    first_resident_slice_ = 0;
+    n_out_of_range_queries_ = 0;
 }
 
 HydroinfoMUSIC::~HydroinfoMUSIC() {
@@ -13,7 +21,12 @@ HydroinfoMUSIC::~HydroinfoMUSIC() {
 }
 
 void HydroinfoMUSIC::clean_hydro_event() {
-    lattice_ideal.clear();
+    spill_.reset();
+    slices_.clear();
+    first_resident_slice_ = 0;
+    row_spans_.clear();
+    update_memory_use();
+    n_out_of_range_queries_ = 0;
     hydroTauMax = 0.;
     itaumax = 0;
 }
@@ -26,307 +39,298 @@ void HydroinfoMUSIC::getHydroValues(
 // For simplicity, hydro_eta_max refers to MUSIC's eta_size, and similarly for
 // hydroDeta; however, x, y, z, and t are as usual to stay compatible with
 // MARTINI.
-    double tau, eta;
-    if (use_tau_eta_coordinate == 1) {
-        if (t*t > z*z) {
-            tau = sqrt(t*t - z*z);
-            eta = 0.5*log((t + z)/(t - z));
-        } else {
-            tau = 0.;
-            eta = 0.;
-        }
-    } else {
-        // if the medium is given in cartesian coordinates
-        // set tau and eta to t and z
-        tau = t;
-        eta = z;
-    }
-
-    int ieta = static_cast<int>((hydro_eta_max + eta)/hydroDeta + 0.0001);
-    if (boost_invariant == 1) {
-        ieta = 0;
-    }
-
-    const int itau = static_cast<int>((tau - hydroTau0)/hydroDtau + 0.0001);
-    const int ix   = static_cast<int>((hydroXmax + x)/hydroDx + 0.0001);
-    const int iy   = static_cast<int>((hydroXmax + y)/hydroDx + 0.0001);
-
-    double xfrac = (x - (static_cast<double>(ix)*hydroDx - hydroXmax))/hydroDx;
-    double yfrac = (y - (static_cast<double>(iy)*hydroDx - hydroXmax))/hydroDx;
-    double etafrac = (eta/hydroDeta - static_cast<double>(ieta)
-                      + 0.5*static_cast<double>(ietamax));
-    double taufrac = (tau - hydroTau0)/hydroDtau - static_cast<double>(itau);
-
-    if (ix < 0 || ix >= ixmax) {
-        music_message << "[HydroinfoMUSIC::getHydroValues]: "
-                      << "WARNING - x out of range x=" << x
-                      << ", ix=" << ix << ", ixmax=" << ixmax;
-        music_message.flush("warning");
-        music_message << "x=" << x << " y=" << y << " eta=" << eta
-                      << " ix=" << ix << " iy=" << iy << " ieta=" << ieta;
-        music_message.flush("warning");
-        music_message << "t=" << t << " tau=" << tau
-                      << " itau=" << itau << " itaumax=" << itaumax;
-        music_message.flush("warning");
-        music_message.flush("warning");
-
-        info->temperature = 0.0;
-        info->ed = 0.0;
-        info->sd = 0.0;
-        info->pressure = 0.0;
-        info->vx = 0.0;
-        info->vy = 0.0;
-        info->vz = 0.0;
+    HydroLookup lookup;
+    const LookupStatus status = locate_hydro_cell(x, y, z, t, lookup);
+    if (status == kInside) {
+        interpolate_hydro_cell(lookup, info);
         return;
     }
 
-    if (iy < 0 || iy >= ixmax) {
-        music_message << "[HydroinfoMUSIC::getHydroValues]: "
-                      << "WARNING - y out of range, y=" << y << ", iy="  << iy
-                      << ", iymax=" << ixmax;
-        music_message.flush("warning");
-        music_message << "x=" << x << " y=" << y << " eta=" << eta
-                      << " ix=" << ix << " iy=" << iy << " ieta=" << ieta;
+    if (status == kXOutOfRange || status == kYOutOfRange) {
+        if (status == kXOutOfRange) {
+            music_message << "[HydroinfoMUSIC::getHydroValues]: "
+                          << "WARNING - x out of range x=" << x
+                          << ", ix=" << lookup.ix << ", ixmax=" << ixmax;
+        } else {
+            music_message << "[HydroinfoMUSIC::getHydroValues]: "
+                          << "WARNING - y out of range, y=" << y
+                          << ", iy="  << lookup.iy << ", iymax=" << iymax;
+        }
         music_message.flush("warning");
-        music_message << "t=" << t << " tau=" << tau
-                      << " itau=" << itau << " itaumax=" << itaumax;
+        music_message << "x=" << x << " y=" << y << " eta=" << lookup.eta
+                      << " ix=" << lookup.ix << " iy=" << lookup.iy
+                      << " ieta=" << lookup.ieta;
         music_message.flush("warning");
+        music_message << "t=" << t << " tau=" << lookup.tau
+                      << " itau=" << lookup.itau << " itaumax=" << itaumax;
         music_message.flush("warning");
-
-        info->temperature = 0.0;
-        info->ed = 0.0;
-        info->sd = 0.0;
-        info->pressure = 0.0;
-        info->vx = 0.0;
-        info->vy = 0.0;
-        info->vz = 0.0;
-        return;
-    }
-    if (itau < 0 || itau > itaumax) {
+    } else if (status == kTauOutOfRange) {
         music_message << "[HydroinfoMUSIC::getHydroValues]: WARNING - "
-                      << "tau out of range, itau=" << itau
+                      << "tau out of range, itau=" << lookup.itau
                       << ", itaumax=" << itaumax;
         music_message.flush("warning");
-        music_message << "[HydroinfoMUSIC::getHydroValues]: tau= " << tau
+        music_message << "[HydroinfoMUSIC::getHydroValues]: tau= "
+                      << lookup.tau
                       << ", hydroTau0 = " << hydroTau0
                       << ", hydroTauMax = " << hydroTauMax
                       << ", hydroDtau = " << hydroDtau;
         music_message.flush("warning");
+    } else {
+        music_message << "[HydroinfoMUSIC::getHydroValues]: WARNING - "
+                      << "eta out of range, ieta=" << lookup.ieta
+                      << ", ietamax=" << ietamax;
+        music_message.flush("warning");
+    }
+    set_vacuum(info);
+}
 
-        info->temperature = 0.0;
-        info->ed = 0.0;
-        info->sd = 0.0;
-        info->pressure = 0.0;
-        info->vx = 0.0;
-        info->vy = 0.0;
-        info->vz = 0.0;
-        return;
+
+void HydroinfoMUSIC::getHydroValues(
+        const int n_points, const double *x, const double *y,
+        const double *z, const double *t, fluidCell *info) {
+    std::vector<Point> points(n_points);
+    for (int i = 0; i < n_points; i++) {
+        points[i] = {x[i], y[i], z[i], t[i]};
     }
-    if (ieta < 0 || ieta >= ietamax) {
+    const size_t n_outside = getHydroValuesBatch(points.data(), n_points,
+                                                 info);
+    if (n_outside > 0) {
         music_message << "[HydroinfoMUSIC::getHydroValues]: WARNING - "
-                      << "eta out of range, ieta=" << ieta
-                      << ", ietamax=" << ietamax;
+                      << n_outside << " of " << n_points
+                      << " points are out of range and set to vacuum";
         music_message.flush("warning");
-        info->temperature = 0.0;
-        info->ed = 0.0;
-        info->sd = 0.0;
-        info->pressure = 0.0;
-        info->vx = 0.0;
-        info->vy = 0.0;
-        info->vz = 0.0;
-        return;
+    }
+}
+
+
+size_t HydroinfoMUSIC::getHydroValuesBatch(const Point *pts, const size_t n,
+                                           fluidCell *out) {
+    // group the queries by tau slice (a counting sort), so that the
+    // threads walk through the history one slice after the other
+    std::vector<int> tau_slice(n);
+    #pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < n; i++) {
+        tau_slice[i] = get_tau_slice(pts[i]);
+    }
+    std::vector<size_t> slice_start(itaumax + 2, 0);
+    for (size_t i = 0; i < n; i++) {
+        slice_start[tau_slice[i] + 1]++;
+    }
+    for (int itau = 0; itau <= itaumax; itau++) {
+        slice_start[itau + 1] += slice_start[itau];
+    }
+    std::vector<size_t> order(n);
+    for (size_t i = 0; i < n; i++) {
+        order[slice_start[tau_slice[i]]++] = i;
     }
 
-    // The array of positions on the 4-dimensional rectangle:
-    int position[2][2][2][2];
-    for (int ipx = 0; ipx < 2; ipx++) {
-        int px;
-        if (ipx == 0 || ix == ixmax-1) {
-            px = ix;
+    size_t n_outside = 0;
+    #pragma omp parallel for schedule(static) reduction(+:n_outside)
+    for (size_t k = 0; k < n; k++) {
+        const size_t i = order[k];
+        HydroLookup lookup;
+        if (locate_hydro_cell(pts[i].x, pts[i].y, pts[i].z, pts[i].t,
+                              lookup) == kInside) {
+            interpolate_hydro_cell(lookup, &out[i]);
         } else {
-            px = ix + 1;
+            set_vacuum(&out[i]);
+            n_outside++;
         }
-        for (int ipy = 0; ipy < 2; ipy++) {
-            int py;
-            if (ipy == 0 || iy == ixmax-1) {
-                py = iy;
-            } else {
-                py = iy + 1;
-            }
-            for (int ipeta = 0; ipeta < 2; ipeta++) {
-                int peta;
-                if (ipeta == 0 || ieta == ietamax-1) {
-                    peta = ieta;
-                } else {
-                    peta = ieta + 1;
-                }
-                for (int iptau = 0; iptau < 2; iptau++) {
-                    int ptau;
-                    if (iptau == 0 || itau == itaumax-1) {
-                        ptau = itau;
-                    } else {
-                        ptau = itau + 1;
-                    }
-                    position[ipx][ipy][ipeta][iptau] = (
-                                px + ixmax*(py + ixmax*(peta + ietamax*ptau)));
-                }
-            }
+    }
+    n_out_of_range_queries_ += n_outside;
+    return(n_outside);
+}
+
+
+int HydroinfoMUSIC::get_tau_slice(const Point &point) const {
+    double tau = point.t;
+    if (use_tau_eta_coordinate == 1) {
+        tau = 0.;
+        if (point.t*point.t > point.z*point.z) {
+            tau = sqrt(point.t*point.t - point.z*point.z);
+        }
+    }
+    const int itau = static_cast<int>((tau - hydroTau0)/hydroDtau + 0.0001);
+    if (itau < 0 || itau >= itaumax) return(itaumax);
+    return(itau);
+}
+
+
+HydroinfoMUSIC::LookupStatus HydroinfoMUSIC::locate_hydro_cell(
+        const double x, const double y, const double z, const double t,
+        HydroLookup &lookup) const {
+    double tau, eta;
+    lookup.cosh_eta = 1.;
+    lookup.sinh_eta = 0.;
+    if (t*t > z*z) {
+        // cosh(eta) = t/tau and sinh(eta) = z/tau
+        const double tau_local = sqrt(t*t - z*z);
+        lookup.cosh_eta = t/tau_local;
+        lookup.sinh_eta = z/tau_local;
+    }
+    if (use_tau_eta_coordinate == 1) {
+        if (t*t > z*z) {
+            tau = sqrt(t*t - z*z);
+            eta = 0.5*log((t + z)/(t - z));
+        } else {
+            tau = 0.;
+            eta = 0.;
         }
+    } else {
+        // if the medium is given in cartesian coordinates
+        // set tau and eta to t and z
+        tau = t;
+        eta = z;
     }
+    lookup.tau = tau;
+    lookup.eta = eta;
 
-    // And now, the interpolation:
-    double T = 0.0;
-    double ed = 0.0;
-    double sd = 0.0;
-    double pressure = 0.0;
-    double vx = 0.0;
-    double vy = 0.0;
-    double vz = 0.0;
-    double ux = 0.0;
-    double uy = 0.0;
-    double ueta = 0.0;
-    double pi00 = 0.0;
-    double pi01 = 0.0;
-    double pi02 = 0.0;
-    double pi03 = 0.0;
-    double pi11 = 0.0;
-    double pi12 = 0.0;
-    double pi13 = 0.0;
-    double pi22 = 0.0;
-    double pi23 = 0.0;
-    double pi33 = 0.0;
-    double bulkPi = 0.0;
-
-    fluidCell_ideal *HydroCell_ptr1, *HydroCell_ptr2;
+    int ieta = static_cast<int>((hydro_eta_max + eta)/hydroDeta + 0.0001);
+    if (boost_invariant) {
+        ieta = 0;
+    }
+    const int itau = static_cast<int>((tau - hydroTau0)/hydroDtau + 0.0001);
+    const int ix   = static_cast<int>((hydroXmax + x)/hydroDx + 0.0001);
+    const int iy   = static_cast<int>((hydroYmax + y)/hydroDy + 0.0001);
+    lookup.itau = itau;
+    lookup.ix   = ix;
+    lookup.iy   = iy;
+    lookup.ieta = ieta;
+
+    if (ix < 0 || ix >= ixmax) return(kXOutOfRange);
+    if (iy < 0 || iy >= iymax) return(kYOutOfRange);
+    if (itau < 0 || itau >= itaumax) return(kTauOutOfRange);
+    if (ieta < 0 || ieta >= ietamax) return(kEtaOutOfRange);
+
+    const double xfrac = (x + hydroXmax)/hydroDx - static_cast<double>(ix);
+    const double yfrac = (y + hydroYmax)/hydroDy - static_cast<double>(iy);
+    double etafrac = 0.;
+    if (!boost_invariant) {
+        etafrac = (eta + hydro_eta_max)/hydroDeta - static_cast<double>(ieta);
+    }
+    const double taufrac = ((tau - hydroTau0)/hydroDtau
+                            - static_cast<double>(itau));
+
+    // the corners of the 4-dimensional rectangle, ix innermost
+    const int px[2]   = {ix, ix == ixmax - 1 ? ix : ix + 1};
+    const int py[2]   = {iy, iy == iymax - 1 ? iy : iy + 1};
+    const int peta[2] = {ieta, ieta == ietamax - 1 ? ieta : ieta + 1};
+    lookup.ptau[0] = itau;
+    lookup.ptau[1] = itau == itaumax - 1 ? itau : itau + 1;
+    const double wx[2]   = {1. - xfrac, xfrac};
+    const double wy[2]   = {1. - yfrac, yfrac};
+    const double weta[2] = {1. - etafrac, etafrac};
+    const double wtau[2] = {1. - taufrac, taufrac};
+    int k = 0;
     for (int iptau = 0; iptau < 2; iptau++) {
-        double taufactor;
-        if (iptau == 0)
-            taufactor = 1. - taufrac;
-        else
-            taufactor = taufrac;
         for (int ipeta = 0; ipeta < 2; ipeta++) {
-            double etafactor;
-            if (ipeta == 0)
-                etafactor = 1. - etafrac;
-            else
-                etafactor = etafrac;
             for (int ipy = 0; ipy < 2; ipy++) {
-                double yfactor;
-                if (ipy == 0)
-                    yfactor = 1. - yfrac;
-                else
-                    yfactor = yfrac;
-
-                double prefrac = yfactor*etafactor*taufactor;
-
-                HydroCell_ptr1 = (
-                        &lattice_ideal[position[0][ipy][ipeta][iptau]]);
-                HydroCell_ptr2 = (
-                        &lattice_ideal[position[1][ipy][ipeta][iptau]]);
-                ed += prefrac*((1. - xfrac)*HydroCell_ptr1->ed
-                              + xfrac*HydroCell_ptr2->ed);
-                sd += prefrac*((1. - xfrac)*HydroCell_ptr1->sd
-                              + xfrac*HydroCell_ptr2->sd);
-                pressure += prefrac*((1. - xfrac)*HydroCell_ptr1->pressure
-                                     + xfrac*HydroCell_ptr2->pressure);
-                T += prefrac*((1. - xfrac)*HydroCell_ptr1->temperature
-                              + xfrac*HydroCell_ptr2->temperature);
-                ux += prefrac*((1. - xfrac)*HydroCell_ptr1->ux
-                                + xfrac*HydroCell_ptr2->ux);
-                uy += prefrac*((1. - xfrac)*HydroCell_ptr1->uy
-                                + xfrac*HydroCell_ptr2->uy);
-                ueta += prefrac*((1. - xfrac)*HydroCell_ptr1->ueta
-                                 + xfrac*HydroCell_ptr2->ueta);
+                for (int ipx = 0; ipx < 2; ipx++) {
+                    lookup.position[k] = get_cell_position(
+                        lookup.ptau[iptau], px[ipx], py[ipy], peta[ipeta]);
+                    lookup.weight[k] = (wtau[iptau]*weta[ipeta]
+                                        *wy[ipy]*wx[ipx]);
+                    k++;
+                }
             }
         }
     }
+    return(kInside);
+}
 
-    double eta_local = 0.5*log((t + z)/(t - z));
-    double sinh_eta, cosh_eta;
-    if (fabs(eta_local) < 1e-6) {
-        // use Taylor expansion for small eta_s to speed up
-        // avoiding to evaluate sinh and cosh
-        sinh_eta = eta_local;
-        cosh_eta = 1.0 + 0.5*eta_local*eta_local;
-    } else {
-        sinh_eta = sinh(eta_local);
-        cosh_eta = cosh(eta_local);
+
+void HydroinfoMUSIC::interpolate_hydro_cell(const HydroLookup &lookup,
+                                            fluidCell *info) const {
+    // all fields of a corner at once, the corners outside of the stored
+    // spans are vacuum
+    double values[kNumFields] = {0.};
+    for (int iptau = 0; iptau < 2; iptau++) {
+        HydroHistorySpill::SliceData paged;
+        const int itau = lookup.ptau[iptau];
+        const float *data = get_slice_data(itau, paged);
+        const int64_t n_stored = slices_[itau].n_stored;
+        for (int k = 8*iptau; k < 8*(iptau + 1); k++) {
+            const int64_t position = lookup.position[k];
+            if (position < 0) continue;
+            const double weight = lookup.weight[k];
+            for (int field = 0; field < kNumFields; field++) {
+                values[field] += weight*data[field*n_stored + position];
+            }
+        }
     }
-    double utau = sqrt(1. + ux*ux + uy*uy + ueta*ueta);
-    double uz = utau*sinh_eta + ueta*cosh_eta;
-    double ut = utau*cosh_eta + ueta*sinh_eta;
-    vx = ux/ut;
-    vy = uy/ut;
-    vz = uz/ut;
-
-    info->temperature = static_cast<float>(T);
-    info->vx = static_cast<float>(vx);
-    info->vy = static_cast<float>(vy);
-    info->vz = static_cast<float>(vz);
-
-    info->ed = static_cast<float>(ed);
-    info->sd = static_cast<float>(sd);
-    info->pressure = static_cast<float>(pressure);
-
-    info->pi[0][0] = static_cast<float>(pi00);
-    info->pi[0][1] = static_cast<float>(pi01);
-    info->pi[0][2] = static_cast<float>(pi02);
-    info->pi[0][3] = static_cast<float>(pi03);
-    info->pi[1][0] = static_cast<float>(pi01);
-    info->pi[1][1] = static_cast<float>(pi11);
-    info->pi[1][2] = static_cast<float>(pi12);
-    info->pi[1][3] = static_cast<float>(pi13);
-    info->pi[2][0] = static_cast<float>(pi02);
-    info->pi[2][1] = static_cast<float>(pi12);
-    info->pi[2][2] = static_cast<float>(pi22);
-    info->pi[2][3] = static_cast<float>(pi23);
-    info->pi[3][0] = static_cast<float>(pi03);
-    info->pi[3][1] = static_cast<float>(pi13);
-    info->pi[3][2] = static_cast<float>(pi23);
-    info->pi[3][3] = static_cast<float>(pi33);
-
-    info->bulkPi = static_cast<float>(bulkPi);
+    set_fluid_cell_values(values, lookup.cosh_eta, lookup.sinh_eta, info);
 }
 
 
-void HydroinfoMUSIC::get_fluid_cell_with_index(const int idx,
-                                               fluidCell *info) const {
-    info->temperature = static_cast<float>(lattice_ideal[idx].temperature);
-    
-    double ux   = lattice_ideal[idx].ux;
-    double uy   = lattice_ideal[idx].uy;
-    double ueta = lattice_ideal[idx].ueta;
-    double utau = sqrt(1. + ux*ux + uy*uy + ueta*ueta);
-    double sinh_eta = sinh(lattice_ideal[idx].eta);
-    double cosh_eta = cosh(lattice_ideal[idx].eta);
-    double uz = utau*sinh_eta + ueta*cosh_eta;
-    double ut = utau*cosh_eta + ueta*sinh_eta;
+void HydroinfoMUSIC::set_fluid_cell_values(
+        const double *values, const double cosh_eta, const double sinh_eta,
+        fluidCell *info) const {
+    const double ux   = values[kUx];
+    const double uy   = values[kUy];
+    const double ueta = values[kUeta];
+    const double utau = sqrt(1. + ux*ux + uy*uy + ueta*ueta);
+    const double uz = utau*sinh_eta + ueta*cosh_eta;
+    const double ut = utau*cosh_eta + ueta*sinh_eta;
+
+    info->temperature = static_cast<float>(values[kTemperature]);
     info->vx = static_cast<float>(ux/ut);
     info->vy = static_cast<float>(uy/ut);
     info->vz = static_cast<float>(uz/ut);
 
-    info->ed = static_cast<float>(lattice_ideal[idx].ed);
-    info->sd = static_cast<float>(lattice_ideal[idx].sd);
-    info->pressure = static_cast<float>(lattice_ideal[idx].pressure);
-
-    info->pi[0][0] = static_cast<float>(0.0);
-    info->pi[0][1] = static_cast<float>(0.0);
-    info->pi[0][2] = static_cast<float>(0.0);
-    info->pi[0][3] = static_cast<float>(0.0);
-    info->pi[1][0] = static_cast<float>(0.0);
-    info->pi[1][1] = static_cast<float>(0.0);
-    info->pi[1][2] = static_cast<float>(0.0);
-    info->pi[1][3] = static_cast<float>(0.0);
-    info->pi[2][0] = static_cast<float>(0.0);
-    info->pi[2][1] = static_cast<float>(0.0);
-    info->pi[2][2] = static_cast<float>(0.0);
-    info->pi[2][3] = static_cast<float>(0.0);
-    info->pi[3][0] = static_cast<float>(0.0);
-    info->pi[3][1] = static_cast<float>(0.0);
-    info->pi[3][2] = static_cast<float>(0.0);
-    info->pi[3][3] = static_cast<float>(0.0);
-
-    info->bulkPi = static_cast<float>(0.0);
+    info->ed = static_cast<float>(values[kEd]);
+    info->sd = static_cast<float>(values[kSd]);
+    info->pressure = static_cast<float>(values[kPressure]);
+
+    for (int mu = 0; mu < 4; mu++) {
+        for (int nu = 0; nu < 4; nu++) {
+            info->pi[mu][nu] = 0.f;
+        }
+    }
+    info->bulkPi = 0.f;
+}
+
+
+void HydroinfoMUSIC::set_vacuum(fluidCell *info) const {
+    info->temperature = 0.0;
+    info->ed = 0.0;
+    info->sd = 0.0;
+    info->pressure = 0.0;
+    info->vx = 0.0;
+    info->vy = 0.0;
+    info->vz = 0.0;
+}
+
+
+void HydroinfoMUSIC::get_fluid_cell_with_index(const int idx,
+                                               fluidCell *info) const {
+    const int ieta = idx % ietamax;
+    const int iy   = (idx/ietamax) % iymax;
+    const int ix   = (idx/(ietamax*iymax)) % ixmax;
+    const int itau = static_cast<int>(idx/get_number_of_cells_per_tau());
+    const int64_t position = get_cell_position(itau, ix, iy, ieta);
+    double values[kNumFields] = {0.};
+    if (position >= 0) {
+        HydroHistorySpill::SliceData paged;
+        const float *data = get_slice_data(itau, paged);
+        const int64_t n_stored = slices_[itau].n_stored;
+        for (int field = 0; field < kNumFields; field++) {
+            values[field] = data[field*n_stored + position];
+        }
+    }
+    double eta = 0.;
+    if (!boost_invariant) {
+        eta = ieta*hydroDeta - hydro_eta_max;
+    }
+    set_fluid_cell_values(values, cosh(eta), sinh(eta), info);
+}
+
+
+const float *HydroinfoMUSIC::get_slice_data(
+        const int itau, HydroHistorySpill::SliceData &paged) const {
+    const TauSlice &slice = slices_[itau];
+    if (!slice.spilled) return(slice.data.data());
+    paged = spill_->load(itau);
+    return(paged->data());
 }
 
 
@@ -335,17 +339,49 @@ void HydroinfoMUSIC::set_grid_infomatioin(const InitData &DATA) {
     boost_invariant = DATA.boost_invariant;
 
     hydroTau0 = DATA.tau0;
-    hydroDtau = DATA.delta_tau*DATA.output_evolution_every_N_timesteps;
+    hydroDtau = DATA.delta_tau_input*DATA.output_evolution_every_N_timesteps;
     hydroDx   = DATA.delta_x*DATA.output_evolution_every_N_x;
+    hydroDy   = DATA.delta_y*DATA.output_evolution_every_N_y;
     hydroDeta = DATA.delta_eta*DATA.output_evolution_every_N_eta;
 
     hydroXmax     = DATA.x_size/2.;
+    hydroYmax     = DATA.y_size/2.;
     hydro_eta_max = DATA.eta_size/2.;
 
     ixmax   = (static_cast<int>((DATA.nx - 1)
                                 /DATA.output_evolution_every_N_x) + 1);
+    iymax   = (static_cast<int>((DATA.ny - 1)
+                                /DATA.output_evolution_every_N_y) + 1);
     ietamax = (static_cast<int>((DATA.neta - 1)
                                 /DATA.output_evolution_every_N_eta) + 1);
+
+    // reserve the index of the history for all output steps of the
+    // evolution
+    T_cut_ = DATA.store_hydro_info_T_cut;
+    const int64_t n_tau = (static_cast<int64_t>(
+                    DATA.nt*DATA.delta_tau/hydroDtau + 1e-6) + 1);
+    slices_.reserve(n_tau);
+    if (T_cut_ > 0.) {
+        row_spans_.reserve(n_tau*iymax*ietamax);
+    }
+
+    n_memory_slices_ = DATA.store_hydro_info_memory_slices;
+    spill_.reset();
+    if (n_memory_slices_ > 0) {
+        spill_.reset(new HydroHistorySpill(
+                DATA.store_hydro_info_spill_directory,
+                DATA.store_hydro_info_cache_slices, FloatCodec::kZlib));
+    }
+    update_memory_use();
+}
+
+void HydroinfoMUSIC::update_memory_use() {
+    int64_t bytes = (row_spans_.capacity()*sizeof(RowSpan)
+                     + slices_.capacity()*sizeof(TauSlice));
+    for (const auto &slice : slices_) {
+        bytes += slice.data.capacity()*sizeof(float);
+    }
+    memory_.set(bytes);
 }
 
 void HydroinfoMUSIC::print_grid_information() {
@@ -357,27 +393,72 @@ void HydroinfoMUSIC::print_grid_information() {
     music_message << "hydro_Xmax = " << hydroXmax << " fm";
     music_message << "hydro_dx = " << hydroDx << " fm";
     music_message << "ixmax = " << ixmax;
+    music_message << "hydro_Ymax = " << hydroYmax << " fm";
+    music_message << "hydro_dy = " << hydroDy << " fm";
+    music_message << "iymax = " << iymax;
     music_message << "hydro_eta_max = " << hydro_eta_max;
     music_message << "hydro_deta = " << hydroDeta;
     music_message << "ietamax = " << ietamax;
     music_message.flush("info");
 }
 
-void HydroinfoMUSIC::dump_ideal_info_to_memory(double tau, float eta,
-        float epsilon, float pressure, float entropy, float T,
-        float ux, float uy, float ueta) {
-    if (tau > hydroTauMax) {
-        hydroTauMax = tau;
-        itaumax++;
+void HydroinfoMUSIC::dump_tau_slice_to_memory(
+        const double tau, const std::vector<float> &slice) {
+    hydroTauMax = tau;
+    itaumax++;
+    const int64_t n_cells = get_number_of_cells_per_tau();
+    TauSlice tau_slice;
+    tau_slice.spilled = false;
+    if (T_cut_ <= 0.) {
+        tau_slice.n_stored = n_cells;
+        tau_slice.data.assign(slice.begin(),
+                              slice.begin() + kNumFields*n_cells);
+    } else {
+        // store the span of every row from the first to the last cell
+        // above the temperature cut
+        const float *temperature = &slice[kTemperature*n_cells];
+        const size_t first_span = row_spans_.size();
+        int64_t n_stored = 0;
+        for (int64_t irow = 0; irow < n_cells/ixmax; irow++) {
+            const int64_t row_start = irow*ixmax;
+            int begin = 0;
+            while (begin < ixmax
+                   && temperature[row_start + begin] < T_cut_) {
+                begin++;
+            }
+            int end = ixmax;
+            while (end > begin
+                   && temperature[row_start + end - 1] < T_cut_) {
+                end--;
+            }
+            RowSpan span;
+            span.offset = n_stored;
+            span.begin  = begin;
+            span.end    = end;
+            row_spans_.push_back(span);
+            n_stored += end - begin;
+        }
+        tau_slice.n_stored = n_stored;
+        tau_slice.data.reserve(kNumFields*n_stored);
+        for (int field = 0; field < kNumFields; field++) {
+            for (int64_t irow = 0; irow < n_cells/ixmax; irow++) {
+                const RowSpan &span = row_spans_[first_span + irow];
+                const auto row = slice.begin() + field*n_cells + irow*ixmax;
+                tau_slice.data.insert(tau_slice.data.end(),
+                                      row + span.begin, row + span.end);
+            }
+        }
+    }
+    slices_.push_back(std::move(tau_slice));
+
+    // hand the oldest slices beyond the ones kept in memory to the spill
+    while (n_memory_slices_ > 0
+           && itaumax - first_resident_slice_ > n_memory_slices_) {
+        TauSlice &oldest = slices_[first_resident_slice_];
+        spill_->spill(first_resident_slice_, std::move(oldest.data));
+        oldest.data = std::vector<float>();
+        oldest.spilled = true;
+        first_resident_slice_++;
     }
-    fluidCell_ideal new_cell;
-    new_cell.eta = eta;
-    new_cell.temperature = T*Util::hbarc;
-    new_cell.ed = epsilon*Util::hbarc;
-    new_cell.sd = entropy;
-    new_cell.pressure = pressure*Util::hbarc;
-    new_cell.ux = ux;
-    new_cell.uy = uy;
-    new_cell.ueta = ueta;
-    lattice_ideal.push_back(new_cell);
+    update_memory_use();
 }
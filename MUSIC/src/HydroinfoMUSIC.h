@@ -3,33 +3,145 @@
 #ifndef SRC_HYDROINFOMUSIC_H_
 #define SRC_HYDROINFOMUSIC_H_
 
+#include <cstdint>
+#include <memory>
 #include <vector>
 #include <string>
 #include "data_struct.h"
 #include "data.h"
+#include "hydro_history_spill.h"
+#include "memory_accounting.h"
 #include "pretty_ostream.h"
 
+//! This class stores the hydro evolution history in memory and
+//! interpolates it for the couplings to jets (JETSCAPE). Every tau slice
+//! of the history is one contiguous float array holding the fields one
+//! after the other. With store_hydro_info_T_cut > 0, every row of a tau
+//! slice along x only stores the span from the first to the last cell
+//! above the cut, and a per-row index of the spans locates the cells.
+//! The cells outside of the spans read as vacuum.
+//!
+//! With store_hydro_info_memory_slices > 0, only the last slices stay in
+//! memory; the older ones are compressed and spilled to a scratch file by
+//! a HydroHistorySpill, and the queries page them back in through its LRU
+//! cache.
 class HydroinfoMUSIC {
+ public:
+    //! the fields of the history
+    enum HydroField {
+        kEd = 0,         //!< energy density [GeV/fm^3]
+        kPressure,       //!< pressure [GeV/fm^3]
+        kSd,             //!< entropy density [1/fm^3]
+        kTemperature,    //!< temperature [GeV]
+        kUx,             //!< u^x
+        kUy,             //!< u^y
+        kUeta,           //!< tau*u^eta
+        kNumFields
+    };
+
+    //! a query point of getHydroValuesBatch() in Cartesian coordinates
+    struct Point {
+        double x, y, z, t;
+    };
+
  private:
     double hydroTau0;       // tau_0 in the hydro data files
     double hydroTauMax;     // tau_max in the hydro data files
     double hydroDtau;       // step dtau in fm/c in the hydro data files
     double hydroXmax;       // maximum x in fm in the hydro data files
-                            // [-xmax, +xmax] for both x and y
+                            // [-xmax, +xmax]
+    double hydroYmax;       // maximum y in fm in the hydro data files
+                            // [-ymax, +ymax]
     double hydro_eta_max;   // maximum z in fm in the hydro data files
                             // [-zmax, +zmax] for 3D hydro
     double hydroDx;         // step dx in fm in the hydro data files
+    double hydroDy;         // step dy in fm in the hydro data files
     double hydroDeta;       // step dz in fm in the hydro data files in
                             // the z-direction for 3D hydro
 
     int use_tau_eta_coordinate;
     bool boost_invariant;
 
-    int itaumax, ixmax, ietamax;
+    int itaumax, ixmax, iymax, ietamax;
+
+    //! cells below this temperature [GeV] are not stored (0: store all)
+    double T_cut_;
+
+    //! the span of the stored cells in a row along x of a tau slice
+    struct RowSpan {
+        int64_t offset;     // position of the first stored cell in the slice
+        int32_t begin;      // first stored ix
+        int32_t end;        // last stored ix + 1
+    };
+    //! [itau][ieta][iy], only with T_cut_ > 0
+    std::vector<RowSpan> row_spans_;
+
+    //! the number of batched queries outside of the history
+    size_t n_out_of_range_queries_;
+
+    //! a tau slice of the history, [field][ieta][iy][ix] (the spans with
+    //! T_cut_ > 0)
+    struct TauSlice {
+        int64_t n_stored;           // the stored cells of every field
+        std::vector<float> data;    // empty once spilled
+        bool spilled;
+    };
+    std::vector<TauSlice> slices_;
+
+    //! the slices kept in memory (0: all) and the first of them
+    int n_memory_slices_;
+    int first_resident_slice_;
+    std::unique_ptr<HydroHistorySpill> spill_;
+    MemoryRegistration memory_;
 
-    std::vector<fluidCell_ideal> lattice_ideal;
     pretty_ostream music_message;
 
+    //! books the capacity of the history
+    void update_memory_use();
+
+    //! the cell and the weights of an interpolation
+    struct HydroLookup {
+        double tau, eta;
+        double cosh_eta, sinh_eta;
+        int itau, ix, iy, ieta;
+        int ptau[2];            // the tau slices of the corners 0-7, 8-15
+        int64_t position[16];   // the positions in the slices
+        double weight[16];
+    };
+    //! the result of locate_hydro_cell()
+    enum LookupStatus {
+        kInside = 0, kXOutOfRange, kYOutOfRange, kTauOutOfRange,
+        kEtaOutOfRange
+    };
+
+    //! returns the position of the cell in its tau slice, -1 if it is
+    //! not stored
+    int64_t get_cell_position(const int itau, const int ix, const int iy,
+                              const int ieta) const {
+        const int64_t irow_slice = iy + static_cast<int64_t>(iymax)*ieta;
+        if (T_cut_ <= 0.) return(ix + ixmax*irow_slice);
+        const RowSpan &row = row_spans_[
+            irow_slice + static_cast<int64_t>(iymax)*ietamax*itau];
+        if (ix < row.begin || ix >= row.end) return(-1);
+        return(row.offset + ix - row.begin);
+    }
+
+    //! returns the values of the tau slice; a spilled slice is paged in
+    //! and held by paged while the values are used
+    const float *get_slice_data(const int itau,
+                                HydroHistorySpill::SliceData &paged) const;
+
+    LookupStatus locate_hydro_cell(const double x, const double y,
+                                   const double z, const double t,
+                                   HydroLookup &lookup) const;
+    void interpolate_hydro_cell(const HydroLookup &lookup,
+                                fluidCell *info) const;
+    //! returns the tau slice of the query, itaumax if it is out of range
+    int get_tau_slice(const Point &point) const;
+    void set_fluid_cell_values(const double *values, const double cosh_eta,
+                               const double sinh_eta, fluidCell *info) const;
+    void set_vacuum(fluidCell *info) const;
+
  public:
     HydroinfoMUSIC();       // constructor
     ~HydroinfoMUSIC();      // destructor
@@ -44,21 +156,48 @@ class HydroinfoMUSIC {
     double get_hydro_x_max() const   {return(hydroXmax);}
     int get_ntau() const {return(itaumax);}
     int get_nx()   const {return(ixmax  );}
+    int get_ny()   const {return(iymax  );}
     int get_neta() const {return(ietamax);}
     bool is_boost_invariant() const {return(boost_invariant);}
 
     void getHydroValues(const double x, const double y,
                         const double z, const double t,
                         fluidCell *info);
+    //! interpolates the history at n_points points in parallel. The points
+    //! outside of the history are set to vacuum with a single warning.
+    void getHydroValues(const int n_points, const double *x, const double *y,
+                        const double *z, const double *t, fluidCell *info);
+    //! interpolates the history at the n points pts into out, in parallel
+    //! and grouped by tau slice. The points outside of the history are set
+    //! to vacuum without a warning, it returns their number.
+    size_t getHydroValuesBatch(const Point *pts, const size_t n,
+                               fluidCell *out);
+    //! returns the number of batched queries outside of the history since
+    //! the last clean_hydro_event()
+    size_t get_number_of_out_of_range_queries() const {
+        return(n_out_of_range_queries_);
+    }
     void set_grid_infomatioin(const InitData &DATA);
     void print_grid_information();
-    void dump_ideal_info_to_memory(double tau, float eta, float epsilon,
-                                   float pressure, float entropy, float T,
-                                   float ux, float uy, float ueta);
 
-    int get_number_of_fluid_cells() const {return(lattice_ideal.size());}
+    //! returns the number of cells of a tau slice, nx*ny*neta
+    int64_t get_number_of_cells_per_tau() const {
+        return(static_cast<int64_t>(ixmax)*iymax*ietamax);
+    }
+    //! appends the tau slice. slice holds the kNumFields fields of the
+    //! nx*ny*neta cells one after the other, each ordered
+    //! [ieta][iy][ix] with ix innermost.
+    void dump_tau_slice_to_memory(const double tau,
+                                  const std::vector<float> &slice);
+
+    //! the spill of the history, nullptr if all of it is in memory
+    const HydroHistorySpill *get_spill() const {return(spill_.get());}
+
+    //! the cells of the history in the order [itau][ix][iy][ieta]
+    int get_number_of_fluid_cells() const {
+        return(static_cast<int>(itaumax*get_number_of_cells_per_tau()));
+    }
     void get_fluid_cell_with_index(const int idx, fluidCell *info) const;
 };
 
 #endif  // SRC_HYDROINFO_MUSIC_H_
-
@@ -0,0 +1,240 @@
+#include "doctest.h"
+#include "HydroinfoMUSIC.h"
+#include <cmath>
+#include <vector>
+
+namespace {
+    InitData get_test_grid() {
+        InitData DATA;
+        DATA.boost_invariant = false;
+        DATA.tau0 = 0.5;
+        DATA.delta_tau = 0.1;
+        DATA.delta_tau_input = 0.1;
+        DATA.nt = 10;
+        DATA.nx = 9;
+        DATA.ny = 7;
+        DATA.neta = 5;
+        DATA.x_size = 4.;
+        DATA.y_size = 3.;
+        DATA.eta_size = 1.;
+        DATA.delta_x = 0.5;
+        DATA.delta_y = 0.5;
+        DATA.delta_eta = 0.25;
+        DATA.output_evolution_every_N_timesteps = 2;
+        DATA.output_evolution_every_N_x = 1;
+        DATA.output_evolution_every_N_y = 1;
+        DATA.output_evolution_every_N_eta = 1;
+        DATA.store_hydro_info_T_cut = 0.;
+        DATA.store_hydro_info_memory_slices = 0;
+        DATA.store_hydro_info_cache_slices = 4;
+        DATA.store_hydro_info_spill_directory = "/tmp";
+        return(DATA);
+    }
+
+    double get_test_temperature(const double tau, const double x,
+                                const double y, const double eta) {
+        return(0.1 + 0.01*x + 0.02*y + 0.03*eta + 0.04*tau);
+    }
+
+    //! fills the history with a temperature linear in tau, x, y, and eta
+    void fill_test_history(const InitData &DATA, HydroinfoMUSIC &hydro_info) {
+        hydro_info.set_grid_infomatioin(DATA);
+        const int n_cells = hydro_info.get_number_of_cells_per_tau();
+        for (int itau = 0; itau < 6; itau++) {
+            const double tau = DATA.tau0 + itau*hydro_info.get_hydro_dtau();
+            std::vector<float> slice(HydroinfoMUSIC::kNumFields*n_cells, 0.f);
+            for (int ieta = 0; ieta < DATA.neta; ieta++) {
+                for (int iy = 0; iy < DATA.ny; iy++) {
+                    for (int ix = 0; ix < DATA.nx; ix++) {
+                        const int i = ix + DATA.nx*(iy + DATA.ny*ieta);
+                        const double T = get_test_temperature(
+                            tau, ix*DATA.delta_x - DATA.x_size/2.,
+                            iy*DATA.delta_y - DATA.y_size/2.,
+                            ieta*DATA.delta_eta - DATA.eta_size/2.);
+                        slice[HydroinfoMUSIC::kTemperature*n_cells + i] = T;
+                        slice[HydroinfoMUSIC::kEd*n_cells + i] = 10.*T;
+                    }
+                }
+            }
+            hydro_info.dump_tau_slice_to_memory(tau, slice);
+        }
+    }
+}
+
+TEST_CASE("Check HydroinfoMUSIC interpolates the history") {
+    const InitData DATA = get_test_grid();
+    HydroinfoMUSIC hydro_info;
+    fill_test_history(DATA, hydro_info);
+    CHECK(hydro_info.get_ntau() == 6);
+    CHECK(hydro_info.get_number_of_fluid_cells() == 6*9*7*5);
+
+    const double tau = 1.03;
+    const double eta = 0.13;
+    const double t = tau*cosh(eta);
+    const double z = tau*sinh(eta);
+    fluidCell cell;
+    hydro_info.getHydroValues(0.3, -0.2, z, t, &cell);
+    const double T = get_test_temperature(tau, 0.3, -0.2, eta);
+    CHECK(cell.temperature == doctest::Approx(T).epsilon(1e-5));
+    CHECK(cell.ed == doctest::Approx(10.*T).epsilon(1e-5));
+    CHECK(cell.vx == doctest::Approx(0.));
+    CHECK(cell.vz == doctest::Approx(z/t).epsilon(1e-6));
+
+    hydro_info.getHydroValues(3.0, -0.2, z, t, &cell);
+    CHECK(cell.temperature == 0.);
+
+    // the cells are ordered [itau][ix][iy][ieta]
+    const int idx = ((2*9 + 4)*7 + 1)*5 + 3;
+    hydro_info.get_fluid_cell_with_index(idx, &cell);
+    CHECK(cell.temperature == doctest::Approx(get_test_temperature(
+                                    0.5 + 2*0.2, 0., -1.0, 0.25)));
+}
+
+TEST_CASE("Check HydroinfoMUSIC batched lookups match the single ones") {
+    const InitData DATA = get_test_grid();
+    HydroinfoMUSIC hydro_info;
+    fill_test_history(DATA, hydro_info);
+    const int n_points = 50;
+    std::vector<double> x(n_points), y(n_points), z(n_points), t(n_points);
+    for (int i = 0; i < n_points; i++) {
+        const double tau = 0.45 + 0.03*i;   // some points are out of range
+        const double eta = -0.4 + 0.016*i;
+        x[i] = -1.9 + 0.07*i;
+        y[i] = 1.3 - 0.05*i;
+        t[i] = tau*cosh(eta);
+        z[i] = tau*sinh(eta);
+    }
+    std::vector<fluidCell> cells(n_points);
+    hydro_info.getHydroValues(n_points, x.data(), y.data(), z.data(),
+                              t.data(), cells.data());
+    for (int i = 0; i < n_points; i++) {
+        fluidCell cell;
+        hydro_info.getHydroValues(x[i], y[i], z[i], t[i], &cell);
+        CHECK(cells[i].temperature == cell.temperature);
+        CHECK(cells[i].vz == cell.vz);
+    }
+}
+
+TEST_CASE("Check HydroinfoMUSIC skips the cells below the temperature cut") {
+    InitData DATA = get_test_grid();
+    HydroinfoMUSIC dense;
+    fill_test_history(DATA, dense);
+    DATA.store_hydro_info_T_cut = 0.1;
+    HydroinfoMUSIC sparse;
+    fill_test_history(DATA, sparse);
+    CHECK(sparse.get_number_of_fluid_cells()
+          == dense.get_number_of_fluid_cells());
+
+    int n_skipped = 0;
+    for (int idx = 0; idx < dense.get_number_of_fluid_cells(); idx++) {
+        fluidCell cell_dense, cell_sparse;
+        dense.get_fluid_cell_with_index(idx, &cell_dense);
+        sparse.get_fluid_cell_with_index(idx, &cell_sparse);
+        if (cell_dense.temperature >= DATA.store_hydro_info_T_cut) {
+            CHECK(cell_sparse.temperature == cell_dense.temperature);
+        } else if (cell_sparse.temperature == 0.) {
+            n_skipped++;
+        }
+    }
+    CHECK(n_skipped > 0);
+
+    // a point surrounded by hot cells
+    const double tau = 1.33;
+    fluidCell cell_dense, cell_sparse;
+    dense.getHydroValues(1.1, 0.8, 0., tau, &cell_dense);
+    sparse.getHydroValues(1.1, 0.8, 0., tau, &cell_sparse);
+    CHECK(cell_sparse.temperature == cell_dense.temperature);
+    sparse.getHydroValues(-1.9, -1.4, 0., 0.6, &cell_sparse);
+    CHECK(cell_sparse.temperature == 0.);
+}
+
+TEST_CASE("Check HydroinfoMUSIC getHydroValuesBatch counts the misses") {
+    const InitData DATA = get_test_grid();
+    HydroinfoMUSIC hydro_info;
+    fill_test_history(DATA, hydro_info);
+    // the points go back and forth in tau to exercise the grouping
+    const int n_points = 200;
+    std::vector<HydroinfoMUSIC::Point> points(n_points);
+    std::vector<bool> outside(n_points, false);
+    int n_outside = 0;
+    for (int i = 0; i < n_points; i++) {
+        const double tau = 0.51 + 1.5*((i*37) % n_points)/n_points;
+        const double eta = 0.3*sin(0.1*i);
+        const double x = 3.0*cos(0.07*i);
+        // the last cells reach up to tau = 1.7 fm and |x| = 2.5 fm
+        outside[i] = (tau > 1.7 || fabs(x) > 2.5);
+        if (outside[i]) n_outside++;
+        points[i] = {x, 1.2*sin(0.05*i), tau*sinh(eta), tau*cosh(eta)};
+    }
+    std::vector<fluidCell> cells(n_points);
+    CHECK(hydro_info.getHydroValuesBatch(points.data(), n_points,
+                                         cells.data()) == n_outside);
+    CHECK(hydro_info.get_number_of_out_of_range_queries() == n_outside);
+    for (int i = 0; i < n_points; i++) {
+        if (outside[i]) {
+            CHECK(cells[i].temperature == 0.);
+            continue;
+        }
+        fluidCell cell;
+        hydro_info.getHydroValues(points[i].x, points[i].y, points[i].z,
+                                  points[i].t, &cell);
+        CHECK(cells[i].temperature == cell.temperature);
+        CHECK(cells[i].ed == cell.ed);
+        CHECK(cells[i].vx == cell.vx);
+    }
+    hydro_info.clean_hydro_event();
+    CHECK(hydro_info.get_number_of_out_of_range_queries() == 0);
+}
+
+TEST_CASE("Check HydroinfoMUSIC pages the spilled slices back in") {
+    for (const double T_cut : {0., 0.1}) {
+        InitData DATA = get_test_grid();
+        DATA.store_hydro_info_T_cut = T_cut;
+        HydroinfoMUSIC in_memory;
+        fill_test_history(DATA, in_memory);
+        DATA.store_hydro_info_memory_slices = 2;
+        DATA.store_hydro_info_cache_slices = 2;
+        HydroinfoMUSIC spilled;
+        fill_test_history(DATA, spilled);
+        REQUIRE(spilled.get_spill() != nullptr);
+        CHECK(in_memory.get_spill() == nullptr);
+
+        for (int idx = 0; idx < in_memory.get_number_of_fluid_cells();
+             idx++) {
+            fluidCell cell, cell_spilled;
+            in_memory.get_fluid_cell_with_index(idx, &cell);
+            spilled.get_fluid_cell_with_index(idx, &cell_spilled);
+            CHECK(cell_spilled.temperature == cell.temperature);
+        }
+
+        const int n_points = 100;
+        std::vector<HydroinfoMUSIC::Point> points(n_points);
+        for (int i = 0; i < n_points; i++) {
+            const double tau = 0.51 + 1.1*((i*37) % n_points)/n_points;
+            const double eta = 0.3*sin(0.1*i);
+            points[i] = {1.5*cos(0.07*i), 1.2*sin(0.05*i),
+                         tau*sinh(eta), tau*cosh(eta)};
+        }
+        std::vector<fluidCell> cells(n_points), cells_spilled(n_points);
+        in_memory.getHydroValuesBatch(points.data(), n_points, cells.data());
+        spilled.getHydroValuesBatch(points.data(), n_points,
+                                    cells_spilled.data());
+        for (int i = 0; i < n_points; i++) {
+            fluidCell cell;
+            spilled.getHydroValues(points[i].x, points[i].y, points[i].z,
+                                   points[i].t, &cell);
+            CHECK(cell.temperature == cells[i].temperature);
+            CHECK(cells_spilled[i].temperature == cells[i].temperature);
+            CHECK(cells_spilled[i].vz == cells[i].vz);
+        }
+
+        // 4 of the 6 slices are spilled, at least the first 2 of them were
+        // written by the time of the queries and are read back
+        const HydroHistorySpill &spill = *spilled.get_spill();
+        CHECK(spill.get_file_size() > 0);
+        CHECK(spill.get_number_of_loads() > 0);
+        CHECK(spill.get_number_of_cache_misses() >= 2);
+        CHECK(spill.get_number_of_cache_misses()
+              < spill.get_number_of_loads());
+    }
+}
@@ -0,0 +1,60 @@
+#include <algorithm>
+#include <climits>
+#include "active_region.h"
+
+ActiveRegion::ActiveRegion(const int nx, const int ny, const int neta) :
+        nx_(nx), ny_(ny), neta_(neta),
+        x_min_(0), x_max_(nx), y_min_(0), y_max_(ny),
+        eta_min_(0), eta_max_(neta) {}
+
+
+void ActiveRegion::update(const SCGrid &arena, const double epsilon_min,
+                          const int margin) {
+    nx_   = arena.nX();
+    ny_   = arena.nY();
+    neta_ = arena.nEta();
+
+    int x_min = INT_MAX, y_min = INT_MAX, eta_min = INT_MAX;
+    int x_max = -1, y_max = -1, eta_max = -1;
+    #pragma omp parallel for collapse(2) reduction(min:x_min, y_min, eta_min) reduction(max:x_max, y_max, eta_max)
+    for (int ieta = 0; ieta < neta_; ieta++)
+    for (int iy   = 0; iy   < ny_;   iy++  ) {
+        for (int ix = 0; ix < nx_; ix++) {
+            if (arena(ix, iy, ieta).epsilon > epsilon_min) {
+                x_min   = std::min(x_min,   ix  );
+                x_max   = std::max(x_max,   ix  );
+                y_min   = std::min(y_min,   iy  );
+                y_max   = std::max(y_max,   iy  );
+                eta_min = std::min(eta_min, ieta);
+                eta_max = std::max(eta_max, ieta);
+            }
+        }
+    }
+
+    if (x_max < 0) {
+        // no fluid left above the vacuum
+        x_min_ = x_max_ = y_min_ = y_max_ = eta_min_ = eta_max_ = 0;
+        return;
+    }
+    x_min_   = std::max(0,     x_min   - margin    );
+    x_max_   = std::min(nx_,   x_max   + margin + 1);
+    y_min_   = std::max(0,     y_min   - margin    );
+    y_max_   = std::min(ny_,   y_max   + margin + 1);
+    eta_min_ = std::max(0,     eta_min - margin    );
+    eta_max_ = std::min(neta_, eta_max + margin + 1);
+}
+
+
+void ActiveRegion::merge(const ActiveRegion &other) {
+    if (other.is_empty()) return;
+    if (is_empty()) {
+        *this = other;
+        return;
+    }
+    x_min_   = std::min(x_min_,   other.x_min_  );
+    x_max_   = std::max(x_max_,   other.x_max_  );
+    y_min_   = std::min(y_min_,   other.y_min_  );
+    y_max_   = std::max(y_max_,   other.y_max_  );
+    eta_min_ = std::min(eta_min_, other.eta_min_);
+    eta_max_ = std::max(eta_max_, other.eta_max_);
+}
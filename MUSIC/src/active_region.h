@@ -0,0 +1,69 @@
+#ifndef SRC_ACTIVE_REGION_H_
+#define SRC_ACTIVE_REGION_H_
+
+#include <algorithm>
+#include "grid.h"
+
+//! This class is the bounding box of the fluid cells above a vacuum energy
+//! density, padded by a safety margin of cells. The box is half-open:
+//! [x_min, x_max) x [y_min, y_max) x [eta_min, eta_max).
+//! The hydro update and the freeze-out scan only visit the cells inside,
+//! the cells outside are copied forward unchanged.
+class ActiveRegion {
+ private:
+    int nx_ = 0, ny_ = 0, neta_ = 0;
+    int x_min_ = 0, x_max_ = 0;
+    int y_min_ = 0, y_max_ = 0;
+    int eta_min_ = 0, eta_max_ = 0;
+
+ public:
+    ActiveRegion() = default;
+
+    //! the region covering the whole nx*ny*neta grid
+    ActiveRegion(const int nx, const int ny, const int neta);
+
+    //! this function shrinks the region to the cells of arena with
+    //! epsilon > epsilon_min [1/fm^4], padded by margin cells
+    void update(const SCGrid &arena, const double epsilon_min,
+                const int margin);
+
+    //! this function extends the region to cover also the other region
+    void merge(const ActiveRegion &other);
+
+    //! the part of the region in the eta layers [eta_min, eta_max)
+    ActiveRegion get_eta_slab(const int eta_min, const int eta_max) const {
+        ActiveRegion slab(*this);
+        slab.eta_min_ = std::max(eta_min_, eta_min);
+        slab.eta_max_ = std::min(eta_max_, eta_max);
+        return(slab);
+    }
+
+    bool is_active(const int ix, const int iy, const int ieta) const {
+        return(   ix   >= x_min_   && ix   < x_max_
+               && iy   >= y_min_   && iy   < y_max_
+               && ieta >= eta_min_ && ieta < eta_max_);
+    }
+
+    bool is_empty() const {
+        return(x_min_ >= x_max_ || y_min_ >= y_max_ || eta_min_ >= eta_max_);
+    }
+
+    bool is_full_grid() const {
+        return(   x_min_ == 0 && x_max_ == nx_ && y_min_ == 0 && y_max_ == ny_
+               && eta_min_ == 0 && eta_max_ == neta_);
+    }
+
+    int get_number_of_cells() const {
+        if (is_empty()) return(0);
+        return((x_max_ - x_min_)*(y_max_ - y_min_)*(eta_max_ - eta_min_));
+    }
+
+    int get_x_min()   const {return(x_min_);}
+    int get_x_max()   const {return(x_max_);}
+    int get_y_min()   const {return(y_min_);}
+    int get_y_max()   const {return(y_max_);}
+    int get_eta_min() const {return(eta_min_);}
+    int get_eta_max() const {return(eta_max_);}
+};
+
+#endif  // SRC_ACTIVE_REGION_H_
@@ -4,14 +4,13 @@
     #include <omp.h>
 #endif
 
+#include <algorithm>
+#include <array>
 #include <cassert>
 #include <cmath>
 #include <memory>
-#include <Eigen/Eigenvalues>
-#include <Eigen/Core>
+#include <utility>
 #include <vector>
-#include <fstream>
-#include <iomanip>
 
 #include "util.h"
 #include "data.h"
@@ -21,20 +20,24 @@
 #include "eos.h"
 #include "evolve.h"
 #include "advance.h"
+#include "grid_tiling.h"
+#include "instrumentation.h"
+#include "wmunu_eigenvalues.h"
 
 using Util::map_2d_idx_to_1d;
 using Util::map_1d_idx_to_2d;
 using Util::hbarc;
-using Eigen::MatrixXd;
-using Eigen::EigenSolver;
 
 Advance::Advance(const EOS &eosIn, const InitData &DATA_in,
                  std::shared_ptr<HydroSourceBase> hydro_source_ptr_in) :
     DATA(DATA_in), eos(eosIn),
     diss_helper(eosIn, DATA_in),
     minmod(DATA_in),
+    eta_grid_(DATA_in),
     reconst_helper(eos, DATA_in.echo_level),
-    transport_coeffs_(eosIn, DATA_in) {
+    rk_scheme_(DATA_in.rk_order),
+    transport_coeffs_(eosIn, DATA_in),
+    causality_limiter_(DATA_in, eosIn, transport_coeffs_) {
 
     hydro_source_terms_ptr = hydro_source_ptr_in;
     flag_add_hydro_source = false;
@@ -47,106 +50,772 @@ Advance::Advance(const EOS &eosIn, const InitData &DATA_in,
             flag_add_hydro_source = true;
         }
     }
+    physics_config_ = PhysicsConfig::get_config(DATA, flag_add_hydro_source);
+#ifdef MUSIC_OFFLOAD
+    thermo_offload_.reset(new ThermoOffload(eos));
+#endif
+}
+
+//! this function resizes thermo to the grid of arena
+void Advance::resize_thermo_cache(const SCGrid &arena,
+                                  SweepThermoGrid &thermo) {
+    const int grid_neta = arena.nEta();
+    const int grid_nx   = arena.nX();
+    const int grid_ny   = arena.nY();
+    if (   thermo.nX() != grid_nx || thermo.nY() != grid_ny
+        || thermo.nEta() != grid_neta) {
+        thermo = SweepThermoGrid(grid_nx, grid_ny, grid_neta);
+    }
+}
+
+
+//! this function computes the EOS quantities of all the cells in arena.
+//! It is called by all the threads of a parallel region, and does not
+//! wait for the other threads at the end.
+void Advance::fill_thermo_cache(const SCGrid &arena,
+                                SweepThermoGrid &thermo) {
+    // the cells are passed to the batch EOS function in chunks
+    const int n_cells = arena.size();
+    const int chunk   = 64;
+    #pragma omp for schedule(static) nowait
+    for (int idx0 = 0; idx0 < n_cells; idx0 += chunk) {
+        const int n = std::min(chunk, n_cells - idx0);
+        double e[chunk], rhob[chunk];
+        ThermoState thermo_list[chunk];
+        for (int i = 0; i < n; i++) {
+            e[i]    = arena(idx0 + i).epsilon;
+            rhob[i] = arena(idx0 + i).rhob;
+        }
+        eos.get_thermo_batch(e, rhob, thermo_list, n);
+        for (int i = 0; i < n; i++) {
+            auto &thermo_i = thermo(idx0 + i);
+            thermo_i.pressure    = thermo_list[i].pressure;
+            thermo_i.cs2         = thermo_list[i].cs2;
+            thermo_i.temperature = thermo_list[i].temperature;
+            thermo_i.muB         = thermo_list[i].muB;
+            thermo_i.entropy     = thermo_list[i].entropy;
+            thermo_i.dpde        = thermo_list[i].dpde;
+            thermo_i.dpdrhob     = thermo_list[i].dpdrhob;
+            for (int alpha = 0; alpha < 5; alpha++) {
+                thermo_i.conserved[alpha] = get_TJb(
+                        arena(idx0 + i), thermo_i.pressure, alpha, 0);
+            }
+        }
+    }
+}
+
+
+//! this function fills the EOS caches chosen by update_thermo_cache,
+//! from all the threads of a parallel region without a barrier
+void Advance::fill_thermo_caches() {
+    for (int i = 0; i < n_thermo_fills_; i++) {
+        fill_thermo_cache(*thermo_fill_src_[i], *thermo_fill_dst_[i]);
+    }
+}
+
+
+//! this function fills the EOS caches chosen by update_thermo_cache in
+//! their own parallel regions, or on the offload device
+void Advance::refill_thermo_caches() {
+#ifdef MUSIC_OFFLOAD
+    if (thermo_offload_->is_active()) {
+        for (int i = 0; i < n_thermo_fills_; i++) {
+            fill_thermo_cache_offload(*thermo_fill_src_[i],
+                                      *thermo_fill_dst_[i]);
+        }
+    } else {
+        #pragma omp parallel
+        fill_thermo_caches();
+    }
+#else
+    #pragma omp parallel
+    fill_thermo_caches();
+#endif
+#ifdef MUSIC_PADDED_SWEEPS
+    // the stencil of MakeDeltaQI reads the pressure and the conserved
+    // densities of the ghost cells
+    fill_ghost_cells(thermo_current_);
+#endif
+}
+
+
+#ifdef MUSIC_OFFLOAD
+//! the whole grid is sent to the device in one batch, the few cells
+//! outside the derivative tables are then evaluated on the host
+void Advance::fill_thermo_cache_offload(const SCGrid &arena,
+                                        SweepThermoGrid &thermo) {
+    const int n_cells = arena.size();
+    offload_e_.resize(n_cells);
+    offload_rhob_.resize(n_cells);
+    offload_thermo_.resize(n_cells);
+    offload_in_tables_.resize(n_cells);
+    #pragma omp parallel for schedule(static)
+    for (int idx = 0; idx < n_cells; idx++) {
+        offload_e_[idx]    = arena(idx).epsilon;
+        offload_rhob_[idx] = arena(idx).rhob;
+    }
+    thermo_offload_->get_thermo_batch(
+        offload_e_.data(), offload_rhob_.data(), offload_thermo_.data(),
+        offload_in_tables_.data(), n_cells);
+    #pragma omp parallel for schedule(static)
+    for (int idx = 0; idx < n_cells; idx++) {
+        const ThermoState thermo_idx = (
+            offload_in_tables_[idx] ? offload_thermo_[idx]
+            : eos.get_thermo(offload_e_[idx], offload_rhob_[idx]));
+        auto &thermo_i = thermo(idx);
+        thermo_i.pressure    = thermo_idx.pressure;
+        thermo_i.cs2         = thermo_idx.cs2;
+        thermo_i.temperature = thermo_idx.temperature;
+        thermo_i.muB         = thermo_idx.muB;
+        thermo_i.entropy     = thermo_idx.entropy;
+        thermo_i.dpde        = thermo_idx.dpde;
+        thermo_i.dpdrhob     = thermo_idx.dpdrhob;
+        for (int alpha = 0; alpha < 5; alpha++) {
+            thermo_i.conserved[alpha] = get_TJb(
+                    arena(idx), thermo_i.pressure, alpha, 0);
+        }
+    }
+}
+#endif
+
+
+//! this function prepares the EOS cache for the Runge-Kutta stage rk_flag.
+//! In the second stage, arena_prev is the arena_current of the first
+//! stage, so its cache is reused, and it is kept for the later stages,
+//! which start from the same arena_prev. The caches to refill are resized
+//! here and filled by fill_thermo_caches.
+void Advance::update_thermo_cache(const SCGrid &arena_prev,
+                                  const SCGrid &arena_current,
+                                  const int rk_flag) {
+    n_thermo_fills_ = 0;
+    auto add_fill = [this](const SCGrid &arena, SweepThermoGrid &thermo) {
+        resize_thermo_cache(arena, thermo);
+        thermo_fill_src_[n_thermo_fills_] = &arena;
+        thermo_fill_dst_[n_thermo_fills_] = &thermo;
+        n_thermo_fills_++;
+    };
+    if (rk_flag == 0) {
+        // arena_prev of the last step has been overwritten
+        thermo_prev_src_ = nullptr;
+    } else if (&arena_prev != thermo_prev_src_) {
+        if (&arena_prev == thermo_current_src_) {
+            std::swap(thermo_prev_, thermo_current_);
+        } else {
+            add_fill(arena_prev, thermo_prev_);
+        }
+        thermo_prev_src_ = &arena_prev;
+    }
+    add_fill(arena_current, thermo_current_);
+    thermo_current_src_ = &arena_current;
+}
+
+
+//! this function points the stencil sweeps of the stage to arena_current,
+//! or to its padded or structure-of-arrays copy
+void Advance::update_sweep_grid(SCGrid &arena_current) {
+#if defined(MUSIC_PADDED_SWEEPS) || defined(MUSIC_SOA_SWEEPS)
+    if (   sweep_copy_.nX() != arena_current.nX()
+        || sweep_copy_.nY() != arena_current.nY()
+        || sweep_copy_.nEta() != arena_current.nEta()) {
+        sweep_copy_ = SweepGrid(arena_current.nX(), arena_current.nY(),
+                                arena_current.nEta());
+    }
+#ifdef MUSIC_PADDED_SWEEPS
+    sweep_copy_.copy_interior(arena_current);
+    fill_ghost_cells(sweep_copy_);
+#else
+    sweep_copy_.load(arena_current);
+#endif
+    sweep_current_ = &sweep_copy_;
+#else
+    sweep_current_ = &arena_current;
+#endif
+}
+
+
+void Advance::update_lambda_grids(const SCGrid &arena_prev,
+                                  const SCGrid &arena_current,
+                                  const SCGrid &arena_future) {
+    const SCGrid *arenas[3] = {&arena_prev, &arena_current, &arena_future};
+    LambdaGrid *grids[3] = {nullptr, nullptr, nullptr};
+    bool taken[3] = {false, false, false};
+    for (int a = 0; a < 3; a++) {
+        for (int i = 0; i < 3; i++) {
+            if (!taken[i] && lambda_src_[i] == arenas[a]
+                    && lambdas_[i].size() == arenas[a]->size()) {
+                grids[a] = &lambdas_[i];
+                taken[i] = true;
+                break;
+            }
+        }
+    }
+    for (int a = 0; a < 3; a++) {
+        if (grids[a] != nullptr) continue;
+        int i = 0;
+        while (taken[i]) i++;
+        lambdas_[i] = LambdaGrid(arenas[a]->nX(), arenas[a]->nY(),
+                                 arenas[a]->nEta());
+        lambda_src_[i] = arenas[a];
+        grids[a] = &lambdas_[i];
+        taken[i] = true;
+    }
+    lambdas_current_ = grids[1];
+    lambdas_future_  = grids[2];
+}
+
+
+void Advance::write_checkpoint(CheckpointWriter &checkpoint,
+                               const SCGrid &arena_prev,
+                               const SCGrid &arena_current,
+                               const SCGrid &arena_future) {
+    if (DATA.causality_method == 0) return;
+    update_lambda_grids(arena_prev, arena_current, arena_future);
+    for (int i = 0; i < 3; i++) checkpoint.add_grid(lambdas_[i]);
+    for (const SCGrid *arena : {&arena_prev, &arena_current, &arena_future}) {
+        for (int i = 0; i < 3; i++) {
+            if (lambda_src_[i] == arena) checkpoint.add(i);
+        }
+    }
+}
+
+
+void Advance::read_checkpoint(CheckpointReader &checkpoint,
+                              const SCGrid &arena_prev,
+                              const SCGrid &arena_current,
+                              const SCGrid &arena_future) {
+    if (DATA.causality_method == 0) return;
+    for (int i = 0; i < 3; i++) checkpoint.get_grid(lambdas_[i]);
+    for (const SCGrid *arena : {&arena_prev, &arena_current, &arena_future}) {
+        int i = 0;
+        checkpoint.get(i);
+        lambda_src_[i] = arena;
+    }
+}
+
+
+//! this function prepares the caches of the Runge-Kutta stage rk_flag and
+//! the grids of their results, the serial part of a stage before its loops
+void Advance::prepare_stage(SCGrid &arena_prev, SCGrid &arena_current,
+                            SCGrid &arena_future, const int rk_flag) {
+    update_thermo_cache(arena_prev, arena_current, rk_flag);
+    update_sweep_grid(arena_current);
+    if (DATA.causality_method != 0) {
+        update_lambda_grids(arena_prev, arena_current, arena_future);
+    }
+    if (DATA.face_flux == 1) resize_face_fluxes(arena_current);
+    if (uses_gradient_rows()
+            && (   gradients_.nX() != arena_current.nX()
+                || gradients_.nY() != arena_current.nY()
+                || gradients_.nEta() != arena_current.nEta())) {
+        gradients_ = GradientGrid(arena_current.nX(), arena_current.nY(),
+                                  arena_current.nEta());
+    }
+}
+
+
+bool Advance::can_advance_in_team() const {
+#if defined(MUSIC_PADDED_SWEEPS) || defined(MUSIC_SOA_SWEEPS)
+    // the copies of the sweep grid have their own parallel loops
+    return(false);
+#else
+#ifdef MUSIC_OFFLOAD
+    if (thermo_offload_->is_active()) return(false);
+#endif
+    if (domain_ptr_ != nullptr && domain_ptr_->is_distributed()) {
+        return(false);
+    }
+    return(!flag_add_hydro_source || DATA.source_deposition != 1);
+#endif
 }
 
+
 //! this function evolves one Runge-Kutta step in tau
 void Advance::AdvanceIt(const double tau,
                         SCGrid &arena_prev, SCGrid &arena_current,
-                        SCGrid &arena_future, const int rk_flag) {
+                        SCGrid &arena_future, const int rk_flag,
+                        const ActiveRegion &active_region) {
+    ScopedTimer timer(InstrumentedTimer::advance_it);
     const int grid_neta = arena_current.nEta();
-    const int grid_nx   = arena_current.nX();
-    const int grid_ny   = arena_current.nY();
 
-    #pragma omp parallel for collapse(3) schedule(guided)
-    for (int ieta = 0; ieta < grid_neta; ieta++)
-    for (int ix   = 0; ix   < grid_nx;   ix++  )
-    for (int iy   = 0; iy   < grid_ny;   iy++  ) {
-        double eta_s_local = - DATA.eta_size/2. + ieta*DATA.delta_eta;
-        double x_local     = - DATA.x_size  /2. +   ix*DATA.delta_x;
-        double y_local     = - DATA.y_size  /2. +   iy*DATA.delta_y;
+    prepare_stage(arena_prev, arena_current, arena_future, rk_flag);
+    refill_thermo_caches();
+    if (DATA.face_flux == 1) {
+        #pragma omp parallel
+        compute_stage_face_fluxes(tau, rk_flag, active_region);
+    }
+    if (flag_add_hydro_source && DATA.source_deposition == 1) {
+        hydro_source_terms_ptr->deposit_sources(
+            tau + rk_scheme_.get_stage_tau_fraction(rk_flag)*DATA.delta_tau,
+            DATA, arena_current, sources_);
+    }
+
+    if (domain_ptr_ == nullptr || !domain_ptr_->is_distributed()) {
+        advance_eta_layers(tau, arena_prev, arena_current, arena_future,
+                           rk_flag, active_region, 0, grid_neta);
+        return;
+    }
+
+    // the layers sent to the neighbouring slabs are evolved first, their
+    // exchange overlaps with the evolution of the interior of the slab
+    const int owned_min    = domain_ptr_->get_owned_eta_min();
+    const int owned_max    = domain_ptr_->get_owned_eta_max();
+    const int interior_min = domain_ptr_->get_interior_eta_min();
+    const int interior_max = domain_ptr_->get_interior_eta_max();
+    advance_eta_layers(tau, arena_prev, arena_current, arena_future,
+                       rk_flag, active_region, owned_min, interior_min);
+    advance_eta_layers(tau, arena_prev, arena_current, arena_future,
+                       rk_flag, active_region, interior_max, owned_max);
+    domain_ptr_->start_halo_exchange(arena_future);
+    advance_eta_layers(tau, arena_prev, arena_current, arena_future,
+                       rk_flag, active_region, interior_min, interior_max);
+    domain_ptr_->finish_halo_exchange();
+}
+
+
+void Advance::AdvanceIt_in_team(const double tau,
+                                SCGrid &arena_prev, SCGrid &arena_current,
+                                SCGrid &arena_future, const int rk_flag,
+                                const ActiveRegion &active_region) {
+    const int grid_neta = arena_current.nEta();
+    // the sweeps read the caches and the faces of the neighbouring cells
+    fill_thermo_caches();
+    #pragma omp barrier
+    if (DATA.face_flux == 1) {
+        compute_stage_face_fluxes(tau, rk_flag, active_region);
+        #pragma omp barrier
+    }
+    advance_eta_layers_in_team(tau, arena_prev, arena_current, arena_future,
+                               rk_flag, active_region, 0, grid_neta);
+    // the causality limiter and the next stage read the evolved cells
+    #pragma omp barrier
+    if (limits_causality()) {
+        enforce_causality(tau, arena_future,
+                          active_region.get_eta_slab(0, grid_neta));
+    }
+}
+
+
+//! this function computes the face fluxes of the stage rk_flag with the
+//! slope limiter of the run
+void Advance::compute_stage_face_fluxes(const double tau, const int rk_flag,
+                                        const ActiveRegion &active_region) {
+    const double tau_rk = (
+        tau + rk_scheme_.get_stage_tau_fraction(rk_flag)*DATA.delta_tau);
+    if (DATA.slope_limiter == SlopeLimiter::kMonotonizedCentral) {
+        compute_face_fluxes(SlopeLimiter::MonotonizedCentral(), tau_rk,
+                            *sweep_current_, thermo_current_,
+                            active_region);
+    } else if (DATA.slope_limiter == SlopeLimiter::kVanLeer) {
+        compute_face_fluxes(SlopeLimiter::VanLeer(), tau_rk,
+                            *sweep_current_, thermo_current_,
+                            active_region);
+    } else {
+        compute_face_fluxes(minmod.get_limiter(), tau_rk,
+                            *sweep_current_, thermo_current_,
+                            active_region);
+    }
+}
 
-        FirstRKStepT(tau, x_local, y_local, eta_s_local,
-                     arena_current, arena_future, arena_prev,
-                     ix, iy, ieta, rk_flag);
 
-        if (DATA.viscosity_flag == 1) {
-            U_derivative u_derivative_helper(DATA, eos);
-            u_derivative_helper.MakedU(tau, arena_prev, arena_current,
-                                       ix, iy, ieta);
-            double theta_local = u_derivative_helper.calculate_expansion_rate(
-                                            tau, arena_current, ieta, ix, iy);
-            DumuVec a_local;
-            u_derivative_helper.calculate_Du_supmu(tau, arena_current,
-                                                   ieta, ix, iy, a_local);
+bool Advance::limits_causality() const {
+    // the causality constraints of the viscous cells evolved by
+    // FirstRKStepW
+    return(   causality_limiter_.is_enabled()
+           && (physics_config_ & PhysicsConfig::kViscous)
+           && DATA.Initial_profile != 0 && DATA.Initial_profile != 1);
+}
+
 
-            VelocityShearVec sigma_local;
-            u_derivative_helper.calculate_velocity_shear_tensor(
-                    tau, arena_current, ieta, ix, iy, a_local, sigma_local);
+void Advance::advance_eta_layers(const double tau,
+                                 SCGrid &arena_prev, SCGrid &arena_current,
+                                 SCGrid &arena_future, const int rk_flag,
+                                 const ActiveRegion &active_region,
+                                 const int eta_min, const int eta_max) {
+    if (eta_min >= eta_max) return;
+    #pragma omp parallel
+    advance_eta_layers_in_team(tau, arena_prev, arena_current, arena_future,
+                               rk_flag, active_region, eta_min, eta_max);
+
+    // the causality constraints, before the layers are sent to the
+    // neighbouring slabs
+    if (limits_causality()) {
+        const ActiveRegion region = (
+                        active_region.get_eta_slab(eta_min, eta_max));
+        #pragma omp parallel
+        enforce_causality(tau, arena_future, region);
+    }
+}
 
-            VorticityVec omega_local;
-            u_derivative_helper.calculate_kinetic_vorticity_with_spatial_projector(
-                    tau, arena_current, ieta, ix, iy, a_local, omega_local);
 
-            DmuMuBoverTVec baryon_diffusion_vector;
-            u_derivative_helper.get_DmuMuBoverTVec(baryon_diffusion_vector);
+void Advance::advance_eta_layers_in_team(const double tau,
+                                         SCGrid &arena_prev,
+                                         SCGrid &arena_current,
+                                         SCGrid &arena_future,
+                                         const int rk_flag,
+                                         const ActiveRegion &active_region,
+                                         const int eta_min,
+                                         const int eta_max) {
+    if (eta_min >= eta_max) return;
+    const int grid_nx = arena_current.nX();
+    const int grid_ny = arena_current.nY();
+    const ActiveRegion region = active_region.get_eta_slab(eta_min, eta_max);
+    const GridTiling tiling(DATA, region);
+    const int ntiles = tiling.get_number_of_tiles();
+    const bool full_grid = region.is_full_grid();
+
+    const auto all_configs = (
+        std::make_integer_sequence<unsigned, PhysicsConfig::kNumConfigs>());
+    const auto advance_stencil = (
+        get_advance_cell_kernel<SCStencil, ThermoStencil>(all_configs));
+    const auto advance_sweep = (
+        get_advance_cell_kernel<SweepGrid, SweepThermoGrid>(all_configs));
+
+    if (uses_gradient_rows()) {
+        compute_stage_gradients(tau, arena_prev, region);
+    }
+
+    U_derivative u_derivative_helper(DATA, eos);
+    auto advance_cell = [&](const int ix, const int iy, const int ieta) {
+        if (DATA.fused_rk_stage == 1) {
+            // read the stencil once into a local tile, and write
+            // the future cell once at the end
+            SCStencil stencil(*sweep_current_, ix, iy, ieta);
+            ThermoStencil thermo_stencil(thermo_current_, ix, iy, ieta);
+            Cell_small grid_f = arena_future(ix, iy, ieta);
+            (this->*advance_stencil)(
+                        tau, stencil, thermo_stencil,
+                        arena_prev, arena_current, grid_f,
+                        u_derivative_helper, ix, iy, ieta, rk_flag);
+            arena_future(ix, iy, ieta) = grid_f;
+        } else {
+            (this->*advance_sweep)(
+                        tau, *sweep_current_, thermo_current_,
+                        arena_prev, arena_current,
+                        arena_future(ix, iy, ieta),
+                        u_derivative_helper, ix, iy, ieta, rk_flag);
+        }
+    };
+
+    if (DATA.grid_traversal == 2) {
+        // the rows in storage order in the static partition of the
+        // first touch, so each thread updates the cells on its NUMA node
+        #pragma omp for collapse(2) schedule(static) nowait
+        for (int ieta = eta_min; ieta < eta_max; ieta++)
+        for (int iy   = 0;       iy   < grid_ny; iy++  ) {
+            for (int ix = 0; ix < grid_nx; ix++) {
+                if (region.is_active(ix, iy, ieta))
+                    advance_cell(ix, iy, ieta);
+            }
+        }
+    } else if (DATA.grid_traversal == 1) {
+        // cache-blocked tiles in the storage order of the grid
+        #pragma omp for schedule(dynamic) nowait
+        for (int itile = 0; itile < ntiles; itile++) {
+            tiling.for_each_cell(itile, advance_cell);
+        }
+    } else if (DATA.grid_traversal == 3) {
+        // the tiles of the whole layers, which stay the same when the
+        // active region changes, so the times of the last sweep predict
+        // the costs of the next one
+        const GridTiling layer_tiling(
+                DATA, ActiveRegion(grid_nx, grid_ny, arena_current.nEta())
+                          .get_eta_slab(eta_min, eta_max));
+        #pragma omp single
+        {
+            tile_scheduler_ = &tile_schedulers_[{eta_min, eta_max}];
+            tile_scheduler_->plan(layer_tiling.get_number_of_tiles());
+        }
+        tile_scheduler_->run([&](const int itile) {
+            layer_tiling.for_each_cell(itile,
+                [&](const int ix, const int iy, const int ieta) {
+                    if (region.is_active(ix, iy, ieta))
+                        advance_cell(ix, iy, ieta);
+                });
+        });
+    } else {
+        #pragma omp for collapse(3) schedule(guided) nowait
+        for (int ieta = eta_min; ieta < eta_max; ieta++)
+        for (int ix   = 0;       ix   < grid_nx; ix++  )
+        for (int iy   = 0;       iy   < grid_ny; iy++  ) {
+            if (region.is_active(ix, iy, ieta))
+                advance_cell(ix, iy, ieta);
+        }
+    }
 
-            FirstRKStepW(tau, arena_prev, arena_current, arena_future, rk_flag,
-                         theta_local, a_local, sigma_local, omega_local,
-                         baryon_diffusion_vector, ieta, ix, iy);
+    if (!full_grid) {
+        // the vacuum outside the active region is copied forward, these
+        // cells are not touched by the sweeps above
+        #pragma omp for collapse(2) nowait
+        for (int ieta = eta_min; ieta < eta_max; ieta++)
+        for (int iy   = 0;       iy   < grid_ny; iy++  ) {
+            for (int ix = 0; ix < grid_nx; ix++) {
+                if (region.is_active(ix, iy, ieta)) continue;
+                arena_future(ix, iy, ieta) = arena_current(ix, iy, ieta);
+                if (DATA.causality_method != 0) {
+                    (*lambdas_future_)(ix, iy, ieta) = (
+                                    (*lambdas_current_)(ix, iy, ieta));
+                }
+            }
         }
     }
 }
 
 
+bool Advance::uses_gradient_rows() const {
+    return(   DATA.u_derivative_rows == 1
+           && (physics_config_ & PhysicsConfig::kViscous));
+}
+
+
+//! the rows of the region are divided statically over the threads, each
+//! thread computes the derivatives of its rows with its own buffers. The
+//! temperatures and mu_B of arena_current come from the EOS cache of the
+//! stage.
+void Advance::compute_stage_gradients(const double tau, SCGrid &arena_prev,
+                                      const ActiveRegion &active_region) {
+    if (active_region.is_empty()) return;
+    const int x_min = active_region.get_x_min();
+    const int x_max = active_region.get_x_max();
+    UDerivativeRows rows(DATA, eos);
+    #pragma omp for collapse(2) schedule(static)
+    for (int ieta = active_region.get_eta_min();
+         ieta < active_region.get_eta_max(); ieta++)
+    for (int iy = active_region.get_y_min();
+         iy < active_region.get_y_max(); iy++) {
+        rows.compute_row(tau, arena_prev, *sweep_current_, &thermo_current_,
+                         x_min, x_max, iy, ieta);
+        for (int ix = x_min; ix < x_max; ix++) {
+            rows.get_gradients(tau, ix, gradients_(ix, iy, ieta));
+        }
+    }
+}
+
+
+void Advance::resize_face_fluxes(const SCGrid &arena) {
+    const std::array<int, 3> dx   = {1, 0, 0};
+    const std::array<int, 3> dy   = {0, 1, 0};
+    const std::array<int, 3> deta = {0, 0, 1};
+    const int n_directions = DATA.boost_invariant ? 2 : 3;
+    for (int dir = 0; dir < n_directions; dir++) {
+        const int nx_f   = arena.nX()   + dx[dir];
+        const int ny_f   = arena.nY()   + dy[dir];
+        const int neta_f = arena.nEta() + deta[dir];
+        FaceFluxGrid &faces = face_fluxes_[dir];
+        if (   faces.nX() != nx_f || faces.nY() != ny_f
+            || faces.nEta() != neta_f) {
+            faces = FaceFluxGrid(nx_f, ny_f, neta_f);
+        }
+    }
+}
+
+
+//! this function computes the KT fluxes of the ideal part through the
+//! faces of the cells in active_region. The half-way cells on the two
+//! sides of a face are the same for the two cells sharing it, so they are
+//! reconstructed once here instead of once by each cell in MakeDeltaQI.
+//! The reconstruction of a face starts from the cell on its minus side,
+//! the slopes of the five components are limited as a row by limiter.
+//! It is called by all the threads of a parallel region after
+//! resize_face_fluxes, and does not wait for them at the end.
+template<class Limiter, class Grid, class Thermo>
+void Advance::compute_face_fluxes(const Limiter &limiter, const double tau,
+                                  Grid &arena_sweep, Thermo &thermo_sweep,
+                                  const ActiveRegion &active_region) {
+    const int grid_neta = arena_sweep.nEta();
+    const int grid_nx   = arena_sweep.nX();
+    const int grid_ny   = arena_sweep.nY();
+    const std::array<int, 3> dx   = {1, 0, 0};
+    const std::array<int, 3> dy   = {0, 1, 0};
+    const std::array<int, 3> deta = {0, 0, 1};
+    // MakeDeltaQI adds the eta fluxes of a boost-invariant run analytically
+    const int n_directions = DATA.boost_invariant ? 2 : 3;
+    for (int dir = 0; dir < n_directions; dir++) {
+        const int direction = dir + 1;
+        const int nx_f   = grid_nx   + dx[dir];
+        const int ny_f   = grid_ny   + dy[dir];
+        const int neta_f = grid_neta + deta[dir];
+        FaceFluxGrid &faces = face_fluxes_[dir];
+
+        // the directions fill different grids, so they share no barrier
+        #pragma omp for collapse(3) schedule(guided) nowait
+        for (int ieta = 0; ieta < neta_f; ieta++)
+        for (int ix   = 0; ix   < nx_f;   ix++  )
+        for (int iy   = 0; iy   < ny_f;   iy++  ) {
+            // the cells m1, c, p1, p2 along direction around the face
+            // between c and p1
+            const int cx   = ix   - dx[dir];
+            const int cy   = iy   - dy[dir];
+            const int ceta = ieta - deta[dir];
+            if (   !active_region.is_active(ix, iy, ieta)
+                && !active_region.is_active(cx, cy, ceta)) continue;
+
+            const auto& tm1 = thermo_sweep.getHalo(
+                        cx - dx[dir], cy - dy[dir], ceta - deta[dir]);
+            const auto& tc  = thermo_sweep.getHalo(cx, cy, ceta);
+            const auto& tp1 = thermo_sweep.getHalo(ix, iy, ieta);
+            const auto& tp2 = thermo_sweep.getHalo(
+                        ix + dx[dir], iy + dy[dir], ieta + deta[dir]);
+
+            double gm1[5], gc[5], gp1[5], gp2[5];
+            for (int alpha = 0; alpha < 5; alpha++) {
+                gm1[alpha] = tau*tm1.conserved[alpha];
+                gc[alpha]  = tau*tc.conserved[alpha];
+                gp1[alpha] = tau*tp1.conserved[alpha];
+                gp2[alpha] = tau*tp2.conserved[alpha];
+            }
+            double slope_c[5], slope_p1[5];
+            SlopeLimiter::limit_row(limiter, 5, gp1, gc, gm1, slope_c);
+            SlopeLimiter::limit_row(limiter, 5, gp2, gp1, gc, slope_p1);
+            TJbVec q_half[2];
+            for (int alpha = 0; alpha < 5; alpha++) {
+                q_half[0][alpha] = gc[alpha]  + 0.5*slope_c[alpha];
+                q_half[1][alpha] = gp1[alpha] - 0.5*slope_p1[alpha];
+            }
+
+            const Cell_small &grid_guess = arena_sweep(
+                            std::max(cx, 0), std::max(cy, 0),
+                            std::max(ceta, 0));
+            ReconstCell grid_half[2];
+            if (DATA.reconst_batch == 1) {
+                reconst_helper.ReconstIt_batch(tau, 2, q_half, grid_guess,
+                                               grid_half);
+            } else {
+                for (int i = 0; i < 2; i++) {
+                    grid_half[i] = reconst_helper.ReconstIt_shell(
+                                                tau, q_half[i], grid_guess);
+                }
+            }
+            get_KT_flux(tau, direction, q_half[0], q_half[1],
+                        grid_half[0], grid_half[1], faces(ix, iy, ieta));
+        }
+    }
+}
+
+
+template<class Grid, class Thermo, unsigned... Configs>
+Advance::AdvanceCellKernel<Grid, Thermo> Advance::get_advance_cell_kernel(
+            std::integer_sequence<unsigned, Configs...>) const {
+    static const AdvanceCellKernel<Grid, Thermo> kernels[] = {
+        &Advance::AdvanceCell<PhysicsConfig::canonical(Configs),
+                              Grid, Thermo>...};
+    return(kernels[physics_config_]);
+}
+
+
+//! this function evolves the cell (ix, iy, ieta) by one Runge-Kutta stage.
+//! The stencils are read from arena_sweep and thermo_sweep, which are
+//! either the sweep grids or the local tiles of the cell. The physics
+//! options come from Config (see physics_config.h).
+template<unsigned Config, class Grid, class Thermo>
+void Advance::AdvanceCell(const double tau, Grid &arena_sweep,
+                          Thermo &thermo_sweep, SCGrid &arena_prev,
+                          SCGrid &arena_current, Cell_small &grid_f,
+                          U_derivative &u_derivative_helper,
+                          const int ix, const int iy, const int ieta,
+                          const int rk_flag) {
+    double eta_s_local = eta_grid_.get_eta(ieta);
+    double x_local     = - DATA.x_size  /2. +   ix*DATA.delta_x;
+    double y_local     = - DATA.y_size  /2. +   iy*DATA.delta_y;
+
+    FirstRKStepT<Config>(tau, x_local, y_local, eta_s_local,
+                         arena_sweep, thermo_sweep, arena_current, grid_f,
+                         arena_prev, ix, iy, ieta, rk_flag);
+
+    if ((Config & PhysicsConfig::kViscous) && DATA.u_derivative_rows == 1) {
+        const Cell_gradients &gradients = gradients_(ix, iy, ieta);
+        FirstRKStepW<Config>(
+                tau, arena_sweep, arena_prev, arena_current, grid_f,
+                rk_flag, gradients.theta, gradients.a, gradients.sigma,
+                gradients.omega, gradients.DmuMuBoverT, ieta, ix, iy);
+    } else if (Config & PhysicsConfig::kViscous) {
+        u_derivative_helper.MakedU(tau, arena_prev, arena_sweep,
+                                   ix, iy, ieta);
+        double theta_local = u_derivative_helper.calculate_expansion_rate(
+                                        tau, arena_current, ieta, ix, iy);
+        DumuVec a_local;
+        u_derivative_helper.calculate_Du_supmu(tau, arena_current,
+                                               ieta, ix, iy, a_local);
+
+        VelocityShearVec sigma_local;
+        u_derivative_helper.calculate_velocity_shear_tensor(
+                tau, arena_current, ieta, ix, iy, a_local, sigma_local);
+
+        VorticityVec omega_local;
+        u_derivative_helper.calculate_kinetic_vorticity_with_spatial_projector(
+                tau, arena_current, ieta, ix, iy, a_local, omega_local);
+
+        DmuMuBoverTVec baryon_diffusion_vector;
+        u_derivative_helper.get_DmuMuBoverTVec(baryon_diffusion_vector);
+
+        FirstRKStepW<Config>(
+                tau, arena_sweep, arena_prev, arena_current, grid_f,
+                rk_flag, theta_local, a_local, sigma_local, omega_local,
+                baryon_diffusion_vector, ieta, ix, iy);
+    }
+}
+
+
 /* %%%%%%%%%%%%%%%%%%%%%% First steps begins here %%%%%%%%%%%%%%%%%% */
+template<unsigned Config, class Grid, class Thermo>
 void Advance::FirstRKStepT(
         const double tau, const double x_local, const double y_local,
-        const double eta_s_local,
-        SCGrid &arena_current, SCGrid &arena_future, SCGrid &arena_prev,
+        const double eta_s_local, Grid &arena_sweep, Thermo &thermo_sweep,
+        SCGrid &arena_current, Cell_small &grid_f, SCGrid &arena_prev,
         const int ix, const int iy, const int ieta, const int rk_flag) {
     // this advances the ideal part
-    double tau_rk = tau + rk_flag*(DATA.delta_tau);
+    double tau_rk = (
+        tau + rk_scheme_.get_stage_tau_fraction(rk_flag)*(DATA.delta_tau));
 
     // Solve partial_a T^{a mu} = -partial_a W^{a mu}
     // Update T^{mu nu}
     // MakeDelatQI gets
-    //   qi = q0 if rk_flag = 0 or
-    //   qi = q0 + k1 if rk_flag = 1
+    //   qi = q_k, the state of the stage rk_flag = k
     // rhs[alpha] is what MakeDeltaQI outputs. 
     // It is the spatial derivative part of partial_a T^{a mu}
     // (including geometric terms)
     TJbVec qi = {0};
-    MakeDeltaQI(tau_rk, arena_current, ix, iy, ieta, qi, rk_flag);
+    MakeDeltaQI(tau_rk, arena_sweep, thermo_sweep, ix, iy, ieta, qi,
+                rk_flag);
 
     TJbVec qi_source = {0.0};
 
-    if (flag_add_hydro_source) {
-        EnergyFlowVec j_mu = {0};
-        FlowVec u_local = arena_current(ix,iy,ieta).u;
+    if (Config & PhysicsConfig::kSource) {
+        if (DATA.source_deposition == 1) {
+            qi_source = sources_(ix, iy, ieta);
+        } else {
+            EnergyFlowVec j_mu = {0};
+            FlowVec u_local = arena_current(ix,iy,ieta).u;
+
+            hydro_source_terms_ptr->get_hydro_energy_source(
+                        tau_rk, x_local, y_local, eta_s_local, u_local, j_mu);
+            for (int ii = 0; ii < 4; ii++) {
+                qi_source[ii] = tau_rk*j_mu[ii];
+            }
 
-        hydro_source_terms_ptr->get_hydro_energy_source(
-                    tau_rk, x_local, y_local, eta_s_local, u_local, j_mu);
+            if (DATA.turn_on_rhob == 1) {
+                qi_source[4] = (
+                    tau_rk*hydro_source_terms_ptr->get_hydro_rhob_source(
+                            tau_rk, x_local, y_local, eta_s_local, u_local));
+            }
+        }
         for (int ii = 0; ii < 4; ii++) {
-            qi_source[ii] = tau_rk*j_mu[ii];
             if (isnan(qi_source[ii])) {
                 music_message << "qi_source is nan. i = " << ii;
                 music_message.flush("error");
                 exit(0);
             }
         }
-
-        if (DATA.turn_on_rhob == 1) {
-            qi_source[4] = (
-                tau_rk*hydro_source_terms_ptr->get_hydro_rhob_source(
-                            tau_rk, x_local, y_local, eta_s_local, u_local));
-        }
     }
 
     // now MakeWSource returns partial_a W^{a mu}
     // (including geometric terms)
+    // (zero in ideal runs)
     TJbVec dwmn ={0.0};
-    diss_helper.MakeWSource(tau_rk, arena_current, arena_prev, ix, iy, ieta,
-                            dwmn);
+    if (Config & PhysicsConfig::kViscous) {
+        diss_helper.MakeWSource<
+            Config & (PhysicsConfig::kBulk | PhysicsConfig::kDiff)>(
+                tau_rk, arena_sweep, arena_prev, ix, iy, ieta, dwmn);
+    }
     for (int alpha = 0; alpha < 5; alpha++) {
         /* dwmn is the only one with the minus sign */
         qi[alpha] -= dwmn[alpha]*(DATA.delta_tau);
@@ -163,21 +832,27 @@ void Advance::FirstRKStepT(
         //        qi[alpha] = 0.;
         //}
 
-        /* if rk_flag > 0, we now have q0 + k1 + k2. 
-         * So add q0 and multiply by 1/2 */
-        qi[alpha] += rk_flag*get_TJb(arena_prev(ix,iy,ieta), alpha, 0)*tau;
-        qi[alpha] *= 1./(1. + rk_flag);
+        /* if rk_flag > 0, we now have q_k + dtau L(q_k). 
+         * So add q0 with the weights of the scheme (see rk_scheme.h) */
+        if (rk_flag > 0) {
+            qi[alpha] += (rk_scheme_.get_q0_ratio(rk_flag)
+                          *thermo_prev_(ix, iy, ieta).conserved[alpha]*tau);
+        }
+        qi[alpha] *= rk_scheme_.get_stage_weight(rk_flag);
     }
 
-    double tau_next = tau + DATA.delta_tau;
+    double tau_next = (
+        tau + rk_scheme_.get_output_tau_fraction(rk_flag)*DATA.delta_tau);
     auto grid_rk_t = reconst_helper.ReconstIt_shell(
                                 tau_next, qi, arena_current(ix, iy, ieta)); 
-    UpdateTJbRK(grid_rk_t, arena_future(ix, iy, ieta));
+    UpdateTJbRK(grid_rk_t, grid_f);
 }
 
 
-void Advance::FirstRKStepW(const double tau, SCGrid &arena_prev,
-                           SCGrid &arena_current, SCGrid &arena_future,
+template<unsigned Config, class Grid>
+void Advance::FirstRKStepW(const double tau, Grid &arena_sweep,
+                           SCGrid &arena_prev, SCGrid &arena_current,
+                           Cell_small &grid_f,
                            const int rk_flag, const double theta_local,
                            const DumuVec &a_local,
                            const VelocityShearVec &sigma_local,
@@ -187,9 +862,54 @@ void Advance::FirstRKStepW(const double tau, SCGrid &arena_prev,
 
     auto grid_pt_prev = &(arena_prev(ix, iy, ieta));
     auto grid_pt_c = &(arena_current(ix, iy, ieta));
-    auto grid_pt_f = &(arena_future(ix, iy, ieta));
-
-    const double tau_now  = tau + rk_flag*DATA.delta_tau;
+    auto grid_pt_f = &grid_f;
+
+    const double tau_now  = (
+        tau + rk_scheme_.get_stage_tau_fraction(rk_flag)*DATA.delta_tau);
+    const double q0_ratio = rk_scheme_.get_q0_ratio(rk_flag);
+    const double stage_weight = rk_scheme_.get_stage_weight(rk_flag);
+
+    // the KT right hand sides of all the currents in one stencil pass
+    DissRHS rhs;
+    diss_helper.Make_uWRHS_all<
+        Config & (PhysicsConfig::kShear | PhysicsConfig::kBulk
+                  | PhysicsConfig::kDiff)>(
+            tau_now, arena_sweep, ix, iy, ieta, theta_local, a_local, rhs);
+
+    // EOS quantities at which the source terms are evaluated
+    const Cell_thermo &thermo_source = (
+        rk_flag == 0 ? thermo_current_(ix, iy, ieta)
+                     : thermo_prev_(ix, iy, ieta));
+
+    // the largest eigenvalue of pi^mu_nu in the bulk relaxation time
+    const double lambda_max = (
+        DATA.causality_method == 2 ? (*lambdas_current_)(ix, iy, ieta)[2]
+                                   : 0.);
+
+    // the source terms of all the currents from one set of transport
+    // coefficients
+    DissSource source;
+    diss_helper.Make_uWSource_all<
+        Config & (PhysicsConfig::kShear | PhysicsConfig::kBulk
+                  | PhysicsConfig::kDiff)>(
+            tau_now, grid_pt_c, grid_pt_prev, thermo_source, lambda_max,
+            rk_flag,
+            theta_local, a_local, sigma_local, omega_local,
+            baryon_diffusion_vector, source);
+
+    // The stage value of a current X from the weighted sum of u^0 X.
+    // With implicit_relaxation the relaxation term -X/tau_X of the source
+    // is taken at the end of the stage instead of at its beginning,
+    // X_f (u^0_f + w delta_tau/tau_X) = sum + w delta_tau/tau_X X_c,
+    // which is stable for any tau_X and tends to the Navier-Stokes value
+    // for tau_X << delta_tau.
+    const bool implicit_relaxation = (DATA.implicit_relaxation == 1);
+    auto get_stage_value = [&](const double weighted_sum, const double X_c,
+                               const double relaxation_rate) {
+        if (!implicit_relaxation) return(weighted_sum/grid_pt_f->u[0]);
+        const double w_rate = stage_weight*DATA.delta_tau*relaxation_rate;
+        return((weighted_sum + w_rate*X_c)/(grid_pt_f->u[0] + w_rate));
+    };
 
     // Solve partial_a (u^a W^{mu nu}) = 0
     // Update W^{mu nu}
@@ -201,26 +921,20 @@ void Advance::FirstRKStepW(const double tau, SCGrid &arena_prev,
     // solve partial_tau (u^0 W^{kl}) = -partial_i (u^i W^{kl}
     /* Advance uWmunu */
     double tempf, temps;
-    if (DATA.turn_on_shear == 1) {
+    if (Config & PhysicsConfig::kShear) {
         for (int idx_1d = 4; idx_1d < 9; idx_1d++) {
-            double w_rhs = 0.;
-            int mu = 0;
-            int nu = 0;
-            map_1d_idx_to_2d(idx_1d, mu, nu);
-            diss_helper.Make_uWRHS(tau_now, arena_current, ix, iy, ieta,
-                                   mu, nu, w_rhs, theta_local, a_local);
-            tempf = (
-                  (1. - rk_flag)*(grid_pt_c->Wmunu[idx_1d]*grid_pt_c->u[0])
-                + rk_flag*(grid_pt_prev->Wmunu[idx_1d]*grid_pt_prev->u[0])
-            );
-            temps = diss_helper.Make_uWSource(
-                    tau_now, grid_pt_c, grid_pt_prev, mu, nu, rk_flag,
-                    theta_local, a_local, sigma_local, omega_local);
+            const double w_rhs = rhs.shear[idx_1d - 4];
+            tempf = (rk_flag == 0
+                ? grid_pt_c->Wmunu[idx_1d]*grid_pt_c->u[0]
+                : q0_ratio*(grid_pt_prev->Wmunu[idx_1d]*grid_pt_prev->u[0]));
+            temps = source.shear[idx_1d - 4];
             tempf += temps*(DATA.delta_tau);
             tempf += w_rhs;
-            tempf += rk_flag*((grid_pt_c->Wmunu[idx_1d])*(grid_pt_c->u[0]));
-            tempf *= 1./(1. + rk_flag);
-            grid_pt_f->Wmunu[idx_1d] = tempf/(grid_pt_f->u[0]);
+            if (rk_flag > 0)
+                tempf += (grid_pt_c->Wmunu[idx_1d])*(grid_pt_c->u[0]);
+            tempf *= stage_weight;
+            grid_pt_f->Wmunu[idx_1d] = get_stage_value(
+                tempf, grid_pt_c->Wmunu[idx_1d], source.shear_rate);
         }
     } else {
         for (int idx_1d = 4; idx_1d < 9; idx_1d++) {
@@ -228,44 +942,40 @@ void Advance::FirstRKStepW(const double tau, SCGrid &arena_prev,
         }
     }
 
-    if (DATA.turn_on_bulk == 1) {
-        double p_rhs;
-        diss_helper.Make_uPRHS(tau_now, arena_current, ix, iy, ieta,
-                               &p_rhs, theta_local);
-        tempf = ((1. - rk_flag)*(grid_pt_c->pi_b*grid_pt_c->u[0])
-                 + rk_flag*(grid_pt_prev->pi_b*grid_pt_prev->u[0]));
-        temps = diss_helper.Make_uPiSource(
-                tau_now, grid_pt_c, grid_pt_prev, rk_flag,
-                theta_local, sigma_local);
+    if (Config & PhysicsConfig::kBulk) {
+        const double p_rhs = rhs.bulk;
+        tempf = (rk_flag == 0
+                 ? grid_pt_c->pi_b*grid_pt_c->u[0]
+                 : q0_ratio*(grid_pt_prev->pi_b*grid_pt_prev->u[0]));
+        temps = source.bulk;
         tempf += temps*(DATA.delta_tau);
         tempf += p_rhs;
-        tempf += rk_flag*((grid_pt_c->pi_b)*(grid_pt_c->u[0]));
-        tempf *= 1./(1. + rk_flag);
-        grid_pt_f->pi_b = tempf/(grid_pt_f->u[0]);
+        if (rk_flag > 0)
+            tempf += (grid_pt_c->pi_b)*(grid_pt_c->u[0]);
+        tempf *= stage_weight;
+        grid_pt_f->pi_b = get_stage_value(tempf, grid_pt_c->pi_b,
+                                          source.bulk_rate);
     } else {
         grid_pt_f->pi_b = 0.0;
     }
 
     // CShen: add source term for baryon diffusion
-    if (DATA.turn_on_diff == 1) {
-        int mu = 4;
+    if (Config & PhysicsConfig::kDiff) {
         for (int idx_1d = 11; idx_1d < 14; idx_1d++) {
-            int nu = idx_1d - 10;
-            double w_rhs = diss_helper.Make_uqRHS(
-                        tau_now, arena_current, ix, iy, ieta, mu, nu);
-            tempf = ((1. - rk_flag)*(grid_pt_c->Wmunu[idx_1d]*grid_pt_c->u[0])
-                     + rk_flag*(grid_pt_prev->Wmunu[idx_1d]*grid_pt_prev->u[0]));
-            temps = diss_helper.Make_uqSource(
-                        tau_now, grid_pt_c, grid_pt_prev, nu, rk_flag,
-                        theta_local, a_local, sigma_local, omega_local,
-                        baryon_diffusion_vector);
+            const double w_rhs = rhs.diff[idx_1d - 11];
+            tempf = (rk_flag == 0
+                ? grid_pt_c->Wmunu[idx_1d]*grid_pt_c->u[0]
+                : q0_ratio*(grid_pt_prev->Wmunu[idx_1d]*grid_pt_prev->u[0]));
+            temps = source.diff[idx_1d - 11];
             tempf += temps*(DATA.delta_tau);
             tempf += w_rhs;
 
-            tempf += rk_flag*(grid_pt_c->Wmunu[idx_1d]*grid_pt_c->u[0]);
-            tempf *= 1./(1. + rk_flag);
+            if (rk_flag > 0)
+                tempf += grid_pt_c->Wmunu[idx_1d]*grid_pt_c->u[0];
+            tempf *= stage_weight;
 
-            grid_pt_f->Wmunu[idx_1d] = tempf/(grid_pt_f->u[0]);
+            grid_pt_f->Wmunu[idx_1d] = get_stage_value(
+                tempf, grid_pt_c->Wmunu[idx_1d], source.diff_rate);
         }
     } else {
         for (int idx_1d = 10; idx_1d < 14; idx_1d++) {
@@ -300,7 +1010,10 @@ void Advance::FirstRKStepW(const double tau, SCGrid &arena_prev,
         tempf += grid_pt_f->Wmunu[nu]*grid_pt_f->u[nu];
     grid_pt_f->Wmunu[0] = tempf/(grid_pt_f->u[0]);
 
-    solveEigenvaluesWmunu(grid_pt_f);
+    // the eigenvalues are only needed by the causality constraints
+    if (DATA.causality_method != 0) {
+        solveEigenvaluesWmunu(*grid_pt_f, (*lambdas_future_)(ix, iy, ieta));
+    }
 
     // make qmu[0] using transversality
     tempf = 0.0;
@@ -308,315 +1021,61 @@ void Advance::FirstRKStepW(const double tau, SCGrid &arena_prev,
         int idx_1d = map_2d_idx_to_1d(4, nu);
         tempf += grid_pt_f->Wmunu[idx_1d]*grid_pt_f->u[nu];
     }
-    grid_pt_f->Wmunu[10] = DATA.turn_on_diff*tempf/(grid_pt_f->u[0]);
+    grid_pt_f->Wmunu[10] = (
+        (Config & PhysicsConfig::kDiff) ? tempf/(grid_pt_f->u[0]) : 0.);
 
     // If the energy density of the fluid element is smaller than 0.01GeV
-    // reduce Wmunu using the QuestRevert algorithm
+    // reduce Wmunu using the QuestRevert algorithm. The causality
+    // constraints and then QuestRevert_qmu follow in enforce_causality.
     if (DATA.Initial_profile != 0 && DATA.Initial_profile != 1) {
         QuestRevert(tau, grid_pt_f, ieta, ix, iy);
-        if (DATA.causality_method == 1){
-            nCausalityConstraints(grid_pt_f, tau);
-        }else if (DATA.causality_method == 2){
-            sCausalityConstraints(grid_pt_f, tau);
-        }
-        if (DATA.turn_on_diff == 1) {
+        if ((Config & PhysicsConfig::kDiff)
+                && !causality_limiter_.is_enabled()) {
             QuestRevert_qmu(tau, grid_pt_f, ieta, ix, iy);
         }
     }
 }
-//Wmunu = 1d array
-void Advance::solveEigenvaluesWmunu(Cell_small *grid_pt) {
-
-    MatrixXd A = MatrixXd::Zero(4,4);
-
-    A(0,0) = - grid_pt->Wmunu[0];
-    A(0,1) = grid_pt->Wmunu[1];
-    A(0,2) = grid_pt->Wmunu[2];
-    A(0,3) = grid_pt->Wmunu[3];
-
-    A(1,0) = - grid_pt->Wmunu[1];
-    A(1,1) = grid_pt->Wmunu[4];
-    A(1,2) = grid_pt->Wmunu[5];
-    A(1,3) = grid_pt->Wmunu[6];
-
-    A(2,0) = - grid_pt->Wmunu[2];
-    A(2,1) = grid_pt->Wmunu[5];
-    A(2,2) = grid_pt->Wmunu[7];
-    A(2,3) = grid_pt->Wmunu[8];
-
-    A(3,0) = - grid_pt->Wmunu[3];
-    A(3,1) = grid_pt->Wmunu[6];
-    A(3,2) = grid_pt->Wmunu[8];
-    A(3,3) = grid_pt->Wmunu[9];
-
-    EigenSolver <MatrixXd> es;
-    es.compute(A, false);
-    
-    double min = es.eigenvalues().real()[0];
-    double max = min;
-
-    for (int i = 1; i < 4; i++){
-        double temp = es.eigenvalues().real()[i];
-        if (temp > max){
-            max = temp;
-        }else if (temp < min){
-            min = temp;
-        }
-    }
-    grid_pt->Lambdas[0] = min;
-    grid_pt->Lambdas[1] = - min - max;
-    grid_pt->Lambdas[2] = max;
-}
-
-//check causality first, if violated, calculate alpha and store them in an array. (alpha = 1 otherwise), pick the min alpha between 0 and 1
-void Advance::nCausalityConstraints(Cell_small *grid_pt, double tau){
-    double eps  = grid_pt->epsilon;
-    double rhob = grid_pt->rhob;
-    double cs2 = eos.get_cs2(eps, rhob);
-    double P = eos.get_pressure(eps, rhob);
-    double transportPart_n13 = 2. * 1./transport_coeffs_.get_shear_relax_time_factor();
-    double viscousPart1_n13 = transport_coeffs_.get_lambda_piPi_coeff();
-    double viscousPart2_n13 = - 1./2. * transport_coeffs_.get_tau_pipi_coeff();
-    double transportPart_n56 = cs2 + 4./3. * 1./transport_coeffs_.get_shear_relax_time_factor() + 1./transport_coeffs_.get_bulk_relax_time_factor() * (1./3. - cs2) * (1./3. - cs2);
-    double viscousPart1_n56 = 2./3.*transport_coeffs_.get_lambda_piPi_coeff() + transport_coeffs_.get_delta_PiPi_coeff() + cs2;
-    double viscousPart2_n56 = transport_coeffs_.get_delta_pipi_coeff() + 1./3.*transport_coeffs_.get_tau_pipi_coeff() + transport_coeffs_.get_lambda_Pipi_coeff() * (1./3.- cs2) + cs2;
-
-
-    double n1 = transportPart_n13 + viscousPart1_n13 * grid_pt->pi_b / (eps + P) + viscousPart2_n13 * abs(grid_pt->Lambdas[0]) / (eps + P);
-    double n3 = transportPart_n13 + viscousPart1_n13 * grid_pt->pi_b / (eps + P) + viscousPart2_n13 * grid_pt->Lambdas[2] / (eps + P);
-    double n5 = transportPart_n56 + viscousPart1_n56 * grid_pt->pi_b / (eps + P) + viscousPart2_n56 * grid_pt->Lambdas[0] / (eps + P);
-    double n6 = (1. - transportPart_n56) + (1. - viscousPart1_n56) * grid_pt->pi_b / (eps + P) + (1. - viscousPart2_n56) * grid_pt->Lambdas[2] / (eps + P);
-    std::vector<double> nCondition {n1, n3, n5, n6};
-
-    double minAlp = 1;
-
-    for (int i = 0; i < nCondition.size(); i++){
-        double alp = 1;
-        if (nCondition[i] < 0){
-            switch(i){
-                case 0: //n1
-                    alp = - transportPart_n13/(viscousPart1_n13 * grid_pt->pi_b / (eps + P) + viscousPart2_n13 * abs(grid_pt->Lambdas[0])/ (eps + P));
-                    break;
-                case 1: //n3
-                    alp = - transportPart_n13/(viscousPart1_n13 * grid_pt->pi_b / (eps + P) + viscousPart2_n13 * grid_pt->Lambdas[2] / (eps + P));
-                    break;
-                case 2: //n5
-                    alp = - transportPart_n56/(viscousPart1_n56 * grid_pt->pi_b / (eps + P) + viscousPart2_n56 * grid_pt->Lambdas[0] / (eps + P));
-                    break;
-                case 3: //n6
-                    alp = - (1. - transportPart_n56)/((1. - viscousPart1_n56) * grid_pt->pi_b / (eps + P) + (1. - viscousPart2_n56) * grid_pt->Lambdas[2] / (eps + P));
-                    break;
-            }
-        }
-        if (alp > 0 && alp < minAlp){
-            minAlp = alp;
-        }else if (alp < 0){
-            minAlp = 0;
-        } 
-    }
-
-    grid_pt->pi_b = grid_pt->pi_b * minAlp;
-
-    for (double& pi : grid_pt->Wmunu){
-        pi = pi * minAlp;
-    }
-    for (double& lam : grid_pt->Lambdas){
-        lam = lam * minAlp;
-    }
-
-    //write reduction factor and energy density into a file
-    if (eps > 0.01){
-    std::ofstream myFile("necessary_causality_reduction_factor_wtau.dat", std::fstream::out | std::fstream::app);
-    myFile << std::scientific << std::setw(18) << std::setprecision(8) 
-       << minAlp << "   " << eps << "   " << tau << std::endl;
-    myFile.close();
-    }
-    
-}
-
-bool Advance::BinarySearch(double left, double right, double (*func)(double, Cell_small*, void*), void* pt2object, double& result, Cell_small *grid_pt){
-    while(right - left > 1e-4){
-        if (right < left){
-            std::cout << "Upper beta bound is smaller than the lower beta bound" << std::endl;
-            return false;
-        }  
-        if (func(right, grid_pt, pt2object)*func(left, grid_pt, pt2object) > 0){
-            return false;
-        }    
-        result = (left + right) / 2.;
-        if (func(result, grid_pt, pt2object) < 0){
-            right = result;
-        }else{
-            left = result;
-        }
-    }
-    return true;
-}
-
-double Advance::Suff5(double beta, Cell_small *grid_pt){
-    double eps = grid_pt->epsilon;
-    double rhob = grid_pt->rhob;
-    double cs2 = eos.get_cs2(eps, rhob);
-    double P = eos.get_pressure(eps, rhob);
-    double L1 = grid_pt->Lambdas[0] / (eps + P);
-    double L3 = grid_pt->Lambdas[2] / (eps + P);
-    double Pi = grid_pt->pi_b / (eps + P);
-    double s_relax = 1./transport_coeffs_.get_shear_relax_time_factor();
-    double b_relax = 1./transport_coeffs_.get_bulk_relax_time_factor() * (1./3. - cs2) * (1./3. - cs2);
-    double lam_piPi = transport_coeffs_.get_lambda_piPi_coeff();
-    double tau_pipi = transport_coeffs_.get_tau_pipi_coeff();
-    double del_PiPi = transport_coeffs_.get_delta_PiPi_coeff();
-    double del_pipi = transport_coeffs_.get_delta_pipi_coeff();
-    double lam_Pipi = transport_coeffs_.get_lambda_Pipi_coeff();
-
-    return 1. - cs2 - 4./3.*s_relax - b_relax - beta*((cs2 - 1. + 2./3.*lam_piPi + del_PiPi)*Pi + (del_pipi + 1./3.*tau_pipi + lam_Pipi + cs2)*L3 + abs(L1)) 
-    - beta*beta*(del_pipi - 1./12.*tau_pipi)*(lam_Pipi + cs2 - 1./12.*tau_pipi)*(L3 + abs(L1))*(L3 + abs(L1))/(1. - s_relax + beta*((1. - 1./2.*lam_piPi)*Pi - abs(L1) - 1./2.*tau_pipi*L3));
-}
-double Advance::Suff7(double beta, Cell_small *grid_pt){
-    double eps = grid_pt->epsilon;
-    double rhob = grid_pt->rhob;
-    double cs2 = eos.get_cs2(eps, rhob);
-    double P = eos.get_pressure(eps, rhob);
-    double L1 = grid_pt->Lambdas[0] / (eps + P);
-    double L3 = grid_pt->Lambdas[2] / (eps + P);
-    double Pi = grid_pt->pi_b / (eps + P);
-    double s_relax = 1./transport_coeffs_.get_shear_relax_time_factor();
-    double b_relax = 1./transport_coeffs_.get_bulk_relax_time_factor() * (1./3. - cs2) * (1./3. - cs2);
-    double lam_piPi = transport_coeffs_.get_lambda_piPi_coeff();
-    double tau_pipi = transport_coeffs_.get_tau_pipi_coeff();
-    double del_PiPi = transport_coeffs_.get_delta_PiPi_coeff();
-    double del_pipi = transport_coeffs_.get_delta_pipi_coeff();
-    double lam_Pipi = transport_coeffs_.get_lambda_Pipi_coeff();
-
-    return (s_relax + beta*(1./2.*lam_piPi*Pi - 1./2.*tau_pipi*abs(L1)))*(s_relax + beta*(1./2.*lam_piPi*Pi - 1./2.*tau_pipi*abs(L1))) 
-    - beta*beta*(del_pipi - 1./12.*tau_pipi)*(lam_Pipi + cs2 - 1./12.*tau_pipi)*(L3 + abs(L1))*(L3 + abs(L1));
-}
-double Advance::Suff8(double beta, Cell_small *grid_pt){
-    double eps = grid_pt->epsilon;
-    double rhob = grid_pt->rhob;
-    double cs2 = eos.get_cs2(eps, rhob);
-    double P = eos.get_pressure(eps, rhob);
-    double L1 = grid_pt->Lambdas[0] / (eps + P);
-    double L2 = grid_pt->Lambdas[1] / (eps + P);
-    double L3 = grid_pt->Lambdas[2] / (eps + P);
-    double Pi = grid_pt->pi_b / (eps + P);
-    double s_relax = 1./transport_coeffs_.get_shear_relax_time_factor();
-    double b_relax = 1./transport_coeffs_.get_bulk_relax_time_factor() * (1./3. - cs2) * (1./3. - cs2);
-    double lam_piPi = transport_coeffs_.get_lambda_piPi_coeff();
-    double tau_pipi = transport_coeffs_.get_tau_pipi_coeff();
-    double del_PiPi = transport_coeffs_.get_delta_PiPi_coeff();
-    double del_pipi = transport_coeffs_.get_delta_pipi_coeff();
-    double lam_Pipi = transport_coeffs_.get_lambda_Pipi_coeff();
-
-    return 4./3.*s_relax + b_relax + cs2 + beta*((2./3.*lam_piPi + del_PiPi + cs2)*Pi - (del_pipi + 1./3.*tau_pipi - lam_Pipi + cs2)*abs(L1)) 
-    - (1. + beta*(Pi + L2))*(1. + beta*(Pi + L3))/3./(1. + beta*(Pi - abs(L1)))/(1. + beta*(Pi - abs(L1)))*(1. + 2.*s_relax + beta*((1. + lam_piPi)*Pi - abs(Pi) + tau_pipi*L3));
-}
-
-double Advance::Suff5_Hook(double beta, Cell_small *grid_pt, void* pt2object){
-    Advance* mySelf = (Advance*) pt2object;
-    return mySelf->Suff5(beta, grid_pt);
-}
-double Advance::Suff7_Hook(double beta, Cell_small *grid_pt, void* pt2object){
-    Advance* mySelf = (Advance*) pt2object;
-    return mySelf->Suff7(beta, grid_pt);
-}
-double Advance::Suff8_Hook(double beta, Cell_small *grid_pt, void* pt2object){
-    Advance* mySelf = (Advance*) pt2object;
-    return mySelf->Suff8(beta, grid_pt);
-}
-void Advance::sCausalityConstraints(Cell_small *grid_pt, double tau){
-    double eps = grid_pt->epsilon;
-    double rhob = grid_pt->rhob;
-    double cs2 = eos.get_cs2(eps, rhob);
-    double P = eos.get_pressure(eps, rhob);
-    double L1 = grid_pt->Lambdas[0] / (eps + P);
-    double L3 = grid_pt->Lambdas[2] / (eps + P);
-    double Pi = grid_pt->pi_b / (eps + P);
-    double s_relax = 1./transport_coeffs_.get_shear_relax_time_factor();
-    double b_relax = 1./transport_coeffs_.get_bulk_relax_time_factor() * (1./3. - cs2) * (1./3. - cs2);
-    double lam_piPi = transport_coeffs_.get_lambda_piPi_coeff();
-    double tau_pipi = transport_coeffs_.get_tau_pipi_coeff();
-    double del_PiPi = transport_coeffs_.get_delta_PiPi_coeff();
-    double del_pipi = transport_coeffs_.get_delta_pipi_coeff();
-    double lam_Pipi = transport_coeffs_.get_lambda_Pipi_coeff();
-
-    double s1 = 1. - s_relax - L1 + (1. - 1./2.*lam_piPi)*Pi - 1./2.*tau_pipi*L3; //>=0
-    double s2 = 2.*s_relax + lam_piPi*Pi - tau_pipi*abs(L1); //>=0 
-    double s6 = 1./3.*s_relax + b_relax + cs2 + (1./6.*lam_piPi + del_PiPi + cs2)*Pi + (1./6.*tau_pipi - del_pipi + lam_Pipi - cs2)*abs(L1);//>=0
-
-    std::vector<double> sCondition {s1, s2, s6};
-    double minBeta = 1;
-
-    for (int i = 0; i < sCondition.size(); i++){
-        double beta = 1;
-        if (sCondition[i] < 0){
-            switch(i){
-                case 0: //s1
-                    beta = (s_relax - 1.)/(-abs(L1) + (1. - 1./2.*lam_piPi)*Pi - 1./2.*tau_pipi*L3);
-                    break;
-                case 1: //s2
-                    beta = (-2.*s_relax)/(lam_piPi*Pi - tau_pipi*abs(L1));
-                    break;
-                case 2: //s6
-                    beta = -(1./3.*s_relax + b_relax + cs2)/((1./6.*lam_piPi + del_PiPi + cs2)*Pi + (1./6.*tau_pipi - del_pipi + lam_Pipi - cs2)*abs(L1));
-                    break;
-            }
-        }
-        if (beta > 0 && beta < minBeta){
-            minBeta = beta;
-        }else if (beta < 0){
-            minBeta = 0;
-        } 
-    }
-    if (Suff5(minBeta, grid_pt) < 0){
-        double result = 0;
-        Advance objA(eos, DATA, hydro_source_terms_ptr);
-        bool status = BinarySearch(0., minBeta, Advance::Suff5_Hook, (void*) &objA, result, grid_pt);
-        if (status){
-            minBeta = result;
-        }else if(cs2 < 0.15){
-            minBeta = 0.;
-        }else{
-            std::cout << "Suff5 Fails Binary Search" << std::endl;
-        }
-    }
-    if (Suff7(minBeta, grid_pt) < 0){
-        double result = 0;
-        Advance objB(eos, DATA, hydro_source_terms_ptr);
-        bool status = BinarySearch(0., minBeta, Advance::Suff7_Hook, (void*) &objB, result, grid_pt);
-        if (status){
-            minBeta = result;
-        }else{
-            std::cout << "Suff7 Fails Binary Search" << std::endl;
-        }
-    }
-    if (Suff8(minBeta, grid_pt) < 0){
-        double result = 0;
-        Advance objC(eos, DATA, hydro_source_terms_ptr);
-        bool status = BinarySearch(0., minBeta, Advance::Suff8_Hook, (void*) &objC, result, grid_pt);
-        if (status){
-            minBeta = result;
-        }else{
-            std::cout << "Suff8 Fails Binary Search" << std::endl;
+//! compute the minimum, middle, and maximum eigenvalues of pi^mu_nu
+//! and store them in lambdas
+void Advance::solveEigenvaluesWmunu(const Cell_small &grid_pt,
+                                    LambdaVec &lambdas) {
+    ScopedTimer timer(InstrumentedTimer::eigenvalues);
+    double min = 0.;
+    double max = 0.;
+    if (DATA.Wmunu_eigenvalue_solver == 0) {
+        // general 4x4 eigenvalue problem
+        auto min_max = WmunuEigenvalues::general4x4_min_max(
+                                            to_ViscousVec(grid_pt.Wmunu));
+        min = min_max[0];
+        max = min_max[1];
+    } else {
+        // symmetric 3x3 problem in the local rest frame, the fourth
+        // eigenvalue (along u^mu) is zero
+        auto pi_LRF = WmunuEigenvalues::get_LRF_spatial_part(
+                                grid_pt.u, to_ViscousVec(grid_pt.Wmunu));
+        std::array<double, 3> lambda;
+        if (DATA.Wmunu_eigenvalue_solver == 1) {
+            lambda = WmunuEigenvalues::symmetric3x3_analytic(pi_LRF);
+        } else {
+            lambda = WmunuEigenvalues::symmetric3x3_Eigen(pi_LRF);
         }
+        min = std::min(lambda[0], 0.);
+        max = std::max(lambda[2], 0.);
     }
-    grid_pt->pi_b = grid_pt->pi_b * minBeta;
-
-    for (double& pi : grid_pt->Wmunu){
-        pi = pi * minBeta;
-    }
-    for (double& lam : grid_pt->Lambdas){
-        lam = lam * minBeta;
-    }
-
-    //write reduction factor and energy density into a file
-    if (eps > 0.01){
-    std::ofstream myFile("sufficient_causality_reduction_factor_wtau.dat", std::fstream::out | std::fstream::app);
-    myFile << std::scientific << std::setw(18) << std::setprecision(8) 
-       << minBeta << "   " << eps << "   " << tau << std::endl;
-    myFile.close(); 
-    }
+    lambdas[0] = min;
+    lambdas[1] = - min - max;
+    lambdas[2] = max;
+}
 
+void Advance::enforce_causality(const double tau, SCGrid &arena_future,
+                                const ActiveRegion &region) {
+    const bool diffusion = (physics_config_ & PhysicsConfig::kDiff);
+    causality_limiter_.enforce_in_team(
+        tau, arena_future, *lambdas_future_, region,
+        [&](Cell_small &grid_pt, const int ix, const int iy,
+            const int ieta) {
+            if (diffusion) QuestRevert_qmu(tau, &grid_pt, ieta, ix, iy);
+        });
 }
 
 
@@ -672,18 +1131,23 @@ void Advance::QuestRevert(const double tau, Cell_small *grid_pt,
     // Reducing the shear stress tensor
     double rho_shear_max = 0.1;
     if (std::isnan(rho_shear)) {
+        Instrumentation::count(InstrumentedCounter::quest_revert_shear);
         for (int mu = 0; mu < 10; mu++) {
             grid_pt->Wmunu[mu] = 0.0;
         }
     } else if (rho_shear > rho_shear_max) {
         if (e_local > eps_scale && DATA.echo_level > 5) {
-            music_message << "ieta = " << ieta << ", ix = " << ix
-                          << ", iy = " << iy
-                          << ", energy density = " << e_local*hbarc
-                          << " GeV/fm^3, shear |pi/(epsilon+3*P)| = "
-                          << rho_shear;
-            music_message.flush("warning");
+            // a message of its own, music_message is shared by the threads
+            static LogSite site("Advance::QuestRevert shear");
+            pretty_ostream cell_message;
+            cell_message << "ieta = " << ieta << ", ix = " << ix
+                         << ", iy = " << iy
+                         << ", energy density = " << e_local*hbarc
+                         << " GeV/fm^3, shear |pi/(epsilon+3*P)| = "
+                         << rho_shear;
+            cell_message.flush("warning", site);
         }
+        Instrumentation::count(InstrumentedCounter::quest_revert_shear);
         for (int mu = 0; mu < 10; mu++) {
             grid_pt->Wmunu[mu] = (rho_shear_max/rho_shear)*grid_pt->Wmunu[mu];
         }
@@ -693,13 +1157,16 @@ void Advance::QuestRevert(const double tau, Cell_small *grid_pt,
     double rho_bulk_max = 0.1;
     if (rho_bulk > rho_bulk_max) {
         if (e_local > eps_scale && DATA.echo_level > 5) {
-            music_message << "ieta = " << ieta << ", ix = " << ix
-                          << ", iy = " << iy
-                          << ", energy density = " << e_local*hbarc
-                          << " GeV/fm^3, bulk |Pi/(epsilon+3*P)| = "
-                          << rho_bulk;
-            music_message.flush("warning");
+            static LogSite site("Advance::QuestRevert bulk");
+            pretty_ostream cell_message;
+            cell_message << "ieta = " << ieta << ", ix = " << ix
+                         << ", iy = " << iy
+                         << ", energy density = " << e_local*hbarc
+                         << " GeV/fm^3, bulk |Pi/(epsilon+3*P)| = "
+                         << rho_bulk;
+            cell_message.flush("warning", site);
         }
+        Instrumentation::count(InstrumentedCounter::quest_revert_bulk);
         grid_pt->pi_b = (rho_bulk_max/rho_bulk)*grid_pt->pi_b;
     }
 }
@@ -732,11 +1199,11 @@ void Advance::QuestRevert_qmu(const double tau, Cell_small *grid_pt,
     // first check the positivity of q^mu q_mu
     // (in the conversion of gmn = diag(-+++))
     if (q_size < 0.0) {
-        music_message << "Advance::QuestRevert_qmu: q^mu q_mu = " << q_size
-                      << " < 0!";
-        music_message.flush("warning");
-        music_message << "Reset it to zero!!!!";
-        music_message.flush("warning");
+        static LogSite site("Advance::QuestRevert_qmu q^mu q_mu < 0");
+        pretty_ostream cell_message;
+        cell_message << "Advance::QuestRevert_qmu: q^mu q_mu = " << q_size
+                     << " < 0! Reset it to zero!!!!";
+        cell_message.flush("warning", site);
         for (int i = 0; i < 4; i++) {
             int idx_1d = map_2d_idx_to_1d(4, i);
             grid_pt->Wmunu[idx_1d] = 0.0;
@@ -750,14 +1217,17 @@ void Advance::QuestRevert_qmu(const double tau, Cell_small *grid_pt,
     double rho_q_max = 0.1;
     if (rho_q > rho_q_max) {
         if (e_local > eps_scale && DATA.echo_level > 5) {
-            music_message << "ieta = " << ieta << ", ix = " << ix
-                          << ", iy = " << iy
-                          << ", energy density = " << e_local*hbarc
-                          << "GeV/fm^3"
-                          << ", rhob = " << rhob_local << "1/fm^3"
-                          << "-- diffusion |q/rhob| = " << rho_q;
-            music_message.flush("warning");
+            static LogSite site("Advance::QuestRevert_qmu diffusion");
+            pretty_ostream cell_message;
+            cell_message << "ieta = " << ieta << ", ix = " << ix
+                         << ", iy = " << iy
+                         << ", energy density = " << e_local*hbarc
+                         << "GeV/fm^3"
+                         << ", rhob = " << rhob_local << "1/fm^3"
+                         << "-- diffusion |q/rhob| = " << rho_q;
+            cell_message.flush("warning", site);
         }
+        Instrumentation::count(InstrumentedCounter::quest_revert_diffusion);
         for (int i = 0; i < 4; i++) {
             grid_pt->Wmunu[10+i] = (rho_q_max/rho_q)*q_mu_local[i];
         }
@@ -767,104 +1237,218 @@ void Advance::QuestRevert_qmu(const double tau, Cell_small *grid_pt,
 
 //! This function computes the rhs array. It computes the spatial
 //! derivatives of T^\mu\nu using the KT algorithm
-void Advance::MakeDeltaQI(const double tau, SCGrid &arena_current,
-                          const int ix, const int iy, const int ieta,
+template<class Grid, class Thermo>
+void Advance::MakeDeltaQI(const double tau, Grid &arena_current,
+                          Thermo &thermo_current, const int ix, const int iy, const int ieta,
                           TJbVec &qi, const int rk_flag) {
-    const double delta[4]   = {0.0, DATA.delta_x, DATA.delta_y, DATA.delta_eta};
-    const double tau_fac[4] = {0.0, tau, tau, 1.0};
-
+    ScopedTimer timer(InstrumentedTimer::make_delta_qi);
+    // the flux differences in eta over the width of the cell
+    const double delta[4]   = {0.0, DATA.delta_x, DATA.delta_y,
+                               eta_grid_.get_width(ieta)};
+
+    // the reconstruction guess needs the full cell, the conserved
+    // densities of the neighbours come from the EOS cache
+    const Cell_small &grid_c = arena_current(ix, iy, ieta);
+    const Cell_thermo &thermo_c = thermo_current(ix, iy, ieta);
+    const double pressure_c = thermo_c.pressure;
     for (int alpha = 0; alpha < 5; alpha++) {
-        qi[alpha] = get_TJb(arena_current(ix, iy, ieta), alpha, 0)*tau;
+        qi[alpha] = thermo_c.conserved[alpha]*tau;
     }
 
-    TJbVec qiphL   = {0.};
-    TJbVec qiphR   = {0.};
-    TJbVec qimhL   = {0.};
-    TJbVec qimhR   = {0.};
+    // boost-invariant runs have a single eta slice without eta fluxes
+    const int n_directions = DATA.boost_invariant ? 2 : 3;
 
     TJbVec rhs     = {0.};
     EnergyFlowVec T_eta_m = {0.};
     EnergyFlowVec T_eta_p = {0.};
-    Neighbourloop(arena_current, ix, iy, ieta, NLAMBDAS{
+    auto add_fluxes = [&](const int direction, const TJbVec &Fiph,
+                          const TJbVec &Fimh) {
         for (int alpha = 0; alpha < 5; alpha++) {
-            const double gphL = qi[alpha];
-            const double gphR = tau*get_TJb(p1, alpha, 0);
-            const double gmhL = tau*get_TJb(m1, alpha, 0);
-            const double gmhR = qi[alpha];
-            const double fphL =  0.5*minmod.minmod_dx(gphR, qi[alpha], gmhL);
-            const double fphR = -0.5*minmod.minmod_dx(
-                                tau*get_TJb(p2, alpha, 0), gphR, qi[alpha]);
-            const double fmhL =  0.5*minmod.minmod_dx(
-                                qi[alpha], gmhL, tau*get_TJb(m2, alpha, 0));
-            const double fmhR = -fphL;
-            qiphL[alpha] = gphL + fphL;
-            qiphR[alpha] = gphR + fphR;
-            qimhL[alpha] = gmhL + fmhL;
-            qimhR[alpha] = gmhR + fmhR;
-        }
-
-        // for each direction, reconstruct half-way cells
-        // reconstruct e, rhob, and u[4] for half way cells
-        auto grid_phL = reconst_helper.ReconstIt_shell(tau, qiphL, c);
-        auto grid_phR = reconst_helper.ReconstIt_shell(tau, qiphR, c);
-        auto grid_mhL = reconst_helper.ReconstIt_shell(tau, qimhL, c);
-        auto grid_mhR = reconst_helper.ReconstIt_shell(tau, qimhR, c);
-
-        double aiphL = MaxSpeed(tau, direction, grid_phL);
-        double aiphR = MaxSpeed(tau, direction, grid_phR);
-        double aimhL = MaxSpeed(tau, direction, grid_mhL);
-        double aimhR = MaxSpeed(tau, direction, grid_mhR);
-
-        double aiph = std::max(aiphL, aiphR);
-        double aimh = std::max(aimhL, aimhR);
-
-        for (int alpha = 0; alpha < 5; alpha++) {
-            double FiphL = get_TJb(grid_phL, 0, alpha, direction)*tau_fac[direction];
-            double FiphR = get_TJb(grid_phR, 0, alpha, direction)*tau_fac[direction];
-            double FimhL = get_TJb(grid_mhL, 0, alpha, direction)*tau_fac[direction];
-            double FimhR = get_TJb(grid_mhR, 0, alpha, direction)*tau_fac[direction];
-
-            // KT: H_{j+1/2} = (f(u^+_{j+1/2}) + f(u^-_{j+1/2})/2
-            //                  - a_{j+1/2}(u_{j+1/2}^+ - u^-_{j+1/2})/2
-            double Fiph = 0.5*((FiphL + FiphR)
-                               - aiph*(qiphR[alpha] - qiphL[alpha]));
-            double Fimh = 0.5*((FimhL + FimhR)
-                               - aimh*(qimhR[alpha] - qimhL[alpha]));
             if (direction == 3 && (alpha == 0 || alpha == 3)) {
-                T_eta_m[alpha] = Fimh;
-                T_eta_p[alpha] = Fiph;
+                T_eta_m[alpha] = Fimh[alpha];
+                T_eta_p[alpha] = Fiph[alpha];
             } else {
-                double DFmmp = (Fimh - Fiph)/delta[direction];
+                double DFmmp = (Fimh[alpha] - Fiph[alpha])/delta[direction];
                 rhs[alpha] += DFmmp*(DATA.delta_tau);
             }
         }
-    });
+    };
+
+    if (DATA.face_flux == 1) {
+        // the fluxes were computed by compute_face_fluxes
+        const int ix_p[3]   = {ix + 1, ix,     ix    };
+        const int iy_p[3]   = {iy,     iy + 1, iy    };
+        const int ieta_p[3] = {ieta,   ieta,   ieta + 1};
+        for (int direction = 1; direction <= n_directions; direction++) {
+            const FaceFluxGrid &faces = face_fluxes_[direction - 1];
+            add_fluxes(direction,
+                       faces(ix_p[direction - 1], iy_p[direction - 1],
+                             ieta_p[direction - 1]),
+                       faces(ix, iy, ieta));
+        }
+    } else {
+        // the half-way cells phL, phR, mhL, mhR of every direction
+        TJbVec q_half[3][4];
+        ReconstCell grid_half[3][4];
+
+        const auto reconstruct_halves = NLAMBDAS_THERMO_GENERIC{
+            TJbVec &qiphL = q_half[direction - 1][0];
+            TJbVec &qiphR = q_half[direction - 1][1];
+            TJbVec &qimhL = q_half[direction - 1][2];
+            TJbVec &qimhR = q_half[direction - 1][3];
+            for (int alpha = 0; alpha < 5; alpha++) {
+                const double gphL = qi[alpha];
+                const double gphR = tau*tp1.conserved[alpha];
+                const double gmhL = tau*tm1.conserved[alpha];
+                const double gmhR = qi[alpha];
+                const double fphL =  0.5*minmod.minmod_dx(gphR, qi[alpha], gmhL);
+                const double fphR = -0.5*minmod.minmod_dx(
+                        tau*tp2.conserved[alpha], gphR, qi[alpha]);
+                const double fmhL =  0.5*minmod.minmod_dx(
+                        qi[alpha], gmhL, tau*tm2.conserved[alpha]);
+                const double fmhR = -fphL;
+                qiphL[alpha] = gphL + fphL;
+                qiphR[alpha] = gphR + fphR;
+                qimhL[alpha] = gmhL + fmhL;
+                qimhR[alpha] = gmhR + fmhR;
+            }
+        };
+        if (DATA.boost_invariant) {
+            Neighbourloop2D(arena_current, thermo_current, ix, iy, ieta,
+                            reconstruct_halves);
+        } else {
+            Neighbourloop(arena_current, thermo_current, ix, iy, ieta,
+                          reconstruct_halves);
+        }
 
-    // add longitudinal flux with discretized geometric terms
-    double cosh_deta = cosh(delta[3]/2.)/std::max(delta[3], Util::small_eps);
-    double sinh_deta = sinh(delta[3]/2.)/std::max(delta[3], Util::small_eps);
-    sinh_deta = std::max(0.5, sinh_deta);
-    if (DATA.boost_invariant) {
-        // if the simulation is boost-invariant,
-        // we directly use the limiting value at \Delta eta = 0
-        // Longitudinal derivatives should be 0, we set cosh_eta = 0 here
-        cosh_deta = 0.0;
-        sinh_deta = 0.5;
+        // reconstruct e, rhob, and u[4] for all the half way cells
+        if (DATA.reconst_batch == 1) {
+            reconst_helper.ReconstIt_batch(tau, 4*n_directions,
+                                           &q_half[0][0], grid_c,
+                                           &grid_half[0][0]);
+        } else {
+            for (int i = 0; i < n_directions; i++) {
+                for (int j = 0; j < 4; j++) {
+                    grid_half[i][j] = reconst_helper.ReconstIt_shell(
+                                                    tau, q_half[i][j], grid_c);
+                }
+            }
+        }
+
+        for (int direction = 1; direction <= n_directions; direction++) {
+            const TJbVec *q_d = q_half[direction - 1];
+            const ReconstCell *grid_d = grid_half[direction - 1];
+            TJbVec Fiph, Fimh;
+            get_KT_flux(tau, direction, q_d[0], q_d[1], grid_d[0], grid_d[1],
+                        Fiph);
+            get_KT_flux(tau, direction, q_d[2], q_d[3], grid_d[2], grid_d[3],
+                        Fimh);
+            add_fluxes(direction, Fiph, Fimh);
+        }
     }
-    rhs[0] += ((  (T_eta_m[0] - T_eta_p[0])*cosh_deta
-                - (T_eta_m[3] + T_eta_p[3])*sinh_deta)*DATA.delta_tau);
-    rhs[3] += ((  (T_eta_m[3] - T_eta_p[3])*cosh_deta
-                - (T_eta_m[0] + T_eta_p[0])*sinh_deta)*DATA.delta_tau);
 
-    // geometric terms
-    //rhs[0] -= get_TJb(arena_current(ix, iy, ieta), 3, 3)*DATA.delta_tau;
-    //rhs[3] -= get_TJb(arena_current(ix, iy, ieta), 3, 0)*DATA.delta_tau;
+    if (DATA.boost_invariant) {
+        // the geometric terms of the Bjorken expansion, the limiting value
+        // of the longitudinal fluxes below at \Delta eta = 0 with
+        // T^{eta mu} of the cell on both eta faces
+        rhs[0] -= get_TJb(grid_c, pressure_c, 3, 3)*DATA.delta_tau;
+        rhs[3] -= get_TJb(grid_c, pressure_c, 0, 3)*DATA.delta_tau;
+    } else if (!eta_grid_.is_uniform()) {
+        // the geometric terms of each face from its distance to the cell
+        const double d_m = eta_grid_.get_face_distance_minus(ieta);
+        const double d_p = eta_grid_.get_face_distance_plus(ieta);
+        const double cosh_m = cosh(d_m)/delta[3];
+        const double cosh_p = cosh(d_p)/delta[3];
+        const double sinh_m = sinh(d_m)/delta[3];
+        const double sinh_p = sinh(d_p)/delta[3];
+        rhs[0] += ((  T_eta_m[0]*cosh_m - T_eta_p[0]*cosh_p
+                    - T_eta_m[3]*sinh_m - T_eta_p[3]*sinh_p)*DATA.delta_tau);
+        rhs[3] += ((  T_eta_m[3]*cosh_m - T_eta_p[3]*cosh_p
+                    - T_eta_m[0]*sinh_m - T_eta_p[0]*sinh_p)*DATA.delta_tau);
+    } else {
+        // add longitudinal flux with discretized geometric terms
+        const double cosh_deta = (cosh(delta[3]/2.)
+                                  /std::max(delta[3], Util::small_eps));
+        const double sinh_deta = std::max(
+            0.5, sinh(delta[3]/2.)/std::max(delta[3], Util::small_eps));
+        rhs[0] += ((  (T_eta_m[0] - T_eta_p[0])*cosh_deta
+                    - (T_eta_m[3] + T_eta_p[3])*sinh_deta)*DATA.delta_tau);
+        rhs[3] += ((  (T_eta_m[3] - T_eta_p[3])*cosh_deta
+                    - (T_eta_m[0] + T_eta_p[0])*sinh_deta)*DATA.delta_tau);
+    }
 
     for (int i = 0; i < 5; i++) {
         qi[i] += rhs[i];
     }
 }
 
+// the stage kernel is compiled for all the sweep grid layouts
+// and for the local stencil of the fused stage kernel
+// (AdvanceCell is instantiated by the tables of get_advance_cell_kernel)
+#define INSTANTIATE_ADVANCE_CELL(Grid, Thermo)                             \
+template void Advance::MakeDeltaQI<Grid, Thermo>(                         \
+    const double, Grid&, Thermo&, const int, const int, const int,        \
+    TJbVec&, const int);
+
+INSTANTIATE_ADVANCE_CELL(SCGrid, ThermoGrid)
+INSTANTIATE_ADVANCE_CELL(PaddedSCGrid, PaddedThermoGrid)
+INSTANTIATE_ADVANCE_CELL(SCGridSoA, ThermoGrid)
+INSTANTIATE_ADVANCE_CELL(SCStencil, ThermoStencil)
+#undef INSTANTIATE_ADVANCE_CELL
+
+//! this function returns the largest signal rate of the cells in
+//! active_region for the adaptive time step. It uses the cells instead of
+//! the half-way cells of the KT fluxes, which lie between the cells and
+//! their neighbours; the Courant number of the step leaves the margin.
+double Advance::get_max_signal_rate(const double tau, const SCGrid &arena,
+                                    const ActiveRegion &active_region) {
+    const int grid_neta = arena.nEta();
+    const int grid_nx   = arena.nX();
+    const int grid_ny   = arena.nY();
+    // no fluxes in eta on a single slice
+    const int n_directions = (grid_neta > 1 ? 3 : 2);
+
+    double rate_max = 0.;
+    #pragma omp parallel for collapse(3) reduction(max:rate_max)
+    for (int ieta = 0; ieta < grid_neta; ieta++)
+    for (int ix   = 0; ix   < grid_nx;   ix++  )
+    for (int iy   = 0; iy   < grid_ny;   iy++  ) {
+        if (!active_region.is_active(ix, iy, ieta)) continue;
+        const Cell_small &grid_pt = arena(ix, iy, ieta);
+        ReconstCell grid_p;
+        grid_p.e    = grid_pt.epsilon;
+        grid_p.rhob = grid_pt.rhob;
+        grid_p.u    = grid_pt.u;
+        const double delta[4] = {0.0, DATA.delta_x, DATA.delta_y,
+                                 eta_grid_.get_width(ieta)};
+        double rate = 0.;
+        for (int direction = 1; direction <= n_directions; direction++) {
+            rate += MaxSpeed(tau, direction, grid_p)/delta[direction];
+        }
+        rate_max = std::max(rate_max, rate);
+    }
+    return(rate_max);
+}
+
+
+//! KT: H_{j+1/2} = (f(u^+_{j+1/2}) + f(u^-_{j+1/2})/2
+//!                  - a_{j+1/2}(u_{j+1/2}^+ - u^-_{j+1/2})/2
+void Advance::get_KT_flux(const double tau, const int direction,
+                          const TJbVec &q_L, const TJbVec &q_R,
+                          const ReconstCell &grid_L,
+                          const ReconstCell &grid_R, TJbVec &flux) {
+    const double tau_fac[4] = {0.0, tau, tau, 1.0};
+    const double a_L = MaxSpeed(tau, direction, grid_L);
+    const double a_R = MaxSpeed(tau, direction, grid_R);
+    const double a   = std::max(a_L, a_R);
+    for (int alpha = 0; alpha < 5; alpha++) {
+        const double F_L = get_TJb(grid_L, 0, alpha, direction)*tau_fac[direction];
+        const double F_R = get_TJb(grid_R, 0, alpha, direction)*tau_fac[direction];
+        flux[alpha] = 0.5*((F_L + F_R) - a*(q_R[alpha] - q_L[alpha]));
+    }
+}
+
+
 // determine the maximum signal propagation speed at the given direction
 double Advance::MaxSpeed(const double tau, const int direc,
                          const ReconstCell &grid_p) {
@@ -891,18 +1475,16 @@ double Advance::MaxSpeed(const double tau, const int direc,
             num = (sqrt(-(h*dpde*h*(dpde*(-1.0 + ut2mux2) - ut2mux2)))
                    - h*(-1.0 + dpde)*utau*ux);
         } else {
-          fprintf(stderr,"WARNING: in MaxSpeed. \n");
-          fprintf(stderr, "Expression under sqrt in num=%lf. \n", num_temp_sqrt);
-          fprintf(stderr,"at value e=%lf. \n",eps);
-          fprintf(stderr,"at value p=%lf. \n",p);
-          fprintf(stderr,"at value h=%lf. \n",h);
-          fprintf(stderr,"at value rhob=%lf. \n",rhob);
-          fprintf(stderr,"at value utau=%lf. \n", utau);
-          fprintf(stderr,"at value uk=%lf. \n", ux);
-          fprintf(stderr,"at value vs^2=%lf. \n", vs2);
-          fprintf(stderr,"at value dpde=%lf. \n", eos.get_dpde(eps, rhob));
-          fprintf(stderr,"at value dpdrhob=%lf. \n", eos.get_dpdrhob(eps, rhob));
-          fprintf(stderr, "MaxSpeed: exiting.\n");
+          pretty_ostream cell_message;
+          cell_message << "MaxSpeed: expression under sqrt in num = "
+                       << num_temp_sqrt << " at e = " << eps
+                       << ", p = " << p << ", h = " << h
+                       << ", rhob = " << rhob << ", utau = " << utau
+                       << ", uk = " << ux << ", vs^2 = " << vs2
+                       << ", dpde = " << dpde
+                       << ", dpdrhob = " << eos.get_dpdrhob(eps, rhob)
+                       << ". Exiting.";
+          cell_message.flush("error");
           exit(1);
         }
     }
@@ -910,26 +1492,30 @@ double Advance::MaxSpeed(const double tau, const int direc,
     double f = num/std::max(den, Util::small_eps);
     // check for problems
     if (f < 0.0) {
-        fprintf(stderr, "SpeedMax = %e\n is negative.\n", f);
-        fprintf(stderr, "Can't happen.\n");
+        pretty_ostream cell_message;
+        cell_message << "SpeedMax = " << f << " is negative. Can't happen.";
+        cell_message.flush("error");
         exit(0);
     } else if (f <  ux/utau) {
         if (num != 0.0) {
             if (fabs(f-ux/utau)<0.0001) {
                 f = ux/utau;
             } else {
-                fprintf(stderr, "SpeedMax-v = %lf\n", f-ux/utau);
-                fprintf(stderr, "SpeedMax = %e\n is smaller than v = %e.\n", f, ux/utau);
-                fprintf(stderr, "Can't happen.\n");
+                pretty_ostream cell_message;
+                cell_message << "SpeedMax = " << f
+                             << " is smaller than v = " << ux/utau
+                             << ", SpeedMax-v = " << f - ux/utau
+                             << ". Can't happen.";
+                cell_message.flush("error");
                 exit(0);
             }
         }
     } else if (f > 1.0) {
-        fprintf(stderr, "SpeedMax = %e\n is bigger than 1.\n", f);
-        fprintf(stderr, "Can't happen.\n");
-        fprintf(stderr, "SpeedMax = num/den, num = %e, den = %e \n", num, den);
-        fprintf(stderr, "cs2 = %e \n", vs2);
-        f =1.;
+        pretty_ostream cell_message;
+        cell_message << "SpeedMax = " << f << " is bigger than 1. "
+                     << "Can't happen. SpeedMax = num/den, num = " << num
+                     << ", den = " << den << ", cs2 = " << vs2;
+        cell_message.flush("error");
         exit(1);
     }
     f *= g[direc-1];
@@ -963,26 +1549,7 @@ double Advance::get_TJb(const ReconstCell &grid_p, const int rk_flag,
 }
 
 double Advance::get_TJb(const Cell_small &grid_p, const int mu, const int nu) {
-    assert(mu < 5); assert(mu > -1);
-    assert(nu < 4); assert(nu > -1);
-    double rhob = grid_p.rhob;
-    const double u_nu = grid_p.u[nu];
-    if (mu == 4) {
-        return rhob*u_nu;
-    }
-    double e = grid_p.epsilon;
-    double gfac = 0.0;
-    double u_mu = 0.0;
-    if (mu == nu) {
-        u_mu = u_nu;
-        gfac = 1.0;
-        if (mu == 0) {
-            gfac = -1.0;
-        }
-    } else {
-        u_mu = grid_p.u[mu];
-    }
-    const double pressure = eos.get_pressure(e, rhob);
-    const double T_munu   = (e + pressure)*u_mu*u_nu + pressure*gfac;
-    return(T_munu);
+    const double pressure = (mu == 4 ? 0. : eos.get_pressure(grid_p.epsilon,
+                                                             grid_p.rhob));
+    return(get_TJb(grid_p, pressure, mu, nu));
 }
@@ -2,49 +2,285 @@
 #ifndef SRC_ADVANCE_H_
 #define SRC_ADVANCE_H_
 
+#include <cassert>
+#include <map>
 #include <memory>
+#include <utility>
+#include <vector>
 #include "data.h"
 #include "cell.h"
 #include "grid.h"
+#include "active_region.h"
+#include "sweep_grid.h"
 #include "dissipative.h"
 #include "minmod.h"
+#include "eta_grid.h"
 #include "u_derivative.h"
+#include "u_derivative_rows.h"
 #include "reconst.h"
+#include "rk_scheme.h"
+#include "physics_config.h"
 #include "hydro_source_base.h"
 #include "transport_coeffs.h"
 #include "pretty_ostream.h"
+#include "causality_diagnostics.h"
+#include "causality_limiter.h"
+#include "domain_decomposition.h"
+#include "checkpoint.h"
+#include "tile_scheduler.h"
+#ifdef MUSIC_OFFLOAD
+    #include "thermo_offload.h"
+#endif
 
 class Advance {
  private:
     const InitData &DATA;
     const EOS &eos;
     TransportCoeffs transport_coeffs_;
+    CausalityLimiter causality_limiter_;
 
     std::shared_ptr<HydroSourceBase> hydro_source_terms_ptr;
 
     Diss diss_helper;
     Minmod minmod;
+    EtaGrid eta_grid_;
     Reconst reconst_helper;
+    RKScheme rk_scheme_;
     pretty_ostream music_message;
 
     bool flag_add_hydro_source;
+    //! the PhysicsConfig of the run, which selects the AdvanceCell kernel
+    unsigned physics_config_;
+
+    //! the slabs of a distributed run (nullptr: the whole grid is local)
+    std::shared_ptr<DomainDecomposition> domain_ptr_;
+
+    //! EOS quantities of arena_current and arena_prev,
+    //! updated at the beginning of every Runge-Kutta stage
+    SweepThermoGrid thermo_current_;
+    SweepThermoGrid thermo_prev_;
+    const SCGrid *thermo_current_src_ = nullptr;
+    const SCGrid *thermo_prev_src_ = nullptr;
+    //! the caches refilled in the current stage from the arenas
+    const SCGrid *thermo_fill_src_[2] = {nullptr, nullptr};
+    SweepThermoGrid *thermo_fill_dst_[2] = {nullptr, nullptr};
+    int n_thermo_fills_ = 0;
+#ifdef MUSIC_OFFLOAD
+    //! the EOS lookups of the thermo cache on the offload device, with
+    //! the energy and baryon densities and the results of a whole grid
+    std::unique_ptr<ThermoOffload> thermo_offload_;
+    std::vector<double> offload_e_, offload_rhob_;
+    std::vector<ThermoState> offload_thermo_;
+    std::vector<char> offload_in_tables_;
+#endif
+
+    //! the eigenvalues of pi^mu_nu of the cells of the arenas, which only
+    //! the causality constraints use (causality_method > 0). A grid
+    //! belongs to the arena lambda_src_ points to, and follows it when
+    //! evolve.cpp rotates the arenas between the stages.
+    LambdaGrid lambdas_[3];
+    const SCGrid *lambda_src_[3] = {nullptr, nullptr, nullptr};
+    LambdaGrid *lambdas_current_ = nullptr;
+    LambdaGrid *lambdas_future_ = nullptr;
+
+    //! arena_current as read by the stencil sweeps of the current stage
+    //! (see sweep_grid.h)
+    SweepGrid *sweep_current_ = nullptr;
+#if defined(MUSIC_PADDED_SWEEPS) || defined(MUSIC_SOA_SWEEPS)
+    SweepGrid sweep_copy_;
+#endif
+
+    //! KT fluxes of the ideal part through the faces of the current
+    //! stage (face_flux = 1). face_fluxes_[d - 1](ix, iy, ieta) is the
+    //! face on the minus side of the cell (ix, iy, ieta) in direction d,
+    //! so each grid has one more layer of faces than cells in d.
+    FaceFluxGrid face_fluxes_[3];
+
+    //! the schedulers of the tiles of the sweeps (grid_traversal = 3), by
+    //! the eta layers [eta_min, eta_max) of the sweep, and the one of the
+    //! current sweep
+    std::map<std::pair<int, int>, TileScheduler> tile_schedulers_;
+    TileScheduler *tile_scheduler_ = nullptr;
+
+    //! the source terms tau*(J^mu, rho_B) of the current stage
+    //! (source_deposition = 1), allocated once and refilled every stage
+    SourceGrid sources_;
+
+    //! the velocity gradients of the cells of the current stage
+    //! (u_derivative_rows = 1), computed a row at a time before the sweep
+    GradientGrid gradients_;
 
  public:
     Advance(const EOS &eosIn, const InitData &DATA_in,
             std::shared_ptr<HydroSourceBase> hydro_source_ptr_in);
 
+    //! set the sink for the causality reduction factors
+    //! (no output if it is not set)
+    void set_causality_diagnostics(
+            std::shared_ptr<CausalityDiagnostics> diagnostics_ptr_in) {
+        causality_limiter_.set_causality_diagnostics(diagnostics_ptr_in);
+    }
+
+    //! set the aggregator of the causality reduction factors
+    void set_causality_statistics(
+            std::shared_ptr<CausalityStatistics> statistics_ptr_in) {
+        causality_limiter_.set_causality_statistics(statistics_ptr_in);
+    }
+
+    //! set the slabs of a distributed run, the halo layers of
+    //! arena_future are exchanged at the end of every AdvanceIt
+    void set_domain_decomposition(
+            std::shared_ptr<DomainDecomposition> domain_ptr_in) {
+        domain_ptr_ = domain_ptr_in;
+    }
+
+    //! largest sum over the directions of the signal speed over the cell
+    //! size in active_region, dtau times it is the Courant number
+    double get_max_signal_rate(const double tau, const SCGrid &arena,
+                               const ActiveRegion &active_region);
+
+    //! prints the iteration counts of the half-way cell reconstruction
+    void print_reconst_statistics() {
+        reconst_helper.print_iteration_histogram();
+    }
+
+    void resize_thermo_cache(const SCGrid &arena, SweepThermoGrid &thermo);
+    void fill_thermo_cache(const SCGrid &arena, SweepThermoGrid &thermo);
+    void fill_thermo_caches();
+    void refill_thermo_caches();
+#ifdef MUSIC_OFFLOAD
+    void fill_thermo_cache_offload(const SCGrid &arena,
+                                   SweepThermoGrid &thermo);
+#endif
+    void update_thermo_cache(const SCGrid &arena_prev,
+                             const SCGrid &arena_current, const int rk_flag);
+    void update_sweep_grid(SCGrid &arena_current);
+
+    //! points lambdas_current_ and lambdas_future_ to the grids of the
+    //! arenas, an arena without a grid gets one with zero eigenvalues
+    void update_lambda_grids(const SCGrid &arena_prev,
+                             const SCGrid &arena_current,
+                             const SCGrid &arena_future);
+
+    //! the eigenvalues of pi^mu_nu of the arenas (causality_method > 0)
+    void write_checkpoint(CheckpointWriter &checkpoint,
+                          const SCGrid &arena_prev,
+                          const SCGrid &arena_current,
+                          const SCGrid &arena_future);
+    void read_checkpoint(CheckpointReader &checkpoint,
+                         const SCGrid &arena_prev,
+                         const SCGrid &arena_current,
+                         const SCGrid &arena_future);
+
+    //! sets the ghost cells of a padded grid with the boundary policy
+    //! chosen by eta_boundary_condition
+    template<class PaddedGrid>
+    void fill_ghost_cells(PaddedGrid &arena) const;
+
+    //! only the cells in active_region are evolved, the others are
+    //! copied forward from arena_current. In a distributed run, the halo
+    //! layers of arena_future are received from the neighbouring slabs.
     void AdvanceIt(const double tau_init,
                    SCGrid &arena_prev, SCGrid &arena_current,
-                   SCGrid &arena_future, const int rk_flag);
+                   SCGrid &arena_future, const int rk_flag,
+                   const ActiveRegion &active_region);
+
+    //! true if the stages can run inside one parallel region of the
+    //! caller, with prepare_stage on one thread and AdvanceIt_in_team on
+    //! all of them. The halo exchange of a distributed run, the offload
+    //! device, the deposition of the sources and the copies of the padded
+    //! and structure-of-arrays sweep grids need AdvanceIt.
+    bool can_advance_in_team() const;
+
+    //! the serial part of AdvanceIt before its grid loops
+    void prepare_stage(SCGrid &arena_prev, SCGrid &arena_current,
+                       SCGrid &arena_future, const int rk_flag);
+
+    //! the grid loops of AdvanceIt, called by all the threads of a parallel
+    //! region after prepare_stage. It ends with a barrier.
+    void AdvanceIt_in_team(const double tau_init,
+                           SCGrid &arena_prev, SCGrid &arena_current,
+                           SCGrid &arena_future, const int rk_flag,
+                           const ActiveRegion &active_region);
 
+    //! this function evolves the cells of active_region in the eta layers
+    //! [eta_min, eta_max), and copies the other cells of the layers forward
+    void advance_eta_layers(const double tau,
+                            SCGrid &arena_prev, SCGrid &arena_current,
+                            SCGrid &arena_future, const int rk_flag,
+                            const ActiveRegion &active_region,
+                            const int eta_min, const int eta_max);
+
+    //! the same as advance_eta_layers without the causality constraints,
+    //! called by all the threads of a parallel region without a barrier
+    //! at the end
+    void advance_eta_layers_in_team(const double tau,
+                                    SCGrid &arena_prev,
+                                    SCGrid &arena_current,
+                                    SCGrid &arena_future, const int rk_flag,
+                                    const ActiveRegion &active_region,
+                                    const int eta_min, const int eta_max);
+
+    //! true if the stages apply the causality constraints
+    bool limits_causality() const;
+
+    //! the face fluxes of the stage rk_flag with the slope limiter of the
+    //! run, from all the threads of a parallel region without a barrier
+    void compute_stage_face_fluxes(const double tau, const int rk_flag,
+                                   const ActiveRegion &active_region);
+
+    //! resizes face_fluxes_ to the faces of the cells of arena
+    void resize_face_fluxes(const SCGrid &arena);
+
+    //! whether the viscous cells read their velocity gradients from
+    //! gradients_ (u_derivative_rows = 1)
+    bool uses_gradient_rows() const;
+
+    //! this function fills gradients_ for the cells of active_region with
+    //! the rows divided over the threads of the team. It ends with a
+    //! barrier.
+    void compute_stage_gradients(const double tau, SCGrid &arena_prev,
+                                 const ActiveRegion &active_region);
+
+    //! this function fills face_fluxes_ for the faces of the cells in
+    //! active_region, with the slopes limited by Limiter (see
+    //! slope_limiter.h)
+    template<class Limiter, class Grid, class Thermo>
+    void compute_face_fluxes(const Limiter &limiter, const double tau,
+                             Grid &arena_sweep, Thermo &thermo_sweep,
+                             const ActiveRegion &active_region);
+
+    template<unsigned Config, class Grid, class Thermo>
+    void AdvanceCell(const double tau, Grid &arena_sweep,
+                     Thermo &thermo_sweep, SCGrid &arena_prev,
+                     SCGrid &arena_current, Cell_small &grid_f,
+                     U_derivative &u_derivative_helper,
+                     const int ix, const int iy, const int ieta,
+                     const int rk_flag);
+
+    template<class Grid, class Thermo>
+    using AdvanceCellKernel = void (Advance::*)(
+        const double, Grid&, Thermo&, SCGrid&, SCGrid&, Cell_small&,
+        U_derivative&, const int, const int, const int, const int);
+
+    //! this function returns AdvanceCell compiled for physics_config_,
+    //! from a table of the kernels of all the PhysicsConfig values
+    template<class Grid, class Thermo, unsigned... Configs>
+    AdvanceCellKernel<Grid, Thermo> get_advance_cell_kernel(
+                std::integer_sequence<unsigned, Configs...>) const;
+
+    template<unsigned Config, class Grid, class Thermo>
     void FirstRKStepT(const double tau, const double x_local,
                       const double y_local, const double eta_s_local,
-                      SCGrid &arena_current, SCGrid &arena_future,
+                      Grid &arena_sweep, Thermo &thermo_sweep,
+                      SCGrid &arena_current, Cell_small &grid_f,
                       SCGrid &arena_prev, const int ix, const int iy,
                       const int ieta, const int rk_flag);
 
-    void FirstRKStepW(const double tau_it, SCGrid &arena_prev,
-                      SCGrid &arena_current, SCGrid &arena_future,
+    template<unsigned Config, class Grid>
+    void FirstRKStepW(const double tau_it, Grid &arena_sweep,
+                      SCGrid &arena_prev, SCGrid &arena_current,
+                      Cell_small &grid_f,
                       const int rk_flag, const double theta_local,
                       const DumuVec &a_local,
                       const VelocityShearVec &sigma_local,
@@ -58,28 +294,74 @@ class Advance {
     void QuestRevert_qmu(const double tau, Cell_small *grid_pt,
                          const int ieta, const int ix, const int iy);
 
-    void MakeDeltaQI(const double tau, SCGrid &arena_current,
+    template<class Grid, class Thermo>
+    void MakeDeltaQI(const double tau, Grid &arena_current,
+                     Thermo &thermo_current,
                      const int ix, const int iy, const int ieta, TJbVec &qi,
                      const int rk_flag);
-    void solveEigenvaluesWmunu(Cell_small *grid_pt);
-    void nCausalityConstraints(Cell_small *grid_pt, double tau);
-    void sCausalityConstraints(Cell_small *grid_pt, double tau);
-    bool BinarySearch(double left, double right, double (*func)(double, Cell_small*, void*), void* pt2Object, double& result, Cell_small *grid_pt);
-    double Suff5(double beta, Cell_small *grid_pt);
-    double Suff7(double beta, Cell_small *grid_pt);
-    double Suff8(double beta, Cell_small *grid_pt);
-    static double Suff5_Hook(double beta, Cell_small *grid_pt, void* pt2object);
-    static double Suff7_Hook(double beta, Cell_small *grid_pt, void* pt2object);
-    static double Suff8_Hook(double beta, Cell_small *grid_pt, void* pt2object);
-
-    
+    void solveEigenvaluesWmunu(const Cell_small &grid_pt, LambdaVec &lambdas);
+
+    //! the causality constraints on the cells of region in arena_future,
+    //! after all of them are evolved, from all the threads of a parallel
+    //! region
+    void enforce_causality(const double tau, SCGrid &arena_future,
+                           const ActiveRegion &region);
+
     double MaxSpeed(const double tau, const int direc,
                     const ReconstCell &grid_p);
 
+    //! KT flux in direction through the face between the reconstructed
+    //! half-way cells grid_L and grid_R
+    void get_KT_flux(const double tau, const int direction,
+                     const TJbVec &q_L, const TJbVec &q_R,
+                     const ReconstCell &grid_L, const ReconstCell &grid_R,
+                     TJbVec &flux);
+
     double get_TJb(const ReconstCell &grid_p, const int rk_flag,
                    const int mu, const int nu);
     double get_TJb(const Cell_small &grid_p, const int mu, const int nu);
 
+    //! T^{mu nu} (J^nu for mu = 4) of a Cell_small or a Cell_small_view
+    //! with the given pressure
+    template<class CellT>
+    double get_TJb(const CellT &grid_p, const double pressure,
+                   const int mu, const int nu) const;
 };
 
+
+template<class CellT>
+double Advance::get_TJb(const CellT &grid_p, const double pressure,
+                        const int mu, const int nu) const {
+    assert(mu < 5); assert(mu > -1);
+    assert(nu < 4); assert(nu > -1);
+    const double u_nu = grid_p.u[nu];
+    if (mu == 4) {
+        return grid_p.rhob*u_nu;
+    }
+    double e = grid_p.epsilon;
+    double gfac = 0.0;
+    double u_mu = 0.0;
+    if (mu == nu) {
+        u_mu = u_nu;
+        gfac = 1.0;
+        if (mu == 0) {
+            gfac = -1.0;
+        }
+    } else {
+        u_mu = grid_p.u[mu];
+    }
+    const double T_munu = (e + pressure)*u_mu*u_nu + pressure*gfac;
+    return(T_munu);
+}
+
+
+template<class PaddedGrid>
+void Advance::fill_ghost_cells(PaddedGrid &arena) const {
+    if (DATA.eta_boundary_condition == 1) {
+        arena.template fill_ghost_cells<PeriodicEtaGridBoundary>();
+    } else {
+        arena.template fill_ghost_cells<OutflowGridBoundary>();
+    }
+}
+
 #endif  // SRC_ADVANCE_H_
@@ -0,0 +1,47 @@
+#ifndef SRC_ALIGNED_ALLOCATOR_H_
+#define SRC_ALIGNED_ALLOCATOR_H_
+
+#include <cstdlib>
+#include <new>
+#include "memory_accounting.h"
+
+//! minimal allocator returning 64-byte aligned memory, booked under the
+//! memory subsystem Subsystem
+template<class T, int Subsystem = MemorySubsystem::other>
+class AlignedAllocator {
+ public:
+    typedef T value_type;
+    static constexpr std::size_t alignment = 64;
+
+    template<class U> struct rebind {
+        typedef AlignedAllocator<U, Subsystem> other;
+    };
+
+    AlignedAllocator() = default;
+    template<class U>
+    AlignedAllocator(const AlignedAllocator<U, Subsystem>&) {}
+
+    T* allocate(std::size_t n) {
+        void *ptr = nullptr;
+        if (posix_memalign(&ptr, alignment, n*sizeof(T)) != 0) {
+            throw std::bad_alloc();
+        }
+        MemoryAccounting::allocate(Subsystem, n*sizeof(T));
+        return static_cast<T*>(ptr);
+    }
+    void deallocate(T* ptr, std::size_t n) {
+        MemoryAccounting::release(Subsystem, n*sizeof(T));
+        free(ptr);
+    }
+
+    template<class U>
+    bool operator==(const AlignedAllocator<U, Subsystem>&) const {
+        return true;
+    }
+    template<class U>
+    bool operator!=(const AlignedAllocator<U, Subsystem>&) const {
+        return false;
+    }
+};
+
+#endif  // SRC_ALIGNED_ALLOCATOR_H_
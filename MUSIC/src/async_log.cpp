@@ -0,0 +1,262 @@
+#ifdef _OPENMP
+    #include <omp.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "async_log.h"
+#include "pretty_ostream.h"
+
+#ifndef _OPENMP
+    #define omp_in_parallel() 0
+#endif
+
+LogLevel AsyncLog::min_level_ = LogLevel::debug;
+int AsyncLog::rate_limit_ = 10;
+
+namespace {
+
+const int64_t window_ticks = (
+    std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                    std::chrono::seconds(1)).count());
+
+int64_t get_ticks() {
+    return(std::chrono::steady_clock::now().time_since_epoch().count());
+}
+
+struct LogRecord {
+    uint64_t ticket = 0;
+    std::string text;
+};
+
+//! the messages of one thread, pushed by the thread and popped by the
+//! drain under drain_mutex
+class LogRing {
+ public:
+    static const uint64_t capacity = 4096;
+
+    bool push(LogRecord &&record) {
+        const uint64_t head = head_.load(std::memory_order_relaxed);
+        if (head - tail_.load(std::memory_order_acquire) >= capacity) {
+            n_dropped_.fetch_add(1, std::memory_order_relaxed);
+            return(false);
+        }
+        records_[head%capacity] = std::move(record);
+        head_.store(head + 1, std::memory_order_release);
+        return(true);
+    }
+
+    void pop_all(std::vector<LogRecord> &records) {
+        const uint64_t tail = tail_.load(std::memory_order_relaxed);
+        const uint64_t head = head_.load(std::memory_order_acquire);
+        for (uint64_t i = tail; i < head; i++) {
+            records.push_back(std::move(records_[i%capacity]));
+        }
+        tail_.store(head, std::memory_order_release);
+    }
+
+    long long take_dropped() {return(n_dropped_.exchange(0));}
+
+ private:
+    std::vector<LogRecord> records_ = std::vector<LogRecord>(capacity);
+    alignas(64) std::atomic<uint64_t> head_{0};
+    alignas(64) std::atomic<uint64_t> tail_{0};
+    std::atomic<long long> n_dropped_{0};
+};
+
+//! the rings of the threads and the sites, which live to the end of the
+//! program
+std::mutex registry_mutex;
+std::vector<std::unique_ptr<LogRing>> rings;
+std::vector<LogSite*> sites;
+thread_local LogRing *thread_ring = nullptr;
+
+//! one writer of the rings and of the stream at a time
+std::mutex drain_mutex;
+std::atomic<uint64_t> next_ticket{0};
+std::atomic<long long> n_dropped_total{0};
+
+std::once_flag drainer_started, shutdown_registered;
+std::thread drainer;
+std::mutex wake_mutex;
+std::condition_variable wake;
+bool stopping = false;
+
+LogRing &get_thread_ring() {
+    if (thread_ring == nullptr) {
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        rings.push_back(std::make_unique<LogRing>());
+        thread_ring = rings.back().get();
+    }
+    return(*thread_ring);
+}
+
+//! writes the messages of all rings in the order they were posted,
+//! called with drain_mutex held
+void write_pending() {
+    std::vector<LogRecord> records;
+    long long n_dropped = 0;
+    {
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        for (auto &ring : rings) {
+            ring->pop_all(records);
+            n_dropped += ring->take_dropped();
+        }
+    }
+    if (records.empty() && n_dropped == 0) return;
+    std::sort(records.begin(), records.end(),
+              [](const LogRecord &a, const LogRecord &b) {
+                  return(a.ticket < b.ticket);
+              });
+    for (const auto &record : records) {
+        std::cout << record.text << '\n';
+    }
+    if (n_dropped > 0) {
+        n_dropped_total += n_dropped;
+        std::cout << n_dropped
+                  << " log messages dropped, the log ring was full" << '\n';
+    }
+    std::cout.flush();
+}
+
+void shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    if (drainer.joinable()) drainer.join();
+    AsyncLog::flush();
+}
+
+void register_shutdown() {
+    std::call_once(shutdown_registered, []() {std::atexit(shutdown);});
+}
+
+}  // namespace
+
+
+//! the background thread: every 20 ms it writes the summaries of the
+//! sites whose window is over and the messages in the rings
+void AsyncLog::drain_loop() {
+    std::unique_lock<std::mutex> lock(wake_mutex);
+    while (!stopping) {
+        wake.wait_for(lock, std::chrono::milliseconds(20));
+        lock.unlock();
+        post_summaries(false);
+        {
+            std::lock_guard<std::mutex> drain_lock(drain_mutex);
+            write_pending();
+        }
+        lock.lock();
+    }
+}
+
+
+void AsyncLog::initialize(const InitData &DATA) {
+    min_level_ = static_cast<LogLevel>(DATA.log_level);
+    rate_limit_ = DATA.log_rate_limit;
+    register_shutdown();
+}
+
+
+bool AsyncLog::allow(LogSite &site) {
+    if (!site.registered_.exchange(true)) {
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        sites.push_back(&site);
+    }
+    if (rate_limit_ <= 0) return(true);
+
+    // the thread which ends the window of the site starts the next one
+    const int64_t now = get_ticks();
+    int64_t start = site.window_start_.load(std::memory_order_relaxed);
+    if (   now - start >= window_ticks
+        && site.window_start_.compare_exchange_strong(start, now)) {
+        const long long n_suppressed = site.n_suppressed_.exchange(0);
+        site.n_posted_.store(0);
+        if (n_suppressed > 0) {
+            post_summary(site, n_suppressed,
+                         static_cast<double>(now - start)/window_ticks);
+        }
+    }
+    if (site.n_posted_.fetch_add(1, std::memory_order_relaxed)
+            < rate_limit_) {
+        return(true);
+    }
+    site.n_suppressed_.fetch_add(1, std::memory_order_relaxed);
+    return(false);
+}
+
+
+void AsyncLog::post(const LogLevel level, std::string text) {
+    if (omp_in_parallel() && level != LogLevel::error) {
+        LogRecord record;
+        record.ticket = next_ticket.fetch_add(1, std::memory_order_relaxed);
+        record.text = std::move(text);
+        get_thread_ring().push(std::move(record));
+        std::call_once(drainer_started, []() {
+            register_shutdown();
+            drainer = std::thread(&AsyncLog::drain_loop);
+        });
+        return;
+    }
+    std::lock_guard<std::mutex> lock(drain_mutex);
+    write_pending();
+    std::cout << text << std::endl;
+}
+
+
+void AsyncLog::flush() {
+    post_summaries(true);
+    std::lock_guard<std::mutex> lock(drain_mutex);
+    write_pending();
+}
+
+
+long long AsyncLog::get_number_of_dropped() {
+    long long n_dropped = n_dropped_total;
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    for (auto &ring : rings) {
+        n_dropped += ring->take_dropped();
+    }
+    n_dropped_total = n_dropped;
+    return(n_dropped);
+}
+
+
+void AsyncLog::post_summaries(const bool all) {
+    std::vector<LogSite*> sites_now;
+    {
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        sites_now = sites;
+    }
+    const int64_t now = get_ticks();
+    for (LogSite *site : sites_now) {
+        const int64_t start = site->window_start_.load();
+        if (!all && now - start < window_ticks) continue;
+        const long long n_suppressed = site->n_suppressed_.exchange(0);
+        if (n_suppressed > 0) {
+            post_summary(*site, n_suppressed,
+                         static_cast<double>(now - start)/window_ticks);
+        }
+    }
+}
+
+
+void AsyncLog::post_summary(LogSite &site, const long long n_suppressed,
+                            const double seconds) {
+    pretty_ostream message;
+    message << site.get_name() << ": " << n_suppressed
+            << " more occurrences suppressed in the last "
+            << std::setprecision(3) << seconds << " s";
+    message.flush("warning");
+}
@@ -0,0 +1,95 @@
+#ifndef SRC_ASYNC_LOG_H_
+#define SRC_ASYNC_LOG_H_
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include "data.h"
+
+//! the severities of the log messages, in increasing order
+enum class LogLevel : int {debug = 0, info, warning, error};
+
+//! a place in the code which can print the same message for many cells,
+//! e.g. a warning in a grid loop. A site is a static object at the
+//! message, its messages are rate limited by AsyncLog::allow:
+//!
+//!     static LogSite site("Advance::QuestRevert_qmu");
+//!     music_message << ...;
+//!     music_message.flush("warning", site);
+class LogSite {
+ public:
+    explicit LogSite(const char *name) : name_(name) {}
+    LogSite(const LogSite&) = delete;
+    LogSite& operator=(const LogSite&) = delete;
+
+    const char *get_name() const {return(name_);}
+
+ private:
+    friend class AsyncLog;
+
+    const char *name_;
+    std::atomic<bool> registered_{false};
+    //! the start of the current window in steady clock ticks, the
+    //! messages posted and suppressed in it
+    std::atomic<int64_t> window_start_{0};
+    std::atomic<int> n_posted_{0};
+    std::atomic<long long> n_suppressed_{0};
+};
+
+
+//! This class writes the log messages of pretty_ostream to the screen.
+//! A message posted by a thread of an OpenMP parallel region goes to a
+//! lock-free ring of that thread, and a background thread writes the
+//! messages of all rings in the order they were posted, so the threads
+//! never wait on the lock of the stream. Outside of parallel regions a
+//! message is written at once, after the ones still in the rings, and an
+//! error is always written at once, so the messages before an exit are
+//! on the screen. A message which finds the ring of its thread full is
+//! dropped and counted.
+//!
+//! The messages below log_level are not written. A LogSite writes at most
+//! log_rate_limit messages per second, the others are suppressed and
+//! summed up in one "N occurrences suppressed" message per second and
+//! site, and at the end of the run.
+class AsyncLog {
+ public:
+    //! sets the severity filter and the rate limit of the run
+    static void initialize(const InitData &DATA);
+    static void set_level(const LogLevel level) {min_level_ = level;}
+    //! messages per second and site, 0 for no limit
+    static void set_rate_limit(const int n_per_second) {
+        rate_limit_ = n_per_second;
+    }
+
+    static bool is_enabled(const LogLevel level) {
+        return(level == LogLevel::error || level >= min_level_);
+    }
+
+    //! true if site may post a message now, otherwise the message is
+    //! counted as suppressed
+    static bool allow(LogSite &site);
+
+    //! writes text, a formatted line without the end of line
+    static void post(const LogLevel level, std::string text);
+
+    //! writes the messages still in the rings and the summaries of the
+    //! suppressed messages, and waits until they are on the screen
+    static void flush();
+
+    //! the messages dropped because the ring of their thread was full
+    static long long get_number_of_dropped();
+
+ private:
+    static LogLevel min_level_;
+    static int rate_limit_;
+
+    //! the background thread which writes the messages of the rings
+    static void drain_loop();
+
+    //! posts the summaries of the sites whose window is over, or of all
+    static void post_summaries(const bool all);
+    static void post_summary(LogSite &site, const long long n_suppressed,
+                             const double seconds);
+};
+
+#endif  // SRC_ASYNC_LOG_H_
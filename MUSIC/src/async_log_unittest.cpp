@@ -0,0 +1,112 @@
+#ifdef _OPENMP
+    #include <omp.h>
+#endif
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "doctest.h"
+#include "async_log.h"
+#include "pretty_ostream.h"
+
+namespace {
+    //! the lines written by AsyncLog while func runs
+    template<class Func>
+    std::vector<std::string> capture_log(Func &&func) {
+        std::ostringstream output;
+        std::streambuf *screen = std::cout.rdbuf(output.rdbuf());
+        func();
+        AsyncLog::flush();
+        std::cout.rdbuf(screen);
+        std::vector<std::string> lines;
+        std::istringstream input(output.str());
+        for (std::string line; std::getline(input, line);) {
+            lines.push_back(line);
+        }
+        return(lines);
+    }
+
+    int count_containing(const std::vector<std::string> &lines,
+                         const std::string &text) {
+        int n = 0;
+        for (const auto &line : lines) {
+            if (line.find(text) != std::string::npos) n++;
+        }
+        return(n);
+    }
+}
+
+
+TEST_CASE("Check AsyncLog rate limits a site and sums up the rest") {
+    AsyncLog::set_rate_limit(3);
+    static LogSite site("rate limited site");
+    const auto lines = capture_log([]() {
+        pretty_ostream message;
+        for (int i = 0; i < 10; i++) {
+            message << "cell message " << i;
+            message.flush("warning", site);
+        }
+    });
+    CHECK(count_containing(lines, "cell message") == 3);
+    CHECK(count_containing(lines, "cell message 2") == 1);
+    CHECK(count_containing(
+            lines, "rate limited site: 7 more occurrences suppressed") == 1);
+    AsyncLog::set_rate_limit(10);
+}
+
+
+TEST_CASE("Check AsyncLog filters by severity") {
+    AsyncLog::set_level(LogLevel::warning);
+    const auto lines = capture_log([]() {
+        pretty_ostream message;
+        message << "an info";
+        message.flush("info");
+        message << "a debug";
+        message.flush("debug");
+        message << "a warning";
+        message.flush("warning");
+        message << "an error";
+        message.flush("error");
+    });
+    CHECK(count_containing(lines, "an info") == 0);
+    CHECK(count_containing(lines, "a debug") == 0);
+    CHECK(count_containing(lines, "a warning") == 1);
+    CHECK(count_containing(lines, "an error") == 1);
+    AsyncLog::set_level(LogLevel::debug);
+}
+
+
+#ifdef _OPENMP
+TEST_CASE("Check AsyncLog writes the messages of a parallel region") {
+    const int n_threads = 4;
+    const int n_messages = 200;
+    const auto lines = capture_log([]() {
+        #pragma omp parallel num_threads(n_threads)
+        {
+            const int thread = omp_get_thread_num();
+            for (int i = 0; i < n_messages; i++) {
+                AsyncLog::post(LogLevel::info,
+                               "thread " + std::to_string(thread)
+                               + " message " + std::to_string(i));
+            }
+        }
+    });
+    CHECK(static_cast<int>(lines.size()) == n_threads*n_messages);
+    // the messages of a thread are in the order they were posted
+    for (int thread = 0; thread < n_threads; thread++) {
+        int last = -1;
+        bool in_order = true;
+        const std::string prefix = "thread " + std::to_string(thread) + " ";
+        for (const auto &line : lines) {
+            if (line.compare(0, prefix.size(), prefix) != 0) continue;
+            const int i = std::stoi(line.substr(line.rfind(' ') + 1));
+            in_order = in_order && (i == last + 1);
+            last = i;
+        }
+        CHECK(in_order);
+        CHECK(last == n_messages - 1);
+    }
+    CHECK(AsyncLog::get_number_of_dropped() == 0);
+}
+#endif
@@ -0,0 +1,355 @@
+#ifdef _OPENMP
+    #include <omp.h>
+#endif
+
+#include <unistd.h>
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include "auto_tuner.h"
+#include "evolve.h"
+#include "util.h"
+
+#ifndef _OPENMP
+    #define omp_get_max_threads() 1
+    #define omp_set_num_threads(n)
+#endif
+
+std::vector<int> AutoTuner::Knob::get(const InitData &DATA) const {
+    std::vector<int> values;
+    for (const auto member : members) values.push_back(DATA.*member);
+    return(values);
+}
+
+
+void AutoTuner::Knob::set(InitData &DATA,
+                          const std::vector<int> &values) const {
+    for (unsigned int i = 0; i < members.size(); i++) {
+        DATA.*members[i] = values[i];
+    }
+}
+
+
+std::string AutoTuner::Knob::describe(const std::vector<int> &values) const {
+    std::ostringstream description;
+    for (unsigned int i = 0; i < parameters.size(); i++) {
+        description << (i > 0 ? ", " : "") << parameters[i] << " = "
+                    << values[i];
+    }
+    return(description.str());
+}
+
+
+AutoTuner::AutoTuner(const EOS &eos_in, const InitData &DATA_in,
+                     std::shared_ptr<HydroSourceBase> hydro_source_ptr_in) :
+    eos(eos_in), DATA(DATA_in), hydro_source_ptr(hydro_source_ptr_in) {}
+
+
+std::vector<AutoTuner::Knob> AutoTuner::get_knobs(const int max_threads,
+                                                  const bool has_sources) {
+    const auto always = [](const InitData &) {return(true);};
+    std::vector<Knob> knobs;
+
+    std::vector<std::vector<int>> threads;
+    for (int n = max_threads; n >= 1 && threads.size() < 3; n /= 2) {
+        threads.push_back({n});
+    }
+    knobs.push_back({{"omp_num_threads"}, {&InitData::omp_num_threads},
+                     threads, always});
+    knobs.push_back({{"grid_traversal"}, {&InitData::grid_traversal},
+                     {{0}, {1}, {2}, {3}}, always});
+    knobs.push_back({{"persistent_parallel_region"},
+                     {&InitData::persistent_parallel_region},
+                     {{0}, {1}}, always});
+    // the tiles of the tiled traversals, 0: from the L2 cache size
+    knobs.push_back({{"grid_tile_size_x", "grid_tile_size_y",
+                      "grid_tile_size_eta"},
+                     {&InitData::grid_tile_size_x,
+                      &InitData::grid_tile_size_y,
+                      &InitData::grid_tile_size_eta},
+                     {{0, 0, 0}, {16, 16, 1}, {32, 8, 1}, {64, 4, 1},
+                      {16, 8, 2}, {8, 8, 4}},
+                     [](const InitData &DATA) {
+                         return(   DATA.grid_traversal == 1
+                                || DATA.grid_traversal == 3);
+                     }});
+    knobs.push_back({{"fused_rk_stage"}, {&InitData::fused_rk_stage},
+                     {{0}, {1}}, always});
+    knobs.push_back({{"reconst_batch"}, {&InitData::reconst_batch},
+                     {{0}, {1}}, always});
+    knobs.push_back({{"face_flux"}, {&InitData::face_flux},
+                     {{0}, {1}}, always});
+    // the gradients are only needed by the viscous terms
+    knobs.push_back({{"u_derivative_rows"}, {&InitData::u_derivative_rows},
+                     {{0}, {1}},
+                     [](const InitData &DATA) {
+                         return(DATA.viscosity_flag == 1);
+                     }});
+    knobs.push_back({{"source_deposition"}, {&InitData::source_deposition},
+                     {{0}, {1}},
+                     [has_sources](const InitData &) {
+                         return(has_sources);
+                     }});
+    return(knobs);
+}
+
+
+bool AutoTuner::is_valid_configuration(const InitData &DATA) {
+    return(DATA.slope_limiter == 0 || DATA.face_flux == 1);
+}
+
+
+InitData AutoTuner::search(const InitData &DATA_in,
+                           const std::vector<Knob> &knobs,
+                           const Measurement &measure,
+                           double &input_seconds, double &best_seconds) {
+    pretty_ostream music_message;
+    InitData best = DATA_in;
+    if (!measure(best, input_seconds)) {
+        music_message.error("auto-tune: the input configuration is rejected");
+        exit(1);
+    }
+    best_seconds = input_seconds;
+    music_message << "auto-tune: " << best_seconds
+                  << " s per time step with the input configuration";
+    music_message.flush("info");
+    for (const Knob &knob : knobs) {
+        if (!knob.applies(best)) continue;
+        const std::vector<int> current = knob.get(best);
+        InitData knob_best = best;
+        for (const auto &values : knob.candidates) {
+            if (values == current) continue;
+            InitData candidate = best;
+            knob.set(candidate, values);
+            if (!is_valid_configuration(candidate)) continue;
+            double seconds = 0.;
+            const bool accepted = measure(candidate, seconds);
+            music_message << "auto-tune: " << knob.describe(values) << ": ";
+            if (!accepted) {
+                music_message << "rejected (not accurate enough)";
+                music_message.flush("info");
+                continue;
+            }
+            music_message << seconds << " s per time step";
+            music_message.flush("info");
+            if (seconds < (1. - kMinRelativeGain)*best_seconds) {
+                knob_best = candidate;
+                best_seconds = seconds;
+            }
+        }
+        best = knob_best;
+        music_message << "auto-tune: " << knob.describe(knob.get(best));
+        music_message.flush("info");
+    }
+    return(best);
+}
+
+
+double AutoTuner::get_difference(const SCGrid &a, const SCGrid &b) {
+    double epsilon_max = 0., rhob_max = 0.;
+    for (int i = 0; i < a.size(); i++) {
+        epsilon_max = std::max(epsilon_max, std::abs(a(i).epsilon));
+        rhob_max = std::max(rhob_max, std::abs(a(i).rhob));
+    }
+    double difference = 0.;
+    for (int i = 0; i < a.size(); i++) {
+        const Cell_small &cell_a = a(i);
+        const Cell_small &cell_b = b(i);
+        if (epsilon_max > 0.) {
+            difference = std::max(
+                difference,
+                std::abs(cell_b.epsilon - cell_a.epsilon)/epsilon_max);
+        }
+        if (rhob_max > 0.) {
+            difference = std::max(
+                difference, std::abs(cell_b.rhob - cell_a.rhob)/rhob_max);
+        }
+        for (int mu = 1; mu < 4; mu++) {
+            difference = std::max(difference,
+                                  std::abs(cell_b.u[mu] - cell_a.u[mu]));
+        }
+    }
+    return(difference);
+}
+
+
+void AutoTuner::run(const SCGrid &arena_prev, const SCGrid &arena_current) {
+    const int max_threads = omp_get_max_threads();
+    InitData DATA_start = DATA;
+    if (DATA_start.omp_num_threads <= 0) {
+        DATA_start.omp_num_threads = max_threads;
+    }
+
+    // the grid of the input configuration, the others are compared to it
+    SCGrid reference;
+    bool has_reference = false;
+    const Measurement measure = [&](const InitData &DATA_candidate,
+                                    double &seconds) {
+        omp_set_num_threads(DATA_candidate.omp_num_threads);
+        // the steps do not write files
+        InitData DATA_run = DATA_candidate;
+        DATA_run.checkpoint_every_N_timesteps = 0;
+        DATA_run.debug_snapshot_ring          = 0;
+        DATA_run.causality_diagnostics_stride = 0;
+        DATA_run.causality_statistics         = 0;
+        SCGrid grid_prev    = arena_prev;
+        SCGrid grid_current = arena_current;
+        SCGrid grid_future  = arena_current;
+        std::vector<double> step_seconds;
+        Evolve evolve(eos, DATA_run, hydro_source_ptr);
+        const SCGrid &result = evolve.advance_steps(
+                DATA.tau0, DATA.autotune_steps, grid_prev, grid_current,
+                grid_future, step_seconds);
+        seconds = *std::min_element(step_seconds.begin() + 1,
+                                    step_seconds.end());
+        if (!has_reference) {
+            reference = result;
+            has_reference = true;
+            return(true);
+        }
+        const double difference = get_difference(reference, result);
+        if (difference > DATA.autotune_tolerance) {
+            music_message << "auto-tune: the grid differs by " << difference
+                          << " > autotune_tolerance = "
+                          << DATA.autotune_tolerance;
+            music_message.flush("info");
+            return(false);
+        }
+        return(true);
+    };
+
+    const std::vector<Knob> knobs = get_knobs(
+                                max_threads, hydro_source_ptr != nullptr);
+    double input_seconds = 0., best_seconds = 0.;
+    const InitData best = search(DATA_start, knobs, measure, input_seconds,
+                                 best_seconds);
+    omp_set_num_threads(max_threads);
+
+    const std::string filename = get_profile_filename(DATA.autotune_profile);
+    write_profile(filename, best, knobs, best_seconds);
+    music_message << "auto-tune: " << best_seconds << " s per time step, "
+                  << input_seconds/best_seconds
+                  << " times faster than the input configuration. "
+                  << "The knobs are in " << filename << ", which the runs on "
+                  << "this machine load (with OMP_PROC_BIND = "
+                  << get_environment_value("OMP_PROC_BIND")
+                  << ", OMP_PLACES = " << get_environment_value("OMP_PLACES")
+                  << ").";
+    music_message.flush("info");
+}
+
+
+std::string AutoTuner::get_profile_filename(const std::string &filename) {
+    if (filename != "") return(filename);
+    return("music_autotune_" + get_machine_name() + ".dat");
+}
+
+
+std::string AutoTuner::get_machine_name() {
+    char hostname[256] = {0};
+    if (gethostname(hostname, sizeof(hostname) - 1) != 0) {
+        return("unknown");
+    }
+    return(std::string(hostname));
+}
+
+
+std::string AutoTuner::get_environment_value(const char *name) {
+    const char *value = getenv(name);
+    if (value == nullptr) return("unset");
+    std::string result(value);
+    result.erase(std::remove_if(result.begin(), result.end(),
+                                [](const unsigned char c) {
+                                    return(std::isspace(c) != 0);
+                                }),
+                 result.end());
+    return(result);
+}
+
+
+void AutoTuner::write_profile(const std::string &filename,
+                              const InitData &DATA,
+                              const std::vector<Knob> &knobs,
+                              const double seconds_per_step) {
+    std::ofstream profile(filename.c_str());
+    if (!profile.is_open()) {
+        pretty_ostream music_message;
+        music_message << "auto-tune: can not open the profile " << filename;
+        music_message.flush("error");
+        exit(1);
+    }
+    profile << "# the runtime knobs of MUSIC tuned by mode 9 on "
+            << DATA.nx << "x" << DATA.ny << "x" << DATA.neta
+            << " cells, " << seconds_per_step << " s per time step" << "\n"
+            << "autotune_machine  " << get_machine_name() << "\n"
+            << "autotune_hardware_threads  "
+            << std::thread::hardware_concurrency() << "\n"
+            << "autotune_omp_proc_bind  "
+            << get_environment_value("OMP_PROC_BIND") << "\n"
+            << "autotune_omp_places  "
+            << get_environment_value("OMP_PLACES") << "\n";
+    for (const Knob &knob : knobs) {
+        const std::vector<int> values = knob.get(DATA);
+        for (unsigned int i = 0; i < knob.parameters.size(); i++) {
+            profile << knob.parameters[i] << "  " << values[i] << "\n";
+        }
+    }
+    profile << "EndOfData" << std::endl;
+}
+
+
+ParameterRegistry AutoTuner::apply_profile(
+                                    const ParameterRegistry &parameters) {
+    ParameterRegistry result = parameters;
+    if (   result.get("mode", 1) == 9
+        || result.get("autotune_load_profile", 1) == 0) {
+        return(result);
+    }
+    const std::string profile_name = result.find("autotune_profile");
+    const std::string filename = get_profile_filename(
+                            profile_name != "empty" ? profile_name : "");
+    if (!Util::IsFile(filename)) return(result);
+
+    pretty_ostream music_message;
+    ParameterRegistry profile(filename);
+    const int hardware_threads = std::thread::hardware_concurrency();
+    if (   profile.find("autotune_machine") != get_machine_name()
+        || profile.get("autotune_hardware_threads", 0) != hardware_threads) {
+        music_message << "auto-tune: the profile " << filename
+                      << " is the one of another machine, it is not used";
+        music_message.flush("warning");
+        return(result);
+    }
+    if (   profile.find("autotune_omp_proc_bind")
+               != get_environment_value("OMP_PROC_BIND")
+        || profile.find("autotune_omp_places")
+               != get_environment_value("OMP_PLACES")) {
+        music_message << "auto-tune: the profile " << filename
+                      << " was tuned with OMP_PROC_BIND = "
+                      << profile.find("autotune_omp_proc_bind")
+                      << ", OMP_PLACES = "
+                      << profile.find("autotune_omp_places");
+        music_message.flush("warning");
+    }
+    int n_applied = 0;
+    for (const Knob &knob : get_knobs(1, true)) {
+        for (const auto &name : knob.parameters) {
+            if (result.contains(name)) continue;
+            if (name == "omp_num_threads" && getenv("OMP_NUM_THREADS")) {
+                continue;
+            }
+            const std::string value = profile.find(name);
+            if (value == "empty") continue;
+            result.set(name, value);
+            n_applied++;
+        }
+    }
+    music_message << "auto-tune: " << n_applied
+                  << " runtime knobs are read from " << filename;
+    music_message.flush("info");
+    return(result);
+}
@@ -0,0 +1,106 @@
+#ifndef SRC_AUTO_TUNER_H_
+#define SRC_AUTO_TUNER_H_
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "data.h"
+#include "eos.h"
+#include "grid.h"
+#include "hydro_source_base.h"
+#include "parameter_registry.h"
+#include "pretty_ostream.h"
+
+//! This class tunes the runtime knobs of the time steps on the machine
+//! (mode 9). Every configuration advances a copy of the initial grids by
+//! autotune_steps time steps (Evolve::advance_steps), the fastest step
+//! after the first one is its time. The knobs are tuned one after the
+//! other, in the order of get_knobs(), each to its fastest value with the
+//! values found for the knobs before it. A value is taken if it is faster
+//! by kMinRelativeGain, and only if the grid after the steps differs from
+//! the one of the input configuration by at most autotune_tolerance.
+//!
+//! The tuned knobs are written to the profile, in the format of an input
+//! file, with the machine it was tuned on. The later runs on the machine
+//! read it in the MUSIC constructor (apply_profile): the knobs in the
+//! profile are taken for the ones the input file does not set.
+//! The binding of the threads (OMP_PROC_BIND, OMP_PLACES) is fixed when
+//! the OpenMP runtime starts, so it is recorded in the profile and the
+//! runs with another binding are warned.
+class AutoTuner {
+ public:
+    //! a runtime knob: one or more integer parameters set together, with
+    //! their candidate values
+    struct Knob {
+        std::vector<std::string> parameters;
+        std::vector<int InitData::*> members;
+        std::vector<std::vector<int>> candidates;
+        //! whether the knob changes the steps of a configuration
+        std::function<bool(const InitData &)> applies;
+
+        std::vector<int> get(const InitData &DATA) const;
+        void set(InitData &DATA, const std::vector<int> &values) const;
+        std::string describe(const std::vector<int> &values) const;
+    };
+
+    //! times the steps of the configuration DATA into seconds, and
+    //! returns false if the configuration is not accurate enough
+    using Measurement = std::function<bool(const InitData &DATA,
+                                           double &seconds)>;
+
+    //! the gain over the fastest configuration so far to take a value
+    static constexpr double kMinRelativeGain = 0.02;
+
+    AutoTuner(const EOS &eos_in, const InitData &DATA_in,
+              std::shared_ptr<HydroSourceBase> hydro_source_ptr_in);
+
+    //! tunes the knobs on the initial grids and writes the profile
+    void run(const SCGrid &arena_prev, const SCGrid &arena_current);
+
+    //! the knobs in the order they are tuned, with up to max_threads
+    //! OpenMP threads (source_deposition only with hydro sources)
+    static std::vector<Knob> get_knobs(const int max_threads,
+                                       const bool has_sources);
+
+    //! whether the options of DATA can be combined (see ReadInParameters)
+    static bool is_valid_configuration(const InitData &DATA);
+
+    //! the tuned configuration from DATA_in, whose time is best_seconds;
+    //! input_seconds is the time of DATA_in
+    static InitData search(const InitData &DATA_in,
+                           const std::vector<Knob> &knobs,
+                           const Measurement &measure,
+                           double &input_seconds, double &best_seconds);
+
+    //! the largest difference of the cells of b from the ones of a: the
+    //! differences of epsilon and rhob relative to their largest values in
+    //! a, and the differences of u^x, u^y, u^eta
+    static double get_difference(const SCGrid &a, const SCGrid &b);
+
+    //! the file name of the profile, filename or the one of the machine
+    static std::string get_profile_filename(const std::string &filename);
+    static std::string get_machine_name();
+    //! the environment variable, without blanks ("unset" if it is not set)
+    static std::string get_environment_value(const char *name);
+
+    static void write_profile(const std::string &filename,
+                              const InitData &DATA,
+                              const std::vector<Knob> &knobs,
+                              const double seconds_per_step);
+
+    //! parameters with the knobs of the profile which are not set in
+    //! parameters (unchanged in mode 9, with autotune_load_profile = 0,
+    //! without a profile, or with the profile of another machine). The
+    //! thread count of the profile is not taken if OMP_NUM_THREADS is set.
+    static ParameterRegistry apply_profile(
+                                    const ParameterRegistry &parameters);
+
+ private:
+    const EOS &eos;
+    const InitData &DATA;
+    std::shared_ptr<HydroSourceBase> hydro_source_ptr;
+    pretty_ostream music_message;
+};
+
+#endif  // SRC_AUTO_TUNER_H_
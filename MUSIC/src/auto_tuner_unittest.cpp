@@ -0,0 +1,135 @@
+#include "auto_tuner.h"
+#include "doctest.h"
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+
+namespace {
+
+InitData make_test_data() {
+    InitData DATA;
+    DATA.omp_num_threads            = 8;
+    DATA.grid_traversal             = 1;
+    DATA.persistent_parallel_region = 1;
+    DATA.grid_tile_size_x           = 0;
+    DATA.grid_tile_size_y           = 0;
+    DATA.grid_tile_size_eta         = 0;
+    DATA.fused_rk_stage             = 1;
+    DATA.reconst_batch              = 1;
+    DATA.face_flux                  = 1;
+    DATA.slope_limiter              = 0;
+    DATA.u_derivative_rows          = 0;
+    DATA.source_deposition          = 1;
+    DATA.viscosity_flag             = 1;
+    DATA.nx = 4;
+    DATA.ny = 4;
+    DATA.neta = 2;
+    return(DATA);
+}
+
+}
+
+TEST_CASE("the search takes the fastest accurate value of every knob") {
+    const InitData DATA = make_test_data();
+    const auto knobs = AutoTuner::get_knobs(8, false);
+    int n_measurements = 0;
+    // 4 threads and the traversal 3 are the fastest, the rows are
+    // faster but not accurate, face_flux = 0 is a little faster
+    const AutoTuner::Measurement measure = [&](const InitData &candidate,
+                                               double &seconds) {
+        n_measurements++;
+        CHECK(candidate.source_deposition == 1);
+        seconds = 1.;
+        if (candidate.omp_num_threads == 4) seconds -= 0.3;
+        if (candidate.grid_traversal == 3) seconds -= 0.2;
+        if (candidate.u_derivative_rows == 1) seconds -= 0.2;
+        if (candidate.face_flux == 0) seconds -= 0.001;
+        return(candidate.u_derivative_rows == 0);
+    };
+    double input_seconds = 0., best_seconds = 0.;
+    const InitData best = AutoTuner::search(DATA, knobs, measure,
+                                            input_seconds, best_seconds);
+    CHECK(input_seconds == 1.);
+    CHECK(best_seconds == doctest::Approx(0.5));
+    CHECK(best.omp_num_threads == 4);
+    CHECK(best.grid_traversal == 3);
+    CHECK(best.u_derivative_rows == 0);
+    // below the minimal gain
+    CHECK(best.face_flux == 1);
+    // the input and 2 thread counts, 3 traversals, 1 region, 5 tile
+    // shapes, 1 of the 4 other knobs each
+    CHECK(n_measurements == 1 + 2 + 3 + 1 + 5 + 4);
+}
+
+TEST_CASE("the search does not combine the options the input rejects") {
+    InitData DATA = make_test_data();
+    DATA.slope_limiter = 2;
+    const auto knobs = AutoTuner::get_knobs(1, true);
+    const AutoTuner::Measurement measure = [&](const InitData &candidate,
+                                               double &seconds) {
+        CHECK(candidate.face_flux == 1);
+        seconds = (candidate.source_deposition == 0 ? 0.5 : 1.);
+        return(true);
+    };
+    double input_seconds = 0., best_seconds = 0.;
+    const InitData best = AutoTuner::search(DATA, knobs, measure,
+                                            input_seconds, best_seconds);
+    CHECK(best.source_deposition == 0);
+    CHECK(best_seconds == 0.5);
+}
+
+TEST_CASE("the difference of two grids") {
+    SCGrid a(3, 2, 2), b(3, 2, 2);
+    for (int i = 0; i < a.size(); i++) {
+        a(i).epsilon = 1. + i;
+        a(i).rhob = 0.;
+    }
+    b = a;
+    CHECK(AutoTuner::get_difference(a, b) == 0.);
+    b(5).epsilon += 1.2;
+    CHECK(AutoTuner::get_difference(a, b) == doctest::Approx(0.1));
+    b(7).u[2] += 0.3;
+    CHECK(AutoTuner::get_difference(a, b) == doctest::Approx(0.3));
+}
+
+TEST_CASE("the profile sets the knobs the input does not set") {
+    const std::string filename = "test_autotune_profile.dat";
+    InitData DATA = make_test_data();
+    DATA.grid_traversal = 3;
+    DATA.grid_tile_size_x = 32;
+    DATA.face_flux = 0;
+    AutoTuner::write_profile(filename, DATA, AutoTuner::get_knobs(8, true),
+                             0.1);
+
+    ParameterRegistry parameters;
+    parameters.set("mode", 2);
+    parameters.set("autotune_profile", filename);
+    parameters.set("face_flux", 1);
+    ParameterRegistry tuned = AutoTuner::apply_profile(parameters);
+    CHECK(tuned.get("grid_traversal", 0) == 3);
+    CHECK(tuned.get("grid_tile_size_x", 0) == 32);
+    CHECK(tuned.get("face_flux", 0) == 1);
+    CHECK(tuned.contains("omp_num_threads")
+          == (getenv("OMP_NUM_THREADS") == nullptr));
+
+    // the tuning runs with its input, the profile can be switched off
+    for (const int mode : {9, 2}) {
+        ParameterRegistry untuned = parameters;
+        untuned.set("mode", mode);
+        if (mode == 2) untuned.set("autotune_load_profile", 0);
+        CHECK(!AutoTuner::apply_profile(untuned).contains("grid_traversal"));
+    }
+
+    // the profile of another machine is not used
+    std::ofstream profile(filename.c_str());
+    profile << "autotune_machine  another_machine\n"
+            << "grid_traversal  3\n"
+            << "EndOfData" << std::endl;
+    profile.close();
+    CHECK(!AutoTuner::apply_profile(parameters).contains("grid_traversal"));
+    remove(filename.c_str());
+
+    // without a profile
+    CHECK(!AutoTuner::apply_profile(parameters).contains("grid_traversal"));
+}
@@ -0,0 +1,75 @@
+#ifdef _OPENMP
+    #include <omp.h>
+#endif
+
+#include <algorithm>
+#include <cstdlib>
+#include "causality_diagnostics.h"
+
+#ifndef _OPENMP
+    #define omp_get_thread_num() 0
+    #define omp_get_max_threads() 1
+#endif
+
+CausalityDiagnostics::CausalityDiagnostics(const InitData &DATA) :
+        stride_(std::max(1, DATA.causality_diagnostics_stride)),
+        out_file_(NULL) {
+    if (DATA.causality_method == 1) {
+        filename_ = "necessary_causality_diagnostics.dat";
+    } else {
+        filename_ = "sufficient_causality_diagnostics.dat";
+    }
+    buffers_.resize(omp_get_max_threads());
+
+    // a restarted run appends to the file, which the checkpoint cuts back
+    // to its size at the checkpoint
+    const bool restart = (DATA.restart_from_checkpoint == 1);
+    out_file_ = fopen(filename_.c_str(), restart ? "ab" : "wb");
+    if (out_file_ == NULL) {
+        music_message << "CausalityDiagnostics: can not open file "
+                      << filename_;
+        music_message.flush("error");
+        exit(1);
+    }
+    if (restart) return;
+    const char magic[8] = {'M', 'U', 'S', 'I', 'C', 'C', 'D', '1'};
+    const int32_t header[2] = {
+        static_cast<int32_t>(DATA.causality_method),
+        static_cast<int32_t>(sizeof(CausalityRecord))};
+    fwrite(magic, sizeof(char), 8, out_file_);
+    fwrite(header, sizeof(int32_t), 2, out_file_);
+}
+
+
+CausalityDiagnostics::~CausalityDiagnostics() {
+    flush();
+    fclose(out_file_);
+}
+
+
+void CausalityDiagnostics::record(const double factor, const double epsilon,
+                                  const double tau, const int ix,
+                                  const int iy, const int ieta,
+                                  const uint16_t violated) {
+    CausalityRecord rec;
+    rec.factor   = static_cast<float>(factor);
+    rec.epsilon  = static_cast<float>(epsilon);
+    rec.tau      = static_cast<float>(tau);
+    rec.ix       = static_cast<int16_t>(ix);
+    rec.iy       = static_cast<int16_t>(iy);
+    rec.ieta     = static_cast<int16_t>(ieta);
+    rec.violated = violated;
+    buffers_[omp_get_thread_num()].push_back(rec);
+}
+
+
+void CausalityDiagnostics::flush() {
+    for (auto &buffer_i : buffers_) {
+        if (buffer_i.empty()) continue;
+        fwrite(buffer_i.data(), sizeof(CausalityRecord), buffer_i.size(),
+               out_file_);
+        // keep the capacity for the next time step
+        buffer_i.clear();
+    }
+    fflush(out_file_);
+}
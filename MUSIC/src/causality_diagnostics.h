@@ -0,0 +1,78 @@
+#ifndef SRC_CAUSALITY_DIAGNOSTICS_H_
+#define SRC_CAUSALITY_DIAGNOSTICS_H_
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "data.h"
+#include "pretty_ostream.h"
+
+//! bit flags recording which causality conditions were violated in a cell
+namespace CausalityCondition {
+    enum : uint16_t {
+        n1    = 1 << 0,
+        n3    = 1 << 1,
+        n5    = 1 << 2,
+        n6    = 1 << 3,
+        s1    = 1 << 4,
+        s2    = 1 << 5,
+        s6    = 1 << 6,
+        suff5 = 1 << 7,
+        suff7 = 1 << 8,
+        suff8 = 1 << 9,
+    };
+}
+
+//! one entry of the causality diagnostics file (20 bytes, no padding)
+struct CausalityRecord {
+    float factor;           //!< reduction factor alpha (necessary)
+                            //!< or beta (sufficient)
+    float epsilon;          //!< local energy density [1/fm^4]
+    float tau;              //!< [fm]
+    int16_t ix;
+    int16_t iy;
+    int16_t ieta;
+    uint16_t violated;      //!< CausalityCondition bit mask
+};
+
+//! This class collects the causality reduction factors computed inside
+//! the OpenMP loop of Advance::AdvanceIt. Every thread appends to its own
+//! buffer, and Evolve::EvolveIt writes all buffers to a single binary file
+//! once per time step.
+//!
+//! File layout: the 8 char magic "MUSICCD1", the int32 causality_method,
+//! the int32 size of a record, followed by the CausalityRecord entries.
+class CausalityDiagnostics {
+ private:
+    const int stride_;
+    std::string filename_;
+    FILE *out_file_;
+    std::vector<std::vector<CausalityRecord>> buffers_;
+    pretty_ostream music_message;
+
+ public:
+    CausalityDiagnostics(const InitData &DATA);
+    ~CausalityDiagnostics();
+
+    CausalityDiagnostics(const CausalityDiagnostics&) = delete;
+    CausalityDiagnostics& operator=(const CausalityDiagnostics&) = delete;
+
+    //! return true if the cell (ix, iy, ieta) is sampled
+    bool is_sampled(const int ix, const int iy, const int ieta) const {
+        return (ix%stride_ == 0 && iy%stride_ == 0 && ieta%stride_ == 0);
+    }
+
+    //! append one record to the buffer of the calling thread
+    void record(const double factor, const double epsilon, const double tau,
+                const int ix, const int iy, const int ieta,
+                const uint16_t violated);
+
+    //! write all buffered records to file and clear the buffers
+    //! (must be called outside of the parallel region)
+    void flush();
+
+    const std::string &get_filename() const {return(filename_);}
+};
+
+#endif  // SRC_CAUSALITY_DIAGNOSTICS_H_
@@ -0,0 +1,214 @@
+#include <algorithm>
+#include "causality_limiter.h"
+
+void NecessaryCausalityCriteria::evaluate(CausalityBatch &batch) const {
+    const int n = batch.n;
+    #pragma omp simd
+    for (int i = 0; i < n; i++) {
+        const CausalityCoefficients coeff = solver_.get_coefficients(
+                batch.cs2[i], batch.L1[i], batch.L2[i], batch.L3[i],
+                batch.Pi[i]);
+        uint16_t violated = 0;
+        batch.factor[i] = solver_.get_necessary_factor(coeff, violated);
+        batch.violated[i] = violated;
+    }
+    batch.n_work = 0;
+}
+
+
+void SufficientCausalityCriteria::evaluate(CausalityBatch &batch) const {
+    const int n = batch.n;
+    bool needs_root[CausalityBatch::kSize];
+    #pragma omp simd
+    for (int i = 0; i < n; i++) {
+        const CausalityCoefficients coeff = solver_.get_coefficients(
+                batch.cs2[i], batch.L1[i], batch.L2[i], batch.L3[i],
+                batch.Pi[i]);
+        uint16_t violated = 0;
+        const double beta = solver_.get_sufficient_linear_factor(coeff,
+                                                                 violated);
+        batch.factor[i] = beta;
+        batch.violated[i] = violated;
+        // the beta of the linear conditions is final if it satisfies
+        // the nonlinear ones
+        needs_root[i] = (  (CausalitySolver::Suff5(coeff, beta) < 0)
+                         | (CausalitySolver::Suff7(coeff, beta) < 0)
+                         | (CausalitySolver::Suff8(coeff, beta) < 0));
+    }
+    batch.n_work = 0;
+    for (int i = 0; i < n; i++) {
+        if (needs_root[i]) batch.worklist[batch.n_work++] = i;
+    }
+}
+
+
+void SufficientCausalityCriteria::solve(CausalityBatch &batch,
+                                        const int lane) const {
+    const CausalityCoefficients coeff = solver_.get_coefficients(
+            batch.cs2[lane], batch.L1[lane], batch.L2[lane], batch.L3[lane],
+            batch.Pi[lane]);
+    uint16_t violated = 0;
+    batch.factor[lane] = solver_.get_sufficient_factor(coeff, violated);
+    batch.violated[lane] = violated;
+}
+
+
+std::unique_ptr<CausalityCriteria> make_causality_criteria(
+        const InitData &DATA, const TransportCoeffs &transport_coeffs) {
+    std::unique_ptr<CausalityCriteria> criteria;
+    if (DATA.causality_method == 1) {
+        criteria.reset(new NecessaryCausalityCriteria(
+                    transport_coeffs, DATA.causality_root_tolerance));
+    } else if (DATA.causality_method == 2) {
+        criteria.reset(new SufficientCausalityCriteria(
+                    transport_coeffs, DATA.causality_root_tolerance));
+    }
+    return(criteria);
+}
+
+
+CausalitySafetyBound::CausalitySafetyBound(
+        const CausalityCriteria &criteria) : bounds_(kNumBins, 0.) {
+    const int n_cs2 = 5;
+    for (int ibin = 0; ibin < kNumBins; ibin++) {
+        double bound = 1.;
+        for (int i = 0; i < n_cs2; i++) {
+            const double cs2 = kCs2Max*(ibin + i/(n_cs2 - 1.))/kNumBins;
+            if (!is_satisfied(criteria, cs2, 0.)) {
+                bound = 0.;
+                break;
+            }
+            // the largest box where all the sample points are satisfied
+            double r_ok = 0.;
+            double r_fail = bound;
+            if (is_satisfied(criteria, cs2, r_fail)) continue;
+            for (int iter = 0; iter < 30; iter++) {
+                const double r = 0.5*(r_ok + r_fail);
+                if (is_satisfied(criteria, cs2, r)) {
+                    r_ok = r;
+                } else {
+                    r_fail = r;
+                }
+            }
+            bound = r_ok;
+        }
+        bounds_[ibin] = 0.5*bound;
+    }
+}
+
+
+bool CausalitySafetyBound::is_satisfied(const CausalityCriteria &criteria,
+                                        const double cs2, const double r) {
+    const int n_points = 5;
+    CausalityBatch batch;
+    batch.n = 0;
+    bool satisfied = true;
+    auto evaluate_batch = [&]() {
+        // a cell which needs a root search violates a condition
+        criteria.evaluate(batch);
+        satisfied = (satisfied && batch.n_work == 0);
+        for (int i = 0; i < batch.n; i++) {
+            satisfied = (satisfied && batch.factor[i] == 1.
+                         && batch.violated[i] == 0);
+        }
+        batch.n = 0;
+    };
+    for (int i1 = 0; i1 < n_points; i1++)
+    for (int i3 = 0; i3 < n_points; i3++)
+    for (int ipi = 0; ipi < n_points; ipi++) {
+        const int i = batch.n++;
+        batch.cs2[i] = cs2;
+        batch.L1[i]  = - r*i1/(n_points - 1.);
+        batch.L3[i]  = r*i3/(n_points - 1.);
+        batch.L2[i]  = - batch.L1[i] - batch.L3[i];
+        batch.Pi[i]  = r*(2.*ipi/(n_points - 1.) - 1.);
+        if (batch.n == CausalityBatch::kSize) evaluate_batch();
+    }
+    if (batch.n > 0) evaluate_batch();
+    return(satisfied);
+}
+
+
+CausalityLimiter::CausalityLimiter(const InitData &DATA, const EOS &eos_in,
+                                   const TransportCoeffs &transport_coeffs)
+    : eos(eos_in),
+      criteria_(make_causality_criteria(DATA, transport_coeffs)),
+      prescreen_(DATA.causality_prescreen == 1) {
+    if (criteria_ != nullptr && prescreen_) {
+        safety_bound_ = CausalitySafetyBound(*criteria_);
+    }
+}
+
+
+void CausalityLimiter::limit_row(const double tau, SCGrid &arena,
+                                 LambdaGrid &lambdas, const int ix_min,
+                                 const int ix_max, const int iy,
+                                 const int ieta) const {
+    CausalityBatch batch;
+    batch.n = 0;
+    int n_prescreened = 0;
+    CausalityAccumulator *acc = (
+        causality_statistics_ptr ? &causality_statistics_ptr->get_accumulator()
+                                 : nullptr);
+    for (int ix = ix_min; ix < ix_max; ix++) {
+        const Cell_small &cell = arena(ix, iy, ieta);
+        const LambdaVec &lambda = lambdas(ix, iy, ieta);
+        const double P = eos.get_pressure(cell.epsilon, cell.rhob);
+        const double enthalpy = cell.epsilon + P;
+        const int i = batch.n;
+        batch.ix[i]  = ix;
+        batch.cs2[i] = eos.get_cs2(cell.epsilon, cell.rhob);
+        batch.L1[i]  = lambda[0]/enthalpy;
+        batch.L2[i]  = lambda[1]/enthalpy;
+        batch.L3[i]  = lambda[2]/enthalpy;
+        batch.Pi[i]  = cell.pi_b/enthalpy;
+        if (prescreen_ && safety_bound_.is_safe(batch.cs2[i], batch.L1[i],
+                                                batch.L3[i], batch.Pi[i])) {
+            // factor 1 without violated conditions
+            n_prescreened++;
+            record(tau, cell, ix, iy, ieta, 1., 0, acc);
+            continue;
+        }
+        batch.n++;
+        if (batch.n == CausalityBatch::kSize) {
+            limit_batch(tau, arena, lambdas, batch, iy, ieta, acc);
+            batch.n = 0;
+        }
+    }
+    if (batch.n > 0) limit_batch(tau, arena, lambdas, batch, iy, ieta, acc);
+    Instrumentation::count(InstrumentedCounter::causality_cells,
+                           ix_max - ix_min);
+    Instrumentation::count(InstrumentedCounter::causality_prescreened,
+                           n_prescreened);
+}
+
+
+void CausalityLimiter::limit_batch(const double tau, SCGrid &arena,
+                                   LambdaGrid &lambdas,
+                                   CausalityBatch &batch, const int iy,
+                                   const int ieta,
+                                   CausalityAccumulator *acc) const {
+    criteria_->evaluate(batch);
+    for (int iwork = 0; iwork < batch.n_work; iwork++) {
+        criteria_->solve(batch, batch.worklist[iwork]);
+    }
+
+    for (int i = 0; i < batch.n; i++) {
+        const int ix = batch.ix[i];
+        Cell_small &cell = arena(ix, iy, ieta);
+        const double factor = batch.factor[i];
+        Instrumentation::count_causality_violations(batch.violated[i]);
+        if (factor != 1.) {
+            cell.pi_b = cell.pi_b*factor;
+            for (auto &pi : cell.Wmunu) {
+                pi = pi*factor;
+            }
+            for (auto &lam : lambdas(ix, iy, ieta)) {
+                lam = lam*factor;
+            }
+        }
+
+        // record the reduction factor and energy density
+        record(tau, cell, ix, iy, ieta, factor, batch.violated[i], acc);
+    }
+}
@@ -0,0 +1,251 @@
+#ifndef SRC_CAUSALITY_LIMITER_H_
+#define SRC_CAUSALITY_LIMITER_H_
+
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "data.h"
+#include "cell.h"
+#include "grid.h"
+#include "eos.h"
+#include "active_region.h"
+#include "transport_coeffs.h"
+#include "causality_solver.h"
+#include "causality_diagnostics.h"
+#include "causality_statistics.h"
+#include "instrumentation.h"
+
+//! the causality input of the cells of a batch, cells ix[lane] of a row
+//! of the grid, in SIMD lanes. L1, L2, L3 and Pi are normalized by (e + P).
+struct CausalityBatch {
+    static constexpr int kSize = 16;
+    int n;
+    int ix[kSize];
+    alignas(64) double cs2[kSize];
+    alignas(64) double L1[kSize];
+    alignas(64) double L2[kSize];
+    alignas(64) double L3[kSize];
+    alignas(64) double Pi[kSize];
+    //! the reduction factor and the CausalityCondition bit mask
+    alignas(64) double factor[kSize];
+    uint16_t violated[kSize];
+    //! the lanes of the cells whose factor needs a root search
+    int worklist[kSize];
+    int n_work;
+};
+
+
+//! This is the base class of the criteria sets of the causality limiter.
+//! A criteria set evaluates its closed-form conditions for all the cells
+//! of a batch at once, and solves the conditions which need a root search
+//! only for the cells it put on the worklist.
+class CausalityCriteria {
+ public:
+    virtual ~CausalityCriteria() {}
+
+    virtual std::string get_name() const = 0;
+
+    //! sets factor and violated of the batch.n cells of batch, and appends
+    //! the lanes violating a condition which needs a root search to the
+    //! worklist (their factor is not final)
+    virtual void evaluate(CausalityBatch &batch) const = 0;
+
+    //! sets factor and violated of the cell of a worklist lane
+    virtual void solve(CausalityBatch &batch, const int lane) const {}
+};
+
+
+//! the necessary conditions n1, n3, n5 and n6, which are all linear in
+//! the reduction factor alpha (causality_method = 1)
+class NecessaryCausalityCriteria : public CausalityCriteria {
+ private:
+    const CausalitySolver solver_;
+
+ public:
+    NecessaryCausalityCriteria(const TransportCoeffs &transport_coeffs,
+                               const double tolerance)
+        : solver_(transport_coeffs, tolerance) {}
+
+    std::string get_name() const override {return("necessary");}
+    void evaluate(CausalityBatch &batch) const override;
+};
+
+
+//! the sufficient conditions (causality_method = 2). The linear s1, s2
+//! and s6 give beta for all the cells, the cells violating Suff5, Suff7 or
+//! Suff8 at that beta go to the root search.
+class SufficientCausalityCriteria : public CausalityCriteria {
+ private:
+    const CausalitySolver solver_;
+
+ public:
+    SufficientCausalityCriteria(const TransportCoeffs &transport_coeffs,
+                                const double tolerance)
+        : solver_(transport_coeffs, tolerance) {}
+
+    std::string get_name() const override {return("sufficient");}
+    void evaluate(CausalityBatch &batch) const override;
+    void solve(CausalityBatch &batch, const int lane) const override;
+};
+
+
+//! the criteria set of causality_method (nullptr for 0)
+std::unique_ptr<CausalityCriteria> make_causality_criteria(
+        const InitData &DATA, const TransportCoeffs &transport_coeffs);
+
+
+//! This class holds the safety bound of the causality prescreen in bins of
+//! cs^2: a cell with L1 <= 0 <= L3, |L1|, |L3| and |Pi| below the bound
+//! of its bin satisfies all the conditions of the criteria set, i.e.
+//! factor 1 and no violated conditions. The bound of a bin is half of the
+//! largest r for which the corners and the inner points of the box
+//! -r <= L1 <= 0 <= L3 <= r, |Pi| <= r satisfy the conditions at five cs^2
+//! of the bin. The linear conditions are the tightest at the corners,
+//! the half covers the nonlinear ones between the points.
+class CausalitySafetyBound {
+ public:
+    static constexpr int kNumBins = 50;
+    static constexpr double kCs2Max = 0.5;
+
+    CausalitySafetyBound() = default;
+    explicit CausalitySafetyBound(const CausalityCriteria &criteria);
+
+    //! the bound of the bin of cs2 (0 outside of [0, kCs2Max))
+    double get_bound(const double cs2) const {
+        if (bounds_.empty() || !(cs2 >= 0.) || !(cs2 < kCs2Max)) return(0.);
+        return(bounds_[static_cast<int>(cs2/kCs2Max*kNumBins)]);
+    }
+
+    //! true if the cell is guaranteed to satisfy all the conditions
+    bool is_safe(const double cs2, const double L1, const double L3,
+                 const double Pi) const {
+        const double bound = get_bound(cs2);
+        return(L1 <= 0. && L3 >= 0. && -L1 < bound && L3 < bound
+               && std::abs(Pi) < bound);
+    }
+
+ private:
+    std::vector<double> bounds_;
+
+    //! true if the sample points of the box of size r satisfy the
+    //! conditions at cs2
+    static bool is_satisfied(const CausalityCriteria &criteria,
+                             const double cs2, const double r);
+};
+
+
+//! This class is the causality enforcement pass of a Runge-Kutta stage,
+//! which runs over the updated cells after all of them are evolved. It
+//! reduces pi^mu_nu, the bulk pressure and the eigenvalues of pi^mu_nu of
+//! every cell by the factor of the criteria set of the run, batch by batch
+//! along the rows of the grid.
+class CausalityLimiter {
+ private:
+    const EOS &eos;
+    std::unique_ptr<CausalityCriteria> criteria_;
+    //! the bound of the prescreen (causality_prescreen = 1)
+    const bool prescreen_;
+    CausalitySafetyBound safety_bound_;
+    std::shared_ptr<CausalityDiagnostics> causality_diagnostics_ptr;
+    std::shared_ptr<CausalityStatistics> causality_statistics_ptr;
+
+    //! records the factor of a cell in the diagnostics and the statistics
+    //! (acc of the calling thread)
+    void record(const double tau, const Cell_small &cell, const int ix,
+                const int iy, const int ieta, const double factor,
+                const uint16_t violated, CausalityAccumulator *acc) const {
+        if (cell.epsilon <= 0.01) return;
+        if (acc != nullptr) {
+            causality_statistics_ptr->add(*acc, factor, cell.epsilon, tau,
+                                          ix, iy, ieta, violated);
+        }
+        if (causality_diagnostics_ptr
+                && causality_diagnostics_ptr->is_sampled(ix, iy, ieta)) {
+            causality_diagnostics_ptr->record(factor, cell.epsilon, tau,
+                                              ix, iy, ieta, violated);
+        }
+    }
+
+    //! limits the cells of batch and writes them back
+    void limit_batch(const double tau, SCGrid &arena, LambdaGrid &lambdas,
+                     CausalityBatch &batch, const int iy, const int ieta,
+                     CausalityAccumulator *acc) const;
+
+    //! limits the cells [ix_min, ix_max) of the row (iy, ieta)
+    void limit_row(const double tau, SCGrid &arena, LambdaGrid &lambdas,
+                   const int ix_min, const int ix_max, const int iy,
+                   const int ieta) const;
+
+ public:
+    CausalityLimiter(const InitData &DATA, const EOS &eos_in,
+                     const TransportCoeffs &transport_coeffs);
+
+    //! false if the run has no causality constraints
+    bool is_enabled() const {return(criteria_ != nullptr);}
+
+    const CausalityCriteria *get_criteria() const {return(criteria_.get());}
+
+    const CausalitySafetyBound &get_safety_bound() const {
+        return(safety_bound_);
+    }
+
+    //! set the sink for the reduction factors of the sampled cells
+    void set_causality_diagnostics(
+            std::shared_ptr<CausalityDiagnostics> diagnostics_ptr_in) {
+        causality_diagnostics_ptr = diagnostics_ptr_in;
+    }
+
+    //! set the aggregator of the reduction factors of all the cells
+    void set_causality_statistics(
+            std::shared_ptr<CausalityStatistics> statistics_ptr_in) {
+        causality_statistics_ptr = statistics_ptr_in;
+    }
+
+    //! limits the cells of region in arena, with their eigenvalues in
+    //! lambdas, and then calls finish(cell, ix, iy, ieta) on each of them
+    template<class Finish>
+    void enforce(const double tau, SCGrid &arena, LambdaGrid &lambdas,
+                 const ActiveRegion &region, Finish &&finish) const;
+
+    //! the same as enforce, called by all the threads of a parallel region
+    template<class Finish>
+    void enforce_in_team(const double tau, SCGrid &arena,
+                         LambdaGrid &lambdas, const ActiveRegion &region,
+                         Finish &&finish) const;
+};
+
+
+template<class Finish>
+void CausalityLimiter::enforce(const double tau, SCGrid &arena,
+                               LambdaGrid &lambdas,
+                               const ActiveRegion &region,
+                               Finish &&finish) const {
+    if (region.is_empty()) return;
+    #pragma omp parallel
+    enforce_in_team(tau, arena, lambdas, region, finish);
+}
+
+
+template<class Finish>
+void CausalityLimiter::enforce_in_team(const double tau, SCGrid &arena,
+                                       LambdaGrid &lambdas,
+                                       const ActiveRegion &region,
+                                       Finish &&finish) const {
+    if (region.is_empty()) return;
+    const int ix_min = region.get_x_min();
+    const int ix_max = region.get_x_max();
+    ScopedTimer timer(InstrumentedTimer::causality);
+    #pragma omp for collapse(2) schedule(static)
+    for (int ieta = region.get_eta_min(); ieta < region.get_eta_max();
+            ieta++)
+    for (int iy = region.get_y_min(); iy < region.get_y_max(); iy++) {
+        limit_row(tau, arena, lambdas, ix_min, ix_max, iy, ieta);
+        for (int ix = ix_min; ix < ix_max; ix++) {
+            finish(arena(ix, iy, ieta), ix, iy, ieta);
+        }
+    }
+}
+
+#endif  // SRC_CAUSALITY_LIMITER_H_
@@ -0,0 +1,251 @@
+#include <random>
+#include "causality_limiter.h"
+#include "doctest.h"
+#include "eos.h"
+
+namespace {
+
+InitData make_test_data(const int causality_method) {
+    InitData DATA;
+    DATA.shear_relax_time_factor = 5.;
+    DATA.bulk_relax_time_factor = 1./14.55;
+    DATA.causality_method = causality_method;
+    DATA.causality_root_tolerance = 1e-6;
+    DATA.causality_prescreen = 1;
+    return(DATA);
+}
+
+//! fills the batch with random cells, many of them violating the
+//! conditions
+void fill_random_batch(std::mt19937 &rng, CausalityBatch &batch) {
+    std::uniform_real_distribution<double> uniform(0., 1.);
+    batch.n = CausalityBatch::kSize;
+    for (int i = 0; i < batch.n; i++) {
+        batch.cs2[i] = 0.15 + 0.18*uniform(rng);
+        batch.L1[i]  = - 0.9*uniform(rng);
+        batch.L3[i]  = 0.9*uniform(rng);
+        batch.L2[i]  = - batch.L1[i] - batch.L3[i];
+        batch.Pi[i]  = - 0.3*uniform(rng);
+    }
+}
+
+}
+
+TEST_CASE("Check the batched causality criteria agree with the solver") {
+    EOS eos_ideal(0);
+    for (int method = 1; method <= 2; method++) {
+        InitData DATA = make_test_data(method);
+        TransportCoeffs transport_coeffs(eos_ideal, DATA);
+        CausalitySolver solver(transport_coeffs, 1e-6);
+        auto criteria = make_causality_criteria(DATA, transport_coeffs);
+        REQUIRE(criteria != nullptr);
+
+        std::mt19937 rng(42 + method);
+        int n_violated = 0;
+        for (int ibatch = 0; ibatch < 20; ibatch++) {
+            CausalityBatch batch;
+            fill_random_batch(rng, batch);
+            criteria->evaluate(batch);
+            for (int iwork = 0; iwork < batch.n_work; iwork++) {
+                criteria->solve(batch, batch.worklist[iwork]);
+            }
+            for (int i = 0; i < batch.n; i++) {
+                auto coeff = solver.get_coefficients(
+                    batch.cs2[i], batch.L1[i], batch.L2[i], batch.L3[i],
+                    batch.Pi[i]);
+                uint16_t violated = 0;
+                const double factor = (
+                    method == 1 ? solver.get_necessary_factor(coeff, violated)
+                                : solver.get_sufficient_factor(coeff,
+                                                               violated));
+                CHECK(batch.factor[i] == doctest::Approx(factor));
+                CHECK(batch.violated[i] == violated);
+                if (violated != 0) n_violated++;
+            }
+        }
+        CHECK(n_violated > 0);
+    }
+    CHECK(make_causality_criteria(make_test_data(0),
+                                  TransportCoeffs(eos_ideal,
+                                                  make_test_data(0)))
+          == nullptr);
+}
+
+TEST_CASE("Check CausalityLimiter limits the cells of the region") {
+    EOS eos_ideal(0);
+    InitData DATA = make_test_data(2);
+    TransportCoeffs transport_coeffs(eos_ideal, DATA);
+    CausalityLimiter limiter(DATA, eos_ideal, transport_coeffs);
+    REQUIRE(limiter.is_enabled());
+
+    const int nx = 20, ny = 3, neta = 2;
+    SCGrid arena(nx, ny, neta);
+    LambdaGrid lambdas(nx, ny, neta);
+    for (int ieta = 0; ieta < neta; ieta++)
+    for (int iy = 0; iy < ny; iy++)
+    for (int ix = 0; ix < nx; ix++) {
+        Cell_small &cell = arena(ix, iy, ieta);
+        cell.epsilon = 1.0;
+        cell.Wmunu[4] = 0.1;
+        cell.pi_b = - 0.05*ix;
+        // the pressure of the ideal gas is e/3
+        const double enthalpy = 4./3.;
+        lambdas(ix, iy, ieta)[0] = - 0.05*ix*enthalpy;
+        lambdas(ix, iy, ieta)[1] = 0.;
+        lambdas(ix, iy, ieta)[2] = 0.05*ix*enthalpy;
+    }
+
+    ActiveRegion region(nx, ny, neta);
+    region = region.get_eta_slab(1, 2);
+    int n_finished = 0;
+    limiter.enforce(0.6, arena, lambdas, region,
+                    [&](Cell_small &cell, int ix, int iy, int ieta) {
+                        #pragma omp atomic
+                        n_finished++;
+                    });
+    CHECK(n_finished == nx*ny);
+
+    CausalitySolver solver(transport_coeffs, 1e-6);
+    bool limited = false;
+    for (int ix = 0; ix < nx; ix++) {
+        const double enthalpy = 4./3.;
+        auto coeff = solver.get_coefficients(1./3., - 0.05*ix, 0., 0.05*ix,
+                                             - 0.05*ix/enthalpy);
+        uint16_t violated = 0;
+        const double beta = solver.get_sufficient_factor(coeff, violated);
+        CHECK(arena(ix, 1, 1).Wmunu[4] == doctest::Approx(0.1*beta));
+        CHECK(lambdas(ix, 1, 1)[2]
+              == doctest::Approx(0.05*ix*enthalpy*beta));
+        // the layer outside the region is not limited
+        CHECK(arena(ix, 1, 0).Wmunu[4] == doctest::Approx(0.1));
+        if (beta < 1.) limited = true;
+    }
+    CHECK(limited);
+}
+
+TEST_CASE("Check CausalityLimiter limits a region the same in a team") {
+    EOS eos_ideal(0);
+    InitData DATA = make_test_data(1);
+    TransportCoeffs transport_coeffs(eos_ideal, DATA);
+    CausalityLimiter limiter(DATA, eos_ideal, transport_coeffs);
+
+    const int nx = 12, ny = 5, neta = 3;
+    SCGrid arena[2] = {SCGrid(nx, ny, neta), SCGrid(nx, ny, neta)};
+    LambdaGrid lambdas[2] = {LambdaGrid(nx, ny, neta),
+                             LambdaGrid(nx, ny, neta)};
+    for (int k = 0; k < 2; k++)
+    for (int idx = 0; idx < arena[k].size(); idx++) {
+        arena[k](idx).epsilon = 1.0;
+        arena[k](idx).Wmunu[4] = 0.2;
+        arena[k](idx).pi_b = - 0.01*(idx%17);
+        lambdas[k](idx)[0] = - 0.04*(idx%13);
+        lambdas[k](idx)[1] = 0.01*(idx%3);
+        lambdas[k](idx)[2] = - lambdas[k](idx)[0] - lambdas[k](idx)[1];
+    }
+    const ActiveRegion region(nx, ny, neta);
+    int n_finished[2] = {0, 0};
+    limiter.enforce(0.6, arena[0], lambdas[0], region,
+                    [&](Cell_small &cell, int ix, int iy, int ieta) {
+                        #pragma omp atomic
+                        n_finished[0]++;
+                    });
+    #pragma omp parallel
+    {
+        limiter.enforce_in_team(
+                    0.6, arena[1], lambdas[1], region,
+                    [&](Cell_small &cell, int ix, int iy, int ieta) {
+                        #pragma omp atomic
+                        n_finished[1]++;
+                    });
+    }
+    CHECK(n_finished[0] == nx*ny*neta);
+    CHECK(n_finished[1] == nx*ny*neta);
+    for (int idx = 0; idx < arena[0].size(); idx++) {
+        CHECK(arena[1](idx).Wmunu[4] == arena[0](idx).Wmunu[4]);
+        CHECK(arena[1](idx).pi_b == arena[0](idx).pi_b);
+        CHECK(lambdas[1](idx)[2] == lambdas[0](idx)[2]);
+    }
+}
+
+TEST_CASE("Check the cells below the causality safety bound are causal") {
+    EOS eos_ideal(0);
+    for (int method = 1; method <= 2; method++) {
+        InitData DATA = make_test_data(method);
+        TransportCoeffs transport_coeffs(eos_ideal, DATA);
+        auto criteria = make_causality_criteria(DATA, transport_coeffs);
+        CausalitySafetyBound safety_bound(*criteria);
+        CHECK(safety_bound.get_bound(1./3.) > 0.);
+        CHECK(safety_bound.get_bound(-0.1) == 0.);
+        CHECK(safety_bound.get_bound(CausalitySafetyBound::kCs2Max) == 0.);
+
+        std::mt19937 rng(7 + method);
+        std::uniform_real_distribution<double> uniform(0., 1.);
+        int n_safe = 0;
+        for (int ibatch = 0; ibatch < 200; ibatch++) {
+            CausalityBatch batch;
+            batch.n = 0;
+            for (int i = 0; i < CausalityBatch::kSize; i++) {
+                const double cs2 = 0.02 + 0.4*uniform(rng);
+                const double bound = safety_bound.get_bound(cs2);
+                const double L1 = - bound*uniform(rng);
+                const double L3 = bound*uniform(rng);
+                const double Pi = bound*(2.*uniform(rng) - 1.);
+                if (!safety_bound.is_safe(cs2, L1, L3, Pi)) continue;
+                const int lane = batch.n++;
+                batch.cs2[lane] = cs2;
+                batch.L1[lane]  = L1;
+                batch.L2[lane]  = - L1 - L3;
+                batch.L3[lane]  = L3;
+                batch.Pi[lane]  = Pi;
+            }
+            criteria->evaluate(batch);
+            for (int iwork = 0; iwork < batch.n_work; iwork++) {
+                criteria->solve(batch, batch.worklist[iwork]);
+            }
+            for (int i = 0; i < batch.n; i++) {
+                CHECK(batch.factor[i] == 1.);
+                CHECK(batch.violated[i] == 0);
+            }
+            n_safe += batch.n;
+        }
+        CHECK(n_safe > 1000);
+    }
+}
+
+TEST_CASE("Check the causality prescreen does not change the limited cells") {
+    EOS eos_ideal(0);
+    const int nx = 40, ny = 2, neta = 1;
+    SCGrid arena[2] = {SCGrid(nx, ny, neta), SCGrid(nx, ny, neta)};
+    LambdaGrid lambdas[2] = {LambdaGrid(nx, ny, neta),
+                             LambdaGrid(nx, ny, neta)};
+    for (int iy = 0; iy < ny; iy++)
+    for (int ix = 0; ix < nx; ix++) {
+        for (int k = 0; k < 2; k++) {
+            Cell_small &cell = arena[k](ix, iy, 0);
+            cell.epsilon = 0.5 + 0.1*iy;
+            cell.Wmunu[4] = 0.1;
+            cell.pi_b = - 0.01*ix;
+            lambdas[k](ix, iy, 0)[0] = - 0.02*ix;
+            lambdas[k](ix, iy, 0)[1] = 0.;
+            lambdas[k](ix, iy, 0)[2] = 0.02*ix;
+        }
+    }
+    const ActiveRegion region(nx, ny, neta);
+    for (int k = 0; k < 2; k++) {
+        InitData DATA = make_test_data(2);
+        DATA.causality_prescreen = k;
+        TransportCoeffs transport_coeffs(eos_ideal, DATA);
+        CausalityLimiter limiter(DATA, eos_ideal, transport_coeffs);
+        limiter.enforce(0.6, arena[k], lambdas[k], region,
+                        [](Cell_small&, int, int, int) {});
+    }
+    bool limited = false;
+    for (int iy = 0; iy < ny; iy++)
+    for (int ix = 0; ix < nx; ix++) {
+        CHECK(arena[1](ix, iy, 0).Wmunu[4] == arena[0](ix, iy, 0).Wmunu[4]);
+        CHECK(arena[1](ix, iy, 0).pi_b == arena[0](ix, iy, 0).pi_b);
+        CHECK(lambdas[1](ix, iy, 0)[2] == lambdas[0](ix, iy, 0)[2]);
+        if (arena[0](ix, iy, 0).Wmunu[4] < 0.1) limited = true;
+    }
+    CHECK(limited);
+}
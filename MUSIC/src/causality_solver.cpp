@@ -0,0 +1,86 @@
+#include <cmath>
+
+#include "causality_solver.h"
+#include "causality_diagnostics.h"
+#include "instrumentation.h"
+#include "pretty_ostream.h"
+
+CausalitySolver::CausalitySolver(const TransportCoeffs &transport_coeffs,
+                                 const double tolerance, const int max_iter) :
+        tolerance_(tolerance), max_iter_(max_iter) {
+    s_relax_  = 1./transport_coeffs.get_shear_relax_time_factor();
+    bulk_relax_inv_ = 1./transport_coeffs.get_bulk_relax_time_factor();
+    lam_piPi_ = transport_coeffs.get_lambda_piPi_coeff();
+    tau_pipi_ = transport_coeffs.get_tau_pipi_coeff();
+    del_PiPi_ = transport_coeffs.get_delta_PiPi_coeff();
+    del_pipi_ = transport_coeffs.get_delta_pipi_coeff();
+    lam_Pipi_ = transport_coeffs.get_lambda_Pipi_coeff();
+}
+
+
+CausalityCoefficients CausalitySolver::get_coefficients(
+        const Cell_small &grid_pt, const LambdaVec &lambdas,
+        const double cs2, const double P) const {
+    const double enthalpy = grid_pt.epsilon + P;
+    return(get_coefficients(cs2, lambdas[0]/enthalpy, lambdas[1]/enthalpy,
+                            lambdas[2]/enthalpy, grid_pt.pi_b/enthalpy));
+}
+
+
+double CausalitySolver::get_sufficient_factor(
+        const CausalityCoefficients &c, uint16_t &violated) const {
+    const double cs2 = c.cs2;
+    double minBeta = get_sufficient_linear_factor(c, violated);
+
+    // the nonlinear conditions
+    if (Suff5(c, minBeta) < 0) {
+        violated |= CausalityCondition::suff5;
+        double result = 0;
+        bool status = find_root(
+            [&c](double beta) {return(Suff5(c, beta));}, 0., minBeta, result);
+        if (status) {
+            minBeta = result;
+        } else if (cs2 < 0.15) {
+            Instrumentation::count(InstrumentedCounter::root_finder_failures);
+            minBeta = 0.;
+        } else {
+            Instrumentation::count(InstrumentedCounter::root_finder_failures);
+            static LogSite site("CausalitySolver Suff5");
+            pretty_ostream message;
+            message << "Suff5 Fails Binary Search";
+            message.flush("warning", site);
+        }
+    }
+    if (Suff7(c, minBeta) < 0) {
+        violated |= CausalityCondition::suff7;
+        double result = 0;
+        bool status = find_root(
+            [&c](double beta) {return(Suff7(c, beta));}, 0., minBeta, result);
+        if (status) {
+            minBeta = result;
+        } else {
+            Instrumentation::count(InstrumentedCounter::root_finder_failures);
+            static LogSite site("CausalitySolver Suff7");
+            pretty_ostream message;
+            message << "Suff7 Fails Binary Search";
+            message.flush("warning", site);
+        }
+    }
+    if (Suff8(c, minBeta) < 0) {
+        violated |= CausalityCondition::suff8;
+        double result = 0;
+        bool status = find_root(
+            [&c](double beta) {return(Suff8(c, beta));}, 0., minBeta, result);
+        if (status) {
+            minBeta = result;
+        } else {
+            Instrumentation::count(InstrumentedCounter::root_finder_failures);
+            static LogSite site("CausalitySolver Suff8");
+            pretty_ostream message;
+            message << "Suff8 Fails Binary Search";
+            message.flush("warning", site);
+        }
+    }
+    return(minBeta);
+}
+
@@ -0,0 +1,305 @@
+#ifndef SRC_CAUSALITY_SOLVER_H_
+#define SRC_CAUSALITY_SOLVER_H_
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include "cell.h"
+#include "causality_diagnostics.h"
+#include "transport_coeffs.h"
+
+//! per-cell input of the causality conditions. The eigenvalues of
+//! pi^mu_nu and the bulk pressure are normalized by (e + P).
+struct CausalityCoefficients {
+    double cs2;
+    double L1, L2, L3;
+    double Pi;
+    double s_relax;         //!< 1/shear_relax_time_factor
+    double b_relax;         //!< (1/3 - cs2)^2/bulk_relax_time_factor
+    double lam_piPi;
+    double tau_pipi;
+    double del_PiPi;
+    double del_pipi;
+    double lam_Pipi;
+};
+
+//! This class computes the reduction factors for the shear stress tensor
+//! and the bulk pressure that restore the necessary (alpha) or the
+//! sufficient (beta) causality conditions in a fluid cell.
+class CausalitySolver {
+ private:
+    const double tolerance_;
+    const int max_iter_;
+    double s_relax_;
+    double lam_piPi_, tau_pipi_, del_PiPi_, del_pipi_, lam_Pipi_;
+    double bulk_relax_inv_;
+
+ public:
+    CausalitySolver(const TransportCoeffs &transport_coeffs,
+                    const double tolerance, const int max_iter = 100);
+
+    double get_tolerance() const {return(tolerance_);}
+
+    //! the coefficients of the conditions of grid_pt with the eigenvalues
+    //! lambdas of its pi^mu_nu
+    CausalityCoefficients get_coefficients(const Cell_small &grid_pt,
+                                           const LambdaVec &lambdas,
+                                           const double cs2,
+                                           const double P) const;
+
+    //! the coefficients of the conditions from the normalized eigenvalues
+    //! and bulk pressure
+    CausalityCoefficients get_coefficients(const double cs2, const double L1,
+                                           const double L2, const double L3,
+                                           const double Pi) const;
+
+    //! returns the reduction factor alpha for the necessary conditions
+    //! and sets the CausalityCondition flags of the violated conditions.
+    //! It has no branches, so that the loops over the cells of a
+    //! CausalityBatch vectorize.
+    double get_necessary_factor(const CausalityCoefficients &coeff,
+                                uint16_t &violated) const;
+
+    //! returns the reduction factor beta for the linear sufficient
+    //! conditions s1, s2 and s6 (no branches, as get_necessary_factor)
+    double get_sufficient_linear_factor(const CausalityCoefficients &coeff,
+                                        uint16_t &violated) const;
+
+    //! returns the reduction factor beta for the sufficient conditions
+    //! and sets the CausalityCondition flags of the violated conditions
+    double get_sufficient_factor(const CausalityCoefficients &coeff,
+                                 uint16_t &violated) const;
+
+    //! lowers factor to the root of transportPart + factor*viscousPart
+    //! if condition < 0, and sets flag in violated
+    static void reduce_factor(const double condition,
+                              const double transportPart,
+                              const double viscousPart, const uint16_t flag,
+                              uint16_t &violated, double &factor);
+
+    //! the nonlinear sufficient conditions (>= 0 if satisfied)
+    static double Suff5(const CausalityCoefficients &c, const double beta);
+    static double Suff7(const CausalityCoefficients &c, const double beta);
+    static double Suff8(const CausalityCoefficients &c, const double beta);
+
+    //! Brent's method for func(x) = 0 in [left, right], where func(left)
+    //! and func(right) must have opposite signs. On success, result is
+    //! within the tolerance of the root on the side where func >= 0.
+    template <typename Func>
+    bool find_root(Func &&func, double left, double right,
+                   double &result) const;
+};
+
+
+inline CausalityCoefficients CausalitySolver::get_coefficients(
+        const double cs2, const double L1, const double L2, const double L3,
+        const double Pi) const {
+    CausalityCoefficients coeff;
+    coeff.cs2      = cs2;
+    coeff.L1       = L1;
+    coeff.L2       = L2;
+    coeff.L3       = L3;
+    coeff.Pi       = Pi;
+    coeff.s_relax  = s_relax_;
+    coeff.b_relax  = bulk_relax_inv_*(1./3. - cs2)*(1./3. - cs2);
+    coeff.lam_piPi = lam_piPi_;
+    coeff.tau_pipi = tau_pipi_;
+    coeff.del_PiPi = del_PiPi_;
+    coeff.del_pipi = del_pipi_;
+    coeff.lam_Pipi = lam_Pipi_;
+    return(coeff);
+}
+
+
+//! lowers factor to the root of transportPart + factor*viscousPart = 0
+//! if the condition (>= 0 if satisfied) is violated
+inline void CausalitySolver::reduce_factor(
+        const double condition, const double transportPart,
+        const double viscousPart, const uint16_t flag, uint16_t &violated,
+        double &factor) {
+    const bool is_violated = (condition < 0);
+    violated |= (is_violated ? flag : 0);
+    const double root = (is_violated ? - transportPart/viscousPart : 1.);
+    factor = ((root > 0 && root < factor) ? root
+                                          : (root < 0 ? 0. : factor));
+}
+
+
+//check causality first, if violated, calculate alpha and store them in an array. (alpha = 1 otherwise), pick the min alpha between 0 and 1
+inline double CausalitySolver::get_necessary_factor(
+        const CausalityCoefficients &c, uint16_t &violated) const {
+    const double cs2 = c.cs2;
+    const double transportPart_n13 = 2.*c.s_relax;
+    const double viscousPart1_n13 = c.lam_piPi;
+    const double viscousPart2_n13 = - 1./2.*c.tau_pipi;
+    const double transportPart_n56 = cs2 + 4./3.*c.s_relax + c.b_relax;
+    const double viscousPart1_n56 = 2./3.*c.lam_piPi + c.del_PiPi + cs2;
+    const double viscousPart2_n56 = (c.del_pipi + 1./3.*c.tau_pipi
+                                     + c.lam_Pipi*(1./3.- cs2) + cs2);
+
+    // n1, n3, n5, n6 = transportPart + viscousPart (>= 0)
+    const double viscousPart_n1 = (viscousPart1_n13*c.Pi
+                                   + viscousPart2_n13*std::abs(c.L1));
+    const double viscousPart_n3 = (viscousPart1_n13*c.Pi
+                                   + viscousPart2_n13*c.L3);
+    const double viscousPart_n5 = (viscousPart1_n56*c.Pi
+                                   + viscousPart2_n56*c.L1);
+    const double viscousPart_n6 = ((1. - viscousPart1_n56)*c.Pi
+                                   + (1. - viscousPart2_n56)*c.L3);
+
+    double minAlp = 1;
+    reduce_factor(transportPart_n13 + viscousPart_n1, transportPart_n13,
+                  viscousPart_n1, CausalityCondition::n1, violated, minAlp);
+    reduce_factor(transportPart_n13 + viscousPart_n3, transportPart_n13,
+                  viscousPart_n3, CausalityCondition::n3, violated, minAlp);
+    reduce_factor(transportPart_n56 + viscousPart_n5, transportPart_n56,
+                  viscousPart_n5, CausalityCondition::n5, violated, minAlp);
+    reduce_factor(1. - transportPart_n56 + viscousPart_n6,
+                  1. - transportPart_n56, viscousPart_n6,
+                  CausalityCondition::n6, violated, minAlp);
+    return(minAlp);
+}
+
+
+inline double CausalitySolver::get_sufficient_linear_factor(
+        const CausalityCoefficients &c, uint16_t &violated) const {
+    const double L1 = c.L1;
+    const double L3 = c.L3;
+    const double Pi = c.Pi;
+    const double cs2 = c.cs2;
+
+    // s1, s2, s6 are linear in beta: transportPart + beta*viscousPart >= 0
+    const double transportPart_s1 = 1. - c.s_relax;
+    const double transportPart_s2 = 2.*c.s_relax;
+    const double transportPart_s6 = 1./3.*c.s_relax + c.b_relax + cs2;
+    // the s1 condition is checked with L1 and solved with |L1|
+    const double viscousPart_s1_check = (
+        - L1 + (1. - 1./2.*c.lam_piPi)*Pi - 1./2.*c.tau_pipi*L3);
+    const double viscousPart_s1 = (
+        - std::abs(L1) + (1. - 1./2.*c.lam_piPi)*Pi - 1./2.*c.tau_pipi*L3);
+    const double viscousPart_s2 = c.lam_piPi*Pi - c.tau_pipi*std::abs(L1);
+    const double viscousPart_s6 = (
+        (1./6.*c.lam_piPi + c.del_PiPi + cs2)*Pi
+        + (1./6.*c.tau_pipi - c.del_pipi + c.lam_Pipi - cs2)*std::abs(L1));
+
+    double minBeta = 1;
+    reduce_factor(transportPart_s1 + viscousPart_s1_check, transportPart_s1,
+                  viscousPart_s1, CausalityCondition::s1, violated, minBeta);
+    reduce_factor(transportPart_s2 + viscousPart_s2, transportPart_s2,
+                  viscousPart_s2, CausalityCondition::s2, violated, minBeta);
+    reduce_factor(transportPart_s6 + viscousPart_s6, transportPart_s6,
+                  viscousPart_s6, CausalityCondition::s6, violated, minBeta);
+    return(minBeta);
+}
+
+
+inline double CausalitySolver::Suff5(const CausalityCoefficients &c,
+                                     const double beta) {
+    const double L1 = c.L1;
+    const double L3 = c.L3;
+    const double Pi = c.Pi;
+    const double cs2 = c.cs2;
+    return 1. - cs2 - 4./3.*c.s_relax - c.b_relax - beta*((cs2 - 1. + 2./3.*c.lam_piPi + c.del_PiPi)*Pi + (c.del_pipi + 1./3.*c.tau_pipi + c.lam_Pipi + cs2)*L3 + std::abs(L1))
+    - beta*beta*(c.del_pipi - 1./12.*c.tau_pipi)*(c.lam_Pipi + cs2 - 1./12.*c.tau_pipi)*(L3 + std::abs(L1))*(L3 + std::abs(L1))/(1. - c.s_relax + beta*((1. - 1./2.*c.lam_piPi)*Pi - std::abs(L1) - 1./2.*c.tau_pipi*L3));
+}
+
+
+inline double CausalitySolver::Suff7(const CausalityCoefficients &c,
+                                     const double beta) {
+    const double L1 = c.L1;
+    const double L3 = c.L3;
+    const double Pi = c.Pi;
+    const double cs2 = c.cs2;
+    const double s7 = c.s_relax + beta*(1./2.*c.lam_piPi*Pi - 1./2.*c.tau_pipi*std::abs(L1));
+    return s7*s7
+    - beta*beta*(c.del_pipi - 1./12.*c.tau_pipi)*(c.lam_Pipi + cs2 - 1./12.*c.tau_pipi)*(L3 + std::abs(L1))*(L3 + std::abs(L1));
+}
+
+
+inline double CausalitySolver::Suff8(const CausalityCoefficients &c,
+                                     const double beta) {
+    const double L1 = c.L1;
+    const double L2 = c.L2;
+    const double L3 = c.L3;
+    const double Pi = c.Pi;
+    const double cs2 = c.cs2;
+    return 4./3.*c.s_relax + c.b_relax + cs2 + beta*((2./3.*c.lam_piPi + c.del_PiPi + cs2)*Pi - (c.del_pipi + 1./3.*c.tau_pipi - c.lam_Pipi + cs2)*std::abs(L1))
+    - (1. + beta*(Pi + L2))*(1. + beta*(Pi + L3))/3./(1. + beta*(Pi - std::abs(L1)))/(1. + beta*(Pi - std::abs(L1)))*(1. + 2.*c.s_relax + beta*((1. + c.lam_piPi)*Pi - std::abs(Pi) + c.tau_pipi*L3));
+}
+
+
+template <typename Func>
+bool CausalitySolver::find_root(Func &&func, double left, double right,
+                                double &result) const {
+    if (right < left) return(false);
+    if (right - left <= tolerance_) {
+        result = left;
+        return(true);
+    }
+
+    double a = left;
+    double b = right;
+    double fa = func(a);
+    double fb = func(b);
+    if (fa*fb > 0.) return(false);
+
+    double c = a;
+    double fc = fa;
+    double d = b - a;
+    double e = d;
+    for (int iter = 0; iter < max_iter_; iter++) {
+        if (fb*fc > 0.) {
+            c  = a;
+            fc = fa;
+            d  = b - a;
+            e  = d;
+        }
+        if (std::abs(fc) < std::abs(fb)) {
+            a  = b;  b  = c;  c  = a;
+            fa = fb; fb = fc; fc = fa;
+        }
+        const double tol1 = 2.*DBL_EPSILON*std::abs(b) + 0.5*tolerance_;
+        const double xm = 0.5*(c - b);
+        if (std::abs(xm) <= tol1 || fb == 0.) {
+            result = (fb >= 0. ? b : c);
+            return(true);
+        }
+        if (std::abs(e) >= tol1 && std::abs(fa) > std::abs(fb)) {
+            // inverse quadratic interpolation or secant step
+            const double s = fb/fa;
+            double p, q;
+            if (a == c) {
+                p = 2.*xm*s;
+                q = 1. - s;
+            } else {
+                const double qa = fa/fc;
+                const double r = fb/fc;
+                p = s*(2.*xm*qa*(qa - r) - (b - a)*(r - 1.));
+                q = (qa - 1.)*(r - 1.)*(s - 1.);
+            }
+            if (p > 0.) q = -q;
+            p = std::abs(p);
+            const double min1 = 3.*xm*q - std::abs(tol1*q);
+            const double min2 = std::abs(e*q);
+            if (2.*p < std::min(min1, min2)) {
+                e = d;
+                d = p/q;
+            } else {
+                // fall back to bisection
+                d = xm;
+                e = d;
+            }
+        } else {
+            d = xm;
+            e = d;
+        }
+        a  = b;
+        fa = fb;
+        b += (std::abs(d) > tol1 ? d : std::copysign(tol1, xm));
+        fb = func(b);
+    }
+    return(false);
+}
+
+#endif  // SRC_CAUSALITY_SOLVER_H_
@@ -0,0 +1,84 @@
+#include "causality_solver.h"
+#include "causality_diagnostics.h"
+#include "doctest.h"
+#include "eos.h"
+
+namespace {
+
+InitData make_test_data() {
+    InitData DATA;
+    DATA.shear_relax_time_factor = 5.;
+    DATA.bulk_relax_time_factor = 1./14.55;
+    return(DATA);
+}
+
+}
+
+TEST_CASE("Brent root finder returns the feasible side of the root") {
+    EOS eos_ideal(0);
+    InitData DATA = make_test_data();
+    TransportCoeffs transport_coeffs(eos_ideal, DATA);
+    CausalitySolver solver(transport_coeffs, 1e-8);
+
+    double result = -1.;
+    auto linear = [](double x) {return(0.3 - x);};
+    CHECK(solver.find_root(linear, 0., 1., result));
+    CHECK(result == doctest::Approx(0.3).epsilon(1e-8));
+    CHECK(linear(result) >= 0.);
+
+    auto cubic = [](double x) {return(0.125 - x*x*x);};
+    CHECK(solver.find_root(cubic, 0., 1., result));
+    CHECK(result == doctest::Approx(0.5).epsilon(1e-8));
+    CHECK(cubic(result) >= 0.);
+
+    // no sign change in the interval
+    CHECK_FALSE(solver.find_root(linear, 0.5, 1., result));
+}
+
+TEST_CASE("causality factors of an ideal fluid cell") {
+    EOS eos_ideal(0);
+    InitData DATA = make_test_data();
+    TransportCoeffs transport_coeffs(eos_ideal, DATA);
+    CausalitySolver solver(transport_coeffs, 1e-6);
+
+    Cell_small cell;
+    cell.epsilon = 1.0;
+    const LambdaVec lambdas = {0., 0., 0.};
+    auto coeff = solver.get_coefficients(cell, lambdas, 1./3., 1./3.);
+    uint16_t violated = 0;
+    CHECK(solver.get_necessary_factor(coeff, violated) == 1.);
+    CHECK(solver.get_sufficient_factor(coeff, violated) == 1.);
+    CHECK(violated == 0);
+}
+
+TEST_CASE("sufficient causality factor restores the conditions") {
+    EOS eos_ideal(0);
+    InitData DATA = make_test_data();
+    TransportCoeffs transport_coeffs(eos_ideal, DATA);
+    CausalitySolver solver(transport_coeffs, 1e-6);
+
+    Cell_small cell;
+    cell.epsilon = 1.0;
+    const double enthalpy = 4./3.;
+    LambdaVec lambdas;
+    lambdas[0] = -0.9*enthalpy;
+    lambdas[1] = 0.2*enthalpy;
+    lambdas[2] = 0.7*enthalpy;
+    cell.pi_b = -0.1*enthalpy;
+    auto coeff = solver.get_coefficients(cell, lambdas, 1./3., 1./3.);
+    CHECK(coeff.L1 == doctest::Approx(-0.9));
+    CHECK(coeff.Pi == doctest::Approx(-0.1));
+
+    uint16_t violated = 0;
+    double beta = solver.get_sufficient_factor(coeff, violated);
+    CHECK(violated != 0);
+    CHECK(beta > 0.);
+    CHECK(beta < 1.);
+    CHECK(CausalitySolver::Suff5(coeff, beta) >= 0.);
+    CHECK(CausalitySolver::Suff7(coeff, beta) >= 0.);
+    CHECK(CausalitySolver::Suff8(coeff, beta) >= 0.);
+
+    violated = 0;
+    double alpha = solver.get_necessary_factor(coeff, violated);
+    CHECK(alpha >= beta);
+}
@@ -0,0 +1,253 @@
+#ifdef _OPENMP
+    #include <omp.h>
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include "util.h"
+#include "causality_statistics.h"
+
+#ifndef _OPENMP
+    #define omp_get_thread_num() 0
+    #define omp_get_max_threads() 1
+#endif
+
+using Util::hbarc;
+
+CausalityStatistics::CausalityStatistics(const InitData &DATA) :
+        sample_size_(std::max(0, DATA.causality_sample_size)),
+        statistics_file_(NULL), sample_file_(NULL), rng_(1),
+        factor_histogram_(kNumFactorBins, 0),
+        factor_eps_histogram_(kNumEpsBins*kNumFactorBins, 0),
+        n_cells_(0), n_violating_(0), energy_(0.), energy_violating_(0.) {
+    const std::string method = (
+            DATA.causality_method == 1 ? "necessary" : "sufficient");
+    statistics_filename_ = method + "_causality_statistics.dat";
+    factor_eps_filename_ = method + "_causality_factor_eps.dat";
+    sample_filename_     = method + "_causality_sample.dat";
+
+    accumulators_.resize(omp_get_max_threads());
+    for (size_t i = 0; i < accumulators_.size(); i++) {
+        CausalityAccumulator &acc = accumulators_[i];
+        acc.factor_histogram.assign(kNumFactorBins, 0);
+        acc.factor_eps_histogram.assign(kNumEpsBins*kNumFactorBins, 0);
+        acc.sample.reserve(sample_size_);
+        acc.rng.seed(static_cast<unsigned int>(i + 2));
+    }
+
+    // a restarted run appends to the files, which the checkpoint cuts back
+    // to their sizes at the checkpoint
+    const bool restart = (DATA.restart_from_checkpoint == 1);
+    statistics_file_ = open_file(statistics_filename_, restart);
+    if (!restart) {
+        fprintf(statistics_file_,
+                "# tau [fm]  N_cells  N_violating  N_violating/N_cells  "
+                "e_violating/e  N(factor bins 0-%d: [i/%d, (i+1)/%d), "
+                "bin %d: factor = 1)\n", kNumFactorBins - 2,
+                kNumFactorBins - 1, kNumFactorBins - 1, kNumFactorBins - 1);
+    }
+    if (sample_size_ == 0) return;
+    sample_file_ = open_file(sample_filename_, restart);
+    if (restart) return;
+    const char magic[8] = {'M', 'U', 'S', 'I', 'C', 'C', 'D', '1'};
+    const int32_t header[2] = {
+        static_cast<int32_t>(DATA.causality_method),
+        static_cast<int32_t>(sizeof(CausalityRecord))};
+    fwrite(magic, sizeof(char), 8, sample_file_);
+    fwrite(header, sizeof(int32_t), 2, sample_file_);
+}
+
+
+CausalityStatistics::~CausalityStatistics() {
+    fclose(statistics_file_);
+    if (sample_file_ != NULL) fclose(sample_file_);
+}
+
+
+FILE *CausalityStatistics::open_file(const std::string &filename,
+                                     const bool restart) {
+    FILE *file = fopen(filename.c_str(), restart ? "ab" : "wb");
+    if (file == NULL) {
+        music_message << "CausalityStatistics: can not open file "
+                      << filename;
+        music_message.flush("error");
+        exit(1);
+    }
+    return(file);
+}
+
+
+CausalityAccumulator &CausalityStatistics::get_accumulator() {
+    return(accumulators_[omp_get_thread_num()]);
+}
+
+
+int CausalityStatistics::get_factor_bin(const double factor) {
+    if (!(factor < 1.)) return(kNumFactorBins - 1);
+    const int ibin = static_cast<int>(factor*(kNumFactorBins - 1));
+    return(std::max(0, std::min(kNumFactorBins - 2, ibin)));
+}
+
+
+int CausalityStatistics::get_eps_bin(const double epsilon) {
+    const double eps = epsilon*hbarc;
+    if (!(eps > kEpsMin)) return(0);
+    const int ibin = static_cast<int>(
+            kNumEpsBins*std::log(eps/kEpsMin)/std::log(kEpsMax/kEpsMin));
+    return(std::min(kNumEpsBins - 1, ibin));
+}
+
+
+void CausalityStatistics::add_to_sample(
+        CausalityAccumulator &acc, const double factor, const double epsilon,
+        const double tau, const int ix, const int iy, const int ieta,
+        const uint16_t violated) const {
+    // n_cells already counts this record
+    size_t i = acc.sample.size();
+    if (i == sample_size_) {
+        std::uniform_int_distribution<uint64_t> dist(0, acc.n_cells - 1);
+        const uint64_t j = dist(acc.rng);
+        if (j >= sample_size_) return;
+        i = static_cast<size_t>(j);
+    } else {
+        acc.sample.emplace_back();
+    }
+    CausalityRecord &rec = acc.sample[i];
+    rec.factor   = static_cast<float>(factor);
+    rec.epsilon  = static_cast<float>(epsilon);
+    rec.tau      = static_cast<float>(tau);
+    rec.ix       = static_cast<int16_t>(ix);
+    rec.iy       = static_cast<int16_t>(iy);
+    rec.ieta     = static_cast<int16_t>(ieta);
+    rec.violated = violated;
+}
+
+
+void CausalityStatistics::merge_samples() {
+    sample_.clear();
+    std::vector<uint64_t> n_left(accumulators_.size());
+    uint64_t n_total = 0;
+    for (size_t k = 0; k < accumulators_.size(); k++) {
+        n_left[k] = accumulators_[k].n_cells;
+        n_total += n_left[k];
+    }
+    // draws without replacement from the cells of all the threads: the
+    // cells of a thread are picked with the probability of their share of
+    // the cells left, as a uniform record of the sample of the thread
+    while (sample_.size() < sample_size_ && n_total > 0) {
+        std::uniform_int_distribution<uint64_t> dist(0, n_total - 1);
+        uint64_t r = dist(rng_);
+        size_t k = 0;
+        while (r >= n_left[k]) {
+            r -= n_left[k];
+            k++;
+        }
+        std::vector<CausalityRecord> &sample_k = accumulators_[k].sample;
+        std::uniform_int_distribution<size_t> pick(0, sample_k.size() - 1);
+        const size_t i = pick(rng_);
+        sample_.push_back(sample_k[i]);
+        sample_k[i] = sample_k.back();
+        sample_k.pop_back();
+        n_left[k]--;
+        n_total--;
+    }
+}
+
+
+void CausalityStatistics::flush(const double tau) {
+    std::fill(factor_histogram_.begin(), factor_histogram_.end(), 0);
+    n_cells_ = 0;
+    n_violating_ = 0;
+    energy_ = 0.;
+    energy_violating_ = 0.;
+    for (const auto &acc : accumulators_) {
+        for (int i = 0; i < kNumFactorBins; i++) {
+            factor_histogram_[i] += acc.factor_histogram[i];
+        }
+        for (size_t i = 0; i < factor_eps_histogram_.size(); i++) {
+            factor_eps_histogram_[i] += acc.factor_eps_histogram[i];
+        }
+        n_cells_ += acc.n_cells;
+        n_violating_ += acc.n_violating;
+        energy_ += acc.energy;
+        energy_violating_ += acc.energy_violating;
+    }
+    if (sample_size_ > 0) merge_samples();
+
+    if (n_cells_ > 0) {
+        fprintf(statistics_file_, "%e  %llu  %llu  %e  %e", tau,
+                static_cast<unsigned long long>(n_cells_),
+                static_cast<unsigned long long>(n_violating_),
+                static_cast<double>(n_violating_)/n_cells_,
+                get_violating_energy_fraction());
+        for (const auto n_i : factor_histogram_) {
+            fprintf(statistics_file_, "  %llu",
+                    static_cast<unsigned long long>(n_i));
+        }
+        fprintf(statistics_file_, "\n");
+        fflush(statistics_file_);
+        write_factor_eps_histogram();
+    }
+    if (!sample_.empty()) {
+        fwrite(sample_.data(), sizeof(CausalityRecord), sample_.size(),
+               sample_file_);
+        fflush(sample_file_);
+    }
+
+    for (auto &acc : accumulators_) {
+        std::fill(acc.factor_histogram.begin(), acc.factor_histogram.end(),
+                  0);
+        std::fill(acc.factor_eps_histogram.begin(),
+                  acc.factor_eps_histogram.end(), 0);
+        acc.n_cells = 0;
+        acc.n_violating = 0;
+        acc.energy = 0.;
+        acc.energy_violating = 0.;
+        // keep the capacity for the next time step
+        acc.sample.clear();
+    }
+}
+
+
+void CausalityStatistics::write_factor_eps_histogram() {
+    FILE *file = fopen(factor_eps_filename_.c_str(), "w");
+    if (file == NULL) {
+        music_message.warning("CausalityStatistics: can not open file "
+                              + factor_eps_filename_);
+        return;
+    }
+    fprintf(file, "# e_min [GeV/fm^3]  e_max [GeV/fm^3]  "
+                  "N(factor bins 0-%d: [i/%d, (i+1)/%d), "
+                  "bin %d: factor = 1)\n", kNumFactorBins - 2,
+            kNumFactorBins - 1, kNumFactorBins - 1, kNumFactorBins - 1);
+    const double dlog = std::log(kEpsMax/kEpsMin)/kNumEpsBins;
+    for (int ieps = 0; ieps < kNumEpsBins; ieps++) {
+        fprintf(file, "%e  %e", kEpsMin*std::exp(ieps*dlog),
+                kEpsMin*std::exp((ieps + 1)*dlog));
+        for (int i = 0; i < kNumFactorBins; i++) {
+            fprintf(file, "  %llu", static_cast<unsigned long long>(
+                        factor_eps_histogram_[ieps*kNumFactorBins + i]));
+        }
+        fprintf(file, "\n");
+    }
+    fclose(file);
+}
+
+
+std::vector<std::string> CausalityStatistics::get_output_filenames() const {
+    std::vector<std::string> filenames = {statistics_filename_};
+    if (sample_size_ > 0) filenames.push_back(sample_filename_);
+    return(filenames);
+}
+
+
+void CausalityStatistics::write_checkpoint(
+                                    CheckpointWriter &checkpoint) const {
+    for (const auto n_i : factor_eps_histogram_) checkpoint.add(n_i);
+}
+
+
+void CausalityStatistics::read_checkpoint(CheckpointReader &checkpoint) {
+    for (auto &n_i : factor_eps_histogram_) checkpoint.get(n_i);
+}
@@ -0,0 +1,152 @@
+#ifndef SRC_CAUSALITY_STATISTICS_H_
+#define SRC_CAUSALITY_STATISTICS_H_
+
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+#include "data.h"
+#include "checkpoint.h"
+#include "causality_diagnostics.h"
+#include "pretty_ostream.h"
+
+//! the histograms, counters and reservoir sample of the cells one thread
+//! limited in the current time step
+struct CausalityAccumulator {
+    //! [factor bin] of the time step, and [eps bin][factor bin]
+    std::vector<uint64_t> factor_histogram;
+    std::vector<uint64_t> factor_eps_histogram;
+    uint64_t n_cells = 0;
+    uint64_t n_violating = 0;
+    double energy = 0.;
+    double energy_violating = 0.;
+    //! a uniform sample of the records of the time step, out of n_cells
+    std::vector<CausalityRecord> sample;
+    std::mt19937 rng;
+};
+
+
+//! This class aggregates the causality reduction factors of all the cells
+//! of a time step, in place of the raw records of CausalityDiagnostics.
+//! Every thread adds its cells to its own CausalityAccumulator, and
+//! Evolve::EvolveIt merges them once per time step (after all the
+//! Runge-Kutta stages, which are all counted) and writes
+//!
+//! <method>_causality_statistics.dat: per time step, tau, the number of
+//!     cells, of violating cells (a violated condition) and their energy
+//!     fraction, followed by the histogram of the factor, i.e. the factor
+//!     vs tau histogram row by row;
+//! <method>_causality_factor_eps.dat: the factor vs eps histogram of the
+//!     run so far, rewritten every time step;
+//! <method>_causality_sample.dat: a reservoir sample of
+//!     causality_sample_size records per time step, in the format of the
+//!     causality diagnostics file.
+//!
+//! The factor bins are kNumFactorBins - 1 bins in [0, 1) and a last bin
+//! for the cells with factor 1. The eps bins are logarithmic in
+//! [kEpsMin, kEpsMax) GeV/fm^3, the cells outside go to the first and the
+//! last bin.
+class CausalityStatistics {
+ public:
+    static constexpr int kNumFactorBins = 21;
+    static constexpr int kNumEpsBins = 40;
+    static constexpr double kEpsMin = 1e-3;
+    static constexpr double kEpsMax = 1e2;
+
+    CausalityStatistics(const InitData &DATA);
+    ~CausalityStatistics();
+
+    CausalityStatistics(const CausalityStatistics&) = delete;
+    CausalityStatistics& operator=(const CausalityStatistics&) = delete;
+
+    //! the accumulator of the calling thread
+    CausalityAccumulator &get_accumulator();
+
+    //! adds one limited cell (epsilon in 1/fm^4) to acc
+    void add(CausalityAccumulator &acc, const double factor,
+             const double epsilon, const double tau, const int ix,
+             const int iy, const int ieta, const uint16_t violated) const {
+        const int ifactor = get_factor_bin(factor);
+        acc.factor_histogram[ifactor]++;
+        acc.factor_eps_histogram[get_eps_bin(epsilon)*kNumFactorBins
+                                 + ifactor]++;
+        acc.n_cells++;
+        acc.energy += epsilon;
+        if (violated != 0) {
+            acc.n_violating++;
+            acc.energy_violating += epsilon;
+        }
+        if (sample_size_ > 0) {
+            add_to_sample(acc, factor, epsilon, tau, ix, iy, ieta,
+                          violated);
+        }
+    }
+
+    static int get_factor_bin(const double factor);
+    //! the bin of epsilon [1/fm^4]
+    static int get_eps_bin(const double epsilon);
+
+    //! merges the accumulators of the time step at tau, writes the tables
+    //! and clears the accumulators (must be called outside of the parallel
+    //! region)
+    void flush(const double tau);
+
+    //! the totals of the last flush
+    const std::vector<uint64_t> &get_factor_histogram() const {
+        return(factor_histogram_);
+    }
+    const std::vector<uint64_t> &get_factor_eps_histogram() const {
+        return(factor_eps_histogram_);
+    }
+    uint64_t get_number_of_cells() const {return(n_cells_);}
+    uint64_t get_number_of_violating_cells() const {return(n_violating_);}
+    double get_violating_energy_fraction() const {
+        return(energy_ > 0. ? energy_violating_/energy_ : 0.);
+    }
+    const std::vector<CausalityRecord> &get_sample() const {
+        return(sample_);
+    }
+
+    //! the files appended to every time step
+    std::vector<std::string> get_output_filenames() const;
+
+    //! the factor vs eps histogram of the run
+    void write_checkpoint(CheckpointWriter &checkpoint) const;
+    void read_checkpoint(CheckpointReader &checkpoint);
+
+ private:
+    const size_t sample_size_;
+    std::string statistics_filename_;
+    std::string factor_eps_filename_;
+    std::string sample_filename_;
+    FILE *statistics_file_;
+    FILE *sample_file_;
+    std::vector<CausalityAccumulator> accumulators_;
+    std::mt19937 rng_;
+    pretty_ostream music_message;
+
+    std::vector<uint64_t> factor_histogram_;
+    std::vector<uint64_t> factor_eps_histogram_;
+    uint64_t n_cells_;
+    uint64_t n_violating_;
+    double energy_;
+    double energy_violating_;
+    std::vector<CausalityRecord> sample_;
+
+    FILE *open_file(const std::string &filename, const bool restart);
+
+    //! Algorithm R on the records of the thread
+    void add_to_sample(CausalityAccumulator &acc, const double factor,
+                       const double epsilon, const double tau, const int ix,
+                       const int iy, const int ieta,
+                       const uint16_t violated) const;
+
+    //! draws the sample of the time step from the samples of the threads,
+    //! each weighted by the number of cells it was drawn from
+    void merge_samples();
+
+    void write_factor_eps_histogram();
+};
+
+#endif  // SRC_CAUSALITY_STATISTICS_H_
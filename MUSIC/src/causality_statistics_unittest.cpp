@@ -0,0 +1,74 @@
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include "causality_statistics.h"
+#include "doctest.h"
+
+TEST_CASE("Check the bins of the causality statistics") {
+    const int nfactor = CausalityStatistics::kNumFactorBins;
+    CHECK(CausalityStatistics::get_factor_bin(1.) == nfactor - 1);
+    CHECK(CausalityStatistics::get_factor_bin(0.) == 0);
+    CHECK(CausalityStatistics::get_factor_bin(0.999) == nfactor - 2);
+    CHECK(CausalityStatistics::get_factor_bin(0.5) == (nfactor - 1)/2);
+    // 1 GeV/fm^3 is the lower edge of the bin 3/5 of 1e-3 to 1e2 GeV/fm^3
+    CHECK(CausalityStatistics::get_eps_bin(1.05/0.19733)
+          == 3*CausalityStatistics::kNumEpsBins/5);
+    CHECK(CausalityStatistics::get_eps_bin(0.) == 0);
+    CHECK(CausalityStatistics::get_eps_bin(1e6)
+          == CausalityStatistics::kNumEpsBins - 1);
+}
+
+TEST_CASE("Check CausalityStatistics merges the threads of a time step") {
+    InitData DATA;
+    DATA.causality_method = 2;
+    DATA.causality_sample_size = 10;
+    DATA.restart_from_checkpoint = 0;
+    CausalityStatistics statistics(DATA);
+
+    #pragma omp parallel for
+    for (int ix = 0; ix < 100; ix++) {
+        CausalityAccumulator &acc = statistics.get_accumulator();
+        // every 4th cell violates a condition and is reduced to 0.5
+        const bool violating = (ix % 4 == 0);
+        statistics.add(acc, violating ? 0.5 : 1., violating ? 3. : 1., 0.6,
+                       ix, 0, 0, violating ? 1 : 0);
+    }
+    statistics.flush(0.6);
+    CHECK(statistics.get_number_of_cells() == 100);
+    CHECK(statistics.get_number_of_violating_cells() == 25);
+    CHECK(statistics.get_violating_energy_fraction()
+          == doctest::Approx(75./150.));
+    const int nfactor = CausalityStatistics::kNumFactorBins;
+    CHECK(statistics.get_factor_histogram()[nfactor - 1] == 75);
+    CHECK(statistics.get_factor_histogram()[(nfactor - 1)/2] == 25);
+    const int ieps = CausalityStatistics::get_eps_bin(3.);
+    CHECK(statistics.get_factor_eps_histogram()[ieps*nfactor
+                                                + (nfactor - 1)/2] == 25);
+    REQUIRE(statistics.get_sample().size() == 10);
+    for (const auto &rec : statistics.get_sample()) {
+        CHECK(rec.factor == (rec.ix % 4 == 0 ? 0.5f : 1.f));
+    }
+
+    // the step histograms start over, the eps histogram sums the run
+    #pragma omp parallel for
+    for (int ix = 0; ix < 5; ix++) {
+        statistics.add(statistics.get_accumulator(), 0.5, 3., 0.7, ix, 0, 0,
+                       1);
+    }
+    statistics.flush(0.7);
+    CHECK(statistics.get_number_of_cells() == 5);
+    CHECK(statistics.get_violating_energy_fraction() == 1.);
+    CHECK(statistics.get_sample().size() == 5);
+    CHECK(statistics.get_factor_eps_histogram()[ieps*nfactor
+                                                + (nfactor - 1)/2] == 30);
+
+    std::ifstream table("sufficient_causality_statistics.dat");
+    std::string line;
+    int n_lines = 0;
+    while (std::getline(table, line)) n_lines++;
+    CHECK(n_lines == 3);
+    for (const auto &filename : statistics.get_output_filenames()) {
+        remove(filename.c_str());
+    }
+    remove("sufficient_causality_factor_eps.dat");
+}
@@ -12,13 +12,12 @@ class Cell_small {
     double rhob = 0;
     FlowVec u = {1., 0., 0., 0.};
 
-    ViscousVec Wmunu = {0.};
-    std::array<double, 3> Lambdas = {0.};
+    ViscousStorageVec Wmunu = {0.};
 
-    double pi_b = 0.;
+    DissipativeReal pi_b = 0.;
 
 
-    Cell_small operator + (Cell_small const &obj) {
+    Cell_small operator + (Cell_small const &obj) const {
         Cell_small res;
         res.epsilon = epsilon + obj.epsilon;
         res.rhob = rhob + obj.rhob;
@@ -35,7 +34,7 @@ class Cell_small {
     }
 
 
-    Cell_small operator * (const double a) {
+    Cell_small operator * (const double a) const {
         Cell_small res;
         res.epsilon = epsilon*a;
         res.rhob = rhob*a;
@@ -61,7 +60,7 @@ class Cell_aux {
     VorticityVec omega_T = {0.};
 
 
-    Cell_aux operator + (Cell_aux const &obj) {
+    Cell_aux operator + (Cell_aux const &obj) const {
         Cell_aux res;
         for (unsigned int i = 0; i < omega_k.size(); i++) {
             res.omega_kSP[i] = omega_kSP[i] + obj.omega_kSP[i];
@@ -73,7 +72,7 @@ class Cell_aux {
     }
 
 
-    Cell_aux operator * (const double a) {
+    Cell_aux operator * (const double a) const {
         Cell_aux res;
         for (unsigned int i = 0; i < omega_k.size(); i++) {
             res.omega_kSP[i] = omega_kSP[i]*a;
@@ -84,4 +83,34 @@ class Cell_aux {
         return(res);
     }
 };
+
+
+//! the velocity gradients of a fluid cell which enter the equations of
+//! the dissipative fields (computed once per Runge-Kutta stage with
+//! u_derivative_rows = 1)
+class Cell_gradients {
+ public:
+    double theta = 0.;                      //!< expansion rate
+    DumuVec a = {0.};                       //!< Du^mu, and D(mu_B/T)
+    VelocityShearVec sigma = {0.};          //!< sigma^{mu nu}
+    VorticityVec omega = {0.};              //!< omega^{mu nu} projected
+    DmuMuBoverTVec DmuMuBoverT = {0.};      //!< partial^mu (mu_B/T)
+};
+
+
+//! thermodynamic quantities of a fluid cell from the equation of state
+//! (cached once per Runge-Kutta stage)
+class Cell_thermo {
+ public:
+    double pressure = 0.;
+    double cs2 = 0.;
+    double temperature = 0.;
+    double muB = 0.;
+    double entropy = 0.;
+    double dpde = 0.;
+    double dpdrhob = 0.;
+    //! the conserved densities T^{tau alpha} and J^tau of the cell,
+    //! without the factor tau of the Runge-Kutta stage
+    TJbVec conserved = {0.};
+};
 #endif  // SRC_CELL_H_
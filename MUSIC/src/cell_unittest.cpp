@@ -43,3 +43,14 @@ TEST_CASE("Does cell * work") {
     CHECK(cell2.rhob == cell1.rhob*factor);
     CHECK(cell2.u[1] == cell1.u[1]*factor);
 }
+
+
+TEST_CASE("Check the dissipative fields are stored with DissipativeReal") {
+    Cell_small cell;
+    cell.Wmunu[1] = 0.1;
+    cell.pi_b = -0.3;
+    const ViscousVec Wmunu = to_ViscousVec(cell.Wmunu);
+    CHECK(Wmunu[1] == static_cast<double>(static_cast<DissipativeReal>(0.1)));
+    CHECK(Wmunu[1] == doctest::Approx(0.1).epsilon(1e-7));
+    CHECK(cell.pi_b == doctest::Approx(-0.3).epsilon(1e-7));
+}
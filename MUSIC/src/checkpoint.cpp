@@ -0,0 +1,167 @@
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "pretty_ostream.h"
+#include "checkpoint.h"
+
+namespace {
+    const char kMagic[8] = {'M', 'U', 'S', 'I', 'C', 'C', 'K', '1'};
+
+    //! the size of the file in bytes, -1 if it does not exist
+    int64_t get_file_size(const std::string &filename) {
+        struct stat file_stat;
+        if (stat(filename.c_str(), &file_stat) != 0) return(-1);
+        return(static_cast<int64_t>(file_stat.st_size));
+    }
+}
+
+
+CheckpointWriter::CheckpointWriter(const std::string &filename) :
+    filename_(filename) {}
+
+
+CheckpointWriter::~CheckpointWriter() {
+    wait();
+}
+
+
+void CheckpointWriter::begin() {
+    wait();
+    buffer_.clear();
+}
+
+
+void CheckpointWriter::add(const std::string &value) {
+    add(static_cast<uint64_t>(value.size()));
+    add_bytes(value.data(), value.size());
+}
+
+
+void CheckpointWriter::add_file_sizes(
+                            const std::vector<std::string> &filenames) {
+    add(static_cast<uint64_t>(filenames.size()));
+    for (const auto &filename : filenames) {
+        add(filename);
+        add(get_file_size(filename));
+    }
+}
+
+
+void CheckpointWriter::write() {
+    wait();
+    writer_ = std::thread(&CheckpointWriter::run_writer, this);
+}
+
+
+void CheckpointWriter::wait() {
+    if (writer_.joinable()) writer_.join();
+}
+
+
+void CheckpointWriter::run_writer() const {
+    pretty_ostream music_message;
+    const std::string tmp_filename = filename_ + ".tmp";
+    FILE *out_file = fopen(tmp_filename.c_str(), "wb");
+    if (out_file == NULL) {
+        music_message << "CheckpointWriter: can not open file "
+                      << tmp_filename;
+        music_message.flush("warning");
+        return;
+    }
+    const uint64_t size = buffer_.size();
+    const bool written = (
+           fwrite(kMagic, 1, sizeof(kMagic), out_file) == sizeof(kMagic)
+        && fwrite(&size, sizeof(size), 1, out_file) == 1
+        && fwrite(buffer_.data(), 1, size, out_file) == size);
+    // the checkpoint has to be on disk before it replaces the last one
+    const bool synced = (fflush(out_file) == 0
+                         && fsync(fileno(out_file)) == 0);
+    fclose(out_file);
+    if (!written || !synced
+            || rename(tmp_filename.c_str(), filename_.c_str()) != 0) {
+        music_message << "CheckpointWriter: writing " << filename_
+                      << " failed, the last checkpoint is kept.";
+        music_message.flush("warning");
+        return;
+    }
+    music_message << "CheckpointWriter: wrote " << filename_ << " ("
+                  << size/(1024*1024) << " MB)";
+    music_message.flush("info");
+}
+
+
+CheckpointReader::CheckpointReader(const std::string &filename) :
+        filename_(filename) {
+    FILE *in_file = fopen(filename_.c_str(), "rb");
+    if (in_file == NULL) error("can not open the file");
+    char magic[sizeof(kMagic)];
+    uint64_t size = 0;
+    if (   fread(magic, 1, sizeof(magic), in_file) != sizeof(magic)
+        || std::memcmp(magic, kMagic, sizeof(kMagic)) != 0
+        || fread(&size, sizeof(size), 1, in_file) != 1) {
+        fclose(in_file);
+        error("not a MUSIC checkpoint");
+    }
+    buffer_.resize(size);
+    const size_t n_read = fread(buffer_.data(), 1, size, in_file);
+    fclose(in_file);
+    if (n_read != size) error("the file is truncated");
+}
+
+
+void CheckpointReader::error(const std::string &message) const {
+    pretty_ostream music_message;
+    music_message << "CheckpointReader: " << filename_ << ": " << message
+                  << "!";
+    music_message.flush("error");
+    exit(1);
+}
+
+
+void CheckpointReader::get_bytes(void *data, const size_t size) {
+    if (position_ + size > buffer_.size()) error("the file is truncated");
+    std::memcpy(data, buffer_.data() + position_, size);
+    position_ += size;
+}
+
+
+void CheckpointReader::get(std::string &value) {
+    uint64_t size = 0;
+    get(size);
+    if (position_ + size > buffer_.size()) error("the file is truncated");
+    value.assign(buffer_.data() + position_, size);
+    position_ += size;
+}
+
+
+void CheckpointReader::restore_file_sizes() {
+    uint64_t n_files = 0;
+    get(n_files);
+    for (uint64_t i = 0; i < n_files; i++) {
+        std::string filename;
+        int64_t size = 0;
+        get(filename);
+        get(size);
+        const int64_t current_size = get_file_size(filename);
+        if (size < 0) {
+            if (current_size >= 0) remove(filename.c_str());
+        } else if (current_size < size) {
+            error("the output file " + filename
+                  + " is shorter than at the checkpoint");
+        } else if (current_size > size
+                   && truncate(filename.c_str(), size) != 0) {
+            error("can not truncate the output file " + filename);
+        }
+    }
+}
+
+
+void CheckpointReader::check_end() const {
+    if (position_ != buffer_.size()) {
+        error("the checkpoint does not match the evolution of the run");
+    }
+}
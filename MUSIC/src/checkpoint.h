@@ -0,0 +1,132 @@
+#ifndef SRC_CHECKPOINT_H_
+#define SRC_CHECKPOINT_H_
+
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "grid.h"
+
+//! This class writes a checkpoint of the evolution: a binary snapshot of
+//! plain values, grids and the sizes of the output files. The snapshot is
+//! assembled in memory on the calling thread, and write() hands it to a
+//! writer thread, which writes it to filename.tmp and renames it to
+//! filename once complete, so a run killed while writing keeps the last
+//! complete checkpoint. Only one snapshot is written at a time, the next
+//! begin() waits for the writer.
+//!
+//! File layout: the 8 char magic "MUSICCK1", the uint64 size of the
+//! payload, followed by the payload in the order of the add calls.
+class CheckpointWriter {
+ private:
+    const std::string filename_;
+    //! the snapshot, owned by the writer thread while it runs
+    std::vector<char> buffer_;
+    std::thread writer_;
+
+    void add_bytes(const void *data, const size_t size) {
+        const char *bytes = static_cast<const char*>(data);
+        buffer_.insert(buffer_.end(), bytes, bytes + size);
+    }
+
+    void run_writer() const;
+
+ public:
+    explicit CheckpointWriter(const std::string &filename);
+    //! waits for the checkpoint being written
+    ~CheckpointWriter();
+
+    CheckpointWriter(const CheckpointWriter&) = delete;
+    CheckpointWriter& operator=(const CheckpointWriter&) = delete;
+
+    //! starts a new snapshot
+    void begin();
+
+    template<typename T>
+    void add(const T &value) {
+        static_assert(std::is_trivially_copyable<T>::value,
+                      "a checkpoint stores the bytes of the values");
+        add_bytes(&value, sizeof(T));
+    }
+
+    void add(const std::string &value);
+
+    //! the interior cells of the grid with its size and the size of a
+    //! cell (which depends on the build, e.g. MUSIC_FLOAT_DISSIPATIVE)
+    template<typename T, int Ghost>
+    void add_grid(const GridT<T, Ghost> &grid) {
+        buffer_.reserve(buffer_.size() + 4*sizeof(int)
+                        + static_cast<size_t>(grid.size())*sizeof(T));
+        add(static_cast<int>(sizeof(T)));
+        add(grid.nX());
+        add(grid.nY());
+        add(grid.nEta());
+        for (int i = 0; i < grid.size(); i++) add(grid(i));
+    }
+
+    //! the current sizes of the files (-1 for a missing file), which a
+    //! restart cuts the files back to
+    void add_file_sizes(const std::vector<std::string> &filenames);
+
+    //! writes the snapshot on the writer thread
+    void write();
+
+    //! waits until the snapshot is written
+    void wait();
+};
+
+
+//! This class reads a checkpoint written by CheckpointWriter, the values
+//! are read back in the order they were added. A value which does not
+//! match the checkpoint (a truncated file or a grid of another size) is a
+//! fatal error.
+class CheckpointReader {
+ private:
+    const std::string filename_;
+    std::vector<char> buffer_;
+    size_t position_ = 0;
+
+    void get_bytes(void *data, const size_t size);
+    void error(const std::string &message) const;
+
+ public:
+    //! reads the checkpoint file
+    explicit CheckpointReader(const std::string &filename);
+
+    template<typename T>
+    void get(T &value) {
+        static_assert(std::is_trivially_copyable<T>::value,
+                      "a checkpoint stores the bytes of the values");
+        get_bytes(&value, sizeof(T));
+    }
+
+    void get(std::string &value);
+
+    //! reads a grid of add_grid into grid, which has to have the same size
+    //! or be empty, from a build with the same cells
+    template<typename T, int Ghost>
+    void get_grid(GridT<T, Ghost> &grid) {
+        int cell_size = 0, nx = 0, ny = 0, neta = 0;
+        get(cell_size);
+        if (cell_size != static_cast<int>(sizeof(T))) {
+            error("the grid cells differ from the build of the run");
+        }
+        get(nx);
+        get(ny);
+        get(neta);
+        if (grid.size() == 0) grid = GridT<T, Ghost>(nx, ny, neta);
+        if (nx != grid.nX() || ny != grid.nY() || neta != grid.nEta()) {
+            error("the grid size differs from the run");
+        }
+        for (int i = 0; i < grid.size(); i++) get(grid(i));
+    }
+
+    //! cuts the files of add_file_sizes back to their sizes at the
+    //! checkpoint, and removes the files created after it
+    void restore_file_sizes();
+
+    //! exits with an error if the checkpoint was not read to its end
+    void check_end() const;
+};
+
+#endif  // SRC_CHECKPOINT_H_
@@ -0,0 +1,77 @@
+#include "doctest.h"
+#include "checkpoint.h"
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace {
+    struct LoopState {
+        int it;
+        double tau;
+    };
+}
+
+TEST_CASE("Check the checkpoint round trip") {
+    const std::string filename = "test_checkpoint.bin";
+    const std::string output_filename = "test_checkpoint_output.dat";
+    const std::string late_filename = "test_checkpoint_late.dat";
+    remove(late_filename.c_str());
+    {
+        std::ofstream output(output_filename.c_str());
+        output << "0123456789";
+    }
+
+    SCGrid arena(3, 2, 2);
+    for (int i = 0; i < arena.size(); i++) {
+        arena(i).epsilon = 0.1*i;
+        arena(i).Wmunu[4] = -1.5*i;
+    }
+    const LoopState state = {7, 1.25};
+    std::vector<std::string> filenames;
+    filenames.push_back(output_filename);
+    filenames.push_back(late_filename);
+    {
+        CheckpointWriter checkpoint(filename);
+        checkpoint.begin();
+        checkpoint.add(state);
+        checkpoint.add(std::string("label"));
+        checkpoint.add_grid(arena);
+        checkpoint.add_file_sizes(filenames);
+        checkpoint.write();
+    }
+
+    // the run goes on after the checkpoint
+    {
+        std::ofstream output(output_filename.c_str(), std::ofstream::app);
+        output << "abc";
+        std::ofstream late(late_filename.c_str());
+        late << "written after the checkpoint";
+    }
+
+    CheckpointReader checkpoint(filename);
+    LoopState state_read = {0, 0.};
+    std::string label;
+    SCGrid arena_read(3, 2, 2);
+    checkpoint.get(state_read);
+    checkpoint.get(label);
+    checkpoint.get_grid(arena_read);
+    checkpoint.restore_file_sizes();
+    checkpoint.check_end();
+
+    CHECK(state_read.it == state.it);
+    CHECK(state_read.tau == state.tau);
+    CHECK(label == "label");
+    for (int i = 0; i < arena.size(); i++) {
+        CHECK(arena_read(i).epsilon == arena(i).epsilon);
+        CHECK(arena_read(i).Wmunu[4] == arena(i).Wmunu[4]);
+    }
+    std::ifstream output(output_filename.c_str());
+    std::string content;
+    output >> content;
+    CHECK(content == "0123456789");
+    CHECK(!std::ifstream(late_filename.c_str()).good());
+
+    remove(filename.c_str());
+    remove(output_filename.c_str());
+}
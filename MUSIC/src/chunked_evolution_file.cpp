@@ -0,0 +1,302 @@
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include "chunked_evolution_file.h"
+#include "float_codec.h"
+
+namespace {
+    const char kMagic[8] = {'M', 'U', 'S', 'I', 'C', 'E', 'V', 'C'};
+    const char kIndexMagic[8] = {'M', 'U', 'S', 'I', 'C', 'I', 'D', 'X'};
+    const char kChunkTag[4] = {'C', 'H', 'N', 'K'};
+
+    //! the header size before the field names
+    const size_t kHeaderSize = (8 + 2*sizeof(int32_t)
+                                + sizeof(ChunkedEvolutionGrid)
+                                + sizeof(int32_t));
+    const size_t kChunkHeaderSize = 32;
+    const size_t kIndexEntrySize = 24;
+    const size_t kFooterSize = 2*sizeof(int64_t) + 8;
+
+    //! the chunk header, in the order of the file
+    struct ChunkHeader {
+        char tag[4];
+        int32_t field;
+        double tau;
+        int32_t itau;
+        int32_t codec;
+        int64_t stored_size;
+    };
+    static_assert(sizeof(ChunkHeader) == kChunkHeaderSize,
+                  "unexpected padding of the chunk header");
+    static_assert(sizeof(ChunkedEvolutionGrid) == 80,
+                  "unexpected padding of the evolution grid");
+}
+
+const int32_t ChunkedEvolutionWriter::kFormatVersion;
+
+
+bool ChunkedEvolutionWriter::codec_is_available(const int codec) {
+    return(FloatCodec::is_available(codec));
+}
+
+
+ChunkedEvolutionWriter::ChunkedEvolutionWriter(
+        const std::string &filename, const ChunkedEvolutionGrid &grid,
+        const std::vector<std::string> &field_names, const int codec) :
+        file_(nullptr), grid_(grid),
+        n_fields_(static_cast<int>(field_names.size())), codec_(codec) {
+    if (!codec_is_available(codec_)) {
+        music_message << "ChunkedEvolutionWriter: codec " << codec_
+                      << " is not available";
+        music_message.flush("error");
+        exit(1);
+    }
+    file_ = fopen(filename.c_str(), "wb");
+    if (file_ == nullptr) {
+        music_message << "ChunkedEvolutionWriter: can not open file "
+                      << filename;
+        music_message.flush("error");
+        exit(1);
+    }
+    std::string names;
+    for (int i = 0; i < n_fields_; i++) {
+        if (i > 0) names += ",";
+        names += field_names[i];
+    }
+    names.resize(names.size() + (8 - (kHeaderSize + names.size())%8)%8,
+                 '\0');
+    const int32_t header[2] = {kFormatVersion, n_fields_};
+    const int32_t names_length = static_cast<int32_t>(names.size());
+    fwrite(kMagic, sizeof(char), 8, file_);
+    fwrite(header, sizeof(int32_t), 2, file_);
+    fwrite(&grid_, sizeof(ChunkedEvolutionGrid), 1, file_);
+    fwrite(&names_length, sizeof(int32_t), 1, file_);
+    fwrite(names.data(), sizeof(char), names_length, file_);
+}
+
+
+ChunkedEvolutionWriter::~ChunkedEvolutionWriter() {
+    close();
+}
+
+
+void ChunkedEvolutionWriter::write_field(const double tau, const int field,
+                                         const float *data) {
+    if (tau_list_.empty() || tau != tau_list_.back()) {
+        tau_list_.push_back(tau);
+    }
+    const size_t n_points = grid_.get_number_of_points();
+    const unsigned char *stored = reinterpret_cast<const unsigned char*>(
+                                                                    data);
+    size_t stored_size = n_points*sizeof(float);
+    int32_t chunk_codec = kRaw;
+    if (codec_ != kRaw) {
+        // chunks that do not compress are stored raw
+        chunk_codec = FloatCodec::compress(codec_, data, n_points, buffer_);
+        stored = buffer_.data();
+        stored_size = buffer_.size();
+    }
+
+    ChunkHeader chunk_header;
+    std::memcpy(chunk_header.tag, kChunkTag, 4);
+    chunk_header.field = field;
+    chunk_header.tau = tau;
+    chunk_header.itau = static_cast<int32_t>(tau_list_.size()) - 1;
+    chunk_header.codec = chunk_codec;
+    chunk_header.stored_size = static_cast<int64_t>(stored_size);
+    const int64_t offset = static_cast<int64_t>(ftell(file_));
+    fwrite(&chunk_header, sizeof(ChunkHeader), 1, file_);
+    fwrite(stored, sizeof(unsigned char), stored_size, file_);
+    index_.push_back({tau, chunk_header.itau, field, offset});
+}
+
+
+void ChunkedEvolutionWriter::close() {
+    if (file_ == nullptr) return;
+    const int64_t index_offset = static_cast<int64_t>(ftell(file_));
+    for (const auto &entry : index_) {
+        fwrite(&entry.tau, sizeof(double), 1, file_);
+        fwrite(&entry.itau, sizeof(int32_t), 1, file_);
+        fwrite(&entry.field, sizeof(int32_t), 1, file_);
+        fwrite(&entry.offset, sizeof(int64_t), 1, file_);
+    }
+    const int64_t n_chunks = static_cast<int64_t>(index_.size());
+    fwrite(&n_chunks, sizeof(int64_t), 1, file_);
+    fwrite(&index_offset, sizeof(int64_t), 1, file_);
+    fwrite(kIndexMagic, sizeof(char), 8, file_);
+    fclose(file_);
+    file_ = nullptr;
+}
+
+
+ChunkedEvolutionReader::ChunkedEvolutionReader(const std::string &filename) :
+        file_(nullptr) {
+    file_ = fopen(filename.c_str(), "rb");
+    if (file_ == nullptr) {
+        music_message << "ChunkedEvolutionReader: can not open file "
+                      << filename;
+        music_message.flush("error");
+        exit(1);
+    }
+    char magic[8];
+    int32_t header[2] = {0, 0};
+    int32_t names_length = 0;
+    bool valid = (fread(magic, sizeof(char), 8, file_) == 8
+                  && std::memcmp(magic, kMagic, 8) == 0
+                  && fread(header, sizeof(int32_t), 2, file_) == 2
+                  && header[0] == ChunkedEvolutionWriter::kFormatVersion
+                  && fread(&grid_, sizeof(ChunkedEvolutionGrid), 1,
+                           file_) == 1
+                  && fread(&names_length, sizeof(int32_t), 1, file_) == 1
+                  && names_length >= 0);
+    std::string names(valid ? names_length : 0, '\0');
+    if (valid) {
+        valid = (fread(&names[0], sizeof(char), names_length, file_)
+                 == static_cast<size_t>(names_length));
+    }
+    if (!valid) {
+        music_message << "ChunkedEvolutionReader: " << filename
+                      << " is not a chunked evolution file";
+        music_message.flush("error");
+        exit(1);
+    }
+    names.resize(std::strlen(names.c_str()));
+    size_t start = 0;
+    for (int i = 0; i < header[1]; i++) {
+        const size_t end = std::min(names.find(',', start), names.size());
+        field_names_.push_back(names.substr(start, end - start));
+        start = end + 1;
+    }
+
+    const int64_t data_offset = kHeaderSize + names_length;
+    fseek(file_, 0, SEEK_END);
+    const int64_t file_size = static_cast<int64_t>(ftell(file_));
+    if (!read_index_table(file_size)) {
+        music_message << "ChunkedEvolutionReader: " << filename
+                      << " has no index table, scanning the chunks";
+        music_message.flush("warning");
+        tau_list_.clear();
+        chunk_offset_.clear();
+        scan_chunks(data_offset, file_size);
+    }
+}
+
+
+ChunkedEvolutionReader::~ChunkedEvolutionReader() {
+    if (file_ != nullptr) fclose(file_);
+}
+
+
+bool ChunkedEvolutionReader::read_index_table(const int64_t file_size) {
+    if (file_size < static_cast<int64_t>(kHeaderSize + kFooterSize)) {
+        return(false);
+    }
+    int64_t footer[2];
+    char magic[8];
+    fseek(file_, file_size - kFooterSize, SEEK_SET);
+    if (fread(footer, sizeof(int64_t), 2, file_) != 2
+            || fread(magic, sizeof(char), 8, file_) != 8
+            || std::memcmp(magic, kIndexMagic, 8) != 0) {
+        return(false);
+    }
+    const int64_t n_chunks = footer[0];
+    const int64_t index_offset = footer[1];
+    if (n_chunks < 0 || index_offset < 0
+            || index_offset + n_chunks*static_cast<int64_t>(kIndexEntrySize)
+               + static_cast<int64_t>(kFooterSize) != file_size) {
+        return(false);
+    }
+    fseek(file_, index_offset, SEEK_SET);
+    for (int64_t i = 0; i < n_chunks; i++) {
+        double tau;
+        int32_t itau_field[2];
+        int64_t offset;
+        if (fread(&tau, sizeof(double), 1, file_) != 1
+                || fread(itau_field, sizeof(int32_t), 2, file_) != 2
+                || fread(&offset, sizeof(int64_t), 1, file_) != 1) {
+            return(false);
+        }
+        add_chunk(tau, itau_field[0], itau_field[1], offset);
+    }
+    return(true);
+}
+
+
+void ChunkedEvolutionReader::scan_chunks(const int64_t data_offset,
+                                         const int64_t file_size) {
+    int64_t offset = data_offset;
+    ChunkHeader chunk_header;
+    while (offset + static_cast<int64_t>(kChunkHeaderSize) <= file_size) {
+        fseek(file_, offset, SEEK_SET);
+        if (fread(&chunk_header, sizeof(ChunkHeader), 1, file_) != 1
+                || std::memcmp(chunk_header.tag, kChunkTag, 4) != 0) {
+            break;
+        }
+        const int64_t next = (offset + kChunkHeaderSize
+                              + chunk_header.stored_size);
+        if (next > file_size) break;  // a chunk cut off by the end of file
+        add_chunk(chunk_header.tau, chunk_header.itau, chunk_header.field,
+                  offset);
+        offset = next;
+    }
+}
+
+
+void ChunkedEvolutionReader::add_chunk(const double tau, const int itau,
+                                       const int field,
+                                       const int64_t offset) {
+    const int n_fields = get_number_of_fields();
+    if (itau < 0 || field < 0 || field >= n_fields) return;
+    if (itau >= get_number_of_tau()) {
+        tau_list_.resize(itau + 1, tau);
+        chunk_offset_.resize(static_cast<size_t>(itau + 1)*n_fields, -1);
+    }
+    tau_list_[itau] = tau;
+    chunk_offset_[static_cast<size_t>(itau)*n_fields + field] = offset;
+}
+
+
+int ChunkedEvolutionReader::get_field_index(const std::string &name) const {
+    for (int i = 0; i < get_number_of_fields(); i++) {
+        if (field_names_[i] == name) return(i);
+    }
+    return(-1);
+}
+
+
+bool ChunkedEvolutionReader::read_field(const int itau, const int field,
+                                        std::vector<float> &data) {
+    if (itau < 0 || itau >= get_number_of_tau()
+            || field < 0 || field >= get_number_of_fields()) {
+        return(false);
+    }
+    const int64_t offset = chunk_offset_[
+                    static_cast<size_t>(itau)*get_number_of_fields() + field];
+    if (offset < 0) return(false);
+    ChunkHeader chunk_header;
+    fseek(file_, offset, SEEK_SET);
+    if (fread(&chunk_header, sizeof(ChunkHeader), 1, file_) != 1) {
+        return(false);
+    }
+    const size_t n_points = grid_.get_number_of_points();
+    const size_t stored_size = chunk_header.stored_size;
+    data.resize(n_points);
+    if (chunk_header.codec == ChunkedEvolutionWriter::kRaw) {
+        if (stored_size != n_points*sizeof(float)) return(false);
+        return(fread(data.data(), sizeof(float), n_points, file_)
+               == n_points);
+    }
+    if (FloatCodec::is_available(chunk_header.codec)) {
+        std::vector<unsigned char> stored(stored_size);
+        if (fread(stored.data(), sizeof(unsigned char), stored_size, file_)
+                != stored_size) {
+            return(false);
+        }
+        return(FloatCodec::decompress(chunk_header.codec, stored.data(),
+                                      stored_size, n_points, data.data()));
+    }
+    music_message << "ChunkedEvolutionReader: codec " << chunk_header.codec
+                  << " is not available";
+    music_message.flush("error");
+    return(false);
+}
@@ -0,0 +1,141 @@
+#ifndef SRC_CHUNKED_EVOLUTION_FILE_H_
+#define SRC_CHUNKED_EVOLUTION_FILE_H_
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "float_codec.h"
+#include "pretty_ostream.h"
+
+//! the output grid of a chunked evolution file
+struct ChunkedEvolutionGrid {
+    int32_t nx = 0;
+    int32_t ny = 0;
+    int32_t neta = 0;
+    int32_t reserved = 0;
+    double tau0 = 0.;
+    double dtau = 0.;
+    double dx = 0.;
+    double dy = 0.;
+    double deta = 0.;
+    double x_min = 0.;
+    double y_min = 0.;
+    double eta_min = 0.;
+
+    int64_t get_number_of_points() const {
+        return(static_cast<int64_t>(nx)*ny*neta);
+    }
+};
+
+
+//! This class writes a chunked, columnar hydro evolution file. Each chunk
+//! holds one field at one tau on all nx*ny*neta output points (ix
+//! innermost, ieta outermost), so readers can seek to a single slice.
+//!
+//! File layout: the 8 char magic "MUSICEVC", the int32 format version,
+//! the int32 number of fields, the ChunkedEvolutionGrid, the int32 length
+//! of the comma separated field names and the names padded with '\0' to a
+//! multiple of 8 bytes of the header. The chunks follow, each a 32 byte
+//! header (the 4 char tag "CHNK", the int32 field, the double tau, the
+//! int32 tau index, the int32 codec, the int64 size of the stored data)
+//! and the stored data. close() appends the index table of the chunks
+//! (double tau, int32 tau index, int32 field, int64 chunk offset each),
+//! the int64 number of chunks, the int64 offset of the table and the
+//! 8 char magic "MUSICIDX". A file without the index (an interrupted run)
+//! is indexed by the reader from the chunk headers.
+class ChunkedEvolutionWriter {
+ public:
+    //! the codecs of the chunk data
+    enum Codec {
+        kRaw = FloatCodec::kRaw,    //!< the floats as they are
+        kZlib = FloatCodec::kZlib,  //!< byte-shuffled floats with zlib
+    };
+    static const int32_t kFormatVersion = 1;
+
+    //! returns whether the codec is compiled in (zlib needs -DZLIB)
+    static bool codec_is_available(const int codec);
+
+ private:
+    FILE *file_;
+    const ChunkedEvolutionGrid grid_;
+    const int n_fields_;
+    const int codec_;
+    std::vector<double> tau_list_;
+    struct IndexEntry {
+        double tau;
+        int32_t itau;
+        int32_t field;
+        int64_t offset;
+    };
+    std::vector<IndexEntry> index_;
+    std::vector<unsigned char> buffer_;
+    pretty_ostream music_message;
+
+ public:
+    ChunkedEvolutionWriter(const std::string &filename,
+                           const ChunkedEvolutionGrid &grid,
+                           const std::vector<std::string> &field_names,
+                           const int codec);
+    //! closes the file if close() was not called
+    ~ChunkedEvolutionWriter();
+
+    ChunkedEvolutionWriter(const ChunkedEvolutionWriter&) = delete;
+    ChunkedEvolutionWriter& operator=(const ChunkedEvolutionWriter&) = delete;
+
+    //! appends the field at tau with grid.get_number_of_points() values.
+    //! The fields of one tau are written before the next tau. A chunk
+    //! that does not get smaller with the codec is stored raw.
+    void write_field(const double tau, const int field, const float *data);
+
+    //! writes the index table and closes the file
+    void close();
+};
+
+
+//! This class reads a file written by ChunkedEvolutionWriter. Only the
+//! header and the index are read when it is opened, read_field() seeks to
+//! the chunk of one field at one tau.
+class ChunkedEvolutionReader {
+ private:
+    FILE *file_;
+    ChunkedEvolutionGrid grid_;
+    std::vector<std::string> field_names_;
+    std::vector<double> tau_list_;
+    //! [itau*n_fields + field] offset of the chunk header, -1 if missing
+    std::vector<int64_t> chunk_offset_;
+    pretty_ostream music_message;
+
+    bool read_index_table(const int64_t file_size);
+    void scan_chunks(const int64_t data_offset, const int64_t file_size);
+    void add_chunk(const double tau, const int itau, const int field,
+                   const int64_t offset);
+
+ public:
+    //! opens filename, exits with an error if it is not a chunked
+    //! evolution file
+    explicit ChunkedEvolutionReader(const std::string &filename);
+    ~ChunkedEvolutionReader();
+
+    ChunkedEvolutionReader(const ChunkedEvolutionReader&) = delete;
+    ChunkedEvolutionReader& operator=(const ChunkedEvolutionReader&) = delete;
+
+    const ChunkedEvolutionGrid &get_grid() const {return(grid_);}
+    int get_number_of_fields() const {
+        return(static_cast<int>(field_names_.size()));
+    }
+    const std::string &get_field_name(const int field) const {
+        return(field_names_[field]);
+    }
+    //! returns the index of the field name, -1 if there is no such field
+    int get_field_index(const std::string &name) const;
+
+    int get_number_of_tau() const {return(static_cast<int>(tau_list_.size()));}
+    double get_tau(const int itau) const {return(tau_list_[itau]);}
+
+    //! reads the field at the tau index itau into data. It returns false
+    //! if the file has no such chunk.
+    bool read_field(const int itau, const int field, std::vector<float> &data);
+};
+
+#endif  // SRC_CHUNKED_EVOLUTION_FILE_H_
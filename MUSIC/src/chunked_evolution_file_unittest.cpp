@@ -0,0 +1,115 @@
+#include "doctest.h"
+#include "chunked_evolution_file.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+    ChunkedEvolutionGrid get_test_grid() {
+        ChunkedEvolutionGrid grid;
+        grid.nx = 5;
+        grid.ny = 4;
+        grid.neta = 3;
+        grid.tau0 = 0.4;
+        grid.dtau = 0.1;
+        grid.dx = 0.5;
+        grid.dy = 0.5;
+        grid.deta = 0.2;
+        grid.x_min = -1.0;
+        grid.y_min = -0.75;
+        grid.eta_min = -0.2;
+        return(grid);
+    }
+
+    float get_test_value(const int itau, const int field, const int i) {
+        return(0.25f*itau + 10.f*field + 0.001f*i);
+    }
+
+    void write_test_file(const std::string &filename, const int codec,
+                         const int n_tau) {
+        const ChunkedEvolutionGrid grid = get_test_grid();
+        ChunkedEvolutionWriter writer(filename, grid, {"e", "T", "ux"}, codec);
+        std::vector<float> data(grid.get_number_of_points());
+        for (int itau = 0; itau < n_tau; itau++) {
+            for (int field = 0; field < 3; field++) {
+                for (unsigned int i = 0; i < data.size(); i++) {
+                    data[i] = get_test_value(itau, field, i);
+                }
+                writer.write_field(grid.tau0 + itau*grid.dtau, field,
+                                   data.data());
+            }
+        }
+    }
+
+    void check_test_file(const std::string &filename, const int n_tau) {
+        ChunkedEvolutionReader reader(filename);
+        const ChunkedEvolutionGrid &grid = reader.get_grid();
+        CHECK(grid.nx == 5);
+        CHECK(grid.ny == 4);
+        CHECK(grid.neta == 3);
+        CHECK(grid.x_min == -1.0);
+        CHECK(grid.deta == 0.2);
+        REQUIRE(reader.get_number_of_fields() == 3);
+        CHECK(reader.get_field_name(1) == "T");
+        CHECK(reader.get_field_index("ux") == 2);
+        CHECK(reader.get_field_index("muB") == -1);
+        REQUIRE(reader.get_number_of_tau() == n_tau);
+        CHECK(reader.get_tau(2) == doctest::Approx(0.6));
+
+        std::vector<float> data;
+        // read the slices out of order
+        for (int itau = n_tau - 1; itau >= 0; itau--) {
+            for (int field = 2; field >= 0; field--) {
+                REQUIRE(reader.read_field(itau, field, data));
+                REQUIRE(data.size() == 60);
+                bool all_equal = true;
+                for (unsigned int i = 0; i < data.size(); i++) {
+                    all_equal = (all_equal
+                                 && data[i] == get_test_value(itau, field, i));
+                }
+                CHECK(all_equal);
+            }
+        }
+        CHECK(!reader.read_field(n_tau, 0, data));
+        CHECK(!reader.read_field(0, 3, data));
+    }
+}
+
+TEST_CASE("Check ChunkedEvolutionWriter and Reader round trip") {
+    std::vector<int> codecs = {ChunkedEvolutionWriter::kRaw};
+    if (ChunkedEvolutionWriter::codec_is_available(
+                                    ChunkedEvolutionWriter::kZlib)) {
+        codecs.push_back(ChunkedEvolutionWriter::kZlib);
+    }
+    const std::string filename = "test_chunked_evolution.dat";
+    for (auto codec : codecs) {
+        write_test_file(filename, codec, 4);
+        check_test_file(filename, 4);
+    }
+    remove(filename.c_str());
+}
+
+TEST_CASE("Check ChunkedEvolutionReader reads a file without the index") {
+    const std::string filename = "test_chunked_evolution_no_index.dat";
+    write_test_file(filename, ChunkedEvolutionWriter::kRaw, 3);
+    // cut off the index table and a part of the last chunk
+    FILE *file = fopen(filename.c_str(), "rb");
+    std::vector<char> content;
+    int c;
+    while ((c = fgetc(file)) != EOF) content.push_back(static_cast<char>(c));
+    fclose(file);
+    std::vector<char> truncated(content.begin(),
+                                content.end() - (9*24 + 24 + 4*60 + 10));
+    file = fopen(filename.c_str(), "wb");
+    fwrite(truncated.data(), 1, truncated.size(), file);
+    fclose(file);
+
+    ChunkedEvolutionReader reader(filename);
+    REQUIRE(reader.get_number_of_tau() == 3);
+    std::vector<float> data;
+    CHECK(reader.read_field(2, 1, data));
+    CHECK(data[7] == get_test_value(2, 1, 7));
+    // the truncated last chunk is missing
+    CHECK(!reader.read_field(2, 2, data));
+    remove(filename.c_str());
+}
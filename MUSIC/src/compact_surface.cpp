@@ -0,0 +1,35 @@
+#include <cmath>
+#include "compact_surface.h"
+
+void CompactSurface::resize(const int n_cells) {
+    n_cells_ = n_cells;
+    data_.assign(static_cast<size_t>(SurfaceField::n_fields)*n_cells_, 0.f);
+    memory_.set(static_cast<int64_t>(data_.capacity()*sizeof(float)));
+}
+
+
+void CompactSurface::set_element(const int i, const float *row,
+                                 const bool boost_invariant) {
+    // the fields of the binary surface row used by the spectra and the
+    // hadron sampler
+    const int row_index[SurfaceField::n_fields] = {
+        0, 3, -1, -1,               // tau, eta_s (sinh, cosh below)
+        4, 5, 6, 7,                 // d^3 sigma_mu
+        8, 9, 10, 11,               // u^mu
+        13, 14, 17,                 // T, mu_B, (e + P)/T
+        18, 19, 20, 21, 22, 23, 24, 25, 26, 27,  // W^{mu nu}
+        28, 29,                     // Pi, rho_B
+        30, 31, 32, 33,             // q^mu
+        1, 2};                      // x, y
+    float *element = &data_[i];
+    for (int field = 0; field < SurfaceField::n_fields; field++) {
+        if (row_index[field] < 0) continue;
+        element[static_cast<size_t>(field)*n_cells_] = row[row_index[field]];
+    }
+    const double eta_s = boost_invariant ? 0. : row[3];
+    element[static_cast<size_t>(SurfaceField::eta_s)*n_cells_] = eta_s;
+    element[static_cast<size_t>(SurfaceField::sinh_eta_s)*n_cells_] = (
+                                                            sinh(eta_s));
+    element[static_cast<size_t>(SurfaceField::cosh_eta_s)*n_cells_] = (
+                                                            cosh(eta_s));
+}
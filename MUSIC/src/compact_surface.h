@@ -0,0 +1,68 @@
+#ifndef SRC_COMPACT_SURFACE_H_
+#define SRC_COMPACT_SURFACE_H_
+
+#include <cstddef>
+#include <vector>
+#include "memory_accounting.h"
+
+//! field offsets of CompactSurface
+namespace SurfaceField {
+    enum {
+        tau               = 0,
+        eta_s             = 1,
+        sinh_eta_s        = 2,
+        cosh_eta_s        = 3,
+        s                 = 4,    //!< d^3 sigma_mu in (tau, x, y, eta)
+        u                 = 8,    //!< u^mu in (tau, x, y, eta)
+        T_f               = 12,
+        mu_B              = 13,
+        eps_plus_p_over_T = 14,
+        //! W^{mu nu}: tautau, taux, tauy, taueta, xx, xy, xeta, yy,
+        //! yeta, etaeta
+        W                 = 15,
+        pi_b              = 25,
+        rho_B             = 26,
+        q                 = 27,   //!< q^mu in (tau, x, y, eta)
+        x                 = 31,   //!< the position of the element [fm]
+        y                 = 32,
+        n_fields          = 33,
+    };
+}
+
+
+//! This class holds the freeze-out surface of Cooper-Frye as a structure
+//! of arrays of floats. It keeps only the fields used by the spectra and
+//! the hadron sampler, the 10 independent components of W^{mu nu}, and
+//! sinh and cosh of eta_s computed once per element; the spectra are
+//! accumulated in double.
+class CompactSurface {
+ private:
+    int n_cells_;
+    std::vector<float> data_;
+    MemoryRegistration memory_;
+
+ public:
+    CompactSurface()
+        : n_cells_(0), memory_(MemorySubsystem::cooper_frye) {}
+
+    //! this function sets the number of elements (all fields zero)
+    void resize(const int n_cells);
+    void clear() {resize(0);}
+    int size() const {return(n_cells_);}
+
+    //! this function fills the element i from a row of a binary surface
+    //! (see freezeout_surface.h). eta_s is set to 0 if boost_invariant.
+    void set_element(const int i, const float *row,
+                     const bool boost_invariant);
+
+    //! the field (see SurfaceField) of the element i
+    double get(const int field, const int i) const {
+        return(data_[static_cast<size_t>(field)*n_cells_ + i]);
+    }
+    void set(const int field, const int i, const double value) {
+        data_[static_cast<size_t>(field)*n_cells_ + i] = (
+                                            static_cast<float>(value));
+    }
+};
+
+#endif  // SRC_COMPACT_SURFACE_H_
@@ -0,0 +1,42 @@
+#include "doctest.h"
+#include "compact_surface.h"
+#include <cmath>
+
+TEST_CASE("Check CompactSurface set_element") {
+    float row[34];
+    for (int i = 0; i < 34; i++) row[i] = 0.5f + i;
+
+    CompactSurface surface;
+    surface.resize(2);
+    surface.set_element(1, row, false);
+    CHECK(surface.size() == 2);
+    CHECK(surface.get(SurfaceField::tau, 1) == row[0]);
+    CHECK(surface.get(SurfaceField::x, 1) == row[1]);
+    CHECK(surface.get(SurfaceField::y, 1) == row[2]);
+    CHECK(surface.get(SurfaceField::eta_s, 1) == row[3]);
+    CHECK(surface.get(SurfaceField::sinh_eta_s, 1)
+          == doctest::Approx(std::sinh(row[3])).epsilon(1e-6));
+    CHECK(surface.get(SurfaceField::cosh_eta_s, 1)
+          == doctest::Approx(std::cosh(row[3])).epsilon(1e-6));
+    for (int ii = 0; ii < 4; ii++) {
+        CHECK(surface.get(SurfaceField::s + ii, 1) == row[4 + ii]);
+        CHECK(surface.get(SurfaceField::u + ii, 1) == row[8 + ii]);
+        CHECK(surface.get(SurfaceField::q + ii, 1) == row[30 + ii]);
+    }
+    CHECK(surface.get(SurfaceField::T_f, 1) == row[13]);
+    CHECK(surface.get(SurfaceField::mu_B, 1) == row[14]);
+    CHECK(surface.get(SurfaceField::eps_plus_p_over_T, 1) == row[17]);
+    for (int ii = 0; ii < 10; ii++) {
+        CHECK(surface.get(SurfaceField::W + ii, 1) == row[18 + ii]);
+    }
+    CHECK(surface.get(SurfaceField::pi_b, 1) == row[28]);
+    CHECK(surface.get(SurfaceField::rho_B, 1) == row[29]);
+    // the other element is untouched
+    CHECK(surface.get(SurfaceField::tau, 0) == 0.);
+
+    // boost-invariant surfaces are at eta_s = 0
+    surface.set_element(0, row, true);
+    CHECK(surface.get(SurfaceField::eta_s, 0) == 0.);
+    CHECK(surface.get(SurfaceField::sinh_eta_s, 0) == 0.);
+    CHECK(surface.get(SurfaceField::cosh_eta_s, 0) == 1.);
+}
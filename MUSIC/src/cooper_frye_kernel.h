@@ -0,0 +1,361 @@
+#ifndef SRC_COOPER_FRYE_KERNEL_H_
+#define SRC_COOPER_FRYE_KERNEL_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+//! the quantities of a surface cell shared by the Cooper-Frye integrands
+//! of all the particle species (see Freeze::get_freeze_cell_info)
+struct FreezeCellInfo {
+    double tau, eta_s, cosh_eta_s, sinh_eta_s;
+    double T, muB;                  // GeV
+    double sigma_mu[4], u_flow[4];
+    double W[10];                   // W^{mu nu}, zero without shear delta f
+    double Pi_bulk;
+    double bulk_deltaf_coeffs[3];
+    double q[4];
+    double deltaf_qmu_coeff;
+    double deltaf_qmu_coeff_14mom_DV, deltaf_qmu_coeff_14mom_BV;
+    double prefactor_shear;         // fm^4/GeV^2
+    double prefactor_qmu;           // 1/GeV
+    int flag_shear_deltaf, flag_bulk_deltaf, flag_qmu_deltaf;
+};
+
+
+//! the particle species in the Cooper-Frye integrand
+struct CooperFryeSpecies {
+    double m;                       // GeV
+    int baryon;
+    double sign;                    // -1 for bosons, +1 for fermions
+    double mu;                      // GeV
+};
+
+
+//! the Cooper-Frye integrand (f_0 + delta f) p^mu dSigma_mu of a surface
+//! cell. get_integrand is the scalar reference; add_phi_integrand evaluates
+//! a row of azimuthal angles at fixed pT in a loop the compiler vectorizes,
+//! with the delta f terms selected at compile time and fast_exp in place of
+//! std::exp.
+namespace CooperFrye {
+
+//! exp(x) for x in [-708, 708], the argument is clamped to this range
+//! (exp(708) ~ 3e307 so 1/(exp(x) +- 1) differs from 0 by less than
+//! 1e-307 above). x = n ln2 + r with |r| <= ln2/2, and exp(r) is the
+//! Taylor polynomial of degree 12, whose truncation error is below
+//! 3.4e-16 relative; together with the rounding the relative error is
+//! below 1e-15. The clamp is a select on x and 2^n is built from the bits,
+//! so loops over the function vectorize.
+inline double fast_exp(double x) {
+    const double round_magic = 6755399441055744.0;  // 1.5*2^52
+    const double log2e = 1.4426950408889634;
+    const double ln2_hi = 6.93147180369123816490e-01;
+    const double ln2_lo = 1.90821492927058770002e-10;
+    x = fabs(x) < 708. ? x : copysign(708., x);
+    // n = round(x/ln2), stored in the low bits of t
+    const double t = x*log2e + round_magic;
+    const double n = t - round_magic;
+    const double r = (x - n*ln2_hi) - n*ln2_lo;
+    // the Taylor polynomial in Estrin's scheme, which keeps the chain of
+    // dependent multiplications short
+    const double r2 = r*r;
+    const double r4 = r2*r2;
+    const double r8 = r4*r4;
+    const double a0 = 1. + r;
+    const double a1 = 0.5 + r*(1./6.);
+    const double a2 = 1./24. + r*(1./120.);
+    const double a3 = 1./720. + r*(1./5040.);
+    const double a4 = 1./40320. + r*(1./362880.);
+    const double a5 = 1./3628800. + r*(1./39916800.);
+    const double a6 = 1./479001600.;
+    const double b0 = a0 + a1*r2;
+    const double b1 = a2 + a3*r2;
+    const double b2 = a4 + a5*r2;
+    const double p = (b0 + b1*r4) + (b2 + a6*r4)*r8;
+    // 2^n from the exponent bits
+    union {double d; uint64_t i;} bits;
+    bits.d = t;
+    bits.i = (bits.i - UINT64_C(0x4338000000000000) + 1023) << 52;
+    const double scale = bits.d;
+    return(p*scale);
+}
+
+
+//! the shear delta f, f_0 (1 -+ f_0) p^mu p^nu W_{mu nu}/(2(e + P)T^2)
+//! (the quadratic Ansatz, the same for all species)
+inline double get_shear_delta_f(const FreezeCellInfo &cell, const double f,
+                                const double sign, const double ptau,
+                                const double px, const double py,
+                                const double peta) {
+    const double *W = cell.W;
+    const double Wfactor = (ptau*W[0]*ptau - 2.*ptau*W[1]*px
+                            - 2.*ptau*W[2]*py
+                            - 2.*ptau*W[3]*peta
+                            + px*W[4]*px + 2.*px*W[5]*py
+                            + 2.*px*W[6]*peta
+                            + py*W[7]*py + 2.*py*W[8]*peta
+                            + peta*W[9]*peta);
+    return(f*(1. - sign*f)*cell.prefactor_shear*Wfactor);
+}
+
+
+//! the bulk delta f of the kind bulk_deltaf_kind (see Freeze)
+inline double get_bulk_delta_f(const FreezeCellInfo &cell,
+                               const int bulk_deltaf_kind, const double f,
+                               const double sign, const double m,
+                               const double E) {
+    const double T = cell.T;
+    const double Pi_bulk = cell.Pi_bulk;
+    const double *bulk_deltaf_coeffs = cell.bulk_deltaf_coeffs;
+    double delta_f_bulk = 0.0;
+    if (bulk_deltaf_kind == 0) {
+        delta_f_bulk = (
+            - f*(1. - sign*f)*Pi_bulk
+            *(bulk_deltaf_coeffs[0]*m*m
+              + bulk_deltaf_coeffs[1]*E
+              + bulk_deltaf_coeffs[2]*E*E));
+    } else if (bulk_deltaf_kind == 1) {
+        double E_over_T = E/T;
+        double mass_over_T = m/T;
+        delta_f_bulk = (
+            - f*(1. - sign*f)/E_over_T
+            *bulk_deltaf_coeffs[0]
+            *(mass_over_T*mass_over_T/3.
+              - bulk_deltaf_coeffs[1]*E_over_T*E_over_T)
+            *Pi_bulk);
+    } else if (bulk_deltaf_kind == 2) {
+        double E_over_T = E/T;
+        delta_f_bulk = (
+            - f*(1. - sign*f)
+            *(-bulk_deltaf_coeffs[0] + bulk_deltaf_coeffs[1]*E_over_T)
+            *Pi_bulk);
+    } else if (bulk_deltaf_kind == 3) {
+        double E_over_T = E/T;
+        delta_f_bulk = (
+            - f*(1.-sign*f)/sqrt(E_over_T)
+                *(- bulk_deltaf_coeffs[0]
+                  + bulk_deltaf_coeffs[1]*E_over_T)
+                *Pi_bulk);
+    } else if (bulk_deltaf_kind == 4) {
+        double E_over_T = E/T;
+        delta_f_bulk = (
+            - f*(1.-sign*f)
+                *(bulk_deltaf_coeffs[0]
+                  - bulk_deltaf_coeffs[1]/E_over_T)
+                *Pi_bulk);
+    }
+    return(delta_f_bulk);
+}
+
+
+//! the delta f of the diffusion current q^mu
+inline double get_qmu_delta_f(const FreezeCellInfo &cell,
+                              const int deltaf_14moments, const double f,
+                              const CooperFryeSpecies &species,
+                              const double E, const double ptau,
+                              const double px, const double py,
+                              const double peta) {
+    // p^\mu q_\mu
+    const double qmufactor = (ptau*cell.q[0] - px*cell.q[1] - py*cell.q[2]
+                              - peta*cell.q[3]);
+    const double sign = species.sign;
+    if (deltaf_14moments == 0) {
+        return(f*(1. - sign*f)*(cell.prefactor_qmu - species.baryon/E)
+               *qmufactor/cell.deltaf_qmu_coeff);
+    }
+    return(f*(1. - sign*f)
+           *(species.baryon*cell.deltaf_qmu_coeff_14mom_DV
+             + 2.*cell.deltaf_qmu_coeff_14mom_BV*E)
+           *qmufactor);
+}
+
+
+//! the total delta f, limited to |delta f| <= f_0 (written as a select
+//! so it does not stop the vectorization)
+inline double limit_delta_f(const double total_deltaf, const double f) {
+    return((f > 0. && fabs(total_deltaf) > f) ? copysign(f, total_deltaf)
+                                              : total_deltaf);
+}
+
+
+//! the scalar Cooper-Frye integrand [fm^3 GeV] at the momentum
+//! (ptau, px, py, peta); f and delta_f_shear are set for the diagnostics
+inline double get_integrand(const FreezeCellInfo &cell,
+                            const int bulk_deltaf_kind,
+                            const int deltaf_14moments,
+                            const CooperFryeSpecies &species,
+                            const double ptau, const double px,
+                            const double py, const double peta,
+                            double &f, double &delta_f_shear) {
+    const double T = cell.T;
+    const double tau = cell.tau;
+    const double *sigma_mu = cell.sigma_mu;
+    const double *u_flow = cell.u_flow;
+    // compute p^mu*dSigma_mu [fm^3*GeV]
+    const double pdSigma = tau*(ptau*sigma_mu[0] + px*sigma_mu[1]
+                                + py*sigma_mu[2] + peta/tau*sigma_mu[3]);
+    const double E = (ptau*u_flow[0] - px*u_flow[1]
+                      - py*u_flow[2] - peta*u_flow[3]);
+    // this is the equilibrium f, f_0:
+    f = 1./(exp(1./T*(E - species.mu)) + species.sign);
+
+    delta_f_shear = 0.0;
+    if (cell.flag_shear_deltaf == 1) {
+        delta_f_shear = get_shear_delta_f(cell, f, species.sign,
+                                          ptau, px, py, peta);
+    }
+    double delta_f_bulk = 0.0;
+    if (cell.flag_bulk_deltaf == 1) {
+        delta_f_bulk = get_bulk_delta_f(cell, bulk_deltaf_kind, f,
+                                        species.sign, species.m, E);
+    }
+    double delta_f_qmu = 0.0;
+    if (cell.flag_qmu_deltaf == 1) {
+        delta_f_qmu = get_qmu_delta_f(cell, deltaf_14moments, f, species, E,
+                                      ptau, px, py, peta);
+    }
+    const double total_deltaf = limit_delta_f(
+                        delta_f_shear + delta_f_bulk + delta_f_qmu, f);
+    return((f + total_deltaf)*pdSigma);
+}
+
+
+//! this function adds weight times the Cooper-Frye integrand at the
+//! n_phi azimuthal angles of (cos_phi, sin_phi) and pT = pt to sum_phi,
+//! with the delta f terms fixed at compile time: bulk_kind is the
+//! bulk_deltaf_kind and qmu_kind the deltaf_14moments, -1 without the
+//! term (the loop of bulk_kind 3 is not vectorized, sqrt sets errno). It
+//! returns true if the integrand exceeds 10000 or f_0 < 0 at some angle,
+//! for which the caller reports the row with get_integrand.
+template <bool shear, int bulk_kind, int qmu_kind>
+bool add_phi_integrand_deltaf(const FreezeCellInfo &cell,
+                              const CooperFryeSpecies &species,
+                              const double pt, const double ptau,
+                              const double peta, const int n_phi,
+                              const double *cos_phi, const double *sin_phi,
+                              const double weight, double *sum_phi) {
+    const double inv_T = 1./cell.T;
+    const double tau = cell.tau;
+    const double *sigma_mu = cell.sigma_mu;
+    const double *u_flow = cell.u_flow;
+    const double mu = species.mu;
+    const double sign = species.sign;
+    double sum_max = 0.0;
+    double f_min = 1.0;
+    #pragma omp simd reduction(max:sum_max) reduction(min:f_min)
+    for (int iphi = 0; iphi < n_phi; iphi++) {
+        const double px = pt*cos_phi[iphi];
+        const double py = pt*sin_phi[iphi];
+        const double pdSigma = tau*(ptau*sigma_mu[0] + px*sigma_mu[1]
+                                    + py*sigma_mu[2] + peta/tau*sigma_mu[3]);
+        const double E = (ptau*u_flow[0] - px*u_flow[1]
+                          - py*u_flow[2] - peta*u_flow[3]);
+        const double f = 1./(fast_exp(inv_T*(E - mu)) + sign);
+        double total_deltaf = 0.0;
+        if (shear) {
+            total_deltaf += get_shear_delta_f(cell, f, sign,
+                                              ptau, px, py, peta);
+        }
+        if (bulk_kind >= 0) {
+            total_deltaf += get_bulk_delta_f(cell, bulk_kind, f, sign,
+                                             species.m, E);
+        }
+        if (qmu_kind >= 0) {
+            total_deltaf += get_qmu_delta_f(cell, qmu_kind, f, species, E,
+                                            ptau, px, py, peta);
+        }
+        if (shear || bulk_kind >= 0 || qmu_kind >= 0) {
+            total_deltaf = limit_delta_f(total_deltaf, f);
+        }
+        const double sum = (f + total_deltaf)*pdSigma;
+        sum_phi[iphi] += weight*sum;
+        sum_max = std::max(sum_max, sum);
+        f_min = std::min(f_min, f);
+    }
+    return(sum_max > 10000 || f_min < 0.);
+}
+
+
+//! add_phi_integrand_deltaf with the bulk delta f of the kind bulk_kind
+template <bool shear, int qmu_kind>
+bool add_phi_integrand_bulk(const FreezeCellInfo &cell, const int bulk_kind,
+                            const CooperFryeSpecies &species,
+                            const double pt, const double ptau,
+                            const double peta, const int n_phi,
+                            const double *cos_phi, const double *sin_phi,
+                            const double weight, double *sum_phi) {
+    switch (bulk_kind) {
+        case 0:
+            return(add_phi_integrand_deltaf<shear, 0, qmu_kind>(
+                cell, species, pt, ptau, peta, n_phi, cos_phi, sin_phi,
+                weight, sum_phi));
+        case 1:
+            return(add_phi_integrand_deltaf<shear, 1, qmu_kind>(
+                cell, species, pt, ptau, peta, n_phi, cos_phi, sin_phi,
+                weight, sum_phi));
+        case 2:
+            return(add_phi_integrand_deltaf<shear, 2, qmu_kind>(
+                cell, species, pt, ptau, peta, n_phi, cos_phi, sin_phi,
+                weight, sum_phi));
+        case 3:
+            return(add_phi_integrand_deltaf<shear, 3, qmu_kind>(
+                cell, species, pt, ptau, peta, n_phi, cos_phi, sin_phi,
+                weight, sum_phi));
+        case 4:
+            return(add_phi_integrand_deltaf<shear, 4, qmu_kind>(
+                cell, species, pt, ptau, peta, n_phi, cos_phi, sin_phi,
+                weight, sum_phi));
+        default:
+            return(add_phi_integrand_deltaf<shear, -1, qmu_kind>(
+                cell, species, pt, ptau, peta, n_phi, cos_phi, sin_phi,
+                weight, sum_phi));
+    }
+}
+
+
+//! add_phi_integrand_deltaf with the delta f flags of the cell
+inline bool add_phi_integrand(const FreezeCellInfo &cell,
+                              const int bulk_deltaf_kind,
+                              const int deltaf_14moments,
+                              const CooperFryeSpecies &species,
+                              const double pt, const double ptau,
+                              const double peta, const int n_phi,
+                              const double *cos_phi, const double *sin_phi,
+                              const double weight, double *sum_phi) {
+    const int bulk_kind = (cell.flag_bulk_deltaf == 1) ? bulk_deltaf_kind
+                                                       : -1;
+    const int qmu_kind = (cell.flag_qmu_deltaf == 1)
+                         ? (deltaf_14moments == 0 ? 0 : 1) : -1;
+    const int flags = 3*cell.flag_shear_deltaf + qmu_kind + 1;
+    switch (flags) {
+        case 0:
+            return(add_phi_integrand_bulk<false, -1>(
+                cell, bulk_kind, species, pt, ptau, peta, n_phi, cos_phi,
+                sin_phi, weight, sum_phi));
+        case 1:
+            return(add_phi_integrand_bulk<false, 0>(
+                cell, bulk_kind, species, pt, ptau, peta, n_phi, cos_phi,
+                sin_phi, weight, sum_phi));
+        case 2:
+            return(add_phi_integrand_bulk<false, 1>(
+                cell, bulk_kind, species, pt, ptau, peta, n_phi, cos_phi,
+                sin_phi, weight, sum_phi));
+        case 3:
+            return(add_phi_integrand_bulk<true, -1>(
+                cell, bulk_kind, species, pt, ptau, peta, n_phi, cos_phi,
+                sin_phi, weight, sum_phi));
+        case 4:
+            return(add_phi_integrand_bulk<true, 0>(
+                cell, bulk_kind, species, pt, ptau, peta, n_phi, cos_phi,
+                sin_phi, weight, sum_phi));
+        default:
+            return(add_phi_integrand_bulk<true, 1>(
+                cell, bulk_kind, species, pt, ptau, peta, n_phi, cos_phi,
+                sin_phi, weight, sum_phi));
+    }
+}
+
+}  // namespace CooperFrye
+
+#endif  // SRC_COOPER_FRYE_KERNEL_H_
@@ -0,0 +1,151 @@
+#include "doctest.h"
+#include "cooper_frye_kernel.h"
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+namespace {
+    FreezeCellInfo make_test_cell() {
+        FreezeCellInfo cell;
+        cell.tau = 5.2;
+        cell.eta_s = 0.3;
+        cell.cosh_eta_s = cosh(cell.eta_s);
+        cell.sinh_eta_s = sinh(cell.eta_s);
+        cell.T = 0.15;
+        cell.muB = 0.05;
+        const double sigma_mu[4] = {1.2, -0.3, 0.25, 0.01};
+        const double u_flow[4] = {1.3, 0.6, -0.55, 0.02};
+        const double q[4] = {0.001, 0.02, -0.01, 0.003};
+        for (int ii = 0; ii < 4; ii++) {
+            cell.sigma_mu[ii] = sigma_mu[ii];
+            cell.u_flow[ii] = u_flow[ii];
+            cell.q[ii] = q[ii];
+        }
+        for (int ii = 0; ii < 10; ii++) cell.W[ii] = 0.002*(ii - 4.5);
+        cell.Pi_bulk = -0.01;
+        cell.bulk_deltaf_coeffs[0] = 0.8;
+        cell.bulk_deltaf_coeffs[1] = 0.3;
+        cell.bulk_deltaf_coeffs[2] = 0.1;
+        cell.deltaf_qmu_coeff = 2.5;
+        cell.deltaf_qmu_coeff_14mom_DV = 0.4;
+        cell.deltaf_qmu_coeff_14mom_BV = -0.2;
+        cell.prefactor_shear = 30.;
+        cell.prefactor_qmu = 0.8;
+        cell.flag_shear_deltaf = 1;
+        cell.flag_bulk_deltaf = 1;
+        cell.flag_qmu_deltaf = 1;
+        return(cell);
+    }
+
+    void get_phi_table(const int n_phi, std::vector<double> &cos_phi,
+                       std::vector<double> &sin_phi) {
+        cos_phi.resize(n_phi);
+        sin_phi.resize(n_phi);
+        for (int iphi = 0; iphi < n_phi; iphi++) {
+            cos_phi[iphi] = cos(2.*M_PI*iphi/n_phi);
+            sin_phi[iphi] = sin(2.*M_PI*iphi/n_phi);
+        }
+    }
+}
+
+TEST_CASE("Check fast_exp against std::exp") {
+    double max_error = 0.;
+    for (int i = 0; i <= 140000; i++) {
+        const double x = -700. + 0.01*i + 1e-4;
+        const double exact = exp(x);
+        max_error = std::max(max_error, fabs(CooperFrye::fast_exp(x) - exact)
+                                        /exact);
+    }
+    CHECK(max_error < 1e-15);
+    CHECK(CooperFrye::fast_exp(0.) == 1.);
+    // the argument is clamped
+    CHECK(std::isfinite(CooperFrye::fast_exp(1000.)));
+    CHECK(CooperFrye::fast_exp(-1000.) > 0.);
+}
+
+TEST_CASE("Check the phi row of the Cooper-Frye integrand") {
+    const int n_phi = 48;
+    std::vector<double> cos_phi, sin_phi;
+    get_phi_table(n_phi, cos_phi, sin_phi);
+    CooperFryeSpecies species = {0.938, 1, 1., 0.05};
+    const double pt = 1.1;
+    const double mt = sqrt(species.m*species.m + pt*pt);
+    const double ptau = mt*1.2;
+    const double peta = -mt*0.4;
+    const double weight = 0.7;
+
+    for (int flags = 0; flags < 8; flags++)
+    for (int bulk_kind = 0; bulk_kind < 5; bulk_kind++)
+    for (int deltaf_14moments = 0; deltaf_14moments < 2; deltaf_14moments++) {
+        FreezeCellInfo cell = make_test_cell();
+        cell.flag_shear_deltaf = (flags >> 2) & 1;
+        cell.flag_bulk_deltaf = (flags >> 1) & 1;
+        cell.flag_qmu_deltaf = flags & 1;
+        std::vector<double> sum_phi(n_phi, 1.0);
+        CHECK(!CooperFrye::add_phi_integrand(
+                    cell, bulk_kind, deltaf_14moments, species, pt, ptau,
+                    peta, n_phi, cos_phi.data(), sin_phi.data(), weight,
+                    sum_phi.data()));
+        for (int iphi = 0; iphi < n_phi; iphi++) {
+            double f, delta_f_shear;
+            const double scalar = CooperFrye::get_integrand(
+                    cell, bulk_kind, deltaf_14moments, species,
+                    ptau, pt*cos_phi[iphi], pt*sin_phi[iphi], peta,
+                    f, delta_f_shear);
+            CHECK(sum_phi[iphi] - 1.0
+                  == doctest::Approx(weight*scalar).epsilon(1e-13));
+        }
+    }
+
+    // the rows with f_0 < 0 are flagged
+    CooperFryeSpecies pion = {0.14, 0, -1., 3.};
+    std::vector<double> sum_phi(n_phi, 0.0);
+    CHECK(CooperFrye::add_phi_integrand(
+                make_test_cell(), 0, 0, pion, pt, ptau, peta, n_phi,
+                cos_phi.data(), sin_phi.data(), 1.0, sum_phi.data()));
+}
+
+TEST_CASE("Benchmark the phi row of the Cooper-Frye integrand") {
+    const int n_phi = 48;
+    const int n_pt = 40;
+    const int n_repeat = 200;
+    std::vector<double> cos_phi, sin_phi;
+    get_phi_table(n_phi, cos_phi, sin_phi);
+    const FreezeCellInfo cell = make_test_cell();
+    const CooperFryeSpecies species = {0.14, 0, -1., 0.};
+    std::vector<double> sum_scalar(n_pt*n_phi, 0.0);
+    std::vector<double> sum_vector(n_pt*n_phi, 0.0);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int irepeat = 0; irepeat < n_repeat; irepeat++)
+    for (int ipt = 0; ipt < n_pt; ipt++) {
+        const double pt = 0.05*ipt;
+        const double mt = sqrt(species.m*species.m + pt*pt);
+        for (int iphi = 0; iphi < n_phi; iphi++) {
+            double f, delta_f_shear;
+            sum_scalar[ipt*n_phi + iphi] += CooperFrye::get_integrand(
+                cell, 1, 0, species, mt, pt*cos_phi[iphi], pt*sin_phi[iphi],
+                0., f, delta_f_shear);
+        }
+    }
+    auto middle = std::chrono::steady_clock::now();
+    for (int irepeat = 0; irepeat < n_repeat; irepeat++)
+    for (int ipt = 0; ipt < n_pt; ipt++) {
+        const double pt = 0.05*ipt;
+        const double mt = sqrt(species.m*species.m + pt*pt);
+        CooperFrye::add_phi_integrand(
+            cell, 1, 0, species, pt, mt, 0., n_phi, cos_phi.data(),
+            sin_phi.data(), 1.0, &sum_vector[ipt*n_phi]);
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < n_pt*n_phi; i++) {
+        CHECK(sum_vector[i] == doctest::Approx(sum_scalar[i]).epsilon(1e-12));
+    }
+    const double t_scalar = (
+        std::chrono::duration<double, std::micro>(middle - start).count());
+    const double t_vector = (
+        std::chrono::duration<double, std::micro>(end - middle).count());
+    MESSAGE("Cooper-Frye phi rows: scalar " << t_scalar << " us, vector "
+            << t_vector << " us, speed up " << t_scalar/t_vector);
+}
@@ -22,12 +22,19 @@
  *
  * Last update 03.08.2012 Hannu Holopainen
  *
+ * Modified for MUSIC: find_surface_4d takes the corner values of the
+ * hypercube as a flat array of 16 doubles. find_surfaces_4d finds the
+ * surfaces of several values in one hypercube, which is split into cubes
+ * and squares once for all of them.
+ *
  */
 
+#include <algorithm>
 #include <iostream>
 #include <fstream>
 #include <math.h>
 #include <stdlib.h>
+#include <vector>
 
 using namespace std;
 
@@ -1013,6 +1020,7 @@ class Square
     int Nlines;
     Line *lines;
     int ambiguous;
+    double value_min, value_max;
     void ends_of_edge(double);
     void find_outside(double);
   public:
@@ -1096,9 +1104,13 @@ Square::~Square()
  */
 void Square::init(double **sq, int *c_i, double *c_v, double *dex)
 {
+  value_min = sq[0][0];
+  value_max = sq[0][0];
   for (int i=0; i < SQUARE_DIM; i++) {
     for (int j=0; j < SQUARE_DIM; j++) {
       points[i][j] = sq[i][j];
+      value_min = min(value_min,sq[i][j]);
+      value_max = max(value_max,sq[i][j]);
     }
   }
   for (int i=0; i < DIM-SQUARE_DIM; i++) {
@@ -1126,25 +1138,20 @@ void Square::init(double **sq, int *c_i, double *c_v, double *dex)
 
 /**
  *
- * Construct the lines which represent the surface on this square.
+ * Construct the lines which represent the surface on this square. Can be
+ * called several times with different values for the same square.
  *
  * @param [in] E0 The value which defines surface
  *
  */
 void Square::construct_lines(double E0)
 {
-  //First we check the corner points and see if there are any lines
-  int above=0;
-  for (int i=0; i < DIM-SQUARE_DIM; i++) {
-    for (int j=0; j < DIM-SQUARE_DIM; j++) {
-      if ( points[i][j] >= E0 )
-        above++; 
-    }
-  }
+  Ncuts = 0;
+  Nlines = 0;
+  ambiguous = 0;
   //If all corners are above or below the surface value, no lines in this
-  //square
-  if ( above == 0 || above == 4 ) {
-    Nlines = 0;
+  //square, which the extremes of the corners tell for every value
+  if ( value_max < E0 || value_min >= E0 ) {
     return;
   }
   //First we find the cut points and the points which are always outside of the
@@ -1492,6 +1499,8 @@ void Cube::init(double ***&c, int c_i, double c_v, double *&dex)
   Nlines    = 0;
   Npolygons = 0;
   ambiguous = 0;
+  //The squares do not depend on the value of the surface
+  split_to_squares();
 }
 
 /**
@@ -1546,14 +1555,15 @@ void Cube::split_to_squares()
  * Here we construct polygons from the lines. If the surface cannot be
  * ambiguous, all lines are just added to single polygon, but if the
  * surface might be ambiguous we order the lines and determine how many
- * polygons we have.
+ * polygons we have. Can be called several times with different values for
+ * the same cube.
  *
  */
 void Cube::construct_polygons(double value0)
 {
-  //Let's start by splitting the cube to squares and finding
-  //the lines from them
-  split_to_squares();
+  //The cube was split to squares in init, let's find the lines from them
+  Npolygons = 0;
+  ambiguous = 0;
   for (int i=0; i < NSQUARES; i++) {
     squares[i].construct_lines(value0);
   } 
@@ -1711,12 +1721,14 @@ class Hypercube
     int ambiguous;
     int x1,x2,x3,x4;
     double *dx;
+    double value_min, value_max;
     void split_to_cubes();
     void check_ambiguous(double);
   public:
     Hypercube();
     ~Hypercube();
-    void init(double****,double*);
+    void init(const double*,double*);
+    bool crosses(double);
     void construct_polyhedrons(double);
     int get_Npolyhedrons();
     Polyhedron* get_polyhedrons();
@@ -1771,11 +1783,11 @@ Hypercube::~Hypercube()
  * Initialized the hypercube. Can be used several times to replace the old
  * hypercube with a new one
  *
- * @param [in] c     Values at the corners of cube
+ * @param [in] c     Values at the corners of cube, [((i*2+j)*2+k)*2+l]
  * @param [in] dex   Lenghts of the sides
  *
  */
-void Hypercube::init(double ****c, double *dex)
+void Hypercube::init(const double *c, double *dex)
 {
   dx = dex;
   //Here we fix the non-zero indices
@@ -1783,11 +1795,16 @@ void Hypercube::init(double ****c, double *dex)
   x2 = 1;
   x3 = 2;
   x4 = 3;
+  value_min = c[0];
+  value_max = c[0];
   for (int i=0; i < STEPS; i++) {
     for (int j=0; j < STEPS; j++) {
       for (int k=0; k < STEPS; k++) {
         for (int l=0; l < STEPS; l++) {
-          hcube[i][j][k][l] = c[i][j][k][l];
+          const double v = c[((i*STEPS + j)*STEPS + k)*STEPS + l];
+          hcube[i][j][k][l] = v;
+          value_min = min(value_min,v);
+          value_max = max(value_max,v);
         }
       }
     }
@@ -1796,6 +1813,22 @@ void Hypercube::init(double ****c, double *dex)
   //many hypercubes
   Npolyhedrons = 0;
   ambiguous = 0;
+  //The cubes do not depend on the value of the surface
+  split_to_cubes();
+}
+
+/**
+ *
+ * Tells if the surface of the given value crosses this hypercube, i.e.
+ * some but not all of the corners are above the value.
+ *
+ * @param [in] value0 The value which defines the surface
+ * @return            True if the hypercube contains surface elements
+ *
+ */
+bool Hypercube::crosses(double value0)
+{
+  return ( value_max >= value0 && value_min < value0 );
 }
 
 /**
@@ -1852,12 +1885,14 @@ void Hypercube::split_to_cubes()
  * Here we construct polyhedrons from the polygons. First we check if the surface
  * is ambiguous and if it is not amibiguous we add all polygons to a single
  * polyhedron. If surface is ambiguous we need to connect the polygons one by one
- * and see in the end how many polyhedrons we have. 
+ * and see in the end how many polyhedrons we have. Can be called several
+ * times with different values for the same hypercube.
  *
  */
 void Hypercube::construct_polyhedrons(double value0)
 {
-  split_to_cubes();
+  Npolyhedrons = 0;
+  ambiguous = 0;
   for (int i=0; i < NCUBES; i++) {
     cubes[i].construct_polygons(value0);
   }
@@ -2005,6 +2040,11 @@ class Cornelius
     int Nelements;
     double **normals;
     double **centroids;
+    //elements of the levels of find_surfaces_4d, [level][element][4]
+    int Nlevels;
+    std::vector<int> level_Nelements;
+    std::vector<double> level_normals;
+    std::vector<double> level_centroids;
     int cube_dim;
     int initialized;
     int print_initialized;
@@ -2023,14 +2063,18 @@ class Cornelius
     void find_surface_2d(double**);
     void find_surface_3d(double***);
     void find_surface_3d_print(double***,double*);
-    void find_surface_4d(double****);
+    void find_surface_4d(const double*);
+    void find_surfaces_4d(const double*,const double*,int);
     int get_Nelements();
+    int get_Nelements(int);
     double **get_normals();
     double **get_centroids();
     double **get_normals_4d();
     double **get_centroids_4d();
     double get_centroid_elem(int,int);
     double get_normal_elem(int,int);
+    double get_centroid_elem(int,int,int);
+    double get_normal_elem(int,int,int);
 };
 
 /**
@@ -2041,6 +2085,7 @@ class Cornelius
 Cornelius::Cornelius()
 {
   Nelements = 0;
+  Nlevels = 0;
   initialized = 0;
   print_initialized = 0;
   normals = new double*[MAX_ELEMENTS];
@@ -2240,12 +2285,12 @@ void Cornelius::surface_3d(double ***cube, double *pos, int do_print)
  *
  * Finds the surface elements in 4-dimensional case.
  *
- * @param [in] cube Values at the corners of the cube as a 4d table so that value
- *                  [0][0][0][0] is at (0,0,0,0) and [1][1][1][1] is at
- *                  (dx1,dx2,dx3,dx4).
+ * @param [in] cube Values at the corners of the cube as a flat array so that
+ *                  value [((i*2+j)*2+k)*2+l] is at (i*dx1,j*dx2,k*dx3,l*dx4),
+ *                  [0] at (0,0,0,0) and [15] at (dx1,dx2,dx3,dx4).
  *
  */
-void Cornelius::find_surface_4d(double ****cube)
+void Cornelius::find_surface_4d(const double *cube)
 {
   if ( !initialized || cube_dim != 4 ) {
     cout << "Cornelius not initialized for 4D case" << endl;
@@ -2259,7 +2304,7 @@ void Cornelius::find_surface_4d(double ****cube)
   for (int j=0; j < STEPS; j++) 
   for (int k=0; k < STEPS; k++)
   for (int l=0; l < STEPS; l++)
-    if ( cube[i][j][k][l] >= value0 )
+    if ( cube[((i*STEPS + j)*STEPS + k)*STEPS + l] >= value0 )
       above++;
 
   if ( above == 0 || above == 16 ) {
@@ -2283,6 +2328,52 @@ void Cornelius::find_surface_4d(double ****cube)
   }
 }
 
+/**
+ *
+ * Finds the surface elements of several values in 4-dimensional case. The
+ * hypercube is split into cubes and squares only once, and the values which
+ * do not cross it are skipped by the extremes of the corners. The value
+ * given to init is not used.
+ *
+ * @param [in] cube    Values at the corners of the cube as in find_surface_4d.
+ * @param [in] levels  Values which define the surfaces.
+ * @param [in] Nlev    Number of the values.
+ *
+ */
+void Cornelius::find_surfaces_4d(const double *cube, const double *levels,
+                                 int Nlev)
+{
+  if ( !initialized || cube_dim != 4 ) {
+    cout << "Cornelius not initialized for 4D case" << endl;
+    exit(1);
+  }
+  Nlevels = Nlev;
+  if ( int(level_Nelements.size()) < Nlevels ) {
+    level_Nelements.resize(Nlevels);
+    level_normals.resize(Nlevels*MAX_ELEMENTS*DIM);
+    level_centroids.resize(Nlevels*MAX_ELEMENTS*DIM);
+  }
+  cu4d.init(cube,dx);
+  for (int ilevel=0; ilevel < Nlevels; ilevel++) {
+    level_Nelements[ilevel] = 0;
+    //If all or none of the corners are below the value, no surface
+    //elements exist for it.
+    if ( !cu4d.crosses(levels[ilevel]) ) {
+      continue;
+    }
+    cu4d.construct_polyhedrons(levels[ilevel]);
+    level_Nelements[ilevel] = cu4d.get_Npolyhedrons();
+    Polyhedron *p = cu4d.get_polyhedrons();
+    for (int i=0; i < level_Nelements[ilevel]; i++) {
+      const int offset = (ilevel*MAX_ELEMENTS + i)*DIM;
+      for (int j=0; j < DIM; j++) {
+        level_centroids[offset+j] = p[i].get_centroid()[j];
+        level_normals[offset+j] = p[i].get_normal()[j];
+      }
+    }
+  }
+}
+
 /**
  *
  * Returns the number of the surface elements in the given cube.
@@ -2295,6 +2386,23 @@ int Cornelius::get_Nelements()
   return Nelements;
 }
 
+/**
+ *
+ * Returns the number of the surface elements of a value of find_surfaces_4d.
+ *
+ * @param [in] ilevel Index of the value.
+ * @return            Number of surface elements of the value.
+ *
+ */
+int Cornelius::get_Nelements(int ilevel)
+{
+  if ( ilevel >= Nlevels ) {
+    cout << "Cornelius error: asking for a level which does not exist." << endl;
+    exit(1);
+  }
+  return level_Nelements[ilevel];
+}
+
 /**
  *
  * Returns the centroid vectors as a 2d table with the following number of indices
@@ -2427,3 +2535,44 @@ double Cornelius::get_normal_elem(int i, int j)
   }
   return normals[i][j+(DIM-cube_dim)];
 }
+
+/**
+ *
+ * Returns an element of the centroid vector of a surface element of a value
+ * of find_surfaces_4d.
+ *
+ * @param [in] ilevel Index of the value.
+ * @param [in] i      Number of surface element of the value.
+ * @param [in] j      Index of the element of centroid, [0,3].
+ * @return            Element j of the centroid of the surface element i.
+ *
+ */
+double Cornelius::get_centroid_elem(int ilevel, int i, int j)
+{
+  if ( ilevel >= Nlevels || i >= level_Nelements[ilevel] || j >= DIM ) {
+    cout << "Cornelius error: asking for an element which does not exist." << endl;
+    exit(1);
+  }
+  return level_centroids[(ilevel*MAX_ELEMENTS + i)*DIM + j];
+}
+
+/**
+ *
+ * Returns an element of the normal vector of a surface element of a value
+ * of find_surfaces_4d. This gives \sigma_\mu without factors (sqrt(-g))
+ * from the metric.
+ *
+ * @param [in] ilevel Index of the value.
+ * @param [in] i      Number of surface element of the value.
+ * @param [in] j      Index of the element of normal, [0,3].
+ * @return            Element j of the normal of the surface element i.
+ *
+ */
+double Cornelius::get_normal_elem(int ilevel, int i, int j)
+{
+  if ( ilevel >= Nlevels || i >= level_Nelements[ilevel] || j >= DIM ) {
+    cout << "Cornelius error: asking for an element which does not exist." << endl;
+    exit(1);
+  }
+  return level_normals[(ilevel*MAX_ELEMENTS + i)*DIM + j];
+}
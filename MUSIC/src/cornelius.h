@@ -5,6 +5,7 @@
 #include <fstream>
 #include <math.h>
 #include <stdlib.h>
+#include <vector>
 
 //using namespace std;
 
@@ -142,6 +143,7 @@ class Square
     int Nlines;
     Line *lines;
     int ambiguous;
+    double value_min, value_max;
     void ends_of_edge(double);
     void find_outside(double);
   public:
@@ -218,12 +220,14 @@ class Hypercube
     int ambiguous;
     int x1,x2,x3,x4;
     double *dx;
+    double value_min, value_max;
     void split_to_cubes();
     void check_ambiguous(double);
   public:
     Hypercube();
     ~Hypercube();
-    void init(double****,double*);
+    void init(const double*,double*);
+    bool crosses(double);
     void construct_polyhedrons(double);
     int get_Npolyhedrons();
     Polyhedron* get_polyhedrons();
@@ -250,6 +254,11 @@ class Cornelius
     int Nelements;
     double **normals;
     double **centroids;
+    //elements of the levels of find_surfaces_4d, [level][element][4]
+    int Nlevels;
+    std::vector<int> level_Nelements;
+    std::vector<double> level_normals;
+    std::vector<double> level_centroids;
     int cube_dim;
     int initialized;
     int print_initialized;
@@ -268,14 +277,18 @@ class Cornelius
     void find_surface_2d(double**);
     void find_surface_3d(double***);
     void find_surface_3d_print(double***,double*);
-    void find_surface_4d(double****);
+    void find_surface_4d(const double*);
+    void find_surfaces_4d(const double*,const double*,int);
     int get_Nelements();
+    int get_Nelements(int);
     double **get_normals();
     double **get_centroids();
     double **get_normals_4d();
     double **get_centroids_4d();
     double get_centroid_elem(int,int);
     double get_normal_elem(int,int);
+    double get_centroid_elem(int,int,int);
+    double get_normal_elem(int,int,int);
 };
 
 #endif /* CORNELIUS_H */
@@ -0,0 +1,644 @@
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+#include "cornelius_4d.h"
+#include "pretty_ostream.h"
+
+namespace {
+
+//! the points where the surface E0 crosses the edges of the square of
+//! sides dx1, dx2, in the order of Square::ends_of_edge of Cornelius
+int find_cuts(const double points[2][2], const double dx1,
+              const double dx2, const double E0, double cuts[4][2]) {
+    int n_cuts = 0;
+    auto add = [&](const double c0, const double c1) {
+        cuts[n_cuts][0] = c0;
+        cuts[n_cuts][1] = c1;
+        n_cuts++;
+    };
+    //Edge 1
+    if ((points[0][0] - E0)*(points[1][0] - E0) < 0) {
+        add((points[0][0] - E0)/(points[0][0] - points[1][0])*dx1, 0);
+    } else if (points[0][0] == E0 && points[1][0] < E0) {
+        add(1e-9*dx1, 0);
+    } else if (points[1][0] == E0 && points[0][0] < E0) {
+        add((1.0 - 1e-9)*dx1, 0);
+    }
+    //Edge 2
+    if ((points[0][0] - E0)*(points[0][1] - E0) < 0) {
+        add(0, (points[0][0] - E0)/(points[0][0] - points[0][1])*dx2);
+    } else if (points[0][0] == E0 && points[0][1] < E0) {
+        add(0, 1e-9*dx2);
+    } else if (points[0][1] == E0 && points[0][0] < E0) {
+        add(0, (1.0 - 1e-9)*dx2);
+    }
+    //Edge 3
+    if ((points[1][0] - E0)*(points[1][1] - E0) < 0) {
+        add(dx1, (points[1][0] - E0)/(points[1][0] - points[1][1])*dx2);
+    } else if (points[1][0] == E0 && points[1][1] < E0) {
+        add(dx1, 1e-9*dx2);
+    } else if (points[1][1] == E0 && points[1][0] < E0) {
+        add(dx1, (1.0 - 1e-9)*dx2);
+    }
+    //Edge 4
+    if ((points[0][1] - E0)*(points[1][1] - E0) < 0) {
+        add((points[0][1] - E0)/(points[0][1] - points[1][1])*dx1, dx2);
+    } else if (points[0][1] == E0 && points[1][1] < E0) {
+        add(1e-9*dx1, dx2);
+    } else if (points[1][1] == E0 && points[0][1] < E0) {
+        add((1.0 - 1e-9)*dx1, dx2);
+    }
+    if (n_cuts != 0 && n_cuts != 2 && n_cuts != 4) {
+        pretty_ostream music_message;
+        music_message << "Cornelius4D: " << n_cuts
+                      << " cuts on the edges of a square";
+        music_message.flush("error");
+        exit(1);
+    }
+    return(n_cuts);
+}
+
+
+//! the points outside of the surface of the lines of the cuts, as in
+//! Square::find_outside of Cornelius, which also orders the 4 cuts of an
+//! ambiguous square into lines. Returns true for an ambiguous square.
+bool find_outside(const double points[2][2], const double dx1,
+                  const double dx2, const double E0, const int n_cuts,
+                  double cuts[4][2], double out[2][2]) {
+    if (n_cuts == 4) {
+        double Emid = 0;
+        for (int i = 0; i < 2; i++) {
+            for (int j = 0; j < 2; j++) {
+                Emid += 0.25*points[i][j];
+            }
+        }
+        // the cuts are connected as \\ unless Emid and (0,0) are on the
+        // same side
+        if (   (points[0][0] < E0 && Emid < E0)
+            || (points[0][0] > E0 && Emid > E0)) {
+            for (int i = 0; i < 2; i++) {
+                std::swap(cuts[1][i], cuts[2][i]);
+            }
+        }
+        if ((Emid - E0) < 0) {
+            // the center is outside
+            for (int i = 0; i < 2; i++) {
+                out[i][0] = 0.5*dx1;
+                out[i][1] = 0.5*dx2;
+            }
+        } else if ((points[0][0] - E0) < 0) {
+            // the bottom left and top right corners are outside
+            out[0][0] = 0;
+            out[0][1] = 0;
+            out[1][0] = dx1;
+            out[1][1] = dx2;
+        } else {
+            // the bottom right and top left corners are outside
+            out[0][0] = dx1;
+            out[0][1] = 0;
+            out[1][0] = 0;
+            out[1][1] = dx2;
+        }
+        return(true);
+    }
+    for (int i = 0; i < 2; i++) {
+        for (int j = 0; j < 2; j++) {
+            out[i][j] = 0;
+        }
+    }
+    int n_out = 0;
+    for (int i = 0; i < 2; i++) {
+        for (int j = 0; j < 2; j++) {
+            if (points[i][j] < E0) {
+                out[0][0] += i*dx1;
+                out[0][1] += j*dx2;
+                n_out++;
+            }
+        }
+    }
+    if (n_out > 0) {
+        for (int i = 0; i < 2; i++) {
+            for (int j = 0; j < 2; j++) {
+                out[i][j] = out[i][j]/double(n_out);
+            }
+        }
+    }
+    return(false);
+}
+
+}  // namespace
+
+
+void Cornelius4D::init(const double *dx) {
+    for (int i = 0; i < kDim; i++) dx_[i] = dx[i];
+}
+
+
+void Cornelius4D::set_cube(const double *cube) {
+    value_min_ = cube[0];
+    value_max_ = cube[0];
+    for (int i = 0; i < 2; i++)
+    for (int j = 0; j < 2; j++)
+    for (int k = 0; k < 2; k++)
+    for (int l = 0; l < 2; l++) {
+        const double v = cube[((i*2 + j)*2 + k)*2 + l];
+        hcube_[i][j][k][l] = v;
+        value_min_ = std::min(value_min_, v);
+        value_max_ = std::max(value_max_, v);
+    }
+    n_elements_ = 0;
+
+    // the cubes at x_i = 0 and x_i = dx_i, as in Hypercube::split_to_cubes
+    double values[2][2][2];
+    int icube = 0;
+    for (int i = 0; i < kDim; i++) {
+        for (int j = 0; j < 2; j++) {
+            for (int c1 = 0; c1 < 2; c1++)
+            for (int c2 = 0; c2 < 2; c2++)
+            for (int c3 = 0; c3 < 2; c3++) {
+                if (i == 0) {
+                    values[c1][c2][c3] = hcube_[j][c1][c2][c3];
+                } else if (i == 1) {
+                    values[c1][c2][c3] = hcube_[c1][j][c2][c3];
+                } else if (i == 2) {
+                    values[c1][c2][c3] = hcube_[c1][c2][j][c3];
+                } else {
+                    values[c1][c2][c3] = hcube_[c1][c2][c3][j];
+                }
+            }
+            Cube &cube_i = cubes_[icube];
+            cube_i.const_i = i;
+            cube_i.const_value = j*dx_[i];
+            cube_i.x1 = (i == 0 ? 1 : 0);
+            cube_i.x2 = (i <= 1 ? 2 : 1);
+            cube_i.x3 = (i <= 2 ? 3 : 2);
+            cube_i.first_polygon = icube*kMaxCubePolygons;
+            cube_i.n_lines = 0;
+            cube_i.n_polygons = 0;
+            cube_i.ambiguous = 0;
+            split_to_squares(cube_i, values);
+            for (int isq = 0; isq < kNumSquares; isq++) {
+                cube_i.squares[isq].first_line = (
+                        (icube*kNumSquares + isq)*kMaxSquareLines);
+            }
+            icube++;
+        }
+    }
+}
+
+
+void Cornelius4D::split_to_squares(Cube &cube, const double values[2][2][2]) {
+    int isq = 0;
+    for (int i = 0; i < kDim; i++) {
+        if (i == cube.const_i) continue;
+        for (int j = 0; j < 2; j++) {
+            Square &square = cube.squares[isq];
+            square.const_i[0] = cube.const_i;
+            square.const_i[1] = i;
+            square.const_value[0] = cube.const_value;
+            square.const_value[1] = j*dx_[i];
+            for (int c1 = 0; c1 < 2; c1++)
+            for (int c2 = 0; c2 < 2; c2++) {
+                if (i == cube.x1) {
+                    square.points[c1][c2] = values[j][c1][c2];
+                } else if (i == cube.x2) {
+                    square.points[c1][c2] = values[c1][j][c2];
+                } else {
+                    square.points[c1][c2] = values[c1][c2][j];
+                }
+            }
+            square.value_min = square.points[0][0];
+            square.value_max = square.points[0][0];
+            for (int c1 = 0; c1 < 2; c1++)
+            for (int c2 = 0; c2 < 2; c2++) {
+                square.value_min = std::min(square.value_min,
+                                            square.points[c1][c2]);
+                square.value_max = std::max(square.value_max,
+                                            square.points[c1][c2]);
+            }
+            square.x1 = -1;
+            square.x2 = -1;
+            for (int k = 0; k < kDim; k++) {
+                if (k == square.const_i[0] || k == square.const_i[1]) {
+                    continue;
+                }
+                if (square.x1 < 0) {
+                    square.x1 = k;
+                } else {
+                    square.x2 = k;
+                }
+            }
+            square.n_lines = 0;
+            square.ambiguous = false;
+            isq++;
+        }
+    }
+}
+
+
+int Cornelius4D::find_surface(const double value0) {
+    n_elements_ = 0;
+    if (!crosses(value0)) return(0);
+
+    for (int icube = 0; icube < kNumCubes; icube++) {
+        construct_polygons(cubes_[icube], value0);
+    }
+    // the polygons of all the cubes, in the order of the cubes
+    int polygon_list[kNumCubes*kMaxCubePolygons];
+    int n_polygons = 0;
+    for (int icube = 0; icube < kNumCubes; icube++) {
+        const Cube &cube = cubes_[icube];
+        for (int i = 0; i < cube.n_polygons; i++) {
+            polygon_list[n_polygons++] = cube.first_polygon + i;
+        }
+    }
+
+    if (is_ambiguous(value0)) {
+        // connect the polygons into polyhedrons, as the lines of a cube
+        bool not_used[kNumCubes*kMaxCubePolygons];
+        for (int i = 0; i < n_polygons; i++) not_used[i] = true;
+        int used = 0;
+        do {
+            Polyhedron &polyhedron = polyhedrons_[n_elements_];
+            polyhedron.n_polygons = 0;
+            polyhedron.n_tetrahedra = 0;
+            for (int i = 0; i < n_polygons; i++) {
+                if (not_used[i]
+                        && add_polygon(polyhedron, polygon_list[i], false)) {
+                    not_used[i] = false;
+                    used++;
+                    // the next polygon is compared from the second one,
+                    // as in Cornelius
+                    i = 0;
+                }
+            }
+            n_elements_++;
+        } while (used < n_polygons);
+    } else {
+        Polyhedron &polyhedron = polyhedrons_[n_elements_];
+        polyhedron.n_polygons = 0;
+        polyhedron.n_tetrahedra = 0;
+        for (int i = 0; i < n_polygons; i++) {
+            add_polygon(polyhedron, polygon_list[i], true);
+        }
+        n_elements_++;
+    }
+
+    for (int i = 0; i < n_elements_; i++) {
+        calculate_centroid(polyhedrons_[i]);
+        calculate_normal(polyhedrons_[i]);
+    }
+    return(n_elements_);
+}
+
+
+void Cornelius4D::construct_lines(Square &square, const double E0) {
+    square.n_lines = 0;
+    square.ambiguous = false;
+    if (square.value_max < E0 || square.value_min >= E0) return;
+
+    const double dx1 = dx_[square.x1];
+    const double dx2 = dx_[square.x2];
+    double cuts[4][2];
+    double out[2][2];
+    const int n_cuts = find_cuts(square.points, dx1, dx2, E0, cuts);
+    if (n_cuts > 0) {
+        square.ambiguous = find_outside(square.points, dx1, dx2, E0, n_cuts,
+                                        cuts, out);
+    }
+    // every two cuts form a line
+    for (int i = 0; i + 1 < n_cuts; i += 2) {
+        Line &line = lines_[square.first_line + square.n_lines];
+        for (int k = 0; k < 2; k++) {
+            line.corners[k][square.x1] = cuts[i + k][0];
+            line.corners[k][square.x2] = cuts[i + k][1];
+            line.corners[k][square.const_i[0]] = square.const_value[0];
+            line.corners[k][square.const_i[1]] = square.const_value[1];
+        }
+        line.out[square.x1] = out[i/2][0];
+        line.out[square.x2] = out[i/2][1];
+        line.out[square.const_i[0]] = square.const_value[0];
+        line.out[square.const_i[1]] = square.const_value[1];
+        line.start = 0;
+        square.n_lines++;
+    }
+}
+
+
+void Cornelius4D::construct_polygons(Cube &cube, const double value0) {
+    cube.n_polygons = 0;
+    cube.ambiguous = 0;
+    int line_list[kNumSquares*kMaxSquareLines];
+    int n_lines = 0;
+    for (int isq = 0; isq < kNumSquares; isq++) {
+        Square &square = cube.squares[isq];
+        construct_lines(square, value0);
+        for (int j = 0; j < square.n_lines; j++) {
+            line_list[n_lines++] = square.first_line + j;
+        }
+    }
+    cube.n_lines = n_lines;
+    if (n_lines == 0) return;
+
+    for (int isq = 0; isq < kNumSquares; isq++) {
+        if (cube.squares[isq].ambiguous) cube.ambiguous++;
+    }
+    // opposite corners give 6 lines
+    if (cube.ambiguous == 0 && n_lines == 6) cube.ambiguous++;
+
+    auto new_polygon = [&]() -> Polygon& {
+        Polygon &polygon = polygons_[cube.first_polygon + cube.n_polygons];
+        polygon.n_lines = 0;
+        polygon.const_i = cube.const_i;
+        polygon.x1 = cube.x1;
+        polygon.x2 = cube.x2;
+        polygon.x3 = cube.x3;
+        polygon.centroid_calculated = false;
+        return(polygon);
+    };
+    if (cube.ambiguous > 0) {
+        // connect the lines, which may form several polygons
+        bool not_used[kNumSquares*kMaxSquareLines];
+        for (int i = 0; i < n_lines; i++) not_used[i] = true;
+        int used = 0;
+        do {
+            if (n_lines - used < 3) {
+                pretty_ostream music_message;
+                music_message << "Cornelius4D: cannot construct a polygon "
+                              << "from " << n_lines - used << " lines";
+                music_message.flush("error");
+                exit(1);
+            }
+            Polygon &polygon = new_polygon();
+            for (int i = 0; i < n_lines; i++) {
+                if (not_used[i] && add_line(polygon, line_list[i], false)) {
+                    not_used[i] = false;
+                    used++;
+                    // the next line is compared from the second one, as in
+                    // Cornelius
+                    i = 0;
+                }
+            }
+            cube.n_polygons++;
+        } while (used < n_lines);
+    } else {
+        Polygon &polygon = new_polygon();
+        for (int i = 0; i < n_lines; i++) {
+            add_line(polygon, line_list[i], true);
+        }
+        cube.n_polygons++;
+    }
+}
+
+
+bool Cornelius4D::add_line(Polygon &polygon, const int iline,
+                           const bool donotcheck) {
+    const double eps = 1e-10;
+    if (donotcheck || polygon.n_lines == 0) {
+        polygon.lines[polygon.n_lines++] = iline;
+        return(true);
+    }
+    // the lines are ordered, so a new line starts or ends at the end of the
+    // last one
+    Line &line = lines_[iline];
+    const double *p1 = line.get_start();
+    const double *p2 = line.get_end();
+    const double *p3 = lines_[polygon.lines[polygon.n_lines - 1]].get_end();
+    double diff1 = 0;
+    double diff2 = 0;
+    for (int j = 0; j < kDim; j++) {
+        diff1 += std::fabs(p1[j] - p3[j]);
+        diff2 += std::fabs(p2[j] - p3[j]);
+    }
+    if (diff1 < eps || diff2 < eps) {
+        if (diff2 < eps) line.start = 1 - line.start;
+        polygon.lines[polygon.n_lines++] = iline;
+        return(true);
+    }
+    return(false);
+}
+
+
+void Cornelius4D::calculate_centroid(Polygon &polygon) {
+    if (polygon.centroid_calculated) return;
+    polygon.centroid_calculated = true;
+    const int n_lines = polygon.n_lines;
+    // every corner is in two lines
+    double mean[kDim] = {0., 0., 0., 0.};
+    for (int i = 0; i < n_lines; i++) {
+        const Line &line = lines_[polygon.lines[i]];
+        const double *p1 = line.get_start();
+        const double *p2 = line.get_end();
+        for (int j = 0; j < kDim; j++) {
+            mean[j] += p1[j] + p2[j];
+        }
+    }
+    for (int j = 0; j < kDim; j++) {
+        mean[j] = mean[j]/double(2.0*n_lines);
+    }
+    // a triangle is on a plane
+    if (n_lines == 3) {
+        for (int j = 0; j < kDim; j++) polygon.centroid[j] = mean[j];
+        return;
+    }
+    // the area weighted centroids of the triangles of the lines and mean
+    const int x1 = polygon.x1;
+    const int x2 = polygon.x2;
+    const int x3 = polygon.x3;
+    double sum_up[kDim] = {0., 0., 0., 0.};
+    double sum_down = 0;
+    for (int i = 0; i < n_lines; i++) {
+        const Line &line = lines_[polygon.lines[i]];
+        const double *p1 = line.get_start();
+        const double *p2 = line.get_end();
+        double cm_i[kDim], a[kDim], b[kDim];
+        for (int j = 0; j < kDim; j++) {
+            cm_i[j] = (p1[j] + p2[j] + mean[j])/3.0;
+        }
+        for (int j = 0; j < kDim; j++) {
+            a[j] = p1[j] - mean[j];
+            b[j] = p2[j] - mean[j];
+        }
+        const double A_i = 0.5*std::sqrt(
+              std::pow(a[x2]*b[x3] - a[x3]*b[x2], 2.0)
+            + std::pow(a[x1]*b[x3] - a[x3]*b[x1], 2.0)
+            + std::pow(a[x2]*b[x1] - a[x1]*b[x2], 2.0));
+        for (int j = 0; j < kDim; j++) {
+            sum_up[j] += cm_i[j]*A_i;
+        }
+        sum_down += A_i;
+    }
+    for (int j = 0; j < kDim; j++) {
+        polygon.centroid[j] = sum_up[j]/sum_down;
+    }
+}
+
+
+bool Cornelius4D::is_ambiguous(const double value0) const {
+    int ambiguous = 0;
+    for (int i = 0; i < kNumCubes; i++) {
+        if (cubes_[i].ambiguous) ambiguous++;
+    }
+    if (ambiguous > 0) return(true);
+    // two opposite corners give 24 lines
+    int n_lines = 0;
+    for (int i = 0; i < kNumCubes; i++) n_lines += cubes_[i].n_lines;
+    int points = 0;
+    for (int i = 0; i < 2; i++)
+    for (int j = 0; j < 2; j++)
+    for (int k = 0; k < 2; k++)
+    for (int l = 0; l < 2; l++) {
+        if (hcube_[i][j][k][l] < value0) points++;
+    }
+    if (points > 8) points = 16 - points;
+    return(n_lines == 24 && points == 2);
+}
+
+
+bool Cornelius4D::add_polygon(Polyhedron &polyhedron, const int ipolygon,
+                              const bool donotcheck) {
+    const Polygon &polygon = polygons_[ipolygon];
+    bool connected = (donotcheck || polyhedron.n_polygons == 0);
+    // a connected polygon shares a line with one of the polyhedron
+    for (int i = 0; i < polyhedron.n_polygons && !connected; i++) {
+        const Polygon &polygon_i = polygons_[polyhedron.polygons[i]];
+        for (int j = 0; j < polygon.n_lines && !connected; j++) {
+            for (int k = 0; k < polygon_i.n_lines && !connected; k++) {
+                connected = lines_equal(lines_[polygon.lines[j]],
+                                        lines_[polygon_i.lines[k]]);
+            }
+        }
+    }
+    if (!connected) return(false);
+    polyhedron.polygons[polyhedron.n_polygons++] = ipolygon;
+    polyhedron.n_tetrahedra += polygon.n_lines;
+    return(true);
+}
+
+
+bool Cornelius4D::lines_equal(const Line &l1, const Line &l2) const {
+    const double eps = 1e-10;
+    const double *p11 = l1.get_start();
+    const double *p12 = l1.get_end();
+    const double *p21 = l2.get_start();
+    double diff1 = 0;
+    double diff2 = 0;
+    for (int i = 0; i < kDim; i++) {
+        diff1 += std::fabs(p11[i] - p21[i]);
+        diff2 += std::fabs(p12[i] - p21[i]);
+        if (diff1 > eps && diff2 > eps) return(false);
+    }
+    return(true);
+}
+
+
+void Cornelius4D::tetravolume(const double *a, const double *b,
+                              const double *c, double *n) {
+    const double bc01 = b[0]*c[1] - b[1]*c[0];
+    const double bc02 = b[0]*c[2] - b[2]*c[0];
+    const double bc03 = b[0]*c[3] - b[3]*c[0];
+    const double bc12 = b[1]*c[2] - b[2]*c[1];
+    const double bc13 = b[1]*c[3] - b[3]*c[1];
+    const double bc23 = b[2]*c[3] - b[3]*c[2];
+    n[0] =  1.0/6.0*(a[1]*bc23 - a[2]*bc13 + a[3]*bc12);
+    n[1] = -1.0/6.0*(a[0]*bc23 - a[2]*bc03 + a[3]*bc02);
+    n[2] =  1.0/6.0*(a[0]*bc13 - a[1]*bc03 + a[3]*bc01);
+    n[3] = -1.0/6.0*(a[0]*bc12 - a[1]*bc02 + a[2]*bc01);
+}
+
+
+void Cornelius4D::check_normal_direction(double *normal, const double *out) {
+    double dot_product = 0;
+    for (int i = 0; i < kDim; i++) {
+        dot_product += out[i]*normal[i];
+    }
+    if (dot_product < 0) {
+        for (int i = 0; i < kDim; i++) {
+            normal[i] = -normal[i];
+        }
+    }
+}
+
+
+void Cornelius4D::calculate_centroid(Polyhedron &polyhedron) {
+    double mean[kDim] = {0., 0., 0., 0.};
+    for (int i = 0; i < polyhedron.n_polygons; i++) {
+        const Polygon &polygon = polygons_[polyhedron.polygons[i]];
+        for (int j = 0; j < polygon.n_lines; j++) {
+            const Line &line = lines_[polygon.lines[j]];
+            const double *p1 = line.get_start();
+            const double *p2 = line.get_end();
+            for (int k = 0; k < kDim; k++) {
+                mean[k] += p1[k] + p2[k];
+            }
+        }
+    }
+    for (int k = 0; k < kDim; k++) {
+        mean[k] = mean[k]/double(2.0*polyhedron.n_tetrahedra);
+    }
+    // the volume weighted centroids of the tetrahedra of the lines, the
+    // polygon centroids and mean
+    double sum_up[kDim] = {0., 0., 0., 0.};
+    double sum_down = 0;
+    for (int i = 0; i < polyhedron.n_polygons; i++) {
+        Polygon &polygon = polygons_[polyhedron.polygons[i]];
+        calculate_centroid(polygon);
+        const double *cent = polygon.centroid;
+        for (int j = 0; j < polygon.n_lines; j++) {
+            const Line &line = lines_[polygon.lines[j]];
+            const double *p1 = line.get_start();
+            const double *p2 = line.get_end();
+            double cm_i[kDim], a[kDim], b[kDim], c[kDim], n[kDim];
+            for (int k = 0; k < kDim; k++) {
+                cm_i[k] = (p1[k] + p2[k] + cent[k] + mean[k])/4.0;
+            }
+            for (int k = 0; k < kDim; k++) {
+                a[k] = p1[k] - mean[k];
+                b[k] = p2[k] - mean[k];
+                c[k] = cent[k] - mean[k];
+            }
+            tetravolume(a, b, c, n);
+            double V_i = 0;
+            for (int k = 0; k < kDim; k++) {
+                V_i += n[k]*n[k];
+            }
+            V_i = std::sqrt(V_i);
+            for (int k = 0; k < kDim; k++) {
+                sum_up[k] += cm_i[k]*V_i;
+            }
+            sum_down += V_i;
+        }
+    }
+    for (int k = 0; k < kDim; k++) {
+        polyhedron.centroid[k] = sum_up[k]/sum_down;
+    }
+}
+
+
+void Cornelius4D::calculate_normal(Polyhedron &polyhedron) {
+    // the sum of the normals of the tetrahedra, pointing outside
+    const double *centroid = polyhedron.centroid;
+    double *normal = polyhedron.normal;
+    for (int k = 0; k < kDim; k++) normal[k] = 0;
+    for (int i = 0; i < polyhedron.n_polygons; i++) {
+        const Polygon &polygon = polygons_[polyhedron.polygons[i]];
+        const double *cent = polygon.centroid;
+        for (int j = 0; j < polygon.n_lines; j++) {
+            const Line &line = lines_[polygon.lines[j]];
+            const double *p1 = line.get_start();
+            const double *p2 = line.get_end();
+            double a[kDim], b[kDim], c[kDim], n[kDim], Vout[kDim];
+            for (int k = 0; k < kDim; k++) {
+                a[k] = p1[k] - centroid[k];
+                b[k] = p2[k] - centroid[k];
+                c[k] = cent[k] - centroid[k];
+            }
+            tetravolume(a, b, c, n);
+            for (int k = 0; k < kDim; k++) {
+                Vout[k] = line.out[k] - centroid[k];
+            }
+            check_normal_direction(n, Vout);
+            for (int k = 0; k < kDim; k++) normal[k] += n[k];
+        }
+    }
+}
@@ -0,0 +1,134 @@
+#ifndef SRC_CORNELIUS_4D_H_
+#define SRC_CORNELIUS_4D_H_
+
+//! This class finds the elements of constant value surfaces in a 4D
+//! hypercube with the algorithm of Cornelius::find_surface_4d, of which it
+//! gives the normals and centroids bit by bit. The squares, lines, polygons
+//! and polyhedrons of the hypercube are fixed-size arrays of the class,
+//! referring to each other by index, so that the analysis allocates
+//! nothing and calls no virtual functions. The bounds are the ones of the
+//! Cornelius classes.
+//!
+//! A hypercube is split once by set_cube, after which find_surface can be
+//! called for any number of values.
+class Cornelius4D {
+ public:
+    static constexpr int kMaxElements = 10;
+
+    //! the lengths of the sides of the hypercube
+    void init(const double *dx);
+
+    //! splits the hypercube of the corner values
+    //! cube[((i*2 + j)*2 + k)*2 + l] at (i*dx[0], j*dx[1], k*dx[2], l*dx[3])
+    //! into cubes and squares
+    void set_cube(const double *cube);
+
+    //! true if some but not all of the corners are above value0
+    bool crosses(const double value0) const {
+        return(value_max_ >= value0 && value_min_ < value0);
+    }
+
+    //! this function finds the elements of the value0 surface in the
+    //! hypercube of set_cube, and returns their number
+    int find_surface(const double value0);
+
+    int get_Nelements() const {return(n_elements_);}
+    //! sigma_mu of the element i of the last find_surface, without the
+    //! sqrt(-g) of the metric
+    const double *get_normal(const int i) const {
+        return(polyhedrons_[i].normal);
+    }
+    const double *get_centroid(const int i) const {
+        return(polyhedrons_[i].centroid);
+    }
+
+ private:
+    static constexpr int kDim = 4;
+    static constexpr int kNumCubes = 8;
+    static constexpr int kNumSquares = 6;
+    static constexpr int kMaxSquareLines = 2;
+    static constexpr int kMaxCubePolygons = 8;
+    static constexpr int kMaxPolygonLines = 24;
+    static constexpr int kMaxPolyhedronPolygons = 24;
+
+    //! a line element of a square, with a point outside of the surface
+    struct Line {
+        double corners[2][kDim];
+        double out[kDim];
+        int start;
+        const double *get_start() const {return(corners[start]);}
+        const double *get_end() const {return(corners[1 - start]);}
+    };
+
+    //! a face of a cube, with the indices x1 < x2 of its sides, and its
+    //! lines from the first one in lines_
+    struct Square {
+        double points[2][2];
+        int const_i[2];
+        double const_value[2];
+        int x1, x2;
+        double value_min, value_max;
+        int first_line;
+        int n_lines;
+        bool ambiguous;
+    };
+
+    //! the lines_ of a polygon, ordered if the cube is ambiguous
+    struct Polygon {
+        int lines[kMaxPolygonLines];
+        int n_lines;
+        int const_i;
+        int x1, x2, x3;
+        bool centroid_calculated;
+        double centroid[kDim];
+    };
+
+    //! a face of the hypercube, with its polygons from the first one in
+    //! polygons_
+    struct Cube {
+        int const_i;
+        double const_value;
+        int x1, x2, x3;
+        Square squares[kNumSquares];
+        int first_polygon;
+        int n_lines;
+        int n_polygons;
+        int ambiguous;
+    };
+
+    struct Polyhedron {
+        int polygons[kMaxPolyhedronPolygons];
+        int n_polygons;
+        int n_tetrahedra;
+        double centroid[kDim];
+        double normal[kDim];
+    };
+
+    double dx_[kDim];
+    double hcube_[2][2][2][2];
+    double value_min_ = 0.;
+    double value_max_ = 0.;
+    Cube cubes_[kNumCubes];
+    Line lines_[kNumCubes*kNumSquares*kMaxSquareLines];
+    Polygon polygons_[kNumCubes*kMaxCubePolygons];
+    Polyhedron polyhedrons_[kMaxElements];
+    int n_elements_ = 0;
+
+    void split_to_squares(Cube &cube, const double values[2][2][2]);
+    void construct_lines(Square &square, const double E0);
+    void construct_polygons(Cube &cube, const double value0);
+    bool add_line(Polygon &polygon, const int iline, const bool donotcheck);
+    void calculate_centroid(Polygon &polygon);
+    bool is_ambiguous(const double value0) const;
+    bool add_polygon(Polyhedron &polyhedron, const int ipolygon,
+                     const bool donotcheck);
+    bool lines_equal(const Line &l1, const Line &l2) const;
+    void calculate_centroid(Polyhedron &polyhedron);
+    void calculate_normal(Polyhedron &polyhedron);
+
+    static void tetravolume(const double *a, const double *b,
+                            const double *c, double *n);
+    static void check_normal_direction(double *normal, const double *out);
+};
+
+#endif  // SRC_CORNELIUS_4D_H_
@@ -0,0 +1,83 @@
+#include <random>
+#include "doctest.h"
+#include "cornelius.h"
+#include "cornelius_4d.h"
+
+namespace {
+
+//! the number of the cubes where Cornelius4D and Cornelius::find_surface_4d
+//! differ in the elements of value0 (and counts the elements)
+int compare_with_cornelius(Cornelius4D &cornelius_4d, double *dx,
+                           const double *cube, const double value0,
+                           int &n_elements) {
+    Cornelius cornelius;
+    cornelius.init(4, value0, dx);
+    cornelius.find_surface_4d(cube);
+    cornelius_4d.set_cube(cube);
+    const int n = cornelius_4d.find_surface(value0);
+    if (n != cornelius.get_Nelements()) return(1);
+    n_elements += n;
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < 4; j++) {
+            if (cornelius_4d.get_centroid(i)[j]
+                    != cornelius.get_centroid_elem(i, j)
+                || cornelius_4d.get_normal(i)[j]
+                    != cornelius.get_normal_elem(i, j)) {
+                return(1);
+            }
+        }
+    }
+    return(0);
+}
+
+}  // namespace
+
+
+TEST_CASE("Check Cornelius4D gives the elements of Cornelius") {
+    double dx[4] = {0.05, 0.2, 0.3, 0.4};
+    Cornelius4D cornelius_4d;
+    cornelius_4d.init(dx);
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> uniform(0., 1.);
+    std::uniform_int_distribution<int> level(0, 3);
+
+    // random corners have many ambiguous cubes and hypercubes, the corners
+    // on a few levels are on the surface
+    int n_differ = 0;
+    int n_elements = 0;
+    int n_multiple = 0;
+    double cube[16];
+    for (int itest = 0; itest < 20000; itest++) {
+        const bool discrete = (itest % 4 == 3);
+        for (int n = 0; n < 16; n++) {
+            cube[n] = discrete ? 0.5*level(rng) : uniform(rng);
+        }
+        const double value0 = discrete ? 0.5 + 0.5*(itest % 3) : 0.5;
+        const int n_before = n_elements;
+        n_differ += compare_with_cornelius(cornelius_4d, dx, cube, value0,
+                                           n_elements);
+        if (n_elements - n_before > 1) n_multiple++;
+    }
+    CHECK(n_differ == 0);
+    CHECK(n_elements > 10000);
+    CHECK(n_multiple > 0);
+
+    // several values in one hypercube
+    for (int n = 0; n < 16; n++) cube[n] = uniform(rng);
+    cornelius_4d.set_cube(cube);
+    CHECK(cornelius_4d.find_surface(2.) == 0);
+    CHECK(cornelius_4d.find_surface(-1.) == 0);
+    for (const double value0 : {0.3, 0.5, 0.7}) {
+        Cornelius cornelius;
+        cornelius.init(4, value0, dx);
+        cornelius.find_surface_4d(cube);
+        REQUIRE(cornelius_4d.find_surface(value0)
+                == cornelius.get_Nelements());
+        for (int i = 0; i < cornelius.get_Nelements(); i++) {
+            for (int j = 0; j < 4; j++) {
+                CHECK(cornelius_4d.get_normal(i)[j]
+                      == cornelius.get_normal_elem(i, j));
+            }
+        }
+    }
+}
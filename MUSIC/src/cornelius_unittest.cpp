@@ -0,0 +1,72 @@
+#include "doctest.h"
+#include "cornelius.h"
+#include <cmath>
+
+TEST_CASE("Check Cornelius find_surface_4d with a planar surface") {
+    // the value decreases linearly in x, so the surface is the plane
+    // x = 0.4*dx with the normal dtau*dy*deta along x
+    const double dx[4] = {0.1, 0.2, 0.3, 0.4};
+    double lattice_spacing[4] = {dx[0], dx[1], dx[2], dx[3]};
+    const double value0 = 0.6;
+    double cube[16];
+    for (int i = 0; i < 2; i++)
+    for (int j = 0; j < 2; j++)
+    for (int k = 0; k < 2; k++)
+    for (int l = 0; l < 2; l++) {
+        cube[((i*2 + j)*2 + k)*2 + l] = 1.0 - j;
+    }
+
+    Cornelius cornelius;
+    cornelius.init(4, value0, lattice_spacing);
+    cornelius.find_surface_4d(cube);
+    REQUIRE(cornelius.get_Nelements() == 1);
+    CHECK(cornelius.get_centroid_elem(0, 0) == doctest::Approx(dx[0]/2.));
+    CHECK(cornelius.get_centroid_elem(0, 1) == doctest::Approx(0.4*dx[1]));
+    CHECK(cornelius.get_centroid_elem(0, 2) == doctest::Approx(dx[2]/2.));
+    CHECK(cornelius.get_centroid_elem(0, 3) == doctest::Approx(dx[3]/2.));
+    CHECK(std::abs(cornelius.get_normal_elem(0, 1))
+          == doctest::Approx(dx[0]*dx[2]*dx[3]));
+    CHECK(cornelius.get_normal_elem(0, 0) == doctest::Approx(0.));
+    CHECK(cornelius.get_normal_elem(0, 2) == doctest::Approx(0.));
+    CHECK(cornelius.get_normal_elem(0, 3) == doctest::Approx(0.));
+
+    // the same instance can be reused for the next cube
+    for (int n = 0; n < 16; n++) cube[n] = 1.0;
+    cornelius.find_surface_4d(cube);
+    CHECK(cornelius.get_Nelements() == 0);
+}
+
+TEST_CASE("Check Cornelius find_surfaces_4d against find_surface_4d") {
+    double lattice_spacing[4] = {0.1, 0.2, 0.3, 0.4};
+    // a saddle in x and y with a gradient in tau and eta, so that some of
+    // the levels have ambiguous squares
+    double cube[16];
+    for (int i = 0; i < 2; i++)
+    for (int j = 0; j < 2; j++)
+    for (int k = 0; k < 2; k++)
+    for (int l = 0; l < 2; l++) {
+        cube[((i*2 + j)*2 + k)*2 + l] = (
+            1.0 + 0.8*(j == k ? 1. : -1.) - 0.3*i + 0.1*l);
+    }
+    const double levels[5] = {-0.5, 0.5, 1.0, 1.5, 3.0};
+
+    Cornelius multi;
+    multi.init(4, levels[0], lattice_spacing);
+    multi.find_surfaces_4d(cube, levels, 5);
+    CHECK(multi.get_Nelements(0) == 0);
+    CHECK(multi.get_Nelements(4) == 0);
+    for (int ilevel = 0; ilevel < 5; ilevel++) {
+        Cornelius single;
+        single.init(4, levels[ilevel], lattice_spacing);
+        single.find_surface_4d(cube);
+        REQUIRE(multi.get_Nelements(ilevel) == single.get_Nelements());
+        for (int i = 0; i < single.get_Nelements(); i++)
+        for (int j = 0; j < 4; j++) {
+            CHECK(multi.get_centroid_elem(ilevel, i, j)
+                  == single.get_centroid_elem(i, j));
+            CHECK(multi.get_normal_elem(ilevel, i, j)
+                  == single.get_normal_elem(i, j));
+        }
+    }
+    CHECK(multi.get_Nelements(2) > 0);
+}
@@ -62,6 +62,9 @@ typedef struct init_data {
     int ny;
     int neta;
     int nt;
+    //! the global eta index of the eta layer 0 of the grid, nonzero for
+    //! the slabs of the distributed runs (see domain_decomposition.h)
+    int eta_index_offset = 0;
 
     double x_size;      //!< in fermi -x_size/2 < x < x_size/2
     double y_size;      //!< in fermi, -y_size/2 < y < y_size/2
@@ -72,7 +75,29 @@ typedef struct init_data {
     double delta_x;
     double delta_y;
     double delta_eta;
-    double delta_tau;
+    //! c of the stretched eta grid (see EtaGrid), 0 for a uniform grid
+    //! with the spacing delta_eta
+    double eta_grid_stretching = 0.;
+    double delta_tau;   //!< time step, changes between steps with adaptive_dtau
+    //! Delta_Tau of the input, the unit of the evolution output times
+    double delta_tau_input;
+    //! tau interval of arena_prev and arena_current for the backward time
+    //! derivatives (set by Evolve, differs from delta_tau in the first
+    //! Runge-Kutta stage after a change of the adaptive time step)
+    double delta_tau_backward;
+    //! 1: choose the time step from the CFL condition of the largest
+    //!    signal speed on the grid at every step
+    //! 0: fixed time step delta_tau
+    int adaptive_dtau;
+    double adaptive_dtau_cfl;        //!< Courant number of the adaptive step
+    double adaptive_dtau_growth;     //!< largest ratio of successive steps
+    double adaptive_dtau_max_ratio;  //!< largest step in units of Delta_Tau
+    //! number of times the transverse plane may be coarsened by 2,
+    //! see GridCoarsening (0: fixed grid)
+    int transverse_coarsening_levels;
+    //! the plane is coarsened when GridCoarsening::get_gradient_indicator
+    //! is below this value
+    double transverse_coarsening_threshold;
 
     int rk_order;
     double minmod_theta;
@@ -81,6 +106,62 @@ typedef struct init_data {
     int whichEOS;       //!< type of EoS
     //! flag for boost invariant simulations
     bool boost_invariant;
+    //! boundary condition of the hydro stencils in eta
+    //! 0: outflow (copy the last cell)
+    //! 1: periodic (needs the padded sweep grid, see sweep_grid.h)
+    int eta_boundary_condition;
+    //! 1: evolve every cell in a single pass over a local copy of its
+    //!    stencil (Advance::AdvanceCell on a StencilTile)
+    //! 0: the sweeps read the stencils directly from the grid
+    int fused_rk_stage;
+    //! 1: reconstruct the half-way cells of a cell together
+    //!    (Reconst::ReconstIt_batch)
+    //! 0: one Reconst::ReconstIt_shell call per half-way cell
+    int reconst_batch;
+    //! 1: reconstruct the half-way cells and compute the KT flux of each
+    //!    face once (Advance::compute_face_fluxes)
+    //! 0: every cell computes the fluxes through its own faces
+    int face_flux;
+    //! the slope limiter of the half-way cells of the face fluxes
+    //! (face_flux = 1, see SlopeLimiter::Kind)
+    //! 0: generalized minmod with minmod_theta
+    //! 1: monotonized central (minmod with theta = 2)
+    //! 2: van Leer
+    int slope_limiter;
+    //! 1: the hydro source terms of a Runge-Kutta stage are deposited
+    //!    into a grid before the sweep (HydroSourceBase::deposit_sources)
+    //! 0: every cell evaluates its source terms in FirstRKStepT
+    int source_deposition;
+    //! 1: the velocity gradients of the cells of a Runge-Kutta stage are
+    //!    computed a row at a time before the sweep (UDerivativeRows)
+    //! 0: every cell computes its gradients with U_derivative::MakedU
+    int u_derivative_rows;
+    //! loop order of the grid sweeps in AdvanceIt
+    //! 3: the tiles of 1 on the threads by their cost in the last sweep,
+    //!    with work stealing (see TileScheduler)
+    //! 2: static partition of the (eta, y) rows in storage order over the
+    //!    threads, the partition of the first touch of the grids
+    //! 1: cache-blocked tiles in storage order (see GridTiling)
+    //! 0: collapsed (eta, x, y) loop
+    int grid_traversal;
+    //! 1: the Runge-Kutta stages of a time step run in one OpenMP parallel
+    //!    region, with the control between the stages on one thread
+    //!    (Advance::AdvanceIt_in_team)
+    //! 0: every grid loop of a stage opens its own parallel region
+    int persistent_parallel_region;
+    //! 1: the threads construct the cells of a new grid in the static
+    //!    partition of grid_traversal = 2 (NUMA first touch, see GridMemory)
+    //! 0: the master thread constructs the cells
+    int grid_first_touch;
+    //! 1: the grids are backed by transparent huge pages if available
+    int grid_huge_pages;
+    //! tile shape of GridTiling (<= 0: chosen from the L2 cache size)
+    int grid_tile_size_x;
+    int grid_tile_size_y;
+    int grid_tile_size_eta;
+    //! vacuum energy density [GeV/fm^3]: only the bounding box of the
+    //! cells above it (plus a margin) is evolved (<= 0: whole grid)
+    double active_region_epsilon;
 
     //! flag to output initial density profile
     int output_initial_density_profiles;
@@ -137,6 +218,9 @@ typedef struct init_data {
     double bulk_3_T_peak_in_GeV;
     double bulk_3_lambda_asymm;
 
+    //! flag to tabulate eta/s(T, muB) and zeta/s(T) at the start
+    int transport_coeffs_table;
+
     //! multiplicative factors for the relaxation times
     double shear_relax_time_factor;
     double bulk_relax_time_factor;
@@ -156,14 +240,44 @@ typedef struct init_data {
     //! coefficient related to the net baryon diff.
     double kappa_coefficient;
 
-    //! decide whether to output the evolution data (1) or not (0)
+    //! integration of the relaxation terms -X/tau_X of the shear, bulk,
+    //! and diffusion currents (Advance::FirstRKStepW)
+    //! 0: explicit, the relaxation times are at least 3 delta_tau
+    //! 1: implicit at the end of each Runge-Kutta stage, so any
+    //!    relaxation time is stable at the time step of the advection
+    int implicit_relaxation;
+
+    //! decide whether to output the evolution data (1-6) or not (0),
+    //! 5 writes the chunked evolution file evolution_xyeta_chunked.dat,
+    //! 6 the sparse evolution file evolution_xyeta_sparse.dat with the
+    //! cells above output_evolution_e_cut
     int outputEvolutionData;
 
     //! flag to store hydro evolution in memory for jetscape
     int store_hydro_info_in_memory;
+    //! cells below this temperature [GeV] are not stored in memory
+    //! (0: store all cells)
+    double store_hydro_info_T_cut;
+    //! the number of the last tau slices of the history kept in memory,
+    //! the older ones are spilled to a scratch file (0: keep all)
+    int store_hydro_info_memory_slices;
+    //! the number of spilled tau slices cached in memory
+    int store_hydro_info_cache_slices;
+    //! the directory of the scratch file of the spilled slices
+    std::string store_hydro_info_spill_directory;
 
     //! decide whether to output files for movie
     int output_movie_flag;
+    //! the 2D frames of the reduced movie written at the output steps
+    //! (bits, 0: none, 1: mid-rapidity slice, 2: eta projection)
+    int output_movie_reductions;
+    //! the transverse block of output_movie_block_size^2 cells averaged
+    //! to one point of the reduced movie
+    int output_movie_block_size;
+    //! number of the last time steps whose grids are kept in memory and
+    //! written to debug_snapshots.dat if the run stops on an error
+    //! (0: none)
+    int debug_snapshot_ring;
 
     //! decide whether to output files for R_pi and R_Pi
     int output_outofequilibriumsize;
@@ -175,12 +289,21 @@ typedef struct init_data {
 
     int output_hydro_debug_info;
     int output_evolution_every_N_timesteps;
+    //! the momentum anisotropy, conservation law and vorticity evolution
+    //! files are written every N time steps
+    int output_observables_every_N_timesteps;
     int output_evolution_every_N_x;
     int output_evolution_every_N_y;
     int output_evolution_every_N_eta;
     bool output_hydro_params_header;
     double output_evolution_T_cut;
     double output_evolution_e_cut;
+    //! number of snapshot buffers of the evolution output writer thread
+    //! (0: write the evolution outputs on the main thread)
+    int output_evolution_buffers;
+    //! codec of the chunks of evolution_xyeta_chunked.dat
+    //! (0: raw floats, 1: zlib, needs -DZLIB)
+    int output_evolution_codec;
 
     int doFreezeOut;            //!< flag to output freeze-out surface
 
@@ -202,6 +325,28 @@ typedef struct init_data {
     int freeze_eps_flag;
     std::string freeze_list_filename;
     bool freeze_surface_in_binary;
+    //! 1: buffer the binary surface in memory and write one file with a
+    //! header per isotherm after the evolution (see freezeout_surface.h)
+    int freeze_surface_single_file;
+    //! the number of threads finding the freeze-out surface while the
+    //! evolution advances (0: the surface is found between the steps)
+    int freeze_out_pipeline;
+    //! the number of threads computing the thermal spectra from the
+    //! surface while the hydro runs (0: after the hydro)
+    int cooper_frye_streaming;
+    //! merge the freeze-out elements with similar fields in blocks of this
+    //! many freeze-out cells per direction before Cooper-Frye (0: off),
+    //! see SurfaceCoarsening
+    int surface_coarsening_factor;
+    //! the largest differences of the merged elements: u^mu, T relative
+    //! to T, mu_B relative to T and W^{mu nu} relative to e + P
+    double surface_coarsening_u_tolerance;
+    double surface_coarsening_T_tolerance;
+    double surface_coarsening_muB_tolerance;
+    double surface_coarsening_W_tolerance;
+    //! 1: compute the first species with the full surface too, and report
+    //! the deviation of their spectra on the coarse surface
+    int surface_coarsening_check;
 
     // for calculation of spectra
     int pseudofreeze;    //! flag to compute spectra in pseudorapdity
@@ -219,6 +364,15 @@ typedef struct init_data {
     //! 0: all particles
     int particleSpectrumNumber;
 
+    //! 1: write the spectra files also when they are handed over in memory
+    int output_spectra_files;
+
+    //! the number of (oversampled) events of hadrons sampled from the
+    //! freeze-out surface to sampled_particles.dat (0: no sampling), and
+    //! the seed of their random streams
+    int number_of_sampled_events;
+    int hadron_sampler_seed;
+
     int include_deltaf;        //!< flag to include shear delta f
     int include_deltaf_qmu;    //!< flag to include diffusion delta f
     int include_deltaf_bulk;   //!< flag to include bulk delta f
@@ -246,6 +400,69 @@ typedef struct init_data {
     // 0: without causality modification
     // 1: questrevert with necessary causality conditions
     // 2: questrevert with sufficient causality conditions
+
+    //! method to compute the eigenvalues of pi^mu_nu (Lambdas)
+    //! 0: general 4x4 eigenvalue solver
+    //! 1: analytic solution of the 3x3 problem in the local rest frame
+    //! 2: Eigen's self-adjoint solver for the 3x3 problem in the
+    //!    local rest frame
+    int Wmunu_eigenvalue_solver;
+
+    //! absolute tolerance on beta in the root finder for the
+    //! nonlinear sufficient causality conditions
+    double causality_root_tolerance;
+
+    //! sampling stride in x, y, and eta for the causality diagnostics file
+    //! (0: no output)
+    int causality_diagnostics_stride;
+
+    //! skip the causality constraints of the cells below the safety bound
+    //! of their cs^2 (1), or evaluate them for all the cells (0)
+    int causality_prescreen;
+
+    //! write the histograms of the causality reduction factors and the
+    //! fractions of the violating cells every time step (1), see
+    //! CausalityStatistics
+    int causality_statistics;
+    //! records of the reservoir sample of the causality statistics per
+    //! time step (0: no sample)
+    int causality_sample_size;
+
+    //! write a checkpoint of the evolution every N time steps (0: never)
+    int checkpoint_every_N_timesteps;
+    std::string checkpoint_filename;
+    //! 1: continue the evolution from checkpoint_filename
+    int restart_from_checkpoint;
+
+    //! 0: off, 1: timers and counters with a summary at the end of the run,
+    //! 2: 1 and per time step JSON lines in instrumentation_filename
+    int instrumentation;
+    std::string instrumentation_filename;
+
+    //! the lowest severity written by the log (0: debug, 1: info,
+    //! 2: warning, 3: error)
+    int log_level;
+    //! messages per second of a LogSite before the others are summed up
+    //! in a suppressed count (0: no limit)
+    int log_rate_limit;
+
+    //! the memory budget [MB] of the run the optional copies are fitted
+    //! into before the allocation (0: no budget, see MemoryAccounting)
+    double memory_budget_MB;
+
+    //! the number of OpenMP threads (0: the default of the runtime)
+    int omp_num_threads;
+    //! the time steps of a configuration of the auto-tune mode 9, the
+    //! first one is not timed (see AutoTuner)
+    int autotune_steps;
+    //! the largest difference of the grid of a tuned configuration from
+    //! the one of the input configuration
+    double autotune_tolerance;
+    //! 1: the runtime knobs the input file does not set are read from
+    //!    the auto-tune profile if it exists
+    int autotune_load_profile;
+    //! the auto-tune profile ("": music_autotune_<host name>.dat)
+    std::string autotune_profile;
 } InitData;
 
 #endif  // SRC_DATA_H_
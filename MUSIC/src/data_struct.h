@@ -15,6 +15,34 @@ typedef std::array<double, 4>  DmuMuBoverTVec;
 typedef std::array<double, 6>  VorticityVec;
 typedef std::array<double, 8>  ShearVisVecLRF;
 typedef std::array<double, 14> ViscousVec;
+
+//! storage type of the dissipative fields (Wmunu, pi_b, Lambdas) in the
+//! grids, chosen at compile time:
+//!   -DMUSIC_FLOAT_DISSIPATIVE: float, the kernels compute in double and
+//!                              round the results when they are stored
+//!   otherwise:                 double
+#ifdef MUSIC_FLOAT_DISSIPATIVE
+typedef float DissipativeReal;
+#else
+typedef double DissipativeReal;
+#endif
+typedef std::array<DissipativeReal, 14> ViscousStorageVec;
+//! the eigenvalues of pi^mu_nu (min, middle, max), which only the
+//! causality constraints use
+typedef std::array<DissipativeReal, 3>  LambdaVec;
+
+//! the stored dissipative fields in double precision for the kernels,
+//! without a copy when they are stored in double
+inline const ViscousVec &to_ViscousVec(const ViscousVec &Wmunu) {
+    return(Wmunu);
+}
+#ifdef MUSIC_FLOAT_DISSIPATIVE
+inline ViscousVec to_ViscousVec(const ViscousStorageVec &Wmunu) {
+    ViscousVec result;
+    for (unsigned int i = 0; i < result.size(); i++) result[i] = Wmunu[i];
+    return(result);
+}
+#endif
 typedef std::array<std::array<double, 4>, 5> dUsupMat;
 
 typedef struct {
@@ -30,12 +58,6 @@ typedef struct {
    float bulkPi;
 } fluidCell;
 
-typedef struct {
-    float eta;
-    float sd, ed, pressure, temperature;
-    float ux, uy, ueta;
-} fluidCell_ideal;
-
 template<typename T>
 T assume_aligned(T x) {
   #if defined(__AVX512__)
@@ -0,0 +1,85 @@
+#ifndef SRC_DETERMINISTIC_SUM_H_
+#define SRC_DETERMINISTIC_SUM_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+//! The parallel reductions of this namespace do not depend on the number
+//! of threads or on the schedule. The terms are split into parts which
+//! only depend on the number of terms, each part is summed in order, and
+//! the parts are combined pairwise in a fixed tree: on level l, part p
+//! takes in part p + 2^l for the p which are multiples of 2^(l+1). So the
+//! results are bitwise the same for any OMP_NUM_THREADS, and the rounding
+//! error grows with the logarithm of the number of parts only.
+namespace DeterministicSum {
+
+//! the number of terms summed in order in one part by sum()
+const int64_t kBlockSize = 1024;
+
+//! the range [begin, end) of part ipart of n terms split into n_parts
+//! parts of (nearly) the same size
+inline void get_part_range(const int64_t n, const int64_t n_parts,
+                           const int64_t ipart, int64_t &begin,
+                           int64_t &end) {
+    begin = (n*ipart)/n_parts;
+    end = (n*(ipart + 1))/n_parts;
+}
+
+
+//! combines the n_parts arrays of width values in parts (part p starts at
+//! parts[p*width]) in the fixed tree into parts[0, width), by
+//! combine(total, part) which merges part into total. The pairs of a level
+//! are combined in parallel, the other parts are overwritten.
+template<class Combine>
+void tree_combine(double *parts, const int64_t n_parts, const int64_t width,
+                  Combine &&combine) {
+    for (int64_t stride = 1; stride < n_parts; stride *= 2) {
+        const int64_t n_pairs = (n_parts - stride + 2*stride - 1)/(2*stride);
+        #pragma omp parallel for schedule(static)
+        for (int64_t ipair = 0; ipair < n_pairs; ipair++) {
+            const int64_t p = 2*stride*ipair;
+            combine(parts + p*width, parts + (p + stride)*width);
+        }
+    }
+}
+
+
+//! tree_combine() with the sum of the values, in parallel over the pairs
+//! and the values, for few parts of many values
+inline void tree_sum(double *parts, const int64_t n_parts,
+                     const int64_t width) {
+    for (int64_t stride = 1; stride < n_parts; stride *= 2) {
+        const int64_t n_pairs = (n_parts - stride + 2*stride - 1)/(2*stride);
+        #pragma omp parallel for collapse(2) schedule(static)
+        for (int64_t ipair = 0; ipair < n_pairs; ipair++)
+        for (int64_t i = 0; i < width; i++) {
+            const int64_t p = 2*stride*ipair;
+            parts[p*width + i] += parts[(p + stride)*width + i];
+        }
+    }
+}
+
+
+//! returns the sum of term(i) for i in [0, n), in parallel over the parts
+//! of block_size terms
+template<class Term>
+double sum(const int64_t n, Term &&term,
+           const int64_t block_size = kBlockSize) {
+    if (n <= 0) return(0.);
+    const int64_t n_parts = (n + block_size - 1)/block_size;
+    std::vector<double> parts(n_parts, 0.);
+    #pragma omp parallel for schedule(static)
+    for (int64_t ipart = 0; ipart < n_parts; ipart++) {
+        const int64_t end = std::min(n, (ipart + 1)*block_size);
+        double part = 0.;
+        for (int64_t i = ipart*block_size; i < end; i++) part += term(i);
+        parts[ipart] = part;
+    }
+    tree_sum(parts.data(), n_parts, 1);
+    return(parts[0]);
+}
+
+}  // namespace DeterministicSum
+
+#endif  // SRC_DETERMINISTIC_SUM_H_
@@ -0,0 +1,73 @@
+#ifdef _OPENMP
+    #include <omp.h>
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "doctest.h"
+#include "deterministic_sum.h"
+
+namespace {
+    //! terms of very different sizes, whose sum depends on the order
+    double get_term(const int64_t i) {
+        return(std::sin(0.37*i)*std::pow(10., (i % 17) - 8));
+    }
+}
+
+
+TEST_CASE("Check DeterministicSum splits the terms into parts") {
+    int64_t n_covered = 0, end_last = 0;
+    for (int ipart = 0; ipart < 7; ipart++) {
+        int64_t begin, end;
+        DeterministicSum::get_part_range(100, 7, ipart, begin, end);
+        CHECK(begin == end_last);
+        CHECK(end - begin >= 14);
+        CHECK(end - begin <= 15);
+        n_covered += end - begin;
+        end_last = end;
+    }
+    CHECK(n_covered == 100);
+
+    // the tree of the pairs adds the integers exactly for any number of
+    // parts, with the parts of 3 values
+    for (int n_parts = 1; n_parts <= 9; n_parts++) {
+        std::vector<double> parts(3*n_parts);
+        for (int p = 0; p < n_parts; p++) {
+            parts[3*p] = p;
+            parts[3*p + 1] = 1.;
+            parts[3*p + 2] = 2.*p;
+        }
+        DeterministicSum::tree_sum(parts.data(), n_parts, 3);
+        CHECK(parts[0] == n_parts*(n_parts - 1)/2);
+        CHECK(parts[1] == n_parts);
+        CHECK(parts[2] == n_parts*(n_parts - 1));
+    }
+    std::vector<double> parts = {3., 8., 1., 5., 2.};
+    DeterministicSum::tree_combine(
+            parts.data(), 5, 1, [](double *total, const double *part) {
+                total[0] = std::max(total[0], part[0]);
+            });
+    CHECK(parts[0] == 8.);
+    CHECK(DeterministicSum::sum(0, get_term) == 0.);
+}
+
+
+#ifdef _OPENMP
+TEST_CASE("Check DeterministicSum does not depend on the number of threads") {
+    const int n_threads_max = omp_get_max_threads();
+    const int64_t n = 100003;
+    omp_set_num_threads(1);
+    const double sum_1 = DeterministicSum::sum(n, get_term);
+    const double sum_1_short = DeterministicSum::sum(n, get_term, 100);
+    double sum_serial = 0.;
+    for (int64_t i = 0; i < n; i++) sum_serial += get_term(i);
+    CHECK(sum_1 == doctest::Approx(sum_serial).epsilon(1e-12));
+    for (const int n_threads : {2, 3, 7, 16}) {
+        omp_set_num_threads(n_threads);
+        CHECK(DeterministicSum::sum(n, get_term) == sum_1);
+        CHECK(DeterministicSum::sum(n, get_term, 100) == sum_1_short);
+    }
+    omp_set_num_threads(n_threads_max);
+}
+#endif
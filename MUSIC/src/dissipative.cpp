@@ -10,12 +10,13 @@
 #include "data.h"
 #include "eos.h"
 #include "dissipative.h"
+#include "physics_config.h"
 
 using Util::hbarc;
 using Util::small_eps;
 
 Diss::Diss(const EOS &eosIn, const InitData &Data_in) :
-                DATA(Data_in), eos(eosIn), minmod(Data_in),
+                DATA(Data_in), eos(eosIn), minmod(Data_in), eta_grid_(Data_in),
                 transport_coeffs_(eosIn, Data_in) {}
 
 /* %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%% */
@@ -25,22 +26,25 @@ Diss::Diss(const EOS &eosIn, const InitData &Data_in) :
 for everywhere else. also, this change is necessary
 to use Wmunu[rk_flag][4][mu] as the dissipative baryon current*/
 /* this is the only one that is being subtracted in the rhs */
+template<unsigned Config, class Grid>
 void Diss::MakeWSource(const double tau,
-                       SCGrid &arena_current, SCGrid &arena_prev,
+                       Grid &arena_current, SCGrid &arena_prev,
                        const int ix, const int iy, const int ieta,
                        TJbVec &dwmn) {
     /* calculate d_m (tau W^{m,alpha}) + (geom source terms) */
-    const auto& grid_pt      = arena_current(ix, iy, ieta);
+    const Cell_small &grid_pt = arena_current(ix, iy, ieta);
     const auto& grid_pt_prev = arena_prev(ix, iy, ieta);
 
     const double delta[4]   = {0.0, DATA.delta_x, DATA.delta_y,
-                               DATA.delta_eta};
+                               eta_grid_.get_width(ieta)};
     const double tau_fac[4] = {0.0, tau, tau, 1.0};
 
     dwmn = {0.};
     EnergyFlowVec W_eta_p = {0.};  // save tau*W^{\eta \nu} at eta + deta/2
     EnergyFlowVec W_eta_m = {0.};  // save tau*W^{\eta \nu} at eta - deta/2
-    for (int alpha = 0; alpha < 5; alpha++) {
+    // the baryon diffusion current is zero without kDiff
+    const int alpha_max = (Config & PhysicsConfig::kDiff) ? 5 : 4;
+    for (int alpha = 0; alpha < alpha_max; alpha++) {
         /* partial_tau W^tau alpha */
         /* this is partial_tau evaluated at tau */
         /* this is the first step. so rk_flag = 0 */
@@ -52,24 +56,25 @@ void Diss::MakeWSource(const double tau,
         // dW/dtau
         // backward time derivative (first order is more stable)
         int idx_1d_alpha0 = map_2d_idx_to_1d(alpha, 0);
-        double dWdtau = (grid_pt.Wmunu[idx_1d_alpha0]
-                         - grid_pt_prev.Wmunu[idx_1d_alpha0])/DATA.delta_tau;
+        double dWdtau = ((grid_pt.Wmunu[idx_1d_alpha0]
+                         - grid_pt_prev.Wmunu[idx_1d_alpha0])
+                        /DATA.delta_tau_backward);
 
         /* bulk pressure term */
         double dPidtau = 0.0;
         double Pi_alpha0 = 0.0;
-        if (alpha < 4 && DATA.turn_on_bulk == 1) {
+        if (alpha < 4 && (Config & PhysicsConfig::kBulk)) {
             double gfac = (alpha == 0 ? -1.0 : 0.0);
             Pi_alpha0 = grid_pt.pi_b*(gfac + grid_pt.u[alpha]*grid_pt.u[0]);
             dPidtau = ((Pi_alpha0 - grid_pt_prev.pi_b
                                     *(gfac + grid_pt_prev.u[alpha]
                                              *grid_pt_prev.u[0]))
-                       /DATA.delta_tau);
+                       /DATA.delta_tau_backward);
         }
 
         double dWdx  = 0.0;  // partial_i (tau W^{i \alpha})
         double dPidx = 0.0;  // partial_i (tau Pi^{i \alpha})
-        Neighbourloop(arena_current, ix, iy, ieta, NLAMBDAS{
+        const auto stencil = NLAMBDAS_GENERIC{
             int idx_1d  = map_2d_idx_to_1d(alpha, direction);
             double sg   = c.Wmunu[idx_1d]*tau_fac[direction];
             double sgp1 = p1.Wmunu[idx_1d]*tau_fac[direction];
@@ -85,7 +90,7 @@ void Diss::MakeWSource(const double tau,
                 dWdx += (W_p - W_m)/delta[direction];
             }
 
-            if (alpha < 4 && DATA.turn_on_bulk == 1) {
+            if (alpha < 4 && (Config & PhysicsConfig::kBulk)) {
                 double gfac1 = (alpha == (direction) ? 1.0 : 0.0);
                 double bgp1  = (p1.pi_b*(gfac1 + p1.u[alpha]*p1.u[direction])
                                 *tau_fac[direction]);
@@ -104,7 +109,22 @@ void Diss::MakeWSource(const double tau,
                     dPidx += (Pi_p - Pi_m)/delta[direction];
                 }
             }
-        });
+        };
+        if (DATA.boost_invariant) {
+            Neighbourloop2D(arena_current, ix, iy, ieta, stencil);
+            // the eta neighbours of the single slice are the cell itself
+            if (alpha == 0 || alpha == 3) {
+                W_eta_p[alpha] = grid_pt.Wmunu[map_2d_idx_to_1d(alpha, 3)];
+                if (alpha < 4 && (Config & PhysicsConfig::kBulk)) {
+                    const double gfac1 = (alpha == 3 ? 1.0 : 0.0);
+                    W_eta_p[alpha] += (grid_pt.pi_b
+                                       *(gfac1 + grid_pt.u[alpha]*grid_pt.u[3]));
+                }
+                W_eta_m[alpha] = W_eta_p[alpha];
+            }
+        } else {
+            Neighbourloop(arena_current, ix, iy, ieta, stencil);
+        }
 
         // partial_m (tau W^mn) = W^0n + tau partial_tau W^mn
         //                        + partial_i(tau W^in)
@@ -139,10 +159,24 @@ void Diss::MakeWSource(const double tau,
         cosh_deta = 0.0;
         sinh_deta = 0.5;
     }
-    dwmn[0] += (  (W_eta_p[0] - W_eta_m[0])*cosh_deta
-                + (W_eta_p[3] + W_eta_m[3])*sinh_deta);
-    dwmn[3] += (  (W_eta_p[3] - W_eta_m[3])*cosh_deta
-                + (W_eta_p[0] + W_eta_m[0])*sinh_deta);
+    if (!DATA.boost_invariant && !eta_grid_.is_uniform()) {
+        // the geometric terms of each face from its distance to the cell
+        const double d_m = eta_grid_.get_face_distance_minus(ieta);
+        const double d_p = eta_grid_.get_face_distance_plus(ieta);
+        const double cosh_m = cosh(d_m)/delta[3];
+        const double cosh_p = cosh(d_p)/delta[3];
+        const double sinh_m = sinh(d_m)/delta[3];
+        const double sinh_p = sinh(d_p)/delta[3];
+        dwmn[0] += (  W_eta_p[0]*cosh_p - W_eta_m[0]*cosh_m
+                    + W_eta_p[3]*sinh_p + W_eta_m[3]*sinh_m);
+        dwmn[3] += (  W_eta_p[3]*cosh_p - W_eta_m[3]*cosh_m
+                    + W_eta_p[0]*sinh_p + W_eta_m[0]*sinh_m);
+    } else {
+        dwmn[0] += (  (W_eta_p[0] - W_eta_m[0])*cosh_deta
+                    + (W_eta_p[3] + W_eta_m[3])*sinh_deta);
+        dwmn[3] += (  (W_eta_p[3] - W_eta_m[3])*cosh_deta
+                    + (W_eta_p[0] + W_eta_m[0])*sinh_deta);
+    }
 
     // sources due to coordinate transform this is added to partial_m W^mn
     //dwmn[0] += grid_pt.Wmunu[9];
@@ -153,6 +187,7 @@ void Diss::MakeWSource(const double tau,
 
 double Diss::Make_uWSource(const double tau, const Cell_small *grid_pt,
                            const Cell_small *grid_pt_prev,
+                           const Cell_thermo &thermo,
                            const int mu, const int nu,
                            const int rk_flag, const double theta_local,
                            const DumuVec &a_local,
@@ -163,7 +198,7 @@ double Diss::Make_uWSource(const double tau, const Cell_small *grid_pt,
     double NS_term;
 
     auto sigma = Util::UnpackVecToMatrix(sigma_1d);
-    auto Wmunu = Util::UnpackVecToMatrix(grid_pt->Wmunu);
+    auto Wmunu = Util::UnpackVecToMatrix(to_ViscousVec(grid_pt->Wmunu));
 
     if (rk_flag == 0) {
         epsilon = grid_pt->epsilon;
@@ -173,8 +208,8 @@ double Diss::Make_uWSource(const double tau, const Cell_small *grid_pt,
         rhob = grid_pt_prev->rhob;
     }
 
-    T = eos.get_temperature(epsilon, rhob);
-    double muB = eos.get_muB(epsilon, rhob);
+    T = thermo.temperature;
+    double muB = thermo.muB;
 
     double shear_to_s = transport_coeffs_.get_eta_over_s(T, muB);
 
@@ -190,9 +225,9 @@ double Diss::Make_uWSource(const double tau, const Cell_small *grid_pt,
     //                Defining transport coefficients                     //
     ////////////////////////////////////////////////////////////////////////
     ////////////////////////////////////////////////////////////////////////
-    double pressure = eos.get_pressure(epsilon, rhob);
+    double pressure = thermo.pressure;
     if (DATA.muB_dependent_shear_to_s == 0) {
-        double entropy = eos.get_entropy(epsilon, rhob);
+        double entropy = thermo.entropy;
         shear = shear_to_s*entropy;
     } else {
         shear = shear_to_s*(epsilon + pressure)/std::max(T, small_eps);
@@ -365,16 +400,18 @@ double Diss::Make_uWSource(const double tau, const Cell_small *grid_pt,
 }
 
 
-int Diss::Make_uWRHS(const double tau, SCGrid &arena,
+template<class Grid>
+int Diss::Make_uWRHS(const double tau, Grid &arena,
                      const int ix, const int iy, const int ieta,
                      const int mu, const int nu, double &w_rhs,
                      const double theta_local, const DumuVec &a_local) {
     const InitData *const DATAaligned = assume_aligned(&DATA);
-    auto& grid_pt = arena(ix, iy, ieta);
+    const Cell_small &grid_pt = arena(ix, iy, ieta);
 
     w_rhs = 0.;
 
-    auto Wmunu_local = Util::UnpackVecToMatrix(grid_pt.Wmunu);
+    auto Wmunu_local = Util::UnpackVecToMatrix(
+                                            to_ViscousVec(grid_pt.Wmunu));
 
     /* Kurganov-Tadmor for Wmunu */
     /* implement 
@@ -392,12 +429,13 @@ int Diss::Make_uWRHS(const double tau, SCGrid &arena,
        Here fRph = ux WmnRph and ax uRph = |ux/utau|_max utau Wmn */
     /* This is the second step in the operator splitting. it uses
        rk_flag+1 as initial condition */
-    double delta[4] = {0.0, DATA.delta_x, DATA.delta_y, DATA.delta_eta*tau};
+    double delta[4] = {0.0, DATA.delta_x, DATA.delta_y,
+                       eta_grid_.get_width(ieta)*tau};
 
     const double delta_tau = DATA.delta_tau;
 
     // pi^\mu\nu is symmetric
-    Neighbourloop(arena, ix, iy, ieta, NLAMBDAS{
+    const auto stencil = NLAMBDAS_GENERIC{
         int idx_1d = map_2d_idx_to_1d(mu, nu);
         double sum = 0.0;
         /* Get_uWmns */
@@ -452,7 +490,12 @@ int Diss::Make_uWRHS(const double tau, SCGrid &arena,
         sum += -HW;
 
         w_rhs += sum*delta_tau;
-    });
+    };
+    if (DATA.boost_invariant) {
+        Neighbourloop2D(arena, ix, iy, ieta, stencil);
+    } else {
+        Neighbourloop(arena, ix, iy, ieta, stencil);
+    }
 
     /* add a source term -u^tau Wmn/tau
        due to the coordinate change to tau-eta */
@@ -492,10 +535,149 @@ int Diss::Make_uWRHS(const double tau, SCGrid &arena,
 }
 
 
-int Diss::Make_uPRHS(const double tau, SCGrid &arena,
+//! This function evaluates the KT fluxes of the shear, bulk, and diffusion
+//! currents in a single pass over the neighbours, sharing the signal speeds
+//! of each direction. Each component adds up the same terms in the same
+//! order as Make_uWRHS, Make_uPRHS, and Make_uqRHS.
+template<unsigned Config, class Grid>
+void Diss::Make_uWRHS_all(const double tau, Grid &arena,
+                          const int ix, const int iy, const int ieta,
+                          const double theta_local, const DumuVec &a_local,
+                          DissRHS &rhs) {
+    const InitData *const DATAaligned = assume_aligned(&DATA);
+    const Cell_small &grid_pt = arena(ix, iy, ieta);
+    const bool shear = (Config & PhysicsConfig::kShear);
+    const bool bulk  = (Config & PhysicsConfig::kBulk);
+    const bool diff  = (Config & PhysicsConfig::kDiff);
+
+    rhs = DissRHS();
+    double bulk_sum = 0.0;
+    std::array<double, 3> diff_sum = {0.0};
+
+    const double delta[4] = {0.0, DATA.delta_x, DATA.delta_y,
+                             eta_grid_.get_width(ieta)*tau};
+    const double delta_tau = DATA.delta_tau;
+
+    const auto stencil = NLAMBDAS_GENERIC{
+        // the KT signal speeds are the same for all the currents
+        const double a   = fabs(c.u[direction])/c.u[0];
+        const double am1 = (fabs(m1.u[direction])/m1.u[0]);
+        const double ap1 = (fabs(p1.u[direction])/p1.u[0]);
+        const double ax_ph = std::max(a, ap1);
+        const double ax_mh = std::max(a, am1);
+
+        // partial_i (u^i X) of the current X with the KT flux
+        auto get_HW = [&](double g, double gp1, double gp2,
+                          double gm1, double gm2) {
+            double f = g*c.u[direction];
+            g *=   c.u[0];
+            double fp2 = gp2*p2.u[direction];
+            gp2 *= p2.u[0];
+            double fp1 = gp1*p1.u[direction];
+            gp1 *= p1.u[0];
+            double fm1 = gm1*m1.u[direction];
+            gm1 *= m1.u[0];
+            double fm2 = gm2*m2.u[direction];
+            gm2 *= m2.u[0];
+
+            double uWphR = fp1 - 0.5*minmod.minmod_dx(fp2, fp1, f);
+            double temp  = 0.5*minmod.minmod_dx(fp1, f, fm1);
+            double uWphL = f + temp;
+            double uWmhR = f - temp;
+            double uWmhL = fm1 + 0.5*minmod.minmod_dx(f, fm1, fm2);
+
+            double WphR = gp1 - 0.5*minmod.minmod_dx(gp2, gp1, g);
+            temp        = 0.5*minmod.minmod_dx(gp1, g, gm1);
+            double WphL = g + temp;
+            double WmhR = g - temp;
+            double WmhL = gm1 + 0.5*minmod.minmod_dx(g, gm1, gm2);
+
+            double HWph = ((uWphR + uWphL) - ax_ph*(WphR - WphL))*0.5;
+            double HWmh = ((uWmhR + uWmhL) - ax_mh*(WmhR - WmhL))*0.5;
+            return((HWph - HWmh)/delta[direction]);
+        };
+
+        if (shear) {
+            for (int i = 0; i < 5; i++) {
+                const int idx_1d = 4 + i;
+                const double HW = get_HW(c.Wmunu[idx_1d], p1.Wmunu[idx_1d],
+                                         p2.Wmunu[idx_1d], m1.Wmunu[idx_1d],
+                                         m2.Wmunu[idx_1d]);
+                rhs.shear[i] += -HW*delta_tau;
+            }
+        }
+        if (bulk) {
+            bulk_sum += -get_HW(c.pi_b, p1.pi_b, p2.pi_b, m1.pi_b, m2.pi_b);
+        }
+        if (diff) {
+            for (int i = 0; i < 3; i++) {
+                const int idx_1d = 11 + i;
+                diff_sum[i] += -get_HW(c.Wmunu[idx_1d], p1.Wmunu[idx_1d],
+                                       p2.Wmunu[idx_1d], m1.Wmunu[idx_1d],
+                                       m2.Wmunu[idx_1d]);
+            }
+        }
+    };
+    if (DATA.boost_invariant) {
+        Neighbourloop2D(arena, ix, iy, ieta, stencil);
+    } else {
+        Neighbourloop(arena, ix, iy, ieta, stencil);
+    }
+
+    if (shear) {
+        // the source terms due to the coordinate change to tau-eta,
+        // see Make_uWRHS
+        auto Wmunu_local = Util::UnpackVecToMatrix(
+                                            to_ViscousVec(grid_pt.Wmunu));
+        for (int i = 0; i < 5; i++) {
+            int mu = 0;
+            int nu = 0;
+            Util::map_1d_idx_to_2d(4 + i, mu, nu);
+            double tempf = (
+                 - (DATAaligned->gmunu[3][mu])*(Wmunu_local[0][nu])
+                 - (DATAaligned->gmunu[3][nu])*(Wmunu_local[0][mu])
+                 + (DATAaligned->gmunu[0][mu])*(Wmunu_local[3][nu])
+                 + (DATAaligned->gmunu[0][nu])*(Wmunu_local[3][mu])
+                 + (Wmunu_local[3][nu])*(grid_pt.u[mu])*(grid_pt.u[0])
+                 + (Wmunu_local[3][mu])*(grid_pt.u[nu])*(grid_pt.u[0])
+                 - (Wmunu_local[0][nu])*(grid_pt.u[mu])*(grid_pt.u[3])
+                 - (Wmunu_local[0][mu])*(grid_pt.u[nu])*(grid_pt.u[3]))
+                 *(grid_pt.u[3]/tau);
+
+            for (int ic = 0; ic < 4; ic++) {
+                const double ic_fac = (ic == 0 ? -1.0 : 1.0);
+                tempf += (
+                    (Wmunu_local[ic][nu])*(grid_pt.u[mu])*(a_local[ic])*ic_fac
+                  + (Wmunu_local[ic][mu])*(grid_pt.u[nu])*(a_local[ic])*ic_fac);
+            }
+
+            rhs.shear[i] += (
+                tempf*(DATAaligned->delta_tau)
+                + (- (grid_pt.u[0]*Wmunu_local[mu][nu])/tau
+                   + (theta_local*Wmunu_local[mu][nu]))
+                  *(DATAaligned->delta_tau));
+        }
+    }
+    if (bulk) {
+        // the source terms due to the coordinate change to tau-eta
+        bulk_sum -= grid_pt.pi_b*grid_pt.u[0]/tau;
+        bulk_sum += grid_pt.pi_b*theta_local;
+        rhs.bulk = bulk_sum*(DATA.delta_tau);
+    }
+    if (diff) {
+        for (int i = 0; i < 3; i++) {
+            rhs.diff[i] = diff_sum[i]*(DATA.delta_tau);
+        }
+    }
+}
+
+
+template<class Grid>
+int Diss::Make_uPRHS(const double tau, Grid &arena,
                      const int ix, const int iy, const int ieta,
                      double *p_rhs, const double theta_local) {
-    auto grid_pt = &(arena(ix, iy, ieta));
+    const double pi_b_c = arena(ix, iy, ieta).pi_b;
+    const double u0_c   = arena(ix, iy, ieta).u[0];
 
     /* Kurganov-Tadmor for Pi */
     /* implement 
@@ -519,10 +701,10 @@ int Diss::Make_uPRHS(const double tau, SCGrid &arena,
     delta[0] = 0.0;
     delta[1] = DATA.delta_x;
     delta[2] = DATA.delta_y;
-    delta[3] = DATA.delta_eta*tau;
+    delta[3] = eta_grid_.get_width(ieta)*tau;
 
     double sum = 0.0;
-    Neighbourloop(arena, ix, iy, ieta, NLAMBDAS{
+    const auto stencil = NLAMBDAS_GENERIC{
         /* Get_uPis */
         double g = c.pi_b;
         double f = g*c.u[direction];
@@ -579,11 +761,16 @@ int Diss::Make_uPRHS(const double tau, SCGrid &arena,
 
         /* make partial_i (u^i Pi) */
         sum += -HPi;
-    });
+    };
+    if (DATA.boost_invariant) {
+        Neighbourloop2D(arena, ix, iy, ieta, stencil);
+    } else {
+        Neighbourloop(arena, ix, iy, ieta, stencil);
+    }
 
      /* add a source term due to the coordinate change to tau-eta */
-     sum -= (grid_pt->pi_b)*(grid_pt->u[0])/tau;
-     sum += (grid_pt->pi_b)*theta_local;
+     sum -= pi_b_c*u0_c/tau;
+     sum += pi_b_c*theta_local;
      *p_rhs = sum*(DATA.delta_tau);
 
      return 1;
@@ -591,7 +778,8 @@ int Diss::Make_uPRHS(const double tau, SCGrid &arena,
 
 
 double Diss::Make_uPiSource(const double tau, const Cell_small *grid_pt,
-                            const Cell_small *grid_pt_prev, 
+                            const Cell_small *grid_pt_prev,
+                            const Cell_thermo &thermo, const double lambda_max,
                             const int rk_flag, const double theta_local,
                             const VelocityShearVec &sigma_1d) {
     double tempf;
@@ -625,11 +813,11 @@ double Diss::Make_uPiSource(const double tau, const Cell_small *grid_pt,
     //s_den = eos.get_entropy(epsilon, rhob);
     //shear = (DATA.shear_to_s)*s_den;   
     // shear viscosity = constant * (e + P)/T
-    double temperature = eos.get_temperature(epsilon, rhob);
+    double temperature = thermo.temperature;
 
     // cs2 is the velocity of sound squared
-    double cs2 = eos.get_cs2(epsilon, rhob);
-    double pressure = eos.get_pressure(epsilon, rhob);
+    double cs2 = thermo.cs2;
+    double pressure = thermo.pressure;
 
     // T dependent bulk viscosity
     bulk = transport_coeffs_.get_zeta_over_s(temperature);
@@ -648,7 +836,7 @@ double Diss::Make_uPiSource(const double tau, const Cell_small *grid_pt,
     }
     
     if (DATA.causality_method == 2){
-        Bulk_Relax_time = Bulk_Relax_time/transport_coeffs_.get_causality_bulk_factor(cs2, grid_pt->pi_b, grid_pt->Lambdas[2]);
+        Bulk_Relax_time = Bulk_Relax_time/transport_coeffs_.get_causality_bulk_factor(cs2, grid_pt->pi_b, lambda_max);
     }
 
     Bulk_Relax_time = (
@@ -687,7 +875,7 @@ double Diss::Make_uPiSource(const double tau, const Cell_small *grid_pt,
 
     if (include_coupling_to_shear == 1) {
         auto sigma = Util::UnpackVecToMatrix(sigma_1d);
-        auto Wmunu = Util::UnpackVecToMatrix(grid_pt->Wmunu);
+        auto Wmunu = Util::UnpackVecToMatrix(to_ViscousVec(grid_pt->Wmunu));
 
         Wsigma = (  Wmunu[0][0]*sigma[0][0]
                   + Wmunu[1][1]*sigma[1][1]
@@ -741,7 +929,8 @@ double Diss::Make_uPiSource(const double tau, const Cell_small *grid_pt,
 */
 double Diss::Make_uqSource(
     const double tau, const Cell_small *grid_pt, const Cell_small *grid_pt_prev,
-    const int nu, const int rk_flag, const double theta_local,
+    const Cell_thermo &thermo, const int nu, const int rk_flag,
+    const double theta_local,
     const DumuVec &a_local, const VelocityShearVec &sigma_1d,
     const VorticityVec &omega_1d, const DmuMuBoverTVec &baryon_diffusion_vec) {
 
@@ -753,14 +942,14 @@ double Diss::Make_uqSource(
         epsilon = grid_pt_prev->epsilon;
         rhob = grid_pt_prev->rhob;
     }
-    double pressure = eos.get_pressure(epsilon, rhob);
-    double T        = eos.get_temperature(epsilon, rhob);
+    double pressure = thermo.pressure;
+    double T        = thermo.temperature;
 
     double kappa_coefficient = DATA.kappa_coefficient;
     double tau_rho = kappa_coefficient/std::max(T, small_eps);
     tau_rho = std::min(10., std::max(3.*DATA.delta_tau, tau_rho));
 
-    double mub   = eos.get_muB(epsilon, rhob);
+    double mub   = thermo.muB;
     double alpha = mub/std::max(T, small_eps);
     double denorm_safe = std::copysign(
             std::max(std::abs(3.*T*tanh(alpha)), small_eps), 3.*T*tanh(alpha));
@@ -861,7 +1050,305 @@ double Diss::Make_uqSource(
 }
 
 
-double Diss::Make_uqRHS(const double tau, SCGrid &arena,
+template<unsigned Config>
+void Diss::make_source_context(const Cell_small *grid_pt,
+                               const Cell_small *grid_pt_prev,
+                               const Cell_thermo &thermo,
+                               const double lambda_max, const int rk_flag,
+                               const VelocityShearVec &sigma_1d,
+                               const VorticityVec &omega_1d,
+                               SourceContext &ctx) {
+    if (rk_flag == 0) {
+        ctx.epsilon = grid_pt->epsilon;
+        ctx.rhob = grid_pt->rhob;
+    } else {
+        ctx.epsilon = grid_pt_prev->epsilon;
+        ctx.rhob = grid_pt_prev->rhob;
+    }
+    ctx.pressure = thermo.pressure;
+    ctx.T = thermo.temperature;
+    const double epsilon = ctx.epsilon;
+    // the explicit relaxation terms are stable for tau_X >= 3 delta_tau
+    const double tau_relax_min = (DATA.implicit_relaxation == 1
+                                  ? small_eps : 3.*DATA.delta_tau);
+    const double pressure = ctx.pressure;
+    const double T = ctx.T;
+
+    ctx.sigma = Util::UnpackVecToMatrix(sigma_1d);
+    ctx.Wmunu = Util::UnpackVecToMatrix(to_ViscousVec(grid_pt->Wmunu));
+    if (DATA.include_vorticity_terms == 1) {
+        ctx.omega = Util::UnpackVecToMatrix(omega_1d);
+    }
+
+    // the contractions shared by the shear and the bulk sources
+    if (DATA.include_second_order_terms == 1
+            && (Config & (PhysicsConfig::kShear | PhysicsConfig::kBulk))) {
+        const auto &Wmunu = ctx.Wmunu;
+        const auto &sigma = ctx.sigma;
+        ctx.Wsigma = (
+               Wmunu[0][0]*sigma[0][0]
+             + Wmunu[1][1]*sigma[1][1]
+             + Wmunu[2][2]*sigma[2][2]
+             + Wmunu[3][3]*sigma[3][3]
+             - 2.*(  Wmunu[0][1]*sigma[0][1]
+                   + Wmunu[0][2]*sigma[0][2]
+                   + Wmunu[0][3]*sigma[0][3])
+             +2.*(  Wmunu[1][2]*sigma[1][2]
+                  + Wmunu[1][3]*sigma[1][3]
+                  + Wmunu[2][3]*sigma[2][3]));
+        ctx.Wsquare = (  Wmunu[0][0]*Wmunu[0][0]
+                       + Wmunu[1][1]*Wmunu[1][1]
+                       + Wmunu[2][2]*Wmunu[2][2]
+                       + Wmunu[3][3]*Wmunu[3][3]
+                - 2.*(  Wmunu[0][1]*Wmunu[0][1]
+                      + Wmunu[0][2]*Wmunu[0][2]
+                      + Wmunu[0][3]*Wmunu[0][3])
+                + 2.*(  Wmunu[1][2]*Wmunu[1][2]
+                      + Wmunu[1][3]*Wmunu[1][3]
+                      + Wmunu[2][3]*Wmunu[2][3]));
+    }
+
+    if (Config & PhysicsConfig::kShear) {
+        double shear_to_s = transport_coeffs_.get_eta_over_s(T, thermo.muB);
+        if (DATA.muB_dependent_shear_to_s == 0) {
+            ctx.shear = shear_to_s*thermo.entropy;
+        } else {
+            ctx.shear = shear_to_s*(epsilon + pressure)/std::max(T, small_eps);
+        }
+        double tau_pi = (transport_coeffs_.get_shear_relax_time_factor()
+                         *ctx.shear/std::max(epsilon + pressure, small_eps));
+        tau_pi = std::min(10., std::max(tau_relax_min, tau_pi));
+        ctx.tau_pi = tau_pi;
+
+        ctx.tc_WW = transport_coeffs_.get_phi7_coeff()*tau_pi/ctx.shear*(4./5.);
+        ctx.tc_theta  = transport_coeffs_.get_delta_pipi_coeff()*tau_pi;
+        ctx.tc_Wsigma = transport_coeffs_.get_tau_pipi_coeff()*tau_pi;
+        ctx.tc_bulk   = transport_coeffs_.get_lambda_piPi_coeff()*tau_pi;
+    }
+
+    if (Config & PhysicsConfig::kBulk) {
+        const double cs2 = thermo.cs2;
+        ctx.bulk = transport_coeffs_.get_zeta_over_s(T);
+        ctx.bulk = ctx.bulk*(epsilon + pressure)/T;
+
+        double csfactor = std::max(1./3. - cs2, small_eps);
+        double tau_Pi = (transport_coeffs_.get_bulk_relax_time_factor()
+                         /(csfactor*csfactor)
+                         /std::max(epsilon + pressure, small_eps)*ctx.bulk);
+        if (DATA.bulk_relaxation_type == 1) {
+            tau_Pi = (
+                ctx.bulk/(transport_coeffs_.get_bulk_relax_time_factor()
+                          *csfactor)
+                /std::max(epsilon + pressure, small_eps));
+        }
+        if (DATA.causality_method == 2) {
+            tau_Pi = tau_Pi/transport_coeffs_.get_causality_bulk_factor(
+                            cs2, grid_pt->pi_b, lambda_max);
+        }
+        tau_Pi = std::min(10., std::max(tau_relax_min, tau_Pi));
+        ctx.tau_Pi = tau_Pi;
+
+        ctx.tc_Pi_theta  = transport_coeffs_.get_delta_PiPi_coeff()*tau_Pi;
+        ctx.tc_PiPi      = transport_coeffs_.get_tau_pipi_coeff()*tau_Pi;
+        ctx.tc_Pi_Wsigma = (transport_coeffs_.get_lambda_Pipi_coeff()
+                            *(1./3. - cs2)*tau_Pi);
+    }
+
+    if (Config & PhysicsConfig::kDiff) {
+        const double rhob = ctx.rhob;
+        double kappa_coefficient = DATA.kappa_coefficient;
+        double tau_rho = kappa_coefficient/std::max(T, small_eps);
+        tau_rho = std::min(10., std::max(tau_relax_min, tau_rho));
+        ctx.tau_rho = tau_rho;
+
+        double mub   = thermo.muB;
+        double alpha = mub/std::max(T, small_eps);
+        double denorm_safe = std::copysign(
+            std::max(std::abs(3.*T*tanh(alpha)), small_eps), 3.*T*tanh(alpha));
+        ctx.kappa = kappa_coefficient*(
+                          rhob/denorm_safe
+                        - rhob*rhob/std::max(epsilon + pressure, small_eps));
+        if (DATA.Initial_profile == 1) {
+            // for 1+1D numerical test
+            double denorm_safe = std::copysign(
+                std::max(std::abs(mub), small_eps), mub);
+            ctx.kappa = kappa_coefficient*(rhob/denorm_safe);
+        }
+
+        ctx.tc_q_theta = transport_coeffs_.get_delta_qq_coeff()*tau_rho;
+        ctx.tc_q_sigma = transport_coeffs_.get_lambda_qq_coeff()*tau_rho;
+    }
+}
+
+
+//! This function evaluates the source terms of the shear, bulk, and
+//! diffusion currents of a cell from one SourceContext. Each component
+//! adds up the same terms in the same order as Make_uWSource,
+//! Make_uPiSource, and Make_uqSource.
+template<unsigned Config>
+void Diss::Make_uWSource_all(const double tau, const Cell_small *grid_pt,
+                             const Cell_small *grid_pt_prev,
+                             const Cell_thermo &thermo,
+                             const double lambda_max, const int rk_flag,
+                             const double theta_local, const DumuVec &a_local,
+                             const VelocityShearVec &sigma_1d,
+                             const VorticityVec &omega_1d,
+                             const DmuMuBoverTVec &baryon_diffusion_vec,
+                             DissSource &source) {
+    SourceContext ctx;
+    make_source_context<Config>(grid_pt, grid_pt_prev, thermo, lambda_max,
+                                rk_flag, sigma_1d, omega_1d, ctx);
+    const auto &Wmunu = ctx.Wmunu;
+    const auto &sigma = ctx.sigma;
+    const auto &omega = ctx.omega;
+    const bool second_order = (DATA.include_second_order_terms == 1);
+    const bool vorticity = (DATA.include_vorticity_terms == 1);
+
+    source = DissSource();
+    if (Config & PhysicsConfig::kShear) {
+        const bool include_nonlinear = (second_order
+                                        && DATA.Initial_profile != 0);
+        // transport coefficient of W^{mu nu} Pi, not yet known
+        const double tc2_bulk = 0.;
+        for (int idx_1d = 4; idx_1d < 9; idx_1d++) {
+            int mu = 0;
+            int nu = 0;
+            Util::map_1d_idx_to_2d(idx_1d, mu, nu);
+
+            double tempf = (-(1.0 + ctx.tc_theta*theta_local)*(Wmunu[mu][nu]));
+            double NS_term = - 2.*ctx.shear*sigma[mu][nu];
+
+            double Vorticity_term = 0.0;
+            if (vorticity) {
+                double transport_coefficient4 = 2.*ctx.tau_pi;
+                double term1_Vorticity = (- Wmunu[mu][0]*omega[nu][0]
+                                          - Wmunu[nu][0]*omega[mu][0]
+                                          + Wmunu[mu][1]*omega[nu][1]
+                                          + Wmunu[nu][1]*omega[mu][1]
+                                          + Wmunu[mu][2]*omega[nu][2]
+                                          + Wmunu[nu][2]*omega[mu][2]
+                                          + Wmunu[mu][3]*omega[nu][3]
+                                          + Wmunu[nu][3]*omega[mu][3])/2.;
+                Vorticity_term = transport_coefficient4*term1_Vorticity;
+            }
+
+            double Wsigma_term = 0.0;
+            double WW_term = 0.0;
+            if (include_nonlinear) {
+                double term1_Wsigma = ( - Wmunu[mu][0]*sigma[nu][0]
+                                        - Wmunu[nu][0]*sigma[mu][0]
+                                        + Wmunu[mu][1]*sigma[nu][1]
+                                        + Wmunu[nu][1]*sigma[mu][1]
+                                        + Wmunu[mu][2]*sigma[nu][2]
+                                        + Wmunu[nu][2]*sigma[mu][2]
+                                        + Wmunu[mu][3]*sigma[nu][3]
+                                        + Wmunu[nu][3]*sigma[mu][3])/2.;
+                double term2_Wsigma = (-(1./3.)*(DATA.gmunu[mu][nu]
+                                                 + grid_pt->u[mu]
+                                                   *grid_pt->u[nu])
+                                       *ctx.Wsigma);
+                term1_Wsigma = ctx.tc_Wsigma*term1_Wsigma;
+                term2_Wsigma = ctx.tc_Wsigma*term2_Wsigma;
+                Wsigma_term = -term1_Wsigma - term2_Wsigma;
+
+                double term1_WW = ( - Wmunu[mu][0]*Wmunu[nu][0]
+                                    + Wmunu[mu][1]*Wmunu[nu][1]
+                                    + Wmunu[mu][2]*Wmunu[nu][2]
+                                    + Wmunu[mu][3]*Wmunu[nu][3]);
+                double term2_WW = (-(1./3.)*(DATA.gmunu[mu][nu]
+                                             + grid_pt->u[mu]*grid_pt->u[nu])
+                                   *ctx.Wsquare);
+                term1_WW = term1_WW*ctx.tc_WW;
+                term2_WW = term2_WW*ctx.tc_WW;
+                WW_term = -term1_WW - term2_WW;
+            }
+
+            double Coupling_to_Bulk = 0.0;
+            if (second_order) {
+                double Bulk_Sigma_term = (
+                            grid_pt->pi_b*sigma[mu][nu]*ctx.tc_bulk);
+                double Bulk_W_term = grid_pt->pi_b*Wmunu[mu][nu]*tc2_bulk;
+                Coupling_to_Bulk = -Bulk_Sigma_term + Bulk_W_term;
+            }
+
+            source.shear[idx_1d - 4] = (
+                (NS_term + tempf + Vorticity_term + Wsigma_term + WW_term
+                 + Coupling_to_Bulk)/(ctx.tau_pi));
+        }
+        source.shear_rate = 1./ctx.tau_pi;
+    }
+
+    if (Config & PhysicsConfig::kBulk) {
+        const double pi_b = grid_pt->pi_b;
+        // transport coefficient of W^{mu nu} W_{mu nu}, not known
+        const double tc_Pi_WW = 0.;
+        double NS_term = -ctx.bulk*theta_local;
+        double tempf = -pi_b - ctx.tc_Pi_theta*theta_local*pi_b;
+        double BB_term = 0.0;
+        double Coupling_to_Shear = 0.0;
+        if (second_order) {
+            BB_term = ctx.tc_PiPi*pi_b*pi_b;
+            Coupling_to_Shear = (-ctx.Wsigma*ctx.tc_Pi_Wsigma
+                                 + ctx.Wsquare*tc_Pi_WW);
+        }
+        source.bulk = ((NS_term + tempf + BB_term + Coupling_to_Shear)
+                       /ctx.tau_Pi);
+        source.bulk_rate = 1./ctx.tau_Pi;
+    }
+
+    if (Config & PhysicsConfig::kDiff) {
+        const double tau_rho = ctx.tau_rho;
+        double q[4];
+        for (int i = 0; i < 4; i++) {
+            q[i] = grid_pt->Wmunu[10+i];
+        }
+
+        // q[e] g[e][b] Du[b] is the same for all the components
+        double qa = 0.0;
+        for (int i = 0; i < 4; i++) {
+            qa += q[i]*Util::gmn(i)*a_local[i];
+        }
+
+        for (int nu = 1; nu < 4; nu++) {
+            double NS = ctx.kappa*(baryon_diffusion_vec[nu]
+                                   + grid_pt->u[nu]*a_local[4]);
+            double Nonlinear1 = -ctx.tc_q_theta*q[nu]*theta_local;
+            double temptemp = 0.0;
+            for (int i = 0 ; i < 4; i++) {
+                temptemp += q[i]*sigma[i][nu]*DATA.gmunu[i][i];
+            }
+            double Nonlinear2 = -ctx.tc_q_sigma*temptemp;
+            double Nonlinear3 = 0.0;
+            if (vorticity) {
+                double transport_coeff_3 = 1.0*tau_rho;
+                double temp3 = 0.0;
+                for (int i = 0 ; i < 4; i++) {
+                    temp3 += q[i]*omega[i][nu]*DATA.gmunu[i][i];
+                }
+                Nonlinear3 = -transport_coeff_3*temp3;
+            }
+
+            double SW = (-q[nu] - NS + Nonlinear1 + Nonlinear2 + Nonlinear3)
+                        /tau_rho;
+            if (DATA.Initial_profile == 1) {
+                // for 1+1D numerical test
+                SW = (-q[nu] - NS)/tau_rho;
+            }
+            SW += (theta_local - grid_pt->u[0]/tau)*q[nu];
+            SW += ((DATA.gmunu[nu][0] + grid_pt->u[nu]*grid_pt->u[0])
+                     *grid_pt->u[3]*q[3]/tau
+                   - (DATA.gmunu[nu][3] + grid_pt->u[nu]*grid_pt->u[3])
+                     *grid_pt->u[3]*q[0]/tau);
+            SW += (grid_pt->u[nu])*qa;
+            source.diff[nu - 1] = SW;
+        }
+        source.diff_rate = 1./tau_rho;
+    }
+}
+
+
+template<class Grid>
+double Diss::Make_uqRHS(const double tau, Grid &arena,
                         const int ix, const int iy, const int ieta,
                         const int mu, const int nu) {
     /* Kurganov-Tadmor for q */
@@ -882,12 +1369,13 @@ double Diss::Make_uqRHS(const double tau, SCGrid &arena,
     /* This is the second step in the operator splitting. it uses
        rk_flag+1 as initial condition */
 
-    double delta[4] = {0.0, DATA.delta_x, DATA.delta_y, DATA.delta_eta*tau};
+    double delta[4] = {0.0, DATA.delta_x, DATA.delta_y,
+                       eta_grid_.get_width(ieta)*tau};
 
     // we use the Wmunu[4][nu] = q[nu]
     int idx_1d = map_2d_idx_to_1d(mu, nu);
     double sum = 0.0;
-    Neighbourloop(arena, ix, iy, ieta, NLAMBDAS{
+    const auto stencil = NLAMBDAS_GENERIC{
         /* Get_uWmns */
         double g = c.Wmunu[idx_1d];
         double f = g*c.u[direction];
@@ -937,7 +1425,12 @@ double Diss::Make_uqRHS(const double tau, SCGrid &arena,
         double HW = (HWph - HWmh)/delta[direction];
         /* make partial_i (u^i Wmn) */
         sum += -HW;
-    });
+    };
+    if (DATA.boost_invariant) {
+        Neighbourloop2D(arena, ix, iy, ieta, stencil);
+    } else {
+        Neighbourloop(arena, ix, iy, ieta, stencil);
+    }
 
     /* add a source term -u^tau Wmn/tau due to the coordinate 
      * change to tau-eta */
@@ -1239,3 +1732,70 @@ void Diss::output_zeta_over_s_along_const_sovernB() {
         of.close();  // close the file
     }
 }
+
+
+// the stencil sweeps are compiled for all the sweep grid layouts
+// and for the local stencil of the fused stage kernel
+#define INSTANTIATE_MAKE_WSOURCE(Config, Grid)                             \
+template void Diss::MakeWSource<Config, Grid>(                            \
+    const double, Grid&, SCGrid&, const int, const int, const int,        \
+    TJbVec&);
+#define INSTANTIATE_MAKE_UWRHS_ALL(Config, Grid)                           \
+template void Diss::Make_uWRHS_all<Config, Grid>(                         \
+    const double, Grid&, const int, const int, const int,                 \
+    const double, const DumuVec&, DissRHS&);
+#define INSTANTIATE_MAKE_UWRHS_ALL_CONFIGS(Grid)                           \
+INSTANTIATE_MAKE_UWRHS_ALL(0u, Grid)                                      \
+INSTANTIATE_MAKE_UWRHS_ALL(PhysicsConfig::kShear, Grid)                   \
+INSTANTIATE_MAKE_UWRHS_ALL(PhysicsConfig::kBulk, Grid)                    \
+INSTANTIATE_MAKE_UWRHS_ALL(PhysicsConfig::kDiff, Grid)                    \
+INSTANTIATE_MAKE_UWRHS_ALL(PhysicsConfig::kShear | PhysicsConfig::kBulk,  \
+                           Grid)                                          \
+INSTANTIATE_MAKE_UWRHS_ALL(PhysicsConfig::kShear | PhysicsConfig::kDiff,  \
+                           Grid)                                          \
+INSTANTIATE_MAKE_UWRHS_ALL(PhysicsConfig::kBulk | PhysicsConfig::kDiff,   \
+                           Grid)                                          \
+INSTANTIATE_MAKE_UWRHS_ALL(PhysicsConfig::kShear | PhysicsConfig::kBulk   \
+                           | PhysicsConfig::kDiff, Grid)
+#define INSTANTIATE_DISS_SWEEPS(Grid)                                      \
+INSTANTIATE_MAKE_UWRHS_ALL_CONFIGS(Grid)                                  \
+INSTANTIATE_MAKE_WSOURCE(0u, Grid)                                        \
+INSTANTIATE_MAKE_WSOURCE(PhysicsConfig::kBulk, Grid)                      \
+INSTANTIATE_MAKE_WSOURCE(PhysicsConfig::kDiff, Grid)                      \
+INSTANTIATE_MAKE_WSOURCE(PhysicsConfig::kBulk | PhysicsConfig::kDiff,     \
+                         Grid)                                            \
+template int Diss::Make_uWRHS<Grid>(                                      \
+    const double, Grid&, const int, const int, const int,                 \
+    const int, const int, double&, const double, const DumuVec&);         \
+template int Diss::Make_uPRHS<Grid>(                                      \
+    const double, Grid&, const int, const int, const int,                 \
+    double*, const double);                                               \
+template double Diss::Make_uqRHS<Grid>(                                   \
+    const double, Grid&, const int, const int, const int,                 \
+    const int, const int);
+
+INSTANTIATE_DISS_SWEEPS(SCGrid)
+INSTANTIATE_DISS_SWEEPS(PaddedSCGrid)
+INSTANTIATE_DISS_SWEEPS(SCGridSoA)
+INSTANTIATE_DISS_SWEEPS(SCStencil)
+#undef INSTANTIATE_DISS_SWEEPS
+#undef INSTANTIATE_MAKE_WSOURCE
+#undef INSTANTIATE_MAKE_UWRHS_ALL_CONFIGS
+#undef INSTANTIATE_MAKE_UWRHS_ALL
+
+#define INSTANTIATE_MAKE_UWSOURCE_ALL(Config)                              \
+template void Diss::Make_uWSource_all<Config>(                            \
+    const double, const Cell_small*, const Cell_small*,                   \
+    const Cell_thermo&, const double, const int, const double,            \
+    const DumuVec&, const VelocityShearVec&, const VorticityVec&,         \
+    const DmuMuBoverTVec&, DissSource&);
+INSTANTIATE_MAKE_UWSOURCE_ALL(0u)
+INSTANTIATE_MAKE_UWSOURCE_ALL(PhysicsConfig::kShear)
+INSTANTIATE_MAKE_UWSOURCE_ALL(PhysicsConfig::kBulk)
+INSTANTIATE_MAKE_UWSOURCE_ALL(PhysicsConfig::kDiff)
+INSTANTIATE_MAKE_UWSOURCE_ALL(PhysicsConfig::kShear | PhysicsConfig::kBulk)
+INSTANTIATE_MAKE_UWSOURCE_ALL(PhysicsConfig::kShear | PhysicsConfig::kDiff)
+INSTANTIATE_MAKE_UWSOURCE_ALL(PhysicsConfig::kBulk | PhysicsConfig::kDiff)
+INSTANTIATE_MAKE_UWSOURCE_ALL(PhysicsConfig::kShear | PhysicsConfig::kBulk
+                              | PhysicsConfig::kDiff)
+#undef INSTANTIATE_MAKE_UWSOURCE_ALL
@@ -6,16 +6,39 @@
 #include "util.h"
 #include "cell.h"
 #include "grid.h"
+#include "sweep_grid.h"
 #include "data.h"
 #include "transport_coeffs.h"
 #include "minmod.h"
+#include "eta_grid.h"
 #include "pretty_ostream.h"
 
+//! KT right hand sides of the dissipative currents of a cell,
+//! times delta_tau (see Diss::Make_uWRHS_all)
+struct DissRHS {
+    std::array<double, 5> shear = {0.};   //!< u pi^{mu nu}, idx_1d = 4..8
+    double bulk = 0.;                     //!< u Pi
+    std::array<double, 3> diff = {0.};    //!< u q^mu, idx_1d = 11..13
+};
+
+//! source terms of the dissipative currents of a cell
+//! (see Diss::Make_uWSource_all), and the rates 1/tau_X of their
+//! relaxation terms -X/tau_X, which the sources include
+struct DissSource {
+    std::array<double, 5> shear = {0.};   //!< idx_1d = 4..8
+    double bulk = 0.;
+    std::array<double, 3> diff = {0.};    //!< idx_1d = 11..13
+    double shear_rate = 0.;               //!< 1/tau_pi
+    double bulk_rate  = 0.;               //!< 1/tau_Pi
+    double diff_rate  = 0.;               //!< 1/tau_rho
+};
+
 class Diss {
  private:
     const InitData &DATA;
     const EOS &eos;
     const Minmod minmod;
+    const EtaGrid eta_grid_;
     TransportCoeffs transport_coeffs_;
     int map_2d_idx_to_1d(int a, int b) {
         static const int index_map[5][4] = {{0,   1,  2,  3},
@@ -28,46 +51,117 @@ class Diss {
 
     pretty_ostream music_message;
 
+    //! the thermodynamic and transport quantities of a cell shared by the
+    //! source terms of all its dissipative currents
+    struct SourceContext {
+        double epsilon, rhob, pressure, T;
+        Mat4x4 Wmunu, sigma, omega;
+        double Wsigma = 0.;     //!< W^{mu nu} sigma_{mu nu}
+        double Wsquare = 0.;    //!< W^{mu nu} W_{mu nu}
+
+        // shear
+        double shear, tau_pi;
+        double tc_WW, tc_theta, tc_Wsigma, tc_bulk;
+
+        // bulk
+        double bulk, tau_Pi;
+        double tc_Pi_theta, tc_PiPi, tc_Pi_Wsigma;
+
+        // diffusion
+        double kappa, tau_rho;
+        double tc_q_theta, tc_q_sigma;
+    };
+
+    template<unsigned Config>
+    void make_source_context(const Cell_small *grid_pt,
+                             const Cell_small *grid_pt_prev,
+                             const Cell_thermo &thermo,
+                             const double lambda_max, const int rk_flag,
+                             const VelocityShearVec &sigma_1d,
+                             const VorticityVec &omega_1d,
+                             SourceContext &ctx);
+
  public:
     Diss(const EOS &eosIn, const InitData &DATA_in);
+
+    //! The stencil sweeps below take any of the SweepGrid layouts
+    //! (explicitly instantiated in dissipative.cpp)
+    //! MakeWSource adds the bulk pressure and the baryon diffusion current
+    //! if Config has kBulk and kDiff (see physics_config.h)
+    template<unsigned Config, class Grid>
     void MakeWSource(const double tau,
-                     SCGrid &arena_current, SCGrid &arena_prev,
+                     Grid &arena_current, SCGrid &arena_prev,
                      const int ix, const int iy, const int ieta,
                      TJbVec &dwmn);
 
+    //! thermo is the cached Cell_thermo of grid_pt (rk_flag = 0)
+    //! or grid_pt_prev (rk_flag = 1)
     double Make_uWSource(const double tau, const Cell_small *grid_pt,
                          const Cell_small *grid_pt_prev,
+                         const Cell_thermo &thermo,
                          const int mu, const int nu, const int rk_flag,
                          const double theta_local, const DumuVec &a_local,
                          const VelocityShearVec &sigma_1d,
                          const VorticityVec &omega_1d);
 
-    int Make_uWRHS(const double tau, SCGrid &arena,
+    template<class Grid>
+    int Make_uWRHS(const double tau, Grid &arena,
                    const int ix, const int iy, const int ieta,
                    const int mu, const int nu, double &w_rhs,
                    const double theta_local, const DumuVec &a_local);
 
-    int Make_uPRHS(const double tau, SCGrid &arena,
+    //! this function gives the right hand sides of Make_uWRHS (shear),
+    //! Make_uPRHS (bulk), and Make_uqRHS (diffusion) of all the components
+    //! in Config (see physics_config.h) in one pass over the stencil
+    template<unsigned Config, class Grid>
+    void Make_uWRHS_all(const double tau, Grid &arena,
+                        const int ix, const int iy, const int ieta,
+                        const double theta_local, const DumuVec &a_local,
+                        DissRHS &rhs);
+
+    template<class Grid>
+    int Make_uPRHS(const double tau, Grid &arena,
                    const int ix, const int iy, const int ieta,
                    double *p_rhs, const double theta_local);
 
+    //! lambda_max is the largest eigenvalue of pi^mu_nu of grid_pt, which
+    //! the bulk relaxation time needs for causality_method = 2
     double Make_uPiSource(const double tau, const Cell_small *grid_pt,
-                          const Cell_small *grid_pt_prev, const int rk_flag,
+                          const Cell_small *grid_pt_prev,
+                          const Cell_thermo &thermo, const double lambda_max,
+                          const int rk_flag,
                           const double theta_local,
                           const VelocityShearVec &sigma_1d);
 
-    double Make_uqRHS(const double tau, SCGrid &arena_current,
+    template<class Grid>
+    double Make_uqRHS(const double tau, Grid &arena_current,
                       const int ix, const int iy, const int ieta,
                       const int mu, const int nu);
 
     double Make_uqSource(const double tau, const Cell_small *grid_pt,
                          const Cell_small *grid_pt_prev,
-                         const int nu, const int rk_flag,
+                         const Cell_thermo &thermo, const int nu, const int rk_flag,
                          const double theta_local, const DumuVec &a_local,
                          const VelocityShearVec &sigma_1d,
                          const VorticityVec &omega_1d,
                          const DmuMuBoverTVec &baryon_diffusion_vec);
 
+    //! this function gives the source terms of Make_uWSource (shear),
+    //! Make_uPiSource (bulk), and Make_uqSource (diffusion) of all the
+    //! components in Config (see physics_config.h), evaluating the shared
+    //! thermodynamic and transport quantities once
+    //! (explicitly instantiated in dissipative.cpp)
+    template<unsigned Config>
+    void Make_uWSource_all(const double tau, const Cell_small *grid_pt,
+                           const Cell_small *grid_pt_prev,
+                           const Cell_thermo &thermo,
+                           const double lambda_max, const int rk_flag,
+                           const double theta_local, const DumuVec &a_local,
+                           const VelocityShearVec &sigma_1d,
+                           const VorticityVec &omega_1d,
+                           const DmuMuBoverTVec &baryon_diffusion_vec,
+                           DissSource &source);
+
     void output_kappa_T_and_muB_dependence();
     void output_kappa_along_const_sovernB();
     void output_eta_over_s_T_and_muB_dependence();
@@ -0,0 +1,236 @@
+#include "dissipative.h"
+#include "physics_config.h"
+#include "doctest.h"
+#include "eos.h"
+#include <cmath>
+
+namespace {
+
+InitData make_test_data() {
+    InitData DATA;
+    DATA.delta_x                 = 0.2;
+    DATA.delta_y                 = 0.3;
+    DATA.delta_eta               = 0.1;
+    DATA.delta_tau               = 0.02;
+    DATA.minmod_theta            = 1.8;
+    DATA.turn_on_shear           = 1;
+    DATA.turn_on_bulk            = 1;
+    DATA.turn_on_diff            = 1;
+    DATA.shear_to_s              = 0.08;
+    DATA.T_dependent_shear_to_s  = 0;
+    DATA.muB_dependent_shear_to_s = 0;
+    DATA.shear_relax_time_factor = 5.;
+    DATA.bulk_relax_time_factor  = 1./14.55;
+    DATA.transport_coeffs_table  = 0;
+    DATA.T_dependent_bulk_to_s   = 1;
+    DATA.bulk_relaxation_type    = 0;
+    DATA.causality_method        = 0;
+    DATA.kappa_coefficient       = 0.4;
+    DATA.include_second_order_terms = 1;
+    DATA.include_vorticity_terms = 1;
+    DATA.Initial_profile         = 9;
+    DATA.boost_invariant         = false;
+    DATA.implicit_relaxation     = 0;
+    return(DATA);
+}
+
+//! a grid with smooth, non-trivial flow and dissipative currents
+void fill_test_grid(SCGrid &arena) {
+    for (int ieta = 0; ieta < arena.nEta(); ieta++)
+    for (int ix = 0; ix < arena.nX(); ix++)
+    for (int iy = 0; iy < arena.nY(); iy++) {
+        Cell_small &cell = arena(ix, iy, ieta);
+        cell.u[1] = 0.3*sin(0.7*ix + 0.2*iy);
+        cell.u[2] = 0.2*cos(0.5*iy - 0.3*ieta);
+        cell.u[3] = 0.1*sin(0.4*ieta + 0.1*ix);
+        cell.u[0] = sqrt(1. + cell.u[1]*cell.u[1] + cell.u[2]*cell.u[2]
+                         + cell.u[3]*cell.u[3]);
+        for (int i = 0; i < 14; i++) {
+            cell.Wmunu[i] = 0.01*sin(1.3*i + 0.9*ix - 0.4*iy + 0.6*ieta);
+        }
+        cell.pi_b = 0.02*cos(0.8*ix + 1.1*iy - 0.5*ieta);
+    }
+}
+
+}
+
+TEST_CASE("Make_uWRHS_all against the single component functions") {
+    EOS eos_ideal(0);
+    const InitData DATA = make_test_data();
+    Diss diss(eos_ideal, DATA);
+
+    SCGrid arena(7, 6, 5);
+    fill_test_grid(arena);
+    const double tau = 1.3;
+    const double theta_local = 0.7;
+    const DumuVec a_local = {0.01, -0.02, 0.03, 0.015, 0.};
+
+    for (int ieta = 0; ieta < arena.nEta(); ieta++)
+    for (int ix = 0; ix < arena.nX(); ix++)
+    for (int iy = 0; iy < arena.nY(); iy++) {
+        DissRHS rhs;
+        diss.Make_uWRHS_all<PhysicsConfig::kShear | PhysicsConfig::kBulk
+                            | PhysicsConfig::kDiff>(
+                tau, arena, ix, iy, ieta, theta_local, a_local, rhs);
+        for (int idx_1d = 4; idx_1d < 9; idx_1d++) {
+            int mu = 0;
+            int nu = 0;
+            Util::map_1d_idx_to_2d(idx_1d, mu, nu);
+            double w_rhs = 0.;
+            diss.Make_uWRHS(tau, arena, ix, iy, ieta, mu, nu, w_rhs,
+                            theta_local, a_local);
+            CHECK(rhs.shear[idx_1d - 4] == w_rhs);
+        }
+        double p_rhs = 0.;
+        diss.Make_uPRHS(tau, arena, ix, iy, ieta, &p_rhs, theta_local);
+        CHECK(rhs.bulk == p_rhs);
+        for (int nu = 1; nu < 4; nu++) {
+            CHECK(rhs.diff[nu - 1]
+                  == diss.Make_uqRHS(tau, arena, ix, iy, ieta, 4, nu));
+        }
+
+        // the components outside Config are zero
+        DissRHS rhs_shear;
+        diss.Make_uWRHS_all<PhysicsConfig::kShear>(
+                tau, arena, ix, iy, ieta, theta_local, a_local, rhs_shear);
+        CHECK(rhs_shear.shear == rhs.shear);
+        CHECK(rhs_shear.bulk == 0.);
+        CHECK(rhs_shear.diff[0] == 0.);
+    }
+}
+
+
+TEST_CASE("Make_uWSource_all against the single component functions") {
+    EOS eos_ideal(0);
+    const InitData DATA = make_test_data();
+    Diss diss(eos_ideal, DATA);
+
+    SCGrid arena(3, 3, 1);
+    fill_test_grid(arena);
+    const Cell_small &grid_pt = arena(1, 2, 0);
+    const Cell_small &grid_pt_prev = arena(2, 1, 0);
+    Cell_thermo thermo;
+    thermo.temperature = 0.9;
+    thermo.muB = 0.3;
+    thermo.pressure = 1.1;
+    thermo.entropy = 4.5;
+    thermo.cs2 = 0.2;
+
+    const double tau = 1.3;
+    const double theta_local = 0.7;
+    const DumuVec a_local = {0.01, -0.02, 0.03, 0.015, 0.05};
+    const DmuMuBoverTVec baryon_diffusion_vec = {0.02, -0.01, 0.03, 0.01};
+    VelocityShearVec sigma_1d;
+    for (int i = 0; i < 10; i++) sigma_1d[i] = 0.05*cos(0.7*i);
+    const VorticityVec omega_1d = {0.01, -0.03, 0.02, 0.04, -0.01, 0.02};
+
+    for (int rk_flag = 0; rk_flag < 2; rk_flag++) {
+        DissSource source;
+        diss.Make_uWSource_all<PhysicsConfig::kShear | PhysicsConfig::kBulk
+                               | PhysicsConfig::kDiff>(
+                tau, &grid_pt, &grid_pt_prev, thermo, 0., rk_flag,
+                theta_local, a_local, sigma_1d, omega_1d,
+                baryon_diffusion_vec, source);
+        for (int idx_1d = 4; idx_1d < 9; idx_1d++) {
+            int mu = 0;
+            int nu = 0;
+            Util::map_1d_idx_to_2d(idx_1d, mu, nu);
+            CHECK(source.shear[idx_1d - 4]
+                  == diss.Make_uWSource(tau, &grid_pt, &grid_pt_prev, thermo,
+                                        mu, nu, rk_flag, theta_local,
+                                        a_local, sigma_1d, omega_1d));
+        }
+        CHECK(source.bulk
+              == diss.Make_uPiSource(tau, &grid_pt, &grid_pt_prev, thermo,
+                                     0., rk_flag, theta_local, sigma_1d));
+        for (int nu = 1; nu < 4; nu++) {
+            CHECK(source.diff[nu - 1]
+                  == diss.Make_uqSource(tau, &grid_pt, &grid_pt_prev, thermo,
+                                        nu, rk_flag, theta_local, a_local,
+                                        sigma_1d, omega_1d,
+                                        baryon_diffusion_vec));
+        }
+        CHECK(source.bulk != 0.);
+        CHECK(source.diff[0] != 0.);
+
+        // the components outside Config are zero
+        DissSource source_bulk;
+        diss.Make_uWSource_all<PhysicsConfig::kBulk>(
+                tau, &grid_pt, &grid_pt_prev, thermo, 0., rk_flag,
+                theta_local, a_local, sigma_1d, omega_1d,
+                baryon_diffusion_vec, source_bulk);
+        CHECK(source_bulk.bulk == source.bulk);
+        CHECK(source_bulk.shear[0] == 0.);
+        CHECK(source_bulk.diff[0] == 0.);
+    }
+}
+
+
+TEST_CASE("Check the relaxation rates of Make_uWSource_all") {
+    EOS eos_ideal(0);
+    InitData DATA = make_test_data();
+    DATA.include_second_order_terms = 0;
+    DATA.include_vorticity_terms = 0;
+
+    SCGrid arena(3, 3, 1);
+    fill_test_grid(arena);
+    Cell_small grid_pt = arena(1, 2, 0);
+    Cell_thermo thermo;
+    thermo.temperature = 0.9;
+    thermo.muB = 0.3;
+    thermo.pressure = 1.1;
+    thermo.entropy = 4.5;
+    thermo.cs2 = 0.2;
+
+    const double tau = 1.3;
+    const DumuVec a_local = {0.01, -0.02, 0.03, 0.015, 0.05};
+    const DmuMuBoverTVec baryon_diffusion_vec = {0.02, -0.01, 0.03, 0.01};
+    VelocityShearVec sigma_1d;
+    for (int i = 0; i < 10; i++) sigma_1d[i] = 0.05*cos(0.7*i);
+    const VorticityVec omega_1d = {0.};
+    auto get_source = [&](Diss &diss, const Cell_small &cell) {
+        DissSource source;
+        diss.Make_uWSource_all<
+                PhysicsConfig::kShear | PhysicsConfig::kBulk
+              | PhysicsConfig::kDiff>(
+            tau, &cell, &cell, thermo, 0., 0, 0., a_local, sigma_1d,
+            omega_1d, baryon_diffusion_vec, source);
+        return(source);
+    };
+
+    // without theta and the second order terms the shear and bulk sources
+    // are the Navier-Stokes values minus the currents times the rates
+    Diss diss(eos_ideal, DATA);
+    const DissSource source = get_source(diss, grid_pt);
+    Cell_small grid_pt_0 = grid_pt;
+    grid_pt_0.Wmunu = {0.};
+    grid_pt_0.pi_b = 0.;
+    const DissSource source_0 = get_source(diss, grid_pt_0);
+    CHECK(source.shear_rate > 0.);
+    CHECK(source.bulk_rate > 0.);
+    CHECK(source.diff_rate == doctest::Approx(
+                thermo.temperature/DATA.kappa_coefficient));
+    for (int i = 0; i < 5; i++) {
+        CHECK(source.shear[i] - source_0.shear[i] == doctest::Approx(
+                -grid_pt.Wmunu[4 + i]*source.shear_rate));
+    }
+    CHECK(source.bulk - source_0.bulk == doctest::Approx(
+                -grid_pt.pi_b*source.bulk_rate));
+
+    // the explicit relaxation times are at least 3 delta_tau,
+    // the implicit ones can be shorter
+    DATA.shear_relax_time_factor = 1e-3;
+    DATA.kappa_coefficient = 1e-3;
+    Diss diss_explicit(eos_ideal, DATA);
+    const DissSource source_explicit = get_source(diss_explicit, grid_pt);
+    CHECK(source_explicit.shear_rate
+          == doctest::Approx(1./(3.*DATA.delta_tau)));
+    CHECK(source_explicit.diff_rate
+          == doctest::Approx(1./(3.*DATA.delta_tau)));
+    DATA.implicit_relaxation = 1;
+    Diss diss_implicit(eos_ideal, DATA);
+    const DissSource source_implicit = get_source(diss_implicit, grid_pt);
+    CHECK(source_implicit.shear_rate > 10.*source_explicit.shear_rate);
+    CHECK(source_implicit.diff_rate == doctest::Approx(
+                thermo.temperature/DATA.kappa_coefficient));
+}
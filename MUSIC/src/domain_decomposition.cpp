@@ -0,0 +1,180 @@
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+#include <type_traits>
+#include "pretty_ostream.h"
+#include "domain_decomposition.h"
+
+namespace {
+    //! the tags of the halo layers sent to the next and the previous rank
+    const int kTagToNext = 0;
+    const int kTagToPrev = 1;
+}
+
+
+DomainDecomposition::DomainDecomposition(const int neta) :
+        neta_global_(neta) {
+#ifdef MUSIC_MPI
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank_);
+    MPI_Comm_size(MPI_COMM_WORLD, &nranks_);
+#endif
+    get_slab(neta, nranks_, rank_, own_min_, own_max_);
+    if (is_distributed() && own_max_ - own_min_ < kHaloWidth) {
+        pretty_ostream music_message;
+        music_message << "DomainDecomposition: the " << neta
+                      << " eta layers can not be split over " << nranks_
+                      << " ranks, every slab needs at least " << kHaloWidth
+                      << " layers!";
+        music_message.flush("error");
+        exit(1);
+    }
+    local_min_ = (rank_ > 0 ? own_min_ - kHaloWidth : own_min_);
+    local_max_ = (rank_ < nranks_ - 1 ? own_max_ + kHaloWidth : own_max_);
+}
+
+
+//! the first neta%nranks slabs have one more layer than the others
+void DomainDecomposition::get_slab(const int neta, const int nranks,
+                                   const int rank,
+                                   int &eta_min, int &eta_max) {
+    const int n_base = neta/nranks;
+    const int n_rest = neta%nranks;
+    eta_min = rank*n_base + std::min(rank, n_rest);
+    eta_max = eta_min + n_base + (rank < n_rest ? 1 : 0);
+}
+
+
+int DomainDecomposition::get_interior_eta_min() const {
+    int eta_min = own_min_;
+    if (rank_ > 0) eta_min = std::min(own_min_ + kHaloWidth, own_max_);
+    return(eta_min - local_min_);
+}
+
+
+int DomainDecomposition::get_interior_eta_max() const {
+    int eta_max = own_max_;
+    if (rank_ < nranks_ - 1) {
+        eta_max = std::max(own_max_ - kHaloWidth,
+                           get_interior_eta_min() + local_min_);
+    }
+    return(eta_max - local_min_);
+}
+
+
+void DomainDecomposition::check_supported(const InitData &DATA) const {
+    if (!is_distributed()) return;
+    const auto reject = [](const bool condition, const std::string &option) {
+        if (!condition) return;
+        pretty_ostream music_message;
+        music_message << "The distributed evolution does not support "
+                      << option << "!";
+        music_message.flush("error");
+        exit(1);
+    };
+    reject(DATA.mode != 2, "running modes other than 2");
+    reject(DATA.boost_invariant, "boost-invariant runs");
+    reject(DATA.eta_boundary_condition == 1,
+           "eta_boundary_condition = 1 (periodic)");
+    reject(DATA.outputEvolutionData != 0, "outputEvolutionData");
+    reject(DATA.output_movie_flag == 1, "output_movie_flag");
+    reject(DATA.output_movie_reductions != 0, "output_movie_reductions");
+    reject(DATA.debug_snapshot_ring != 0, "debug_snapshot_ring");
+    reject(DATA.store_hydro_info_in_memory == 1,
+           "store_hydro_info_in_memory");
+    reject(DATA.output_outofequilibriumsize == 1,
+           "output_outofequilibriumsize");
+    reject(DATA.freeze_surface_single_file == 1,
+           "freeze_surface_single_file = 1");
+    reject(DATA.causality_method != 0 && DATA.causality_diagnostics_stride > 0,
+           "causality_diagnostics_stride");
+    reject(DATA.causality_method != 0 && DATA.causality_statistics == 1,
+           "causality_statistics");
+    reject(   DATA.checkpoint_every_N_timesteps > 0
+           || DATA.restart_from_checkpoint == 1, "checkpoints");
+    reject(DATA.transverse_coarsening_levels > 0,
+           "transverse_coarsening_levels");
+}
+
+
+SCGrid DomainDecomposition::get_local_grid(const SCGrid &global) const {
+    const int nx = global.nX();
+    const int ny = global.nY();
+    SCGrid local(nx, ny, get_local_neta());
+    #pragma omp parallel for collapse(2)
+    for (int ieta = 0; ieta < get_local_neta(); ieta++)
+    for (int iy = 0; iy < ny; iy++) {
+        for (int ix = 0; ix < nx; ix++) {
+            local(ix, iy, ieta) = global(ix, iy, ieta + local_min_);
+        }
+    }
+    return(local);
+}
+
+
+//! the eta layers of a grid are contiguous (x fastest, see grid.h), so
+//! kHaloWidth layers are sent as one block
+void DomainDecomposition::start_halo_exchange(SCGrid &arena) {
+#ifdef MUSIC_MPI
+    static_assert(std::is_trivially_copyable<Cell_small>::value,
+                  "the halo layers are sent as bytes");
+    if (!is_distributed()) return;
+    const int n_bytes = static_cast<int>(
+                sizeof(Cell_small)*arena.nX()*arena.nY()*kHaloWidth);
+    const int owned_min = get_owned_eta_min();
+    const int owned_max = get_owned_eta_max();
+    requests_.clear();
+    if (rank_ > 0) {
+        requests_.emplace_back();
+        MPI_Irecv(&arena(0, 0, owned_min - kHaloWidth), n_bytes, MPI_BYTE,
+                  rank_ - 1, kTagToNext, MPI_COMM_WORLD, &requests_.back());
+        requests_.emplace_back();
+        MPI_Isend(&arena(0, 0, owned_min), n_bytes, MPI_BYTE,
+                  rank_ - 1, kTagToPrev, MPI_COMM_WORLD, &requests_.back());
+    }
+    if (rank_ < nranks_ - 1) {
+        requests_.emplace_back();
+        MPI_Irecv(&arena(0, 0, owned_max), n_bytes, MPI_BYTE,
+                  rank_ + 1, kTagToPrev, MPI_COMM_WORLD, &requests_.back());
+        requests_.emplace_back();
+        MPI_Isend(&arena(0, 0, owned_max - kHaloWidth), n_bytes, MPI_BYTE,
+                  rank_ + 1, kTagToNext, MPI_COMM_WORLD, &requests_.back());
+    }
+#endif
+}
+
+
+void DomainDecomposition::finish_halo_exchange() {
+#ifdef MUSIC_MPI
+    if (requests_.empty()) return;
+    MPI_Waitall(static_cast<int>(requests_.size()), requests_.data(),
+                MPI_STATUSES_IGNORE);
+    requests_.clear();
+#endif
+}
+
+
+double DomainDecomposition::get_global_max(const double value) const {
+    double global_max = value;
+#ifdef MUSIC_MPI
+    if (is_distributed()) {
+        MPI_Allreduce(&value, &global_max, 1, MPI_DOUBLE, MPI_MAX,
+                      MPI_COMM_WORLD);
+    }
+#endif
+    return(global_max);
+}
+
+
+void DomainDecomposition::all_gather(const std::vector<double> &local,
+                                     std::vector<double> &all) const {
+    all.resize(local.size()*nranks_);
+#ifdef MUSIC_MPI
+    if (is_distributed()) {
+        MPI_Allgather(local.data(), static_cast<int>(local.size()),
+                      MPI_DOUBLE, all.data(), static_cast<int>(local.size()),
+                      MPI_DOUBLE, MPI_COMM_WORLD);
+        return;
+    }
+#endif
+    std::copy(local.begin(), local.end(), all.begin());
+}
@@ -0,0 +1,87 @@
+#ifndef SRC_DOMAIN_DECOMPOSITION_H_
+#define SRC_DOMAIN_DECOMPOSITION_H_
+
+#include <vector>
+#include "data.h"
+#include "grid.h"
+
+#ifdef MUSIC_MPI
+    #include <mpi.h>
+#endif
+
+//! This class splits the eta layers of the grid into slabs, one per MPI
+//! rank. A rank evolves the eta layers of its slab, and keeps a copy of
+//! the kHaloWidth layers next to it on each neighbouring slab, which is
+//! exchanged after every Runge-Kutta stage. The local grid of a rank is
+//!
+//!     [halo of rank - 1][owned layers][halo of rank + 1]
+//!
+//! with no halo at the ends of the global grid. Without MUSIC_MPI there is
+//! a single rank owning the whole grid.
+class DomainDecomposition {
+ public:
+    //! the layers read by the KT stencil on each side of a cell
+    static const int kHaloWidth = 2;
+
+    //! splits the neta eta layers over the ranks of MPI_COMM_WORLD
+    explicit DomainDecomposition(const int neta);
+
+    //! the eta layers [eta_min, eta_max) of the slab of rank among nranks
+    static void get_slab(const int neta, const int nranks, const int rank,
+                         int &eta_min, int &eta_max);
+
+    bool is_distributed() const {return(nranks_ > 1);}
+    int get_rank() const {return(rank_);}
+    int get_number_of_ranks() const {return(nranks_);}
+
+    int get_global_neta() const {return(neta_global_);}
+    int get_local_neta() const {return(local_max_ - local_min_);}
+    //! the global eta index of the local eta layer 0
+    int get_eta_index_offset() const {return(local_min_);}
+
+    //! the owned eta layers [get_owned_eta_min(), get_owned_eta_max())
+    //! in local indices
+    int get_owned_eta_min() const {return(own_min_ - local_min_);}
+    int get_owned_eta_max() const {return(own_max_ - local_min_);}
+    //! the owned eta layers which are not sent to a neighbouring slab,
+    //! in local indices
+    int get_interior_eta_min() const;
+    int get_interior_eta_max() const;
+
+    //! this function exits with an error if an option of DATA is not
+    //! supported by the distributed evolution
+    void check_supported(const InitData &DATA) const;
+
+    //! the local grid of the rank copied from the global grid
+    SCGrid get_local_grid(const SCGrid &global) const;
+
+    //! this function starts sending the owned layers of arena next to the
+    //! neighbouring slabs and receiving their halo layers. arena must not
+    //! be read or written near the slab edges before the exchange is
+    //! finished.
+    void start_halo_exchange(SCGrid &arena);
+    void finish_halo_exchange();
+
+    //! the maximum of value over the ranks
+    double get_global_max(const double value) const;
+
+    //! gathers the local vectors of all the ranks in the order of the
+    //! ranks, all the local vectors have the same size
+    void all_gather(const std::vector<double> &local,
+                    std::vector<double> &all) const;
+
+ private:
+    int rank_ = 0;
+    int nranks_ = 1;
+    int neta_global_ = 0;
+    //! the owned layers [own_min_, own_max_) and the local grid
+    //! [local_min_, local_max_) in global indices
+    int own_min_ = 0, own_max_ = 0;
+    int local_min_ = 0, local_max_ = 0;
+
+#ifdef MUSIC_MPI
+    std::vector<MPI_Request> requests_;
+#endif
+};
+
+#endif  // SRC_DOMAIN_DECOMPOSITION_H_
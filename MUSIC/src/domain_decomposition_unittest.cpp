@@ -0,0 +1,46 @@
+#include "doctest.h"
+#include "domain_decomposition.h"
+#include "active_region.h"
+
+TEST_CASE("Check the eta slabs cover the grid") {
+    const int neta = 63;
+    for (int nranks = 1; nranks <= 8; nranks++) {
+        int eta_end = 0;
+        for (int rank = 0; rank < nranks; rank++) {
+            int eta_min, eta_max;
+            DomainDecomposition::get_slab(neta, nranks, rank,
+                                          eta_min, eta_max);
+            CHECK(eta_min == eta_end);
+            // the slabs differ by at most one layer
+            CHECK(eta_max - eta_min >= neta/nranks);
+            CHECK(eta_max - eta_min <= neta/nranks + 1);
+            eta_end = eta_max;
+        }
+        CHECK(eta_end == neta);
+    }
+}
+
+
+TEST_CASE("Check a single rank owns the whole grid") {
+    DomainDecomposition domain(9);
+    if (domain.is_distributed()) return;
+    CHECK(domain.get_eta_index_offset() == 0);
+    CHECK(domain.get_local_neta() == 9);
+    CHECK(domain.get_owned_eta_min() == 0);
+    CHECK(domain.get_owned_eta_max() == 9);
+    CHECK(domain.get_interior_eta_min() == 0);
+    CHECK(domain.get_interior_eta_max() == 9);
+
+    SCGrid global(3, 3, 9);
+    for (int i = 0; i < global.size(); i++) global(i).epsilon = i;
+    const SCGrid local = domain.get_local_grid(global);
+    CHECK(local.size() == global.size());
+    CHECK(local(2, 1, 8).epsilon == global(2, 1, 8).epsilon);
+
+    ActiveRegion region(3, 3, 9);
+    const ActiveRegion slab = region.get_eta_slab(2, 5);
+    CHECK(slab.get_number_of_cells() == 3*3*3);
+    CHECK(!slab.is_full_grid());
+    CHECK(!slab.is_active(0, 0, 5));
+    CHECK(region.get_eta_slab(5, 5).is_empty());
+}
@@ -32,6 +32,20 @@ class EOS {
     double get_s2e        (double s, double rhob) const {return(eos_ptr->get_s2e(s, rhob));}
     double get_T2e        (double T, double rhob) const {return(eos_ptr->get_T2e(T, rhob));}
 
+    //! all the EOS quantities at (e, rhob) at once
+    ThermoState get_thermo(double e, double rhob) const {return(eos_ptr->get_thermo(e, rhob));}
+    void get_thermo_batch(const double *e, const double *rhob, ThermoState *out, const int n) const {eos_ptr->get_thermo_batch(e, rhob, out, n);}
+    const EOSThermoTables *get_thermo_tables() const {return(eos_ptr->get_thermo_tables());}
+
+    //! batch versions, out[i] = f(e[i], rhob[i]) for i < n
+    void get_pressure_batch   (const double *e, const double *rhob, double *out, const int n) const {eos_ptr->get_pressure_batch(e, rhob, out, n);}
+    void get_temperature_batch(const double *e, const double *rhob, double *out, const int n) const {eos_ptr->get_temperature_batch(e, rhob, out, n);}
+    void get_entropy_batch    (const double *e, const double *rhob, double *out, const int n) const {eos_ptr->get_entropy_batch(e, rhob, out, n);}
+    void get_cs2_batch        (const double *e, const double *rhob, double *out, const int n) const {eos_ptr->get_cs2_batch(e, rhob, out, n);}
+    void get_dpde_batch       (const double *e, const double *rhob, double *out, const int n) const {eos_ptr->p_e_func_batch(e, rhob, out, n);}
+    void get_dpdrhob_batch    (const double *e, const double *rhob, double *out, const int n) const {eos_ptr->p_rho_func_batch(e, rhob, out, n);}
+    void get_muB_batch        (const double *e, const double *rhob, double *out, const int n) const {eos_ptr->get_muB_batch(e, rhob, out, n);}
+
     double get_eps_max() const {return(eos_ptr->get_eps_max());}
     void   check_eos()   const {return(eos_ptr->check_eos());}
 };
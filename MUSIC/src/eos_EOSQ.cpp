@@ -102,17 +102,19 @@ void EOS_eosQ::initialize_eos() {
     double eps_max_in = e_bounds[1] + e_spacing[1]*e_length[1];
     set_eps_max(eps_max_in);
 
+    build_derivative_tables();
+    build_inverse_tables();
     music_message.info("Done reading EOS.");
 }
 
 
 double EOS_eosQ::p_e_func(double e, double rhob) const {
-    return(get_dpOverde3(e, rhob));
+    return(interpolate_dpOverde(e, rhob));
 }
 
 
 double EOS_eosQ::p_rho_func(double e, double rhob) const {
-    return(get_dpOverdrhob2(e, rhob));
+    return(interpolate_dpOverdrhob(e, rhob));
 }
 
 
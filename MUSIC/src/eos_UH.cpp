@@ -101,17 +101,19 @@ void EOS_UH::initialize_eos() {
     double eps_max_in = e_bounds[5] + e_spacing[5]*e_length[5];
     set_eps_max(eps_max_in);
 
+    build_derivative_tables();
+    build_inverse_tables();
     music_message.info("Done reading EOS.");
 }
 
 
 double EOS_UH::p_e_func(double e, double rhob) const {
-    return(get_dpOverde3(e, rhob));
+    return(interpolate_dpOverde(e, rhob));
 }
 
 
 double EOS_UH::p_rho_func(double e, double rhob) const {
-    return(get_dpOverdrhob2(e, rhob));
+    return(interpolate_dpOverdrhob(e, rhob));
 }
 
 
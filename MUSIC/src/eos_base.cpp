@@ -2,6 +2,8 @@
 #include "eos_base.h"
 #include "util.h"
 
+#include <algorithm>
+#include <cmath>
 #include <string>
 #include <sstream>
 #include <iomanip>
@@ -18,17 +20,64 @@ using std::string;
 using Util::hbarc;
 using Util::small_eps;
 
+namespace {
+    //! the samples of e per rhob and the nodes of x of the inverse tables,
+    //! the rows of rhob are a quarter of the spacing of the EOS tables
+    const int inverse_n_e = 4096;
+    const int inverse_n_x = 2048;
+    const int inverse_rhob_refinement = 4;
+    const int inverse_max_n_rhob = 401;
+
+    //! Newton steps on quantity(e) = x_goal from the e of an inverse
+    //! table, the first with the dlog(e)/dlog(x) of the table, the next
+    //! ones with the secant through the last two steps, which also
+    //! converges next to a kink of the tables of the EOS
+    template <class Func>
+    double polish_inverse(Func &&quantity, const double x_goal, double e,
+                          const double dloge_dlogx, const int n_steps) {
+        if (n_steps <= 0) return(e);
+        double x = quantity(e);
+        double de_dx = dloge_dlogx*e/x;
+        for (int i = 0; i < n_steps; i++) {
+            const double e_next = e + (x_goal - x)*de_dx;
+            // a step off the table is a kink of the EOS, not a correction
+            if (!(e_next > 0.5*e && e_next < 2.*e)) break;
+            if (i + 1 < n_steps) {
+                const double x_next = quantity(e_next);
+                if (x_next == x) {
+                    e = e_next;
+                    break;
+                }
+                de_dx = (e_next - e)/(x_next - x);
+                x = x_next;
+            }
+            e = e_next;
+        }
+        return(e);
+    }
+}
+
 EOS_base::~EOS_base() {
     for (int itable = 0; itable < number_of_tables; itable++) {
-        Util::mtx_free(pressure_tb[itable],
-                       nb_length[itable], e_length[itable]);
-        Util::mtx_free(temperature_tb[itable],
-                       nb_length[itable], e_length[itable]);
+        free_table(pressure_tb[itable], nb_length[itable], e_length[itable]);
+        free_table(temperature_tb[itable],
+                   nb_length[itable], e_length[itable]);
     }
     if (number_of_tables > 0) {
         delete[] pressure_tb;
         delete[] temperature_tb;
     }
+    if (dpOverde_tb != nullptr) {
+        for (int itable = 0; itable < number_of_tables; itable++) {
+            Util::mtx_free(dpOverde_tb[itable],
+                           nb_length[itable], e_length[itable]);
+            Util::mtx_free(dpOverdrhob_tb[itable],
+                           nb_length[itable], e_length[itable]);
+        }
+        delete[] dpOverde_tb;
+        delete[] dpOverdrhob_tb;
+    }
+    unmap_table_cache();
 }
 
 
@@ -180,6 +229,152 @@ double EOS_base::get_dpOverdrhob2(double e, double rhob) const {
 }
 
 
+//! This function tabulates dP/de|rhob and dP/drhob|e on the nodes of the
+//! EOS tables, with the finite differences of get_dpOverde3 and
+//! get_dpOverdrhob2. Between the nodes the derivatives are then one
+//! interpolation instead of two pressure lookups, and they stay
+//! continuous across the seams between the tables.
+//! It is called once the pressure lookups of the EOS are set up.
+void EOS_base::build_derivative_tables() {
+    dpOverde_tb    = new double** [number_of_tables];
+    dpOverdrhob_tb = new double** [number_of_tables];
+    for (int itable = 0; itable < number_of_tables; itable++) {
+        const int N_nb = nb_length[itable];
+        const int N_e  = e_length[itable];
+        dpOverde_tb[itable]    = Util::mtx_malloc(N_nb, N_e);
+        dpOverdrhob_tb[itable] = Util::mtx_malloc(N_nb, N_e);
+        #pragma omp parallel for
+        for (int i = 0; i < N_nb; i++) {
+            const double rhob = (N_nb == 1 ? 0. : (nb_bounds[itable]
+                                                   + i*nb_spacing[itable]));
+            for (int j = 0; j < N_e; j++) {
+                const double e = e_bounds[itable] + j*e_spacing[itable];
+                dpOverde_tb[itable][i][j] = get_dpOverde3(e, rhob);
+                dpOverdrhob_tb[itable][i][j] = (
+                    N_nb == 1 ? 0. : get_dpOverdrhob2(e, rhob));
+            }
+        }
+    }
+}
+
+
+//! this function checks whether (e, rhob) is inside the derivative
+//! tables; outside them the derivatives fall back to finite differences
+//! of the extrapolated pressure
+bool EOS_base::is_in_derivative_tables(const double e,
+                                       const double rhob) const {
+    if (dpOverde_tb == nullptr) return(false);
+    const int last = number_of_tables - 1;
+    if (   e < e_bounds[0]
+        || e > e_bounds[last] + (e_length[last] - 1)*e_spacing[last]) {
+        return(false);
+    }
+    const int table_idx = get_table_idx(e);
+    if (nb_length[table_idx] == 1) return(true);
+    return(std::abs(rhob) <= (nb_bounds[table_idx]
+                              + (nb_length[table_idx] - 1)
+                                *nb_spacing[table_idx]));
+}
+
+
+//! This function returns dP/de|rhob from the derivative tables
+double EOS_base::interpolate_dpOverde(const double e,
+                                      const double rhob) const {
+    if (!is_in_derivative_tables(e, rhob)) return(get_dpOverde3(e, rhob));
+    const int table_idx = get_table_idx(e);
+    if (nb_length[table_idx] == 1) {
+        return(interpolate1D(e, table_idx, dpOverde_tb));
+    }
+    return(interpolate2D(e, std::abs(rhob), table_idx, dpOverde_tb));
+}
+
+
+//! This function returns dP/drhob|e [1/fm] from the derivative tables
+double EOS_base::interpolate_dpOverdrhob(const double e,
+                                         const double rhob) const {
+    if (!is_in_derivative_tables(e, rhob)) return(get_dpOverdrhob2(e, rhob));
+    const int table_idx = get_table_idx(e);
+    if (nb_length[table_idx] == 1) return(0.0);
+    const double sign = rhob/(std::abs(rhob) + small_eps);
+    return(sign*interpolate2D(e, std::abs(rhob), table_idx, dpOverdrhob_tb));
+}
+
+
+ThermoState EOS_base::get_thermo(double e, double rhob) const {
+    ThermoState thermo;
+    thermo.pressure    = get_pressure(e, rhob);
+    thermo.temperature = get_temperature(e, rhob);
+    thermo.cs2         = get_cs2(e, rhob);
+    thermo.muB         = get_muB(e, rhob);
+    thermo.muS         = get_muS(e, rhob);
+    thermo.muC         = get_muC(e, rhob);
+    thermo.dpde        = p_e_func(e, rhob);
+    thermo.dpdrhob     = p_rho_func(e, rhob);
+    thermo.entropy     = get_entropy_from(e, rhob, thermo);
+    return(thermo);
+}
+
+
+//! the same as get_entropy, with the quantities already computed
+double EOS_base::get_entropy_from(const double e, const double rhob,
+                                  const ThermoState &thermo) const {
+    const double rhoS = get_rhoS(e, rhob);
+    const double rhoC = get_rhoC(e, rhob);
+    const double f = (  e + thermo.pressure - thermo.muB*rhob
+                      - thermo.muS*rhoS - thermo.muC*rhoC)
+                     /(thermo.temperature + small_eps);
+    return(std::max(small_eps, f));
+}
+
+
+void EOS_base::get_thermo_batch(const double *e, const double *rhob,
+                                ThermoState *out, const int n) const {
+    for (int i = 0; i < n; i++) out[i] = get_thermo(e[i], rhob[i]);
+}
+
+
+void EOS_base::get_pressure_batch(const double *e, const double *rhob,
+                                  double *out, const int n) const {
+    for (int i = 0; i < n; i++) out[i] = get_pressure(e[i], rhob[i]);
+}
+
+
+void EOS_base::get_temperature_batch(const double *e, const double *rhob,
+                                     double *out, const int n) const {
+    for (int i = 0; i < n; i++) out[i] = get_temperature(e[i], rhob[i]);
+}
+
+
+void EOS_base::get_muB_batch(const double *e, const double *rhob,
+                             double *out, const int n) const {
+    for (int i = 0; i < n; i++) out[i] = get_muB(e[i], rhob[i]);
+}
+
+
+void EOS_base::get_cs2_batch(const double *e, const double *rhob,
+                             double *out, const int n) const {
+    for (int i = 0; i < n; i++) out[i] = get_cs2(e[i], rhob[i]);
+}
+
+
+void EOS_base::p_e_func_batch(const double *e, const double *rhob,
+                              double *out, const int n) const {
+    for (int i = 0; i < n; i++) out[i] = p_e_func(e[i], rhob[i]);
+}
+
+
+void EOS_base::p_rho_func_batch(const double *e, const double *rhob,
+                                double *out, const int n) const {
+    for (int i = 0; i < n; i++) out[i] = p_rho_func(e[i], rhob[i]);
+}
+
+
+void EOS_base::get_entropy_batch(const double *e, const double *rhob,
+                                 double *out, const int n) const {
+    for (int i = 0; i < n; i++) out[i] = get_entropy(e[i], rhob[i]);
+}
+
+
 int EOS_base::get_table_idx(double e) const {
     //double local_ed = e*hbarc;  // [GeV/fm^3]
     double local_ed = e;  // [1/fm^4]
@@ -192,10 +387,130 @@ int EOS_base::get_table_idx(double e) const {
 }
 
 
+bool EOSInverseTable::lookup(const double x, const double rhob,
+                             double &e, double &dloge_dlogx) const {
+    if (n_x == 0 || !(x > 0.) || rhob < 0.) return(false);
+    const double fx = (log(x) - log_x_min)/dlog_x;
+    if (!(fx >= 0.) || fx > n_x - 1) return(false);
+    const int ix = std::min(static_cast<int>(fx), n_x - 2);
+    const double frac_x = fx - ix;
+
+    // an EOS at zero rhob has one row for all rhob
+    int irhob = 0;
+    double frac_rhob = 0.;
+    if (n_rhob > 1) {
+        const double frhob = rhob/drhob;
+        if (frhob > n_rhob - 1) return(false);
+        irhob = std::min(static_cast<int>(frhob), n_rhob - 2);
+        frac_rhob = frhob - irhob;
+    }
+    const int next_irhob = (n_rhob > 1 ? irhob + 1 : irhob);
+    if (   ix < std::max(ix_begin[irhob], ix_begin[next_irhob])
+        || ix + 1 >= std::min(ix_end[irhob], ix_end[next_irhob])) {
+        return(false);
+    }
+    const double *row = &log_e[irhob*n_x + ix];
+    const double *next_row = &log_e[next_irhob*n_x + ix];
+    const double log_e_0 = row[0]*(1. - frac_x) + row[1]*frac_x;
+    const double log_e_1 = next_row[0]*(1. - frac_x) + next_row[1]*frac_x;
+    e = exp(log_e_0*(1. - frac_rhob) + log_e_1*frac_rhob);
+    dloge_dlogx = ((row[1] - row[0])*(1. - frac_rhob)
+                   + (next_row[1] - next_row[0])*frac_rhob)/dlog_x;
+    return(true);
+}
+
+
+//! This function fills table with the inverse of quantity(e, rhob). The
+//! quantity is sampled on a log grid of e from six decades below the EOS
+//! tables to eps_max, on every row of rhob, and inverted by a linear
+//! interpolation of log(e) in log(x) on every node of x. A quantity which
+//! does not grow with e is made monotone by its running maximum, which
+//! gives the smallest e of a value, as the binary search does.
+template <class Func>
+void EOS_base::build_inverse_table(EOSInverseTable &table,
+                                   Func &&quantity) const {
+    const int last = number_of_tables - 1;
+    const double rhob_max = (nb_length[last] > 1
+            ? nb_bounds[last] + (nb_length[last] - 1)*nb_spacing[last] : 0.);
+    table.n_rhob = (rhob_max > 0.
+                    ? std::min(inverse_rhob_refinement*(nb_length[last] - 1)
+                               + 1, inverse_max_n_rhob)
+                    : 1);
+    table.drhob  = (table.n_rhob > 1 ? rhob_max/(table.n_rhob - 1) : 0.);
+
+    const double e_low = (e_bounds[0] > 0. ? e_bounds[0] : e_spacing[0]);
+    const double log_e_min = log(1e-6*e_low);
+    const double dlog_e = (log(eps_max) - log_e_min)/(inverse_n_e - 1);
+    std::vector<double> log_x(table.n_rhob*inverse_n_e);
+    #pragma omp parallel for
+    for (int irhob = 0; irhob < table.n_rhob; irhob++) {
+        // the values below x(small_eps) are left to the binary search,
+        // which gives small_eps for them
+        const double rhob = irhob*table.drhob;
+        double *row = &log_x[irhob*inverse_n_e];
+        double running_max = log(std::max(quantity(small_eps, rhob),
+                                          small_eps));
+        for (int k = 0; k < inverse_n_e; k++) {
+            const double x = quantity(exp(log_e_min + k*dlog_e), rhob);
+            running_max = std::max(running_max, log(std::max(x, small_eps)));
+            row[k] = running_max;
+        }
+    }
+
+    double log_x_min = log_x[0];
+    double log_x_max = log_x[inverse_n_e - 1];
+    for (int irhob = 1; irhob < table.n_rhob; irhob++) {
+        log_x_min = std::min(log_x_min, log_x[irhob*inverse_n_e]);
+        log_x_max = std::max(log_x_max,
+                             log_x[(irhob + 1)*inverse_n_e - 1]);
+    }
+    table.n_x = inverse_n_x;
+    table.log_x_min = log_x_min;
+    table.dlog_x = (log_x_max - log_x_min)/(inverse_n_x - 1);
+    table.log_e.assign(table.n_rhob*inverse_n_x, 0.);
+    table.ix_begin.assign(table.n_rhob, inverse_n_x);
+    table.ix_end.assign(table.n_rhob, 0);
+    #pragma omp parallel for
+    for (int irhob = 0; irhob < table.n_rhob; irhob++) {
+        const double *row = &log_x[irhob*inverse_n_e];
+        double *log_e = &table.log_e[irhob*inverse_n_x];
+        int k = 0;
+        for (int j = 0; j < inverse_n_x; j++) {
+            const double target = log_x_min + j*table.dlog_x;
+            if (target < row[0] || target > row[inverse_n_e - 1]) continue;
+            table.ix_begin[irhob] = std::min(table.ix_begin[irhob], j);
+            table.ix_end[irhob] = j + 1;
+            // a value on a plateau of x maps to the end of the plateau
+            while (k < inverse_n_e - 2 && row[k + 1] <= target) k++;
+            const double width = row[k + 1] - row[k];
+            const double frac = (width > 0. ? (target - row[k])/width : 0.);
+            log_e[j] = log_e_min + (k + frac)*dlog_e;
+        }
+    }
+}
+
+
+void EOS_base::build_inverse_tables() {
+    build_inverse_table(s2e_table, [this](double e, double rhob) {
+        return(get_entropy(e, rhob));
+    });
+    build_inverse_table(T2e_table, [this](double e, double rhob) {
+        return(get_temperature(e, rhob));
+    });
+}
+
+
 //! This function returns local energy density [1/fm^4] from
-//! a given temperature T [GeV] and rhob [1/fm^3] using binary search
+//! a given temperature T [GeV] and rhob [1/fm^3] using the inverse
+//! table, or binary search outside of it
 double EOS_base::get_T2e_finite_rhob(const double T, const double rhob) const {
     double T_goal = T/Util::hbarc;         // convert to 1/fm
+    double e_table, dloge_dlogT;
+    if (T2e_table.lookup(T_goal, rhob, e_table, dloge_dlogT)) {
+        return(polish_inverse(
+                [this, rhob](double e) {return(get_temperature(e, rhob));},
+                T_goal, e_table, dloge_dlogT, inverse_newton_steps));
+    }
     double eps_lower = small_eps;
     double eps_upper = eps_max;
     double eps_mid   = (eps_upper + eps_lower)/2.;
@@ -240,8 +555,14 @@ double EOS_base::get_T2e_finite_rhob(const double T, const double rhob) const {
 
 //! This function returns local energy density [1/fm^4] from
 //! a given entropy density [1/fm^3] and rhob [1/fm^3]
-//! using binary search
+//! using the inverse table, or binary search outside of it
 double EOS_base::get_s2e_finite_rhob(double s, double rhob) const {
+    double e_table, dloge_dlogs;
+    if (s2e_table.lookup(s, rhob, e_table, dloge_dlogs)) {
+        return(polish_inverse(
+                [this, rhob](double e) {return(get_entropy(e, rhob));},
+                s, e_table, dloge_dlogs, inverse_newton_steps));
+    }
     double eps_lower = small_eps;
     double eps_upper = eps_max;
     double eps_mid   = (eps_upper + eps_lower)/2.;
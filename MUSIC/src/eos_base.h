@@ -5,9 +5,47 @@
 
 #include "pretty_ostream.h"
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
+struct EOSThermoTables;
+
+//! all the EOS quantities of a fluid cell, see EOS_base::get_thermo
+struct ThermoState {
+    double pressure;       //!< [1/fm^4]
+    double temperature;    //!< [1/fm]
+    double cs2;
+    double muB;            //!< [1/fm]
+    double muS;            //!< [1/fm]
+    double muC;            //!< [1/fm]
+    double entropy;        //!< [1/fm^3]
+    double dpde;
+    double dpdrhob;        //!< [1/fm]
+};
+
+//! the inverse e(x, rhob) of a quantity x(e, rhob) of the EOS which grows
+//! with e, e.g. the entropy density or the temperature: log(e) on a grid
+//! of log(x) and rhob >= 0, see EOS_base::build_inverse_tables
+struct EOSInverseTable {
+    int n_x    = 0;
+    int n_rhob = 0;
+    double log_x_min = 0.;
+    double dlog_x    = 0.;
+    double drhob     = 0.;
+    //! log(e) at [irhob*n_x + ix], set for the nodes
+    //! ix_begin[irhob] <= ix < ix_end[irhob] in the range of x(e, rhob)
+    std::vector<double> log_e;
+    std::vector<int> ix_begin;
+    std::vector<int> ix_end;
+
+    //! interpolates e and dlog(e)/dlog(x) at (x, rhob), false if the
+    //! point is outside the table
+    bool lookup(const double x, const double rhob,
+                double &e, double &dloge_dlogx) const;
+};
+
+
 class EOS_base {
  private:
     int whichEOS;
@@ -17,6 +55,21 @@ class EOS_base {
     bool flag_muS;
     bool flag_muC;
 
+    // the binary table cache mapped by load_table_cache
+    void *mapped_tables = nullptr;
+    std::size_t mapped_size = 0;
+
+    uint64_t get_table_cache_signature(
+                const std::vector<std::string> &source_files) const;
+
+    //! e(s, rhob) and e(T, rhob), see build_inverse_tables
+    EOSInverseTable s2e_table;
+    EOSInverseTable T2e_table;
+    int inverse_newton_steps = 1;
+
+    template <class Func>
+    void build_inverse_table(EOSInverseTable &table, Func &&quantity) const;
+
  public:
     pretty_ostream music_message;
     std::vector<double> nb_bounds;
@@ -34,6 +87,10 @@ class EOS_base {
     double ***mu_S_tb;
     double ***mu_C_tb;
 
+    //! dP/de|rhob and dP/drhob|e on the nodes of the tables
+    double ***dpOverde_tb    = nullptr;
+    double ***dpOverdrhob_tb = nullptr;
+
     EOS_base() = default;
     virtual ~EOS_base();
 
@@ -58,16 +115,47 @@ class EOS_base {
     void   set_eps_max(double eps_max_in) {eps_max = eps_max_in;}
     double get_eps_max() const {return(eps_max);}
 
+    //! binary cache of the tables of an EOS. The tables are given as the
+    //! addresses of the table members, e.g. {&pressure_tb, &temperature_tb}.
+    //! The cache is stale once one of the ASCII source files changes.
+    bool load_table_cache(const std::string &cache_file,
+                          const std::vector<std::string> &source_files,
+                          const std::vector<double****> &tables);
+    void write_table_cache(const std::string &cache_file,
+                           const std::vector<std::string> &source_files,
+                           const std::vector<double****> &tables);
+    bool is_table_cache_mapped() const {return(mapped_tables != nullptr);}
+    void free_table(double **table, const int n1, const int n2);
+    void unmap_table_cache();
+
     double interpolate1D(double e, int table_idx, double ***table) const;
     double interpolate2D(const double e, const double rhob,
                          const int table_idx, double ***table) const;
 
     int    get_table_idx(double e) const;
+    double get_entropy_from(const double e, const double rhob,
+                            const ThermoState &thermo) const;
     double get_entropy  (double epsilon, double rhob) const;
 
     double calculate_velocity_of_sound_sq(double e, double rhob) const;
     double get_dpOverde3(double e, double rhob) const;
     double get_dpOverdrhob2(double e, double rhob) const;
+
+    //! derivative tables of the tabulated EOSs, see build_derivative_tables
+    void   build_derivative_tables();
+    bool   is_in_derivative_tables(const double e, const double rhob) const;
+    double interpolate_dpOverde   (const double e, const double rhob) const;
+    double interpolate_dpOverdrhob(const double e, const double rhob) const;
+
+    //! tabulates the inverses of s(e, rhob) and T(e, rhob) for
+    //! get_s2e_finite_rhob and get_T2e_finite_rhob, which then cost one
+    //! interpolation and inverse_newton_steps Newton steps instead of a
+    //! binary search. The binary search remains outside the tables.
+    //! It is called once the EOS is set up.
+    void build_inverse_tables();
+    bool has_inverse_tables() const {return(s2e_table.n_x > 0);}
+    //! Newton steps polishing the e of the inverse tables (0: none)
+    void set_inverse_newton_steps(const int n) {inverse_newton_steps = n;}
     double get_s2e_finite_rhob(double s, double rhob) const;
     double get_T2e_finite_rhob(const double T, const double rhob) const;
     void map_TmuB2erhoB(const double T, const double muB,
@@ -89,6 +177,36 @@ class EOS_base {
     virtual double get_T2e        (double T, double rhob) const {return(0.0);}
     virtual void   check_eos      () const {}
 
+    //! returns all the quantities of ThermoState at (e, rhob) in one call.
+    //! The default evaluates every quantity once; the tabulated EOSs
+    //! override it to share the table lookup between the quantities.
+    virtual ThermoState get_thermo(double e, double rhob) const;
+    virtual void get_thermo_batch(const double *e, const double *rhob,
+                                  ThermoState *out, const int n) const;
+    //! the flattened tables behind get_thermo, or nullptr if get_thermo
+    //! does not only read flattened tables
+    virtual const EOSThermoTables *get_thermo_tables() const {
+        return(nullptr);
+    }
+
+    //! batch versions of the functions above, out[i] = f(e[i], rhob[i])
+    //! for i < n. The default loops over the scalar functions; the
+    //! tabulated and analytic EOSs override them with vectorized loops.
+    virtual void get_pressure_batch   (const double *e, const double *rhob,
+                                       double *out, const int n) const;
+    virtual void get_temperature_batch(const double *e, const double *rhob,
+                                       double *out, const int n) const;
+    virtual void get_muB_batch        (const double *e, const double *rhob,
+                                       double *out, const int n) const;
+    virtual void get_cs2_batch        (const double *e, const double *rhob,
+                                       double *out, const int n) const;
+    virtual void p_e_func_batch       (const double *e, const double *rhob,
+                                       double *out, const int n) const;
+    virtual void p_rho_func_batch     (const double *e, const double *rhob,
+                                       double *out, const int n) const;
+    virtual void get_entropy_batch    (const double *e, const double *rhob,
+                                       double *out, const int n) const;
+
     void check_eos_with_finite_muB() const;
     void check_eos_no_muB() const;
     void outputMutable() const;
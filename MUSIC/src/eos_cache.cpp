@@ -0,0 +1,250 @@
+// binary cache of the EOS tables, see EOS_base::load_table_cache
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "eos_base.h"
+#include "util.h"
+
+namespace {
+    const char cache_magic[8] = {'M', 'U', 'S', 'I', 'C', 'E', 'O', 'S'};
+    const uint32_t cache_version = 1;
+
+    //! start of the tables in the file, keeps them 64-byte aligned
+    const std::size_t data_alignment = 64;
+
+    struct CacheHeader {
+        char     magic[8];
+        uint32_t version;
+        uint32_t number_of_tables;
+        uint32_t number_of_fields;
+        uint32_t reserved;
+        uint64_t signature;
+        double   eps_max;
+    };
+
+    struct CacheTableInfo {
+        double  e_bound, e_spacing;
+        double  nb_bound, nb_spacing;
+        int32_t e_length, nb_length;
+    };
+
+    std::size_t get_data_offset(const int ntables) {
+        const std::size_t head = (sizeof(CacheHeader)
+                                  + ntables*sizeof(CacheTableInfo));
+        return((head + data_alignment - 1)/data_alignment*data_alignment);
+    }
+
+    //! FNV-1a hash
+    void hash_bytes(uint64_t &hash, const void *data, const std::size_t n) {
+        const unsigned char *bytes = static_cast<const unsigned char*>(data);
+        for (std::size_t i = 0; i < n; i++) {
+            hash ^= bytes[i];
+            hash *= 1099511628211ULL;
+        }
+    }
+}
+
+
+//! this function returns the signature of the source files of a table
+//! cache from their names, sizes, and modification times.
+//! It returns 0 if one of the files is missing.
+uint64_t EOS_base::get_table_cache_signature(
+            const std::vector<std::string> &source_files) const {
+    uint64_t hash = 14695981039346656037ULL;
+    hash_bytes(hash, &cache_version, sizeof(cache_version));
+    for (const auto &filename : source_files) {
+        struct stat file_stat;
+        if (stat(filename.c_str(), &file_stat) != 0) return(0);
+        const int64_t file_size  = static_cast<int64_t>(file_stat.st_size);
+        const int64_t file_mtime = static_cast<int64_t>(file_stat.st_mtime);
+        hash_bytes(hash, filename.data(), filename.size());
+        hash_bytes(hash, &file_size, sizeof(file_size));
+        hash_bytes(hash, &file_mtime, sizeof(file_mtime));
+    }
+    return(hash == 0 ? 1 : hash);
+}
+
+
+//! This function maps the binary table cache cache_file into memory and
+//! points the tables and the table info at it. The rows of the tables
+//! are read-only views of the mapped file, so concurrent runs on one node
+//! share them through the page cache. It returns false, and changes
+//! nothing, if the cache is missing or was written from other source
+//! files, in which case the tables are read from the ASCII files.
+bool EOS_base::load_table_cache(const std::string &cache_file,
+                                const std::vector<std::string> &source_files,
+                                const std::vector<double****> &tables) {
+    const uint64_t signature = get_table_cache_signature(source_files);
+    if (signature == 0) return(false);
+
+    const int fd = open(cache_file.c_str(), O_RDONLY);
+    if (fd < 0) return(false);
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0
+            || file_stat.st_size < static_cast<off_t>(sizeof(CacheHeader))) {
+        close(fd);
+        return(false);
+    }
+    const std::size_t file_size = static_cast<std::size_t>(file_stat.st_size);
+    void *mapped = mmap(nullptr, file_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) return(false);
+
+    const char *base = static_cast<const char*>(mapped);
+    CacheHeader header;
+    std::memcpy(&header, base, sizeof(CacheHeader));
+    const int ntables = get_number_of_tables();
+    bool valid = (   std::memcmp(header.magic, cache_magic, 8) == 0
+                  && header.version == cache_version
+                  && header.signature == signature
+                  && static_cast<int>(header.number_of_tables) == ntables
+                  && header.number_of_fields == tables.size());
+
+    std::vector<CacheTableInfo> info(ntables);
+    std::size_t data_size = 0;
+    if (valid && file_size >= get_data_offset(ntables)) {
+        std::memcpy(info.data(), base + sizeof(CacheHeader),
+                    ntables*sizeof(CacheTableInfo));
+        for (const auto &info_i : info) {
+            data_size += (static_cast<std::size_t>(info_i.nb_length)
+                          *info_i.e_length*sizeof(double));
+        }
+        valid = (file_size == get_data_offset(ntables)
+                              + tables.size()*data_size);
+    } else {
+        valid = false;
+    }
+    if (!valid) {
+        munmap(mapped, file_size);
+        return(false);
+    }
+
+    set_eps_max(header.eps_max);
+    for (int itable = 0; itable < ntables; itable++) {
+        e_bounds[itable]   = info[itable].e_bound;
+        e_spacing[itable]  = info[itable].e_spacing;
+        nb_bounds[itable]  = info[itable].nb_bound;
+        nb_spacing[itable] = info[itable].nb_spacing;
+        e_length[itable]   = info[itable].e_length;
+        nb_length[itable]  = info[itable].nb_length;
+    }
+
+    double *data = reinterpret_cast<double*>(
+                    const_cast<char*>(base) + get_data_offset(ntables));
+    for (auto table : tables) {
+        *table = new double** [ntables];
+        for (int itable = 0; itable < ntables; itable++) {
+            (*table)[itable] = new double* [nb_length[itable]];
+            for (int i = 0; i < nb_length[itable]; i++) {
+                (*table)[itable][i] = data;
+                data += e_length[itable];
+            }
+        }
+    }
+    mapped_tables = mapped;
+    mapped_size   = file_size;
+
+    music_message << "mapped EOS tables from " << cache_file;
+    music_message.flush("info");
+    return(true);
+}
+
+
+//! This function writes the tables to the binary cache cache_file.
+//! The file is written under a temporary name and renamed, so concurrent
+//! runs never see a partial cache. Failing to write is not an error.
+void EOS_base::write_table_cache(const std::string &cache_file,
+                                 const std::vector<std::string> &source_files,
+                                 const std::vector<double****> &tables) {
+    const uint64_t signature = get_table_cache_signature(source_files);
+    if (signature == 0) return;
+
+    std::ostringstream tmp_name;
+    tmp_name << cache_file << ".tmp." << getpid();
+    FILE *out_file = fopen(tmp_name.str().c_str(), "wb");
+    if (out_file == NULL) {
+        music_message << "can not write the EOS cache " << cache_file;
+        music_message.flush("warning");
+        return;
+    }
+
+    const int ntables = get_number_of_tables();
+    CacheHeader header;
+    std::memset(&header, 0, sizeof(CacheHeader));
+    std::memcpy(header.magic, cache_magic, 8);
+    header.version          = cache_version;
+    header.number_of_tables = ntables;
+    header.number_of_fields = tables.size();
+    header.signature        = signature;
+    header.eps_max          = get_eps_max();
+    bool success = (fwrite(&header, sizeof(CacheHeader), 1, out_file) == 1);
+
+    for (int itable = 0; itable < ntables; itable++) {
+        CacheTableInfo info;
+        std::memset(&info, 0, sizeof(CacheTableInfo));
+        info.e_bound    = e_bounds[itable];
+        info.e_spacing  = e_spacing[itable];
+        info.nb_bound   = nb_bounds[itable];
+        info.nb_spacing = nb_spacing[itable];
+        info.e_length   = e_length[itable];
+        info.nb_length  = nb_length[itable];
+        success = success && (fwrite(&info, sizeof(CacheTableInfo), 1,
+                                     out_file) == 1);
+    }
+    const std::size_t padding = (get_data_offset(ntables) - sizeof(CacheHeader)
+                                 - ntables*sizeof(CacheTableInfo));
+    const std::vector<char> zeros(padding, 0);
+    success = success && (fwrite(zeros.data(), 1, padding, out_file)
+                          == padding);
+
+    for (auto table : tables) {
+        for (int itable = 0; itable < ntables; itable++) {
+            for (int i = 0; i < nb_length[itable]; i++) {
+                const std::size_t n = e_length[itable];
+                success = success && (fwrite((*table)[itable][i],
+                                             sizeof(double), n, out_file)
+                                      == n);
+            }
+        }
+    }
+    success = (fclose(out_file) == 0) && success;
+
+    if (!success || rename(tmp_name.str().c_str(), cache_file.c_str()) != 0) {
+        remove(tmp_name.str().c_str());
+        music_message << "can not write the EOS cache " << cache_file;
+        music_message.flush("warning");
+        return;
+    }
+    music_message << "wrote EOS cache " << cache_file;
+    music_message.flush("info");
+}
+
+
+//! this function frees one table allocated with Util::mtx_malloc, or only
+//! its row pointers if the rows are in the mapped cache
+void EOS_base::free_table(double **table, const int n1, const int n2) {
+    if (mapped_tables != nullptr) {
+        delete[] table;
+    } else {
+        Util::mtx_free(table, n1, n2);
+    }
+}
+
+
+void EOS_base::unmap_table_cache() {
+    if (mapped_tables != nullptr) {
+        munmap(mapped_tables, mapped_size);
+        mapped_tables = nullptr;
+        mapped_size   = 0;
+    }
+}
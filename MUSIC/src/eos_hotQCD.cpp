@@ -3,6 +3,7 @@
 #include "eos_hotQCD.h"
 #include "util.h"
 
+#include <algorithm>
 #include <sstream>
 #include <fstream>
 #include <cmath>
@@ -81,12 +82,15 @@ void EOS_hotQCD::initialize_eos() {
             temperature_tb[itable][0][ii] = pow(temp, 5);
         }
     }
+
+    build_derivative_tables();
+    build_inverse_tables();
     music_message.info("Done reading EOS.");
 }
 
 
 double EOS_hotQCD::p_e_func(double e, double rhob) const {
-    return(get_dpOverde3(e, rhob));
+    return(interpolate_dpOverde(e, rhob));
 }
 
 
@@ -107,6 +111,43 @@ double EOS_hotQCD::get_pressure(double e, double rhob) const {
 }
 
 
+//! this function interpolates P and T from the same index in e,
+//! as interpolate1D
+ThermoState EOS_hotQCD::get_thermo(double e, double rhob) const {
+    const double e0      = e_bounds[0];
+    const double delta_e = e_spacing[0];
+    const int N_e        = e_length[0];
+    const int idx_e = std::min(N_e - 2, static_cast<int>((e - e0)/delta_e));
+
+    double f, T5;
+    if (e < e0) {
+        f  = pressure_tb[0][0][0]*e/e0;
+        T5 = temperature_tb[0][0][0]*e/e0;
+    } else {
+        const double frac_e = (e - (idx_e*delta_e + e0))/delta_e;
+        f  = (  pressure_tb[0][0][idx_e]*(1. - frac_e)
+              + pressure_tb[0][0][idx_e + 1]*frac_e);
+        T5 = (  temperature_tb[0][0][idx_e]*(1. - frac_e)
+              + temperature_tb[0][0][idx_e + 1]*frac_e);
+    }
+
+    ThermoState thermo;
+    thermo.pressure    = std::max(Util::small_eps, f);
+    thermo.temperature = std::max(Util::small_eps, pow(T5, 0.2));
+    thermo.muB         = 0.;
+    thermo.muS         = 0.;
+    thermo.muC         = 0.;
+    thermo.dpde        = interpolate_dpOverde(e, rhob);
+    thermo.dpdrhob     = 0.;
+    const double v_sound = (thermo.dpde + rhob/(e + thermo.pressure
+                                                + Util::small_eps)
+                                          *thermo.dpdrhob);
+    thermo.cs2 = std::max(0.01, std::min(1./3, v_sound));
+    thermo.entropy = get_entropy_from(e, rhob, thermo);
+    return(thermo);
+}
+
+
 double EOS_hotQCD::get_s2e(double s, double rhob) const {
     double e = get_s2e_finite_rhob(s, 0.0);
     return(e);
@@ -19,6 +19,8 @@ class EOS_hotQCD : public EOS_base {
     double get_s2e        (double s, double rhob) const;
     double get_T2e        (double T, double rhob) const;
 
+    ThermoState get_thermo(double e, double rhob) const;
+
     void check_eos() const {check_eos_no_muB();}
 };
 
@@ -1,7 +1,9 @@
 // Copyright 2018 @ Chun Shen
 #include "eos_idealgas.h"
 
+#include <algorithm>
 #include <cmath>
+#include "util.h"
 
 EOS_idealgas::EOS_idealgas() {
     set_EOS_id(0);
@@ -35,3 +37,72 @@ double EOS_idealgas::get_muB(double e, double rhob) const {
 double EOS_idealgas::get_T2e(double T, double rhob) const {
     return 3*T*T*T*T*M_PI*M_PI/90*(2*(Nc*Nc-1)+7./2*Nc*Nf);
 }
+
+ThermoState EOS_idealgas::get_thermo(double e, double rhob) const {
+    ThermoState thermo;
+    thermo.pressure    = 1./3.*e;
+    thermo.temperature = EOS_idealgas::get_temperature(e, rhob);
+    thermo.cs2         = 1./3.;
+    thermo.muB         = 5.*rhob/(thermo.temperature*thermo.temperature);
+    thermo.muS         = 0.;
+    thermo.muC         = 0.;
+    thermo.dpde        = 1./3.;
+    thermo.dpdrhob     = 0.;
+    thermo.entropy     = get_entropy_from(e, rhob, thermo);
+    return(thermo);
+}
+
+void EOS_idealgas::get_thermo_batch(const double *e, const double *rhob,
+                                    ThermoState *out, const int n) const {
+    for (int i = 0; i < n; i++) out[i] = EOS_idealgas::get_thermo(e[i], rhob[i]);
+}
+
+void EOS_idealgas::get_pressure_batch(const double *e, const double *rhob,
+                                      double *out, const int n) const {
+    #pragma omp simd
+    for (int i = 0; i < n; i++) out[i] = 1./3.*e[i];
+}
+
+void EOS_idealgas::get_temperature_batch(const double *e, const double *rhob,
+                                         double *out, const int n) const {
+    const double g = 2*(Nc*Nc-1)+7./2*Nc*Nf;
+    #pragma omp simd
+    for (int i = 0; i < n; i++) {
+        out[i] = pow(90.0/M_PI/M_PI*(e[i]/3.0)/g, .25);
+    }
+}
+
+void EOS_idealgas::get_muB_batch(const double *e, const double *rhob,
+                                 double *out, const int n) const {
+    get_temperature_batch(e, rhob, out, n);
+    #pragma omp simd
+    for (int i = 0; i < n; i++) out[i] = 5.*rhob[i]/(out[i]*out[i]);
+}
+
+void EOS_idealgas::get_cs2_batch(const double *e, const double *rhob,
+                                 double *out, const int n) const {
+    std::fill(out, out + n, 1./3.);
+}
+
+void EOS_idealgas::p_e_func_batch(const double *e, const double *rhob,
+                                  double *out, const int n) const {
+    std::fill(out, out + n, 1./3.);
+}
+
+void EOS_idealgas::p_rho_func_batch(const double *e, const double *rhob,
+                                    double *out, const int n) const {
+    std::fill(out, out + n, 0.0);
+}
+
+//! s = (e + P - mu_B rho_B - mu_C rho_C)/T, with mu_C = 0
+void EOS_idealgas::get_entropy_batch(const double *e, const double *rhob,
+                                     double *out, const int n) const {
+    const double g = 2*(Nc*Nc-1)+7./2*Nc*Nf;
+    #pragma omp simd
+    for (int i = 0; i < n; i++) {
+        const double T   = pow(90.0/M_PI/M_PI*(e[i]/3.0)/g, .25);
+        const double muB = 5.*rhob[i]/(T*T);
+        const double f   = (e[i] + 1./3.*e[i] - muB*rhob[i])/(T + Util::small_eps);
+        out[i] = std::max(Util::small_eps, f);
+    }
+}
@@ -27,6 +27,25 @@ class EOS_idealgas : public EOS_base {
     double get_s2e        (double s, double rhob) const;
     double get_T2e        (double s, double rhob) const;
 
+    ThermoState get_thermo(double e, double rhob) const;
+    void get_thermo_batch(const double *e, const double *rhob,
+                          ThermoState *out, const int n) const;
+
+    void get_pressure_batch   (const double *e, const double *rhob,
+                               double *out, const int n) const;
+    void get_temperature_batch(const double *e, const double *rhob,
+                               double *out, const int n) const;
+    void get_muB_batch        (const double *e, const double *rhob,
+                               double *out, const int n) const;
+    void get_cs2_batch        (const double *e, const double *rhob,
+                               double *out, const int n) const;
+    void p_e_func_batch       (const double *e, const double *rhob,
+                               double *out, const int n) const;
+    void p_rho_func_batch     (const double *e, const double *rhob,
+                               double *out, const int n) const;
+    void get_entropy_batch    (const double *e, const double *rhob,
+                               double *out, const int n) const;
+
     void check_eos() const {check_eos_no_muB();}
 };
 
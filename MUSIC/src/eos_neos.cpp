@@ -3,9 +3,11 @@
 #include "eos_neos.h"
 #include "util.h"
 
+#include <algorithm>
 #include <sstream>
 #include <fstream>
 #include <cmath>
+#include <vector>
 
 using std::stringstream;
 using std::string;
@@ -23,15 +25,14 @@ EOS_neos::EOS_neos(const int eos_id_in) : eos_id(eos_id_in) {
 EOS_neos::~EOS_neos() {
     int ntables = get_number_of_tables();
     for (int itable = 0; itable < ntables; itable++) {
-        Util::mtx_free(mu_B_tb[itable],
-                       nb_length[itable], e_length[itable]);
+        free_table(mu_B_tb[itable], nb_length[itable], e_length[itable]);
         if (get_flag_muS()) {
-            Util::mtx_free(mu_S_tb[itable],
-                           nb_length[itable], e_length[itable]);
+            free_table(mu_S_tb[itable],
+                       nb_length[itable], e_length[itable]);
         }
         if (get_flag_muC()) {
-            Util::mtx_free(mu_C_tb[itable],
-                           nb_length[itable], e_length[itable]);
+            free_table(mu_C_tb[itable],
+                       nb_length[itable], e_length[itable]);
         }
     }
     if (ntables > 0) {
@@ -103,6 +104,82 @@ void EOS_neos::initialize_eos() {
     set_number_of_tables(ntables);
     resize_table_info_arrays();
 
+    std::vector<string> source_files;
+    for (int itable = 0; itable < ntables; itable++) {
+        string suffix[] = {"_p.dat", "_t.dat", "_mub.dat"};
+        for (const auto &suffix_i : suffix) {
+            source_files.push_back(path + "neos" + eos_file_string_array[itable]
+                                   + suffix_i);
+        }
+        if (flag_muS) {
+            source_files.push_back(path + "neos" + eos_file_string_array[itable]
+                                   + "_mus.dat");
+        }
+        if (flag_muC) {
+            source_files.push_back(path + "neos" + eos_file_string_array[itable]
+                                   + "_muq.dat");
+        }
+    }
+    std::vector<double****> tables = {&pressure_tb, &temperature_tb, &mu_B_tb};
+    if (flag_muS) tables.push_back(&mu_S_tb);
+    if (flag_muC) tables.push_back(&mu_C_tb);
+
+    const string cache_file = path + "music_eos_cache.bin";
+    if (!load_table_cache(cache_file, source_files, tables)) {
+        read_eos_tables(path, eos_file_string_array);
+        write_table_cache(cache_file, source_files, tables);
+    }
+
+    //double eps_max_in = (e_bounds[6] + e_spacing[6]*e_length[6])/hbarc;
+    double eps_max_in = e_bounds[6] + e_spacing[6]*e_length[6];
+    set_eps_max(eps_max_in);
+
+    pressure_flat.build(*this, pressure_tb);
+    temperature_flat.build(*this, temperature_tb);
+    mu_B_flat.build(*this, mu_B_tb);
+    if (flag_muS) mu_S_flat.build(*this, mu_S_tb);
+    if (flag_muC) mu_C_flat.build(*this, mu_C_tb);
+
+    build_derivative_tables();
+    dpOverde_flat.build(*this, dpOverde_tb);
+    dpOverdrhob_flat.build(*this, dpOverdrhob_tb);
+    set_thermo_tables();
+    build_inverse_tables();
+
+    music_message.info("Done reading EOS.");
+}
+
+
+//! the flattened tables are not moved after initialize_eos, so the
+//! views stay valid
+void EOS_neos::set_thermo_tables() {
+    thermo_tables.pressure    = pressure_flat;
+    thermo_tables.temperature = temperature_flat;
+    thermo_tables.mu_B        = mu_B_flat;
+    thermo_tables.mu_S        = mu_S_flat;
+    thermo_tables.mu_C        = mu_C_flat;
+    thermo_tables.dpde        = dpOverde_flat;
+    thermo_tables.dpdrhob     = dpOverdrhob_flat;
+
+    const int last = get_number_of_tables() - 1;
+    thermo_tables.e_min = e_bounds[0];
+    thermo_tables.e_max = (e_bounds[last]
+                           + (e_length[last] - 1)*e_spacing[last]);
+    for (int itable = 0; itable <= last; itable++) {
+        thermo_tables.nb_max[itable] = (
+            nb_length[itable] == 1 ? -1.
+            : nb_bounds[itable] + (nb_length[itable] - 1)*nb_spacing[itable]);
+    }
+}
+
+
+//! This function reads the ASCII tables of the EOS from path
+void EOS_neos::read_eos_tables(const string &path,
+                               const string *eos_file_string_array) {
+    const int ntables = get_number_of_tables();
+    const bool flag_muS = get_flag_muS();
+    const bool flag_muC = get_flag_muC();
+
     pressure_tb    = new double** [ntables];
     temperature_tb = new double** [ntables];
     mu_B_tb        = new double** [ntables];
@@ -220,31 +297,26 @@ void EOS_neos::initialize_eos() {
             }
         }
     }
-
-    //double eps_max_in = (e_bounds[6] + e_spacing[6]*e_length[6])/hbarc;
-    double eps_max_in = e_bounds[6] + e_spacing[6]*e_length[6];
-    set_eps_max(eps_max_in);
-
-    music_message.info("Done reading EOS.");
 }
 
 
 double EOS_neos::p_e_func(double e, double rhob) const {
-    return(get_dpOverde3(e, rhob));
+    if (!is_in_derivative_tables(e, rhob)) return(get_dpOverde3(e, rhob));
+    return(dpOverde_flat.interpolate(e, std::abs(rhob)));
 }
 
 
 double EOS_neos::p_rho_func(double e, double rhob) const {
-    return(get_dpOverdrhob2(e, rhob));
+    if (!is_in_derivative_tables(e, rhob)) return(get_dpOverdrhob2(e, rhob));
+    double sign = rhob/(std::abs(rhob) + Util::small_eps);
+    return(sign*dpOverdrhob_flat.interpolate(e, std::abs(rhob)));
 }
 
 
 //! This function returns the local temperature in [1/fm]
 //! input local energy density eps [1/fm^4] and rhob [1/fm^3]
 double EOS_neos::get_temperature(double e, double rhob) const {
-    int table_idx = get_table_idx(e);
-    double T5 = interpolate2D(e, std::abs(rhob), table_idx,
-                              temperature_tb);  // 1/fm^5
+    double T5 = temperature_flat.interpolate(e, std::abs(rhob));  // 1/fm^5
     T5 = std::max(Util::small_eps, T5);
     double T = pow(T5, 0.2);  // 1/fm
     return(T);
@@ -254,8 +326,7 @@ double EOS_neos::get_temperature(double e, double rhob) const {
 //! This function returns the local pressure in [1/fm^4]
 //! the input local energy density [1/fm^4], rhob [1/fm^3]
 double EOS_neos::get_pressure(double e, double rhob) const {
-    int table_idx = get_table_idx(e);
-    double f = interpolate2D(e, std::abs(rhob), table_idx, pressure_tb);
+    double f = pressure_flat.interpolate(e, std::abs(rhob));
     f = std::max(Util::small_eps, f);
     return(f);
 }
@@ -264,10 +335,8 @@ double EOS_neos::get_pressure(double e, double rhob) const {
 //! This function returns the local baryon chemical potential  mu_B in [1/fm]
 //! input local energy density eps [1/fm^4] and rhob [1/fm^3]
 double EOS_neos::get_muB(double e, double rhob) const {
-    int table_idx = get_table_idx(e);
     double sign = rhob/(std::abs(rhob) + Util::small_eps);
-    double mu = sign*interpolate2D(e, std::abs(rhob), table_idx,
-                                   mu_B_tb);  // 1/fm
+    double mu = sign*mu_B_flat.interpolate(e, std::abs(rhob));  // 1/fm
     return(mu);
 }
 
@@ -276,10 +345,8 @@ double EOS_neos::get_muB(double e, double rhob) const {
 //! input local energy density eps [1/fm^4] and rhob [1/fm^3]
 double EOS_neos::get_muS(double e, double rhob) const {
     if (!get_flag_muS()) return(0.0);
-    int table_idx = get_table_idx(e);
     double sign = rhob/(std::abs(rhob) + Util::small_eps);
-    double mu = sign*interpolate2D(e, std::abs(rhob), table_idx,
-                                   mu_S_tb);  // 1/fm
+    double mu = sign*mu_S_flat.interpolate(e, std::abs(rhob));  // 1/fm
     return(mu);
 }
 
@@ -288,14 +355,126 @@ double EOS_neos::get_muS(double e, double rhob) const {
 //! input local energy density eps [1/fm^4] and rhob [1/fm^3]
 double EOS_neos::get_muC(double e, double rhob) const {
     if (!get_flag_muC()) return(0.0);
-    int table_idx = get_table_idx(e);
     double sign = rhob/(std::abs(rhob) + Util::small_eps);
-    double mu = sign*interpolate2D(e, std::abs(rhob), table_idx,
-                                   mu_C_tb);  // 1/fm
+    double mu = sign*mu_C_flat.interpolate(e, std::abs(rhob));  // 1/fm
     return(mu);
 }
 
 
+//! This function returns the speed of sound squared from P and its
+//! derivatives at one table stencil
+double EOS_neos::get_cs2(double e, double rhob) const {
+    if (!is_in_derivative_tables(e, rhob)) {
+        return(calculate_velocity_of_sound_sq(e, rhob));
+    }
+    const EOSTableStencil stencil = pressure_flat.get_stencil(e,
+                                                              std::abs(rhob));
+    const double pressure = std::max(Util::small_eps,
+                                     pressure_flat.interpolate(stencil));
+    const double dpde     = dpOverde_flat.interpolate(stencil);
+    const double dpdrho   = (rhob/(std::abs(rhob) + Util::small_eps)
+                             *dpOverdrhob_flat.interpolate(stencil));
+    const double v_sound  = (dpde + rhob/(e + pressure + Util::small_eps)
+                                    *dpdrho);
+    return(std::max(0.01, std::min(1./3, v_sound)));
+}
+
+
+//! this function computes the table stencil once for P, T, the
+//! chemical potentials, and the derivatives of P
+ThermoState EOS_neos::get_thermo(double e, double rhob) const {
+    ThermoState thermo;
+    if (!thermo_tables.get_thermo(e, rhob, thermo)) {
+        thermo.dpde    = get_dpOverde3(e, rhob);
+        thermo.dpdrhob = get_dpOverdrhob2(e, rhob);
+    }
+    EOSThermoTables::set_cs2_and_entropy(e, rhob, thermo);
+    return(thermo);
+}
+
+
+void EOS_neos::get_thermo_batch(const double *e, const double *rhob,
+                                ThermoState *out, const int n) const {
+    for (int i = 0; i < n; i++) out[i] = EOS_neos::get_thermo(e[i], rhob[i]);
+}
+
+
+//! the batch functions below mirror the scalar ones,
+//! with the loops written for vectorization
+void EOS_neos::get_pressure_batch(const double *e, const double *rhob,
+                                  double *out, const int n) const {
+    pressure_flat.interpolate_batch(e, rhob, out, n);
+    #pragma omp simd
+    for (int i = 0; i < n; i++) out[i] = std::max(Util::small_eps, out[i]);
+}
+
+
+void EOS_neos::get_temperature_batch(const double *e, const double *rhob,
+                                     double *out, const int n) const {
+    temperature_flat.interpolate_batch(e, rhob, out, n);  // 1/fm^5
+    #pragma omp simd
+    for (int i = 0; i < n; i++) {
+        out[i] = pow(std::max(Util::small_eps, out[i]), 0.2);  // 1/fm
+    }
+}
+
+
+void EOS_neos::get_muB_batch(const double *e, const double *rhob,
+                             double *out, const int n) const {
+    mu_B_flat.interpolate_batch(e, rhob, out, n);
+    #pragma omp simd
+    for (int i = 0; i < n; i++) {
+        out[i] *= rhob[i]/(std::abs(rhob[i]) + Util::small_eps);
+    }
+}
+
+
+void EOS_neos::p_e_func_batch(const double *e, const double *rhob,
+                              double *out, const int n) const {
+    dpOverde_flat.interpolate_batch(e, rhob, out, n);
+    for (int i = 0; i < n; i++) {
+        if (!is_in_derivative_tables(e[i], rhob[i])) {
+            out[i] = get_dpOverde3(e[i], rhob[i]);
+        }
+    }
+}
+
+
+void EOS_neos::p_rho_func_batch(const double *e, const double *rhob,
+                                double *out, const int n) const {
+    dpOverdrhob_flat.interpolate_batch(e, rhob, out, n);
+    for (int i = 0; i < n; i++) {
+        if (is_in_derivative_tables(e[i], rhob[i])) {
+            out[i] *= rhob[i]/(std::abs(rhob[i]) + Util::small_eps);
+        } else {
+            out[i] = get_dpOverdrhob2(e[i], rhob[i]);
+        }
+    }
+}
+
+
+void EOS_neos::get_cs2_batch(const double *e, const double *rhob,
+                             double *out, const int n) const {
+    const double v_min = 0.01;
+    const double v_max = 1./3;
+    const int chunk = 64;
+    double dpde[chunk], dpdrho[chunk], pressure[chunk];
+    for (int i0 = 0; i0 < n; i0 += chunk) {
+        const int m = std::min(chunk, n - i0);
+        p_e_func_batch    (e + i0, rhob + i0, dpde,     m);
+        p_rho_func_batch  (e + i0, rhob + i0, dpdrho,   m);
+        get_pressure_batch(e + i0, rhob + i0, pressure, m);
+        #pragma omp simd
+        for (int i = 0; i < m; i++) {
+            const double v_sound = (
+                dpde[i] + rhob[i0 + i]/(e[i0 + i] + pressure[i]
+                                        + Util::small_eps)*dpdrho[i]);
+            out[i0 + i] = std::max(v_min, std::min(v_max, v_sound));
+        }
+    }
+}
+
+
 double EOS_neos::get_s2e(double s, double rhob) const {
     double e = get_s2e_finite_rhob(s, rhob);
     return(e);
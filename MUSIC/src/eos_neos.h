@@ -3,12 +3,31 @@
 #ifndef SRC_EOS_neos_H_
 #define SRC_EOS_neos_H_
 
+#include <string>
+
 #include "eos_base.h"
+#include "eos_table.h"
 
 class EOS_neos : public EOS_base {
  private:
     const int eos_id;
 
+    //! flattened copies of the tables for the lookups
+    EOSTable2D pressure_flat;
+    EOSTable2D temperature_flat;
+    EOSTable2D mu_B_flat;
+    EOSTable2D mu_S_flat;
+    EOSTable2D mu_C_flat;
+    EOSTable2D dpOverde_flat;
+    EOSTable2D dpOverdrhob_flat;
+    //! the views of the flattened tables for get_thermo
+    EOSThermoTables thermo_tables;
+
+    void set_thermo_tables();
+
+    void read_eos_tables(const std::string &path,
+                         const std::string *eos_file_string_array);
+
  public:
     EOS_neos(const int eos_id_in);
     ~EOS_neos();
@@ -21,8 +40,29 @@ class EOS_neos : public EOS_base {
     double get_muS        (double e, double rhob) const;
     double get_muC        (double e, double rhob) const;
     double get_pressure   (double e, double rhob) const;
+    double get_cs2        (double e, double rhob) const;
     double get_s2e        (double s, double rhob) const;
 
+    ThermoState get_thermo(double e, double rhob) const;
+    const EOSThermoTables *get_thermo_tables() const {
+        return(&thermo_tables);
+    }
+    void get_thermo_batch(const double *e, const double *rhob,
+                          ThermoState *out, const int n) const;
+
+    void get_pressure_batch   (const double *e, const double *rhob,
+                               double *out, const int n) const;
+    void get_temperature_batch(const double *e, const double *rhob,
+                               double *out, const int n) const;
+    void get_muB_batch        (const double *e, const double *rhob,
+                               double *out, const int n) const;
+    void get_cs2_batch        (const double *e, const double *rhob,
+                               double *out, const int n) const;
+    void p_e_func_batch       (const double *e, const double *rhob,
+                               double *out, const int n) const;
+    void p_rho_func_batch     (const double *e, const double *rhob,
+                               double *out, const int n) const;
+
     void check_eos() const {
         check_eos_with_finite_muB();
         outputMutable();
@@ -5,6 +5,7 @@
 
 #include <sstream>
 #include <fstream>
+#include <vector>
 
 using std::stringstream;
 using std::string;
@@ -58,6 +59,7 @@ void EOS_s95p::initialize_eos() {
     
     music_message << "from path " << spath.str();
     music_message.flush("info");
+    const string eos_dir = spath.str();
 
     if (eos_id == 2) {
         spath << "s95p-v1_";
@@ -69,13 +71,41 @@ void EOS_s95p::initialize_eos() {
     set_number_of_tables(ntables);
     resize_table_info_arrays();
     
+    std::vector<string> source_files;
+    for (int itable = 1; itable <= ntables; itable++) {
+        source_files.push_back(spath.str() + "dens" + std::to_string(itable)
+                               + ".dat");
+        source_files.push_back(spath.str() + "par" + std::to_string(itable)
+                               + ".dat");
+    }
+    const std::vector<double****> tables = {&pressure_tb, &temperature_tb};
+    const string cache_file = eos_dir + "music_eos_cache.bin";
+    if (!load_table_cache(cache_file, source_files, tables)) {
+        read_eos_tables(spath.str());
+        write_table_cache(cache_file, source_files, tables);
+    }
+
+    //double eps_max_in = (e_bounds[6] + e_spacing[6]*e_length[6])/hbarc;
+    double eps_max_in = e_bounds[6] + e_spacing[6]*e_length[6];
+    set_eps_max(eps_max_in);
+
+    build_derivative_tables();
+    build_inverse_tables();
+    music_message.info("Done reading EOS.");
+}
+
+
+//! This function reads the ASCII tables of the EOS, the file names
+//! start with path_prefix
+void EOS_s95p::read_eos_tables(const string &path_prefix) {
+    const int ntables = get_number_of_tables();
     string eos_file_string_array[7] = {"1", "2", "3", "4", "5", "6", "7"};
     pressure_tb    = new double** [ntables];
     temperature_tb = new double** [ntables];
     for (int itable = 0; itable < ntables; itable++) {
-        std::ifstream eos_d(spath.str() + "dens"
+        std::ifstream eos_d(path_prefix + "dens"
                             + eos_file_string_array[itable] + ".dat");
-        std::ifstream eos_T(spath.str() + "par"
+        std::ifstream eos_T(path_prefix + "par"
                             + eos_file_string_array[itable] + ".dat");
         // read the first two lines with general info:
         // lowest value of epsilon
@@ -114,17 +144,11 @@ void EOS_s95p::initialize_eos() {
             temperature_tb[itable][i][j] /= Util::hbarc;    // 1/fm
         }
     }
-
-    //double eps_max_in = (e_bounds[6] + e_spacing[6]*e_length[6])/hbarc;
-    double eps_max_in = e_bounds[6] + e_spacing[6]*e_length[6];
-    set_eps_max(eps_max_in);
-
-    music_message.info("Done reading EOS.");
 }
 
 
 double EOS_s95p::p_e_func(double e, double rhob) const {
-    return(get_dpOverde3(e, rhob));
+    return(interpolate_dpOverde(e, rhob));
 }
 
 
@@ -3,11 +3,15 @@
 #ifndef SRC_EOS_s95p_H_
 #define SRC_EOS_s95p_H_
 
+#include <string>
+
 #include "eos_base.h"
 
 class EOS_s95p : public EOS_base {
  private:
     const int eos_id;
+
+    void read_eos_tables(const std::string &path_prefix);
    
  public:
     EOS_s95p(const int eos_id_in);
@@ -0,0 +1,65 @@
+#include <cmath>
+#include <cstdlib>
+#include "eos_base.h"
+#include "eos_table.h"
+
+void EOSTable2D::build(const EOS_base &eos, double ***table) {
+    number_of_tables = eos.get_number_of_tables();
+    if (number_of_tables > max_tables) {
+        pretty_ostream music_message;
+        music_message << "EOSTable2D: " << number_of_tables
+                      << " tables, at most " << max_tables << " supported";
+        music_message.flush("error");
+        exit(1);
+    }
+
+    int total_size = 0;
+    for (int t = 0; t < number_of_tables; t++) {
+        const int N_e  = eos.e_length[t];
+        const int N_nb = eos.nb_length[t];
+        e0[t]           = eos.e_bounds[t];
+        nb0[t]          = eos.nb_bounds[t];
+        delta_e[t]      = eos.e_spacing[t];
+        delta_nb[t]     = eos.nb_spacing[t];
+        inv_delta_e[t]  = 1./delta_e[t];
+        inv_delta_nb[t] = 1./delta_nb[t];
+        e_lower[t]      = eos.e_bounds[t];
+        const bool last = (t == number_of_tables - 1);
+        idx_e_max[t]    = (last ? N_e - 2 : N_e - 1);
+        idx_nb_max[t]   = N_nb - 2;
+        seam_idx[t]     = (last ? -1 : N_e - 1);
+        row_stride[t]   = N_e + 1;
+        offset[t]       = total_size;
+        total_size     += N_nb*row_stride[t];
+    }
+
+    data.assign(total_size, 0.);
+    for (int t = 0; t < number_of_tables; t++) {
+        const int N_e  = eos.e_length[t];
+        const int N_nb = eos.nb_length[t];
+        const bool last = (t == number_of_tables - 1);
+        for (int i_nb = 0; i_nb < N_nb; i_nb++) {
+            double *row = data.data() + offset[t] + i_nb*row_stride[t];
+            for (int i_e = 0; i_e < N_e; i_e++) {
+                row[i_e] = table[t][i_nb][i_e];
+            }
+            if (last) {
+                row[N_e] = row[N_e - 1];
+            } else {
+                const int i_nb_next = std::min(i_nb, eos.nb_length[t+1] - 1);
+                row[N_e] = table[t+1][i_nb_next][0];
+            }
+        }
+    }
+    values = data.data();
+    size   = total_size;
+}
+
+
+void EOSTable2D::interpolate_batch(const double *e, const double *rhob,
+                                   double *out, const int n) const {
+    #pragma omp simd
+    for (int i = 0; i < n; i++) {
+        out[i] = interpolate(e[i], std::abs(rhob[i]));
+    }
+}
@@ -0,0 +1,187 @@
+#ifndef SRC_EOS_TABLE_H_
+#define SRC_EOS_TABLE_H_
+
+#include <algorithm>
+#include <vector>
+#include <cmath>
+#include "aligned_allocator.h"
+#include "eos_base.h"
+#include "util.h"
+
+//! position and weights of a point in the tables of an EOS. The tables
+//! of all quantities of one EOS have the same layout, so one stencil
+//! serves the lookups of all of them.
+struct EOSTableStencil {
+    int table_idx;
+    int base;          //!< index of the lower corner in the flat array
+    int row_stride;
+    bool seam;
+    double frac_e;
+    double frac_rhob;
+};
+
+#pragma omp declare target
+//! The layout of the flattened (e, rho_b) tables of one EOS quantity and
+//! a pointer to their values. All the tables are stored in one contiguous
+//! array together with their bounds and inverse spacings, so a lookup is
+//! a few multiply-adds and four loads without pointer chasing.
+//! Every row carries one extra column with the first entry of the next
+//! table, so the seam between two tables needs no special case.
+//! The view is plain data, so it can be copied to an offload device
+//! once values points to a copy of the array there.
+struct EOSTableView {
+    static constexpr int max_tables = 8;
+
+    const double *values = nullptr;
+    int size = 0;                  //!< number of entries of values
+
+    int number_of_tables = 0;
+    double e0[max_tables], nb0[max_tables];
+    double delta_e[max_tables], delta_nb[max_tables];
+    double inv_delta_e[max_tables], inv_delta_nb[max_tables];
+    double e_lower[max_tables];    //!< e_bounds, to select the table
+    int idx_e_max[max_tables], idx_nb_max[max_tables];
+    int seam_idx[max_tables];      //!< idx_e of the seam column
+    int row_stride[max_tables];
+    int offset[max_tables];
+
+    bool is_empty() const {return(number_of_tables == 0);}
+
+    //! index of the table holding e [1/fm^4]. Same as
+    //! EOS_base::get_table_idx, but without branches.
+    int get_table_idx(const double e) const {
+        int idx = 0;
+        for (int itable = 1; itable < number_of_tables; itable++) {
+            idx += (e >= e_lower[itable]);
+        }
+        return(idx);
+    }
+
+    //! the stencil of (e [1/fm^4], rhob [1/fm^3]), with the same
+    //! extrapolation as EOS_base::interpolate2D
+    EOSTableStencil get_stencil(const double e, const double rhob) const {
+        const int t = get_table_idx(e);
+
+        int idx_e  = static_cast<int>((e - e0[t])*inv_delta_e[t]);
+        int idx_nb = static_cast<int>((rhob - nb0[t])*inv_delta_nb[t]);
+        idx_e  = std::max(0, std::min(idx_e_max[t], idx_e));
+        idx_nb = std::max(0, std::min(idx_nb_max[t], idx_nb));
+
+        EOSTableStencil stencil;
+        stencil.table_idx  = t;
+        stencil.base       = offset[t] + idx_nb*row_stride[t] + idx_e;
+        stencil.row_stride = row_stride[t];
+        stencil.seam       = (idx_e == seam_idx[t]);
+        stencil.frac_e     = (e - (idx_e*delta_e[t] + e0[t]))*inv_delta_e[t];
+        stencil.frac_rhob  = ((rhob - (idx_nb*delta_nb[t] + nb0[t]))
+                              *inv_delta_nb[t]);
+        return(stencil);
+    }
+
+    //! bilinear interpolation at a stencil of this table, or of a table
+    //! built from the same EOS
+    double interpolate(const EOSTableStencil &s) const {
+        const double *corner = values + s.base;
+        const double temp1 = corner[0];
+        const double temp2 = corner[1];
+        const double temp4 = corner[s.row_stride];
+        // at the seam both upper corners are the first entry of the
+        // next table
+        const double temp3 = (s.seam ? temp2 : corner[s.row_stride + 1]);
+        return((temp1*(1. - s.frac_e) + temp2*s.frac_e)*(1. - s.frac_rhob)
+               + (temp3*s.frac_e + temp4*(1. - s.frac_e))*s.frac_rhob);
+    }
+
+    double interpolate(const double e, const double rhob) const {
+        return(interpolate(get_stencil(e, rhob)));
+    }
+};
+#pragma omp end declare target
+
+
+//! This class owns the 64-byte aligned array of an EOSTableView.
+//! It can be moved but not copied, so the view always points to its own
+//! array.
+class EOSTable2D : public EOSTableView {
+ private:
+    typedef AlignedAllocator<double, MemorySubsystem::eos_tables> Allocator;
+    std::vector<double, Allocator> data;
+
+ public:
+    EOSTable2D() = default;
+    EOSTable2D(const EOSTable2D &) = delete;
+    EOSTable2D &operator=(const EOSTable2D &) = delete;
+    EOSTable2D(EOSTable2D &&) = default;
+    EOSTable2D &operator=(EOSTable2D &&) = default;
+
+    //! copies table[itable][i_nb][i_e] with the table layout of eos
+    void build(const EOS_base &eos, double ***table);
+
+    //! out[i] = interpolate(e[i], std::abs(rhob[i]))
+    void interpolate_batch(const double *e, const double *rhob,
+                           double *out, const int n) const;
+};
+
+
+#pragma omp declare target
+//! The views of the flattened tables of a tabulated EOS which give the
+//! quantities of ThermoState. EOS_neos computes its ThermoState with
+//! them, and ThermoOffload reads a copy of them on the offload device,
+//! so both give the same results.
+struct EOSThermoTables {
+    EOSTableView pressure, temperature, mu_B, mu_S, mu_C, dpde, dpdrhob;
+
+    //! the range of the derivative tables, see
+    //! EOS_base::is_in_derivative_tables
+    double e_min = 0., e_max = -1.;
+    //! the largest |rhob| of each table, negative for the 1D tables
+    double nb_max[EOSTableView::max_tables];
+
+    bool is_in_derivative_tables(const double e, const double rhob) const {
+        if (dpde.is_empty() || e < e_min || e > e_max) return(false);
+        const double nb_limit = nb_max[pressure.get_table_idx(e)];
+        return(nb_limit < 0. || std::abs(rhob) <= nb_limit);
+    }
+
+    //! P, T and the chemical potentials at (e, rhob) from one stencil,
+    //! and dP/de and dP/drhob if (e, rhob) is in the derivative tables.
+    //! Returns false, leaving the derivatives unset, if it is not.
+    bool get_thermo(const double e, const double rhob,
+                    ThermoState &thermo) const {
+        const EOSTableStencil stencil = pressure.get_stencil(e,
+                                                             std::abs(rhob));
+        const double sign = rhob/(std::abs(rhob) + Util::small_eps);
+        thermo.pressure = std::max(Util::small_eps,
+                                   pressure.interpolate(stencil));
+        const double T5 = std::max(Util::small_eps,
+                                   temperature.interpolate(stencil));
+        thermo.temperature = pow(T5, 0.2);
+        thermo.muB = sign*mu_B.interpolate(stencil);
+        thermo.muS = (mu_S.is_empty() ? 0. : sign*mu_S.interpolate(stencil));
+        thermo.muC = (mu_C.is_empty() ? 0. : sign*mu_C.interpolate(stencil));
+        if (!is_in_derivative_tables(e, rhob)) return(false);
+        thermo.dpde    = dpde.interpolate(stencil);
+        thermo.dpdrhob = sign*dpdrhob.interpolate(stencil);
+        return(true);
+    }
+
+    //! cs^2 and the entropy density from the other quantities of thermo,
+    //! as EOS_base::get_entropy_from with its rho_S = 0 and
+    //! rho_C = 0.4 rho_B
+    static void set_cs2_and_entropy(const double e, const double rhob,
+                                    ThermoState &thermo) {
+        const double v_sound = (thermo.dpde + rhob/(e + thermo.pressure
+                                                    + Util::small_eps)
+                                              *thermo.dpdrhob);
+        thermo.cs2 = std::max(0.01, std::min(1./3, v_sound));
+        const double rhoS = 0.;
+        const double rhoC = 0.4*rhob;
+        const double f = (  e + thermo.pressure - thermo.muB*rhob
+                          - thermo.muS*rhoS - thermo.muC*rhoC)
+                         /(thermo.temperature + Util::small_eps);
+        thermo.entropy = std::max(Util::small_eps, f);
+    }
+};
+#pragma omp end declare target
+
+#endif  // SRC_EOS_TABLE_H_
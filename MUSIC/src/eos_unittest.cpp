@@ -1,10 +1,16 @@
 // Copyright 2018 @ Chun Shen
 
 #include "eos.h"
+#include "eos_table.h"
+#include "util.h"
 #include "doctest.h"
 
 #include <cassert>
+#include <cstdio>
+#include <fstream>
 #include <iostream>
+#include <string>
+#include <vector>
 
 TEST_CASE("test constructor") {
     EOS test(0);
@@ -14,3 +20,300 @@ TEST_CASE("test constructor") {
     CHECK(test.get_muB(1.0, 1.0)      == 0.0);
     CHECK(test.get_muS(1.0, -1.0)     == 0.0);
 }
+
+
+TEST_CASE("test flattened EOS table against interpolate2D") {
+    EOS_base eos_tb;
+    const int ntables = 2;
+    eos_tb.set_number_of_tables(ntables);
+    eos_tb.resize_table_info_arrays();
+    eos_tb.pressure_tb    = new double** [ntables];
+    eos_tb.temperature_tb = new double** [ntables];
+    for (int itable = 0; itable < ntables; itable++) {
+        eos_tb.e_bounds[itable]   = 0.1 + 1.0*itable;
+        eos_tb.e_spacing[itable]  = 0.1*(itable + 1);
+        eos_tb.e_length[itable]   = 11 - 5*itable;
+        eos_tb.nb_bounds[itable]  = 0.0;
+        eos_tb.nb_spacing[itable] = 0.05*(itable + 1);
+        eos_tb.nb_length[itable]  = 6;
+        eos_tb.pressure_tb[itable] = Util::mtx_malloc(
+                        eos_tb.nb_length[itable], eos_tb.e_length[itable]);
+        eos_tb.temperature_tb[itable] = Util::mtx_malloc(
+                        eos_tb.nb_length[itable], eos_tb.e_length[itable]);
+        for (int i = 0; i < eos_tb.nb_length[itable]; i++)
+        for (int j = 0; j < eos_tb.e_length[itable]; j++) {
+            eos_tb.pressure_tb[itable][i][j] = (
+                        1. + 0.3*eos_tb.e_bounds[itable] + 0.1*j + 0.07*i
+                        + 0.01*i*j*(itable + 1));
+        }
+    }
+    EOSTable2D flat;
+    flat.build(eos_tb, eos_tb.pressure_tb);
+
+    std::vector<double> e_list, rhob_list;
+    for (double e : {0.05, 0.1, 0.37, 1.03, 1.05, 1.1, 1.63, 2.3, 3.5})
+    for (double rhob : {0.0, 0.013, 0.12, 0.25, 0.5}) {
+        CHECK(flat.get_table_idx(e) == eos_tb.get_table_idx(e));
+        const int itable = eos_tb.get_table_idx(e);
+        const double ref = eos_tb.interpolate2D(e, rhob, itable,
+                                                eos_tb.pressure_tb);
+        CHECK(flat.interpolate(e, rhob) == doctest::Approx(ref).epsilon(1e-12));
+        e_list.push_back(e);
+        rhob_list.push_back(-rhob);
+    }
+
+    std::vector<double> out(e_list.size());
+    flat.interpolate_batch(e_list.data(), rhob_list.data(), out.data(),
+                           out.size());
+    for (unsigned int i = 0; i < out.size(); i++) {
+        CHECK(out[i] == flat.interpolate(e_list[i], -rhob_list[i]));
+    }
+}
+
+
+TEST_CASE("test the binary EOS table cache") {
+    EOS_base eos_tb;
+    const int ntables = 2;
+    eos_tb.set_number_of_tables(ntables);
+    eos_tb.resize_table_info_arrays();
+    eos_tb.pressure_tb    = new double** [ntables];
+    eos_tb.temperature_tb = new double** [ntables];
+    for (int itable = 0; itable < ntables; itable++) {
+        eos_tb.e_bounds[itable]   = 0.1 + 1.0*itable;
+        eos_tb.e_spacing[itable]  = 0.1*(itable + 1);
+        eos_tb.e_length[itable]   = 11 - 5*itable;
+        eos_tb.nb_bounds[itable]  = 0.0;
+        eos_tb.nb_spacing[itable] = 0.05*(itable + 1);
+        eos_tb.nb_length[itable]  = 6 - itable;
+        eos_tb.pressure_tb[itable] = Util::mtx_malloc(
+                        eos_tb.nb_length[itable], eos_tb.e_length[itable]);
+        eos_tb.temperature_tb[itable] = Util::mtx_malloc(
+                        eos_tb.nb_length[itable], eos_tb.e_length[itable]);
+        for (int i = 0; i < eos_tb.nb_length[itable]; i++)
+        for (int j = 0; j < eos_tb.e_length[itable]; j++) {
+            eos_tb.pressure_tb[itable][i][j]    = 0.1*j + i + 10*itable;
+            eos_tb.temperature_tb[itable][i][j] = -0.2*j + i*i;
+        }
+    }
+    eos_tb.set_eps_max(3.4);
+
+    const std::string source_file = "eos_cache_unittest_source.dat";
+    const std::string cache_file  = "eos_cache_unittest.bin";
+    std::ofstream(source_file) << "1 2 3" << std::endl;
+    const std::vector<std::string> source_files = {source_file};
+    eos_tb.write_table_cache(
+        cache_file, source_files, {&eos_tb.pressure_tb, &eos_tb.temperature_tb});
+
+    {
+        EOS_base eos_cached;
+        eos_cached.set_number_of_tables(ntables);
+        eos_cached.resize_table_info_arrays();
+        REQUIRE(eos_cached.load_table_cache(
+            cache_file, source_files,
+            {&eos_cached.pressure_tb, &eos_cached.temperature_tb}));
+        CHECK(eos_cached.is_table_cache_mapped());
+        CHECK(eos_cached.get_eps_max() == 3.4);
+        for (int itable = 0; itable < ntables; itable++) {
+            CHECK(eos_cached.e_bounds[itable]   == eos_tb.e_bounds[itable]);
+            CHECK(eos_cached.e_spacing[itable]  == eos_tb.e_spacing[itable]);
+            CHECK(eos_cached.nb_spacing[itable] == eos_tb.nb_spacing[itable]);
+            CHECK(eos_cached.e_length[itable]   == eos_tb.e_length[itable]);
+            CHECK(eos_cached.nb_length[itable]  == eos_tb.nb_length[itable]);
+            for (int i = 0; i < eos_tb.nb_length[itable]; i++)
+            for (int j = 0; j < eos_tb.e_length[itable]; j++) {
+                CHECK(eos_cached.pressure_tb[itable][i][j]
+                      == eos_tb.pressure_tb[itable][i][j]);
+                CHECK(eos_cached.temperature_tb[itable][i][j]
+                      == eos_tb.temperature_tb[itable][i][j]);
+            }
+        }
+    }
+
+    // the cache is stale once the source file changes
+    std::ofstream(source_file) << "1 2 3 4" << std::endl;
+    EOS_base eos_stale;
+    eos_stale.set_number_of_tables(0);
+    CHECK(!eos_stale.load_table_cache(cache_file, source_files,
+                                      {&eos_stale.pressure_tb}));
+    CHECK(!eos_stale.is_table_cache_mapped());
+    std::remove(source_file.c_str());
+    std::remove(cache_file.c_str());
+}
+
+
+namespace {
+    //! a tabulated EOS with P = e/3 + rhob^2/2
+    class EOS_test_table : public EOS_base {
+     public:
+        EOS_test_table() {
+            const int ntables = 2;
+            set_number_of_tables(ntables);
+            resize_table_info_arrays();
+            pressure_tb    = new double** [ntables];
+            temperature_tb = new double** [ntables];
+            for (int itable = 0; itable < ntables; itable++) {
+                e_bounds[itable]   = 0.1 + 1.0*itable;
+                e_spacing[itable]  = 0.1*(itable + 1);
+                e_length[itable]   = 11 - 5*itable;
+                nb_bounds[itable]  = 0.0;
+                nb_spacing[itable] = 0.05*(itable + 1);
+                nb_length[itable]  = 6;
+                pressure_tb[itable] = Util::mtx_malloc(
+                                nb_length[itable], e_length[itable]);
+                temperature_tb[itable] = Util::mtx_malloc(
+                                nb_length[itable], e_length[itable]);
+                for (int i = 0; i < nb_length[itable]; i++)
+                for (int j = 0; j < e_length[itable]; j++) {
+                    const double e    = e_bounds[itable] + j*e_spacing[itable];
+                    const double rhob = i*nb_spacing[itable];
+                    pressure_tb[itable][i][j] = e/3. + rhob*rhob/2.;
+                }
+            }
+        }
+
+        double get_pressure(double e, double rhob) const {
+            return(interpolate2D(e, std::abs(rhob), get_table_idx(e),
+                                 pressure_tb));
+        }
+    };
+}
+
+
+TEST_CASE("test the EOS derivative tables") {
+    EOS_test_table eos_tb;
+    eos_tb.build_derivative_tables();
+    // the last node of the first table is the first node of the second
+    for (int itable = 0; itable < 2; itable++)
+    for (int i = 0; i < eos_tb.nb_length[itable]; i++)
+    for (int j = 0; j < eos_tb.e_length[itable] - 1 + itable; j++) {
+        const double e    = eos_tb.e_bounds[itable] + j*eos_tb.e_spacing[itable];
+        const double rhob = i*eos_tb.nb_spacing[itable];
+        CHECK(eos_tb.interpolate_dpOverde(e, rhob)
+              == doctest::Approx(eos_tb.get_dpOverde3(e, rhob)));
+        CHECK(eos_tb.interpolate_dpOverdrhob(e, -rhob)
+              == doctest::Approx(eos_tb.get_dpOverdrhob2(e, -rhob)));
+    }
+    // between the nodes
+    CHECK(eos_tb.interpolate_dpOverde(0.53, 0.12)
+          == doctest::Approx(1./3.).epsilon(1e-6));
+    CHECK(eos_tb.interpolate_dpOverdrhob(0.53, 0.12)
+          == doctest::Approx(0.12).epsilon(0.05));
+    CHECK(eos_tb.interpolate_dpOverdrhob(0.53, -0.12)
+          == -eos_tb.interpolate_dpOverdrhob(0.53, 0.12));
+    // outside the tables the finite differences are used
+    CHECK(!eos_tb.is_in_derivative_tables(0.05, 0.));
+    CHECK(!eos_tb.is_in_derivative_tables(0.5, 0.3));
+    CHECK(eos_tb.interpolate_dpOverde(0.05, 0.)
+          == eos_tb.get_dpOverde3(0.05, 0.));
+}
+
+
+namespace {
+    //! a conformal EOS with T = (e/(a (1 + rhob^2)))^(1/4), whose
+    //! inverses e(T, rhob) and e(s, rhob) are known
+    class EOS_test_inverse : public EOS_base {
+     public:
+        const double a = 15.;
+
+        EOS_test_inverse() {
+            set_number_of_tables(1);
+            resize_table_info_arrays();
+            e_bounds[0]   = 0.01;
+            e_spacing[0]  = 0.01;
+            e_length[0]   = 2;
+            nb_bounds[0]  = 0.0;
+            nb_spacing[0] = 0.1;
+            nb_length[0]  = 11;
+            pressure_tb    = new double** [1];
+            temperature_tb = new double** [1];
+            pressure_tb[0]    = Util::mtx_malloc(nb_length[0], e_length[0]);
+            temperature_tb[0] = Util::mtx_malloc(nb_length[0], e_length[0]);
+            set_eps_max(1e4);
+        }
+
+        double get_pressure(double e, double rhob) const {return(e/3.);}
+        double get_temperature(double e, double rhob) const {
+            return(pow(e/(a*(1. + rhob*rhob)), 0.25));
+        }
+
+        double get_T2e_exact(const double T, const double rhob) const {
+            return(a*(1. + rhob*rhob)*pow(T/Util::hbarc, 4));
+        }
+        double get_s2e_exact(const double s, const double rhob) const {
+            return(pow(3.*s/(4.*pow(a*(1. + rhob*rhob), 0.25)), 4./3.));
+        }
+    };
+}
+
+
+TEST_CASE("test the inverse EOS tables against the binary search") {
+    EOS_test_inverse eos_inv;
+    CHECK(!eos_inv.has_inverse_tables());
+    CHECK(eos_inv.get_s2e_finite_rhob(5., 0.3)
+          == doctest::Approx(eos_inv.get_s2e_exact(5., 0.3)).epsilon(1e-7));
+
+    eos_inv.build_inverse_tables();
+    CHECK(eos_inv.has_inverse_tables());
+    for (double rhob : {0.0, 0.25, 0.93}) {
+        for (double s : {1e-3, 0.1, 5., 80.}) {
+            CHECK(eos_inv.get_s2e_finite_rhob(s, rhob)
+                  == doctest::Approx(
+                        eos_inv.get_s2e_exact(s, rhob)).epsilon(1e-7));
+        }
+        for (double T : {0.05, 0.2, 0.6}) {
+            CHECK(eos_inv.get_T2e_finite_rhob(T, rhob)
+                  == doctest::Approx(
+                        eos_inv.get_T2e_exact(T, rhob)).epsilon(1e-7));
+        }
+    }
+
+    // without the Newton step, the interpolation of the tables is
+    // accurate to 1e-4
+    eos_inv.set_inverse_newton_steps(0);
+    CHECK(eos_inv.get_s2e_finite_rhob(5., 0.25)
+          == doctest::Approx(eos_inv.get_s2e_exact(5., 0.25)).epsilon(1e-3));
+    eos_inv.set_inverse_newton_steps(1);
+
+    // outside the tables, the binary search
+    CHECK(eos_inv.get_s2e_finite_rhob(5., 1.5)
+          == doctest::Approx(eos_inv.get_s2e_exact(5., 1.5)).epsilon(1e-7));
+}
+
+
+TEST_CASE("test batch EOS functions against the scalar ones") {
+    EOS test(0);
+    const int n = 100;
+    std::vector<double> e(n), rhob(n), out(n);
+    for (int i = 0; i < n; i++) {
+        e[i]    = 0.01 + 0.7*i;
+        rhob[i] = 0.003*i - 0.1;
+    }
+    test.get_pressure_batch(e.data(), rhob.data(), out.data(), n);
+    for (int i = 0; i < n; i++) CHECK(out[i] == test.get_pressure(e[i], rhob[i]));
+    test.get_temperature_batch(e.data(), rhob.data(), out.data(), n);
+    for (int i = 0; i < n; i++) CHECK(out[i] == test.get_temperature(e[i], rhob[i]));
+    test.get_muB_batch(e.data(), rhob.data(), out.data(), n);
+    for (int i = 0; i < n; i++) CHECK(out[i] == test.get_muB(e[i], rhob[i]));
+    test.get_entropy_batch(e.data(), rhob.data(), out.data(), n);
+    for (int i = 0; i < n; i++) CHECK(out[i] == test.get_entropy(e[i], rhob[i]));
+    test.get_cs2_batch(e.data(), rhob.data(), out.data(), n);
+    for (int i = 0; i < n; i++) CHECK(out[i] == test.get_cs2(e[i], rhob[i]));
+}
+
+
+TEST_CASE("test get_thermo against the single quantity getters") {
+    EOS test(0);
+    for (double e : {0.01, 0.3, 2.5, 40.}) {
+        for (double rhob : {-0.2, 0.0, 0.1}) {
+            const ThermoState thermo = test.get_thermo(e, rhob);
+            CHECK(thermo.pressure    == test.get_pressure(e, rhob));
+            CHECK(thermo.temperature == test.get_temperature(e, rhob));
+            CHECK(thermo.cs2         == test.get_cs2(e, rhob));
+            CHECK(thermo.muB         == test.get_muB(e, rhob));
+            CHECK(thermo.muS         == test.get_muS(e, rhob));
+            CHECK(thermo.entropy     == test.get_entropy(e, rhob));
+            CHECK(thermo.dpde        == test.get_dpde(e, rhob));
+            CHECK(thermo.dpdrhob     == test.get_dpdrhob(e, rhob));
+        }
+    }
+}
@@ -0,0 +1,37 @@
+#include <algorithm>
+#include <cmath>
+#include "eta_grid.h"
+
+EtaGrid::EtaGrid(const InitData &DATA_in) : DATA(DATA_in) {
+    uniform_ = !(DATA.eta_grid_stretching > 0.) || DATA.neta <= 1;
+    if (uniform_) return;
+
+    const int neta = DATA.neta;
+    const double c = DATA.eta_grid_stretching;
+    eta_.resize(neta);
+    width_.resize(neta);
+    spacing_.resize(neta);
+    face_minus_.resize(neta);
+    face_plus_.resize(neta);
+    const double dxi = 2./(neta - 1.);
+    const double eta_max = DATA.eta_size/2.;
+    min_width_ = DATA.eta_size;
+    for (int i = 0; i < neta; i++) {
+        const double xi = -1. + i*dxi;
+        const double eta_m = map(DATA.eta_size, c, xi - dxi/2.);
+        const double eta_p = map(DATA.eta_size, c, xi + dxi/2.);
+        eta_[i]        = map(DATA.eta_size, c, xi);
+        width_[i]      = eta_p - eta_m;
+        spacing_[i]    = eta_max*c*cosh(c*xi)/sinh(c)*dxi;
+        face_minus_[i] = eta_[i] - eta_m;
+        face_plus_[i]  = eta_p - eta_[i];
+        min_width_ = std::min(min_width_, width_[i]);
+    }
+}
+
+
+double EtaGrid::map(const double eta_size, const double stretching,
+                    const double xi) {
+    if (!(stretching > 0.)) return(eta_size/2.*xi);
+    return(eta_size/2.*sinh(stretching*xi)/sinh(stretching));
+}
@@ -0,0 +1,88 @@
+#ifndef SRC_ETA_GRID_H_
+#define SRC_ETA_GRID_H_
+
+#include <cassert>
+#include <vector>
+#include "data.h"
+
+//! This class is the longitudinal coordinate of the cells. The neta cells
+//! are uniform in a computational coordinate xi in [-1, 1], and
+//!
+//!     eta_s(xi) = eta_size/2*sinh(c*xi)/sinh(c),  c = eta_grid_stretching,
+//!
+//! which is monotone, with the fine cells at mid-rapidity and the spacing
+//! growing by c*cosh(c)/sinh(c) towards the edges. c = 0 is the uniform
+//! grid with spacing delta_eta, whose values are the ones of the
+//! expressions of the uniform grid bit by bit.
+//!
+//! The faces of the cell ieta are at xi_{ieta -+ 1/2}. The stencils are
+//! unchanged in xi: the flux differences are divided by the width of the
+//! cell between its faces, the centred differences by the metric spacing
+//! d eta_s/d xi*delta_xi at the cell, and the geometric terms of the KT
+//! fluxes take the distances from the cell to each of its faces.
+//! The indices are the ones of the local grid, shifted by
+//! DATA.eta_index_offset in the slabs of a distributed run.
+class EtaGrid {
+ private:
+    const InitData &DATA;
+    bool uniform_ = true;
+    //! the cells of the stretched grid (empty on the uniform grid)
+    std::vector<double> eta_;           //!< the cell centres
+    std::vector<double> width_;         //!< face to face
+    std::vector<double> spacing_;       //!< d eta_s/d xi*delta_xi
+    std::vector<double> face_minus_;    //!< from the minus face to the centre
+    std::vector<double> face_plus_;     //!< from the centre to the plus face
+    double min_width_ = 0.;
+
+    int get_global_index(const int ieta) const {
+        const int i = ieta + DATA.eta_index_offset;
+        assert(i >= 0 && i < static_cast<int>(eta_.size()));
+        return(i);
+    }
+
+ public:
+    explicit EtaGrid(const InitData &DATA_in);
+
+    //! eta_s(xi) of the stretched grid
+    static double map(const double eta_size, const double stretching,
+                      const double xi);
+
+    bool is_uniform() const {return(uniform_);}
+
+    double get_eta(const int ieta) const {
+        if (uniform_) {
+            return(- DATA.eta_size/2.
+                   + (ieta + DATA.eta_index_offset)*DATA.delta_eta);
+        }
+        return(eta_[get_global_index(ieta)]);
+    }
+    double get_width(const int ieta) const {
+        if (uniform_) return(DATA.delta_eta);
+        return(width_[get_global_index(ieta)]);
+    }
+    double get_spacing(const int ieta) const {
+        if (uniform_) return(DATA.delta_eta);
+        return(spacing_[get_global_index(ieta)]);
+    }
+    double get_face_distance_minus(const int ieta) const {
+        if (uniform_) return(DATA.delta_eta/2.);
+        return(face_minus_[get_global_index(ieta)]);
+    }
+    double get_face_distance_plus(const int ieta) const {
+        if (uniform_) return(DATA.delta_eta/2.);
+        return(face_plus_[get_global_index(ieta)]);
+    }
+    //! the distance between the centres of the cells ieta and ieta + 1
+    double get_distance_to_next(const int ieta) const {
+        if (uniform_) return(DATA.delta_eta);
+        const int i = get_global_index(ieta);
+        return(eta_[i + 1] - eta_[i]);
+    }
+
+    //! the narrowest cell of the grid, which sets the Courant condition
+    double get_min_width() const {
+        return(uniform_ ? DATA.delta_eta : min_width_);
+    }
+};
+
+#endif  // SRC_ETA_GRID_H_
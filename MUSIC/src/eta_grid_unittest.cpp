@@ -0,0 +1,96 @@
+#include "eta_grid.h"
+#include "doctest.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+InitData make_test_data(const int neta, const double stretching) {
+    InitData DATA;
+    DATA.neta                = neta;
+    DATA.eta_size            = 12.;
+    DATA.delta_eta           = DATA.eta_size/neta;
+    DATA.eta_grid_stretching = stretching;
+    DATA.eta_index_offset    = 0;
+    return(DATA);
+}
+
+}
+
+TEST_CASE("the uniform eta grid is the one of the legacy expressions") {
+    InitData DATA = make_test_data(24, 0.);
+    for (const int offset : {0, 5}) {
+        DATA.eta_index_offset = offset;
+        const EtaGrid eta_grid(DATA);
+        CHECK(eta_grid.is_uniform());
+        CHECK(eta_grid.get_min_width() == DATA.delta_eta);
+        for (int ieta = 0; ieta < DATA.neta - offset; ieta++) {
+            CHECK(eta_grid.get_eta(ieta)
+                  == ((DATA.delta_eta)*(ieta + DATA.eta_index_offset)
+                      - (DATA.eta_size)/2.0));
+            CHECK(eta_grid.get_width(ieta) == DATA.delta_eta);
+            CHECK(eta_grid.get_spacing(ieta) == DATA.delta_eta);
+            CHECK(eta_grid.get_distance_to_next(ieta) == DATA.delta_eta);
+            CHECK(eta_grid.get_face_distance_minus(ieta)
+                  == DATA.delta_eta/2.);
+            CHECK(eta_grid.get_face_distance_plus(ieta)
+                  == DATA.delta_eta/2.);
+        }
+    }
+}
+
+TEST_CASE("the stretched eta grid is monotone, symmetric and covers eta_size") {
+    const InitData DATA = make_test_data(31, 1.5);
+    const EtaGrid eta_grid(DATA);
+    CHECK(!eta_grid.is_uniform());
+    const int neta = DATA.neta;
+    CHECK(eta_grid.get_eta(0) == doctest::Approx(-DATA.eta_size/2.));
+    CHECK(eta_grid.get_eta(neta - 1) == doctest::Approx(DATA.eta_size/2.));
+    CHECK(eta_grid.get_eta(neta/2) == doctest::Approx(0.));
+
+    double sum_width = 0.;
+    double min_width = DATA.eta_size;
+    for (int ieta = 0; ieta < neta; ieta++) {
+        const int ieta_mirror = neta - 1 - ieta;
+        CHECK(eta_grid.get_eta(ieta)
+              == doctest::Approx(-eta_grid.get_eta(ieta_mirror)));
+        CHECK(eta_grid.get_width(ieta)
+              == doctest::Approx(eta_grid.get_width(ieta_mirror)));
+        CHECK(eta_grid.get_width(ieta)
+              == doctest::Approx(eta_grid.get_face_distance_minus(ieta)
+                                 + eta_grid.get_face_distance_plus(ieta)));
+        if (ieta < neta - 1) {
+            CHECK(eta_grid.get_eta(ieta + 1) > eta_grid.get_eta(ieta));
+            // the cells share their faces
+            CHECK(eta_grid.get_distance_to_next(ieta)
+                  == doctest::Approx(
+                         eta_grid.get_face_distance_plus(ieta)
+                         + eta_grid.get_face_distance_minus(ieta + 1)));
+        }
+        if (ieta > neta/2) {
+            // the cells grow towards the edges
+            CHECK(eta_grid.get_width(ieta) > eta_grid.get_width(ieta - 1));
+        }
+        sum_width += eta_grid.get_width(ieta);
+        min_width = std::min(min_width, eta_grid.get_width(ieta));
+    }
+    // the grid spans the centres of the edge cells plus a half cell each
+    CHECK(sum_width
+          == doctest::Approx(DATA.eta_size
+                             + eta_grid.get_face_distance_minus(0)
+                             + eta_grid.get_face_distance_plus(neta - 1)));
+    CHECK(eta_grid.get_min_width() == min_width);
+    CHECK(eta_grid.get_min_width() < DATA.eta_size/(neta - 1.));
+}
+
+TEST_CASE("the eta grid tends to the uniform grid for a weak stretching") {
+    const int neta = 21;
+    const double eta_size = 8.;
+    const double dxi = 2./(neta - 1.);
+    for (int i = 0; i < neta; i++) {
+        const double xi = -1. + i*dxi;
+        CHECK(EtaGrid::map(eta_size, 1e-6, xi)
+              == doctest::Approx(EtaGrid::map(eta_size, 0., xi)));
+    }
+    CHECK(EtaGrid::map(eta_size, 0., 0.5) == eta_size/4.);
+}
@@ -0,0 +1,803 @@
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+#include "util.h"
+#include "grid_info.h"
+#include "evolution_observables.h"
+
+using Util::hbarc;
+using Util::small_eps;
+using std::scientific;
+using std::setw;
+using std::setprecision;
+using std::endl;
+using std::ostringstream;
+
+namespace {
+    //! opens an observable file at tau, a new file at the first time step
+    void open_observable_file(std::fstream &of, const std::string &filename,
+                              const InitData &DATA, const double tau,
+                              const std::string &header) {
+        if (std::abs(tau - DATA.tau0) < 1e-10) {
+            of.open(filename.c_str(), std::fstream::out);
+            of << header << endl;
+        } else {
+            of.open(filename.c_str(), std::fstream::out | std::fstream::app);
+        }
+    }
+
+    std::string get_window_filename(const std::string &prefix,
+                                    const double eta_min,
+                                    const double eta_max) {
+        ostringstream filename;
+        filename << prefix << eta_min << "_" << eta_max << ".dat";
+        return(filename.str());
+    }
+}
+
+
+void Observable::combine(double *total, const double *part) const {
+    const int n = get_number_of_accumulators();
+    for (int i = 0; i < n; i++) total[i] += part[i];
+}
+
+
+EvolutionObservables::EvolutionObservables(const InitData &DATA_in,
+                                           const EOS &eos_in) :
+    DATA(DATA_in), eos(eos_in), eta_grid_(DATA_in) {}
+
+
+Observable *EvolutionObservables::add(
+                                std::unique_ptr<Observable> observable) {
+    observables_.push_back(std::move(observable));
+    return(observables_.back().get());
+}
+
+
+void EvolutionObservables::compute_slice_centroids(const SCGrid &arena) {
+    const int neta = arena.nEta();
+    slice_centroids_.assign(2*neta, 0.);
+    #pragma omp parallel for
+    for (int ieta = 0; ieta < neta; ieta++) {
+        double x_o   = 0.0;
+        double y_o   = 0.0;
+        double w_sum = 0.0;
+        for (int iy = 0; iy < arena.nY(); iy++)
+        for (int ix = 0; ix < arena.nX(); ix++) {
+            const double x_local = - DATA.x_size/2. + ix*DATA.delta_x;
+            const double y_local = - DATA.y_size/2. + iy*DATA.delta_y;
+            const double weight  = (arena(ix, iy, ieta).epsilon
+                                    *arena(ix, iy, ieta).u[0]);
+            x_o   += x_local*weight;
+            y_o   += y_local*weight;
+            w_sum += weight;
+        }
+        slice_centroids_[2*ieta]     = x_o/w_sum;
+        slice_centroids_[2*ieta + 1] = y_o/w_sum;
+    }
+}
+
+
+void EvolutionObservables::evaluate(
+        const int it, const double tau, const SCGrid &arena,
+        const SCGrid *arena_prev, const VorticityGrid *vorticity,
+        const ActiveRegion &active_region) {
+    std::vector<Observable*> due;
+    std::vector<int> offsets;
+    int n_acc = 0;
+    int fields = 0;
+    bool active_region_only = true;
+    for (auto &observable : observables_) {
+        if (!observable->is_due(it)) continue;
+        due.push_back(observable.get());
+        offsets.push_back(n_acc);
+        n_acc += observable->get_number_of_accumulators();
+        fields |= observable->get_fields();
+        active_region_only = (active_region_only
+                              && observable->is_active_region_only());
+    }
+    if (due.empty()) return;
+
+    if (   ((fields & Observable::kPrevGrid) && arena_prev == nullptr)
+        || ((fields & Observable::kVorticity) && vorticity == nullptr)) {
+        pretty_ostream music_message;
+        music_message.error("EvolutionObservables: an observable needs the "
+                            "previous grid or the vorticity, which is not "
+                            "given!");
+        exit(1);
+    }
+    if (fields & Observable::kSliceCentroid) compute_slice_centroids(arena);
+
+    const bool distributed = (domain_ptr_ != nullptr
+                              && domain_ptr_->is_distributed());
+    int x0 = 0, x1 = arena.nX();
+    int y0 = 0, y1 = arena.nY();
+    int eta0 = 0, eta1 = arena.nEta();
+    if (distributed) {
+        // the halo layers are summed by the neighbouring slabs
+        eta0 = domain_ptr_->get_owned_eta_min();
+        eta1 = domain_ptr_->get_owned_eta_max();
+    }
+    if (active_region_only) {
+        x0 = active_region.get_x_min();
+        x1 = active_region.get_x_max();
+        y0 = active_region.get_y_min();
+        y1 = active_region.get_y_max();
+        eta0 = std::max(eta0, active_region.get_eta_min());
+        eta1 = std::min(eta1, active_region.get_eta_max());
+    }
+    const int nrows_y = std::max(0, y1 - y0);
+    const int nrows = (x1 > x0) ? nrows_y*std::max(0, eta1 - eta0) : 0;
+    row_accumulators_.assign(static_cast<size_t>(nrows)*n_acc, 0.);
+
+    const int ndue = due.size();
+    #pragma omp parallel for schedule(dynamic)
+    for (int irow = 0; irow < nrows; irow++) {
+        const int ieta = eta0 + irow/nrows_y;
+        const int iy   = y0 + irow%nrows_y;
+        double *acc = &row_accumulators_[static_cast<size_t>(irow)*n_acc];
+        std::vector<char> contained(ndue);
+
+        ObservableCell c;
+        c.tau   = tau;
+        c.iy    = iy;
+        c.ieta  = ieta + DATA.eta_index_offset;
+        c.y     = - DATA.y_size/2. + iy*DATA.delta_y;
+        c.eta_s = 0.0;
+        if (!DATA.boost_invariant) {
+            c.eta_s = eta_grid_.get_eta(ieta);
+        }
+        c.eta_weight = eta_grid_.get_width(ieta)/DATA.delta_eta;
+        c.cosh_eta  = cosh(c.eta_s);
+        c.sinh_eta  = sinh(c.eta_s);
+        c.cell_prev = nullptr;
+        c.vorticity = nullptr;
+        c.x_o = 0.;
+        c.y_o = 0.;
+        if (fields & Observable::kSliceCentroid) {
+            c.x_o = slice_centroids_[2*ieta];
+            c.y_o = slice_centroids_[2*ieta + 1];
+        }
+        for (int ix = x0; ix < x1; ix++) {
+            c.ix     = ix;
+            c.x      = - DATA.x_size/2. + ix*DATA.delta_x;
+            c.cell   = &arena(ix, iy, ieta);
+            c.active = active_region.is_active(ix, iy, ieta);
+            if (arena_prev != nullptr)
+                c.cell_prev = &(*arena_prev)(ix, iy, ieta);
+            if (vorticity != nullptr)
+                c.vorticity = &(*vorticity)(ix, iy, ieta);
+
+            bool any_contained = false;
+            int needed = 0;
+            for (int k = 0; k < ndue; k++) {
+                contained[k] = due[k]->contains(c);
+                if (contained[k]) {
+                    any_contained = true;
+                    needed |= due[k]->get_fields();
+                }
+            }
+            if (!any_contained) continue;
+
+            const double e_local    = c.cell->epsilon;
+            const double rhob_local = c.cell->rhob;
+            if (needed & Observable::kPressure)
+                c.pressure = eos.get_pressure(e_local, rhob_local);
+            if (needed & Observable::kTemperature)
+                c.temperature = eos.get_temperature(e_local, rhob_local);
+            if (needed & Observable::kMuB)
+                c.muB = eos.get_muB(e_local, rhob_local);
+            for (int k = 0; k < ndue; k++) {
+                if (contained[k]) due[k]->accumulate(c, acc + offsets[k]);
+            }
+        }
+    }
+
+    // merge the rows in the fixed tree of DeterministicSum
+    DeterministicSum::tree_combine(
+            row_accumulators_.data(), nrows, n_acc,
+            [&](double *total, const double *part) {
+                for (int k = 0; k < ndue; k++) {
+                    due[k]->combine(total + offsets[k], part + offsets[k]);
+                }
+            });
+    std::vector<double> totals(n_acc, 0.);
+    if (nrows > 0) {
+        std::copy(row_accumulators_.begin(),
+                  row_accumulators_.begin() + n_acc, totals.begin());
+    }
+    if (distributed) {
+        std::vector<double> rank_totals;
+        domain_ptr_->all_gather(totals, rank_totals);
+        totals.assign(n_acc, 0.);
+        for (int irank = 0; irank < domain_ptr_->get_number_of_ranks();
+                irank++) {
+            const double *acc = &rank_totals[static_cast<size_t>(irank)*n_acc];
+            for (int k = 0; k < ndue; k++) {
+                due[k]->combine(&totals[offsets[k]], acc + offsets[k]);
+            }
+        }
+    }
+    const bool write_output = (!distributed || domain_ptr_->get_rank() == 0);
+    for (int k = 0; k < ndue; k++) {
+        due[k]->set_write_output(write_output);
+        due[k]->finish(tau, &totals[offsets[k]]);
+    }
+}
+
+
+std::vector<std::string> EvolutionObservables::get_output_filenames() const {
+    std::vector<std::string> filenames;
+    for (const auto &observable : observables_) {
+        if (!observable->writes_output()) continue;
+        const auto filenames_i = observable->get_output_filenames();
+        filenames.insert(filenames.end(), filenames_i.begin(),
+                         filenames_i.end());
+    }
+    return(filenames);
+}
+
+
+void EvolutionObservables::write_checkpoint(
+                                    CheckpointWriter &checkpoint) const {
+    for (const auto &observable : observables_) {
+        observable->write_checkpoint(checkpoint);
+    }
+}
+
+
+void EvolutionObservables::read_checkpoint(CheckpointReader &checkpoint) {
+    for (const auto &observable : observables_) {
+        observable->read_checkpoint(checkpoint);
+    }
+}
+
+
+void MaximumEnergyDensity::accumulate(const ObservableCell &cell,
+                                      double *acc) const {
+    acc[0] = std::max(acc[0], cell.cell->epsilon);
+    acc[1] = std::max(acc[1], cell.cell->rhob);
+    acc[2] = std::max(acc[2], cell.temperature);
+}
+
+
+void MaximumEnergyDensity::combine(double *total, const double *part) const {
+    for (int i = 0; i < 3; i++) total[i] = std::max(total[i], part[i]);
+}
+
+
+void MaximumEnergyDensity::finish(const double tau, const double *acc) {
+    const double eps_max  = acc[0]*hbarc;   // GeV/fm^3
+    const double rhob_max = acc[1];
+    const double T_max    = acc[2]*hbarc;   // GeV
+
+    if (eps_max > 1e5) {
+        music_message << "The maximum e = " << eps_max << " < 1e5 GeV/fm^3";
+        music_message.flush("error");
+        music_message.error("This normally should not happen!");
+        music_message.error("Exiting ...");
+        exit(1);
+    }
+    eps_max_  = eps_max;
+    rhob_max_ = rhob_max;
+    T_max_    = T_max;
+    if (!writes_output()) return;
+    music_message << "eps_max = " << eps_max << " GeV/fm^3, "
+                  << "rhob_max = " << rhob_max << " 1/fm^3, "
+                  << "T_max = " << T_max << " GeV.";
+    music_message.flush("info");
+}
+
+
+//! the accumulators are
+//! 0-8: the T^{xx} - T^{yy}, 2 T^{xy} and T^{xx} + T^{yy} sums
+//!      for ideal, ideal + shear and full,
+//! 9-16: the numerators and denominators of <u^tau>, <T>, R_Pi and R_pi,
+//! 17-34: the epsilon_{pn} cos, sin and weight sums,
+//! 35-52: the eccentricity cos, sin and weight sums
+void MomentumAnisotropy::accumulate(const ObservableCell &cell,
+                                    double *acc) const {
+    double *ep_num1   = acc + 17;
+    double *ep_num2   = acc + 23;
+    double *ep_den    = acc + 29;
+    double *eccn_num1 = acc + 35;
+    double *eccn_num2 = acc + 35 + norder;
+    double *eccn_den  = acc + 35 + 2*norder;
+
+    const double x_local   = cell.x - cell.x_o;
+    const double y_local   = cell.y - cell.y_o;
+    const double r_local   = sqrt(x_local*x_local + y_local*y_local);
+    const double phi_local = atan2(y_local, x_local);
+
+    const Cell_small &c     = *cell.cell;
+    const double e_local    = c.epsilon;  // 1/fm^4
+    const double P_local    = cell.pressure;
+    const double enthopy    = e_local + P_local;
+    const double T_local    = cell.temperature;
+    const double u0         = c.u[0];
+    const double ux         = c.u[1];
+    const double uy         = c.u[2];
+    const double pi_0x      = c.Wmunu[1];
+    const double pi_0y      = c.Wmunu[2];
+    const double pi_xx      = c.Wmunu[4];
+    const double pi_xy      = c.Wmunu[5];
+    const double pi_yy      = c.Wmunu[7];
+    const double bulk_Pi    = c.pi_b;
+
+    const double T_0x_ideal  = enthopy*u0*ux;
+    const double T_0y_ideal  = enthopy*u0*uy;
+    const double T_0r_ideal  = sqrt(  T_0x_ideal*T_0x_ideal
+                                    + T_0y_ideal*T_0y_ideal);
+    const double phi_u_ideal = atan2(T_0y_ideal, T_0x_ideal);
+    const double T_xx_ideal  = enthopy*ux*ux + P_local;
+    const double T_xy_ideal  = enthopy*ux*uy;
+    const double T_yy_ideal  = enthopy*uy*uy + P_local;
+
+    const double T_0x_shear  = T_0x_ideal + pi_0x;
+    const double T_0y_shear  = T_0y_ideal + pi_0y;
+    const double T_0r_shear  = sqrt(  T_0x_shear*T_0x_shear
+                                    + T_0y_shear*T_0y_shear);
+    const double phi_u_shear = atan2(T_0y_shear, T_0x_shear);
+    const double T_xx_shear  = T_xx_ideal + pi_xx;
+    const double T_xy_shear  = T_xy_ideal + pi_xy;
+    const double T_yy_shear  = T_yy_ideal + pi_yy;
+
+    const double T_0x_full   = T_0x_shear + bulk_Pi*u0*ux;
+    const double T_0y_full   = T_0y_shear + bulk_Pi*u0*uy;
+    const double T_0r_full   = sqrt(  T_0x_full*T_0x_full
+                                    + T_0y_full*T_0y_full);
+    const double phi_u_full  = atan2(T_0y_full, T_0x_full);
+    const double T_xx_full   = T_xx_shear - bulk_Pi*(-1 - ux*ux);
+    const double T_xy_full   = T_xy_shear + bulk_Pi*ux*uy;
+    const double T_yy_full   = T_yy_shear - bulk_Pi*(-1 - uy*uy);
+
+    acc[0] += T_xx_ideal - T_yy_ideal;
+    acc[1] += 2.*T_xy_ideal;
+    acc[2] += T_xx_ideal + T_yy_ideal;
+    acc[3] += T_xx_shear - T_yy_shear;
+    acc[4] += 2.*T_xy_shear;
+    acc[5] += T_xx_shear + T_yy_shear;
+    acc[6] += T_xx_full - T_yy_full;
+    acc[7] += 2.*T_xy_full;
+    acc[8] += T_xx_full + T_yy_full;
+
+    double weight_local = e_local;
+    acc[9]  += weight_local*u0;
+    acc[10] += weight_local;
+    acc[11] += weight_local*T_local;
+    acc[12] += weight_local;
+
+    if (e_local > 1e-3) {
+        double r_shearpi_tmp, r_bulkPi_tmp;
+        Cell_info::get_inverse_Reynolds_numbers(c, P_local, r_shearpi_tmp,
+                                                r_bulkPi_tmp);
+        acc[15] += weight_local*r_shearpi_tmp;
+        acc[16] += weight_local;
+        acc[13] += weight_local*r_bulkPi_tmp;
+        acc[14] += weight_local;
+    }
+
+    for (int i = 0; i < 2; i++) {
+        int idx = 3*i;
+        int iorder = 2+i;
+        ep_num1[idx]   += T_0r_ideal*cos(iorder*phi_u_ideal);
+        ep_num2[idx]   += T_0r_ideal*sin(iorder*phi_u_ideal);
+        ep_den [idx]   += T_0r_ideal;
+        ep_num1[idx+1] += T_0r_shear*cos(iorder*phi_u_shear);
+        ep_num2[idx+1] += T_0r_shear*sin(iorder*phi_u_shear);
+        ep_den [idx+1] += T_0r_shear;
+        ep_num1[idx+2] += T_0r_full*cos(iorder*phi_u_full);
+        ep_num2[idx+2] += T_0r_full*sin(iorder*phi_u_full);
+        ep_den [idx+2] += T_0r_full;
+    }
+    for (int i = 1; i <= norder; i++) {
+        if (i == 1) {
+            weight_local = u0*e_local*pow(r_local, 3);
+        } else {
+            weight_local = u0*e_local*pow(r_local, i);
+        }
+        eccn_num1[i-1] += weight_local*cos(i*phi_local);
+        eccn_num2[i-1] += weight_local*sin(i*phi_local);
+        eccn_den [i-1] += weight_local;
+    }
+}
+
+
+void MomentumAnisotropy::finish(const double tau, const double *acc) {
+    if (!writes_output()) return;
+    std::fstream of;
+    open_observable_file(
+        of, get_window_filename("momentum_anisotropy_eta_",
+                                eta_min_, eta_max_), DATA, tau,
+        "# tau(fm)  epsilon_p(ideal)(cos)  epsilon_p(ideal)(sin)  "
+        "epsilon_p(shear)(cos)  epsilon_p(shear)(sin)  "
+        "epsilon_p(full)(cos)  epsilon_p(full)(sin)  "
+        "epsilon_2p(ideal)(cos)  epsilon_2p(ideal)(sin)  "
+        "epsilon_2p(shear)(cos)  epsilon_2p(shear)(sin)  "
+        "epsilon_2p(full)(cos)  epsilon_2p(full)(sin)  "
+        "epsilon_3p(ideal)(cos)  epsilon_3p(ideal)(sin)  "
+        "epsilon_3p(shear)(cos)  epsilon_3p(shear)(sin)  "
+        "epsilon_3p(full)(cos)  epsilon_3p(full)(sin)  ");
+    std::fstream of1;
+    open_observable_file(
+        of1, get_window_filename("eccentricities_evo_eta_",
+                                 eta_min_, eta_max_), DATA, tau,
+        "# tau(fm)  ecc_n(cos)  ecc_n(sin) (n=1-6)");
+    std::fstream of2;
+    open_observable_file(
+        of2, get_window_filename("inverse_Reynolds_number_eta_",
+                                 eta_min_, eta_max_), DATA, tau,
+        "# tau(fm)  R_shearpi  R_Pi  gamma  T[GeV]");
+
+    const double *ep_num1   = acc + 17;
+    const double *ep_num2   = acc + 23;
+    const double *ep_den    = acc + 29;
+    const double *eccn_num1 = acc + 35;
+    const double *eccn_num2 = acc + 35 + norder;
+    const double *eccn_den  = acc + 35 + 2*norder;
+
+    double R_shearpi = acc[15]/std::max(acc[16], small_eps);
+    double R_Pi      = acc[13]/std::max(acc[14], small_eps);
+    double u_avg     = acc[9]/std::max(acc[10], small_eps);
+    double T_avg     = acc[11]/std::max(acc[12], small_eps)*hbarc;
+
+    of << scientific << setw(18) << setprecision(8)
+       << tau << "  "
+       << acc[0]/std::max(acc[2], small_eps) << "  "
+       << acc[1]/std::max(acc[2], small_eps) << "  "
+       << acc[3]/std::max(acc[5], small_eps) << "  "
+       << acc[4]/std::max(acc[5], small_eps) << "  "
+       << acc[6]/std::max(acc[8], small_eps) << "  "
+       << acc[7]/std::max(acc[8], small_eps) << "  ";
+    for (int i = 0; i < 6; i++) {
+        of << ep_num1[i]/std::max(ep_den[i], small_eps) << "  "
+           << ep_num2[i]/std::max(ep_den[i], small_eps)<< "  ";
+    }
+    of << endl;
+    of.close();
+
+    of1 << scientific << setw(18) << setprecision(8)
+        << tau << "  ";
+    for (int i = 0; i < norder; i++) {
+        // the minus sign ensure the vector points to the short axis
+        of1 << -eccn_num1[i]/std::max(eccn_den[i], small_eps) << "  "
+            << -eccn_num2[i]/std::max(eccn_den[i], small_eps)<< "  ";
+    }
+    of1 << endl;
+    of1.close();
+
+    of2 << scientific << setw(18) << setprecision(8)
+        << tau << "  " << R_shearpi << "  " << R_Pi << "  "
+        << u_avg << "  " << T_avg << endl;
+    of2.close();
+}
+
+
+std::vector<std::string> MomentumAnisotropy::get_output_filenames() const {
+    std::vector<std::string> filenames;
+    filenames.push_back(get_window_filename("momentum_anisotropy_eta_",
+                                            eta_min_, eta_max_));
+    filenames.push_back(get_window_filename("eccentricities_evo_eta_",
+                                            eta_min_, eta_max_));
+    filenames.push_back(get_window_filename("inverse_Reynolds_number_eta_",
+                                            eta_min_, eta_max_));
+    return(filenames);
+}
+
+
+void PhaseDiagramTrajectory::accumulate(const ObservableCell &cell,
+                                        double *acc) const {
+    const double e_local      = cell.cell->epsilon;  // 1/fm^4
+    if (e_local > 0.16/hbarc)
+        acc[5] += cell.eta_weight;
+    const double utau         = cell.cell->u[0];
+    const double ueta         = cell.cell->u[3];
+    const double ut           = utau*cell.cosh_eta + ueta*cell.sinh_eta;
+    const double T_local      = cell.temperature;
+    const double muB_local    = cell.muB;
+    const double weight_local = e_local*ut;
+    acc[0] += T_local*weight_local;
+    acc[1] += muB_local*weight_local;
+    acc[2] += T_local*T_local*weight_local;
+    acc[3] += muB_local*muB_local*weight_local;
+    acc[4] += weight_local;
+}
+
+
+void PhaseDiagramTrajectory::finish(const double tau, const double *acc) {
+    if (!writes_output()) return;
+    std::fstream of;
+    open_observable_file(
+        of, get_window_filename("averaged_phase_diagram_trajectory_eta_",
+                                eta_min_, eta_max_), DATA, tau,
+        "# tau(fm)  <T>(GeV)  std(T)(GeV)  <mu_B>(GeV)  std(mu_B)(GeV)  "
+        "V4 (fm^4)");
+    const double unit_volume = tau*DATA.delta_x*DATA.delta_y*DATA.delta_eta;
+    const double weight = std::max(acc[4], small_eps);
+    const double avg_T  = acc[0]/weight*hbarc;
+    const double avg_mu = acc[1]/weight*hbarc;
+    const double std_T  = sqrt(acc[2]/weight*hbarc*hbarc - avg_T*avg_T);
+    const double std_mu = sqrt(acc[3]/weight*hbarc*hbarc - avg_mu*avg_mu);
+    const double V4     = acc[5]*unit_volume;
+    of << scientific << setw(18) << setprecision(8)
+       << tau << "  " << avg_T << "  " << std_T << "  "
+       << avg_mu << "  " << std_mu << "  " << V4 << endl;
+    of.close();
+}
+
+
+std::vector<std::string>
+        PhaseDiagramTrajectory::get_output_filenames() const {
+    return(std::vector<std::string>(1, get_window_filename(
+        "averaged_phase_diagram_trajectory_eta_", eta_min_, eta_max_)));
+}
+
+
+//! the accumulators are N_B, T^{tau t}, T^{tau x}, T^{tau y}, T^{tau z}
+//! of all the cells and of the cells on the edge of the grid
+void ConservationLaws::accumulate(const ObservableCell &cell,
+                                  double *acc) const {
+    const Cell_small &c      = *cell.cell;
+    const Cell_small &c_prev = *cell.cell_prev;
+    const double cosh_eta  = cell.cosh_eta;
+    const double sinh_eta  = cell.sinh_eta;
+    const double e_local   = c.epsilon;
+    const double pressure  = cell.pressure;
+    const double u0        = c.u[0];
+    const double u1        = c.u[1];
+    const double u2        = c.u[2];
+    const double u3        = c.u[3];
+    const double T00_local = (e_local + pressure)*u0*u0 - pressure;
+    const double Pi00_rk_0 = (c_prev.pi_b*(-1.0 + c_prev.u[0]*c_prev.u[0]));
+
+    const double T_tau_tau = (T00_local + c_prev.Wmunu[0] + Pi00_rk_0);
+    const double T01_local = ((e_local + pressure)*u0*u1 + c_prev.Wmunu[1]
+                              + c_prev.pi_b*c_prev.u[0]*c_prev.u[1]);
+    const double T02_local = ((e_local + pressure)*u0*u2 + c_prev.Wmunu[2]
+                              + c_prev.pi_b*c_prev.u[0]*c_prev.u[2]);
+    const double T_tau_eta = ((e_local + pressure)*u0*u3 + c_prev.Wmunu[3]
+                              + c_prev.pi_b*c_prev.u[0]*c_prev.u[3]);
+    const double N_B     = c.rhob*c.u[0] + c_prev.Wmunu[10];
+    const double T_tau_t = T_tau_tau*cosh_eta + T_tau_eta*sinh_eta;
+    const double T_tau_z = T_tau_tau*sinh_eta + T_tau_eta*cosh_eta;
+    const double w = cell.eta_weight;
+    acc[0] += N_B*w;
+    acc[1] += T_tau_t*w;
+    acc[2] += T01_local*w;
+    acc[3] += T02_local*w;
+    acc[4] += T_tau_z*w;
+
+    // the energy-momentum vector on the edge
+    if (cell.ieta == 0 || cell.ieta == neta_ - 1 || cell.ix == 0
+        || cell.ix == DATA.nx - 1 || cell.iy == 0
+        || cell.iy == DATA.ny - 1) {
+        acc[5] += N_B*w;
+        acc[6] += T_tau_t*w;
+        acc[7] += T01_local*w;
+        acc[8] += T02_local*w;
+        acc[9] += T_tau_z*w;
+    }
+}
+
+
+void ConservationLaws::finish(const double tau, const double *acc) {
+    // add units
+    const double factor = tau*DATA.delta_x*DATA.delta_y*DATA.delta_eta;
+    double N_B          = acc[0]*factor;
+    double T_tau_t      = acc[1]*factor*hbarc;  // GeV
+    double T_tau_x      = acc[2]*factor*hbarc;  // GeV
+    double T_tau_y      = acc[3]*factor*hbarc;  // GeV
+    double T_tau_z      = acc[4]*factor*hbarc;  // GeV
+    const double N_B_edge     = acc[5]*factor;
+    const double T_tau_t_edge = acc[6]*factor*hbarc;  // GeV
+    const double T_tau_x_edge = acc[7]*factor*hbarc;  // GeV
+    const double T_tau_y_edge = acc[8]*factor*hbarc;  // GeV
+    const double T_tau_z_edge = acc[9]*factor*hbarc;  // GeV
+
+    // compute the outflow flux
+    if (tau > DATA.tau0) {
+        outflow_flux[0] += T_tau_t_edge - Pmu_edge_prev[0];
+        outflow_flux[1] += T_tau_x_edge - Pmu_edge_prev[1];
+        outflow_flux[2] += T_tau_y_edge - Pmu_edge_prev[2];
+        outflow_flux[3] += T_tau_z_edge - Pmu_edge_prev[3];
+        outflow_flux[4] += N_B_edge - Pmu_edge_prev[4];
+
+        N_B     += outflow_flux[4];
+        T_tau_t += outflow_flux[0];  // GeV
+        T_tau_x += outflow_flux[1];  // GeV
+        T_tau_y += outflow_flux[2];  // GeV
+        T_tau_z += outflow_flux[3];  // GeV
+    }
+    Pmu_edge_prev[0] = T_tau_t_edge;
+    Pmu_edge_prev[1] = T_tau_x_edge;
+    Pmu_edge_prev[2] = T_tau_y_edge;
+    Pmu_edge_prev[3] = T_tau_z_edge;
+    Pmu_edge_prev[4] = N_B_edge;
+
+    // output results
+    if (!writes_output()) return;
+    std::fstream output_file;
+    open_observable_file(output_file, "global_conservation_laws.dat", DATA,
+                         tau, "# tau(fm)  E(GeV)  Px(GeV)  Py(GeV)  "
+                              "Pz(GeV)  N_B ");
+    music_message << "total energy T^{taut} = " << T_tau_t << " GeV";
+    music_message.flush("info");
+    music_message << "net longitudinal momentum Pz = " << T_tau_z << " GeV";
+    music_message.flush("info");
+    music_message << "net baryon number N_B = " << N_B;
+    if (N_B > 0. || N_B < 500.) {
+        music_message.flush("info");
+    } else {
+        music_message.flush("error");
+        exit(1);
+    }
+    output_file << scientific << setprecision(6)
+                << tau << "  " << T_tau_t << "  " << T_tau_x << "  "
+                << T_tau_y << "  " << T_tau_z << "  " << N_B << std::endl;
+    output_file.close();
+}
+
+
+void ConservationLaws::write_checkpoint(CheckpointWriter &checkpoint) const {
+    checkpoint.add(Pmu_edge_prev);
+    checkpoint.add(outflow_flux);
+}
+
+
+void ConservationLaws::read_checkpoint(CheckpointReader &checkpoint) {
+    checkpoint.get(Pmu_edge_prev);
+    checkpoint.get(outflow_flux);
+}
+
+
+void AngularMomentum::accumulate(const ObservableCell &cell,
+                                 double *acc) const {
+    const Cell_small &c      = *cell.cell;
+    const Cell_small &c_prev = *cell.cell_prev;
+    const double cosh_eta = cell.cosh_eta;
+    const double sinh_eta = cell.sinh_eta;
+    const double t_local  = cell.tau*cosh_eta;
+    const double x_local  = DATA.x_size/2. + cell.ix*DATA.delta_x;
+    const double y_local  = DATA.x_size/2. + cell.iy*DATA.delta_y;
+    const double z_local  = cell.tau*sinh_eta;
+
+    const double e_local   = c.epsilon;
+    const double pressure  = cell.pressure;
+    const double u0        = c.u[0];
+    const double u1        = c.u[1];
+    const double u2        = c.u[2];
+    const double u3        = c.u[3];
+
+    const double T00_local = (e_local + pressure)*u0*u0 - pressure;
+    const double Pi00_rk_0 = (c_prev.pi_b*(-1.0 + c_prev.u[0]*c_prev.u[0]));
+
+    const double T_tau_tau = (T00_local + c_prev.Wmunu[0] + Pi00_rk_0);
+    const double T_tau_x   = ((e_local + pressure)*u0*u1 + c_prev.Wmunu[1]
+                              + c_prev.pi_b*c_prev.u[0]*c_prev.u[1]);
+    const double T_tau_y   = ((e_local + pressure)*u0*u2 + c_prev.Wmunu[2]
+                              + c_prev.pi_b*c_prev.u[0]*c_prev.u[2]);
+    const double T_tau_eta = ((e_local + pressure)*u0*u3 + c_prev.Wmunu[3]
+                              + c_prev.pi_b*c_prev.u[0]*c_prev.u[3]);
+    const double T_tau_t = T_tau_tau*cosh_eta + T_tau_eta*sinh_eta;
+    const double T_tau_z = T_tau_tau*sinh_eta + T_tau_eta*cosh_eta;
+
+    const double w = cell.eta_weight;
+    acc[0] += (y_local*T_tau_z - z_local*T_tau_y)*w;
+    acc[1] += (z_local*T_tau_x - x_local*T_tau_z)*w;
+    acc[2] += (x_local*T_tau_y - y_local*T_tau_x)*w;
+    acc[3] += (t_local*T_tau_x - x_local*T_tau_t)*w;
+    acc[4] += (t_local*T_tau_y - y_local*T_tau_t)*w;
+    acc[5] += (t_local*T_tau_z - z_local*T_tau_t)*w;
+}
+
+
+void AngularMomentum::finish(const double tau, const double *acc) {
+    if (!writes_output()) return;
+    std::fstream output_file;
+    open_observable_file(
+        output_file, get_window_filename("global_angular_momentum_eta_",
+                                         eta_min_, eta_max_), DATA, tau,
+        "# tau[fm]  Lx[hbarc]  Ly[hbarc]  Lz[hbarc]  "
+        "L^{tx}[hbarc]  L^{ty}[hbarc]  L^{tz}[hbarc]");
+    // add units
+    const double factor = tau*DATA.delta_x*DATA.delta_y*DATA.delta_eta;
+    output_file << scientific << setprecision(6) << tau;
+    for (int i = 0; i < 6; i++) output_file << "  " << acc[i]*factor;
+    output_file << std::endl;
+    output_file.close();
+}
+
+
+std::vector<std::string> AngularMomentum::get_output_filenames() const {
+    return(std::vector<std::string>(1, get_window_filename(
+        "global_angular_momentum_eta_", eta_min_, eta_max_)));
+}
+
+
+//! the accumulators are the weighted sums of omega_kSP/T, omega_k/T,
+//! omega_th and omega_T/T^2, and the weight
+void VorticityEvolution::accumulate(const ObservableCell &cell,
+                                    double *acc) const {
+    const double e_local = cell.cell->epsilon;
+    const double T_local = cell.temperature;
+    const Cell_aux omega_local = (
+        u_derivative_helper.transform_vorticity_to_tz(*cell.vorticity,
+                                                      cell.eta_s));
+    for (unsigned int ii = 0; ii < omega_local.omega_k.size(); ii++) {
+        acc[ii]      += e_local*omega_local.omega_kSP[ii]/T_local;
+        acc[6 + ii]  += e_local*omega_local.omega_k[ii]/T_local;
+        acc[12 + ii] += e_local*omega_local.omega_th[ii];
+        acc[18 + ii] += e_local*omega_local.omega_T[ii]/T_local/T_local;
+    }
+    acc[24] += e_local;
+}
+
+
+void VorticityEvolution::finish(const double tau, const double *acc) {
+    if (!writes_output()) return;
+    const std::string header_1 = ("# tau[fm]  omega^{tx}/T  omega^{ty}/T  "
+                                  "omega^{tz}/T  omega^{xy}/T  "
+                                  "omega^{xz}/T  omega^{yz}/T");
+    std::fstream of1, of2, of3, of4;
+    open_observable_file(
+        of1, get_window_filename("vorticity_evo_kinetic_wSP_eta_",
+                                 eta_min_, eta_max_), DATA, tau, header_1);
+    open_observable_file(
+        of2, get_window_filename("vorticity_evo_kinetic_eta_",
+                                 eta_min_, eta_max_), DATA, tau, header_1);
+    open_observable_file(
+        of3, get_window_filename("vorticity_evo_thermal_eta_",
+                                 eta_min_, eta_max_), DATA, tau,
+        "# tau[fm]  omega^{tx}  omega^{ty}  omega^{tz}  omega^{xy}  "
+        "omega^{xz}  omega^{yz}");
+    open_observable_file(
+        of4, get_window_filename("vorticity_evo_T_eta_",
+                                 eta_min_, eta_max_), DATA, tau,
+        "# tau[fm]  omega^{tx}/T^2  omega^{ty}/T^2  omega^{tz}/T^2  "
+        "omega^{xy}/T^2  omega^{xz}/T^2  omega^{yz}/T^2");
+
+    const double weight = std::max(acc[24], small_eps);
+    of1 << scientific << setw(18) << setprecision(8) << tau << "  ";
+    of2 << scientific << setw(18) << setprecision(8) << tau << "  ";
+    of3 << scientific << setw(18) << setprecision(8) << tau << "  ";
+    of4 << scientific << setw(18) << setprecision(8) << tau << "  ";
+    for (int ii = 0; ii < 6; ii++) {
+        // no minus sign because it has opposite sign to the kinetic vorcitity
+        of1 << scientific << setprecision(8) << setw(18)
+            << acc[ii]/weight << "  ";
+        // minus sign from the metric
+        // output quantities in g = (1, -1, -1 , -1)
+        of2 << scientific << setprecision(8) << setw(18)
+            << -acc[6 + ii]/weight << "  ";
+        of3 << scientific << setprecision(8) << setw(18)
+            << -acc[12 + ii]/weight << "  ";
+        of4 << scientific << setprecision(8) << setw(18)
+            << -acc[18 + ii]/weight << "  ";
+    }
+    of1 << std::endl;
+    of2 << std::endl;
+    of3 << std::endl;
+    of4 << std::endl;
+    of1.close();
+    of2.close();
+    of3.close();
+    of4.close();
+}
+
+
+std::vector<std::string> VorticityEvolution::get_output_filenames() const {
+    std::vector<std::string> filenames;
+    filenames.push_back(get_window_filename("vorticity_evo_kinetic_wSP_eta_",
+                                            eta_min_, eta_max_));
+    filenames.push_back(get_window_filename("vorticity_evo_kinetic_eta_",
+                                            eta_min_, eta_max_));
+    filenames.push_back(get_window_filename("vorticity_evo_thermal_eta_",
+                                            eta_min_, eta_max_));
+    filenames.push_back(get_window_filename("vorticity_evo_T_eta_",
+                                            eta_min_, eta_max_));
+    return(filenames);
+}
@@ -0,0 +1,311 @@
+#ifndef SRC_EVOLUTION_OBSERVABLES_H_
+#define SRC_EVOLUTION_OBSERVABLES_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "data.h"
+#include "cell.h"
+#include "grid.h"
+#include "eos.h"
+#include "active_region.h"
+#include "domain_decomposition.h"
+#include "eta_grid.h"
+#include "u_derivative.h"
+#include "checkpoint.h"
+#include "deterministic_sum.h"
+#include "pretty_ostream.h"
+
+//! the fluid cell handed to the observables in the fused pass, with the
+//! EOS quantities the observables containing it asked for
+struct ObservableCell {
+    double tau;
+    //! ieta is the global eta index in the distributed runs
+    int ix, iy, ieta;
+    //! eta_s is 0 for the boost-invariant runs
+    double x, y, eta_s;
+    double cosh_eta, sinh_eta;
+    //! the width of the eta cell over delta_eta, the weight of the cell
+    //! in the volume integrals (1 on the uniform grid)
+    double eta_weight;
+    const Cell_small *cell;
+    //! the previous time step, with Observable::kPrevGrid
+    const Cell_small *cell_prev;
+    //! the vorticity tensors in the tau-eta frame, with Observable::kVorticity
+    const Cell_aux *vorticity;
+    //! with Observable::kSliceCentroid, the epsilon*u^tau weighted
+    //! centroid of the eta_s slice of the cell
+    double x_o, y_o;
+    bool active;
+    //! only set if an observable containing the cell asked for them
+    double pressure, temperature, muB;
+};
+
+
+//! This is the base class of the analysis observables of the evolution,
+//! reductions over the fluid cells of the current time step. The
+//! observables are evaluated together by EvolutionObservables, which visits
+//! every cell once: an observable adds a cell to its accumulators, and
+//! writes out the totals at the end of the pass.
+class Observable {
+ public:
+    //! the fields of ObservableCell an observable uses
+    enum Field {
+        kPressure      = 1,
+        kTemperature   = 2,
+        kMuB           = 4,
+        kPrevGrid      = 8,
+        kVorticity     = 16,
+        kSliceCentroid = 32,
+    };
+
+    //! the observable is evaluated every n_steps time steps
+    explicit Observable(const int n_steps = 1) : n_steps_(n_steps) {}
+    virtual ~Observable() {}
+
+    bool is_due(const int it) const {return(it % n_steps_ == 0);}
+
+    //! an OR of Field
+    virtual int get_fields() const = 0;
+    virtual int get_number_of_accumulators() const = 0;
+
+    //! returns true if the observable only contains active cells, the pass
+    //! then skips the cells outside the active region
+    virtual bool is_active_region_only() const {return(false);}
+
+    //! returns true if the cell is summed. The EOS quantities of the cell
+    //! are not set yet.
+    virtual bool contains(const ObservableCell &cell) const = 0;
+
+    //! adds a contained cell to the accumulators, which start at 0
+    virtual void accumulate(const ObservableCell &cell, double *acc) const = 0;
+
+    //! merges the accumulators of a part of the grid into the total,
+    //! the default adds them
+    virtual void combine(double *total, const double *part) const;
+
+    //! writes out the totals of the pass at tau
+    virtual void finish(const double tau, const double *acc) = 0;
+
+    //! the files finish appends to, which a checkpoint records the sizes of
+    virtual std::vector<std::string> get_output_filenames() const {
+        return(std::vector<std::string>());
+    }
+
+    //! the results an observable carries from one time step to the next
+    virtual void write_checkpoint(CheckpointWriter &checkpoint) const {}
+    virtual void read_checkpoint(CheckpointReader &checkpoint) {}
+
+    //! only MPI rank 0 writes the output of finish, the other ranks just
+    //! update the results of the observable
+    void set_write_output(const bool write_output) {
+        write_output_ = write_output;
+    }
+    bool writes_output() const {return(write_output_);}
+
+ private:
+    const int n_steps_;
+    bool write_output_ = true;
+};
+
+
+//! This class evaluates the registered observables which are due at a time
+//! step in one parallel pass over the grid. The EOS quantities of a cell
+//! are computed once for all the observables containing it. The grid is
+//! split into rows (fixed ieta and iy) which are summed in parallel and
+//! merged in the fixed tree of DeterministicSum::tree_combine, so the
+//! results do not depend on the number of threads.
+//! In a distributed run, the totals of the slabs are merged in the order of
+//! the ranks.
+class EvolutionObservables {
+ private:
+    const InitData &DATA;
+    const EOS &eos;
+    const EtaGrid eta_grid_;
+    std::shared_ptr<const DomainDecomposition> domain_ptr_;
+    std::vector<std::unique_ptr<Observable>> observables_;
+    std::vector<double> row_accumulators_;
+    std::vector<double> slice_centroids_;
+
+    void compute_slice_centroids(const SCGrid &arena);
+
+ public:
+    EvolutionObservables(const InitData &DATA_in, const EOS &eos_in);
+
+    //! registers an observable and returns it
+    Observable *add(std::unique_ptr<Observable> observable);
+
+    bool empty() const {return(observables_.empty());}
+
+    //! set the slabs of a distributed run, the grids of evaluate are then
+    //! the local grids of the rank
+    void set_domain_decomposition(
+            std::shared_ptr<const DomainDecomposition> domain_ptr_in) {
+        domain_ptr_ = domain_ptr_in;
+    }
+
+    //! evaluates the observables due at time step it. arena_prev and
+    //! vorticity may be null if no observable needs them.
+    void evaluate(const int it, const double tau, const SCGrid &arena,
+                  const SCGrid *arena_prev, const VorticityGrid *vorticity,
+                  const ActiveRegion &active_region);
+
+    //! the output files of the observables written by this rank
+    std::vector<std::string> get_output_filenames() const;
+    void write_checkpoint(CheckpointWriter &checkpoint) const;
+    void read_checkpoint(CheckpointReader &checkpoint);
+};
+
+
+//! the maximum energy density, net baryon density and temperature of the
+//! active region, printed to the screen
+class MaximumEnergyDensity : public Observable {
+ private:
+    pretty_ostream music_message;
+    double eps_max_ = 0., rhob_max_ = 0., T_max_ = 0.;
+
+ public:
+    int get_fields() const {return(kTemperature);}
+    int get_number_of_accumulators() const {return(3);}
+    bool is_active_region_only() const {return(true);}
+    bool contains(const ObservableCell &cell) const {return(cell.active);}
+    void accumulate(const ObservableCell &cell, double *acc) const;
+    void combine(double *total, const double *part) const;
+    void finish(const double tau, const double *acc);
+
+    //! the results of the last evaluation [GeV/fm^3, 1/fm^3, GeV]
+    double get_eps_max()  const {return(eps_max_);}
+    double get_rhob_max() const {return(rhob_max_);}
+    double get_T_max()    const {return(T_max_);}
+};
+
+
+//! the momentum anisotropy, the eccentricities and the inverse Reynolds
+//! numbers of the cells with eta_min < eta_s < eta_max
+class MomentumAnisotropy : public Observable {
+ private:
+    const InitData &DATA;
+    const double eta_min_, eta_max_;
+    static const int norder = 6;
+
+ public:
+    MomentumAnisotropy(const InitData &DATA_in, const double eta_min,
+                       const double eta_max, const int n_steps = 1)
+        : Observable(n_steps), DATA(DATA_in),
+          eta_min_(eta_min), eta_max_(eta_max) {}
+    int get_fields() const {
+        return(kPressure | kTemperature | kSliceCentroid);
+    }
+    int get_number_of_accumulators() const {return(17 + 3*6 + 3*norder);}
+    bool contains(const ObservableCell &cell) const {
+        return(cell.eta_s < eta_max_ && cell.eta_s > eta_min_);
+    }
+    void accumulate(const ObservableCell &cell, double *acc) const;
+    void finish(const double tau, const double *acc);
+    std::vector<std::string> get_output_filenames() const;
+};
+
+
+//! the energy weighted averages of T and mu_B of the cells with
+//! eta_min < eta_s < eta_max
+class PhaseDiagramTrajectory : public Observable {
+ private:
+    const InitData &DATA;
+    const double eta_min_, eta_max_;
+
+ public:
+    PhaseDiagramTrajectory(const InitData &DATA_in, const double eta_min,
+                           const double eta_max, const int n_steps = 1)
+        : Observable(n_steps), DATA(DATA_in),
+          eta_min_(eta_min), eta_max_(eta_max) {}
+    int get_fields() const {return(kTemperature | kMuB);}
+    int get_number_of_accumulators() const {return(6);}
+    bool contains(const ObservableCell &cell) const {
+        return(cell.eta_s < eta_max_ && cell.eta_s > eta_min_);
+    }
+    void accumulate(const ObservableCell &cell, double *acc) const;
+    void finish(const double tau, const double *acc);
+    std::vector<std::string> get_output_filenames() const;
+};
+
+
+//! the total energy, momentum and net baryon number of the active region,
+//! corrected by the flux through the edges of the grid
+class ConservationLaws : public Observable {
+ private:
+    const InitData &DATA;
+    pretty_ostream music_message;
+    int neta_;
+    TJbVec Pmu_edge_prev = {0.};
+    TJbVec outflow_flux = {0.};
+
+ public:
+    //! the edges in x and y are the ones of the DATA.nx*DATA.ny plane,
+    //! which shrinks when the transverse plane is coarsened
+    ConservationLaws(const InitData &DATA_in, const int neta,
+                     const int n_steps = 1)
+        : Observable(n_steps), DATA(DATA_in), neta_(neta) {}
+    int get_fields() const {return(kPressure | kPrevGrid);}
+    int get_number_of_accumulators() const {return(10);}
+    bool is_active_region_only() const {return(true);}
+    bool contains(const ObservableCell &cell) const {return(cell.active);}
+    void accumulate(const ObservableCell &cell, double *acc) const;
+    void finish(const double tau, const double *acc);
+    std::vector<std::string> get_output_filenames() const {
+        return(std::vector<std::string>(1, "global_conservation_laws.dat"));
+    }
+    void write_checkpoint(CheckpointWriter &checkpoint) const;
+    void read_checkpoint(CheckpointReader &checkpoint);
+};
+
+
+//! the global angular momentum of the cells with eta_min < eta_s < eta_max
+class AngularMomentum : public Observable {
+ private:
+    const InitData &DATA;
+    const double eta_min_, eta_max_;
+
+ public:
+    AngularMomentum(const InitData &DATA_in, const double eta_min,
+                    const double eta_max, const int n_steps = 1)
+        : Observable(n_steps), DATA(DATA_in),
+          eta_min_(eta_min), eta_max_(eta_max) {}
+    int get_fields() const {return(kPressure | kPrevGrid);}
+    int get_number_of_accumulators() const {return(6);}
+    bool contains(const ObservableCell &cell) const {
+        return(cell.eta_s < eta_max_ && cell.eta_s > eta_min_);
+    }
+    void accumulate(const ObservableCell &cell, double *acc) const;
+    void finish(const double tau, const double *acc);
+    std::vector<std::string> get_output_filenames() const;
+};
+
+
+//! the energy weighted averages of the vorticity tensors of the cells with
+//! eta_min < eta_s < eta_max and epsilon >= 0.1 fm^-4
+class VorticityEvolution : public Observable {
+ private:
+    const InitData &DATA;
+    const double eta_min_, eta_max_;
+    //! transform_vorticity_to_tz does not touch the members of the helper
+    mutable U_derivative u_derivative_helper;
+
+ public:
+    VorticityEvolution(const InitData &DATA_in, const EOS &eos_in,
+                       const double eta_min, const double eta_max,
+                       const int n_steps = 1)
+        : Observable(n_steps), DATA(DATA_in),
+          eta_min_(eta_min), eta_max_(eta_max),
+          u_derivative_helper(DATA_in, eos_in) {}
+    int get_fields() const {return(kTemperature | kVorticity);}
+    int get_number_of_accumulators() const {return(4*6 + 1);}
+    bool contains(const ObservableCell &cell) const {
+        return(   cell.eta_s < eta_max_ && cell.eta_s > eta_min_
+               && cell.cell->epsilon >= 0.1);
+    }
+    void accumulate(const ObservableCell &cell, double *acc) const;
+    void finish(const double tau, const double *acc);
+    std::vector<std::string> get_output_filenames() const;
+};
+
+#endif  // SRC_EVOLUTION_OBSERVABLES_H_
@@ -0,0 +1,92 @@
+#include "doctest.h"
+#include "evolution_observables.h"
+#include "util.h"
+#include <cmath>
+
+namespace {
+    //! sums epsilon*P and counts the cells with eta_s > 0
+    class TestObservable : public Observable {
+     public:
+        int n_finish = 0;
+        double sum = 0., count = 0.;
+
+        explicit TestObservable(const int n_steps) : Observable(n_steps) {}
+        int get_fields() const {return(kPressure);}
+        int get_number_of_accumulators() const {return(2);}
+        bool contains(const ObservableCell &cell) const {
+            return(cell.eta_s > 0.);
+        }
+        void accumulate(const ObservableCell &cell, double *acc) const {
+            acc[0] += cell.cell->epsilon*cell.pressure;
+            acc[1] += 1.;
+        }
+        void finish(const double tau, const double *acc) {
+            n_finish++;
+            sum = acc[0];
+            count = acc[1];
+        }
+    };
+}
+
+TEST_CASE("Check EvolutionObservables evaluates the due observables") {
+    InitData DATA;
+    DATA.x_size = 4.;
+    DATA.y_size = 4.;
+    DATA.eta_size = 2.;
+    DATA.delta_x = 0.5;
+    DATA.delta_y = 0.5;
+    DATA.delta_eta = 0.5;
+    DATA.boost_invariant = false;
+    EOS eos_ideal(0);
+
+    const int nx = 9, ny = 9, neta = 5;
+    SCGrid arena(nx, ny, neta);
+    for (int ieta = 0; ieta < neta; ieta++)
+    for (int iy = 0; iy < ny; iy++)
+    for (int ix = 0; ix < nx; ix++) {
+        arena(ix, iy, ieta).epsilon = 0.1*(ix + 2*iy + 3*ieta) + 0.01;
+        arena(ix, iy, ieta).u[0] = 1.;
+    }
+    ActiveRegion active_region(nx, ny, neta);
+
+    EvolutionObservables observables(DATA, eos_ideal);
+    auto *every_step = static_cast<TestObservable*>(observables.add(
+                std::unique_ptr<Observable>(new TestObservable(1))));
+    auto *every_2_steps = static_cast<TestObservable*>(observables.add(
+                std::unique_ptr<Observable>(new TestObservable(2))));
+    auto *eps_max = new MaximumEnergyDensity();
+    observables.add(std::unique_ptr<Observable>(eps_max));
+
+    double sum = 0., count = 0., e_max = 0.;
+    for (int ieta = 3; ieta < neta; ieta++)
+    for (int iy = 0; iy < ny; iy++)
+    for (int ix = 0; ix < nx; ix++) {
+        const double e = arena(ix, iy, ieta).epsilon;
+        sum += e*eos_ideal.get_pressure(e, 0.);
+        count += 1.;
+    }
+    for (int i = 0; i < arena.size(); i++) {
+        e_max = std::max(e_max, arena(i).epsilon);
+    }
+
+    observables.evaluate(3, 0.6, arena, nullptr, nullptr, active_region);
+    CHECK(every_step->n_finish == 1);
+    CHECK(every_2_steps->n_finish == 0);
+    CHECK(every_step->count == count);
+    CHECK(every_step->sum == doctest::Approx(sum).epsilon(1e-14));
+    CHECK(eps_max->get_eps_max() == doctest::Approx(e_max*Util::hbarc));
+
+    observables.evaluate(4, 0.6, arena, nullptr, nullptr, active_region);
+    CHECK(every_step->n_finish == 2);
+    CHECK(every_2_steps->n_finish == 1);
+    CHECK(every_2_steps->sum == every_step->sum);
+
+    // the maximum is only over the active region
+    for (int i = 0; i < arena.size(); i++) arena(i).epsilon = 0.01;
+    arena(4, 4, 2).epsilon = 1.;
+    active_region.update(arena, 0.5, 1);
+    arena(0, 0, 0).epsilon = 100.;
+    REQUIRE(!active_region.is_active(0, 0, 0));
+    observables.evaluate(5, 0.6, arena, nullptr, nullptr, active_region);
+    CHECK(eps_max->get_eps_max() == doctest::Approx(Util::hbarc));
+}
@@ -0,0 +1,95 @@
+#include <algorithm>
+#include "evolution_output.h"
+
+EvolutionOutputWriter::EvolutionOutputWriter(const int n_buffers) :
+    n_buffers_(n_buffers), writing_(false), stop_(false), buffer_bytes_(0),
+    memory_(MemorySubsystem::evolution_output) {
+    // the synchronous writer keeps one buffer to reuse
+    const int n_pool = n_buffers_ > 0 ? n_buffers_ : 1;
+    for (int i = 0; i < n_pool; i++) {
+        free_buffers_.emplace_back(new EvolutionSnapshot);
+    }
+    if (n_buffers_ > 0) {
+        writer_ = std::thread(&EvolutionOutputWriter::run_writer, this);
+    }
+}
+
+
+EvolutionOutputWriter::~EvolutionOutputWriter() {
+    if (writer_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        snapshot_submitted_.notify_one();
+        writer_.join();
+    }
+}
+
+
+std::unique_ptr<EvolutionSnapshot> EvolutionOutputWriter::get_buffer() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    buffer_returned_.wait(lock, [this] {return(!free_buffers_.empty());});
+    std::unique_ptr<EvolutionSnapshot> buffer = std::move(
+                                                    free_buffers_.back());
+    free_buffers_.pop_back();
+    return(buffer);
+}
+
+
+void EvolutionOutputWriter::submit(std::unique_ptr<EvolutionSnapshot> snapshot,
+                                   WriteFunction write) {
+    if (n_buffers_ == 0) {
+        write(*snapshot);
+        std::lock_guard<std::mutex> lock(mutex_);
+        return_buffer(std::move(snapshot));
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.emplace_back(std::move(snapshot), std::move(write));
+    }
+    snapshot_submitted_.notify_one();
+}
+
+
+void EvolutionOutputWriter::flush() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    buffer_returned_.wait(lock, [this] {
+        return(queue_.empty() && !writing_);
+    });
+}
+
+
+void EvolutionOutputWriter::run_writer() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        snapshot_submitted_.wait(lock, [this] {
+            return(stop_ || !queue_.empty());
+        });
+        if (queue_.empty()) break;  // stop_ with everything written
+        auto job = std::move(queue_.front());
+        queue_.pop_front();
+        writing_ = true;
+        lock.unlock();
+        job.second(*job.first);
+        lock.lock();
+        writing_ = false;
+        return_buffer(std::move(job.first));
+        buffer_returned_.notify_all();
+    }
+}
+
+
+void EvolutionOutputWriter::return_buffer(
+                            std::unique_ptr<EvolutionSnapshot> buffer) {
+    const int64_t bytes = static_cast<int64_t>(
+                buffer->cells.capacity()*sizeof(Cell_small)
+                + buffer->vorticity.capacity()*sizeof(Cell_aux)
+                + buffer->points.capacity()*sizeof(uint32_t));
+    if (bytes > buffer_bytes_) {
+        buffer_bytes_ = bytes;
+        memory_.set(buffer_bytes_*std::max(1, n_buffers_));
+    }
+    free_buffers_.push_back(std::move(buffer));
+}
@@ -0,0 +1,93 @@
+#ifndef SRC_EVOLUTION_OUTPUT_H_
+#define SRC_EVOLUTION_OUTPUT_H_
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "cell.h"
+#include "memory_accounting.h"
+
+//! the cells of one evolution output, copied from the grid at the output
+//! points (every output_evolution_every_N_{x,y,eta} cell) in the order of
+//! the output loops, ieta outermost and ix innermost
+struct EvolutionSnapshot {
+    double tau = 0.;
+    //! size of the hydro grid
+    int nx = 0;
+    int ny = 0;
+    int neta = 0;
+    std::vector<Cell_small> cells;
+    //! the vorticity tensors in the tau-eta frame, for the outputs with
+    //! vorticity only
+    std::vector<Cell_aux> vorticity;
+    //! the output point of each cell (ix innermost, ieta outermost) for
+    //! the sparse outputs, which copy only the cells above the cut, empty
+    //! if the cells are all the output points
+    std::vector<uint32_t> points;
+};
+
+
+//! This class writes the hydro evolution outputs on a writer thread. The
+//! main thread copies the output cells of a time step into a snapshot
+//! from a pool of n_buffers buffers and hands it to the writer, which
+//! evaluates the EOS, formats the records, and writes the files while the
+//! evolution goes on. When all buffers are in use, get_buffer() waits for
+//! the writer to return one. With n_buffers = 0 the outputs are written on
+//! the calling thread in submit().
+class EvolutionOutputWriter {
+ public:
+    typedef std::function<void(const EvolutionSnapshot&)> WriteFunction;
+
+ private:
+    const int n_buffers_;
+    std::vector<std::unique_ptr<EvolutionSnapshot>> free_buffers_;
+    std::deque<std::pair<std::unique_ptr<EvolutionSnapshot>, WriteFunction>>
+                                                                    queue_;
+    bool writing_;
+    bool stop_;
+    //! the largest buffer so far, booked for every buffer of the pool
+    int64_t buffer_bytes_;
+    MemoryRegistration memory_;
+
+    std::mutex mutex_;
+    std::condition_variable buffer_returned_;
+    std::condition_variable snapshot_submitted_;
+    std::thread writer_;
+
+    void run_writer();
+
+    //! puts the buffer back into the pool, which is booked with the size
+    //! of its largest buffer (called with the lock held)
+    void return_buffer(std::unique_ptr<EvolutionSnapshot> buffer);
+
+ public:
+    explicit EvolutionOutputWriter(const int n_buffers);
+    //! writes the submitted snapshots and stops the writer thread
+    ~EvolutionOutputWriter();
+
+    EvolutionOutputWriter(const EvolutionOutputWriter&) = delete;
+    EvolutionOutputWriter& operator=(const EvolutionOutputWriter&) = delete;
+
+    bool is_asynchronous() const {return(n_buffers_ > 0);}
+
+    //! returns a free snapshot buffer, waiting for the writer if all
+    //! buffers are in use
+    std::unique_ptr<EvolutionSnapshot> get_buffer();
+
+    //! hands the filled snapshot to the writer, which calls write with it
+    //! and returns the buffer to the pool afterwards. The snapshots are
+    //! written in the order they are submitted.
+    void submit(std::unique_ptr<EvolutionSnapshot> snapshot,
+                WriteFunction write);
+
+    //! waits until all submitted snapshots are written
+    void flush();
+};
+
+#endif  // SRC_EVOLUTION_OUTPUT_H_
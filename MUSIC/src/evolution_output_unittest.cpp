@@ -0,0 +1,47 @@
+#include "doctest.h"
+#include "evolution_output.h"
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace {
+    void submit_steps(EvolutionOutputWriter &writer, const int n_steps,
+                      std::vector<double> &written) {
+        for (int it = 0; it < n_steps; it++) {
+            std::unique_ptr<EvolutionSnapshot> snapshot = writer.get_buffer();
+            snapshot->tau = 0.5 + it;
+            snapshot->cells.assign(10, Cell_small());
+            snapshot->cells[3].epsilon = it;
+            writer.submit(std::move(snapshot),
+                          [&written](const EvolutionSnapshot &cells) {
+                // a slow writer, the evolution has to wait for the buffers
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+                written.push_back(cells.tau + cells.cells[3].epsilon);
+            });
+        }
+    }
+}
+
+TEST_CASE("Check EvolutionOutputWriter writes the snapshots in order") {
+    for (int n_buffers = 0; n_buffers < 4; n_buffers++) {
+        std::vector<double> written;
+        EvolutionOutputWriter writer(n_buffers);
+        CHECK(writer.is_asynchronous() == (n_buffers > 0));
+        submit_steps(writer, 20, written);
+        writer.flush();
+        REQUIRE(written.size() == 20);
+        for (int it = 0; it < 20; it++) {
+            CHECK(written[it] == 0.5 + 2*it);
+        }
+    }
+}
+
+TEST_CASE("Check EvolutionOutputWriter writes the snapshots when destroyed") {
+    std::vector<double> written;
+    {
+        EvolutionOutputWriter writer(2);
+        submit_steps(writer, 5, written);
+    }
+    CHECK(written.size() == 5);
+}
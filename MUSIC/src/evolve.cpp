@@ -5,6 +5,7 @@
 #endif
 
 #include <algorithm>
+#include <chrono>
 #include <memory>
 #include <cmath>
 #include <string>
@@ -15,25 +16,67 @@
 #include "evolve.h"
 #include "cornelius.h"
 #include "u_derivative.h"
+#include "u_derivative_rows.h"
 #include "emoji.h"
 #include "util.h"
+#include "instrumentation.h"
+#include "memory_accounting.h"
 
 #ifndef _OPENMP
   #define omp_get_thread_num() 0
+  #define omp_get_max_threads() 1
 #endif
 
 using Util::hbarc;
 
-Evolve::Evolve(const EOS &eosIn, const InitData &DATA_in,
+Evolve::Evolve(const EOS &eosIn, InitData &DATA_in,
                std::shared_ptr<HydroSourceBase> hydro_source_ptr_in) :
     eos(eosIn), DATA(DATA_in),
-    grid_info(DATA_in, eosIn), advance(eosIn, DATA_in, hydro_source_ptr_in) {
+    grid_info(DATA_in, eosIn), advance(eosIn, DATA_in, hydro_source_ptr_in),
+    observables_(DATA_in, eosIn), rk_scheme_(DATA_in.rk_order),
+    grid_coarsening_(DATA_in, eosIn), eta_grid_(DATA_in) {
 
-    rk_order  = DATA_in.rk_order;
     if (DATA.freezeOutMethod == 4) {
         initialize_freezeout_surface_info();
     }
+    if (DATA.active_region_epsilon > 0. && !epsFO_list.empty()) {
+        const double epsFO_min = *std::min_element(epsFO_list.begin(),
+                                                   epsFO_list.end());
+        if (DATA.active_region_epsilon >= epsFO_min) {
+            music_message << "active_region_epsilon = "
+                          << DATA.active_region_epsilon
+                          << " GeV/fm^3 must be below the lowest freeze-out "
+                          << "energy density " << epsFO_min << " GeV/fm^3";
+            music_message.flush("error");
+            exit(1);
+        }
+    }
     hydro_source_terms_ptr = hydro_source_ptr_in;
+    if (DATA.causality_method != 0 && DATA.causality_diagnostics_stride > 0) {
+        causality_diagnostics_ptr =
+                            std::make_shared<CausalityDiagnostics>(DATA);
+        advance.set_causality_diagnostics(causality_diagnostics_ptr);
+    }
+    if (DATA.causality_method != 0 && DATA.causality_statistics == 1) {
+        causality_statistics_ptr =
+                            std::make_shared<CausalityStatistics>(DATA);
+        advance.set_causality_statistics(causality_statistics_ptr);
+    }
+    if (DATA.checkpoint_every_N_timesteps > 0) {
+        checkpoint_writer_.reset(
+                        new CheckpointWriter(DATA.checkpoint_filename));
+    }
+    if (DATA.debug_snapshot_ring > 0) {
+        snapshot_ring_.reset(new SnapshotRing("debug_snapshots.dat",
+                                              DATA.debug_snapshot_ring));
+    }
+}
+
+void Evolve::set_domain_decomposition(
+        std::shared_ptr<DomainDecomposition> domain_ptr_in) {
+    domain_ptr_ = domain_ptr_in;
+    advance.set_domain_decomposition(domain_ptr_in);
+    observables_.set_domain_decomposition(domain_ptr_in);
 }
 
 // master control function for hydrodynamic evolution
@@ -50,6 +93,9 @@ int Evolve::EvolveIt(SCGrid &arena_prev, SCGrid &arena_current,
     //if (DATA.output_hydro_params_header || DATA.outputEvolutionData == 1)
     //    grid_info.Output_hydro_information_header();
 
+    // the eta_s and the widths of the cells of a stretched eta grid
+    if (!eta_grid_.is_uniform()) grid_info.output_eta_grid();
+
     if (DATA.store_hydro_info_in_memory == 1) {
         hydro_info_ptr.set_grid_infomatioin(DATA);
     }
@@ -59,7 +105,24 @@ int Evolve::EvolveIt(SCGrid &arena_prev, SCGrid &arena_current,
     double tau0  = DATA.tau0;
     double dt    = DATA.delta_tau;
 
-    double tau;
+    // with adaptive steps, the evolution ends at the same time and
+    // the evolution output stays on the tau grid of the fixed step
+    const bool adaptive_dtau = (DATA.adaptive_dtau == 1);
+    const double tau_end     = tau0 + dt*itmax;
+    const double output_dtau = Nskip_timestep*DATA.delta_tau_input;
+    const bool evolution_output = (   DATA.outputEvolutionData != 0
+                                   || DATA.output_movie_flag == 1
+                                   || DATA.output_movie_reductions != 0
+                                   || DATA.store_hydro_info_in_memory == 1
+                                   || DATA.output_outofequilibriumsize == 1);
+    double tau_next_output = tau0;
+    double tau_freezeout   = tau0;
+    int coarsening_levels = DATA.transverse_coarsening_levels;
+    tau_first_step_ = tau0 + dt;
+    freezeout_dtau_ = facTau*dt;
+    dtau_prev_      = dt;
+
+    double tau = tau0;
     int it_start = 3;
     double source_tau_max = 0.0;
     if (!Util::weak_ptr_is_uninitialized(hydro_source_terms_ptr)) {
@@ -71,35 +134,78 @@ int Evolve::EvolveIt(SCGrid &arena_prev, SCGrid &arena_current,
     GridPointer ap_current(&arena_current, closer);
     GridPointer ap_future (&arena_future, closer);
 
-    SCGrid arena_freezeout_prev(arena_current.nX(),
-                                arena_current.nY(),
-                                arena_current.nEta());
-    SCGrid arena_freezeout(arena_current.nX(),
-                           arena_current.nY(),
-                           arena_current.nEta());
+    FreezeoutHistory freezeout_history(DATA, arena_current.nX(),
+                                       arena_current.nY(),
+                                       arena_current.nEta());
+    // the surface of a freeze-out step is found while the next steps
+    // advance, on threads of the pipeline
+    std::unique_ptr<FreezeoutPipeline> freezeout_pipeline;
+    if (freezeout_flag == 1 && DATA.freeze_out_pipeline > 0) {
+        // the threads use the per-thread buffers of the freeze-out
+        const int n_threads = std::min(DATA.freeze_out_pipeline,
+                                       omp_get_max_threads());
+        freezeout_pipeline.reset(new FreezeoutPipeline(DATA, n_threads));
+    }
+    register_observables(arena_current);
 
     int it = 0;
     double eps_max_cur = -1.;
+    if (DATA.restart_from_checkpoint == 1) {
+        EvolutionLoopState state;
+        read_checkpoint(state, arena_prev, arena_current, arena_future,
+                        freezeout_history.get_snapshot_for_restart());
+        it              = state.it;
+        tau             = state.tau;
+        DATA.delta_tau  = state.delta_tau;
+        tau_next_output = state.tau_next_output;
+        tau_freezeout   = state.tau_freezeout;
+        eps_max_cur     = state.eps_max_cur;
+    }
     const double max_allowed_e_increase_factor = 2.;
-    for (it = 0; it <= itmax; it++) {
-        tau = tau0 + dt*it;
+    if (snapshot_ring_ != nullptr) snapshot_ring_->arm();
+    for (; adaptive_dtau || it <= itmax; it++) {
+        if (!adaptive_dtau) {
+            tau = tau0 + dt*it;
+        } else if (tau > tau_end) {
+            break;
+        }
+        // the last snapshot of a run stopped by an error is the grid the
+        // failed step started from
+        if (snapshot_ring_ != nullptr) {
+            snapshot_ring_->push(it, tau, *ap_current);
+        }
 
         if (!Util::weak_ptr_is_uninitialized(hydro_source_terms_ptr)) {
             hydro_source_terms_ptr.lock()->prepare_list_for_current_tau_frame(tau);
         }
+        update_active_region(*ap_current, tau, source_tau_max);
+        if (it == 0) {
+            freezeout_region = active_region;
+        } else {
+            freezeout_region.merge(active_region);
+        }
+
         // store initial conditions
         if (it == it_start) {
-            store_previous_step_for_freezeout(*ap_prev, arena_freezeout_prev);
-            store_previous_step_for_freezeout(*ap_current, arena_freezeout);
+            // two Runge-Kutta steps until the first freeze-out step
+            freezeout_history.store_copy(*ap_current);
+            if (DATA.output_vorticity == 1 && !DATA.boost_invariant) {
+                update_vorticity_grid(tau, *ap_prev, *ap_current,
+                                      vorticity_freezeout_);
+            }
+            freezeout_region = active_region;
+            tau_freezeout = tau;
         }
 
-        if (DATA.Initial_profile == 0) {
+        // the check files of the whole grid are not written by the
+        // distributed runs
+        if (DATA.Initial_profile == 0 && !is_distributed()) {
             if (   fabs(tau - 1.0) < 1e-8 || fabs(tau - 1.2) < 1e-8
                 || fabs(tau - 1.5) < 1e-8 || fabs(tau - 2.0) < 1e-8
                 || fabs(tau - 3.0) < 1e-8) {
                 grid_info.Gubser_flow_check_file(*ap_current, tau);
             }
-        } else if (DATA.Initial_profile == 1) {
+        } else if (DATA.Initial_profile == 1 && !is_distributed()) {
             if (   fabs(tau -  1.0) < 1e-8 || fabs(tau -  2.0) < 1e-8
                 || fabs(tau -  5.0) < 1e-8 || fabs(tau - 10.0) < 1e-8
                 || fabs(tau - 20.0) < 1e-8) {
@@ -115,7 +221,20 @@ int Evolve::EvolveIt(SCGrid &arena_prev, SCGrid &arena_current,
         //    }
         //}
 
-        if (it % Nskip_timestep == 0) {
+        bool output_step = (it % Nskip_timestep == 0);
+        if (adaptive_dtau) {
+            // the steps are chosen to land on tau_next_output
+            output_step = (tau > tau_next_output - 1e-3*DATA.delta_tau_input);
+            if (output_step) tau_next_output += output_dtau;
+        }
+        // the vorticity outputs of this step share one pass over the grid
+        if (   (output_step && DATA.outputEvolutionData == 4)
+            || (DATA.output_vorticity == 1 && !DATA.boost_invariant)) {
+            update_vorticity_grid(tau, *ap_prev, *ap_current,
+                                  vorticity_current_);
+        }
+        if (output_step) {
+            ScopedTimer output_timer(InstrumentedTimer::output);
             if (DATA.outputEvolutionData == 1) {
                 grid_info.OutputEvolutionDataXYEta(*ap_current, tau);
             } else if (DATA.outputEvolutionData == 2) {
@@ -124,12 +243,20 @@ int Evolve::EvolveIt(SCGrid &arena_prev, SCGrid &arena_current,
                 grid_info.OutputEvolutionDataXYEta_photon(*ap_current, tau);
             } else if (DATA.outputEvolutionData == 4) {
                 grid_info.OutputEvolutionDataXYEta_vorticity(
-                                            *ap_current, *ap_prev, tau);
+                                            *ap_current, vorticity_current_,
+                                            tau);
+            } else if (DATA.outputEvolutionData == 5) {
+                grid_info.OutputEvolutionDataXYEta_chunked(*ap_current, tau);
+            } else if (DATA.outputEvolutionData == 6) {
+                grid_info.OutputEvolutionDataXYEta_sparse(*ap_current, tau);
             }
 
             if (DATA.output_movie_flag == 1) {
                 grid_info.output_evolution_for_movie(*ap_current, tau);
             }
+            if (DATA.output_movie_reductions != 0) {
+                grid_info.output_reduced_movie(*ap_current, tau);
+            }
 
             if (DATA.store_hydro_info_in_memory == 1) {
                 grid_info.OutputEvolutionDataXYEta_memory(*ap_current, tau,
@@ -142,55 +269,29 @@ int Evolve::EvolveIt(SCGrid &arena_prev, SCGrid &arena_current,
             }
         }
 
-        if (it == it_start)
+        if (it == it_start && !is_distributed())
             grid_info.output_momentum_anisotropy_vs_etas(tau, *ap_current);
-        grid_info.output_momentum_anisotropy_vs_tau(
-                                            tau, -0.5, 0.5, *ap_current);
-        if (DATA.Initial_profile == 13) {
-            grid_info.output_average_phase_diagram_trajectory(
-                                            tau, -0.5, 0.5, *ap_current);
-            grid_info.output_average_phase_diagram_trajectory(
-                                            tau, 0.5, 2.0, *ap_current);
-            grid_info.output_average_phase_diagram_trajectory(
-                                            tau, 2.0, 3.0, *ap_current);
-            grid_info.output_average_phase_diagram_trajectory(
-                                            tau, 3.0, 4.0, *ap_current);
-            grid_info.output_average_phase_diagram_trajectory(
-                                            tau, 4.0, 5.0, *ap_current);
+        if (   !DATA.boost_invariant && DATA.output_vorticity == 1
+            && !is_distributed()
+            && (   fabs(tau -  1.0) < 1e-8 || fabs(tau -  2.0) < 1e-8
+                || fabs(tau -  5.0) < 1e-8 || fabs(tau - 10.0) < 1e-8)) {
+            grid_info.output_vorticity_distribution(
+                            *ap_current, vorticity_current_, tau, -0.5, 0.5);
         }
 
-
-        // check energy conservation
-        if (!DATA.boost_invariant) {
-            grid_info.check_conservation_law(*ap_current, *ap_prev, tau);
-            if (DATA.output_vorticity) {
-                if (   fabs(tau -  1.0) < 1e-8 || fabs(tau -  2.0) < 1e-8
-                    || fabs(tau -  5.0) < 1e-8 || fabs(tau - 10.0) < 1e-8) {
-                    grid_info.output_vorticity_distribution(
-                                    *ap_current, *ap_prev, tau, -0.5, 0.5);
-                }
-                grid_info.compute_angular_momentum(
-                                    *ap_current, *ap_prev, tau, -0.5, 0.5);
-                grid_info.output_vorticity_time_evolution(
-                                    *ap_current, *ap_prev, tau, -0.5, 0.5);
-                grid_info.compute_angular_momentum(
-                                    *ap_current, *ap_prev, tau, -1.0, 1.0);
-                grid_info.output_vorticity_time_evolution(
-                                    *ap_current, *ap_prev, tau, -1.0, 1.0);
-                grid_info.compute_angular_momentum(
-                                    *ap_current, *ap_prev, tau,
-                                    -DATA.eta_size/2., DATA.eta_size/2.);
-                grid_info.output_vorticity_time_evolution(
-                                    *ap_current, *ap_prev, tau,
-                                    -DATA.eta_size/2., DATA.eta_size/2.);
-            }
+        // the momentum anisotropy, the conservation laws, the vorticity
+        // and the maximum energy density in one pass over the grid
+        const bool has_vorticity = (DATA.output_vorticity == 1
+                                    && !DATA.boost_invariant);
+        {
+            ScopedTimer output_timer(InstrumentedTimer::output);
+            observables_.evaluate(
+                        it, tau, *ap_current, ap_prev.get(),
+                        has_vorticity ? &vorticity_current_ : nullptr,
+                        active_region);
         }
-
-        double emax_loc = 0.;
-        double Tmax_curr = 0.;
-        double nB_max_curr = 0.;
-        grid_info.get_maximum_energy_density(*ap_current, emax_loc,
-                                             nB_max_curr, Tmax_curr);
+        const double emax_loc  = eps_max_observable_->get_eps_max();
+        const double Tmax_curr = eps_max_observable_->get_T_max();
         if (tau > source_tau_max && it > 0) {
             if (eps_max_cur < 0.) {
                 eps_max_cur = emax_loc;
@@ -208,44 +309,108 @@ int Evolve::EvolveIt(SCGrid &arena_prev, SCGrid &arena_current,
             }
         }
 
-        if (DATA.output_hydro_debug_info == 1) {
+        if (DATA.output_hydro_debug_info == 1 && !is_distributed()) {
             grid_info.monitor_a_fluid_cell(*ap_current, *ap_prev,
                                            100, 100, 0, tau);
         }
 
+        if (step_callback_ && !step_callback_(it, tau, *ap_current)) {
+            music_message.info("The evolution is stopped by the step "
+                               "callback.");
+            break;
+        }
+
+        if (adaptive_dtau) {
+            DATA.delta_tau = get_adaptive_time_step(
+                    *ap_current, tau, source_tau_max,
+                    evolution_output ? tau_next_output : tau_end + 1.);
+        }
+
         /* execute rk steps */
         // all the evolution are at here !!!
         AdvanceRK(tau, ap_prev, ap_current, ap_future);
+        if (causality_diagnostics_ptr) {
+            ScopedTimer output_timer(InstrumentedTimer::output);
+            causality_diagnostics_ptr->flush();
+        }
+        if (causality_statistics_ptr) {
+            ScopedTimer output_timer(InstrumentedTimer::output);
+            causality_statistics_ptr->flush(tau);
+        }
 
         //determine freeze-out surface
         int frozen = 0;
+        // the freeze-out step handed to the pipeline after the
+        // termination decision
+        bool launch_freezeout = false;
+        const double tau_step = tau;
+        ActiveRegion launch_region;
         if (freezeout_flag == 1) {
+            ScopedTimer freeze_out_timer(InstrumentedTimer::freeze_out);
             if (freezeout_lowtemp_flag == 1 && it == it_start) {
                 frozen = FreezeOut_equal_tau_Surface(tau, *ap_current);
             }
             // avoid freeze-out at the first time step
             if ((it - it_start)%facTau == 0 && it > it_start) {
-                if (!DATA.boost_invariant) {
+                if (freezeout_pipeline != nullptr) {
+                    // the last freeze-out step decides the termination,
+                    // its snapshot becomes the lower time level
+                    frozen = freezeout_pipeline->wait(freezeout_history);
+                }
+                if (adaptive_dtau) freezeout_dtau_ = tau - tau_freezeout;
+                if (freezeout_pipeline != nullptr) {
+                    launch_freezeout = true;
+                    launch_region = freezeout_region;
+                } else if (!DATA.boost_invariant) {
                     frozen = FindFreezeOutSurface_Cornelius(
-                                tau, *ap_prev, *ap_current,
-                                arena_freezeout_prev, arena_freezeout);
+                                tau, freezeout_region, *ap_prev, *ap_current,
+                                freezeout_history.get());
                 } else {
                     frozen = FindFreezeOutSurface_boostinvariant_Cornelius(
-                                tau, *ap_current, arena_freezeout);
+                                tau, freezeout_region, *ap_current,
+                                freezeout_history.get());
+                }
+                if (is_distributed()) {
+                    // all the slabs have to be frozen out
+                    frozen = static_cast<int>(
+                                domain_ptr_->get_global_max(frozen));
                 }
-                store_previous_step_for_freezeout(*ap_prev,
-                                                  arena_freezeout_prev);
-                store_previous_step_for_freezeout(*ap_current,
-                                                  arena_freezeout);
+                // with facTau = 1, ap_current is arena_prev of the next
+                // freeze-out step (the pipeline stores its snapshot)
+                if (freezeout_pipeline == nullptr) {
+                    if (facTau == 1) {
+                        freezeout_history.store_reference(*ap_current);
+                    } else {
+                        freezeout_history.store_copy(*ap_current);
+                    }
+                }
+                std::swap(vorticity_freezeout_, vorticity_current_);
+                freezeout_region = active_region;
+                tau_freezeout = tau;
             }
         }
-        music_message << emoji::clock()
-                      << " Done time step " << it << "/" << itmax
-                      << " tau = " << tau << " fm/c";
+        if (adaptive_dtau) {
+            music_message << emoji::clock()
+                          << " Done time step " << it
+                          << " tau = " << tau << " fm/c, dtau = "
+                          << DATA.delta_tau << " fm/c";
+        } else {
+            music_message << emoji::clock()
+                          << " Done time step " << it << "/" << itmax
+                          << " tau = " << tau << " fm/c";
+        }
         music_message.flush("info");
+        Instrumentation::end_time_step(it, tau);
+        if (adaptive_dtau) {
+            tau += DATA.delta_tau;
+            // remove the round-off of the steps to the output times
+            if (std::abs(tau - tau_next_output) < 1e-3*DATA.delta_tau_input)
+                tau = tau_next_output;
+        }
         if (frozen == 1 && tau > source_tau_max) {
             if (   DATA.outputEvolutionData == 2
-                || DATA.outputEvolutionData == 3) {
+                || DATA.outputEvolutionData == 3
+                || DATA.outputEvolutionData == 6) {
                 if (eps_max_cur < DATA.output_evolution_e_cut) {
                     music_message << "All cells e < "
                                   << DATA.output_evolution_e_cut
@@ -265,34 +430,288 @@ int Evolve::EvolveIt(SCGrid &arena_prev, SCGrid &arena_current,
                 break;
             }
         }
+
+        if (launch_freezeout) {
+            // the pipeline finds the surface of the snapshot of ap_current
+            // while the next steps advance
+            ScopedTimer freeze_out_timer(InstrumentedTimer::freeze_out);
+            freezeout_pipeline->launch(*ap_current, freezeout_history,
+                [this, tau_step, launch_region](
+                        SCGrid &arena, const SCGrid &arena_freezeout) {
+                    if (DATA.boost_invariant) {
+                        return(FindFreezeOutSurface_boostinvariant_Cornelius(
+                                tau_step, launch_region, arena,
+                                arena_freezeout));
+                    }
+                    // arena_prev is not read without the vorticity
+                    return(FindFreezeOutSurface_Cornelius(
+                                tau_step, launch_region, arena, arena,
+                                arena_freezeout));
+                });
+        }
+
+        if (   checkpoint_writer_ != nullptr
+            && (it + 1) % DATA.checkpoint_every_N_timesteps == 0) {
+            // the checkpoint holds the last found freeze-out step
+            if (freezeout_pipeline != nullptr) {
+                freezeout_pipeline->wait(freezeout_history);
+            }
+            const EvolutionLoopState state = {it + 1, tau, DATA.delta_tau,
+                                              tau_next_output, tau_freezeout,
+                                              eps_max_cur};
+            write_checkpoint(state, *ap_prev, *ap_current, *ap_future,
+                             freezeout_history.get());
+        }
+
+        if (coarsening_levels > 0 && it > it_start && tau > source_tau_max) {
+            if (coarsen_transverse_plane(ap_prev, ap_current, ap_future,
+                                         freezeout_history,
+                                         freezeout_pipeline.get())) {
+                coarsening_levels--;
+            }
+        }
     }
-    if (it < itmax) {
+    if (freezeout_pipeline != nullptr) {
+        ScopedTimer freeze_out_timer(InstrumentedTimer::freeze_out);
+        freezeout_pipeline->wait(freezeout_history);
+    }
+    if (checkpoint_writer_ != nullptr) checkpoint_writer_->wait();
+    if (snapshot_ring_ != nullptr) snapshot_ring_->disarm();
+    const bool reached_tau_max = (adaptive_dtau ? tau > tau_end : it >= itmax);
+    if (!reached_tau_max) {
         music_message.info("Finished.");
     } else {
         music_message.warning("Maximum allowed time reached.");
     }
+    {
+        ScopedTimer output_timer(InstrumentedTimer::output);
+        grid_info.flush_evolution_output();
+        if (freezeout_surface_ptr != nullptr) write_freezeout_surface_files();
+    }
+    advance.print_reconst_statistics();
     return 1;
 }
 
-void Evolve::store_previous_step_for_freezeout(SCGrid &arena_current,
-                                               SCGrid &arena_freezeout) {
+//! this function sets the active region of the time step to the cells
+//! above active_region_epsilon, with a margin of the distance a signal can
+//! travel in one time step (2 cells per Runge-Kutta stage, plus 1).
+//! The whole grid is active if the option is off or while there are
+//! source terms, which can deposit energy anywhere.
+void Evolve::update_active_region(const SCGrid &arena_current,
+                                  const double tau,
+                                  const double source_tau_max) {
+    const bool whole_grid = (DATA.active_region_epsilon <= 0.
+                             || tau <= source_tau_max);
+    if (whole_grid) {
+        active_region = ActiveRegion(arena_current.nX(), arena_current.nY(),
+                                     arena_current.nEta());
+    } else {
+        active_region.update(arena_current, DATA.active_region_epsilon/hbarc,
+                             2*rk_scheme_.get_number_of_stages() + 1);
+    }
+    if (is_distributed()) {
+        // the halo layers are evolved by the neighbouring slabs
+        active_region = active_region.get_eta_slab(
+                                        domain_ptr_->get_owned_eta_min(),
+                                        domain_ptr_->get_owned_eta_max());
+    }
+    if (whole_grid) return;
+    music_message << "active region: " << active_region.get_number_of_cells()
+                  << " of " << arena_current.size() << " cells";
+    music_message.flush("info");
+}
+
+bool Evolve::coarsen_transverse_plane(GridPointer &ap_prev,
+                                      GridPointer &ap_current,
+                                      GridPointer &ap_future,
+                                      FreezeoutHistory &freezeout_history,
+                                      FreezeoutPipeline *freezeout_pipeline) {
+    const int nx   = ap_current->nX();
+    const int ny   = ap_current->nY();
+    const int neta = ap_current->nEta();
+    if (!grid_coarsening_.can_coarsen(nx, ny)) return(false);
+    const double indicator = (
+                    GridCoarsening::get_gradient_indicator(*ap_current));
+    if (indicator >= DATA.transverse_coarsening_threshold) return(false);
+
+    // the step being found is the lower time level of the next freeze-out
+    // step, it is restricted with the grids
+    if (freezeout_pipeline != nullptr) {
+        ScopedTimer freeze_out_timer(InstrumentedTimer::freeze_out);
+        freezeout_pipeline->wait(freezeout_history);
+    }
+    const int nx_coarse = (nx + 1)/2;
+    const int ny_coarse = (ny + 1)/2;
+    // the last freeze-out step may be a reference to ap_current, so it is
+    // restricted first
+    std::unique_ptr<SCGrid> freezeout_step;
+    {
+        MemoryScope memory_scope(MemorySubsystem::freeze_out);
+        freezeout_step.reset(new SCGrid(nx_coarse, ny_coarse, neta));
+    }
+    grid_coarsening_.restrict_grid(freezeout_history.get(), *freezeout_step);
+    freezeout_history.store_snapshot(freezeout_step);
+    for (GridPointer *arena : {&ap_prev, &ap_current}) {
+        SCGrid coarse(nx_coarse, ny_coarse, neta);
+        grid_coarsening_.restrict_grid(**arena, coarse);
+        **arena = std::move(coarse);
+    }
+    *ap_future = SCGrid(nx_coarse, ny_coarse, neta);
+
+    // the parts of the evolution read the grid spacing from DATA; the
+    // evolution output and the freeze-out keep the lattice of their points
+    DATA.nx = nx_coarse;
+    DATA.ny = ny_coarse;
+    DATA.delta_x *= 2.;
+    DATA.delta_y *= 2.;
+    if (DATA.output_evolution_every_N_x%2 == 0) {
+        DATA.output_evolution_every_N_x /= 2;
+    }
+    if (DATA.output_evolution_every_N_y%2 == 0) {
+        DATA.output_evolution_every_N_y /= 2;
+    }
+    if (DATA.fac_x%2 == 0) DATA.fac_x /= 2;
+    if (DATA.fac_y%2 == 0) DATA.fac_y /= 2;
+    active_region = ActiveRegion(nx_coarse, ny_coarse, neta);
+    freezeout_region = active_region;
+
+    music_message << "coarsened the transverse plane to " << nx_coarse
+                  << " x " << ny_coarse << " points, dx = " << DATA.delta_x
+                  << " fm, dy = " << DATA.delta_y << " fm (gradient "
+                  << "indicator " << indicator << ")";
+    music_message.flush("info");
+    return(true);
+}
+
+//! this function returns the time step from tau. It is the step of the
+//! CFL condition with adaptive_dtau_cfl for the fastest signal in the
+//! active region, limited to adaptive_dtau_growth times the last step and
+//! adaptive_dtau_max_ratio times Delta_Tau. The step is Delta_Tau while
+//! there are source terms, and the steps are shortened evenly to land on
+//! tau_next_output.
+double Evolve::get_adaptive_time_step(const SCGrid &arena_current,
+                                      const double tau,
+                                      const double source_tau_max,
+                                      const double tau_next_output) {
+    double dtau = DATA.delta_tau_input;
+    if (tau > source_tau_max) {
+        double rate = advance.get_max_signal_rate(tau, arena_current,
+                                                  active_region);
+        if (is_distributed()) rate = domain_ptr_->get_global_max(rate);
+        dtau = DATA.adaptive_dtau_cfl/std::max(rate, Util::small_eps);
+        dtau = std::min(dtau, DATA.adaptive_dtau_growth*dtau_prev_);
+        dtau = std::min(dtau, DATA.adaptive_dtau_max_ratio
+                              *DATA.delta_tau_input);
+    }
+    const double dtau_output = tau_next_output - tau;
+    if (dtau_output > 0. && dtau_output < dtau*(1. + 1e-3)) {
+        dtau = dtau_output;
+    } else if (dtau_output > 0. && dtau_output < 2.*dtau) {
+        dtau = dtau_output/2.;
+    }
+    return(dtau);
+}
+
+
+//! this function registers the observables written at every
+//! output_observables_every_N_timesteps time steps, and the maximum energy
+//! density check of every time step
+void Evolve::register_observables(const SCGrid &arena) {
+    if (!observables_.empty()) return;
+    const int n_steps = DATA.output_observables_every_N_timesteps;
+    observables_.add(std::unique_ptr<Observable>(
+                new MomentumAnisotropy(DATA, -0.5, 0.5, n_steps)));
+    if (DATA.Initial_profile == 13) {
+        const double eta_windows[][2] = {{-0.5, 0.5}, {0.5, 2.0}, {2.0, 3.0},
+                                         {3.0, 4.0}, {4.0, 5.0}};
+        for (const auto &window : eta_windows) {
+            observables_.add(std::unique_ptr<Observable>(
+                new PhaseDiagramTrajectory(DATA, window[0], window[1],
+                                           n_steps)));
+        }
+    }
+    if (!DATA.boost_invariant) {
+        observables_.add(std::unique_ptr<Observable>(
+                new ConservationLaws(DATA,
+                                     (is_distributed()
+                                      ? domain_ptr_->get_global_neta()
+                                      : arena.nEta()),
+                                     n_steps)));
+        if (DATA.output_vorticity == 1) {
+            const double eta_windows[][2] = {
+                {-0.5, 0.5}, {-1.0, 1.0},
+                {-DATA.eta_size/2., DATA.eta_size/2.}};
+            for (const auto &window : eta_windows) {
+                observables_.add(std::unique_ptr<Observable>(
+                    new AngularMomentum(DATA, window[0], window[1],
+                                        n_steps)));
+                observables_.add(std::unique_ptr<Observable>(
+                    new VorticityEvolution(DATA, eos, window[0], window[1],
+                                           n_steps)));
+            }
+        }
+    }
+    eps_max_observable_ = new MaximumEnergyDensity();
+    observables_.add(std::unique_ptr<Observable>(eps_max_observable_));
+}
+
+
+//! this function fills vorticity with the vorticity tensors of the cells
+//! in the tau-eta frame, with the time derivatives from arena_prev
+void Evolve::update_vorticity_grid(const double tau, SCGrid &arena_prev,
+                                   SCGrid &arena_current,
+                                   VorticityGrid &vorticity) {
     const int nx   = arena_current.nX();
     const int ny   = arena_current.nY();
     const int neta = arena_current.nEta();
-    #pragma omp parallel for collapse(3)
-    for (int ieta = 0; ieta < neta; ieta++)
-    for (int ix = 0;   ix   < nx;   ix++)
-    for (int iy = 0;   iy   < ny;   iy++) {
-        arena_freezeout(ix, iy, ieta) = arena_current(ix, iy, ieta);
+    if (   vorticity.nX() != nx || vorticity.nY() != ny
+        || vorticity.nEta() != neta) {
+        vorticity = VorticityGrid(nx, ny, neta);
+    }
+    if (DATA.u_derivative_rows == 1) {
+        // the rows of cells at once, with the EOS evaluated once per row
+        #pragma omp parallel
+        {
+            UDerivativeRows rows(DATA, eos);
+            #pragma omp for collapse(2)
+            for (int ieta = 0; ieta < neta; ieta++)
+            for (int iy   = 0; iy   < ny;   iy++  ) {
+                rows.compute_row(tau, arena_prev, arena_current,
+                                 static_cast<const ThermoGrid*>(nullptr),
+                                 0, nx, iy, ieta);
+                for (int ix = 0; ix < nx; ix++) {
+                    rows.get_vorticity(tau, ix, vorticity(ix, iy, ieta));
+                }
+            }
+        }
+        return;
+    }
+    #pragma omp parallel
+    {
+        U_derivative u_derivative_helper(DATA, eos);
+        #pragma omp for collapse(3)
+        for (int ieta = 0; ieta < neta; ieta++)
+        for (int ix   = 0; ix   < nx;   ix++  )
+        for (int iy   = 0; iy   < ny;   iy++  ) {
+            u_derivative_helper.compute_vorticity_Milne(
+                tau, arena_prev, arena_current, ieta, ix, iy,
+                vorticity(ix, iy, ieta));
+        }
     }
 }
 
 void Evolve::AdvanceRK(double tau, GridPointer &arena_prev, GridPointer &arena_current, GridPointer &arena_future) {
     // control function for Runge-Kutta evolution in tau
     // loop over Runge-Kutta steps
-    for (int rk_flag = 0; rk_flag < rk_order; rk_flag++) {
-        advance.AdvanceIt(tau, *arena_prev, *arena_current, *arena_future,
-                          rk_flag);
+    const int n_stages = rk_scheme_.get_number_of_stages();
+    // arena_prev is one step back in the first stage,
+    // and the start of this step in the later ones
+    auto get_delta_tau_backward = [this](const int rk_flag) {
+        return(rk_flag == 0 ? dtau_prev_
+                            : (rk_scheme_.get_stage_tau_fraction(rk_flag)
+                               *DATA.delta_tau));
+    };
+    auto rotate_arenas = [&](const int rk_flag) {
         if (rk_flag == 0) {
             auto temp     = std::move(arena_prev);
             arena_prev    = std::move(arena_current);
@@ -301,48 +720,322 @@ void Evolve::AdvanceRK(double tau, GridPointer &arena_prev, GridPointer &arena_c
         } else {
             std::swap(arena_current, arena_future);
         }
-    }  /* loop over rk_flag */
+    };
+    if (   DATA.persistent_parallel_region == 1
+        && advance.can_advance_in_team()) {
+        // the stages run in one parallel region, the rotation of the
+        // arenas and the preparation of the next stage on one thread
+        ScopedTimer timer(InstrumentedTimer::advance_it);
+        #pragma omp parallel
+        {
+            #pragma omp single
+            {
+                DATA.delta_tau_backward = get_delta_tau_backward(0);
+                advance.prepare_stage(*arena_prev, *arena_current,
+                                      *arena_future, 0);
+            }
+            for (int rk_flag = 0; rk_flag < n_stages; rk_flag++) {
+                advance.AdvanceIt_in_team(tau, *arena_prev, *arena_current,
+                                          *arena_future, rk_flag,
+                                          active_region);
+                #pragma omp single
+                {
+                    rotate_arenas(rk_flag);
+                    if (rk_flag + 1 < n_stages) {
+                        DATA.delta_tau_backward = (
+                                    get_delta_tau_backward(rk_flag + 1));
+                        advance.prepare_stage(*arena_prev, *arena_current,
+                                              *arena_future, rk_flag + 1);
+                    }
+                }
+            }
+        }
+    } else {
+        for (int rk_flag = 0; rk_flag < n_stages; rk_flag++) {
+            DATA.delta_tau_backward = get_delta_tau_backward(rk_flag);
+            advance.AdvanceIt(tau, *arena_prev, *arena_current,
+                              *arena_future, rk_flag, active_region);
+            rotate_arenas(rk_flag);
+        }  /* loop over rk_flag */
+    }
+    dtau_prev_ = DATA.delta_tau;
+    DATA.delta_tau_backward = DATA.delta_tau;
+}
+
+const SCGrid &Evolve::advance_steps(const double tau, const int n_steps,
+                                    SCGrid &arena_prev,
+                                    SCGrid &arena_current,
+                                    SCGrid &arena_future,
+                                    std::vector<double> &step_seconds) {
+    const auto closer = [](SCGrid* g) { /*Don't delete memory we don't own*/ };
+    GridPointer ap_prev   (&arena_prev, closer);
+    GridPointer ap_current(&arena_current, closer);
+    GridPointer ap_future (&arena_future, closer);
+
+    double source_tau_max = 0.0;
+    if (!Util::weak_ptr_is_uninitialized(hydro_source_terms_ptr)) {
+        source_tau_max = hydro_source_terms_ptr.lock()->get_source_tau_max();
+    }
+    tau_first_step_ = tau + DATA.delta_tau;
+    dtau_prev_      = DATA.delta_tau;
+    for (int it = 0; it < n_steps; it++) {
+        const double tau_it = tau + DATA.delta_tau*it;
+        const auto start = std::chrono::steady_clock::now();
+        if (!Util::weak_ptr_is_uninitialized(hydro_source_terms_ptr)) {
+            hydro_source_terms_ptr.lock()->prepare_list_for_current_tau_frame(
+                                                                    tau_it);
+        }
+        update_active_region(*ap_current, tau_it, source_tau_max);
+        AdvanceRK(tau_it, ap_prev, ap_current, ap_future);
+        const std::chrono::duration<double> elapsed = (
+                            std::chrono::steady_clock::now() - start);
+        step_seconds.push_back(elapsed.count());
+    }
+    return(*ap_current);
+}
+
+
+//! this function gives the range of the lower corners ix, iy of the
+//! freeze-out cubes that touch region. The ranges stay on the
+//! fac_x, fac_y lattice of the full scan.
+void Evolve::get_freezeout_scan_range(const ActiveRegion &region,
+                                      const int nx, const int ny,
+                                      const int fac_x, const int fac_y,
+                                      int &ix_start, int &ix_end,
+                                      int &iy_start, int &iy_end) const {
+    ix_start = std::max(0, region.get_x_min() - fac_x);
+    iy_start = std::max(0, region.get_y_min() - fac_y);
+    ix_start = (ix_start/fac_x)*fac_x;
+    iy_start = (iy_start/fac_y)*fac_y;
+    ix_end   = std::min(nx - fac_x, region.get_x_max());
+    iy_end   = std::min(ny - fac_y, region.get_y_max());
 }
 
 // Cornelius freeze out  (C. Shen, 11/2014)
 int Evolve::FindFreezeOutSurface_Cornelius(double tau,
-        SCGrid &arena_prev, SCGrid &arena_current,
-        SCGrid &arena_freezeout_prev, SCGrid &arena_freezeout) {
+        const ActiveRegion &region, SCGrid &arena_prev,
+        SCGrid &arena_current, const SCGrid &arena_freezeout) {
+    const int nx = arena_current.nX();
+    const int ny = arena_current.nY();
     const int neta = arena_current.nEta();
+    const int fac_x = DATA.fac_x;
+    const int fac_y = DATA.fac_y;
     const int fac_eta = 1;
-    int intersections = 0;
+    if (DATA.output_vorticity == 1) {
+        // the vorticity at tau, vorticity_freezeout_ holds the one of
+        // arena_freezeout from the last freeze-out step
+        update_vorticity_grid(tau, arena_prev, arena_current,
+                              vorticity_current_);
+    }
+
+    // the hypercubes crossed by any of the isotherms, only the cubes with
+    // a corner in the active region can intersect
+    std::vector<double> epsFO_fm(n_freeze_surf);
     for (int i_freezesurf = 0; i_freezesurf < n_freeze_surf; i_freezesurf++) {
-        const double epsFO = epsFO_list[i_freezesurf]/hbarc;   // 1/fm^4
-
-        #pragma omp parallel for reduction(+:intersections)
-        for (int ieta = 0; ieta < (neta-fac_eta); ieta += fac_eta) {
-            int thread_id = omp_get_thread_num();
-            intersections += FindFreezeOutSurface_Cornelius_XY(
-                tau, ieta, arena_prev, arena_current,
-                arena_freezeout_prev, arena_freezeout, thread_id, epsFO);
+        epsFO_fm[i_freezesurf] = epsFO_list[i_freezesurf]/hbarc;  // 1/fm^4
+    }
+    int ix_start, ix_end, iy_start, iy_end;
+    get_freezeout_scan_range(region, nx, ny, fac_x, fac_y,
+                             ix_start, ix_end, iy_start, iy_end);
+    // the cubes of a slab start in its owned layers
+    const int owned_min = is_distributed() ? domain_ptr_->get_owned_eta_min()
+                                           : 0;
+    const int ieta_start = std::max(owned_min,
+                                    region.get_eta_min() - fac_eta);
+    const int ieta_end = std::min(neta - fac_eta, region.get_eta_max());
+    freezeout_prescreen_.find_cubes(arena_current, arena_freezeout, epsFO_fm,
+                                    ix_start, ix_end, fac_x,
+                                    iy_start, iy_end, fac_y,
+                                    ieta_start, ieta_end, fac_eta,
+                                    freezeout_cubes_);
+
+    // the isotherms crossing a hypercube are analysed together, so the
+    // cubes are grouped by position, with the isotherms in order
+    std::sort(freezeout_cubes_.begin(), freezeout_cubes_.end(),
+              [](const FreezeoutCube &a, const FreezeoutCube &b) {
+                  if (a.ieta != b.ieta) return(a.ieta < b.ieta);
+                  if (a.ix != b.ix) return(a.ix < b.ix);
+                  if (a.iy != b.iy) return(a.iy < b.iy);
+                  return(a.isurf < b.isurf);
+              });
+    const int n_cubes = static_cast<int>(freezeout_cubes_.size());
+    freezeout_group_starts_.clear();
+    for (int icube = 0; icube < n_cubes; icube++) {
+        const FreezeoutCube &fo_cube = freezeout_cubes_[icube];
+        if (icube == 0 || fo_cube.ieta != freezeout_cubes_[icube - 1].ieta
+                || fo_cube.ix != freezeout_cubes_[icube - 1].ix
+                || fo_cube.iy != freezeout_cubes_[icube - 1].iy) {
+            freezeout_group_starts_.push_back(icube);
+        }
+    }
+    const int n_groups = static_cast<int>(freezeout_group_starts_.size());
+    freezeout_group_starts_.push_back(n_cubes);
+
+    // Cornelius runs only on the listed hypercubes, split evenly among the
+    // threads, each writing to its own surface files
+    // (or its own buffers of the in-memory surface)
+    #pragma omp parallel
+    {
+        const int thread_id = omp_get_thread_num();
+        std::vector<std::ofstream> s_files(n_freeze_surf);
+        for (int i_freezesurf = 0; i_freezesurf < n_freeze_surf;
+                i_freezesurf++) {
+            if (freezeout_surface_ptr != nullptr) break;
+            open_freezeout_surface_file(tau, epsFO_fm[i_freezesurf],
+                                        thread_id, s_files[i_freezesurf]);
+        }
+        #pragma omp for schedule(static)
+        for (int igroup = 0; igroup < n_groups; igroup++) {
+            const int icube = freezeout_group_starts_[igroup];
+            FindFreezeOutSurface_Cornelius_cube(
+                tau, &freezeout_cubes_[icube],
+                freezeout_group_starts_[igroup + 1] - icube, arena_current,
+                arena_freezeout, epsFO_fm, *freezeout_workspaces_[thread_id],
+                s_files);
         }
     }
+    if (surface_stream_ptr_ != nullptr) publish_freezeout_surface_chunk();
+    if (freezeout_surface_ptr != nullptr) {
+        freezeout_surface_ptr->update_memory_use();
+    }
 
-    return(intersections + 1);
+    return(n_cubes + 1);
 }
 
-int Evolve::FindFreezeOutSurface_Cornelius_XY(double tau, int ieta,
-                                              SCGrid &arena_prev,
-                                              SCGrid &arena_current,
-                                              SCGrid &arena_freezeout_prev,
-                                              SCGrid &arena_freezeout,
-                                              int thread_id, double epsFO) {
-    const bool surface_in_binary = DATA.freeze_surface_in_binary;
-    const int nx = arena_current.nX();
-    const int ny = arena_current.nY();
 
+std::string Evolve::get_freezeout_surface_filename(
+                        const double epsFO, const int thread_id) const {
     std::stringstream strs_name;
-    strs_name << "surface_eps_" << std::setprecision(4) << epsFO*hbarc
-              << "_" << thread_id << ".dat";
-    std::ofstream s_file;
+    strs_name << "surface_eps_" << std::setprecision(4) << epsFO*hbarc;
+    if (is_distributed()) strs_name << "_" << domain_ptr_->get_rank();
+    strs_name << "_" << thread_id << ".dat";
+    return(strs_name.str());
+}
+
+
+//! the boost-invariant runs write one file per isotherm, the others one
+//! per isotherm and thread
+std::vector<std::string> Evolve::get_freezeout_surface_filenames() const {
+    std::vector<std::string> filenames;
+    if (DATA.doFreezeOut != 1 || DATA.freezeOutMethod != 4) {
+        return(filenames);
+    }
+    for (int i_freezesurf = 0; i_freezesurf < n_freeze_surf; i_freezesurf++) {
+        const double epsFO = epsFO_list[i_freezesurf]/hbarc;
+        if (DATA.boost_invariant) {
+            std::stringstream strs_name;
+            strs_name << "surface_eps_" << std::setprecision(4)
+                      << epsFO*hbarc << ".dat";
+            filenames.push_back(strs_name.str());
+            continue;
+        }
+        for (int i = 0; i < omp_get_max_threads(); i++) {
+            filenames.push_back(get_freezeout_surface_filename(epsFO, i));
+        }
+    }
+    return(filenames);
+}
+
+
+//! the grids are written with the step counter and the other state of
+//! the main loop, the observables which accumulate over the time steps,
+//! and the sizes of the files the evolution appends to
+void Evolve::write_checkpoint(const EvolutionLoopState &state,
+                              const SCGrid &arena_prev,
+                              const SCGrid &arena_current,
+                              const SCGrid &arena_future,
+                              const SCGrid &arena_freezeout) {
+    CheckpointWriter &checkpoint = *checkpoint_writer_;
+    checkpoint.begin();
+    checkpoint.add(DATA.tau0);
+    checkpoint.add(DATA.delta_tau_input);
+    checkpoint.add(state);
+    checkpoint.add(freezeout_dtau_);
+    checkpoint.add(dtau_prev_);
+    checkpoint.add(freezeout_region);
+    checkpoint.add_grid(arena_prev);
+    checkpoint.add_grid(arena_current);
+    checkpoint.add_grid(arena_future);
+    checkpoint.add_grid(arena_freezeout);
+    advance.write_checkpoint(checkpoint, arena_prev, arena_current,
+                             arena_future);
+    if (DATA.output_vorticity == 1 && !DATA.boost_invariant) {
+        checkpoint.add_grid(vorticity_freezeout_);
+    }
+    observables_.write_checkpoint(checkpoint);
+    if (causality_statistics_ptr) {
+        causality_statistics_ptr->write_checkpoint(checkpoint);
+    }
+
+    std::vector<std::string> filenames = get_freezeout_surface_filenames();
+    const std::vector<std::string> observable_filenames = (
+                                    observables_.get_output_filenames());
+    filenames.insert(filenames.end(), observable_filenames.begin(),
+                     observable_filenames.end());
+    if (causality_diagnostics_ptr) {
+        filenames.push_back(causality_diagnostics_ptr->get_filename());
+    }
+    if (causality_statistics_ptr) {
+        const auto statistics_filenames = (
+                        causality_statistics_ptr->get_output_filenames());
+        filenames.insert(filenames.end(), statistics_filenames.begin(),
+                         statistics_filenames.end());
+    }
+    if (DATA.instrumentation == 2) {
+        filenames.push_back(DATA.instrumentation_filename);
+    }
+    checkpoint.add_file_sizes(filenames);
+    checkpoint.write();
+}
+
+
+void Evolve::read_checkpoint(EvolutionLoopState &state, SCGrid &arena_prev,
+                             SCGrid &arena_current, SCGrid &arena_future,
+                             SCGrid &arena_freezeout) {
+    CheckpointReader checkpoint(DATA.checkpoint_filename);
+    double tau0 = 0., delta_tau_input = 0.;
+    checkpoint.get(tau0);
+    checkpoint.get(delta_tau_input);
+    if (tau0 != DATA.tau0 || delta_tau_input != DATA.delta_tau_input) {
+        music_message << "The checkpoint " << DATA.checkpoint_filename
+                      << " was written by a run with another tau_0 "
+                      << "or Delta_Tau!";
+        music_message.flush("error");
+        exit(1);
+    }
+    checkpoint.get(state);
+    checkpoint.get(freezeout_dtau_);
+    checkpoint.get(dtau_prev_);
+    checkpoint.get(freezeout_region);
+    checkpoint.get_grid(arena_prev);
+    checkpoint.get_grid(arena_current);
+    checkpoint.get_grid(arena_future);
+    checkpoint.get_grid(arena_freezeout);
+    advance.read_checkpoint(checkpoint, arena_prev, arena_current,
+                            arena_future);
+    if (DATA.output_vorticity == 1 && !DATA.boost_invariant) {
+        checkpoint.get_grid(vorticity_freezeout_);
+    }
+    observables_.read_checkpoint(checkpoint);
+    if (causality_statistics_ptr) {
+        causality_statistics_ptr->read_checkpoint(checkpoint);
+    }
+    checkpoint.restore_file_sizes();
+    checkpoint.check_end();
+    music_message << "Restart from " << DATA.checkpoint_filename
+                  << " at time step " << state.it << ", tau = " << state.tau
+                  << " fm/c";
+    music_message.flush("info");
+}
+
+
+void Evolve::open_freezeout_surface_file(const double tau,
+                                         const double epsFO,
+                                         const int thread_id,
+                                         std::ofstream &s_file) const {
     std::ios_base::openmode modes;
 
-    if (surface_in_binary) {
+    if (DATA.freeze_surface_in_binary) {
         modes=std::ios::out | std::ios::binary;
     } else {
         modes=std::ios::out;
@@ -350,346 +1043,292 @@ int Evolve::FindFreezeOutSurface_Cornelius_XY(double tau, int ieta,
 
     // Only append at the end of the file if it's not the first timestep
     // (that is, overwrite file at first timestep)
-    if (tau != DATA.tau0+DATA.delta_tau) {
+    if (tau != tau_first_step_) {
         modes = modes | std::ios::app;
     }
 
-    s_file.open(strs_name.str().c_str(), modes);
+    s_file.open(get_freezeout_surface_filename(epsFO, thread_id).c_str(),
+                modes);
+}
 
-    const int dim = 4;
-    int intersections = 0;
 
-    facTau      = DATA.facTau;   // step to skip in tau direction
-    int fac_x   = DATA.fac_x;
-    int fac_y   = DATA.fac_y;
-    int fac_eta = 1;
+void Evolve::FindFreezeOutSurface_Cornelius_cube(
+        const double tau, const FreezeoutCube *cubes, const int n_levels,
+        SCGrid &arena_current, const SCGrid &arena_freezeout,
+        const std::vector<double> &epsFO_fm, FreezeoutWorkspace &workspace,
+        std::vector<std::ofstream> &s_files) {
+    const bool surface_in_binary = DATA.freeze_surface_in_binary;
+    const int nx = arena_current.nX();
+    const int ny = arena_current.nY();
 
-    const double DTAU = facTau*DATA.delta_tau;
+    const int fac_x   = DATA.fac_x;
+    const int fac_y   = DATA.fac_y;
+    const int fac_eta = 1;
+
+    const int ix = cubes[0].ix;
+    const int iy = cubes[0].iy;
+    const int ieta = cubes[0].ieta;
+
+    // the eta side of the cube is the distance of its eta slices
+    const double DTAU = freezeout_dtau_;
     const double DX   = fac_x*DATA.delta_x;
     const double DY   = fac_y*DATA.delta_y;
-    const double DETA = fac_eta*DATA.delta_eta;
+    const double DETA = fac_eta*eta_grid_.get_distance_to_next(ieta);
 
-    U_derivative u_derivative_helper(DATA, eos);
+    U_derivative &u_derivative_helper = workspace.u_derivative;
+    pretty_ostream &music_message = workspace.music_message;
+    auto &fluid_cube = workspace.fluid_cube;
+    auto &fluid_aux_cube = workspace.fluid_aux_cube;
+    double *cube = workspace.cube;
 
-    // initialize Cornelius
+    // set up Cornelius for the cube
     double lattice_spacing[4] = {DTAU, DX, DY, DETA};
-    std::shared_ptr<Cornelius> cornelius_ptr(new Cornelius());
-    cornelius_ptr->init(dim, epsFO, lattice_spacing);
+    Cornelius4D &cornelius_4d = workspace.cornelius_4d;
+    cornelius_4d.init(lattice_spacing);
 
-    // initialize the hyper-cube for Cornelius
-    Cell_small ****fluid_cube = new Cell_small*** [2];
-    Cell_aux ****fluid_aux_cube = new Cell_aux*** [2];
-    double ****cube = new double*** [2];
-    for (int i = 0; i < 2; i++) {
-        fluid_cube[i] = new Cell_small** [2];
-        fluid_aux_cube[i] = new Cell_aux** [2];
-        cube[i] = new double** [2];
-        for (int j = 0; j < 2; j++) {
-            fluid_cube[i][j] = new Cell_small* [2];
-            fluid_aux_cube[i][j] = new Cell_aux* [2];
-            cube[i][j] = new double* [2];
-            for (int k = 0; k < 2; k++) {
-                fluid_cube[i][j][k] = new Cell_small[2];
-                fluid_aux_cube[i][j][k] = new Cell_aux[2];
-                cube[i][j][k] = new double[2];
-                for (int l = 0; l < 2; l++)
-                    cube[i][j][k][l] = 0.0;
-            }
-        }
+    const double x = ix*(DATA.delta_x) - (DATA.x_size/2.0);
+    const double y = iy*(DATA.delta_y) - (DATA.y_size/2.0);
+    const double eta = eta_grid_.get_eta(ieta);
+    double x_fraction[2][4];
+
+    if (ix == 0 || ix >= nx - 2*fac_x || iy == 0 || iy >= ny - 2*fac_y) {
+        music_message << "Freeze-out cell at the boundary! "
+                      << "The grid is too small!";
+        music_message.flush("error");
+        exit(1);
     }
 
-    double x_fraction[2][4];
-    double eta = (DATA.delta_eta)*ieta - (DATA.eta_size)/2.0;
-    for (int ix = 0; ix < nx - fac_x; ix += fac_x) {
-        double x = ix*(DATA.delta_x) - (DATA.x_size/2.0);
-        for (int iy = 0; iy < ny - fac_y; iy += fac_y) {
-            double y = iy*(DATA.delta_y) - (DATA.y_size/2.0);
+    // prepare the hyper-cube
+    cube[ 0] = arena_freezeout(ix      , iy      , ieta        ).epsilon;
+    cube[ 2] = arena_freezeout(ix      , iy+fac_y, ieta        ).epsilon;
+    cube[ 4] = arena_freezeout(ix+fac_x, iy      , ieta        ).epsilon;
+    cube[ 6] = arena_freezeout(ix+fac_x, iy+fac_y, ieta        ).epsilon;
+    cube[ 8] = arena_current  (ix      , iy      , ieta        ).epsilon;
+    cube[10] = arena_current  (ix      , iy+fac_y, ieta        ).epsilon;
+    cube[12] = arena_current  (ix+fac_x, iy      , ieta        ).epsilon;
+    cube[14] = arena_current  (ix+fac_x, iy+fac_y, ieta        ).epsilon;
+    cube[ 1] = arena_freezeout(ix      , iy      , ieta+fac_eta).epsilon;
+    cube[ 3] = arena_freezeout(ix      , iy+fac_y, ieta+fac_eta).epsilon;
+    cube[ 5] = arena_freezeout(ix+fac_x, iy      , ieta+fac_eta).epsilon;
+    cube[ 7] = arena_freezeout(ix+fac_x, iy+fac_y, ieta+fac_eta).epsilon;
+    cube[ 9] = arena_current  (ix      , iy      , ieta+fac_eta).epsilon;
+    cube[11] = arena_current  (ix      , iy+fac_y, ieta+fac_eta).epsilon;
+    cube[13] = arena_current  (ix+fac_x, iy      , ieta+fac_eta).epsilon;
+    cube[15] = arena_current  (ix+fac_x, iy+fac_y, ieta+fac_eta).epsilon;
+
+    // the fluid cells and the vorticity tensors at the corners, shared by
+    // the elements of all the isotherms
+    for (int ii = 0; ii < 2; ii++)
+    for (int jj = 0; jj < 2; jj++)
+    for (int kk = 0; kk < 2; kk++) {
+        fluid_cube[0][ii][jj][kk] = arena_freezeout(
+                ix + ii*fac_x, iy + jj*fac_y, ieta + kk*fac_eta);
+        fluid_cube[1][ii][jj][kk] = arena_current(
+                ix + ii*fac_x, iy + jj*fac_y, ieta + kk*fac_eta);
+
+        if (DATA.output_vorticity == 0) continue;
+
+        // the vorticity tensors of the corners
+        // (filled by FindFreezeOutSurface_Cornelius)
+        double eta_local = eta + kk*DETA;
+        fluid_aux_cube[1][ii][jj][kk] = (
+            u_derivative_helper.transform_vorticity_to_tz(
+                vorticity_current_(ix + ii*fac_x, iy + jj*fac_y,
+                                   ieta + kk*fac_eta),
+                eta_local));
+        fluid_aux_cube[0][ii][jj][kk] = (
+            u_derivative_helper.transform_vorticity_to_tz(
+                vorticity_freezeout_(ix + ii*fac_x, iy + jj*fac_y,
+                                     ieta + kk*fac_eta),
+                eta_local));
+    }
 
-            // judge intersection (from Bjoern)
-            int intersect = 1;
-            if ((arena_current(ix+fac_x,iy+fac_y,ieta+fac_eta).epsilon-epsFO)
-                *(arena_freezeout(ix,iy,ieta).epsilon-epsFO)>0.)
-                if((arena_current(ix+fac_x,iy,ieta).epsilon-epsFO)
-                    *(arena_freezeout(ix,iy+fac_y,ieta+fac_eta).epsilon-epsFO)>0.)
-                    if((arena_current(ix,iy+fac_y,ieta).epsilon-epsFO)
-                        *(arena_freezeout(ix+fac_x,iy,ieta+fac_eta).epsilon-epsFO)>0.)
-                        if((arena_current(ix,iy,ieta+fac_eta).epsilon-epsFO)
-                            *(arena_freezeout(ix+fac_x,iy+fac_y,ieta).epsilon-epsFO)>0.)
-                            if((arena_current(ix+fac_x,iy+fac_y,ieta).epsilon-epsFO)
-                                *(arena_freezeout(ix,iy,ieta+fac_eta).epsilon-epsFO)>0.)
-                                if((arena_current(ix+fac_x,iy,ieta+fac_eta).epsilon-epsFO)
-                                    *(arena_freezeout(ix,iy+fac_y,ieta).epsilon-epsFO)>0.)
-                                    if((arena_current(ix,iy+fac_y,ieta+fac_eta).epsilon-epsFO)
-                                        *(arena_freezeout(ix+fac_x,iy,ieta).epsilon-epsFO)>0.)
-                                        if((arena_current(ix,iy,ieta).epsilon-epsFO)
-                                            *(arena_freezeout(ix+fac_x,iy+fac_y,ieta+fac_eta).epsilon-epsFO)>0.)
-                                                intersect=0;
-
-            if (intersect==0) continue;
-                
-            if (ix == 0 || ix >= nx - 2*fac_x
-                    || iy == 0 || iy >= ny - 2*fac_y) {
-                music_message << "Freeze-out cell at the boundary! "
-                              << "The grid is too small!";
-                music_message.flush("error");
-                exit(1);
+    // Now, the magic will happen in the Cornelius ...
+    cornelius_4d.set_cube(cube);
+
+    for (int ilevel = 0; ilevel < n_levels; ilevel++) {
+        const int i_freezesurf = cubes[ilevel].isurf;
+        const double epsFO = epsFO_fm[i_freezesurf];
+        std::ofstream &s_file = s_files[i_freezesurf];
+        const int n_elements = cornelius_4d.find_surface(epsFO);
+
+        // get positions of the freeze-out surface
+        // and interpolating results
+        for (int isurf = 0; isurf < n_elements; isurf++) {
+            // surface normal vector d^3 \sigma_\mu
+            double FULLSU[4];
+            for (int ii = 0; ii < 4; ii++)
+                FULLSU[ii] = cornelius_4d.get_normal(isurf)[ii];
+
+            // check the size of the surface normal vector
+            if (std::abs(FULLSU[0]) > (DX*DY*DETA+0.01)) {
+                music_message << "problem: volume in tau direction "
+                              << std::abs(FULLSU[0]) << "  > DX*DY*DETA = "
+                              << DX*DY*DETA;
+                music_message.flush("warning");
+            }
+            if (std::abs(FULLSU[1]) > (DTAU*DY*DETA+0.01)) {
+                music_message << "problem: volume in x direction "
+                              << std::abs(FULLSU[1])
+                              << "  > DTAU*DY*DETA = " << DTAU*DY*DETA;
+                music_message.flush("warning");
+            }
+            if (std::abs(FULLSU[2]) > (DX*DTAU*DETA+0.01)) {
+                music_message << "problem: volume in y direction "
+                              << std::abs(FULLSU[2])
+                              << "  > DX*DTAU*DETA = " << DX*DTAU*DETA;
+                music_message.flush("warning");
+            }
+            if (std::abs(FULLSU[3]) > (DX*DY*DTAU+0.01)) {
+                music_message << "problem: volume in eta direction "
+                              << std::abs(FULLSU[3]) << "  > DX*DY*DTAU = "
+                              << DX*DY*DTAU;
+                music_message.flush("warning");
             }
 
-            if (ix == 0 || ix >= nx - 2*fac_x
-                    || iy == 0 || iy >= ny - 2*fac_y) {
-                music_message << "Freeze-out cell at the boundary! "
-                              << "The grid is too small!";
+            // position of the freeze-out fluid cell
+            for (int ii = 0; ii < 4; ii++) {
+                x_fraction[1][ii] = cornelius_4d.get_centroid(isurf)[ii];
+                x_fraction[0][ii] =
+                    lattice_spacing[ii] - x_fraction[1][ii];
+            }
+            const double tau_center = tau - DTAU + x_fraction[1][0];
+            const double x_center = x + x_fraction[1][1];
+            const double y_center = y + x_fraction[1][2];
+            const double eta_center = eta + x_fraction[1][3];
+
+
+            // perform 4-d linear interpolation for all fluid quantities
+            auto fluid_center = four_dimension_linear_interpolation(
+                    lattice_spacing, x_fraction, fluid_cube);
+            Cell_aux fluid_aux_center;
+            if (DATA.output_vorticity == 1) {
+                fluid_aux_center = four_dimension_linear_interpolation(
+                        lattice_spacing, x_fraction, fluid_aux_cube);
+            }
+
+            // reconstruct q^\tau from the transverality criteria
+            FlowVec u_flow = fluid_center.u;
+            double q_mu[4] = {
+                fluid_center.Wmunu[10], fluid_center.Wmunu[11],
+                fluid_center.Wmunu[12], fluid_center.Wmunu[13]};
+            double q_regulated[4] = {0.0, 0.0, 0.0, 0.0};
+            regulate_qmu(u_flow, q_mu, q_regulated);
+            fluid_center.Wmunu[10] = q_regulated[0];
+            fluid_center.Wmunu[11] = q_regulated[1];
+            fluid_center.Wmunu[12] = q_regulated[2];
+            fluid_center.Wmunu[13] = q_regulated[3];
+
+            // regulate Wmunu according to transversality and traceless
+            double Wmunu_input[4][4];
+            double Wmunu_regulated[4][4];
+            Wmunu_input[0][0] = fluid_center.Wmunu[0];
+            Wmunu_input[0][1] = Wmunu_input[1][0] = fluid_center.Wmunu[1];
+            Wmunu_input[0][2] = Wmunu_input[2][0] = fluid_center.Wmunu[2];
+            Wmunu_input[0][3] = Wmunu_input[3][0] = fluid_center.Wmunu[3];
+            Wmunu_input[1][1] = fluid_center.Wmunu[4];
+            Wmunu_input[1][2] = Wmunu_input[2][1] = fluid_center.Wmunu[5];
+            Wmunu_input[1][3] = Wmunu_input[3][1] = fluid_center.Wmunu[6];
+            Wmunu_input[2][2] = fluid_center.Wmunu[7];
+            Wmunu_input[2][3] = Wmunu_input[3][2] = fluid_center.Wmunu[8];
+            Wmunu_input[3][3] = fluid_center.Wmunu[9];
+            regulate_Wmunu(u_flow, Wmunu_input, Wmunu_regulated);
+            fluid_center.Wmunu[0] = Wmunu_regulated[0][0];
+            fluid_center.Wmunu[1] = Wmunu_regulated[0][1];
+            fluid_center.Wmunu[2] = Wmunu_regulated[0][2];
+            fluid_center.Wmunu[3] = Wmunu_regulated[0][3];
+            fluid_center.Wmunu[4] = Wmunu_regulated[1][1];
+            fluid_center.Wmunu[5] = Wmunu_regulated[1][2];
+            fluid_center.Wmunu[6] = Wmunu_regulated[1][3];
+            fluid_center.Wmunu[7] = Wmunu_regulated[2][2];
+            fluid_center.Wmunu[8] = Wmunu_regulated[2][3];
+            fluid_center.Wmunu[9] = Wmunu_regulated[3][3];
+
+            // 4-dimension interpolation done
+            const double TFO = eos.get_temperature(epsFO,
+                                                   fluid_center.rhob);
+            if (TFO < 0) {
+                music_message << "TFO=" << TFO
+                              << "<0. ERROR. exiting.";
                 music_message.flush("error");
                 exit(1);
             }
+            const double muB = eos.get_muB(epsFO, fluid_center.rhob);
+            const double muS = eos.get_muS(epsFO, fluid_center.rhob);
+            const double muC = eos.get_muC(epsFO, fluid_center.rhob);
 
-            // if intersect, prepare for the hyper-cube
-            intersections++;
-
-            cube[0][0][0][0] = arena_freezeout(ix      , iy      , ieta        ).epsilon;
-            cube[0][0][1][0] = arena_freezeout(ix      , iy+fac_y, ieta        ).epsilon;
-            cube[0][1][0][0] = arena_freezeout(ix+fac_x, iy      , ieta        ).epsilon;
-            cube[0][1][1][0] = arena_freezeout(ix+fac_x, iy+fac_y, ieta        ).epsilon;
-            cube[1][0][0][0] = arena_current  (ix      , iy      , ieta        ).epsilon;
-            cube[1][0][1][0] = arena_current  (ix      , iy+fac_y, ieta        ).epsilon;
-            cube[1][1][0][0] = arena_current  (ix+fac_x, iy      , ieta        ).epsilon;
-            cube[1][1][1][0] = arena_current  (ix+fac_x, iy+fac_y, ieta        ).epsilon;
-            cube[0][0][0][1] = arena_freezeout(ix      , iy      , ieta+fac_eta).epsilon;
-            cube[0][0][1][1] = arena_freezeout(ix      , iy+fac_y, ieta+fac_eta).epsilon;
-            cube[0][1][0][1] = arena_freezeout(ix+fac_x, iy      , ieta+fac_eta).epsilon;
-            cube[0][1][1][1] = arena_freezeout(ix+fac_x, iy+fac_y, ieta+fac_eta).epsilon;
-            cube[1][0][0][1] = arena_current  (ix      , iy      , ieta+fac_eta).epsilon;
-            cube[1][0][1][1] = arena_current  (ix      , iy+fac_y, ieta+fac_eta).epsilon;
-            cube[1][1][0][1] = arena_current  (ix+fac_x, iy      , ieta+fac_eta).epsilon;
-            cube[1][1][1][1] = arena_current  (ix+fac_x, iy+fac_y, ieta+fac_eta).epsilon;
-
-            // Now, the magic will happen in the Cornelius ...
-            cornelius_ptr->find_surface_4d(cube);
+            const double pressure = eos.get_pressure(epsFO, fluid_center.rhob);
+            const double eps_plus_p_over_T_FO = (epsFO + pressure)/TFO;
 
-            // get positions of the freeze-out surface
-            // and interpolating results
-            for (int isurf = 0; isurf < cornelius_ptr->get_Nelements();
-                 isurf++) {
-                // surface normal vector d^3 \sigma_\mu
-                double FULLSU[4];
+            // finally output results !!!!
+            if (surface_in_binary) {
+                const int FOsize = 34 + DATA.output_vorticity*24;
+                float array[FOsize];
+                array[0] = static_cast<float>(tau_center);
+                array[1] = static_cast<float>(x_center);
+                array[2] = static_cast<float>(y_center);
+                array[3] = static_cast<float>(eta_center);
                 for (int ii = 0; ii < 4; ii++)
-                    FULLSU[ii] = cornelius_ptr->get_normal_elem(isurf, ii);
-
-                // check the size of the surface normal vector
-                if (std::abs(FULLSU[0]) > (DX*DY*DETA+0.01)) {
-                    music_message << "problem: volume in tau direction "
-                                  << std::abs(FULLSU[0]) << "  > DX*DY*DETA = "
-                                  << DX*DY*DETA;
-                    music_message.flush("warning");
-                }
-                if (std::abs(FULLSU[1]) > (DTAU*DY*DETA+0.01)) {
-                    music_message << "problem: volume in x direction "
-                                  << std::abs(FULLSU[1])
-                                  << "  > DTAU*DY*DETA = " << DTAU*DY*DETA;
-                    music_message.flush("warning");
-                }
-                if (std::abs(FULLSU[2]) > (DX*DTAU*DETA+0.01)) {
-                    music_message << "problem: volume in y direction "
-                                  << std::abs(FULLSU[2])
-                                  << "  > DX*DTAU*DETA = " << DX*DTAU*DETA;
-                    music_message.flush("warning");
-                }
-                if (std::abs(FULLSU[3]) > (DX*DY*DTAU+0.01)) {
-                    music_message << "problem: volume in eta direction "
-                                  << std::abs(FULLSU[3]) << "  > DX*DY*DTAU = "
-                                  << DX*DY*DTAU;
-                    music_message.flush("warning");
-                }
-
-                // position of the freeze-out fluid cell
-                for (int ii = 0; ii < 4; ii++) {
-                    x_fraction[1][ii] =
-                        cornelius_ptr->get_centroid_elem(isurf, ii);
-                    x_fraction[0][ii] =
-                        lattice_spacing[ii] - x_fraction[1][ii];
-                }
-                const double tau_center = tau - DTAU + x_fraction[1][0];
-                const double x_center = x + x_fraction[1][1];
-                const double y_center = y + x_fraction[1][2];
-                const double eta_center = eta + x_fraction[1][3];
-
-
-                // perform 4-d linear interpolation for all fluid quantities
-                for (int ii = 0; ii < 2; ii++)
-                for (int jj = 0; jj < 2; jj++)
-                for (int kk = 0; kk < 2; kk++) {
-                    fluid_cube[0][ii][jj][kk] = arena_freezeout(
-                            ix + ii*fac_x, iy + jj*fac_y, ieta + kk*fac_eta);
-                    fluid_cube[1][ii][jj][kk] = arena_current(
-                            ix + ii*fac_x, iy + jj*fac_y, ieta + kk*fac_eta);
-
-                    if (DATA.output_vorticity == 0) continue;
-
-                    // compute the vorticity tensors
-                    Cell_aux aux_tmp;
-                    double eta_local = eta + kk*DETA;
-                    u_derivative_helper.compute_vorticity_shell(
-                        tau, arena_prev, arena_current,
-                        ieta + kk*fac_eta, ix + ii*fac_eta, iy + jj*fac_eta,
-                        eta_local,
-                        aux_tmp.omega_kSP, aux_tmp.omega_k,
-                        aux_tmp.omega_th, aux_tmp.omega_T);
-                    fluid_aux_cube[1][ii][jj][kk] = aux_tmp;
-                    u_derivative_helper.compute_vorticity_shell(
-                        tau - DTAU, arena_freezeout_prev, arena_freezeout,
-                        ieta + kk*fac_eta, ix + ii*fac_eta, iy + jj*fac_eta,
-                        eta_local,
-                        aux_tmp.omega_kSP, aux_tmp.omega_k,
-                        aux_tmp.omega_th, aux_tmp.omega_T);
-                    fluid_aux_cube[0][ii][jj][kk] = aux_tmp;
-                }
-                auto fluid_center = four_dimension_linear_interpolation(
-                        lattice_spacing, x_fraction, fluid_cube);
-                Cell_aux fluid_aux_center;
+                    array[4+ii] = static_cast<float>(FULLSU[ii]);
+                for (int ii = 0; ii < 4; ii++)
+                    array[8+ii] = static_cast<float>(fluid_center.u[ii]);
+                array[12] = static_cast<float>(epsFO);
+                array[13] = static_cast<float>(TFO);
+                array[14] = static_cast<float>(muB);
+                array[15] = static_cast<float>(muS);
+                array[16] = static_cast<float>(muC);
+                array[17] = static_cast<float>(eps_plus_p_over_T_FO);
+                for (int ii = 0; ii < 10; ii++)
+                    array[18+ii] = static_cast<float>(fluid_center.Wmunu[ii]);
+                array[28] = fluid_center.pi_b;
+                array[29] = fluid_center.rhob;
+                for (int ii = 0; ii < 4; ii++)
+                    array[30+ii] = static_cast<float>(
+                                            fluid_center.Wmunu[10+ii]);
                 if (DATA.output_vorticity == 1) {
-                    fluid_aux_center = four_dimension_linear_interpolation(
-                            lattice_spacing, x_fraction, fluid_aux_cube);
-                }
-
-                // reconstruct q^\tau from the transverality criteria
-                FlowVec u_flow = fluid_center.u;
-                double q_mu[4] = {
-                    fluid_center.Wmunu[10], fluid_center.Wmunu[11],
-                    fluid_center.Wmunu[12], fluid_center.Wmunu[13]};
-                double q_regulated[4] = {0.0, 0.0, 0.0, 0.0};
-                regulate_qmu(u_flow, q_mu, q_regulated);
-                fluid_center.Wmunu[10] = q_regulated[0];
-                fluid_center.Wmunu[11] = q_regulated[1];
-                fluid_center.Wmunu[12] = q_regulated[2];
-                fluid_center.Wmunu[13] = q_regulated[3];
-
-                // regulate Wmunu according to transversality and traceless
-                double Wmunu_input[4][4];
-                double Wmunu_regulated[4][4];
-                Wmunu_input[0][0] = fluid_center.Wmunu[0];
-                Wmunu_input[0][1] = Wmunu_input[1][0] = fluid_center.Wmunu[1];
-                Wmunu_input[0][2] = Wmunu_input[2][0] = fluid_center.Wmunu[2];
-                Wmunu_input[0][3] = Wmunu_input[3][0] = fluid_center.Wmunu[3];
-                Wmunu_input[1][1] = fluid_center.Wmunu[4];
-                Wmunu_input[1][2] = Wmunu_input[2][1] = fluid_center.Wmunu[5];
-                Wmunu_input[1][3] = Wmunu_input[3][1] = fluid_center.Wmunu[6];
-                Wmunu_input[2][2] = fluid_center.Wmunu[7];
-                Wmunu_input[2][3] = Wmunu_input[3][2] = fluid_center.Wmunu[8];
-                Wmunu_input[3][3] = fluid_center.Wmunu[9];
-                regulate_Wmunu(u_flow, Wmunu_input, Wmunu_regulated);
-                fluid_center.Wmunu[0] = Wmunu_regulated[0][0];
-                fluid_center.Wmunu[1] = Wmunu_regulated[0][1];
-                fluid_center.Wmunu[2] = Wmunu_regulated[0][2];
-                fluid_center.Wmunu[3] = Wmunu_regulated[0][3];
-                fluid_center.Wmunu[4] = Wmunu_regulated[1][1];
-                fluid_center.Wmunu[5] = Wmunu_regulated[1][2];
-                fluid_center.Wmunu[6] = Wmunu_regulated[1][3];
-                fluid_center.Wmunu[7] = Wmunu_regulated[2][2];
-                fluid_center.Wmunu[8] = Wmunu_regulated[2][3];
-                fluid_center.Wmunu[9] = Wmunu_regulated[3][3];
-
-                // 4-dimension interpolation done
-                const double TFO = eos.get_temperature(epsFO,
-                                                       fluid_center.rhob);
-                if (TFO < 0) {
-                    music_message << "TFO=" << TFO
-                                  << "<0. ERROR. exiting.";
-                    music_message.flush("error");
-                    exit(1);
-                }
-                const double muB = eos.get_muB(epsFO, fluid_center.rhob);
-                const double muS = eos.get_muS(epsFO, fluid_center.rhob);
-                const double muC = eos.get_muC(epsFO, fluid_center.rhob);
-
-                const double pressure = eos.get_pressure(epsFO, fluid_center.rhob);
-                const double eps_plus_p_over_T_FO = (epsFO + pressure)/TFO;
-
-                // finally output results !!!!
-                if (surface_in_binary) {
-                    const int FOsize = 34 + DATA.output_vorticity*24;
-                    float array[FOsize];
-                    array[0] = static_cast<float>(tau_center);
-                    array[1] = static_cast<float>(x_center);
-                    array[2] = static_cast<float>(y_center);
-                    array[3] = static_cast<float>(eta_center);
-                    for (int ii = 0; ii < 4; ii++)
-                        array[4+ii] = static_cast<float>(FULLSU[ii]);
-                    for (int ii = 0; ii < 4; ii++)
-                        array[8+ii] = static_cast<float>(fluid_center.u[ii]);
-                    array[12] = static_cast<float>(epsFO);
-                    array[13] = static_cast<float>(TFO);
-                    array[14] = static_cast<float>(muB);
-                    array[15] = static_cast<float>(muS);
-                    array[16] = static_cast<float>(muC);
-                    array[17] = static_cast<float>(eps_plus_p_over_T_FO);
-                    for (int ii = 0; ii < 10; ii++)
-                        array[18+ii] = static_cast<float>(fluid_center.Wmunu[ii]);
-                    array[28] = fluid_center.pi_b;
-                    array[29] = fluid_center.rhob;
-                    for (int ii = 0; ii < 4; ii++)
-                        array[30+ii] = static_cast<float>(fluid_center.Wmunu[10+ii]);
-                    if (DATA.output_vorticity == 1) {
-                        for (int ii = 0; ii < 6; ii++) {
-                            array[34+ii] = fluid_aux_center.omega_kSP[ii]/TFO;  // no minus sign because its definition is opposite to the kinetic vorticity
-                            // the extra minus sign is from metric
-                            // output quantities for g = (1, -1, -1, -1)
-                            array[40+ii] = -fluid_aux_center.omega_k[ii]/TFO;
-                            array[46+ii] = -fluid_aux_center.omega_th[ii];
-                            array[52+ii] = (-fluid_aux_center.omega_T[ii]
-                                            /TFO/TFO);
-                        }
+                    for (int ii = 0; ii < 6; ii++) {
+                        array[34+ii] = fluid_aux_center.omega_kSP[ii]/TFO;  // no minus sign because its definition is opposite to the kinetic vorticity
+                        // the extra minus sign is from metric
+                        // output quantities for g = (1, -1, -1, -1)
+                        array[40+ii] = -fluid_aux_center.omega_k[ii]/TFO;
+                        array[46+ii] = -fluid_aux_center.omega_th[ii];
+                        array[52+ii] = (-fluid_aux_center.omega_T[ii]
+                                        /TFO/TFO);
                     }
+                }
+                if (freezeout_surface_ptr != nullptr) {
+                    freezeout_surface_ptr->add_element(i_freezesurf, array,
+                                                       FOsize);
+                } else {
                     for (int i = 0; i < FOsize; i++)
                         s_file.write((char*) &(array[i]), sizeof(float));
-                } else {
+                }
+            } else {
+                s_file << std::scientific << std::setprecision(10)
+                       << tau_center << " " << x_center << " "
+                       << y_center << " " << eta_center << " "
+                       << FULLSU[0] << " " << FULLSU[1] << " "
+                       << FULLSU[2] << " " << FULLSU[3] << " "
+                       << fluid_center.u[0] << " " << fluid_center.u[1] << " "
+                       << fluid_center.u[2] << " " << fluid_center.u[3] << " "
+                       << epsFO << " " << TFO << " " << muB << " "
+                       << muS << " " << muC << " "
+                       << eps_plus_p_over_T_FO << " ";
+                for (int ii = 0; ii < 10; ii++)
                     s_file << std::scientific << std::setprecision(10)
-                           << tau_center << " " << x_center << " "
-                           << y_center << " " << eta_center << " "
-                           << FULLSU[0] << " " << FULLSU[1] << " "
-                           << FULLSU[2] << " " << FULLSU[3] << " "
-                           << fluid_center.u[0] << " " << fluid_center.u[1] << " "
-                           << fluid_center.u[2] << " " << fluid_center.u[3] << " "
-                           << epsFO << " " << TFO << " " << muB << " "
-                           << muS << " " << muC << " "
-                           << eps_plus_p_over_T_FO << " ";
-                    for (int ii = 0; ii < 10; ii++)
+                           << fluid_center.Wmunu[ii] << " ";
+                if (DATA.turn_on_bulk)
+                    s_file << fluid_center.pi_b << " ";
+                if (DATA.turn_on_rhob)
+                    s_file << fluid_center.rhob << " ";
+                if (DATA.turn_on_diff)
+                    for (int ii = 10; ii < 14; ii++)
                         s_file << std::scientific << std::setprecision(10)
                                << fluid_center.Wmunu[ii] << " ";
-                    if (DATA.turn_on_bulk)
-                        s_file << fluid_center.pi_b << " ";
-                    if (DATA.turn_on_rhob)
-                        s_file << fluid_center.rhob << " ";
-                    if (DATA.turn_on_diff)
-                        for (int ii = 10; ii < 14; ii++)
-                            s_file << std::scientific << std::setprecision(10)
-                                   << fluid_center.Wmunu[ii] << " ";
-                    s_file << std::endl;
-                }
+                s_file << std::endl;
             }
         }
     }
-    s_file.close();
-
-    // clean up
-    for (int i = 0; i < 2; i++) {
-        for (int j = 0; j < 2; j++) {
-            for (int k = 0; k < 2; k++) {
-                delete [] cube[i][j][k];
-                delete [] fluid_cube[i][j][k];
-                delete [] fluid_aux_cube[i][j][k];
-            }
-            delete [] cube[i][j];
-            delete [] fluid_cube[i][j];
-            delete [] fluid_aux_cube[i][j];
-        }
-        delete [] cube[i];
-        delete [] fluid_cube[i];
-        delete [] fluid_aux_cube[i];
-    }
-    delete [] cube;
-    delete [] fluid_cube;
-    delete [] fluid_aux_cube;
-    return(intersections);
 }
 
 
@@ -701,27 +1340,40 @@ int Evolve::FreezeOut_equal_tau_Surface(double tau,
     // this function will be trigged if freezeout_lowtemp_flag == 1
     const int neta = arena_current.nEta();
     const int fac_eta = 1;
+    // the owned layers of a slab
+    const int ieta_start = is_distributed() ? domain_ptr_->get_owned_eta_min()
+                                            : 0;
+    const int ieta_end = (is_distributed()
+                          ? std::min(domain_ptr_->get_owned_eta_max(),
+                                     neta - fac_eta)
+                          : neta - fac_eta);
 
     for (int i_freezesurf = 0; i_freezesurf < n_freeze_surf; i_freezesurf++) {
         double epsFO = epsFO_list[i_freezesurf]/hbarc;
         if (!DATA.boost_invariant) {
             #pragma omp parallel for
-            for (int ieta = 0; ieta < neta - fac_eta; ieta += fac_eta) {
+            for (int ieta = ieta_start; ieta < ieta_end; ieta += fac_eta) {
                 int thread_id = omp_get_thread_num();
                 FreezeOut_equal_tau_Surface_XY(tau,  ieta, arena_current,
-                                               thread_id, epsFO);
+                                               thread_id, i_freezesurf,
+                                               epsFO);
             }
         } else {
-            FreezeOut_equal_tau_Surface_XY(tau, 0, arena_current, 0, epsFO);
+            FreezeOut_equal_tau_Surface_XY(tau, 0, arena_current, 0,
+                                           i_freezesurf, epsFO);
         }
     }
+    if (freezeout_surface_ptr != nullptr) {
+        freezeout_surface_ptr->update_memory_use();
+    }
     return(0);
 }
 
 
 void Evolve::FreezeOut_equal_tau_Surface_XY(double tau, int ieta,
                                             SCGrid &arena_current,
-                                            int thread_id, double epsFO) {
+                                            int thread_id, int isurf,
+                                            double epsFO) {
     const bool surface_in_binary = DATA.freeze_surface_in_binary;
     double epsFO_low = 0.05/hbarc;        // 1/fm^4
 
@@ -730,8 +1382,7 @@ void Evolve::FreezeOut_equal_tau_Surface_XY(double tau, int ieta,
 
     std::stringstream strs_name;
     if (!DATA.boost_invariant) {
-        strs_name << "surface_eps_" << std::setprecision(4) << epsFO*hbarc
-                  << "_" << thread_id << ".dat";
+        strs_name << get_freezeout_surface_filename(epsFO, thread_id);
     } else {
         strs_name << "surface_eps_" << std::setprecision(4) << epsFO*hbarc
                   << ".dat";
@@ -747,11 +1398,13 @@ void Evolve::FreezeOut_equal_tau_Surface_XY(double tau, int ieta,
 
     // Only append at the end of the file if it's not the first timestep
     // (that is, overwrite file at first timestep)
-    if (tau != DATA.tau0+DATA.delta_tau) {
+    if (tau != tau_first_step_) {
             modes = modes | std::ios::app;
     }
 
-    s_file.open(strs_name.str().c_str(), modes);
+    if (freezeout_surface_ptr == nullptr) {
+        s_file.open(strs_name.str().c_str(), modes);
+    }
 
     const int fac_x   = DATA.fac_x;
     const int fac_y   = DATA.fac_y;
@@ -759,9 +1412,9 @@ void Evolve::FreezeOut_equal_tau_Surface_XY(double tau, int ieta,
 
     const double DX   = fac_x*DATA.delta_x;
     const double DY   = fac_y*DATA.delta_y;
-    const double DETA = fac_eta*DATA.delta_eta;
+    const double DETA = fac_eta*eta_grid_.get_width(ieta);
 
-    double eta = (DATA.delta_eta)*ieta - (DATA.eta_size)/2.0;
+    double eta = eta_grid_.get_eta(ieta);
     for (int ix = 0; ix < nx - fac_x; ix += fac_x) {
         double x = ix*(DATA.delta_x) - (DATA.x_size/2.0); 
         for (int iy = 0; iy < ny - fac_y; iy += fac_y) {
@@ -915,8 +1568,12 @@ void Evolve::FreezeOut_equal_tau_Surface_XY(double tau, int ieta,
                                         /T_local/T_local);
                     }
                 }
-                for (int i = 0; i < FOsize; i++) {
-                    s_file.write((char*) &(array[i]), sizeof(float));
+                if (freezeout_surface_ptr != nullptr) {
+                    freezeout_surface_ptr->add_element(isurf, array, FOsize);
+                } else {
+                    for (int i = 0; i < FOsize; i++) {
+                        s_file.write((char*) &(array[i]), sizeof(float));
+                    }
                 }
             } else {
                 s_file << std::scientific << std::setprecision(10) 
@@ -950,16 +1607,83 @@ void Evolve::FreezeOut_equal_tau_Surface_XY(double tau, int ieta,
 
 
 int Evolve::FindFreezeOutSurface_boostinvariant_Cornelius(
-                double tau, SCGrid &arena_current, SCGrid &arena_freezeout) {
+                double tau, const ActiveRegion &region,
+                SCGrid &arena_current, const SCGrid &arena_freezeout) {
     const bool surface_in_binary = DATA.freeze_surface_in_binary;
-    // find boost-invariant hyper-surfaces
-    int *all_frozen = new int[n_freeze_surf];
+    const int nx = arena_current.nX();
+    const int ny = arena_current.nY();
+    const int fac_x = DATA.fac_x;
+    const int fac_y = DATA.fac_y;
+
+    // the cubes crossed by any of the isotherms (from Bjoern), the
+    // single eta layer has no extent in eta
+    std::vector<double> epsFO_fm(n_freeze_surf);
     for (int i_freezesurf = 0; i_freezesurf < n_freeze_surf; i_freezesurf++) {
-        double epsFO = epsFO_list[i_freezesurf]/hbarc;
+        epsFO_fm[i_freezesurf] = epsFO_list[i_freezesurf]/hbarc;  // 1/fm^4
+    }
+    int ix_start, ix_end, iy_start, iy_end;
+    get_freezeout_scan_range(region, nx, ny, fac_x, fac_y,
+                             ix_start, ix_end, iy_start, iy_end);
+    freezeout_prescreen_.find_cubes(arena_current, arena_freezeout, epsFO_fm,
+                                    ix_start, ix_end, fac_x,
+                                    iy_start, iy_end, fac_y, 0, 1, 0,
+                                    freezeout_cubes_);
+
+    // the work items are the x rows with the cubes of all the isotherms,
+    // ordered by iy so that the corners of a cube are loaded once for the
+    // isotherms crossing it
+    const int n_rows = std::max(0, (ix_end - ix_start + fac_x - 1)/fac_x);
+    std::vector<int> row_offsets(n_rows + 1, 0);
+    std::vector<int> intersections(n_freeze_surf, 0);
+    for (const auto &fo_cube : freezeout_cubes_) {
+        row_offsets[(fo_cube.ix - ix_start)/fac_x + 1]++;
+        intersections[fo_cube.isurf]++;
+    }
+    for (int irow = 0; irow < n_rows; irow++) {
+        row_offsets[irow + 1] += row_offsets[irow];
+    }
+    freezeout_row_cubes_.resize(freezeout_cubes_.size());
+    std::vector<int> row_end(row_offsets.begin(), row_offsets.end() - 1);
+    for (const auto &fo_cube : freezeout_cubes_) {
+        freezeout_row_cubes_[row_end[(fo_cube.ix - ix_start)/fac_x]++] = (
+                                                                    fo_cube);
+    }
+    freezeout_row_buffers_.resize(static_cast<size_t>(n_rows)*n_freeze_surf);
+
+    #pragma omp parallel
+    {
+        FreezeoutWorkspace &workspace = (
+                            *freezeout_workspaces_[omp_get_thread_num()]);
+        #pragma omp for schedule(dynamic)
+        for (int irow = 0; irow < n_rows; irow++) {
+            FreezeoutCube *row_cubes = (
+                                &freezeout_row_cubes_[row_offsets[irow]]);
+            const int n_cubes = row_offsets[irow + 1] - row_offsets[irow];
+            std::stable_sort(row_cubes, row_cubes + n_cubes,
+                             [](const FreezeoutCube &a,
+                                const FreezeoutCube &b) {
+                                 return(a.iy < b.iy);});
+            FreezeoutElementBuffer *buffers = (
+                &freezeout_row_buffers_[static_cast<size_t>(irow)
+                                        *n_freeze_surf]);
+            for (int i_freezesurf = 0; i_freezesurf < n_freeze_surf;
+                    i_freezesurf++) {
+                buffers[i_freezesurf].elements.clear();
+                buffers[i_freezesurf].text.clear();
+            }
+            FindFreezeOutSurface_boostinvariant_Cornelius_row(
+                tau, row_cubes, n_cubes, arena_current, arena_freezeout,
+                epsFO_fm, workspace, buffers);
+        }
+    }
 
+    // the rows are written in order, as by the serial scan
+    const int FOsize = 34;
+    int all_frozen_flag = 1;
+    for (int i_freezesurf = 0; i_freezesurf < n_freeze_surf; i_freezesurf++) {
         std::stringstream strs_name;
-        strs_name << "surface_eps_" << std::setprecision(4) << epsFO*hbarc
-                  << ".dat";
+        strs_name << "surface_eps_" << std::setprecision(4)
+                  << epsFO_fm[i_freezesurf]*hbarc << ".dat";
 
         std::ofstream s_file;
         std::ios_base::openmode modes;
@@ -972,278 +1696,261 @@ int Evolve::FindFreezeOutSurface_boostinvariant_Cornelius(
 
         // Only append at the end of the file if it's not the first timestep
         // (that is, overwrite file at first timestep)
-        if (tau != DATA.tau0+DATA.delta_tau) {
+        if (tau != tau_first_step_) {
                 modes = modes | std::ios::app;
         }
 
-        s_file.open(strs_name.str().c_str(), modes);
-
-        const int nx = arena_current.nX();
-        const int ny = arena_current.nY();
-        double FULLSU[4];  // d^3 \sigma_\mu
+        if (freezeout_surface_ptr == nullptr) {
+            s_file.open(strs_name.str().c_str(), modes);
+        }
+        for (int irow = 0; irow < n_rows; irow++) {
+            const FreezeoutElementBuffer &buffer = freezeout_row_buffers_[
+                            static_cast<size_t>(irow)*n_freeze_surf
+                            + i_freezesurf];
+            if (freezeout_surface_ptr != nullptr) {
+                // the vorticity fields are not computed here
+                for (size_t i = 0; i < buffer.elements.size(); i += FOsize) {
+                    freezeout_surface_ptr->add_element(
+                            i_freezesurf, &buffer.elements[i], FOsize);
+                }
+            } else if (surface_in_binary) {
+                s_file.write(
+                    reinterpret_cast<const char*>(buffer.elements.data()),
+                    buffer.elements.size()*sizeof(float));
+            } else {
+                s_file << buffer.text;
+            }
+        }
+        s_file.close();
 
-        int intersect;
-        int intersections = 0;
+        // judge whether the entire fireball is freeze-out
+        if (intersections[i_freezesurf] != 0) all_frozen_flag = 0;
+    }
+    if (surface_stream_ptr_ != nullptr) publish_freezeout_surface_chunk();
+    if (freezeout_surface_ptr != nullptr) {
+        freezeout_surface_ptr->update_memory_use();
+    }
 
-        facTau    = DATA.facTau;   // step to skip in tau direction
-        int fac_x = DATA.fac_x;
-        int fac_y = DATA.fac_y;
+    if (all_frozen_flag == 1) {
+        pretty_ostream music_message;
+        music_message.info("All cells frozen out. Exiting.");
+    }
+    return(all_frozen_flag);
+}
 
-        const double DX   = fac_x*DATA.delta_x;
-        const double DY   = fac_y*DATA.delta_y;
-        const double DETA = 1.0;
-        const double DTAU = facTau*DATA.delta_tau;
 
-        double lattice_spacing[3] = {DTAU, DX, DY};
-        double x_fraction[2][3];
+void Evolve::FindFreezeOutSurface_boostinvariant_Cornelius_row(
+        const double tau, const FreezeoutCube *cubes, const int n_cubes,
+        const SCGrid &arena_current, const SCGrid &arena_freezeout,
+        const std::vector<double> &epsFO_fm, FreezeoutWorkspace &workspace,
+        FreezeoutElementBuffer *buffers) {
+    const bool surface_in_binary = DATA.freeze_surface_in_binary;
+    const int nx = arena_current.nX();
+    const int ny = arena_current.nY();
+    double FULLSU[4];  // d^3 \sigma_\mu
 
-        // initialize Cornelius
-        const int dim = 3;
-        std::shared_ptr<Cornelius> cornelius_ptr(new Cornelius());
-        cornelius_ptr->init(dim, epsFO, lattice_spacing);
+    const int fac_x = DATA.fac_x;
+    const int fac_y = DATA.fac_y;
 
-        // initialize the hyper-cube for Cornelius
-        Cell_small ***fluid_cube = new Cell_small ** [2];
-        double ***cube = new double ** [2];
-        for (int i = 0; i < 2; i++) {
-            fluid_cube[i] = new Cell_small * [2];
-            cube[i] = new double * [2];
-            for (int j = 0; j < 2; j++) {
-                fluid_cube[i][j] = new Cell_small[2];
-                cube[i][j] = new double[2];
-                for (int k = 0; k < 2; k++)
-                    cube[i][j][k] = 0.0;
+    const double DX   = fac_x*DATA.delta_x;
+    const double DY   = fac_y*DATA.delta_y;
+    const double DETA = 1.0;
+    const double DTAU = freezeout_dtau_;
+
+    double lattice_spacing[3] = {DTAU, DX, DY};
+    double x_fraction[2][3];
+
+    const int dim = 3;
+    Cornelius *cornelius_ptr = &workspace.cornelius;
+    auto &cube = workspace.cube_3d;
+    auto &fluid_cube = workspace.fluid_cube_3d;
+    std::ostringstream &s_file = workspace.text;
+    pretty_ostream &music_message = workspace.music_message;
+
+    for (int icube = 0; icube < n_cubes; icube++) {
+        const FreezeoutCube &fo_cube = cubes[icube];
+        const int ix = fo_cube.ix;
+        const int iy = fo_cube.iy;
+        const double x = ix*(DATA.delta_x) - (DATA.x_size/2.0);
+        const double y = iy*(DATA.delta_y) - (DATA.y_size/2.0);
+        const double epsFO = epsFO_fm[fo_cube.isurf];
+        FreezeoutElementBuffer &buffer = buffers[fo_cube.isurf];
+
+        // prepare the hyper-cube, unless the last isotherm crossed it too
+        if (icube == 0 || cubes[icube - 1].iy != iy) {
+            if (ix == 0 || ix >= nx - 2*fac_x
+                    || iy == 0 || iy >= ny - 2*fac_y) {
+                music_message << "Freeze-out cell at the boundary! "
+                              << "The grid is too small!";
+                music_message.flush("error");
+                exit(1);
+            }
+            for (int j = 0; j < 2; j++)
+            for (int k = 0; k < 2; k++) {
+                fluid_cube[0][j][k] = arena_freezeout(ix + j*fac_x,
+                                                      iy + k*fac_y, 0);
+                fluid_cube[1][j][k] = arena_current  (ix + j*fac_x,
+                                                      iy + k*fac_y, 0);
+                cube[0][j][k] = fluid_cube[0][j][k].epsilon;
+                cube[1][j][k] = fluid_cube[1][j][k].epsilon;
             }
         }
 
-        for (int ix=0; ix < nx - fac_x; ix += fac_x) {
-            double x = ix*(DATA.delta_x) - (DATA.x_size/2.0);
-            for (int iy=0; iy < ny - fac_y; iy += fac_y) {
-                double y = iy*(DATA.delta_y) - (DATA.y_size/2.0);
-
-                // judge intersection (from Bjoern)
-                intersect=1;
-                if ((arena_current(ix+fac_x,iy+fac_y,0).epsilon-epsFO)
-                    *(arena_freezeout(ix,iy,0).epsilon-epsFO) > 0.)
-                    if ((arena_current(ix+fac_x,iy,0).epsilon-epsFO)
-                        *(arena_freezeout(ix,iy+fac_y,0).epsilon-epsFO) > 0.)
-                        if ((arena_current(ix,iy+fac_y,0).epsilon-epsFO)
-                            *(arena_freezeout(ix+fac_x,iy,0).epsilon-epsFO) > 0.)
-                            if ((arena_current(ix,iy,0).epsilon-epsFO)
-                                *(arena_freezeout(ix+fac_x,iy+fac_y,0).epsilon-epsFO) > 0.)
-                                    intersect = 0;
-                if (intersect == 0) continue;
-
-                if (ix == 0 || ix >= nx - 2*fac_x
-                        || iy == 0 || iy >= ny - 2*fac_y) {
-                    music_message << "Freeze-out cell at the boundary! "
-                                  << "The grid is too small!";
-                    music_message.flush("error");
-                    exit(1);
-                }
+        // Now, the magic will happen in the Cornelius ...
+        cornelius_ptr->init(dim, epsFO, lattice_spacing);
+        cornelius_ptr->find_surface_3d(workspace.cube_3d_ptr);
 
-                // if intersect, prepare for the hyper-cube
-                intersections++;
-                cube[0][0][0] = arena_freezeout(ix      , iy      , 0).epsilon;
-                cube[0][0][1] = arena_freezeout(ix      , iy+fac_y, 0).epsilon;
-                cube[0][1][0] = arena_freezeout(ix+fac_x, iy      , 0).epsilon;
-                cube[0][1][1] = arena_freezeout(ix+fac_x, iy+fac_y, 0).epsilon;
-                cube[1][0][0] = arena_current  (ix      , iy      , 0).epsilon;
-                cube[1][0][1] = arena_current  (ix      , iy+fac_y, 0).epsilon;
-                cube[1][1][0] = arena_current  (ix+fac_x, iy      , 0).epsilon;
-                cube[1][1][1] = arena_current  (ix+fac_x, iy+fac_y, 0).epsilon;
-
-                // Now, the magic will happen in the Cornelius ...
-                cornelius_ptr->find_surface_3d(cube);
-
-                // get positions of the freeze-out surface 
-                // and interpolating results
-                for (int isurf = 0; isurf < cornelius_ptr->get_Nelements(); 
-                     isurf++) {
-                    // surface normal vector d^3 \sigma_\mu
-                    for (int ii = 0; ii < dim; ii++)
-                        FULLSU[ii] = cornelius_ptr->get_normal_elem(isurf, ii);
-
-                    FULLSU[3] = 0.0; // rapidity direction is set to 0
-
-                    // check the size of the surface normal vector
-                    if (fabs(FULLSU[0]) > (DX*DY*DETA + 0.01)) {
-                       music_message << "problem: volume in tau direction "
-                                     << fabs(FULLSU[0]) << "  > DX*DY*DETA = "
-                                     << DX*DY*DETA;
-                        music_message.flush("warning");
-                    }
-                    if (fabs(FULLSU[1]) > (DTAU*DY*DETA + 0.01)) {
-                        music_message << "problem: volume in x direction "
-                                      << fabs(FULLSU[1])
-                                      << "  > DTAU*DY*DETA = " << DTAU*DY*DETA;
-                        music_message.flush("warning");
-                    }
-                    if (fabs(FULLSU[2]) > (DX*DTAU*DETA+0.01)) {
-                        music_message << "problem: volume in y direction "
-                                      << fabs(FULLSU[2])
-                                      << "  > DX*DTAU*DETA = " << DX*DTAU*DETA;
-                        music_message.flush("warning");
-                    }
+        // get positions of the freeze-out surface
+        // and interpolating results
+        for (int isurf = 0; isurf < cornelius_ptr->get_Nelements();
+             isurf++) {
+            // surface normal vector d^3 \sigma_\mu
+            for (int ii = 0; ii < dim; ii++)
+                FULLSU[ii] = cornelius_ptr->get_normal_elem(isurf, ii);
 
-                    // position of the freeze-out fluid cell
-                    for (int ii = 0; ii < dim; ii++) {
-                        x_fraction[1][ii] = (
-                            cornelius_ptr->get_centroid_elem(isurf, ii));
-                        x_fraction[0][ii] = (
-                            lattice_spacing[ii] - x_fraction[1][ii]);
-                    }
-                    const double tau_center = tau - DTAU + x_fraction[1][0];
-                    const double x_center = x + x_fraction[1][1];
-                    const double y_center = y + x_fraction[1][2];
-                    const double eta_center = 0.0;
-
-                    // perform 3-d linear interpolation for all fluid quantities
-                    fluid_cube[0][0][0] = arena_freezeout(ix      , iy      , 0);
-                    fluid_cube[0][0][1] = arena_freezeout(ix      , iy+fac_y, 0);
-                    fluid_cube[0][1][0] = arena_freezeout(ix+fac_x, iy      , 0);
-                    fluid_cube[0][1][1] = arena_freezeout(ix+fac_x, iy+fac_y, 0);
-                    fluid_cube[1][0][0] = arena_current  (ix      , iy      , 0);
-                    fluid_cube[1][0][1] = arena_current  (ix      , iy+fac_y, 0);
-                    fluid_cube[1][1][0] = arena_current  (ix+fac_x, iy      , 0);
-                    fluid_cube[1][1][1] = arena_current  (ix+fac_x, iy+fac_y, 0);
-                    auto fluid_center = three_dimension_linear_interpolation(
-                            lattice_spacing, x_fraction, fluid_cube);
-
-                    // reconstruct q^\tau from the transverality criteria
-                    FlowVec u_flow = fluid_center.u;
-                    double q_mu[4] = {
-                        fluid_center.Wmunu[10], fluid_center.Wmunu[11],
-                        fluid_center.Wmunu[12], fluid_center.Wmunu[13]};
-                    double q_regulated[4] = {0.0, 0.0, 0.0, 0.0};
-                    regulate_qmu(u_flow, q_mu, q_regulated);
-                    fluid_center.Wmunu[10] = q_regulated[0];
-                    fluid_center.Wmunu[11] = q_regulated[1];
-                    fluid_center.Wmunu[12] = q_regulated[2];
-                    fluid_center.Wmunu[13] = q_regulated[3];
-
-                    // regulate Wmunu according to transversality and traceless
-                    double Wmunu_input[4][4];
-                    double Wmunu_regulated[4][4];
-                    Wmunu_input[0][0] = fluid_center.Wmunu[0];
-                    Wmunu_input[0][1] = Wmunu_input[1][0] = fluid_center.Wmunu[1];
-                    Wmunu_input[0][2] = Wmunu_input[2][0] = fluid_center.Wmunu[2];
-                    Wmunu_input[0][3] = Wmunu_input[3][0] = fluid_center.Wmunu[3];
-                    Wmunu_input[1][1] = fluid_center.Wmunu[4];
-                    Wmunu_input[1][2] = Wmunu_input[2][1] = fluid_center.Wmunu[5];
-                    Wmunu_input[1][3] = Wmunu_input[3][1] = fluid_center.Wmunu[6];
-                    Wmunu_input[2][2] = fluid_center.Wmunu[7];
-                    Wmunu_input[2][3] = Wmunu_input[3][2] = fluid_center.Wmunu[8];
-                    Wmunu_input[3][3] = fluid_center.Wmunu[9];
-                    regulate_Wmunu(u_flow, Wmunu_input, Wmunu_regulated);
-                    fluid_center.Wmunu[0] = Wmunu_regulated[0][0];
-                    fluid_center.Wmunu[1] = Wmunu_regulated[0][1];
-                    fluid_center.Wmunu[2] = Wmunu_regulated[0][2];
-                    fluid_center.Wmunu[3] = Wmunu_regulated[0][3];
-                    fluid_center.Wmunu[4] = Wmunu_regulated[1][1];
-                    fluid_center.Wmunu[5] = Wmunu_regulated[1][2];
-                    fluid_center.Wmunu[6] = Wmunu_regulated[1][3];
-                    fluid_center.Wmunu[7] = Wmunu_regulated[2][2];
-                    fluid_center.Wmunu[8] = Wmunu_regulated[2][3];
-                    fluid_center.Wmunu[9] = Wmunu_regulated[3][3];
-
-                    // 3-dimension interpolation done
-                    double TFO = eos.get_temperature(epsFO, fluid_center.rhob);
-                    double muB = eos.get_muB(epsFO, fluid_center.rhob);
-                    double muS = eos.get_muS(epsFO, fluid_center.rhob);
-                    double muC = eos.get_muC(epsFO, fluid_center.rhob);
-                    if (TFO < 0) {
-                        music_message << "TFO=" << TFO
-                                      << "<0. ERROR. exiting.";
-                        music_message.flush("error");
-                        exit(1);
-                    }
+            FULLSU[3] = 0.0; // rapidity direction is set to 0
 
-                    double pressure = eos.get_pressure(epsFO, fluid_center.rhob);
-                    double eps_plus_p_over_T_FO = (epsFO + pressure)/TFO;
-
-                    // finally output results !!!!
-                    if (surface_in_binary) {
-                        float array[34];
-                        array[0] = static_cast<float>(tau_center);
-                        array[1] = static_cast<float>(x_center);
-                        array[2] = static_cast<float>(y_center);
-                        array[3] = static_cast<float>(eta_center);
-                        for (int ii = 0; ii < 4; ii++)
-                            array[4+ii] = static_cast<float>(FULLSU[ii]);
-                        for (int ii = 0; ii < 4; ii++)
-                            array[8+ii] = static_cast<float>(fluid_center.u[ii]);
-                        array[12] = static_cast<float>(epsFO);
-                        array[13] = static_cast<float>(TFO);
-                        array[14] = static_cast<float>(muB);
-                        array[15] = static_cast<float>(muS);
-                        array[16] = static_cast<float>(muC);
-                        array[17] = static_cast<float>(eps_plus_p_over_T_FO);
-                        for (int ii = 0; ii < 10; ii++)
-                            array[18+ii] = static_cast<float>(fluid_center.Wmunu[ii]);
-                        array[28] = fluid_center.pi_b;
-                        array[29] = fluid_center.rhob;
-                        for (int ii = 0; ii < 4; ii++)
-                            array[30+ii] = static_cast<float>(fluid_center.Wmunu[10+ii]);
-                        for (int i = 0; i < 34; i++)
-                            s_file.write((char*) &(array[i]), sizeof(float));
-                    } else {
-                        s_file << std::scientific << std::setprecision(10)
-                               << tau_center << " " << x_center << " "
-                               << y_center << " " << eta_center << " "
-                               << FULLSU[0] << " " << FULLSU[1] << " "
-                               << FULLSU[2] << " " << FULLSU[3] << " "
-                               << fluid_center.u[0] << " " << fluid_center.u[1] << " "
-                               << fluid_center.u[2] << " " << fluid_center.u[3] << " "
-                               << epsFO << " " << TFO << " " << muB << " "
-                               << muS << " " << muC << " "
-                               << eps_plus_p_over_T_FO << " ";
-                        for (int ii = 0; ii < 10; ii++)
-                            s_file << std::scientific << std::setprecision(10)
-                                   << fluid_center.Wmunu[ii] << " ";
-                        if (DATA.turn_on_bulk)
-                            s_file << fluid_center.pi_b << " ";
-                        if (DATA.turn_on_rhob)
-                            s_file << fluid_center.rhob << " ";
-                        if (DATA.turn_on_diff)
-                            for (int ii = 10; ii < 14; ii++)
-                                s_file << std::scientific << std::setprecision(10)
-                                       << fluid_center.Wmunu[ii] << " ";
-                    }
-                }
+            // check the size of the surface normal vector
+            if (fabs(FULLSU[0]) > (DX*DY*DETA + 0.01)) {
+               music_message << "problem: volume in tau direction "
+                             << fabs(FULLSU[0]) << "  > DX*DY*DETA = "
+                             << DX*DY*DETA;
+                music_message.flush("warning");
+            }
+            if (fabs(FULLSU[1]) > (DTAU*DY*DETA + 0.01)) {
+                music_message << "problem: volume in x direction "
+                              << fabs(FULLSU[1])
+                              << "  > DTAU*DY*DETA = " << DTAU*DY*DETA;
+                music_message.flush("warning");
+            }
+            if (fabs(FULLSU[2]) > (DX*DTAU*DETA+0.01)) {
+                music_message << "problem: volume in y direction "
+                              << fabs(FULLSU[2])
+                              << "  > DX*DTAU*DETA = " << DX*DTAU*DETA;
+                music_message.flush("warning");
             }
-        }
 
-        s_file.close();
+            // position of the freeze-out fluid cell
+            for (int ii = 0; ii < dim; ii++) {
+                x_fraction[1][ii] = (
+                    cornelius_ptr->get_centroid_elem(isurf, ii));
+                x_fraction[0][ii] = (
+                    lattice_spacing[ii] - x_fraction[1][ii]);
+            }
+            const double tau_center = tau - DTAU + x_fraction[1][0];
+            const double x_center = x + x_fraction[1][1];
+            const double y_center = y + x_fraction[1][2];
+            const double eta_center = 0.0;
+
+            // perform 3-d linear interpolation for all fluid quantities
+            auto fluid_center = three_dimension_linear_interpolation(
+                    lattice_spacing, x_fraction, fluid_cube);
 
-        // clean up
-        for (int i = 0; i < 2; i++) {
-            for (int j = 0; j < 2; j++) {
-                delete [] cube[i][j];
-                delete [] fluid_cube[i][j];
+            // reconstruct q^\tau from the transverality criteria
+            FlowVec u_flow = fluid_center.u;
+            double q_mu[4] = {
+                fluid_center.Wmunu[10], fluid_center.Wmunu[11],
+                fluid_center.Wmunu[12], fluid_center.Wmunu[13]};
+            double q_regulated[4] = {0.0, 0.0, 0.0, 0.0};
+            regulate_qmu(u_flow, q_mu, q_regulated);
+            fluid_center.Wmunu[10] = q_regulated[0];
+            fluid_center.Wmunu[11] = q_regulated[1];
+            fluid_center.Wmunu[12] = q_regulated[2];
+            fluid_center.Wmunu[13] = q_regulated[3];
+
+            // regulate Wmunu according to transversality and traceless
+            double Wmunu_input[4][4];
+            double Wmunu_regulated[4][4];
+            Wmunu_input[0][0] = fluid_center.Wmunu[0];
+            Wmunu_input[0][1] = Wmunu_input[1][0] = fluid_center.Wmunu[1];
+            Wmunu_input[0][2] = Wmunu_input[2][0] = fluid_center.Wmunu[2];
+            Wmunu_input[0][3] = Wmunu_input[3][0] = fluid_center.Wmunu[3];
+            Wmunu_input[1][1] = fluid_center.Wmunu[4];
+            Wmunu_input[1][2] = Wmunu_input[2][1] = fluid_center.Wmunu[5];
+            Wmunu_input[1][3] = Wmunu_input[3][1] = fluid_center.Wmunu[6];
+            Wmunu_input[2][2] = fluid_center.Wmunu[7];
+            Wmunu_input[2][3] = Wmunu_input[3][2] = fluid_center.Wmunu[8];
+            Wmunu_input[3][3] = fluid_center.Wmunu[9];
+            regulate_Wmunu(u_flow, Wmunu_input, Wmunu_regulated);
+            fluid_center.Wmunu[0] = Wmunu_regulated[0][0];
+            fluid_center.Wmunu[1] = Wmunu_regulated[0][1];
+            fluid_center.Wmunu[2] = Wmunu_regulated[0][2];
+            fluid_center.Wmunu[3] = Wmunu_regulated[0][3];
+            fluid_center.Wmunu[4] = Wmunu_regulated[1][1];
+            fluid_center.Wmunu[5] = Wmunu_regulated[1][2];
+            fluid_center.Wmunu[6] = Wmunu_regulated[1][3];
+            fluid_center.Wmunu[7] = Wmunu_regulated[2][2];
+            fluid_center.Wmunu[8] = Wmunu_regulated[2][3];
+            fluid_center.Wmunu[9] = Wmunu_regulated[3][3];
+
+            // 3-dimension interpolation done
+            double TFO = eos.get_temperature(epsFO, fluid_center.rhob);
+            double muB = eos.get_muB(epsFO, fluid_center.rhob);
+            double muS = eos.get_muS(epsFO, fluid_center.rhob);
+            double muC = eos.get_muC(epsFO, fluid_center.rhob);
+            if (TFO < 0) {
+                music_message << "TFO=" << TFO
+                              << "<0. ERROR. exiting.";
+                music_message.flush("error");
+                exit(1);
             }
-            delete [] cube[i];
-            delete [] fluid_cube[i];
-        }
-        delete [] cube;
-        delete [] fluid_cube;
 
-        // judge whether the entire fireball is freeze-out
-        all_frozen[i_freezesurf] = 0;
-        if (intersections == 0)
-            all_frozen[i_freezesurf] = 1;
-    }
+            double pressure = eos.get_pressure(epsFO, fluid_center.rhob);
+            double eps_plus_p_over_T_FO = (epsFO + pressure)/TFO;
 
-    int all_frozen_flag = 1;
-    for (int ii = 0; ii < n_freeze_surf; ii++) {
-        all_frozen_flag *= all_frozen[ii];
-    }
-    if (all_frozen_flag == 1) {
-        music_message.info("All cells frozen out. Exiting.");
+            // finally output results !!!!
+            if (surface_in_binary) {
+                float array[34];
+                array[0] = static_cast<float>(tau_center);
+                array[1] = static_cast<float>(x_center);
+                array[2] = static_cast<float>(y_center);
+                array[3] = static_cast<float>(eta_center);
+                for (int ii = 0; ii < 4; ii++)
+                    array[4+ii] = static_cast<float>(FULLSU[ii]);
+                for (int ii = 0; ii < 4; ii++)
+                    array[8+ii] = static_cast<float>(fluid_center.u[ii]);
+                array[12] = static_cast<float>(epsFO);
+                array[13] = static_cast<float>(TFO);
+                array[14] = static_cast<float>(muB);
+                array[15] = static_cast<float>(muS);
+                array[16] = static_cast<float>(muC);
+                array[17] = static_cast<float>(eps_plus_p_over_T_FO);
+                for (int ii = 0; ii < 10; ii++)
+                    array[18+ii] = static_cast<float>(fluid_center.Wmunu[ii]);
+                array[28] = fluid_center.pi_b;
+                array[29] = fluid_center.rhob;
+                for (int ii = 0; ii < 4; ii++)
+                    array[30+ii] = static_cast<float>(fluid_center.Wmunu[10+ii]);
+                buffer.elements.insert(buffer.elements.end(), array,
+                                       array + 34);
+            } else {
+                s_file.str("");
+                s_file << std::scientific << std::setprecision(10)
+                       << tau_center << " " << x_center << " "
+                       << y_center << " " << eta_center << " "
+                       << FULLSU[0] << " " << FULLSU[1] << " "
+                       << FULLSU[2] << " " << FULLSU[3] << " "
+                       << fluid_center.u[0] << " " << fluid_center.u[1] << " "
+                       << fluid_center.u[2] << " " << fluid_center.u[3] << " "
+                       << epsFO << " " << TFO << " " << muB << " "
+                       << muS << " " << muC << " "
+                       << eps_plus_p_over_T_FO << " ";
+                for (int ii = 0; ii < 10; ii++)
+                    s_file << std::scientific << std::setprecision(10)
+                           << fluid_center.Wmunu[ii] << " ";
+                if (DATA.turn_on_bulk)
+                    s_file << fluid_center.pi_b << " ";
+                if (DATA.turn_on_rhob)
+                    s_file << fluid_center.rhob << " ";
+                if (DATA.turn_on_diff)
+                    for (int ii = 10; ii < 14; ii++)
+                        s_file << std::scientific << std::setprecision(10)
+                               << fluid_center.Wmunu[ii] << " ";
+                s_file << "\n";
+                buffer.text += s_file.str();
+            }
+        }
     }
-
-    delete [] all_frozen;
-    return(all_frozen_flag);
 }
 
 void Evolve::regulate_qmu(const FlowVec u, const double q[],
@@ -1347,11 +2054,53 @@ void Evolve::initialize_freezeout_surface_info() {
         music_message.flush("error");
         exit(1);
     }
+
+    // the hypercube buffers and the Cornelius instance of each thread
+    freezeout_workspaces_.clear();
+    for (int i = 0; i < omp_get_max_threads(); i++) {
+        freezeout_workspaces_.emplace_back(
+                                new FreezeoutWorkspace(DATA, eos));
+    }
+
+    if (DATA.freeze_surface_single_file == 1) {
+        freezeout_surface_ptr = std::make_shared<FreezeoutSurface>(
+            n_freeze_surf, (FreezeoutSurface::kNumBaseFields
+                            + DATA.output_vorticity
+                              *FreezeoutSurface::kNumVorticityFields));
+    }
+}
+
+
+void Evolve::write_freezeout_surface_files() {
+    freezeout_surface_ptr->merge();
+    for (int i_freezesurf = 0; i_freezesurf < n_freeze_surf; i_freezesurf++) {
+        if (surface_stream_ptr_ != nullptr && i_freezesurf == 0) {
+            // the streamed elements are not kept
+            continue;
+        }
+        std::stringstream strs_name;
+        strs_name << "surface_eps_" << std::setprecision(4)
+                  << epsFO_list[i_freezesurf] << ".dat";
+        freezeout_surface_ptr->write_file(i_freezesurf, strs_name.str());
+        music_message << "wrote "
+                      << freezeout_surface_ptr->get_number_of_elements(
+                                                            i_freezesurf)
+                      << " surface elements to " << strs_name.str();
+        music_message.flush("info");
+    }
+}
+
+
+void Evolve::publish_freezeout_surface_chunk() {
+    std::vector<float> rows;
+    freezeout_surface_ptr->take_new_elements(0, rows);
+    surface_stream_ptr_->publish(std::move(rows));
 }
 
 
 Cell_small Evolve::three_dimension_linear_interpolation(
-        double* lattice_spacing, double fraction[2][3], Cell_small*** cube) {
+        double* lattice_spacing, double fraction[2][3],
+        const Cell_small cube[2][2][2]) {
     double denorm = 1.0;
     for (int i = 0; i < 3; i++) {
         denorm *= lattice_spacing[i];
@@ -1372,7 +2121,8 @@ Cell_small Evolve::three_dimension_linear_interpolation(
 
 
 Cell_small Evolve::four_dimension_linear_interpolation(
-        double* lattice_spacing, double fraction[2][4], Cell_small**** cube) {
+        double* lattice_spacing, double fraction[2][4],
+        const Cell_small cube[2][2][2][2]) {
     double denorm = 1.0;
     Cell_small results;
     for (int i = 0; i < 4; i++) {
@@ -1395,7 +2145,8 @@ Cell_small Evolve::four_dimension_linear_interpolation(
 
 
 Cell_aux Evolve::three_dimension_linear_interpolation(
-        double* lattice_spacing, double fraction[2][3], Cell_aux*** cube) {
+        double* lattice_spacing, double fraction[2][3],
+        const Cell_aux cube[2][2][2]) {
     double denorm = 1.0;
     for (int i = 0; i < 3; i++) {
         denorm *= lattice_spacing[i];
@@ -1416,7 +2167,8 @@ Cell_aux Evolve::three_dimension_linear_interpolation(
 
 
 Cell_aux Evolve::four_dimension_linear_interpolation(
-        double* lattice_spacing, double fraction[2][4], Cell_aux**** cube) {
+        double* lattice_spacing, double fraction[2][4],
+        const Cell_aux cube[2][2][2][2]) {
     double denorm = 1.0;
     Cell_aux results;
     for (int i = 0; i < 4; i++) {
@@ -2,70 +2,287 @@
 #ifndef SRC_EVOLVE_H_
 #define SRC_EVOLVE_H_
 
+#include <fstream>
+#include <functional>
 #include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
 #include <vector>
 #include "util.h"
 #include "data.h"
 #include "cell.h"
 #include "grid.h"
+#include "active_region.h"
 #include "grid_info.h"
 #include "eos.h"
 #include "advance.h"
+#include "cornelius.h"
+#include "cornelius_4d.h"
+#include "freezeout_history.h"
+#include "freezeout_pipeline.h"
+#include "freezeout_prescreen.h"
+#include "freezeout_surface.h"
+#include "grid_coarsening.h"
+#include "surface_stream.h"
+#include "u_derivative.h"
+#include "eta_grid.h"
+#include "rk_scheme.h"
+#include "causality_diagnostics.h"
+#include "causality_statistics.h"
+#include "checkpoint.h"
+#include "snapshot_ring.h"
+#include "evolution_observables.h"
+#include "domain_decomposition.h"
 #include "hydro_source_base.h"
 #include "pretty_ostream.h"
 #include "HydroinfoMUSIC.h"
 
+//! per-thread buffers of the Cornelius freeze-out, allocated once in
+//! Evolve::initialize_freezeout_surface_info
+struct FreezeoutWorkspace {
+    //! Cornelius of the boost-invariant (tau, x, y) cubes
+    Cornelius cornelius;
+    Cornelius4D cornelius_4d;
+    U_derivative u_derivative;
+    //! epsilon at the corners of the hypercube [tau][x][y][eta],
+    //! flattened as ((i*2 + j)*2 + k)*2 + l
+    double cube[16];
+    Cell_small fluid_cube[2][2][2][2];
+    Cell_aux fluid_aux_cube[2][2][2][2];
+    //! the boost-invariant cube [tau][x][y], with the row pointers
+    //! Cornelius::find_surface_3d takes
+    double cube_3d[2][2][2];
+    double *cube_3d_rows[2][2];
+    double **cube_3d_ptr[2];
+    Cell_small fluid_cube_3d[2][2][2];
+    //! the text lines of a surface element
+    std::ostringstream text;
+    //! the warnings of the thread, which may find the surface while the
+    //! evolution writes its messages
+    pretty_ostream music_message;
+
+    FreezeoutWorkspace(const InitData &DATA, const EOS &eos)
+        : u_derivative(DATA, eos) {
+        for (int i = 0; i < 2; i++) {
+            for (int j = 0; j < 2; j++) cube_3d_rows[i][j] = cube_3d[i][j];
+            cube_3d_ptr[i] = cube_3d_rows[i];
+        }
+    }
+
+    FreezeoutWorkspace(const FreezeoutWorkspace&) = delete;
+    FreezeoutWorkspace& operator=(const FreezeoutWorkspace&) = delete;
+};
+
+//! the surface elements of an isotherm found in one x row of the
+//! boost-invariant freeze-out, as float rows (binary output) or text
+struct FreezeoutElementBuffer {
+    std::vector<float> elements;
+    std::string text;
+};
+
+//! the state of the main loop of Evolve::EvolveIt between two time steps,
+//! kept in the checkpoints
+struct EvolutionLoopState {
+    int it;                  //!< the next time step
+    double tau;              //!< [fm]
+    double delta_tau;        //!< DATA.delta_tau of the last step [fm]
+    double tau_next_output;  //!< [fm]
+    double tau_freezeout;    //!< tau of the last freeze-out step [fm]
+    double eps_max_cur;
+};
+
+//! the function EvolveIt calls at every time step with the step number,
+//! tau and the fluid cells at tau, before they are advanced. The cells are
+//! only valid during the call, and the evolution stops if it returns false.
+typedef std::function<bool(const int it, const double tau,
+                           const SCGrid &arena_current)> EvolutionStepCallback;
+
 // this is a control class for the hydrodynamic evolution
 class Evolve {
  private:
     const EOS &eos;        // declare EOS object
-    const InitData &DATA;
+    //! not const: the adaptive time step changes DATA.delta_tau,
+    //! which all the parts of the evolution read
+    InitData &DATA;
     std::weak_ptr<HydroSourceBase> hydro_source_terms_ptr;
 
     Cell_info grid_info;
     Advance advance;
     pretty_ostream music_message;
 
+    //! the analysis observables, evaluated in one pass per time step
+    EvolutionObservables observables_;
+    //! the maximum energy density check, owned by observables_
+    MaximumEnergyDensity *eps_max_observable_ = nullptr;
+
+    //! buffered output of the causality reduction factors
+    std::shared_ptr<CausalityDiagnostics> causality_diagnostics_ptr;
+    //! histograms of the causality reduction factors of all the cells
+    std::shared_ptr<CausalityStatistics> causality_statistics_ptr;
+
     // simulation information
-    int rk_order;
+    //! time integrator, which needs the three grids of EvolveIt
+    RKScheme rk_scheme_;
+    //! the restriction of the transverse plane with
+    //! transverse_coarsening_levels
+    GridCoarsening grid_coarsening_;
+    //! the eta_s of the cells and the spacings of the stretched eta grid
+    EtaGrid eta_grid_;
 
     int facTau;
 
+    //! tau of the first time step, its freeze-out files are overwritten
+    double tau_first_step_;
+    //! tau interval of the freeze-out cubes of the current step
+    double freezeout_dtau_;
+    //! the last time step, for the backward time derivatives
+    double dtau_prev_;
+
     // information about freeze-out surface
     // (only used when freezeout_method == 4)
     int n_freeze_surf;
     std::vector<double> epsFO_list;
+    //! one workspace per OpenMP thread
+    std::vector<std::unique_ptr<FreezeoutWorkspace>> freezeout_workspaces_;
+    //! the hypercubes of the freeze-out step crossed by the isotherms
+    FreezeoutPrescreen freezeout_prescreen_;
+    std::vector<FreezeoutCube> freezeout_cubes_;
+    //! the first cube of each position in freezeout_cubes_, and its size
+    std::vector<int> freezeout_group_starts_;
+    //! the cubes of the boost-invariant freeze-out grouped by x row, and
+    //! the elements of the rows [row][isurf]
+    std::vector<FreezeoutCube> freezeout_row_cubes_;
+    std::vector<FreezeoutElementBuffer> freezeout_row_buffers_;
+    //! the surface elements of all the isotherms, kept in memory with
+    //! freeze_surface_single_file = 1 (nullptr otherwise)
+    std::shared_ptr<FreezeoutSurface> freezeout_surface_ptr;
+    //! the subscriber of the elements of the first isotherm, which are
+    //! then published after each freeze-out step instead of kept
+    std::shared_ptr<SurfaceStream> surface_stream_ptr_;
+
+    //! vorticity tensors (tau-eta frame) of the vorticity outputs and the
+    //! freeze-out surface at tau, and of the last freeze-out step
+    //! (only filled with output_vorticity = 1)
+    VorticityGrid vorticity_current_;
+    VorticityGrid vorticity_freezeout_;
+
+    //! cells above the vacuum at the current time step,
+    //! and their union since the last freeze-out step
+    ActiveRegion active_region;
+    ActiveRegion freezeout_region;
+
+    //! the slabs of a distributed run (nullptr: the whole grid is local)
+    std::shared_ptr<DomainDecomposition> domain_ptr_;
+
+    //! writes the checkpoints (nullptr without checkpoint_every_N_timesteps)
+    std::unique_ptr<CheckpointWriter> checkpoint_writer_;
+    //! the grids of the last time steps, written if the run stops on an
+    //! error (debug_snapshot_ring)
+    std::unique_ptr<SnapshotRing> snapshot_ring_;
+
+    //! called at every time step (empty: no callback)
+    EvolutionStepCallback step_callback_;
 
     typedef std::unique_ptr<SCGrid, void(*)(SCGrid*)> GridPointer;
 
+    bool is_distributed() const {
+        return(domain_ptr_ != nullptr && domain_ptr_->is_distributed());
+    }
+
  public:
-    Evolve(const EOS &eos, const InitData &DATA_in,
+    Evolve(const EOS &eos, InitData &DATA_in,
            std::shared_ptr<HydroSourceBase> hydro_source_ptr_in);
+    //! set the slabs of a distributed run, the grids of EvolveIt are then
+    //! the local grids of the rank
+    void set_domain_decomposition(
+            std::shared_ptr<DomainDecomposition> domain_ptr_in);
+    //! streams the first isotherm of the in-memory surface
+    //! (freeze_surface_single_file = 1) to a subscriber
+    void set_surface_stream(std::shared_ptr<SurfaceStream> stream_in) {
+        surface_stream_ptr_ = stream_in;
+    }
+    void set_step_callback(EvolutionStepCallback callback) {
+        step_callback_ = std::move(callback);
+    }
+
     int EvolveIt(SCGrid &arena_prev, SCGrid &arena_current,
                  SCGrid &arena_future, HydroinfoMUSIC &hydro_info_ptr);
 
     void AdvanceRK(double tau, GridPointer &arena_prev,
                    GridPointer &arena_current, GridPointer &arena_future);
 
+    //! advances the grids by n_steps time steps from tau, as EvolveIt
+    //! without the freeze-out, the outputs and the observables, e.g. for
+    //! timing the steps (AutoTuner). The wall time of every step is
+    //! appended to step_seconds. It returns the grid of the last step,
+    //! one of the three grids.
+    const SCGrid &advance_steps(const double tau, const int n_steps,
+                                SCGrid &arena_prev, SCGrid &arena_current,
+                                SCGrid &arena_future,
+                                std::vector<double> &step_seconds);
+
     int FreezeOut_equal_tau_Surface(double tau, SCGrid &arena_current);
     void FreezeOut_equal_tau_Surface_XY(double tau,
                                         int ieta, SCGrid &arena_current,
-                                        int thread_id, double epsFO);
+                                        int thread_id, int isurf,
+                                        double epsFO);
+    //! arena_prev is only read for the time derivatives of the vorticity,
+    //! the hypercubes are the ones touching region
     int FindFreezeOutSurface_Cornelius(double tau,
-        SCGrid &arena_prev, SCGrid &arena_current,
-        SCGrid &arena_freezeout_prev, SCGrid &arena_freezeout);
-
-    int FindFreezeOutSurface_Cornelius_XY(double tau, int ieta,
-                                          SCGrid &arena_prev,
-                                          SCGrid &arena_current,
-                                          SCGrid &arena_freezeout_prev,
-                                          SCGrid &arena_freezeout,
-                                          int thread_id, double epsFO);
+        const ActiveRegion &region, SCGrid &arena_prev,
+        SCGrid &arena_current, const SCGrid &arena_freezeout);
+
+    //! this function writes the surface elements of one hypercube for the
+    //! n_levels isotherms of cubes (all at its position) to their files
+    void FindFreezeOutSurface_Cornelius_cube(
+        const double tau, const FreezeoutCube *cubes, const int n_levels,
+        SCGrid &arena_current, const SCGrid &arena_freezeout,
+        const std::vector<double> &epsFO_fm, FreezeoutWorkspace &workspace,
+        std::vector<std::ofstream> &s_files);
+    //! the surface file of the isotherm epsFO [1/fm^4] written by a thread,
+    //! with the rank in distributed runs
+    std::string get_freezeout_surface_filename(const double epsFO,
+                                               const int thread_id) const;
+    void open_freezeout_surface_file(const double tau, const double epsFO,
+                                     const int thread_id,
+                                     std::ofstream &s_file) const;
     int FindFreezeOutSurface_boostinvariant_Cornelius(
-                double tau, SCGrid &arena_current, SCGrid &arena_freezeout);
+                double tau, const ActiveRegion &region,
+                SCGrid &arena_current, const SCGrid &arena_freezeout);
+    //! this function adds the surface elements of the cubes of an x row,
+    //! ordered by iy, to the buffers of their isotherms
+    void FindFreezeOutSurface_boostinvariant_Cornelius_row(
+        const double tau, const FreezeoutCube *cubes, const int n_cubes,
+        const SCGrid &arena_current, const SCGrid &arena_freezeout,
+        const std::vector<double> &epsFO_fm, FreezeoutWorkspace &workspace,
+        FreezeoutElementBuffer *buffers);
 
-    void store_previous_step_for_freezeout(SCGrid &arena_current,
-                                           SCGrid &arena_freezeout);
+    void update_active_region(const SCGrid &arena_current, const double tau,
+                              const double source_tau_max);
+    //! this function halves the resolution of the transverse plane of the
+    //! grids and of the last freeze-out step, if GridCoarsening allows it
+    //! and its gradient indicator is below transverse_coarsening_threshold.
+    //! It returns true if the grids were coarsened.
+    bool coarsen_transverse_plane(GridPointer &ap_prev,
+                                  GridPointer &ap_current,
+                                  GridPointer &ap_future,
+                                  FreezeoutHistory &freezeout_history,
+                                  FreezeoutPipeline *freezeout_pipeline);
+    double get_adaptive_time_step(const SCGrid &arena_current,
+                                  const double tau,
+                                  const double source_tau_max,
+                                  const double tau_next_output);
+    void get_freezeout_scan_range(const ActiveRegion &region,
+                                  const int nx, const int ny,
+                                  const int fac_x, const int fac_y,
+                                  int &ix_start, int &ix_end,
+                                  int &iy_start, int &iy_end) const;
+    //! this function registers the observables of the run in observables_
+    void register_observables(const SCGrid &arena);
+    void update_vorticity_grid(const double tau, SCGrid &arena_prev,
+                               SCGrid &arena_current,
+                               VorticityGrid &vorticity);
     void regulate_qmu(const FlowVec u, const double q[],
                       double q_regulated[]) const;
     void regulate_Wmunu(const FlowVec u, const double Wmunu[4][4],
@@ -73,14 +290,46 @@ class Evolve {
 
     void initialize_freezeout_surface_info();
 
+    //! the surface files of the isotherms, which the freeze-out appends to
+    std::vector<std::string> get_freezeout_surface_filenames() const;
+    //! this function writes a checkpoint of the evolution at the start of
+    //! the time step state.it
+    void write_checkpoint(const EvolutionLoopState &state,
+                          const SCGrid &arena_prev,
+                          const SCGrid &arena_current,
+                          const SCGrid &arena_future,
+                          const SCGrid &arena_freezeout);
+    //! this function restores the evolution from checkpoint_filename and
+    //! cuts the output files back to their sizes at the checkpoint
+    void read_checkpoint(EvolutionLoopState &state, SCGrid &arena_prev,
+                         SCGrid &arena_current, SCGrid &arena_future,
+                         SCGrid &arena_freezeout);
+
+    //! this function merges the in-memory surface and writes one
+    //! surface_eps_*.dat per isotherm
+    void write_freezeout_surface_files();
+    //! this function publishes the elements of the first isotherm found
+    //! since the last call to the surface stream
+    void publish_freezeout_surface_chunk();
+
+    //! the in-memory surface of the evolution
+    //! (nullptr unless freeze_surface_single_file = 1)
+    std::shared_ptr<const FreezeoutSurface> get_freezeout_surface() const {
+        return(freezeout_surface_ptr);
+    }
+
     Cell_small four_dimension_linear_interpolation(
-        double* lattice_spacing, double fraction[2][4], Cell_small**** cube);
+        double* lattice_spacing, double fraction[2][4],
+        const Cell_small cube[2][2][2][2]);
     Cell_small three_dimension_linear_interpolation(
-        double* lattice_spacing, double fraction[2][3], Cell_small*** cube);
+        double* lattice_spacing, double fraction[2][3],
+        const Cell_small cube[2][2][2]);
     Cell_aux four_dimension_linear_interpolation(
-        double* lattice_spacing, double fraction[2][4], Cell_aux**** cube);
+        double* lattice_spacing, double fraction[2][4],
+        const Cell_aux cube[2][2][2][2]);
     Cell_aux three_dimension_linear_interpolation(
-        double* lattice_spacing, double fraction[2][3], Cell_aux*** cube);
+        double* lattice_spacing, double fraction[2][3],
+        const Cell_aux cube[2][2][2]);
 };
 
 #endif  // SRC_EVOLVE_H_
@@ -0,0 +1,86 @@
+#include <cstring>
+#ifdef ZLIB
+    #include <zlib.h>
+#endif
+#include "float_codec.h"
+
+namespace {
+#ifdef ZLIB
+    void shuffle_bytes(const unsigned char *in, const size_t n_values,
+                       unsigned char *out) {
+        for (size_t i = 0; i < n_values; i++) {
+            for (size_t k = 0; k < sizeof(float); k++) {
+                out[k*n_values + i] = in[i*sizeof(float) + k];
+            }
+        }
+    }
+
+    void unshuffle_bytes(const unsigned char *in, const size_t n_values,
+                         unsigned char *out) {
+        for (size_t i = 0; i < n_values; i++) {
+            for (size_t k = 0; k < sizeof(float); k++) {
+                out[i*sizeof(float) + k] = in[k*n_values + i];
+            }
+        }
+    }
+#endif
+}
+
+namespace FloatCodec {
+
+bool is_available(const int codec) {
+    if (codec == kRaw) return(true);
+#ifdef ZLIB
+    if (codec == kZlib) return(true);
+#endif
+    return(false);
+}
+
+
+int compress(const int codec, const float *values, const size_t n,
+             std::vector<unsigned char> &stored) {
+    const size_t raw_size = n*sizeof(float);
+    const unsigned char *raw = reinterpret_cast<const unsigned char*>(
+                                                                values);
+#ifdef ZLIB
+    if (codec == kZlib) {
+        std::vector<unsigned char> shuffled(raw_size);
+        shuffle_bytes(raw, n, shuffled.data());
+        uLongf compressed_size = compressBound(raw_size);
+        stored.resize(compressed_size);
+        if (compress2(stored.data(), &compressed_size, shuffled.data(),
+                      raw_size, 1) == Z_OK && compressed_size < raw_size) {
+            stored.resize(compressed_size);
+            return(kZlib);
+        }
+    }
+#endif
+    stored.assign(raw, raw + raw_size);
+    return(kRaw);
+}
+
+
+bool decompress(const int codec, const unsigned char *stored,
+                const size_t stored_size, const size_t n, float *values) {
+    if (codec == kRaw) {
+        if (stored_size != n*sizeof(float)) return(false);
+        std::memcpy(values, stored, stored_size);
+        return(true);
+    }
+#ifdef ZLIB
+    if (codec == kZlib) {
+        std::vector<unsigned char> shuffled(n*sizeof(float));
+        uLongf raw_size = shuffled.size();
+        if (uncompress(shuffled.data(), &raw_size, stored, stored_size)
+                != Z_OK || raw_size != shuffled.size()) {
+            return(false);
+        }
+        unshuffle_bytes(shuffled.data(), n,
+                        reinterpret_cast<unsigned char*>(values));
+        return(true);
+    }
+#endif
+    return(false);
+}
+
+}  // namespace FloatCodec
@@ -0,0 +1,33 @@
+#ifndef SRC_FLOAT_CODEC_H_
+#define SRC_FLOAT_CODEC_H_
+
+#include <cstddef>
+#include <vector>
+
+//! The lossless codecs of the float arrays written to disk (the chunked
+//! evolution files and the spilled hydro history). The zlib codec groups
+//! the i-th bytes of all floats together before compressing, which makes
+//! the slowly varying sign and exponent bytes compress well.
+namespace FloatCodec {
+
+enum Codec {
+    kRaw = 0,   //!< the floats as they are
+    kZlib = 1,  //!< byte-shuffled floats compressed with zlib
+};
+
+//! returns whether the codec is compiled in (zlib needs -DZLIB)
+bool is_available(const int codec);
+
+//! stores the n values with the codec into stored and returns the codec
+//! of stored: the values are stored raw if they do not get smaller
+int compress(const int codec, const float *values, const size_t n,
+             std::vector<unsigned char> &stored);
+
+//! decodes the stored_size bytes of stored with the codec into the n
+//! values and returns whether they decode to n floats
+bool decompress(const int codec, const unsigned char *stored,
+                const size_t stored_size, const size_t n, float *values);
+
+}  // namespace FloatCodec
+
+#endif  // SRC_FLOAT_CODEC_H_
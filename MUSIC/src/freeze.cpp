@@ -2,6 +2,7 @@
 // Copyright (C) 2017  Gabriel Denicol, Charles Gale, Sangyong Jeon, Matthew Luzum, Jean-François Paquet, Björn Schenke, Chun Shen
 
 #include "./freeze.h"
+#include "./surface_coarsening.h"
 #include <cstring>
 
 using namespace std;
@@ -18,6 +19,12 @@ Freeze::Freeze(InitData* DATA_in) {
 
     DATA_ptr = DATA_in;
     surface_in_binary = DATA_ptr->freeze_surface_in_binary;
+    stream_particleSpectrumNumber_ = 0;
+    stream_n_cells_ = 0;
+    stream_n_coarse_cells_ = 0;
+    thermal_spectra_streamed_ = false;
+    thermal_spectra_in_memory_ = false;
+    final_spectra_in_memory_ = false;
 
     // for final particle spectra and flow analysis, define the list
     // of charged hadrons that have a long enough lifetime to reach
@@ -103,12 +110,9 @@ void Freeze::checkForReadError(FILE *file, const char* name) {
     }
 }
 
-void Freeze::read_particle_PCE_mu(InitData* DATA, EOS *eos) {
-    double ef = DATA->epsilonFreeze;
-    music_message << "Determining chemical potentials at freeze out "
-                  << "energy density " << ef << " GeV/fm^3.";
-    music_message.flush("info");
-
+//! the chemical potentials of the stable particles at freeze-out of the
+//! partial chemical equilibrium EOS
+std::string Freeze::get_PCE_mu_filename(const InitData *DATA) const {
     // get environment path
     const char* EOSPATH = "HYDROPROGRAMPATH";
     char * pre_envPath= getenv(EOSPATH);
@@ -129,6 +133,17 @@ void Freeze::read_particle_PCE_mu(InitData* DATA, EOS *eos) {
     } else if (DATA->whichEOS == 6) {
         mu_name = envPath + "/EOS/s95p-PCE165-v0/s95p-PCE165-v0_pichem1.dat";
     }
+    return(mu_name);
+}
+
+
+void Freeze::read_particle_PCE_mu(InitData* DATA, const EOS *eos) {
+    double ef = DATA->epsilonFreeze;
+    music_message << "Determining chemical potentials at freeze out "
+                  << "energy density " << ef << " GeV/fm^3.";
+    music_message.flush("info");
+
+    const string mu_name = get_PCE_mu_filename(DATA);
     music_message << "Reading chemical potentials from file " << mu_name; 
     music_message.flush("info");
 
@@ -360,7 +375,7 @@ void Freeze::read_particle_PCE_mu(InitData* DATA, EOS *eos) {
 }
 
 
-void Freeze::ReadParticleData(InitData *DATA, EOS *eos) {
+void Freeze::ReadParticleData(InitData *DATA, const EOS *eos) {
     // read in particle and decay information from file:
     partid = new int[MAXINTV]; 
     music_message.info("reading particle data");
@@ -379,6 +394,37 @@ void Freeze::ReadParticleData(InitData *DATA, EOS *eos) {
         p_name = envPath + "/EOS/pdg-urqmd_v3.3+.dat";
     }
 
+    for (int k = 0; k < MAXINTV; k++) 
+        partid[k] = -1; 
+
+    // the tables of the species read so far, and the chemical potentials
+    // at freeze-out of the partial chemical equilibrium EOS
+    const bool is_PCE = (DATA->whichEOS > 2 && DATA->whichEOS < 6);
+    std::vector<std::string> source_files = {p_name};
+    std::vector<double> cache_parameters = {
+        static_cast<double>(DATA->whichEOS),
+        static_cast<double>(DATA->NumberOfParticlesToInclude)};
+    if (is_PCE) {
+        source_files.push_back(get_PCE_mu_filename(DATA));
+        cache_parameters.push_back(DATA->epsilonFreeze);
+    }
+    const string cache_file = (envPath + "/EOS/music_particle_cache_eos"
+                               + std::to_string(DATA->whichEOS) + ".bin");
+    const uint64_t cache_signature = ParticleTableCache::get_signature(
+                                            source_files, cache_parameters);
+    ParticleTableCache cache;
+    if (cache.load(cache_file, cache_signature)) {
+        particleList = new Particle[cache.get_number_of_particles() + 1];
+        set_particle_tables(cache);
+        music_message << "mapped particle species table from " << cache_file
+                      << ", " << cache.get_number_of_particles()
+                      << " species";
+        music_message.flush("info");
+        DATA->NumberOfParticlesToInclude = cache.get_number_of_particles();
+        music_message.info("Done reading particle data.");
+        return;
+    }
+
     music_message << "read in particle species table from " << p_name;
     music_message.flush("info");
 
@@ -386,16 +432,12 @@ void Freeze::ReadParticleData(InitData *DATA, EOS *eos) {
     p_file = fopen(p_name.c_str(), "r");
     checkForReadError(p_file, p_name.c_str());
 
-    for (int k = 0; k < MAXINTV; k++) 
-        partid[k] = -1; 
-
     if (DATA->echo_level > 5) {
-        music_message << "size_of_Particle= " << sizeof(Particle)/1024/1024
-                      << " MB";
+        music_message << "size_of_Particle= " << sizeof(Particle)/1024.
+                      << " kB";
         music_message.flush("info");
     }
-    particleList = (Particle *)malloc(
-                    (DATA->NumberOfParticlesToInclude + 2)*sizeof(Particle));
+    particleList = new Particle[DATA->NumberOfParticlesToInclude + 2];
     if (DATA->echo_level > 5) {
         music_message << "after first (check if there is enough memory... "
                       << "seg fault may be due to lack of memory)";
@@ -470,164 +512,224 @@ void Freeze::ReadParticleData(InitData *DATA, EOS *eos) {
     DATA->NumberOfParticlesToInclude = i;
 
     // here read the stable particles' chemical potential at freeze-out
-    if (DATA->whichEOS > 2 && DATA->whichEOS < 6) {
+    for (int ip = 0; ip < i; ip++) {
+        particleList[ip].muAtFreezeOut = 0.;
+    }
+    if (is_PCE) {
         read_particle_PCE_mu(DATA, eos);
     }
 
+    write_particle_table_cache(cache_file, cache_signature, i);
     music_message.info("Done reading particle data.");
 }
 
 
+//! sets the species, partid, and the decay table from the cache
+void Freeze::set_particle_tables(const ParticleTableCache &cache) {
+    const ParticleTableCache::ParticleRecord *records = cache.get_particles();
+    for (int i = 0; i < cache.get_number_of_particles(); i++) {
+        Particle &particle = particleList[i];
+        particle.number = records[i].number;
+        strcpy(particle.name, records[i].name);
+        particle.mass = records[i].mass;
+        particle.width = records[i].width;
+        particle.degeneracy = records[i].degeneracy;
+        particle.baryon = records[i].baryon;
+        particle.strange = records[i].strange;
+        particle.charm = records[i].charm;
+        particle.bottom = records[i].bottom;
+        particle.isospin = records[i].isospin;
+        particle.charge = records[i].charge;
+        particle.decays = records[i].decays;
+        particle.stable = records[i].stable;
+        particle.muAtFreezeOut = records[i].mu_at_freeze_out;
+        partid[MHALF + particle.number] = i;
+    }
+    const ParticleTableCache::DecayRecord *decays = cache.get_decays();
+    decayMax = cache.get_number_of_decays();
+    for (int j = 0; j < decayMax; j++) {
+        decay[j].reso = decays[j].reso;
+        decay[j].numpart = decays[j].numpart;
+        decay[j].branch = decays[j].branch;
+        for (int k = 0; k < 5; k++) {
+            decay[j].part[k] = decays[j].part[k];
+        }
+    }
+}
+
+
+//! writes the n_particles species of particleList and the decay table to the cache,
+//! failing to write it is not an error
+void Freeze::write_particle_table_cache(const std::string &cache_file,
+                                        const uint64_t signature,
+                                        const int n_particles) {
+    std::vector<ParticleTableCache::ParticleRecord> records(n_particles);
+    for (size_t i = 0; i < records.size(); i++) {
+        const Particle &particle = particleList[i];
+        ParticleTableCache::ParticleRecord &record = records[i];
+        std::memset(&record, 0, sizeof(record));
+        record.number = particle.number;
+        strcpy(record.name, particle.name);
+        record.mass = particle.mass;
+        record.width = particle.width;
+        record.degeneracy = particle.degeneracy;
+        record.baryon = particle.baryon;
+        record.strange = particle.strange;
+        record.charm = particle.charm;
+        record.bottom = particle.bottom;
+        record.isospin = particle.isospin;
+        record.charge = particle.charge;
+        record.decays = particle.decays;
+        record.stable = particle.stable;
+        record.mu_at_freeze_out = particle.muAtFreezeOut;
+    }
+    std::vector<ParticleTableCache::DecayRecord> decays(decayMax);
+    for (int j = 0; j < decayMax; j++) {
+        std::memset(&decays[j], 0, sizeof(decays[j]));
+        decays[j].reso = decay[j].reso;
+        decays[j].numpart = decay[j].numpart;
+        decays[j].branch = decay[j].branch;
+        for (int k = 0; k < 5; k++) {
+            decays[j].part[k] = decay[j].part[k];
+        }
+    }
+    if (ParticleTableCache::write(cache_file, signature, records, decays)) {
+        music_message << "wrote particle table cache " << cache_file;
+        music_message.flush("info");
+    } else {
+        music_message << "can not write the particle table cache "
+                      << cache_file;
+        music_message.flush("warning");
+    }
+}
+
+
 void Freeze::ReadFreezeOutSurface(InitData *DATA) {
     music_message.info("reading freeze-out surface");
 
-    ostringstream surfdat_stream;
-    surfdat_stream << "./surface.dat";
+    if (freezeout_surface_ptr != nullptr) {
+        if (freezeout_surface_ptr->get_number_of_isotherms() > 1) {
+            music_message.info(
+                "using the first isotherm of the hydro surface");
+        }
+        const int n_fields = freezeout_surface_ptr->get_number_of_fields();
+        const float *rows = freezeout_surface_ptr->get_elements(0).data();
+        NCells = freezeout_surface_ptr->get_number_of_elements(0);
+        music_message << "NCells = " << NCells;
+        music_message.flush("info");
+        surface.resize(NCells);
+        for (int i = 0; i < NCells; i++) {
+            set_surface_element(i, rows + static_cast<size_t>(i)*n_fields);
+        }
+        return;
+    }
 
-    // new counting, mac compatible ...
+    const std::string surface_filename = "./surface.dat";
     if (surface_in_binary) {
-        NCells = get_number_of_lines_of_binary_surface_file(
-                                                    surfdat_stream.str());
-    } else {
-        NCells = get_number_of_lines_of_text_surface_file(
-                                                    surfdat_stream.str());
+        // the rows are read from the mapped file, legacy files have
+        // 34 fields per element
+        MappedSurfaceFile surface_file(surface_filename,
+                                       FreezeoutSurface::kNumBaseFields);
+        const int n_fields = surface_file.get_number_of_fields();
+        const float *rows = surface_file.get_rows();
+        NCells = surface_file.get_number_of_elements();
+        music_message << "NCells = " << NCells;
+        music_message.flush("info");
+        surface.resize(NCells);
+        for (int i = 0; i < NCells; i++) {
+            set_surface_element(i, rows + static_cast<size_t>(i)*n_fields);
+        }
+        return;
     }
+
+    // new counting, mac compatible ...
+    NCells = get_number_of_lines_of_text_surface_file(surface_filename);
     music_message << "NCells = " << NCells;
     music_message.flush("info");
 
-    ifstream surfdat;
-    if (surface_in_binary) {
-        surfdat.open(surfdat_stream.str().c_str(), std::ios::binary);
-    } else {
-        surfdat.open(surfdat_stream.str().c_str());
-    }
-    // Now allocate memory: array of surfaceElements with length NCells
-    //surface = (SurfaceElement *) malloc((NCells)*sizeof(SurfaceElement));
-    int i = 0;
-    while (i < NCells) {
-        SurfaceElement temp_cell;
-        if (surface_in_binary) {
-            float array[34];
-            for (int ii = 0; ii < 34; ii++) {
-                float temp = 0.;
-                surfdat.read((char*)&temp, sizeof(float));
-                array[ii] = temp;
-            }
-            temp_cell.x[0] = array[0];
-            temp_cell.x[1] = array[1];
-            temp_cell.x[2] = array[2];
-            temp_cell.x[3] = array[3];
-            if (boost_invariant) {
-                temp_cell.x[3] = 0.0;
-            }
-
-            temp_cell.s[0] = array[4];
-            temp_cell.s[1] = array[5];
-            temp_cell.s[2] = array[6];
-            temp_cell.s[3] = array[7];
-
-            temp_cell.u[0] = array[8];
-            temp_cell.u[1] = array[9];
-            temp_cell.u[2] = array[10];
-            temp_cell.u[3] = array[11];
-
-            temp_cell.epsilon_f            = array[12];
-            temp_cell.T_f                  = array[13];
-            temp_cell.mu_B                 = array[14];
-            temp_cell.mu_S                 = array[15];
-            temp_cell.mu_C                 = array[16];
-            temp_cell.eps_plus_p_over_T_FO = array[17];
-
-            temp_cell.W[0][0] = array[18];
-            temp_cell.W[0][1] = array[19];
-            temp_cell.W[0][2] = array[20];
-            temp_cell.W[0][3] = array[21];
-            temp_cell.W[1][1] = array[22];
-            temp_cell.W[1][2] = array[23];
-            temp_cell.W[1][3] = array[24];
-            temp_cell.W[2][2] = array[25];
-            temp_cell.W[2][3] = array[26];
-            temp_cell.W[3][3] = array[27];
-
-            temp_cell.pi_b  = array[28];
-            temp_cell.rho_B = array[29];
-
-            temp_cell.q[0] = array[30];
-            temp_cell.q[1] = array[31];
-            temp_cell.q[2] = array[32];
-            temp_cell.q[3] = array[33];
-        } else {
-            // position in (tau, x, y, eta)
-            surfdat >> temp_cell.x[0] >> temp_cell.x[1]
-                    >> temp_cell.x[2] >> temp_cell.x[3];
-
-            // hypersurface vector in (tau, x, y, eta)
-            surfdat >> temp_cell.s[0] >> temp_cell.s[1]
-                    >> temp_cell.s[2] >> temp_cell.s[3];
-
-            // flow velocity in (tau, x, y, eta)
-            surfdat >> temp_cell.u[0] >> temp_cell.u[1]
-                    >> temp_cell.u[2] >> temp_cell.u[3];
-
-            surfdat >> temp_cell.epsilon_f >> temp_cell.T_f
-                    >> temp_cell.mu_B >> temp_cell.mu_S >> temp_cell.mu_C
-                    >> temp_cell.eps_plus_p_over_T_FO;
-
-            // freeze-out Wmunu
-            surfdat >> temp_cell.W[0][0] >> temp_cell.W[0][1]
-                    >> temp_cell.W[0][2] >> temp_cell.W[0][3]
-                    >> temp_cell.W[1][1] >> temp_cell.W[1][2]
-                    >> temp_cell.W[1][3] >> temp_cell.W[2][2]
-                    >> temp_cell.W[2][3] >> temp_cell.W[3][3];
-            if (DATA->turn_on_bulk) {
-                surfdat >> temp_cell.pi_b;
-            } else {
-                temp_cell.pi_b = 0.;
-            }
-            if (DATA->turn_on_rhob) {
-                surfdat >> temp_cell.rho_B;
-            } else {
-                temp_cell.rho_B = 0.;
-            }
-            if (DATA->turn_on_diff) {
-                surfdat >> temp_cell.q[0] >> temp_cell.q[1]
-                        >> temp_cell.q[2] >> temp_cell.q[3];
-            } else {
-                temp_cell.q[0] = 0.;
-                temp_cell.q[1] = 0.;
-                temp_cell.q[2] = 0.;
-                temp_cell.q[3] = 0.;
-            }
+    ifstream surfdat(surface_filename.c_str());
+    surface.resize(NCells);
+    for (int i = 0; i < NCells; i++) {
+        // the line in the order of the binary row
+        double temp[FreezeoutSurface::kNumBaseFields] = {0.};
+        // position, hypersurface vector, and flow velocity
+        // in (tau, x, y, eta), e, T, mu_B, mu_S, mu_C, (e + P)/T,
+        // and the freeze-out Wmunu
+        for (int ii = 0; ii < 28; ii++) {
+            surfdat >> temp[ii];
         }
-        temp_cell.sinh_eta_s = sinh(temp_cell.x[3]);
-        temp_cell.cosh_eta_s = cosh(temp_cell.x[3]);
-
-        if (temp_cell.epsilon_f < 0)  {
-            music_message.error("epsilon_f < 0.!");
-            exit(1);
+        if (DATA->turn_on_bulk) {
+            surfdat >> temp[28];
         }
-        if (temp_cell.T_f < 0) {
-            music_message.error("T_f < 0.!");
-            exit(1);
+        if (DATA->turn_on_rhob) {
+            surfdat >> temp[29];
         }
-        surface.push_back(temp_cell);
-        i++;
+        if (DATA->turn_on_diff) {
+            surfdat >> temp[30] >> temp[31] >> temp[32] >> temp[33];
+        }
+        float array[FreezeoutSurface::kNumBaseFields];
+        for (int ii = 0; ii < FreezeoutSurface::kNumBaseFields; ii++) {
+            array[ii] = static_cast<float>(temp[ii]);
+        }
+        set_surface_element(i, array);
     }
     surfdat.close();
 }
 
 
-int Freeze::get_number_of_lines_of_binary_surface_file(string filename) {
-    std::ifstream surface_file(filename.c_str(), std::ios::binary);
-    int count = 0;
-    float temp = 0.;
-    while(surface_file) {
-        surface_file.read((char*) &temp, sizeof(float));
-        count++;
+void Freeze::set_surface_element(const int i, const float *array) {
+    if (array[12] < 0)  {
+        music_message.error("epsilon_f < 0.!");
+        exit(1);
+    }
+    if (array[13] < 0) {
+        music_message.error("T_f < 0.!");
+        exit(1);
+    }
+    surface.set_element(i, array, boost_invariant);
+}
+
+
+void Freeze::coarsen_surface(InitData *DATA,
+                             const std::vector<int> &reference_numbers) {
+    const bool check = (DATA->surface_coarsening_check == 1
+                        && !reference_numbers.empty());
+    ThermalSpectraBlock full_block;
+    if (check) {
+        set_thermal_spectra_block(DATA, reference_numbers, full_block);
+        add_surface_to_block(DATA, full_block);
+    }
+
+    const int n_full_cells = NCells;
+    CompactSurface coarse;
+    SurfaceCoarsening(*DATA, boost_invariant).coarsen(surface, coarse);
+    surface = std::move(coarse);
+    NCells = surface.size();
+    music_message << "surface coarsening: NCells = " << n_full_cells
+                  << " -> " << NCells << " ("
+                  << 100.*NCells/std::max(1, n_full_cells) << "%)";
+    music_message.flush("info");
+    if (!check) return;
+
+    ThermalSpectraBlock coarse_block;
+    set_thermal_spectra_block(DATA, reference_numbers, coarse_block);
+    add_surface_to_block(DATA, coarse_block);
+    const int n_species = static_cast<int>(reference_numbers.size());
+    const int n_spectra = static_cast<int>(full_block.sum.size())/n_species;
+    for (int is = 0; is < n_species; is++) {
+        double sum_deviation, max_deviation;
+        SurfaceCoarsening::get_spectra_deviation(
+                &full_block.sum[is*n_spectra],
+                &coarse_block.sum[is*n_spectra], n_spectra,
+                sum_deviation, max_deviation);
+        const int j = full_block.species[is].j;
+        music_message << "surface coarsening: " << particleList[j].name
+                      << "(" << particleList[j].number
+                      << "): deviation of the summed spectrum = "
+                      << sum_deviation << ", largest deviation of a bin = "
+                      << max_deviation;
+        music_message.flush("info");
     }
-    int counted_line = count/34;
-    surface_file.close();
-    return(counted_line);
 }
 
 
@@ -28,6 +28,7 @@
 #include <iterator>
 #include <algorithm>
 #include <fstream>
+#include <memory>
 #include <unistd.h>
 #include <sstream>
 #include <string>
@@ -36,6 +37,12 @@
 #include "data.h"
 #include "util.h"
 #include "eos.h"
+#include "freezeout_surface.h"
+#include "compact_surface.h"
+#include "spectrum_moments.h"
+#include "cooper_frye_kernel.h"
+#include "particle_spectrum.h"
+#include "particle_table_cache.h"
 #include "pretty_ostream.h"
 
 const int nharmonics = 8;   // calculate up to maximum harmonic (n-1)
@@ -64,7 +71,7 @@ typedef struct particle {
     double phimax;
     double ymax;
     double deltaY;
-    double dNdydptdphi[NY][NPT][NPHI+1];
+    ParticleSpectrum dNdydptdphi;  // [ny][npt][nphi]
     double pt[NPT];         // pt values for spectrum
     double y[NY];           // y values for spectrum
     double slope;           // assymtotic slope of pt-spectrum
@@ -81,40 +88,57 @@ typedef struct de {
 } de;
 
 
-typedef struct pblockN {
-    double pt, mt, y, e, pl;        // pt, mt, y of decay product 1
-    double phi;
+//! the daughter of a decay at one (y, pT, phi) point of its spectrum, with
+//! the trigonometry of the phi nodes of the innermost decay integral
+struct DecayKinematics {
+    double pt, e, pl;               // pt, energy and p_z of decay product 1
+    double pt_cos_phi, pt_sin_phi;
     double m1, m2, m3;              // masses of decay products
     double mr;                      // mass of resonance
-    double costh, sinth;
-    double e0, p0;
     int res_num;                    // Montecarlo number of the Res.
-} pblockN;
+    double cos_phi_node[PTN2];      // cos(phi_i) of the phi nodes
+    double cos_phi_shifted[PTN2];   // cos(phi_i + phi), sin(phi_i + phi)
+    double sin_phi_shifted[PTN2];
+};
+
 
+//! a decay channel feeding a daughter particle in the resonance decays
+typedef struct reso_feed {
+    int pnR;            // internal number of the resonance
+    int j;              // decay channel
+    int numpart;        // number of particles of the decay
+    double m1, m2, m3;  // masses of decay products, m1 is the daughter
+    double mr;          // mass of resonance
+    double norm3;       // normalisation of 3-body integral
+} reso_feed;
 
-typedef struct nblock {
-    double a, b, c, d;
-} nblock;         // for normalisation integral of 3-body decays
+
+//! the properties of a particle species in the Cooper-Frye kernels
+struct ThermalSpecies {
+    int j;
+    double m;
+    int deg;
+    int baryon;
+    double sign;
+    double mu_PCE;
+};
 
 
-typedef struct surfaceElement {
-    double x[4];            // position in (tau, x, y, eta)
-    double sinh_eta_s;      // caching the sinh and cosh of eta_s
-    double cosh_eta_s;
-    double s[4];            // hypersurface vector in (tau, x, y, eta)
-    double u[4];            // flow velocity in (tau, x, y, eta)
-    double W[4][4];         // W^{\mu\nu}
-    double q[4];            // baryon diffusion current
-    double pi_b;            // bulk pressure
-    double rho_B;           // net baryon density
+//! the species of one pass over the surface with the caches of their
+//! momenta, and the sums of the Cooper-Frye integrand over the surface
+//! cells of [species][eta][pT][phi] ([species][pT][phi] if
+//! boost-invariant), which the chunks of a streamed surface add to
+struct ThermalSpectraBlock {
+    std::vector<ThermalSpecies> species;
+    std::vector<double> cos_phi, sin_phi;
+    //! rapidity, cosh(y), sinh(y) of [species][eta][pT], m_T of
+    //! [species][pT], and the range of the rapidity of [species][eta]
+    std::vector<double> rapidity, cosh_y, sinh_y;
+    std::vector<double> mt_array;
+    std::vector<double> y_row_min, y_row_max;
+    std::vector<double> sum;
+};
 
-    double epsilon_f;
-    double T_f;
-    double mu_B;
-    double mu_S;
-    double mu_C;
-    double eps_plus_p_over_T_FO;  // (energy_density+pressure)/temperature
-} SurfaceElement;
 
 //! This class perform Cooper-Fyre freeze-out and resonance decays
 class Freeze{
@@ -128,9 +152,15 @@ class Freeze{
     int system_status_;
 
     pretty_ostream music_message;
-    std::vector<SurfaceElement> surface;
+    CompactSurface surface;
+    //! the surface of the hydro run in the same MUSIC object, read instead
+    //! of ./surface.dat if set
+    std::shared_ptr<const FreezeoutSurface> freezeout_surface_ptr;
     Particle *particleList;
     int NCells;
+    //! the number of parts of the surface the Cooper-Frye passes sum
+    //! separately, fixed so that the spectra do not depend on the threads
+    static const int kNumSurfaceParts = 64;
     int decayMax, particleMax;
 
     de decay[NUMDECAY];
@@ -164,25 +194,127 @@ class Freeze{
 
     int bulk_deltaf_kind;
 
+    //! the thermal spectra of a streamed surface: the blocks of the
+    //! computed species, the species the others are copied from, and the
+    //! number of the streamed cells (and of the coarse ones)
+    std::vector<ThermalSpectraBlock> stream_blocks_;
+    std::vector<int> stream_copy_from_;
+    int stream_particleSpectrumNumber_;
+    int64_t stream_n_cells_;
+    int64_t stream_n_coarse_cells_;
+    bool thermal_spectra_streamed_;
+    //! the thermal spectra, or the ones after the resonance decays, of
+    //! this run are in particleList, instead of the spectra files
+    bool thermal_spectra_in_memory_;
+    bool final_spectra_in_memory_;
+
+    //! the Fourier moments of the spectra of particleList, against the
+    //! pseudo-rapidity [0] and the rapidity [1], and of the sum of the
+    //! charged hadrons against the pseudo-rapidity, built at the first
+    //! query of the observables of the spectra
+    std::vector<std::unique_ptr<SpectrumMoments>> spectrum_moments_[2];
+    std::unique_ptr<SpectrumMoments> charged_hadron_moments_;
+
  public:
     Freeze(InitData* DATA_in);
     ~Freeze();
 
-    double gauss(int n, double (Freeze::*f)(double, void *), double xlo,
-                 double xhi, void *optvec);
-    void read_particle_PCE_mu(InitData* DATA, EOS* eos);
-    int get_number_of_lines_of_binary_surface_file(std::string filename);
+    //! the species of the particle table and their spectra
+    int get_number_of_particles() const {return(particleMax);}
+    const Particle &get_particle(const int j) const {
+        return(particleList[j]);
+    }
+
+    void read_particle_PCE_mu(InitData* DATA, const EOS* eos);
     int get_number_of_lines_of_text_surface_file(std::string filename);
-    void ReadParticleData(InitData *DATA, EOS *eos);
+    void ReadParticleData(InitData *DATA, const EOS *eos);
+    std::string get_PCE_mu_filename(const InitData *DATA) const;
+    void set_particle_tables(const ParticleTableCache &cache);
+    void write_particle_table_cache(const std::string &cache_file,
+                                    const uint64_t signature,
+                                    const int n_particles);
+    void set_freezeout_surface(
+            std::shared_ptr<const FreezeoutSurface> surface_ptr_in) {
+        freezeout_surface_ptr = surface_ptr_in;
+    }
     void ReadFreezeOutSurface(InitData *DATA);
+    //! this function fills the surface element i from a row of a binary
+    //! surface (see freezeout_surface.h)
+    void set_surface_element(const int i, const float *array);
+    //! this function merges the elements of the surface with similar
+    //! fields (see SurfaceCoarsening). With surface_coarsening_check the
+    //! spectra of the species reference_numbers are computed on both
+    //! surfaces and their deviations are reported.
+    void coarsen_surface(InitData *DATA,
+                         const std::vector<int> &reference_numbers);
     void ReadSpectra_pseudo(InitData* DATA, int full, int verbose);
     void compute_thermal_spectra(int particleSpectrumNumber, InitData* DATA);
+    //! this function gives the Monte-Carlo numbers of the species whose
+    //! thermal spectra are computed, and for all the species the one their
+    //! spectra are copied from (0: computed)
+    void select_thermal_species(int particleSpectrumNumber, InitData *DATA,
+                                std::vector<int> &copy_from,
+                                std::vector<int> &numbers_to_compute);
+    //! this function samples the hadrons of number_of_sampled_events
+    //! events from the surface to sampled_particles.dat (see HadronSampler)
+    void sample_hadrons(InitData *DATA);
+    //! this function writes the thermal spectra, copying the ones of the
+    //! species with the same mass
+    void output_thermal_spectra(InitData *DATA, int particleSpectrumNumber,
+                                const std::vector<int> &copy_from);
+    //! this function sets up the spectra of particleList for the resonance
+    //! decays and the observables, as ReadSpectra_pseudo does for the
+    //! spectra files
+    void set_spectra_in_memory(InitData *DATA);
+    //! this function removes the thermal spectra files of a previous run
+    void remove_thermal_spectra_files();
+
+    //! these functions compute the thermal spectra from the chunks of the
+    //! surface published while the hydro runs (see surface_stream.h),
+    //! instead of the whole surface after the hydro. The chunk cells are
+    //! not kept, CooperFrye_pseudo then goes on from the thermal spectra.
+    void begin_thermal_spectra_stream(int particleSpectrumNumber,
+                                      InitData *DATA, const EOS *eos);
+    void add_surface_chunk(InitData *DATA, const float *rows,
+                           const int64_t n_elements, const int n_fields);
+    void finish_thermal_spectra_stream(InitData *DATA);
     void perform_resonance_decays(InitData *DATA);
     void compute_thermal_particle_spectra_and_vn(InitData* DATA);
     void compute_final_particle_spectra_and_vn(InitData* DATA);
-    void ComputeParticleSpectrum_pseudo_improved(InitData *DATA, int number);
-    void ComputeParticleSpectrum_pseudo_boost_invariant(InitData *DATA,
-                                                        int number);
+    //! this function sets up the block of the species (Monte-Carlo
+    //! numbers) computed in one pass over the surface
+    void set_thermal_spectra_block(InitData *DATA,
+                                   const std::vector<int> &numbers,
+                                   ThermalSpectraBlock &block);
+    //! these functions add the cells of the surface to the sums of block
+    void ComputeParticleSpectrum_pseudo_improved(
+                        InitData *DATA, ThermalSpectraBlock &block);
+    void ComputeParticleSpectrum_pseudo_boost_invariant(
+                        InitData *DATA, ThermalSpectraBlock &block);
+    //! this function adds the cells with the pass of the surface
+    void add_surface_to_block(InitData *DATA, ThermalSpectraBlock &block);
+    //! this function stores the spectra of the sums of block
+    void store_thermal_spectra_block(InitData *DATA,
+                                     const ThermalSpectraBlock &block);
+    //! this function sets the spectra grid of the species j
+    void set_thermal_spectrum_grid(InitData *DATA, const int j);
+    //! this function appends the thermal spectrum of the species j to
+    //! particleInformation.dat and yptphiSpectra.dat
+    void output_thermal_spectrum(InitData *DATA, const int j);
+    void get_freeze_cell_info(InitData *DATA, const int icell,
+                              FreezeCellInfo &cell);
+    //! this function gives (f_0 + delta f) p^mu dSigma_mu of the cell at
+    //! the momentum (ptau, px, py, peta), using the scalar path
+    double get_Cooper_Frye_integrand(const FreezeCellInfo &cell,
+                                     const CooperFryeSpecies &species,
+                                     const double ptau, const double px,
+                                     const double py, const double peta);
+    void report_Cooper_Frye_row(const FreezeCellInfo &cell,
+                                const CooperFryeSpecies &species,
+                                const double pt, const double ptau,
+                                const double peta,
+                                const std::vector<double> &cos_phi,
+                                const std::vector<double> &sin_phi);
 
     void load_deltaf_qmu_coeff_table(std::string filename);
     void load_deltaf_qmu_coeff_table_14mom(std::string filename);
@@ -204,18 +336,29 @@ class Freeze{
     /* J. Sollfrank, P. Koch, and U. Heinz, Z. Phys. C 52 (1991)  */
     /* for a description of the formalism utilized in this program. */
     
-    // this computes "Q(m_R,m_1,m_2,m_3)"
-    double norm3int (double x, void *paranorm);
-    double Edndp3(double yr, double ptr, double phirin, int res_num);
-    double dnpir2N(double phi, void *para1);    
-    double dnpir1N(double costh, void* para1);
-    double dn2ptN(double w2, void* para1);
-    double dn3ptN(double x, void* para1);
+    //! interpolates the spectrum of the resonance pn at (yr, ptr, phir)
+    double Edndp3(double yr, double ptr, double phir, int pn);
+    //! the spectrum of the resonance res_num at the n points (yr, ptr, phir)
+    void Edndp3(int n, const double *yr, const double *ptr,
+                const double *phir, int res_num, double *values);
+    //! the phi kernel of the decay at the PTN2 phi nodes of kin, for the
+    //! momentum p0 of the daughter at the angle costh in the resonance frame
+    void dnpir2N(const DecayKinematics &kin, double e0, double p0,
+                 double costh, double *values);
+    double dnpir1N(const DecayKinematics &kin, double e0, double p0,
+                   double costh);
+    double dn2ptN(const DecayKinematics &kin, double w2);
+    void set_decay_kinematics(double y, double pt, double phi, double m1,
+                              double m2, double m3, double mr, int res_num,
+                              DecayKinematics &kin) const;
     double Edndp3_2bodyN(double y, double pt, double phi, double m1, double m2,
                          double mr, int res_num);
     double Edndp3_3bodyN(double y, double pt, double phi, double m1, double m2,
                          double m3, double mr, double norm3, int res_num);
-    void add_reso(int pn, int pnR, int k, int j);
+    void set_reso_feed(int pn, int pnR, int k, int j, reso_feed &feed);
+    void add_reso_feed(const reso_feed &feed, int pn, int n, int l, int i);
+    void collect_reso_feeds(int i, int maxdecay,
+                            std::vector<reso_feed> &feeds);
     void cal_reso_decays(int maxpart, int maxdecay, int bound);
     // -----------------------------------------------------------------------
     
@@ -224,13 +367,27 @@ class Freeze{
     void OutputFullParticleSpectrum_pseudo(
                         InitData *DATA, int number, int anti, int full);
     void CooperFrye_pseudo(int particleSpectrumNumber, int mode,
-                           InitData *DATA, EOS *eos);
+                           InitData *DATA, const EOS *eos);
     double Rap(double eta, double pt, double m);
     double PseudoRap(double y, double pt, double m);
     double dydeta(double eta, double pt, double m);
     void rapidity_integrated_flow(InitData *DATA, int number, int yflag,
                                   double minrap, double maxrap,
                                   double vn[nharmonics][2][etasize]);
+    //! these functions exit if the range is outside the spectra grid of j
+    void check_rapidity_range(InitData *DATA, const int j, const int yflag,
+                              const double minrap, const double maxrap);
+    void check_pt_range(const int j, const double minpt, const double maxpt);
+    const SpectrumMoments &get_spectrum_moments(InitData *DATA, const int j,
+                                                const int yflag);
+    const SpectrumMoments &get_charged_hadron_moments(InitData *DATA);
+    //! this function clears the moments of the former spectra
+    void clear_spectrum_moments();
+    //! this function gives the moments of the charged hadrons summed over
+    //! the species, if they share the rapidity nodes (false otherwise)
+    bool get_charged_hadron_integrated_moments(
+            InitData *DATA, double minpt, double maxpt, int yflag,
+            double minrap, double maxrap, double moments[nharmonics][2]);
     void pt_and_rapidity_integrated_flow(InitData *DATA, int number,
                                          double minpt, double maxpt, int yflag,
                                          double minrap, double maxrap,
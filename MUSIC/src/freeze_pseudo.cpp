@@ -11,6 +11,9 @@
 #include<iomanip>
 #include<cstring>
 #include "freeze.h"
+#include "deterministic_sum.h"
+#include "hadron_sampler.h"
+#include "surface_coarsening.h"
 
 using Util::hbarc;
 using std::string;
@@ -104,6 +107,8 @@ void Freeze::ReadSpectra_pseudo(InitData* DATA, int full, int verbose) {
                           << particleList[ip].name << " ...";
             music_message.flush("info");
         }
+        particleList[ip].dNdydptdphi.resize(pseudo_steps + 1, iptmax,
+                                            iphimax);
         for(int ieta = 0; ieta <= pseudo_steps; ieta++) {
             for (int ipt = 0; ipt < iptmax; ipt++) {
                 for (int iphi = 0; iphi < iphimax; iphi++) {
@@ -129,19 +134,33 @@ void Freeze::ReadSpectra_pseudo(InitData* DATA, int full, int verbose) {
     fclose(s_file);
 }
 
-// Modified spectra calculation by ML 05/2013
-// Calculates on fixed grid in pseudorapidity, pt, and phi
-// adapted from ML and improved on performance (C. Shen 2015)
-void Freeze::ComputeParticleSpectrum_pseudo_improved(InitData *DATA,
-                                                     int number) {
-    double y_minus_eta_cut = 4.0;
-    int j = partid[MHALF+number];
-    // set some parameters
+namespace {
+    //! the species in the Cooper-Frye integrand of a cell at mu_B = muB
+    void set_Cooper_Frye_species(const InitData *DATA,
+                                 const ThermalSpecies &species,
+                                 const double muB,
+                                 CooperFryeSpecies &cf_species) {
+        cf_species.m = species.m;
+        cf_species.baryon = species.baryon;
+        cf_species.sign = species.sign;
+        cf_species.mu = species.baryon*muB;  // GeV
+        if (DATA->whichEOS>=3 && DATA->whichEOS < 10) {
+            // for PCE use the previously computed mu
+            // at the freeze-out energy density
+            cf_species.mu += species.mu_PCE;  // GeV
+        }
+    }
+}
+
+
+//! this function sets the pseudo-rapidity, pT, and phi grid of the
+//! thermal spectrum of the species j
+void Freeze::set_thermal_spectrum_grid(InitData *DATA, const int j) {
     double etamax = DATA->max_pseudorapidity;
     int ietamax = DATA->pseudo_steps + 1;  // pseudo_steps is number of steps.
                                            // Including edges
                                            // number of points is steps + 1
-    double deltaeta = 0;
+    double deltaeta = boost_invariant ? 1.0 : 0.0;
     if (ietamax > 1) {
         deltaeta = 2.*etamax/DATA->pseudo_steps;
     }
@@ -151,744 +170,490 @@ void Freeze::ComputeParticleSpectrum_pseudo_improved(InitData *DATA,
                                     // (ipt goes from 0 to iptmax)
     int iphimax = DATA->phi_steps;  // number of points
                                     // (phi=2pi equal to phi=0)
-    double deltaphi = 2*M_PI/iphimax;
-  
+
     // Reuse rapidity variables (Need to reuse variable y
     // so resonance decay routine can be used as is.
     // Might as well misuse ymax and deltaY too)
-    particleList[j].ymax = etamax; 
+    particleList[j].ymax = etamax;
     particleList[j].deltaY = deltaeta;
-
-    music_message << "Doing " << j << ": "
-                  << particleList[j].name << "("
-                  << particleList[j].number << ") ... ";
-    music_message.flush("info");
- 
-    particleList[j].ny = DATA->pseudo_steps + 1;
+    particleList[j].ny = ietamax;
     particleList[j].npt = iptmax;
     particleList[j].nphi = iphimax;
-  
-    // set particle properties
-    double m = particleList[j].mass;
-    int deg = particleList[j].degeneracy;
-    int baryon = particleList[j].baryon;
-    // int s = particleList[j].strange;
-    // int c = particleList[j].charge;
-    double mu_PCE = particleList[j].muAtFreezeOut;
-    int sign;
-    if (baryon == 0) {
-        sign = -1.;
-    } else {
-        sign = 1.;
-    }
-
-    // open files to write
-    FILE *d_file;
-    char *buf = new char[10];
-    sprintf (buf, "%d", 0);
-    
-    char *specString=new char[30];
-    strcpy(specString, "yptphiSpectra");
-    strcat(specString, buf);
-    strcat(specString, ".dat");
-    char* s_name = specString;
-    FILE *s_file;
-    s_file = fopen(s_name, "w");
-
-    delete[] specString;
-    delete[] buf;
-
-    // -----------------------------------------------------------------------
-    // write information in the particle information file
-    const char* d_name = "particleInformation.dat";
-    d_file = fopen(d_name, "a");
-    fprintf(d_file, "%d %e %d %e %e %d %d \n",
-            number,  etamax, DATA->pseudo_steps+1, ptmin, ptmax,
-            iptmax, iphimax);
-
-    // caching 
-    double* cos_phi = new double [iphimax];
-    double* sin_phi = new double [iphimax];
-    for (int iphi = 0; iphi < iphimax; iphi++) {
-        double phi_local = deltaphi*iphi;
-        cos_phi[iphi] = cos(phi_local);
-        sin_phi[iphi] = sin(phi_local);
-    }
-    double* pt_array = new double [iptmax];
+    particleList[j].dNdydptdphi.resize(ietamax, iptmax, iphimax);
     for (int ipt = 0; ipt < iptmax; ipt++) {
-        double pt =  (ptmin + (ptmax - ptmin)
-                               *pow(static_cast<double>(ipt), 2.)
-                               /pow(static_cast<double>(iptmax - 1), 2.));
-        pt_array[ipt] = pt;
-        particleList[j].pt[ipt] = pt;
+        particleList[j].pt[ipt] = (
+            ptmin + (ptmax - ptmin)*pow(static_cast<double>(ipt), 2.)
+                    /pow(static_cast<double>(iptmax - 1), 2.));
     }
-    
-    double *bulk_deltaf_coeffs = new double[3];
-    if (DATA_ptr->turn_on_bulk == 1 && DATA_ptr->include_deltaf_bulk == 1) {
-        if (bulk_deltaf_kind == 0) {
-            bulk_deltaf_coeffs = new double[3];
-        } else {
-            bulk_deltaf_coeffs = new double[2];
-        }
-    }
-      
-    double alpha = 0.0;
-    // main loop begins ...
-    // store E dN/d^3p as function of phi,
-    // pt and eta (pseudorapidity) in sumPtPhi:
-    int ieta;
-    for (ieta = 0; ieta < ietamax; ieta++) {
-        double eta = -etamax + ieta*deltaeta;
-
+    for (int ieta = 0; ieta < ietamax; ieta++) {
         // Use this variable to store pseudorapidity instead of rapidity
         // May cause confusion in the future,
         // but easier to to share code for both options:
         // calculating on a fixed grid in rapidity or pseudorapidity
-        particleList[j].y[ieta] = eta;  // store particle pseudo-rapidity
-
-        double* rapidity = new double [iptmax];
-        double* cosh_y = new double [iptmax];
-        double* sinh_y = new double [iptmax];
-        for (int ipt = 0; ipt < iptmax; ipt++) {
-            double pt = pt_array[ipt];
-            double y_local;
-            // rapidity as a function of pseudorapidity:
-            if (DATA->pseudofreeze == 1) {
-                y_local = Rap(eta, pt, m);
-            } else {
-                y_local = eta;
-            }
-            rapidity[ipt] = y_local;
-            cosh_y[ipt] = cosh(y_local);
-            sinh_y[ipt] = sinh(y_local);
-        }
+        particleList[j].y[ieta] = -etamax + ieta*deltaeta;
+    }
+}
 
-        double** temp_sum = new double* [iptmax];
-        for (int ii = 0; ii < iptmax; ii++) {
-            temp_sum[ii] = new double [iphimax];
-            for (int jj = 0; jj < iphimax; jj++) {
-                temp_sum[ii][jj] = 0.0;
-            }
-        }
 
-        #pragma omp parallel
-        {
-            // need to perform reduction on a 2d array
-            // first create a private copy for every omp_thread
-            // use critical clause at the end to add the private 2d arrays
-            // together from individual omp_thread
-            double temp_sum_private[iptmax][iphimax];
-            for (int ii = 0; ii < iptmax; ii++) {
-                for (int jj = 0; jj < iphimax; jj++) {
-                    temp_sum_private[ii][jj] = 0.0;
-                }
-            }
+//! this function appends the thermal spectrum of the species j to
+//! particleInformation.dat and yptphiSpectra.dat
+void Freeze::output_thermal_spectrum(InitData *DATA, const int j) {
+    const int iptmax = DATA->pt_steps + 1;
+    const int iphimax = DATA->phi_steps;
+    const int ietamax = DATA->pseudo_steps + 1;
 
-            #pragma omp for
-            for (int icell = 0; icell < NCells; icell++) {
-                double tau        = surface[icell].x[0];
-                double eta_s      = surface[icell].x[3];
-                double cosh_eta_s = surface[icell].cosh_eta_s;
-                double sinh_eta_s = surface[icell].sinh_eta_s;
-
-                double T   = surface[icell].T_f*hbarc;  // GeV
-                double muB = surface[icell].mu_B*hbarc;  // GeV
-                double mu  = baryon*muB;  // GeV
-                if (DATA->whichEOS>=3 && DATA->whichEOS < 10) {
-                    // for PCE use the previously computed mu
-                    // at the freeze-out energy density
-                    mu += mu_PCE;  // GeV
-                }
+    FILE *d_file = fopen("particleInformation.dat", "a");
+    fprintf(d_file, "%d %e %d %e %e %d %d \n",
+            particleList[j].number, DATA->max_pseudorapidity, ietamax,
+            DATA->min_pt, DATA->max_pt, iptmax, iphimax);
+    fclose(d_file);
 
-                double sigma_mu[4];
-                double u_flow[4];
-                for (int ii = 0; ii < 4; ii++) {
-                    sigma_mu[ii] = surface[icell].s[ii];
-                    u_flow[ii] = surface[icell].u[ii];
-                }
+    FILE *s_file = fopen("yptphiSpectra.dat", "a");
+    for (int ieta = 0; ieta < ietamax; ieta++) {
+        for (int ipt = 0; ipt < iptmax; ipt++) {
+            for (int iphi = 0; iphi < iphimax; iphi++) {
+                fprintf(s_file, "%e ",
+                        particleList[j].dNdydptdphi[ieta][ipt][iphi]);
+            }
+            fprintf(s_file, "\n");
+        }
+    }
+    fclose(s_file);
+}
 
-                double W00 = 0.0;
-                double W01 = 0.0;
-                double W02 = 0.0;
-                double W03 = 0.0;
-                double W11 = 0.0;
-                double W12 = 0.0;
-                double W13 = 0.0;
-                double W22 = 0.0;
-                double W23 = 0.0;
-                double W33 = 0.0;
-                int flag_shear_deltaf = 0;
-                if (DATA->turn_on_shear == 1 && DATA->include_deltaf == 1) {
-                    flag_shear_deltaf = 1;
-                    W00 = surface[icell].W[0][0];
-                    W01 = surface[icell].W[0][1];
-                    W02 = surface[icell].W[0][2];
-                    W03 = surface[icell].W[0][3];
-                    W11 = surface[icell].W[1][1];
-                    W12 = surface[icell].W[1][2];
-                    W13 = surface[icell].W[1][3];
-                    W22 = surface[icell].W[2][2];
-                    W23 = surface[icell].W[2][3];
-                    W33 = surface[icell].W[3][3];
-                }
 
-                double Pi_bulk = 0.0;
-                int flag_bulk_deltaf = 0;
-                if (DATA->turn_on_bulk == 1 && DATA->include_deltaf_bulk == 1) {
-                    flag_bulk_deltaf = 1;
-                    Pi_bulk = surface[icell].pi_b;
-                    getbulkvisCoefficients(T, bulk_deltaf_coeffs);
-                }
-                
-                double qmu_0 = 0.0;
-                double qmu_1 = 0.0;
-                double qmu_2 = 0.0;
-                double qmu_3 = 0.0;
-                double deltaf_qmu_coeff = 1.0;
-                double deltaf_qmu_coeff_14mom_DV = 0.0;
-                double deltaf_qmu_coeff_14mom_BV = 0.0;
-                int flag_qmu_deltaf = 0;
-                if (DATA->turn_on_diff == 1 && DATA->include_deltaf_qmu == 1) {
-                    flag_qmu_deltaf = 1;
-                    qmu_0 = surface[icell].q[0];
-                    qmu_1 = surface[icell].q[1];
-                    qmu_2 = surface[icell].q[2];
-                    qmu_3 = surface[icell].q[3];
-                    if (DATA->deltaf_14moments == 0) {
-                        deltaf_qmu_coeff = get_deltaf_qmu_coeff(T, muB);
-                    } else {
-                        deltaf_qmu_coeff_14mom_DV =
-                                        get_deltaf_coeff_14moments(T, muB, 3);
-                        deltaf_qmu_coeff_14mom_BV =
-                                        get_deltaf_coeff_14moments(T, muB, 4);
-                    }
-                }
-                double rhoB = 0.0;
-                if (DATA->turn_on_rhob == 1) {
-                    rhoB = surface[icell].rho_B;
-                }
-
-                double eps_plus_P_over_T = surface[icell].eps_plus_p_over_T_FO;
-                double prefactor_shear = 1./(2.*eps_plus_P_over_T*T*T*T)*hbarc; 
-                                                                // fm^4/GeV^2
-                double prefactor_qmu = rhoB/(eps_plus_P_over_T*T);   // 1/GeV
+//! this function collects the quantities of the surface cell icell that
+//! do not depend on the particle species
+void Freeze::get_freeze_cell_info(InitData *DATA, const int icell,
+                                  FreezeCellInfo &cell) {
+    cell.tau        = surface.get(SurfaceField::tau, icell);
+    cell.eta_s      = surface.get(SurfaceField::eta_s, icell);
+    cell.cosh_eta_s = surface.get(SurfaceField::cosh_eta_s, icell);
+    cell.sinh_eta_s = surface.get(SurfaceField::sinh_eta_s, icell);
+
+    cell.T   = surface.get(SurfaceField::T_f, icell)*hbarc;   // GeV
+    cell.muB = surface.get(SurfaceField::mu_B, icell)*hbarc;  // GeV
+    for (int ii = 0; ii < 4; ii++) {
+        cell.sigma_mu[ii] = surface.get(SurfaceField::s + ii, icell);
+        cell.u_flow[ii] = surface.get(SurfaceField::u + ii, icell);
+    }
+
+    cell.flag_shear_deltaf = 0;
+    for (int ii = 0; ii < 10; ii++) cell.W[ii] = 0.0;
+    if (DATA->turn_on_shear == 1 && DATA->include_deltaf == 1) {
+        cell.flag_shear_deltaf = 1;
+        for (int ii = 0; ii < 10; ii++) {
+            cell.W[ii] = surface.get(SurfaceField::W + ii, icell);
+        }
+    }
 
-                for (int ipt = 0; ipt < iptmax; ipt++) {
-                    double y = rapidity[ipt];
-                    if (fabs(y - eta_s) < y_minus_eta_cut) {
-                        double pt = pt_array[ipt];
-                        double cosh_y_local = cosh_y[ipt];
-                        double sinh_y_local = sinh_y[ipt];
-                        double mt = sqrt(m*m + pt*pt);     // all in GeV
-                        double ptau = mt*(cosh_y_local*cosh_eta_s
-                                          - sinh_y_local*sinh_eta_s); 
-                        double peta = mt*(sinh_y_local*cosh_eta_s
-                                          - cosh_y_local*sinh_eta_s); 
-                        for (int iphi = 0; iphi < iphimax; iphi++) {
-                            double px = pt*cos_phi[iphi];
-                            double py = pt*sin_phi[iphi];
-                  
-                            double sum;
-                            // compute p^mu*dSigma_mu [fm^3*GeV]
-                            double pdSigma = tau*(ptau*sigma_mu[0]
-                                                  + px*sigma_mu[1]
-                                                  + py*sigma_mu[2]
-                                                  + peta/tau*sigma_mu[3]);
-                            double E = (ptau*u_flow[0] - px*u_flow[1]
-                                        - py*u_flow[2] - peta*u_flow[3]);
-                            // this is the equilibrium f, f_0:
-                            double f = 1./(exp(1./T*(E - mu)) + sign);
-                     
-                            // now comes the delta_f: check if still correct
-                            // at finite mu_b 
-                            // we assume here the same C=eta/s for
-                            // all particle species because
-                            // it is the simplest way to do it.
-                            // also we assume Xi(p)=p^2, the quadratic Ansatz
-                            double Wfactor = 0.0;
-                            double delta_f_shear = 0.0;
-                            if (flag_shear_deltaf == 1) {
-                                Wfactor = (ptau*W00*ptau - 2.*ptau*W01*px
-                                           - 2.*ptau*W02*py
-                                           - 2.*ptau*W03*peta
-                                           + px*W11*px + 2.*px*W12*py
-                                           + 2.*px*W13*peta
-                                           + py*W22*py + 2.*py*W23*peta
-                                           + peta*W33*peta);
-                                delta_f_shear = (f*(1. - sign*f)
-                                                 *prefactor_shear*Wfactor);
-                                if (DATA->include_deltaf==2) {
-                                    // if delta f is proportional
-                                    // to p^(2-alpha):
-                                    delta_f_shear = (delta_f_shear
-                                                     *pow((T/E), 1.*alpha)
-                                                     *120./(tgamma(6.-alpha))); 
-                                }
-                            }
-                            double delta_f_bulk = 0.0;
-                            if (flag_bulk_deltaf == 1) {
-                                if (bulk_deltaf_kind == 0) {
-                                    delta_f_bulk = (
-                                        - f*(1. - sign*f)*Pi_bulk
-                                        *(bulk_deltaf_coeffs[0]*m*m
-                                          + bulk_deltaf_coeffs[1]*E
-                                          + bulk_deltaf_coeffs[2]*E*E));
-                                } else if (bulk_deltaf_kind == 1) {
-                                    double E_over_T = E/T;
-                                    double mass_over_T = m/T;
-                                    delta_f_bulk = (
-                                        - f*(1. - sign*f)/E_over_T
-                                        *bulk_deltaf_coeffs[0]
-                                        *(mass_over_T*mass_over_T/3.
-                                          - bulk_deltaf_coeffs[1]
-                                            *E_over_T*E_over_T)
-                                        *Pi_bulk);
-                                } else if (bulk_deltaf_kind == 2) {
-                                    double E_over_T = E/T;
-                                    delta_f_bulk = (
-                                        - f*(1. - sign*f)
-                                        *(-bulk_deltaf_coeffs[0]
-                                          + bulk_deltaf_coeffs[1]*E_over_T)
-                                        *Pi_bulk);
-                                } else if (bulk_deltaf_kind == 3) {
-                                    double E_over_T = E/T;
-                                    delta_f_bulk = (
-                                        - f*(1.-sign*f)/sqrt(E_over_T)
-                                            *(- bulk_deltaf_coeffs[0]
-                                              + bulk_deltaf_coeffs[1]*E_over_T)
-                                            *Pi_bulk);
-                                } else if (bulk_deltaf_kind == 4) {
-                                    double E_over_T = E/T;
-                                    delta_f_bulk = (
-                                        - f*(1.-sign*f)
-                                            *(bulk_deltaf_coeffs[0]
-                                              - bulk_deltaf_coeffs[1]/E_over_T)
-                                            *Pi_bulk);
-                                }
-                            }
-
-                            // delta f for qmu
-                            double qmufactor = 0.0;
-                            double delta_f_qmu = 0.0;
-                            if (flag_qmu_deltaf == 1) {
-                                // p^\mu q_\mu
-                                qmufactor = (ptau*qmu_0 - px*qmu_1 - py*qmu_2
-                                             - peta*qmu_3);
-                                if (DATA->deltaf_14moments == 0) {
-                                    delta_f_qmu = (
-                                        f*(1. - sign*f)
-                                         *(prefactor_qmu - baryon/E)*qmufactor
-                                         /deltaf_qmu_coeff);
-                                } else {
-                                    delta_f_qmu = (
-                                        f*(1. - sign*f)
-                                         *(baryon*deltaf_qmu_coeff_14mom_DV
-                                           + 2.*deltaf_qmu_coeff_14mom_BV*E)
-                                         *qmufactor);
-                                }
-                            }
-
-                            double max_ratio = 1.0;
-                            double total_deltaf = (delta_f_shear
-                                                   + delta_f_bulk
-                                                   + delta_f_qmu);
-
-                            if (fabs(total_deltaf)/f > max_ratio) {
-                                total_deltaf *= f/fabs(total_deltaf);
-                            }
-                            sum = (f + total_deltaf)*pdSigma;
-                     
-                            if (sum > 10000) {
-                                music_message << "sum>10000 in summation. sum = "
-                                     << sum 
-                                     << ", f=" << f << ", deltaf="
-                                     << delta_f_shear
-                                     << ", pdSigma=" << pdSigma << ", T=" << T 
-                                     << ", E=" << E << ", mu=" << mu;
-                                music_message.flush("warning");
-                            }
-                            if (f < 0.) {
-                                music_message << " f_eq < 0.! f_eq = " << f
-                                              << ", T = " << T << " GeV, mu = "
-                                              << mu << " GeV, E = "
-                                              << E << " GeV";
-                                music_message.flush("error");
-                            }
-                            temp_sum_private[ipt][iphi] += sum;
-                        }
-                    }
-                }
-            }
-            #pragma omp critical
-            {
-                for (int ipt = 0; ipt < iptmax; ipt++) {
-                    for (int iphi = 0; iphi < iphimax; iphi++) {
-                        temp_sum[ipt][iphi] += temp_sum_private[ipt][iphi];
-                    }
-                }
-            }
+    cell.Pi_bulk = 0.0;
+    cell.flag_bulk_deltaf = 0;
+    for (int ii = 0; ii < 3; ii++) cell.bulk_deltaf_coeffs[ii] = 0.0;
+    if (DATA->turn_on_bulk == 1 && DATA->include_deltaf_bulk == 1) {
+        cell.flag_bulk_deltaf = 1;
+        cell.Pi_bulk = surface.get(SurfaceField::pi_b, icell);
+        getbulkvisCoefficients(cell.T, cell.bulk_deltaf_coeffs);
+    }
+
+    for (int ii = 0; ii < 4; ii++) cell.q[ii] = 0.0;
+    cell.deltaf_qmu_coeff = 1.0;
+    cell.deltaf_qmu_coeff_14mom_DV = 0.0;
+    cell.deltaf_qmu_coeff_14mom_BV = 0.0;
+    cell.flag_qmu_deltaf = 0;
+    if (DATA->turn_on_diff == 1 && DATA->include_deltaf_qmu == 1) {
+        cell.flag_qmu_deltaf = 1;
+        for (int ii = 0; ii < 4; ii++) {
+            cell.q[ii] = surface.get(SurfaceField::q + ii, icell);
         }
-        double prefactor = deg/(pow(2.*M_PI,3.)*pow(hbarc,3.));
-        // store the final results
-        for (int ipt = 0; ipt < iptmax; ipt++) {
-            for (int iphi = 0; iphi < iphimax; iphi++) {
-                double sum = temp_sum[ipt][iphi]*prefactor;   // in GeV^(-2)
-                particleList[j].dNdydptdphi[ieta][ipt][iphi] = sum;
-                fprintf(s_file,"%e ", sum);
-            }
-            fprintf(s_file,"\n");
+        if (DATA->deltaf_14moments == 0) {
+            cell.deltaf_qmu_coeff = get_deltaf_qmu_coeff(cell.T, cell.muB);
+        } else {
+            cell.deltaf_qmu_coeff_14mom_DV =
+                            get_deltaf_coeff_14moments(cell.T, cell.muB, 3);
+            cell.deltaf_qmu_coeff_14mom_BV =
+                            get_deltaf_coeff_14moments(cell.T, cell.muB, 4);
         }
-        // clean up
-        delete[] rapidity;
-        delete[] cosh_y;
-        delete[] sinh_y;
-        for (int ipt = 0; ipt < iptmax; ipt++)
-            delete[] temp_sum[ipt];
-        delete[] temp_sum;
     }
-    
-    if (DATA_ptr->turn_on_bulk == 1 && DATA_ptr->include_deltaf_bulk == 1) {
-        delete[] bulk_deltaf_coeffs;
+    double rhoB = 0.0;
+    if (DATA->turn_on_rhob == 1) {
+        rhoB = surface.get(SurfaceField::rho_B, icell);
     }
 
-    // clean up
-    delete[] cos_phi;
-    delete[] sin_phi;
-    delete[] pt_array;
-    fclose(s_file);
-    fclose(d_file);
+    const double eps_plus_P_over_T = surface.get(
+                                SurfaceField::eps_plus_p_over_T, icell);
+    const double T = cell.T;
+    cell.prefactor_shear = 1./(2.*eps_plus_P_over_T*T*T*T)*hbarc;
+    cell.prefactor_qmu = rhoB/(eps_plus_P_over_T*T);
 }
 
 
-void Freeze::ComputeParticleSpectrum_pseudo_boost_invariant(
-                                        InitData *DATA, int number) {
-    // this function compute thermal paritcle spectra assuming a
-    // boost-invarianat hyper-surface from hydro simulations
-    int j = partid[MHALF+number];
-    // set some parameters
-    double etamax = DATA->max_pseudorapidity;
-    int ietamax = DATA->pseudo_steps + 1;  // pseudo_steps is number of steps.
-                                           // Including edges
-                                           // number of points is steps + 1
-    double deltaeta = 1.0;
-    if (ietamax > 1)
-        deltaeta = 2.*etamax/DATA->pseudo_steps;
-    double ptmax = DATA->max_pt;
-    double ptmin = DATA->min_pt;
-    int iptmax = DATA->pt_steps+1;  // Number of points is iptmax + 1
-                                    // (ipt goes from 0 to iptmax)
-    int iphimax = DATA->phi_steps;  // number of points
-                                    // (phi=2pi equal to phi=0)
-    double deltaphi = 2*M_PI/iphimax;
-  
-    // Reuse rapidity variables (Need to reuse variable y
-    // so resonance decay routine can be used as is.
-    // Might as well misuse ymax and deltaY too)
-    particleList[j].ymax = etamax; 
-    particleList[j].deltaY = deltaeta;
+double Freeze::get_Cooper_Frye_integrand(const FreezeCellInfo &cell,
+                                         const CooperFryeSpecies &species,
+                                         const double ptau, const double px,
+                                         const double py, const double peta) {
+    double f = 0.0;
+    double delta_f_shear = 0.0;
+    const double sum = CooperFrye::get_integrand(
+                cell, bulk_deltaf_kind, DATA_ptr->deltaf_14moments, species,
+                ptau, px, py, peta, f, delta_f_shear);
+
+    const double T = cell.T;
+    const double mu = species.mu;
+    if (sum > 10000) {
+        const double pdSigma = cell.tau*(ptau*cell.sigma_mu[0]
+                                         + px*cell.sigma_mu[1]
+                                         + py*cell.sigma_mu[2]
+                                         + peta/cell.tau*cell.sigma_mu[3]);
+        const double E = (ptau*cell.u_flow[0] - px*cell.u_flow[1]
+                          - py*cell.u_flow[2] - peta*cell.u_flow[3]);
+        music_message << "sum>10000 in summation. sum = " << sum
+                      << ", f=" << f << ", deltaf=" << delta_f_shear
+                      << ", pdSigma=" << pdSigma << ", T=" << T
+                      << ", E=" << E << ", mu=" << mu;
+        music_message.flush("warning");
+    }
+    if (f < 0.) {
+        const double E = (ptau*cell.u_flow[0] - px*cell.u_flow[1]
+                          - py*cell.u_flow[2] - peta*cell.u_flow[3]);
+        music_message << " f_eq < 0.! f_eq = " << f
+                      << ", T = " << T << " GeV, mu = "
+                      << mu << " GeV, E = " << E << " GeV";
+        music_message.flush("error");
+    }
+    return(sum);
+}
 
-    music_message << "Doing " << j << ": "
-                  << particleList[j].name << "("
-                  << particleList[j].number << ") ...";
-    music_message.flush("info");
- 
-    particleList[j].ny = DATA->pseudo_steps + 1;
-    particleList[j].npt = iptmax;
-    particleList[j].nphi = iphimax;
-  
-    // set particle properties
-    double m = particleList[j].mass;
-    int deg = particleList[j].degeneracy;
-    int baryon = particleList[j].baryon;
-    // int s = particleList[j].strange;
-    // int c = particleList[j].charge;
-    double mu_PCE = particleList[j].muAtFreezeOut;
-    int sign;
-    if (baryon == 0) {
-        sign = -1.;
-    } else {
-        sign = 1.;
+
+//! this function reports the warnings of the Cooper-Frye integrand at the
+//! momenta of a phi row with the scalar path
+void Freeze::report_Cooper_Frye_row(const FreezeCellInfo &cell,
+                                    const CooperFryeSpecies &species,
+                                    const double pt, const double ptau,
+                                    const double peta,
+                                    const std::vector<double> &cos_phi,
+                                    const std::vector<double> &sin_phi) {
+    for (unsigned int iphi = 0; iphi < cos_phi.size(); iphi++) {
+        get_Cooper_Frye_integrand(cell, species, ptau, pt*cos_phi[iphi],
+                                  pt*sin_phi[iphi], peta);
     }
+}
 
-    // open files to write
-    FILE *d_file;
-    string d_name = "particleInformation.dat";
-    d_file = fopen(d_name.c_str(), "a");
 
-    string s_name = "yptphiSpectra0.dat";
-    FILE *s_file;
-    s_file = fopen(s_name.c_str(), "w");
+//! this function sets up the species of numbers, their spectra grids and
+//! the caches of their momenta, with the sums at zero
+void Freeze::set_thermal_spectra_block(InitData *DATA,
+                                       const std::vector<int> &numbers,
+                                       ThermalSpectraBlock &block) {
+    const int ietamax = DATA->pseudo_steps + 1;
+    const int iptmax = DATA->pt_steps + 1;
+    const int iphimax = DATA->phi_steps;
+    const double deltaphi = 2*M_PI/iphimax;
 
-    // -----------------------------------------------------------------------
-    // write information in the particle information file
-    fprintf(d_file, "%d %e %d %e %e %d %d \n",
-            number,  etamax, DATA->pseudo_steps+1, ptmin, ptmax,
-            iptmax, iphimax);
-    // caching 
-    double *cos_phi = new double[iphimax];
-    double *sin_phi = new double[iphimax];
+    // set particle properties
+    const int n_species = static_cast<int>(numbers.size());
+    std::vector<ThermalSpecies> &species = block.species;
+    species.resize(n_species);
+    for (int is = 0; is < n_species; is++) {
+        const int j = partid[MHALF + numbers[is]];
+        music_message << "Doing " << j << ": "
+                      << particleList[j].name << "("
+                      << particleList[j].number << ") ... ";
+        music_message.flush("info");
+        set_thermal_spectrum_grid(DATA, j);
+        species[is].j = j;
+        species[is].m = particleList[j].mass;
+        species[is].deg = particleList[j].degeneracy;
+        species[is].baryon = particleList[j].baryon;
+        species[is].sign = (species[is].baryon == 0) ? -1. : 1.;
+        species[is].mu_PCE = particleList[j].muAtFreezeOut;
+    }
+
+    // caching
+    block.cos_phi.resize(iphimax);
+    block.sin_phi.resize(iphimax);
     for (int iphi = 0; iphi < iphimax; iphi++) {
         double phi_local = deltaphi*iphi;
-        cos_phi[iphi] = cos(phi_local);
-        sin_phi[iphi] = sin(phi_local);
-    }
-    double* pt_array = new double[iptmax];
-    for (int ipt = 0; ipt < iptmax; ipt++) {
-        double pt =  (ptmin + (ptmax - ptmin)
-                              *pow(static_cast<double>(ipt), 2.)
-                              /pow(static_cast<double>(iptmax - 1), 2.));
-        pt_array[ipt] = pt;
-        particleList[j].pt[ipt] = pt;
+        block.cos_phi[iphi] = cos(phi_local);
+        block.sin_phi[iphi] = sin(phi_local);
     }
-    
-    double *bulk_deltaf_coeffs = new double[3];
-    if (DATA_ptr->turn_on_bulk == 1 && DATA_ptr->include_deltaf_bulk == 1) {
-        if (bulk_deltaf_kind == 0) {
-            bulk_deltaf_coeffs = new double[3];
-        } else {
-            bulk_deltaf_coeffs = new double[2];
+    block.mt_array.resize(n_species*iptmax);
+    for (int is = 0; is < n_species; is++) {
+        const double m = species[is].m;
+        for (int ipt = 0; ipt < iptmax; ipt++) {
+            const double pt = particleList[species[is].j].pt[ipt];
+            block.mt_array[is*iptmax + ipt] = sqrt(m*m + pt*pt);  // in GeV
         }
     }
-      
-    double alpha = 0.0;
-    double** temp_sum = new double* [iptmax];
-    for (int ii = 0; ii < iptmax; ii++) {
-        temp_sum[ii] = new double [iphimax];
-        for (int jj = 0; jj < iphimax; jj++) {
-            temp_sum[ii][jj] = 0.0;
+    if (boost_invariant) {
+        // the spectra are the same at all rapidities
+        block.sum.assign(n_species*iptmax*iphimax, 0.0);
+        return;
+    }
+
+    const int n_yp = ietamax*iptmax;
+    block.rapidity.resize(n_species*n_yp);
+    block.cosh_y.resize(n_species*n_yp);
+    block.sinh_y.resize(n_species*n_yp);
+    block.y_row_min.resize(n_species*ietamax);
+    block.y_row_max.resize(n_species*ietamax);
+    for (int is = 0; is < n_species; is++) {
+        const int j = species[is].j;
+        const double m = species[is].m;
+        for (int ieta = 0; ieta < ietamax; ieta++)
+        for (int ipt = 0; ipt < iptmax; ipt++) {
+            const double eta = particleList[j].y[ieta];
+            const double pt = particleList[j].pt[ipt];
+            double y_local;
+            // rapidity as a function of pseudorapidity:
+            if (DATA->pseudofreeze == 1) {
+                y_local = Rap(eta, pt, m);
+            } else {
+                y_local = eta;
+            }
+            const int idx = is*n_yp + ieta*iptmax + ipt;
+            block.rapidity[idx] = y_local;
+            block.cosh_y[idx] = cosh(y_local);
+            block.sinh_y[idx] = sinh(y_local);
+            const int irow = is*ietamax + ieta;
+            if (ipt == 0) {
+                block.y_row_min[irow] = y_local;
+                block.y_row_max[irow] = y_local;
+            }
+            block.y_row_min[irow] = std::min(block.y_row_min[irow], y_local);
+            block.y_row_max[irow] = std::max(block.y_row_max[irow], y_local);
         }
     }
-    
+    block.sum.assign(n_species*n_yp*iphimax, 0.0);
+}
+
+
+// Modified spectra calculation by ML 05/2013
+// Calculates on fixed grid in pseudorapidity, pt, and phi
+// adapted from ML and improved on performance (C. Shen 2015)
+// The species of the block share the pass over the surface: the
+// quantities of a cell are evaluated once for all of them. The surface is
+// split into kNumSurfaceParts parts of consecutive cells, each summed in
+// order into its own (species, eta, pT, phi) array, and the part arrays
+// are added in a fixed tree (see DeterministicSum), so the spectra do not
+// depend on the number of threads.
+void Freeze::ComputeParticleSpectrum_pseudo_improved(
+                        InitData *DATA, ThermalSpectraBlock &block) {
+    double y_minus_eta_cut = 4.0;
+    const int ietamax = DATA->pseudo_steps + 1;
+    const int iptmax = DATA->pt_steps + 1;
+    const int iphimax = DATA->phi_steps;
+
+    const std::vector<ThermalSpecies> &species = block.species;
+    const int n_species = static_cast<int>(species.size());
+    const std::vector<double> &cos_phi = block.cos_phi;
+    const std::vector<double> &sin_phi = block.sin_phi;
+    const std::vector<double> &rapidity = block.rapidity;
+    const std::vector<double> &cosh_y = block.cosh_y;
+    const std::vector<double> &sinh_y = block.sinh_y;
+    const std::vector<double> &mt_array = block.mt_array;
+    const std::vector<double> &y_row_min = block.y_row_min;
+    const std::vector<double> &y_row_max = block.y_row_max;
+    const int n_yp = ietamax*iptmax;
+
     // main loop begins ...
     // store E dN/d^3p as function of phi,
     // pt and eta (pseudorapidity) in sumPtPhi:
+    const int n_spectra = n_species*n_yp*iphimax;
+    const int n_parts = std::max(1, std::min(kNumSurfaceParts, NCells));
+    std::vector<double> part_sum(static_cast<size_t>(n_parts)*n_spectra,
+                                 0.0);
+    // adds the integrand of the surface cell icell to the part sums
+    auto add_cell = [&](const int icell, FreezeCellInfo &cell,
+                        double *sum_part) {
+        get_freeze_cell_info(DATA, icell, cell);
+        for (int is = 0; is < n_species; is++) {
+            const int j = species[is].j;
+            CooperFryeSpecies cf_species;
+            set_Cooper_Frye_species(DATA, species[is], cell.muB,
+                                    cf_species);
+            for (int ieta = 0; ieta < ietamax; ieta++) {
+                // the eta rows out of reach of the cell
+                const int irow = is*ietamax + ieta;
+                if (y_row_min[irow] - cell.eta_s >= y_minus_eta_cut
+                    || cell.eta_s - y_row_max[irow] >= y_minus_eta_cut) {
+                    continue;
+                }
+                for (int ipt = 0; ipt < iptmax; ipt++) {
+                    const int idx = is*n_yp + ieta*iptmax + ipt;
+                    double y = rapidity[idx];
+                    if (fabs(y - cell.eta_s) >= y_minus_eta_cut) continue;
+                    double pt = particleList[j].pt[ipt];
+                    double mt = mt_array[is*iptmax + ipt];
+                    double ptau = mt*(cosh_y[idx]*cell.cosh_eta_s
+                                      - sinh_y[idx]*cell.sinh_eta_s);
+                    double peta = mt*(sinh_y[idx]*cell.cosh_eta_s
+                                      - cosh_y[idx]*cell.sinh_eta_s);
+                    double *sum_phi = sum_part + idx*iphimax;
+                    if (CooperFrye::add_phi_integrand(
+                            cell, bulk_deltaf_kind,
+                            DATA->deltaf_14moments, cf_species, pt, ptau,
+                            peta, iphimax, cos_phi.data(), sin_phi.data(),
+                            1.0, sum_phi)) {
+                        report_Cooper_Frye_row(cell, cf_species, pt,
+                                               ptau, peta, cos_phi,
+                                               sin_phi);
+                    }
+                }
+            }
+        }
+    };
 
     #pragma omp parallel
     {
-        // need to perform reduction on a 2d array
-        // first create a private copy for every omp_thread
-        // use critical clause at the end to add the private 2d arrays
-        // together from individual omp_thread
-        double temp_sum_private[iptmax][iphimax];
-        for (int ii = 0; ii < iptmax;  ii++) 
-        for (int jj = 0; jj < iphimax; jj++) {
-            temp_sum_private[ii][jj] = 0.0;
-        }
-
-        #pragma omp for
-        for (int icell = 0; icell < NCells; icell++) {
-            double tau = surface[icell].x[0];
-
-            double T = surface[icell].T_f*hbarc;  // GeV
-            double muB = 0.0;
-            double mu = baryon*muB;  // GeV
-            if (DATA->whichEOS>=3 && DATA->whichEOS < 10) {
-                // for PCE use the previously computed mu
-                // at the freeze-out energy density
-                mu += mu_PCE;  // GeV
+        FreezeCellInfo cell;
+
+        #pragma omp for schedule(dynamic)
+        for (int ipart = 0; ipart < n_parts; ipart++) {
+            double *sum_part = (
+                    &part_sum[static_cast<size_t>(ipart)*n_spectra]);
+            int64_t icell_begin, icell_end;
+            DeterministicSum::get_part_range(NCells, n_parts, ipart,
+                                             icell_begin, icell_end);
+            for (int64_t icell = icell_begin; icell < icell_end;
+                    icell++) {
+                add_cell(static_cast<int>(icell), cell, sum_part);
             }
+        }
+    }
 
-            double sigma_mu[4];
-            double u_flow[4];
-            for (int ii = 0; ii < 4; ii++) {
-                sigma_mu[ii] = surface[icell].s[ii];
-                u_flow[ii] = surface[icell].u[ii];
-            }
+    // sum the part arrays
+    DeterministicSum::tree_sum(part_sum.data(), n_parts, n_spectra);
+    std::vector<double> &spectra_sum = block.sum;
+    #pragma omp parallel for schedule(static)
+    for (int idx = 0; idx < n_spectra; idx++) {
+        spectra_sum[idx] += part_sum[idx];
+    }
+}
 
-            double W00 = 0.0;
-            double W01 = 0.0;
-            double W02 = 0.0;
-            double W03 = 0.0;
-            double W11 = 0.0;
-            double W12 = 0.0;
-            double W13 = 0.0;
-            double W22 = 0.0;
-            double W23 = 0.0;
-            double W33 = 0.0;
-            int flag_shear_deltaf = 0;
-            if (DATA->turn_on_shear == 1 && DATA->include_deltaf == 1) {
-                flag_shear_deltaf = 1;
-                W00 = surface[icell].W[0][0];
-                W01 = surface[icell].W[0][1];
-                W02 = surface[icell].W[0][2];
-                W03 = surface[icell].W[0][3];
-                W11 = surface[icell].W[1][1];
-                W12 = surface[icell].W[1][2];
-                W13 = surface[icell].W[1][3];
-                W22 = surface[icell].W[2][2];
-                W23 = surface[icell].W[2][3];
-                W33 = surface[icell].W[3][3];
-            }
 
-            double Pi_bulk = 0.0;
-            int flag_bulk_deltaf = 0;
-            if (DATA->turn_on_bulk == 1 && DATA->include_deltaf_bulk == 1) {
-                flag_bulk_deltaf = 1;
-                Pi_bulk = surface[icell].pi_b;
-                getbulkvisCoefficients(T, bulk_deltaf_coeffs);
-            }
+//! this function compute thermal paritcle spectra assuming a
+//! boost-invarianat hyper-surface from hydro simulations, for the block of
+//! species in one pass over the surface
+void Freeze::ComputeParticleSpectrum_pseudo_boost_invariant(
+                        InitData *DATA, ThermalSpectraBlock &block) {
+    const int iptmax = DATA->pt_steps + 1;
+    const int iphimax = DATA->phi_steps;
 
-            double eps_plus_P_over_T = surface[icell].eps_plus_p_over_T_FO;
-            double prefactor_shear = 1./(2.*eps_plus_P_over_T*T*T*T)*hbarc; 
-                                                                // fm^4/GeV^2
+    const std::vector<ThermalSpecies> &species = block.species;
+    const int n_species = static_cast<int>(species.size());
+    const std::vector<double> &cos_phi = block.cos_phi;
+    const std::vector<double> &sin_phi = block.sin_phi;
+    const std::vector<double> &mt_array = block.mt_array;
 
+    // main loop begins ...
+    // store E dN/d^3p as function of phi and pt of [species][pT][phi]
+    const int n_spectra = n_species*iptmax*iphimax;
+    const int n_parts = std::max(1, std::min(kNumSurfaceParts, NCells));
+    std::vector<double> part_sum(static_cast<size_t>(n_parts)*n_spectra,
+                                 0.0);
+    // adds the integrand of the surface cell icell to the part sums
+    auto add_cell = [&](const int icell, FreezeCellInfo &cell,
+                        double *sum_part) {
+        get_freeze_cell_info(DATA, icell, cell);
+        // the boost-invariant spectra are at mu_B = 0,
+        // without the delta f of the diffusion current
+        cell.muB = 0.0;
+        cell.flag_qmu_deltaf = 0;
+        for (int is = 0; is < n_species; is++) {
+            const int j = species[is].j;
+            CooperFryeSpecies cf_species;
+            set_Cooper_Frye_species(DATA, species[is], cell.muB,
+                                    cf_species);
             for (int ieta_s = 0; ieta_s < n_eta_s_integral; ieta_s++) {
                 double cosh_eta_s = cosh_eta_s_inte[ieta_s];
                 double sinh_eta_s = sinh_eta_s_inte[ieta_s];
-                for (int ipt=0; ipt<iptmax; ipt++) {
-                    double pt = pt_array[ipt];
-                    double mt = sqrt(m*m + pt*pt);     // all in GeV
+                double weight = eta_s_inte_weight[ieta_s];
+                for (int ipt = 0; ipt < iptmax; ipt++) {
+                    double pt = particleList[j].pt[ipt];
+                    double mt = mt_array[is*iptmax + ipt];
                     double ptau = mt*cosh_eta_s;
                     // sinh(y - eta_s) = - sinh(eta_s)
                     double peta = - mt*sinh_eta_s;
-                    for (int iphi = 0; iphi < iphimax; iphi++) {
-                        double px = pt*cos_phi[iphi];
-                        double py = pt*sin_phi[iphi];
-                  
-                        double sum;
-                        // compute p^mu*dSigma_mu [fm^3*GeV]
-                        double pdSigma = tau*(ptau*sigma_mu[0]
-                                              + px*sigma_mu[1]
-                                              + py*sigma_mu[2]
-                                              + peta*sigma_mu[3]/tau);
-                        double E = (ptau*u_flow[0] - px*u_flow[1]
-                                    - py*u_flow[2]- peta*u_flow[3]);
-                        // this is the equilibrium f, f_0:
-                        double f = 1./(exp(1./T*(E - mu)) + sign);
-                    
-                        // now comes the delta_f: check if still correct
-                        // at finite mu_b 
-                        // we assume here the same C=eta/s for
-                        // all particle species because
-                        // it is the simplest way to do it.
-                        // also we assume Xi(p)=p^2, the quadratic Ansatz
-                        double Wfactor = 0.0;
-                        double delta_f_shear = 0.0;
-                        if (flag_shear_deltaf == 1) {
-                            Wfactor = (ptau*W00*ptau - 2.*ptau*W01*px
-                                       - 2.*ptau*W02*py
-                                       - 2.*ptau*W03*peta
-                                       + px*W11*px + 2.*px*W12*py
-                                       + 2.*px*W13*peta
-                                       + py*W22*py + 2.*py*W23*peta
-                                       + peta*W33*peta);
-                            delta_f_shear = (f*(1. - sign*f)
-                                             *prefactor_shear*Wfactor);
-                            if (DATA->include_deltaf==2) {
-                                // if delta f is supposed to be proportional
-                                // to p^(2-alpha):
-                                delta_f_shear = (delta_f_shear
-                                                 *pow((T/E), 1.*alpha)
-                                                 *120./(tgamma(6.-alpha))); 
-                            }
-                        }
-                        double delta_f_bulk = 0.0;
-                        if (flag_bulk_deltaf == 1) {
-                            if (bulk_deltaf_kind == 0) {
-                                delta_f_bulk = (
-                                    - f*(1. - sign*f)*Pi_bulk
-                                    *(bulk_deltaf_coeffs[0]*m*m
-                                      + bulk_deltaf_coeffs[1]*E
-                                      + bulk_deltaf_coeffs[2]*E*E));
-                            } else if (bulk_deltaf_kind == 1) {
-                                double E_over_T = E/T;
-                                double mass_over_T = m/T;
-                                delta_f_bulk = (
-                                    - f*(1. - sign*f)/E_over_T
-                                    *bulk_deltaf_coeffs[0]
-                                    *(mass_over_T*mass_over_T/3.
-                                      - bulk_deltaf_coeffs[1]
-                                        *E_over_T*E_over_T)
-                                    *Pi_bulk);
-                            } else if (bulk_deltaf_kind == 2) {
-                                double E_over_T = E/T;
-                                delta_f_bulk = (
-                                    - f*(1. - sign*f)
-                                    *(-bulk_deltaf_coeffs[0]
-                                      + bulk_deltaf_coeffs[1]*E_over_T)
-                                    *Pi_bulk);
-                            } else if (bulk_deltaf_kind == 3) {
-                                double E_over_T = E/T;
-                                delta_f_bulk = (
-                                    - f*(1.-sign*f)/sqrt(E_over_T)
-                                        *(- bulk_deltaf_coeffs[0]
-                                          + bulk_deltaf_coeffs[1]*E_over_T)
-                                        *Pi_bulk);
-                            } else if (bulk_deltaf_kind == 4) {
-                                double E_over_T = E/T;
-                                delta_f_bulk = (
-                                    - f*(1.-sign*f)
-                                        *(bulk_deltaf_coeffs[0]
-                                          - bulk_deltaf_coeffs[1]/E_over_T)
-                                        *Pi_bulk);
-                            }
-                        }
-                        double total_deltaf = delta_f_shear + delta_f_bulk;
-                        double max_ratio = 1.0;
-                        if (fabs(total_deltaf)/f > max_ratio) {
-                            total_deltaf *= f/fabs(total_deltaf);
-                        }
-                        sum = (f + total_deltaf)*pdSigma;
-                    
-                        if (sum > 10000) {
-                            music_message << "sum>10000 in summation. sum = "
-                                 << sum 
-                                 << ", f=" << f << ", deltaf=" << delta_f_shear
-                                 << ", pdSigma=" << pdSigma << ", T=" << T 
-                                 << ", E=" << E << ", mu=" << mu;
-                            music_message.flush("warning");
-                        }
-                        temp_sum_private[ipt][iphi] += (
-                                                sum*eta_s_inte_weight[ieta_s]);
+                    double *sum_phi = (
+                            sum_part + (is*iptmax + ipt)*iphimax);
+                    if (CooperFrye::add_phi_integrand(
+                            cell, bulk_deltaf_kind,
+                            DATA->deltaf_14moments, cf_species, pt, ptau,
+                            peta, iphimax, cos_phi.data(), sin_phi.data(),
+                            weight, sum_phi)) {
+                        report_Cooper_Frye_row(cell, cf_species, pt,
+                                               ptau, peta, cos_phi,
+                                               sin_phi);
                     }
                 }
             }
         }
-        #pragma omp critical
-        {
-            for (int ipt = 0; ipt < iptmax; ipt++) {
-                for (int iphi = 0; iphi < iphimax; iphi++) {
-                    temp_sum[ipt][iphi] += temp_sum_private[ipt][iphi];
-                }
-            }
-        }
-    }
-    double prefactor = deg/(pow(2.*M_PI, 3.)*pow(hbarc, 3.));
-
-    for (int ieta = 0; ieta < ietamax; ieta++) {
-        double eta = -etamax + ieta*deltaeta;
-        // Use this variable to store pseudorapidity instead of rapidity
-        // May cause confusion in the future,
-        // but easier to to share code for both options:
-        // calculating on a fixed grid in rapidity or pseudorapidity
-        particleList[j].y[ieta] = eta;  // store particle pseudo-rapidity
+    };
 
-        // store the final results
-        for (int ipt = 0; ipt < iptmax; ipt++) {
-            for(int iphi = 0; iphi < iphimax; iphi++) {
-                double sum = temp_sum[ipt][iphi]*prefactor;
-                particleList[j].dNdydptdphi[ieta][ipt][iphi] = sum;
-                fprintf(s_file, "%e ", sum);
+    // the parts as in ComputeParticleSpectrum_pseudo_improved
+    #pragma omp parallel
+    {
+        FreezeCellInfo cell;
+
+        #pragma omp for schedule(dynamic)
+        for (int ipart = 0; ipart < n_parts; ipart++) {
+            double *sum_part = (
+                    &part_sum[static_cast<size_t>(ipart)*n_spectra]);
+            int64_t icell_begin, icell_end;
+            DeterministicSum::get_part_range(NCells, n_parts, ipart,
+                                             icell_begin, icell_end);
+            for (int64_t icell = icell_begin; icell < icell_end;
+                    icell++) {
+                add_cell(static_cast<int>(icell), cell, sum_part);
             }
-            fprintf(s_file, "\n");
         }
     }
-    // clean up
-    for (int ipt = 0; ipt < iptmax; ipt++) {
-        delete[] temp_sum[ipt];
+
+    // sum the part arrays
+    DeterministicSum::tree_sum(part_sum.data(), n_parts, n_spectra);
+    std::vector<double> &spectra_sum = block.sum;
+    #pragma omp parallel for schedule(static)
+    for (int idx = 0; idx < n_spectra; idx++) {
+        spectra_sum[idx] += part_sum[idx];
     }
-    delete[] temp_sum;
-    
-    if (DATA_ptr->turn_on_bulk == 1 && DATA_ptr->include_deltaf_bulk == 1) {
-        delete [] bulk_deltaf_coeffs;
+}
+
+
+void Freeze::add_surface_to_block(InitData *DATA,
+                                  ThermalSpectraBlock &block) {
+    if (boost_invariant) {
+        ComputeParticleSpectrum_pseudo_boost_invariant(DATA, block);
+    } else {
+        ComputeParticleSpectrum_pseudo_improved(DATA, block);
     }
+}
 
-    // clean up
-    delete[] cos_phi;
-    delete[] sin_phi;
-    delete[] pt_array;
-    fclose(s_file);
-    fclose(d_file);
+
+//! this function stores the final results of the sums of block, the
+//! boost-invariant spectra are the same at all pseudo-rapidities
+void Freeze::store_thermal_spectra_block(InitData *DATA,
+                                         const ThermalSpectraBlock &block) {
+    const int ietamax = DATA->pseudo_steps + 1;
+    const int iptmax = DATA->pt_steps + 1;
+    const int iphimax = DATA->phi_steps;
+    const int n_species = static_cast<int>(block.species.size());
+    for (int is = 0; is < n_species; is++) {
+        const int j = block.species[is].j;
+        double prefactor = (block.species[is].deg
+                            /(pow(2.*M_PI, 3.)*pow(hbarc, 3.)));
+        for (int ieta = 0; ieta < ietamax; ieta++)
+        for (int ipt = 0; ipt < iptmax; ipt++)
+        for (int iphi = 0; iphi < iphimax; iphi++) {
+            const int idx = (
+                boost_invariant ? (is*iptmax + ipt)*iphimax + iphi
+                                : ((is*ietamax + ieta)*iptmax + ipt)*iphimax
+                                  + iphi);
+            // in GeV^(-2)
+            particleList[j].dNdydptdphi[ieta][ipt][iphi] = (
+                                            block.sum[idx]*prefactor);
+        }
+    }
 }
 
 void Freeze::OutputFullParticleSpectrum_pseudo(InitData *DATA, int number,
@@ -924,111 +689,86 @@ void Freeze::OutputFullParticleSpectrum_pseudo(InitData *DATA, int number,
 //! this function computes particle thermal spectra
 void Freeze::compute_thermal_spectra(int particleSpectrumNumber,
                                      InitData* DATA) {
-    double mass_tol = 1e-3;
-    double mu_tol = 1e-3;
-
-    // clean up
-    system_status_ = system("rm yptphiSpectra.dat yptphiSpectra?.dat "
-           "yptphiSpectra??.dat particleInformation.dat 2> /dev/null");
+    // number of species computed in one pass over the surface
+    const int n_species_per_block = 8;
 
+    remove_thermal_spectra_files();
     ReadFreezeOutSurface(DATA);  // read freeze out surface
-    if (particleSpectrumNumber == 0) {
-        // do all particles up to particleMax
-        music_message.info("Doing all particles. May take a while ...");
-
-        int particleMax_copy = particleMax;
-        for (int i = 1; i < particleMax_copy; i++) {
-            int number = particleList[i].number;
-            int computespectrum = 1;
-
-            // Only calculate particles with unique mass
-            for(int part = 1; part < i; part++) {
-                double mass_diff = fabs(particleList[i].mass
-                                        - particleList[part].mass);
-                double mu_diff = fabs(particleList[i].muAtFreezeOut
-                                      - particleList[part].muAtFreezeOut);
-                if (mass_diff < mass_tol && mu_diff < mu_tol
-                    && (DATA->turn_on_rhob == 0
-                        || particleList[i].baryon == particleList[part].baryon)
-                   ) {
-                    // here we assume zero mu_B
-                    computespectrum = 0;
-
-                    // If there is more than one processor,
-                    // this processor doesn't have all pseudorapidity
-                    // values in memory
-                    music_message << "Copying " << i << ":"
-                                  << particleList[i].name << " ("
-                                  << particleList[i].number << ") from "
-                                  << particleList[part].name;
-                    music_message.flush("info");
-
-                    int iphimax = DATA->phi_steps;
-                    int iptmax = DATA->pt_steps + 1;
-                    int ietamax = DATA->pseudo_steps + 1;
-                    double ptmax = DATA->max_pt;
-                    double ptmin = DATA->min_pt;
-                    double etamax = DATA->max_pseudorapidity;
-                    // If the particles have a different degeneracy,
-                    // we have to multiply by the ratio when copying.
-                    double degen_ratio = (
-                        static_cast<double>(particleList[i].degeneracy)
-                        /static_cast<double>(particleList[part].degeneracy)
-                    );
-
-                    // open files to write
-                    FILE *d_file;
-                    const char* d_name = "particleInformation.dat";
-                    d_file = fopen(d_name, "a");
-                    FILE *s_file;
-                    const char* s_name = "yptphiSpectra.dat";
-                    s_file = fopen(s_name, "a");
-                    particleList[i].ymax = particleList[part].ymax; 
-                    particleList[i].deltaY = particleList[part].deltaY;
-                    particleList[i].ny = particleList[part].ny;
-                    particleList[i].npt = particleList[part].npt;
-                    particleList[i].nphi = particleList[part].nphi;
-                    fprintf(d_file, "%d %e %d %e %e %d %d \n",
-                            number, etamax, ietamax, ptmin, ptmax,
-                            iptmax, iphimax);
-                    for (int ieta = 0; ieta < ietamax; ieta++) {
-                        for (int ipt = 0; ipt < iptmax; ipt++) {
-                            particleList[i].pt[ipt] =
-                                            particleList[part].pt[ipt];
-                            particleList[i].y[ieta] =
-                                            particleList[part].y[ieta];  
-                            for (int iphi = 0; iphi < iphimax; iphi++) {
-                                particleList[i].dNdydptdphi[ieta][ipt][iphi] =
-                                    (degen_ratio
-                                     *particleList[part].dNdydptdphi[ieta][ipt][iphi]);
-                                fprintf(s_file, "%e ",
-                                        particleList[i].dNdydptdphi[ieta][ipt][iphi]);
-                            }
-                            fprintf(s_file, "\n");
-                        }
-                    }
-                    fclose(s_file);
-                    fclose(d_file);
-                    part = particleMax_copy; // break out of particle loop
-                }  // if particles have same mass
-            }  // loop over particles that have already been calculated
-
-            if (computespectrum) {
-                if (boost_invariant) {
-                    ComputeParticleSpectrum_pseudo_boost_invariant(
-                                                                DATA, number);
-                } else {
-                    ComputeParticleSpectrum_pseudo_improved(DATA, number);
-                }
+    std::vector<int> copy_from;
+    std::vector<int> numbers_to_compute;
+    select_thermal_species(particleSpectrumNumber, DATA, copy_from,
+                           numbers_to_compute);
+    if (DATA->surface_coarsening_factor > 0) {
+        // the species of the first block are the reference of the check
+        const unsigned int n_reference = std::min(
+                static_cast<unsigned int>(n_species_per_block),
+                static_cast<unsigned int>(numbers_to_compute.size()));
+        std::vector<int> reference_numbers(
+                numbers_to_compute.begin(),
+                numbers_to_compute.begin() + n_reference);
+        coarsen_surface(DATA, reference_numbers);
+    }
+    for (unsigned int ifirst = 0; ifirst < numbers_to_compute.size();
+         ifirst += n_species_per_block) {
+        unsigned int ilast = std::min(
+                ifirst + n_species_per_block,
+                static_cast<unsigned int>(numbers_to_compute.size()));
+        std::vector<int> numbers(numbers_to_compute.begin() + ifirst,
+                                 numbers_to_compute.begin() + ilast);
+        ThermalSpectraBlock block;
+        set_thermal_spectra_block(DATA, numbers, block);
+        add_surface_to_block(DATA, block);
+        store_thermal_spectra_block(DATA, block);
+    }
+    output_thermal_spectra(DATA, particleSpectrumNumber, copy_from);
+}
 
-                system_status_ = system(
-                        "cat yptphiSpectra?.dat >> yptphiSpectra.dat");
-                system_status_ = system(
-                        "cat yptphiSpectra??.dat >> yptphiSpectra.dat "
-                        "2> /dev/null");
-            }
+
+void Freeze::sample_hadrons(InitData *DATA) {
+    std::vector<SamplerSpecies> species;
+    for (int j = 1; j < particleMax; j++) {
+        if (DATA->particleSpectrumNumber != 0
+                && j != DATA->particleSpectrumNumber) {
+            continue;
         }
-    } else {
+        SamplerSpecies sp;
+        sp.number = particleList[j].number;
+        sp.m = particleList[j].mass;
+        sp.deg = particleList[j].degeneracy;
+        sp.baryon = particleList[j].baryon;
+        sp.charge = particleList[j].charge;
+        sp.sign = (sp.baryon == 0) ? -1. : 1.;
+        sp.mu_PCE = 0.;
+        if (DATA->whichEOS>=3 && DATA->whichEOS < 10) {
+            sp.mu_PCE = particleList[j].muAtFreezeOut;  // GeV
+        }
+        species.push_back(sp);
+    }
+    // the boost-invariant surface is spread over the rapidity range of
+    // the spectra
+    const double eta_s_max = boost_invariant ? DATA->max_pseudorapidity : 0.;
+    HadronSampler sampler(
+        species, NCells,
+        [&](const int icell, FreezeCellInfo &cell, double &x, double &y) {
+            get_freeze_cell_info(DATA, icell, cell);
+            x = surface.get(SurfaceField::x, icell);
+            y = surface.get(SurfaceField::y, icell);
+        }, bulk_deltaf_kind, DATA->deltaf_14moments, eta_s_max,
+        static_cast<uint64_t>(DATA->hadron_sampler_seed));
+    sampler.write_events("sampled_particles.dat",
+                         DATA->number_of_sampled_events);
+}
+
+
+void Freeze::select_thermal_species(int particleSpectrumNumber,
+                                    InitData *DATA,
+                                    std::vector<int> &copy_from,
+                                    std::vector<int> &numbers_to_compute) {
+    double mass_tol = 1e-3;
+    double mu_tol = 1e-3;
+    copy_from.assign(particleMax, 0);
+    numbers_to_compute.clear();
+    if (particleSpectrumNumber != 0) {
         // compute single one particle with pid = particleSpectrumNumber
         if (particleSpectrumNumber >= particleMax) {
             music_message << "No particle has the number "
@@ -1036,21 +776,208 @@ void Freeze::compute_thermal_spectra(int particleSpectrumNumber,
             music_message.flush("error");
             exit(1);
         }
-        int number = particleList[particleSpectrumNumber].number;
+        numbers_to_compute.push_back(
+                            particleList[particleSpectrumNumber].number);
         music_message.info("COMPUTE");
-        if (boost_invariant) {
-            ComputeParticleSpectrum_pseudo_boost_invariant(DATA, number);
-        } else {
-            ComputeParticleSpectrum_pseudo_improved(DATA, number);
+        return;
+    }
+
+    // do all particles up to particleMax
+    music_message.info("Doing all particles. May take a while ...");
+    // Only calculate particles with unique mass
+    for (int i = 1; i < particleMax; i++) {
+        for (int part = 1; part < i; part++) {
+            double mass_diff = fabs(particleList[i].mass
+                                    - particleList[part].mass);
+            double mu_diff = fabs(particleList[i].muAtFreezeOut
+                                  - particleList[part].muAtFreezeOut);
+            if (mass_diff < mass_tol && mu_diff < mu_tol
+                && (DATA->turn_on_rhob == 0
+                    || particleList[i].baryon == particleList[part].baryon)
+               ) {
+                // here we assume zero mu_B
+                copy_from[i] = part;
+                break;
+            }
+        }
+        if (copy_from[i] == 0) {
+            numbers_to_compute.push_back(particleList[i].number);
+        }
+    }
+}
+
+
+void Freeze::output_thermal_spectra(InitData *DATA,
+                                    int particleSpectrumNumber,
+                                    const std::vector<int> &copy_from) {
+    if (particleSpectrumNumber != 0) {
+        output_thermal_spectrum(DATA, particleSpectrumNumber);
+        return;
+    }
+    // in mode 1 the spectra of all the species stay in particleList for
+    // the resonance decays and the observables
+    const bool write_files = (DATA->output_spectra_files == 1
+                              || DATA->mode != 1);
+
+    // write out the spectra in the order of the particle list
+    for (int i = 1; i < particleMax; i++) {
+        const int part = copy_from[i];
+        if (part == 0) {
+            if (write_files) output_thermal_spectrum(DATA, i);
+            continue;
+        }
+        music_message << "Copying " << i << ":"
+                      << particleList[i].name << " ("
+                      << particleList[i].number << ") from "
+                      << particleList[part].name;
+        music_message.flush("info");
+
+        int iphimax = DATA->phi_steps;
+        int iptmax = DATA->pt_steps + 1;
+        int ietamax = DATA->pseudo_steps + 1;
+        // If the particles have a different degeneracy,
+        // we have to multiply by the ratio when copying.
+        double degen_ratio = (
+            static_cast<double>(particleList[i].degeneracy)
+            /static_cast<double>(particleList[part].degeneracy)
+        );
+        particleList[i].ymax = particleList[part].ymax;
+        particleList[i].deltaY = particleList[part].deltaY;
+        particleList[i].ny = particleList[part].ny;
+        particleList[i].npt = particleList[part].npt;
+        particleList[i].nphi = particleList[part].nphi;
+        particleList[i].dNdydptdphi.resize(ietamax, iptmax, iphimax);
+        for (int ieta = 0; ieta < ietamax; ieta++) {
+            particleList[i].y[ieta] = particleList[part].y[ieta];
+        }
+        for (int ipt = 0; ipt < iptmax; ipt++) {
+            particleList[i].pt[ipt] = particleList[part].pt[ipt];
+        }
+        for (int ieta = 0; ieta < ietamax; ieta++)
+        for (int ipt = 0; ipt < iptmax; ipt++)
+        for (int iphi = 0; iphi < iphimax; iphi++) {
+            particleList[i].dNdydptdphi[ieta][ipt][iphi] = (
+                degen_ratio
+                *particleList[part].dNdydptdphi[ieta][ipt][iphi]);
         }
-        system_status_ = system("cat yptphiSpectra?.dat >> yptphiSpectra.dat");
-        system_status_ = system("cat yptphiSpectra??.dat >> yptphiSpectra.dat "
-                                "2> /dev/null");
+        if (write_files) output_thermal_spectrum(DATA, i);
     }
+    set_spectra_in_memory(DATA);
+    thermal_spectra_in_memory_ = true;
 }
 
+
+void Freeze::set_spectra_in_memory(InitData *DATA) {
+    const int ietamax = DATA->pseudo_steps + 1;
+    const int iptmax = DATA->pt_steps + 1;
+    const int iphimax = DATA->phi_steps;
+    for (int ip = 1; ip < particleMax; ip++) {
+        particleList[ip].phimin = 0;
+        particleList[ip].phimax = 2*M_PI;
+        particleList[ip].slope = 1;
+        for (int ieta = 0; ieta < ietamax; ieta++)
+        for (int ipt = 0; ipt < iptmax; ipt++)
+        for (int iphi = 0; iphi < iphimax; iphi++) {
+            if (particleList[ip].dNdydptdphi[ieta][ipt][iphi] < 0.) {
+                particleList[ip].dNdydptdphi[ieta][ipt][iphi] = 0;
+            }
+        }
+    }
+
+    // phiArray for use in Edndp3 interpolation function
+    // during resonance decay calculation
+    if (phiArray == NULL) {
+        phiArray = new double[iphimax];
+        for (int iphi = 0; iphi < iphimax; iphi++) {
+            phiArray[iphi] = iphi*2*M_PI/iphimax;
+        }
+    }
+}
+
+
+void Freeze::remove_thermal_spectra_files() {
+    remove("yptphiSpectra.dat");
+    remove("particleInformation.dat");
+}
+
+
+void Freeze::begin_thermal_spectra_stream(int particleSpectrumNumber,
+                                          InitData *DATA, const EOS *eos) {
+    // number of species computed in one pass over a chunk
+    const int n_species_per_block = 8;
+
+    ReadParticleData(DATA, eos);
+    remove_thermal_spectra_files();
+    music_message.info("streaming the freeze-out surface of the hydro");
+
+    std::vector<int> numbers_to_compute;
+    select_thermal_species(particleSpectrumNumber, DATA, stream_copy_from_,
+                           numbers_to_compute);
+    stream_particleSpectrumNumber_ = particleSpectrumNumber;
+    stream_blocks_.clear();
+    for (unsigned int ifirst = 0; ifirst < numbers_to_compute.size();
+         ifirst += n_species_per_block) {
+        unsigned int ilast = std::min(
+                ifirst + n_species_per_block,
+                static_cast<unsigned int>(numbers_to_compute.size()));
+        std::vector<int> numbers(numbers_to_compute.begin() + ifirst,
+                                 numbers_to_compute.begin() + ilast);
+        stream_blocks_.emplace_back();
+        set_thermal_spectra_block(DATA, numbers, stream_blocks_.back());
+    }
+    stream_n_cells_ = 0;
+    stream_n_coarse_cells_ = 0;
+}
+
+
+void Freeze::add_surface_chunk(InitData *DATA, const float *rows,
+                               const int64_t n_elements,
+                               const int n_fields) {
+    NCells = static_cast<int>(n_elements);
+    surface.resize(NCells);
+    for (int i = 0; i < NCells; i++) {
+        set_surface_element(i, rows + static_cast<size_t>(i)*n_fields);
+    }
+    if (DATA->surface_coarsening_factor > 0) {
+        // the elements are merged within the chunk
+        CompactSurface coarse;
+        SurfaceCoarsening(*DATA, boost_invariant).coarsen(surface, coarse);
+        surface = std::move(coarse);
+        NCells = surface.size();
+    }
+    for (auto &block : stream_blocks_) {
+        add_surface_to_block(DATA, block);
+    }
+    stream_n_cells_ += n_elements;
+    stream_n_coarse_cells_ += NCells;
+}
+
+
+void Freeze::finish_thermal_spectra_stream(InitData *DATA) {
+    music_message << "NCells = " << stream_n_cells_
+                  << " streamed from the hydro";
+    if (DATA->surface_coarsening_factor > 0) {
+        music_message << ", " << stream_n_coarse_cells_
+                      << " after the surface coarsening";
+    }
+    music_message.flush("info");
+    for (const auto &block : stream_blocks_) {
+        store_thermal_spectra_block(DATA, block);
+    }
+    output_thermal_spectra(DATA, stream_particleSpectrumNumber_,
+                           stream_copy_from_);
+    stream_blocks_.clear();
+    surface.clear();
+    NCells = 0;
+    thermal_spectra_streamed_ = true;
+}
+
+
 void Freeze::perform_resonance_decays(InitData *DATA) {
-    ReadSpectra_pseudo(DATA, 0, 1);
+    const bool spectra_in_memory = thermal_spectra_in_memory_;
+    if (!spectra_in_memory) {
+        ReadSpectra_pseudo(DATA, 0, 1);
+    }
     int bound = 211; //number of lightest particle to calculate. 
     music_message << "particleMax = " << particleMax;
     music_message.flush("info");
@@ -1061,9 +988,16 @@ void Freeze::perform_resonance_decays(InitData *DATA) {
     music_message.flush("info");
 
     cal_reso_decays(particleMax, decayMax, bound);
+    // particleList now holds the spectra after the decays
+    thermal_spectra_in_memory_ = false;
 
-    system_status_ = system(
-            "rm FyptphiSpectra.dat FparticleInformation.dat 2> /dev/null");
+    remove("FyptphiSpectra.dat");
+    remove("FparticleInformation.dat");
+    if (spectra_in_memory) {
+        set_spectra_in_memory(DATA);
+        final_spectra_in_memory_ = true;
+        if (DATA->output_spectra_files == 0 && DATA->mode == 1) return;
+    }
     for (int i = 1; i < particleMax; i++) {
         int number = particleList[i].number;
         int b = particleList[i].baryon;
@@ -1079,7 +1013,10 @@ void Freeze::compute_thermal_particle_spectra_and_vn(InitData* DATA) {
         music_message << "Can not create folder ./outputs ...";
         music_message.flush("warning");
     }
-    ReadSpectra_pseudo(DATA, 0, 1);
+    if (!thermal_spectra_in_memory_) {
+        ReadSpectra_pseudo(DATA, 0, 1);
+    }
+    clear_spectrum_moments();
 
     //Make sure the pion, kaon and proton spectra are available
     if (particleMax < 21) {
@@ -1110,7 +1047,11 @@ void Freeze::compute_final_particle_spectra_and_vn(InitData* DATA) {
         music_message << "Can not create folder ./outputs ...";
         music_message.flush("warning");
     }
-    ReadSpectra_pseudo(DATA, 1, 1);  // read in particle spectra information
+    if (!final_spectra_in_memory_) {
+        // read in particle spectra information
+        ReadSpectra_pseudo(DATA, 1, 1);
+    }
+    clear_spectrum_moments();
     
     if (DATA->NumberOfParticlesToInclude > 200) {
         if ((DATA-> whichEOS != 7 && particleMax < 320)
@@ -1158,27 +1099,38 @@ void Freeze::compute_final_particle_spectra_and_vn(InitData* DATA) {
 
 
 void Freeze::CooperFrye_pseudo(int particleSpectrumNumber, int mode,
-                               InitData *DATA, EOS *eos) {
+                               InitData *DATA, const EOS *eos) {
     // this is a shell function for Cooper-Frye routine
     // -- spectra calculated on an equally-spaced grid
     // in phi and (pseudo)rapidity
-    ReadParticleData(DATA, eos); // read in data for Cooper-Frye
-    if (mode == 3 || mode == 1) {  // compute thermal spectra
-        compute_thermal_spectra(particleSpectrumNumber, DATA);
+    if (!thermal_spectra_streamed_) {
+        ReadParticleData(DATA, eos); // read in data for Cooper-Frye
+        if (mode == 3 || mode == 1) {  // compute thermal spectra
+            compute_thermal_spectra(particleSpectrumNumber, DATA);
+            if (DATA->number_of_sampled_events > 0) {
+                sample_hadrons(DATA);
+            }
+        }
+    } else if (DATA->number_of_sampled_events > 0) {
+        music_message.warning(
+            "The cells of the streamed surface are not kept, "
+            "no hadrons are sampled");
     }
-    if (mode==4 || mode==1) { //  do resonance decays
-        perform_resonance_decays(DATA);
-    } 
+    // the thermal observables come first, the decays replace the thermal
+    // spectra in particleList
     if (mode==13 || mode == 3 || mode == 1) {
         compute_thermal_particle_spectra_and_vn(DATA);
     } 
+    if (mode==4 || mode==1) { //  do resonance decays
+        perform_resonance_decays(DATA);
+    } 
     if (mode==14 || mode == 4 || mode == 1) {
         compute_final_particle_spectra_and_vn(DATA);
     } 
 
     // clean up
     delete[] partid;
-    free(particleList);
+    delete[] particleList;
 }
 
 
@@ -1213,12 +1165,33 @@ void Freeze::rapidity_integrated_flow(
         InitData *DATA, int number, int yflag, double minrap, double maxrap,
         double vn[nharmonics][2][etasize]) {
     int j = partid[MHALF+number];
-    int nphi = particleList[j].nphi;
     int npt = particleList[j].npt;
+    check_rapidity_range(DATA, j, yflag, minrap, maxrap);
+
+    const SpectrumMoments &moments = get_spectrum_moments(DATA, j, yflag);
+    double intvn[nharmonics][2];
+    // loop over pt
+    for (int ipt = 0; ipt < npt; ipt++) {
+        moments.get_rapidity_integrated(ipt, minrap, maxrap, intvn[0]);
+        for (int k = 0; k < 2; k++) {
+             vn[0][k][ipt] = intvn[0][k];
+        }
+        
+        for (int i = 1; i < nharmonics; i++) {
+             for(int k = 0; k < 2; k++) {
+                 vn[i][k][ipt] = intvn[i][k]/intvn[0][0];
+             }
+        }
+    }  // pt loop
+}
+
+
+void Freeze::check_rapidity_range(InitData *DATA, const int j,
+                                  const int yflag, const double minrap,
+                                  const double maxrap) {
     int neta = particleList[j].ny;
-    double intvn[ptsize][nharmonics][2] = {};
     double m = particleList[j].mass;
-   
+
     double testmin;
     if (yflag) {
         if (DATA->pseudofreeze == 1)
@@ -1265,97 +1238,13 @@ void Freeze::rapidity_integrated_flow(
         music_message.flush("error");
         exit(1);
     }
-   
-    // loop over pt
-    for (int ipt = 0; ipt < npt; ipt++) {
-        double pt = particleList[j].pt[ipt];
-     
-        // Integrate over phi using trapezoid rule
-        for (int iphi = 0; iphi < nphi; iphi++) {
-            double ylist[etasize] = {0};
-            double etalist[etasize] = {0};
-           
-            // Integrate over pseudorapidity using gsl
-            double dndpt[etasize] = {0};
-            for (int ieta = 0; ieta < neta; ieta++) {
-                double rap_local = particleList[j].y[ieta];
-
-                double eta_local, y_local;
-                if (DATA->pseudofreeze == 1) {
-                     eta_local = rap_local;
-                     etalist[ieta] = eta_local;
-                     y_local = Rap(eta_local, pt, m);   // get rapidity
-                     ylist[ieta] = y_local;   // get rapidity
-                } else {
-                     y_local = rap_local;
-                     ylist[ieta] = y_local;
-                     // get Pseudo-rapidity
-                     eta_local = PseudoRap(y_local, pt, m);
-                     etalist[ieta] = eta_local;   // get Pseudo-rapidity
-                }
-                if (yflag) {
-                     // dN/(dydpTdphi)
-                     dndpt[ieta] = (
-                             pt*particleList[j].dNdydptdphi[ieta][ipt][iphi]);
-                } else {
-                     // dN/(detadpTdphi)
-                     dndpt[ieta] = (
-                             pt*dydeta(eta_local, pt, m)
-                             *particleList[j].dNdydptdphi[ieta][ipt][iphi]);
-                }
-            }
-            gsl_interp_accel *acc = gsl_interp_accel_alloc ();
-            gsl_spline *spline = gsl_spline_alloc (gsl_interp_linear, neta);
-            if (yflag) {
-                // rapidity
-                gsl_spline_init (spline, ylist, dndpt , neta);
-            } else {
-                // pseudo-rapidity
-                gsl_spline_init (spline, etalist, dndpt , neta);
-            }
-   
-            double dNdp;
-            if (minrap < maxrap) {
-                // integrated from minrap to maxrap
-                dNdp = gsl_spline_eval_integ(spline, minrap, maxrap, acc);
-            } else {
-                // value at minrap = maxrap
-                dNdp = gsl_spline_eval(spline, maxrap, acc);
-            }
-           
-            double phi = iphi*2*M_PI/nphi;
-            for (int i = 0; i < nharmonics; i++) {
-                intvn[ipt][i][0] += cos(i*phi)*dNdp*2*M_PI/nphi;
-                intvn[ipt][i][1] += sin(i*phi)*dNdp*2*M_PI/nphi;
-            }
-            gsl_spline_free (spline);
-            gsl_interp_accel_free (acc);
-        }  // phi loop
-   
-        for (int k = 0; k < 2; k++) {
-             vn[0][k][ipt] = intvn[ipt][0][k];
-        }
-        
-        for (int i = 1; i < nharmonics; i++) {
-             for(int k = 0; k < 2; k++) {
-                 vn[i][k][ipt] = intvn[ipt][i][k]/intvn[ipt][0][0];
-             }
-        }
-    }  // pt loop
 }
 
 
-// calculates pt- and (pseudo)rapidity-integrated flow for a given range
-// in pt and eta or y
-// format is vn[n][i(real=0 or imaginary part=1)]
-// the rapidity integral is nested inside the phi integral
-// inside the pt integral
-void Freeze::pt_and_rapidity_integrated_flow(InitData *DATA, int number,
-        double minpt, double maxpt, int yflag,  double minrap, double maxrap,
-        double vn[nharmonics][2]) {
-    int j = partid[MHALF+number];
-    int npt = particleList[j].npt;  
-    
+void Freeze::check_pt_range(const int j, const double minpt,
+                            const double maxpt) {
+    int npt = particleList[j].npt;
+
     if (minpt < particleList[j].pt[0]) {
         music_message << "Error: called out of range pt in "
              << "pt_and_rapidity_integrated_flow, " 
@@ -1376,53 +1265,118 @@ void Freeze::pt_and_rapidity_integrated_flow(InitData *DATA, int number,
         music_message.flush("error");
         exit(1);
     }
-  
-    // do rapidity-integral first
-    double vnpt[nharmonics][2][etasize] = {};
-    rapidity_integrated_flow(DATA, number, yflag,  minrap, maxrap, vnpt);
-    double dndpt[ptsize];
+}
+
+
+//! the Fourier moments of the spectrum of j against the rapidity (yflag
+//! = 1) or the pseudo-rapidity (yflag = 0), in the steps of the former
+//! rapidity integral at each phi
+const SpectrumMoments &Freeze::get_spectrum_moments(InitData *DATA,
+                                                    const int j,
+                                                    const int yflag) {
+    std::vector<std::unique_ptr<SpectrumMoments>> &cache = (
+                                                spectrum_moments_[yflag]);
+    if (static_cast<int>(cache.size()) <= j) cache.resize(j + 1);
+    if (cache[j] != nullptr) return(*cache[j]);
+
+    int nphi = particleList[j].nphi;
+    int npt = particleList[j].npt;
+    int neta = particleList[j].ny;
+    double m = particleList[j].mass;
+    std::vector<double> pt_list(particleList[j].pt,
+                                particleList[j].pt + npt);
+    cache[j].reset(new SpectrumMoments(nharmonics, pt_list, neta));
+    double moments[nharmonics][2];
     for (int ipt = 0; ipt < npt; ipt++) {
-        dndpt[ipt] = vnpt[0][0][ipt];
-    }
-    for (int n = 0; n < nharmonics; n++) {
-        double vncos[ptsize] = {0};
-        double vnsin[ptsize] = {0};
-        for(int ipt = 0; ipt < npt; ipt++) {
-            double weight;
-            if (n != 0)
-                weight = dndpt[ipt];
-            else
-                weight = 1;
-            vncos[ipt] = vnpt[n][0][ipt]*weight;
-            vnsin[ipt] = vnpt[n][1][ipt]*weight;
+        double pt = particleList[j].pt[ipt];
+        for (int ieta = 0; ieta < neta; ieta++) {
+            double rap_local = particleList[j].y[ieta];
+            double eta_local, y_local;
+            if (DATA->pseudofreeze == 1) {
+                 eta_local = rap_local;
+                 y_local = Rap(eta_local, pt, m);   // get rapidity
+            } else {
+                 y_local = rap_local;
+                 // get Pseudo-rapidity
+                 eta_local = PseudoRap(y_local, pt, m);
+            }
+            // dN/(dydpTdphi) or dN/(detadpTdphi)
+            const double jacobian = yflag ? 1. : dydeta(eta_local, pt, m);
+            for (int i = 0; i < nharmonics; i++) {
+                moments[i][0] = 0.;
+                moments[i][1] = 0.;
+            }
+            for (int iphi = 0; iphi < nphi; iphi++) {
+                double dNdp = (
+                    pt*jacobian*particleList[j].dNdydptdphi[ieta][ipt][iphi]);
+                double phi = iphi*2*M_PI/nphi;
+                for (int i = 0; i < nharmonics; i++) {
+                    moments[i][0] += cos(i*phi)*dNdp*2*M_PI/nphi;
+                    moments[i][1] += sin(i*phi)*dNdp*2*M_PI/nphi;
+                }
+            }
+            cache[j]->set_node(ipt, ieta, yflag ? y_local : eta_local,
+                               moments[0]);
         }
-        gsl_interp_accel *cosacc = gsl_interp_accel_alloc ();
-        gsl_spline *cosspline = gsl_spline_alloc (gsl_interp_linear, npt);
-        gsl_spline_init (cosspline, particleList[j].pt ,vncos , npt);
+    }
+    cache[j]->integrate();
+    return(*cache[j]);
+}
 
-        gsl_interp_accel *sinacc = gsl_interp_accel_alloc ();
-        gsl_spline *sinspline = gsl_spline_alloc (gsl_interp_linear, npt);
-        gsl_spline_init (sinspline, particleList[j].pt ,vnsin , npt);
 
-        if (fabs(minpt - maxpt) > 1e-6) {
-            vn[n][0] = gsl_spline_eval_integ(cosspline, minpt, maxpt, cosacc);
-            vn[n][1] = gsl_spline_eval_integ(sinspline, minpt, maxpt, sinacc);
+const SpectrumMoments &Freeze::get_charged_hadron_moments(InitData *DATA) {
+    if (charged_hadron_moments_ != nullptr) return(*charged_hadron_moments_);
+    for (int k = 0; k < charged_hadron_list_length; k++) {
+        int j = partid[MHALF+charged_hadron_list[k]];
+        const SpectrumMoments &moments = get_spectrum_moments(DATA, j, 0);
+        if (k == 0) {
+            charged_hadron_moments_.reset(new SpectrumMoments(moments));
         } else {
-            vn[n][0] = gsl_spline_eval(cosspline, minpt, cosacc);
-            vn[n][1] = gsl_spline_eval(sinspline, minpt, sinacc);
+            charged_hadron_moments_->add(moments);
         }
-    
-        if (n != 0) {
-            for (int i = 0; i < 2; i++) {
-                vn[n][i] /= vn[0][0];
-            }
+    }
+    charged_hadron_moments_->integrate();
+    return(*charged_hadron_moments_);
+}
+
+
+void Freeze::clear_spectrum_moments() {
+    spectrum_moments_[0].clear();
+    spectrum_moments_[1].clear();
+    charged_hadron_moments_.reset();
+}
+
+
+bool Freeze::get_charged_hadron_integrated_moments(
+        InitData *DATA, double minpt, double maxpt, int yflag,
+        double minrap, double maxrap, double moments[nharmonics][2]) {
+    // the species share the pseudo-rapidity nodes of the spectra grid
+    if (yflag != 0 || DATA->pseudofreeze != 1) return(false);
+    int j = partid[MHALF+charged_hadron_list[0]];
+    check_pt_range(j, minpt, maxpt);
+    check_rapidity_range(DATA, j, yflag, minrap, maxrap);
+    get_charged_hadron_moments(DATA).get_integrated(minpt, maxpt, minrap,
+                                                    maxrap, moments[0]);
+    return(true);
+}
+
+
+// calculates pt- and (pseudo)rapidity-integrated flow for a given range
+// in pt and eta or y
+// format is vn[n][i(real=0 or imaginary part=1)]
+// the Fourier moments in phi are integrated over rapidity, then over pt
+void Freeze::pt_and_rapidity_integrated_flow(InitData *DATA, int number,
+        double minpt, double maxpt, int yflag,  double minrap, double maxrap,
+        double vn[nharmonics][2]) {
+    int j = partid[MHALF+number];
+    check_pt_range(j, minpt, maxpt);
+    check_rapidity_range(DATA, j, yflag, minrap, maxrap);
+    get_spectrum_moments(DATA, j, yflag).get_integrated(minpt, maxpt, minrap,
+                                                        maxrap, vn[0]);
+    for (int n = 1; n < nharmonics; n++) {
+        for (int i = 0; i < 2; i++) {
+            vn[n][i] /= vn[0][0];
         }
-    
-        // clean up
-        gsl_spline_free (cosspline);
-        gsl_interp_accel_free (cosacc);
-        gsl_spline_free (sinspline);
-        gsl_interp_accel_free (sinacc);
     }
 }
 
@@ -1801,6 +1755,11 @@ double Freeze::get_N(InitData *DATA, int number, double minpt, double maxpt,
 // If both, dN/dpt/deta.  Otherwise, total yield N
 double Freeze::get_Nch(InitData *DATA, double minpt, double maxpt, int yflag,
                        double minrap, double maxrap) {
+    double moments[nharmonics][2];
+    if (get_charged_hadron_integrated_moments(DATA, minpt, maxpt, yflag,
+                                              minrap, maxrap, moments)) {
+        return(moments[0][0]);
+    }
     double N = 0;
     for (int k = 0; k < charged_hadron_list_length; k++) {
         int number = charged_hadron_list[k];
@@ -1823,14 +1782,22 @@ double Freeze::get_vn_ch(InitData *DATA, double minpt, double maxpt, int yflag,
     double numr = 0.;  // real part (x projection, \sum N*v_n*cos(Psi_n))
     double numi = 0.;  // imaginary part (y projection, \sum N*v_n*sin(Psi_n))
     double den = 0.;   // denominator (\sum N)
-    for (int k=0; k< charged_hadron_list_length; k++) {
-        int number = charged_hadron_list[k];
-        double vn[nharmonics][2];
-        pt_and_rapidity_integrated_flow(DATA, number, minpt, maxpt, yflag,
-                                        minrap, maxrap, vn);
-        numr+= vn[0][0]*vn[n][0];
-        numi+= vn[0][0]*vn[n][1];
-        den+= vn[0][0];
+    double moments[nharmonics][2];
+    if (get_charged_hadron_integrated_moments(DATA, minpt, maxpt, yflag,
+                                              minrap, maxrap, moments)) {
+        numr = moments[n][0];
+        numi = moments[n][1];
+        den = moments[0][0];
+    } else {
+        for (int k=0; k< charged_hadron_list_length; k++) {
+            int number = charged_hadron_list[k];
+            double vn[nharmonics][2];
+            pt_and_rapidity_integrated_flow(DATA, number, minpt, maxpt,
+                                            yflag, minrap, maxrap, vn);
+            numr+= vn[0][0]*vn[n][0];
+            numi+= vn[0][0]*vn[n][1];
+            den+= vn[0][0];
+        }
     }
     vn_results[0] = numr/den;
     vn_results[1] = numi/den;
@@ -1901,6 +1868,11 @@ double Freeze::get_psi_n_ch(InitData *DATA, double minpt, double maxpt,
     }
     double numr = 0.;  // real part (x projection, \sum N*v_n*cos(Psi_n))
     double numi = 0.;  // imaginary part (y projection, \sum N*v_n*sin(Psi_n))
+    double moments[nharmonics][2];
+    if (get_charged_hadron_integrated_moments(DATA, minpt, maxpt, yflag,
+                                              minrap, maxrap, moments)) {
+        return(atan2(moments[n][1], moments[n][0])/n);
+    }
     for (int k = 0; k < charged_hadron_list_length; k++) {
         int number = charged_hadron_list[k];
         double vn[nharmonics][2];
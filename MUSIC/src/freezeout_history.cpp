@@ -0,0 +1,48 @@
+#include "freezeout_history.h"
+#include "grid_tiling.h"
+#include "memory_accounting.h"
+
+FreezeoutHistory::FreezeoutHistory(const InitData &DATA_in, const int nx,
+                                   const int ny, const int neta)
+    : DATA(DATA_in), nx_(nx), ny_(ny), neta_(neta) {}
+
+
+void FreezeoutHistory::store_copy(const SCGrid &arena_current) {
+    const int nx   = arena_current.nX();
+    const int ny   = arena_current.nY();
+    const int neta = arena_current.nEta();
+    if (   snapshot_ == nullptr || snapshot_->nX() != nx
+        || snapshot_->nY() != ny || snapshot_->nEta() != neta) {
+        MemoryScope memory_scope(MemorySubsystem::freeze_out);
+        snapshot_.reset(new SCGrid(nx, ny, neta));
+    }
+    SCGrid &snapshot = *snapshot_;
+    const GridTiling tiling(DATA, nx, ny, neta);
+    tiling.parallel_for_each_cell([&](const int ix, const int iy,
+                                      const int ieta) {
+        snapshot(ix, iy, ieta) = arena_current(ix, iy, ieta);
+    });
+    last_ = snapshot_.get();
+}
+
+
+void FreezeoutHistory::store_reference(const SCGrid &arena_current) {
+    snapshot_.reset();
+    last_ = &arena_current;
+}
+
+
+void FreezeoutHistory::store_snapshot(std::unique_ptr<SCGrid> &snapshot) {
+    snapshot_.swap(snapshot);
+    last_ = snapshot_.get();
+}
+
+
+SCGrid &FreezeoutHistory::get_snapshot_for_restart() {
+    if (snapshot_ == nullptr) {
+        MemoryScope memory_scope(MemorySubsystem::freeze_out);
+        snapshot_.reset(new SCGrid(nx_, ny_, neta_));
+    }
+    last_ = snapshot_.get();
+    return(*snapshot_);
+}
@@ -0,0 +1,55 @@
+#ifndef SRC_FREEZEOUT_HISTORY_H_
+#define SRC_FREEZEOUT_HISTORY_H_
+
+#include <memory>
+#include "data.h"
+#include "grid.h"
+
+//! This class holds the fluid cells of the last freeze-out step, the lower
+//! time level of the freeze-out hypercubes. Cell_small has only the fields
+//! which the freeze-out interpolates (epsilon, rhob, u, Wmunu and pi_b),
+//! so the snapshot is a SCGrid.
+//!
+//! A step stored with store_reference is not copied: the arena stays
+//! untouched as long as the Runge-Kutta steps only rotate it into
+//! arena_prev, which holds for the one step between the freeze-out steps
+//! of facTau = 1. The other steps (the first one, facTau > 1, a restart)
+//! are copied into a snapshot grid, which is released by the next
+//! store_reference. The snapshot takes the size of the copied arena, which
+//! shrinks when the transverse plane is coarsened; nx, ny and neta of the
+//! constructor are the size of the grid read from a checkpoint.
+class FreezeoutHistory {
+ private:
+    const InitData &DATA;
+    const int nx_, ny_, neta_;
+    std::unique_ptr<SCGrid> snapshot_;
+    //! the grid of the last stored step, snapshot_ or an arena
+    const SCGrid *last_ = nullptr;
+
+ public:
+    FreezeoutHistory(const InitData &DATA_in, const int nx, const int ny,
+                     const int neta);
+
+    //! copies arena_current into the snapshot grid
+    void store_copy(const SCGrid &arena_current);
+
+    //! records arena_current without a copy, it must become arena_prev
+    //! of the next freeze-out step unchanged
+    void store_reference(const SCGrid &arena_current);
+
+    //! takes the grid of snapshot as the last stored step, and gives back
+    //! the former snapshot grid (nullptr if there was none)
+    void store_snapshot(std::unique_ptr<SCGrid> &snapshot);
+
+    //! the cells of the last stored step
+    const SCGrid &get() const {return(*last_);}
+
+    //! true if the last step is held as a reference to an arena
+    bool is_reference() const {return(last_ != snapshot_.get());}
+
+    //! the snapshot grid the checkpoint is read into, which becomes the
+    //! last stored step
+    SCGrid &get_snapshot_for_restart();
+};
+
+#endif  // SRC_FREEZEOUT_HISTORY_H_
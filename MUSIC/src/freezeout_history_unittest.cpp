@@ -0,0 +1,32 @@
+#include "freezeout_history.h"
+#include "doctest.h"
+
+TEST_CASE("Check FreezeoutHistory copies or references the last step") {
+    InitData DATA;
+    DATA.grid_tile_size_x   = 2;
+    DATA.grid_tile_size_y   = 2;
+    DATA.grid_tile_size_eta = 2;
+    SCGrid arena(3, 4, 5);
+    arena(2, 3, 4).epsilon = 2.;
+    arena(1, 0, 2).Wmunu[5] = 0.5;
+
+    FreezeoutHistory history(DATA, 3, 4, 5);
+    history.store_copy(arena);
+    CHECK(!history.is_reference());
+    CHECK(&history.get() != &arena);
+    CHECK(history.get()(2, 3, 4).epsilon == 2.);
+    CHECK(history.get()(1, 0, 2).Wmunu[5] == 0.5);
+    // the copy does not follow the arena
+    arena(2, 3, 4).epsilon = 3.;
+    CHECK(history.get()(2, 3, 4).epsilon == 2.);
+
+    history.store_reference(arena);
+    CHECK(history.is_reference());
+    CHECK(&history.get() == &arena);
+
+    SCGrid &snapshot = history.get_snapshot_for_restart();
+    CHECK(!history.is_reference());
+    CHECK(&history.get() == &snapshot);
+    CHECK(snapshot.nX() == 3);
+    CHECK(snapshot.nEta() == 5);
+}
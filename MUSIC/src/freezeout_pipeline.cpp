@@ -0,0 +1,58 @@
+#ifdef _OPENMP
+    #include <omp.h>
+#endif
+
+#include <utility>
+#include "freezeout_pipeline.h"
+#include "grid_tiling.h"
+#include "memory_accounting.h"
+
+FreezeoutPipeline::FreezeoutPipeline(const InitData &DATA_in,
+                                     const int n_threads)
+    : DATA(DATA_in), n_threads_(n_threads) {}
+
+
+FreezeoutPipeline::~FreezeoutPipeline() {
+    if (worker_.joinable()) worker_.join();
+}
+
+
+void FreezeoutPipeline::launch(const SCGrid &arena_current,
+                               FreezeoutHistory &history,
+                               SurfaceFinder find_surface) {
+    wait(history);
+    const int nx   = arena_current.nX();
+    const int ny   = arena_current.nY();
+    const int neta = arena_current.nEta();
+    if (   snapshot_ == nullptr || snapshot_->nX() != nx
+        || snapshot_->nY() != ny || snapshot_->nEta() != neta) {
+        MemoryScope memory_scope(MemorySubsystem::freeze_out);
+        snapshot_.reset(new SCGrid(nx, ny, neta));
+    }
+    SCGrid &snapshot = *snapshot_;
+    const GridTiling tiling(DATA, nx, ny, neta);
+    tiling.parallel_for_each_cell([&](const int ix, const int iy,
+                                      const int ieta) {
+        snapshot(ix, iy, ieta) = arena_current(ix, iy, ieta);
+    });
+    const SCGrid *arena_freezeout = &history.get();
+    has_step_ = true;
+    worker_ = std::thread(
+        [this, arena_freezeout, find_surface = std::move(find_surface)]() {
+#ifdef _OPENMP
+            // the number of threads of the regions of this thread
+            omp_set_num_threads(n_threads_);
+#endif
+            result_ = find_surface(*snapshot_, *arena_freezeout);
+        });
+}
+
+
+int FreezeoutPipeline::wait(FreezeoutHistory &history) {
+    if (worker_.joinable()) worker_.join();
+    if (has_step_) {
+        history.store_snapshot(snapshot_);
+        has_step_ = false;
+    }
+    return(result_);
+}
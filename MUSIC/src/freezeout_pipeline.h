@@ -0,0 +1,60 @@
+#ifndef SRC_FREEZEOUT_PIPELINE_H_
+#define SRC_FREEZEOUT_PIPELINE_H_
+
+#include <functional>
+#include <memory>
+#include <thread>
+#include "data.h"
+#include "grid.h"
+#include "freezeout_history.h"
+
+//! This class finds the freeze-out surface of a step on a thread of its
+//! own, while the evolution advances the next steps. launch() copies the
+//! arena of the step into a snapshot, the upper time level of the
+//! hypercubes, whose lower one is the last step of the FreezeoutHistory.
+//! Only one step is found at a time: wait() joins the freeze-out thread
+//! and stores the snapshot in the history, as the lower time level of the
+//! next step. The snapshot takes the size of the arena of the step.
+//!
+//! The OpenMP regions of the freeze-out thread have n_threads threads,
+//! numbered from 0 like the ones of the evolution, so the per-thread
+//! buffers of the freeze-out must not be used by the evolution.
+class FreezeoutPipeline {
+ public:
+    //! finds the surface between the arenas of a step and the last step,
+    //! returns the frozen flag of the step
+    typedef std::function<int(SCGrid &arena_current,
+                              const SCGrid &arena_freezeout)> SurfaceFinder;
+
+ private:
+    const InitData &DATA;
+    const int n_threads_;
+    std::unique_ptr<SCGrid> snapshot_;
+    std::thread worker_;
+    //! a launched step, whose snapshot is not yet in the history
+    bool has_step_ = false;
+    int result_ = 0;
+
+ public:
+    FreezeoutPipeline(const InitData &DATA_in, const int n_threads);
+    //! waits for the step being found
+    ~FreezeoutPipeline();
+
+    FreezeoutPipeline(const FreezeoutPipeline&) = delete;
+    FreezeoutPipeline& operator=(const FreezeoutPipeline&) = delete;
+
+    int get_number_of_threads() const {return(n_threads_);}
+
+    //! waits for the previous step, copies arena_current into the snapshot
+    //! and runs find_surface(snapshot, history.get()) on the freeze-out
+    //! thread. The history must not change until the next wait().
+    void launch(const SCGrid &arena_current, FreezeoutHistory &history,
+                SurfaceFinder find_surface);
+
+    //! waits for the last launched step and stores its snapshot in
+    //! history. Returns the frozen flag of the last launched step (0
+    //! before the first one).
+    int wait(FreezeoutHistory &history);
+};
+
+#endif  // SRC_FREEZEOUT_PIPELINE_H_
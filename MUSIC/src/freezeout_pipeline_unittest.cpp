@@ -0,0 +1,60 @@
+#ifdef _OPENMP
+    #include <omp.h>
+#endif
+
+#include "freezeout_pipeline.h"
+#include "doctest.h"
+
+TEST_CASE("Check FreezeoutPipeline finds a step while the arena changes") {
+    InitData DATA;
+    DATA.grid_tile_size_x   = 2;
+    DATA.grid_tile_size_y   = 2;
+    DATA.grid_tile_size_eta = 2;
+    SCGrid arena(3, 4, 5);
+    arena(2, 3, 4).epsilon = 1.;
+
+    FreezeoutHistory history(DATA, 3, 4, 5);
+    history.store_copy(arena);
+    FreezeoutPipeline pipeline(DATA, 2);
+    CHECK(pipeline.wait(history) == 0);
+
+    // the step sees the snapshot of the arena and the last step
+    int n_steps = 0;
+    double eps_current = 0.;
+    double eps_freezeout = 0.;
+    int n_threads = 0;
+    auto find_surface = [&](SCGrid &arena_current,
+                            const SCGrid &arena_freezeout) {
+        n_steps++;
+        eps_current = arena_current(2, 3, 4).epsilon;
+        eps_freezeout = arena_freezeout(2, 3, 4).epsilon;
+        #pragma omp parallel
+        {
+            #pragma omp single
+            {
+#ifdef _OPENMP
+                n_threads = omp_get_num_threads();
+#else
+                n_threads = 2;
+#endif
+            }
+        }
+        return(n_steps == 2 ? 1 : 10);
+    };
+    arena(2, 3, 4).epsilon = 2.;
+    pipeline.launch(arena, history, find_surface);
+    arena(2, 3, 4).epsilon = 3.;
+    CHECK(pipeline.wait(history) == 10);
+    CHECK(eps_current == 2.);
+    CHECK(eps_freezeout == 1.);
+    CHECK(n_threads == 2);
+    // the snapshot is the lower time level of the next step
+    CHECK(history.get()(2, 3, 4).epsilon == 2.);
+    CHECK(pipeline.wait(history) == 10);
+
+    pipeline.launch(arena, history, find_surface);
+    CHECK(pipeline.wait(history) == 1);
+    CHECK(eps_current == 3.);
+    CHECK(eps_freezeout == 2.);
+    CHECK(history.get()(2, 3, 4).epsilon == 3.);
+}
@@ -0,0 +1,121 @@
+#include <algorithm>
+#include "freezeout_prescreen.h"
+
+void FreezeoutPrescreen::find_cubes(const SCGrid &arena_current,
+                                    const SCGrid &arena_freezeout,
+                                    const std::vector<double> &epsFO_list,
+                                    const int ix_start, const int ix_end,
+                                    const int fac_x,
+                                    const int iy_start, const int iy_end,
+                                    const int fac_y,
+                                    const int ieta_start, const int ieta_end,
+                                    const int fac_eta,
+                                    std::vector<FreezeoutCube> &cubes) {
+    cubes.clear();
+    const int ncube_x = std::max(0, (ix_end - ix_start + fac_x - 1)/fac_x);
+    const int ncube_y = std::max(0, (iy_end - iy_start + fac_y - 1)/fac_y);
+    const int nslices = std::max(0, ieta_end - ieta_start);
+    const int nsurf   = static_cast<int>(epsFO_list.size());
+    if (ncube_x == 0 || ncube_y == 0 || nslices == 0 || nsurf == 0) return;
+
+    // the corners of the cubes, y runs fastest. Without eta extent the
+    // corners at ieta + 1 are the ones at ieta.
+    const int npx = ncube_x + 1;
+    const int npy = ncube_y + 1;
+    const int nlayers = nslices + fac_eta;
+    const int npoints = npx*npy*nlayers;
+    above_current_.resize(npoints);
+    below_current_.resize(npoints);
+    above_freezeout_.resize(npoints);
+    below_freezeout_.resize(npoints);
+    cubes_per_slice_.resize(nslices);
+    for (auto &slice_cubes : cubes_per_slice_) slice_cubes.clear();
+
+    const int max_bits = 32;
+    for (int s0 = 0; s0 < nsurf; s0 += max_bits) {
+        const int nbits = std::min(max_bits, nsurf - s0);
+        const uint32_t all_bits = (
+            nbits == max_bits ? ~0u : ((1u << nbits) - 1u));
+
+        // the sides of the isotherms at the corners
+        #pragma omp parallel for collapse(2)
+        for (int l = 0; l < nlayers; l++)
+        for (int px = 0; px < npx; px++) {
+            const int ieta = ieta_start + l;
+            const int ix = ix_start + px*fac_x;
+            const int offset = (l*npx + px)*npy;
+            for (int py = 0; py < npy; py++) {
+                const int iy = iy_start + py*fac_y;
+                const double e_c = arena_current(ix, iy, ieta).epsilon;
+                const double e_f = arena_freezeout(ix, iy, ieta).epsilon;
+                uint32_t a_c = 0, b_c = 0, a_f = 0, b_f = 0;
+                for (int s = 0; s < nbits; s++) {
+                    const double epsFO = epsFO_list[s0 + s];
+                    a_c |= static_cast<uint32_t>(e_c > epsFO) << s;
+                    b_c |= static_cast<uint32_t>(e_c < epsFO) << s;
+                    a_f |= static_cast<uint32_t>(e_f > epsFO) << s;
+                    b_f |= static_cast<uint32_t>(e_f < epsFO) << s;
+                }
+                above_current_  [offset + py] = a_c;
+                below_current_  [offset + py] = b_c;
+                above_freezeout_[offset + py] = a_f;
+                below_freezeout_[offset + py] = b_f;
+            }
+        }
+
+        // the isotherms crossing a diagonal of each cube
+        #pragma omp parallel
+        {
+            std::vector<uint32_t> crossed(ncube_y);
+            #pragma omp for schedule(static)
+            for (int l = 0; l < nslices; l++)
+            for (int cx = 0; cx < ncube_x; cx++) {
+                // the mask rows of the corners [dx][deta]
+                const uint32_t *a_c[2][2], *b_c[2][2];
+                const uint32_t *a_f[2][2], *b_f[2][2];
+                for (int dx = 0; dx < 2; dx++)
+                for (int de = 0; de < 2; de++) {
+                    const int offset = ((l + de*fac_eta)*npx + cx + dx)*npy;
+                    a_c[dx][de] = &above_current_  [offset];
+                    b_c[dx][de] = &below_current_  [offset];
+                    a_f[dx][de] = &above_freezeout_[offset];
+                    b_f[dx][de] = &below_freezeout_[offset];
+                }
+
+                #pragma omp simd
+                for (int cy = 0; cy < ncube_y; cy++) {
+                    uint32_t same_side = all_bits;
+                    for (int dx = 0; dx < 2; dx++)
+                    for (int dy = 0; dy < 2; dy++)
+                    for (int de = 0; de < 2; de++) {
+                        const int yc = cy + dy;
+                        const int yf = cy + 1 - dy;
+                        same_side &= (
+                              (a_c[dx][de][yc] & a_f[1-dx][1-de][yf])
+                            | (b_c[dx][de][yc] & b_f[1-dx][1-de][yf]));
+                    }
+                    crossed[cy] = ~same_side & all_bits;
+                }
+
+                const int ieta = ieta_start + l;
+                const int ix = ix_start + cx*fac_x;
+                for (int cy = 0; cy < ncube_y; cy++) {
+                    if (crossed[cy] == 0) continue;
+                    for (int s = 0; s < nbits; s++) {
+                        if ((crossed[cy] >> s) & 1u) {
+                            cubes_per_slice_[l].push_back(
+                                {s0 + s, ieta, ix, iy_start + cy*fac_y});
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    for (const auto &slice_cubes : cubes_per_slice_) {
+        cubes.insert(cubes.end(), slice_cubes.begin(), slice_cubes.end());
+    }
+    std::stable_sort(cubes.begin(), cubes.end(),
+                     [](const FreezeoutCube &a, const FreezeoutCube &b) {
+                         return(a.isurf < b.isurf);});
+}
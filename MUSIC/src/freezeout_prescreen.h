@@ -0,0 +1,47 @@
+#ifndef SRC_FREEZEOUT_PRESCREEN_H_
+#define SRC_FREEZEOUT_PRESCREEN_H_
+
+#include <cstdint>
+#include <vector>
+#include "grid.h"
+
+//! a hypercube of the freeze-out scan, with corners (ix, iy, ieta) and
+//! (ix + fac_x, iy + fac_y, ieta + fac_eta) on arena_freezeout and
+//! arena_current, crossed by the isotherm epsFO_list[isurf]
+struct FreezeoutCube {
+    int isurf;
+    int ieta;
+    int ix;
+    int iy;
+};
+
+//! This class lists the hypercubes of the freeze-out scan that can be
+//! intersected by any of the isotherms, so that Cornelius only runs on
+//! those. A hypercube is skipped when each of its eight diagonals (a corner
+//! at tau and the opposite one at tau - dtau) lies on one side of the
+//! isotherm, the criterion of Evolve::FindFreezeOutSurface_Cornelius.
+//! The sides of the isotherms are bit masks of the corners, up to 32
+//! isotherms per pass, so the scan is integer logic over the masks.
+class FreezeoutPrescreen {
+ private:
+    //! bit s is set if epsilon > epsFO_s (above) or epsilon < epsFO_s (below)
+    std::vector<uint32_t> above_current_, below_current_;
+    std::vector<uint32_t> above_freezeout_, below_freezeout_;
+    std::vector<std::vector<FreezeoutCube>> cubes_per_slice_;
+
+ public:
+    //! this function fills cubes with the intersected hypercubes of the
+    //! scan range ix in [ix_start, ix_end) with step fac_x, iy likewise,
+    //! and ieta in [ieta_start, ieta_end), ordered by isurf, ieta, ix, iy.
+    //! fac_eta is 1, or 0 for the (tau, x, y) cubes of the boost-invariant
+    //! runs. epsFO_list is in 1/fm^4.
+    void find_cubes(const SCGrid &arena_current,
+                    const SCGrid &arena_freezeout,
+                    const std::vector<double> &epsFO_list,
+                    const int ix_start, const int ix_end, const int fac_x,
+                    const int iy_start, const int iy_end, const int fac_y,
+                    const int ieta_start, const int ieta_end,
+                    const int fac_eta, std::vector<FreezeoutCube> &cubes);
+};
+
+#endif  // SRC_FREEZEOUT_PRESCREEN_H_
@@ -0,0 +1,129 @@
+#include "doctest.h"
+#include "freezeout_prescreen.h"
+#include <cmath>
+
+namespace {
+
+//! the intersection criterion of the scalar freeze-out scan
+bool is_intersected(const SCGrid &arena_current, const SCGrid &arena_freezeout,
+                    const int ix, const int iy, const int ieta,
+                    const int fac_x, const int fac_y, const double epsFO) {
+    for (int dx = 0; dx < 2; dx++)
+    for (int dy = 0; dy < 2; dy++)
+    for (int de = 0; de < 2; de++) {
+        const double e_c = arena_current(ix + dx*fac_x, iy + dy*fac_y,
+                                         ieta + de).epsilon;
+        const double e_f = arena_freezeout(ix + (1 - dx)*fac_x,
+                                           iy + (1 - dy)*fac_y,
+                                           ieta + 1 - de).epsilon;
+        if ((e_c - epsFO)*(e_f - epsFO) <= 0.) return(true);
+    }
+    return(false);
+}
+
+}
+
+TEST_CASE("Check FreezeoutPrescreen against the scalar criterion") {
+    const int nx = 21;
+    const int ny = 17;
+    const int neta = 4;
+    SCGrid arena_current(nx, ny, neta);
+    SCGrid arena_freezeout(nx, ny, neta);
+    for (int ieta = 0; ieta < neta; ieta++)
+    for (int iy = 0; iy < ny; iy++)
+    for (int ix = 0; ix < nx; ix++) {
+        const double r2 = ((ix - 10.)*(ix - 10.) + (iy - 8.)*(iy - 8.)
+                           + 4.*ieta*ieta);
+        arena_freezeout(ix, iy, ieta).epsilon = 2.*exp(-r2/30.);
+        arena_current(ix, iy, ieta).epsilon = 1.8*exp(-r2/25.);
+    }
+    // more isotherms than the bits of one pass
+    std::vector<double> epsFO_list;
+    for (int s = 0; s < 40; s++) epsFO_list.push_back(0.05 + 0.04*s);
+
+    FreezeoutPrescreen prescreen;
+    for (int fac = 1; fac < 3; fac++) {
+        const int ix_start = 2;
+        const int ix_end = nx - 2*fac;
+        const int iy_start = 0;
+        const int iy_end = ny - fac;
+        std::vector<FreezeoutCube> cubes;
+        prescreen.find_cubes(arena_current, arena_freezeout, epsFO_list,
+                             ix_start, ix_end, fac, iy_start, iy_end, fac,
+                             0, neta - 1, 1, cubes);
+
+        std::vector<FreezeoutCube> cubes_ref;
+        for (int s = 0; s < static_cast<int>(epsFO_list.size()); s++)
+        for (int ieta = 0; ieta < neta - 1; ieta++)
+        for (int ix = ix_start; ix < ix_end; ix += fac)
+        for (int iy = iy_start; iy < iy_end; iy += fac) {
+            if (is_intersected(arena_current, arena_freezeout, ix, iy, ieta,
+                               fac, fac, epsFO_list[s])) {
+                cubes_ref.push_back({s, ieta, ix, iy});
+            }
+        }
+
+        CHECK(cubes_ref.size() > 0);
+        REQUIRE(cubes.size() == cubes_ref.size());
+        int n_different = 0;
+        for (unsigned int i = 0; i < cubes.size(); i++) {
+            if (   cubes[i].isurf != cubes_ref[i].isurf
+                || cubes[i].ieta != cubes_ref[i].ieta
+                || cubes[i].ix != cubes_ref[i].ix
+                || cubes[i].iy != cubes_ref[i].iy) {
+                n_different++;
+            }
+        }
+        CHECK(n_different == 0);
+    }
+
+    // an empty scan range
+    std::vector<FreezeoutCube> cubes(1);
+    prescreen.find_cubes(arena_current, arena_freezeout, epsFO_list,
+                         3, 3, 1, 0, ny - 1, 1, 0, neta - 1, 1, cubes);
+    CHECK(cubes.empty());
+}
+
+TEST_CASE("Check FreezeoutPrescreen on the boost-invariant cubes") {
+    const int nx = 21;
+    const int ny = 17;
+    SCGrid arena_current(nx, ny, 1);
+    SCGrid arena_freezeout(nx, ny, 1);
+    for (int iy = 0; iy < ny; iy++)
+    for (int ix = 0; ix < nx; ix++) {
+        const double r2 = (ix - 10.)*(ix - 10.) + (iy - 8.)*(iy - 8.);
+        arena_freezeout(ix, iy, 0).epsilon = 2.*exp(-r2/30.);
+        arena_current(ix, iy, 0).epsilon = 1.8*exp(-r2/25.);
+    }
+    const std::vector<double> epsFO_list = {0.1, 0.5, 1.2};
+
+    FreezeoutPrescreen prescreen;
+    std::vector<FreezeoutCube> cubes;
+    prescreen.find_cubes(arena_current, arena_freezeout, epsFO_list,
+                         1, nx - 2, 1, 1, ny - 2, 1, 0, 1, 0, cubes);
+
+    // the four diagonals of the (tau, x, y) cube
+    std::vector<FreezeoutCube> cubes_ref;
+    for (int s = 0; s < static_cast<int>(epsFO_list.size()); s++)
+    for (int ix = 1; ix < nx - 2; ix++)
+    for (int iy = 1; iy < ny - 2; iy++) {
+        bool intersected = false;
+        for (int dx = 0; dx < 2; dx++)
+        for (int dy = 0; dy < 2; dy++) {
+            const double e_c = arena_current(ix + dx, iy + dy, 0).epsilon;
+            const double e_f = arena_freezeout(ix + 1 - dx, iy + 1 - dy,
+                                               0).epsilon;
+            if ((e_c - epsFO_list[s])*(e_f - epsFO_list[s]) <= 0.) {
+                intersected = true;
+            }
+        }
+        if (intersected) cubes_ref.push_back({s, 0, ix, iy});
+    }
+    CHECK(cubes_ref.size() > 0);
+    REQUIRE(cubes.size() == cubes_ref.size());
+    for (unsigned int i = 0; i < cubes.size(); i++) {
+        CHECK(cubes[i].isurf == cubes_ref[i].isurf);
+        CHECK(cubes[i].ix == cubes_ref[i].ix);
+        CHECK(cubes[i].iy == cubes_ref[i].iy);
+    }
+}
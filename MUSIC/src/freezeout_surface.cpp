@@ -0,0 +1,246 @@
+#ifdef _OPENMP
+    #include <omp.h>
+#endif
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "freezeout_surface.h"
+
+#ifndef _OPENMP
+    #define omp_get_thread_num() 0
+    #define omp_get_max_threads() 1
+#endif
+
+namespace {
+    const char kMagic[8] = {'M', 'U', 'S', 'I', 'C', 'F', 'O', 'S'};
+
+    const char *kBaseFieldNames[FreezeoutSurface::kNumBaseFields] = {
+        "tau", "x", "y", "eta",
+        "dsigma_tau", "dsigma_x", "dsigma_y", "dsigma_eta",
+        "u_tau", "u_x", "u_y", "u_eta",
+        "epsilon", "T", "mu_B", "mu_S", "mu_C", "eps_plus_p_over_T",
+        "W_tautau", "W_taux", "W_tauy", "W_taueta", "W_xx", "W_xy",
+        "W_xeta", "W_yy", "W_yeta", "W_etaeta",
+        "pi_b", "rho_B", "q_tau", "q_x", "q_y", "q_eta"};
+
+    const char *kVorticityNames[4] = {
+        "omega_kSP", "omega_k", "omega_th", "omega_T"};
+
+    //! the header size before the field names
+    const size_t kHeaderSize = 8 + 2*sizeof(int32_t) + sizeof(int64_t)
+                               + sizeof(int32_t);
+}
+
+const int32_t FreezeoutSurface::kFormatVersion;
+const int FreezeoutSurface::kNumBaseFields;
+const int FreezeoutSurface::kNumVorticityFields;
+
+
+FreezeoutSurface::FreezeoutSurface(const int n_surf, const int n_fields) :
+        n_fields_(n_fields), memory_(MemorySubsystem::freeze_out) {
+    buffers_.resize(omp_get_max_threads());
+    for (auto &buffer_i : buffers_) buffer_i.resize(n_surf);
+    elements_.resize(n_surf);
+}
+
+
+void FreezeoutSurface::add_element(const int isurf, const float *row,
+                                   const int n_values) {
+    auto &buffer = buffers_[omp_get_thread_num()][isurf];
+    const int n_copy = std::min(n_values, n_fields_);
+    buffer.insert(buffer.end(), row, row + n_copy);
+    buffer.resize(buffer.size() + (n_fields_ - n_copy), 0.f);
+}
+
+
+void FreezeoutSurface::merge() {
+    for (unsigned int isurf = 0; isurf < elements_.size(); isurf++) {
+        size_t n_total = elements_[isurf].size();
+        for (const auto &buffer_i : buffers_) {
+            n_total += buffer_i[isurf].size();
+        }
+        elements_[isurf].reserve(n_total);
+        for (auto &buffer_i : buffers_) {
+            elements_[isurf].insert(elements_[isurf].end(),
+                                    buffer_i[isurf].begin(),
+                                    buffer_i[isurf].end());
+            std::vector<float>().swap(buffer_i[isurf]);
+        }
+    }
+    update_memory_use();
+}
+
+
+void FreezeoutSurface::take_new_elements(const int isurf,
+                                         std::vector<float> &rows) {
+    rows.clear();
+    size_t n_total = 0;
+    for (const auto &buffer_i : buffers_) n_total += buffer_i[isurf].size();
+    rows.reserve(n_total);
+    for (auto &buffer_i : buffers_) {
+        rows.insert(rows.end(), buffer_i[isurf].begin(),
+                    buffer_i[isurf].end());
+        buffer_i[isurf].clear();
+    }
+}
+
+
+void FreezeoutSurface::update_memory_use() {
+    size_t n_floats = 0;
+    for (const auto &buffer_i : buffers_) {
+        for (const auto &buffer : buffer_i) n_floats += buffer.capacity();
+    }
+    for (const auto &elements : elements_) n_floats += elements.capacity();
+    memory_.set(static_cast<int64_t>(n_floats*sizeof(float)));
+}
+
+
+void FreezeoutSurface::write_file(const int isurf,
+                                  const std::string &filename) {
+    FILE *out_file = fopen(filename.c_str(), "wb");
+    if (out_file == NULL) {
+        music_message << "FreezeoutSurface: can not open file " << filename;
+        music_message.flush("error");
+        exit(1);
+    }
+    // the rows start at a multiple of 8 bytes, for mapping the file
+    std::string field_names = get_field_names(n_fields_);
+    field_names.resize(field_names.size()
+                       + (8 - (kHeaderSize + field_names.size())%8)%8, '\0');
+    const int32_t header[2] = {kFormatVersion,
+                               static_cast<int32_t>(n_fields_)};
+    const int64_t n_elements = get_number_of_elements(isurf);
+    const int32_t names_length = static_cast<int32_t>(field_names.size());
+    fwrite(kMagic, sizeof(char), 8, out_file);
+    fwrite(header, sizeof(int32_t), 2, out_file);
+    fwrite(&n_elements, sizeof(int64_t), 1, out_file);
+    fwrite(&names_length, sizeof(int32_t), 1, out_file);
+    fwrite(field_names.data(), sizeof(char), names_length, out_file);
+    fwrite(elements_[isurf].data(), sizeof(float), elements_[isurf].size(),
+           out_file);
+    fclose(out_file);
+}
+
+
+std::string FreezeoutSurface::get_field_names(const int n_fields) {
+    std::string names;
+    for (int i = 0; i < n_fields; i++) {
+        if (i > 0) names += ",";
+        if (i < kNumBaseFields) {
+            names += kBaseFieldNames[i];
+        } else {
+            const int i_vor = i - kNumBaseFields;
+            names += (std::string(kVorticityNames[(i_vor/6)%4]) + "_"
+                      + std::to_string(i_vor%6));
+        }
+    }
+    return(names);
+}
+
+
+bool FreezeoutSurface::read_file(const std::string &filename, int &n_fields,
+                                 std::vector<float> &elements) {
+    MappedSurfaceFile surface_file(filename, kNumBaseFields);
+    if (!surface_file.has_header()) return(false);
+    n_fields = surface_file.get_number_of_fields();
+    elements.assign(surface_file.get_rows(),
+                    surface_file.get_rows()
+                    + surface_file.get_number_of_elements()*n_fields);
+    return(true);
+}
+
+
+MappedSurfaceFile::MappedSurfaceFile(const std::string &filename,
+                                     const int n_fields_headerless) :
+        map_(nullptr), map_size_(0), has_header_(false),
+        n_fields_(n_fields_headerless), n_elements_(0), rows_(nullptr) {
+    pretty_ostream music_message;
+    const int fd = open(filename.c_str(), O_RDONLY);
+    struct stat file_stat;
+    if (fd < 0 || fstat(fd, &file_stat) != 0) {
+        music_message << "MappedSurfaceFile: can not open file " << filename;
+        music_message.flush("error");
+        exit(1);
+    }
+    map_size_ = static_cast<size_t>(file_stat.st_size);
+    if (map_size_ > 0) {
+        map_ = mmap(nullptr, map_size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (map_ == MAP_FAILED) {
+        music_message << "MappedSurfaceFile: can not map file " << filename;
+        music_message.flush("error");
+        exit(1);
+    }
+    if (map_size_ == 0) return;
+    const char *data = static_cast<const char*>(map_);
+
+    has_header_ = (map_size_ >= 8 && std::memcmp(data, kMagic, 8) == 0);
+    if (!has_header_) {
+        // legacy surface file
+        n_elements_ = (map_size_/sizeof(float))/n_fields_;
+        rows_ = reinterpret_cast<const float*>(data);
+        return;
+    }
+
+    int32_t header[2] = {0, 0};
+    int64_t n_elements = 0;
+    int32_t names_length = 0;
+    bool header_ok = (map_size_ >= kHeaderSize);
+    if (header_ok) {
+        std::memcpy(header, data + 8, 2*sizeof(int32_t));
+        std::memcpy(&n_elements, data + 16, sizeof(int64_t));
+        std::memcpy(&names_length, data + 24, sizeof(int32_t));
+        header_ok = (names_length >= 0
+                     && map_size_ >= kHeaderSize + names_length);
+    }
+    if (!header_ok || header[0] > FreezeoutSurface::kFormatVersion
+            || n_elements < 0) {
+        music_message << "MappedSurfaceFile: " << filename
+                      << " has an invalid header (format version "
+                      << header[0] << ", this code reads up to "
+                      << FreezeoutSurface::kFormatVersion << ")";
+        music_message.flush("error");
+        exit(1);
+    }
+
+    // the fields read by Freeze have to be in the legacy order
+    n_fields_ = header[1];
+    std::string field_names(data + kHeaderSize, names_length);
+    field_names.resize(std::strlen(field_names.c_str()));
+    const std::string base_names = FreezeoutSurface::get_field_names(
+                                        FreezeoutSurface::kNumBaseFields);
+    if (n_fields_ < FreezeoutSurface::kNumBaseFields
+            || field_names.compare(0, base_names.size(), base_names) != 0
+            || (field_names.size() > base_names.size()
+                && field_names[base_names.size()] != ',')) {
+        music_message << "MappedSurfaceFile: unknown field layout in "
+                      << filename << ": " << field_names;
+        music_message.flush("error");
+        exit(1);
+    }
+
+    const size_t rows_offset = kHeaderSize + names_length;
+    const size_t n_floats = static_cast<size_t>(n_elements)*n_fields_;
+    if (map_size_ < rows_offset + n_floats*sizeof(float)) {
+        music_message << "MappedSurfaceFile: " << filename
+                      << " is truncated, "
+                      << (map_size_ - rows_offset)/sizeof(float)/n_fields_
+                      << " of " << n_elements << " elements";
+        music_message.flush("error");
+        exit(1);
+    }
+    n_elements_ = n_elements;
+    rows_ = reinterpret_cast<const float*>(data + rows_offset);
+}
+
+
+MappedSurfaceFile::~MappedSurfaceFile() {
+    if (map_ != nullptr && map_ != MAP_FAILED) munmap(map_, map_size_);
+}
@@ -0,0 +1,117 @@
+#ifndef SRC_FREEZEOUT_SURFACE_H_
+#define SRC_FREEZEOUT_SURFACE_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "memory_accounting.h"
+#include "pretty_ostream.h"
+
+//! This class collects the freeze-out surface elements found inside the
+//! OpenMP loops of the Cornelius freeze-out. Every thread appends to its own
+//! buffer for each isotherm, the buffers are merged once after the
+//! evolution and written as one binary file per isotherm (or handed to
+//! Freeze directly when hydro and Cooper-Frye run in one MUSIC object).
+//! An element is a row of floats in the order of the legacy binary surface
+//! files, 34 fields plus the 24 vorticity fields with output_vorticity = 1.
+//!
+//! File layout: the 8 char magic "MUSICFOS", the int32 format version,
+//! the int32 number of fields per element, the int64 number of elements,
+//! the int32 length of the field names, the comma separated field names
+//! padded with '\0' to a multiple of 8 bytes of the header, followed by the
+//! elements as float rows.
+class FreezeoutSurface {
+ private:
+    const int n_fields_;
+    //! [thread][isurf] rows of n_fields_ floats
+    std::vector<std::vector<std::vector<float>>> buffers_;
+    //! [isurf] merged rows, filled by merge()
+    std::vector<std::vector<float>> elements_;
+    MemoryRegistration memory_;
+    pretty_ostream music_message;
+
+ public:
+    static const int32_t kFormatVersion = 1;
+    static const int kNumBaseFields = 34;
+    static const int kNumVorticityFields = 24;
+
+    FreezeoutSurface(const int n_surf, const int n_fields);
+
+    FreezeoutSurface(const FreezeoutSurface&) = delete;
+    FreezeoutSurface& operator=(const FreezeoutSurface&) = delete;
+
+    int get_number_of_fields() const {return(n_fields_);}
+    int get_number_of_isotherms() const {
+        return(static_cast<int>(elements_.size()));
+    }
+
+    //! append one element of the isotherm isurf to the buffer of the
+    //! calling thread. The first n_values fields are copied from row,
+    //! the remaining ones are set to zero.
+    void add_element(const int isurf, const float *row, const int n_values);
+
+    //! move the thread buffers to the merged lists, in thread order
+    //! (must be called outside of the parallel region)
+    void merge();
+
+    //! move the elements of the isotherm isurf added since the last call
+    //! out of the thread buffers into rows, in thread order, e.g. to
+    //! stream them instead of keeping them (outside of the parallel region)
+    void take_new_elements(const int isurf, std::vector<float> &rows);
+
+    //! books the capacity of the buffers and of the merged lists (outside
+    //! of the parallel region)
+    void update_memory_use();
+
+    int64_t get_number_of_elements(const int isurf) const {
+        return(static_cast<int64_t>(elements_[isurf].size())/n_fields_);
+    }
+    //! the merged rows of the isotherm isurf
+    const std::vector<float> &get_elements(const int isurf) const {
+        return(elements_[isurf]);
+    }
+
+    //! write the merged elements of the isotherm isurf to filename
+    void write_file(const int isurf, const std::string &filename);
+
+    //! the comma separated names of the first n_fields fields
+    static std::string get_field_names(const int n_fields);
+
+    //! this function reads a surface file written by write_file into
+    //! elements, with n_fields floats per element. It returns false,
+    //! reading nothing, if the file does not start with the magic.
+    static bool read_file(const std::string &filename, int &n_fields,
+                          std::vector<float> &elements);
+};
+
+
+//! This class maps a binary surface file read-only into memory, so the
+//! float rows can be used without reading them into a buffer first. Files
+//! written by FreezeoutSurface::write_file are recognized by their header,
+//! other files are taken as legacy surface files without header with
+//! n_fields_headerless floats per element.
+class MappedSurfaceFile {
+ private:
+    void *map_;
+    size_t map_size_;
+    bool has_header_;
+    int n_fields_;
+    int64_t n_elements_;
+    const float *rows_;
+
+ public:
+    MappedSurfaceFile(const std::string &filename,
+                      const int n_fields_headerless);
+    ~MappedSurfaceFile();
+
+    MappedSurfaceFile(const MappedSurfaceFile&) = delete;
+    MappedSurfaceFile& operator=(const MappedSurfaceFile&) = delete;
+
+    bool has_header() const {return(has_header_);}
+    int get_number_of_fields() const {return(n_fields_);}
+    int64_t get_number_of_elements() const {return(n_elements_);}
+    //! the element rows, n_fields floats each
+    const float *get_rows() const {return(rows_);}
+};
+
+#endif  // SRC_FREEZEOUT_SURFACE_H_
@@ -0,0 +1,88 @@
+#include "doctest.h"
+#include "freezeout_surface.h"
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+TEST_CASE("Check FreezeoutSurface write and read round trip") {
+    const int n_fields = (FreezeoutSurface::kNumBaseFields
+                          + FreezeoutSurface::kNumVorticityFields);
+    FreezeoutSurface surface(2, n_fields);
+    std::vector<float> row(n_fields);
+    for (int ielem = 0; ielem < 3; ielem++) {
+        for (int i = 0; i < n_fields; i++) row[i] = 100.f*ielem + i;
+        surface.add_element(0, row.data(), n_fields);
+    }
+    // the fields after n_values are zero
+    surface.add_element(1, row.data(), FreezeoutSurface::kNumBaseFields);
+    surface.merge();
+    REQUIRE(surface.get_number_of_elements(0) == 3);
+    REQUIRE(surface.get_number_of_elements(1) == 1);
+    CHECK(surface.get_elements(0)[2*n_fields + 5] == 205.f);
+    CHECK(surface.get_elements(1)[FreezeoutSurface::kNumBaseFields - 1]
+          == 200.f + FreezeoutSurface::kNumBaseFields - 1);
+    CHECK(surface.get_elements(1)[FreezeoutSurface::kNumBaseFields] == 0.f);
+
+    const std::string filename = "freezeout_surface_unittest.dat";
+    surface.write_file(0, filename);
+    int n_fields_read = 0;
+    std::vector<float> elements;
+    REQUIRE(FreezeoutSurface::read_file(filename, n_fields_read, elements));
+    CHECK(n_fields_read == n_fields);
+    CHECK(elements == surface.get_elements(0));
+
+    {
+        MappedSurfaceFile mapped_file(filename,
+                                      FreezeoutSurface::kNumBaseFields);
+        REQUIRE(mapped_file.has_header());
+        REQUIRE(mapped_file.get_number_of_elements() == 3);
+        CHECK(mapped_file.get_number_of_fields() == n_fields);
+        // the rows are aligned for the float access
+        CHECK(reinterpret_cast<uintptr_t>(mapped_file.get_rows())%8 == 0);
+        CHECK(mapped_file.get_rows()[2*n_fields + 5] == 205.f);
+    }
+
+    // a legacy file without the header
+    FILE *legacy_file = fopen(filename.c_str(), "wb");
+    fwrite(surface.get_elements(0).data(), sizeof(float),
+           FreezeoutSurface::kNumBaseFields, legacy_file);
+    fclose(legacy_file);
+    CHECK(!FreezeoutSurface::read_file(filename, n_fields_read, elements));
+    MappedSurfaceFile legacy_mapped(filename,
+                                    FreezeoutSurface::kNumBaseFields);
+    CHECK(!legacy_mapped.has_header());
+    REQUIRE(legacy_mapped.get_number_of_elements() == 1);
+    CHECK(legacy_mapped.get_rows()[7] == 7.f);
+    std::remove(filename.c_str());
+}
+
+TEST_CASE("Check FreezeoutSurface field names") {
+    const std::string names = FreezeoutSurface::get_field_names(
+            FreezeoutSurface::kNumBaseFields
+            + FreezeoutSurface::kNumVorticityFields);
+    CHECK(names.compare(0, 10, "tau,x,y,et") == 0);
+    CHECK(names.find(",q_eta,omega_kSP_0,") != std::string::npos);
+    CHECK(names.substr(names.size() - 9) == "omega_T_5");
+}
+
+TEST_CASE("Check FreezeoutSurface hands over the new elements") {
+    const int n_fields = FreezeoutSurface::kNumBaseFields;
+    FreezeoutSurface surface(2, n_fields);
+    std::vector<float> row(n_fields, 1.f);
+    surface.add_element(0, row.data(), n_fields);
+    surface.add_element(1, row.data(), n_fields);
+    std::vector<float> rows;
+    surface.take_new_elements(0, rows);
+    CHECK(rows.size() == static_cast<size_t>(n_fields));
+    surface.take_new_elements(0, rows);
+    CHECK(rows.empty());
+
+    // the taken elements are not kept, the others are merged as before
+    row[0] = 2.f;
+    surface.add_element(0, row.data(), n_fields);
+    surface.merge();
+    CHECK(surface.get_number_of_elements(0) == 1);
+    CHECK(surface.get_elements(0)[0] == 2.f);
+    CHECK(surface.get_number_of_elements(1) == 1);
+}
@@ -0,0 +1,72 @@
+#ifndef SRC_GAUSS_LEGENDRE_H_
+#define SRC_GAUSS_LEGENDRE_H_
+
+//! This class applies a Gauss-Legendre rule of n (even) points, given by its
+//! n/2 positive nodes p and their weights w on [-1, 1], to callables. The
+//! nodes come in the pairs x_offset +- x_half_width*p_i, and the values of
+//! a pair are summed before they are weighted, as in the gauss() of azhydro,
+//! so the integral is the same whether the nodes are evaluated one at a
+//! time or all at once as a batch.
+class GaussLegendre {
+ private:
+    const int n_;
+    const double *p_;
+    const double *w_;
+
+ public:
+    //! the largest rule the batches have room for
+    static const int max_nodes = 48;
+
+    GaussLegendre(const int n, const double *p, const double *w)
+        : n_(n), p_(p), w_(w) {}
+
+    int get_number_of_nodes() const {return(n_);}
+
+    //! fills x[0, n) with the nodes of [xlo, xhi], x[2i] and x[2i + 1] the
+    //! pair of p_i
+    void get_nodes(const double xlo, const double xhi, double *x) const {
+        const double x_offset = 0.5*(xlo + xhi);
+        const double x_half_width = 0.5*(xhi - xlo);
+        for (int i = 0; i < n_/2; i++) {
+            x[2*i] = x_offset + x_half_width*p_[i];
+            x[2*i + 1] = x_offset - x_half_width*p_[i];
+        }
+    }
+
+    //! the integral over [xlo, xhi] from the values f[0, n) at the nodes
+    //! of get_nodes
+    double sum(const double xlo, const double xhi, const double *f) const {
+        const double x_half_width = 0.5*(xhi - xlo);
+        double s = 0.;
+        for (int i = 0; i < n_/2; i++) {
+            s += w_[i]*(f[2*i] + f[2*i + 1]);
+        }
+        return(s*x_half_width);
+    }
+
+    //! integrates f(x) over [xlo, xhi], one node at a time
+    template <typename Function>
+    double integrate(Function &&f, const double xlo, const double xhi) const {
+        double x[max_nodes];
+        double values[max_nodes];
+        get_nodes(xlo, xhi, x);
+        for (int i = 0; i < n_; i++) {
+            values[i] = f(x[i]);
+        }
+        return(sum(xlo, xhi, values));
+    }
+
+    //! integrates over [xlo, xhi] with f(x, n, values) filling values[0, n)
+    //! at all the nodes x[0, n) at once
+    template <typename BatchFunction>
+    double integrate_batch(BatchFunction &&f, const double xlo,
+                           const double xhi) const {
+        double x[max_nodes];
+        double values[max_nodes];
+        get_nodes(xlo, xhi, x);
+        f(x, n_, values);
+        return(sum(xlo, xhi, values));
+    }
+};
+
+#endif  // SRC_GAUSS_LEGENDRE_H_
@@ -0,0 +1,50 @@
+#include <cmath>
+#include "doctest.h"
+#include "gauss_legendre.h"
+
+namespace {
+    // the 4-point rule of int.h
+    double gaulep4[] = {0.8611363115, 0.3399810435};
+    double gaulew4[] = {0.3478548451, 0.6521451548};
+}
+
+TEST_CASE("Check GaussLegendre integrates polynomials of degree 2n - 1") {
+    GaussLegendre rule(4, gaulep4, gaulew4);
+    const auto f = [](const double x) {
+        return(1. - 2.*x + 3.*x*x*x - 0.5*x*x*x*x*x*x*x);
+    };
+    // the primitive of f
+    const auto F = [](const double x) {
+        return(x - x*x + 0.75*x*x*x*x - x*x*x*x*x*x*x*x/16.);
+    };
+    CHECK(rule.integrate(f, -0.5, 1.5)
+          == doctest::Approx(F(1.5) - F(-0.5)).epsilon(1e-8));
+}
+
+TEST_CASE("Check GaussLegendre batches sum the pairs as one node at a time") {
+    GaussLegendre rule(4, gaulep4, gaulew4);
+    const auto f = [](const double x) {return(exp(-x)*cos(3.*x));};
+    const double xlo = 0.2;
+    const double xhi = 2.9;
+
+    // the pair sum of the gauss() of azhydro
+    const double xoffs = 0.5*(xlo + xhi);
+    const double xdiff = 0.5*(xhi - xlo);
+    double s = 0.;
+    for (int ix = 0; ix < 2; ix++) {
+        s += gaulew4[ix]*(f(xoffs + xdiff*gaulep4[ix])
+                          + f(xoffs - xdiff*gaulep4[ix]));
+    }
+    const double reference = s*xdiff;
+
+    CHECK(rule.integrate(f, xlo, xhi) == reference);
+    const auto f_batch = [&](const double *x, const int n, double *values) {
+        for (int i = 0; i < n; i++) values[i] = f(x[i]);
+    };
+    CHECK(rule.integrate_batch(f_batch, xlo, xhi) == reference);
+
+    double x[4], values[4];
+    rule.get_nodes(xlo, xhi, x);
+    for (int i = 0; i < 4; i++) values[i] = f(x[i]);
+    CHECK(rule.sum(xlo, xhi, values) == reference);
+}
@@ -2,21 +2,93 @@
 #define _SRC_GRID_H_
 
 #include <cassert>
+#include <new>
 #include <vector>
 #include "cell.h"
 #include "grid.h"
+#include "grid_memory.h"
 
-template<class T>
+//! boundary policies for the ghost cells of a padded GridT. source(i, n)
+//! returns the interior index in [0, n) a ghost cell at i is copied from.
+
+//! copy the nearest interior cell (zero-gradient outflow)
+struct CopyBoundary {
+    static int source(const int i, const int n) {
+        return(i < 0 ? 0 : (i >= n ? n - 1 : i));
+    }
+};
+
+//! wrap around the grid
+struct PeriodicBoundary {
+    static int source(const int i, const int n) {
+        return(((i % n) + n) % n);
+    }
+};
+
+//! boundary policy for each direction of a padded GridT
+template<class BoundaryX, class BoundaryY, class BoundaryEta>
+struct GridBoundary {
+    typedef BoundaryX   X;
+    typedef BoundaryY   Y;
+    typedef BoundaryEta Eta;
+};
+
+typedef GridBoundary<CopyBoundary, CopyBoundary, CopyBoundary>
+        OutflowGridBoundary;
+typedef GridBoundary<CopyBoundary, CopyBoundary, PeriodicBoundary>
+        PeriodicEtaGridBoundary;
+
+
+//! Ghost = 0: getHalo clamps the indices to the grid.
+//! Ghost = 2: the grid carries 2 layers of ghost cells in every direction,
+//!            which fill_ghost_cells() sets once per Runge-Kutta stage, so
+//!            getHalo is a plain strided access.
+template<class T, int Ghost = 0>
 class GridT {
+    static_assert(Ghost == 0 || Ghost >= 2,
+                  "GridT needs at least 2 ghost cells for the KT stencil");
+
  private:
-    std::vector<T> grid;
+    //! 64-byte aligned storage, constructed by first_touch (see GridMemory)
+    std::vector<T, GridAllocator<T>> grid;
 
     int Nx   = 0;
     int Ny   = 0;
     int Neta = 0;
 
+    int index(int x, int y, int eta) const {
+        return (Nx + 2*Ghost)*((Ny + 2*Ghost)*(eta + Ghost) + y + Ghost)
+               + x + Ghost;
+    }
+
+    int flat_index(const int i) const {
+        if (Ghost == 0) return i;
+        return index(i%Nx, (i/Nx)%Ny, i/(Nx*Ny));
+    }
+
     T& get(int x, int y, int eta) {
-        return grid[Nx*(Ny*eta+y)+x];
+        return grid[index(x, y, eta)];
+    }
+
+    const T& get(int x, int y, int eta) const {
+        return grid[index(x, y, eta)];
+    }
+
+    //! constructs the cells of the storage. With grid_first_touch the
+    //! (x) rows in storage order are split over the threads in the static
+    //! partition of the loops over (eta, y) rows (grid_traversal = 2), so
+    //! the pages are placed on the NUMA node of the thread updating them.
+    void first_touch() {
+        const int row_size = Nx + 2*Ghost;
+        const int n_rows   = (Ny + 2*Ghost)*(Neta + 2*Ghost);
+        T *data = grid.data();
+        #pragma omp parallel for schedule(static) \
+                if (GridMemory::get_first_touch())
+        for (int row = 0; row < n_rows; row++) {
+            for (int x = 0; x < row_size; x++) {
+                ::new(static_cast<void*>(data + row*row_size + x)) T();
+            }
+        }
     }
 
  public:
@@ -25,7 +97,8 @@ class GridT {
         Nx   = Nx0  ;
         Ny   = Ny0  ;
         Neta = Neta0;
-        grid.resize(Nx*Ny*Neta);
+        grid.resize((Nx + 2*Ghost)*(Ny + 2*Ghost)*(Neta + 2*Ghost));
+        first_touch();
     }
 
     int nX()   const {return(Nx );  }
@@ -37,14 +110,16 @@ class GridT {
         assert(-2<=x  ); assert(x  <Nx  +2);
         assert(-2<=y  ); assert(y  <Ny  +2);
         assert(-2<=eta); assert(eta<Neta+2);
-        if(x  <0)   x  =0;  else if(x  >=Nx)   x  = Nx   - 1;
-        if(y  <0)   y  =0;  else if(y  >=Ny)   y  = Ny   - 1;
-        if(eta<0)   eta=0;  else if(eta>=Neta) eta= Neta - 1;
+        if (Ghost == 0) {
+            if(x  <0)   x  =0;  else if(x  >=Nx)   x  = Nx   - 1;
+            if(y  <0)   y  =0;  else if(y  >=Ny)   y  = Ny   - 1;
+            if(eta<0)   eta=0;  else if(eta>=Neta) eta= Neta - 1;
+        }
         return get(x,y,eta);
     }
 
     const T& getHalo(int x, int y, int eta) const {
-        return getHalo(x, y, eta);
+        return const_cast<GridT*>(this)->getHalo(x, y, eta);
     }
 
     T& operator()(const int x, const int y, const int eta) {
@@ -61,14 +136,63 @@ class GridT {
         return get(x, y, eta);
     }
 
+    //! the i-th cell of the interior
     T& operator()(const int i) {
         assert(0<=i  ); assert(i<Nx*Ny*Neta);
-        return grid[i];
+        return grid[flat_index(i)];
     }
 
     const T& operator()(const int i) const {
         assert(0<=i  ); assert(i<Nx*Ny*Neta);
-        return grid[i];
+        return grid[flat_index(i)];
+    }
+
+    //! copy the interior cells from a grid of the same size
+    template<int GhostIn>
+    void copy_interior(const GridT<T, GhostIn> &arena) {
+        assert(arena.nX() == Nx && arena.nY() == Ny && arena.nEta() == Neta);
+        #pragma omp parallel for collapse(2)
+        for (int eta = 0; eta < Neta; eta++)
+        for (int y   = 0; y   < Ny;   y++  )
+        for (int x   = 0; x   < Nx;   x++  ) {
+            get(x, y, eta) = arena(x, y, eta);
+        }
+    }
+
+    //! this function sets the ghost cells from the interior with the
+    //! boundary policy Boundary (see GridBoundary)
+    template<class Boundary>
+    void fill_ghost_cells() {
+        if (Ghost == 0) return;
+        // the ghost cells in eta first, then y and x including the corners
+        // of the layers filled before
+        #pragma omp parallel for collapse(2)
+        for (int eta = -Ghost; eta < Neta + Ghost; eta++)
+        for (int y   = 0;      y   < Ny;           y++  ) {
+            if (eta >= 0 && eta < Neta) continue;
+            const int eta_src = Boundary::Eta::source(eta, Neta);
+            for (int x = 0; x < Nx; x++) {
+                get(x, y, eta) = get(x, y, eta_src);
+            }
+        }
+        #pragma omp parallel for
+        for (int eta = -Ghost; eta < Neta + Ghost; eta++)
+        for (int y   = -Ghost; y   < Ny   + Ghost; y++  ) {
+            if (y >= 0 && y < Ny) continue;
+            const int y_src = Boundary::Y::source(y, Ny);
+            for (int x = 0; x < Nx; x++) {
+                get(x, y, eta) = get(x, y_src, eta);
+            }
+        }
+        #pragma omp parallel for
+        for (int eta = -Ghost; eta < Neta + Ghost; eta++)
+        for (int y   = -Ghost; y   < Ny   + Ghost; y++  ) {
+            for (int x = 1; x <= Ghost; x++) {
+                get(-x, y, eta) = get(Boundary::X::source(-x, Nx), y, eta);
+                get(Nx - 1 + x, y, eta) = (
+                        get(Boundary::X::source(Nx - 1 + x, Nx), y, eta));
+            }
+        }
     }
 
     void clear() {
@@ -78,13 +202,29 @@ class GridT {
 };
 
 typedef GridT<Cell_small> SCGrid;
+typedef GridT<Cell_thermo> ThermoGrid;
+typedef GridT<Cell_small, 2> PaddedSCGrid;
+typedef GridT<Cell_thermo, 2> PaddedThermoGrid;
+typedef GridT<TJbVec> FaceFluxGrid;
+//! the source terms tau*(J^mu, rho_B) of a Runge-Kutta stage
+typedef GridT<TJbVec> SourceGrid;
+typedef GridT<Cell_aux> VorticityGrid;
+//! the velocity gradients of a Runge-Kutta stage (see UDerivativeRows)
+typedef GridT<Cell_gradients> GradientGrid;
+//! the eigenvalues of pi^mu_nu of the cells of a SCGrid (see Advance)
+typedef GridT<LambdaVec> LambdaGrid;
 
-template<class T, class Func>
-void Neighbourloop(GridT<T> &arena, int cx, int cy, int ceta, Func func) {
+//! loop over the 3 directions and pass the cell (cx, cy, ceta) and
+//! its 4 neighbours along each direction to func.
+//! Works with any grid type with operator() and getHalo
+//! (GridT of any padding, SCGridSoA).
+//! With n_directions = 2 only x and y are visited, see Neighbourloop2D
+template<int n_directions = 3, class Grid, class Func>
+void Neighbourloop(Grid &arena, int cx, int cy, int ceta, Func func) {
     const std::array<int, 6> dx   = {-1, 1,  0, 0,  0, 0};
     const std::array<int, 6> dy   = { 0, 0, -1, 1,  0, 0};
     const std::array<int, 6> deta = { 0, 0,  0, 0, -1, 1};
-    for(int dir = 0; dir < 3; dir++) {
+    for(int dir = 0; dir < n_directions; dir++) {
         const int m1nx   = dx  [2*dir];
         const int m1ny   = dy  [2*dir];
         const int m1neta = deta[2*dir];
@@ -97,7 +237,7 @@ void Neighbourloop(GridT<T> &arena, int cx, int cy, int ceta, Func func) {
         const int p2nx   = 2*p1nx;
         const int p2ny   = 2*p1ny;
         const int p2neta = 2*p1neta;
-              auto&  c   = arena        (cx,      cy,      ceta       );
+              auto&& c   = arena        (cx,      cy,      ceta       );
         const auto& p1   = arena.getHalo(cx+p1nx, cy+p1ny, ceta+p1neta);
         const auto& p2   = arena.getHalo(cx+p2nx, cy+p2ny, ceta+p2neta);
         const auto& m1   = arena.getHalo(cx+m1nx, cy+m1ny, ceta+m1neta);
@@ -108,4 +248,59 @@ void Neighbourloop(GridT<T> &arena, int cx, int cy, int ceta, Func func) {
 
 #define NLAMBDAS [&](Cell_small& c, const Cell_small& p1, const Cell_small& p2, const Cell_small& m1, const Cell_small& m2, const int direction) 
 
+//! same as above, but also passes the neighbouring cells of a companion grid
+template<int n_directions = 3, class Grid, class Aux, class Func>
+void Neighbourloop(Grid &arena, Aux &aux,
+                   int cx, int cy, int ceta, Func func) {
+    const std::array<int, 6> dx   = {-1, 1,  0, 0,  0, 0};
+    const std::array<int, 6> dy   = { 0, 0, -1, 1,  0, 0};
+    const std::array<int, 6> deta = { 0, 0,  0, 0, -1, 1};
+    for(int dir = 0; dir < n_directions; dir++) {
+        const int m1nx   = dx  [2*dir];
+        const int m1ny   = dy  [2*dir];
+        const int m1neta = deta[2*dir];
+        const int p1nx   = dx  [2*dir+1];
+        const int p1ny   = dy  [2*dir+1];
+        const int p1neta = deta[2*dir+1];
+        const int m2nx   = 2*m1nx;
+        const int m2ny   = 2*m1ny;
+        const int m2neta = 2*m1neta;
+        const int p2nx   = 2*p1nx;
+        const int p2ny   = 2*p1ny;
+        const int p2neta = 2*p1neta;
+              auto&& c   = arena        (cx,      cy,      ceta       );
+        const auto& p1   = arena.getHalo(cx+p1nx, cy+p1ny, ceta+p1neta);
+        const auto& p2   = arena.getHalo(cx+p2nx, cy+p2ny, ceta+p2neta);
+        const auto& m1   = arena.getHalo(cx+m1nx, cy+m1ny, ceta+m1neta);
+        const auto& m2   = arena.getHalo(cx+m2nx, cy+m2ny, ceta+m2neta);
+        const auto& ac   = aux          (cx,      cy,      ceta       );
+        const auto& ap1  = aux.getHalo  (cx+p1nx, cy+p1ny, ceta+p1neta);
+        const auto& ap2  = aux.getHalo  (cx+p2nx, cy+p2ny, ceta+p2neta);
+        const auto& am1  = aux.getHalo  (cx+m1nx, cy+m1ny, ceta+m1neta);
+        const auto& am2  = aux.getHalo  (cx+m2nx, cy+m2ny, ceta+m2neta);
+        func(c,p1,p2,m1,m2,ac,ap1,ap2,am1,am2,dir+1);
+    }
+}
+
+//! the transverse directions only, for the single eta slice of a
+//! boost-invariant run. There the eta neighbours are the cell itself, so
+//! the KT fluxes through the two eta faces cancel and the kernels add the
+//! geometric terms of the Bjorken expansion from the cell directly.
+template<class Grid, class Func>
+void Neighbourloop2D(Grid &arena, int cx, int cy, int ceta, Func func) {
+    Neighbourloop<2>(arena, cx, cy, ceta, func);
+}
+
+template<class Grid, class Aux, class Func>
+void Neighbourloop2D(Grid &arena, Aux &aux,
+                     int cx, int cy, int ceta, Func func) {
+    Neighbourloop<2>(arena, aux, cx, cy, ceta, func);
+}
+
+//! generic stencil lambdas for code shared between SCGrid and SCGridSoA
+#define NLAMBDAS_GENERIC [&](auto& c, const auto& p1, const auto& p2, const auto& m1, const auto& m2, const int direction)
+#define NLAMBDAS_THERMO_GENERIC [&](auto& c, const auto& p1, const auto& p2, const auto& m1, const auto& m2, const Cell_thermo& tc, const Cell_thermo& tp1, const Cell_thermo& tp2, const Cell_thermo& tm1, const Cell_thermo& tm2, const int direction)
+
+#define NLAMBDAS_THERMO [&](Cell_small& c, const Cell_small& p1, const Cell_small& p2, const Cell_small& m1, const Cell_small& m2, const Cell_thermo& tc, const Cell_thermo& tp1, const Cell_thermo& tp2, const Cell_thermo& tm1, const Cell_thermo& tm2, const int direction)
+
 #endif
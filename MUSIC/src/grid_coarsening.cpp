@@ -0,0 +1,112 @@
+// restriction of the transverse plane to half the resolution, see
+// GridCoarsening
+
+#include <algorithm>
+#include <cmath>
+
+#include "grid_coarsening.h"
+
+GridCoarsening::GridCoarsening(const InitData &DATA_in, const EOS &eos_in)
+    : DATA(DATA_in), eos(eos_in),
+      reconst_helper(eos_in, DATA_in.echo_level) {}
+
+
+double GridCoarsening::get_gradient_indicator(const SCGrid &arena) {
+    const int nx   = arena.nX();
+    const int ny   = arena.nY();
+    const int neta = arena.nEta();
+    double e_max  = 0.;
+    double de_max = 0.;
+    #pragma omp parallel for collapse(3) reduction(max: e_max, de_max)
+    for (int ieta = 0; ieta < neta; ieta++)
+    for (int iy = 0; iy < ny; iy++)
+    for (int ix = 0; ix < nx; ix++) {
+        e_max = std::max(e_max, arena(ix, iy, ieta).epsilon);
+        if (ix > 0 && ix < nx - 1) {
+            de_max = std::max(de_max,
+                              std::abs(  arena(ix + 1, iy, ieta).epsilon
+                                       - arena(ix - 1, iy, ieta).epsilon));
+        }
+        if (iy > 0 && iy < ny - 1) {
+            de_max = std::max(de_max,
+                              std::abs(  arena(ix, iy + 1, ieta).epsilon
+                                       - arena(ix, iy - 1, ieta).epsilon));
+        }
+    }
+    if (e_max <= 0.) return(0.);
+    return(de_max/e_max);
+}
+
+
+bool GridCoarsening::can_coarsen(const int nx, const int ny) const {
+    if (nx%2 == 0 || ny%2 == 0) return(false);
+    if ((nx + 1)/2 < min_points || (ny + 1)/2 < min_points) return(false);
+    // the frames of the reduced movie keep the grid of the first frame
+    if (DATA.output_movie_reductions != 0) return(false);
+    const bool evolution_output = (   DATA.outputEvolutionData != 0
+                                   || DATA.output_movie_flag == 1
+                                   || DATA.output_movie_reductions != 0
+                                   || DATA.store_hydro_info_in_memory == 1
+                                   || DATA.output_outofequilibriumsize == 1);
+    if (   evolution_output
+        && (   DATA.output_evolution_every_N_x%2 != 0
+            || DATA.output_evolution_every_N_y%2 != 0)) {
+        return(false);
+    }
+    return(true);
+}
+
+
+void GridCoarsening::restrict_grid(const SCGrid &fine, SCGrid &coarse) {
+    const int nx   = fine.nX();
+    const int ny   = fine.nY();
+    const int neta = fine.nEta();
+    const int nx_coarse = coarse.nX();
+    const int ny_coarse = coarse.nY();
+    // the weights of the fine points 2i - 1, 2i and 2i + 1
+    const double weights[3] = {0.25, 0.5, 0.25};
+    #pragma omp parallel for collapse(3)
+    for (int ieta = 0; ieta < neta; ieta++)
+    for (int iy_c = 0; iy_c < ny_coarse; iy_c++)
+    for (int ix_c = 0; ix_c < nx_coarse; ix_c++) {
+        TJbVec q = {0.};
+        ViscousVec Wmunu = {0.};
+        double pi_b = 0.;
+        for (int j = -1; j <= 1; j++) {
+            const int iy = 2*iy_c + j;
+            if (iy < 0 || iy >= ny) continue;
+            for (int i = -1; i <= 1; i++) {
+                const int ix = 2*ix_c + i;
+                if (ix < 0 || ix >= nx) continue;
+                const double w = weights[j + 1]*weights[i + 1];
+                const Cell_small &cell = fine(ix, iy, ieta);
+                const double pressure = eos.get_pressure(cell.epsilon,
+                                                         cell.rhob);
+                const double enthalpy_u0 = (
+                                    (cell.epsilon + pressure)*cell.u[0]);
+                q[0] += w*(enthalpy_u0*cell.u[0] - pressure);
+                for (int mu = 1; mu < 4; mu++) {
+                    q[mu] += w*enthalpy_u0*cell.u[mu];
+                }
+                q[4] += w*cell.rhob*cell.u[0];
+                for (unsigned int k = 0; k < Wmunu.size(); k++) {
+                    Wmunu[k] += w*cell.Wmunu[k];
+                }
+                pi_b += w*cell.pi_b;
+            }
+        }
+        // the densities are restricted without the factor tau, which the
+        // reconstruction divides out
+        const Cell_small &guess = fine(2*ix_c, 2*iy_c, ieta);
+        const ReconstCell primitive = reconst_helper.ReconstIt_shell(
+                                                            1., q, guess);
+        Cell_small &cell_coarse = coarse(ix_c, iy_c, ieta);
+        cell_coarse.epsilon = primitive.e;
+        cell_coarse.rhob    = primitive.rhob;
+        cell_coarse.u       = primitive.u;
+        for (unsigned int k = 0; k < Wmunu.size(); k++) {
+            cell_coarse.Wmunu[k] = Wmunu[k];
+        }
+        cell_coarse.pi_b = pi_b;
+    }
+}
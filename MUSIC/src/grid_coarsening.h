@@ -0,0 +1,51 @@
+#ifndef SRC_GRID_COARSENING_H_
+#define SRC_GRID_COARSENING_H_
+
+#include "data.h"
+#include "eos.h"
+#include "grid.h"
+#include "reconst.h"
+
+//! This class halves the resolution of the transverse plane once the
+//! gradients of the fluid are resolved on the coarser grid. The grid is
+//! vertex centered, the coarse point (i, j) is the fine point (2i, 2j),
+//! so nx and ny have to be odd and the coarse grid spans the same x_size
+//! and y_size with (nx + 1)/2 points.
+//!
+//! The ideal T^{tau mu} and J^tau are restricted with the full weighting
+//! (1, 2, 1) x (1, 2, 1)/16 of the fine neighbours, with the missing
+//! neighbours beyond the edges taken as vacuum. Every fine cell passes
+//! a total weight 1/4 to the coarse cells of 4 times its volume, so the
+//! sums over the grid of the energy, the momentum and the net baryon number
+//! are the same on both grids. The primitive fields are reconstructed from
+//! the restricted densities, the dissipative fields are restricted with the
+//! same weights.
+class GridCoarsening {
+ private:
+    const InitData &DATA;
+    const EOS &eos;
+    Reconst reconst_helper;
+
+ public:
+    GridCoarsening(const InitData &DATA_in, const EOS &eos_in);
+
+    //! the largest difference of the energy density between the points
+    //! two cells apart in x or y, relative to the largest energy density
+    //! of the grid: the jump between the neighbouring points of the coarse
+    //! grid
+    static double get_gradient_indicator(const SCGrid &arena);
+
+    //! true if the nx*ny plane can be halved: nx and ny odd and at least
+    //! 2*min_points - 1, and the evolution output keeps its lattice, which
+    //! needs even output_evolution_every_N_x and _y
+    bool can_coarsen(const int nx, const int ny) const;
+
+    //! restricts the cells of fine to coarse, a grid of
+    //! (nx + 1)/2*(ny + 1)/2*neta cells
+    void restrict_grid(const SCGrid &fine, SCGrid &coarse);
+
+    //! the smallest number of points of the coarsened directions
+    static constexpr int min_points = 9;
+};
+
+#endif  // SRC_GRID_COARSENING_H_
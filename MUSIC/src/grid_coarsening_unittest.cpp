@@ -0,0 +1,119 @@
+#include <cmath>
+#include "doctest.h"
+#include "eos.h"
+#include "grid_coarsening.h"
+
+namespace {
+    InitData make_test_data() {
+        InitData DATA;
+        DATA.echo_level = 1;
+        DATA.outputEvolutionData = 1;
+        DATA.output_movie_flag = 0;
+        DATA.output_movie_reductions = 0;
+        DATA.store_hydro_info_in_memory = 0;
+        DATA.output_outofequilibriumsize = 0;
+        DATA.output_evolution_every_N_x = 2;
+        DATA.output_evolution_every_N_y = 2;
+        return(DATA);
+    }
+
+    //! the ideal T^{tau mu} and J^tau summed over the cells of arena
+    TJbVec get_total_densities(const EOS &eos, const SCGrid &arena) {
+        TJbVec total = {0.};
+        for (int ieta = 0; ieta < arena.nEta(); ieta++)
+        for (int iy = 0; iy < arena.nY(); iy++)
+        for (int ix = 0; ix < arena.nX(); ix++) {
+            const Cell_small &cell = arena(ix, iy, ieta);
+            const double pressure = eos.get_pressure(cell.epsilon, cell.rhob);
+            const double enthalpy_u0 = (cell.epsilon + pressure)*cell.u[0];
+            total[0] += enthalpy_u0*cell.u[0] - pressure;
+            for (int mu = 1; mu < 4; mu++) {
+                total[mu] += enthalpy_u0*cell.u[mu];
+            }
+            total[4] += cell.rhob*cell.u[0];
+        }
+        return(total);
+    }
+}
+
+TEST_CASE("Check GridCoarsening conserves the densities of the grid") {
+    const InitData DATA = make_test_data();
+    EOS eos_ideal(0);
+    GridCoarsening coarsening(DATA, eos_ideal);
+
+    SCGrid fine(17, 21, 2);
+    for (int ieta = 0; ieta < 2; ieta++)
+    for (int iy = 0; iy < 21; iy++)
+    for (int ix = 0; ix < 17; ix++) {
+        const double x = (ix - 8)*0.5;
+        const double y = (iy - 10)*0.4;
+        Cell_small &cell = fine(ix, iy, ieta);
+        cell.epsilon = 5.*exp(-0.5*(x*x + 2.*y*y)) + 0.1*ieta;
+        cell.rhob = 0.2*cell.epsilon;
+        cell.u[1] = 0.1*x;
+        cell.u[2] = 0.05*y;
+        cell.u[3] = 0.02;
+        cell.u[0] = sqrt(1. + cell.u[1]*cell.u[1] + cell.u[2]*cell.u[2]
+                         + cell.u[3]*cell.u[3]);
+        cell.pi_b = 0.01*cell.epsilon;
+        cell.Wmunu[1] = 0.02*x;
+    }
+    SCGrid coarse(9, 11, 2);
+    coarsening.restrict_grid(fine, coarse);
+
+    // the coarse cells have 4 times the volume of the fine ones
+    const TJbVec total_fine   = get_total_densities(eos_ideal, fine);
+    const TJbVec total_coarse = get_total_densities(eos_ideal, coarse);
+    for (int alpha = 0; alpha < 5; alpha++) {
+        CHECK(4.*total_coarse[alpha]
+              == doctest::Approx(total_fine[alpha]).epsilon(1e-8));
+    }
+    double pi_b_fine = 0., pi_b_coarse = 0.;
+    for (int ieta = 0; ieta < 2; ieta++) {
+        for (int iy = 0; iy < 21; iy++)
+        for (int ix = 0; ix < 17; ix++) pi_b_fine += fine(ix, iy, ieta).pi_b;
+        for (int iy = 0; iy < 11; iy++)
+        for (int ix = 0; ix < 9; ix++) {
+            pi_b_coarse += coarse(ix, iy, ieta).pi_b;
+        }
+    }
+    CHECK(4.*pi_b_coarse == doctest::Approx(pi_b_fine).epsilon(1e-12));
+
+    // the full weighting smooths the peak, which stays at the fine point
+    // below it
+    CHECK(coarse(4, 5, 1).epsilon < fine(8, 10, 1).epsilon);
+    CHECK(coarse(4, 5, 1).epsilon > 0.85*fine(8, 10, 1).epsilon);
+    CHECK(coarse(4, 5, 1).epsilon > coarse(3, 5, 1).epsilon);
+    CHECK(coarse(4, 5, 1).epsilon > coarse(4, 4, 1).epsilon);
+    CHECK(coarse(4, 5, 0).u[1] == doctest::Approx(0.).epsilon(1e-12));
+}
+
+TEST_CASE("Check the GridCoarsening indicator and the allowed grids") {
+    const InitData DATA = make_test_data();
+    EOS eos_ideal(0);
+    GridCoarsening coarsening(DATA, eos_ideal);
+
+    SCGrid arena(17, 17, 1);
+    CHECK(GridCoarsening::get_gradient_indicator(arena) == 0.);
+    for (int iy = 0; iy < 17; iy++)
+    for (int ix = 0; ix < 17; ix++) {
+        arena(ix, iy, 0).epsilon = 1. + 0.01*ix;
+    }
+    arena(3, 5, 0).epsilon = 1.5;
+    // the largest jump is next to the peak, 1.5 - 1.01
+    CHECK(GridCoarsening::get_gradient_indicator(arena)
+          == doctest::Approx(0.49/1.5));
+
+    CHECK(coarsening.can_coarsen(17, 21));
+    CHECK(!coarsening.can_coarsen(18, 21));
+    CHECK(!coarsening.can_coarsen(17, 20));
+    CHECK(!coarsening.can_coarsen(15, 21));
+
+    InitData DATA_odd_output = make_test_data();
+    DATA_odd_output.output_evolution_every_N_x = 3;
+    DATA_odd_output.output_evolution_every_N_y = 3;
+    GridCoarsening coarsening_odd_output(DATA_odd_output, eos_ideal);
+    CHECK(!coarsening_odd_output.can_coarsen(17, 21));
+    DATA_odd_output.outputEvolutionData = 0;
+    CHECK(coarsening_odd_output.can_coarsen(17, 21));
+}
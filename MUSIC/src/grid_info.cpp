@@ -20,7 +20,8 @@ using std::ostringstream;
 Cell_info::Cell_info(const InitData &DATA_in, const EOS &eos_in) :
     DATA(DATA_in),
     eos(eos_in),
-    u_derivative_helper(DATA_in, eos_in) {
+    u_derivative_helper(DATA_in, eos_in),
+    eta_grid_(DATA_in) {
 
     // read in tables for delta f coefficients
     if (DATA.turn_on_diff == 1) {
@@ -33,11 +34,11 @@ Cell_info::Cell_info(const InitData &DATA_in, const EOS &eos_in) :
                         "tables/Coefficients_RTA_diffusion.dat");
         }
     }
-    Pmu_edge_prev = {0.};
-    outflow_flux = {0.};
 }
 
 Cell_info::~Cell_info() {
+    // finish the evolution outputs before the tables they use are freed
+    output_writer_.reset();
     if (DATA.turn_on_diff == 1) {
         if (DATA.deltaf_14moments == 1) {
             for (int i = 0; i < deltaf_coeff_table_14mom_length_T; i++) {
@@ -94,7 +95,8 @@ void Cell_info::Output_hydro_information_header() {
             << DATA.delta_eta*DATA.output_evolution_every_N_eta << ";"
             << endl;
     outfile << "const double MUSIC_dtau = "
-            << DATA.output_evolution_every_N_timesteps*DATA.delta_tau << ";"
+            << DATA.output_evolution_every_N_timesteps*DATA.delta_tau_input
+            << ";"
             << endl;
 
     outfile << "const bool MUSIC_with_shear_viscosity = "
@@ -112,8 +114,193 @@ void Cell_info::Output_hydro_information_header() {
 }
 
 
-//! This function outputs hydro evolution file in binary format
+void Cell_info::output_eta_grid() const {
+    ofstream outfile("eta_grid.dat");
+    outfile << "# ieta  eta_s  delta_eta_s" << endl;
+    // the getters take the local indices of the slab of the rank
+    for (int ieta = 0; ieta < DATA.neta; ieta++) {
+        const int ieta_local = ieta - DATA.eta_index_offset;
+        outfile << ieta << "  " << scientific << setprecision(12)
+                << eta_grid_.get_eta(ieta_local) << "  "
+                << eta_grid_.get_width(ieta_local) << endl;
+    }
+    outfile.close();
+}
+
+
 void Cell_info::OutputEvolutionDataXYEta(SCGrid &arena, double tau) {
+    submit_evolution_output(arena, nullptr, tau,
+                            &Cell_info::write_evolution_xyeta);
+}
+
+
+void Cell_info::OutputEvolutionDataXYEta_chun(SCGrid &arena, double tau) {
+    submit_evolution_output(arena, nullptr, tau,
+                            &Cell_info::write_evolution_xyeta_chun);
+}
+
+
+void Cell_info::OutputEvolutionDataXYEta_photon(SCGrid &arena, double tau) {
+    submit_evolution_output(arena, nullptr, tau,
+                            &Cell_info::write_evolution_xyeta_photon);
+}
+
+
+void Cell_info::OutputEvolutionDataXYEta_vorticity(
+        SCGrid &arena_curr, const VorticityGrid &vorticity, double tau) {
+    submit_evolution_output(arena_curr, &vorticity, tau,
+                            &Cell_info::write_evolution_xyeta_vorticity);
+}
+
+
+void Cell_info::output_evolution_for_movie(SCGrid &arena, const double tau) {
+    submit_evolution_output(arena, nullptr, tau,
+                            &Cell_info::write_evolution_for_movie);
+}
+
+
+void Cell_info::OutputEvolutionDataXYEta_chunked(SCGrid &arena, double tau) {
+    submit_evolution_output(arena, nullptr, tau,
+                            &Cell_info::write_evolution_xyeta_chunked);
+}
+
+
+void Cell_info::output_reduced_movie(const SCGrid &arena, const double tau) {
+    if (movie_reduction_ == nullptr) {
+        movie_reduction_.reset(new MovieReduction(DATA, eos));
+    }
+    movie_reduction_->write_frames(arena, tau);
+}
+
+
+void Cell_info::OutputEvolutionDataXYEta_sparse(SCGrid &arena, double tau) {
+    submit_sparse_evolution_output(arena, tau,
+                                   &Cell_info::write_evolution_xyeta_sparse);
+}
+
+
+void Cell_info::flush_evolution_output() {
+    if (output_writer_ != nullptr) {
+        output_writer_->flush();
+    }
+    chunked_file_.reset();
+    sparse_file_.reset();
+    if (movie_reduction_ != nullptr) movie_reduction_->close();
+}
+
+
+//! This function copies the output cells of the grid into the snapshot
+//! and hands it to the output writer, which calls write with it
+void Cell_info::submit_evolution_output(
+        SCGrid &arena, const VorticityGrid *vorticity, const double tau,
+        void (Cell_info::*write)(const EvolutionSnapshot &)) {
+    if (output_writer_ == nullptr) {
+        output_writer_.reset(
+                new EvolutionOutputWriter(DATA.output_evolution_buffers));
+    }
+    std::unique_ptr<EvolutionSnapshot> snapshot = (
+                                            output_writer_->get_buffer());
+    const int n_skip_x   = DATA.output_evolution_every_N_x;
+    const int n_skip_y   = DATA.output_evolution_every_N_y;
+    const int n_skip_eta = DATA.output_evolution_every_N_eta;
+    const int n_out_x    = (arena.nX() + n_skip_x - 1)/n_skip_x;
+    const int n_out_y    = (arena.nY() + n_skip_y - 1)/n_skip_y;
+    const int n_out_eta  = (arena.nEta() + n_skip_eta - 1)/n_skip_eta;
+    const size_t n_cells = static_cast<size_t>(n_out_x)*n_out_y*n_out_eta;
+    snapshot->tau  = tau;
+    snapshot->nx   = arena.nX();
+    snapshot->ny   = arena.nY();
+    snapshot->neta = arena.nEta();
+    snapshot->cells.resize(n_cells);
+    snapshot->vorticity.resize(vorticity != nullptr ? n_cells : 0);
+    snapshot->points.clear();
+    #pragma omp parallel for collapse(2)
+    for (int jeta = 0; jeta < n_out_eta; jeta++)
+    for (int jy = 0; jy < n_out_y; jy++) {
+        const size_t i_row = (static_cast<size_t>(jeta)*n_out_y + jy)*n_out_x;
+        for (int jx = 0; jx < n_out_x; jx++) {
+            snapshot->cells[i_row + jx] = arena(
+                    jx*n_skip_x, jy*n_skip_y, jeta*n_skip_eta);
+            if (vorticity != nullptr) {
+                snapshot->vorticity[i_row + jx] = (*vorticity)(
+                    jx*n_skip_x, jy*n_skip_y, jeta*n_skip_eta);
+            }
+        }
+    }
+    output_writer_->submit(std::move(snapshot),
+                           [this, write](const EvolutionSnapshot &cells) {
+                               (this->*write)(cells);
+                           });
+}
+
+
+//! This function copies the output cells of the grid with e above
+//! output_evolution_e_cut into the snapshot and hands it to the output
+//! writer. The rows of output points are counted and then copied in
+//! parallel, each to its offset in the snapshot.
+void Cell_info::submit_sparse_evolution_output(
+        SCGrid &arena, const double tau,
+        void (Cell_info::*write)(const EvolutionSnapshot &)) {
+    if (output_writer_ == nullptr) {
+        output_writer_.reset(
+                new EvolutionOutputWriter(DATA.output_evolution_buffers));
+    }
+    std::unique_ptr<EvolutionSnapshot> snapshot = (
+                                            output_writer_->get_buffer());
+    const int n_skip_x   = DATA.output_evolution_every_N_x;
+    const int n_skip_y   = DATA.output_evolution_every_N_y;
+    const int n_skip_eta = DATA.output_evolution_every_N_eta;
+    const int n_out_x    = (arena.nX() + n_skip_x - 1)/n_skip_x;
+    const int n_out_y    = (arena.nY() + n_skip_y - 1)/n_skip_y;
+    const int n_out_eta  = (arena.nEta() + n_skip_eta - 1)/n_skip_eta;
+    const int n_rows     = n_out_y*n_out_eta;
+    const double e_cut   = DATA.output_evolution_e_cut;  // GeV/fm^3
+    snapshot->tau  = tau;
+    snapshot->nx   = arena.nX();
+    snapshot->ny   = arena.nY();
+    snapshot->neta = arena.nEta();
+    snapshot->vorticity.clear();
+
+    std::vector<size_t> row_begin(n_rows + 1, 0);
+    #pragma omp parallel for collapse(2)
+    for (int jeta = 0; jeta < n_out_eta; jeta++)
+    for (int jy = 0; jy < n_out_y; jy++) {
+        size_t n_above = 0;
+        for (int jx = 0; jx < n_out_x; jx++) {
+            n_above += !(arena(jx*n_skip_x, jy*n_skip_y,
+                               jeta*n_skip_eta).epsilon*hbarc < e_cut);
+        }
+        row_begin[jeta*n_out_y + jy + 1] = n_above;
+    }
+    for (int i = 0; i < n_rows; i++) row_begin[i + 1] += row_begin[i];
+    snapshot->cells.resize(row_begin[n_rows]);
+    snapshot->points.resize(row_begin[n_rows]);
+    #pragma omp parallel for collapse(2)
+    for (int jeta = 0; jeta < n_out_eta; jeta++)
+    for (int jy = 0; jy < n_out_y; jy++) {
+        const int i_row = jeta*n_out_y + jy;
+        size_t i_cell = row_begin[i_row];
+        for (int jx = 0; jx < n_out_x; jx++) {
+            const Cell_small &cell = arena(jx*n_skip_x, jy*n_skip_y,
+                                           jeta*n_skip_eta);
+            if (cell.epsilon*hbarc < e_cut) continue;
+            snapshot->cells[i_cell] = cell;
+            snapshot->points[i_cell] = static_cast<uint32_t>(
+                                    static_cast<size_t>(i_row)*n_out_x + jx);
+            i_cell++;
+        }
+    }
+    output_writer_->submit(std::move(snapshot),
+                           [this, write](const EvolutionSnapshot &cells) {
+                               (this->*write)(cells);
+                           });
+}
+
+
+//! This function outputs hydro evolution file in binary format
+void Cell_info::write_evolution_xyeta(
+        const EvolutionSnapshot &snapshot) {
+    const double tau = snapshot.tau;
     const string out_name_xyeta = "evolution_xyeta.dat";
     const string out_name_W_xyeta =
                         "evolution_Wmunu_over_epsilon_plus_P_xyeta.dat";
@@ -151,32 +338,36 @@ void Cell_info::OutputEvolutionDataXYEta(SCGrid &arena, double tau) {
     const int n_skip_x   = DATA.output_evolution_every_N_x;
     const int n_skip_y   = DATA.output_evolution_every_N_y;
     const int n_skip_eta = DATA.output_evolution_every_N_eta;
-    for (int ieta = 0; ieta < arena.nEta(); ieta += n_skip_eta) {
+    size_t i_cell = 0;
+    for (int ieta = 0; ieta < snapshot.neta; ieta += n_skip_eta) {
         double eta = 0.0;
         if (!DATA.boost_invariant) {
-            eta = ((static_cast<double>(ieta))*(DATA.delta_eta)
-                    - (DATA.eta_size)/2.0);
+            eta = eta_grid_.get_eta(ieta);
         }
         double cosh_eta = cosh(eta);
         double sinh_eta = sinh(eta);
-        for (int iy = 0; iy < arena.nY(); iy += n_skip_y) {
-            for (int ix = 0; ix < arena.nX(); ix += n_skip_x) {
-                double e_local    = arena(ix, iy, ieta).epsilon;  // 1/fm^4
-                double rhob_local = arena(ix, iy, ieta).rhob;     // 1/fm^3
-                double p_local = eos.get_pressure(e_local, rhob_local);
-                double utau = arena(ix, iy, ieta).u[0];
-                double ux   = arena(ix, iy, ieta).u[1];
-                double uy   = arena(ix, iy, ieta).u[2];
-                double ueta = arena(ix, iy, ieta).u[3];
+        for (int iy = 0; iy < snapshot.ny; iy += n_skip_y) {
+            for (int ix = 0; ix < snapshot.nx; ix += n_skip_x) {
+                const Cell_small &cell = snapshot.cells[i_cell];
+                i_cell++;
+                double e_local    = cell.epsilon;  // 1/fm^4
+                double rhob_local = cell.rhob;     // 1/fm^3
+                const ThermoState thermo = eos.get_thermo(e_local,
+                                                          rhob_local);
+                double p_local = thermo.pressure;
+                double utau = cell.u[0];
+                double ux   = cell.u[1];
+                double uy   = cell.u[2];
+                double ueta = cell.u[3];
                 double ut = utau*cosh_eta + ueta*sinh_eta;  // gamma factor
                 double vx = ux/ut;
                 double vy = uy/ut;
                 double uz = ueta*cosh_eta + utau*sinh_eta;
                 double vz = uz/ut;
 
-                double T_local   = eos.get_temperature(e_local, rhob_local);
-                double cs2_local = eos.get_cs2(e_local, rhob_local);
-                double muB_local = eos.get_muB(e_local, rhob_local);
+                double T_local   = thermo.temperature;
+                double cs2_local = thermo.cs2;
+                double muB_local = thermo.muB;
                 double enthropy  = e_local + p_local;  // [1/fm^4]
 
                 double Wtautau = 0.0;
@@ -190,21 +381,21 @@ void Cell_info::OutputEvolutionDataXYEta(SCGrid &arena, double tau) {
                 double Wyeta   = 0.0;
                 double Wetaeta = 0.0;
                 if (DATA.turn_on_shear == 1) {
-                    Wtautau = arena(ix, iy, ieta).Wmunu[0]/enthropy;
-                    Wtaux   = arena(ix, iy, ieta).Wmunu[1]/enthropy;
-                    Wtauy   = arena(ix, iy, ieta).Wmunu[2]/enthropy;
-                    Wtaueta = arena(ix, iy, ieta).Wmunu[3]/enthropy;
-                    Wxx     = arena(ix, iy, ieta).Wmunu[4]/enthropy;
-                    Wxy     = arena(ix, iy, ieta).Wmunu[5]/enthropy;
-                    Wxeta   = arena(ix, iy, ieta).Wmunu[6]/enthropy;
-                    Wyy     = arena(ix, iy, ieta).Wmunu[7]/enthropy;
-                    Wyeta   = arena(ix, iy, ieta).Wmunu[8]/enthropy;
-                    Wetaeta = arena(ix, iy, ieta).Wmunu[9]/enthropy;
+                    Wtautau = cell.Wmunu[0]/enthropy;
+                    Wtaux   = cell.Wmunu[1]/enthropy;
+                    Wtauy   = cell.Wmunu[2]/enthropy;
+                    Wtaueta = cell.Wmunu[3]/enthropy;
+                    Wxx     = cell.Wmunu[4]/enthropy;
+                    Wxy     = cell.Wmunu[5]/enthropy;
+                    Wxeta   = cell.Wmunu[6]/enthropy;
+                    Wyy     = cell.Wmunu[7]/enthropy;
+                    Wyeta   = cell.Wmunu[8]/enthropy;
+                    Wetaeta = cell.Wmunu[9]/enthropy;
                 }
 
                 double bulk_Pi = 0.0;
                 if (DATA.turn_on_bulk == 1) {
-                    bulk_Pi = arena(ix, iy, ieta).pi_b;  // [1/fm^4]
+                    bulk_Pi = cell.pi_b;  // [1/fm^4]
                 }
 
                 // outputs for baryon diffusion part
@@ -217,10 +408,10 @@ void Cell_info::OutputEvolutionDataXYEta(SCGrid &arena, double tau) {
                     common_term_q = rhob_local*T_local/enthropy;
                     double kappa_hat = get_deltaf_qmu_coeff(T_local,
                                                             muB_local);
-                    qtau = arena(ix, iy, ieta).Wmunu[10]/kappa_hat;
-                    qx   = arena(ix, iy, ieta).Wmunu[11]/kappa_hat;
-                    qy   = arena(ix, iy, ieta).Wmunu[12]/kappa_hat;
-                    qeta = arena(ix, iy, ieta).Wmunu[13]/kappa_hat;
+                    qtau = cell.Wmunu[10]/kappa_hat;
+                    qx   = cell.Wmunu[11]/kappa_hat;
+                    qy   = cell.Wmunu[12]/kappa_hat;
+                    qeta = cell.Wmunu[13]/kappa_hat;
                 }
 
                 // exclude the actual coordinates from the output to save space:
@@ -342,12 +533,15 @@ void Cell_info::calculate_inverse_Reynolds_numbers(
                                 SCGrid &arena_current,
                                 const int ieta, const int ix, const int iy,
                                 double &R_pi, double &R_Pi) const {
-    const auto grid_pt = arena_current(ix, iy, ieta);
+    const auto &grid_pt = arena_current(ix, iy, ieta);
+    const double pressure = eos.get_pressure(grid_pt.epsilon, grid_pt.rhob);
+    get_inverse_Reynolds_numbers(grid_pt, pressure, R_pi, R_Pi);
+}
 
-    const double e_local  = grid_pt.epsilon;
-    const double rhob     = grid_pt.rhob;
-    const double pressure = eos.get_pressure(e_local, rhob);
 
+void Cell_info::get_inverse_Reynolds_numbers(
+                    const Cell_small &grid_pt, const double pressure,
+                    double &R_pi, double &R_Pi) {
     const double pi_00 = grid_pt.Wmunu[0];
     const double pi_01 = grid_pt.Wmunu[1];
     const double pi_02 = grid_pt.Wmunu[2];
@@ -377,43 +571,47 @@ void Cell_info::OutputEvolutionDataXYEta_memory(
     const int n_skip_x   = DATA.output_evolution_every_N_x;
     const int n_skip_y   = DATA.output_evolution_every_N_y;
     const int n_skip_eta = DATA.output_evolution_every_N_eta;
-    for (int ix = 0; ix < arena.nX(); ix += n_skip_x) {
-        for (int iy = 0; iy < arena.nY(); iy += n_skip_y) {
-            for (int ieta = 0; ieta < arena.nEta(); ieta += n_skip_eta) {
-                double eta = 0.0;
-                if (!DATA.boost_invariant) {
-                    eta = ((static_cast<double>(ieta))*(DATA.delta_eta)
-                            - (DATA.eta_size)/2.0);
-                }
-                double cosh_eta = cosh(eta);
-                double sinh_eta = sinh(eta);
-
-                double e_local    = arena(ix, iy, ieta).epsilon;  // 1/fm^4
-                double rhob_local = arena(ix, iy, ieta).rhob;     // 1/fm^3
-                double p_local = eos.get_pressure(e_local, rhob_local);
-                double utau = arena(ix, iy, ieta).u[0];
-                double ux   = arena(ix, iy, ieta).u[1];
-                double uy   = arena(ix, iy, ieta).u[2];
-                double ueta = arena(ix, iy, ieta).u[3];
-                double ut = utau*cosh_eta + ueta*sinh_eta;  // gamma factor
-                double vx = ux/ut;
-                double vy = uy/ut;
-                double uz = ueta*cosh_eta + utau*sinh_eta;
-                double vz = uz/ut;
-
-                double T_local   = eos.get_temperature(e_local, rhob_local);
-                double s_local   = eos.get_entropy(e_local, rhob_local);
-
-                hydro_info_ptr.dump_ideal_info_to_memory(
-                    tau, eta, e_local, p_local, s_local, T_local, vx, vy, vz);
+    const int output_nx   = hydro_info_ptr.get_nx();
+    const int output_ny   = hydro_info_ptr.get_ny();
+    const int output_neta = hydro_info_ptr.get_neta();
+    const int64_t n_cells = hydro_info_ptr.get_number_of_cells_per_tau();
+    std::vector<float> slice(HydroinfoMUSIC::kNumFields*n_cells);
+    #pragma omp parallel for collapse(3)
+    for (int ieta = 0; ieta < output_neta; ieta++) {
+        for (int iy = 0; iy < output_ny; iy++) {
+            for (int ix = 0; ix < output_nx; ix++) {
+                const Cell_small &cell = arena(ix*n_skip_x, iy*n_skip_y,
+                                               ieta*n_skip_eta);
+                const ThermoState thermo = eos.get_thermo(cell.epsilon,
+                                                          cell.rhob);
+                const int64_t i_cell = ix + output_nx*(
+                                static_cast<int64_t>(iy) + output_ny*ieta);
+                float *cell_slice = &slice[i_cell];
+                cell_slice[HydroinfoMUSIC::kEd*n_cells] = static_cast<float>(
+                                                        cell.epsilon*hbarc);
+                cell_slice[HydroinfoMUSIC::kPressure*n_cells] = (
+                        static_cast<float>(thermo.pressure*hbarc));
+                cell_slice[HydroinfoMUSIC::kSd*n_cells] = static_cast<float>(
+                                                        thermo.entropy);
+                cell_slice[HydroinfoMUSIC::kTemperature*n_cells] = (
+                        static_cast<float>(thermo.temperature*hbarc));
+                cell_slice[HydroinfoMUSIC::kUx*n_cells] = static_cast<float>(
+                                                                cell.u[1]);
+                cell_slice[HydroinfoMUSIC::kUy*n_cells] = static_cast<float>(
+                                                                cell.u[2]);
+                cell_slice[HydroinfoMUSIC::kUeta*n_cells] = (
+                                            static_cast<float>(cell.u[3]));
             }
         }
     }
+    hydro_info_ptr.dump_tau_slice_to_memory(tau, slice);
 }
 
 
 //! This function outputs hydro evolution file in binary format
-void Cell_info::OutputEvolutionDataXYEta_chun(SCGrid &arena, double tau) {
+void Cell_info::write_evolution_xyeta_chun(
+        const EvolutionSnapshot &snapshot) {
+    const double tau = snapshot.tau;
     // the format of the file is as follows,
     //    itau ix iy ieta e P T cs^2 ux uy ueta
     // if turn_on_shear == 1:
@@ -443,7 +641,7 @@ void Cell_info::OutputEvolutionDataXYEta_chun(SCGrid &arena, double tau) {
     out_file_xyeta = fopen(out_name_xyeta.c_str(), out_open_mode.c_str());
 
     int n_skip_tau     = DATA.output_evolution_every_N_timesteps;
-    double output_dtau = DATA.delta_tau*n_skip_tau;
+    double output_dtau = DATA.delta_tau_input*n_skip_tau;
     int itau = static_cast<int>((tau - DATA.tau0)/(output_dtau) + 0.1);
 
     int n_skip_x       = DATA.output_evolution_every_N_x;
@@ -451,9 +649,9 @@ void Cell_info::OutputEvolutionDataXYEta_chun(SCGrid &arena, double tau) {
     int n_skip_eta     = DATA.output_evolution_every_N_eta;
 
     // write out header
-    const int output_nx        = static_cast<int>(arena.nX()/n_skip_x);
-    const int output_ny        = static_cast<int>(arena.nY()/n_skip_y);
-    const int output_neta      = static_cast<int>(arena.nEta()/n_skip_eta);
+    const int output_nx        = static_cast<int>(snapshot.nx/n_skip_x);
+    const int output_ny        = static_cast<int>(snapshot.ny/n_skip_y);
+    const int output_neta      = static_cast<int>(snapshot.neta/n_skip_eta);
     const double output_dx     = DATA.delta_x*n_skip_x;
     const double output_dy     = DATA.delta_y*n_skip_y;
     const double output_deta   = DATA.delta_eta*n_skip_eta;
@@ -479,36 +677,41 @@ void Cell_info::OutputEvolutionDataXYEta_chun(SCGrid &arena, double tau) {
             static_cast<float>(nVar_per_cell)};
         fwrite(header, sizeof(float), 16, out_file_xyeta);
     }
-    for (int ieta = 0; ieta < arena.nEta(); ieta += n_skip_eta) {
+    size_t i_cell = 0;
+    for (int ieta = 0; ieta < snapshot.neta; ieta += n_skip_eta) {
         double eta_local = - DATA.eta_size/2. + ieta*DATA.delta_eta;
         double cosh_eta = cosh(eta_local);
         double sinh_eta = sinh(eta_local);
-        for (int iy = 0; iy < arena.nY(); iy += n_skip_y) {
-            for (int ix = 0; ix < arena.nX(); ix += n_skip_x) {
-                double e_local    = arena(ix, iy, ieta).epsilon;  // 1/fm^4
-                double rhob_local = arena(ix, iy, ieta).rhob;     // 1/fm^3
+        for (int iy = 0; iy < snapshot.ny; iy += n_skip_y) {
+            for (int ix = 0; ix < snapshot.nx; ix += n_skip_x) {
+                const Cell_small &cell = snapshot.cells[i_cell];
+                i_cell++;
+                double e_local    = cell.epsilon;  // 1/fm^4
+                double rhob_local = cell.rhob;     // 1/fm^3
 
                 if (e_local*hbarc < DATA.output_evolution_e_cut) continue;
                 // only ouput fluid cells that are above cut-off temperature
 
-                double p_local    = eos.get_pressure(e_local, rhob_local);
-                double cs2        = eos.get_cs2(e_local, rhob_local);
+                const ThermoState thermo = eos.get_thermo(e_local,
+                                                          rhob_local);
+                double p_local    = thermo.pressure;
+                double cs2        = thermo.cs2;
 
-                double ux = arena(ix, iy, ieta).u[1];
-                double uy = arena(ix, iy, ieta).u[2];
-                double uz = (  arena(ix, iy, ieta).u[3]*cosh_eta
-                             + arena(ix, iy, ieta).u[0]*sinh_eta);
+                double ux = cell.u[1];
+                double uy = cell.u[2];
+                double uz = (  cell.u[3]*cosh_eta
+                             + cell.u[0]*sinh_eta);
 
 
                 // T_local is in 1/fm
-                double T_local = eos.get_temperature(e_local, rhob_local);
+                double T_local = thermo.temperature;
 
                 double muB_local = 0.0;
                 if (DATA.turn_on_rhob == 1)
-                    muB_local = eos.get_muB(e_local, rhob_local);
+                    muB_local = thermo.muB;
 
                 ShearVisVecLRF piLRF;
-                get_LRF_shear_stress_tensor(arena(ix, iy, ieta), eta_local,
+                get_LRF_shear_stress_tensor(cell, eta_local,
                                             piLRF);
                 double div_factor = e_local + p_local;  // 1/fm^4
                 double Wxx = 0.0;
@@ -526,7 +729,7 @@ void Cell_info::OutputEvolutionDataXYEta_chun(SCGrid &arena, double tau) {
 
                 double pi_b = 0.0;
                 if (DATA.turn_on_bulk == 1) {
-                    pi_b = arena(ix, iy, ieta).pi_b/div_factor;
+                    pi_b = cell.pi_b/div_factor;
                 }
 
                 // outputs for baryon diffusion part
@@ -591,7 +794,9 @@ void Cell_info::OutputEvolutionDataXYEta_chun(SCGrid &arena, double tau) {
 
 
 //! This function outputs hydro evolution file in binary format for photon production
-void Cell_info::OutputEvolutionDataXYEta_photon(SCGrid &arena, double tau) {
+void Cell_info::write_evolution_xyeta_photon(
+        const EvolutionSnapshot &snapshot) {
+    const double tau = snapshot.tau;
     // volume = tau*dtau*dx*dy*deta
     // the format of the file is as follows,
     //    volume T ux uy ueta
@@ -623,26 +828,32 @@ void Cell_info::OutputEvolutionDataXYEta_photon(SCGrid &arena, double tau) {
     int n_skip_x = DATA.output_evolution_every_N_x;
     int n_skip_y = DATA.output_evolution_every_N_y;
     int n_skip_eta = DATA.output_evolution_every_N_eta;
-    double dtau = DATA.delta_tau;
+    double dtau = DATA.delta_tau_input;
     double dx = DATA.delta_x;
     double dy = DATA.delta_y;
-    double deta = DATA.delta_eta;
-    double volume = tau*n_skip_tau*dtau*n_skip_x*dx*n_skip_y*dy*n_skip_eta*deta;
 
-    for (int ieta = 0; ieta < arena.nEta(); ieta += n_skip_eta) {
-        double eta_local = - DATA.eta_size/2. + ieta*deta;
-        for (int iy = 0; iy < arena.nY(); iy += n_skip_y) {
-            for (int ix = 0; ix < arena.nX(); ix += n_skip_x) {
-                double e_local = arena(ix, iy, ieta).epsilon;  // 1/fm^4
+    size_t i_cell = 0;
+    for (int ieta = 0; ieta < snapshot.neta; ieta += n_skip_eta) {
+        // the eta width of the slice is the one of its cell, which varies
+        // along a stretched eta grid
+        double deta = eta_grid_.get_width(ieta);
+        double volume = (tau*n_skip_tau*dtau*n_skip_x*dx*n_skip_y*dy
+                         *n_skip_eta*deta);
+        double eta_local = eta_grid_.get_eta(ieta);
+        for (int iy = 0; iy < snapshot.ny; iy += n_skip_y) {
+            for (int ix = 0; ix < snapshot.nx; ix += n_skip_x) {
+                const Cell_small &cell = snapshot.cells[i_cell];
+                i_cell++;
+                double e_local = cell.epsilon;  // 1/fm^4
 
                 if (e_local*hbarc < DATA.output_evolution_e_cut) continue;
                 // only ouput fluid cells that are above cut-off temperature
 
-                double rhob_local = arena(ix, iy, ieta).rhob;  // 1/fm^3
+                double rhob_local = cell.rhob;  // 1/fm^3
 
-                double ux   = arena(ix, iy, ieta).u[1];
-                double uy   = arena(ix, iy, ieta).u[2];
-                double ueta = arena(ix, iy, ieta).u[3];
+                double ux   = cell.u[1];
+                double uy   = cell.u[2];
+                double ueta = cell.u[3];
 
                 // T_local is in 1/fm
                 double T_local = eos.get_temperature(e_local, rhob_local);
@@ -659,16 +870,16 @@ void Cell_info::OutputEvolutionDataXYEta_photon(SCGrid &arena, double tau) {
                 double Wyy = 0.0;
                 double Wyeta = 0.0;
                 if (DATA.turn_on_shear == 1) {
-                    Wxx   = arena(ix, iy, ieta).Wmunu[4]/div_factor;
-                    Wxy   = arena(ix, iy, ieta).Wmunu[5]/div_factor;
-                    Wxeta = arena(ix, iy, ieta).Wmunu[6]/div_factor;
-                    Wyy   = arena(ix, iy, ieta).Wmunu[7]/div_factor;
-                    Wyeta = arena(ix, iy, ieta).Wmunu[8]/div_factor;
+                    Wxx   = cell.Wmunu[4]/div_factor;
+                    Wxy   = cell.Wmunu[5]/div_factor;
+                    Wxeta = cell.Wmunu[6]/div_factor;
+                    Wyy   = cell.Wmunu[7]/div_factor;
+                    Wyeta = cell.Wmunu[8]/div_factor;
                 }
 
                 double pi_b = 0.0;
                 if (DATA.turn_on_bulk == 1) {
-                    pi_b = arena(ix, iy, ieta).pi_b;   // 1/fm^4
+                    pi_b = cell.pi_b;   // 1/fm^4
                 }
 
                 // outputs for baryon diffusion part
@@ -680,9 +891,9 @@ void Cell_info::OutputEvolutionDataXYEta_photon(SCGrid &arena, double tau) {
                     common_term_q = rhob_local*T_local/div_factor;
                     double kappa_hat = get_deltaf_qmu_coeff(T_local,
                                                             muB_local);
-                    qx   = arena(ix, iy, ieta).Wmunu[11]/kappa_hat;
-                    qy   = arena(ix, iy, ieta).Wmunu[12]/kappa_hat;
-                    qeta = arena(ix, iy, ieta).Wmunu[13]/kappa_hat;
+                    qx   = cell.Wmunu[11]/kappa_hat;
+                    qy   = cell.Wmunu[12]/kappa_hat;
+                    qeta = cell.Wmunu[13]/kappa_hat;
                 }
 
                 float ideal[] = {static_cast<float>(volume),
@@ -728,8 +939,9 @@ void Cell_info::OutputEvolutionDataXYEta_photon(SCGrid &arena, double tau) {
 
 
 //! This function outputs hydro evolution file in binary format
-void Cell_info::OutputEvolutionDataXYEta_vorticity(
-        SCGrid &arena_curr, SCGrid &arena_prev, double tau) {
+void Cell_info::write_evolution_xyeta_vorticity(
+        const EvolutionSnapshot &snapshot) {
+    const double tau = snapshot.tau;
     // the format of the file is as follows,
     //    itau ix iy ieta e P T ux uy ueta mu_B
     //    omega^tx omega^ty omega^tz omega^xy omega^xz omega^yz
@@ -745,7 +957,7 @@ void Cell_info::OutputEvolutionDataXYEta_vorticity(
     out_file_xyeta = fopen(out_name_xyeta.c_str(), out_open_mode.c_str());
 
     int n_skip_tau     = DATA.output_evolution_every_N_timesteps;
-    double output_dtau = DATA.delta_tau*n_skip_tau;
+    double output_dtau = DATA.delta_tau_input*n_skip_tau;
     int itau = static_cast<int>((tau - DATA.tau0)/(output_dtau) + 0.1);
 
     int n_skip_x       = DATA.output_evolution_every_N_x;
@@ -753,9 +965,9 @@ void Cell_info::OutputEvolutionDataXYEta_vorticity(
     int n_skip_eta     = DATA.output_evolution_every_N_eta;
 
     // write out header
-    const int output_nx        = static_cast<int>(arena_curr.nX()/n_skip_x);
-    const int output_ny        = static_cast<int>(arena_curr.nY()/n_skip_y);
-    const int output_neta      = static_cast<int>(arena_curr.nEta()/n_skip_eta);
+    const int output_nx        = static_cast<int>(snapshot.nx/n_skip_x);
+    const int output_ny        = static_cast<int>(snapshot.ny/n_skip_y);
+    const int output_neta      = static_cast<int>(snapshot.neta/n_skip_eta);
     const double output_dx     = DATA.delta_x*n_skip_x;
     const double output_dy     = DATA.delta_y*n_skip_y;
     const double output_deta   = DATA.delta_eta*n_skip_eta;
@@ -777,17 +989,21 @@ void Cell_info::OutputEvolutionDataXYEta_vorticity(
             static_cast<float>(nVar_per_cell)};
         fwrite(header, sizeof(float), 12, out_file_xyeta);
     }
-    for (int ieta = 0; ieta < arena_curr.nEta(); ieta += n_skip_eta) {
+    size_t i_cell = 0;
+    for (int ieta = 0; ieta < snapshot.neta; ieta += n_skip_eta) {
         double eta_local = - DATA.eta_size/2. + ieta*DATA.delta_eta;
-        for (int iy = 0; iy < arena_curr.nY(); iy += n_skip_y) {
-            for (int ix = 0; ix < arena_curr.nX(); ix += n_skip_x) {
-                double e_local    = arena_curr(ix, iy, ieta).epsilon;  // 1/fm^4
-                double rhob_local = arena_curr(ix, iy, ieta).rhob;     // 1/fm^3
+        for (int iy = 0; iy < snapshot.ny; iy += n_skip_y) {
+            for (int ix = 0; ix < snapshot.nx; ix += n_skip_x) {
+                const Cell_small &cell = snapshot.cells[i_cell];
+                const Cell_aux &omega_Milne = snapshot.vorticity[i_cell];
+                i_cell++;
+                double e_local    = cell.epsilon;  // 1/fm^4
+                double rhob_local = cell.rhob;     // 1/fm^3
                 double p_local    = eos.get_pressure(e_local, rhob_local);
 
-                double ux   = arena_curr(ix, iy, ieta).u[1];
-                double uy   = arena_curr(ix, iy, ieta).u[2];
-                double ueta = arena_curr(ix, iy, ieta).u[3];
+                double ux   = cell.u[1];
+                double uy   = cell.u[2];
+                double ueta = cell.u[3];
 
                 // T_local is in GeV
                 double T_local = eos.get_temperature(e_local, rhob_local)*hbarc;
@@ -797,13 +1013,13 @@ void Cell_info::OutputEvolutionDataXYEta_vorticity(
 
                 double muB_local = eos.get_muB(e_local, rhob_local);
 
-                VorticityVec omega_kSP = {0.0};
-                VorticityVec omega_k   = {0.0};
-                VorticityVec omega_th  = {0.0};
-                VorticityVec omega_T   = {0.0};
-                u_derivative_helper.compute_vorticity_shell(
-                    tau, arena_prev, arena_curr, ieta, ix, iy, eta_local,
-                    omega_kSP, omega_k, omega_th, omega_T);
+                const Cell_aux omega_local = (
+                    u_derivative_helper.transform_vorticity_to_tz(
+                                omega_Milne, eta_local));
+                const VorticityVec &omega_kSP = omega_local.omega_kSP;
+                const VorticityVec &omega_k   = omega_local.omega_k;
+                const VorticityVec &omega_th  = omega_local.omega_th;
+                const VorticityVec &omega_T   = omega_local.omega_T;
 
                 float ideal[] = {static_cast<float>(itau),
                                  static_cast<float>(ix/n_skip_x),
@@ -851,270 +1067,218 @@ void Cell_info::OutputEvolutionDataXYEta_vorticity(
 }
 
 
-//! This function prints to the screen the maximum local energy density,
-//! the maximum temperature in the current grid
-void Cell_info::get_maximum_energy_density(
-        SCGrid &arena, double &e_max, double &nB_max, double &Tmax) {
-    double eps_max  = 0.0;
-    double rhob_max = 0.0;
-    double T_max    = 0.0;
-
-    // get the grid information
-    const int neta = arena.nEta();
-    const int nx   = arena.nX();
-    const int ny   = arena.nY();
-
-    #pragma omp parallel for collapse(3) reduction(max:eps_max, rhob_max, T_max)
-    for (int ieta = 0; ieta < neta; ieta++)
-    for (int ix = 0; ix < nx; ix++) 
-    for (int iy = 0; iy < ny; iy++) {
-        const auto eps_local  = arena(ix, iy, ieta).epsilon;
-        const auto rhob_local = arena(ix, iy, ieta).rhob;
-        eps_max  = std::max(eps_max,  eps_local );
-        rhob_max = std::max(rhob_max, rhob_local);
-        T_max    = std::max(T_max,    eos.get_temperature(eps_local, rhob_local));
-    }
-    eps_max *= Util::hbarc;   // GeV/fm^3
-    T_max   *= Util::hbarc;   // GeV
-
-    if (eps_max > 1e5) {
-        music_message << "The maximum e = " << eps_max << " < 1e5 GeV/fm^3";
-        music_message.flush("error");
-        music_message.error("This normally should not happen!");
-        music_message.error("Exiting ...");
-        exit(1);
-    }
-    music_message << "eps_max = " << eps_max << " GeV/fm^3, "
-                  << "rhob_max = " << rhob_max << " 1/fm^3, "
-                  << "T_max = " << T_max << " GeV.";
-    music_message.flush("info");
-    e_max = eps_max;
-    nB_max = rhob_max;
-    Tmax = T_max;
-}
-
+//! This function outputs the hydro evolution to evolution_xyeta_chunked.dat
+//! The fields are the ones of evolution_all_xyeta.dat, on all output points:
+//!    e P T cs^2 ux uy uz [GeV/fm^3, GeV/fm^3, GeV, 1, 1, 1, 1]
+//! if turn_on_rhob == 1:  rho_B mu_B [1/fm^3, GeV]
+//! if turn_on_shear == 1: Wxx Wxy Wxz Wyy Wyz
+//! if turn_on_bulk == 1:  pi_b
+//! if turn_on_diff == 1:  qx qy qz
+//! Here Wij and pi_b are divided by (e+P) in the fluid rest frame
+//! and qi is divided by kappa_hat in the fluid rest frame
+void Cell_info::write_evolution_xyeta_chunked(
+        const EvolutionSnapshot &snapshot) {
+    const int n_skip_x   = DATA.output_evolution_every_N_x;
+    const int n_skip_y   = DATA.output_evolution_every_N_y;
+    const int n_skip_eta = DATA.output_evolution_every_N_eta;
 
-//! This function computes global angular momentum at a give proper time
-void Cell_info::compute_angular_momentum(
-        SCGrid &arena, SCGrid &arena_prev, const double tau,
-        const double eta_min, const double eta_max) {
-    ostringstream filename;
-    filename << "global_angular_momentum_eta_"
-             << eta_min << "_" << eta_max << ".dat";
-    ofstream output_file;
-    if (std::abs(tau - DATA.tau0) < 1e-10) {
-        // create new files at the first time step
-        output_file.open(filename.str().c_str(), std::ofstream::out);
-        output_file << "# tau[fm]  Lx[hbarc]  Ly[hbarc]  Lz[hbarc]  "
-                    << "L^{tx}[hbarc]  L^{ty}[hbarc]  L^{tz}[hbarc]"
-                    << std::endl;
-    } else {
-        output_file.open(filename.str().c_str(),
-                         std::fstream::out | std::fstream::app);
+    std::vector<string> field_names = {"e", "P", "T", "cs2",
+                                       "ux", "uy", "uz"};
+    if (DATA.turn_on_rhob == 1) {
+        field_names.insert(field_names.end(), {"rhob", "muB"});
     }
-    double Lx  = 0.0;
-    double Ly  = 0.0;
-    double Lz  = 0.0;
-    double Ltx = 0.0;
-    double Lty = 0.0;
-    double Ltz = 0.0;
-    const double deta = DATA.delta_eta;
-    const double dx   = DATA.delta_x;
-    const double dy   = DATA.delta_y;
-    const int neta    = arena.nEta();
-    const int nx      = arena.nX();
-    const int ny      = arena.nY();
-    #pragma omp parallel for collapse(3) reduction(+:Lx, Ly, Lz, Ltx, Lty, Ltz)
-    for (int ieta = 0; ieta < neta; ieta++)
-    for (int ix = 0; ix < nx; ix++)
-    for (int iy = 0; iy < ny; iy++) {
-        const auto& c      = arena     (ix, iy, ieta);
-        const auto& c_prev = arena_prev(ix, iy, ieta);
-
-        double eta_s = deta*ieta - (DATA.eta_size)/2.0;
-        if (DATA.boost_invariant) {
-            eta_s = 0.0;
-        }
+    const int i_shear = static_cast<int>(field_names.size());
+    if (DATA.turn_on_shear == 1) {
+        field_names.insert(field_names.end(),
+                           {"Wxx", "Wxy", "Wxz", "Wyy", "Wyz"});
+    }
+    const int i_bulk = static_cast<int>(field_names.size());
+    if (DATA.turn_on_bulk == 1) field_names.push_back("pi_b");
+    const int i_diff = static_cast<int>(field_names.size());
+    if (DATA.turn_on_diff == 1) {
+        field_names.insert(field_names.end(), {"qx", "qy", "qz"});
+    }
+    const int n_fields = static_cast<int>(field_names.size());
+
+    if (chunked_file_ == nullptr) {
+        ChunkedEvolutionGrid grid;
+        grid.nx      = (snapshot.nx + n_skip_x - 1)/n_skip_x;
+        grid.ny      = (snapshot.ny + n_skip_y - 1)/n_skip_y;
+        grid.neta    = (snapshot.neta + n_skip_eta - 1)/n_skip_eta;
+        grid.tau0    = DATA.tau0;
+        grid.dtau    = (DATA.delta_tau_input
+                        *DATA.output_evolution_every_N_timesteps);
+        grid.dx      = DATA.delta_x*n_skip_x;
+        grid.dy      = DATA.delta_y*n_skip_y;
+        grid.deta    = DATA.delta_eta*n_skip_eta;
+        grid.x_min   = - DATA.x_size/2.;
+        grid.y_min   = - DATA.y_size/2.;
+        grid.eta_min = - DATA.eta_size/2.;
+        chunked_file_.reset(new ChunkedEvolutionWriter(
+                "evolution_xyeta_chunked.dat", grid, field_names,
+                DATA.output_evolution_codec));
+    }
+
+    const size_t n_cells = snapshot.cells.size();
+    std::vector<std::vector<float>> fields(n_fields,
+                                           std::vector<float>(n_cells, 0.f));
+    size_t i_cell = 0;
+    for (int ieta = 0; ieta < snapshot.neta; ieta += n_skip_eta) {
+        double eta_local = - DATA.eta_size/2. + ieta*DATA.delta_eta;
+        double cosh_eta = cosh(eta_local);
+        double sinh_eta = sinh(eta_local);
+        for (int iy = 0; iy < snapshot.ny; iy += n_skip_y) {
+            for (int ix = 0; ix < snapshot.nx; ix += n_skip_x) {
+                const Cell_small &cell = snapshot.cells[i_cell];
+                const double e_local    = cell.epsilon;  // 1/fm^4
+                const double rhob_local = cell.rhob;     // 1/fm^3
+                const ThermoState thermo = eos.get_thermo(e_local,
+                                                          rhob_local);
+                const double p_local = thermo.pressure;
+                fields[0][i_cell] = static_cast<float>(e_local*hbarc);
+                fields[1][i_cell] = static_cast<float>(p_local*hbarc);
+                fields[2][i_cell] = static_cast<float>(
+                                                thermo.temperature*hbarc);
+                fields[3][i_cell] = static_cast<float>(thermo.cs2);
+                fields[4][i_cell] = static_cast<float>(cell.u[1]);
+                fields[5][i_cell] = static_cast<float>(cell.u[2]);
+                fields[6][i_cell] = static_cast<float>(
+                            cell.u[3]*cosh_eta + cell.u[0]*sinh_eta);
+                if (DATA.turn_on_rhob == 1) {
+                    fields[7][i_cell] = static_cast<float>(rhob_local);
+                    fields[8][i_cell] = static_cast<float>(thermo.muB*hbarc);
+                }
 
-        const double cosh_eta = cosh(eta_s);
-        const double sinh_eta = sinh(eta_s);
-        const double t_local = tau*cosh_eta;
-        const double x_local = DATA.x_size/2. + ix*dx;
-        const double y_local = DATA.x_size/2. + iy*dy;
-        const double z_local = tau*sinh_eta;
-
-        const double e_local   = c.epsilon;
-        const double rhob      = c.rhob;
-        const double pressure  = eos.get_pressure(e_local, rhob);
-        const double u0        = c.u[0];
-        const double u1        = c.u[1];
-        const double u2        = c.u[2];
-        const double u3        = c.u[3];
-
-        const double T00_local = (e_local + pressure)*u0*u0 - pressure;
-        const double Pi00_rk_0 = (c_prev.pi_b
-                                  *(-1.0 + c_prev.u[0]*c_prev.u[0]));
-
-        const double T_tau_tau = (T00_local + c_prev.Wmunu[0] + Pi00_rk_0);
-        const double T_tau_x   = ((e_local + pressure)*u0*u1 + c_prev.Wmunu[1]
-                                  + c_prev.pi_b*c_prev.u[0]*c_prev.u[1]);
-        const double T_tau_y   = ((e_local + pressure)*u0*u2 + c_prev.Wmunu[2]
-                                  + c_prev.pi_b*c_prev.u[0]*c_prev.u[2]);
-        const double T_tau_eta = ((e_local + pressure)*u0*u3 + c_prev.Wmunu[3]
-                                  + c_prev.pi_b*c_prev.u[0]*c_prev.u[3]);
-        const double T_tau_t = T_tau_tau*cosh_eta + T_tau_eta*sinh_eta;
-        const double T_tau_z = T_tau_tau*sinh_eta + T_tau_eta*cosh_eta;
-
-        if (eta_s < eta_max && eta_s > eta_min) {
-            Lx  += (y_local*T_tau_z - z_local*T_tau_y);
-            Ly  += (z_local*T_tau_x - x_local*T_tau_z);
-            Lz  += (x_local*T_tau_y - y_local*T_tau_x);
-            Ltx += (t_local*T_tau_x - x_local*T_tau_t);
-            Lty += (t_local*T_tau_y - y_local*T_tau_t);
-            Ltz += (t_local*T_tau_z - z_local*T_tau_t);
+                ShearVisVecLRF piLRF;
+                get_LRF_shear_stress_tensor(cell, eta_local, piLRF);
+                const double div_factor = e_local + p_local;  // 1/fm^4
+                if (DATA.turn_on_shear == 1) {
+                    for (int i = 0; i < 5; i++) {
+                        fields[i_shear + i][i_cell] = static_cast<float>(
+                                                    piLRF[i]/div_factor);
+                    }
+                }
+                if (DATA.turn_on_bulk == 1) {
+                    fields[i_bulk][i_cell] = static_cast<float>(
+                                                    cell.pi_b/div_factor);
+                }
+                if (DATA.turn_on_diff == 1) {
+                    double muB_local = 0.0;
+                    if (DATA.turn_on_rhob == 1) muB_local = thermo.muB;
+                    const double kappa_hat = get_deltaf_qmu_coeff(
+                                        thermo.temperature, muB_local);
+                    for (int i = 0; i < 3; i++) {
+                        fields[i_diff + i][i_cell] = static_cast<float>(
+                                                piLRF[5 + i]/kappa_hat);
+                    }
+                }
+                i_cell++;
+            }
         }
     }
-    // add units
-    double factor = tau*dx*dy*deta;
-    Lx  *= factor;
-    Ly  *= factor;
-    Lz  *= factor;
-    Ltx *= factor;
-    Lty *= factor;
-    Ltz *= factor;
-
-    // output results
-    output_file << scientific << setprecision(6)
-                << tau << "  " << Lx << "  " << Ly << "  " << Lz << "  "
-                << Ltx << "  " << Lty << "  " << Ltz << std::endl;
-    output_file.close();
+    for (int i = 0; i < n_fields; i++) {
+        chunked_file_->write_field(snapshot.tau, i, fields[i].data());
+    }
 }
 
 
-//! This function checks the total energy and total net baryon number
-//! at a give proper time
-void Cell_info::check_conservation_law(SCGrid &arena, SCGrid &arena_prev,
-                                       const double tau) {
-    std::string filename = "global_conservation_laws.dat";
-    ofstream output_file;
-    if (std::abs(tau - DATA.tau0) < 1e-10) {
-        output_file.open(filename.c_str(), std::ofstream::out);
-        output_file << "# tau(fm)  E(GeV)  Px(GeV)  Py(GeV)  Pz(GeV)  N_B "
-                    << std::endl;
-    } else {
-        output_file.open(filename.c_str(),
-                         std::fstream::out | std::fstream::app);
+//! This function outputs the hydro evolution to evolution_xyeta_sparse.dat
+//! The fields are the ones of evolution_for_photon_xyeta.dat, for the
+//! output points with e above output_evolution_e_cut only:
+//!    T ux uy ueta [GeV, 1, 1, 1]
+//! if turn_on_rhob == 1:  mu_B [GeV]
+//! if turn_on_shear == 1: Wxx Wxy Wxeta Wyy Wyeta
+//! if turn_on_bulk == 1:  pi_b [1/fm^4]
+//! if turn_on_diff == 1:  rhob*T/(e+P) qx qy qeta
+//! Here ueta = tau*ueta, Wieta = tau*Wieta, qeta = tau*qeta, Wij is
+//! divided by (e+P) and qi by kappa_hat. The volume tau*dtau*dx*dy*deta
+//! and eta of a point follow from the grid of the file.
+void Cell_info::write_evolution_xyeta_sparse(
+        const EvolutionSnapshot &snapshot) {
+    const int n_skip_x   = DATA.output_evolution_every_N_x;
+    const int n_skip_y   = DATA.output_evolution_every_N_y;
+    const int n_skip_eta = DATA.output_evolution_every_N_eta;
+    const int n_out_x    = (snapshot.nx + n_skip_x - 1)/n_skip_x;
+    const int n_out_y    = (snapshot.ny + n_skip_y - 1)/n_skip_y;
+    const int n_out_eta  = (snapshot.neta + n_skip_eta - 1)/n_skip_eta;
+
+    std::vector<string> field_names = {"T", "ux", "uy", "ueta"};
+    const int i_muB = static_cast<int>(field_names.size());
+    if (DATA.turn_on_rhob == 1) field_names.push_back("muB");
+    const int i_shear = static_cast<int>(field_names.size());
+    if (DATA.turn_on_shear == 1) {
+        field_names.insert(field_names.end(),
+                           {"Wxx", "Wxy", "Wxeta", "Wyy", "Wyeta"});
     }
-    double N_B     = 0.0;
-    double T_tau_t = 0.0;
-    double T_tau_x = 0.0;
-    double T_tau_y = 0.0;
-    double T_tau_z = 0.0;
-    double N_B_edge     = 0.0;
-    double T_tau_t_edge = 0.0;
-    double T_tau_x_edge = 0.0;
-    double T_tau_y_edge = 0.0;
-    double T_tau_z_edge = 0.0;
-    double deta    = DATA.delta_eta;
-    double dx      = DATA.delta_x;
-    double dy      = DATA.delta_y;
-    const int neta = arena.nEta();
-    const int nx   = arena.nX();
-    const int ny   = arena.nY();
-
-    #pragma omp parallel for collapse(3) reduction(+:N_B, T_tau_t, T_tau_x, T_tau_y, T_tau_z, N_B_edge, T_tau_t_edge, T_tau_x_edge, T_tau_y_edge, T_tau_z_edge)
-    for (int ieta = 0; ieta < neta; ieta++)
-    for (int ix = 0; ix < nx; ix++)
-    for (int iy = 0; iy < ny; iy++) {
-        const auto& c      = arena     (ix, iy, ieta);
-        const auto& c_prev = arena_prev(ix, iy, ieta);
-
-        const double eta_s = deta*ieta - (DATA.eta_size)/2.0;
-        const double cosh_eta = cosh(eta_s);
-        const double sinh_eta = sinh(eta_s);
-        N_B += (c.rhob*c.u[0] + c_prev.Wmunu[10]);
-        const double e_local   = c.epsilon;
-        const double rhob      = c.rhob;
-        const double pressure  = eos.get_pressure(e_local, rhob);
-        const double u0        = c.u[0];
-        const double u1        = c.u[1];
-        const double u2        = c.u[2];
-        const double u3        = c.u[3];
-        const double T00_local = (e_local + pressure)*u0*u0 - pressure;
-        const double Pi00_rk_0 = (c_prev.pi_b
-                                  *(-1.0 + c_prev.u[0]*c_prev.u[0]));
-
-        const double T_tau_tau = (T00_local + c_prev.Wmunu[0] + Pi00_rk_0);
-        const double T01_local = ((e_local + pressure)*u0*u1 + c_prev.Wmunu[1]
-                                  + c_prev.pi_b*c_prev.u[0]*c_prev.u[1]);
-        const double T02_local = ((e_local + pressure)*u0*u2 + c_prev.Wmunu[2]
-                                  + c_prev.pi_b*c_prev.u[0]*c_prev.u[2]);
-        const double T_tau_eta = ((e_local + pressure)*u0*u3 + c_prev.Wmunu[3]
-                                  + c_prev.pi_b*c_prev.u[0]*c_prev.u[3]);
-        T_tau_t += T_tau_tau*cosh_eta + T_tau_eta*sinh_eta;
-        T_tau_x += T01_local;
-        T_tau_y += T02_local;
-        T_tau_z += T_tau_tau*sinh_eta + T_tau_eta*cosh_eta;
-
-        // compute the energy-momentum vector on the edge
-        if (ieta == 0 || ieta == neta - 1 || ix == 0 || ix == nx - 1
-            || iy == 0 || iy == ny - 1) {
-            N_B_edge     += c.rhob*c.u[0] + c_prev.Wmunu[10];
-            T_tau_t_edge += T_tau_tau*cosh_eta + T_tau_eta*sinh_eta;
-            T_tau_x_edge += T01_local;
-            T_tau_y_edge += T02_local;
-            T_tau_z_edge += T_tau_tau*sinh_eta + T_tau_eta*cosh_eta;
+    const int i_bulk = static_cast<int>(field_names.size());
+    if (DATA.turn_on_bulk == 1) field_names.push_back("pi_b");
+    const int i_diff = static_cast<int>(field_names.size());
+    if (DATA.turn_on_diff == 1) {
+        field_names.insert(field_names.end(),
+                           {"rhobT_over_ePlusP", "qx", "qy", "qeta"});
+    }
+    const int n_fields = static_cast<int>(field_names.size());
+
+    if (sparse_file_ == nullptr) {
+        ChunkedEvolutionGrid grid;
+        grid.nx      = n_out_x;
+        grid.ny      = n_out_y;
+        grid.neta    = n_out_eta;
+        grid.tau0    = DATA.tau0;
+        grid.dtau    = (DATA.delta_tau_input
+                        *DATA.output_evolution_every_N_timesteps);
+        grid.dx      = DATA.delta_x*n_skip_x;
+        grid.dy      = DATA.delta_y*n_skip_y;
+        grid.deta    = DATA.delta_eta*n_skip_eta;
+        grid.x_min   = - DATA.x_size/2.;
+        grid.y_min   = - DATA.y_size/2.;
+        grid.eta_min = - DATA.eta_size/2.;
+        sparse_file_.reset(new SparseEvolutionWriter(
+                "evolution_xyeta_sparse.dat", grid, field_names));
+    }
+
+    const size_t n_cells = snapshot.cells.size();
+    std::vector<float> fields(n_fields*n_cells, 0.f);
+    for (size_t i_cell = 0; i_cell < n_cells; i_cell++) {
+        const Cell_small &cell = snapshot.cells[i_cell];
+        const double e_local    = cell.epsilon;  // 1/fm^4
+        const double rhob_local = cell.rhob;     // 1/fm^3
+        const ThermoState thermo = eos.get_thermo(e_local, rhob_local);
+        const double T_local = thermo.temperature;  // 1/fm
+        double muB_local = 0.0;
+        if (DATA.turn_on_rhob == 1) muB_local = thermo.muB;
+        const double div_factor = e_local + thermo.pressure;  // 1/fm^4
+        auto field = [&](const int i) -> float& {
+            return(fields[i*n_cells + i_cell]);
+        };
+        field(0) = static_cast<float>(T_local*hbarc);
+        field(1) = static_cast<float>(cell.u[1]);
+        field(2) = static_cast<float>(cell.u[2]);
+        field(3) = static_cast<float>(cell.u[3]);
+        if (DATA.turn_on_rhob == 1) {
+            field(i_muB) = static_cast<float>(muB_local*hbarc);
+        }
+        if (DATA.turn_on_shear == 1) {
+            for (int i = 0; i < 5; i++) {
+                field(i_shear + i) = static_cast<float>(
+                                            cell.Wmunu[4 + i]/div_factor);
+            }
+        }
+        if (DATA.turn_on_bulk == 1) {
+            field(i_bulk) = static_cast<float>(cell.pi_b);
+        }
+        if (DATA.turn_on_diff == 1) {
+            const double kappa_hat = get_deltaf_qmu_coeff(T_local,
+                                                          muB_local);
+            field(i_diff) = static_cast<float>(
+                                        rhob_local*T_local/div_factor);
+            for (int i = 0; i < 3; i++) {
+                field(i_diff + 1 + i) = static_cast<float>(
+                                            cell.Wmunu[11 + i]/kappa_hat);
+            }
         }
     }
-    // add units
-    double factor = tau*dx*dy*deta;
-    N_B *= factor;
-    T_tau_t *= factor*Util::hbarc;  // GeV
-    T_tau_x *= factor*Util::hbarc;  // GeV
-    T_tau_y *= factor*Util::hbarc;  // GeV
-    T_tau_z *= factor*Util::hbarc;  // GeV
-    N_B_edge *= factor;
-    T_tau_t_edge *= factor*Util::hbarc;  // GeV
-    T_tau_x_edge *= factor*Util::hbarc;  // GeV
-    T_tau_y_edge *= factor*Util::hbarc;  // GeV
-    T_tau_z_edge *= factor*Util::hbarc;  // GeV
-
-    // compute the outflow flux
-    if (tau > DATA.tau0) {
-        outflow_flux[0] += T_tau_t_edge - Pmu_edge_prev[0];
-        outflow_flux[1] += T_tau_x_edge - Pmu_edge_prev[1];
-        outflow_flux[2] += T_tau_y_edge - Pmu_edge_prev[2];
-        outflow_flux[3] += T_tau_z_edge - Pmu_edge_prev[3];
-        outflow_flux[4] += N_B_edge - Pmu_edge_prev[4];
-
-        N_B     += outflow_flux[4];
-        T_tau_t += outflow_flux[0];  // GeV
-        T_tau_x += outflow_flux[1];  // GeV
-        T_tau_y += outflow_flux[2];  // GeV
-        T_tau_z += outflow_flux[3];  // GeV
-    }
-    Pmu_edge_prev[0] = T_tau_t_edge;
-    Pmu_edge_prev[1] = T_tau_x_edge;
-    Pmu_edge_prev[2] = T_tau_y_edge;
-    Pmu_edge_prev[3] = T_tau_z_edge;
-    Pmu_edge_prev[4] = N_B_edge;
-
-    // output results
-    music_message << "total energy T^{taut} = " << T_tau_t << " GeV";
-    music_message.flush("info");
-    music_message << "net longitudinal momentum Pz = " << T_tau_z << " GeV";
-    music_message.flush("info");
-    music_message << "net baryon number N_B = " << N_B;
-    if (N_B > 0. || N_B < 500.) {
-        music_message.flush("info");
-    } else {
-        music_message.flush("error");
-        exit(1);
-    }
-    output_file << scientific << setprecision(6)
-                << tau << "  " << T_tau_t << "  " << T_tau_x << "  "
-                << T_tau_y << "  " << T_tau_z << "  " << N_B << std::endl;
-    output_file.close();
+    sparse_file_->write_frame(snapshot.tau, snapshot.points, fields.data());
 }
 
 
@@ -1238,7 +1402,9 @@ void Cell_info::output_1p1D_check_file(SCGrid &arena, const double tau) {
 
 
 //! This function outputs energy density and n_b for making movies
-void Cell_info::output_evolution_for_movie(SCGrid &arena, const double tau) {
+void Cell_info::write_evolution_for_movie(
+        const EvolutionSnapshot &snapshot) {
+    const double tau = snapshot.tau;
     const string out_name_xyeta = "evolution_for_movie_xyeta.dat";
     string out_open_mode;
     FILE *out_file_xyeta;
@@ -1251,7 +1417,7 @@ void Cell_info::output_evolution_for_movie(SCGrid &arena, const double tau) {
     out_file_xyeta = fopen(out_name_xyeta.c_str(), out_open_mode.c_str());
 
     int n_skip_tau = DATA.output_evolution_every_N_timesteps;
-    double output_dtau = DATA.delta_tau*n_skip_tau;
+    double output_dtau = DATA.delta_tau_input*n_skip_tau;
     int itau = static_cast<int>((tau - DATA.tau0)/(output_dtau) + 0.1);
 
     int n_skip_x   = DATA.output_evolution_every_N_x;
@@ -1265,10 +1431,10 @@ void Cell_info::output_evolution_for_movie(SCGrid &arena, const double tau) {
     const int nVar_per_cell = 14;
     if (tau == DATA.tau0) {
         // write out header
-        const int output_nx   = static_cast<int>(arena.nX()/n_skip_x);
-        const int output_ny   = static_cast<int>(arena.nY()/n_skip_y);
+        const int output_nx   = static_cast<int>(snapshot.nx/n_skip_x);
+        const int output_ny   = static_cast<int>(snapshot.ny/n_skip_y);
         const int output_neta = (
-                std::min(1, static_cast<int>(arena.nEta()/n_skip_eta)));
+                std::min(1, static_cast<int>(snapshot.neta/n_skip_eta)));
         const double output_dx     = DATA.delta_x*n_skip_x;
         const double output_dy     = DATA.delta_y*n_skip_y;
         const double output_deta   = DATA.delta_eta*n_skip_eta;
@@ -1286,13 +1452,16 @@ void Cell_info::output_evolution_for_movie(SCGrid &arena, const double tau) {
             static_cast<float>(nVar_per_cell)};
         fwrite(header, sizeof(float), 12, out_file_xyeta);
     }
-    for (int ieta = 0; ieta < arena.nEta(); ieta += n_skip_eta) {
+    size_t i_cell = 0;
+    for (int ieta = 0; ieta < snapshot.neta; ieta += n_skip_eta) {
         double eta_local = - DATA.eta_size/2. + ieta*deta;
         if (DATA.boost_invariant) eta_local = 0.;
-        for (int iy = 0; iy < arena.nY(); iy += n_skip_y) {
-            for (int ix = 0; ix < arena.nX(); ix += n_skip_x) {
-                double e_local = arena(ix, iy, ieta).epsilon;  // 1/fm^4
-                double rhob_local = arena(ix, iy, ieta).rhob;  // 1/fm^3
+        for (int iy = 0; iy < snapshot.ny; iy += n_skip_y) {
+            for (int ix = 0; ix < snapshot.nx; ix += n_skip_x) {
+                const Cell_small &cell = snapshot.cells[i_cell];
+                i_cell++;
+                double e_local = cell.epsilon;  // 1/fm^4
+                double rhob_local = cell.rhob;  // 1/fm^3
 
                 // T_local is in 1/fm
                 double T_local   = eos.get_temperature(e_local, rhob_local);
@@ -1301,22 +1470,22 @@ void Cell_info::output_evolution_for_movie(SCGrid &arena, const double tau) {
                 double muB_local = eos.get_muB(e_local, rhob_local);  // 1/fm
 
                 double pressure  = eos.get_pressure(e_local, rhob_local);
-                double u0        = arena(ix, iy, ieta).u[0];
-                double u1        = arena(ix, iy, ieta).u[1];
-                double u2        = arena(ix, iy, ieta).u[2];
-                double u3        = arena(ix, iy, ieta).u[3];
+                double u0        = cell.u[0];
+                double u1        = cell.u[1];
+                double u2        = cell.u[2];
+                double u3        = cell.u[3];
                 double T00_ideal = (e_local + pressure)*u0*u0 - pressure;
                 double T03_ideal = (e_local + pressure)*u0*u3;
-                double Pi00      = arena(ix, iy, ieta).pi_b*(-1.0 + u0*u0);
-                double Pi03      = arena(ix, iy, ieta).pi_b*u0*u3;
+                double Pi00      = cell.pi_b*(-1.0 + u0*u0);
+                double Pi03      = cell.pi_b*u0*u3;
                 double T00_full  = (  T00_ideal
-                                    + arena(ix, iy, ieta).Wmunu[0] + Pi00);
+                                    + cell.Wmunu[0] + Pi00);
                 double T03_full  = (  T03_ideal
-                                    + arena(ix, iy, ieta).Wmunu[3] + Pi03);
+                                    + cell.Wmunu[3] + Pi03);
                 double Ttaut     = (  T00_full*cosh(eta_local)
                                     + T03_full*sinh(eta_local));
                 double JBtau     = (  rhob_local*u0
-                                    + arena(ix, iy, ieta).Wmunu[10]);
+                                    + cell.Wmunu[10]);
                 float array[] = {static_cast<float>(itau),
                                  static_cast<float>(ix/n_skip_x),
                                  static_cast<float>(iy/n_skip_y),
@@ -1415,7 +1584,8 @@ void Cell_info::monitor_a_fluid_cell(SCGrid &arena_curr, SCGrid &arena_prev,
 }
 
 void Cell_info::output_vorticity_distribution(
-                SCGrid &arena_curr, SCGrid &arena_prev, const double tau,
+                SCGrid &arena_curr, const VorticityGrid &vorticity,
+                const double tau,
                 const double eta_min, const double eta_max) {
     // This function outputs the vorticity tensor at a given tau
     ostringstream filename1;
@@ -1472,7 +1642,7 @@ void Cell_info::output_vorticity_distribution(
             double muB_avg = 0.0;
             double weight   = 0.0;
             for (int ieta = 0; ieta < arena_curr.nEta(); ieta++) {
-                double eta_local = - DATA.eta_size/2. + ieta*DATA.delta_eta;
+                double eta_local = eta_grid_.get_eta(ieta);
                 if (DATA.boost_invariant)
                     eta_local = 0.0;
                 if (eta_local < eta_max && eta_local > eta_min) {
@@ -1482,23 +1652,28 @@ void Cell_info::output_vorticity_distribution(
                     const double T_local = (
                             eos.get_temperature(e_local, rhob_local));
                     const double muB_local = eos.get_muB(e_local, rhob_local);
-                    T_avg += e_local*T_local*hbarc;
-                    muB_avg += e_local*muB_local*hbarc;
-
-                    VorticityVec omega_local_1, omega_local_2;
-                    VorticityVec omega_local_3, omega_local_4;
-                    u_derivative_helper.compute_vorticity_shell(
-                        tau, arena_prev, arena_curr, ieta, ix, iy, eta_local,
-                        omega_local_1, omega_local_2,
-                        omega_local_3, omega_local_4);
+                    // the energy in the cell, for the widths of the cells
+                    // of a stretched eta grid
+                    const double w_local = (
+                        e_local*eta_grid_.get_width(ieta)/DATA.delta_eta);
+                    T_avg += w_local*T_local*hbarc;
+                    muB_avg += w_local*muB_local*hbarc;
+
+                    const Cell_aux omega_local = (
+                        u_derivative_helper.transform_vorticity_to_tz(
+                                    vorticity(ix, iy, ieta), eta_local));
+                    const VorticityVec &omega_local_1 = omega_local.omega_kSP;
+                    const VorticityVec &omega_local_2 = omega_local.omega_k;
+                    const VorticityVec &omega_local_3 = omega_local.omega_th;
+                    const VorticityVec &omega_local_4 = omega_local.omega_T;
                     for (unsigned int ii = 0; ii < omega_k.size(); ii++) {
-                        omega_kSP[ii] += e_local*omega_local_1[ii]/T_local;
-                        omega_k[ii]   += e_local*omega_local_2[ii]/T_local;
-                        omega_th[ii]  += e_local*omega_local_3[ii];
-                        omega_T[ii]   += (e_local*omega_local_4[ii]
+                        omega_kSP[ii] += w_local*omega_local_1[ii]/T_local;
+                        omega_k[ii]   += w_local*omega_local_2[ii]/T_local;
+                        omega_th[ii]  += w_local*omega_local_3[ii];
+                        omega_T[ii]   += (w_local*omega_local_4[ii]
                                           /T_local/T_local);
                     }
-                    weight += e_local;
+                    weight += w_local;
                 }
             }
             weight = std::max(weight, small_eps);
@@ -1540,128 +1715,6 @@ void Cell_info::output_vorticity_distribution(
     of4.close();
 }
 
-void Cell_info::output_vorticity_time_evolution(
-                SCGrid &arena_curr, SCGrid &arena_prev, const double tau,
-                const double eta_min, const double eta_max) {
-    // This function outputs the time evolution of the vorticity tensor
-    ostringstream filename1;
-    filename1 << "vorticity_evo_kinetic_wSP_eta_" << eta_min
-              << "_" << eta_max << ".dat";
-    std::fstream of1;
-    if (std::abs(tau - DATA.tau0) < 1e-10) {
-        of1.open(filename1.str().c_str(), std::fstream::out);
-        of1 << "# tau[fm]  omega^{tx}/T  omega^{ty}/T  "
-            << "omega^{tz}/T  omega^{xy}/T  omega^{xz}/T  "
-            << "omega^{yz}/T" << std::endl;
-    } else {
-        of1.open(filename1.str().c_str(),
-                 std::fstream::out | std::fstream::app);
-    }
-    ostringstream filename2;
-    filename2 << "vorticity_evo_kinetic_eta_" << eta_min
-              << "_" << eta_max << ".dat";
-    std::fstream of2;
-    if (std::abs(tau - DATA.tau0) < 1e-10) {
-        of2.open(filename2.str().c_str(), std::fstream::out);
-        of2 << "# tau[fm]  omega^{tx}/T  omega^{ty}/T  "
-            << "omega^{tz}/T  omega^{xy}/T  omega^{xz}/T  "
-            << "omega^{yz}/T" << std::endl;
-    } else {
-        of2.open(filename2.str().c_str(),
-                 std::fstream::out | std::fstream::app);
-    }
-    ostringstream filename3;
-    filename3 << "vorticity_evo_thermal_eta_" << eta_min
-              << "_" << eta_max << ".dat";
-    std::fstream of3;
-    if (std::abs(tau - DATA.tau0) < 1e-10) {
-        of3.open(filename3.str().c_str(), std::fstream::out);
-        of3 << "# tau[fm]  omega^{tx}  omega^{ty}  "
-            << "omega^{tz}  omega^{xy}  omega^{xz}  "
-            << "omega^{yz}" << std::endl;
-    } else {
-        of3.open(filename3.str().c_str(),
-                 std::fstream::out | std::fstream::app);
-    }
-    ostringstream filename4;
-    filename4 << "vorticity_evo_T_eta_" << eta_min
-              << "_" << eta_max << ".dat";
-    std::fstream of4;
-    if (std::abs(tau - DATA.tau0) < 1e-10) {
-        of4.open(filename4.str().c_str(), std::fstream::out);
-        of4 << "# tau[fm]  omega^{tx}/T^2  omega^{ty}/T^2  "
-            << "omega^{tz}/T^2  omega^{xy}/T^2  "
-            << "omega^{xz}/T^2  omega^{yz}/T^2" << std::endl;
-    } else {
-        of4.open(filename4.str().c_str(),
-                 std::fstream::out | std::fstream::app);
-    }
-
-    VorticityVec omega_kSP = {0.0};
-    VorticityVec omega_k   = {0.0};
-    VorticityVec omega_th  = {0.0};
-    VorticityVec omega_T   = {0.0};
-    double weight = 0.0;
-    for (int ieta = 0; ieta < arena_curr.nEta(); ieta++) {
-        double eta = 0.0;
-        if (!DATA.boost_invariant) {
-            eta = ((static_cast<double>(ieta))*(DATA.delta_eta)
-                    - (DATA.eta_size)/2.0);
-        }
-        if (eta < eta_max && eta > eta_min) {
-            for (int iy = 0; iy < arena_curr.nY(); iy++)
-            for (int ix = 0; ix < arena_curr.nX(); ix++) {
-                const double e_local = arena_curr(ix, iy, ieta).epsilon;
-                if (e_local < 0.1) continue;
-                const double rhob_local = arena_curr(ix, iy, ieta).rhob;
-                const double T_local = (
-                            eos.get_temperature(e_local, rhob_local));
-                VorticityVec omega_local_1, omega_local_2;
-                VorticityVec omega_local_3, omega_local_4;
-                u_derivative_helper.compute_vorticity_shell(
-                    tau, arena_prev, arena_curr, ieta, ix, iy, eta,
-                    omega_local_1, omega_local_2,
-                    omega_local_3, omega_local_4);
-                for (unsigned int ii = 0; ii < omega_k.size(); ii++) {
-                    omega_kSP[ii] += e_local*omega_local_1[ii]/T_local;
-                    omega_k[ii]   += e_local*omega_local_2[ii]/T_local;
-                    omega_th[ii]  += e_local*omega_local_3[ii];
-                    omega_T[ii]   += e_local*omega_local_4[ii]/T_local/T_local;
-                }
-                weight += e_local;
-            }
-        }
-    }
-    weight = std::max(weight, small_eps);
-
-    of1 << scientific << setw(18) << setprecision(8) << tau << "  ";
-    of2 << scientific << setw(18) << setprecision(8) << tau << "  ";
-    of3 << scientific << setw(18) << setprecision(8) << tau << "  ";
-    of4 << scientific << setw(18) << setprecision(8) << tau << "  ";
-    for (unsigned int ii = 0; ii < omega_k.size(); ii++) {
-        // no minus sign because it has opposite sign to the kinetic vorcitity
-        of1 << scientific << setprecision(8) << setw(18)
-            << omega_kSP[ii]/weight << "  ";
-        // minus sign from the metric
-        // output quantities in g = (1, -1, -1 , -1)
-        of2 << scientific << setprecision(8) << setw(18)
-            << -omega_k[ii]/weight << "  ";
-        of3 << scientific << setprecision(8) << setw(18)
-            << -omega_th[ii]/weight << "  ";
-        of4 << scientific << setprecision(8) << setw(18)
-            << -omega_T[ii]/weight << "  ";
-    }
-    of1 << std::endl;
-    of2 << std::endl;
-    of3 << std::endl;
-    of4 << std::endl;
-
-    of1.close();
-    of2.close();
-    of3.close();
-    of4.close();
-}
-
 
 void Cell_info::load_deltaf_qmu_coeff_table(string filename) {
     std::ifstream table(filename.c_str());
@@ -1824,70 +1877,6 @@ double Cell_info::get_deltaf_coeff_14moments(double T, double muB,
 }
 
 
-//! This function outputs average T and mu_B as a function of proper tau
-//! within a given space-time rapidity range
-void Cell_info::output_average_phase_diagram_trajectory(
-        const double tau, const double eta_min, const double eta_max,
-        SCGrid &arena) {
-    ostringstream filename;
-    filename << "averaged_phase_diagram_trajectory_eta_" << eta_min
-             << "_" << eta_max << ".dat";
-    std::fstream of;
-    if (std::abs(tau - DATA.tau0) < 1e-10) {
-        of.open(filename.str().c_str(), std::fstream::out);
-        of << "# tau(fm)  <T>(GeV)  std(T)(GeV)  <mu_B>(GeV)  std(mu_B)(GeV)  "
-           << "V4 (fm^4)" << endl;
-    } else {
-        of.open(filename.str().c_str(),
-                std::fstream::out | std::fstream::app);
-    }
-    double avg_T  = 0.0;
-    double avg_mu = 0.0;
-    double std_T  = 0.0;
-    double std_mu = 0.0;
-    double weight = 0.0;
-    double V4     = 0.0;
-    const double unit_volume = tau*DATA.delta_x*DATA.delta_y*DATA.delta_eta;
-    for (int ieta = 0; ieta < arena.nEta(); ieta++) {
-        double eta = 0.0;
-        if (!DATA.boost_invariant) {
-            eta = ((static_cast<double>(ieta))*(DATA.delta_eta)
-                    - (DATA.eta_size)/2.0);
-        }
-        if (eta < eta_max && eta > eta_min) {
-            double cosh_eta = cosh(eta);
-            double sinh_eta = sinh(eta);
-            for (int iy = 0; iy < arena.nY(); iy++)
-            for (int ix = 0; ix < arena.nX(); ix++) {
-                double e_local      = arena(ix, iy, ieta).epsilon;  // 1/fm^4
-                if (e_local > 0.16/hbarc)
-                    V4 += unit_volume;
-                double rhob_local   = arena(ix, iy, ieta).rhob;     // 1/fm^3
-                double utau         = arena(ix, iy, ieta).u[0];
-                double ueta         = arena(ix, iy, ieta).u[3];
-                double ut           = utau*cosh_eta + ueta*sinh_eta;  // gamma factor
-                double T_local      = eos.get_temperature(e_local, rhob_local);
-                double muB_local    = eos.get_muB(e_local, rhob_local);
-                double weight_local = e_local*ut;
-                avg_T  += T_local*weight_local;
-                avg_mu += muB_local*weight_local;
-                std_T  += T_local*T_local*weight_local;
-                std_mu += muB_local*muB_local*weight_local;
-                weight += weight_local;
-            }
-        }
-    }
-    avg_T  = avg_T/std::max(weight, small_eps)*hbarc;
-    avg_mu = avg_mu/std::max(weight, small_eps)*hbarc;
-    std_T  = sqrt(std_T/std::max(weight, small_eps)*hbarc*hbarc - avg_T*avg_T);
-    std_mu = sqrt(std_mu/std::max(weight, small_eps)*hbarc*hbarc - avg_mu*avg_mu);
-    of << scientific << setw(18) << setprecision(8)
-       << tau << "  " << avg_T << "  " << std_T << "  "
-       << avg_mu << "  " << std_mu << "  " << V4 << endl;
-    of.close();
-}
-
-
 //! This function outputs system's eccentricity and momentum anisotropy
 //! as functions of eta_s
 void Cell_info::output_momentum_anisotropy_vs_etas(
@@ -1916,8 +1905,7 @@ void Cell_info::output_momentum_anisotropy_vs_etas(
     for (int ieta = 0; ieta < arena.nEta(); ieta++) {
         double eta = 0.0;
         if (!DATA.boost_invariant) {
-            eta = ((static_cast<double>(ieta))*(DATA.delta_eta)
-                    - (DATA.eta_size)/2.0);
+            eta = eta_grid_.get_eta(ieta);
         }
 
         // compute the central of mass position
@@ -2056,245 +2044,6 @@ void Cell_info::output_momentum_anisotropy_vs_etas(
 }
 
 
-//! This function outputs system's momentum anisotropy as a function of tau
-void Cell_info::output_momentum_anisotropy_vs_tau(
-                const double tau, const double eta_min, const double eta_max,
-                SCGrid &arena) const {
-    ostringstream filename;
-    filename << "momentum_anisotropy_eta_" << eta_min
-             << "_" << eta_max << ".dat";
-    std::fstream of;
-    if (std::abs(tau - DATA.tau0) < 1e-10) {
-        of.open(filename.str().c_str(), std::fstream::out);
-        of << "# tau(fm)  epsilon_p(ideal)(cos)  epsilon_p(ideal)(sin)  "
-           << "epsilon_p(shear)(cos)  epsilon_p(shear)(sin)  "
-           << "epsilon_p(full)(cos)  epsilon_p(full)(sin)  "
-           << "epsilon_2p(ideal)(cos)  epsilon_2p(ideal)(sin)  "
-           << "epsilon_2p(shear)(cos)  epsilon_2p(shear)(sin)  "
-           << "epsilon_2p(full)(cos)  epsilon_2p(full)(sin)  "
-           << "epsilon_3p(ideal)(cos)  epsilon_3p(ideal)(sin)  "
-           << "epsilon_3p(shear)(cos)  epsilon_3p(shear)(sin)  "
-           << "epsilon_3p(full)(cos)  epsilon_3p(full)(sin)  "
-           << endl;
-    } else {
-        of.open(filename.str().c_str(),
-                std::fstream::out | std::fstream::app);
-    }
-
-    ostringstream filename1;
-    filename1 << "eccentricities_evo_eta_" << eta_min
-              << "_" << eta_max << ".dat";
-    std::fstream of1;
-    if (std::abs(tau - DATA.tau0) < 1e-10) {
-        of1.open(filename1.str().c_str(), std::fstream::out);
-        of1 << "# tau(fm)  ecc_n(cos)  ecc_n(sin) (n=1-6)"<< endl;
-    } else {
-        of1.open(filename1.str().c_str(),
-                 std::fstream::out | std::fstream::app);
-    }
-
-    ostringstream filename2;
-    filename2 << "inverse_Reynolds_number_eta_" << eta_min
-             << "_" << eta_max << ".dat";
-    std::fstream of2;
-    if (std::abs(tau - DATA.tau0) < 1e-10) {
-        of2.open(filename2.str().c_str(), std::fstream::out);
-        of2 << "# tau(fm)  R_shearpi  R_Pi  gamma  T[GeV]" << endl;
-    } else {
-        of2.open(filename2.str().c_str(),
-                 std::fstream::out | std::fstream::app);
-    }
-
-    double ideal_num1 = 0.0;
-    double ideal_num2 = 0.0;
-    double ideal_den  = 0.0;
-    double shear_num1 = 0.0;
-    double shear_num2 = 0.0;
-    double shear_den  = 0.0;
-    double full_num1  = 0.0;
-    double full_num2  = 0.0;
-    double full_den   = 0.0;
-    double u_perp_num = 0.0;
-    double u_perp_den = 0.0;
-    double T_avg_num  = 0.0;
-    double T_avg_den  = 0.0;
-    double R_Pi_num   = 0.0;
-    double R_Pi_den   = 0.0;
-    double R_shearpi_num   = 0.0;
-    double R_shearpi_den   = 0.0;
-
-    // compute epsilon_{p2} and epsilon_{p3} using T^{0\mu} vector
-    // epsilon_{pn} = (\int (T^{0r} exp(i n \phi_u))/(\int T^{0r})
-    // for every n, we compute T^{0\mu} for ideal, ideal + shear, and full
-    std::vector<double> ep_num1(6, 0.0);
-    std::vector<double> ep_num2(6, 0.0);
-    std::vector<double> ep_den (6, 0.0);
-
-    const int norder = 6;
-    std::vector<double> eccn_num1(norder, 0.0);
-    std::vector<double> eccn_num2(norder, 0.0);
-    std::vector<double> eccn_den (norder, 0.0);
-    for (int ieta = 0; ieta < arena.nEta(); ieta++) {
-        double eta = 0.0;
-        if (!DATA.boost_invariant) {
-            eta = ((static_cast<double>(ieta))*(DATA.delta_eta)
-                    - (DATA.eta_size)/2.0);
-        }
-        if (eta < eta_max && eta > eta_min) {
-            double x_o   = 0.0;
-            double y_o   = 0.0;
-            double w_sum = 0.0;
-            for (int iy = 0; iy < arena.nY(); iy++)
-            for (int ix = 0; ix < arena.nX(); ix++) {
-                double x_local    = - DATA.x_size/2. + ix*DATA.delta_x;
-                double y_local    = - DATA.y_size/2. + iy*DATA.delta_y;
-                double e_local    = arena(ix, iy, ieta).epsilon;  // 1/fm^4
-                double gamma_perp = arena(ix, iy, ieta).u[0];
-                x_o   += x_local*e_local*gamma_perp;
-                y_o   += y_local*e_local*gamma_perp;
-                w_sum += e_local*gamma_perp;
-            }
-            x_o /= w_sum;
-            y_o /= w_sum;
-            for (int iy = 0; iy < arena.nY(); iy++)
-            for (int ix = 0; ix < arena.nX(); ix++) {
-                double x_local   = (- DATA.x_size/2. + ix*DATA.delta_x - x_o);
-                double y_local   = (- DATA.y_size/2. + iy*DATA.delta_y - y_o);
-                double r_local   = sqrt(x_local*x_local + y_local*y_local);
-                double phi_local = atan2(y_local, x_local);
-
-                double e_local    = arena(ix, iy, ieta).epsilon;  // 1/fm^4
-                double rhob_local = arena(ix, iy, ieta).rhob;     // 1/fm^3
-                double P_local    = eos.get_pressure(e_local, rhob_local);
-                double enthopy    = e_local + P_local;
-                double T_local    = eos.get_temperature(e_local, rhob_local);
-                double u0         = arena(ix, iy, ieta).u[0];
-                double ux         = arena(ix, iy, ieta).u[1];
-                double uy         = arena(ix, iy, ieta).u[2];
-                double pi_0x      = arena(ix, iy, ieta).Wmunu[1];
-                double pi_0y      = arena(ix, iy, ieta).Wmunu[2];
-                double pi_xx      = arena(ix, iy, ieta).Wmunu[4];
-                double pi_xy      = arena(ix, iy, ieta).Wmunu[5];
-                double pi_yy      = arena(ix, iy, ieta).Wmunu[7];
-                double bulk_Pi    = arena(ix, iy, ieta).pi_b;
-
-                double T_0x_ideal   = enthopy*u0*ux;
-                double T_0y_ideal   = enthopy*u0*uy;
-                double T_0r_ideal   = sqrt(  T_0x_ideal*T_0x_ideal
-                                           + T_0y_ideal*T_0y_ideal);
-                double phi_u_ideal  = atan2(T_0y_ideal, T_0x_ideal);
-                double T_xx_ideal   = enthopy*ux*ux + P_local;
-                double T_xy_ideal   = enthopy*ux*uy;
-                double T_yy_ideal   = enthopy*uy*uy + P_local;
-
-                double T_0x_shear   = T_0x_ideal + pi_0x;
-                double T_0y_shear   = T_0y_ideal + pi_0y;
-                double T_0r_shear   = sqrt(  T_0x_shear*T_0x_shear
-                                           + T_0y_shear*T_0y_shear);
-                double phi_u_shear  = atan2(T_0y_shear, T_0x_shear);
-                double T_xx_shear   = T_xx_ideal + pi_xx;
-                double T_xy_shear   = T_xy_ideal + pi_xy;
-                double T_yy_shear   = T_yy_ideal + pi_yy;
-
-                double T_0x_full    = T_0x_shear + bulk_Pi*u0*ux;
-                double T_0y_full    = T_0y_shear + bulk_Pi*u0*uy;
-                double T_0r_full    = sqrt(  T_0x_full*T_0x_full
-                                           + T_0y_full*T_0y_full);
-                double phi_u_full   = atan2(T_0y_full, T_0x_full);
-                double T_xx_full    = T_xx_shear - bulk_Pi*(-1 - ux*ux);
-                double T_xy_full    = T_xy_shear + bulk_Pi*ux*uy;
-                double T_yy_full    = T_yy_shear - bulk_Pi*(-1 - uy*uy);
-
-                ideal_num1 += T_xx_ideal - T_yy_ideal;
-                ideal_num2 += 2.*T_xy_ideal;
-                ideal_den  += T_xx_ideal + T_yy_ideal;
-                shear_num1 += T_xx_shear - T_yy_shear;
-                shear_num2 += 2.*T_xy_shear;
-                shear_den  += T_xx_shear + T_yy_shear;
-                full_num1  += T_xx_full - T_yy_full;
-                full_num2  += 2.*T_xy_full;
-                full_den   += T_xx_full + T_yy_full;
-
-                double weight_local = e_local;
-                u_perp_num += weight_local*u0;
-                u_perp_den += weight_local;
-                T_avg_num  += weight_local*T_local;
-                T_avg_den  += weight_local;
-
-                if (e_local > 1e-3) {
-                    double r_shearpi_tmp, r_bulkPi_tmp;
-                    calculate_inverse_Reynolds_numbers(arena, ieta, ix, iy,
-                                                       r_shearpi_tmp,
-                                                       r_bulkPi_tmp);
-                    R_shearpi_num += weight_local*r_shearpi_tmp;
-                    R_shearpi_den += weight_local;
-                    R_Pi_num      += weight_local*r_bulkPi_tmp;
-                    R_Pi_den      += weight_local;
-                }
-
-                for (int i = 0; i < 2; i++) {
-                    int idx = 3*i;
-                    int iorder = 2+i;
-                    ep_num1[idx]   += T_0r_ideal*cos(iorder*phi_u_ideal);
-                    ep_num2[idx]   += T_0r_ideal*sin(iorder*phi_u_ideal);
-                    ep_den [idx]   += T_0r_ideal;
-                    ep_num1[idx+1] += T_0r_shear*cos(iorder*phi_u_shear);
-                    ep_num2[idx+1] += T_0r_shear*sin(iorder*phi_u_shear);
-                    ep_den [idx+1] += T_0r_shear;
-                    ep_num1[idx+2] += T_0r_full*cos(iorder*phi_u_full);
-                    ep_num2[idx+2] += T_0r_full*sin(iorder*phi_u_full);
-                    ep_den [idx+2] += T_0r_full;
-                }
-                for (int i = 1; i <= norder; i++) {
-                    if (i == 1) {
-                        weight_local = u0*e_local*pow(r_local, 3);
-                    } else {
-                        weight_local = u0*e_local*pow(r_local, i);
-                    }
-                    eccn_num1[i-1] += weight_local*cos(i*phi_local);
-                    eccn_num2[i-1] += weight_local*sin(i*phi_local);
-                    eccn_den [i-1] += weight_local;
-                }
-            }
-        }
-    }
-    double R_shearpi = R_shearpi_num/std::max(R_shearpi_den, small_eps);
-    double R_Pi      = R_Pi_num/std::max(R_Pi_den, small_eps);
-    double u_avg     = u_perp_num/std::max(u_perp_den, small_eps);
-    double T_avg     = T_avg_num/std::max(T_avg_den, small_eps)*hbarc;
-
-    of << scientific << setw(18) << setprecision(8)
-       << tau << "  "
-       << ideal_num1/std::max(ideal_den, small_eps) << "  "
-       << ideal_num2/std::max(ideal_den, small_eps) << "  "
-       << shear_num1/std::max(shear_den, small_eps) << "  "
-       << shear_num2/std::max(shear_den, small_eps) << "  "
-       << full_num1/std::max(full_den, small_eps) << "  "
-       << full_num2/std::max(full_den, small_eps) << "  ";
-    for (int i = 0; i < 6; i++) {
-        of << ep_num1[i]/std::max(ep_den[i], small_eps) << "  "
-           << ep_num2[i]/std::max(ep_den[i], small_eps)<< "  ";
-    }
-    of << endl;
-    of.close();
-
-    of1 << scientific << setw(18) << setprecision(8)
-        << tau << "  ";
-    for (int i = 0; i < norder; i++) {
-        // the minus sign ensure the vector points to the short axis
-        of1 << -eccn_num1[i]/std::max(eccn_den[i], small_eps) << "  "
-            << -eccn_num2[i]/std::max(eccn_den[i], small_eps)<< "  ";
-    }
-    of1 << endl;
-    of1.close();
-
-    of2 << scientific << setw(18) << setprecision(8)
-        << tau << "  " << R_shearpi << "  " << R_Pi << "  "
-        << u_avg << "  " << T_avg << endl;
-    of2.close();
-}
-
-
 void Cell_info::get_LRF_shear_stress_tensor(const Cell_small &cell,
                                             const double eta_s,
                                             ShearVisVecLRF &res) {
@@ -5,22 +5,29 @@
 
 #include <iostream>
 #include <iomanip>
+#include <memory>
 #include <string>
 
 #include "data.h"
 #include "data_struct.h"
 #include "eos.h"
+#include "eta_grid.h"
 #include "cell.h"
 #include "grid.h"
 #include "u_derivative.h"
 #include "pretty_ostream.h"
 #include "HydroinfoMUSIC.h"
+#include "evolution_output.h"
+#include "chunked_evolution_file.h"
+#include "sparse_evolution_file.h"
+#include "movie_reduction.h"
 
 class Cell_info {
  private:
     const InitData &DATA;
     const EOS &eos;
     U_derivative u_derivative_helper;
+    const EtaGrid eta_grid_;
     pretty_ostream music_message;
 
     int deltaf_qmu_coeff_table_length_T;
@@ -43,7 +50,39 @@ class Cell_info {
     double **deltaf_coeff_tb_14mom_DV;
     double **deltaf_coeff_tb_14mom_Bpi_shear;
 
-    TJbVec Pmu_edge_prev, outflow_flux;
+    //! the chunked evolution file, opened with the first output
+    std::unique_ptr<ChunkedEvolutionWriter> chunked_file_;
+
+    //! the sparse evolution file, opened with the first output
+    std::unique_ptr<SparseEvolutionWriter> sparse_file_;
+
+    //! the reduced movie, created with the first frame
+    std::unique_ptr<MovieReduction> movie_reduction_;
+
+    //! writes the evolution outputs, created with the first output
+    std::unique_ptr<EvolutionOutputWriter> output_writer_;
+
+    //! copies the output cells of arena (and vorticity if not null) at tau
+    //! into a snapshot and hands it to the output writer
+    void submit_evolution_output(
+            SCGrid &arena, const VorticityGrid *vorticity, const double tau,
+            void (Cell_info::*write)(const EvolutionSnapshot &));
+
+    //! copies the output cells of arena at tau with e above
+    //! output_evolution_e_cut into a snapshot and hands it to the output
+    //! writer
+    void submit_sparse_evolution_output(
+            SCGrid &arena, const double tau,
+            void (Cell_info::*write)(const EvolutionSnapshot &));
+
+    // the evolution outputs of a snapshot, run on the writer thread
+    void write_evolution_xyeta(const EvolutionSnapshot &snapshot);
+    void write_evolution_xyeta_chun(const EvolutionSnapshot &snapshot);
+    void write_evolution_xyeta_photon(const EvolutionSnapshot &snapshot);
+    void write_evolution_xyeta_vorticity(const EvolutionSnapshot &snapshot);
+    void write_evolution_for_movie(const EvolutionSnapshot &snapshot);
+    void write_evolution_xyeta_chunked(const EvolutionSnapshot &snapshot);
+    void write_evolution_xyeta_sparse(const EvolutionSnapshot &snapshot);
 
  public:
     Cell_info(const InitData &DATA_in, const EOS &eos_ptr_in);
@@ -52,7 +91,14 @@ class Cell_info {
     //! This function outputs a header files for JF and Gojko's EM programs
     void Output_hydro_information_header();
 
+    //! This function outputs the cells of a stretched eta grid to
+    //! eta_grid.dat, as ieta, eta_s and the width of the cell, for the
+    //! evolution outputs that carry the eta slices without their positions
+    void output_eta_grid() const;
+
     //! This function outputs hydro evolution file in binary format
+    //! (the evolution outputs are written by the output writer, see
+    //! output_evolution_buffers)
     void OutputEvolutionDataXYEta(SCGrid &arena, double tau);
 
     //! This function outputs hydro evolution file in binary format
@@ -61,9 +107,18 @@ class Cell_info {
     //! This function outputs hydro evolution file in binary format for photon production
     void OutputEvolutionDataXYEta_photon(SCGrid &arena, double tau);
 
+    //! This function outputs hydro evolution to a chunked, columnar file
+    //! with one chunk per field and tau (see ChunkedEvolutionWriter)
+    void OutputEvolutionDataXYEta_chunked(SCGrid &arena, double tau);
+
+    //! This function outputs the fields of the photon output for the cells
+    //! above output_evolution_e_cut only (see SparseEvolutionWriter)
+    void OutputEvolutionDataXYEta_sparse(SCGrid &arena, double tau);
+
     //! This function outputs hydro evolution file in binary format
+    //! (vorticity holds the tensors of the cells in the tau-eta frame)
     void OutputEvolutionDataXYEta_vorticity(
-            SCGrid &arena_curr, SCGrid &arena_prev, double tau);
+            SCGrid &arena_curr, const VorticityGrid &vorticity, double tau);
 
     void load_deltaf_qmu_coeff_table(std::string filename);
     void load_deltaf_qmu_coeff_table_14mom(std::string filename);
@@ -78,6 +133,12 @@ class Cell_info {
                         const int ieta, const int ix, const int iy,
                         double &R_pi, double &R_Pi) const;
 
+    //! This function computes the inverse Reynolds numbers of a fluid cell
+    //! with the pressure of the cell
+    static void get_inverse_Reynolds_numbers(
+                        const Cell_small &grid_pt, const double pressure,
+                        double &R_pi, double &R_Pi);
+
     void OutputEvolution_Knudsen_Reynoldsnumbers(SCGrid &arena,
                                                  const double tau) const;
 
@@ -87,55 +148,33 @@ class Cell_info {
     //! This function outputs files to cross check with 1+1D simulation
     void output_1p1D_check_file(SCGrid &arena, const double tau);
 
-    //! This function prints to the screen the maximum local energy density,
-    //! the maximum temperature in the current grid
-    void get_maximum_energy_density(
-        SCGrid &arena, double &e_max, double &nB_max, double &Tmax);
-
     //! This function outputs energy density and n_b for making movies
     void output_evolution_for_movie(SCGrid &arena, const double tau);
 
-    //! This function outputs average T and mu_B as a function of proper tau
-    //! within a given space-time rapidity range
-    void output_average_phase_diagram_trajectory(
-        const double tau, const double eta_min, const double eta_max,
-        SCGrid &arena);
+    //! This function writes the 2D frames of the reduced movie chosen by
+    //! output_movie_reductions (see MovieReduction)
+    void output_reduced_movie(const SCGrid &arena, const double tau);
+
+    //! This function waits until the evolution outputs handed to the
+    //! output writer are written and closes the chunked, sparse and
+    //! reduced movie evolution files
+    void flush_evolution_output();
 
     //! This function outputs the vorticity tensor at a given tau
     void output_vorticity_distribution(
-        SCGrid &arena_curr, SCGrid &arena_prev, const double tau,
-        const double eta_min, const double eta_max);
-
-    //! This function outputs the time evolution of the vorticity tensor
-    void output_vorticity_time_evolution(
-        SCGrid &arena_curr, SCGrid &arena_prev, const double tau,
+        SCGrid &arena_curr, const VorticityGrid &vorticity, const double tau,
         const double eta_min, const double eta_max);
 
     //! This function dumps the energy density and net baryon density
     void output_energy_density_and_rhob_disitrubtion(SCGrid &arena,
                                                      std::string filename);
 
-    //! This function computes global angular momentum at a give proper time
-    void compute_angular_momentum(SCGrid &arena, SCGrid &arena_prev,
-                                  const double tau,
-                                  const double eta_min, const double eta_max);
-
-    //! This function checks the total energy and total net baryon number
-    //! at a give proper time
-    void check_conservation_law(SCGrid &arena, SCGrid &arena_prev,
-                                const double tau);
-
     //! This function outputs the evolution of hydrodynamic variables at a
     //! give fluid cell
     void monitor_a_fluid_cell(SCGrid &arena_curr, SCGrid &arena_prev,
                               const int ix, const int iy, const int ieta,
                               const double tau);
 
-    //! This function outputs system's momentum anisotropy as a function of tau
-    void output_momentum_anisotropy_vs_tau(
-                const double tau, const double eta_min, const double eta_max,
-                SCGrid &arena) const;
-
     //! This function outputs system's eccentricity and momentum anisotropy
     //! as functions of eta_s
     void output_momentum_anisotropy_vs_etas(const double tau,
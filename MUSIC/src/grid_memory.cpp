@@ -0,0 +1,165 @@
+#ifdef _OPENMP
+    #include <omp.h>
+#endif
+
+#include <dirent.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "grid_memory.h"
+#include "memory_accounting.h"
+#include "pretty_ostream.h"
+
+#ifndef _OPENMP
+    #define omp_get_thread_num() 0
+    #define omp_get_num_threads() 1
+    #define omp_get_max_threads() 1
+#endif
+
+namespace {
+    //! the NUMA node of cpu from sysfs (-1 if unknown)
+    int get_numa_node(const int cpu) {
+        if (cpu < 0) return(-1);
+        const std::string path = ("/sys/devices/system/cpu/cpu"
+                                  + std::to_string(cpu));
+        DIR *dir = opendir(path.c_str());
+        if (dir == NULL) return(-1);
+        int node = -1;
+        while (struct dirent *entry = readdir(dir)) {
+            if (strncmp(entry->d_name, "node", 4) == 0) {
+                node = atoi(entry->d_name + 4);
+                break;
+            }
+        }
+        closedir(dir);
+        return(node);
+    }
+
+    std::string get_proc_bind_name() {
+#ifdef _OPENMP
+        switch (omp_get_proc_bind()) {
+            case omp_proc_bind_false:  return("false");
+            case omp_proc_bind_true:   return("true");
+            case omp_proc_bind_master: return("master");
+            case omp_proc_bind_close:  return("close");
+            case omp_proc_bind_spread: return("spread");
+        }
+#endif
+        return("false");
+    }
+
+    //! the size and the subsystem of the grids allocated, by address. They
+    //! are never destroyed, for the grids released at the exit.
+    typedef std::map<void*, std::pair<std::size_t, int>> BookingMap;
+    std::mutex &get_bookings_mutex() {
+        static std::mutex *bookings_mutex = new std::mutex;
+        return(*bookings_mutex);
+    }
+    BookingMap &get_bookings() {
+        static BookingMap *bookings = new BookingMap;
+        return(*bookings);
+    }
+}
+
+
+bool GridMemory::first_touch_ = true;
+bool GridMemory::huge_pages_  = false;
+
+
+void GridMemory::initialize(const InitData &DATA) {
+    first_touch_ = (DATA.grid_first_touch == 1);
+    huge_pages_  = (DATA.grid_huge_pages == 1);
+
+    static bool reported = false;
+    if (!reported) {
+        reported = true;
+        print_affinity_report();
+    }
+}
+
+
+void *GridMemory::allocate(const std::size_t size) {
+    const bool huge = (huge_pages_ && size >= huge_page_size);
+    const std::size_t align = huge ? huge_page_size : alignment;
+    void *ptr = nullptr;
+    if (posix_memalign(&ptr, align, size) != 0) {
+        throw std::bad_alloc();
+    }
+#ifdef MADV_HUGEPAGE
+    if (huge) {
+        // only advice, the kernel may not have transparent huge pages
+        madvise(ptr, size - size%huge_page_size, MADV_HUGEPAGE);
+    }
+#endif
+    const int subsystem = MemoryAccounting::get_grid_subsystem();
+    MemoryAccounting::allocate(subsystem, size);
+    std::lock_guard<std::mutex> lock(get_bookings_mutex());
+    get_bookings()[ptr] = std::make_pair(size, subsystem);
+    return(ptr);
+}
+
+
+void GridMemory::deallocate(void *ptr) noexcept {
+    if (ptr == nullptr) return;
+    {
+        std::lock_guard<std::mutex> lock(get_bookings_mutex());
+        BookingMap &bookings = get_bookings();
+        auto booking = bookings.find(ptr);
+        if (booking != bookings.end()) {
+            MemoryAccounting::release(booking->second.second,
+                                      booking->second.first);
+            bookings.erase(booking);
+        }
+    }
+    free(ptr);
+}
+
+
+void GridMemory::print_affinity_report() {
+    const int n_threads = omp_get_max_threads();
+    std::vector<int> cpus(n_threads, -1);
+    std::vector<int> nodes(n_threads, -1);
+    #pragma omp parallel
+    {
+        const int ithread = omp_get_thread_num();
+        if (ithread < n_threads) {
+            cpus[ithread]  = sched_getcpu();
+            nodes[ithread] = get_numa_node(cpus[ithread]);
+        }
+    }
+
+    std::map<int, int> threads_per_node;
+    std::ostringstream thread_cpus;
+    for (int i = 0; i < n_threads; i++) {
+        threads_per_node[nodes[i]]++;
+        thread_cpus << " " << i << ":" << cpus[i];
+    }
+    std::ostringstream node_list;
+    for (const auto &node : threads_per_node) {
+        node_list << " node " << node.first << ": " << node.second;
+    }
+
+    pretty_ostream music_message;
+    music_message << "Thread affinity: " << n_threads
+                  << " OpenMP threads, proc_bind = " << get_proc_bind_name()
+                  << ", threads per NUMA node:" << node_list.str();
+    music_message.flush("info");
+    music_message << "Thread affinity: thread:cpu" << thread_cpus.str();
+    music_message.flush("info");
+    if (threads_per_node.size() > 1 && get_proc_bind_name() == "false") {
+        music_message << "The threads are not bound and run on several "
+                      << "NUMA nodes, set OMP_PROC_BIND=true and "
+                      << "OMP_PLACES=cores to keep them next to the pages "
+                      << "they first touched";
+        music_message.flush("warning");
+    }
+    music_message << "Grid memory: first touch = " << first_touch_
+                  << ", huge pages = " << huge_pages_;
+    music_message.flush("info");
+}
@@ -0,0 +1,80 @@
+#ifndef SRC_GRID_MEMORY_H_
+#define SRC_GRID_MEMORY_H_
+
+#include <cstddef>
+#include <new>
+#include <utility>
+#include "data.h"
+
+//! This class holds the memory policy of the GridT storage, which is set
+//! once per run from the parameters:
+//!   grid_first_touch = 1: the cells of a new grid are constructed by the
+//!                         OpenMP threads in the static partition of the
+//!                         storage order (see GridT::first_touch), so that
+//!                         the pages of a grid are spread over the NUMA
+//!                         nodes of the threads sweeping through them
+//!                         (grid_traversal = 2)
+//!   grid_huge_pages  = 1: the grids larger than a huge page are aligned
+//!                         to 2 MB and advised to be backed by transparent
+//!                         huge pages
+class GridMemory {
+ public:
+    //! the alignment of all the grids (a cache line), and of the grids
+    //! backed by huge pages
+    static constexpr std::size_t alignment = 64;
+    static constexpr std::size_t huge_page_size = 2*1024*1024;
+
+    //! sets the policy of the grids allocated from now on and prints the
+    //! thread affinity report (once per process)
+    static void initialize(const InitData &DATA);
+
+    static bool get_first_touch() {return(first_touch_);}
+    static bool get_huge_pages() {return(huge_pages_);}
+
+    //! allocates size bytes with the alignment of the policy, booked
+    //! under the grid subsystem of the calling thread (see MemoryScope)
+    static void *allocate(const std::size_t size);
+    static void deallocate(void *ptr) noexcept;
+
+    //! prints the number of OpenMP threads, their binding and the CPUs and
+    //! NUMA nodes they run on
+    static void print_affinity_report();
+
+ private:
+    static bool first_touch_;
+    static bool huge_pages_;
+};
+
+
+//! allocator of the GridT storage from GridMemory. The cells are not
+//! constructed when the storage is resized, GridT constructs them itself
+//! in parallel (the first touch of the pages).
+template<class T>
+class GridAllocator {
+ public:
+    typedef T value_type;
+
+    GridAllocator() = default;
+    template<class U> GridAllocator(const GridAllocator<U>&) {}
+
+    T* allocate(std::size_t n) {
+        return static_cast<T*>(GridMemory::allocate(n*sizeof(T)));
+    }
+    void deallocate(T* ptr, std::size_t) {GridMemory::deallocate(ptr);}
+
+    //! default construction (resize) is left to GridT::first_touch
+    template<class U>
+    void construct(U*) noexcept {}
+
+    template<class U, class... Args>
+    void construct(U *ptr, Args&&... args) {
+        ::new(static_cast<void*>(ptr)) U(std::forward<Args>(args)...);
+    }
+
+    template<class U>
+    bool operator==(const GridAllocator<U>&) const {return true;}
+    template<class U>
+    bool operator!=(const GridAllocator<U>&) const {return false;}
+};
+
+#endif  // SRC_GRID_MEMORY_H_
@@ -0,0 +1,167 @@
+#ifndef SRC_GRID_SOA_H_
+#define SRC_GRID_SOA_H_
+
+#include <cassert>
+#include <cstdlib>
+#include <vector>
+#include "aligned_allocator.h"
+#include "cell.h"
+#include "grid.h"
+#include "data_struct.h"
+
+//! view of N consecutive fields of one cell in a structure-of-arrays grid
+template<int N>
+class FieldArrayView {
+ private:
+    double *base;
+    int stride;
+
+ public:
+    FieldArrayView(double *base_in, const int stride_in) :
+        base(base_in), stride(stride_in) {}
+
+    double &operator[](const int i) const {return base[i*stride];}
+    static constexpr int size() {return N;}
+};
+
+
+//! field offsets of Cell_small in SCGridSoA
+namespace CellField {
+    enum {
+        epsilon  = 0,
+        rhob     = 1,
+        u        = 2,
+        Wmunu    = 6,
+        pi_b     = 20,
+        n_fields = 21,
+    };
+}
+
+
+//! proxy of one Cell_small stored in a SCGridSoA. It has the same member
+//! names as Cell_small, so stencil code can be written once for both
+//! layouts, and it converts to and from Cell_small.
+class Cell_small_view {
+ public:
+    double &epsilon;
+    double &rhob;
+    FieldArrayView<4>  u;
+    FieldArrayView<14> Wmunu;
+    double &pi_b;
+
+    Cell_small_view(double *data, const int stride, const int idx) :
+        epsilon(data[CellField::epsilon*stride + idx]),
+        rhob   (data[CellField::rhob*stride + idx]),
+        u      (data + CellField::u*stride + idx, stride),
+        Wmunu  (data + CellField::Wmunu*stride + idx, stride),
+        pi_b   (data[CellField::pi_b*stride + idx]) {}
+
+    operator Cell_small() const {
+        Cell_small cell;
+        cell.epsilon = epsilon;
+        cell.rhob    = rhob;
+        for (int i = 0; i < 4; i++) cell.u[i] = u[i];
+        for (int i = 0; i < 14; i++) cell.Wmunu[i] = Wmunu[i];
+        cell.pi_b    = pi_b;
+        return(cell);
+    }
+
+    Cell_small_view &operator=(const Cell_small &cell) {
+        epsilon = cell.epsilon;
+        rhob    = cell.rhob;
+        for (int i = 0; i < 4; i++) u[i] = cell.u[i];
+        for (int i = 0; i < 14; i++) Wmunu[i] = cell.Wmunu[i];
+        pi_b    = cell.pi_b;
+        return(*this);
+    }
+};
+
+
+//! Structure-of-arrays version of SCGrid: every field of Cell_small is
+//! stored in its own contiguous, 64-byte aligned array, indexed like GridT.
+//! Stencil sweeps through it only stream the fields they read.
+class SCGridSoA {
+ private:
+    typedef AlignedAllocator<double, MemorySubsystem::hydro_grids> Allocator;
+    std::vector<double, Allocator> data;
+
+    int Nx     = 0;
+    int Ny     = 0;
+    int Neta   = 0;
+    int stride = 0;
+
+    int index(int x, int y, int eta) const {return Nx*(Ny*eta+y)+x;}
+
+ public:
+    SCGridSoA() = default;
+    SCGridSoA(int Nx0, int Ny0, int Neta0) {
+        Nx     = Nx0  ;
+        Ny     = Ny0  ;
+        Neta   = Neta0;
+        // pad each field to a multiple of 8 doubles to keep them aligned
+        stride = ((Nx*Ny*Neta + 7)/8)*8;
+        data.resize(CellField::n_fields*stride);
+        for (int idx = 0; idx < size(); idx++) {
+            (*this)(idx) = Cell_small();
+        }
+    }
+
+    int nX()   const {return(Nx );  }
+    int nY()   const {return(Ny );  }
+    int nEta() const {return(Neta );}
+    int size() const {return Nx*Ny*Neta;}
+
+    //! pointer to the first element of a field (see CellField)
+    double *field(const int f) {
+        return assume_aligned(data.data() + f*stride);
+    }
+    const double *field(const int f) const {
+        return assume_aligned(data.data() + f*stride);
+    }
+
+    Cell_small_view operator()(const int i) {
+        assert(0<=i  ); assert(i<Nx*Ny*Neta);
+        return Cell_small_view(data.data(), stride, i);
+    }
+
+    Cell_small_view operator()(const int x, const int y, const int eta) {
+        assert(0<=x  ); assert(x  <Nx);
+        assert(0<=y  ); assert(y  <Ny);
+        assert(0<=eta); assert(eta<Neta);
+        return Cell_small_view(data.data(), stride, index(x, y, eta));
+    }
+
+    Cell_small_view getHalo(int x, int y, int eta) {
+        assert(-2<=x  ); assert(x  <Nx  +2);
+        assert(-2<=y  ); assert(y  <Ny  +2);
+        assert(-2<=eta); assert(eta<Neta+2);
+        if(x  <0)   x  =0;  else if(x  >=Nx)   x  = Nx   - 1;
+        if(y  <0)   y  =0;  else if(y  >=Ny)   y  = Ny   - 1;
+        if(eta<0)   eta=0;  else if(eta>=Neta) eta= Neta - 1;
+        return Cell_small_view(data.data(), stride, index(x, y, eta));
+    }
+
+    //! copy all the fields from an AoS grid of the same size
+    void load(const SCGrid &arena) {
+        assert(arena.nX() == Nx && arena.nY() == Ny && arena.nEta() == Neta);
+        const int n_cells = size();
+        double *ptr = data.data();
+        #pragma omp parallel for
+        for (int idx = 0; idx < n_cells; idx++) {
+            Cell_small_view(ptr, stride, idx) = arena(idx);
+        }
+    }
+
+    //! copy all the fields to an AoS grid of the same size
+    void store(SCGrid &arena) const {
+        assert(arena.nX() == Nx && arena.nY() == Ny && arena.nEta() == Neta);
+        const int n_cells = size();
+        double *ptr = const_cast<double*>(data.data());
+        #pragma omp parallel for
+        for (int idx = 0; idx < n_cells; idx++) {
+            arena(idx) = Cell_small_view(ptr, stride, idx);
+        }
+    }
+};
+
+#endif  // SRC_GRID_SOA_H_
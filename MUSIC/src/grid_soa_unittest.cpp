@@ -0,0 +1,70 @@
+#include "grid_soa.h"
+#include "doctest.h"
+#include <cstdint>
+
+TEST_CASE("check SoA grid load and store") {
+    SCGrid grid(3, 2, 4);
+    for (int i = 0; i < grid.size(); i++) {
+        grid(i).epsilon = i;
+        grid(i).rhob    = 2*i;
+        grid(i).u[3]    = 0.1*i;
+        grid(i).Wmunu[13] = -i;
+        grid(i).pi_b    = 3*i;
+    }
+    SCGridSoA grid_soa(3, 2, 4);
+    grid_soa.load(grid);
+    CHECK(grid_soa(2, 1, 3).epsilon == grid(2, 1, 3).epsilon);
+    CHECK(grid_soa(2, 1, 3).u[3] == grid(2, 1, 3).u[3]);
+    CHECK(grid_soa(2, 1, 3).Wmunu[13] == grid(2, 1, 3).Wmunu[13]);
+
+    grid_soa(1, 1, 1).pi_b = -1.;
+    SCGrid grid2(3, 2, 4);
+    grid_soa.store(grid2);
+    for (int i = 0; i < grid.size(); i++) {
+        if (i == 3*(2*1 + 1) + 1) {
+            CHECK(grid2(i).pi_b == -1.);
+        } else {
+            CHECK(grid2(i).pi_b == grid(i).pi_b);
+        }
+        CHECK(grid2(i).rhob == grid(i).rhob);
+    }
+
+    const Cell_small cell = grid_soa(0, 1, 2);
+    CHECK(cell.epsilon == grid(0, 1, 2).epsilon);
+    CHECK(cell.u[0] == 1.);
+}
+
+TEST_CASE("check SoA fields are aligned") {
+    SCGridSoA grid_soa(3, 3, 3);
+    for (int f = 0; f < CellField::n_fields; f++) {
+        CHECK(reinterpret_cast<std::uintptr_t>(grid_soa.field(f))%64 == 0);
+    }
+    CHECK(&grid_soa(1, 0, 0).epsilon == grid_soa.field(CellField::epsilon) + 1);
+    CHECK(&grid_soa(0, 0, 0).u[2] == grid_soa.field(CellField::u + 2));
+}
+
+TEST_CASE("check neighbourloop on SoA grid") {
+    SCGrid grid(5, 1, 1);
+    for (int i = 0; i < 5; i++) {
+        grid(i, 0, 0).epsilon = i + 1;
+    }
+    SCGridSoA grid_soa(5, 1, 1);
+    grid_soa.load(grid);
+    Neighbourloop(grid_soa, 2, 0, 0, NLAMBDAS_GENERIC {
+        if (direction == 1) {
+            CHECK(p1.epsilon == 4);
+            CHECK(p2.epsilon == 5);
+            CHECK(m1.epsilon == 2);
+            CHECK(m2.epsilon == 1);
+        } else {
+            CHECK(p1.epsilon == c.epsilon);
+            CHECK(m2.epsilon == c.epsilon);
+        }
+    });
+    Neighbourloop(grid_soa, 0, 0, 0, NLAMBDAS_GENERIC {
+        if (direction == 1) {
+            CHECK(m1.epsilon == 1);
+            CHECK(m2.epsilon == 1);
+        }
+    });
+}
@@ -0,0 +1,86 @@
+#ifdef _OPENMP
+    #include <omp.h>
+#endif
+
+#include <algorithm>
+#include "cell.h"
+#include "grid_tiling.h"
+
+#ifndef _OPENMP
+    #define omp_get_max_threads() 1
+#endif
+
+namespace {
+    //! L2 cache budget of one tile
+    const int tile_cache_bytes = 1 << 20;
+
+    //! cells touched per grid point in a Runge-Kutta stage:
+    //! arena_prev, arena_current, arena_future, and the EOS cache
+    const int bytes_per_cell = 3*sizeof(Cell_small) + 2*sizeof(Cell_thermo);
+
+    //! keep a few tiles per thread for the dynamic scheduling
+    const int tiles_per_thread = 4;
+}
+
+
+GridTiling::GridTiling(const int nx, const int ny, const int neta,
+                       const int tile_nx, const int tile_ny,
+                       const int tile_neta) :
+        nx_(nx), ny_(ny), neta_(neta) {
+    set_tile_shape(tile_nx, tile_ny, tile_neta);
+}
+
+
+GridTiling::GridTiling(const InitData &DATA, const int nx, const int ny,
+                       const int neta) : nx_(nx), ny_(ny), neta_(neta) {
+    set_tile_shape(DATA.grid_tile_size_x, DATA.grid_tile_size_y,
+                   DATA.grid_tile_size_eta);
+}
+
+
+GridTiling::GridTiling(const InitData &DATA, const ActiveRegion &region) :
+        x0_(region.get_x_min()), y0_(region.get_y_min()),
+        eta0_(region.get_eta_min()),
+        nx_(region.get_x_max() - region.get_x_min()),
+        ny_(region.get_y_max() - region.get_y_min()),
+        neta_(region.get_eta_max() - region.get_eta_min()) {
+    if (region.is_empty()) {
+        nx_ = ny_ = neta_ = 0;
+        tile_nx_ = tile_ny_ = tile_neta_ = 1;
+        ntiles_x_ = ntiles_y_ = ntiles_eta_ = 0;
+        return;
+    }
+    set_tile_shape(DATA.grid_tile_size_x, DATA.grid_tile_size_y,
+                   DATA.grid_tile_size_eta);
+}
+
+
+//! this function sets the tile shape. The automatic shape keeps whole
+//! rows in x for the unit stride, and a few cells in eta so the eta
+//! neighbours of a cell are reused within the tile. The tile is then
+//! stacked in y until it fills the cache budget.
+void GridTiling::set_tile_shape(const int tile_nx, const int tile_ny,
+                                const int tile_neta) {
+    tile_nx_   = (tile_nx   > 0 ? std::min(tile_nx,   nx_  ) : nx_);
+    tile_neta_ = (tile_neta > 0 ? std::min(tile_neta, neta_)
+                                : std::min(4, neta_));
+    if (tile_ny > 0) {
+        tile_ny_ = std::min(tile_ny, ny_);
+    } else {
+        const int cells_per_tile = tile_cache_bytes/bytes_per_cell;
+        tile_ny_ = std::max(1, cells_per_tile/(tile_nx_*tile_neta_));
+        tile_ny_ = std::min(tile_ny_, ny_);
+        // split further if there are too few tiles for the threads
+        const int min_tiles = tiles_per_thread*omp_get_max_threads();
+        while (tile_ny_ > 1) {
+            const int ntiles = (  ((nx_ + tile_nx_ - 1)/tile_nx_)
+                                * ((ny_ + tile_ny_ - 1)/tile_ny_)
+                                * ((neta_ + tile_neta_ - 1)/tile_neta_));
+            if (ntiles >= min_tiles) break;
+            tile_ny_ = (tile_ny_ + 1)/2;
+        }
+    }
+    ntiles_x_   = (nx_   + tile_nx_   - 1)/tile_nx_;
+    ntiles_y_   = (ny_   + tile_ny_   - 1)/tile_ny_;
+    ntiles_eta_ = (neta_ + tile_neta_ - 1)/tile_neta_;
+}
@@ -0,0 +1,79 @@
+#ifndef SRC_GRID_TILING_H_
+#define SRC_GRID_TILING_H_
+
+#include <algorithm>
+#include "data.h"
+#include "active_region.h"
+
+//! This class splits a nx*ny*neta grid into 3D tiles for cache-blocked
+//! loops. The cells of a tile are visited in the storage order of GridT
+//! (x fastest), and the tiles are the units distributed over the OpenMP
+//! threads:
+//!
+//!     GridTiling tiling(DATA, nx, ny, neta);
+//!     #pragma omp parallel for schedule(dynamic)
+//!     for (int itile = 0; itile < tiling.get_number_of_tiles(); itile++) {
+//!         tiling.for_each_cell(itile, [&](int ix, int iy, int ieta) {...});
+//!     }
+class GridTiling {
+ private:
+    int x0_ = 0, y0_ = 0, eta0_ = 0;
+    int nx_, ny_, neta_;
+    int tile_nx_, tile_ny_, tile_neta_;
+    int ntiles_x_, ntiles_y_, ntiles_eta_;
+
+    void set_tile_shape(const int tile_nx, const int tile_ny,
+                        const int tile_neta);
+
+ public:
+    //! tile sizes <= 0 are chosen to fit the working set of a Runge-Kutta
+    //! stage of a tile into the L2 cache
+    GridTiling(const int nx, const int ny, const int neta,
+               const int tile_nx = 0, const int tile_ny = 0,
+               const int tile_neta = 0);
+
+    //! the tile shape is read from grid_tile_size_x/y/eta in DATA
+    GridTiling(const InitData &DATA, const int nx, const int ny,
+               const int neta);
+
+    //! tiles only the cells of the active region
+    GridTiling(const InitData &DATA, const ActiveRegion &region);
+
+    int get_number_of_tiles() const {
+        return(ntiles_x_*ntiles_y_*ntiles_eta_);
+    }
+    int get_tile_nx()   const {return(tile_nx_);}
+    int get_tile_ny()   const {return(tile_ny_);}
+    int get_tile_neta() const {return(tile_neta_);}
+
+    //! calls func(ix, iy, ieta) for all the cells of the tile itile
+    template<class Func>
+    void for_each_cell(const int itile, Func &&func) const {
+        const int itile_x   = itile%ntiles_x_;
+        const int itile_y   = (itile/ntiles_x_)%ntiles_y_;
+        const int itile_eta = itile/(ntiles_x_*ntiles_y_);
+        const int x0   = x0_   + itile_x*tile_nx_;
+        const int y0   = y0_   + itile_y*tile_ny_;
+        const int eta0 = eta0_ + itile_eta*tile_neta_;
+        const int x1   = std::min(x0_   + nx_,   x0   + tile_nx_  );
+        const int y1   = std::min(y0_   + ny_,   y0   + tile_ny_  );
+        const int eta1 = std::min(eta0_ + neta_, eta0 + tile_neta_);
+        for (int ieta = eta0; ieta < eta1; ieta++)
+        for (int iy   = y0;   iy   < y1;   iy++  )
+        for (int ix   = x0;   ix   < x1;   ix++  ) {
+            func(ix, iy, ieta);
+        }
+    }
+
+    //! calls func(ix, iy, ieta) for all the cells in parallel
+    template<class Func>
+    void parallel_for_each_cell(Func &&func) const {
+        const int ntiles = get_number_of_tiles();
+        #pragma omp parallel for schedule(dynamic)
+        for (int itile = 0; itile < ntiles; itile++) {
+            for_each_cell(itile, func);
+        }
+    }
+};
+
+#endif  // SRC_GRID_TILING_H_
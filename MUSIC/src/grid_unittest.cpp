@@ -1,7 +1,13 @@
 #include "grid.h"
+#include "active_region.h"
+#include "grid_tiling.h"
+#include "stencil_tile.h"
 #include "doctest.h"
+#include <algorithm>
 #include <cassert>
+#include <cstdint>
 #include <iostream>
+#include <vector>
 
 TEST_CASE("Does grid copy work"){
     SCGrid grid(3, 3, 3);
@@ -10,6 +16,24 @@ TEST_CASE("Does grid copy work"){
     CHECK(grid2(0, 0, 0).epsilon == grid(0, 0, 0).epsilon);
 }
 
+TEST_CASE("Check the first touch constructs all the cells") {
+    PaddedSCGrid grid(7, 5, 3);
+    CHECK(reinterpret_cast<uintptr_t>(&grid.getHalo(-2, -2, -2))
+          % GridMemory::alignment == 0);
+    bool default_cells = true;
+    for (int eta = -2; eta < 5; eta++)
+    for (int y   = -2; y   < 7; y++  )
+    for (int x   = -2; x   < 9; x++  ) {
+        const Cell_small &cell = grid.getHalo(x, y, eta);
+        default_cells = (default_cells && cell.epsilon == 0.
+                         && cell.u[0] == 1. && cell.Wmunu[5] == 0.);
+    }
+    CHECK(default_cells);
+
+    FaceFluxGrid fluxes(4, 4, 4);
+    CHECK(fluxes(63)[4] == 0.);
+}
+
 TEST_CASE("check neighbourloop1") {
     SCGrid grid(1, 1, 1);
     grid(0,0,0).epsilon = 3;
@@ -75,6 +99,33 @@ TEST_CASE("check neighbourloop4"){
     CHECK(sum == 15);
 }
 
+TEST_CASE("check neighbourloop2D visits the transverse directions"){
+    SCGrid grid(3, 3, 1);
+    ThermoGrid thermo(3, 3, 1);
+    for (int i = 0; i < 3; i++)
+    for (int j = 0; j < 3; j++) {
+        grid(i, j, 0).epsilon = 1 + i + 3*j;
+        thermo(i, j, 0).pressure = grid(i, j, 0).epsilon/3.;
+    }
+
+    std::vector<int> directions;
+    Neighbourloop2D(grid, 1, 1, 0, NLAMBDAS {
+        directions.push_back(direction);
+        const double step = (direction == 1 ? 1 : 3);
+        CHECK(p1.epsilon == c.epsilon + step);
+        CHECK(m1.epsilon == c.epsilon - step);
+    });
+    CHECK(directions == std::vector<int>({1, 2}));
+
+    int n_calls = 0;
+    Neighbourloop2D(grid, thermo, 1, 1, 0, NLAMBDAS_THERMO {
+        n_calls++;
+        CHECK(tp1.pressure == doctest::Approx(p1.epsilon/3.));
+        CHECK(tm1.pressure == doctest::Approx(m1.epsilon/3.));
+    });
+    CHECK(n_calls == 2);
+}
+
 TEST_CASE("check dimension"){
     SCGrid grid(1, 2,3);
 
@@ -83,3 +134,154 @@ TEST_CASE("check dimension"){
     CHECK(grid.nEta() == 3);
 }
 
+
+TEST_CASE("check neighbourloop with a companion grid"){
+    SCGrid grid(5, 1, 1);
+    ThermoGrid thermo(5, 1, 1);
+    for (int i = 0; i < 5; i++) {
+        grid(i, 0, 0).epsilon = i + 1;
+        thermo(i, 0, 0).pressure = (i + 1)/3.;
+    }
+    Neighbourloop(grid, thermo, 2, 0, 0, NLAMBDAS_THERMO {
+        CHECK(tc.pressure  == doctest::Approx(c.epsilon/3.));
+        CHECK(tp1.pressure == doctest::Approx(p1.epsilon/3.));
+        CHECK(tp2.pressure == doctest::Approx(p2.epsilon/3.));
+        CHECK(tm1.pressure == doctest::Approx(m1.epsilon/3.));
+        CHECK(tm2.pressure == doctest::Approx(m2.epsilon/3.));
+    });
+}
+
+
+TEST_CASE("check padded grid with outflow boundary"){
+    SCGrid grid(5, 3, 4);
+    for (int i = 0; i < grid.size(); i++) {
+        grid(i).epsilon = i + 1;
+    }
+    PaddedSCGrid padded(5, 3, 4);
+    padded.copy_interior(grid);
+    padded.fill_ghost_cells<OutflowGridBoundary>();
+    for (int i = 0; i < grid.size(); i++) {
+        CHECK(padded(i).epsilon == grid(i).epsilon);
+    }
+    for (int ieta = -2; ieta < 6; ieta++)
+    for (int iy = -2; iy < 5; iy++)
+    for (int ix = -2; ix < 7; ix++) {
+        CHECK(padded.getHalo(ix, iy, ieta).epsilon
+              == grid.getHalo(ix, iy, ieta).epsilon);
+    }
+    Neighbourloop(padded, 4, 0, 3, NLAMBDAS {
+        CHECK(c.epsilon == grid(4, 0, 3).epsilon);
+        if (direction == 1) {
+            CHECK(p1.epsilon == c.epsilon);
+            CHECK(m2.epsilon == grid(2, 0, 3).epsilon);
+        }
+    });
+}
+
+
+TEST_CASE("check padded grid with periodic boundary in eta"){
+    ThermoGrid thermo(2, 2, 3);
+    for (int ieta = 0; ieta < 3; ieta++) {
+        thermo(1, 1, ieta).pressure = ieta;
+    }
+    PaddedThermoGrid padded(2, 2, 3);
+    padded.copy_interior(thermo);
+    padded.fill_ghost_cells<PeriodicEtaGridBoundary>();
+    CHECK(padded.getHalo(1, 1, -1).pressure == 2);
+    CHECK(padded.getHalo(1, 1, -2).pressure == 1);
+    CHECK(padded.getHalo(1, 1,  3).pressure == 0);
+    CHECK(padded.getHalo(1, 1,  4).pressure == 1);
+    // the corners are set from the periodic layers in eta
+    CHECK(padded.getHalo(3, 3, -1).pressure == 2);
+    CHECK(padded.getHalo(-2, 1, 4).pressure == 0);
+}
+
+
+TEST_CASE("check neighbourloop on a stencil tile"){
+    SCGrid grid(5, 4, 3);
+    ThermoGrid thermo(5, 4, 3);
+    for (int i = 0; i < grid.size(); i++) {
+        grid(i).epsilon = i + 1;
+        thermo(i).pressure = (i + 1)/3.;
+    }
+    for (int ix : {0, 2, 4}) {
+        SCStencil stencil(grid, ix, 1, 2);
+        ThermoStencil thermo_stencil(thermo, ix, 1, 2);
+        std::vector<double> e_grid, e_tile;
+        Neighbourloop(grid, thermo, ix, 1, 2, NLAMBDAS_THERMO {
+            e_grid.push_back(c.epsilon);
+            e_grid.push_back(p1.epsilon + 10*p2.epsilon);
+            e_grid.push_back(m1.epsilon + 10*m2.epsilon);
+            e_grid.push_back(tp2.pressure - tm2.pressure);
+        });
+        Neighbourloop(stencil, thermo_stencil, ix, 1, 2,
+                      NLAMBDAS_THERMO_GENERIC {
+            e_tile.push_back(c.epsilon);
+            e_tile.push_back(p1.epsilon + 10*p2.epsilon);
+            e_tile.push_back(m1.epsilon + 10*m2.epsilon);
+            e_tile.push_back(tp2.pressure - tm2.pressure);
+        });
+        CHECK(e_grid == e_tile);
+    }
+}
+
+
+TEST_CASE("check grid tiling covers the grid in storage order"){
+    const int nx = 7, ny = 5, neta = 3;
+    for (int tile_ny : {0, 1, 2, 5, 9}) {
+        GridTiling tiling(nx, ny, neta, 4, tile_ny, 2);
+        std::vector<int> n_visits(nx*ny*neta, 0);
+        for (int itile = 0; itile < tiling.get_number_of_tiles(); itile++) {
+            int idx_prev = -1;
+            tiling.for_each_cell(itile, [&](int ix, int iy, int ieta) {
+                const int idx = nx*(ny*ieta + iy) + ix;
+                CHECK(idx > idx_prev);
+                idx_prev = idx;
+                n_visits[idx]++;
+            });
+        }
+        CHECK(std::count(n_visits.begin(), n_visits.end(), 1)
+              == nx*ny*neta);
+    }
+}
+
+
+TEST_CASE("check active region bounding box"){
+    SCGrid grid(10, 8, 6);
+    for (int i = 0; i < grid.size(); i++) grid(i).epsilon = 1e-5;
+    grid(4, 3, 2).epsilon = 1.;
+    grid(6, 3, 3).epsilon = 1.;
+    ActiveRegion region(10, 8, 6);
+    CHECK(region.is_full_grid());
+    region.update(grid, 1e-3, 2);
+    CHECK(region.get_x_min() == 2);
+    CHECK(region.get_x_max() == 9);
+    CHECK(region.get_y_min() == 1);
+    CHECK(region.get_y_max() == 6);
+    CHECK(region.get_eta_min() == 0);
+    CHECK(region.get_eta_max() == 6);
+    CHECK(region.is_active(8, 5, 0));
+    CHECK(!region.is_active(9, 5, 0));
+    CHECK(!region.is_full_grid());
+
+    InitData DATA;
+    DATA.grid_tile_size_x   = 3;
+    DATA.grid_tile_size_y   = 2;
+    DATA.grid_tile_size_eta = 4;
+    GridTiling tiling(DATA, region);
+    int n_cells = 0;
+    for (int itile = 0; itile < tiling.get_number_of_tiles(); itile++) {
+        tiling.for_each_cell(itile, [&](int ix, int iy, int ieta) {
+            CHECK(region.is_active(ix, iy, ieta));
+            n_cells++;
+        });
+    }
+    CHECK(n_cells == region.get_number_of_cells());
+
+    ActiveRegion vacuum;
+    vacuum.update(grid, 10., 2);
+    CHECK(vacuum.is_empty());
+    CHECK(GridTiling(DATA, vacuum).get_number_of_tiles() == 0);
+    vacuum.merge(region);
+    CHECK(vacuum.get_number_of_cells() == region.get_number_of_cells());
+}
@@ -0,0 +1,321 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#include "util.h"
+#include "deterministic_sum.h"
+#include "hadron_sampler.h"
+
+using Util::hbarc;
+
+namespace {
+    //! the number of events sampled in parallel before they are written
+    const int64_t kEventsPerBatch = 256;
+
+    //! a uniform number in [0, 1) from the 53 high bits of the stream
+    inline double get_uniform(std::mt19937_64 &rng) {
+        return((rng() >> 11)*(1./9007199254740992.));
+    }
+}
+
+
+void WalkerAliasTable::build(const std::vector<double> &weights) {
+    const int n = static_cast<int>(weights.size());
+    total_weight_ = 0.;
+    for (const double weight : weights) total_weight_ += weight;
+    probability_.assign(n, 1.);
+    alias_.resize(n);
+    for (int i = 0; i < n; i++) alias_[i] = i;
+    if (n == 0 || total_weight_ <= 0.) return;
+
+    // the scaled weights below 1 take their rest from the ones above 1
+    std::vector<int> small, large;
+    for (int i = 0; i < n; i++) {
+        probability_[i] = weights[i]*n/total_weight_;
+        if (probability_[i] < 1.) {
+            small.push_back(i);
+        } else {
+            large.push_back(i);
+        }
+    }
+    while (!small.empty() && !large.empty()) {
+        const int i_small = small.back();
+        small.pop_back();
+        const int i_large = large.back();
+        alias_[i_small] = i_large;
+        probability_[i_large] -= 1. - probability_[i_small];
+        if (probability_[i_large] < 1.) {
+            large.pop_back();
+            small.push_back(i_large);
+        }
+    }
+    // the rest is 1 up to the rounding
+    for (const int i : small) probability_[i] = 1.;
+    for (const int i : large) probability_[i] = 1.;
+}
+
+
+HadronSampler::HadronSampler(const std::vector<SamplerSpecies> &species,
+                             const int n_cells,
+                             const CellInfoFunction &get_cell_info,
+                             const int bulk_deltaf_kind,
+                             const int deltaf_14moments,
+                             const double eta_s_max, const uint64_t seed) :
+        species_(species), get_cell_info_(get_cell_info),
+        bulk_deltaf_kind_(bulk_deltaf_kind),
+        deltaf_14moments_(deltaf_14moments), eta_s_max_(eta_s_max),
+        seed_(seed), mean_candidates_(0.) {
+    const int n_species = static_cast<int>(species_.size());
+    T_.resize(n_cells);
+    muB_.resize(n_cells);
+    sigma_bound_.resize(n_cells);
+    density_sum_.resize(n_cells);
+    species_fraction_max_.assign(n_species, 0.);
+    std::vector<double> cell_weights(n_cells);
+    // the hadrons of a boost-invariant cell are spread over the eta_s range
+    const double eta_s_range = (eta_s_max_ > 0.) ? 2.*eta_s_max_ : 1.;
+    bool condensed = false;
+    #pragma omp parallel reduction(||:condensed)
+    {
+        std::vector<double> densities(n_species);
+        std::vector<double> fraction_max(n_species, 0.);
+        FreezeCellInfo cell;
+        double x, y;
+        #pragma omp for schedule(static)
+        for (int icell = 0; icell < n_cells; icell++) {
+            get_cell_info_(icell, cell, x, y);
+            T_[icell] = cell.T;
+            muB_[icell] = cell.muB;
+            // u.dSigma and dSigma.dSigma [fm^3] give the rest frame dSigma
+            const double tau = cell.tau;
+            const double *s = cell.sigma_mu;
+            const double *u = cell.u_flow;
+            const double sigma_0 = tau*(u[0]*s[0] + u[1]*s[1] + u[2]*s[2]
+                                        + u[3]*s[3]/tau);
+            const double sigma_2 = tau*tau*(s[0]*s[0] - s[1]*s[1]
+                                            - s[2]*s[2]
+                                            - s[3]*s[3]/(tau*tau));
+            const double sigma_perp = sqrt(std::max(
+                                        0., sigma_0*sigma_0 - sigma_2));
+            const bool with_deltaf = (cell.flag_shear_deltaf == 1
+                                      || cell.flag_bulk_deltaf == 1
+                                      || cell.flag_qmu_deltaf == 1);
+            sigma_bound_[icell] = ((std::abs(sigma_0) + sigma_perp)
+                                   *(with_deltaf ? 2. : 1.));
+            double density_sum = 0.;
+            for (int is = 0; is < n_species; is++) {
+                const SamplerSpecies &sp = species_[is];
+                if (sp.sign < 0.
+                        && sp.baryon*cell.muB + sp.mu_PCE >= sp.m) {
+                    condensed = true;
+                }
+                densities[is] = get_density_bound(sp, cell.T, cell.muB);
+                density_sum += densities[is];
+            }
+            density_sum_[icell] = density_sum;
+            cell_weights[icell] = sigma_bound_[icell]*density_sum*eta_s_range;
+            if (density_sum > 0.) {
+                for (int is = 0; is < n_species; is++) {
+                    fraction_max[is] = std::max(fraction_max[is],
+                                                densities[is]/density_sum);
+                }
+            }
+        }
+        // the maximum does not depend on the order of the threads
+        #pragma omp critical
+        for (int is = 0; is < n_species; is++) {
+            species_fraction_max_[is] = std::max(species_fraction_max_[is],
+                                                 fraction_max[is]);
+        }
+    }
+    if (condensed) {
+        music_message << "HadronSampler: the chemical potential of a boson "
+                      << "is above its mass on the surface";
+        music_message.flush("error");
+        exit(1);
+    }
+    cell_table_.build(cell_weights);
+    species_table_.build(species_fraction_max_);
+    // the thinning of the species keeps 1/sum_i max_c N_ic/sum_j N_jc of
+    // the candidates
+    mean_candidates_ = (DeterministicSum::sum(
+                            n_cells, [&](const int64_t i) {
+                                return(cell_weights[i]);})
+                        /(2.*M_PI*M_PI*hbarc*hbarc*hbarc)
+                        *species_table_.get_total_weight());
+}
+
+
+double HadronSampler::get_density_bound(const SamplerSpecies &species,
+                                        const double T,
+                                        const double muB) const {
+    const double m = species.m;
+    const double mu = species.baryon*muB + species.mu_PCE;
+    const double fugacity = exp((mu - m)/T);
+    const double r = (species.sign < 0.) ? 1./(1. - fugacity) : 1.;
+    return(species.deg*fugacity*T*(m*m + 2.*m*T + 2.*T*T)*r);
+}
+
+
+void HadronSampler::sample_candidate(
+                std::mt19937_64 &rng,
+                std::vector<SampledHadron> &hadrons) const {
+    const int icell = cell_table_.sample(get_uniform(rng), get_uniform(rng));
+    const int is = species_table_.sample(get_uniform(rng), get_uniform(rng));
+    const SamplerSpecies &sp = species_[is];
+    const double T = T_[icell];
+    const double fraction = (get_density_bound(sp, T, muB_[icell])
+                             /density_sum_[icell]);
+    if (get_uniform(rng)*species_fraction_max_[is] >= fraction) return;
+
+    // the kinetic energy from (k + m)^2 e^{-k/T}, the sum of the Gamma
+    // distributions of k^n e^{-k/T} of the weights m^2, 2 m T, 2 T^2,
+    // and p/E gives p^2 e^{-E/T} dp
+    const double m = sp.m;
+    const double weights[3] = {m*m, 2.*m*T, 2.*T*T};
+    const double r = get_uniform(rng)*(weights[0] + weights[1] + weights[2]);
+    const int n_gamma = (r < weights[0]) ? 1
+                        : (r < weights[0] + weights[1] ? 2 : 3);
+    double log_u = 0.;
+    for (int i = 0; i < n_gamma; i++) log_u += log(1. - get_uniform(rng));
+    const double k = -T*log_u;
+    const double E = k + m;
+    const double p = sqrt(k*(k + 2.*m));
+    if (get_uniform(rng)*E >= p) return;
+
+    // the momentum in the rest frame, boosted with u^mu
+    const double cos_theta = 2.*get_uniform(rng) - 1.;
+    const double sin_theta = sqrt(std::max(0., 1. - cos_theta*cos_theta));
+    const double phi = 2.*M_PI*get_uniform(rng);
+    const double p_rest[3] = {p*sin_theta*cos(phi), p*sin_theta*sin(phi),
+                              p*cos_theta};
+    FreezeCellInfo cell;
+    double x, y;
+    get_cell_info_(icell, cell, x, y);
+    const double *u = cell.u_flow;
+    const double u_dot_p = u[1]*p_rest[0] + u[2]*p_rest[1] + u[3]*p_rest[2];
+    const double ptau = u[0]*E + u_dot_p;
+    const double boost = u_dot_p/(1. + u[0]) + E;
+    const double px = p_rest[0] + boost*u[1];
+    const double py = p_rest[1] + boost*u[2];
+    const double peta = p_rest[2] + boost*u[3];
+    if (eta_s_max_ > 0.) {
+        cell.eta_s = eta_s_max_*(2.*get_uniform(rng) - 1.);
+        cell.cosh_eta_s = cosh(cell.eta_s);
+        cell.sinh_eta_s = sinh(cell.eta_s);
+    }
+
+    // the Cooper-Frye integrand over its bound
+    CooperFryeSpecies cf_species;
+    cf_species.m = m;
+    cf_species.baryon = sp.baryon;
+    cf_species.sign = sp.sign;
+    cf_species.mu = sp.baryon*cell.muB + sp.mu_PCE;
+    double f, delta_f_shear;
+    const double integrand = CooperFrye::get_integrand(
+                cell, bulk_deltaf_kind_, deltaf_14moments_, cf_species,
+                ptau, px, py, peta, f, delta_f_shear);
+    const double fugacity = exp((cf_species.mu - m)/T);
+    const double r_bose = (sp.sign < 0.) ? 1./(1. - fugacity) : 1.;
+    const double bound = (E*exp(-(E - cf_species.mu)/T)*r_bose
+                          *sigma_bound_[icell]);
+    if (get_uniform(rng)*bound >= integrand) return;
+
+    SampledHadron hadron;
+    hadron.species = is;
+    hadron.t = cell.tau*cell.cosh_eta_s;
+    hadron.x = x;
+    hadron.y = y;
+    hadron.z = cell.tau*cell.sinh_eta_s;
+    hadron.E = ptau*cell.cosh_eta_s + peta*cell.sinh_eta_s;
+    hadron.px = px;
+    hadron.py = py;
+    hadron.pz = ptau*cell.sinh_eta_s + peta*cell.cosh_eta_s;
+    hadrons.push_back(hadron);
+}
+
+
+void HadronSampler::sample_event(const int64_t ievent,
+                                 std::vector<SampledHadron> &hadrons) const {
+    hadrons.clear();
+    if (mean_candidates_ <= 0.) return;
+    std::seed_seq seeds = {static_cast<uint32_t>(seed_),
+                           static_cast<uint32_t>(seed_ >> 32),
+                           static_cast<uint32_t>(ievent),
+                           static_cast<uint32_t>(ievent >> 32)};
+    std::mt19937_64 rng(seeds);
+    std::poisson_distribution<int64_t> n_candidates_distribution(
+                                                        mean_candidates_);
+    const int64_t n_candidates = n_candidates_distribution(rng);
+    for (int64_t i = 0; i < n_candidates; i++) {
+        sample_candidate(rng, hadrons);
+    }
+}
+
+
+void HadronSampler::write_events(const std::string &filename,
+                                 const int64_t n_events) {
+    FILE *file = fopen(filename.c_str(), "w");
+    if (file == nullptr) {
+        music_message << "HadronSampler: can not open file " << filename;
+        music_message.flush("error");
+        exit(1);
+    }
+    fprintf(file, "#!OSCAR2013 particle_lists t x y z mass p0 px py pz "
+                  "pdg ID charge\n");
+    fprintf(file, "# Units: fm fm fm fm GeV GeV GeV GeV GeV none none e\n");
+    fprintf(file, "# MUSIC Cooper-Frye hadron sampler\n");
+    music_message << "sampling " << n_events << " events with "
+                  << mean_candidates_ << " candidates per event ...";
+    music_message.flush("info");
+    int64_t n_hadrons = 0;
+    // the events of a batch are sampled and formatted in parallel, and
+    // written in order
+    std::vector<std::string> batch(kEventsPerBatch);
+    for (int64_t first = 0; first < n_events; first += kEventsPerBatch) {
+        const int64_t n_batch = std::min(kEventsPerBatch, n_events - first);
+        #pragma omp parallel reduction(+:n_hadrons)
+        {
+            std::vector<SampledHadron> hadrons;
+            #pragma omp for schedule(dynamic)
+            for (int64_t i = 0; i < n_batch; i++) {
+                sample_event(first + i, hadrons);
+                format_event(first + i, hadrons, batch[i]);
+                n_hadrons += hadrons.size();
+            }
+        }
+        for (int64_t i = 0; i < n_batch; i++) {
+            fwrite(batch[i].data(), sizeof(char), batch[i].size(), file);
+        }
+    }
+    fclose(file);
+    music_message << "sampled " << n_hadrons << " hadrons, "
+                  << (n_events > 0 ? 1.*n_hadrons/n_events : 0.)
+                  << " per event, to " << filename;
+    music_message.flush("info");
+}
+
+
+void HadronSampler::format_event(const int64_t ievent,
+                                 const std::vector<SampledHadron> &hadrons,
+                                 std::string &text) const {
+    char line[256];
+    text.clear();
+    snprintf(line, sizeof(line), "# event %ld out %zu\n",
+             static_cast<long>(ievent), hadrons.size());
+    text += line;
+    for (size_t i = 0; i < hadrons.size(); i++) {
+        const SampledHadron &hadron = hadrons[i];
+        const SamplerSpecies &sp = species_[hadron.species];
+        snprintf(line, sizeof(line),
+                 "%.6e %.6e %.6e %.6e %.6e %.6e %.6e %.6e %.6e %d %zu %d\n",
+                 hadron.t, hadron.x, hadron.y, hadron.z, sp.m, hadron.E,
+                 hadron.px, hadron.py, hadron.pz, sp.number, i,
+                 static_cast<int>(round(sp.charge)));
+        text += line;
+    }
+    snprintf(line, sizeof(line), "# event %ld end\n",
+             static_cast<long>(ievent));
+    text += line;
+}
@@ -0,0 +1,155 @@
+#ifndef SRC_HADRON_SAMPLER_H_
+#define SRC_HADRON_SAMPLER_H_
+
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "cooper_frye_kernel.h"
+#include "pretty_ostream.h"
+
+//! This class draws the indices 0 ... n - 1 with the probabilities
+//! weights[i]/sum(weights) in constant time, by Walker's alias method
+//! (built with Vose's algorithm): the index i = floor(n u1) is kept if
+//! u2 < probability[i], and replaced by alias[i] otherwise.
+class WalkerAliasTable {
+ private:
+    std::vector<double> probability_;
+    std::vector<int> alias_;
+    double total_weight_;
+
+ public:
+    WalkerAliasTable() : total_weight_(0.) {}
+
+    //! builds the table of the weights (>= 0, with a positive sum)
+    void build(const std::vector<double> &weights);
+
+    int size() const {return(static_cast<int>(probability_.size()));}
+    double get_total_weight() const {return(total_weight_);}
+
+    //! the index for the uniform numbers u1, u2 in [0, 1)
+    int sample(const double u1, const double u2) const {
+        const int n = size();
+        int i = static_cast<int>(u1*n);
+        i = (i < n) ? i : n - 1;
+        return(u2 < probability_[i] ? i : alias_[i]);
+    }
+};
+
+
+//! a particle species of the sampler
+struct SamplerSpecies {
+    int number;                     // Monte-Carlo number
+    double m;                       // GeV
+    int deg;
+    int baryon;
+    double charge;
+    double sign;                    // -1 for bosons, +1 for fermions
+    double mu_PCE;                  // GeV, added to baryon*mu_B
+};
+
+
+//! a sampled hadron: the index of its species, its position [fm] and its
+//! momentum [GeV] in the Cartesian lab frame
+struct SampledHadron {
+    int species;
+    double t, x, y, z;
+    double E, px, py, pz;
+};
+
+
+//! This class samples the hadrons of many (oversampled) events from the
+//! Cooper-Frye formula on the freeze-out surface, for hadronic transport.
+//!
+//! The candidates of an event are the Poisson distributed upper bounds
+//!     N_ic = g_i/(2 pi^2) e^{(mu_i - m_i)/T} T (m_i^2 + 2 m_i T + 2 T^2)
+//!            r_i (|u.dSigma| + |dSigma_perp|) d_c
+//! of the Cooper-Frye yields of the species i in the cells c, with
+//! r_i = 1/(1 - e^{(mu_i - m_i)/T}) for the bosons (1 otherwise) and
+//! d_c = 2 with delta f (1 otherwise). A candidate draws its cell from a
+//! Walker alias table of sum_i N_ic, and its species from an alias table
+//! of max_c N_ic/sum_j N_jc which the ratio in its cell thins (the mean
+//! number of candidates includes the thinned ones). The momentum is drawn
+//! in the rest frame of the cell, with the kinetic energy from
+//! (k + m)^2 e^{-k/T}, and kept with the probability p/E times
+//!     max(0, (f_0 + delta f) p.dSigma)/(E e^{-(E - mu)/T} r_i
+//!                                       (|u.dSigma| + |dSigma_perp|) d_c)
+//! with the integrand of the spectra (CooperFrye::get_integrand), so the
+//! hadrons follow the positive part of the Cooper-Frye distribution with
+//! the quantum statistics and the delta f of the spectra. Boost-invariant
+//! surfaces are at eta_s = 0; their hadrons are spread uniformly in eta_s
+//! in [-eta_s_max, eta_s_max].
+//!
+//! Each event has its own random stream, seeded from (seed, event), and
+//! the events are sampled in parallel, so the events do not depend on the
+//! number of threads.
+class HadronSampler {
+ public:
+    //! fills the cell quantities of the surface cell icell, and its
+    //! transverse position x, y [fm]
+    typedef std::function<void(const int icell, FreezeCellInfo &cell,
+                               double &x, double &y)> CellInfoFunction;
+
+ private:
+    pretty_ostream music_message;
+    const std::vector<SamplerSpecies> species_;
+    const CellInfoFunction get_cell_info_;
+    const int bulk_deltaf_kind_;
+    const int deltaf_14moments_;
+    const double eta_s_max_;
+    const uint64_t seed_;
+
+    //! the temperature and mu_B [GeV], the bound of the Cooper-Frye
+    //! integrand over E f_0 (the sum in the rest frame times d_c), and the
+    //! sum over the species of the bound densities, of [cell]
+    std::vector<double> T_, muB_;
+    std::vector<double> sigma_bound_;
+    std::vector<double> density_sum_;
+    WalkerAliasTable cell_table_;
+    WalkerAliasTable species_table_;
+    //! the maximum over the cells of the fraction of the species
+    std::vector<double> species_fraction_max_;
+    double mean_candidates_;
+
+    //! the bound density of the species at T, mu_B [GeV] without
+    //! 1/(2 pi^2 hbarc^3)
+    double get_density_bound(const SamplerSpecies &species, const double T,
+                             const double muB) const;
+
+    //! tries the candidate of a cell and a species, and adds its hadron to
+    //! hadrons if it is kept
+    void sample_candidate(std::mt19937_64 &rng,
+                          std::vector<SampledHadron> &hadrons) const;
+
+ public:
+    //! sets up the tables of the n_cells surface cells; the surface of a
+    //! boost-invariant run has eta_s_max > 0
+    HadronSampler(const std::vector<SamplerSpecies> &species,
+                  const int n_cells, const CellInfoFunction &get_cell_info,
+                  const int bulk_deltaf_kind, const int deltaf_14moments,
+                  const double eta_s_max, const uint64_t seed);
+
+    //! the mean number of candidates per event
+    double get_mean_number_of_candidates() const {return(mean_candidates_);}
+
+    const SamplerSpecies &get_species(const int i) const {
+        return(species_[i]);
+    }
+
+    //! samples the event ievent
+    void sample_event(const int64_t ievent,
+                      std::vector<SampledHadron> &hadrons) const;
+
+    //! samples the events [0, n_events) in parallel and writes them to
+    //! filename in the OSCAR2013 particle list format
+    void write_events(const std::string &filename, const int64_t n_events);
+
+    //! the lines of the hadrons of the event ievent in the OSCAR2013 format
+    void format_event(const int64_t ievent,
+                      const std::vector<SampledHadron> &hadrons,
+                      std::string &text) const;
+};
+
+#endif  // SRC_HADRON_SAMPLER_H_
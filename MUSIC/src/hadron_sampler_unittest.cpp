@@ -0,0 +1,186 @@
+#ifdef _OPENMP
+    #include <omp.h>
+#endif
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "doctest.h"
+#include "util.h"
+#include "hadron_sampler.h"
+
+using Util::hbarc;
+
+namespace {
+    //! a cell at rest in the lab, or moving with the velocity v along x,
+    //! with dSigma_mu = V u_mu
+    void set_cell(const double T, const double volume, const double v,
+                  FreezeCellInfo &cell) {
+        std::memset(&cell, 0, sizeof(FreezeCellInfo));
+        const double gamma = 1./sqrt(1. - v*v);
+        cell.tau = 1.;
+        cell.cosh_eta_s = 1.;
+        cell.T = T;
+        cell.u_flow[0] = gamma;
+        cell.u_flow[1] = gamma*v;
+        cell.sigma_mu[0] = volume*gamma;
+        cell.sigma_mu[1] = -volume*gamma*v;
+    }
+
+    //! the density [1/fm^3] and the mean energy in the rest frame of the
+    //! species at T and mu_B = 0
+    void get_thermal_density(const SamplerSpecies &species, const double T,
+                             double &density, double &mean_energy) {
+        const int n_p = 20000;
+        const double dp = 10.*T/n_p;
+        double sum = 0., sum_E = 0.;
+        for (int i = 1; i <= n_p; i++) {
+            const double p = i*dp;
+            const double E = sqrt(p*p + species.m*species.m);
+            const double f = 1./(exp(E/T) + species.sign);
+            sum += p*p*f*dp;
+            sum_E += E*p*p*f*dp;
+        }
+        density = species.deg*sum/(2.*M_PI*M_PI*hbarc*hbarc*hbarc);
+        mean_energy = sum_E/sum;
+    }
+}
+
+
+TEST_CASE("Check WalkerAliasTable draws the indices with their weights") {
+    WalkerAliasTable table;
+    table.build({1., 0., 3., 6.});
+    CHECK(table.size() == 4);
+    CHECK(table.get_total_weight() == 10.);
+    const int n_u = 1000;
+    std::vector<int> counts(4, 0);
+    for (int i1 = 0; i1 < n_u; i1++) {
+        for (int i2 = 0; i2 < n_u; i2++) {
+            counts[table.sample((i1 + 0.5)/n_u, (i2 + 0.5)/n_u)]++;
+        }
+    }
+    CHECK(counts[1] == 0);
+    CHECK(counts[0]/(1.*n_u*n_u) == doctest::Approx(0.1).epsilon(1e-3));
+    CHECK(counts[2]/(1.*n_u*n_u) == doctest::Approx(0.3).epsilon(1e-3));
+    CHECK(counts[3]/(1.*n_u*n_u) == doctest::Approx(0.6).epsilon(1e-3));
+}
+
+
+TEST_CASE("Check HadronSampler gives the thermal yields of a cell") {
+    const double T = 0.15;
+    const double volume = 500.;
+    const std::vector<SamplerSpecies> species = {
+        {211, 0.13957, 1, 0, 1., -1., 0.},
+        {2212, 0.93827, 2, 1, 1., 1., 0.},
+    };
+    const int n_events = 1000;
+    for (const double v : {0., 0.6}) {
+        FreezeCellInfo cell_in;
+        set_cell(T, volume, v, cell_in);
+        HadronSampler sampler(
+            species, 1,
+            [&](const int icell, FreezeCellInfo &cell, double &x, double &y) {
+                cell = cell_in;
+                x = 1.;
+                y = -2.;
+            }, 0, 0, 0., 1);
+        std::vector<double> counts(2, 0.), energy(2, 0.);
+        std::vector<double> px(2, 0.), px2(2, 0.);
+        std::vector<SampledHadron> hadrons;
+        for (int ievent = 0; ievent < n_events; ievent++) {
+            sampler.sample_event(ievent, hadrons);
+            for (const auto &hadron : hadrons) {
+                counts[hadron.species] += 1.;
+                energy[hadron.species] += hadron.E;
+                px[hadron.species] += hadron.px;
+                px2[hadron.species] += hadron.px*hadron.px;
+                CHECK(hadron.x == 1.);
+                CHECK(hadron.z == 0.);
+                CHECK(hadron.E*hadron.E
+                      == doctest::Approx(
+                            hadron.px*hadron.px + hadron.py*hadron.py
+                            + hadron.pz*hadron.pz
+                            + species[hadron.species].m
+                              *species[hadron.species].m));
+            }
+        }
+        for (int is = 0; is < 2; is++) {
+            double density, mean_energy;
+            get_thermal_density(species[is], T, density, mean_energy);
+            const double expected = density*volume*n_events;
+            // within 4 standard deviations
+            CHECK(std::abs(counts[is] - expected) < 4.*sqrt(expected));
+            // the lab energy and momentum of the moving cell
+            const double gamma = 1./sqrt(1. - v*v);
+            CHECK(energy[is]/counts[is]
+                  == doctest::Approx(gamma*mean_energy).epsilon(0.02));
+            const double mean_px = px[is]/counts[is];
+            const double sigma_px = sqrt(
+                    (px2[is]/counts[is] - mean_px*mean_px)/counts[is]);
+            CHECK(std::abs(mean_px - gamma*v*mean_energy) < 4.*sigma_px);
+        }
+    }
+
+    // the events are their own streams
+    FreezeCellInfo cell_in;
+    set_cell(T, volume, 0., cell_in);
+    HadronSampler sampler(
+        species, 1,
+        [&](const int icell, FreezeCellInfo &cell, double &x, double &y) {
+            cell = cell_in;
+            x = y = 0.;
+        }, 0, 0, 0., 2);
+    std::vector<SampledHadron> event_a, event_b, event_c;
+    sampler.sample_event(7, event_a);
+    sampler.sample_event(8, event_c);
+    sampler.sample_event(7, event_b);
+    REQUIRE(event_a.size() == event_b.size());
+    for (size_t i = 0; i < event_a.size(); i++) {
+        CHECK(event_a[i].species == event_b[i].species);
+        CHECK(event_a[i].E == event_b[i].E);
+        CHECK(event_a[i].px == event_b[i].px);
+    }
+    CHECK((event_a.size() != event_c.size()
+           || event_a[0].E != event_c[0].E));
+}
+
+
+#ifdef _OPENMP
+TEST_CASE("Check HadronSampler events do not depend on the number of threads") {
+    const std::vector<SamplerSpecies> species = {
+        {211, 0.13957, 1, 0, 1., -1., 0.},
+        {-321, 0.49368, 1, 0, -1., -1., 0.},
+    };
+    HadronSampler sampler(
+        species, 20,
+        [&](const int icell, FreezeCellInfo &cell, double &x, double &y) {
+            set_cell(0.15, 2. + icell, 0.03*icell, cell);
+            cell.eta_s = 0.1*icell;
+            cell.cosh_eta_s = cosh(cell.eta_s);
+            cell.sinh_eta_s = sinh(cell.eta_s);
+            x = 0.5*icell;
+            y = 0.;
+        }, 0, 0, 0., 3);
+    auto read_file = [](const std::string &filename) {
+        std::ifstream file(filename);
+        return(std::string(std::istreambuf_iterator<char>(file),
+                           std::istreambuf_iterator<char>()));
+    };
+    const int n_threads_max = omp_get_max_threads();
+    omp_set_num_threads(1);
+    sampler.write_events("test_sampled_particles.dat", 300);
+    const std::string events_1 = read_file("test_sampled_particles.dat");
+    omp_set_num_threads(3);
+    sampler.write_events("test_sampled_particles.dat", 300);
+    const std::string events_3 = read_file("test_sampled_particles.dat");
+    omp_set_num_threads(n_threads_max);
+    CHECK(events_1.substr(0, 11) == "#!OSCAR2013");
+    CHECK(events_1.find("# event 299 end\n") != std::string::npos);
+    CHECK(events_1 == events_3);
+    std::remove("test_sampled_particles.dat");
+}
+#endif
@@ -0,0 +1,201 @@
+#include <fcntl.h>
+#include <unistd.h>
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include "float_codec.h"
+#include "hydro_history_spill.h"
+
+namespace {
+    //! the scratch files of the spills of this process
+    std::atomic<int> n_spill_files(0);
+}
+
+const int HydroHistorySpill::kMaxPendingSlices;
+
+
+HydroHistorySpill::HydroHistorySpill(const std::string &directory,
+                                     const int n_cache_slices,
+                                     const int codec) :
+        fd_(-1), file_size_(0),
+        codec_(FloatCodec::is_available(codec) ? codec : FloatCodec::kRaw),
+        n_cache_slices_(n_cache_slices), stop_(false), n_loads_(0),
+        n_cache_misses_(0), memory_(MemorySubsystem::hydro_history) {
+    std::ostringstream filename;
+    filename << directory << "/music_hydro_history_" << getpid() << "_"
+             << n_spill_files++ << ".spill";
+    fd_ = open(filename.str().c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd_ < 0) {
+        music_message << "HydroHistorySpill: can not open the scratch file "
+                      << filename.str() << ": " << strerror(errno);
+        music_message.flush("error");
+        exit(1);
+    }
+    // the open descriptor keeps the file until it is closed
+    unlink(filename.str().c_str());
+    writer_ = std::thread(&HydroHistorySpill::run_writer, this);
+}
+
+
+HydroHistorySpill::~HydroHistorySpill() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    slice_submitted_.notify_one();
+    writer_.join();
+    close(fd_);
+}
+
+
+void HydroHistorySpill::spill(const int itau, std::vector<float> &&slice) {
+    SliceData data = std::make_shared<const std::vector<float>>(
+                                                        std::move(slice));
+    std::unique_lock<std::mutex> lock(mutex_);
+    slice_written_.wait(lock, [this] {
+        return(static_cast<int>(pending_.size()) < kMaxPendingSlices);
+    });
+    if (static_cast<int>(records_.size()) <= itau) {
+        records_.resize(itau + 1);
+    }
+    pending_[itau] = data;
+    queue_.emplace_back(itau, std::move(data));
+    update_memory_use();
+    lock.unlock();
+    slice_submitted_.notify_one();
+}
+
+
+HydroHistorySpill::SliceData HydroHistorySpill::load(const int itau) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    n_loads_++;
+    auto cached = cache_index_.find(itau);
+    if (cached != cache_index_.end()) {
+        cache_.splice(cache_.begin(), cache_, cached->second);
+        return(cached->second->second);
+    }
+    auto pending = pending_.find(itau);
+    if (pending != pending_.end()) return(pending->second);
+    if (itau < 0 || itau >= static_cast<int>(records_.size())
+            || records_[itau].offset < 0) {
+        music_message << "HydroHistorySpill: the slice " << itau
+                      << " was not spilled";
+        music_message.flush("error");
+        exit(1);
+    }
+    const Record record = records_[itau];
+    n_cache_misses_++;
+    lock.unlock();
+
+    // the slice is read without the lock, the threads of the queries read
+    // their slices at the same time
+    std::vector<unsigned char> stored(record.stored_size);
+    int64_t n_read = 0;
+    while (n_read < record.stored_size) {
+        const ssize_t n = pread(fd_, stored.data() + n_read,
+                                record.stored_size - n_read,
+                                record.offset + n_read);
+        if (n <= 0) break;
+        n_read += n;
+    }
+    auto values = std::make_shared<std::vector<float>>(record.n_values);
+    if (n_read != record.stored_size
+            || !FloatCodec::decompress(record.codec, stored.data(),
+                                       stored.size(), values->size(),
+                                       values->data())) {
+        music_message << "HydroHistorySpill: can not read back the slice "
+                      << itau;
+        music_message.flush("error");
+        exit(1);
+    }
+
+    lock.lock();
+    cached = cache_index_.find(itau);
+    if (cached != cache_index_.end()) return(cached->second->second);
+    cache_.emplace_front(itau, std::move(values));
+    cache_index_[itau] = cache_.begin();
+    while (static_cast<int>(cache_.size()) > n_cache_slices_) {
+        cache_index_.erase(cache_.back().first);
+        cache_.pop_back();
+    }
+    update_memory_use();
+    return(cache_.front().second);
+}
+
+
+void HydroHistorySpill::flush() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    slice_written_.wait(lock, [this] {return(pending_.empty());});
+}
+
+
+int64_t HydroHistorySpill::get_file_size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return(file_size_);
+}
+
+
+int64_t HydroHistorySpill::get_number_of_loads() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return(n_loads_);
+}
+
+
+int64_t HydroHistorySpill::get_number_of_cache_misses() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return(n_cache_misses_);
+}
+
+
+void HydroHistorySpill::run_writer() {
+    std::vector<unsigned char> stored;
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        slice_submitted_.wait(lock, [this] {
+            return(stop_ || !queue_.empty());
+        });
+        if (queue_.empty()) break;  // stop_ with everything written
+        auto job = std::move(queue_.front());
+        queue_.pop_front();
+        const int64_t offset = file_size_;
+        lock.unlock();
+
+        // only this thread appends to the file
+        Record record;
+        record.codec = FloatCodec::compress(codec_, job.second->data(),
+                                            job.second->size(), stored);
+        record.offset = offset;
+        record.stored_size = static_cast<int64_t>(stored.size());
+        record.n_values = static_cast<int64_t>(job.second->size());
+        int64_t n_written = 0;
+        while (n_written < record.stored_size) {
+            const ssize_t n = pwrite(fd_, stored.data() + n_written,
+                                     record.stored_size - n_written,
+                                     offset + n_written);
+            if (n <= 0) {
+                music_message << "HydroHistorySpill: can not write the "
+                              << "scratch file: " << strerror(errno);
+                music_message.flush("error");
+                exit(1);
+            }
+            n_written += n;
+        }
+
+        lock.lock();
+        records_[job.first] = record;
+        file_size_ += record.stored_size;
+        pending_.erase(job.first);
+        update_memory_use();
+        slice_written_.notify_all();
+    }
+}
+
+
+void HydroHistorySpill::update_memory_use() {
+    int64_t n_values = 0;
+    for (const auto &slice : cache_) n_values += slice.second->capacity();
+    for (const auto &slice : pending_) n_values += slice.second->capacity();
+    memory_.set(n_values*static_cast<int64_t>(sizeof(float)));
+}
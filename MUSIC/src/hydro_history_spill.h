@@ -0,0 +1,105 @@
+#ifndef SRC_HYDRO_HISTORY_SPILL_H_
+#define SRC_HYDRO_HISTORY_SPILL_H_
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "memory_accounting.h"
+#include "pretty_ostream.h"
+
+//! This class keeps the tau slices of the hydro history which were
+//! spilled out of memory in a scratch file. A spilled slice is handed to
+//! a writer thread, which compresses it (FloatCodec, zlib if compiled in)
+//! and appends it to the file while the evolution goes on; at most
+//! kMaxPendingSlices slices wait for the writer. load() pages a slice back
+//! in through an LRU cache of n_cache_slices slices keyed by the tau
+//! index, and may be called from many threads at once.
+//!
+//! The scratch file is removed from the directory as soon as it is
+//! opened, so it disappears with the process even after a crash.
+class HydroHistorySpill {
+ public:
+    //! the values of a tau slice, shared with the queries using it
+    typedef std::shared_ptr<const std::vector<float>> SliceData;
+
+    static const int kMaxPendingSlices = 2;
+
+ private:
+    //! the position of a slice in the scratch file
+    struct Record {
+        int64_t offset = -1;
+        int64_t stored_size = 0;
+        int64_t n_values = 0;
+        int codec = 0;
+    };
+
+    int fd_;
+    int64_t file_size_;
+    const int codec_;
+    const int n_cache_slices_;
+    //! [itau], offset -1 while the slice is not written
+    std::vector<Record> records_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable slice_submitted_;
+    std::condition_variable slice_written_;
+    //! the slices waiting for the writer, and the one being written
+    std::deque<std::pair<int, SliceData>> queue_;
+    std::unordered_map<int, SliceData> pending_;
+    bool stop_;
+    std::thread writer_;
+
+    //! the slices paged in, most recently used first
+    std::list<std::pair<int, SliceData>> cache_;
+    std::unordered_map<int, std::list<std::pair<int, SliceData>>::iterator>
+                                                                cache_index_;
+    int64_t n_loads_;
+    int64_t n_cache_misses_;
+    MemoryRegistration memory_;
+    pretty_ostream music_message;
+
+    void run_writer();
+
+    //! books the bytes of the cache and of the pending slices (called
+    //! with the lock held)
+    void update_memory_use();
+
+ public:
+    //! opens the scratch file in directory and starts the writer; the
+    //! slices are compressed with the FloatCodec codec if it is available
+    HydroHistorySpill(const std::string &directory, const int n_cache_slices,
+                      const int codec);
+    //! stops the writer and closes the scratch file
+    ~HydroHistorySpill();
+
+    HydroHistorySpill(const HydroHistorySpill&) = delete;
+    HydroHistorySpill& operator=(const HydroHistorySpill&) = delete;
+
+    //! hands the slice itau to the writer, waiting for it if
+    //! kMaxPendingSlices slices are not written yet
+    void spill(const int itau, std::vector<float> &&slice);
+
+    //! returns the slice itau: from the cache, from the slices waiting
+    //! for the writer, or read back from the scratch file into the cache
+    SliceData load(const int itau);
+
+    //! waits until all spilled slices are in the scratch file
+    void flush();
+
+    //! the bytes of the scratch file
+    int64_t get_file_size() const;
+    //! the number of loads, and the ones read back from the file
+    int64_t get_number_of_loads() const;
+    int64_t get_number_of_cache_misses() const;
+};
+
+#endif  // SRC_HYDRO_HISTORY_SPILL_H_
@@ -9,6 +9,7 @@
 #include <memory>
 
 #include "hydro_source_TATB.h"
+#include "eta_grid.h"
 #include "util.h"
 
 using std::string;
@@ -94,6 +95,41 @@ void HydroSourceTATB::read_in_TATB() {
     music_message.flush("info");
     music_message << "Longitudinal velocity fraction yL_frac = " << yL_frac_;
     music_message.flush("info");
+    set_source_columns();
+}
+
+
+void HydroSourceTATB::set_source_columns() {
+    double eta_flat = DATA_.eta_flat;
+    if (DATA_.ecm > 2000.) {
+        // at LHC energies, we vary eta_flat according to TA + TB
+        double total_num_nucleons = 208.*2.;  // for PbPb runs
+        double slope = -0.4;
+        eta_flat = eta_flat + ((TA_ + TB_)/total_num_nucleons - 0.5)*slope;
+    }
+
+    const int nx = DATA_.nx;
+    const int ny = DATA_.ny;
+    columns_.resize(nx*ny);
+    for (int ix = 0; ix < nx; ix++)
+    for (int iy = 0; iy < ny; iy++) {
+        SourceColumn &column = columns_[ix*ny + iy];
+        column.y_CM = atanh((profile_TA[ix][iy] - profile_TB[ix][iy])
+                            /(profile_TA[ix][iy] + profile_TB[ix][iy]
+                              + Util::small_eps)
+                            *tanh(DATA_.beam_rapidity));
+        column.y_L = yL_frac_*column.y_CM;
+        column.M_inv = ((profile_TA[ix][iy] + profile_TB[ix][iy])
+                        *Util::m_N*cosh(DATA_.beam_rapidity)
+                        /Util::hbarc);  // [1/fm^3]
+        column.eta0 = std::min(
+                eta_flat/2.0,
+                std::abs(DATA_.beam_rapidity - (column.y_CM - column.y_L)));
+        column.E_norm = tau_source*energy_eta_profile_normalisation(
+                                column.y_CM, column.eta0, DATA_.eta_fall_off);
+        column.cosh_y_L = cosh(column.y_L);
+        column.sinh_y_L = sinh(column.y_L);
+    }
 }
 
 
@@ -107,35 +143,17 @@ void HydroSourceTATB::get_hydro_energy_source(
     const int ix = static_cast<int>((x + DATA_.x_size/2.)/DATA_.delta_x + 0.1);
     const int iy = static_cast<int>((y + DATA_.y_size/2.)/DATA_.delta_y + 0.1);
 
-    double eta_flat = DATA_.eta_flat;
-    if (DATA_.ecm > 2000.) {
-        // at LHC energies, we vary eta_flat according to TA + TB
-        double total_num_nucleons = 208.*2.;  // for PbPb runs
-        double slope = -0.4;
-        eta_flat = eta_flat + ((TA_ + TB_)/total_num_nucleons - 0.5)*slope;
-    }
-
-    double y_CM = atanh((profile_TA[ix][iy] - profile_TB[ix][iy])
-                        /(profile_TA[ix][iy] + profile_TB[ix][iy]
-                          + Util::small_eps)
-                        *tanh(DATA_.beam_rapidity));
-    double y_L = yL_frac_*y_CM;
-    double M_inv = ((profile_TA[ix][iy] + profile_TB[ix][iy])
-                    *Util::m_N*cosh(DATA_.beam_rapidity)/Util::hbarc);  // [1/fm^3]
-    double eta0 = std::min(eta_flat/2.0,
-                           std::abs(DATA_.beam_rapidity - (y_CM - y_L)));
-    double eta_envelop = eta_profile_plateau(eta_s - (y_CM - y_L), eta0,
-                                             DATA_.eta_fall_off);
-    double E_norm = tau_source*energy_eta_profile_normalisation(
-                                    y_CM, eta0, DATA_.eta_fall_off);
+    const SourceColumn &column = columns_[ix*DATA_.ny + iy];
+    double eta_envelop = eta_profile_plateau(
+            eta_s - (column.y_CM - column.y_L), column.eta0,
+            DATA_.eta_fall_off);
     //double eta_envelop = eta_profile_plateau_frag(eta_s - (y_CM - y_L), eta0,
     //                                              DATA_.eta_fall_off);
     //double E_norm = tau_source*energy_eta_profile_normalisation_numerical(
     //                                y_CM, eta0, DATA_.eta_fall_off);
-    //std::cout << "check E_norm1 = " << E_norm1 << ", E_norm = " << E_norm << std::endl;
-    double epsilon = M_inv*eta_envelop/E_norm/dtau;  // [1/fm^5]
-    j_mu[0] = epsilon*cosh(y_L);  // [1/fm^5]
-    j_mu[3] = epsilon*sinh(y_L);  // [1/fm^5]
+    double epsilon = column.M_inv*eta_envelop/column.E_norm/dtau;  // [1/fm^5]
+    j_mu[0] = epsilon*column.cosh_y_L;  // [1/fm^5]
+    j_mu[3] = epsilon*column.sinh_y_L;  // [1/fm^5]
 }
 
 
@@ -156,6 +174,61 @@ double HydroSourceTATB::get_hydro_rhob_source(
 }
 
 
+bool HydroSourceTATB::fill_source_grid(const double tau, const InitData &DATA,
+                                       const SCGrid &arena,
+                                       SourceGrid &sources) const {
+    const int nx   = arena.nX();
+    const int ny   = arena.nY();
+    const int neta = arena.nEta();
+    if (nx != DATA_.nx || ny != DATA_.ny) return(false);
+
+    const double dtau = DATA_.delta_tau;
+    if (std::abs((tau - tau_source)) > 1./2.*dtau) {
+        #pragma omp parallel for schedule(static)
+        for (int i = 0; i < sources.size(); i++) sources(i) = {0.};
+        return(true);
+    }
+
+    // the net baryon factors only depend on the eta slice
+    const bool with_rhob = (DATA.turn_on_rhob == 1);
+    const EtaGrid eta_grid(DATA);
+    std::vector<double> eta_s_table(neta);
+    std::vector<double> rhob_left_table(neta, 0.), rhob_right_table(neta, 0.);
+    for (int ieta = 0; ieta < neta; ieta++) {
+        eta_s_table[ieta] = eta_grid.get_eta(ieta);
+        if (with_rhob) {
+            rhob_left_table[ieta]  = eta_rhob_left_factor(eta_s_table[ieta]);
+            rhob_right_table[ieta] = eta_rhob_right_factor(eta_s_table[ieta]);
+        }
+    }
+
+    #pragma omp parallel for collapse(2) schedule(static)
+    for (int ieta = 0; ieta < neta; ieta++)
+    for (int ix   = 0; ix   < nx;   ix++  ) {
+        const double eta_s = eta_s_table[ieta];
+        for (int iy = 0; iy < ny; iy++) {
+            const SourceColumn &column = columns_[ix*ny + iy];
+            const double eta_envelop = eta_profile_plateau(
+                    eta_s - (column.y_CM - column.y_L), column.eta0,
+                    DATA_.eta_fall_off);
+            const double epsilon = (
+                    column.M_inv*eta_envelop/column.E_norm/dtau);  // [1/fm^5]
+            TJbVec &source = sources(ix, iy, ieta);
+            source = {0.};
+            source[0] = tau*(epsilon*column.cosh_y_L);
+            source[3] = tau*(epsilon*column.sinh_y_L);
+            if (with_rhob) {
+                const double rhob = (
+                    (  profile_TA[ix][iy]*rhob_right_table[ieta]
+                     + profile_TB[ix][iy]*rhob_left_table[ieta])/dtau);
+                source[4] = tau*rhob;
+            }
+        }
+    }
+    return(true);
+}
+
+
 double HydroSourceTATB::eta_rhob_left_factor(const double eta) const {
     double eta_0       = -std::abs(DATA_.eta_rhob_0);
     double delta_eta_1 = DATA_.eta_rhob_width_1;
@@ -10,12 +10,24 @@
 
 class HydroSourceTATB : public HydroSourceBase {
  private:
+    //! the quantities of the energy source of a transverse column, which
+    //! only depend on TA and TB of the column
+    struct SourceColumn {
+        double y_CM, y_L, M_inv, eta0, E_norm;
+        double cosh_y_L, sinh_y_L;
+    };
+
     const InitData &DATA_;
     double yL_frac_;
     double tau_source;
     double TA_, TB_;
     std::vector<std::vector<double>> profile_TA;
     std::vector<std::vector<double>> profile_TB;
+    //! the columns of [ix*ny + iy], set once after the thickness functions
+    //! are read
+    std::vector<SourceColumn> columns_;
+
+    void set_source_columns();
 
  public:
     HydroSourceTATB() = default;
@@ -44,6 +56,11 @@ class HydroSourceTATB : public HydroSourceBase {
     double get_hydro_rhob_source(const double tau, const double x,
                                  const double y, const double eta_s,
                                  const FlowVec &u_mu) const ;
+
+    //! fills the sources of the grid of the thickness functions with the
+    //! columns and the net baryon eta factors of the slices tabulated once
+    bool fill_source_grid(const double tau, const InitData &DATA,
+                          const SCGrid &arena, SourceGrid &sources) const;
     double eta_profile_plateau_frag(
         const double eta, const double eta_0, const double sigma_eta) const;
     double energy_eta_profile_normalisation_numerical(
@@ -0,0 +1,89 @@
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include "doctest.h"
+#include "hydro_source_TATB.h"
+
+namespace {
+    InitData make_test_data() {
+        InitData DATA;
+        DATA.nx = 9;
+        DATA.ny = 7;
+        DATA.x_size = 4.;
+        DATA.y_size = 3.;
+        DATA.eta_size = 4.;
+        DATA.delta_x = 0.5;
+        DATA.delta_y = 0.5;
+        DATA.delta_eta = 0.5;
+        DATA.eta_index_offset = 0;
+        DATA.turn_on_rhob = 1;
+        DATA.tau0 = 0.4;
+        DATA.delta_tau = 0.02;
+        DATA.ecm = 19.6;
+        DATA.beam_rapidity = std::acosh(19.6/2./0.938);
+        DATA.eta_flat = 2.;
+        DATA.eta_fall_off = 0.6;
+        DATA.yL_frac = 0.3;
+        DATA.eta_rhob_0 = 1.5;
+        DATA.eta_rhob_width_1 = 0.3;
+        DATA.eta_rhob_width_2 = 0.8;
+        DATA.initName_TA = "test_TA.dat";
+        DATA.initName_TB = "test_TB.dat";
+        return(DATA);
+    }
+
+    void write_thickness_files(const InitData &DATA) {
+        std::ofstream TA(DATA.initName_TA.c_str());
+        std::ofstream TB(DATA.initName_TB.c_str());
+        for (int ix = 0; ix < DATA.nx; ix++) {
+            for (int iy = 0; iy < DATA.ny; iy++) {
+                const double x = - DATA.x_size/2. + ix*DATA.delta_x;
+                const double y = - DATA.y_size/2. + iy*DATA.delta_y;
+                TA << 3.*exp(-((x - 0.5)*(x - 0.5) + y*y)/2.) << " ";
+                TB << 2.*exp(-((x + 0.5)*(x + 0.5) + 1.5*y*y)/2.) << " ";
+            }
+            TA << std::endl;
+            TB << std::endl;
+        }
+    }
+}
+
+TEST_CASE("Check HydroSourceTATB fills the grid like the point interface") {
+    const InitData DATA = make_test_data();
+    write_thickness_files(DATA);
+    HydroSourceTATB source(DATA);
+    SCGrid arena(DATA.nx, DATA.ny, 9);
+    SourceGrid sources;
+    const double tau_source = source.get_source_tau_min();
+    for (const double tau : {tau_source, tau_source + 0.1}) {
+        source.deposit_sources(tau, DATA, arena, sources);
+        REQUIRE(sources.nEta() == 9);
+        double e_sum = 0.;
+        for (int ieta = 0; ieta < 9; ieta++)
+        for (int ix = 0; ix < DATA.nx; ix++)
+        for (int iy = 0; iy < DATA.ny; iy++) {
+            const double x = - DATA.x_size/2. + ix*DATA.delta_x;
+            const double y = - DATA.y_size/2. + iy*DATA.delta_y;
+            const double eta_s = - DATA.eta_size/2. + ieta*DATA.delta_eta;
+            const FlowVec &u = arena(ix, iy, ieta).u;
+            EnergyFlowVec j_mu;
+            source.get_hydro_energy_source(tau, x, y, eta_s, u, j_mu);
+            const double rhob = source.get_hydro_rhob_source(tau, x, y,
+                                                             eta_s, u);
+            const TJbVec &cell_source = sources(ix, iy, ieta);
+            CHECK(cell_source[0] == tau*j_mu[0]);
+            CHECK(cell_source[1] == 0.);
+            CHECK(cell_source[3] == tau*j_mu[3]);
+            CHECK(cell_source[4] == tau*rhob);
+            e_sum += cell_source[0];
+        }
+        // the source only acts in the time step of tau_source
+        if (tau == tau_source) {
+            CHECK(e_sum > 0.);
+        } else {
+            CHECK(e_sum == 0.);
+        }
+    }
+    remove(DATA.initName_TA.c_str());
+    remove(DATA.initName_TB.c_str());
+}
@@ -145,6 +145,20 @@ void HydroSourceAMPT::prepare_list_for_current_tau_frame(
             parton_list_current_tau.push_back(it);
         }
     }
+
+    // the footprints follow the skips of get_hydro_energy_source and
+    // get_hydro_rhob_source
+    const double n_sigma_skip = 5.;
+    const double skip_dis_x   = n_sigma_skip*get_sigma_x() + 1e-6;
+    const double skip_dis_eta = n_sigma_skip*get_sigma_eta() + 1e-6;
+    std::vector<SourceBinIndex::Box> boxes;
+    boxes.reserve(parton_list_current_tau.size());
+    for (auto const &it: parton_list_current_tau) {
+        boxes.push_back({it->x - skip_dis_x, it->x + skip_dis_x,
+                         it->y - skip_dis_x, it->y + skip_dis_x,
+                         it->eta_s - skip_dis_eta, it->eta_s + skip_dis_eta});
+    }
+    parton_index_current_tau.build(boxes, skip_dis_x, skip_dis_eta);
     music_message << "hydro_source: tau = " << tau_local
                   << " number of source: "
                   << parton_list_current_tau.size();
@@ -176,7 +190,9 @@ void HydroSourceAMPT::get_hydro_energy_source(
     // AMPT parton sources
     double tau_dis_max = tau - get_source_tau_max();
     if (tau_dis_max < n_sigma_skip*sigma_tau) {
-        for (auto &it: parton_list_current_tau) {
+        for (const int i: parton_index_current_tau.get_sources(x, y,
+                                                               eta_s)) {
+            auto const &it = parton_list_current_tau[i];
             double x_dis = x - it->x;
             if (std::abs(x_dis) > skip_dis_x) continue;
 
@@ -236,7 +252,9 @@ double HydroSourceAMPT::get_hydro_rhob_source(
 
     double tau_dis_max = tau - get_source_tau_max();
     if (tau_dis_max < n_sigma_skip*sigma_tau) {
-        for (auto &it: parton_list_current_tau) {
+        for (const int i: parton_index_current_tau.get_sources(x, y,
+                                                               eta_s)) {
+            auto const &it = parton_list_current_tau[i];
             // skip the evaluation if the strings is too far away in the
             // space-time grid
             double x_dis = x - it->x;
@@ -6,6 +6,7 @@
 #include <vector>
 #include <memory>
 #include "hydro_source_base.h"
+#include "source_bin_index.h"
 
 //! This data structure stores parton information
 struct parton {
@@ -26,6 +27,8 @@ class HydroSourceAMPT : public HydroSourceBase {
     double parton_quench_factor;
     std::vector<std::shared_ptr<parton>> parton_list;
     std::vector<std::shared_ptr<parton>> parton_list_current_tau;
+    //! the spatial index of parton_list_current_tau
+    SourceBinIndex parton_index_current_tau;
 
  public:
     HydroSourceAMPT() = default;
@@ -48,6 +51,12 @@ class HydroSourceAMPT : public HydroSourceBase {
                                  const FlowVec &u_mu) const ;
 
     void prepare_list_for_current_tau_frame(const double tau_local);
+    bool get_current_tau_frame_extent(SourceBinIndex::Box &box) const {
+        if (!parton_index_current_tau.get_extent(box)) {
+            box = {1., 0., 1., 0., 1., 0.};     // no sources
+        }
+        return(true);
+    }
 };
 
 #endif  // SRC_HYDRO_SOURCE_AMPT_H_
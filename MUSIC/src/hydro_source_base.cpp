@@ -1,7 +1,10 @@
 // Copyright 2019 Chun Shen
 
+#include <algorithm>
+#include <cmath>
 #include "hydro_source_base.h"
 #include "data_struct.h"
+#include "eta_grid.h"
 
 void HydroSourceBase::get_hydro_energy_source_before_tau(
     const double tau, const double x, const double y, const double eta_s,
@@ -47,3 +50,91 @@ double HydroSourceBase::get_hydro_rhob_source_before_tau(
 
     return(res/tau);
 }
+
+void HydroSourceBase::deposit_sources(const double tau, const InitData &DATA,
+                                      const SCGrid &arena,
+                                      SourceGrid &sources) const {
+    const int nx   = arena.nX();
+    const int ny   = arena.nY();
+    const int neta = arena.nEta();
+    const EtaGrid eta_grid(DATA);
+    if (sources.nX() != nx || sources.nY() != ny || sources.nEta() != neta) {
+        sources = SourceGrid(nx, ny, neta);
+    }
+    if (fill_source_grid(tau, DATA, arena, sources)) return;
+
+    // the cell range of the extent, with one more cell on each side
+    int ix_range[2]   = {0, nx - 1};
+    int iy_range[2]   = {0, ny - 1};
+    int ieta_range[2] = {0, neta - 1};
+    SourceBinIndex::Box box;
+    if (get_current_tau_frame_extent(box)) {
+        const auto get_range = [](const double min, const double max,
+                                  const double grid_min, const double dx,
+                                  const int n, int *range) {
+            if (!(min <= max)) {
+                // no sources
+                range[0] = 0;
+                range[1] = -1;
+                return;
+            }
+            range[0] = static_cast<int>(std::max(
+                    0., std::floor((min - grid_min)/dx) - 1.));
+            range[1] = static_cast<int>(std::min(
+                    n - 1., std::ceil((max - grid_min)/dx) + 1.));
+        };
+        get_range(box.x_min, box.x_max, -DATA.x_size/2., DATA.delta_x, nx,
+                  ix_range);
+        get_range(box.y_min, box.y_max, -DATA.y_size/2., DATA.delta_y, ny,
+                  iy_range);
+        if (eta_grid.is_uniform()) {
+            get_range(box.eta_min, box.eta_max,
+                      -DATA.eta_size/2. + DATA.eta_index_offset*DATA.delta_eta,
+                      DATA.delta_eta, neta, ieta_range);
+        } else if (!(box.eta_min <= box.eta_max)) {
+            ieta_range[0] = 0;
+            ieta_range[1] = -1;
+        } else {
+            // the cells around the extent on the stretched grid
+            ieta_range[0] = 0;
+            while (   ieta_range[0] + 1 < neta
+                   && eta_grid.get_eta(ieta_range[0] + 1) <= box.eta_min) {
+                ieta_range[0]++;
+            }
+            ieta_range[0] = std::max(0, ieta_range[0] - 1);
+            ieta_range[1] = neta - 1;
+            while (   ieta_range[1] > 0
+                   && eta_grid.get_eta(ieta_range[1] - 1) >= box.eta_max) {
+                ieta_range[1]--;
+            }
+            ieta_range[1] = std::min(neta - 1, ieta_range[1] + 1);
+        }
+    }
+
+    #pragma omp parallel for collapse(2) schedule(dynamic)
+    for (int ieta = 0; ieta < neta; ieta++)
+    for (int ix   = 0; ix   < nx;   ix++  ) {
+        for (int iy = 0; iy < ny; iy++) {
+            TJbVec &source = sources(ix, iy, ieta);
+            source = {0.};
+            if (   ix < ix_range[0] || ix > ix_range[1]
+                || iy < iy_range[0] || iy > iy_range[1]
+                || ieta < ieta_range[0] || ieta > ieta_range[1]) continue;
+
+            const double eta_s_local = eta_grid.get_eta(ieta);
+            const double x_local     = - DATA.x_size  /2. +   ix*DATA.delta_x;
+            const double y_local     = - DATA.y_size  /2. +   iy*DATA.delta_y;
+            const FlowVec &u_local   = arena(ix, iy, ieta).u;
+            EnergyFlowVec j_mu = {0};
+            get_hydro_energy_source(tau, x_local, y_local, eta_s_local,
+                                    u_local, j_mu);
+            for (int ii = 0; ii < 4; ii++) {
+                source[ii] = tau*j_mu[ii];
+            }
+            if (DATA.turn_on_rhob == 1) {
+                source[4] = tau*get_hydro_rhob_source(
+                            tau, x_local, y_local, eta_s_local, u_local);
+            }
+        }
+    }
+}
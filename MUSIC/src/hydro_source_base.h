@@ -5,6 +5,8 @@
 #include "data.h"
 #include "pretty_ostream.h"
 #include "data_struct.h"
+#include "grid.h"
+#include "source_bin_index.h"
 
 class HydroSourceBase {
  private:
@@ -64,6 +66,30 @@ class HydroSourceBase {
                                             const double eta_s) const;
 
     virtual void prepare_list_for_current_tau_frame(const double tau_local) {}
+
+    //! this function sets box to a box holding all the sources of the
+    //! current tau frame, it returns false if there is no such box
+    virtual bool get_current_tau_frame_extent(SourceBinIndex::Box &box) const {
+        return(false);
+    }
+
+    //! this function fills sources like deposit_sources in one pass over
+    //! the grid, from quantities the source precomputed. It returns false
+    //! if the source has no such bulk path for the grid of arena, then
+    //! deposit_sources evaluates the point interface above cell by cell.
+    virtual bool fill_source_grid(const double tau, const InitData &DATA,
+                                  const SCGrid &arena,
+                                  SourceGrid &sources) const {
+        return(false);
+    }
+
+    //! this function fills sources with the source terms
+    //! tau*(J^mu, rho_B) of the cells of arena at the time tau, with the
+    //! flow velocity of arena (rho_B only with turn_on_rhob = 1). Only the
+    //! cells in the extent of the current tau frame are evaluated, the
+    //! others are set to 0.
+    void deposit_sources(const double tau, const InitData &DATA,
+                         const SCGrid &arena, SourceGrid &sources) const;
 };
 
 #endif  // SRC_HYDRO_SOURCE_BASE_H_
@@ -0,0 +1,64 @@
+#include "doctest.h"
+#include "hydro_source_base.h"
+#include <cmath>
+
+namespace {
+    //! a source 1 + x inside |x|, |y| < 1 and |eta_s| < 0.5
+    class BoxSource : public HydroSourceBase {
+     public:
+        void get_hydro_energy_source(
+                const double tau, const double x, const double y,
+                const double eta_s, const FlowVec &u_mu,
+                EnergyFlowVec &j_mu) const {
+            j_mu = {0.};
+            if (std::abs(x) < 1. && std::abs(y) < 1. && std::abs(eta_s) < 0.5)
+                j_mu[0] = (1. + x)/tau;
+        }
+        double get_hydro_rhob_source(const double tau, const double x,
+                                     const double y, const double eta_s,
+                                     const FlowVec &u_mu) const {
+            return(u_mu[0]);
+        }
+        bool get_current_tau_frame_extent(SourceBinIndex::Box &box) const {
+            box = {-1., 1., -1., 1., -0.5, 0.5};
+            return(true);
+        }
+    };
+}
+
+TEST_CASE("Check HydroSourceBase::deposit_sources fills the extent") {
+    InitData DATA;
+    DATA.x_size = 6.;
+    DATA.y_size = 6.;
+    DATA.eta_size = 4.;
+    DATA.delta_x = 0.5;
+    DATA.delta_y = 0.5;
+    DATA.delta_eta = 0.25;
+    DATA.turn_on_rhob = 1;
+    SCGrid arena(13, 13, 17);
+    for (int i = 0; i < arena.size(); i++) arena(i).u[0] = 2.;
+
+    BoxSource source;
+    SourceGrid sources;
+    const double tau = 0.8;
+    source.deposit_sources(tau, DATA, arena, sources);
+    REQUIRE(sources.nX() == 13);
+    for (int ieta = 0; ieta < 17; ieta++)
+    for (int ix = 0; ix < 13; ix++)
+    for (int iy = 0; iy < 13; iy++) {
+        const double x = -3. + 0.5*ix;
+        const double y = -3. + 0.5*iy;
+        const double eta = -2. + 0.25*ieta;
+        EnergyFlowVec j_mu;
+        source.get_hydro_energy_source(tau, x, y, eta, arena(ix, iy, ieta).u,
+                                       j_mu);
+        CHECK(sources(ix, iy, ieta)[0] == tau*j_mu[0]);
+        // rho_B is only evaluated close to the extent
+        const bool near = (   std::abs(x) <= 1.5 && std::abs(y) <= 1.5
+                           && std::abs(eta) <= 0.75);
+        if (!near) CHECK(sources(ix, iy, ieta)[4] == 0.);
+        if (std::abs(x) <= 1. && std::abs(y) <= 1. && std::abs(eta) <= 0.5) {
+            CHECK(sources(ix, iy, ieta)[4] == tau*2.);
+        }
+    }
+}
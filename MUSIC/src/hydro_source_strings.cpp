@@ -290,6 +290,7 @@ void HydroSourceStrings::prepare_list_for_current_tau_frame(
             QCD_strings_list_current_tau.push_back(it);
         }
     }
+    build_index_for_current_tau_frame();
     music_message << "hydro_source: tau = " << tau_local << " fm."
                   << " number of strings for energy density: "
                   << QCD_strings_list_current_tau.size()
@@ -299,6 +300,91 @@ void HydroSourceStrings::prepare_list_for_current_tau_frame(
 }
 
 
+void HydroSourceStrings::build_index_for_current_tau_frame() {
+    // the footprints follow the skips of get_hydro_energy_source and
+    // get_hydro_rhob_source, padded against the rounding of the string
+    // positions
+    const double n_sigma_skip = 5.;
+    const double pad = 1e-6;
+    double bin_size_x = 0.;
+    double bin_size_eta = 0.;
+    std::vector<SourceBinIndex::Box> boxes;
+    const auto add_string_box = [&](const QCD_string &string,
+                                    const double eta_min,
+                                    const double eta_max) {
+        const double skip_dis_x = n_sigma_skip*string.sigma_x + pad;
+        const double skip_dis_eta = n_sigma_skip*string.sigma_eta + pad;
+        boxes.push_back({
+            std::min(string.x_pl, string.x_pr) - skip_dis_x,
+            std::max(string.x_pl, string.x_pr) + skip_dis_x,
+            std::min(string.y_pl, string.y_pr) - skip_dis_x,
+            std::max(string.y_pl, string.y_pr) + skip_dis_x,
+            eta_min - skip_dis_eta, eta_max + skip_dis_eta});
+        if (bin_size_x == 0. || skip_dis_x < bin_size_x) {
+            bin_size_x = skip_dis_x;
+        }
+        if (bin_size_eta == 0. || skip_dis_eta < bin_size_eta) {
+            bin_size_eta = skip_dis_eta;
+        }
+    };
+
+    for (auto const &it: QCD_strings_list_current_tau) {
+        add_string_box(*it, it->eta_s_left, it->eta_s_right);
+    }
+    strings_index_current_tau.build(boxes, bin_size_x, bin_size_eta);
+
+    boxes.clear();
+    bin_size_x = bin_size_eta = 0.;
+    for (auto const &it: QCD_strings_remnant_list_current_tau) {
+        const double skip_dis_x = n_sigma_skip*it->sigma_x + pad;
+        const double skip_dis_eta = n_sigma_skip*it->sigma_eta + pad;
+        boxes.push_back({
+            it->x_perp - skip_dis_x, it->x_perp + skip_dis_x,
+            it->y_perp - skip_dis_x, it->y_perp + skip_dis_x,
+            std::min(it->eta_s_left, it->eta_s_right) - skip_dis_eta,
+            std::max(it->eta_s_left, it->eta_s_right) + skip_dis_eta});
+        if (bin_size_x == 0. || skip_dis_x < bin_size_x) {
+            bin_size_x = skip_dis_x;
+        }
+        if (bin_size_eta == 0. || skip_dis_eta < bin_size_eta) {
+            bin_size_eta = skip_dis_eta;
+        }
+    }
+    remnant_index_current_tau.build(boxes, bin_size_x, bin_size_eta);
+
+    boxes.clear();
+    bin_size_x = bin_size_eta = 0.;
+    for (auto const &it: QCD_strings_baryon_list_current_tau) {
+        add_string_box(*it, it->eta_s_left, it->eta_s_right);
+    }
+    baryon_index_current_tau.build(boxes, bin_size_x, bin_size_eta);
+}
+
+
+bool HydroSourceStrings::get_current_tau_frame_extent(
+                                        SourceBinIndex::Box &box) const {
+    box = {1., 0., 1., 0., 1., 0.};     // no sources
+    bool first = true;
+    for (const SourceBinIndex *index: {&strings_index_current_tau,
+                                       &remnant_index_current_tau,
+                                       &baryon_index_current_tau}) {
+        SourceBinIndex::Box index_box;
+        if (!index->get_extent(index_box)) continue;
+        if (first) {
+            box = index_box;
+            first = false;
+        }
+        box.x_min   = std::min(box.x_min,   index_box.x_min);
+        box.x_max   = std::max(box.x_max,   index_box.x_max);
+        box.y_min   = std::min(box.y_min,   index_box.y_min);
+        box.y_max   = std::max(box.y_max,   index_box.y_max);
+        box.eta_min = std::min(box.eta_min, index_box.eta_min);
+        box.eta_max = std::max(box.eta_max, index_box.eta_max);
+    }
+    return(true);
+}
+
+
 void HydroSourceStrings::get_hydro_energy_source(
     const double tau, const double x, const double y, const double eta_s,
     const FlowVec &u_mu, EnergyFlowVec &j_mu) const {
@@ -309,7 +395,8 @@ void HydroSourceStrings::get_hydro_energy_source(
     const double dtau = DATA.delta_tau;
     const double n_sigma_skip = 5.;
     const double exp_tau = 1./tau;
-    for (auto const&it: QCD_strings_list_current_tau) {
+    for (const int i: strings_index_current_tau.get_sources(x, y, eta_s)) {
+        auto const &it = QCD_strings_list_current_tau[i];
         const double sigma_x = it->sigma_x;
         const double sigma_eta = it->sigma_eta;
         const double prefactor_prep = 1./(2.*M_PI*sigma_x*sigma_x);
@@ -418,7 +505,8 @@ void HydroSourceStrings::get_hydro_energy_source(
         j_mu[3] += local_eperp*sinh_long;
     }
 
-    for (auto const&it: QCD_strings_remnant_list_current_tau) {
+    for (const int i: remnant_index_current_tau.get_sources(x, y, eta_s)) {
+        auto const &it = QCD_strings_remnant_list_current_tau[i];
         const double sigma_x = it->sigma_x;
         const double sigma_eta = it->sigma_eta;
         const double prefactor_prep = 1./(2.*M_PI*sigma_x*sigma_x);
@@ -507,7 +595,8 @@ double HydroSourceStrings::get_hydro_rhob_source(
 
     const double exp_tau        = 1.0/tau;
     const double n_sigma_skip   = 5.;
-    for (auto &it: QCD_strings_baryon_list_current_tau) {
+    for (const int i: baryon_index_current_tau.get_sources(x, y, eta_s)) {
+        auto const &it = QCD_strings_baryon_list_current_tau[i];
         const double sigma_x = it->sigma_x;
         const double sigma_eta = it->sigma_eta;
         const double prefactor_prep = 1./(2.*M_PI*sigma_x*sigma_x);
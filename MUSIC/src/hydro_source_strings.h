@@ -6,6 +6,7 @@
 #include <vector>
 #include <memory>
 #include "hydro_source_base.h"
+#include "source_bin_index.h"
 
 //! This data structure contains a QCD string object
 struct QCD_string {
@@ -43,6 +44,14 @@ class HydroSourceStrings : public HydroSourceBase {
     std::vector<std::shared_ptr<QCD_string>> QCD_strings_remnant_list_current_tau;
     std::vector<std::shared_ptr<QCD_string>> QCD_strings_baryon_list_current_tau;
 
+    //! the spatial indices of the three lists of the current tau frame
+    SourceBinIndex strings_index_current_tau;
+    SourceBinIndex remnant_index_current_tau;
+    SourceBinIndex baryon_index_current_tau;
+
+    //! builds the spatial indices of the lists of the current tau frame
+    void build_index_for_current_tau_frame();
+
  public:
     HydroSourceStrings() = default;
     HydroSourceStrings(const InitData &DATA_in);
@@ -65,6 +74,7 @@ class HydroSourceStrings : public HydroSourceBase {
                                  const FlowVec &u_mu) const ;
 
     void prepare_list_for_current_tau_frame(const double tau_local);
+    bool get_current_tau_frame_extent(SourceBinIndex::Box &box) const;
     void compute_norm_for_strings(const double total_energy);
 };
 
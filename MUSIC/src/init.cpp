@@ -7,7 +7,10 @@
 #include "./cell.h"
 #include "./grid.h"
 #include "./init.h"
+#include "./grid_tiling.h"
+#include "./deterministic_sum.h"
 #include "./eos.h"
+#include "./eta_grid.h"
 
 #ifndef _OPENMP
     #define omp_get_thread_num() 0
@@ -20,6 +23,13 @@ using std::vector;
 using std::ifstream;
 using Util::hbarc;
 
+namespace {
+    //! the quantities of Initial_profile 111 of a transverse column
+    struct MCGlbColumn {
+        double y_CM, E_lrf, eta0, E_norm;
+    };
+}
+
 
 Init::Init(const EOS &eosIn, InitData &DATA_in,
            std::shared_ptr<HydroSourceBase> hydro_source_ptr_in) :
@@ -51,21 +61,16 @@ void Init::InitArena(SCGrid &arena_prev, SCGrid &arena_current,
         music_message.flush("info");
     } else if (DATA.Initial_profile == 8) {
         music_message.info(DATA.initName);
-        ifstream profile(DATA.initName.c_str());
-        std::string dummy;
-        int nx, ny, neta;
-        double deta, dx, dy, dummy2;
-        // read the first line with general info
-        profile >> dummy >> dummy >> dummy2
-                >> dummy >> neta >> dummy >> nx >> dummy >> ny
-                >> dummy >> deta >> dummy >> dx >> dummy >> dy;
-        profile.close();
+        read_initial_profile();
+        const int nx = initial_profile.nx;
+        const int ny = initial_profile.ny;
+        const int neta = initial_profile.neta;
         music_message << "Using Initial_profile=" << DATA.Initial_profile
                       << ". Overwriting lattice dimensions:";
         DATA.nx = nx;
         DATA.ny = ny;
-        DATA.delta_x = dx;
-        DATA.delta_y = dy;
+        DATA.delta_x = initial_profile.dx;
+        DATA.delta_y = initial_profile.dy;
 
         music_message << "neta=" << neta << ", nx=" << nx << ", ny=" << ny;
         music_message << "deta=" << DATA.delta_eta << ", dx=" << DATA.delta_x
@@ -74,22 +79,17 @@ void Init::InitArena(SCGrid &arena_prev, SCGrid &arena_current,
     } else if (   DATA.Initial_profile == 9 || DATA.Initial_profile == 91
                || DATA.Initial_profile == 92 || DATA.Initial_profile == 93) {
         music_message.info(DATA.initName);
-        ifstream profile(DATA.initName.c_str());
-        std::string dummy;
-        int nx, ny, neta;
-        double deta, dx, dy, dummy2;
-        // read the first line with general info
-        profile >> dummy >> dummy >> dummy2
-                >> dummy >> neta >> dummy >> nx >> dummy >> ny
-                >> dummy >> deta >> dummy >> dx >> dummy >> dy;
-        profile.close();
+        read_initial_profile();
+        const int nx = initial_profile.nx;
+        const int ny = initial_profile.ny;
+        const int neta = initial_profile.neta;
         music_message << "Using Initial_profile=" << DATA.Initial_profile
                       << ". Overwriting lattice dimensions:";
         DATA.nx = nx;
         DATA.ny = ny;
         DATA.neta = neta;
-        DATA.delta_x = dx;
-        DATA.delta_y = dy;
+        DATA.delta_x = initial_profile.dx;
+        DATA.delta_y = initial_profile.dy;
         DATA.delta_eta = 0.1;
 
         music_message << "neta=" << neta << ", nx=" << nx << ", ny=" << ny;
@@ -120,7 +120,14 @@ void Init::InitArena(SCGrid &arena_prev, SCGrid &arena_current,
         music_message.flush("info");
 
         const int nx = static_cast<int>(
-                sqrt(jetscape_initial_energy_density.size()/DATA.neta));
+                sqrt(jetscape_fields.n_cells/DATA.neta) + 0.5);
+        if (static_cast<size_t>(nx)*nx*DATA.neta != jetscape_fields.n_cells) {
+            music_message << "The JETSCAPE initial condition has "
+                          << jetscape_fields.n_cells << " cells, which is "
+                          << "not nx*nx*neta with neta = " << DATA.neta;
+            music_message.flush("error");
+            exit(1);
+        }
         const int ny = nx;
         DATA.nx = nx;
         DATA.ny = ny;
@@ -197,10 +204,7 @@ void Init::InitTJb(SCGrid &arena_prev, SCGrid &arena_current) {
         music_message << "file name used: " << DATA.initName;
         music_message.flush("info");
 
-        #pragma omp parallel for
-        for (int ieta = 0; ieta < arena_current.nEta(); ieta++) {
-            initial_IPGlasma_XY(ieta, arena_prev, arena_current);
-        }
+        initial_IPGlasma_XY(arena_prev, arena_current);
     } else if (   DATA.Initial_profile == 9 || DATA.Initial_profile == 91
                || DATA.Initial_profile == 92 || DATA.Initial_profile == 93) {
         // read in the profile from file
@@ -210,10 +214,7 @@ void Init::InitTJb(SCGrid &arena_prev, SCGrid &arena_current) {
         music_message << "file name used: " << DATA.initName;
         music_message.flush("info");
 
-        #pragma omp parallel for
-        for (int ieta = 0; ieta < arena_current.nEta(); ieta++) {
-            initial_IPGlasma_XY_with_pi(ieta, arena_prev, arena_current);
-        }
+        initial_IPGlasma_XY_with_pi(arena_prev, arena_current);
     } else if (DATA.Initial_profile == 11 || DATA.Initial_profile == 111) {
         // read in the transverse profile from file with finite rho_B
         // the initial entropy and net baryon density profile are
@@ -249,10 +250,7 @@ void Init::InitTJb(SCGrid &arena_prev, SCGrid &arena_current) {
         music_message.info(" ----- information on initial distribution -----");
         music_message << "initialized with a JETSCAPE initial condition.";
         music_message.flush("info");
-        #pragma omp parallel for
-        for (int ieta = 0; ieta < arena_current.nEta(); ieta++) {
-            initial_with_jetscape(ieta, arena_prev, arena_current);
-        }
+        initial_with_jetscape(arena_prev, arena_current);
         clean_up_jetscape_arrays();
     } else if (DATA.Initial_profile == 101) {
         music_message.info(" ----- information on initial distribution -----");
@@ -270,17 +268,14 @@ void Init::InitTJb(SCGrid &arena_prev, SCGrid &arena_current) {
         const int grid_neta = arena_current.nEta();
         const int grid_nx   = arena_current.nX();
         const int grid_ny   = arena_current.nY();
-        #pragma omp parallel for collapse(3)
-        for (int ieta = 0; ieta < grid_neta; ieta++) {
-            for (int ix = 0; ix < grid_nx; ix++) {
-                for (int iy = 0; iy < grid_ny; iy++) {
-                    arena_prev(ix, iy, ieta).Wmunu = {0.};
-                    arena_prev(ix, iy, ieta).pi_b = 0.;
-                    arena_current(ix, iy, ieta).Wmunu = {0.};
-                    arena_current(ix, iy, ieta).pi_b = 0.;
-                }
-            }
-        }
+        const GridTiling tiling(DATA, grid_nx, grid_ny, grid_neta);
+        tiling.parallel_for_each_cell([&](const int ix, const int iy,
+                                          const int ieta) {
+            arena_prev(ix, iy, ieta).Wmunu = {0.};
+            arena_prev(ix, iy, ieta).pi_b = 0.;
+            arena_current(ix, iy, ieta).Wmunu = {0.};
+            arena_current(ix, iy, ieta).pi_b = 0.;
+        });
     }
     music_message.info("initial distribution done.");
 }
@@ -471,93 +466,86 @@ void Init::initial_1p1D_eta(SCGrid &arena_prev, SCGrid &arena_current) {
     }
 }
 
-void Init::initial_IPGlasma_XY(int ieta, SCGrid &arena_prev,
-                               SCGrid &arena_current) {
-    ifstream profile(DATA.initName.c_str());
+//! This function reads the transverse profile of Initial_profile 8 and 9x
+//! in the text or the binary format
+void Init::read_initial_profile() {
+    std::vector<std::string> columns;
+    if (DATA.Initial_profile == 8) {
+        columns = {"ed", "utau", "ux", "uy"};
+    } else {
+        columns = {"ed", "utau", "ux", "uy", "ueta",
+                   "pitautau", "pitaux", "pitauy", "pitaueta",
+                   "pixx", "pixy", "pixeta", "piyy", "piyeta", "pietaeta"};
+    }
+    InitialProfileFile::read(DATA.initName, columns, initial_profile);
+    DATA.x_size = -initial_profile.x_min*2;
+    DATA.y_size = -initial_profile.y_min*2;
+    music_message << "eta_size=" << DATA.eta_size
+                  << ", x_size=" << DATA.x_size
+                  << ", y_size=" << DATA.y_size;
+    music_message.flush("info");
+}
 
-    std::string dummy;
-    // read the information line
-    std::getline(profile, dummy);
 
+void Init::initial_IPGlasma_XY(SCGrid &arena_prev, SCGrid &arena_current) {
     const int nx = arena_current.nX();
     const int ny = arena_current.nY();
-    double temp_profile_ed[nx][ny];
-    double temp_profile_utau[nx][ny];
-    double temp_profile_ux[nx][ny];
-    double temp_profile_uy[nx][ny];
-
-    // read the one slice
-    double density, dummy1, dummy2, dummy3;
-    double ux, uy, utau;
-    for (int ix = 0; ix < nx; ix++) {
-        for (int iy = 0; iy < ny; iy++) {
-            profile >> dummy1 >> dummy2 >> dummy3
-                    >> density >> utau >> ux >> uy
-                    >> dummy  >> dummy  >> dummy  >> dummy;
-            temp_profile_ed[ix][iy] = density;
-            temp_profile_ux[ix][iy] = ux;
-            temp_profile_uy[ix][iy] = uy;
-            temp_profile_utau[ix][iy] = sqrt(1. + ux*ux + uy*uy);
-            if (ix == 0 && iy == 0) {
-                DATA.x_size = -dummy2*2;
-                DATA.y_size = -dummy3*2;
-                if (omp_get_thread_num() == 0) {
-                    music_message << "eta_size=" << DATA.eta_size
-                                  << ", x_size=" << DATA.x_size
-                                  << ", y_size=" << DATA.y_size;
-                    music_message.flush("info");
-                }
-            }
-        }
-    }
-    profile.close();
+    const int neta = arena_current.nEta();
+    const std::vector<double> &temp_profile_ed = initial_profile.fields[
+                                initial_profile.get_field_index("ed")];
+    const std::vector<double> &temp_profile_ux = initial_profile.fields[
+                                initial_profile.get_field_index("ux")];
+    const std::vector<double> &temp_profile_uy = initial_profile.fields[
+                                initial_profile.get_field_index("uy")];
 
-    double eta = (DATA.delta_eta)*ieta - (DATA.eta_size)/2.0;
-    double eta_envelop_ed = eta_profile_plateau(eta, DATA.eta_flat/2.0,
-                                                DATA.eta_fall_off);
     int entropy_flag = DATA.initializeEntropy;
-    for (int ix = 0; ix < nx; ix++) {
-        for (int iy = 0; iy< ny; iy++) {
-            double rhob = 0.0;
-            double epsilon = 0.0;
-            if (entropy_flag == 0) {
-                epsilon = (temp_profile_ed[ix][iy]*eta_envelop_ed
-                           *DATA.sFactor/hbarc);  // 1/fm^4
-            } else {
-                double local_sd = (temp_profile_ed[ix][iy]*DATA.sFactor
-                                   *eta_envelop_ed);
-                epsilon = eos.get_s2e(local_sd, rhob);
-            }
-            epsilon = std::max(Util::small_eps, epsilon);
+    const std::vector<double> envelop_table = get_eta_plateau_table(neta);
+    #pragma omp parallel for collapse(2)
+    for (int ieta = 0; ieta < neta; ieta++) {
+        for (int ix = 0; ix < nx; ix++) {
+            const double eta_envelop_ed = envelop_table[ieta];
+            for (int iy = 0; iy< ny; iy++) {
+                const int idx = iy + ix*ny;
+                double rhob = 0.0;
+                double epsilon = 0.0;
+                if (entropy_flag == 0) {
+                    epsilon = (temp_profile_ed[idx]*eta_envelop_ed
+                               *DATA.sFactor/hbarc);  // 1/fm^4
+                } else {
+                    double local_sd = (temp_profile_ed[idx]*DATA.sFactor
+                                       *eta_envelop_ed);
+                    epsilon = eos.get_s2e(local_sd, rhob);
+                }
+                epsilon = std::max(Util::small_eps, epsilon);
 
-            arena_current(ix, iy, ieta).epsilon = epsilon;
-            arena_current(ix, iy, ieta).rhob = rhob;
+                const double ux = temp_profile_ux[idx];
+                const double uy = temp_profile_uy[idx];
+                arena_current(ix, iy, ieta).epsilon = epsilon;
+                arena_current(ix, iy, ieta).rhob = rhob;
 
-            arena_current(ix, iy, ieta).u[0] = temp_profile_utau[ix][iy];
-            arena_current(ix, iy, ieta).u[1] = temp_profile_ux[ix][iy];
-            arena_current(ix, iy, ieta).u[2] = temp_profile_uy[ix][iy];
-            arena_current(ix, iy, ieta).u[3] = 0.0;
+                arena_current(ix, iy, ieta).u[0] = sqrt(1. + ux*ux + uy*uy);
+                arena_current(ix, iy, ieta).u[1] = ux;
+                arena_current(ix, iy, ieta).u[2] = uy;
+                arena_current(ix, iy, ieta).u[3] = 0.0;
 
-            arena_prev(ix, iy, ieta) = arena_current(ix, iy, ieta);
+                arena_prev(ix, iy, ieta) = arena_current(ix, iy, ieta);
+            }
         }
     }
+    initial_profile = InitialProfile();
 }
 
-void Init::initial_IPGlasma_XY_with_pi(int ieta, SCGrid &arena_prev,
+void Init::initial_IPGlasma_XY_with_pi(SCGrid &arena_prev,
                                        SCGrid &arena_current) {
     // Initial_profile == 9 : full T^\mu\nu
     // Initial_profile == 91: e and u^\mu
     // Initial_profile == 92: e only
     // Initial_profile == 93: e, u^\mu, and pi^\mu\nu, no bulk Pi
     double tau0 = DATA.tau0;
-    ifstream profile(DATA.initName.c_str());
-
-    std::string dummy;
-    // read the information line
-    std::getline(profile, dummy);
 
     const int nx = arena_current.nX();
     const int ny = arena_current.nY();
+    const int neta = arena_current.nEta();
     std::vector<double> temp_profile_ed(nx*ny, 0.0);
     std::vector<double> temp_profile_utau(nx*ny, 0.0);
     std::vector<double> temp_profile_ux(nx*ny, 0.0);
@@ -574,146 +562,137 @@ void Init::initial_IPGlasma_XY_with_pi(int ieta, SCGrid &arena_prev,
     std::vector<double> temp_profile_piyeta(nx*ny, 0.0);
     std::vector<double> temp_profile_pietaeta(nx*ny, 0.0);
 
-    // read the one slice
-    double density, dummy1, dummy2, dummy3;
-    double ux, uy, utau, ueta;
-    double pitautau, pitaux, pitauy, pitaueta;
-    double pixx, pixy, pixeta, piyy, piyeta, pietaeta;
-    for (int ix = 0; ix < nx; ix++) {
-        for (int iy = 0; iy < ny; iy++) {
-            int idx = iy + ix*ny;
-            std::getline(profile, dummy);
-            std::stringstream ss(dummy);
-            ss >> dummy1 >> dummy2 >> dummy3
-               >> density >> utau >> ux >> uy >> ueta
-               >> pitautau >> pitaux >> pitauy >> pitaueta
-               >> pixx >> pixy >> pixeta >> piyy >> piyeta >> pietaeta;
-            ueta = ueta*tau0;
-            temp_profile_ed    [idx] = density;
-            temp_profile_ux    [idx] = ux;
-            temp_profile_uy    [idx] = uy;
-            temp_profile_ueta  [idx] = ueta;
-            temp_profile_utau  [idx] = sqrt(1. + ux*ux + uy*uy + ueta*ueta);
-            temp_profile_pixx  [idx] = pixx*DATA.sFactor;
-            temp_profile_pixy  [idx] = pixy*DATA.sFactor;
-            temp_profile_pixeta[idx] = pixeta*tau0*DATA.sFactor;
-            temp_profile_piyy  [idx] = piyy*DATA.sFactor;
-            temp_profile_piyeta[idx] = piyeta*tau0*DATA.sFactor;
-
-            utau = temp_profile_utau[idx];
-            temp_profile_pietaeta[idx] = (
-                (2.*(  ux*uy*temp_profile_pixy[idx]
-                     + ux*ueta*temp_profile_pixeta[idx]
-                     + uy*ueta*temp_profile_piyeta[idx])
-                 - (utau*utau - ux*ux)*temp_profile_pixx[idx]
-                 - (utau*utau - uy*uy)*temp_profile_piyy[idx])
-                /(utau*utau - ueta*ueta));
-            temp_profile_pitaux  [idx] = (1./utau
-                *(  temp_profile_pixx[idx]*ux
-                  + temp_profile_pixy[idx]*uy
-                  + temp_profile_pixeta[idx]*ueta));
-            temp_profile_pitauy  [idx] = (1./utau
-                *(  temp_profile_pixy[idx]*ux
-                  + temp_profile_piyy[idx]*uy
-                  + temp_profile_piyeta[idx]*ueta));
-            temp_profile_pitaueta[idx] = (1./utau
-                *(  temp_profile_pixeta[idx]*ux
-                  + temp_profile_piyeta[idx]*uy
-                  + temp_profile_pietaeta[idx]*ueta));
-            temp_profile_pitautau[idx] = (1./utau
-                *(  temp_profile_pitaux[idx]*ux
-                  + temp_profile_pitauy[idx]*uy
-                  + temp_profile_pitaueta[idx]*ueta));
-            if (ix == 0 && iy == 0) {
-                DATA.x_size = -dummy2*2;
-                DATA.y_size = -dummy3*2;
-                if (omp_get_thread_num() == 0) {
-                    music_message << "eta_size=" << DATA.eta_size
-                                  << ", x_size=" << DATA.x_size
-                                  << ", y_size=" << DATA.y_size;
-                    music_message.flush("info");
-                }
-            }
-        }
+    const auto get_field = [this](const std::string &name) {
+        return(&initial_profile.fields[
+                        initial_profile.get_field_index(name)][0]);
+    };
+    const double *density_in = get_field("ed");
+    const double *ux_in      = get_field("ux");
+    const double *uy_in      = get_field("uy");
+    const double *ueta_in    = get_field("ueta");
+    const double *pixx_in    = get_field("pixx");
+    const double *pixy_in    = get_field("pixy");
+    const double *pixeta_in  = get_field("pixeta");
+    const double *piyy_in    = get_field("piyy");
+    const double *piyeta_in  = get_field("piyeta");
+
+    // the transverse slice
+    #pragma omp parallel for
+    for (int idx = 0; idx < nx*ny; idx++) {
+        const double density = density_in[idx];
+        const double ux = ux_in[idx];
+        const double uy = uy_in[idx];
+        const double ueta = ueta_in[idx]*tau0;
+        temp_profile_ed    [idx] = density;
+        temp_profile_ux    [idx] = ux;
+        temp_profile_uy    [idx] = uy;
+        temp_profile_ueta  [idx] = ueta;
+        temp_profile_utau  [idx] = sqrt(1. + ux*ux + uy*uy + ueta*ueta);
+        temp_profile_pixx  [idx] = pixx_in[idx]*DATA.sFactor;
+        temp_profile_pixy  [idx] = pixy_in[idx]*DATA.sFactor;
+        temp_profile_pixeta[idx] = pixeta_in[idx]*tau0*DATA.sFactor;
+        temp_profile_piyy  [idx] = piyy_in[idx]*DATA.sFactor;
+        temp_profile_piyeta[idx] = piyeta_in[idx]*tau0*DATA.sFactor;
+
+        const double utau = temp_profile_utau[idx];
+        temp_profile_pietaeta[idx] = (
+            (2.*(  ux*uy*temp_profile_pixy[idx]
+                 + ux*ueta*temp_profile_pixeta[idx]
+                 + uy*ueta*temp_profile_piyeta[idx])
+             - (utau*utau - ux*ux)*temp_profile_pixx[idx]
+             - (utau*utau - uy*uy)*temp_profile_piyy[idx])
+            /(utau*utau - ueta*ueta));
+        temp_profile_pitaux  [idx] = (1./utau
+            *(  temp_profile_pixx[idx]*ux
+              + temp_profile_pixy[idx]*uy
+              + temp_profile_pixeta[idx]*ueta));
+        temp_profile_pitauy  [idx] = (1./utau
+            *(  temp_profile_pixy[idx]*ux
+              + temp_profile_piyy[idx]*uy
+              + temp_profile_piyeta[idx]*ueta));
+        temp_profile_pitaueta[idx] = (1./utau
+            *(  temp_profile_pixeta[idx]*ux
+              + temp_profile_piyeta[idx]*uy
+              + temp_profile_pietaeta[idx]*ueta));
+        temp_profile_pitautau[idx] = (1./utau
+            *(  temp_profile_pitaux[idx]*ux
+              + temp_profile_pitauy[idx]*uy
+              + temp_profile_pitaueta[idx]*ueta));
     }
-    profile.close();
+    initial_profile = InitialProfile();
 
-    double eta = (DATA.delta_eta)*(ieta) - (DATA.eta_size)/2.0;
-    double eta_envelop_ed = eta_profile_plateau(eta, DATA.eta_flat/2.0,
-                                                DATA.eta_fall_off);
     int entropy_flag = DATA.initializeEntropy;
-    for (int ix = 0; ix < nx; ix++) {
-        for (int iy = 0; iy< ny; iy++) {
-            int idx = iy + ix*ny;
-            double rhob = 0.0;
-            double epsilon = 0.0;
-            if (entropy_flag == 0) {
-                epsilon = (temp_profile_ed[idx]*eta_envelop_ed
-                           *DATA.sFactor/hbarc);  // 1/fm^4
-            } else {
-                double local_sd = (temp_profile_ed[idx]*DATA.sFactor
-                                   *eta_envelop_ed);
-                epsilon = eos.get_s2e(local_sd, rhob);
-            }
-            epsilon = std::max(Util::small_eps, epsilon);
+    const std::vector<double> envelop_table = get_eta_plateau_table(neta);
+    #pragma omp parallel for collapse(2)
+    for (int ieta = 0; ieta < neta; ieta++) {
+        for (int ix = 0; ix < nx; ix++) {
+            const double eta_envelop_ed = envelop_table[ieta];
+            for (int iy = 0; iy< ny; iy++) {
+                int idx = iy + ix*ny;
+                double rhob = 0.0;
+                double epsilon = 0.0;
+                if (entropy_flag == 0) {
+                    epsilon = (temp_profile_ed[idx]*eta_envelop_ed
+                               *DATA.sFactor/hbarc);  // 1/fm^4
+                } else {
+                    double local_sd = (temp_profile_ed[idx]*DATA.sFactor
+                                       *eta_envelop_ed);
+                    epsilon = eos.get_s2e(local_sd, rhob);
+                }
+                epsilon = std::max(Util::small_eps, epsilon);
 
-            arena_current(ix, iy, ieta).epsilon = epsilon;
-            arena_current(ix, iy, ieta).rhob = rhob;
+                arena_current(ix, iy, ieta).epsilon = epsilon;
+                arena_current(ix, iy, ieta).rhob = rhob;
 
-            if (DATA.Initial_profile == 92) {
-                arena_current(ix, iy, ieta).u[0] = 1.0;
-                arena_current(ix, iy, ieta).u[1] = 0.0;
-                arena_current(ix, iy, ieta).u[2] = 0.0;
-                arena_current(ix, iy, ieta).u[3] = 0.0;
-            } else {
-                arena_current(ix, iy, ieta).u[0] = temp_profile_utau[idx];
-                arena_current(ix, iy, ieta).u[1] = temp_profile_ux[idx];
-                arena_current(ix, iy, ieta).u[2] = temp_profile_uy[idx];
-                arena_current(ix, iy, ieta).u[3] = temp_profile_ueta[idx];
-            }
+                if (DATA.Initial_profile == 92) {
+                    arena_current(ix, iy, ieta).u[0] = 1.0;
+                    arena_current(ix, iy, ieta).u[1] = 0.0;
+                    arena_current(ix, iy, ieta).u[2] = 0.0;
+                    arena_current(ix, iy, ieta).u[3] = 0.0;
+                } else {
+                    arena_current(ix, iy, ieta).u[0] = temp_profile_utau[idx];
+                    arena_current(ix, iy, ieta).u[1] = temp_profile_ux[idx];
+                    arena_current(ix, iy, ieta).u[2] = temp_profile_uy[idx];
+                    arena_current(ix, iy, ieta).u[3] = temp_profile_ueta[idx];
+                }
 
-            if (DATA.Initial_profile == 9 || DATA.Initial_profile == 93) {
-                arena_current(ix, iy, ieta).Wmunu[0] = temp_profile_pitautau[idx];
-                arena_current(ix, iy, ieta).Wmunu[1] = temp_profile_pitaux[idx];
-                arena_current(ix, iy, ieta).Wmunu[2] = temp_profile_pitauy[idx];
-                arena_current(ix, iy, ieta).Wmunu[3] = temp_profile_pitaueta[idx];
-                arena_current(ix, iy, ieta).Wmunu[4] = temp_profile_pixx[idx];
-                arena_current(ix, iy, ieta).Wmunu[5] = temp_profile_pixy[idx];
-                arena_current(ix, iy, ieta).Wmunu[6] = temp_profile_pixeta[idx];
-                arena_current(ix, iy, ieta).Wmunu[7] = temp_profile_piyy[idx];
-                arena_current(ix, iy, ieta).Wmunu[8] = temp_profile_piyeta[idx];
-                arena_current(ix, iy, ieta).Wmunu[9] = temp_profile_pietaeta[idx];
-
-                if (DATA.Initial_profile == 9) {
-                    double pressure = eos.get_pressure(epsilon, rhob);
-                    arena_current(ix, iy, ieta).pi_b = epsilon/3. - pressure;
+                if (DATA.Initial_profile == 9 || DATA.Initial_profile == 93) {
+                    arena_current(ix, iy, ieta).Wmunu[0] = temp_profile_pitautau[idx];
+                    arena_current(ix, iy, ieta).Wmunu[1] = temp_profile_pitaux[idx];
+                    arena_current(ix, iy, ieta).Wmunu[2] = temp_profile_pitauy[idx];
+                    arena_current(ix, iy, ieta).Wmunu[3] = temp_profile_pitaueta[idx];
+                    arena_current(ix, iy, ieta).Wmunu[4] = temp_profile_pixx[idx];
+                    arena_current(ix, iy, ieta).Wmunu[5] = temp_profile_pixy[idx];
+                    arena_current(ix, iy, ieta).Wmunu[6] = temp_profile_pixeta[idx];
+                    arena_current(ix, iy, ieta).Wmunu[7] = temp_profile_piyy[idx];
+                    arena_current(ix, iy, ieta).Wmunu[8] = temp_profile_piyeta[idx];
+                    arena_current(ix, iy, ieta).Wmunu[9] = temp_profile_pietaeta[idx];
+
+                    if (DATA.Initial_profile == 9) {
+                        double pressure = eos.get_pressure(epsilon, rhob);
+                        arena_current(ix, iy, ieta).pi_b = epsilon/3. - pressure;
+                    }
                 }
+                arena_prev(ix, iy, ieta) = arena_current(ix, iy, ieta);
             }
-            arena_prev(ix, iy, ieta) = arena_current(ix, iy, ieta);
         }
     }
 }
 
 void Init::initial_MCGlb_with_rhob(SCGrid &arena_prev, SCGrid &arena_current) {
     // first load in the transverse profile
-    ifstream profile_TA(DATA.initName_TA.c_str());
-    ifstream profile_TB(DATA.initName_TB.c_str());
-
     const int nx = arena_current.nX();
     const int ny = arena_current.nY();
     const int neta = arena_current.nEta();
-    double temp_profile_TA[nx][ny];
-    double temp_profile_TB[nx][ny];
+    std::vector<double> profile_TA, profile_TB;
+    InitialProfileFile::read_transverse_field(DATA.initName_TA, nx, ny,
+                                              profile_TA);
+    InitialProfileFile::read_transverse_field(DATA.initName_TB, nx, ny,
+                                              profile_TB);
     double N_B = 0.0;
-    for (int i = 0; i < nx; i++) {
-        for (int j = 0; j < ny; j++) {
-            profile_TA >> temp_profile_TA[i][j];
-            profile_TB >> temp_profile_TB[i][j];
-            N_B += temp_profile_TA[i][j] + temp_profile_TB[i][j];
-        }
+    for (int idx = 0; idx < nx*ny; idx++) {
+        N_B += profile_TA[idx] + profile_TB[idx];
     }
-    profile_TA.close();
-    profile_TB.close();
     N_B *= DATA.delta_x*DATA.delta_y;
     double total_energy = DATA.ecm/2.*N_B;
     music_message << "sqrt{s} = " << DATA.ecm << " GeV, "
@@ -722,66 +701,91 @@ void Init::initial_MCGlb_with_rhob(SCGrid &arena_prev, SCGrid &arena_current) {
                   << "N_B = " << N_B;
     music_message.flush("info");
 
-    double T_tau_t = 0.0;
-    #pragma omp parallel for reduction(+: T_tau_t)
+    // the envelopes which only depend on eta, tabulated on the eta slices
+    std::vector<double> eta_table(neta), cosh_eta_table(neta);
+    std::vector<double> rhob_left_table(neta), rhob_right_table(neta);
+    std::vector<double> envelop_table(neta, 0.0);
+    const EtaGrid eta_grid(DATA);
     for (int ieta = 0; ieta < neta; ieta++) {
-        double eta = (DATA.delta_eta)*ieta - (DATA.eta_size)/2.0;
+        double eta = eta_grid.get_eta(ieta);
         if (DATA.boost_invariant) {
             eta = 0.0;
         }
-        double eta_rhob_left  = eta_rhob_left_factor(eta);
-        double eta_rhob_right = eta_rhob_right_factor(eta);
+        eta_table[ieta]        = eta;
+        cosh_eta_table[ieta]   = cosh(eta);
+        rhob_left_table[ieta]  = eta_rhob_left_factor(eta);
+        rhob_right_table[ieta] = eta_rhob_right_factor(eta);
+        if (DATA.Initial_profile == 11) {
+            envelop_table[ieta] = eta_profile_plateau(
+                    eta, DATA.eta_flat/2., DATA.eta_fall_off);
+        }
+    }
 
+    // the normalisations of Initial_profile 11 are the same for all cells
+    double norm_even = 0.0, norm_odd = 0.0;
+    if (DATA.Initial_profile == 11) {
+        const double eta_0 = DATA.eta_flat/2.;
+        const double sigma_eta = DATA.eta_fall_off;
+        const double E_norm = energy_eta_profile_normalisation(
+                                    0.0, eta_0, sigma_eta);
+        const double Pz_norm = Pz_eta_profile_normalisation(eta_0, sigma_eta);
+        norm_even = (1./(DATA.tau0*E_norm)
+                     *Util::m_N*cosh(DATA.beam_rapidity));
+        norm_odd = (DATA.beam_rapidity/(DATA.tau0*Pz_norm)
+                    *Util::m_N*sinh(DATA.beam_rapidity));
+    }
+
+    // the center-of-mass rapidity, the local energy and the normalisation
+    // of Initial_profile 111 only depend on the column (ix, iy)
+    std::vector<MCGlbColumn> columns;
+    if (DATA.Initial_profile == 111) {
+        columns.resize(nx*ny);
+        #pragma omp parallel for
+        for (int idx = 0; idx < nx*ny; idx++) {
+            const double TA = profile_TA[idx];
+            const double TB = profile_TB[idx];
+            MCGlbColumn &column = columns[idx];
+            column.y_CM = atanh((TA - TB)/(TA + TB + Util::small_eps)
+                                *tanh(DATA.beam_rapidity));
+            // local energy density [1/fm]
+            column.E_lrf = ((TA + TB)*Util::m_N*cosh(DATA.beam_rapidity)
+                            /Util::hbarc);
+            column.eta0 = std::min(DATA.eta_flat/2.0,
+                                   std::abs(DATA.beam_rapidity - column.y_CM));
+            column.E_norm = (DATA.tau0*energy_eta_profile_normalisation(
+                                column.y_CM, column.eta0, DATA.eta_fall_off));
+        }
+    }
+
+    // one pass over the grid, the rows (ieta, ix) are summed in order and
+    // added by DeterministicSum
+    std::vector<double> T_tau_t_row(neta*nx, 0.0);
+    #pragma omp parallel for collapse(2)
+    for (int ieta = 0; ieta < neta; ieta++) {
         for (int ix = 0; ix < nx; ix++) {
-            for (int iy = 0; iy< ny; iy++) {
+            const double eta = eta_table[ieta];
+            double T_tau_t_local = 0.0;
+            for (int iy = 0; iy < ny; iy++) {
+                const int idx = iy + ix*ny;
+                const double TA = profile_TA[idx];
+                const double TB = profile_TB[idx];
                 double rhob = 0.0;
                 double epsilon = 0.0;
                 if (DATA.turn_on_rhob == 1) {
-                    rhob = (  temp_profile_TA[ix][iy]*eta_rhob_right
-                            + temp_profile_TB[ix][iy]*eta_rhob_left);
-                } else {
-                    rhob = 0.0;
+                    rhob = (  TA*rhob_right_table[ieta]
+                            + TB*rhob_left_table[ieta]);
                 }
 
                 if (DATA.Initial_profile == 11) {
-                    const double eta_0 = DATA.eta_flat/2.;
-                    const double sigma_eta = DATA.eta_fall_off;
-                    const double E_norm = energy_eta_profile_normalisation(
-                                                0.0, eta_0, sigma_eta);
-                    const double Pz_norm = Pz_eta_profile_normalisation(
-                                                eta_0, sigma_eta);
-                    const double norm_even = (
-                            1./(DATA.tau0*E_norm)
-                            *Util::m_N*cosh(DATA.beam_rapidity));
-                    const double norm_odd = (
-                            DATA.beam_rapidity/(DATA.tau0*Pz_norm)
-                            *Util::m_N*sinh(DATA.beam_rapidity));
-                    double eta_envelop = eta_profile_plateau(
-                                                    eta, eta_0, sigma_eta);
                     epsilon = (
-                        ((  (temp_profile_TA[ix][iy] + temp_profile_TB[ix][iy])
-                           *norm_even
-                          + (temp_profile_TA[ix][iy] - temp_profile_TB[ix][iy])
-                            *norm_odd*eta/DATA.beam_rapidity)*eta_envelop)
-                        /Util::hbarc);
+                        ((  (TA + TB)*norm_even
+                          + (TA - TB)*norm_odd*eta/DATA.beam_rapidity)
+                         *envelop_table[ieta])/Util::hbarc);
                 } else if (DATA.Initial_profile == 111) {
-                    double y_CM = atanh(
-                        (temp_profile_TA[ix][iy] - temp_profile_TB[ix][iy])
-                        /(temp_profile_TA[ix][iy] + temp_profile_TB[ix][iy]
-                          + Util::small_eps)
-                        *tanh(DATA.beam_rapidity));
-                    // local energy density [1/fm]
-                    double E_lrf = (
-                        (temp_profile_TA[ix][iy] + temp_profile_TB[ix][iy])
-                        *Util::m_N*cosh(DATA.beam_rapidity)/Util::hbarc);
-                    double eta0 = std::min(DATA.eta_flat/2.0,
-                                    std::abs(DATA.beam_rapidity - y_CM));
+                    const MCGlbColumn &column = columns[idx];
                     double eta_envelop = eta_profile_plateau(
-                                    eta - y_CM, eta0, DATA.eta_fall_off);
-                    double E_norm = (
-                        DATA.tau0*energy_eta_profile_normalisation(
-                                    y_CM, eta0, DATA.eta_fall_off));
-                    epsilon = E_lrf*eta_envelop/E_norm;
+                            eta - column.y_CM, column.eta0, DATA.eta_fall_off);
+                    epsilon = column.E_lrf*eta_envelop/column.E_norm;
                 }
                 epsilon = std::max(Util::small_eps, epsilon);
 
@@ -793,25 +797,22 @@ void Init::initial_MCGlb_with_rhob(SCGrid &arena_prev, SCGrid &arena_current) {
                 arena_current(ix, iy, ieta).u[2] = 0.0;
                 arena_current(ix, iy, ieta).u[3] = 0.0;
 
-                T_tau_t += epsilon*cosh(eta);
+                arena_prev(ix, iy, ieta) = arena_current(ix, iy, ieta);
+
+                T_tau_t_local += epsilon*cosh_eta_table[ieta];
             }
+            // the widths of the cells of a stretched eta grid
+            T_tau_t_row[ieta*nx + ix] = (
+                T_tau_t_local*eta_grid.get_width(ieta)/DATA.delta_eta);
         }
     }
+    double T_tau_t = DeterministicSum::sum(
+            neta*nx, [&](const int64_t irow) {return(T_tau_t_row[irow]);});
     T_tau_t *= DATA.tau0*DATA.delta_eta*DATA.delta_x*DATA.delta_y*Util::hbarc;
+    // the energy is not renormalized, the norm is only printed
     double norm = total_energy/T_tau_t;
     music_message << "energy norm = " << norm;
     music_message.flush("info");
-
-    // renormalize the system's energy density
-    #pragma omp parallel for collapse(3)
-    for (int ieta = 0; ieta < neta; ieta++) {
-        for (int ix = 0; ix < nx; ix++) {
-            for (int iy = 0; iy< ny; iy++) {
-                //arena_current(ix, iy, ieta).epsilon *= norm;
-                arena_prev(ix, iy, ieta) = arena_current(ix, iy, ieta);
-            }
-        }
-    }
 }
 
 
@@ -887,7 +888,7 @@ void Init::initial_AMPT_XY(int ieta, SCGrid &arena_prev,
     double u[4] = {1.0, 0.0, 0.0, 0.0};
     EnergyFlowVec j_mu = {0.0, 0.0, 0.0, 0.0};
 
-    double eta = (DATA.delta_eta)*ieta - (DATA.eta_size)/2.0;
+    double eta = EtaGrid(DATA).get_eta(ieta);
     double tau0 = DATA.tau0;
     const int nx = arena_current.nX();
     const int ny = arena_current.nY();
@@ -935,88 +936,153 @@ void Init::get_jetscape_preequilibrium_vectors(
         vector<double> pi_13_in, vector<double> pi_22_in,
         vector<double> pi_23_in, vector<double> pi_33_in,
         vector<double> Bulk_pi_in) {
-    jetscape_initial_energy_density = e_in;
-    jetscape_initial_pressure       = P_in;
-    jetscape_initial_u_tau          = u_tau_in;
-    jetscape_initial_u_x            = u_x_in;
-    jetscape_initial_u_y            = u_y_in;
-    jetscape_initial_u_eta          = u_eta_in;
-    jetscape_initial_pi_00          = pi_00_in;
-    jetscape_initial_pi_01          = pi_01_in;
-    jetscape_initial_pi_02          = pi_02_in;
-    jetscape_initial_pi_03          = pi_03_in;
-    jetscape_initial_pi_11          = pi_11_in;
-    jetscape_initial_pi_12          = pi_12_in;
-    jetscape_initial_pi_13          = pi_13_in;
-    jetscape_initial_pi_22          = pi_22_in;
-    jetscape_initial_pi_23          = pi_23_in;
-    jetscape_initial_pi_33          = pi_33_in;
-    jetscape_initial_bulk_pi        = Bulk_pi_in;
+    // the vectors are moved in, the callers that move their vectors do
+    // not copy the fields at all
+    jetscape_initial_energy_density = std::move(e_in);
+    jetscape_initial_pressure       = std::move(P_in);
+    jetscape_initial_u_tau          = std::move(u_tau_in);
+    jetscape_initial_u_x            = std::move(u_x_in);
+    jetscape_initial_u_y            = std::move(u_y_in);
+    jetscape_initial_u_eta          = std::move(u_eta_in);
+    jetscape_initial_pi_00          = std::move(pi_00_in);
+    jetscape_initial_pi_01          = std::move(pi_01_in);
+    jetscape_initial_pi_02          = std::move(pi_02_in);
+    jetscape_initial_pi_03          = std::move(pi_03_in);
+    jetscape_initial_pi_11          = std::move(pi_11_in);
+    jetscape_initial_pi_12          = std::move(pi_12_in);
+    jetscape_initial_pi_13          = std::move(pi_13_in);
+    jetscape_initial_pi_22          = std::move(pi_22_in);
+    jetscape_initial_pi_23          = std::move(pi_23_in);
+    jetscape_initial_pi_33          = std::move(pi_33_in);
+    jetscape_initial_bulk_pi        = std::move(Bulk_pi_in);
+
+    const std::vector<const std::vector<double>*> fields = {
+        &jetscape_initial_pressure, &jetscape_initial_u_tau,
+        &jetscape_initial_u_x, &jetscape_initial_u_y,
+        &jetscape_initial_u_eta, &jetscape_initial_pi_00,
+        &jetscape_initial_pi_01, &jetscape_initial_pi_02,
+        &jetscape_initial_pi_03, &jetscape_initial_pi_11,
+        &jetscape_initial_pi_12, &jetscape_initial_pi_13,
+        &jetscape_initial_pi_22, &jetscape_initial_pi_23,
+        &jetscape_initial_pi_33, &jetscape_initial_bulk_pi};
+    for (const auto field : fields) {
+        if (field->size() != jetscape_initial_energy_density.size()) {
+            music_message << "The JETSCAPE initial condition vectors have "
+                          << "different sizes: " << field->size() << " != "
+                          << jetscape_initial_energy_density.size();
+            music_message.flush("error");
+            exit(1);
+        }
+    }
+
+    JetscapePreequilibriumFields view;
+    view.n_cells = jetscape_initial_energy_density.size();
+    view.e       = jetscape_initial_energy_density.data();
+    view.P       = jetscape_initial_pressure.data();
+    view.u_tau   = jetscape_initial_u_tau.data();
+    view.u_x     = jetscape_initial_u_x.data();
+    view.u_y     = jetscape_initial_u_y.data();
+    view.u_eta   = jetscape_initial_u_eta.data();
+    view.pi_00   = jetscape_initial_pi_00.data();
+    view.pi_01   = jetscape_initial_pi_01.data();
+    view.pi_02   = jetscape_initial_pi_02.data();
+    view.pi_03   = jetscape_initial_pi_03.data();
+    view.pi_11   = jetscape_initial_pi_11.data();
+    view.pi_12   = jetscape_initial_pi_12.data();
+    view.pi_13   = jetscape_initial_pi_13.data();
+    view.pi_22   = jetscape_initial_pi_22.data();
+    view.pi_23   = jetscape_initial_pi_23.data();
+    view.pi_33   = jetscape_initial_pi_33.data();
+    view.bulk_pi = jetscape_initial_bulk_pi.data();
+    jetscape_fields = view;
 }
 
 
-void Init::initial_with_jetscape(int ieta, SCGrid &arena_prev,
-                                 SCGrid &arena_current) {
+void Init::set_jetscape_preequilibrium_fields(
+                            const JetscapePreequilibriumFields &fields) {
+    const double *arrays[] = {
+        fields.e, fields.P, fields.u_tau, fields.u_x, fields.u_y,
+        fields.u_eta, fields.pi_00, fields.pi_01, fields.pi_02,
+        fields.pi_03, fields.pi_11, fields.pi_12, fields.pi_13,
+        fields.pi_22, fields.pi_23, fields.pi_33, fields.bulk_pi};
+    for (const auto array : arrays) {
+        if (array == nullptr && fields.n_cells > 0) {
+            music_message << "The JETSCAPE initial condition misses a field";
+            music_message.flush("error");
+            exit(1);
+        }
+    }
+    jetscape_fields = fields;
+}
+
+
+void Init::initial_with_jetscape(SCGrid &arena_prev, SCGrid &arena_current) {
     const int nx = arena_current.nX();
     const int ny = arena_current.nY();
+    const int neta = arena_current.nEta();
+    const JetscapePreequilibriumFields &in = jetscape_fields;
 
-    for (int ix = 0; ix < nx; ix++) {
-        for (int iy = 0; iy< ny; iy++) {
-            const double rhob = 0.0;
-            double epsilon = 0.0;
-            const int idx = iy + ix*ny + ieta*ny*nx;
-            epsilon = (jetscape_initial_energy_density[idx]
-                       *DATA.sFactor/hbarc);  // 1/fm^4
-            epsilon = std::max(Util::small_eps, epsilon);
-
-            arena_current(ix, iy, ieta).epsilon = epsilon;
-            arena_current(ix, iy, ieta).rhob = rhob;
-            double pressure = eos.get_pressure(epsilon, rhob);
-
-            arena_current(ix, iy, ieta).u[0] = jetscape_initial_u_tau[idx];
-            arena_current(ix, iy, ieta).u[1] = jetscape_initial_u_x[idx];
-            arena_current(ix, iy, ieta).u[2] = jetscape_initial_u_y[idx];
-            arena_current(ix, iy, ieta).u[3] = DATA.tau0*jetscape_initial_u_eta[idx];
-
-            arena_current(ix, iy, ieta).pi_b = (DATA.sFactor/hbarc*(
-                jetscape_initial_pressure[idx] + jetscape_initial_bulk_pi[idx])
-                - pressure);
-
-            arena_current(ix, iy, ieta).Wmunu[0] = DATA.sFactor*jetscape_initial_pi_00[idx]/hbarc;
-            arena_current(ix, iy, ieta).Wmunu[1] = DATA.sFactor*jetscape_initial_pi_01[idx]/hbarc;
-            arena_current(ix, iy, ieta).Wmunu[2] = DATA.sFactor*jetscape_initial_pi_02[idx]/hbarc;
-            arena_current(ix, iy, ieta).Wmunu[3] = DATA.sFactor*jetscape_initial_pi_03[idx]/hbarc*DATA.tau0;
-            arena_current(ix, iy, ieta).Wmunu[4] = DATA.sFactor*jetscape_initial_pi_11[idx]/hbarc;
-            arena_current(ix, iy, ieta).Wmunu[5] = DATA.sFactor*jetscape_initial_pi_12[idx]/hbarc;
-            arena_current(ix, iy, ieta).Wmunu[6] = DATA.sFactor*jetscape_initial_pi_13[idx]/hbarc*DATA.tau0;
-            arena_current(ix, iy, ieta).Wmunu[7] = DATA.sFactor*jetscape_initial_pi_22[idx]/hbarc;
-            arena_current(ix, iy, ieta).Wmunu[8] = DATA.sFactor*jetscape_initial_pi_23[idx]/hbarc*DATA.tau0;
-            arena_current(ix, iy, ieta).Wmunu[9] = DATA.sFactor*jetscape_initial_pi_33[idx]/hbarc*DATA.tau0*DATA.tau0;
+    #pragma omp parallel for collapse(2)
+    for (int ieta = 0; ieta < neta; ieta++) {
+        for (int ix = 0; ix < nx; ix++) {
+            for (int iy = 0; iy< ny; iy++) {
+                const double rhob = 0.0;
+                double epsilon = 0.0;
+                const int idx = iy + ix*ny + ieta*ny*nx;
+                epsilon = (in.e[idx]*DATA.sFactor/hbarc);  // 1/fm^4
+                epsilon = std::max(Util::small_eps, epsilon);
 
-            arena_prev(ix, iy, ieta) = arena_current(ix, iy, ieta);
+                Cell_small &cell = arena_current(ix, iy, ieta);
+                cell.epsilon = epsilon;
+                cell.rhob = rhob;
+                double pressure = eos.get_pressure(epsilon, rhob);
+
+                cell.u[0] = in.u_tau[idx];
+                cell.u[1] = in.u_x[idx];
+                cell.u[2] = in.u_y[idx];
+                cell.u[3] = DATA.tau0*in.u_eta[idx];
+
+                cell.pi_b = (DATA.sFactor/hbarc*(in.P[idx] + in.bulk_pi[idx])
+                             - pressure);
+
+                cell.Wmunu[0] = DATA.sFactor*in.pi_00[idx]/hbarc;
+                cell.Wmunu[1] = DATA.sFactor*in.pi_01[idx]/hbarc;
+                cell.Wmunu[2] = DATA.sFactor*in.pi_02[idx]/hbarc;
+                cell.Wmunu[3] = DATA.sFactor*in.pi_03[idx]/hbarc*DATA.tau0;
+                cell.Wmunu[4] = DATA.sFactor*in.pi_11[idx]/hbarc;
+                cell.Wmunu[5] = DATA.sFactor*in.pi_12[idx]/hbarc;
+                cell.Wmunu[6] = DATA.sFactor*in.pi_13[idx]/hbarc*DATA.tau0;
+                cell.Wmunu[7] = DATA.sFactor*in.pi_22[idx]/hbarc;
+                cell.Wmunu[8] = DATA.sFactor*in.pi_23[idx]/hbarc*DATA.tau0;
+                cell.Wmunu[9] = (DATA.sFactor*in.pi_33[idx]/hbarc
+                                 *DATA.tau0*DATA.tau0);
+
+                arena_prev(ix, iy, ieta) = cell;
+            }
         }
     }
 }
 
 void Init::clean_up_jetscape_arrays() {
-    // clean up
-    jetscape_initial_energy_density.clear();
-    jetscape_initial_pressure.clear();
-    jetscape_initial_u_tau.clear();
-    jetscape_initial_u_x.clear();
-    jetscape_initial_u_y.clear();
-    jetscape_initial_u_eta.clear();
-    jetscape_initial_pi_00.clear();
-    jetscape_initial_pi_01.clear();
-    jetscape_initial_pi_02.clear();
-    jetscape_initial_pi_03.clear();
-    jetscape_initial_pi_11.clear();
-    jetscape_initial_pi_12.clear();
-    jetscape_initial_pi_13.clear();
-    jetscape_initial_pi_22.clear();
-    jetscape_initial_pi_23.clear();
-    jetscape_initial_pi_33.clear();
-    jetscape_initial_bulk_pi.clear();
+    // free the staging vectors, clear() would keep their memory
+    std::vector<double>().swap(jetscape_initial_energy_density);
+    std::vector<double>().swap(jetscape_initial_pressure);
+    std::vector<double>().swap(jetscape_initial_u_tau);
+    std::vector<double>().swap(jetscape_initial_u_x);
+    std::vector<double>().swap(jetscape_initial_u_y);
+    std::vector<double>().swap(jetscape_initial_u_eta);
+    std::vector<double>().swap(jetscape_initial_pi_00);
+    std::vector<double>().swap(jetscape_initial_pi_01);
+    std::vector<double>().swap(jetscape_initial_pi_02);
+    std::vector<double>().swap(jetscape_initial_pi_03);
+    std::vector<double>().swap(jetscape_initial_pi_11);
+    std::vector<double>().swap(jetscape_initial_pi_12);
+    std::vector<double>().swap(jetscape_initial_pi_13);
+    std::vector<double>().swap(jetscape_initial_pi_22);
+    std::vector<double>().swap(jetscape_initial_pi_23);
+    std::vector<double>().swap(jetscape_initial_pi_33);
+    std::vector<double>().swap(jetscape_initial_bulk_pi);
+    jetscape_fields = JetscapePreequilibriumFields();
 }
 
 
@@ -1032,6 +1098,18 @@ double Init::eta_profile_plateau(const double eta, const double eta_0,
 }
 
 
+std::vector<double> Init::get_eta_plateau_table(const int neta) const {
+    std::vector<double> envelop_table(neta);
+    const EtaGrid eta_grid(DATA);
+    for (int ieta = 0; ieta < neta; ieta++) {
+        const double eta = eta_grid.get_eta(ieta);
+        envelop_table[ieta] = eta_profile_plateau(eta, DATA.eta_flat/2.0,
+                                                  DATA.eta_fall_off);
+    }
+    return(envelop_table);
+}
+
+
 double Init::energy_eta_profile_normalisation(
         const double y_CM, const double eta_0, const double sigma_eta) const {
     // this function returns the normalization of the eta envelope profile
@@ -1162,8 +1240,9 @@ void Init::output_initial_density_profiles(SCGrid &arena) {
     if (DATA.turn_on_rhob == 1)
         of << "  rhob(1/fm^3)";
     of << std::endl;
+    const EtaGrid eta_grid(DATA);
     for (int ieta = 0; ieta < arena.nEta(); ieta++) {
-        double eta_local = (DATA.delta_eta)*ieta - (DATA.eta_size)/2.0;
+        double eta_local = eta_grid.get_eta(ieta);
         for(int ix = 0; ix < arena.nX(); ix++) {
             double x_local = -DATA.x_size/2. + ix*DATA.delta_x;
             for(int iy = 0; iy < arena.nY(); iy++) {
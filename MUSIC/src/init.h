@@ -12,8 +12,32 @@
 #include "grid.h"
 #include "eos.h"
 #include "hydro_source_base.h"
+#include "initial_profile_file.h"
 #include "pretty_ostream.h"
 
+//! non-owning views of the JETSCAPE preequilibrium fields, each with
+//! n_cells values ordered [ieta][ix][iy] with iy innermost
+struct JetscapePreequilibriumFields {
+    size_t n_cells = 0;
+    const double *e = nullptr;
+    const double *P = nullptr;
+    const double *u_tau = nullptr;
+    const double *u_x = nullptr;
+    const double *u_y = nullptr;
+    const double *u_eta = nullptr;
+    const double *pi_00 = nullptr;
+    const double *pi_01 = nullptr;
+    const double *pi_02 = nullptr;
+    const double *pi_03 = nullptr;
+    const double *pi_11 = nullptr;
+    const double *pi_12 = nullptr;
+    const double *pi_13 = nullptr;
+    const double *pi_22 = nullptr;
+    const double *pi_23 = nullptr;
+    const double *pi_33 = nullptr;
+    const double *bulk_pi = nullptr;
+};
+
 class Init {
  private:
     InitData &DATA;
@@ -39,6 +63,14 @@ class Init {
     std::vector<double> jetscape_initial_pi_23;
     std::vector<double> jetscape_initial_pi_33;
     std::vector<double> jetscape_initial_bulk_pi;
+    //! the fields read by initial_with_jetscape, either the vectors above
+    //! or the caller's arrays
+    JetscapePreequilibriumFields jetscape_fields;
+
+    //! the transverse profile of Initial_profile 8 and 9x, read once in
+    //! InitArena
+    InitialProfile initial_profile;
+    void read_initial_profile();
 
  public:
     Init(const EOS &eos, InitData &DATA_in,
@@ -51,13 +83,13 @@ class Init {
 
     void initial_Gubser_XY               (int ieta, SCGrid &arena_prev, SCGrid &arena_current);
     void initial_1p1D_eta                (SCGrid &arena_prev, SCGrid &arena_current);
-    void initial_IPGlasma_XY             (int ieta, SCGrid &arena_prev, SCGrid &arena_current);
-    void initial_IPGlasma_XY_with_pi     (int ieta, SCGrid &arena_prev, SCGrid &arena_current);
+    void initial_IPGlasma_XY             (SCGrid &arena_prev, SCGrid &arena_current);
+    void initial_IPGlasma_XY_with_pi     (SCGrid &arena_prev, SCGrid &arena_current);
     void initial_with_zero_XY            (int ieta, SCGrid &arena_prev, SCGrid &arena_current);
     void initial_AMPT_XY                 (int ieta, SCGrid &arena_prev, SCGrid &arena_current);
     void initial_MCGlb_with_rhob         (SCGrid &arena_prev, SCGrid &arena_current);
     void initial_UMN_with_rhob           (SCGrid &arena_prev, SCGrid & arena_current);
-    void initial_with_jetscape           (int ieta, SCGrid &arena_prev, SCGrid &arena_current);
+    void initial_with_jetscape           (SCGrid &arena_prev, SCGrid &arena_current);
 
     void get_jetscape_preequilibrium_vectors(
         std::vector<double> e_in, std::vector<double> P_in,
@@ -69,10 +101,16 @@ class Init {
         std::vector<double> pi_13_in, std::vector<double> pi_22_in,
         std::vector<double> pi_23_in, std::vector<double> pi_33_in,
         std::vector<double> Bulk_pi_in);
+    //! uses the caller's arrays, which have to stay valid until InitArena()
+    void set_jetscape_preequilibrium_fields(
+                                const JetscapePreequilibriumFields &fields);
     void clean_up_jetscape_arrays();
 
     double eta_profile_plateau(const double eta, const double eta_0,
                                const double sigma_eta) const;
+    //! eta_profile_plateau(eta_s, eta_flat/2, eta_fall_off) of the eta
+    //! slices
+    std::vector<double> get_eta_plateau_table(const int neta) const;
     double energy_eta_profile_normalisation(
         const double y_CM, const double eta_0, const double sigma_eta) const;
     double Pz_eta_profile_normalisation(
@@ -0,0 +1,312 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include "initial_profile_file.h"
+#include "pretty_ostream.h"
+
+namespace {
+    const char kMagic[8] = {'M', 'U', 'S', 'I', 'C', 'I', 'C', '1'};
+    const int32_t kFormatVersion = 1;
+    const int kNumHeaderInts = 6;
+    //! the header size before the field names
+    const size_t kHeaderSize = (8 + kNumHeaderInts*sizeof(int32_t)
+                                + 6*sizeof(double) + sizeof(int32_t));
+
+    //! reads the whole file into content, returns false on failure
+    bool read_file(const std::string &filename, std::string &content) {
+        FILE *file = fopen(filename.c_str(), "rb");
+        if (file == nullptr) return(false);
+        fseek(file, 0, SEEK_END);
+        const long size = ftell(file);
+        fseek(file, 0, SEEK_SET);
+        content.resize(size > 0 ? size : 0);
+        const bool success = (size <= 0
+                              || fread(&content[0], 1, size, file)
+                                 == static_cast<size_t>(size));
+        fclose(file);
+        return(success);
+    }
+
+    //! parses the numbers of the line at pos into values, the missing
+    //! numbers are set to 0. pos is moved to the next line.
+    void parse_line(const std::string &content, size_t &pos,
+                    std::vector<double> &values) {
+        const char *begin = content.c_str() + pos;
+        const char *line_end = strchr(begin, '\n');
+        if (line_end == nullptr) line_end = content.c_str() + content.size();
+        const char *current = begin;
+        for (auto &value : values) {
+            char *end;
+            value = 0.;
+            if (current < line_end) {
+                value = strtod(current, &end);
+                if (end == current || end > line_end) {
+                    value = 0.;
+                    current = line_end;
+                } else {
+                    current = end;
+                }
+            }
+        }
+        pos = line_end - content.c_str();
+        if (pos < content.size()) pos++;
+    }
+
+    void read_text(const std::string &filename,
+                   const std::vector<std::string> &columns,
+                   InitialProfile &profile) {
+        pretty_ostream music_message;
+        std::string content;
+        if (!read_file(filename, content)) {
+            music_message << "InitialProfileFile: can not open the initial "
+                          << "file: " << filename;
+            music_message.flush("error");
+            exit(1);
+        }
+        size_t pos = content.find('\n');
+        std::stringstream header(content.substr(0, pos));
+        std::string dummy;
+        header >> dummy >> dummy >> profile.tau0
+               >> dummy >> profile.neta >> dummy >> profile.nx
+               >> dummy >> profile.ny >> dummy >> profile.deta
+               >> dummy >> profile.dx >> dummy >> profile.dy;
+        if (header.fail() || profile.nx <= 0 || profile.ny <= 0) {
+            music_message << "InitialProfileFile: can not read the header "
+                          << "of " << filename;
+            music_message.flush("error");
+            exit(1);
+        }
+        pos = (pos == std::string::npos ? content.size() : pos + 1);
+
+        const size_t n_cells = static_cast<size_t>(profile.nx)*profile.ny;
+        std::vector<int> field_column;
+        profile.field_names.clear();
+        for (unsigned int i = 0; i < columns.size(); i++) {
+            if (columns[i].empty()) continue;
+            profile.field_names.push_back(columns[i]);
+            field_column.push_back(3 + i);
+        }
+        profile.fields.assign(profile.field_names.size(),
+                              std::vector<double>(n_cells, 0.));
+        std::vector<double> values(3 + columns.size());
+        for (size_t idx = 0; idx < n_cells; idx++) {
+            if (pos >= content.size()) {
+                music_message << "InitialProfileFile: " << filename
+                              << " ends after " << idx << " of " << n_cells
+                              << " cells";
+                music_message.flush("error");
+                exit(1);
+            }
+            parse_line(content, pos, values);
+            if (idx == 0) {
+                profile.x_min = values[1];
+                profile.y_min = values[2];
+            }
+            for (unsigned int i = 0; i < field_column.size(); i++) {
+                profile.fields[i][idx] = values[field_column[i]];
+            }
+        }
+    }
+
+    //! reads the header of a binary profile into profile and the names of
+    //! the fields of the file into file_names, returns false on failure
+    bool read_binary_header(FILE *file, InitialProfile &profile,
+                            std::vector<std::string> &file_names) {
+        char magic[8];
+        int32_t header[kNumHeaderInts];
+        double grid[6];
+        int32_t names_length = 0;
+        if (fread(magic, 1, 8, file) != 8
+                || std::memcmp(magic, kMagic, 8) != 0
+                || fread(header, sizeof(int32_t), kNumHeaderInts, file)
+                   != static_cast<size_t>(kNumHeaderInts)
+                || header[0] != kFormatVersion
+                || fread(grid, sizeof(double), 6, file) != 6
+                || fread(&names_length, sizeof(int32_t), 1, file) != 1
+                || names_length < 0) {
+            return(false);
+        }
+        profile.neta  = header[2];
+        profile.nx    = header[3];
+        profile.ny    = header[4];
+        profile.tau0  = grid[0];
+        profile.deta  = grid[1];
+        profile.dx    = grid[2];
+        profile.dy    = grid[3];
+        profile.x_min = grid[4];
+        profile.y_min = grid[5];
+        std::string names(names_length, '\0');
+        if (names_length > 0
+                && fread(&names[0], 1, names_length, file)
+                   != static_cast<size_t>(names_length)) {
+            return(false);
+        }
+        file_names.clear();
+        std::stringstream names_stream(names.c_str());
+        std::string name;
+        while (std::getline(names_stream, name, ',')) {
+            file_names.push_back(name);
+        }
+        return(static_cast<int>(file_names.size()) == header[1]);
+    }
+
+    void read_binary(const std::string &filename,
+                     const std::vector<std::string> &columns,
+                     InitialProfile &profile) {
+        pretty_ostream music_message;
+        FILE *file = fopen(filename.c_str(), "rb");
+        std::vector<std::string> file_names;
+        if (file == nullptr
+                || !read_binary_header(file, profile, file_names)) {
+            music_message << "InitialProfileFile: " << filename
+                          << " is not a binary initial profile";
+            music_message.flush("error");
+            exit(1);
+        }
+        const long data_offset = ftell(file);
+
+        const size_t n_cells = static_cast<size_t>(profile.nx)*profile.ny;
+        profile.field_names.clear();
+        profile.fields.clear();
+        for (const auto &column : columns) {
+            if (column.empty()) continue;
+            profile.field_names.push_back(column);
+            profile.fields.emplace_back(n_cells, 0.);
+            int field = -1;
+            for (unsigned int i = 0; i < file_names.size(); i++) {
+                if (file_names[i] == column) field = static_cast<int>(i);
+            }
+            if (field < 0) {
+                music_message << "InitialProfileFile: " << filename
+                              << " has no field " << column
+                              << ", it is set to 0";
+                music_message.flush("warning");
+                continue;
+            }
+            fseek(file, data_offset + field*n_cells*sizeof(double),
+                  SEEK_SET);
+            if (fread(profile.fields.back().data(), sizeof(double), n_cells,
+                      file) != n_cells) {
+                music_message << "InitialProfileFile: " << filename
+                              << " ends in the field " << column;
+                music_message.flush("error");
+                exit(1);
+            }
+        }
+        fclose(file);
+    }
+}
+
+
+int InitialProfile::get_field_index(const std::string &name) const {
+    for (unsigned int i = 0; i < field_names.size(); i++) {
+        if (field_names[i] == name) return(static_cast<int>(i));
+    }
+    return(-1);
+}
+
+
+namespace InitialProfileFile {
+
+bool is_binary(const std::string &filename) {
+    FILE *file = fopen(filename.c_str(), "rb");
+    if (file == nullptr) return(false);
+    char magic[8];
+    const bool binary = (fread(magic, 1, 8, file) == 8
+                         && std::memcmp(magic, kMagic, 8) == 0);
+    fclose(file);
+    return(binary);
+}
+
+
+void read(const std::string &filename,
+          const std::vector<std::string> &columns, InitialProfile &profile) {
+    if (is_binary(filename)) {
+        read_binary(filename, columns, profile);
+    } else {
+        read_text(filename, columns, profile);
+    }
+}
+
+
+bool write_binary(const std::string &filename, const InitialProfile &profile) {
+    FILE *file = fopen(filename.c_str(), "wb");
+    if (file == nullptr) return(false);
+    std::string names;
+    for (unsigned int i = 0; i < profile.field_names.size(); i++) {
+        if (i > 0) names += ",";
+        names += profile.field_names[i];
+    }
+    names.resize(names.size() + (8 - (kHeaderSize + names.size())%8)%8,
+                 '\0');
+    const int32_t header[kNumHeaderInts] = {
+        kFormatVersion, static_cast<int32_t>(profile.fields.size()),
+        profile.neta, profile.nx, profile.ny, 0};
+    const double grid[6] = {profile.tau0, profile.deta, profile.dx,
+                            profile.dy, profile.x_min, profile.y_min};
+    const int32_t names_length = static_cast<int32_t>(names.size());
+    fwrite(kMagic, 1, 8, file);
+    fwrite(header, sizeof(int32_t), kNumHeaderInts, file);
+    fwrite(grid, sizeof(double), 6, file);
+    fwrite(&names_length, sizeof(int32_t), 1, file);
+    fwrite(names.data(), 1, names.size(), file);
+    bool success = true;
+    for (const auto &field : profile.fields) {
+        success = (success && fwrite(field.data(), sizeof(double),
+                                     field.size(), file) == field.size());
+    }
+    return(fclose(file) == 0 && success);
+}
+
+
+void read_transverse_field(const std::string &filename, const int nx,
+                           const int ny, std::vector<double> &field) {
+    pretty_ostream music_message;
+    const size_t n_cells = static_cast<size_t>(nx)*ny;
+    if (is_binary(filename)) {
+        InitialProfile profile;
+        std::vector<std::string> file_names;
+        FILE *file = fopen(filename.c_str(), "rb");
+        field.resize(n_cells);
+        const bool success = (
+            read_binary_header(file, profile, file_names)
+            && !file_names.empty()
+            && static_cast<size_t>(profile.nx)*profile.ny == n_cells
+            && fread(field.data(), sizeof(double), n_cells, file) == n_cells);
+        fclose(file);
+        if (!success) {
+            music_message << "InitialProfileFile: " << filename
+                          << " does not hold a " << nx << " x " << ny
+                          << " field";
+            music_message.flush("error");
+            exit(1);
+        }
+        return;
+    }
+
+    std::string content;
+    if (!read_file(filename, content)) {
+        music_message << "InitialProfileFile: can not open the initial "
+                      << "file: " << filename;
+        music_message.flush("error");
+        exit(1);
+    }
+    field.resize(n_cells);
+    const char *current = content.c_str();
+    for (size_t idx = 0; idx < n_cells; idx++) {
+        char *end;
+        field[idx] = strtod(current, &end);
+        if (end == current) {
+            music_message << "InitialProfileFile: " << filename
+                          << " ends after " << idx << " of " << n_cells
+                          << " values";
+            music_message.flush("error");
+            exit(1);
+        }
+        current = end;
+    }
+}
+
+}  // namespace InitialProfileFile
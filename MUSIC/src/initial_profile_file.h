@@ -0,0 +1,64 @@
+#ifndef SRC_INITIAL_PROFILE_FILE_H_
+#define SRC_INITIAL_PROFILE_FILE_H_
+
+#include <string>
+#include <vector>
+
+//! a transverse initial profile (IP-Glasma, Initial_profile 8 and 9x).
+//! The profile is one slice in x and y, which Init extends in eta with
+//! the eta envelope.
+struct InitialProfile {
+    int neta = 1;           //!< number of eta cells given in the header
+    int nx = 0;
+    int ny = 0;
+    double tau0 = 0.;       //!< in fm
+    double deta = 0.;
+    double dx = 0.;         //!< in fm
+    double dy = 0.;         //!< in fm
+    double x_min = 0.;      //!< x of the first cell in fm
+    double y_min = 0.;      //!< y of the first cell in fm
+    std::vector<std::string> field_names;
+    //! [field][ix*ny + iy]
+    std::vector<std::vector<double>> fields;
+
+    //! returns the index of the field, -1 if there is no such field
+    int get_field_index(const std::string &name) const;
+};
+
+
+//! This namespace reads and writes the initial profiles. The text format
+//! is the IP-Glasma one: a header line
+//!    # tau_in_fm tau0 etamax= neta xmax= nx ymax= ny deta= deta dx= dx dy= dy
+//! followed by nx*ny lines (iy innermost) starting with the columns
+//! eta x y. The binary format starts with the 8 char magic "MUSICIC1",
+//! the int32 format version, the int32 number of fields, the int32 neta,
+//! nx, ny, an int32 0, the doubles tau0, deta, dx, dy, x_min, y_min, the
+//! int32 length of the comma separated field names and the names padded
+//! with '\0' to a multiple of 8 bytes of the header. The fields follow as
+//! nx*ny doubles each. The data starts at a multiple of 8 bytes, so the
+//! file can also be mapped into memory directly.
+//! utilities/convert_initial_profile_to_binary.py converts text profiles.
+namespace InitialProfileFile {
+
+//! returns whether the file starts with the magic of the binary format
+bool is_binary(const std::string &filename);
+
+//! reads a profile in either format. For text profiles columns names the
+//! columns after eta x y, "" skips a column. Binary profiles have to
+//! hold all the named columns. It exits with an error if the file can not
+//! be read.
+void read(const std::string &filename,
+          const std::vector<std::string> &columns, InitialProfile &profile);
+
+//! writes the profile in the binary format, returns false on failure
+bool write_binary(const std::string &filename, const InitialProfile &profile);
+
+//! reads the nx*ny values iy innermost of a text file without a header
+//! (the MC-Glauber thickness functions) or the first field of a binary
+//! profile. It exits with an error if the file can not be read.
+void read_transverse_field(const std::string &filename, const int nx,
+                           const int ny, std::vector<double> &field);
+
+}  // namespace InitialProfileFile
+
+#endif  // SRC_INITIAL_PROFILE_FILE_H_
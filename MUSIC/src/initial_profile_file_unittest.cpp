@@ -0,0 +1,90 @@
+#include "doctest.h"
+#include "initial_profile_file.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+    double get_test_value(const int field, const int idx) {
+        return(0.125*field + 1e-3*idx - 0.01);
+    }
+
+    //! writes a 4 x 3 IP-Glasma style text profile with 4 fields
+    void write_test_text_file(const std::string &filename) {
+        FILE *file = fopen(filename.c_str(), "w");
+        fprintf(file, "# tau_in_fm 0.4 etamax= 1 xmax= 4 ymax= 3 deta= 0 "
+                      "dx= 0.5 dy= 0.25\n");
+        for (int ix = 0; ix < 4; ix++) {
+            for (int iy = 0; iy < 3; iy++) {
+                const int idx = iy + ix*3;
+                fprintf(file, "0 %.17g %.17g", -0.75 + 0.5*ix,
+                        -0.25 + 0.25*iy);
+                for (int field = 0; field < 4; field++) {
+                    fprintf(file, " %.17g", get_test_value(field, idx));
+                }
+                fprintf(file, "\n");
+            }
+        }
+        fclose(file);
+    }
+}
+
+TEST_CASE("Check InitialProfileFile reads text and binary profiles") {
+    const std::string text_name = "test_initial_profile.txt";
+    const std::string binary_name = "test_initial_profile.bin";
+    write_test_text_file(text_name);
+    CHECK(!InitialProfileFile::is_binary(text_name));
+
+    InitialProfile text;
+    InitialProfileFile::read(text_name, {"ed", "", "ux", "uy"}, text);
+    CHECK(text.nx == 4);
+    CHECK(text.ny == 3);
+    CHECK(text.tau0 == 0.4);
+    CHECK(text.dx == 0.5);
+    CHECK(text.dy == 0.25);
+    CHECK(text.x_min == -0.75);
+    CHECK(text.y_min == -0.25);
+    REQUIRE(text.fields.size() == 3);
+    CHECK(text.get_field_index("ux") == 1);
+    CHECK(text.get_field_index("utau") == -1);
+    CHECK(text.fields[2][7] == get_test_value(3, 7));
+
+    REQUIRE(InitialProfileFile::write_binary(binary_name, text));
+    CHECK(InitialProfileFile::is_binary(binary_name));
+    InitialProfile binary;
+    InitialProfileFile::read(binary_name, {"uy", "ed", "ueta"}, binary);
+    CHECK(binary.nx == text.nx);
+    CHECK(binary.ny == text.ny);
+    CHECK(binary.dy == text.dy);
+    CHECK(binary.x_min == text.x_min);
+    REQUIRE(binary.fields.size() == 3);
+    CHECK(binary.fields[0] == text.fields[2]);
+    CHECK(binary.fields[1] == text.fields[0]);
+    // the missing fields are 0
+    CHECK(binary.fields[2] == std::vector<double>(12, 0.));
+
+    std::vector<double> field;
+    InitialProfileFile::read_transverse_field(binary_name, 4, 3, field);
+    CHECK(field == text.fields[0]);
+    remove(text_name.c_str());
+    remove(binary_name.c_str());
+}
+
+TEST_CASE("Check InitialProfileFile reads the headerless thickness files") {
+    const std::string filename = "test_thickness.txt";
+    FILE *file = fopen(filename.c_str(), "w");
+    for (int ix = 0; ix < 3; ix++) {
+        for (int iy = 0; iy < 2; iy++) {
+            fprintf(file, "%.17g ", get_test_value(0, iy + 2*ix));
+        }
+        fprintf(file, "\n");
+    }
+    fclose(file);
+    std::vector<double> field;
+    InitialProfileFile::read_transverse_field(filename, 3, 2, field);
+    REQUIRE(field.size() == 6);
+    for (int idx = 0; idx < 6; idx++) {
+        CHECK(field[idx] == get_test_value(0, idx));
+    }
+    remove(filename.c_str());
+}
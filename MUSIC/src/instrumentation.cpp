@@ -0,0 +1,337 @@
+#ifdef _OPENMP
+    #include <omp.h>
+#endif
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <sstream>
+#include "aligned_allocator.h"
+#include "causality_diagnostics.h"
+#include "instrumentation.h"
+#include "pretty_ostream.h"
+
+#ifndef _OPENMP
+    #define omp_get_thread_num() 0
+    #define omp_get_max_threads() 1
+    #define omp_in_parallel() 0
+#endif
+
+namespace {
+    using InstrumentedTimer::n_timers;
+    using InstrumentedCounter::n_counters;
+
+    //! the counters of one thread, aligned to a cache line so that the
+    //! threads do not share lines
+    struct alignas(64) ThreadBlock {
+        long long counters[n_counters];
+        //! calls and seconds of the timers by timer and parent + 1
+        //! (0 for the timers without a parent)
+        long long calls[n_timers][n_timers + 1];
+        double seconds[n_timers][n_timers + 1];
+        //! the innermost timer of the thread in a parallel region
+        int active;
+        //! the seconds in the tiles of the scheduled sweeps, and waiting
+        //! for the other threads at their ends
+        double busy_seconds;
+        double idle_seconds;
+    };
+
+    //! the sums over the threads and the parents
+    struct Totals {
+        long long calls[n_timers];
+        double seconds[n_timers];
+        long long counters[n_counters];
+    };
+
+    std::vector<ThreadBlock, AlignedAllocator<ThreadBlock>> blocks;
+    //! the innermost timer outside of the parallel regions, it is only
+    //! changed outside of them
+    int serial_active = -1;
+    FILE *step_file = NULL;
+    Totals previous_step;
+    //! the busy and idle seconds of the threads at the last time step
+    std::vector<double> previous_busy, previous_idle;
+
+    const char *timer_names[n_timers] = {
+        "AdvanceIt", "MakeDeltaQI", "reconstruction",
+        "solveEigenvaluesWmunu", "causality_constraints", "freeze_out",
+        "output", "Cooper_Frye"};
+
+    const char *counter_names[n_counters] = {
+        "reconst_failures", "quest_revert_shear", "quest_revert_bulk",
+        "quest_revert_diffusion", "causality_n1", "causality_n3",
+        "causality_n5", "causality_n6", "causality_s1", "causality_s2",
+        "causality_s6", "causality_suff5", "causality_suff7",
+        "causality_suff8", "root_finder_failures", "causality_cells",
+        "causality_prescreened"};
+
+    Totals get_totals() {
+        Totals totals = {};
+        for (const auto &block : blocks) {
+            for (int i = 0; i < n_timers; i++) {
+                for (int p = 0; p <= n_timers; p++) {
+                    totals.calls[i]   += block.calls[i][p];
+                    totals.seconds[i] += block.seconds[i][p];
+                }
+            }
+            for (int i = 0; i < n_counters; i++) {
+                totals.counters[i] += block.counters[i];
+            }
+        }
+        return(totals);
+    }
+
+    //! prints the timers running inside parent, and the timers inside them
+    void print_timers(pretty_ostream &music_message, const int parent,
+                      const double parent_seconds, const int depth) {
+        for (int i = 0; i < n_timers; i++) {
+            long long calls = 0;
+            double seconds = 0.;
+            int n_threads = 0;
+            for (const auto &block : blocks) {
+                calls   += block.calls[i][parent + 1];
+                seconds += block.seconds[i][parent + 1];
+                if (block.calls[i][parent + 1] > 0) n_threads++;
+            }
+            if (calls == 0) continue;
+            const double seconds_per_thread = seconds/n_threads;
+            std::ostringstream row;
+            row << std::string(2*depth, ' ') << std::left
+                << std::setw(30 - 2*depth) << timer_names[i] << std::right
+                << std::setw(12) << calls
+                << std::setw(12) << std::fixed << std::setprecision(3)
+                << seconds << std::setw(9) << n_threads
+                << std::setw(16) << seconds_per_thread;
+            if (parent_seconds > 0.) {
+                row << std::setw(10) << std::setprecision(1)
+                    << 100.*seconds_per_thread/parent_seconds << "%";
+            }
+            music_message << row.str();
+            music_message.flush("info");
+            print_timers(music_message, i, seconds_per_thread, depth + 1);
+        }
+    }
+}
+
+
+int Instrumentation::level_ = 0;
+
+
+void Instrumentation::initialize(const InitData &DATA) {
+    level_ = DATA.instrumentation;
+    blocks.assign(level_ > 0 ? std::max(1, omp_get_max_threads()) : 0,
+                  ThreadBlock());
+    for (auto &block : blocks) block.active = -1;
+    serial_active = -1;
+    previous_step = Totals();
+    previous_busy.assign(blocks.size(), 0.);
+    previous_idle.assign(blocks.size(), 0.);
+    if (step_file != NULL) {
+        fclose(step_file);
+        step_file = NULL;
+    }
+    if (level_ < 2) return;
+
+    // a restarted run appends to the file, which the checkpoint cuts back
+    // to its size at the checkpoint
+    const bool restart = (DATA.restart_from_checkpoint == 1);
+    step_file = fopen(DATA.instrumentation_filename.c_str(),
+                      restart ? "a" : "w");
+    if (step_file == NULL) {
+        pretty_ostream music_message;
+        music_message << "Instrumentation: can not open file "
+                      << DATA.instrumentation_filename;
+        music_message.flush("error");
+        exit(1);
+    }
+}
+
+
+void Instrumentation::add_count(const int counter, const long long n) {
+    blocks[omp_get_thread_num()].counters[counter] += n;
+}
+
+
+void Instrumentation::add_thread_seconds(const double busy_seconds,
+                                         const double idle_seconds) {
+    ThreadBlock &block = blocks[omp_get_thread_num()];
+    block.busy_seconds += busy_seconds;
+    block.idle_seconds += idle_seconds;
+}
+
+
+void Instrumentation::add_causality_violations(const uint16_t violated) {
+    static_assert(CausalityCondition::suff8 == 1 << 9,
+                  "one counter per CausalityCondition bit");
+    long long *counters = blocks[omp_get_thread_num()].counters;
+    const int n_conditions = (InstrumentedCounter::causality_suff8
+                              - InstrumentedCounter::causality_n1 + 1);
+    for (int i = 0; i < n_conditions; i++) {
+        if (violated & (1 << i)) {
+            counters[InstrumentedCounter::causality_n1 + i]++;
+        }
+    }
+}
+
+
+void Instrumentation::end_time_step(const int it, const double tau) {
+    if (step_file == NULL) return;
+    const Totals totals = get_totals();
+    fprintf(step_file, "{\"it\": %d, \"tau\": %.6g, \"timers\": {", it, tau);
+    for (int i = 0; i < n_timers; i++) {
+        fprintf(step_file, "%s\"%s\": {\"calls\": %lld, \"seconds\": %.6g}",
+                i > 0 ? ", " : "", timer_names[i],
+                totals.calls[i] - previous_step.calls[i],
+                totals.seconds[i] - previous_step.seconds[i]);
+    }
+    fprintf(step_file, "}, \"counters\": {");
+    for (int i = 0; i < n_counters; i++) {
+        fprintf(step_file, "%s\"%s\": %lld", i > 0 ? ", " : "",
+                counter_names[i],
+                totals.counters[i] - previous_step.counters[i]);
+    }
+    fprintf(step_file, "}");
+    // the thread times only appear with the scheduled sweeps
+    bool has_thread_times = false;
+    for (const auto &block : blocks) {
+        if (block.busy_seconds > 0.) has_thread_times = true;
+    }
+    if (has_thread_times) {
+        for (const bool busy : {true, false}) {
+            fprintf(step_file, ", \"thread_%s_seconds\": [",
+                    busy ? "busy" : "idle");
+            for (unsigned int i = 0; i < blocks.size(); i++) {
+                const double seconds = (
+                    busy ? blocks[i].busy_seconds - previous_busy[i]
+                         : blocks[i].idle_seconds - previous_idle[i]);
+                fprintf(step_file, "%s%.6g", i > 0 ? ", " : "", seconds);
+            }
+            fprintf(step_file, "]");
+        }
+    }
+    fprintf(step_file, "}\n");
+    // the checkpoints record the size of the file
+    fflush(step_file);
+    previous_step = totals;
+    for (unsigned int i = 0; i < blocks.size(); i++) {
+        previous_busy[i] = blocks[i].busy_seconds;
+        previous_idle[i] = blocks[i].idle_seconds;
+    }
+}
+
+
+void Instrumentation::print_summary() {
+    if (level_ == 0) return;
+    pretty_ostream music_message;
+    music_message << "Instrumentation: timers and counters of the run";
+    music_message.flush("info");
+    std::ostringstream header;
+    header << std::left << std::setw(30) << "timer" << std::right
+           << std::setw(12) << "calls" << std::setw(12) << "total [s]"
+           << std::setw(9) << "threads" << std::setw(16) << "per thread [s]"
+           << std::setw(11) << "of parent";
+    music_message << header.str();
+    music_message.flush("info");
+    print_timers(music_message, -1, 0., 0);
+
+    const Totals totals = get_totals();
+    for (int i = 0; i < n_counters; i++) {
+        std::ostringstream row;
+        row << std::left << std::setw(30) << counter_names[i]
+            << std::right << std::setw(12) << totals.counters[i];
+        music_message << row.str();
+        music_message.flush("info");
+    }
+    for (unsigned int i = 0; i < blocks.size(); i++) {
+        const double busy = blocks[i].busy_seconds;
+        const double idle = blocks[i].idle_seconds;
+        if (busy + idle <= 0.) continue;
+        std::ostringstream row;
+        row << std::left << std::setw(30) << ("thread " + std::to_string(i))
+            << std::right << std::fixed << std::setprecision(3)
+            << std::setw(12) << busy << " s busy"
+            << std::setw(12) << idle << " s idle"
+            << std::setw(9) << std::setprecision(1)
+            << 100.*idle/(busy + idle) << "% idle";
+        music_message << row.str();
+        music_message.flush("info");
+    }
+    const long long n_causality = (
+                totals.counters[InstrumentedCounter::causality_cells]);
+    if (n_causality > 0) {
+        music_message << "Causality prescreen: skipped "
+                      << (100.*totals.counters[
+                              InstrumentedCounter::causality_prescreened]
+                          /n_causality)
+                      << "% of the cells";
+        music_message.flush("info");
+    }
+}
+
+
+long long Instrumentation::get_calls(const int timer) {
+    return(get_totals().calls[timer]);
+}
+
+
+double Instrumentation::get_seconds(const int timer) {
+    return(get_totals().seconds[timer]);
+}
+
+
+long long Instrumentation::get_count(const int counter) {
+    return(get_totals().counters[counter]);
+}
+
+
+double Instrumentation::get_thread_busy_seconds(const int thread) {
+    return(blocks[thread].busy_seconds);
+}
+
+
+double Instrumentation::get_thread_idle_seconds(const int thread) {
+    return(blocks[thread].idle_seconds);
+}
+
+
+const char *Instrumentation::get_timer_name(const int timer) {
+    return(timer_names[timer]);
+}
+
+
+const char *Instrumentation::get_counter_name(const int counter) {
+    return(counter_names[counter]);
+}
+
+
+void ScopedTimer::start() {
+    running_ = true;
+    thread_ = omp_get_thread_num();
+    in_parallel_ = omp_in_parallel();
+    if (in_parallel_) {
+        previous_ = blocks[thread_].active;
+        parent_ = (previous_ >= 0 ? previous_ : serial_active);
+        blocks[thread_].active = timer_;
+    } else {
+        previous_ = serial_active;
+        parent_ = serial_active;
+        serial_active = timer_;
+    }
+    start_time_ = std::chrono::steady_clock::now();
+}
+
+
+void ScopedTimer::stop() {
+    const std::chrono::duration<double> elapsed = (
+                        std::chrono::steady_clock::now() - start_time_);
+    ThreadBlock &block = blocks[thread_];
+    block.calls[timer_][parent_ + 1]++;
+    block.seconds[timer_][parent_ + 1] += elapsed.count();
+    if (in_parallel_) {
+        block.active = previous_;
+    } else {
+        serial_active = previous_;
+    }
+}
@@ -0,0 +1,145 @@
+#ifndef SRC_INSTRUMENTATION_H_
+#define SRC_INSTRUMENTATION_H_
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "data.h"
+
+//! the stages of the run timed by ScopedTimer
+namespace InstrumentedTimer {
+    enum : int {
+        advance_it = 0,
+        make_delta_qi,
+        reconstruction,
+        eigenvalues,
+        causality,
+        freeze_out,
+        output,
+        cooper_frye,
+        n_timers
+    };
+}
+
+//! the events counted by Instrumentation::count. The causality counters
+//! are in the order of the CausalityCondition bits.
+namespace InstrumentedCounter {
+    enum : int {
+        reconst_failures = 0,
+        quest_revert_shear,
+        quest_revert_bulk,
+        quest_revert_diffusion,
+        causality_n1,
+        causality_n3,
+        causality_n5,
+        causality_n6,
+        causality_s1,
+        causality_s2,
+        causality_s6,
+        causality_suff5,
+        causality_suff7,
+        causality_suff8,
+        root_finder_failures,
+        //! the cells of the causality limiter, and the ones of them
+        //! skipped by the prescreen
+        causality_cells,
+        causality_prescreened,
+        n_counters
+    };
+}
+
+//! This class collects the timers and the event counters of a run. It is
+//! switched on by the parameter instrumentation: every thread adds to its
+//! own block of counters, and the blocks are summed up at the end of a
+//! time step (per step JSON lines for instrumentation = 2) and at the end
+//! of the run (the summary table). When it is switched off, a timer or a
+//! count costs one test of a static flag.
+//!
+//! The sweeps scheduled by TileScheduler also give the time every thread
+//! was busy in the tiles and idle waiting for the others at the end.
+//!
+//! The timers are hierarchical: the time of a timer is booked under the
+//! timer running around it, on the same thread or, inside a parallel
+//! region, on the thread which started it. The times of the timers in
+//! the parallel regions are summed over the threads.
+class Instrumentation {
+ public:
+    //! switches the instrumentation on or off for a run and clears the
+    //! timers and counters
+    static void initialize(const InitData &DATA);
+
+    static bool is_enabled() {return(level_ > 0);}
+
+    static void count(const int counter, const long long n = 1) {
+        if (level_ > 0) add_count(counter, n);
+    }
+
+    //! adds the busy and idle seconds of the calling thread in a
+    //! scheduled sweep (see TileScheduler)
+    static void add_thread_time(const double busy_seconds,
+                                const double idle_seconds) {
+        if (level_ > 0) add_thread_seconds(busy_seconds, idle_seconds);
+    }
+    //! counts the conditions of a CausalityCondition bit mask
+    static void count_causality_violations(const uint16_t violated) {
+        if (level_ > 0 && violated != 0) add_causality_violations(violated);
+    }
+
+    //! writes the timers and counters of the time step as one JSON line
+    //! (instrumentation = 2, must be called outside of parallel regions)
+    static void end_time_step(const int it, const double tau);
+
+    //! prints the timers and counters of the run
+    static void print_summary();
+
+    //! the totals over the threads and the parents of the timers
+    static long long get_calls(const int timer);
+    static double get_seconds(const int timer);
+    static long long get_count(const int counter);
+    //! the busy and idle seconds of a thread in the scheduled sweeps
+    static double get_thread_busy_seconds(const int thread);
+    static double get_thread_idle_seconds(const int thread);
+
+    //! the name of a timer or a counter in the summary and the JSON lines
+    static const char *get_timer_name(const int timer);
+    static const char *get_counter_name(const int counter);
+
+ private:
+    friend class ScopedTimer;
+    static int level_;
+
+    static void add_count(const int counter, const long long n);
+    static void add_thread_seconds(const double busy_seconds,
+                                   const double idle_seconds);
+    static void add_causality_violations(const uint16_t violated);
+};
+
+
+//! This class times its scope with the timer of InstrumentedTimer
+class ScopedTimer {
+ public:
+    explicit ScopedTimer(const int timer) : timer_(timer) {
+        if (Instrumentation::level_ > 0) start();
+    }
+    ~ScopedTimer() {
+        if (running_) stop();
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+ private:
+    const int timer_;
+    bool running_ = false;
+    bool in_parallel_ = false;
+    int thread_ = 0;
+    int parent_ = -1;
+    int previous_ = -1;
+    std::chrono::steady_clock::time_point start_time_;
+
+    void start();
+    void stop();
+};
+
+#endif  // SRC_INSTRUMENTATION_H_
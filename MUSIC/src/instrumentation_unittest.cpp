@@ -0,0 +1,53 @@
+#include "doctest.h"
+#include "instrumentation.h"
+#include "causality_diagnostics.h"
+
+namespace {
+    InitData make_test_data(const int level) {
+        InitData DATA;
+        DATA.instrumentation = level;
+        DATA.instrumentation_filename = "instrumentation_unittest.jsonl";
+        DATA.restart_from_checkpoint = 0;
+        return(DATA);
+    }
+}
+
+TEST_CASE("Check Instrumentation records nothing when it is off") {
+    Instrumentation::initialize(make_test_data(0));
+    CHECK(!Instrumentation::is_enabled());
+    {
+        ScopedTimer timer(InstrumentedTimer::advance_it);
+        Instrumentation::count(InstrumentedCounter::reconst_failures);
+    }
+    CHECK(Instrumentation::get_calls(InstrumentedTimer::advance_it) == 0);
+    CHECK(Instrumentation::get_count(InstrumentedCounter::reconst_failures)
+          == 0);
+}
+
+TEST_CASE("Check Instrumentation counts the timers and the events") {
+    Instrumentation::initialize(make_test_data(1));
+    REQUIRE(Instrumentation::is_enabled());
+    for (int i = 0; i < 3; i++) {
+        ScopedTimer timer(InstrumentedTimer::advance_it);
+        ScopedTimer inner_timer(InstrumentedTimer::make_delta_qi);
+        Instrumentation::count(InstrumentedCounter::quest_revert_bulk, 2);
+    }
+    CHECK(Instrumentation::get_calls(InstrumentedTimer::advance_it) == 3);
+    CHECK(Instrumentation::get_calls(InstrumentedTimer::make_delta_qi) == 3);
+    CHECK(Instrumentation::get_seconds(InstrumentedTimer::advance_it)
+          >= Instrumentation::get_seconds(InstrumentedTimer::make_delta_qi));
+    CHECK(Instrumentation::get_count(InstrumentedCounter::quest_revert_bulk)
+          == 6);
+
+    Instrumentation::count_causality_violations(
+                CausalityCondition::n3 | CausalityCondition::suff8);
+    CHECK(Instrumentation::get_count(InstrumentedCounter::causality_n1) == 0);
+    CHECK(Instrumentation::get_count(InstrumentedCounter::causality_n3) == 1);
+    CHECK(Instrumentation::get_count(InstrumentedCounter::causality_suff8)
+          == 1);
+
+    // a new run starts from zero
+    Instrumentation::initialize(make_test_data(1));
+    CHECK(Instrumentation::get_calls(InstrumentedTimer::advance_it) == 0);
+    Instrumentation::initialize(make_test_data(0));
+}
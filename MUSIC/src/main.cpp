@@ -5,11 +5,21 @@
 #include <string>
 #include <sys/stat.h>
 
+#ifdef MUSIC_MPI
+    #include <mpi.h>
+#endif
+
 #include "music.h"
+#include "music_ensemble.h"
 #include "music_logo.h"
 
 // main program
 int main(int argc, char *argv[]) {
+#ifdef MUSIC_MPI
+    // only the main thread calls MPI
+    int mpi_thread_support;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &mpi_thread_support);
+#endif
     std::string input_file;
     InitData DATA __attribute__ ((aligned (64)));
 
@@ -19,26 +29,19 @@ int main(int argc, char *argv[]) {
         input_file = "";
 
     MUSIC_LOGO::welcome_message();
-    MUSIC music_hydro(input_file);
-    int running_mode = music_hydro.get_running_mode();
-
-    if (running_mode == 1 || running_mode == 2) {
-        music_hydro.initialize_hydro();
-        music_hydro.run_hydro();
-    }
-
-    if (running_mode == 1 || running_mode == 3 || running_mode == 4
-            || running_mode == 13 || running_mode == 14) {
-        music_hydro.run_Cooper_Frye();
-    }
-
-    if (running_mode == 71) {
-        music_hydro.check_eos();
-    }
-    if (running_mode == 73) {
-        music_hydro.output_transport_coefficients();
+    const ParameterRegistry parameters(input_file);
+    int status = 0;
+    if (parameters.contains("ensemble_event_list")) {
+        MUSICEnsemble ensemble(parameters);
+        status = (ensemble.run() > 0 ? 1 : 0);
+    } else {
+        MUSIC music_hydro(parameters);
+        music_hydro.run();
     }
 
-    return(0);
+#ifdef MUSIC_MPI
+    MPI_Finalize();
+#endif
+    return(status);
 }  /* main */
 
@@ -0,0 +1,298 @@
+#include <sys/resource.h>
+#include <algorithm>
+#include <atomic>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include "cell.h"
+#include "hydro_history_spill.h"
+#include "memory_accounting.h"
+#include "pretty_ostream.h"
+
+namespace {
+    using MemorySubsystem::n_subsystems;
+
+    //! zero-initialized before any allocation of the static objects
+    std::atomic<int64_t> current_bytes[n_subsystems];
+    std::atomic<int64_t> peak_bytes[n_subsystems];
+    std::atomic<int64_t> total_current_bytes(0);
+    std::atomic<int64_t> total_peak_bytes(0);
+
+    const char *subsystem_names[n_subsystems] = {
+        "hydro_grids", "freeze_out", "hydro_history", "evolution_output",
+        "cooper_frye", "eos_tables", "other"};
+
+    //! the grids of the evolution in units of a grid of cells: the three
+    //! time levels of the arenas, and the work grids of Advance (the copy
+    //! of the sweeps, the thermodynamic and the source grids)
+    const int kNumberOfHydroGrids = 5;
+
+    void update_peak(std::atomic<int64_t> &peak, const int64_t value) {
+        int64_t previous = peak.load(std::memory_order_relaxed);
+        while (value > previous
+               && !peak.compare_exchange_weak(previous, value,
+                                              std::memory_order_relaxed)) {
+        }
+    }
+
+    double to_MB(const int64_t bytes) {
+        return(bytes/(1024.*1024.));
+    }
+
+    //! the rows of the breakdown of bytes by subsystem
+    void print_breakdown(pretty_ostream &music_message,
+                         const int64_t bytes[n_subsystems],
+                         const std::string &level) {
+        for (int i = 0; i < n_subsystems; i++) {
+            std::ostringstream row;
+            row << std::left << std::setw(30) << subsystem_names[i]
+                << std::right << std::fixed << std::setprecision(1)
+                << std::setw(12) << to_MB(bytes[i]) << " MB";
+            music_message << row.str();
+            music_message.flush(level);
+        }
+    }
+
+    //! the output steps of the history of HydroinfoMUSIC
+    int64_t get_number_of_history_slices(const InitData &DATA) {
+        return(DATA.nt/std::max(1, DATA.output_evolution_every_N_timesteps)
+               + 1);
+    }
+
+    //! the slices of the history in memory with the spill: the resident
+    //! ones, the cache and the ones waiting for the writer
+    int64_t get_number_of_spill_slices(const InitData &DATA) {
+        return(DATA.store_hydro_info_memory_slices
+               + DATA.store_hydro_info_cache_slices
+               + HydroHistorySpill::kMaxPendingSlices);
+    }
+
+    int64_t get_sum(const int64_t bytes[n_subsystems]) {
+        int64_t sum = 0;
+        for (int i = 0; i < n_subsystems; i++) sum += bytes[i];
+        return(sum);
+    }
+}
+
+thread_local int MemoryAccounting::grid_subsystem_ = (
+                                            MemorySubsystem::hydro_grids);
+
+
+void MemoryAccounting::allocate(const int subsystem, const int64_t bytes) {
+    const int64_t current = (
+        current_bytes[subsystem].fetch_add(bytes, std::memory_order_relaxed)
+        + bytes);
+    const int64_t total = (
+        total_current_bytes.fetch_add(bytes, std::memory_order_relaxed)
+        + bytes);
+    if (bytes > 0) {
+        update_peak(peak_bytes[subsystem], current);
+        update_peak(total_peak_bytes, total);
+    }
+}
+
+
+int MemoryAccounting::get_grid_subsystem() {
+    return(grid_subsystem_);
+}
+
+
+int64_t MemoryAccounting::get_current(const int subsystem) {
+    return(current_bytes[subsystem].load());
+}
+
+
+int64_t MemoryAccounting::get_peak(const int subsystem) {
+    return(peak_bytes[subsystem].load());
+}
+
+
+int64_t MemoryAccounting::get_total_current() {
+    return(total_current_bytes.load());
+}
+
+
+int64_t MemoryAccounting::get_total_peak() {
+    return(total_peak_bytes.load());
+}
+
+
+const char *MemoryAccounting::get_subsystem_name(const int subsystem) {
+    return(subsystem_names[subsystem]);
+}
+
+
+void MemoryAccounting::estimate_footprint(const InitData &DATA,
+                                          int64_t bytes[n_subsystems]) {
+    using namespace MemorySubsystem;
+    std::fill(bytes, bytes + n_subsystems, 0);
+    const int64_t grid_bytes = (static_cast<int64_t>(DATA.nx)*DATA.ny
+                                *DATA.neta*sizeof(Cell_small));
+    const bool runs_hydro = (DATA.mode == 1 || DATA.mode == 2
+                             || DATA.mode == 9);
+    if (runs_hydro) {
+        bytes[hydro_grids] = kNumberOfHydroGrids*grid_bytes;
+        if (DATA.u_derivative_rows == 1 && DATA.viscosity_flag == 1) {
+            // the velocity gradients of a stage
+            bytes[hydro_grids] += (static_cast<int64_t>(DATA.nx)*DATA.ny
+                                   *DATA.neta*sizeof(Cell_gradients));
+        }
+        // the lower time level of the freeze-out, and the step the
+        // pipeline is finding
+        const bool pipelined = (DATA.doFreezeOut == 1
+                                && DATA.freeze_out_pipeline > 0);
+        bytes[freeze_out] = (pipelined ? 2 : 1)*grid_bytes;
+
+        // the output points of an evolution output step
+        const int64_t nx_out = ((DATA.nx - 1)
+                                /DATA.output_evolution_every_N_x + 1);
+        const int64_t ny_out = ((DATA.ny - 1)
+                                /DATA.output_evolution_every_N_y + 1);
+        const int64_t neta_out = ((DATA.neta - 1)
+                                  /DATA.output_evolution_every_N_eta + 1);
+        const int64_t n_points = nx_out*ny_out*neta_out;
+        if (DATA.outputEvolutionData > 0) {
+            bytes[evolution_output] += (
+                std::max(1, DATA.output_evolution_buffers)
+                *n_points*sizeof(Cell_small));
+        }
+        bytes[evolution_output] += DATA.debug_snapshot_ring*grid_bytes;
+
+        if (DATA.store_hydro_info_in_memory == 1) {
+            int64_t n_tau = get_number_of_history_slices(DATA);
+            if (DATA.store_hydro_info_memory_slices > 0) {
+                n_tau = std::min(n_tau, get_number_of_spill_slices(DATA));
+            }
+            if (DATA.store_hydro_info_T_cut > 0.) {
+                // the rows above the cut are not known in advance, only
+                // their spans are reserved
+                bytes[hydro_history] = (n_tau*ny_out*neta_out
+                                        *2*sizeof(int64_t));
+            } else {
+                bytes[hydro_history] = 7*n_tau*n_points*sizeof(float);
+            }
+        }
+    }
+    if (DATA.mode == 1 || DATA.mode == 3 || DATA.mode == 4
+            || DATA.mode == 13 || DATA.mode == 14) {
+        bytes[cooper_frye] = (static_cast<int64_t>(
+                                    DATA.NumberOfParticlesToInclude + 2)
+                              *(DATA.pseudo_steps + 1)*(DATA.pt_steps + 1)
+                              *DATA.phi_steps*sizeof(double));
+    }
+    bytes[eos_tables] = get_current(eos_tables);
+}
+
+
+void MemoryAccounting::apply_budget(InitData &DATA) {
+    if (DATA.memory_budget_MB <= 0.) return;
+    using namespace MemorySubsystem;
+    pretty_ostream music_message;
+    const int64_t budget = static_cast<int64_t>(
+                                    DATA.memory_budget_MB*1024.*1024.);
+    int64_t bytes[n_subsystems];
+    estimate_footprint(DATA, bytes);
+    auto report_option = [&](const std::string &option) {
+        music_message << "Memory budget: " << option
+                      << ", the estimate is now "
+                      << to_MB(get_sum(bytes)) << " MB";
+        music_message.flush("info");
+    };
+
+    if (get_sum(bytes) > budget && DATA.output_evolution_buffers > 0) {
+        DATA.output_evolution_buffers = 0;
+        estimate_footprint(DATA, bytes);
+        report_option("the evolution outputs are written synchronously");
+    }
+    if (get_sum(bytes) > budget && DATA.debug_snapshot_ring > 0) {
+        const int64_t grid_bytes = (static_cast<int64_t>(DATA.nx)*DATA.ny
+                                    *DATA.neta*sizeof(Cell_small));
+        const int64_t n_excess = (
+            (get_sum(bytes) - budget + grid_bytes - 1)/grid_bytes);
+        DATA.debug_snapshot_ring = static_cast<int>(
+            std::max<int64_t>(0, DATA.debug_snapshot_ring - n_excess));
+        estimate_footprint(DATA, bytes);
+        report_option("debug_snapshot_ring = "
+                      + std::to_string(DATA.debug_snapshot_ring));
+    }
+    if (get_sum(bytes) > budget && DATA.freeze_out_pipeline > 0) {
+        DATA.freeze_out_pipeline = 0;
+        estimate_footprint(DATA, bytes);
+        report_option("the freeze-out pipeline is switched off");
+    }
+    if (get_sum(bytes) > budget && DATA.freeze_surface_single_file == 1
+            && DATA.cooper_frye_streaming == 0) {
+        // the surface is not in the estimate, its size is not known
+        DATA.freeze_surface_single_file = 0;
+        report_option("the surface is written per thread instead of "
+                      "being kept in memory");
+    }
+    if (get_sum(bytes) > budget && DATA.store_hydro_info_in_memory == 1
+            && DATA.store_hydro_info_memory_slices == 0
+            && DATA.store_hydro_info_T_cut <= 0.) {
+        // keep as many slices of the history in memory as fit, at least
+        // the two of an interpolation
+        const int64_t n_tau = get_number_of_history_slices(DATA);
+        const int64_t slice_bytes = bytes[hydro_history]/n_tau;
+        const int64_t n_available = (
+            (budget - get_sum(bytes) + bytes[hydro_history])/slice_bytes);
+        const int64_t n_slices = std::max<int64_t>(
+            2, n_available - DATA.store_hydro_info_cache_slices
+               - HydroHistorySpill::kMaxPendingSlices);
+        if (n_slices < n_tau) {
+            DATA.store_hydro_info_memory_slices = static_cast<int>(n_slices);
+            estimate_footprint(DATA, bytes);
+            report_option("store_hydro_info_memory_slices = "
+                          + std::to_string(n_slices));
+        }
+    }
+
+    if (get_sum(bytes) > budget) {
+        music_message << "Memory budget: the estimate of "
+                      << to_MB(get_sum(bytes)) << " MB exceeds the budget of "
+                      << DATA.memory_budget_MB << " MB:";
+        music_message.flush("warning");
+        print_breakdown(music_message, bytes, "warning");
+#ifndef MUSIC_FLOAT_DISSIPATIVE
+        music_message << "Memory budget: compiling with "
+                      << "-DMUSIC_FLOAT_DISSIPATIVE stores the dissipative "
+                      << "fields of the grids in float";
+        music_message.flush("warning");
+#endif
+    } else {
+        music_message << "Memory budget: the estimate of "
+                      << to_MB(get_sum(bytes)) << " MB fits into "
+                      << DATA.memory_budget_MB << " MB";
+        music_message.flush("info");
+    }
+}
+
+
+void MemoryAccounting::print_report() {
+    pretty_ostream music_message;
+    music_message << "Memory: current and peak bytes by subsystem";
+    music_message.flush("info");
+    std::ostringstream header;
+    header << std::left << std::setw(30) << "subsystem" << std::right
+           << std::setw(15) << "current [MB]" << std::setw(15) << "peak [MB]";
+    music_message << header.str();
+    music_message.flush("info");
+    for (int i = 0; i < n_subsystems; i++) {
+        std::ostringstream row;
+        row << std::left << std::setw(30) << subsystem_names[i]
+            << std::right << std::fixed << std::setprecision(1)
+            << std::setw(15) << to_MB(get_current(i))
+            << std::setw(15) << to_MB(get_peak(i));
+        music_message << row.str();
+        music_message.flush("info");
+    }
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    std::ostringstream total;
+    total << std::fixed << std::setprecision(1)
+          << "Memory: peak of the booked bytes " << to_MB(get_total_peak())
+          << " MB, peak resident size of the process "
+          << usage.ru_maxrss/1024. << " MB";
+    music_message << total.str();
+    music_message.flush("info");
+}
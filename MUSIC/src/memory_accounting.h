@@ -0,0 +1,145 @@
+#ifndef SRC_MEMORY_ACCOUNTING_H_
+#define SRC_MEMORY_ACCOUNTING_H_
+
+#include <cstddef>
+#include <cstdint>
+#include "data.h"
+
+//! the subsystems whose memory is booked by MemoryAccounting
+namespace MemorySubsystem {
+    enum : int {
+        hydro_grids = 0,    //!< the grids of the evolution
+        freeze_out,         //!< the freeze-out steps and the surface
+        hydro_history,      //!< the evolution history of HydroinfoMUSIC
+        evolution_output,   //!< the output buffers and the snapshot ring
+        cooper_frye,        //!< the surface cells and the spectra
+        eos_tables,         //!< the tables of the EOS and of Freeze
+        other,
+        n_subsystems
+    };
+}
+
+//! This class books the major allocations of a run by subsystem: the
+//! allocators of the grids (GridMemory, AlignedAllocator) and of the
+//! tables (Util::mtx_malloc) book every allocation, the containers which
+//! grow (the history, the surfaces, the spectra, the output buffers) book
+//! their capacity with a MemoryRegistration. The current and the peak
+//! bytes of every subsystem, and the peak of their sum, are kept with
+//! atomics, so the bookings may come from any thread.
+//!
+//! With the parameter memory_budget_MB > 0, apply_budget() estimates the
+//! footprint of the run from the parameters before the grids are
+//! allocated, and switches off the optional copies which do not change
+//! the results until the estimate fits.
+class MemoryAccounting {
+ public:
+    //! books bytes allocated or released by the subsystem
+    static void allocate(const int subsystem, const int64_t bytes);
+    static void release(const int subsystem, const int64_t bytes) {
+        allocate(subsystem, -bytes);
+    }
+
+    //! the subsystem of the grids allocated by the calling thread (see
+    //! MemoryScope), hydro_grids by default
+    static int get_grid_subsystem();
+
+    static int64_t get_current(const int subsystem);
+    static int64_t get_peak(const int subsystem);
+    static int64_t get_total_current();
+    static int64_t get_total_peak();
+    static const char *get_subsystem_name(const int subsystem);
+
+    //! the estimate of the bytes of the subsystems with the parameters
+    //! of DATA; the EOS tables are the ones booked so far
+    static void estimate_footprint(
+        const InitData &DATA, int64_t bytes[MemorySubsystem::n_subsystems]);
+
+    //! fits the estimate of the run into memory_budget_MB: it switches off
+    //!   1. the asynchronous evolution output buffers,
+    //!   2. the snapshots of the debug ring, as many as needed,
+    //!   3. the copy of the freeze-out pipeline,
+    //!   4. the in-memory surface, which is written per thread instead
+    //!      (not with cooper_frye_streaming, which reads it),
+    //!   5. the tau slices of the in-memory history beyond the ones which
+    //!      fit, which are spilled to a scratch file,
+    //! in this order, and warns with the breakdown if it still does not fit
+    static void apply_budget(InitData &DATA);
+
+    //! prints the current and the peak bytes of the subsystems and the
+    //! peak resident size of the process
+    static void print_report();
+
+ private:
+    friend class MemoryScope;
+    static thread_local int grid_subsystem_;
+};
+
+
+//! This class books the allocations of the grids of the calling thread in
+//! its scope under a subsystem (the grids are released from the
+//! subsystem they were allocated by)
+class MemoryScope {
+ public:
+    explicit MemoryScope(const int subsystem)
+        : previous_(MemoryAccounting::grid_subsystem_) {
+        MemoryAccounting::grid_subsystem_ = subsystem;
+    }
+    ~MemoryScope() {MemoryAccounting::grid_subsystem_ = previous_;}
+
+    MemoryScope(const MemoryScope&) = delete;
+    MemoryScope& operator=(const MemoryScope&) = delete;
+
+ private:
+    const int previous_;
+};
+
+
+//! This class books the bytes of a container of its owner, set with
+//! set(), and releases them with the owner. A copy books the same bytes
+//! again, as the copy of the container holds them too; a move takes them
+//! over with the storage of the container.
+class MemoryRegistration {
+ public:
+    explicit MemoryRegistration(const int subsystem)
+        : subsystem_(subsystem), bytes_(0) {}
+    MemoryRegistration(const MemoryRegistration &other)
+        : subsystem_(other.subsystem_), bytes_(0) {
+        set(other.bytes_);
+    }
+    MemoryRegistration& operator=(const MemoryRegistration &other) {
+        if (this != &other) {
+            set(0);
+            subsystem_ = other.subsystem_;
+            set(other.bytes_);
+        }
+        return(*this);
+    }
+    MemoryRegistration(MemoryRegistration &&other) noexcept
+        : subsystem_(other.subsystem_), bytes_(other.bytes_) {
+        other.bytes_ = 0;
+    }
+    MemoryRegistration& operator=(MemoryRegistration &&other) noexcept {
+        if (this != &other) {
+            set(0);
+            subsystem_ = other.subsystem_;
+            bytes_ = other.bytes_;
+            other.bytes_ = 0;
+        }
+        return(*this);
+    }
+    ~MemoryRegistration() {set(0);}
+
+    void set(const int64_t bytes) {
+        if (bytes != bytes_) {
+            MemoryAccounting::allocate(subsystem_, bytes - bytes_);
+            bytes_ = bytes;
+        }
+    }
+    int64_t get() const {return(bytes_);}
+
+ private:
+    int subsystem_;
+    int64_t bytes_;
+};
+
+#endif  // SRC_MEMORY_ACCOUNTING_H_
@@ -0,0 +1,179 @@
+#include <memory>
+#include <vector>
+#include "doctest.h"
+#include "aligned_allocator.h"
+#include "cell.h"
+#include "grid.h"
+#include "memory_accounting.h"
+
+using namespace MemorySubsystem;
+
+namespace {
+    //! the parameters of a 3D run with all the optional copies
+    InitData get_run_parameters() {
+        InitData DATA{};
+        DATA.mode = 2;
+        DATA.nx = 100;
+        DATA.ny = 100;
+        DATA.neta = 10;
+        DATA.nt = 100;
+        DATA.doFreezeOut = 1;
+        DATA.freeze_out_pipeline = 2;
+        DATA.freeze_surface_single_file = 1;
+        DATA.cooper_frye_streaming = 0;
+        DATA.outputEvolutionData = 1;
+        DATA.output_evolution_buffers = 3;
+        DATA.output_evolution_every_N_x = 1;
+        DATA.output_evolution_every_N_y = 1;
+        DATA.output_evolution_every_N_eta = 1;
+        DATA.output_evolution_every_N_timesteps = 10;
+        DATA.debug_snapshot_ring = 4;
+        DATA.store_hydro_info_in_memory = 0;
+        DATA.store_hydro_info_T_cut = 0.;
+        DATA.store_hydro_info_memory_slices = 0;
+        DATA.store_hydro_info_cache_slices = 4;
+        return(DATA);
+    }
+
+    //! the budget [MB] of n_grids grids of the run and the EOS tables
+    double get_budget_MB(const InitData &DATA, const double n_grids) {
+        const double grid_bytes = (1.*DATA.nx*DATA.ny*DATA.neta
+                                   *sizeof(Cell_small));
+        return((n_grids*grid_bytes + MemoryAccounting::get_current(eos_tables))
+               /(1024.*1024.));
+    }
+}
+
+
+TEST_CASE("Check MemoryRegistration books the bytes of its owner") {
+    const int64_t current = MemoryAccounting::get_current(hydro_history);
+    const int64_t total = MemoryAccounting::get_total_current();
+    {
+        MemoryRegistration registration(hydro_history);
+        registration.set(1000);
+        CHECK(MemoryAccounting::get_current(hydro_history) == current + 1000);
+        registration.set(600);
+        CHECK(MemoryAccounting::get_current(hydro_history) == current + 600);
+        CHECK(MemoryAccounting::get_peak(hydro_history) >= current + 1000);
+
+        // a copy books the bytes again, a move takes them over
+        MemoryRegistration copy(registration);
+        CHECK(MemoryAccounting::get_current(hydro_history) == current + 1200);
+        MemoryRegistration moved(std::move(copy));
+        CHECK(copy.get() == 0);
+        CHECK(moved.get() == 600);
+        CHECK(MemoryAccounting::get_current(hydro_history) == current + 1200);
+        CHECK(MemoryAccounting::get_total_current() == total + 1200);
+    }
+    CHECK(MemoryAccounting::get_current(hydro_history) == current);
+    CHECK(MemoryAccounting::get_total_current() == total);
+    CHECK(MemoryAccounting::get_total_peak() >= total + 1200);
+}
+
+
+TEST_CASE("Check the allocators book the grids by subsystem") {
+    const int64_t current_grids = MemoryAccounting::get_current(hydro_grids);
+    const int64_t current_freeze = MemoryAccounting::get_current(freeze_out);
+    const int64_t grid_bytes = 3*4*5*sizeof(Cell_small);
+    SCGrid arena(3, 4, 5);
+    CHECK(MemoryAccounting::get_current(hydro_grids)
+          == current_grids + grid_bytes);
+    {
+        std::unique_ptr<SCGrid> snapshot;
+        {
+            MemoryScope memory_scope(freeze_out);
+            snapshot.reset(new SCGrid(3, 4, 5));
+        }
+        CHECK(MemoryAccounting::get_grid_subsystem() == hydro_grids);
+        CHECK(MemoryAccounting::get_current(freeze_out)
+              == current_freeze + grid_bytes);
+        // the grid is released from the subsystem which allocated it
+        *snapshot = SCGrid(3, 4, 5);
+        CHECK(MemoryAccounting::get_current(freeze_out) == current_freeze);
+        CHECK(MemoryAccounting::get_current(hydro_grids)
+              == current_grids + 2*grid_bytes);
+    }
+    CHECK(MemoryAccounting::get_current(hydro_grids)
+          == current_grids + grid_bytes);
+
+    const int64_t current_eos = MemoryAccounting::get_current(eos_tables);
+    {
+        std::vector<double, AlignedAllocator<double, eos_tables>> table(100);
+        CHECK(MemoryAccounting::get_current(eos_tables)
+              == current_eos + 100*static_cast<int64_t>(sizeof(double)));
+    }
+    CHECK(MemoryAccounting::get_current(eos_tables) == current_eos);
+}
+
+
+TEST_CASE("Check MemoryAccounting fits the run into the budget") {
+    const InitData parameters = get_run_parameters();
+    int64_t bytes[n_subsystems];
+    MemoryAccounting::estimate_footprint(parameters, bytes);
+    const int64_t grid_bytes = 100*100*10*sizeof(Cell_small);
+    CHECK(bytes[hydro_grids] == 5*grid_bytes);
+    CHECK(bytes[freeze_out] == 2*grid_bytes);
+    CHECK(bytes[evolution_output] == 7*grid_bytes);
+    CHECK(bytes[hydro_history] == 0);
+
+    // no budget, or a budget the run fits into
+    InitData DATA = parameters;
+    MemoryAccounting::apply_budget(DATA);
+    DATA.memory_budget_MB = get_budget_MB(DATA, 14.5);
+    MemoryAccounting::apply_budget(DATA);
+    CHECK(DATA.output_evolution_buffers == 3);
+    CHECK(DATA.debug_snapshot_ring == 4);
+    CHECK(DATA.freeze_out_pipeline == 2);
+
+    // the output buffers go first, then the snapshots as many as needed
+    DATA.memory_budget_MB = get_budget_MB(DATA, 9.5);
+    MemoryAccounting::apply_budget(DATA);
+    CHECK(DATA.output_evolution_buffers == 0);
+    CHECK(DATA.debug_snapshot_ring == 1);
+    CHECK(DATA.freeze_out_pipeline == 2);
+    CHECK(DATA.freeze_surface_single_file == 1);
+
+    // everything optional is switched off when the grids do not fit
+    DATA = parameters;
+    DATA.memory_budget_MB = get_budget_MB(DATA, 4.5);
+    MemoryAccounting::apply_budget(DATA);
+    CHECK(DATA.output_evolution_buffers == 0);
+    CHECK(DATA.debug_snapshot_ring == 0);
+    CHECK(DATA.freeze_out_pipeline == 0);
+    CHECK(DATA.freeze_surface_single_file == 0);
+
+    // the streamed Cooper-Frye reads the in-memory surface
+    DATA = parameters;
+    DATA.cooper_frye_streaming = 1;
+    DATA.memory_budget_MB = get_budget_MB(DATA, 4.5);
+    MemoryAccounting::apply_budget(DATA);
+    CHECK(DATA.freeze_surface_single_file == 1);
+}
+
+
+TEST_CASE("Check MemoryAccounting spills the history beyond the budget") {
+    InitData DATA = get_run_parameters();
+    DATA.store_hydro_info_in_memory = 1;
+    DATA.output_evolution_every_N_timesteps = 10;
+    int64_t bytes[n_subsystems];
+    MemoryAccounting::estimate_footprint(DATA, bytes);
+    const int64_t slice_bytes = 7*100*100*10*sizeof(float);
+    CHECK(bytes[hydro_history] == 11*slice_bytes);
+
+    // the grids left after the other options, and 10.5 slices: 4 of them
+    // stay in memory next to the cache and the pending slices
+    const double slice_grids = 1.*slice_bytes/(100*100*10*sizeof(Cell_small));
+    DATA.memory_budget_MB = get_budget_MB(DATA, 7. + 10.5*slice_grids);
+    MemoryAccounting::apply_budget(DATA);
+    CHECK(DATA.freeze_surface_single_file == 0);
+    CHECK(DATA.store_hydro_info_memory_slices == 4);
+    MemoryAccounting::estimate_footprint(DATA, bytes);
+    CHECK(bytes[hydro_history] == 10*slice_bytes);
+
+    // the two slices of an interpolation stay in memory in any case
+    DATA = get_run_parameters();
+    DATA.store_hydro_info_in_memory = 1;
+    DATA.memory_budget_MB = get_budget_MB(DATA, 4.5);
+    MemoryAccounting::apply_budget(DATA);
+    CHECK(DATA.store_hydro_info_memory_slices == 2);
+}
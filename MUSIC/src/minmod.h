@@ -4,6 +4,7 @@
 
 #include "data.h"
 #include "iostream"
+#include "slope_limiter.h"
 class Minmod {
  private:
     const double theta_flux;
@@ -27,16 +28,16 @@ class Minmod {
     /*     } */
     /* }/\* minmod_dx *\/ */
 
+    //! the generalized minmod slope, branch-free and without divisions
+    //! (see SlopeLimiter::Minmod)
     double minmod_dx(const double up1, const double u, const double um1) const {
-        const double diffup   = (up1 - u)*theta_flux;
-        const double diffdown = (u - um1)*theta_flux;
-        const double diffmid  = (up1 - um1)*0.5;
-	if(diffup==0.)
-	  return 0.;
-	else
-	  return diffup*std::max(0., std::min(1.,std::min(diffdown/diffup, diffmid/diffup)));
+        return(get_limiter()(up1, u, um1));
     }/* minmod_dx */
 
+    SlopeLimiter::Minmod get_limiter() const {
+        return(SlopeLimiter::Minmod{theta_flux});
+    }
+
 };
 
 #endif  // SRC_MINMOD_H_
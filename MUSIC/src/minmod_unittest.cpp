@@ -1,3 +1,4 @@
+#include <algorithm>
 #include "doctest.h"
 #include "minmod.h"
 
@@ -20,3 +21,46 @@ TEST_CASE("Does Minmod work") {
     test_dx = test.minmod_dx(0.0, 1.9, 2.0);
     CHECK(test_dx == doctest::Approx(-0.18).epsilon(0.0001));
 }
+
+TEST_CASE("Check the slope limiters") {
+    // the generalized minmod with divisions it replaces
+    const auto minmod_division = [](const double theta, const double up1,
+                                    const double u, const double um1) {
+        const double diffup   = (up1 - u)*theta;
+        const double diffdown = (u - um1)*theta;
+        const double diffmid  = (up1 - um1)*0.5;
+        if (diffup == 0.) return(0.);
+        return(diffup*std::max(0., std::min(1., std::min(diffdown/diffup,
+                                                         diffmid/diffup))));
+    };
+    const double values[] = {-2., -0.7, -0.1, 0., 0.05, 0.3, 1., 2.5};
+    Minmod minmod(1.8);
+    SlopeLimiter::MonotonizedCentral mc;
+    for (const double up1 : values)
+    for (const double u : values)
+    for (const double um1 : values) {
+        CHECK(minmod.minmod_dx(up1, u, um1)
+              == doctest::Approx(minmod_division(1.8, up1, u, um1)));
+        CHECK(mc(up1, u, um1)
+              == doctest::Approx(minmod_division(2., up1, u, um1)));
+    }
+
+    SlopeLimiter::VanLeer van_leer;
+    CHECK(van_leer(3., 2., 0.) == doctest::Approx(2.*1.*2./3.));
+    CHECK(van_leer(-1., 0., 2.) == doctest::Approx(-2.*1.*2./3.));
+    CHECK(van_leer(1., 2., 0.) == 0.);
+    CHECK(van_leer(2., 2., 0.) == 0.);
+    CHECK(van_leer(1., 1., 1.) == 0.);
+
+    // a row at once
+    const double up1[4] = {2., -2., 0., 3.};
+    const double u[4]   = {1., -1., 0.1, 2.};
+    const double um1[4] = {0., 0., 2., 0.};
+    double slope[4];
+    SlopeLimiter::limit_row(minmod.get_limiter(), 4, up1, u, um1, slope);
+    for (int i = 0; i < 4; i++) {
+        CHECK(slope[i] == minmod.minmod_dx(up1[i], u[i], um1[i]));
+    }
+    SlopeLimiter::limit_row(van_leer, 4, up1, u, um1, slope);
+    CHECK(slope[3] == van_leer(3., 2., 0.));
+}
@@ -0,0 +1,138 @@
+#include <algorithm>
+#include <cmath>
+
+#include "util.h"
+#include "movie_reduction.h"
+
+using Util::hbarc;
+
+
+MovieReduction::MovieReduction(const InitData &DATA_in, const EOS &eos_in) :
+        DATA(DATA_in), eos(eos_in),
+        block_size_(DATA_in.output_movie_block_size) {
+    field_names_ = {"e", "T", "ux", "uy"};
+    if (DATA.turn_on_rhob == 1) field_names_.push_back("rhob");
+}
+
+
+int MovieReduction::get_mid_rapidity_index(const int neta) const {
+    const int ieta = static_cast<int>(
+                        std::round(DATA.eta_size/2./DATA.delta_eta));
+    return(std::max(0, std::min(neta - 1, ieta)));
+}
+
+
+void MovieReduction::reduce(const SCGrid &arena, const Reduction reduction,
+                            MovieFrame &frame) const {
+    const int nx = arena.nX();
+    const int ny = arena.nY();
+    frame.nx = (nx + block_size_ - 1)/block_size_;
+    frame.ny = (ny + block_size_ - 1)/block_size_;
+    const int n_fields = static_cast<int>(field_names_.size());
+    frame.fields.resize(n_fields);
+    for (auto &field : frame.fields) field.assign(frame.nx*frame.ny, 0.f);
+
+    int ieta_begin = 0;
+    int ieta_end = arena.nEta();
+    // the projection integrates over eta, the slice is the block average
+    double eta_weight = DATA.delta_eta;
+    if (reduction == kSlice) {
+        ieta_begin = get_mid_rapidity_index(arena.nEta());
+        ieta_end = ieta_begin + 1;
+        eta_weight = 1.;
+    }
+    const bool with_rhob = (DATA.turn_on_rhob == 1);
+
+    #pragma omp parallel for collapse(2) schedule(static)
+    for (int by = 0; by < frame.ny; by++)
+    for (int bx = 0; bx < frame.nx; bx++) {
+        const int ix_end = std::min(nx, (bx + 1)*block_size_);
+        const int iy_end = std::min(ny, (by + 1)*block_size_);
+        double e_sum = 0., rhob_sum = 0.;
+        double eT_sum = 0., eux_sum = 0., euy_sum = 0.;
+        for (int ieta = ieta_begin; ieta < ieta_end; ieta++)
+        for (int iy = by*block_size_; iy < iy_end; iy++)
+        for (int ix = bx*block_size_; ix < ix_end; ix++) {
+            const Cell_small &cell = arena(ix, iy, ieta);
+            const double e_local = cell.epsilon;
+            e_sum    += e_local;
+            rhob_sum += cell.rhob;
+            eT_sum   += e_local*eos.get_temperature(e_local, cell.rhob);
+            eux_sum  += e_local*cell.u[1];
+            euy_sum  += e_local*cell.u[2];
+        }
+        const int n_cells = (ix_end - bx*block_size_)*(iy_end - by*block_size_);
+        const int i_pixel = by*frame.nx + bx;
+        const double weight = eta_weight/n_cells;
+        frame.fields[0][i_pixel] = static_cast<float>(e_sum*weight*hbarc);
+        if (e_sum > 0.) {
+            frame.fields[1][i_pixel] = static_cast<float>(
+                                                    eT_sum/e_sum*hbarc);
+            frame.fields[2][i_pixel] = static_cast<float>(eux_sum/e_sum);
+            frame.fields[3][i_pixel] = static_cast<float>(euy_sum/e_sum);
+        }
+        if (with_rhob) {
+            frame.fields[4][i_pixel] = static_cast<float>(rhob_sum*weight);
+        }
+    }
+}
+
+
+ChunkedEvolutionWriter *MovieReduction::open_file(
+        const SCGrid &arena, const Reduction reduction,
+        const std::string &filename) {
+    ChunkedEvolutionGrid grid;
+    grid.nx      = (arena.nX() + block_size_ - 1)/block_size_;
+    grid.ny      = (arena.nY() + block_size_ - 1)/block_size_;
+    grid.neta    = 1;
+    grid.tau0    = DATA.tau0;
+    grid.dtau    = (DATA.delta_tau_input
+                    *DATA.output_evolution_every_N_timesteps);
+    grid.dx      = DATA.delta_x*block_size_;
+    grid.dy      = DATA.delta_y*block_size_;
+    // the points are at the centers of the full blocks
+    grid.x_min   = - DATA.x_size/2. + 0.5*(block_size_ - 1)*DATA.delta_x;
+    grid.y_min   = - DATA.y_size/2. + 0.5*(block_size_ - 1)*DATA.delta_y;
+    if (reduction == kSlice) {
+        grid.deta    = DATA.delta_eta;
+        grid.eta_min = (- DATA.eta_size/2.
+                        + get_mid_rapidity_index(arena.nEta())
+                          *DATA.delta_eta);
+    } else {
+        grid.deta    = arena.nEta()*DATA.delta_eta;
+        grid.eta_min = 0.;
+    }
+    return(new ChunkedEvolutionWriter(filename, grid, field_names_,
+                                      DATA.output_evolution_codec));
+}
+
+
+void MovieReduction::write_frames(const SCGrid &arena, const double tau) {
+    const int n_fields = static_cast<int>(field_names_.size());
+    if (DATA.output_movie_reductions & kSlice) {
+        if (slice_file_ == nullptr) {
+            slice_file_.reset(open_file(arena, kSlice,
+                                        "evolution_movie_slice.dat"));
+        }
+        reduce(arena, kSlice, frame_);
+        for (int i = 0; i < n_fields; i++) {
+            slice_file_->write_field(tau, i, frame_.fields[i].data());
+        }
+    }
+    if (DATA.output_movie_reductions & kProjection) {
+        if (projection_file_ == nullptr) {
+            projection_file_.reset(open_file(
+                    arena, kProjection, "evolution_movie_projection.dat"));
+        }
+        reduce(arena, kProjection, frame_);
+        for (int i = 0; i < n_fields; i++) {
+            projection_file_->write_field(tau, i, frame_.fields[i].data());
+        }
+    }
+}
+
+
+void MovieReduction::close() {
+    slice_file_.reset();
+    projection_file_.reset();
+}
@@ -0,0 +1,77 @@
+#ifndef SRC_MOVIE_REDUCTION_H_
+#define SRC_MOVIE_REDUCTION_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "data.h"
+#include "eos.h"
+#include "grid.h"
+#include "chunked_evolution_file.h"
+
+//! one 2D frame of the reduced movie on the grid of the blocks,
+//! fields[field][iy*nx + ix]
+struct MovieFrame {
+    int nx = 0;
+    int ny = 0;
+    std::vector<std::vector<float>> fields;
+};
+
+
+//! This class reduces the hydro grid at the output steps to small 2D
+//! frames, computed in parallel during the run, instead of the full 3D
+//! output of output_movie_flag = 1. The reductions are chosen by
+//! output_movie_reductions:
+//!     1: the slice at mid-rapidity, evolution_movie_slice.dat
+//!     2: the projection integrated over eta, evolution_movie_projection.dat
+//! Both average the transverse plane in blocks of output_movie_block_size
+//! cells. The fields of a frame are
+//!     e T ux uy [GeV/fm^3, GeV, 1, 1], and rhob [1/fm^3] with turn_on_rhob
+//! where e and rhob are the block averages (and, in the projection, the
+//! integrals over eta of them) and T, ux, uy are averaged with the weight
+//! e. The frames are written as chunked evolution files with one eta point
+//! (see ChunkedEvolutionWriter).
+class MovieReduction {
+ public:
+    //! the reductions, bits of output_movie_reductions
+    enum Reduction {
+        kSlice = 1,
+        kProjection = 2,
+    };
+
+ private:
+    const InitData &DATA;
+    const EOS &eos;
+    const int block_size_;
+    std::vector<std::string> field_names_;
+    std::unique_ptr<ChunkedEvolutionWriter> slice_file_;
+    std::unique_ptr<ChunkedEvolutionWriter> projection_file_;
+    MovieFrame frame_;
+
+    //! opens the file of the reduction for the grid of arena
+    ChunkedEvolutionWriter *open_file(const SCGrid &arena,
+                                      const Reduction reduction,
+                                      const std::string &filename);
+
+ public:
+    MovieReduction(const InitData &DATA_in, const EOS &eos_in);
+
+    const std::vector<std::string> &get_field_names() const {
+        return(field_names_);
+    }
+
+    //! the eta index of the mid-rapidity slice
+    int get_mid_rapidity_index(const int neta) const;
+
+    //! reduces arena to frame, from all the threads
+    void reduce(const SCGrid &arena, const Reduction reduction,
+                MovieFrame &frame) const;
+
+    //! writes the frames of the chosen reductions of arena at tau
+    void write_frames(const SCGrid &arena, const double tau);
+
+    void close();
+};
+
+#endif  // SRC_MOVIE_REDUCTION_H_
@@ -0,0 +1,121 @@
+#include <cmath>
+#include <cstdio>
+#include "doctest.h"
+#include "eos.h"
+#include "util.h"
+#include "movie_reduction.h"
+
+namespace {
+    InitData make_test_data() {
+        InitData DATA;
+        DATA.turn_on_rhob = 1;
+        DATA.x_size = 5.;
+        DATA.y_size = 4.;
+        DATA.eta_size = 0.8;
+        DATA.delta_x = 0.5;
+        DATA.delta_y = 0.5;
+        DATA.delta_eta = 0.2;
+        DATA.tau0 = 0.4;
+        DATA.delta_tau_input = 0.02;
+        DATA.output_evolution_every_N_timesteps = 5;
+        DATA.output_evolution_codec = 0;
+        DATA.output_movie_block_size = 3;
+        DATA.output_movie_reductions = 3;
+        return(DATA);
+    }
+
+    //! a grid of 10 x 8 x 5 cells with e and rhob linear in x, y and eta
+    SCGrid make_test_grid() {
+        SCGrid arena(10, 8, 5);
+        for (int ieta = 0; ieta < 5; ieta++)
+        for (int iy = 0; iy < 8; iy++)
+        for (int ix = 0; ix < 10; ix++) {
+            Cell_small &cell = arena(ix, iy, ieta);
+            cell.epsilon = 1. + 0.1*ix + 0.2*iy + 0.5*ieta;
+            cell.rhob = 0.01*(ix + iy);
+            cell.u[1] = 0.1;
+            cell.u[2] = -0.05*ieta;
+        }
+        return(arena);
+    }
+}
+
+TEST_CASE("Check MovieReduction slices, projects and averages blocks") {
+    const InitData DATA = make_test_data();
+    EOS eos_ideal(0);
+    MovieReduction reduction(DATA, eos_ideal);
+    const SCGrid arena = make_test_grid();
+    CHECK(reduction.get_field_names().size() == 5);
+    CHECK(reduction.get_mid_rapidity_index(5) == 2);
+    CHECK(reduction.get_mid_rapidity_index(1) == 0);
+
+    MovieFrame slice;
+    reduction.reduce(arena, MovieReduction::kSlice, slice);
+    // the blocks of 3 x 3 cells, the last ones are cut off by the grid
+    REQUIRE(slice.nx == 4);
+    REQUIRE(slice.ny == 3);
+    // the block (1, 0) has ix = 3..5 and iy = 0..2 at ieta = 2
+    const double e_block = 1. + 0.1*4 + 0.2*1 + 0.5*2;
+    CHECK(slice.fields[0][1] == doctest::Approx(e_block*Util::hbarc));
+    // the last block (3, 2) has ix = 9 and iy = 6..7 only
+    CHECK(slice.fields[0][11] == doctest::Approx(
+                (1. + 0.9 + 0.2*6.5 + 1.)*Util::hbarc));
+    CHECK(slice.fields[4][11] == doctest::Approx(0.01*(9 + 6.5)));
+    CHECK(slice.fields[2][5] == doctest::Approx(0.1));
+    CHECK(slice.fields[3][5] == doctest::Approx(-0.1));
+
+    MovieFrame projection;
+    reduction.reduce(arena, MovieReduction::kProjection, projection);
+    REQUIRE(projection.nx == 4);
+    // e integrated over eta: the mid-rapidity value times the eta range
+    CHECK(projection.fields[0][1] == doctest::Approx(
+                                    e_block*5*0.2*Util::hbarc));
+    // u^y averaged with the weight e, so the larger e at large eta count
+    double e_sum = 0., euy_sum = 0.;
+    for (int ieta = 0; ieta < 5; ieta++) {
+        const double e = 1. + 0.1*4 + 0.2*1 + 0.5*ieta;
+        e_sum += e;
+        euy_sum += -0.05*ieta*e;
+    }
+    CHECK(projection.fields[3][1] == doctest::Approx(euy_sum/e_sum));
+    // the temperature of a uniform block is the one of its cells
+    MovieFrame uniform;
+    SCGrid arena_uniform(3, 3, 1);
+    for (int i = 0; i < arena_uniform.size(); i++) {
+        arena_uniform(i).epsilon = 2.;
+    }
+    reduction.reduce(arena_uniform, MovieReduction::kSlice, uniform);
+    REQUIRE(uniform.nx == 1);
+    CHECK(uniform.fields[1][0] == doctest::Approx(
+                    eos_ideal.get_temperature(2., 0.)*Util::hbarc));
+}
+
+TEST_CASE("Check MovieReduction writes the frames as chunked files") {
+    const InitData DATA = make_test_data();
+    EOS eos_ideal(0);
+    const SCGrid arena = make_test_grid();
+    {
+        MovieReduction reduction(DATA, eos_ideal);
+        reduction.write_frames(arena, 0.4);
+        reduction.write_frames(arena, 0.5);
+        reduction.close();
+    }
+    ChunkedEvolutionReader slice("evolution_movie_slice.dat");
+    CHECK(slice.get_grid().nx == 4);
+    CHECK(slice.get_grid().neta == 1);
+    CHECK(slice.get_grid().dx == doctest::Approx(1.5));
+    CHECK(slice.get_grid().x_min == doctest::Approx(-2.));
+    CHECK(slice.get_grid().eta_min == doctest::Approx(0.));
+    CHECK(slice.get_number_of_tau() == 2);
+    CHECK(slice.get_field_index("rhob") == 4);
+    std::vector<float> data;
+    REQUIRE(slice.read_field(1, 0, data));
+    CHECK(data.size() == 12);
+    CHECK(data[1] == doctest::Approx((1. + 0.4 + 0.2 + 1.)*Util::hbarc));
+
+    ChunkedEvolutionReader projection("evolution_movie_projection.dat");
+    CHECK(projection.get_grid().deta == doctest::Approx(1.));
+    CHECK(projection.get_number_of_tau() == 2);
+    remove("evolution_movie_slice.dat");
+    remove("evolution_movie_projection.dat");
+}
@@ -1,5 +1,9 @@
 // Original copyright 2011 @ Bjoern Schenke, Sangyong Jeon, and Charles Gale
 // Massively cleaned up and improved by Chun Shen 2015-2016
+#ifdef _OPENMP
+    #include <omp.h>
+#endif
+
 #include <stdio.h>
 #include <sys/stat.h>
 #include <vector>
@@ -14,17 +18,45 @@
 #include "hydro_source_strings.h"
 #include "hydro_source_ampt.h"
 #include "hydro_source_TATB.h"
+#include "async_log.h"
+#include "instrumentation.h"
+#include "grid_memory.h"
+#include "memory_accounting.h"
+#include "auto_tuner.h"
 
 #ifdef GSL
     #include "freeze.h"
 #endif
 
+#ifndef _OPENMP
+    #define omp_set_num_threads(n)
+#endif
+
 using std::vector;
 
 MUSIC::MUSIC(std::string input_file) :
-    DATA(ReadInParameters::read_in_parameters(input_file)),
-    eos(DATA.whichEOS) {
+    MUSIC(ParameterRegistry(input_file)) {}
+
+
+MUSIC::MUSIC(const ParameterRegistry &parameters) :
+    MUSIC(parameters, nullptr) {}
+
+
+MUSIC::MUSIC(const ParameterRegistry &parameters,
+             std::shared_ptr<const EOS> eos_in) :
+    parameters_(AutoTuner::apply_profile(parameters)),
+    DATA(ReadInParameters::read_in_parameters(parameters_)),
+    eos_ptr_(eos_in != nullptr ? eos_in
+                               : std::make_shared<const EOS>(DATA.whichEOS)),
+    eos(*eos_ptr_) {
 
+    if (DATA.omp_num_threads > 0) omp_set_num_threads(DATA.omp_num_threads);
+    AsyncLog::initialize(DATA);
+    Instrumentation::initialize(DATA);
+    GridMemory::initialize(DATA);
+    // the options are fitted into the budget before the grids exist, the
+    // EOS tables are already booked
+    MemoryAccounting::apply_budget(DATA);
     mode                   = DATA.mode;
     flag_hydro_run         = 0;
     flag_hydro_initialized = 0;
@@ -42,6 +74,34 @@ MUSIC::MUSIC(std::string input_file) :
 
 
 MUSIC::~MUSIC() {
+    Instrumentation::print_summary();
+    if (DATA.instrumentation > 0 || DATA.memory_budget_MB > 0.) {
+        MemoryAccounting::print_report();
+    }
+}
+
+
+void MUSIC::run() {
+    if (mode == 1 || mode == 2) {
+        initialize_hydro();
+        run_hydro();
+    }
+
+    if (mode == 1 || mode == 3 || mode == 4 || mode == 13 || mode == 14) {
+        run_Cooper_Frye();
+    }
+
+    if (mode == 9) {
+        initialize_hydro();
+        tune_runtime_knobs();
+    }
+
+    if (mode == 71) {
+        check_eos();
+    }
+    if (mode == 73) {
+        output_transport_coefficients();
+    }
 }
 
 
@@ -79,7 +139,13 @@ void MUSIC::clean_all_the_surface_files() {
 
 //! This function change the parameter value in DATA
 void MUSIC::set_parameter(std::string parameter_name, double value) {
-    ReadInParameters::set_parameter(DATA, parameter_name, value);
+    parameters_.set(parameter_name, value);
+    if (!ReadInParameters::set_parameter(DATA, parameter_name, value)) {
+        music_message << "MUSIC::set_parameter: " << parameter_name
+                      << " can not be changed after the construction, "
+                      << "please set it in the ParameterRegistry";
+        music_message.flush("warning");
+    }
 }
 
 
@@ -89,30 +155,101 @@ void MUSIC::initialize_hydro() {
 
     Init initialization(eos, DATA, hydro_source_terms_ptr);
     initialization.InitArena(arena_prev, arena_current, arena_future);
+    distribute_grids();
     flag_hydro_initialized = 1;
 }
 
 
+//! the grids are initialized on every rank, then each rank keeps its slab
+void MUSIC::distribute_grids() {
+    domain_ptr_ = std::make_shared<DomainDecomposition>(arena_current.nEta());
+    if (!domain_ptr_->is_distributed()) {
+        domain_ptr_ = nullptr;
+        return;
+    }
+    domain_ptr_->check_supported(DATA);
+    arena_prev    = domain_ptr_->get_local_grid(arena_prev);
+    arena_current = domain_ptr_->get_local_grid(arena_current);
+    arena_future  = domain_ptr_->get_local_grid(arena_future);
+    DATA.eta_index_offset = domain_ptr_->get_eta_index_offset();
+    music_message << "rank " << domain_ptr_->get_rank() << " evolves "
+                  << (domain_ptr_->get_owned_eta_max()
+                      - domain_ptr_->get_owned_eta_min())
+                  << " of the " << domain_ptr_->get_global_neta()
+                  << " eta layers";
+    music_message.flush("info");
+}
+
+
 //! this is a shell function to run hydro
 int MUSIC::run_hydro() {
     Evolve evolve_local(eos, DATA, hydro_source_terms_ptr);
+    if (domain_ptr_ != nullptr) {
+        evolve_local.set_domain_decomposition(domain_ptr_);
+    }
 
     if (hydro_info_ptr == nullptr && DATA.store_hydro_info_in_memory == 1) {
         hydro_info_ptr = std::make_shared<HydroinfoMUSIC> ();
     }
+#ifdef GSL
+    if (DATA.cooper_frye_streaming > 0) {
+        // the thermal spectra are computed from the surface chunks while
+        // the hydro runs
+        const int n_fields = (
+            FreezeoutSurface::kNumBaseFields
+            + DATA.output_vorticity*FreezeoutSurface::kNumVorticityFields);
+        surface_stream_ptr_ = std::make_shared<SurfaceStream>(
+            DATA.cooper_frye_streaming, n_fields,
+            [this]() {
+                streamed_cooper_frye_ptr_ = std::make_shared<Freeze>(&DATA);
+                streamed_cooper_frye_ptr_->begin_thermal_spectra_stream(
+                            DATA.particleSpectrumNumber, &DATA, &eos);
+            },
+            [this](const float *rows, const int64_t n_elements,
+                   const int n_fields_chunk) {
+                streamed_cooper_frye_ptr_->add_surface_chunk(
+                            &DATA, rows, n_elements, n_fields_chunk);
+            });
+        evolve_local.set_surface_stream(surface_stream_ptr_);
+    }
+#endif
+    if (step_callback_) evolve_local.set_step_callback(step_callback_);
     evolve_local.EvolveIt(arena_prev, arena_current, arena_future,
                           (*hydro_info_ptr));
+    freezeout_surface_ptr = evolve_local.get_freezeout_surface();
     flag_hydro_run = 1;
     return(0);
 }
 
 
+void MUSIC::tune_runtime_knobs() {
+    AutoTuner tuner(eos, DATA, hydro_source_terms_ptr);
+    tuner.run(arena_prev, arena_current);
+}
+
+
 //! this is a shell function to run Cooper-Frye
 int MUSIC::run_Cooper_Frye() {
 #ifdef GSL
-    Freeze cooper_frye(&DATA);
-    cooper_frye.CooperFrye_pseudo(DATA.particleSpectrumNumber, mode,
-                                  &DATA, &eos);
+    ScopedTimer timer(InstrumentedTimer::cooper_frye);
+    if (surface_stream_ptr_ != nullptr) {
+        // the thermal spectra are ready once the last chunks are added
+        surface_stream_ptr_->close();
+        streamed_cooper_frye_ptr_->finish_thermal_spectra_stream(&DATA);
+        streamed_cooper_frye_ptr_->CooperFrye_pseudo(
+                        DATA.particleSpectrumNumber, mode, &DATA, &eos);
+        cooper_frye_ptr_ = streamed_cooper_frye_ptr_;
+        surface_stream_ptr_ = nullptr;
+        streamed_cooper_frye_ptr_ = nullptr;
+        return(0);
+    }
+    auto cooper_frye = std::make_shared<Freeze>(&DATA);
+    if (freezeout_surface_ptr != nullptr) {
+        cooper_frye->set_freezeout_surface(freezeout_surface_ptr);
+    }
+    cooper_frye->CooperFrye_pseudo(DATA.particleSpectrumNumber, mode,
+                                   &DATA, &eos);
+    cooper_frye_ptr_ = cooper_frye;
 #endif
     return(0);
 }
@@ -148,7 +285,35 @@ void MUSIC::initialize_hydro_from_jetscape_preequilibrium_vectors(
         vector<double> pi_13_in, vector<double> pi_22_in,
         vector<double> pi_23_in, vector<double> pi_33_in,
         vector<double> Bulk_pi_in) {
+    set_jetscape_grid(dx, dz, nz);
+    Init initialization(eos, DATA, hydro_source_terms_ptr);
+    initialization.get_jetscape_preequilibrium_vectors(
+        std::move(e_in), std::move(P_in), std::move(u_tau_in),
+        std::move(u_x_in), std::move(u_y_in), std::move(u_eta_in),
+        std::move(pi_00_in), std::move(pi_01_in), std::move(pi_02_in),
+        std::move(pi_03_in), std::move(pi_11_in), std::move(pi_12_in),
+        std::move(pi_13_in), std::move(pi_22_in), std::move(pi_23_in),
+        std::move(pi_33_in), std::move(Bulk_pi_in));
+    initialization.InitArena(arena_prev, arena_current, arena_future);
+    distribute_grids();
+    flag_hydro_initialized = 1;
+}
+
+
+void MUSIC::initialize_hydro_from_jetscape_preequilibrium_vectors(
+        const double dx, const double dz, const double z_max, const int nz,
+        const JetscapePreequilibriumFields &fields) {
+    set_jetscape_grid(dx, dz, nz);
+    Init initialization(eos, DATA, hydro_source_terms_ptr);
+    initialization.set_jetscape_preequilibrium_fields(fields);
+    initialization.InitArena(arena_prev, arena_current, arena_future);
+    distribute_grids();
+    flag_hydro_initialized = 1;
+}
+
 
+void MUSIC::set_jetscape_grid(const double dx, const double dz,
+                              const int nz) {
     DATA.Initial_profile = 42;
     clean_all_the_surface_files();
 
@@ -160,14 +325,6 @@ void MUSIC::initialize_hydro_from_jetscape_preequilibrium_vectors(
     }
     DATA.delta_x = dx;
     DATA.delta_y = dx;
-
-    Init initialization(eos, DATA, hydro_source_terms_ptr);
-    initialization.get_jetscape_preequilibrium_vectors(
-        e_in, P_in, u_tau_in, u_x_in, u_y_in, u_eta_in,
-        pi_00_in, pi_01_in, pi_02_in, pi_03_in, pi_11_in, pi_12_in, pi_13_in,
-        pi_22_in, pi_23_in, pi_33_in, Bulk_pi_in);
-    initialization.InitArena(arena_prev, arena_current, arena_future);
-    flag_hydro_initialized = 1;
 }
 
 void MUSIC::get_hydro_info(
@@ -183,6 +340,19 @@ void MUSIC::get_hydro_info(
     hydro_info_ptr->getHydroValues(x, y, z, t, fluid_cell_info);
 }
 
+size_t MUSIC::get_hydro_info_batch(const HydroinfoMUSIC::Point *pts,
+                                   const size_t n,
+                                   fluidCell *fluid_cell_info) {
+    if (DATA.store_hydro_info_in_memory == 0 || hydro_info_ptr == nullptr) {
+        music_message << "hydro evolution informaiton is not stored "
+                      << "in the momeory! Please set the parameter "
+                      << "store_hydro_info_in_memory to 1~";
+        music_message.flush("error");
+        exit(1);
+    }
+    return(hydro_info_ptr->getHydroValuesBatch(pts, n, fluid_cell_info));
+}
+
 void MUSIC::clear_hydro_info_from_memory() {
     if (DATA.store_hydro_info_in_memory == 0 || hydro_info_ptr == nullptr) {
         music_message << "The parameter store_hydro_info_in_memory is 0. "
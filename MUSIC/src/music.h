@@ -3,6 +3,7 @@
 #define SRC_MUSIC_H_
 
 #include <memory>
+#include <utility>
 
 #include "util.h"
 #include "cell.h"
@@ -10,9 +11,16 @@
 #include "data.h"
 #include "eos.h"
 #include "hydro_source_base.h"
+#include "freezeout_surface.h"
+#include "surface_stream.h"
 #include "read_in_parameters.h"
 #include "pretty_ostream.h"
 #include "HydroinfoMUSIC.h"
+#include "init.h"
+#include "domain_decomposition.h"
+#include "evolve.h"
+
+class Freeze;
 
 //! This is a wrapper class for the MUSIC hydro
 class MUSIC {
@@ -28,9 +36,14 @@ class MUSIC {
 
     int system_status_;
 
+    //! the input parameters, with the set_parameter() overrides
+    ParameterRegistry parameters_;
+
     InitData DATA;
 
-    EOS eos;
+    //! the EOS, shared with the other events of an ensemble
+    std::shared_ptr<const EOS> eos_ptr_;
+    const EOS &eos;
 
     SCGrid arena_prev;
     SCGrid arena_current;
@@ -38,26 +51,92 @@ class MUSIC {
 
     std::shared_ptr<HydroSourceBase> hydro_source_terms_ptr;
 
+    //! the eta slabs of a distributed run (nullptr: a single rank)
+    std::shared_ptr<DomainDecomposition> domain_ptr_;
+
     std::shared_ptr<HydroinfoMUSIC> hydro_info_ptr;
 
+    //! the in-memory freeze-out surface of the last hydro run, passed on
+    //! to Cooper-Frye (only with freeze_surface_single_file = 1)
+    std::shared_ptr<const FreezeoutSurface> freezeout_surface_ptr;
+
+    //! the Cooper-Frye of the surface streamed from the hydro run, and the
+    //! stream (only with cooper_frye_streaming > 0)
+    std::shared_ptr<Freeze> streamed_cooper_frye_ptr_;
+    std::shared_ptr<SurfaceStream> surface_stream_ptr_;
+
+    //! the Cooper-Frye of the last run_Cooper_Frye, with the spectra of
+    //! its particle table
+    std::shared_ptr<const Freeze> cooper_frye_ptr_;
+
+    //! called by the evolution at every time step (empty: no callback)
+    EvolutionStepCallback step_callback_;
+
     pretty_ostream music_message;
 
+    //! sets up the grid of a JETSCAPE initial condition
+    void set_jetscape_grid(const double dx, const double dz, const int nz);
+
+    //! this function replaces the initialized grids by the local grids of
+    //! the rank in a distributed run
+    void distribute_grids();
+
  public:
     MUSIC(std::string input_file);
+    //! sets up MUSIC from parameters in memory, e.g. an input file read
+    //! once with overrides from set() for each event
+    MUSIC(const ParameterRegistry &parameters);
+    //! sets up MUSIC with an EOS which is already loaded, e.g. shared by
+    //! the events of an ensemble. It has to be the EOS of EOS_to_use.
+    MUSIC(const ParameterRegistry &parameters,
+          std::shared_ptr<const EOS> eos_in);
     ~MUSIC();
 
     //! this function returns the running mode
     int get_running_mode() {return(mode);}
 
+    //! returns the input parameters with the set_parameter() overrides,
+    //! e.g. to set up the next event
+    const ParameterRegistry &get_parameters() const {return(parameters_);}
+
+    //! runs the tasks of the running mode, as the MUSIC executable
+    void run();
+
     //! This function initialize hydro
     void initialize_hydro();
 
-    //! This function change the parameter value in DATA
+    //! This function change the parameter value in DATA. Only the
+    //! run-time parameters listed in ReadInParameters::set_parameter can
+    //! be changed here, the others have to be set in the ParameterRegistry
+    //! before MUSIC is constructed.
     void set_parameter(std::string parameter_name, double value);
 
     //! this is a shell function to run hydro
     int run_hydro();
 
+    //! times the time steps of the candidate runtime knobs on the initial
+    //! grids and writes the auto-tune profile (mode 9, see AutoTuner)
+    void tune_runtime_knobs();
+
+    //! sets the function run_hydro calls at every time step with the
+    //! fluid cells at tau, which can stop the evolution (see
+    //! EvolutionStepCallback)
+    void set_step_callback(EvolutionStepCallback callback) {
+        step_callback_ = std::move(callback);
+    }
+
+    //! the in-memory freeze-out surface of the last hydro run (nullptr
+    //! without freeze_surface_single_file = 1)
+    std::shared_ptr<const FreezeoutSurface> get_freezeout_surface() const {
+        return(freezeout_surface_ptr);
+    }
+
+    //! the Cooper-Frye of the last run_Cooper_Frye (nullptr before),
+    //! whose particle table holds the spectra of the run
+    std::shared_ptr<const Freeze> get_cooper_frye() const {
+        return(cooper_frye_ptr_);
+    }
+
     //! this is a shell function to run Cooper-Frye
     int run_Cooper_Frye();
 
@@ -77,6 +156,8 @@ class MUSIC {
 
     void clean_all_the_surface_files();
 
+    //! initializes hydro from the JETSCAPE vectors, which are moved into
+    //! MUSIC (pass them with std::move to avoid copying them)
     void initialize_hydro_from_jetscape_preequilibrium_vectors(
         const double dx, const double dz, const double z_max, const int nz,
         std::vector<double> e_in, std::vector<double> P_in,
@@ -88,10 +169,19 @@ class MUSIC {
         std::vector<double> pi_13_in, std::vector<double> pi_22_in,
         std::vector<double> pi_23_in, std::vector<double> pi_33_in,
         std::vector<double> Bulk_pi_in);
+    //! initializes hydro from the caller's arrays without copying them,
+    //! they only have to stay valid during the call
+    void initialize_hydro_from_jetscape_preequilibrium_vectors(
+        const double dx, const double dz, const double z_max, const int nz,
+        const JetscapePreequilibriumFields &fields);
 
     void get_hydro_info(
         const double x, const double y, const double z, const double t,
         fluidCell* fluid_cell_info);
+    //! interpolates the hydro history at n points in parallel, returns the
+    //! number of points out of range
+    size_t get_hydro_info_batch(const HydroinfoMUSIC::Point *pts,
+                                const size_t n, fluidCell *fluid_cell_info);
     int get_number_of_fluid_cells() const {
         return(hydro_info_ptr->get_number_of_fluid_cells());
     }
@@ -0,0 +1,514 @@
+// micro and macro benchmarks of the hydro kernels, see hackathon/NOTES.md
+//
+//     music_bench [results.json] [name filter]
+//
+// The results are written as JSON, one entry per benchmark with the
+// nanoseconds per operation (the minimum and the median of the samples).
+// The commit is taken from the environment variable MUSIC_BENCH_COMMIT.
+
+#ifdef _OPENMP
+    #include <omp.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+#include "active_region.h"
+#include "advance.h"
+#include "cooper_frye_kernel.h"
+#include "cornelius.h"
+#include "eos.h"
+#include "eos_base.h"
+#include "minmod.h"
+#include "parameter_registry.h"
+#include "pretty_ostream.h"
+#include "read_in_parameters.h"
+#include "reconst.h"
+#include "util.h"
+
+#ifndef _OPENMP
+    #define omp_get_max_threads() 1
+#endif
+
+namespace {
+    //! the samples of one benchmark, every sample runs n_ops operations
+    struct BenchmarkResult {
+        std::string name;
+        long long n_ops;
+        std::vector<double> seconds;
+
+        double get_ns_per_op_min() const {
+            return(1e9*(*std::min_element(seconds.begin(), seconds.end()))
+                   /n_ops);
+        }
+        double get_ns_per_op_median() const {
+            std::vector<double> sorted = seconds;
+            std::sort(sorted.begin(), sorted.end());
+            return(1e9*sorted[sorted.size()/2]/n_ops);
+        }
+    };
+
+    //! the results of the kernels are summed into sink, so the compiler
+    //! keeps the work
+    volatile double sink = 0.;
+
+    class BenchmarkSuite {
+     public:
+        explicit BenchmarkSuite(const std::string &filter) :
+            filter_(filter) {}
+
+        bool is_selected(const std::string &name) const {
+            return(name.find(filter_) != std::string::npos);
+        }
+
+        //! times batch, which returns the number of operations it ran.
+        //! The batches of a sample are repeated for at least 20 ms.
+        void run_micro(const std::string &name,
+                       const std::function<long long()> &batch) {
+            if (!is_selected(name)) return;
+            const double min_sample_seconds = 0.02;
+            const int n_samples = 7;
+            long long n_ops = 0;
+            int n_batches = 1;
+            while (true) {
+                n_ops = 0;
+                const double seconds = time_batches(batch, n_batches, n_ops);
+                if (seconds >= min_sample_seconds) break;
+                n_batches *= 2;
+            }
+            BenchmarkResult result = {name, n_ops, {}};
+            for (int i = 0; i < n_samples; i++) {
+                long long n_ops_sample = 0;
+                result.seconds.push_back(
+                        time_batches(batch, n_batches, n_ops_sample));
+            }
+            add_result(result);
+        }
+
+        //! times step n_samples times, setup runs untimed before every
+        //! sample; step runs n_ops operations
+        void run_macro(const std::string &name, const long long n_ops,
+                       const int n_samples,
+                       const std::function<void()> &setup,
+                       const std::function<void()> &step) {
+            if (!is_selected(name)) return;
+            BenchmarkResult result = {name, n_ops, {}};
+            for (int i = 0; i < n_samples; i++) {
+                setup();
+                const auto start = std::chrono::steady_clock::now();
+                step();
+                const std::chrono::duration<double> elapsed = (
+                            std::chrono::steady_clock::now() - start);
+                result.seconds.push_back(elapsed.count());
+            }
+            add_result(result);
+        }
+
+        //! writes the results as JSON
+        void write(const std::string &filename) {
+            FILE *out_file = fopen(filename.c_str(), "w");
+            if (out_file == NULL) {
+                music_message << "music_bench: can not open file "
+                              << filename;
+                music_message.flush("error");
+                exit(1);
+            }
+            const char *commit = getenv("MUSIC_BENCH_COMMIT");
+            char date[32];
+            const time_t now = time(NULL);
+            strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S",
+                     localtime(&now));
+            fprintf(out_file, "{\n  \"commit\": \"%s\",\n"
+                    "  \"date\": \"%s\",\n  \"threads\": %d,\n"
+                    "  \"results\": [\n",
+                    commit != NULL ? commit : "unknown", date,
+                    omp_get_max_threads());
+            for (unsigned int i = 0; i < results_.size(); i++) {
+                const BenchmarkResult &result = results_[i];
+                fprintf(out_file, "    {\"name\": \"%s\", \"ops\": %lld, "
+                        "\"samples\": %d, \"ns_per_op_min\": %.6g, "
+                        "\"ns_per_op_median\": %.6g}%s\n",
+                        result.name.c_str(), result.n_ops,
+                        static_cast<int>(result.seconds.size()),
+                        result.get_ns_per_op_min(),
+                        result.get_ns_per_op_median(),
+                        i + 1 < results_.size() ? "," : "");
+            }
+            fprintf(out_file, "  ]\n}\n");
+            fclose(out_file);
+            music_message << "music_bench: wrote " << results_.size()
+                          << " results to " << filename;
+            music_message.flush("info");
+        }
+
+     private:
+        const std::string filter_;
+        std::vector<BenchmarkResult> results_;
+        pretty_ostream music_message;
+
+        double time_batches(const std::function<long long()> &batch,
+                            const int n_batches, long long &n_ops) const {
+            const auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < n_batches; i++) n_ops += batch();
+            const std::chrono::duration<double> elapsed = (
+                        std::chrono::steady_clock::now() - start);
+            return(elapsed.count());
+        }
+
+        void add_result(const BenchmarkResult &result) {
+            music_message << result.name << ": "
+                          << result.get_ns_per_op_min() << " ns/op (median "
+                          << result.get_ns_per_op_median() << " ns/op)";
+            music_message.flush("info");
+            results_.push_back(result);
+        }
+    };
+
+
+    //! the input of the benchmarks: a 3+1D viscous run with the ideal gas
+    //! EOS on an nx*ny*neta grid
+    InitData get_benchmark_data(const int nx, const int neta,
+                                const int causality_method) {
+        ParameterRegistry parameters;
+        parameters.set("mode", 2);
+        parameters.set("echo_level", 1);
+        parameters.set("boost_invariant", 0);
+        parameters.set("EOS_to_use", 0);
+        parameters.set("Grid_size_in_x", nx);
+        parameters.set("Grid_size_in_y", nx);
+        parameters.set("Grid_size_in_eta", neta);
+        parameters.set("X_grid_size_in_fm", 20.);
+        parameters.set("Y_grid_size_in_fm", 20.);
+        parameters.set("Eta_grid_size", 8.);
+        parameters.set("Initial_time_tau_0", 0.6);
+        parameters.set("Delta_Tau", 0.005);
+        parameters.set("Viscosity_Flag_Yes_1_No_0", 1);
+        parameters.set("Include_Shear_Visc_Yes_1_No_0", 1);
+        parameters.set("Shear_to_S_ratio", 0.12);
+        parameters.set("Include_Bulk_Visc_Yes_1_No_0", 1);
+        parameters.set("causality_method", causality_method);
+        return(ReadInParameters::read_in_parameters(parameters));
+    }
+
+    //! a Gaussian fire ball at rest with Bjorken-like shear stress and a
+    //! negative bulk pressure, the same for every benchmark
+    void fill_benchmark_grid(const InitData &DATA, const EOS &eos,
+                             SCGrid &arena) {
+        for (int ieta = 0; ieta < arena.nEta(); ieta++)
+        for (int ix = 0; ix < arena.nX(); ix++)
+        for (int iy = 0; iy < arena.nY(); iy++) {
+            const double x = -DATA.x_size/2. + ix*DATA.delta_x;
+            const double y = -DATA.y_size/2. + iy*DATA.delta_y;
+            const double eta = -DATA.eta_size/2. + ieta*DATA.delta_eta;
+            const double profile = exp(-(x*x + y*y)/(2.*3.*3.)
+                                       - eta*eta/(2.*2.*2.));
+            Cell_small &cell = arena(ix, iy, ieta);
+            cell.epsilon = 50.*profile + 1e-4;
+            cell.rhob = 0.;
+            cell.u = {1., 0., 0., 0.};
+            const double pressure = eos.get_pressure(cell.epsilon, 0.);
+            const double pi = 0.1*pressure*profile;
+            cell.Wmunu = {0.};
+            cell.Wmunu[4] = pi;
+            cell.Wmunu[7] = pi;
+            cell.Wmunu[9] = -2.*pi;
+            cell.pi_b = -0.05*pressure*profile;
+        }
+    }
+
+
+    void run_micro_benchmarks(BenchmarkSuite &suite) {
+        std::mt19937 rng(42);
+        std::uniform_real_distribution<double> uniform(0., 1.);
+        const int n_points = 4096;
+
+        // bilinear interpolation of a tabulated EOS (two tables)
+        EOS_base eos_table;
+        const int n_tables = 2;
+        eos_table.set_number_of_tables(n_tables);
+        eos_table.resize_table_info_arrays();
+        eos_table.pressure_tb    = new double** [n_tables];
+        eos_table.temperature_tb = new double** [n_tables];
+        for (int itable = 0; itable < n_tables; itable++) {
+            eos_table.e_bounds[itable]   = 0.1 + 10.*itable;
+            eos_table.e_spacing[itable]  = 0.02*(itable + 1);
+            eos_table.e_length[itable]   = 500;
+            eos_table.nb_bounds[itable]  = 0.;
+            eos_table.nb_spacing[itable] = 0.004*(itable + 1);
+            eos_table.nb_length[itable]  = 250;
+            eos_table.pressure_tb[itable] = Util::mtx_malloc(
+                    eos_table.nb_length[itable], eos_table.e_length[itable]);
+            eos_table.temperature_tb[itable] = Util::mtx_malloc(
+                    eos_table.nb_length[itable], eos_table.e_length[itable]);
+            for (int i = 0; i < eos_table.nb_length[itable]; i++)
+            for (int j = 0; j < eos_table.e_length[itable]; j++) {
+                eos_table.pressure_tb[itable][i][j] = (
+                        0.3*(eos_table.e_bounds[itable]
+                             + j*eos_table.e_spacing[itable]) + 0.01*i);
+                eos_table.temperature_tb[itable][i][j] = 0.;
+            }
+        }
+        std::vector<double> e_list(n_points), rhob_list(n_points);
+        std::vector<int> table_list(n_points);
+        for (int i = 0; i < n_points; i++) {
+            e_list[i] = 0.1 + 20.*uniform(rng);
+            rhob_list[i] = 0.9*uniform(rng);
+            table_list[i] = eos_table.get_table_idx(e_list[i]);
+        }
+        suite.run_micro("micro/EOS_base::interpolate2D", [&]() {
+            double sum = 0.;
+            for (int i = 0; i < n_points; i++) {
+                sum += eos_table.interpolate2D(e_list[i], rhob_list[i],
+                                               table_list[i],
+                                               eos_table.pressure_tb);
+            }
+            sink = sink + sum;
+            return(static_cast<long long>(n_points));
+        });
+
+        // the reconstruction of moving cells from T^{tau mu} and J^tau
+        EOS eos_ideal(0);
+        const double tau = 1.0;
+        std::vector<TJbVec> tauq_list(n_points);
+        std::vector<Cell_small> guess_list(n_points);
+        std::vector<ReconstCell> reconst_list(n_points);
+        std::vector<Cell_small> cell_list(n_points);
+        for (int i = 0; i < n_points; i++) {
+            const double e = 0.1 + 10.*uniform(rng);
+            const double p = eos_ideal.get_pressure(e, 0.);
+            FlowVec u = {0., 0.8*(uniform(rng) - 0.5),
+                         0.8*(uniform(rng) - 0.5), 0.4*(uniform(rng) - 0.5)};
+            u[0] = sqrt(1. + u[1]*u[1] + u[2]*u[2] + u[3]*u[3]);
+            for (int mu = 0; mu < 4; mu++) {
+                tauq_list[i][mu] = tau*((e + p)*u[0]*u[mu]
+                                        - (mu == 0 ? p : 0.));
+            }
+            tauq_list[i][4] = 0.;
+            guess_list[i].epsilon = 0.95*e;
+            guess_list[i].u = u;
+            reconst_list[i] = {e, 0., u};
+
+            Cell_small &cell = cell_list[i];
+            cell.epsilon = e;
+            cell.u = u;
+            for (int j = 0; j < 10; j++) {
+                cell.Wmunu[j] = 0.05*p*(uniform(rng) - 0.5);
+            }
+        }
+        Reconst reconst(eos_ideal, 1);
+        suite.run_micro("micro/Reconst::ReconstIt_shell", [&]() {
+            double sum = 0.;
+            for (int i = 0; i < n_points; i++) {
+                sum += reconst.ReconstIt_shell(tau, tauq_list[i],
+                                               guess_list[i]).e;
+            }
+            sink = sink + sum;
+            return(static_cast<long long>(n_points));
+        });
+
+        // slope limiters of the KT reconstruction, one cell at a time and
+        // a row at once
+        std::vector<double> f_row(n_points + 2), slope_row(n_points);
+        for (auto &f : f_row) f = uniform(rng) - 0.5;
+        const Minmod minmod_limiter(1.8);
+        suite.run_micro("micro/Minmod::minmod_dx", [&]() {
+            double sum = 0.;
+            for (int i = 0; i < n_points; i++) {
+                sum += minmod_limiter.minmod_dx(f_row[i + 2], f_row[i + 1],
+                                                f_row[i]);
+            }
+            sink = sink + sum;
+            return(static_cast<long long>(n_points));
+        });
+        suite.run_micro("micro/SlopeLimiter::limit_row/minmod", [&]() {
+            SlopeLimiter::limit_row(minmod_limiter.get_limiter(), n_points,
+                                    &f_row[2], &f_row[1], &f_row[0],
+                                    slope_row.data());
+            sink = sink + slope_row[0];
+            return(static_cast<long long>(n_points));
+        });
+        suite.run_micro("micro/SlopeLimiter::limit_row/van_leer", [&]() {
+            SlopeLimiter::limit_row(SlopeLimiter::VanLeer(), n_points,
+                                    &f_row[2], &f_row[1], &f_row[0],
+                                    slope_row.data());
+            sink = sink + slope_row[0];
+            return(static_cast<long long>(n_points));
+        });
+
+        InitData DATA = get_benchmark_data(16, 4, 2);
+        Advance advance(eos_ideal, DATA, nullptr);
+        suite.run_micro("micro/Advance::MaxSpeed", [&]() {
+            double sum = 0.;
+            for (int i = 0; i < n_points; i++) {
+                sum += advance.MaxSpeed(tau, 1 + i%3, reconst_list[i]);
+            }
+            sink = sink + sum;
+            return(static_cast<long long>(n_points));
+        });
+
+        // Advance keeps a reference to DATA, the solver is picked per call
+        for (int solver = 0; solver < 3; solver++) {
+            DATA.Wmunu_eigenvalue_solver = solver;
+            suite.run_micro(
+                "micro/solveEigenvaluesWmunu/solver" + std::to_string(solver),
+                [&]() {
+                    double sum = 0.;
+                    for (int i = 0; i < n_points; i++) {
+                        LambdaVec lambdas;
+                        advance.solveEigenvaluesWmunu(cell_list[i], lambdas);
+                        sum += lambdas[2];
+                    }
+                    sink = sink + sum;
+                    return(static_cast<long long>(n_points));
+                });
+        }
+
+        // hypercubes crossed by the surface at 0.5
+        const int n_cubes = 1024;
+        std::vector<double> cubes(16*n_cubes);
+        for (int i = 0; i < n_cubes; i++) {
+            const double slope[4] = {uniform(rng) - 0.5, uniform(rng) - 0.5,
+                                     uniform(rng) - 0.5, uniform(rng) - 0.5};
+            for (int n = 0; n < 16; n++) {
+                double value = 0.5 + 0.1*(uniform(rng) - 0.5);
+                for (int d = 0; d < 4; d++) {
+                    value += slope[d]*(((n >> (3 - d)) & 1) - 0.5);
+                }
+                cubes[16*i + n] = value;
+            }
+        }
+        double lattice_spacing[4] = {0.1, 0.2, 0.2, 0.1};
+        Cornelius cornelius;
+        cornelius.init(4, 0.5, lattice_spacing);
+        suite.run_micro("micro/Cornelius::find_surface_4d", [&]() {
+            long long n_elements = 0;
+            for (int i = 0; i < n_cubes; i++) {
+                cornelius.find_surface_4d(&cubes[16*i]);
+                n_elements += cornelius.get_Nelements();
+            }
+            sink = sink + static_cast<double>(n_elements);
+            return(static_cast<long long>(n_cubes));
+        });
+
+        // the Cooper-Frye integrand of a row of azimuthal angles with the
+        // shear, bulk and diffusion delta f
+        FreezeCellInfo cell;
+        cell.tau = 5.2;
+        cell.eta_s = 0.3;
+        cell.cosh_eta_s = cosh(cell.eta_s);
+        cell.sinh_eta_s = sinh(cell.eta_s);
+        cell.T = 0.15;
+        cell.muB = 0.05;
+        const double sigma_mu[4] = {1.2, -0.3, 0.25, 0.01};
+        const double u_flow[4] = {1.3, 0.6, -0.55, 0.02};
+        const double q[4] = {0.001, 0.02, -0.01, 0.003};
+        for (int ii = 0; ii < 4; ii++) {
+            cell.sigma_mu[ii] = sigma_mu[ii];
+            cell.u_flow[ii] = u_flow[ii];
+            cell.q[ii] = q[ii];
+        }
+        for (int ii = 0; ii < 10; ii++) cell.W[ii] = 0.002*(ii - 4.5);
+        cell.Pi_bulk = -0.01;
+        cell.bulk_deltaf_coeffs[0] = 0.8;
+        cell.bulk_deltaf_coeffs[1] = 0.3;
+        cell.bulk_deltaf_coeffs[2] = 0.1;
+        cell.deltaf_qmu_coeff = 2.5;
+        cell.deltaf_qmu_coeff_14mom_DV = 0.4;
+        cell.deltaf_qmu_coeff_14mom_BV = -0.2;
+        cell.prefactor_shear = 30.;
+        cell.prefactor_qmu = 0.8;
+        cell.flag_shear_deltaf = 1;
+        cell.flag_bulk_deltaf = 1;
+        cell.flag_qmu_deltaf = 1;
+        const CooperFryeSpecies species = {0.938, 1, 1., 0.05};
+        const int n_pt = 40;
+        const int n_phi = 48;
+        std::vector<double> cos_phi(n_phi), sin_phi(n_phi);
+        for (int iphi = 0; iphi < n_phi; iphi++) {
+            cos_phi[iphi] = cos(2.*M_PI*iphi/n_phi);
+            sin_phi[iphi] = sin(2.*M_PI*iphi/n_phi);
+        }
+        std::vector<double> sum_phi(n_pt*n_phi, 0.);
+        suite.run_micro("micro/CooperFrye::add_phi_integrand", [&]() {
+            for (int ipt = 0; ipt < n_pt; ipt++) {
+                const double pt = 0.05*ipt;
+                const double mt = sqrt(species.m*species.m + pt*pt);
+                CooperFrye::add_phi_integrand(
+                    cell, 1, 0, species, pt, mt, 0., n_phi, cos_phi.data(),
+                    sin_phi.data(), 1.0, &sum_phi[ipt*n_phi]);
+            }
+            sink = sink + sum_phi[0];
+            return(static_cast<long long>(n_pt*n_phi));
+        });
+    }
+
+
+    //! one Runge-Kutta step (all the stages) of the whole grid, as in
+    //! Evolve::AdvanceRK
+    void run_macro_benchmarks(BenchmarkSuite &suite) {
+        const struct {
+            const char *name;
+            int nx, neta;
+        } grids[3] = {{"small", 64, 8}, {"middle", 128, 16},
+                      {"large", 200, 32}};
+        const EOS eos_ideal(0);
+        for (const auto &grid : grids)
+        for (int causality_method = 0; causality_method < 3;
+             causality_method++) {
+            const std::string name = (
+                std::string("macro/rk_step/") + grid.name
+                + "/causality_method" + std::to_string(causality_method));
+            if (!suite.is_selected(name)) continue;
+            InitData DATA = get_benchmark_data(grid.nx, grid.neta,
+                                               causality_method);
+            DATA.delta_tau_backward = DATA.delta_tau;
+            SCGrid initial(grid.nx, grid.nx, grid.neta);
+            fill_benchmark_grid(DATA, eos_ideal, initial);
+            SCGrid arena_prev, arena_current, arena_future;
+            const ActiveRegion active_region(grid.nx, grid.nx, grid.neta);
+            Advance advance(eos_ideal, DATA, nullptr);
+            const int n_stages = DATA.rk_order;
+            suite.run_macro(name, static_cast<long long>(initial.size()), 3,
+                [&]() {
+                    arena_prev    = initial;
+                    arena_current = initial;
+                    arena_future  = initial;
+                },
+                [&]() {
+                    SCGrid *prev    = &arena_prev;
+                    SCGrid *current = &arena_current;
+                    SCGrid *future  = &arena_future;
+                    for (int rk_flag = 0; rk_flag < n_stages; rk_flag++) {
+                        advance.AdvanceIt(DATA.tau0, *prev, *current,
+                                          *future, rk_flag, active_region);
+                        if (rk_flag == 0) {
+                            std::swap(prev, current);
+                            std::swap(current, future);
+                        } else {
+                            std::swap(current, future);
+                        }
+                    }
+                    sink = sink + (*current)(0).epsilon;
+                });
+        }
+    }
+}
+
+
+int main(int argc, char *argv[]) {
+    const std::string filename = (argc > 1 ? argv[1]
+                                           : "music_bench_results.json");
+    const std::string filter = (argc > 2 ? argv[2] : "");
+    BenchmarkSuite suite(filter);
+    run_micro_benchmarks(suite);
+    run_macro_benchmarks(suite);
+    suite.write(filename);
+    return(0);
+}
@@ -0,0 +1,199 @@
+#ifdef _OPENMP
+    #include <omp.h>
+#endif
+
+#ifdef MUSIC_MPI
+    #include <mpi.h>
+#endif
+
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include "music.h"
+#include "music_ensemble.h"
+#include "read_in_parameters.h"
+#include "util.h"
+
+#ifndef _OPENMP
+    #define omp_get_max_threads() 1
+    #define omp_set_num_threads(n)
+#endif
+
+MUSICEnsemble::MUSICEnsemble(const ParameterRegistry &parameters) :
+        parameters_(parameters) {
+#ifdef MUSIC_MPI
+    int nranks = 1;
+    MPI_Comm_size(MPI_COMM_WORLD, &nranks);
+    if (nranks > 1) {
+        music_message << "MUSICEnsemble: the ensemble runs in one process, "
+                      << "please start it without mpirun!";
+        music_message.flush("error");
+        exit(1);
+    }
+#endif
+    const std::string list_filename = parameters_.find("ensemble_event_list");
+    std::ifstream list_file(list_filename.c_str());
+    if (!list_file.is_open()) {
+        music_message << "MUSICEnsemble: can not open the event list "
+                      << list_filename;
+        music_message.flush("error");
+        exit(1);
+    }
+    events_ = read_event_list(list_file);
+    check_events();
+
+    const int n_threads = omp_get_max_threads();
+    n_concurrent_ = parameters_.get("ensemble_concurrent_events", n_threads);
+    n_concurrent_ = std::max(1, std::min(n_concurrent_,
+                                         static_cast<int>(events_.size())));
+    n_threads_per_event_ = std::max(1, n_threads/n_concurrent_);
+
+    // the driver must not start OpenMP threads, the thread pool of the
+    // OpenMP runtime does not survive the fork of the events
+    omp_set_num_threads(1);
+    ParameterRegistry eos_parameters = parameters_;
+    const InitData DATA = ReadInParameters::read_in_parameters(
+                                                        eos_parameters);
+    eos_ptr_ = std::make_shared<const EOS>(DATA.whichEOS);
+
+    music_message << "MUSICEnsemble: " << events_.size() << " events, "
+                  << n_concurrent_ << " at a time with "
+                  << n_threads_per_event_ << " threads each";
+    music_message.flush("info");
+}
+
+
+std::vector<EnsembleEvent> MUSICEnsemble::read_event_list(
+                                                std::istream &input) {
+    std::vector<EnsembleEvent> events;
+    std::string line;
+    while (std::getline(input, line)) {
+        std::string entries;
+        std::stringstream line_stream(line);
+        std::getline(line_stream, entries, '#');  // remove the comments
+        std::stringstream entry_stream(entries);
+        EnsembleEvent event;
+        if (!(entry_stream >> event.directory)) continue;
+        std::string name, value;
+        while (entry_stream >> name) {
+            if (!(entry_stream >> value)) {
+                pretty_ostream music_message;
+                music_message << "MUSICEnsemble: the parameter " << name
+                              << " of the event " << event.directory
+                              << " has no value!";
+                music_message.flush("error");
+                exit(1);
+            }
+            event.parameters.push_back(std::make_pair(name, value));
+        }
+        events.push_back(event);
+    }
+    return(events);
+}
+
+
+void MUSICEnsemble::check_events() {
+    std::set<std::string> directories;
+    for (const auto &event : events_) {
+        if (!directories.insert(event.directory).second) {
+            music_message << "MUSICEnsemble: the events have to write to "
+                          << "different directories, " << event.directory
+                          << " is listed twice!";
+            music_message.flush("error");
+            exit(1);
+        }
+        for (const auto &parameter : event.parameters) {
+            const std::string name = Util::convert_to_lowercase(
+                                                        parameter.first);
+            if (name == "eos_to_use") {
+                music_message << "MUSICEnsemble: the events share the EOS, "
+                              << "the event " << event.directory
+                              << " can not change EOS_to_use!";
+                music_message.flush("error");
+                exit(1);
+            }
+        }
+    }
+}
+
+
+//! the events are forked in the order of the event list, a new one starts
+//! when one of the running events has finished
+int MUSICEnsemble::run() {
+    std::map<pid_t, const EnsembleEvent*> running;
+    int n_failed = 0;
+    size_t next_event = 0;
+    while (next_event < events_.size() || !running.empty()) {
+        if (next_event < events_.size()
+                && static_cast<int>(running.size()) < n_concurrent_) {
+            const EnsembleEvent &event = events_[next_event++];
+            mkdir(event.directory.c_str(), 0755);
+            // the buffered output would be written again by the child
+            std::cout.flush();
+            fflush(stdout);
+            fflush(stderr);
+            const pid_t pid = fork();
+            if (pid == 0) _exit(run_event(event));
+            if (pid < 0) {
+                music_message << "MUSICEnsemble: can not start the event "
+                              << event.directory;
+                music_message.flush("warning");
+                n_failed++;
+            } else {
+                running[pid] = &event;
+            }
+            continue;
+        }
+
+        int status = 0;
+        const pid_t pid = wait(&status);
+        if (pid < 0) break;
+        const auto it = running.find(pid);
+        if (it == running.end()) continue;
+        if (WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+            music_message << "MUSICEnsemble: event " << it->second->directory
+                          << " done.";
+            music_message.flush("info");
+        } else {
+            music_message << "MUSICEnsemble: event " << it->second->directory
+                          << " failed, see its music_output.log";
+            music_message.flush("warning");
+            n_failed++;
+        }
+        running.erase(it);
+    }
+    music_message << "MUSICEnsemble: " << events_.size() - n_failed
+                  << " of " << events_.size() << " events done.";
+    music_message.flush("info");
+    return(n_failed);
+}
+
+
+int MUSICEnsemble::run_event(const EnsembleEvent &event) const {
+    if (chdir(event.directory.c_str()) != 0) return(1);
+    if (freopen("music_output.log", "w", stdout) == NULL) return(1);
+    dup2(fileno(stdout), fileno(stderr));
+    omp_set_num_threads(n_threads_per_event_);
+
+    ParameterRegistry parameters = parameters_;
+    for (const auto &parameter : event.parameters) {
+        parameters.set(parameter.first, parameter.second);
+    }
+    // the threads of the event are not the ones of an auto-tune profile
+    parameters.set("omp_num_threads", n_threads_per_event_);
+    MUSIC music_hydro(parameters, eos_ptr_);
+    music_hydro.run();
+
+    std::cout.flush();
+    fflush(stdout);
+    return(0);
+}
@@ -0,0 +1,64 @@
+#ifndef SRC_MUSIC_ENSEMBLE_H_
+#define SRC_MUSIC_ENSEMBLE_H_
+
+#include <istream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "eos.h"
+#include "parameter_registry.h"
+#include "pretty_ostream.h"
+
+//! one event of an ensemble: its output directory and the parameters
+//! which override those of the input file
+struct EnsembleEvent {
+    std::string directory;
+    std::vector<std::pair<std::string, std::string>> parameters;
+};
+
+//! This class runs the events of an ensemble in one process. The input
+//! file is parsed and the EOS is loaded once, then every event runs in a
+//! child process forked from the driver, in its own directory. At most
+//! ensemble_concurrent_events children run at a time, and the OpenMP
+//! threads are split among them. The children share the EOS tables of the
+//! driver (the pages are only copied when written), and an event which
+//! exits with an error does not stop the others.
+//!
+//! The events are listed in the file ensemble_event_list, one per line:
+//!
+//!     event_directory [parameter_name value]...
+//!
+//! where "#" starts a comment. The directory is created if needed, and the
+//! event writes its outputs and its log (music_output.log) there. The
+//! event runs in its directory, so relative paths in the input file and in
+//! the event list are relative to the event directory.
+class MUSICEnsemble {
+ public:
+    explicit MUSICEnsemble(const ParameterRegistry &parameters);
+
+    //! the events of an event list, see the class comment
+    static std::vector<EnsembleEvent> read_event_list(std::istream &input);
+
+    //! runs all the events, returns the number of events which failed
+    int run();
+
+ private:
+    //! the input file, shared by all the events
+    ParameterRegistry parameters_;
+    std::vector<EnsembleEvent> events_;
+    int n_concurrent_ = 1;
+    int n_threads_per_event_ = 1;
+    std::shared_ptr<const EOS> eos_ptr_;
+    pretty_ostream music_message;
+
+    //! exits with an error if an event overrides a parameter which has to
+    //! be the same for all the events
+    void check_events();
+
+    //! runs the event in the calling child process, returns the exit
+    //! status of the child
+    int run_event(const EnsembleEvent &event) const;
+};
+
+#endif  // SRC_MUSIC_ENSEMBLE_H_
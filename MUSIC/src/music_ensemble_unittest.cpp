@@ -0,0 +1,30 @@
+#include "doctest.h"
+#include "music_ensemble.h"
+#include <sstream>
+
+TEST_CASE("Check MUSICEnsemble reads the event list") {
+    std::istringstream input(
+        "# design point 0\n"
+        "event_0  eta_over_s 0.08  Initial_Distribution_input_filename "
+        "../ic/event_0.dat\n"
+        "\n"
+        "event_1 # no overrides\n"
+        "   event_2 T_freeze 0.145\n");
+    const auto events = MUSICEnsemble::read_event_list(input);
+    REQUIRE(events.size() == 3);
+
+    CHECK(events[0].directory == "event_0");
+    REQUIRE(events[0].parameters.size() == 2);
+    CHECK(events[0].parameters[0].first == "eta_over_s");
+    CHECK(events[0].parameters[0].second == "0.08");
+    CHECK(events[0].parameters[1].first
+          == "Initial_Distribution_input_filename");
+    CHECK(events[0].parameters[1].second == "../ic/event_0.dat");
+
+    CHECK(events[1].directory == "event_1");
+    CHECK(events[1].parameters.empty());
+
+    CHECK(events[2].directory == "event_2");
+    REQUIRE(events[2].parameters.size() == 1);
+    CHECK(events[2].parameters[0].second == "0.145");
+}
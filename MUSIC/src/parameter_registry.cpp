@@ -0,0 +1,83 @@
+#include <fstream>
+#include <iostream>
+#include "parameter_registry.h"
+#include "util.h"
+
+ParameterRegistry::ParameterRegistry(const std::string &input_file) {
+    // check whether the input parameter file is exist or not
+    if (!Util::IsFile(input_file)) {
+        std::string tmpfilename = "input.default";
+        if (input_file == "") {
+            fprintf(stderr, "No input file name specified.\n");
+            fprintf(stderr, "Creating a default file named input.default\n");
+        } else {
+            std::cerr << "The file named " << input_file << " is absent."
+                      << std::endl;
+            std::cout << "Creating " << input_file << "..." << std::endl;
+            tmpfilename = input_file;
+        }
+        std::ofstream tmp_file(tmpfilename.c_str());
+        tmp_file << "EndOfData" << std::endl;
+        tmp_file.close();
+        exit(1);
+    }
+
+    std::ifstream input(input_file.c_str());
+    std::string temp_string;
+    while (std::getline(input, temp_string)
+           && Util::convert_to_lowercase(temp_string) != "endofdata") {
+        std::string para_string;
+        std::stringstream temp_ss(temp_string);
+        std::getline(temp_ss, para_string, '#');  // remove the comments
+        std::string para_name, para_val;
+        std::stringstream para_stream(para_string);
+        para_stream >> para_name >> para_val;
+        if (para_name == "") continue;
+        // the first entry of a parameter wins, as in Util::StringFind4
+        const std::string key = Util::convert_to_lowercase(para_name);
+        if (values_.count(key) == 0) {
+            names_.push_back(key);
+            values_[key] = para_val;
+        }
+    }
+    input.close();
+}
+
+
+std::string ParameterRegistry::find(const std::string &name) {
+    const std::string key = Util::convert_to_lowercase(name);
+    requested_.insert(key);
+    const auto it = values_.find(key);
+    if (it == values_.end() || it->second == "") return("empty");
+    return(it->second);
+}
+
+
+bool ParameterRegistry::contains(const std::string &name) const {
+    return(values_.count(Util::convert_to_lowercase(name)) > 0);
+}
+
+
+void ParameterRegistry::set(const std::string &name,
+                            const std::string &value) {
+    const std::string key = Util::convert_to_lowercase(name);
+    if (values_.count(key) == 0) names_.push_back(key);
+    values_[key] = value;
+}
+
+
+void ParameterRegistry::set(const std::string &name, const double value) {
+    std::ostringstream value_stream;
+    value_stream.precision(17);
+    value_stream << value;
+    set(name, value_stream.str());
+}
+
+
+std::vector<std::string> ParameterRegistry::get_unused_parameters() const {
+    std::vector<std::string> unused;
+    for (const auto &name : names_) {
+        if (requested_.count(name) == 0) unused.push_back(name);
+    }
+    return(unused);
+}
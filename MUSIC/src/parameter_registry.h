@@ -0,0 +1,55 @@
+#ifndef SRC_PARAMETER_REGISTRY_H_
+#define SRC_PARAMETER_REGISTRY_H_
+
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+//! This class holds the parameters of an input file. The file is parsed
+//! once into a hash map (the names are case insensitive, "#" starts a
+//! comment and the lines after EndOfData are ignored), the lookups do not
+//! touch the disk. The lookups are recorded, so the parameters in the file
+//! which are never looked up can be reported.
+class ParameterRegistry {
+ private:
+    //! the parameters by lower case name
+    std::unordered_map<std::string, std::string> values_;
+    //! the names in the order of the input file
+    std::vector<std::string> names_;
+    //! the lower case names looked up so far
+    std::unordered_set<std::string> requested_;
+
+ public:
+    //! an empty registry, to be filled with set()
+    ParameterRegistry() = default;
+    //! reads the input file. A missing file is an error, as in
+    //! Util::StringFind4, an input.default file is created to start from.
+    explicit ParameterRegistry(const std::string &input_file);
+
+    //! returns the value string, "empty" if the parameter is not set
+    //! (the convention of Util::StringFind4)
+    std::string find(const std::string &name);
+
+    //! returns the value of the parameter, default_value if it is not set
+    template <typename T>
+    T get(const std::string &name, const T default_value) {
+        const std::string value = find(name);
+        if (value == "empty") return(default_value);
+        T result = default_value;
+        std::istringstream(value) >> result;
+        return(result);
+    }
+
+    bool contains(const std::string &name) const;
+
+    //! sets or overrides the parameter in memory
+    void set(const std::string &name, const std::string &value);
+    void set(const std::string &name, const double value);
+
+    //! returns the parameters in the input file which were never looked up
+    std::vector<std::string> get_unused_parameters() const;
+};
+
+#endif  // SRC_PARAMETER_REGISTRY_H_
@@ -0,0 +1,39 @@
+#include "doctest.h"
+#include "parameter_registry.h"
+#include <cstdio>
+#include <string>
+
+TEST_CASE("Check ParameterRegistry parses the input file once") {
+    const std::string filename = "test_parameter_registry.input";
+    FILE *file = fopen(filename.c_str(), "w");
+    fprintf(file, "# a comment line\n");
+    fprintf(file, "Initial_profile 9    # IP-Glasma\n");
+    fprintf(file, "\n");
+    fprintf(file, "Delta_Tau  0.005\n");
+    fprintf(file, "initial_profile 8\n");
+    fprintf(file, "Initial_Distribution_input_filename ipg.dat\n");
+    fprintf(file, "Not_Used 1\n");
+    fprintf(file, "EndOfData\n");
+    fprintf(file, "T_freeze 0.15\n");
+    fclose(file);
+
+    ParameterRegistry parameters(filename);
+    remove(filename.c_str());
+    // the first entry wins and the names are case insensitive
+    CHECK(parameters.get("INITIAL_PROFILE", 1) == 9);
+    CHECK(parameters.get("Delta_Tau", 0.1) == 0.005);
+    CHECK(parameters.find("Initial_Distribution_input_filename")
+          == "ipg.dat");
+    // the lines after EndOfData are ignored
+    CHECK(parameters.find("T_freeze") == "empty");
+    CHECK(parameters.get("T_freeze", 0.12) == 0.12);
+    CHECK(!parameters.contains("T_freeze"));
+
+    REQUIRE(parameters.get_unused_parameters().size() == 1);
+    CHECK(parameters.get_unused_parameters()[0] == "not_used");
+
+    parameters.set("Delta_Tau", 0.02);
+    parameters.set("T_freeze", "0.145");
+    CHECK(parameters.get("delta_tau", 0.1) == 0.02);
+    CHECK(parameters.get("T_freeze", 0.12) == 0.145);
+}
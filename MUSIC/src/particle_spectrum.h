@@ -0,0 +1,109 @@
+#ifndef SRC_PARTICLE_SPECTRUM_H_
+#define SRC_PARTICLE_SPECTRUM_H_
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "memory_accounting.h"
+
+//! This class stores the spectrum dN/(dy pT dpT dphi) of one particle
+//! species on its (pseudo-)rapidity, pT, and phi grid. The storage is
+//! sized to the grid of the run with resize() and indexed like the former
+//! fixed size array, spectrum[iy][ipt][iphi].
+class ParticleSpectrum {
+ private:
+    int npt_;
+    int nphi_;
+    std::vector<double> data_;
+    MemoryRegistration memory_;
+
+ public:
+    ParticleSpectrum()
+        : npt_(0), nphi_(0), memory_(MemorySubsystem::cooper_frye) {}
+
+    //! set the grid size and all entries to zero
+    void resize(const int ny, const int npt, const int nphi) {
+        npt_ = npt;
+        nphi_ = nphi;
+        data_.assign(static_cast<size_t>(ny)*npt*nphi, 0.);
+        memory_.set(static_cast<int64_t>(data_.capacity()*sizeof(double)));
+    }
+
+    size_t size() const {return(data_.size());}
+    int get_npt()  const {return(npt_);}
+    int get_nphi() const {return(nphi_);}
+    //! the entries in the order [iy][ipt][iphi]
+    const double *data() const {return(data_.data());}
+
+    //! the pT x phi slice of one rapidity point
+    class Row {
+     private:
+        double *row_;
+        const int nphi_;
+     public:
+        Row(double *row, const int nphi) : row_(row), nphi_(nphi) {}
+        double *operator[](const int ipt) const {
+            return(row_ + static_cast<size_t>(ipt)*nphi_);
+        }
+    };
+    class ConstRow {
+     private:
+        const double *row_;
+        const int nphi_;
+     public:
+        ConstRow(const double *row, const int nphi)
+            : row_(row), nphi_(nphi) {}
+        const double *operator[](const int ipt) const {
+            return(row_ + static_cast<size_t>(ipt)*nphi_);
+        }
+    };
+
+    Row operator[](const int iy) {
+        return(Row(data_.data() + static_cast<size_t>(iy)*npt_*nphi_, nphi_));
+    }
+    ConstRow operator[](const int iy) const {
+        return(ConstRow(data_.data() + static_cast<size_t>(iy)*npt_*nphi_,
+                        nphi_));
+    }
+};
+
+
+namespace SpectrumGrid {
+
+//! This function returns the upper index of the interval of the increasing
+//! grid[0..n-1] that contains x, as the scan
+//!     i = 1; while (x > grid[i] && i < n - 1) i++;
+//! of the resonance decays finds it, starting from the estimate guess of
+//! the (fractional) index instead of from 1. The estimate only has to be
+//! close, the result is corrected to the exact bin on the grid.
+inline int get_upper_index(const double *grid, const int n,
+                           const double x, const double guess) {
+    const int i_max = std::max(1, n - 1);
+    int i = 1;
+    if (guess >= i_max) {
+        i = i_max;
+    } else if (guess > 1.) {
+        i = static_cast<int>(std::ceil(guess));
+    }
+    while (i > 1 && x <= grid[i - 1]) i--;
+    while (i < i_max && x > grid[i]) i++;
+    return(i);
+}
+
+//! the fractional index of x on the uniform grid x_i = x_0 + i*dx
+inline double get_uniform_index(const double x, const double x_0,
+                                const double inv_dx) {
+    return((x - x_0)*inv_dx);
+}
+
+//! the fractional index of x on the quadratic pT grid
+//! x_i = x_0 + (x_max - x_0)*i^2/(n - 1)^2 of the thermal spectra
+inline double get_quadratic_index(const double x, const double x_0,
+                                  const double x_max, const int n) {
+    if (x <= x_0 || x_max <= x_0) return(0.);
+    return(std::sqrt((x - x_0)/(x_max - x_0))*(n - 1));
+}
+
+}  // namespace SpectrumGrid
+
+#endif  // SRC_PARTICLE_SPECTRUM_H_
@@ -0,0 +1,74 @@
+#include "doctest.h"
+#include "particle_spectrum.h"
+#include <cmath>
+#include <vector>
+
+namespace {
+    // the linear scan of the resonance decays
+    int scan_upper_index(const std::vector<double> &grid, const double x) {
+        const int n = static_cast<int>(grid.size());
+        int i = 1;
+        while (x > grid[i] && i < n - 1) i++;
+        return(i);
+    }
+}
+
+TEST_CASE("Check ParticleSpectrum indexing") {
+    ParticleSpectrum spectrum;
+    spectrum.resize(3, 4, 5);
+    CHECK(spectrum.size() == 60);
+    for (int iy = 0; iy < 3; iy++)
+    for (int ipt = 0; ipt < 4; ipt++)
+    for (int iphi = 0; iphi < 5; iphi++) {
+        spectrum[iy][ipt][iphi] = 100*iy + 10*ipt + iphi;
+    }
+    const ParticleSpectrum &const_spectrum = spectrum;
+    CHECK(const_spectrum[2][3][4] == 234.);
+    CHECK(const_spectrum[1][0][2] == 102.);
+    CHECK(&spectrum[1][0][0] - &spectrum[0][0][0] == 20);
+
+    spectrum.resize(2, 2, 2);
+    CHECK(spectrum.size() == 8);
+    CHECK(spectrum[1][1][1] == 0.);
+}
+
+TEST_CASE("Check SpectrumGrid indices against the linear scan") {
+    const int npt = 41;
+    const double pt_min = 0.01;
+    const double pt_max = 3.0;
+    std::vector<double> pt(npt);
+    for (int ipt = 0; ipt < npt; ipt++) {
+        pt[ipt] = pt_min + (pt_max - pt_min)*ipt*ipt/((npt - 1.)*(npt - 1.));
+    }
+    const int ny = 21;
+    const double y_max = 2.5;
+    const double dy = 2.*y_max/(ny - 1);
+    std::vector<double> y(ny);
+    for (int iy = 0; iy < ny; iy++) y[iy] = -y_max + iy*dy;
+
+    for (int i = -20; i <= 1020; i++) {
+        // include the grid points themselves
+        const double ptr = pt_min + (pt_max - pt_min)*i/1000.;
+        CHECK(SpectrumGrid::get_upper_index(
+                pt.data(), npt, ptr,
+                SpectrumGrid::get_quadratic_index(ptr, pt_min, pt_max, npt))
+              == scan_upper_index(pt, ptr));
+        const double yr = 1.2*y_max*(i - 500)/500.;
+        CHECK(SpectrumGrid::get_upper_index(
+                y.data(), ny, yr,
+                SpectrumGrid::get_uniform_index(yr, y[0], 1./dy))
+              == scan_upper_index(y, yr));
+    }
+    for (int ipt = 0; ipt < npt; ipt++) {
+        CHECK(SpectrumGrid::get_upper_index(
+                pt.data(), npt, pt[ipt],
+                SpectrumGrid::get_quadratic_index(pt[ipt], pt_min, pt_max,
+                                                  npt))
+              == scan_upper_index(pt, pt[ipt]));
+    }
+    // a poor estimate still gives the bin
+    CHECK(SpectrumGrid::get_upper_index(y.data(), ny, 0.1, 3.)
+          == scan_upper_index(y, 0.1));
+    CHECK(SpectrumGrid::get_upper_index(y.data(), ny, 0.1, NAN)
+          == scan_upper_index(y, 0.1));
+}
@@ -0,0 +1,162 @@
+// binary cache of the particle and decay tables, see ParticleTableCache
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+
+#include "particle_table_cache.h"
+
+namespace {
+    const char cache_magic[8] = {'M', 'U', 'S', 'I', 'C', 'P', 'D', 'G'};
+    const uint32_t cache_version = 1;
+
+    struct CacheHeader {
+        char     magic[8];
+        uint32_t version;
+        uint32_t number_of_particles;
+        uint32_t number_of_decays;
+        uint32_t particle_record_size;
+        uint32_t decay_record_size;
+        uint32_t reserved;
+        uint64_t signature;
+    };
+
+    //! FNV-1a hash
+    void hash_bytes(uint64_t &hash, const void *data, const std::size_t n) {
+        const unsigned char *bytes = static_cast<const unsigned char*>(data);
+        for (std::size_t i = 0; i < n; i++) {
+            hash ^= bytes[i];
+            hash *= 1099511628211ULL;
+        }
+    }
+}
+
+
+ParticleTableCache::ParticleTableCache() :
+        map_(nullptr), map_size_(0), n_particles_(0), n_decays_(0),
+        particles_(nullptr), decays_(nullptr) {}
+
+
+ParticleTableCache::~ParticleTableCache() {
+    unmap();
+}
+
+
+void ParticleTableCache::unmap() {
+    if (map_ != nullptr) munmap(map_, map_size_);
+    map_ = nullptr;
+    map_size_ = 0;
+    n_particles_ = 0;
+    n_decays_ = 0;
+    particles_ = nullptr;
+    decays_ = nullptr;
+}
+
+
+uint64_t ParticleTableCache::get_signature(
+            const std::vector<std::string> &source_files,
+            const std::vector<double> &parameters) {
+    uint64_t hash = 14695981039346656037ULL;
+    hash_bytes(hash, &cache_version, sizeof(cache_version));
+    for (const auto &filename : source_files) {
+        struct stat file_stat;
+        if (stat(filename.c_str(), &file_stat) != 0) return(0);
+        const int64_t file_size  = static_cast<int64_t>(file_stat.st_size);
+        const int64_t file_mtime = static_cast<int64_t>(file_stat.st_mtime);
+        hash_bytes(hash, filename.data(), filename.size());
+        hash_bytes(hash, &file_size, sizeof(file_size));
+        hash_bytes(hash, &file_mtime, sizeof(file_mtime));
+    }
+    for (const double parameter : parameters) {
+        hash_bytes(hash, &parameter, sizeof(parameter));
+    }
+    return(hash == 0 ? 1 : hash);
+}
+
+
+bool ParticleTableCache::load(const std::string &cache_file,
+                              const uint64_t signature) {
+    unmap();
+    if (signature == 0) return(false);
+
+    const int fd = open(cache_file.c_str(), O_RDONLY);
+    if (fd < 0) return(false);
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0
+            || file_stat.st_size < static_cast<off_t>(sizeof(CacheHeader))) {
+        close(fd);
+        return(false);
+    }
+    const std::size_t file_size = static_cast<std::size_t>(file_stat.st_size);
+    void *mapped = mmap(nullptr, file_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) return(false);
+
+    const char *base = static_cast<const char*>(mapped);
+    CacheHeader header;
+    std::memcpy(&header, base, sizeof(CacheHeader));
+    const bool valid = (
+           std::memcmp(header.magic, cache_magic, 8) == 0
+        && header.version == cache_version
+        && header.signature == signature
+        && header.particle_record_size == sizeof(ParticleRecord)
+        && header.decay_record_size == sizeof(DecayRecord)
+        && file_size == (sizeof(CacheHeader)
+                         + header.number_of_particles*sizeof(ParticleRecord)
+                         + header.number_of_decays*sizeof(DecayRecord)));
+    if (!valid) {
+        munmap(mapped, file_size);
+        return(false);
+    }
+
+    map_ = mapped;
+    map_size_ = file_size;
+    n_particles_ = static_cast<int>(header.number_of_particles);
+    n_decays_ = static_cast<int>(header.number_of_decays);
+    particles_ = reinterpret_cast<const ParticleRecord*>(
+                                                base + sizeof(CacheHeader));
+    decays_ = reinterpret_cast<const DecayRecord*>(
+        base + sizeof(CacheHeader) + n_particles_*sizeof(ParticleRecord));
+    return(true);
+}
+
+
+bool ParticleTableCache::write(const std::string &cache_file,
+                               const uint64_t signature,
+                               const std::vector<ParticleRecord> &particles,
+                               const std::vector<DecayRecord> &decays) {
+    if (signature == 0) return(false);
+
+    std::ostringstream tmp_name;
+    tmp_name << cache_file << ".tmp." << getpid();
+    FILE *out_file = fopen(tmp_name.str().c_str(), "wb");
+    if (out_file == NULL) return(false);
+
+    CacheHeader header;
+    std::memset(&header, 0, sizeof(CacheHeader));
+    std::memcpy(header.magic, cache_magic, 8);
+    header.version              = cache_version;
+    header.number_of_particles  = particles.size();
+    header.number_of_decays     = decays.size();
+    header.particle_record_size = sizeof(ParticleRecord);
+    header.decay_record_size    = sizeof(DecayRecord);
+    header.signature            = signature;
+    bool success = (fwrite(&header, sizeof(CacheHeader), 1, out_file) == 1);
+    success = success && (fwrite(particles.data(), sizeof(ParticleRecord),
+                                 particles.size(), out_file)
+                          == particles.size());
+    success = success && (fwrite(decays.data(), sizeof(DecayRecord),
+                                 decays.size(), out_file) == decays.size());
+    success = (fclose(out_file) == 0) && success;
+
+    if (!success || rename(tmp_name.str().c_str(), cache_file.c_str()) != 0) {
+        remove(tmp_name.str().c_str());
+        return(false);
+    }
+    return(true);
+}
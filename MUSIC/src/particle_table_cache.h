@@ -0,0 +1,84 @@
+#ifndef SRC_PARTICLE_TABLE_CACHE_H_
+#define SRC_PARTICLE_TABLE_CACHE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//! This class is the binary cache of the particle and decay tables of the
+//! Cooper-Frye and the resonance decays, with the chemical potentials of
+//! the partial chemical equilibrium EOS at freeze-out. The cache is keyed
+//! by a signature of the source files and of the parameters the tables
+//! depend on, and it is mapped into memory, so the many afterburner runs
+//! of an ensemble parse the text tables once.
+class ParticleTableCache {
+ public:
+    //! the species part of a Particle
+    struct ParticleRecord {
+        int32_t number;
+        char name[50];
+        double mass;
+        double width;
+        int32_t degeneracy;
+        int32_t baryon;
+        int32_t strange;
+        int32_t charm;
+        int32_t bottom;
+        int32_t isospin;
+        double charge;
+        int32_t decays;
+        int32_t stable;
+        double mu_at_freeze_out;
+    };
+
+    //! a decay channel of the decay table
+    struct DecayRecord {
+        int32_t reso;
+        int32_t numpart;
+        double branch;
+        int32_t part[5];
+    };
+
+ private:
+    void *map_;
+    size_t map_size_;
+    int n_particles_;
+    int n_decays_;
+    const ParticleRecord *particles_;
+    const DecayRecord *decays_;
+
+    void unmap();
+
+ public:
+    ParticleTableCache();
+    ~ParticleTableCache();
+
+    ParticleTableCache(const ParticleTableCache&) = delete;
+    ParticleTableCache& operator=(const ParticleTableCache&) = delete;
+
+    //! the signature of the source files, from their names, sizes and
+    //! modification times, and of the parameters the tables depend on.
+    //! It is 0 if one of the files is missing.
+    static uint64_t get_signature(const std::vector<std::string> &source_files,
+                                  const std::vector<double> &parameters);
+
+    //! maps cache_file, and returns false if it is missing or was written
+    //! with another signature
+    bool load(const std::string &cache_file, const uint64_t signature);
+
+    //! writes the tables to cache_file under a temporary name and renames
+    //! it, so concurrent runs never see a partial cache. It returns false
+    //! if the cache could not be written.
+    static bool write(const std::string &cache_file, const uint64_t signature,
+                      const std::vector<ParticleRecord> &particles,
+                      const std::vector<DecayRecord> &decays);
+
+    int get_number_of_particles() const {return(n_particles_);}
+    int get_number_of_decays() const {return(n_decays_);}
+    //! the records in the mapped file, valid until the cache is destroyed
+    const ParticleRecord *get_particles() const {return(particles_);}
+    const DecayRecord *get_decays() const {return(decays_);}
+};
+
+#endif  // SRC_PARTICLE_TABLE_CACHE_H_
@@ -0,0 +1,59 @@
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include "doctest.h"
+#include "particle_table_cache.h"
+
+TEST_CASE("Check ParticleTableCache writes and maps the tables") {
+    const std::string source_file = "particle_table_cache_unittest.dat";
+    const std::string cache_file = "particle_table_cache_unittest.bin";
+    {
+        std::ofstream source(source_file);
+        source << "211 pi+ 0.13957 0. 1 0 0 0 0 2 1. 1" << std::endl;
+    }
+    const uint64_t signature = ParticleTableCache::get_signature(
+                                                    {source_file}, {2., 3.});
+    CHECK(signature != 0);
+    CHECK(signature != ParticleTableCache::get_signature({source_file},
+                                                         {2., 3.5}));
+    CHECK(ParticleTableCache::get_signature({"not_a_file.dat"}, {2.}) == 0);
+
+    std::vector<ParticleTableCache::ParticleRecord> particles(2);
+    for (int i = 0; i < 2; i++) {
+        std::memset(&particles[i], 0, sizeof(particles[i]));
+        particles[i].number = (i == 0) ? 2212 : -2212;
+        std::strcpy(particles[i].name, (i == 0) ? "p" : "Anti-p");
+        particles[i].mass = 0.938;
+        particles[i].baryon = 1 - 2*i;
+        particles[i].mu_at_freeze_out = 0.1*i;
+    }
+    std::vector<ParticleTableCache::DecayRecord> decays(1);
+    std::memset(&decays[0], 0, sizeof(decays[0]));
+    decays[0].reso = 2212;
+    decays[0].numpart = 1;
+    decays[0].branch = 1.;
+    decays[0].part[0] = 2212;
+    REQUIRE(ParticleTableCache::write(cache_file, signature, particles,
+                                      decays));
+
+    ParticleTableCache cache;
+    REQUIRE(cache.load(cache_file, signature));
+    REQUIRE(cache.get_number_of_particles() == 2);
+    REQUIRE(cache.get_number_of_decays() == 1);
+    CHECK(cache.get_particles()[1].number == -2212);
+    CHECK(std::string(cache.get_particles()[1].name) == "Anti-p");
+    CHECK(cache.get_particles()[1].baryon == -1);
+    CHECK(cache.get_particles()[1].mu_at_freeze_out == 0.1);
+    CHECK(cache.get_particles()[0].mass == 0.938);
+    CHECK(cache.get_decays()[0].part[0] == 2212);
+    CHECK(cache.get_decays()[0].branch == 1.);
+
+    // a cache of other source files or parameters is not used
+    ParticleTableCache other;
+    CHECK(!other.load(cache_file, signature + 1));
+    CHECK(other.get_number_of_particles() == 0);
+    CHECK(!other.load("not_a_cache.bin", signature));
+
+    remove(source_file.c_str());
+    remove(cache_file.c_str());
+}
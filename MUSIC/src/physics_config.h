@@ -0,0 +1,43 @@
+#ifndef SRC_PHYSICS_CONFIG_H_
+#define SRC_PHYSICS_CONFIG_H_
+
+#include "data.h"
+
+//! The physics options of the per-cell kernels of Advance as a compile-time
+//! bitset. The flags are constant during a run, so Advance picks the kernel
+//! compiled for them once, and their branches fold away in the inner loop.
+namespace PhysicsConfig {
+
+enum Flag : unsigned {
+    kViscous = 1u << 0,     //!< viscosity_flag
+    kShear   = 1u << 1,     //!< turn_on_shear
+    kBulk    = 1u << 2,     //!< turn_on_bulk
+    kDiff    = 1u << 3,     //!< turn_on_diff
+    kSource  = 1u << 4,     //!< hydro source terms
+};
+
+//! number of configurations, the size of the dispatch tables
+constexpr unsigned kNumConfigs = 1u << 5;
+
+//! the dissipative currents are only evolved in viscous runs, so all the
+//! configurations without kViscous share the ideal kernel
+constexpr unsigned canonical(const unsigned config) {
+    return((config & kViscous) ? config
+                               : (config & ~(kShear | kBulk | kDiff)));
+}
+
+//! the configuration of the run
+inline unsigned get_config(const InitData &DATA,
+                           const bool add_hydro_source) {
+    unsigned config = 0;
+    if (DATA.viscosity_flag == 1) config |= kViscous;
+    if (DATA.turn_on_shear == 1)  config |= kShear;
+    if (DATA.turn_on_bulk == 1)   config |= kBulk;
+    if (DATA.turn_on_diff == 1)   config |= kDiff;
+    if (add_hydro_source)         config |= kSource;
+    return(canonical(config));
+}
+
+}  // namespace PhysicsConfig
+
+#endif  // SRC_PHYSICS_CONFIG_H_
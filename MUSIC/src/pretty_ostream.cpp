@@ -9,8 +9,6 @@
 #include "pretty_ostream.h"
 #include "emoji.h"
 
-using std::cout;
-using std::endl;
 using std::string;
 
 pretty_ostream::pretty_ostream() {}
@@ -34,31 +32,55 @@ void pretty_ostream::flush(string type) {
     message_stream.clear();
 }
 
+
+void pretty_ostream::flush(string type, LogSite &site) {
+    std::transform(type.begin(), type.end(), type.begin(), ::tolower);
+    const LogLevel level = (type == "error"   ? LogLevel::error
+                          : type == "warning" ? LogLevel::warning
+                          : type == "debug"   ? LogLevel::debug
+                          : LogLevel::info);
+    if (!AsyncLog::is_enabled(level) || !AsyncLog::allow(site)) {
+        message_stream.str("");
+        message_stream.clear();
+        return;
+    }
+    flush(type);
+}
+
 //! This function output information message
 void pretty_ostream::info(string message) {
-    //cout << "[Info] " << get_memory_usage() << " " << message << endl;
-    cout << emoji::music_note() << " " << get_memory_usage() << " "
-         << message << endl;
+    if (!AsyncLog::is_enabled(LogLevel::info)) return;
+    std::ostringstream line;
+    line << emoji::music_note() << " " << get_memory_usage() << " "
+         << message;
+    AsyncLog::post(LogLevel::info, line.str());
 }
 
 
 //! This function output debug message
 void pretty_ostream::debug(string message) {
-    cout << CYAN << emoji::debug() << " " << get_memory_usage() << " "
-         << message << RESET << endl;
+    if (!AsyncLog::is_enabled(LogLevel::debug)) return;
+    std::ostringstream line;
+    line << CYAN << emoji::debug() << " " << get_memory_usage() << " "
+         << message << RESET;
+    AsyncLog::post(LogLevel::debug, line.str());
 }
 
 
 //! This function output warning message
 void pretty_ostream::warning(string message) {
-    cout << BOLD << YELLOW << emoji::warning() << " " << message
-         << RESET << endl;
+    if (!AsyncLog::is_enabled(LogLevel::warning)) return;
+    std::ostringstream line;
+    line << BOLD << YELLOW << emoji::warning() << " " << message << RESET;
+    AsyncLog::post(LogLevel::warning, line.str());
 }
 
 
 //! This function output error message
 void pretty_ostream::error(string message) {
-    cout << BOLD << RED << emoji::error() << " " << message << RESET << endl;
+    std::ostringstream line;
+    line << BOLD << RED << emoji::error() << " " << message << RESET;
+    AsyncLog::post(LogLevel::error, line.str());
 }
 
 //! This function returns a string for the memory usage
@@ -18,7 +18,10 @@
 #include <iostream>
 #include <sstream>
 #include <string>
+#include "async_log.h"
 
+//! The messages are written by AsyncLog, which filters them by severity
+//! and keeps the threads of the parallel regions off the stream lock.
 class pretty_ostream {
  private:
     std::ostringstream message_stream;
@@ -29,6 +32,10 @@ class pretty_ostream {
 
     void flush(std::string type);
 
+    //! flushes the message of a site which can print it for many cells,
+    //! rate limited by AsyncLog::allow
+    void flush(std::string type, LogSite &site);
+
     //! This function output information message
     void info(std::string message);
 
@@ -2,7 +2,10 @@
 #include <iostream>
 #include <cstring>
 #include "read_in_parameters.h"
+#include "eta_grid.h"
 #include "util.h"
+#include "parameter_registry.h"
+#include "chunked_evolution_file.h"
 
 using namespace std;
 
@@ -11,6 +14,12 @@ namespace ReadInParameters {
 pretty_ostream music_message;
 
 InitData read_in_parameters(std::string input_file) {
+    ParameterRegistry parameters(input_file);
+    return(read_in_parameters(parameters));
+}
+
+
+InitData read_in_parameters(ParameterRegistry &parameters) {
     InitData parameter_list;
 
     // this function reads in parameters
@@ -19,40 +28,40 @@ InitData read_in_parameters(std::string input_file) {
     // echo_level controls the mount of
     // warning message output during the evolution
     double temp_echo_level = 9;
-    tempinput = Util::StringFind4(input_file, "echo_level");
+    tempinput = parameters.find("echo_level");
     if(tempinput != "empty") istringstream ( tempinput ) >> temp_echo_level;
     parameter_list.echo_level = temp_echo_level;
 
     // Initial_profile:
     int tempInitial_profile = 1;
-    tempinput = Util::StringFind4(input_file, "Initial_profile");
+    tempinput = parameters.find("Initial_profile");
     if (tempinput != "empty") istringstream(tempinput) >> tempInitial_profile;
     parameter_list.Initial_profile = tempInitial_profile;
 
     // Initial_profile:
     int temp_string_dump_mode = 1;
-    tempinput = Util::StringFind4(input_file, "string_dump_mode");
+    tempinput = parameters.find("string_dump_mode");
     if (tempinput != "empty")
         istringstream(tempinput) >> temp_string_dump_mode;
     parameter_list.string_dump_mode = temp_string_dump_mode;
 
     // hydro source
     double temp_string_quench_factor = 0.;
-    tempinput = Util::StringFind4(input_file, "string_quench_factor");
+    tempinput = parameters.find("string_quench_factor");
     if (tempinput != "empty")
         istringstream(tempinput) >> temp_string_quench_factor;
     parameter_list.string_quench_factor = temp_string_quench_factor;
 
     // hydro source
     double temp_parton_quench_factor = 1.;
-    tempinput = Util::StringFind4(input_file, "parton_quench_factor");
+    tempinput = parameters.find("parton_quench_factor");
     if (tempinput != "empty")
         istringstream(tempinput) >> temp_parton_quench_factor;
     parameter_list.parton_quench_factor = temp_parton_quench_factor;
 
     // boost-invariant
     int temp_boost_invariant = 1;
-    tempinput = Util::StringFind4(input_file, "boost_invariant");
+    tempinput = parameters.find("boost_invariant");
     if (tempinput != "empty")
         istringstream(tempinput) >> temp_boost_invariant;
     if (temp_boost_invariant == 0) {
@@ -61,9 +70,118 @@ InitData read_in_parameters(std::string input_file) {
         parameter_list.boost_invariant = true;
     }
 
+    // eta_boundary_condition: 0 outflow, 1 periodic
+    int temp_eta_boundary_condition = 0;
+    tempinput = parameters.find("eta_boundary_condition");
+    if (tempinput != "empty")
+        istringstream(tempinput) >> temp_eta_boundary_condition;
+    parameter_list.eta_boundary_condition = temp_eta_boundary_condition;
+
+    // fused_rk_stage: 1 fused stage kernel, 0 separate sweeps
+    int temp_fused_rk_stage = 1;
+    tempinput = parameters.find("fused_rk_stage");
+    if (tempinput != "empty")
+        istringstream(tempinput) >> temp_fused_rk_stage;
+    parameter_list.fused_rk_stage = temp_fused_rk_stage;
+
+    // reconst_batch: 1 batched half-way cell reconstruction, 0 one by one
+    int temp_reconst_batch = 1;
+    tempinput = parameters.find("reconst_batch");
+    if (tempinput != "empty")
+        istringstream(tempinput) >> temp_reconst_batch;
+    parameter_list.reconst_batch = temp_reconst_batch;
+
+    // face_flux: 1 one KT flux per face, 0 per cell
+    int temp_face_flux = 1;
+    tempinput = parameters.find("face_flux");
+    if (tempinput != "empty")
+        istringstream(tempinput) >> temp_face_flux;
+    parameter_list.face_flux = temp_face_flux;
+
+    // slope_limiter: limiter of the face fluxes, 0 minmod, 1 monotonized
+    // central, 2 van Leer
+    int temp_slope_limiter = 0;
+    tempinput = parameters.find("slope_limiter");
+    if (tempinput != "empty")
+        istringstream(tempinput) >> temp_slope_limiter;
+    parameter_list.slope_limiter = temp_slope_limiter;
+
+    // source_deposition: 1 source terms deposited once per stage,
+    // 0 evaluated by every cell
+    int temp_source_deposition = 1;
+    tempinput = parameters.find("source_deposition");
+    if (tempinput != "empty")
+        istringstream(tempinput) >> temp_source_deposition;
+    parameter_list.source_deposition = temp_source_deposition;
+
+    // u_derivative_rows: 1 velocity gradients computed a row at a time
+    // before the sweep, 0 computed by every cell
+    int temp_u_derivative_rows = 0;
+    tempinput = parameters.find("u_derivative_rows");
+    if (tempinput != "empty")
+        istringstream(tempinput) >> temp_u_derivative_rows;
+    parameter_list.u_derivative_rows = temp_u_derivative_rows;
+
+    // grid_traversal: 3 tiles scheduled by cost, 2 static (eta, y) rows,
+    // 1 tiled, 0 collapsed (eta, x, y) loop in AdvanceIt
+    int temp_grid_traversal = 1;
+    tempinput = parameters.find("grid_traversal");
+    if (tempinput != "empty")
+        istringstream(tempinput) >> temp_grid_traversal;
+    parameter_list.grid_traversal = temp_grid_traversal;
+
+    // persistent_parallel_region: 1 the Runge-Kutta stages of a time step
+    // in one parallel region, 0 a parallel region per grid loop
+    int temp_persistent_parallel_region = 1;
+    tempinput = parameters.find("persistent_parallel_region");
+    if (tempinput != "empty")
+        istringstream(tempinput) >> temp_persistent_parallel_region;
+    parameter_list.persistent_parallel_region = (
+                                        temp_persistent_parallel_region);
+
+    // grid_first_touch: 1 the cells of the grids are constructed by the
+    // threads which update them (NUMA first touch), 0 by the master thread
+    int temp_grid_first_touch = 1;
+    tempinput = parameters.find("grid_first_touch");
+    if (tempinput != "empty")
+        istringstream(tempinput) >> temp_grid_first_touch;
+    parameter_list.grid_first_touch = temp_grid_first_touch;
+
+    // grid_huge_pages: 1 the grids are backed by transparent huge pages
+    int temp_grid_huge_pages = 0;
+    tempinput = parameters.find("grid_huge_pages");
+    if (tempinput != "empty")
+        istringstream(tempinput) >> temp_grid_huge_pages;
+    parameter_list.grid_huge_pages = temp_grid_huge_pages;
+
+    // grid_tile_size_x, grid_tile_size_y, grid_tile_size_eta:
+    // tile shape of the tiled loops (0: automatic)
+    int temp_grid_tile_size_x = 0;
+    tempinput = parameters.find("grid_tile_size_x");
+    if (tempinput != "empty")
+        istringstream(tempinput) >> temp_grid_tile_size_x;
+    parameter_list.grid_tile_size_x = temp_grid_tile_size_x;
+    int temp_grid_tile_size_y = 0;
+    tempinput = parameters.find("grid_tile_size_y");
+    if (tempinput != "empty")
+        istringstream(tempinput) >> temp_grid_tile_size_y;
+    parameter_list.grid_tile_size_y = temp_grid_tile_size_y;
+    int temp_grid_tile_size_eta = 0;
+    tempinput = parameters.find("grid_tile_size_eta");
+    if (tempinput != "empty")
+        istringstream(tempinput) >> temp_grid_tile_size_eta;
+    parameter_list.grid_tile_size_eta = temp_grid_tile_size_eta;
+
+    // active_region_epsilon: vacuum energy density in GeV/fm^3, only the
+    // cells around the fluid above it are evolved (0: whole grid)
+    double temp_active_region_epsilon = 0.0;
+    tempinput = parameters.find("active_region_epsilon");
+    if (tempinput != "empty")
+        istringstream(tempinput) >> temp_active_region_epsilon;
+    parameter_list.active_region_epsilon = temp_active_region_epsilon;
+
     int temp_output_initial_profile = 0;
-    tempinput = Util::StringFind4(input_file,
-                                  "output_initial_density_profiles");
+    tempinput = parameters.find("output_initial_density_profiles");
     if (tempinput != "empty")
         istringstream(tempinput) >> temp_output_initial_profile;
     parameter_list.output_initial_density_profiles =
@@ -71,7 +189,7 @@ InitData read_in_parameters(std::string input_file) {
 
     // eta envelope function parameter for rhob
     int temp_rhob_flag = 1;
-    tempinput = Util::StringFind4(input_file, "initial_eta_rhob_profile");
+    tempinput = parameters.find("initial_eta_rhob_profile");
     if (tempinput != "empty")
         istringstream(tempinput) >> temp_rhob_flag;
     parameter_list.initial_eta_rhob_profile = temp_rhob_flag;
@@ -80,7 +198,7 @@ InitData read_in_parameters(std::string input_file) {
     //0: scale with energy density
     //1: scale with entropy density
     int tempinitializeEntropy = 0;
-    tempinput = Util::StringFind4(input_file, "initialize_with_entropy");
+    tempinput = parameters.find("initialize_with_entropy");
     if (tempinput != "empty")
         istringstream(tempinput) >> tempinitializeEntropy;
     parameter_list.initializeEntropy = tempinitializeEntropy;
@@ -90,7 +208,7 @@ InitData read_in_parameters(std::string input_file) {
     // 1: freeze out at constant energy density epsilon_freeze
     // if set in input input_file, overide above defaults
     int tempuseEpsFO = 1;
-    tempinput = Util::StringFind4(input_file, "use_eps_for_freeze_out");
+    tempinput = parameters.find("use_eps_for_freeze_out");
     if (tempinput != "empty")
         istringstream(tempinput) >> tempuseEpsFO;
     parameter_list.useEpsFO = tempuseEpsFO;
@@ -99,7 +217,7 @@ InitData read_in_parameters(std::string input_file) {
     // only used with use_eps_for_freeze_out = 0
     double tempTFO = 0.12;
     if (parameter_list.useEpsFO == 0) {
-        tempinput = Util::StringFind4(input_file, "T_freeze");
+        tempinput = parameters.find("T_freeze");
         if (tempinput != "empty") {
             istringstream(tempinput) >> tempTFO;
         } else {
@@ -112,45 +230,45 @@ InitData read_in_parameters(std::string input_file) {
         // epsilon_freeze: freeze-out energy density in GeV/fm^3
         // only used with use_eps_for_freeze_out = 1
         double tempepsilonFreeze = 0.12;
-        tempinput = Util::StringFind4(input_file, "epsilon_freeze");
+        tempinput = parameters.find("epsilon_freeze");
         if (tempinput != "empty") {
             istringstream(tempinput) >> tempepsilonFreeze;
         }
         parameter_list.epsilonFreeze = tempepsilonFreeze;
 
         int temp_N_freeze_out = 1;
-        tempinput = Util::StringFind4(input_file, "N_freeze_out");
+        tempinput = parameters.find("N_freeze_out");
         if (tempinput != "empty")
             istringstream(tempinput) >> temp_N_freeze_out;
         parameter_list.N_freeze_out = temp_N_freeze_out;
     }
 
     string temp_freeze_list_filename = "eps_freeze_list_s95p_v1.dat";
-    tempinput = Util::StringFind4(input_file, "freeze_list_filename");
+    tempinput = parameters.find("freeze_list_filename");
     if (tempinput != "empty")
         temp_freeze_list_filename.assign(tempinput);
     parameter_list.freeze_list_filename.assign(temp_freeze_list_filename);
 
     double temp_eps_freeze_max = 0.18;
-    tempinput = Util::StringFind4(input_file, "eps_freeze_max");
+    tempinput = parameters.find("eps_freeze_max");
     if (tempinput != "empty")
         istringstream(tempinput) >> temp_eps_freeze_max;
     parameter_list.eps_freeze_max = temp_eps_freeze_max;
 
     double temp_eps_freeze_min = 0.18;
-    tempinput = Util::StringFind4(input_file, "eps_freeze_min");
+    tempinput = parameters.find("eps_freeze_min");
     if (tempinput != "empty")
         istringstream(tempinput) >> temp_eps_freeze_min;
     parameter_list.eps_freeze_min = temp_eps_freeze_min;
 
     int temp_freeze_eps_flag = 0;
-    tempinput = Util::StringFind4(input_file, "freeze_eps_flag");
+    tempinput = parameters.find("freeze_eps_flag");
     if (tempinput != "empty")
         istringstream (tempinput) >> temp_freeze_eps_flag;
     parameter_list.freeze_eps_flag = temp_freeze_eps_flag;
 
     int temp_freeze_surface_binary = 1;
-    tempinput = Util::StringFind4(input_file, "freeze_surface_in_binary");
+    tempinput = parameters.find("freeze_surface_in_binary");
     if (tempinput != "empty")
         istringstream(tempinput) >> temp_freeze_surface_binary;
     if (temp_freeze_surface_binary == 0) {
@@ -159,15 +277,130 @@ InitData read_in_parameters(std::string input_file) {
         parameter_list.freeze_surface_in_binary = true;
     }
 
+    // freeze_surface_single_file:
+    // 0: every thread appends to its own surface_eps_*_<thread>.dat
+    // 1: the surface elements are kept in memory and written once as
+    //    surface_eps_*.dat with a header (needs freeze_surface_in_binary)
+    int temp_freeze_surface_single_file = 0;
+    tempinput = parameters.find("freeze_surface_single_file");
+    if (tempinput != "empty")
+        istringstream(tempinput) >> temp_freeze_surface_single_file;
+    parameter_list.freeze_surface_single_file =
+                                        temp_freeze_surface_single_file;
+
+    // freeze_out_pipeline:
+    // 0: the freeze-out surface of a step is found before the next step
+    // n > 0: the surface is found by n threads of their own, while the
+    //        evolution advances the next steps
+    int temp_freeze_out_pipeline = 0;
+    tempinput = parameters.find("freeze_out_pipeline");
+    if (tempinput != "empty")
+        istringstream(tempinput) >> temp_freeze_out_pipeline;
+    parameter_list.freeze_out_pipeline = temp_freeze_out_pipeline;
+
+    // cooper_frye_streaming:
+    // 0: the thermal spectra are computed from the surface after the hydro
+    // n > 0: n threads of their own compute the thermal spectra from the
+    //        surface of every freeze-out step while the hydro runs, the
+    //        surface of the first isotherm is neither kept nor written
+    int temp_cooper_frye_streaming = 0;
+    tempinput = parameters.find("cooper_frye_streaming");
+    if (tempinput != "empty")
+        istringstream(tempinput) >> temp_cooper_frye_streaming;
+    parameter_list.cooper_frye_streaming = temp_cooper_frye_streaming;
+
+    // surface_coarsening_factor:
+    // 0: Cooper-Frye sums over the elements of the freeze-out surface
+    // n > 0: the elements with similar fields in the blocks of n
+    //        freeze-out cells per direction are merged into one
+    int temp_surface_coarsening_factor = 0;
+    tempinput = parameters.find("surface_coarsening_factor");
+    if (tempinput != "empty")
+        istringstream(tempinput) >> temp_surface_coarsening_factor;
+    parameter_list.surface_coarsening_factor = (
+                                            temp_surface_coarsening_factor);
+
+    // the tolerances of the merged elements: the largest difference of
+    // u^mu, of T relative to T, of mu_B relative to T, and of W^{mu nu}
+    // relative to e + P
+    double temp_surface_coarsening_u_tolerance = 0.02;
+    tempinput = parameters.find("surface_coarsening_u_tolerance");
+    if (tempinput != "empty")
+        istringstream(tempinput) >> temp_surface_coarsening_u_tolerance;
+    parameter_list.surface_coarsening_u_tolerance = (
+                                    temp_surface_coarsening_u_tolerance);
+
+    double temp_surface_coarsening_T_tolerance = 0.005;
+    tempinput = parameters.find("surface_coarsening_T_tolerance");
+    if (tempinput != "empty")
+        istringstream(tempinput) >> temp_surface_coarsening_T_tolerance;
+    parameter_list.surface_coarsening_T_tolerance = (
+                                    temp_surface_coarsening_T_tolerance);
+
+    double temp_surface_coarsening_muB_tolerance = 0.01;
+    tempinput = parameters.find("surface_coarsening_muB_tolerance");
+    if (tempinput != "empty")
+        istringstream(tempinput) >> temp_surface_coarsening_muB_tolerance;
+    parameter_list.surface_coarsening_muB_tolerance = (
+                                    temp_surface_coarsening_muB_tolerance);
+
+    double temp_surface_coarsening_W_tolerance = 0.02;
+    tempinput = parameters.find("surface_coarsening_W_tolerance");
+    if (tempinput != "empty")
+        istringstream(tempinput) >> temp_surface_coarsening_W_tolerance;
+    parameter_list.surface_coarsening_W_tolerance = (
+                                    temp_surface_coarsening_W_tolerance);
+
+    // surface_coarsening_check:
+    // 1: the first species are computed with the full surface too and the
+    //    deviation of their spectra on the coarse surface is reported
+    int temp_surface_coarsening_check = 0;
+    tempinput = parameters.find("surface_coarsening_check");
+    if (tempinput != "empty")
+        istringstream(tempinput) >> temp_surface_coarsening_check;
+    parameter_list.surface_coarsening_check = temp_surface_coarsening_check;
+
     //particle_spectrum_to_compute:
     // 0: Do all up to number_of_particles_to_include
     // any natural number: Do the particle with this (internal) ID
     int tempparticleSpectrumNumber = 0;
-    tempinput = Util::StringFind4(input_file, "particle_spectrum_to_compute");
+    tempinput = parameters.find("particle_spectrum_to_compute");
     if (tempinput != "empty")
         istringstream(tempinput) >> tempparticleSpectrumNumber;
     parameter_list.particleSpectrumNumber = tempparticleSpectrumNumber;
 
+    // output_spectra_files:
+    // 0: in mode 1 the spectra of all the species are handed to the
+    //    resonance decays and the observables in memory, without
+    //    yptphiSpectra.dat and FyptphiSpectra.dat
+    // 1: the spectra files are written (e.g. for a later run of mode 4,
+    //    13 or 14), as they always are in the other modes
+    int temp_output_spectra_files = 0;
+    tempinput = parameters.find("output_spectra_files");
+    if (tempinput != "empty")
+        istringstream(tempinput) >> temp_output_spectra_files;
+    parameter_list.output_spectra_files = temp_output_spectra_files;
+
+    // number_of_sampled_events:
+    // the number of events of hadrons sampled from the freeze-out surface
+    // (in the modes that compute the thermal spectra) and written to
+    // sampled_particles.dat in the OSCAR2013 format for hadronic transport
+    // 0: no sampling
+    int temp_number_of_sampled_events = 0;
+    tempinput = parameters.find("number_of_sampled_events");
+    if (tempinput != "empty")
+        istringstream(tempinput) >> temp_number_of_sampled_events;
+    parameter_list.number_of_sampled_events = temp_number_of_sampled_events;
+
+    // hadron_sampler_seed:
+    // the seed of the random streams of the sampled events, the events
+    // are the same for any number of threads
+    int temp_hadron_sampler_seed = 1;
+    tempinput = parameters.find("hadron_sampler_seed");
+    if (tempinput != "empty")
+        istringstream(tempinput) >> temp_hadron_sampler_seed;
+    parameter_list.hadron_sampler_seed = temp_hadron_sampler_seed;
+
     // mode: 
     // 1: Does everything. Evolution. Computation of thermal spectra.
     //    Resonance decays. Observables.
@@ -176,8 +409,10 @@ InitData read_in_parameters(std::string input_file) {
     // 4: Resonance decays only.
     // 13: Compute observables from previously-computed thermal spectra
     // 14: Compute observables from post-decay spectra
+    // 9: Auto-tune the runtime knobs of the time steps on the initial
+    //    grid and write the auto-tune profile (see AutoTuner)
     int tempmode = 1;
-    tempinput = Util::StringFind4(input_file, "mode");
+    tempinput = parameters.find("mode");
     if (tempinput != "empty") {
         istringstream(tempinput) >> tempmode;
     } else {
@@ -191,12 +426,179 @@ InitData read_in_parameters(std::string input_file) {
     // 1: questrevert with necessary causality conditions
     // 2: questrevert with sufficient causality conditions
     int tempcausalitymode = 2;
-    tempinput = Util::StringFind4(input_file, "causality_method");
+    tempinput = parameters.find("causality_method");
     if (tempinput != "empty") {
         istringstream(tempinput) >> tempcausalitymode;
     }
     parameter_list.causality_method = tempcausalitymode;
 
+    // Wmunu_eigenvalue_solver:
+    // 0: general 4x4 eigenvalue solver
+    // 1: analytic solution of the 3x3 problem in the local rest frame
+    // 2: Eigen's self-adjoint solver for the 3x3 problem
+    //    in the local rest frame
+    int temp_Wmunu_eigenvalue_solver = 1;
+    tempinput = parameters.find("Wmunu_eigenvalue_solver");
+    if (tempinput != "empty")
+        istringstream(tempinput) >> temp_Wmunu_eigenvalue_solver;
+    parameter_list.Wmunu_eigenvalue_solver = temp_Wmunu_eigenvalue_solver;
+
+    // causality_root_tolerance:
+    // absolute tolerance on the reduction factor beta for the
+    // nonlinear sufficient causality conditions
+    double temp_causality_root_tolerance = 1e-6;
+    tempinput = parameters.find("causality_root_tolerance");
+    if (tempinput != "empty")
+        istringstream(tempinput) >> temp_causality_root_tolerance;
+    parameter_list.causality_root_tolerance = temp_causality_root_tolerance;
+
+    // causality_diagnostics_stride:
+    // record the causality reduction factors of every n-th cell in
+    // x, y, and eta (0: no output)
+    int temp_causality_diagnostics_stride = 1;
+    tempinput = parameters.find("causality_diagnostics_stride");
+    if (tempinput != "empty")
+        istringstream(tempinput) >> temp_causality_diagnostics_stride;
+    parameter_list.causality_diagnostics_stride =
+                                        temp_causality_diagnostics_stride;
+
+    // causality_prescreen:
+    // skip the causality constraints of the cells whose eigenvalues of
+    // pi^mu_nu and bulk pressure over (e + P) are below the bound which
+    // guarantees all the conditions (1: on, 0: off)
+    int temp_causality_prescreen = 1;
+    tempinput = parameters.find("causality_prescreen");
+    if (tempinput != "empty")
+        istringstream(tempinput) >> temp_causality_prescreen;
+    parameter_list.causality_prescreen = temp_causality_prescreen;
+
+    // causality_statistics:
+    // write the histograms of the causality reduction factors vs eps and
+    // tau and the fractions of the violating cells (1: on, 0: off)
+    int temp_causality_statistics = 0;
+    tempinput = parameters.find("causality_statistics");
+    if (tempinput != "empty")
+        istringstream(tempinput) >> temp_causality_statistics;
+    parameter_list.causality_statistics = temp_causality_statistics;
+
+    // causality_sample_size:
+    // the number of records of the reservoir sample of the causality
+    // statistics per time step (0: no sample)
+    int temp_causality_sample_size = 0;
+    tempinput = parameters.find("causality_sample_size");
+    if (tempinput != "empty")
+        istringstream(tempinput) >> temp_causality_sample_size;
+    parameter_list.causality_sample_size = temp_causality_sample_size;
+
+    // checkpoint_every_N_timesteps:
+    // write a checkpoint of the evolution to checkpoint_filename every
+    // N time steps (0: no checkpoints)
+    int temp_checkpoint_every_N_timesteps = 0;
+    tempinput = parameters.find("checkpoint_every_N_timesteps");
+    if (tempinput != "empty")
+        istringstream(tempinput) >> temp_checkpoint_every_N_timesteps;
+    parameter_list.checkpoint_every_N_timesteps =
+                                        temp_checkpoint_every_N_timesteps;
+
+    string temp_checkpoint_filename = "music_checkpoint.bin";
+    tempinput = parameters.find("checkpoint_filename");
+    if (tempinput != "empty")
+        temp_checkpoint_filename.assign(tempinput);
+    parameter_list.checkpoint_filename.assign(temp_checkpoint_filename);
+
+    // restart_from_checkpoint:
+    // 1: continue the evolution from checkpoint_filename, with the input
+    //    file of the interrupted run
+    int temp_restart_from_checkpoint = 0;
+    tempinput = parameters.find("restart_from_checkpoint");
+    if (tempinput != "empty")
+        istringstream(tempinput) >> temp_restart_from_checkpoint;
+    parameter_list.restart_from_checkpoint = temp_restart_from_checkpoint;
+
+    // instrumentation:
+    // 0: off
+    // 1: time the stages of the run and count the solver events,
+    //    a summary table is printed at the end of the run
+    // 2: 1 and one JSON line per time step in instrumentation_filename
+    int temp_instrumentation = 0;
+    tempinput = parameters.find("instrumentation");
+    if (tempinput != "empty")
+        istringstream(tempinput) >> temp_instrumentation;
+    parameter_list.instrumentation = temp_instrumentation;
+
+    string temp_instrumentation_filename = "music_instrumentation.jsonl";
+    tempinput = parameters.find("instrumentation_filename");
+    if (tempinput != "empty")
+        temp_instrumentation_filename.assign(tempinput);
+    parameter_list.instrumentation_filename.assign(
+                                        temp_instrumentation_filename);
+
+    // memory_budget_MB: the estimate of the memory of the run is fitted
+    // into this budget by switching off the optional copies, and the
+    // memory by subsystem is printed at the end (0: no budget)
+    double temp_memory_budget_MB = 0.;
+    tempinput = parameters.find("memory_budget_MB");
+    if (tempinput != "empty")
+        istringstream(tempinput) >> temp_memory_budget_MB;
+    parameter_list.memory_budget_MB = temp_memory_budget_MB;
+
+    // omp_num_threads: the number of OpenMP threads of the run
+    // (0: the default of the OpenMP runtime, e.g. OMP_NUM_THREADS)
+    int temp_omp_num_threads = 0;
+    tempinput = parameters.find("omp_num_threads");
+    if (tempinput != "empty")
+        istringstream(tempinput) >> temp_omp_num_threads;
+    parameter_list.omp_num_threads = temp_omp_num_threads;
+
+    // autotune_steps: the time steps of every configuration of the
+    // auto-tune mode 9, the first one is not timed
+    int temp_autotune_steps = 4;
+    tempinput = parameters.find("autotune_steps");
+    if (tempinput != "empty")
+        istringstream(tempinput) >> temp_autotune_steps;
+    parameter_list.autotune_steps = temp_autotune_steps;
+
+    // autotune_tolerance: the largest difference of the grid after the
+    // steps of a configuration from the one of the input configuration
+    // (see AutoTuner::get_difference)
+    double temp_autotune_tolerance = 1e-10;
+    tempinput = parameters.find("autotune_tolerance");
+    if (tempinput != "empty")
+        istringstream(tempinput) >> temp_autotune_tolerance;
+    parameter_list.autotune_tolerance = temp_autotune_tolerance;
+
+    // autotune_load_profile: 1 the runtime knobs which the input file does
+    // not set are taken from the auto-tune profile if it exists, 0 not
+    int temp_autotune_load_profile = 1;
+    tempinput = parameters.find("autotune_load_profile");
+    if (tempinput != "empty")
+        istringstream(tempinput) >> temp_autotune_load_profile;
+    parameter_list.autotune_load_profile = temp_autotune_load_profile;
+
+    // autotune_profile: the auto-tune profile
+    // (default: music_autotune_<host name>.dat)
+    string temp_autotune_profile = "";
+    tempinput = parameters.find("autotune_profile");
+    if (tempinput != "empty")
+        temp_autotune_profile.assign(tempinput);
+    parameter_list.autotune_profile.assign(temp_autotune_profile);
+
+    // log_level: the lowest severity of the messages written,
+    // 0 debug, 1 info, 2 warning, 3 error
+    int temp_log_level = 0;
+    tempinput = parameters.find("log_level");
+    if (tempinput != "empty")
+        istringstream(tempinput) >> temp_log_level;
+    parameter_list.log_level = temp_log_level;
+
+    // log_rate_limit: the messages per second of a site printing for
+    // many cells before the others are suppressed (0: no limit)
+    int temp_log_rate_limit = 10;
+    tempinput = parameters.find("log_rate_limit");
+    if (tempinput != "empty")
+        istringstream(tempinput) >> temp_log_rate_limit;
+    parameter_list.log_rate_limit = temp_log_rate_limit;
+
 
 
     //EOS_to_use:
@@ -214,7 +616,7 @@ InitData read_in_parameters(std::string input_file) {
     // 11: finite muB EOS from Pasi
     // 12: finite muB EOS from A. Monnai (up to mu_B^6)
     int tempwhichEOS = 2;
-    tempinput = Util::StringFind4(input_file, "EOS_to_use");
+    tempinput = parameters.find("EOS_to_use");
     if (tempinput != "empty")
         istringstream(tempinput) >> tempwhichEOS;
     parameter_list.whichEOS = tempwhichEOS;
@@ -224,8 +626,7 @@ InitData read_in_parameters(std::string input_file) {
     // should be computed (mode=3) or resonances should be included (mode=4)
     // current maximum = 319
     int tempNumberOfParticlesToInclude = 2;
-    tempinput = Util::StringFind4(input_file,
-                                  "number_of_particles_to_include");
+    tempinput = parameters.find("number_of_particles_to_include");
     if (tempinput != "empty")
         istringstream(tempinput) >> tempNumberOfParticlesToInclude;
     parameter_list.NumberOfParticlesToInclude = tempNumberOfParticlesToInclude;
@@ -233,7 +634,7 @@ InitData read_in_parameters(std::string input_file) {
     // freeze_out_method:
     // 2: Schenke's more complex method
     int tempfreezeOutMethod = 4;
-    tempinput = Util::StringFind4(input_file, "freeze_out_method");
+    tempinput = parameters.find("freeze_out_method");
     if (tempinput != "empty")
         istringstream(tempinput) >> tempfreezeOutMethod;
     parameter_list.freezeOutMethod = tempfreezeOutMethod;
@@ -241,21 +642,20 @@ InitData read_in_parameters(std::string input_file) {
     // average_surface_over_this_many_time_steps:
     // Only save every N timesteps for finding freeze out surface
     int tempfacTau = 1;
-    tempinput = Util::StringFind4(input_file,
-                                  "average_surface_over_this_many_time_steps");
+    tempinput = parameters.find("average_surface_over_this_many_time_steps");
     if (tempinput != "empty")
         istringstream(tempinput) >> tempfacTau;
     parameter_list.facTau = tempfacTau;
 
     int tempfac_x = 1;
-    tempinput = Util::StringFind4(input_file, "freeze_Ncell_x_step");
+    tempinput = parameters.find("freeze_Ncell_x_step");
     if (tempinput != "empty")
         istringstream(tempinput) >> tempfac_x;
     parameter_list.fac_x = tempfac_x;
     parameter_list.fac_y = tempfac_x;
 
     int tempfac_eta = 1;
-    tempinput = Util::StringFind4(input_file, "freeze_Ncell_eta_step");
+    tempinput = parameters.find("freeze_Ncell_eta_step");
     if (tempinput != "empty")
         istringstream(tempinput) >> tempfac_eta;
     parameter_list.fac_eta = tempfac_eta;
@@ -263,12 +663,12 @@ InitData read_in_parameters(std::string input_file) {
     // Grid_size_in_*
     // number of cells in x,y direction
     int tempnx = 10;
-    tempinput = Util::StringFind4(input_file, "Grid_size_in_x");
+    tempinput = parameters.find("Grid_size_in_x");
     if (tempinput != "empty")
         istringstream(tempinput) >> tempnx;
     parameter_list.nx = tempnx;
     int tempny = 10;
-    tempinput = Util::StringFind4(input_file, "Grid_size_in_y");
+    tempinput = parameters.find("Grid_size_in_y");
     if (tempinput != "empty")
         istringstream(tempinput) >> tempny;
     parameter_list.ny = tempny;
@@ -279,7 +679,7 @@ InitData read_in_parameters(std::string input_file) {
     // half the cells are at negative eta,
     // the rest (one fewer) are at positive eta
     int tempneta = 1;
-    tempinput = Util::StringFind4(input_file, "Grid_size_in_eta");
+    tempinput = parameters.find("Grid_size_in_eta");
     if (tempinput != "empty")
         istringstream(tempinput) >> tempneta;
     parameter_list.neta = tempneta;
@@ -287,19 +687,19 @@ InitData read_in_parameters(std::string input_file) {
     // grid_size_in_fm:
     // total length of box in x,y direction in fm (minus delta_*)
     double tempx_size = 25.;
-    tempinput = Util::StringFind4(input_file, "X_grid_size_in_fm");
+    tempinput = parameters.find("X_grid_size_in_fm");
     if (tempinput != "empty")
         istringstream(tempinput) >> tempx_size;
     parameter_list.x_size = tempx_size;
     double tempy_size = 25.;
-    tempinput = Util::StringFind4(input_file, "Y_grid_size_in_fm");
+    tempinput = parameters.find("Y_grid_size_in_fm");
     if (tempinput != "empty")
         istringstream(tempinput) >> tempy_size;
     parameter_list.y_size = tempy_size;
 
     // switch for baryon current propagation
     int tempturn_on_rhob = 0;
-    tempinput = Util::StringFind4(input_file, "Include_Rhob_Yes_1_No_0");
+    tempinput = parameters.find("Include_Rhob_Yes_1_No_0");
     if (tempinput != "empty")
         istringstream(tempinput) >> tempturn_on_rhob;
     parameter_list.turn_on_rhob = tempturn_on_rhob;
@@ -311,23 +711,32 @@ InitData read_in_parameters(std::string input_file) {
     // Eta_grid_size:  total length of box in eta direction (minus delta_eta)
     // e.g., neta=8 and eta_size=8 has 8 cells that run from eta=-4 to eta=3
     double tempeta_size = 8.;
-    tempinput = Util::StringFind4(input_file, "Eta_grid_size");
+    tempinput = parameters.find("Eta_grid_size");
     if (tempinput != "empty")
         istringstream(tempinput) >> tempeta_size;
     parameter_list.eta_size = tempeta_size;
 
+    // eta_grid_stretching: c of the stretched eta grid with the cells at
+    // eta_s = Eta_grid_size/2*sinh(c*xi)/sinh(c), xi uniform in [-1, 1]
+    // (0: uniform grid)
+    double temp_eta_grid_stretching = 0.;
+    tempinput = parameters.find("eta_grid_stretching");
+    if (tempinput != "empty")
+        istringstream(tempinput) >> temp_eta_grid_stretching;
+    parameter_list.eta_grid_stretching = temp_eta_grid_stretching;
+
     // Total_evolution_time_tau
     // total evolution time in [fm]. in case of freeze_out_method = 2,3,
     // evolution will halt earlier if all cells are frozen out.
     double temptau_size = 50.;
-    tempinput = Util::StringFind4(input_file, "Total_evolution_time_tau");
+    tempinput = parameters.find("Total_evolution_time_tau");
     if (tempinput != "empty")
         istringstream(tempinput) >> temptau_size;
     parameter_list.tau_size = temptau_size;
 
     // Initial_time_tau_0:  in fm
     double temptau0 = 0.4;
-    tempinput = Util::StringFind4(input_file, "Initial_time_tau_0");
+    tempinput = parameters.find("Initial_time_tau_0");
     if (tempinput != "empty")
         istringstream(tempinput) >> temptau0;
     parameter_list.tau0 = temptau0;
@@ -350,36 +759,145 @@ InitData read_in_parameters(std::string input_file) {
     // Delta_Tau:
     // time step to use in [fm].
     double tempdelta_tau = 0.02;
-    tempinput = Util::StringFind4(input_file, "Delta_Tau");
+    tempinput = parameters.find("Delta_Tau");
     if (tempinput != "empty")
         istringstream(tempinput) >> tempdelta_tau;
     parameter_list.delta_tau = tempdelta_tau;
     music_message << " DeltaTau = " << parameter_list.delta_tau << " fm";
     music_message.flush("info");
 
+    // adaptive_dtau: 1 time step from the CFL condition, 0 fixed Delta_Tau
+    int temp_adaptive_dtau = 0;
+    tempinput = parameters.find("adaptive_dtau");
+    if (tempinput != "empty")
+        istringstream(tempinput) >> temp_adaptive_dtau;
+    parameter_list.adaptive_dtau = temp_adaptive_dtau;
+
+    double temp_adaptive_dtau_cfl = 0.25;
+    tempinput = parameters.find("adaptive_dtau_cfl");
+    if (tempinput != "empty")
+        istringstream(tempinput) >> temp_adaptive_dtau_cfl;
+    parameter_list.adaptive_dtau_cfl = temp_adaptive_dtau_cfl;
+
+    double temp_adaptive_dtau_growth = 1.1;
+    tempinput = parameters.find("adaptive_dtau_growth");
+    if (tempinput != "empty")
+        istringstream(tempinput) >> temp_adaptive_dtau_growth;
+    parameter_list.adaptive_dtau_growth = temp_adaptive_dtau_growth;
+
+    double temp_adaptive_dtau_max_ratio = 5.0;
+    tempinput = parameters.find("adaptive_dtau_max_ratio");
+    if (tempinput != "empty")
+        istringstream(tempinput) >> temp_adaptive_dtau_max_ratio;
+    parameter_list.adaptive_dtau_max_ratio = temp_adaptive_dtau_max_ratio;
+
+    // transverse_coarsening_levels: the transverse plane is coarsened by 2
+    // up to this number of times, whenever the jump of the energy density
+    // between the points of the coarser grid, relative to the largest
+    // energy density, is below transverse_coarsening_threshold
+    // (0: fixed grid)
+    int temp_transverse_coarsening_levels = 0;
+    tempinput = parameters.find("transverse_coarsening_levels");
+    if (tempinput != "empty")
+        istringstream(tempinput) >> temp_transverse_coarsening_levels;
+    parameter_list.transverse_coarsening_levels =
+                                        temp_transverse_coarsening_levels;
+
+    double temp_transverse_coarsening_threshold = 0.05;
+    tempinput = parameters.find("transverse_coarsening_threshold");
+    if (tempinput != "empty")
+        istringstream(tempinput) >> temp_transverse_coarsening_threshold;
+    parameter_list.transverse_coarsening_threshold =
+                                        temp_transverse_coarsening_threshold;
+
     // output_evolution_data:
     // 1: output bulk information at every grid point at every time step
+    // 5: output the chunked, columnar file evolution_xyeta_chunked.dat
+    // 6: output the photon fields of the cells above output_evolution_e_cut
+    //    to the sparse file evolution_xyeta_sparse.dat
     int tempoutputEvolutionData = 0;
-    tempinput = Util::StringFind4(input_file, "output_evolution_data");
+    tempinput = parameters.find("output_evolution_data");
     if (tempinput != "empty")
         istringstream(tempinput) >> tempoutputEvolutionData;
     parameter_list.outputEvolutionData = tempoutputEvolutionData;
 
     int temp_store_hydro_info_in_memory = 0;
-    tempinput = Util::StringFind4(input_file, "store_hydro_info_in_memory");
+    tempinput = parameters.find("store_hydro_info_in_memory");
     if (tempinput != "empty")
         istringstream(tempinput) >> temp_store_hydro_info_in_memory;
     parameter_list.store_hydro_info_in_memory =
                                             temp_store_hydro_info_in_memory;
 
+    // store_hydro_info_T_cut:
+    // the in-memory history only keeps the cells above this temperature
+    // [GeV] (0: keep all cells)
+    double temp_store_hydro_info_T_cut = 0.;
+    tempinput = parameters.find("store_hydro_info_T_cut");
+    if (tempinput != "empty")
+        istringstream(tempinput) >> temp_store_hydro_info_T_cut;
+    parameter_list.store_hydro_info_T_cut = temp_store_hydro_info_T_cut;
+
+    // store_hydro_info_memory_slices:
+    // the last tau slices of the in-memory history kept in memory, the
+    // older ones are compressed and spilled to a scratch file in
+    // store_hydro_info_spill_directory and paged back in through a cache
+    // of store_hydro_info_cache_slices slices (0: keep all in memory)
+    int temp_store_hydro_info_memory_slices = 0;
+    tempinput = parameters.find("store_hydro_info_memory_slices");
+    if (tempinput != "empty")
+        istringstream(tempinput) >> temp_store_hydro_info_memory_slices;
+    parameter_list.store_hydro_info_memory_slices =
+                                    temp_store_hydro_info_memory_slices;
+
+    int temp_store_hydro_info_cache_slices = 4;
+    tempinput = parameters.find("store_hydro_info_cache_slices");
+    if (tempinput != "empty")
+        istringstream(tempinput) >> temp_store_hydro_info_cache_slices;
+    parameter_list.store_hydro_info_cache_slices =
+                                    temp_store_hydro_info_cache_slices;
+
+    string temp_store_hydro_info_spill_directory = ".";
+    tempinput = parameters.find("store_hydro_info_spill_directory");
+    if (tempinput != "empty")
+        temp_store_hydro_info_spill_directory.assign(tempinput);
+    parameter_list.store_hydro_info_spill_directory.assign(
+                                    temp_store_hydro_info_spill_directory);
+
     int temp_output_movie_flag = 0;
-    tempinput = Util::StringFind4(input_file, "output_movie_flag");
+    tempinput = parameters.find("output_movie_flag");
     if (tempinput != "empty")
         istringstream(tempinput) >> temp_output_movie_flag;
     parameter_list.output_movie_flag = temp_output_movie_flag;
 
+    // output_movie_reductions:
+    // the 2D frames of the reduced movie, computed during the run
+    // 0: none, 1: mid-rapidity slice (evolution_movie_slice.dat),
+    // 2: projection over eta (evolution_movie_projection.dat), 3: both
+    int temp_output_movie_reductions = 0;
+    tempinput = parameters.find("output_movie_reductions");
+    if (tempinput != "empty")
+        istringstream(tempinput) >> temp_output_movie_reductions;
+    parameter_list.output_movie_reductions = temp_output_movie_reductions;
+
+    // output_movie_block_size:
+    // the reduced movie averages blocks of N x N transverse cells
+    int temp_output_movie_block_size = 1;
+    tempinput = parameters.find("output_movie_block_size");
+    if (tempinput != "empty")
+        istringstream(tempinput) >> temp_output_movie_block_size;
+    parameter_list.output_movie_block_size = temp_output_movie_block_size;
+
+    // debug_snapshot_ring:
+    // the grids of the last N time steps are kept in memory and written
+    // to debug_snapshots.dat if the run stops on an error (0: off)
+    int temp_debug_snapshot_ring = 0;
+    tempinput = parameters.find("debug_snapshot_ring");
+    if (tempinput != "empty")
+        istringstream(tempinput) >> temp_debug_snapshot_ring;
+    parameter_list.debug_snapshot_ring = temp_debug_snapshot_ring;
+
     int temp_output_outofequilibriumsize = 0;
-    tempinput = Util::StringFind4(input_file, "output_outofequilibriumsize");
+    tempinput = parameters.find("output_outofequilibriumsize");
     if (tempinput != "empty")
         istringstream(tempinput) >> temp_output_outofequilibriumsize;
     parameter_list.output_outofequilibriumsize = (
@@ -395,25 +913,25 @@ InitData read_in_parameters(std::string input_file) {
     music_message.flush("info");
 
     double temp_eta_0 = 3.0;
-    tempinput = Util::StringFind4(input_file, "eta_rhob_0");
+    tempinput = parameters.find("eta_rhob_0");
     if (tempinput != "empty") istringstream (tempinput) >> temp_eta_0;
     parameter_list.eta_rhob_0 = temp_eta_0;
     double temp_eta_width = 1.0;
-    tempinput = Util::StringFind4(input_file, "eta_rhob_width");
+    tempinput = parameters.find("eta_rhob_width");
     if (tempinput != "empty") istringstream (tempinput) >> temp_eta_width;
     parameter_list.eta_rhob_width = temp_eta_width;
     double temp_eta_plateau_height = 0.5;
-    tempinput = Util::StringFind4(input_file, "eta_rhob_plateau_height");
+    tempinput = parameters.find("eta_rhob_plateau_height");
     if (tempinput != "empty")
         istringstream(tempinput) >> temp_eta_plateau_height;
     parameter_list.eta_rhob_plateau_height = temp_eta_plateau_height;
     double temp_eta_width_1 = 1.0;
-    tempinput = Util::StringFind4(input_file, "eta_rhob_width_1");
+    tempinput = parameters.find("eta_rhob_width_1");
     if (tempinput != "empty")
         istringstream(tempinput) >> temp_eta_width_1;
     parameter_list.eta_rhob_width_1 = temp_eta_width_1;
     double temp_eta_width_2 = 1.0;
-    tempinput = Util::StringFind4(input_file, "eta_rhob_width_2");
+    tempinput = parameters.find("eta_rhob_width_2");
     if (tempinput != "empty")
         istringstream(tempinput) >> temp_eta_width_2;
     parameter_list.eta_rhob_width_2 = temp_eta_width_2;
@@ -421,7 +939,7 @@ InitData read_in_parameters(std::string input_file) {
     // Eta_fall_off:
     // width of half-Gaussian on each side of a central pleateau in eta
     double tempeta_fall_off  = 0.4;
-    tempinput = Util::StringFind4(input_file, "Eta_fall_off");
+    tempinput = parameters.find("Eta_fall_off");
     if (tempinput != "empty")
         istringstream(tempinput) >> tempeta_fall_off ;
     parameter_list.eta_fall_off  = tempeta_fall_off;
@@ -429,21 +947,21 @@ InitData read_in_parameters(std::string input_file) {
     // Eta_plateau_size:
     // width of the flat region symmetrical around eta=0
     double tempeta_flat = 20.0;
-    tempinput = Util::StringFind4(input_file, "Eta_plateau_size");
+    tempinput = parameters.find("Eta_plateau_size");
     if (tempinput != "empty")
         istringstream(tempinput) >> tempeta_flat;
     parameter_list.eta_flat = tempeta_flat;
 
     // yL_frac: the fraction of Y_CM in the longitudinal velocity
     double temp_yL_frac = 0.0;  // default is 0: Bjorken flow
-    tempinput = Util::StringFind4(input_file, "yL_frac");
+    tempinput = parameters.find("yL_frac");
     if (tempinput != "empty")
         istringstream(tempinput) >> temp_yL_frac;
     parameter_list.yL_frac = temp_yL_frac;
 
     // s_factor:  for use with IP-Glasma initial conditions
     double tempsFactor   = 1.0;
-    tempinput = Util::StringFind4(input_file, "s_factor");
+    tempinput = parameters.find("s_factor");
     if (tempinput != "empty")
         istringstream ( tempinput ) >> tempsFactor;
     parameter_list.sFactor = tempsFactor;
@@ -452,7 +970,7 @@ InitData read_in_parameters(std::string input_file) {
     // max_pseudorapidity:
     // spectra calculated from zero to this pseudorapidity in +eta and -eta
     double tempmax_pseudorapidity = 5.0;
-    tempinput = Util::StringFind4(input_file, "max_pseudorapidity");
+    tempinput = parameters.find("max_pseudorapidity");
     if (tempinput != "empty")
         istringstream(tempinput) >> tempmax_pseudorapidity;
     parameter_list.max_pseudorapidity = tempmax_pseudorapidity;
@@ -460,7 +978,7 @@ InitData read_in_parameters(std::string input_file) {
     // pseudo_steps:
     // steps in pseudorapidity in calculation of spectra
     int temppseudo_steps = 51;
-    tempinput = Util::StringFind4(input_file, "pseudo_steps");
+    tempinput = parameters.find("pseudo_steps");
     if (tempinput != "empty")
         istringstream(tempinput) >> temppseudo_steps;
     parameter_list.pseudo_steps = temppseudo_steps; 
@@ -468,7 +986,7 @@ InitData read_in_parameters(std::string input_file) {
     // phi_steps
     // steps in azimuthal angle in calculation of spectra
     int tempphi_steps = 48;
-    tempinput = Util::StringFind4(input_file, "phi_steps");
+    tempinput = parameters.find("phi_steps");
     if (tempinput != "empty")
         istringstream(tempinput) >> tempphi_steps  ;
     parameter_list.phi_steps = tempphi_steps; 
@@ -476,7 +994,7 @@ InitData read_in_parameters(std::string input_file) {
     // min_pt:
     // spectra calculated from this to max_pt transverse momentum in GeV
     double tempmin_pt   = 0.0;
-    tempinput = Util::StringFind4(input_file, "min_pt");
+    tempinput = parameters.find("min_pt");
     if (tempinput != "empty")
         istringstream(tempinput) >> tempmin_pt  ;
     parameter_list.min_pt = tempmin_pt;
@@ -484,7 +1002,7 @@ InitData read_in_parameters(std::string input_file) {
     // max_pt:
     // spectra calculated from min_pt to this transverse momentum in GeV
     double tempmax_pt   = 3.0;
-    tempinput = Util::StringFind4(input_file, "max_pt");
+    tempinput = parameters.find("max_pt");
     if (tempinput != "empty")
         istringstream(tempinput) >> tempmax_pt;
     parameter_list.max_pt = tempmax_pt;
@@ -492,7 +1010,7 @@ InitData read_in_parameters(std::string input_file) {
     // pt_steps:
     // steps in transverse momentum in calculation of spectra
     int temppt_steps   = 60;
-    tempinput = Util::StringFind4(input_file, "pt_steps");
+    tempinput = parameters.find("pt_steps");
     if (tempinput != "empty")
         istringstream(tempinput) >> temppt_steps  ;
     parameter_list.pt_steps = temppt_steps;   
@@ -501,35 +1019,35 @@ InitData read_in_parameters(std::string input_file) {
     // Calculate spectra at fixed,
     // equally-spaced grid in pseudorapidity, pt, and phi
     int temppseudofreeze = 1;
-    tempinput = Util::StringFind4(input_file, "pseudofreeze");
+    tempinput = parameters.find("pseudofreeze");
     if (tempinput != "empty")
         istringstream(tempinput) >> temppseudofreeze;
     parameter_list.pseudofreeze = temppseudofreeze;
 
-    // Runge_Kutta_order:  must be 1 or 2
+    // Runge_Kutta_order:  1, 2 (SSP-RK2), or 3 (SSP-RK3)
     int temprk_order = 2;
-    tempinput = Util::StringFind4(input_file, "Runge_Kutta_order");
+    tempinput = parameters.find("Runge_Kutta_order");
     if (tempinput != "empty")
         istringstream(tempinput) >> temprk_order;
     parameter_list.rk_order = temprk_order;
 
     // Minmod_Theta: theta parameter in the min-mod like limiter
     double tempminmod_theta   = 1.8;
-    tempinput = Util::StringFind4(input_file, "Minmod_Theta");
+    tempinput = parameters.find("Minmod_Theta");
     if (tempinput != "empty")
         istringstream(tempinput) >> tempminmod_theta  ;
     parameter_list.minmod_theta = tempminmod_theta;
 
     // Viscosity_Flag_Yes_1_No_0:   set to 0 for ideal hydro
     int tempviscosity_flag = 1;
-    tempinput = Util::StringFind4(input_file, "Viscosity_Flag_Yes_1_No_0");
+    tempinput = parameters.find("Viscosity_Flag_Yes_1_No_0");
     if (tempinput != "empty")
         istringstream(tempinput) >> tempviscosity_flag;
     parameter_list.viscosity_flag = tempviscosity_flag;
 
     // Include_Shear_Visc_Yes_1_No_0
     int tempturn_on_shear = 0;
-    tempinput = Util::StringFind4(input_file, "Include_Shear_Visc_Yes_1_No_0");
+    tempinput = parameters.find("Include_Shear_Visc_Yes_1_No_0");
     if (tempinput != "empty")
         istringstream(tempinput) >> tempturn_on_shear;
     parameter_list.turn_on_shear = tempturn_on_shear;
@@ -537,7 +1055,7 @@ InitData read_in_parameters(std::string input_file) {
     // T_dependent_Shear_to_S_ratio:
     // if 1 use hard-coded T-dependent shear viscosity
     int tempT_dependent_shear_to_s = 0;
-    tempinput = Util::StringFind4(input_file, "T_dependent_Shear_to_S_ratio");
+    tempinput = parameters.find("T_dependent_Shear_to_S_ratio");
     if (tempinput != "empty")
         istringstream(tempinput) >> tempT_dependent_shear_to_s;
     parameter_list.T_dependent_shear_to_s = tempT_dependent_shear_to_s;
@@ -545,14 +1063,14 @@ InitData read_in_parameters(std::string input_file) {
     // muB_dependent_Shear_to_S_ratio:
     // if 1 use hard-coded muB-dependent shear viscosity
     int tempmuB_dependent_shear_to_s = 0;
-    tempinput = Util::StringFind4(input_file, "muB_dependent_Shear_to_S_ratio");
+    tempinput = parameters.find("muB_dependent_Shear_to_S_ratio");
     if (tempinput != "empty")
         istringstream(tempinput) >> tempmuB_dependent_shear_to_s;
     parameter_list.muB_dependent_shear_to_s = tempmuB_dependent_shear_to_s;
 
     //Shear_to_S_ratio:  constant eta/s
     double tempshear_to_s = 0.08;
-    tempinput = Util::StringFind4(input_file, "Shear_to_S_ratio");
+    tempinput = parameters.find("Shear_to_S_ratio");
     if (tempinput != "empty") {
         istringstream(tempinput) >> tempshear_to_s;
     } else if (parameter_list.turn_on_shear == 1
@@ -566,19 +1084,19 @@ InitData read_in_parameters(std::string input_file) {
     // (eta/s)(T) = eta_over_s_min + eta_over_s_slope*(T − Tc)*(T/Tc)^{eta_over_s_curv}
     // with T_c=0.154 GeV
     double temp_eta_over_s_min = 0.08;
-    tempinput = Util::StringFind4(input_file, "shear_viscosity_2_min");
+    tempinput = parameters.find("shear_viscosity_2_min");
     if (tempinput != "empty")
         istringstream ( tempinput ) >> temp_eta_over_s_min;
     parameter_list.shear_2_min = temp_eta_over_s_min;
 
     double temp_eta_over_s_slope = 1.0;
-    tempinput = Util::StringFind4(input_file, "shear_viscosity_2_slope");
+    tempinput = parameters.find("shear_viscosity_2_slope");
     if (tempinput != "empty")
         istringstream ( tempinput ) >> temp_eta_over_s_slope;
     parameter_list.shear_2_slope = temp_eta_over_s_slope;
 
     double temp_eta_over_s_curv = 0;
-    tempinput = Util::StringFind4(input_file, "shear_viscosity_2_curv");
+    tempinput = parameters.find("shear_viscosity_2_curv");
     if (tempinput != "empty")
         istringstream ( tempinput ) >> temp_eta_over_s_curv;
     parameter_list.shear_2_curv = temp_eta_over_s_curv;
@@ -586,37 +1104,34 @@ InitData read_in_parameters(std::string input_file) {
 
     // If "T_dependent_Shear_to_S_ratio==3", 
     double temp_eta_over_s_T_kink_in_GeV = .16;
-    tempinput = Util::StringFind4(input_file,
-                                  "shear_viscosity_3_T_kink_in_GeV");
+    tempinput = parameters.find("shear_viscosity_3_T_kink_in_GeV");
     if (tempinput != "empty")
         istringstream ( tempinput ) >> temp_eta_over_s_T_kink_in_GeV;
     parameter_list.shear_3_T_kink_in_GeV = temp_eta_over_s_T_kink_in_GeV;
 
     double temp_eta_over_s_low_T_slope_in_GeV = 0.0;
-    tempinput = Util::StringFind4(input_file,
-                                  "shear_viscosity_3_low_T_slope_in_GeV");
+    tempinput = parameters.find("shear_viscosity_3_low_T_slope_in_GeV");
     if (tempinput != "empty")
         istringstream ( tempinput ) >> temp_eta_over_s_low_T_slope_in_GeV;
     parameter_list.shear_3_low_T_slope_in_GeV = (
                                         temp_eta_over_s_low_T_slope_in_GeV);
 
     double temp_eta_over_s_high_T_slope_in_GeV = 0.0;
-    tempinput = Util::StringFind4(input_file,
-                                  "shear_viscosity_3_high_T_slope_in_GeV");
+    tempinput = parameters.find("shear_viscosity_3_high_T_slope_in_GeV");
     if (tempinput != "empty")
         istringstream ( tempinput ) >> temp_eta_over_s_high_T_slope_in_GeV;
     parameter_list.shear_3_high_T_slope_in_GeV = (
                                     temp_eta_over_s_high_T_slope_in_GeV);
 
     double temp_eta_over_s_at_kink = 0.08;
-    tempinput = Util::StringFind4(input_file, "shear_viscosity_3_at_kink");
+    tempinput = parameters.find("shear_viscosity_3_at_kink");
     if (tempinput != "empty")
         istringstream ( tempinput ) >> temp_eta_over_s_at_kink;
     parameter_list.shear_3_at_kink = temp_eta_over_s_at_kink;
 
     // the strength for the viscous regulation
     double temp_quest_revert_strength = 10.;
-    tempinput = Util::StringFind4(input_file, "quest_revert_strength");
+    tempinput = parameters.find("quest_revert_strength");
     if (tempinput != "empty") {
         istringstream(tempinput) >> temp_quest_revert_strength;
     }
@@ -624,142 +1139,157 @@ InitData read_in_parameters(std::string input_file) {
 
     // Include_Bulk_Visc_Yes_1_No_0
     int tempturn_on_bulk = 0;
-    tempinput = Util::StringFind4(input_file, "Include_Bulk_Visc_Yes_1_No_0");
+    tempinput = parameters.find("Include_Bulk_Visc_Yes_1_No_0");
     if (tempinput != "empty")
         istringstream(tempinput) >> tempturn_on_bulk;
     parameter_list.turn_on_bulk = tempturn_on_bulk;
 
     // type of bulk relaxation time parameterization
     int tempbulk_relaxation_type = 0;
-    tempinput = Util::StringFind4(input_file, "Bulk_relaxation_time_type");
+    tempinput = parameters.find("Bulk_relaxation_time_type");
     if (tempinput != "empty")
         istringstream(tempinput) >> tempbulk_relaxation_type;
     parameter_list.bulk_relaxation_type = tempbulk_relaxation_type;
 
     // T_dependent_Bulk_to_S_ratio:
     int tempT_dependent_bulk_to_s = 1;
-    tempinput = Util::StringFind4(input_file, "T_dependent_Bulk_to_S_ratio");
+    tempinput = parameters.find("T_dependent_Bulk_to_S_ratio");
     if (tempinput != "empty")
         istringstream(tempinput) >> tempT_dependent_bulk_to_s;
     parameter_list.T_dependent_bulk_to_s = tempT_dependent_bulk_to_s;
 
+    // transport_coeffs_table: 1 interpolate eta/s(T, muB) and zeta/s(T)
+    // in tables built at the start, 0 evaluate the parameterizations
+    int temptransport_coeffs_table = 1;
+    tempinput = parameters.find("transport_coeffs_table");
+    if (tempinput != "empty")
+        istringstream(tempinput) >> temptransport_coeffs_table;
+    parameter_list.transport_coeffs_table = temptransport_coeffs_table;
+
     // "T_dependent_Bulk_to_S_ratio=2",
     // bulk viscosity is parametrized as with "A", "G" and "Tc" as "A*(1/(1+((T-Tc)/G)^2)"
     double tempBulkViscosityNorm = 0.33;
-    tempinput = Util::StringFind4(input_file,
-                                  "bulk_viscosity_2_normalisation");
+    tempinput = parameters.find("bulk_viscosity_2_normalisation");
     if (tempinput != "empty")
         istringstream ( tempinput ) >> tempBulkViscosityNorm;
     parameter_list.bulk_2_normalisation = tempBulkViscosityNorm;
 
     double tempBulkViscosityWidth = 0.08;
-    tempinput = Util::StringFind4(input_file, "bulk_viscosity_2_width_in_GeV");
+    tempinput = parameters.find("bulk_viscosity_2_width_in_GeV");
     if (tempinput != "empty")
         istringstream ( tempinput ) >> tempBulkViscosityWidth;
     parameter_list.bulk_2_width_in_GeV = tempBulkViscosityWidth;
 
     // flag for different parameterization of zeta/s(T)
     double tempBulkViscosityPeak = 0.18;
-    tempinput = Util::StringFind4(input_file, "bulk_viscosity_2_peak_in_GeV");
+    tempinput = parameters.find("bulk_viscosity_2_peak_in_GeV");
     if (tempinput != "empty")
         istringstream ( tempinput ) >> tempBulkViscosityPeak;
     parameter_list.bulk_2_peak_in_GeV = tempBulkViscosityPeak;
 
     // "T_dependent_Bulk_to_S_ratio==3",
     double tempzeta_over_s_max= 0.1;
-    tempinput = Util::StringFind4(input_file, "bulk_viscosity_3_max");
+    tempinput = parameters.find("bulk_viscosity_3_max");
     if (tempinput != "empty")
         istringstream ( tempinput ) >> tempzeta_over_s_max;
     parameter_list.bulk_3_max = tempzeta_over_s_max;
 
     double tempzeta_over_s_width_in_GeV= 0.05;
-    tempinput = Util::StringFind4(input_file, "bulk_viscosity_3_width_in_GeV");
+    tempinput = parameters.find("bulk_viscosity_3_width_in_GeV");
     if (tempinput != "empty")
         istringstream ( tempinput ) >> tempzeta_over_s_width_in_GeV;
     parameter_list.bulk_3_width_in_GeV = tempzeta_over_s_width_in_GeV;
 
     double tempzeta_over_s_T_peak_in_GeV= 0.18;
-    tempinput = Util::StringFind4(input_file, "bulk_viscosity_3_T_peak_in_GeV");
+    tempinput = parameters.find("bulk_viscosity_3_T_peak_in_GeV");
     if (tempinput != "empty")
         istringstream ( tempinput ) >> tempzeta_over_s_T_peak_in_GeV;
     parameter_list.bulk_3_T_peak_in_GeV = tempzeta_over_s_T_peak_in_GeV;
 
     double tempzeta_over_s_lambda_asymm= 0.;
-    tempinput = Util::StringFind4(input_file, "bulk_viscosity_3_lambda_asymm");
+    tempinput = parameters.find("bulk_viscosity_3_lambda_asymm");
     if (tempinput != "empty")
         istringstream ( tempinput ) >> tempzeta_over_s_lambda_asymm;
     parameter_list.bulk_3_lambda_asymm = tempzeta_over_s_lambda_asymm;
 
     // Include secord order terms
     int tempturn_on_second_order = 0;
-    tempinput = Util::StringFind4(input_file, "Include_second_order_terms");
+    tempinput = parameters.find("Include_second_order_terms");
     if (tempinput != "empty")
         istringstream(tempinput) >> tempturn_on_second_order;
     parameter_list.include_second_order_terms = tempturn_on_second_order;
 
     // Include vorticity coupling terms
     int tempturn_on_vorticity_terms = 0;
-    tempinput = Util::StringFind4(input_file, "Include_vorticity_terms");
+    tempinput = parameters.find("Include_vorticity_terms");
     if (tempinput != "empty")
         istringstream(tempinput) >> tempturn_on_vorticity_terms;
     parameter_list.include_vorticity_terms = tempturn_on_vorticity_terms;
 
     // Output vorticity evolution
     int tempoutput_vorticity = 0;
-    tempinput = Util::StringFind4(input_file, "output_vorticity");
+    tempinput = parameters.find("output_vorticity");
     if (tempinput != "empty")
         istringstream(tempinput) >> tempoutput_vorticity;
     parameter_list.output_vorticity = tempoutput_vorticity;
 
     int tempturn_on_diff = 0;
-    tempinput = Util::StringFind4(input_file, "turn_on_baryon_diffusion");
+    tempinput = parameters.find("turn_on_baryon_diffusion");
     if (tempinput != "empty")
         istringstream(tempinput) >> tempturn_on_diff;
     parameter_list.turn_on_diff = tempturn_on_diff;
 
     // Relaxation time factors
     double tempshear_relax_time_factor= 5.;
-    tempinput = Util::StringFind4(input_file, "shear_relax_time_factor");
+    tempinput = parameters.find("shear_relax_time_factor");
     if (tempinput != "empty")
         istringstream ( tempinput ) >> tempshear_relax_time_factor;
     parameter_list.shear_relax_time_factor = tempshear_relax_time_factor;
 
     double tempbulk_relax_time_factor= 1./14.55;
-    tempinput = Util::StringFind4(input_file, "bulk_relax_time_factor");
+    tempinput = parameters.find("bulk_relax_time_factor");
     if (tempinput != "empty")
         istringstream ( tempinput ) >> tempbulk_relax_time_factor;
     parameter_list.bulk_relax_time_factor = tempbulk_relax_time_factor;
 
     // kappa coefficient
     double temp_kappa_coefficient = 0.0;
-    tempinput = Util::StringFind4(input_file, "kappa_coefficient");
+    tempinput = parameters.find("kappa_coefficient");
     if (tempinput != "empty")
         istringstream(tempinput) >> temp_kappa_coefficient;
     parameter_list.kappa_coefficient = temp_kappa_coefficient;
 
+    // implicit_relaxation: 1 the relaxation terms of the dissipative
+    // currents are integrated implicitly, 0 explicitly
+    int temp_implicit_relaxation = 0;
+    tempinput = parameters.find("implicit_relaxation");
+    if (tempinput != "empty")
+        istringstream(tempinput) >> temp_implicit_relaxation;
+    parameter_list.implicit_relaxation = temp_implicit_relaxation;
+
     // Include_deltaf:
     // Looks like 0 sets delta_f=0, 1 uses standard quadratic ansatz,
     // and 2 is supposed to use p^(2-alpha)
     int tempinclude_deltaf = 1;
-    tempinput = Util::StringFind4(input_file, "Include_deltaf");
+    tempinput = parameters.find("Include_deltaf");
     if (tempinput != "empty")
         istringstream(tempinput) >> tempinclude_deltaf;
     parameter_list.include_deltaf = tempinclude_deltaf;
 
     int tempinclude_deltaf_bulk = 0;
-    tempinput = Util::StringFind4(input_file, "Include_deltaf_bulk");
+    tempinput = parameters.find("Include_deltaf_bulk");
     if (tempinput != "empty")
         istringstream(tempinput) >> tempinclude_deltaf_bulk;
     parameter_list.include_deltaf_bulk = tempinclude_deltaf_bulk;
 
     int tempinclude_deltaf_qmu = 0;
-    tempinput = Util::StringFind4(input_file, "Include_deltaf_qmu");
+    tempinput = parameters.find("Include_deltaf_qmu");
     if (tempinput != "empty")
         istringstream(tempinput) >> tempinclude_deltaf_qmu;
     parameter_list.include_deltaf_qmu = tempinclude_deltaf_qmu;
 
     int temp_deltaf_14moments = 0;
-    tempinput = Util::StringFind4(input_file, "deltaf_14moments");
+    tempinput = parameters.find("deltaf_14moments");
     if (tempinput != "empty")
         istringstream(tempinput) >> temp_deltaf_14moments;
     parameter_list.deltaf_14moments = temp_deltaf_14moments;
@@ -767,51 +1297,47 @@ InitData read_in_parameters(std::string input_file) {
     // Do_FreezeOut_Yes_1_No_0
     // set to 0 to bypass freeze out surface finder
     int tempdoFreezeOut = 1;
-    tempinput = Util::StringFind4(input_file, "Do_FreezeOut_Yes_1_No_0");
+    tempinput = parameters.find("Do_FreezeOut_Yes_1_No_0");
     if (tempinput != "empty")
         istringstream(tempinput) >> tempdoFreezeOut;
     parameter_list.doFreezeOut = tempdoFreezeOut;
 
     int tempdoFreezeOut_lowtemp = 1;
-    tempinput = Util::StringFind4(input_file, "Do_FreezeOut_lowtemp");
+    tempinput = parameters.find("Do_FreezeOut_lowtemp");
     if (tempinput != "empty")
         istringstream(tempinput) >> tempdoFreezeOut_lowtemp;
     parameter_list.doFreezeOut_lowtemp = tempdoFreezeOut_lowtemp;
 
     // Initial_Distribution_input_filename
     string tempinitName = "initial/initial_ed.dat";
-    tempinput = Util::StringFind4(input_file,
-                                  "Initial_Distribution_input_filename");
+    tempinput = parameters.find("Initial_Distribution_input_filename");
     if (tempinput != "empty")
         tempinitName.assign(tempinput);
     parameter_list.initName.assign(tempinitName);
 
     // Initial_Distribution_Filename for TA
     string tempinitName_TA = "initial/initial_TA.dat";
-    tempinput = Util::StringFind4(input_file,
-                                  "Initial_TA_Distribution_Filename");
+    tempinput = parameters.find("Initial_TA_Distribution_Filename");
     if (tempinput != "empty")
         tempinitName_TA.assign(tempinput);
     parameter_list.initName_TA.assign(tempinitName_TA);
     // Initial_Distribution_Filename for TB
     string tempinitName_TB = "initial/initial_TB.dat";
-    tempinput = Util::StringFind4(input_file,
-                                  "Initial_TB_Distribution_Filename");
+    tempinput = parameters.find("Initial_TB_Distribution_Filename");
     if (tempinput != "empty")
         tempinitName_TB.assign(tempinput);
     parameter_list.initName_TB.assign(tempinitName_TB);
 
     // Initial_Distribution_AMPT_filename for AMPT
     string tempinitName_AMPT = "initial/initial_AMPT.dat";
-    tempinput = Util::StringFind4(input_file,
-                                  "Initial_Distribution_AMPT_filename");
+    tempinput = parameters.find("Initial_Distribution_AMPT_filename");
     if (tempinput != "empty")
         tempinitName_AMPT.assign(tempinput);
     parameter_list.initName_AMPT.assign(tempinitName_AMPT);
 
     // compute beam rapidity according to the collision energy
     double temp_ecm = 200;
-    tempinput = Util::StringFind4(input_file, "ecm");
+    tempinput = parameters.find("ecm");
     if (tempinput != "empty")
         istringstream(tempinput) >> temp_ecm;
     parameter_list.ecm = temp_ecm;
@@ -819,7 +1345,7 @@ InitData read_in_parameters(std::string input_file) {
     parameter_list.beam_rapidity = y_beam;
 
     int tempoutputBinaryEvolution = 0;
-    tempinput = Util::StringFind4(input_file, "outputBinaryEvolution");
+    tempinput = parameters.find("outputBinaryEvolution");
     if (tempinput != "empty")
         istringstream(tempinput) >> tempoutputBinaryEvolution;
     parameter_list.outputBinaryEvolution = tempoutputBinaryEvolution;
@@ -827,7 +1353,7 @@ InitData read_in_parameters(std::string input_file) {
     //  Make MUSIC output additionnal hydro information
     //  0 for false (do not output), 1 for true
     int tempoutput_hydro_debug_info = 0;
-    tempinput = Util::StringFind4(input_file, "output_hydro_debug_info");
+    tempinput = parameters.find("output_hydro_debug_info");
     if (tempinput != "empty")
         istringstream(tempinput) >> tempoutput_hydro_debug_info;
     parameter_list.output_hydro_debug_info = tempoutput_hydro_debug_info;
@@ -835,177 +1361,211 @@ InitData read_in_parameters(std::string input_file) {
     // The evolution is outputted every
     // "output_evolution_every_N_timesteps" timesteps
     int temp_evo_N_tau = 1;
-    tempinput = Util::StringFind4(input_file,
-                                  "output_evolution_every_N_timesteps");
+    tempinput = parameters.find("output_evolution_every_N_timesteps");
     if (tempinput != "empty")
         istringstream(tempinput) >> temp_evo_N_tau;
     parameter_list.output_evolution_every_N_timesteps = temp_evo_N_tau;
 
+    // The observables vs tau (momentum anisotropy, conservation laws,
+    // vorticity evolution) are outputted every
+    // "output_observables_every_N_timesteps" timesteps
+    int temp_observables_N_tau = 1;
+    tempinput = parameters.find("output_observables_every_N_timesteps");
+    if (tempinput != "empty")
+        istringstream(tempinput) >> temp_observables_N_tau;
+    parameter_list.output_observables_every_N_timesteps = (
+                                                    temp_observables_N_tau);
+
     int temp_evo_N_x = 1;
-    tempinput = Util::StringFind4(input_file, "output_evolution_every_N_x");
+    tempinput = parameters.find("output_evolution_every_N_x");
     if(tempinput != "empty") istringstream ( tempinput ) >> temp_evo_N_x;
     parameter_list.output_evolution_every_N_x = temp_evo_N_x;
     parameter_list.output_evolution_every_N_y = temp_evo_N_x;
 
     int temp_evo_N_eta = 1;
-    tempinput = Util::StringFind4(input_file, "output_evolution_every_N_eta");
+    tempinput = parameters.find("output_evolution_every_N_eta");
     if(tempinput != "empty") istringstream ( tempinput ) >> temp_evo_N_eta;
     parameter_list.output_evolution_every_N_eta = temp_evo_N_eta;
 
     double temp_evo_T_cut = 0.105;  // GeV
-    tempinput = Util::StringFind4(input_file, "output_evolution_T_cut");
+    tempinput = parameters.find("output_evolution_T_cut");
     if (tempinput != "empty")
         istringstream(tempinput) >> temp_evo_T_cut;
     parameter_list.output_evolution_T_cut = temp_evo_T_cut;
 
     double temp_evo_e_cut = 0.15;  // GeV/fm^3
-    tempinput = Util::StringFind4(input_file, "output_evolution_e_cut");
+    tempinput = parameters.find("output_evolution_e_cut");
     if (tempinput != "empty")
         istringstream(tempinput) >> temp_evo_e_cut;
     parameter_list.output_evolution_e_cut = temp_evo_e_cut;
 
+    // output_evolution_buffers:
+    // number of time steps of evolution output the writer thread can
+    // lag behind the evolution (0: write on the main thread)
+    int temp_evo_buffers = 2;
+    tempinput = parameters.find("output_evolution_buffers");
+    if (tempinput != "empty")
+        istringstream(tempinput) >> temp_evo_buffers;
+    parameter_list.output_evolution_buffers = temp_evo_buffers;
+
+    // output_evolution_codec:
+    // compression of the chunks of the chunked evolution file
+    // 0: raw floats, 1: zlib (default if MUSIC is compiled with zlib)
+#ifdef ZLIB
+    int temp_evo_codec = 1;
+#else
+    int temp_evo_codec = 0;
+#endif
+    tempinput = parameters.find("output_evolution_codec");
+    if (tempinput != "empty")
+        istringstream(tempinput) >> temp_evo_codec;
+    parameter_list.output_evolution_codec = temp_evo_codec;
+
     // Make MUSIC output a C header input_file containing
     // informations about the hydro parameters used
     // 0 for false (do not output), 1 for true
     bool tempoutput_hydro_params_header = false;
-    tempinput = Util::StringFind4(input_file, "output_hydro_params_header");
+    tempinput = parameters.find("output_hydro_params_header");
     if (tempinput != "empty")
         istringstream(tempinput) >> tempoutput_hydro_params_header;
     parameter_list.output_hydro_params_header = tempoutput_hydro_params_header;
 
     // initial parameters for mode 14
     double temp_dNdy_y_min = -0.5;
-    tempinput = Util::StringFind4(input_file, "dNdy_y_min");
+    tempinput = parameters.find("dNdy_y_min");
     if(tempinput != "empty") istringstream ( tempinput ) >> temp_dNdy_y_min;
     parameter_list.dNdy_y_min = temp_dNdy_y_min;
 
     double temp_dNdy_y_max = 0.5;
-    tempinput = Util::StringFind4(input_file, "dNdy_y_max");
+    tempinput = parameters.find("dNdy_y_max");
     if(tempinput != "empty") istringstream ( tempinput ) >> temp_dNdy_y_max;
     parameter_list.dNdy_y_max = temp_dNdy_y_max;
 
     double temp_dNdy_eta_min = -2.0;
-    tempinput = Util::StringFind4(input_file, "dNdy_eta_min");
+    tempinput = parameters.find("dNdy_eta_min");
     if(tempinput != "empty") istringstream ( tempinput ) >> temp_dNdy_eta_min;
     parameter_list.dNdy_eta_min = temp_dNdy_eta_min;
 
     double temp_dNdy_eta_max = 2.0;
-    tempinput = Util::StringFind4(input_file, "dNdy_eta_max");
+    tempinput = parameters.find("dNdy_eta_max");
     if(tempinput != "empty") istringstream ( tempinput ) >> temp_dNdy_eta_max;
     parameter_list.dNdy_eta_max = temp_dNdy_eta_max;
 
     int temp_dNdy_nrap = 30;
-    tempinput = Util::StringFind4(input_file, "dNdy_nrap");
+    tempinput = parameters.find("dNdy_nrap");
     if (tempinput != "empty")
         istringstream(tempinput) >> temp_dNdy_nrap;
     parameter_list.dNdy_nrap = temp_dNdy_nrap;
 
     double temp_dNdyptdpt_y_min = -0.5;
-    tempinput = Util::StringFind4(input_file, "dNdyptdpt_y_min");
+    tempinput = parameters.find("dNdyptdpt_y_min");
     if (tempinput != "empty")
         istringstream(tempinput) >> temp_dNdyptdpt_y_min;
     parameter_list.dNdyptdpt_y_min = temp_dNdyptdpt_y_min;
 
     double temp_dNdyptdpt_y_max = 0.5;
-    tempinput = Util::StringFind4(input_file, "dNdyptdpt_y_max");
+    tempinput = parameters.find("dNdyptdpt_y_max");
     if (tempinput != "empty")
         istringstream(tempinput) >> temp_dNdyptdpt_y_max;
     parameter_list.dNdyptdpt_y_max = temp_dNdyptdpt_y_max;
 
     double temp_dNdyptdpt_eta_min = -0.5;
-    tempinput = Util::StringFind4(input_file, "dNdyptdpt_eta_min");
+    tempinput = parameters.find("dNdyptdpt_eta_min");
     if (tempinput != "empty")
         istringstream(tempinput) >> temp_dNdyptdpt_eta_min;
     parameter_list.dNdyptdpt_eta_min = temp_dNdyptdpt_eta_min;
 
     double temp_dNdyptdpt_eta_max = 0.5;
-    tempinput = Util::StringFind4(input_file, "dNdyptdpt_eta_max");
+    tempinput = parameters.find("dNdyptdpt_eta_max");
     if (tempinput != "empty")
         istringstream(tempinput) >> temp_dNdyptdpt_eta_max;
     parameter_list.dNdyptdpt_eta_max = temp_dNdyptdpt_eta_max;
 
     music_message.info("Done read_in_parameters.");
-    check_parameters(parameter_list, input_file);
+    check_parameters(parameter_list, parameters);
+
+    const std::vector<std::string> unused_parameters = (
+                                        parameters.get_unused_parameters());
+    if (!unused_parameters.empty()) {
+        music_message << "The input parameters";
+        for (const auto &name : unused_parameters) music_message << " " << name;
+        music_message << " are not used by MUSIC.";
+        music_message.flush("warning");
+    }
+
+    // check_parameters may have reset delta_tau
+    parameter_list.delta_tau_input    = parameter_list.delta_tau;
+    parameter_list.delta_tau_backward = parameter_list.delta_tau;
 
     return parameter_list;
 }
 
 
-void set_parameter(InitData &parameter_list, std::string parameter_name,
+bool set_parameter(InitData &parameter_list, std::string parameter_name,
                    double value) {
     if (parameter_name == "MUSIC_mode")
         parameter_list.mode = static_cast<int>(value);
-
-    if (parameter_name == "Initial_time_tau_0")
+    else if (parameter_name == "Initial_time_tau_0")
         parameter_list.tau0 = value;
-
-    if (parameter_name == "output_evolution_data")
+    else if (parameter_name == "output_evolution_data")
         parameter_list.outputEvolutionData = static_cast<int>(value);
-
-    if (parameter_name == "output_movie_flag")
+    else if (parameter_name == "output_movie_flag")
         parameter_list.output_movie_flag = static_cast<int>(value);
-
-    if (parameter_name == "store_hydro_info_in_memory")
+    else if (parameter_name == "store_hydro_info_in_memory")
         parameter_list.store_hydro_info_in_memory = static_cast<int>(value);
-
-    if (parameter_name == "Viscosity_Flag_Yes_1_No_0")
+    else if (parameter_name == "store_hydro_info_T_cut")
+        parameter_list.store_hydro_info_T_cut = value;
+    else if (parameter_name == "Viscosity_Flag_Yes_1_No_0")
         parameter_list.viscosity_flag = static_cast<int>(value);
-
-    if (parameter_name == "Include_Shear_Visc_Yes_1_No_0")
+    else if (parameter_name == "Include_Shear_Visc_Yes_1_No_0")
         parameter_list.turn_on_shear = static_cast<int>(value);
-
-    if (parameter_name == "Shear_to_S_ratio")
+    else if (parameter_name == "Shear_to_S_ratio")
         parameter_list.shear_to_s = value;
-
-    if (parameter_name == "T_freeze")
+    else if (parameter_name == "T_freeze")
         parameter_list.TFO = value;
-
-    if (parameter_name == "Include_Bulk_Visc_Yes_1_No_0")
+    else if (parameter_name == "Include_Bulk_Visc_Yes_1_No_0")
         parameter_list.turn_on_bulk = static_cast<int>(value);
-
-    if (parameter_name == "Include_second_order_terms")
+    else if (parameter_name == "Include_second_order_terms")
         parameter_list.include_second_order_terms = static_cast<int>(value);
-
-    if (parameter_name == "T_dependent_Shear_to_S_ratio")
+    else if (parameter_name == "T_dependent_Shear_to_S_ratio")
         parameter_list.T_dependent_shear_to_s = static_cast<int>(value);
-
-    if (parameter_name == "shear_viscosity_2_min")
+    else if (parameter_name == "shear_viscosity_2_min")
         parameter_list.shear_2_min = value;
-    if (parameter_name == "shear_viscosity_slope")
+    else if (parameter_name == "shear_viscosity_slope")
         parameter_list.shear_2_slope = value;
-    if (parameter_name == "shear_viscosity_curv")
+    else if (parameter_name == "shear_viscosity_curv")
         parameter_list.shear_2_curv = value;
-
-    if (parameter_name == "shear_viscosity_3_T_kink_in_GeV")
+    else if (parameter_name == "shear_viscosity_3_T_kink_in_GeV")
         parameter_list.shear_3_T_kink_in_GeV = value;
-    if (parameter_name == "shear_viscosity_3_low_T_slope_in_GeV")
+    else if (parameter_name == "shear_viscosity_3_low_T_slope_in_GeV")
         parameter_list.shear_3_low_T_slope_in_GeV = value;
-    if (parameter_name == "shear_viscosity_3_high_T_slope_in_GeV")
+    else if (parameter_name == "shear_viscosity_3_high_T_slope_in_GeV")
         parameter_list.shear_3_high_T_slope_in_GeV = value;
-    if (parameter_name == "shear_viscosity_3_at_kink")
+    else if (parameter_name == "shear_viscosity_3_at_kink")
         parameter_list.shear_3_at_kink = value;
-
-    if (parameter_name == "T_dependent_Bulk_to_S_ratio")
+    else if (parameter_name == "T_dependent_Bulk_to_S_ratio")
         parameter_list.T_dependent_bulk_to_s = static_cast<int>(value);
-
-    if (parameter_name == "bulk_viscosity_2_normalisation")
+    else if (parameter_name == "bulk_viscosity_2_normalisation")
         parameter_list.bulk_2_normalisation = value;
-    if (parameter_name == "bulk_viscosity_2_peak_in_GeV")
+    else if (parameter_name == "bulk_viscosity_2_peak_in_GeV")
         parameter_list.bulk_2_peak_in_GeV = value;
-    if (parameter_name == "bulk_viscosity_2_width_in_GeV")
+    else if (parameter_name == "bulk_viscosity_2_width_in_GeV")
         parameter_list.bulk_2_width_in_GeV = value;
-
-    if (parameter_name == "bulk_viscosity_3_max")
+    else if (parameter_name == "bulk_viscosity_3_max")
         parameter_list.bulk_3_max = value;
-    if (parameter_name == "bulk_viscosity_3_width_in_GeV")
+    else if (parameter_name == "bulk_viscosity_3_width_in_GeV")
         parameter_list.bulk_3_width_in_GeV = value;
-    if (parameter_name == "bulk_viscosity_3_T_peak_in_GeV")
+    else if (parameter_name == "bulk_viscosity_3_T_peak_in_GeV")
         parameter_list.bulk_3_T_peak_in_GeV = value;
-    if (parameter_name == "bulk_viscosity_3_lambda_asymm")
+    else if (parameter_name == "bulk_viscosity_3_lambda_asymm")
         parameter_list.bulk_3_lambda_asymm = value;
+    else
+        return(false);
+    return(true);
 }
 
-void check_parameters(InitData &parameter_list, std::string input_file) {
+void check_parameters(InitData &parameter_list,
+                      ParameterRegistry &parameters) {
     music_message.info("Checking input parameter list ... ");
 
     if (parameter_list.Initial_profile < 0) {
@@ -1075,6 +1635,86 @@ void check_parameters(InitData &parameter_list, std::string input_file) {
         exit(1);
     }
 
+    if (parameter_list.freeze_surface_single_file != 0
+            && parameter_list.freeze_surface_single_file != 1) {
+        music_message << "Invalid option for freeze_surface_single_file: "
+                      << parameter_list.freeze_surface_single_file;
+        music_message.flush("error");
+        exit(1);
+    }
+
+    if (parameter_list.freeze_surface_single_file == 1
+            && !parameter_list.freeze_surface_in_binary) {
+        music_message << "freeze_surface_single_file = 1 requires "
+                      << "freeze_surface_in_binary = 1";
+        music_message.flush("error");
+        exit(1);
+    }
+
+    if (parameter_list.freeze_out_pipeline < 0) {
+        music_message.error("freeze_out_pipeline < 0!");
+        exit(1);
+    }
+
+    if (   parameter_list.freeze_out_pipeline > 0
+        && parameter_list.output_vorticity == 1) {
+        // the vorticity at the freeze-out steps is shared with the
+        // evolution outputs
+        music_message << "freeze_out_pipeline > 0 requires "
+                      << "output_vorticity = 0";
+        music_message.flush("error");
+        exit(1);
+    }
+
+    if (   parameter_list.output_spectra_files < 0
+        || parameter_list.output_spectra_files > 1) {
+        music_message << "Invalid option for output_spectra_files: "
+                      << parameter_list.output_spectra_files;
+        music_message.flush("error");
+        exit(1);
+    }
+
+    if (parameter_list.number_of_sampled_events < 0) {
+        music_message.error("number_of_sampled_events < 0!");
+        exit(1);
+    }
+
+    if (parameter_list.hadron_sampler_seed < 0) {
+        music_message.error("hadron_sampler_seed < 0!");
+        exit(1);
+    }
+
+    if (parameter_list.cooper_frye_streaming < 0) {
+        music_message.error("cooper_frye_streaming < 0!");
+        exit(1);
+    }
+
+    if (   parameter_list.cooper_frye_streaming > 0
+        && (   parameter_list.mode != 1
+            || parameter_list.freeze_surface_single_file != 1)) {
+        // the chunks come from the in-memory surface of the hydro run
+        music_message << "cooper_frye_streaming > 0 requires mode = 1 "
+                      << "and freeze_surface_single_file = 1";
+        music_message.flush("error");
+        exit(1);
+    }
+
+    if (parameter_list.surface_coarsening_factor < 0) {
+        music_message << "surface_coarsening_factor < 0: "
+                      << parameter_list.surface_coarsening_factor;
+        music_message.flush("error");
+        exit(1);
+    }
+
+    if (   parameter_list.surface_coarsening_u_tolerance < 0.
+        || parameter_list.surface_coarsening_T_tolerance < 0.
+        || parameter_list.surface_coarsening_muB_tolerance < 0.
+        || parameter_list.surface_coarsening_W_tolerance < 0.) {
+        music_message.error("the surface_coarsening tolerances must not be "
+                            "negative!");
+        exit(1);
+    }
+
     if (parameter_list.facTau <= 0) {
         music_message << "average_surface_over_this_many_time_steps <= 0: "
                       << parameter_list.facTau;
@@ -1143,8 +1783,7 @@ void check_parameters(InitData &parameter_list, std::string input_file) {
 
         bool reset_dtau_use_CFL_condition = true;
         int temp_CFL_condition = 1;
-        string tempinput = Util::StringFind4(input_file,
-                                      "reset_dtau_use_CFL_condition");
+        string tempinput = parameters.find("reset_dtau_use_CFL_condition");
         if (tempinput != "empty")
             istringstream(tempinput) >> temp_CFL_condition;
         if (temp_CFL_condition == 0)
@@ -1154,7 +1793,8 @@ void check_parameters(InitData &parameter_list, std::string input_file) {
             music_message.info("reset dtau using CFL condition.");
             double dtau_CFL = std::min(
                     parameter_list.delta_x/10.0,
-                    parameter_list.tau0*parameter_list.delta_eta/10.0);
+                    (parameter_list.tau0
+                     *EtaGrid(parameter_list).get_min_width()/10.0));
             parameter_list.delta_tau = dtau_CFL;
             parameter_list.nt = static_cast<int>(
                 parameter_list.tau_size/(parameter_list.delta_tau) + 0.5);
@@ -1185,7 +1825,7 @@ void check_parameters(InitData &parameter_list, std::string input_file) {
         exit(1);
     }
 
-    if (parameter_list.rk_order > 2 || parameter_list.rk_order < 0) {
+    if (parameter_list.rk_order > 3 || parameter_list.rk_order < 1) {
         music_message << "Invalid option for Runge_Kutta_order: "
                       << parameter_list.rk_order;
         music_message.flush("error");
@@ -1235,11 +1875,330 @@ void check_parameters(InitData &parameter_list, std::string input_file) {
         parameter_list.include_deltaf_bulk = 0;
     }
 
+    if (   parameter_list.Wmunu_eigenvalue_solver < 0
+        || parameter_list.Wmunu_eigenvalue_solver > 2) {
+        music_message << "Invalid option for Wmunu_eigenvalue_solver: "
+                      << parameter_list.Wmunu_eigenvalue_solver;
+        music_message.flush("error");
+        exit(1);
+    }
+
+    if (   parameter_list.eta_boundary_condition < 0
+        || parameter_list.eta_boundary_condition > 1) {
+        music_message << "Invalid option for eta_boundary_condition: "
+                      << parameter_list.eta_boundary_condition;
+        music_message.flush("error");
+        exit(1);
+    }
+    if (   parameter_list.fused_rk_stage < 0
+        || parameter_list.fused_rk_stage > 1) {
+        music_message << "Invalid option for fused_rk_stage: "
+                      << parameter_list.fused_rk_stage;
+        music_message.flush("error");
+        exit(1);
+    }
+    if (   parameter_list.source_deposition < 0
+        || parameter_list.source_deposition > 1) {
+        music_message << "Invalid option for source_deposition: "
+                      << parameter_list.source_deposition;
+        music_message.flush("error");
+        exit(1);
+    }
+    if (   parameter_list.u_derivative_rows < 0
+        || parameter_list.u_derivative_rows > 1) {
+        music_message << "Invalid option for u_derivative_rows: "
+                      << parameter_list.u_derivative_rows;
+        music_message.flush("error");
+        exit(1);
+    }
+    if (   parameter_list.reconst_batch < 0
+        || parameter_list.reconst_batch > 1) {
+        music_message << "Invalid option for reconst_batch: "
+                      << parameter_list.reconst_batch;
+        music_message.flush("error");
+        exit(1);
+    }
+    if (   parameter_list.adaptive_dtau < 0
+        || parameter_list.adaptive_dtau > 1) {
+        music_message << "Invalid option for adaptive_dtau: "
+                      << parameter_list.adaptive_dtau;
+        music_message.flush("error");
+        exit(1);
+    }
+    if (parameter_list.adaptive_dtau == 1) {
+        if (parameter_list.adaptive_dtau_cfl <= 0.) {
+            music_message << "Invalid option for adaptive_dtau_cfl: "
+                          << parameter_list.adaptive_dtau_cfl;
+            music_message.flush("error");
+            exit(1);
+        }
+        if (parameter_list.adaptive_dtau_growth < 1.) {
+            music_message << "Invalid option for adaptive_dtau_growth: "
+                          << parameter_list.adaptive_dtau_growth;
+            music_message.flush("error");
+            exit(1);
+        }
+        if (parameter_list.adaptive_dtau_max_ratio < 1.) {
+            music_message << "Invalid option for adaptive_dtau_max_ratio: "
+                          << parameter_list.adaptive_dtau_max_ratio;
+            music_message.flush("error");
+            exit(1);
+        }
+    }
+    if (parameter_list.transverse_coarsening_levels < 0) {
+        music_message << "Invalid option for transverse_coarsening_levels: "
+                      << parameter_list.transverse_coarsening_levels;
+        music_message.flush("error");
+        exit(1);
+    }
+    if (parameter_list.transverse_coarsening_levels > 0) {
+        if (parameter_list.transverse_coarsening_threshold <= 0.) {
+            music_message << "Invalid option for "
+                          << "transverse_coarsening_threshold: "
+                          << parameter_list.transverse_coarsening_threshold;
+            music_message.flush("error");
+            exit(1);
+        }
+        // these keep per-cell data of the fine grid between the steps
+        auto reject = [&](const bool is_set, const std::string &option) {
+            if (!is_set) return;
+            music_message << "The transverse coarsening does not support "
+                          << option << "!";
+            music_message.flush("error");
+            exit(1);
+        };
+        reject(parameter_list.output_vorticity == 1, "output_vorticity");
+        reject(   parameter_list.checkpoint_every_N_timesteps > 0
+               || parameter_list.restart_from_checkpoint == 1,
+               "checkpoints");
+    }
+    if (   parameter_list.implicit_relaxation < 0
+        || parameter_list.implicit_relaxation > 1) {
+        music_message << "Invalid option for implicit_relaxation: "
+                      << parameter_list.implicit_relaxation;
+        music_message.flush("error");
+        exit(1);
+    }
+    if (parameter_list.face_flux < 0 || parameter_list.face_flux > 1) {
+        music_message << "Invalid option for face_flux: "
+                      << parameter_list.face_flux;
+        music_message.flush("error");
+        exit(1);
+    }
+    if (parameter_list.slope_limiter < 0 || parameter_list.slope_limiter > 2) {
+        music_message << "Invalid option for slope_limiter: "
+                      << parameter_list.slope_limiter;
+        music_message.flush("error");
+        exit(1);
+    }
+    if (parameter_list.slope_limiter != 0 && parameter_list.face_flux != 1) {
+        music_message << "slope_limiter = " << parameter_list.slope_limiter
+                      << " needs face_flux = 1";
+        music_message.flush("error");
+        exit(1);
+    }
+
+    if (parameter_list.log_level < 0 || parameter_list.log_level > 3) {
+        music_message << "Invalid option for log_level: "
+                      << parameter_list.log_level;
+        music_message.flush("error");
+        exit(1);
+    }
+
+    if (   parameter_list.output_movie_reductions < 0
+        || parameter_list.output_movie_reductions > 3) {
+        music_message << "Invalid option for output_movie_reductions: "
+                      << parameter_list.output_movie_reductions;
+        music_message.flush("error");
+        exit(1);
+    }
+
+    if (parameter_list.output_movie_block_size < 1) {
+        music_message << "Invalid option for output_movie_block_size: "
+                      << parameter_list.output_movie_block_size;
+        music_message.flush("error");
+        exit(1);
+    }
+
+    if (parameter_list.debug_snapshot_ring < 0) {
+        music_message << "Invalid option for debug_snapshot_ring: "
+                      << parameter_list.debug_snapshot_ring;
+        music_message.flush("error");
+        exit(1);
+    }
+
+    if (parameter_list.log_rate_limit < 0) {
+        music_message << "Invalid option for log_rate_limit: "
+                      << parameter_list.log_rate_limit;
+        music_message.flush("error");
+        exit(1);
+    }
+
+    if (   parameter_list.grid_traversal < 0
+        || parameter_list.grid_traversal > 3) {
+        music_message << "Invalid option for grid_traversal: "
+                      << parameter_list.grid_traversal;
+        music_message.flush("error");
+        exit(1);
+    }
+
+    if (   parameter_list.persistent_parallel_region < 0
+        || parameter_list.persistent_parallel_region > 1) {
+        music_message << "Invalid option for persistent_parallel_region: "
+                      << parameter_list.persistent_parallel_region;
+        music_message.flush("error");
+        exit(1);
+    }
+
+    if (   parameter_list.grid_first_touch < 0
+        || parameter_list.grid_first_touch > 1) {
+        music_message << "Invalid option for grid_first_touch: "
+                      << parameter_list.grid_first_touch;
+        music_message.flush("error");
+        exit(1);
+    }
+
+    if (   parameter_list.grid_huge_pages < 0
+        || parameter_list.grid_huge_pages > 1) {
+        music_message << "Invalid option for grid_huge_pages: "
+                      << parameter_list.grid_huge_pages;
+        music_message.flush("error");
+        exit(1);
+    }
+
+    if (   parameter_list.transport_coeffs_table < 0
+        || parameter_list.transport_coeffs_table > 1) {
+        music_message << "Invalid option for transport_coeffs_table: "
+                      << parameter_list.transport_coeffs_table;
+        music_message.flush("error");
+        exit(1);
+    }
+
+#ifndef MUSIC_PADDED_SWEEPS
+    if (parameter_list.eta_boundary_condition == 1) {
+        music_message.error(
+            "eta_boundary_condition = 1 needs the padded sweep grid!");
+        exit(1);
+    }
+#endif
+
+    if (parameter_list.causality_root_tolerance <= 0.) {
+        music_message.error("causality_root_tolerance <= 0!");
+        exit(1);
+    }
+
+    if (parameter_list.causality_diagnostics_stride < 0) {
+        music_message.error("causality_diagnostics_stride < 0!");
+        exit(1);
+    }
+
+    if (   parameter_list.causality_prescreen != 0
+        && parameter_list.causality_prescreen != 1) {
+        music_message << "causality_prescreen = "
+                      << parameter_list.causality_prescreen
+                      << " is not 0 or 1!";
+        music_message.flush("error");
+        exit(1);
+    }
+
+    if (   parameter_list.causality_statistics != 0
+        && parameter_list.causality_statistics != 1) {
+        music_message << "causality_statistics = "
+                      << parameter_list.causality_statistics
+                      << " is not 0 or 1!";
+        music_message.flush("error");
+        exit(1);
+    }
+
+    if (parameter_list.causality_sample_size < 0) {
+        music_message.error("causality_sample_size < 0!");
+        exit(1);
+    }
+
+    if (parameter_list.checkpoint_every_N_timesteps < 0) {
+        music_message.error("checkpoint_every_N_timesteps < 0!");
+        exit(1);
+    }
+
+    if (   parameter_list.restart_from_checkpoint < 0
+        || parameter_list.restart_from_checkpoint > 1) {
+        music_message << "Invalid option for restart_from_checkpoint: "
+                      << parameter_list.restart_from_checkpoint;
+        music_message.flush("error");
+        exit(1);
+    }
+
+    if (   parameter_list.checkpoint_every_N_timesteps > 0
+        || parameter_list.restart_from_checkpoint == 1) {
+        // these outputs are written beside the files of the checkpoint
+        auto reject = [&](const bool is_set, const std::string &option) {
+            if (!is_set) return;
+            music_message << "The checkpoints do not support " << option
+                          << "!";
+            music_message.flush("error");
+            exit(1);
+        };
+        reject(parameter_list.outputEvolutionData != 0,
+               "outputEvolutionData");
+        reject(parameter_list.output_movie_flag == 1, "output_movie_flag");
+        reject(parameter_list.output_movie_reductions != 0,
+               "output_movie_reductions");
+        reject(parameter_list.store_hydro_info_in_memory == 1,
+               "store_hydro_info_in_memory");
+        reject(parameter_list.output_outofequilibriumsize == 1,
+               "output_outofequilibriumsize");
+        reject(parameter_list.output_hydro_debug_info == 1,
+               "output_hydro_debug_info");
+        reject(parameter_list.freeze_surface_single_file == 1,
+               "freeze_surface_single_file = 1");
+    }
+
+    if (   parameter_list.instrumentation < 0
+        || parameter_list.instrumentation > 2) {
+        music_message << "Invalid option for instrumentation: "
+                      << parameter_list.instrumentation;
+        music_message.flush("error");
+        exit(1);
+    }
+
+    if (parameter_list.memory_budget_MB < 0.) {
+        music_message.error("memory_budget_MB < 0!");
+        exit(1);
+    }
+
+    if (parameter_list.omp_num_threads < 0) {
+        music_message.error("omp_num_threads < 0!");
+        exit(1);
+    }
+
+    if (parameter_list.autotune_steps < 2) {
+        music_message.error("autotune_steps < 2!");
+        exit(1);
+    }
+
+    if (parameter_list.autotune_tolerance < 0.) {
+        music_message.error("autotune_tolerance < 0!");
+        exit(1);
+    }
+
+    if (   parameter_list.autotune_load_profile < 0
+        || parameter_list.autotune_load_profile > 1) {
+        music_message << "Invalid option for autotune_load_profile: "
+                      << parameter_list.autotune_load_profile;
+        music_message.flush("error");
+        exit(1);
+    }
+
     if (parameter_list.output_evolution_every_N_timesteps <= 0) {
         music_message.error("output_evolution_every_N_timesteps < 0!");
         exit(1);
     }
 
+    if (parameter_list.output_observables_every_N_timesteps <= 0) {
+        music_message.error("output_observables_every_N_timesteps < 0!");
+        exit(1);
+    }
+
     if (parameter_list.output_evolution_every_N_x <= 0) {
         music_message.error("output_evolution_every_N_x < 0!");
         exit(1);
@@ -1255,6 +2214,71 @@ void check_parameters(InitData &parameter_list, std::string input_file) {
         exit(1);
     }
 
+    if (!ChunkedEvolutionWriter::codec_is_available(
+                                    parameter_list.output_evolution_codec)) {
+        music_message << "Invalid option for output_evolution_codec: "
+                      << parameter_list.output_evolution_codec
+                      << " (zlib needs MUSIC compiled with -DZLIB)";
+        music_message.flush("error");
+        exit(1);
+    }
+
+    if (parameter_list.output_evolution_buffers < 0) {
+        music_message << "Invalid option for output_evolution_buffers: "
+                      << parameter_list.output_evolution_buffers;
+        music_message.flush("error");
+        exit(1);
+    }
+
+    if (parameter_list.store_hydro_info_T_cut < 0.) {
+        music_message << "Invalid option for store_hydro_info_T_cut: "
+                      << parameter_list.store_hydro_info_T_cut;
+        music_message.flush("error");
+        exit(1);
+    }
+
+    if (parameter_list.eta_grid_stretching < 0.) {
+        music_message << "Invalid option for eta_grid_stretching: "
+                      << parameter_list.eta_grid_stretching;
+        music_message.flush("error");
+        exit(1);
+    }
+    if (   parameter_list.eta_grid_stretching > 0.
+        && !parameter_list.boost_invariant) {
+        // these outputs describe the eta slices by a uniform spacing
+        const bool uniform_outputs = (
+               (   parameter_list.outputEvolutionData != 0
+                && parameter_list.outputEvolutionData != 1
+                && parameter_list.outputEvolutionData != 3)
+            || parameter_list.output_movie_flag == 1
+            || parameter_list.output_movie_reductions != 0
+            || parameter_list.store_hydro_info_in_memory == 1);
+        if (uniform_outputs) {
+            music_message << "eta_grid_stretching = "
+                          << parameter_list.eta_grid_stretching
+                          << " is not supported by the evolution outputs "
+                          << "on a uniform eta grid (output_evolution_data "
+                          << "= 1 and 3 write the eta slices of "
+                          << "eta_grid.dat)";
+            music_message.flush("error");
+            exit(1);
+        }
+    }
+
+    if (parameter_list.store_hydro_info_memory_slices < 0) {
+        music_message << "Invalid option for store_hydro_info_memory_slices: "
+                      << parameter_list.store_hydro_info_memory_slices;
+        music_message.flush("error");
+        exit(1);
+    }
+
+    if (parameter_list.store_hydro_info_cache_slices < 1) {
+        music_message << "Invalid option for store_hydro_info_cache_slices: "
+                      << parameter_list.store_hydro_info_cache_slices;
+        music_message.flush("error");
+        exit(1);
+    }
+
     if (parameter_list.dNdy_y_min > parameter_list.dNdy_y_max) {
         music_message << "dNdy_y_min = " << parameter_list.dNdy_y_min << " < " 
                       << "dNdy_y_max = " << parameter_list.dNdy_y_max << "!";
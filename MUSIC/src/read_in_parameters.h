@@ -7,12 +7,19 @@
 #include "util.h"
 #include "emoji.h"
 #include "pretty_ostream.h"
+#include "parameter_registry.h"
 
 //! This class handles read in parameters
 namespace ReadInParameters {
     InitData read_in_parameters(std::string input_file);
-    void check_parameters(InitData &parameter_list, std::string input_file);
-    void set_parameter(InitData &parameter_list, std::string parameter_name,
+    //! reads the parameters from the registry and warns about the
+    //! parameters which are not used
+    InitData read_in_parameters(ParameterRegistry &parameters);
+    void check_parameters(InitData &parameter_list,
+                          ParameterRegistry &parameters);
+    //! changes a run-time parameter in parameter_list, returns false if
+    //! parameter_name is not one of them
+    bool set_parameter(InitData &parameter_list, std::string parameter_name,
                        double value);
 }
 
@@ -1,4 +1,8 @@
 // Copyright 2011 @ Bjoern Schenke, Sangyong Jeon, and Charles Gale
+#ifdef _OPENMP
+    #include <omp.h>
+#endif
+
 #include <iostream>
 #include <algorithm>
 #include <cmath>
@@ -6,6 +10,12 @@
 #include "grid.h"
 #include "eos.h"
 #include "reconst.h"
+#include "instrumentation.h"
+
+#ifndef _OPENMP
+    #define omp_get_thread_num() 0
+    #define omp_get_max_threads() 1
+#endif
 
 Reconst::Reconst(const EOS &eosIn, const int echo_level_in) :
     eos(eosIn),
@@ -14,12 +24,15 @@ Reconst::Reconst(const EOS &eosIn, const int echo_level_in) :
     abs_err(1e-16),
     LARGE(1e20),
     v_critical(0.563624),
-    echo_level(echo_level_in) {}
+    echo_level(echo_level_in),
+    iteration_histograms(omp_get_max_threads(),
+                         std::vector<long long>(max_iter + 2, 0)) {}
 
 
 
 ReconstCell Reconst::ReconstIt_shell(double tau, const TJbVec &tauq_vec,
                                      const Cell_small &grid_pt) {
+    ScopedTimer timer(InstrumentedTimer::reconstruction);
     ReconstCell grid_p1;
 
     TJbVec q_vec;
@@ -39,6 +52,327 @@ ReconstCell Reconst::ReconstIt_shell(double tau, const TJbVec &tauq_vec,
 }
 
 
+void Reconst::ReconstIt_batch(const double tau, const int n,
+                              const TJbVec *tauq_vec,
+                              const Cell_small &grid_pt,
+                              ReconstCell *grid_p) {
+    ScopedTimer timer(InstrumentedTimer::reconstruction);
+    for (int i0 = 0; i0 < n; i0 += max_batch) {
+        ReconstIt_batch_chunk(tau, std::min(max_batch, n - i0),
+                              tauq_vec + i0, grid_pt, grid_p + i0);
+    }
+}
+
+
+//! This function reconstructs up to max_batch cells with the steps of
+//! ReconstIt_velocity_Newton. The hybrid velocity solver runs for all
+//! the cells in lock step, with one batched EOS call per iteration for
+//! the cells that have not converged yet. It starts from the velocity of
+//! grid_pt instead of the middle of [0, 1], which saves most of the
+//! bisection steps because the half-way cells are close to grid_pt.
+void Reconst::ReconstIt_batch_chunk(const double tau, const int n,
+                                    const TJbVec *tauq_vec,
+                                    const Cell_small &grid_pt,
+                                    ReconstCell *grid_p) {
+    double T00[max_batch], K00[max_batch], M[max_batch], J0[max_batch];
+    int flag[max_batch];
+    for (int i = 0; i < n; i++) {
+        T00[i] = tauq_vec[i][0]/tau;
+        J0[i]  = tauq_vec[i][4]/tau;
+        const double q1 = tauq_vec[i][1]/tau;
+        const double q2 = tauq_vec[i][2]/tau;
+        const double q3 = tauq_vec[i][3]/tau;
+        K00[i] = q1*q1 + q2*q2 + q3*q3;
+        M[i]   = sqrt(K00[i]);
+        flag[i] = 1;
+        if (T00[i] < abs_err) {
+            flag[i] = -2;
+        } else if (T00[i] < M[i]) {
+            if (echo_level > 9) {
+                music_message.warning(
+                            "Reconst:: can not find solution! Revert back~");
+                music_message << "T00 = " << T00[i] << ", M = " << M[i];
+                music_message.flush("warning");
+            }
+            flag[i] = -1;
+        }
+    }
+
+    double v_guess = sqrt(1. - 1./(grid_pt.u[0]*grid_pt.u[0] + abs_err));
+    if (!(v_guess > 0. && v_guess < 1.)) v_guess = 0.5;
+
+    // the hybrid solver of solve_v_Hybrid, one lane per cell
+    double v_l[max_batch], v_h[max_batch], fv_l[max_batch], fv_h[max_batch];
+    double v_root[max_batch], fv[max_batch], dfdv[max_batch];
+    double dv_prev[max_batch], dv_curr[max_batch];
+    double abs_error_v[max_batch], rel_error_v[max_batch];
+    int iter_v[max_batch];
+    int lane[2*max_batch];
+    double v_eval[2*max_batch], T00_eval[2*max_batch], M_eval[2*max_batch];
+    double J0_eval[2*max_batch], f_eval[2*max_batch], df_eval[2*max_batch];
+
+    // f at the ends of the bracket
+    int m = 0;
+    for (int i = 0; i < n; i++) {
+        if (flag[i] != 1) continue;
+        v_l[i] = 0.;
+        v_h[i] = 1.;
+        lane[m] = i; v_eval[m] = v_l[i]; m++;
+        lane[m] = i; v_eval[m] = v_h[i]; m++;
+    }
+    for (int k = 0; k < m; k++) {
+        T00_eval[k] = T00[lane[k]];
+        M_eval[k]   = M[lane[k]];
+        J0_eval[k]  = J0[lane[k]];
+    }
+    reconst_velocity_fdf_batch(m, lane, v_eval, T00_eval, M_eval, J0_eval,
+                               f_eval, df_eval);
+    for (int k = 0; k < m; k += 2) {
+        fv_l[lane[k]] = f_eval[k];
+        fv_h[lane[k]] = f_eval[k + 1];
+    }
+
+    // bracket checks, and f at the warm start
+    m = 0;
+    for (int i = 0; i < n; i++) {
+        if (flag[i] != 1) continue;
+        iter_v[i] = 0;
+        if (std::abs(fv_l[i]) < abs_err) {
+            v_root[i] = v_l[i];
+            record_iterations(0);
+            continue;
+        }
+        if (std::abs(fv_h[i]) < abs_err) {
+            v_root[i] = v_h[i];
+            record_iterations(0);
+            continue;
+        }
+        if (fv_l[i]*fv_h[i] > 0.) {
+            music_message.error(
+                    "Reconst velocity Hybrid:: can not find solution!");
+            record_iterations(max_iter + 1);
+            flag[i] = -1;
+            continue;
+        }
+        dv_prev[i] = v_h[i] - v_l[i];
+        dv_curr[i] = dv_prev[i];
+        v_root[i]  = v_guess;
+        lane[m] = i; v_eval[m] = v_root[i]; m++;
+    }
+
+    int n_active = m;
+    while (n_active > 0) {
+        for (int k = 0; k < n_active; k++) {
+            T00_eval[k] = T00[lane[k]];
+            M_eval[k]   = M[lane[k]];
+            J0_eval[k]  = J0[lane[k]];
+        }
+        reconst_velocity_fdf_batch(n_active, lane, v_eval, T00_eval, M_eval,
+                                   J0_eval, f_eval, df_eval);
+        int n_next = 0;
+        for (int k = 0; k < n_active; k++) {
+            const int i = lane[k];
+            fv[i]   = f_eval[k];
+            dfdv[i] = df_eval[k];
+            if (iter_v[i] > 0) {
+                // bracket update and convergence of the last step
+                if (fv[i]*fv_l[i] < 0.) {
+                    v_h[i]  = v_root[i];
+                    fv_h[i] = fv[i];
+                } else {
+                    v_l[i]  = v_root[i];
+                    fv_l[i] = fv[i];
+                }
+                if (iter_v[i] > max_iter) {
+                    if (echo_level > 5) {
+                        music_message.warning(
+                            "Reconst velocity Hybrid:: can not find solution!");
+                    }
+                    record_iterations(max_iter + 1);
+                    flag[i] = -1;
+                    continue;
+                }
+                if (!(   std::abs(abs_error_v[i]) > abs_err
+                      && std::abs(rel_error_v[i]) > rel_err)) {
+                    record_iterations(iter_v[i]);
+                    continue;
+                }
+            }
+            // next step, Newton's if it stays in the bracket and
+            // converges fast enough, bisection otherwise
+            iter_v[i]++;
+            const bool bisect = (
+                ((v_root[i] - v_h[i])*dfdv[i] - fv[i])
+                *((v_root[i] - v_l[i])*dfdv[i] - fv[i]) > 0.
+                || (std::abs(2.*fv[i]) > std::abs(dv_prev[i]*dfdv[i])));
+            dv_prev[i] = dv_curr[i];
+            if (bisect) {
+                dv_curr[i] = (v_h[i] - v_l[i])/2.;
+                v_root[i]  = v_l[i] + dv_curr[i];
+            } else {
+                dv_curr[i] = fv[i]/dfdv[i];
+                v_root[i]  = v_root[i] - dv_curr[i];
+            }
+            abs_error_v[i] = dv_curr[i];
+            rel_error_v[i] = abs_error_v[i]/(v_root[i] + abs_err);
+            lane[n_next]   = i;
+            v_eval[n_next] = v_root[i];
+            n_next++;
+        }
+        n_active = n_next;
+    }
+
+    // u^0, e, and rhob from the velocity
+    double u0[max_batch], epsilon[max_batch], rhob[max_batch];
+    for (int i = 0; i < n; i++) {
+        if (flag[i] != 1) continue;
+        const double v_solution = v_root[i];
+        u0[i] = 1./(sqrt(1. - v_solution*v_solution) + v_solution*abs_err);
+        epsilon[i] = T00[i] - v_solution*sqrt(K00[i]);
+        rhob[i] = J0[i]/u0[i];
+        if (v_solution > v_critical) {
+            // for large velocity, solve u0
+            double u0_solution = u0[i];
+            int u0_status = solve_u0_Hybrid(u0[i], T00[i], K00[i], M[i],
+                                            J0[i], u0_solution);
+            if (u0_status == 1) {
+                u0[i] = u0_solution;
+                epsilon[i] = T00[i] - sqrt((1. - 1./(u0_solution*u0_solution))
+                                           *K00[i]);
+                rhob[i] = J0[i]/u0_solution;
+            }
+        }
+        double check_u0_var = std::abs(u0[i] - grid_pt.u[0])/grid_pt.u[0];
+        if (check_u0_var > 100.) {
+            if (grid_pt.epsilon > 1e-6 && echo_level > 2) {
+                music_message << "Reconst velocity Newton:: "
+                              << "u0 varies more than 100 times compared to "
+                              << "its value at previous time step";
+                music_message.flush("warning");
+                music_message << "e = " << grid_pt.epsilon
+                              << ", u[0] = " << u0[i]
+                              << ", prev_u[0] = " << grid_pt.u[0];
+                music_message.flush("warning");
+            }
+            flag[i] = -1;
+        }
+    }
+
+    m = 0;
+    for (int i = 0; i < n; i++) {
+        if (flag[i] != 1) continue;
+        lane[m] = i;
+        v_eval[m] = epsilon[i];
+        T00_eval[m] = rhob[i];
+        m++;
+    }
+    eos.get_pressure_batch(v_eval, T00_eval, f_eval, m);
+    for (int k = 0; k < m; k++) {
+        const int i = lane[k];
+        const double *q = tauq_vec[i].data();
+        const double velocity_inverse_factor = u0[i]/(T00[i] + f_eval[k]);
+        double u[4];
+        u[0] = u0[i];
+        u[1] = q[1]/tau*velocity_inverse_factor;
+        u[2] = q[2]/tau*velocity_inverse_factor;
+        u[3] = q[3]/tau*velocity_inverse_factor;
+
+        // Correcting normalization of 4-velocity
+        const double u_mag_sq = u[1]*u[1] + u[2]*u[2] + u[3]*u[3];
+        if (std::abs(u[0]*u[0] - u_mag_sq - 1.0) > abs_err) {
+            const double scalef = sqrt((u[0]*u[0] - 1.)/(u_mag_sq + abs_err));
+            u[1] *= scalef;
+            u[2] *= scalef;
+            u[3] *= scalef;
+        }
+        grid_p[i].e    = epsilon[i];
+        grid_p[i].rhob = rhob[i];
+        for (int mu = 0; mu < 4; mu++) {
+            grid_p[i].u[mu] = u[mu];
+        }
+    }
+
+    for (int i = 0; i < n; i++) {
+        if (flag[i] == -1) {
+            revert_grid(grid_p[i], grid_pt);
+        } else if (flag[i] == -2) {
+            regulate_grid(grid_p[i], T00[i]);
+        }
+    }
+}
+
+
+void Reconst::reconst_velocity_fdf_batch(const int m, const int *lane,
+                                         const double *v, const double *T00,
+                                         const double *M, const double *J0,
+                                         double *fv, double *dfdv) const {
+    double epsilon[2*max_batch], rho[2*max_batch];
+    double pressure[2*max_batch], dPde[2*max_batch], dPdrho[2*max_batch];
+    #pragma omp simd
+    for (int k = 0; k < m; k++) {
+        epsilon[k] = T00[k] - v[k]*M[k];
+        rho[k]     = J0[k]*sqrt(1. - v[k]*v[k]);
+    }
+    eos.get_pressure_batch(epsilon, rho, pressure, m);
+    eos.get_dpde_batch    (epsilon, rho, dPde,     m);
+    eos.get_dpdrhob_batch (epsilon, rho, dPdrho,   m);
+    #pragma omp simd
+    for (int k = 0; k < m; k++) {
+        const double temp  = sqrt(1. - v[k]*v[k]);
+        const double temp1 = T00[k] + pressure[k];
+        const double temp2 = v[k]/temp;
+        fv[k]   = v[k] - M[k]/temp1;
+        dfdv[k] = 1. - M[k]/(temp1*temp1)*(M[k]*dPde[k]
+                                             + J0[k]*temp2*dPdrho[k]);
+    }
+}
+
+
+void Reconst::record_iterations(const int n_iter) {
+    if (n_iter > max_iter) {
+        Instrumentation::count(InstrumentedCounter::reconst_failures);
+    }
+    if (iteration_histograms.empty()) return;
+    iteration_histograms[omp_get_thread_num()][
+                            std::min(n_iter, max_iter + 1)]++;
+}
+
+
+std::vector<long long> Reconst::get_iteration_histogram() const {
+    std::vector<long long> histogram(max_iter + 2, 0);
+    for (const auto &histogram_i : iteration_histograms) {
+        for (unsigned int i = 0; i < histogram_i.size(); i++) {
+            histogram[i] += histogram_i[i];
+        }
+    }
+    return(histogram);
+}
+
+
+//! This function prints the number of iterations of the velocity solver
+void Reconst::print_iteration_histogram() {
+    const auto histogram = get_iteration_histogram();
+    long long n_solves = 0;
+    double sum = 0.;
+    for (int i = 0; i <= max_iter; i++) {
+        n_solves += histogram[i];
+        sum += static_cast<double>(i)*histogram[i];
+    }
+    n_solves += histogram[max_iter + 1];
+    if (n_solves == 0) return;
+    music_message << "Reconst: " << n_solves << " velocity solves, "
+                  << sum/std::max(1LL, n_solves - histogram[max_iter + 1])
+                  << " iterations on average, "
+                  << histogram[max_iter + 1] << " failed";
+    music_message.flush("info");
+    music_message << "Reconst: iterations histogram:";
+    for (int i = 0; i <= max_iter; i++) {
+        if (histogram[i] > 0) music_message << " " << i << ":" << histogram[i];
+    }
+    music_message.flush("info");
+}
+
+
 //! This function reverts the grid information back its values
 //! at the previous time step
 void Reconst::revert_grid(ReconstCell &grid_current,
@@ -207,10 +541,12 @@ int Reconst::solve_v_Hybrid(const double v_guess, const double T00,
     reconst_velocity_fdf(v_h, T00, M, J0, fv_h, dfdv_h);
     if (std::abs(fv_l) < abs_err) {
         v_solution = v_l;
+        record_iterations(0);
         return(1);
     }
     if (std::abs(fv_h) < abs_err) {
         v_solution = v_h;
+        record_iterations(0);
         return(1);
     }
 
@@ -218,6 +554,7 @@ int Reconst::solve_v_Hybrid(const double v_guess, const double T00,
         v_status = 0;
         music_message.error(
                 "Reconst velocity Hybrid:: can not find solution!");
+        record_iterations(max_iter + 1);
         return(v_status);
     }
 
@@ -258,6 +595,7 @@ int Reconst::solve_v_Hybrid(const double v_guess, const double T00,
     } while (   std::abs(abs_error_v) > abs_err
              && std::abs(rel_error_v) > rel_err);
     v_solution = v_root;
+    record_iterations(v_status == 1 ? iter_v : max_iter + 1);
 
     if (v_status == 0 && echo_level > 5) {
         music_message.warning(
@@ -4,6 +4,7 @@
 
 #include <array>
 #include <iostream>
+#include <vector>
 #include "util.h"
 #include "cell.h"
 #include "grid.h"
@@ -25,6 +26,25 @@ class Reconst {
     const double v_critical;
     const int echo_level;
 
+    //! iteration counts of the velocity solver, one histogram per thread
+    std::vector<std::vector<long long>> iteration_histograms;
+
+    //! number of cells reconstructed together by ReconstIt_batch
+    static constexpr int max_batch = 16;
+
+    void record_iterations(const int n_iter);
+
+    void ReconstIt_batch_chunk(const double tau, const int n,
+                               const TJbVec *tauq_vec,
+                               const Cell_small &grid_pt,
+                               ReconstCell *grid_p);
+
+    //! reconst_velocity_fdf for the cells lane[0..m-1] of a batch
+    void reconst_velocity_fdf_batch(const int m, const int *lane,
+                                    const double *v, const double *T00,
+                                    const double *M, const double *J0,
+                                    double *fv, double *dfdv) const;
+
  public:
     Reconst() = default;
     Reconst(const EOS &eos, const int echo_level_in);
@@ -32,6 +52,17 @@ class Reconst {
     ReconstCell ReconstIt_shell(double tau, const TJbVec &tauq_vec,
                                 const Cell_small &grid_pt);
 
+    //! reconstructs the n cells tauq_vec[i] next to grid_pt, the same as
+    //! ReconstIt_shell for every one of them
+    void ReconstIt_batch(const double tau, const int n,
+                         const TJbVec *tauq_vec, const Cell_small &grid_pt,
+                         ReconstCell *grid_p);
+
+    //! number of velocity solves that needed i iterations,
+    //! summed over the threads; the last bin counts the failures
+    std::vector<long long> get_iteration_histogram() const;
+    void print_iteration_histogram();
+
     int get_max_iter() const {return(max_iter);}
     int get_echo_level() const {return(echo_level);}
     double get_abs_err() const {return(abs_err);}
@@ -492,3 +492,56 @@ TEST_CASE("Test reconst main function") {
     CHECK(cell_sol.u[3] == doctest::Approx(ueta).epsilon(ueta*2e-8));
 }
 
+
+
+TEST_CASE("Test reconst batch function") {
+    EOS eos_ideal(0);
+    Reconst reconst_test(eos_ideal, 9);
+
+    Cell_small temp_grid;
+    temp_grid.epsilon = 1.0;
+    temp_grid.u       = {1.5, 0.0, 0.0, 0.0};
+    temp_grid.Wmunu   = {0.0};
+
+    // more cells than one chunk, with T00 = 0 and T00 < M among them
+    const double tau = 1.7;
+    const int n_cells = 21;
+    std::vector<TJbVec> tauq_vec(n_cells);
+    for (int i = 0; i < n_cells; i++) {
+        const double e_local    = 0.1 + 0.37*i;
+        const double rhob_local = 0.05*(i % 4);
+        const double p_local    = eos_ideal.get_pressure(e_local, rhob_local);
+        const double ux         = 0.2*i - 1.5;
+        const double uy         = 0.1*(i % 3);
+        const double ueta       = 0.04*i;
+        const double utau       = sqrt(1. + ux*ux + uy*uy + ueta*ueta);
+        tauq_vec[i] = {tau*((e_local + p_local)*utau*utau - p_local),
+                       tau*(e_local + p_local)*utau*ux,
+                       tau*(e_local + p_local)*utau*uy,
+                       tau*(e_local + p_local)*utau*ueta,
+                       tau*rhob_local*utau};
+    }
+    tauq_vec[5]  = {0.};
+    tauq_vec[17] = {1.0, 2.0, 0.0, 0.0, 0.0};
+
+    std::vector<ReconstCell> cells_batch(n_cells);
+    reconst_test.ReconstIt_batch(tau, n_cells, tauq_vec.data(), temp_grid,
+                                 cells_batch.data());
+    const auto histogram = reconst_test.get_iteration_histogram();
+    long long n_solves = 0;
+    for (const auto &count_i : histogram) n_solves += count_i;
+    CHECK(n_solves == n_cells - 2);
+
+    for (int i = 0; i < n_cells; i++) {
+        const auto cell_i = reconst_test.ReconstIt_shell(tau, tauq_vec[i],
+                                                         temp_grid);
+        CHECK(cells_batch[i].e == doctest::Approx(cell_i.e).epsilon(1e-12));
+        CHECK(cells_batch[i].rhob
+              == doctest::Approx(cell_i.rhob).epsilon(1e-12));
+        for (int mu = 0; mu < 4; mu++) {
+            CHECK(cells_batch[i].u[mu]
+                  == doctest::Approx(cell_i.u[mu]).epsilon(1e-12));
+        }
+    }
+    CHECK(cells_batch[17].u[0] == temp_grid.u[0]);
+}
@@ -12,8 +12,29 @@
 
 #include <cmath>
 #include "freeze.h"
+#include "gauss_legendre.h"
 #include "int.h"
 
+namespace {
+
+//! the Gauss-Legendre rule of n points from the tables of int.h
+GaussLegendre get_gauss_rule(const int n) {
+    switch (n) {
+        case 4:  return(GaussLegendre(n, gaulep4, gaulew4));
+        case 8:  return(GaussLegendre(n, gaulep8, gaulew8));
+        case 10: return(GaussLegendre(n, gaulep10, gaulew10));
+        case 12: return(GaussLegendre(n, gaulep12, gaulew12));
+        case 16: return(GaussLegendre(n, gaulep16, gaulew16));
+        case 20: return(GaussLegendre(n, gaulep20, gaulew20));
+        case 48: return(GaussLegendre(n, gaulep48, gaulew48));
+        default:
+            printf("\ngauss():%d points not in list\n", n);
+            exit(0);
+    }
+}
+
+}  // namespace
+
 /*************************************************
 *
 *   Edndp3
@@ -21,18 +42,16 @@
 * 
 **************************************************/
 // This function interpolates the needed spectra for a given y, pt and phi.
-double Freeze::Edndp3(double yr, double ptr, double phirin, int res_num) {
+double Freeze::Edndp3(double yr, double ptr, double phir, int pn) {
 // if pseudofreeze flag is set, yr is the *pseudorapidity* of the resonance
-    if (phirin < 0.0) {
-        printf("ERROR: phir %15.8le < 0 !!! \n", phirin);
+    if (phir < 0.0) {
+        printf("ERROR: phir %15.8le < 0 !!! \n", phir);
         exit(0);
     }
-    if(phirin > 2.0*M_PI) {
-        printf("ERROR: phir %15.8le > 2PI !!! \n", phirin);
+    if(phir > 2.0*M_PI) {
+        printf("ERROR: phir %15.8le > 2PI !!! \n", phir);
         exit(0);
     }
-    double phir = phirin;
-    int pn = partid[MHALF + res_num];
 
     // If pseudofreeze flag is set,
     // dNdydptdphi is on a fixed grid in pseudorapidity. 
@@ -51,17 +70,22 @@ double Freeze::Edndp3(double yr, double ptr, double phirin, int res_num) {
         return 0.;
     }
 
-    int nphi = 1; 
-    while ((phir > phiArray[nphi]) && (nphi<(particleList[pn].nphi-1))) {
-        nphi++;
-    }
-    int npt = 1; 
-    while (ptr > particleList[pn].pt[npt] && npt<(particleList[pn].npt - 1)) {
-        npt++;
-    }
-    int ny = 1; 
-    while (yr > particleList[pn].y[ny] && ny < (particleList[pn].ny - 1)) {
-        ny++;
+    // find the bins from the uniform phi and y grids and the quadratic
+    // pT grid directly instead of scanning the grids
+    const Particle &particle = particleList[pn];
+    int nphi = SpectrumGrid::get_upper_index(
+        phiArray, particle.nphi, phir, phir*particle.nphi/(2.*M_PI));
+    int npt = SpectrumGrid::get_upper_index(
+        particle.pt, particle.npt, ptr,
+        SpectrumGrid::get_quadratic_index(ptr, particle.pt[0],
+                                          particle.pt[particle.npt - 1],
+                                          particle.npt));
+    int ny = 1;
+    if (particle.ny > 1) {
+        ny = SpectrumGrid::get_upper_index(
+            particle.y, particle.ny, yr,
+            SpectrumGrid::get_uniform_index(yr, particle.y[0],
+                                            1./particle.deltaY));
     }
 
     /* phi interpolation */
@@ -96,7 +120,7 @@ double Freeze::Edndp3(double yr, double ptr, double phirin, int res_num) {
     }
   
     if (std::isnan(val1)) {
-        fprintf(stderr,"\n number=%d\n\n",res_num);
+        fprintf(stderr,"\n number=%d\n\n",particleList[pn].number);
         fprintf(stderr,"val1=%f\n",val1);
         fprintf(stderr,"f1=%f\n",f1);
         fprintf(stderr,"f2=%f\n",f2);
@@ -123,6 +147,11 @@ double Freeze::Edndp3(double yr, double ptr, double phirin, int res_num) {
         fprintf(stderr,"y2=%f\n",particleList[pn].y[ny]);
     }
 
+    // a spectrum with a single rapidity point needs no y interpolation
+    if (particle.ny < 2) {
+        return(val1);
+    }
+
     f1 = Util::lin_int(phiArray[nphi-1], phiArray[nphi], 
                        particleList[pn].dNdydptdphi[ny][npt-1][nphi-1], 
                        particleList[pn].dNdydptdphi[ny][npt-1][nphi], phir);
@@ -186,152 +215,129 @@ double Freeze::Edndp3(double yr, double ptr, double phirin, int res_num) {
 }
 
 
-double Freeze::dnpir2N (double phi, void *para1)    
-{
-  pblockN *para = (pblockN *) para1;
-  double D;
-  double eR, plR, ptR, yR, phiR, sume, jac;
-  double cphiR, sphiR;
-  double dnr;           /* dn/mtdmt of resonance */
-  
-  sume = para->e + para->e0;
-
-  D = para->e * para->e0 + para->pl * para->p0 * para->costh +
-    para->pt * para->p0 * para->sinth * cos (phi) + para->m1 * para->m1;
-
-  eR = para->mr * (sume * sume / D - 1.0);
-  jac = para->mr + eR;
-  plR = para->mr * sume * (para->pl - para->p0 * para->costh) / D;
-  ptR = (eR * eR - plR * plR - para->mr * para->mr);
-
-  if (ptR < 0.0)
-    ptR = 0.0;
-
-  else
-    ptR = sqrt (ptR);
-
-  yR = 0.5 * log ((eR + plR) / (eR - plR));
-  cphiR = -jac * (para->p0 * para->sinth * cos (phi + para->phi)
-          - para->pt * cos (para->phi)) / (sume * ptR);
-  sphiR = -jac * (para->p0 * para->sinth * sin (phi + para->phi)
-          - para->pt * sin (para->phi)) / (sume * ptR);
-
-  if ((fabs (cphiR) > 1.000) || (fabs (sphiR) > 1.000))
-    {
-      if ((fabs (cphiR) > 1.01) || (fabs (sphiR) > 1.01))
-    {
-      //  printf ("  |phir| = %15.8lf  > 1 ! \n", phiR);
-      printf (" phi %15.8le D %15.8le \n", phi, D);
-      printf (" eR %15.8le plR %15.8le \n", eR, plR);
-      printf (" ptR %15.8le jac %15.8le \n", ptR, jac);
-      printf (" sume %15.8le costh %15.8le \n", sume, para->costh);
-
-      printf (" pt %15.8le \n", para->pt);
-      printf (" mt  %15.8le \n", para->mt);
-      printf (" y %15.8le \n", para->y);
-      printf (" e %15.8le \n", para->e);
-      printf (" e0 %15.8le \n", para->e0);
-      printf (" p0 %15.8le \n", para->p0);
-      printf (" pl %15.8le \n", para->pl);
-      printf (" phi %15.8le \n", para->phi);
-
-      printf (" m1 %15.8le \n", para->m1);
-      printf (" m2 %15.8le \n", para->m2);
-      printf (" m3 %15.8le \n", para->m3);
-      printf (" mr %15.8le \n", para->mr);
-      if (cphiR > 1.0)
-        cphiR = 1.0;
-      if (cphiR < -1.0)
-        cphiR = -1.0;
-      //exit (0);
-    }
-      else
-    {
-      if (cphiR > 1.0)
-        cphiR = 1.0;
-      if (cphiR < -1.0)
-        cphiR = -1.0;
-    }
+void Freeze::Edndp3(int n, const double *yr, const double *ptr,
+                    const double *phir, int res_num, double *values) {
+    const int pn = partid[MHALF + res_num];
+    for (int i = 0; i < n; i++) {
+        values[i] = Edndp3(yr[i], ptr[i], phir[i], pn);
     }
+}
 
-  phiR = acos (cphiR);
-  if (sphiR < 0.0)
-    phiR = 2.0 * M_PI - phiR;
 
-  dnr = Edndp3 (yR, ptR, phiR, para->res_num);
+//! The kinematics of the resonance at the phi nodes do not depend on each
+//! other, so they are computed for all the nodes first, then the spectrum
+//! of the resonance is interpolated at all of them.
+void Freeze::dnpir2N(const DecayKinematics &kin, double e0, double p0,
+                     double costh, double *values) {
+    const double sinth = sqrt(1.0 - costh*costh);
+    const double mr = kin.mr;
+    const double sume = kin.e + e0;
+    const double sume2 = sume*sume;
+    const double D0 = kin.e*e0 + kin.pl*p0*costh;
+    const double D1 = kin.pt*p0*sinth;
+    const double plR_numerator = mr*sume*(kin.pl - p0*costh);
+    const double p0_sinth = p0*sinth;
+
+    double yR[PTN2], ptR[PTN2], phiR[PTN2], jac[PTN2];
+    for (int i = 0; i < PTN2; i++) {
+        const double D = D0 + D1*kin.cos_phi_node[i] + kin.m1*kin.m1;
+        const double eR = mr*(sume2/D - 1.0);
+        jac[i] = mr + eR;
+        const double plR = plR_numerator/D;
+        double ptR2 = (eR*eR - plR*plR - mr*mr);
+        if (ptR2 < 0.0) {
+            ptR[i] = 0.0;
+        } else {
+            ptR[i] = sqrt(ptR2);
+        }
 
-  /*printf(" phir = %15.8lf  ! ", phiR);
-     printf(" ptR %15.8le jac %15.8le ", ptR, jac );
-     printf(" dnr %15.8le \n", dnr); */
+        yR[i] = 0.5*log((eR + plR)/(eR - plR));
+        double cphiR = -jac[i]*(p0_sinth*kin.cos_phi_shifted[i]
+                                - kin.pt_cos_phi)/(sume*ptR[i]);
+        const double sphiR = -jac[i]*(p0_sinth*kin.sin_phi_shifted[i]
+                                      - kin.pt_sin_phi)/(sume*ptR[i]);
+
+        if ((fabs(cphiR) > 1.01) || (fabs(sphiR) > 1.01)) {
+            printf(" phi node %d D %15.8le \n", i, D);
+            printf(" eR %15.8le plR %15.8le \n", eR, plR);
+            printf(" ptR %15.8le jac %15.8le \n", ptR[i], jac[i]);
+            printf(" sume %15.8le costh %15.8le \n", sume, costh);
+            printf(" pt %15.8le \n", kin.pt);
+            printf(" e %15.8le \n", kin.e);
+            printf(" e0 %15.8le \n", e0);
+            printf(" p0 %15.8le \n", p0);
+            printf(" pl %15.8le \n", kin.pl);
+            printf(" m1 %15.8le \n", kin.m1);
+            printf(" m2 %15.8le \n", kin.m2);
+            printf(" m3 %15.8le \n", kin.m3);
+            printf(" mr %15.8le \n", mr);
+        }
+        if (cphiR > 1.0) cphiR = 1.0;
+        if (cphiR < -1.0) cphiR = -1.0;
 
-  return dnr * jac * jac / (2.0 * sume * sume);
-}
+        phiR[i] = acos(cphiR);
+        if (sphiR < 0.0) {
+            phiR[i] = 2.0*M_PI - phiR[i];
+        }
+    }
 
-double Freeze::norm3int (double x, void *paranorm) // this computes "Q(m_R,m_1,m_2,m_3)"
-{
-  nblock *tmp = (nblock *) paranorm;
-  double res = sqrt ((tmp->a - x) * (tmp->b - x)
-             * (x - tmp->c) * (x - tmp->d)) / x;
-  return res;
+    Edndp3(PTN2, yR, ptR, phiR, kin.res_num, values);
+    const double norm = 2.0*sume*sume;
+    for (int i = 0; i < PTN2; i++) {
+        values[i] = values[i]*jac[i]*jac[i]/norm;
+    }
 }
 
-double Freeze::dnpir1N (double costh, void* para1)         
-{
-  pblockN *para = (pblockN *) para1;
-  double r;
-  para->costh = costh;
-  para->sinth = sqrt (1.0 - para->costh * para->costh);
-  r = gauss (PTN2, &Freeze::dnpir2N, 0.0, 2.0 * M_PI, para); //Integrates the "dnpir2N" kernel over phi using gaussian integration
-  return r;
-}
 
-double Freeze::dn2ptN (double w2, void* para1)
-{
-  pblockN *para = (pblockN *) para1;
-  para->e0 = (para->mr * para->mr + para->m1 * para->m1 - w2) / (2 * para->mr); //particle one energy in resonance rest frame
-  para->p0 = sqrt (para->e0 * para->e0 - para->m1 * para->m1); // particle one absolute value of three momentum on resonance rest frame
-  return gauss (PTN1, &Freeze::dnpir1N, -1.0, 1.0, para); //Integrate the "dnpir1N" kernel over cos(theta) using gaussian integration
+double Freeze::dnpir1N(const DecayKinematics &kin, double e0, double p0,
+                       double costh) {
+    // Integrates the "dnpir2N" kernel over phi using gaussian integration
+    double values[PTN2];
+    dnpir2N(kin, e0, p0, costh, values);
+    return(get_gauss_rule(PTN2).sum(0.0, 2.0*M_PI, values));
 }
 
-double Freeze::dn3ptN (double x, void* para1)  //The integration kernel for "W" in 3-body decays. x=invariant mass of other particles squared
-{
-  pblockN *para = (pblockN *) para1;
-  double e0 =(para->mr * para->mr + para->m1 * para->m1 - x) / (2 * para->mr);
-  double p0 = sqrt (e0 * e0 - para->m1 * para->m1);
-  double a = (para->m2 + para->m3) * (para->m2 + para->m3);
-  double b = (para->m2 - para->m3) * (para->m2 - para->m3);
-  double re = p0 * sqrt ((x - a) * (x - b)) / x * dn2ptN (x, para);
-  return re;
+
+double Freeze::dn2ptN(const DecayKinematics &kin, double w2) {
+    // particle one energy and absolute value of three momentum in the
+    // resonance rest frame
+    const double e0 = (kin.mr*kin.mr + kin.m1*kin.m1 - w2)/(2*kin.mr);
+    const double p0 = sqrt(e0*e0 - kin.m1*kin.m1);
+    // Integrate the "dnpir1N" kernel over cos(theta) using gaussian
+    // integration
+    return(get_gauss_rule(PTN1).integrate(
+        [&](const double costh) {return(dnpir1N(kin, e0, p0, costh));},
+        -1.0, 1.0));
 }
 
-double Freeze::gauss(int n, double (Freeze::*f)(double, void *),
-                     double xlo, double xhi, void *optvec) {
-    double  xoffs, xdiff; 
-    int ix;
-    double  s;      /* summing up */
-    double  *p, *w;     /* pointing to active list */
 
-    switch (n) {
-        case 4:     p= gaulep4; w= gaulew4; break;
-        case 8:     p= gaulep8; w= gaulew8; break;
-        case 10:    p=gaulep10; w=gaulew10; break;
-        case 12:    p=gaulep12; w=gaulew12; break;
-        case 16:    p=gaulep16; w=gaulew16; break;
-        case 20:    p=gaulep20; w=gaulew20; break;
-        case 48:    p=gaulep48; w=gaulew48; break;
-        default:    printf("\ngauss():%d points not in list\n",n);
-                exit(0);
-        }
-    xoffs = 0.5 * ( xlo + xhi );
-    xdiff = 0.5 * ( xhi - xlo );
-    s = 0;
-    for( ix=0; ix<n/2; ix++ )   /* n is even */
-      s += w[ix] * ( (this->*f)(xoffs+xdiff*p[ix],optvec)
-                 + (this->*f)(xoffs-xdiff*p[ix],optvec) );
-    return( s * xdiff );
+//! sets the kinematics of the daughter at (y, pt, phi), which the integrals
+//! over the rest frame momentum of the daughter share
+void Freeze::set_decay_kinematics(double y, double pt, double phi, double m1,
+                                  double m2, double m3, double mr,
+                                  int res_num, DecayKinematics &kin) const {
+    const double mt = sqrt(pt*pt + m1*m1);
+    kin.pt = pt;
+    kin.e = mt*cosh(y);
+    kin.pl = mt*sinh(y);
+    kin.pt_cos_phi = pt*cos(phi);
+    kin.pt_sin_phi = pt*sin(phi);
+    kin.m1 = m1;
+    kin.m2 = m2;
+    kin.m3 = m3;
+    kin.mr = mr;
+    kin.res_num = res_num;
+
+    double phi_node[PTN2];
+    get_gauss_rule(PTN2).get_nodes(0.0, 2.0*M_PI, phi_node);
+    for (int i = 0; i < PTN2; i++) {
+        kin.cos_phi_node[i] = cos(phi_node[i]);
+        kin.cos_phi_shifted[i] = cos(phi_node[i] + phi);
+        kin.sin_phi_shifted[i] = sin(phi_node[i] + phi);
+    }
 }
-    
-    
+
+
 /********************************************************************
 *
 *   Edndp3_2bodyN()
@@ -346,28 +352,17 @@ double Freeze::Edndp3_2bodyN (double y, double pt, double phi, double m1, double
 /*      double phi;     /\* phi angle of particle 1      *\/ */
 /*      double m1, m2;      /\* restmasses of decay particles in MeV *\/ */
 /*      double mr;          /\* restmass of resonance MeV            *\/ */
-/*      int res_num;        /\* Montecarlo number of the Resonance   */ 
+/*      int res_num;        /\* Montecarlo number of the Resonance   */
 
 {
-  double mt = sqrt (pt * pt + m1 * m1);
   double norm2;         /* 2-body normalization         */
-  pblockN para;
+  DecayKinematics kin;
   double res2;
 
-  para.pt = pt;
-  para.mt = mt;
-  para.e = mt * cosh (y);
-  para.pl = mt * sinh (y);
-  para.y = y;
-  para.phi = phi;
-  para.m1 = m1;
-  para.m2 = m2;
-  para.mr = mr;
-
-  para.res_num = res_num;
+  set_decay_kinematics(y, pt, phi, m1, m2, 0., mr, res_num, kin);
 
   norm2 = 1.0 / (2.0 * M_PI);
-  res2 = norm2 * dn2ptN (m2 * m2, &para); //Calls the integration routines for 2-body
+  res2 = norm2 * dn2ptN (kin, m2 * m2); //Calls the integration routines for 2-body
   if (res2<0.) res2=0.;
   return res2;          /* like Ed3ndp3_2body() */
 }
@@ -384,54 +379,45 @@ double Freeze::Edndp3_3bodyN (double y, double pt, double phi, double m1, double
         /* in units of GeV^-2,includes phasespace and volume,
            does not include degeneracy factors  */
 {
-  double mt = sqrt (pt * pt + m1 * m1);
-  pblockN para;
+  DecayKinematics kin;
   double wmin, wmax;
   double res3;
-//   double slope;          /* slope of resonance for high mt */
-//   int pn;
 
-  para.pt  = pt;
-  para.mt  = mt;
-  para.y   = y;
-  para.e   = mt * cosh (y);
-  para.pl  = mt * sinh (y);
-  para.phi = phi;
+  set_decay_kinematics(y, pt, phi, m1, m2, m3, mr, res_num, kin);
 
-  para.m1 = m1;
-  para.m2 = m2;
-  para.m3 = m3;
-  para.mr = mr;
+  //The integration kernel for "W" in 3-body decays. x=invariant mass of other particles squared
+  const double a = (m2 + m3) * (m2 + m3);
+  const double b = (m2 - m3) * (m2 - m3);
+  const auto dn3ptN = [&](const double x) {
+      double e0 = (mr * mr + m1 * m1 - x) / (2 * mr);
+      double p0 = sqrt (e0 * e0 - m1 * m1);
+      return(p0 * sqrt ((x - a) * (x - b)) / x * dn2ptN (kin, x));
+  };
 
-//   pn = partid[MHALF + res_num];
-
-  para.res_num = res_num;
-
-  wmin = (m2 + m3) * (m2 + m3); 
+  wmin = (m2 + m3) * (m2 + m3);
   wmax = (mr - m1) * (mr - m1);
-  res3 = 2.0 * norm3 * gauss (PTS4, &Freeze::dn3ptN, wmin, wmax, &para) / mr;  //Integrates "W" using gaussian 
-  if (res3<0.) res3=0.; 
+  res3 = 2.0 * norm3 * get_gauss_rule(PTS4).integrate(dn3ptN, wmin, wmax) / mr;  //Integrates "W" using gaussian
+  if (res3<0.) res3=0.;
   return res3;
 }
 
 
-//! computes the pt, mt distribution including resonance decays
-void Freeze::add_reso(int pn, int pnR, int k, int j) {
-    nblock paranorm;      /* for 3body normalization integral */
-    double y;
-    double m1, m2, m3, mr;
-    double norm3;         /* normalisation of 3-body integral */
+//! sets the masses and the 3-body normalization of the decay channel j of
+//! the resonance pnR feeding the daughter pn at position k of the channel
+void Freeze::set_reso_feed(int pn, int pnR, int k, int j, reso_feed &feed) {
     int pn2, pn3, pn4;        /* internal numbers for resonances */
 
-    // this variable stores number of points in pseudorapidity
-    int ny = particleList[pn].ny;
-    int npt = particleList[pn].npt;
-    int nphi = particleList[pn].nphi;
-    double deltaphi = 2*M_PI/nphi;
-  
+    feed.pnR = pnR;
+    feed.j = j;
+    feed.numpart = abs(decay[j].numpart);
+    feed.m1 = 0.;
+    feed.m2 = 0.;
+    feed.m3 = 0.;
+    feed.mr = 0.;
+    feed.norm3 = 0.;
 
     // Determine the number of particles involved in the decay with the switch
-    switch (abs(decay[j].numpart)) {
+    switch (feed.numpart) {
         case 1:
         {
             // Only 1 particle, if it gets here, by accident,
@@ -446,96 +432,14 @@ void Freeze::add_reso(int pn, int pnR, int k, int j) {
             } else {
                 pn2 = partid[MHALF + decay[j].part[0]];
             }
-            // printf ("case 2:  i %3i j %3i k %3i \n", pn, j, k);
-            m1 = particleList[pn].mass;
-            m2 = particleList[pn2].mass;
-            mr = particleList[pnR].mass;
-
-            while ((m1 + m2) > mr) {
-                mr += 0.25*particleList[pnR].width;
-                m1 -= 0.5*particleList[pn].width;
-                m2 -= 0.5*particleList[pn2].width;
-            }
-            // fprintf(stderr,"mr=%f\n",mr);
-            // fprintf(stderr,"m1=%f\n",m1);
-            // fprintf(stderr,"m2=%f\n",m2);
-
-            if (boost_invariant) {
-                y = 0.0;
-                #pragma omp parallel for collapse(2)
-                for (int l = 0; l < npt; l++)
-                for (int i = 0; i < nphi; i++) {
-                    if (pseudofreeze) {
-                        y = Rap(y, particleList[pn].pt[l], m1);
-                    }
-                    double phi = 0.0;
-                    if (pseudofreeze) {
-                        phi = i*deltaphi;
-                    } else {
-                        phi = phiArray[i];
-                    }
-                    double spectrum = Edndp3_2bodyN(
-                            y, particleList[pn].pt[l], phi,
-                            m1, m2, mr,
-                            particleList[pnR].number);
-                    if (std::isnan(spectrum)) {
-                        fprintf(stderr, "2 pt=%f\n",
-                                particleList[pn].pt[l]);
-                        fprintf(stderr, "2 number=%d\n",
-                                particleList[pnR].number);
-                        fprintf(stderr, "2 Edn..=%f\n", spectrum);
-                    } else {
-                        // Call the 2-body decay integral and
-                        // add its contribution to the daughter
-                        // particle of interest
-                        for (int n = 0; n < ny; n++) {
-                            particleList[pn].dNdydptdphi[n][l][i] += (
-                                            decay[j].branch*spectrum);
-                            //if (n == ny/2 && i==0) {
-                            //    particleList[pn].resCont[n][l][i] += (
-                            //                decay[j].branch*spectrum);
-                            //}
-                        }
-                    }
-                }
-            } else {
-                #pragma omp parallel for collapse(3)
-                for (int n = 0; n < ny; n++)
-                for (int l = 0; l < npt; l++)
-                for (int i = 0; i < nphi; i++) {
-                    y = particleList[pn].y[n];
-                    if (pseudofreeze) {
-                        y = Rap(particleList[pn].y[n],
-                                particleList[pn].pt[l], m1);
-                    }
-                    double phi = 0.0;
-                    if (pseudofreeze) {
-                        phi = i*deltaphi;
-                    } else {
-                        phi = phiArray[i];
-                    }
-                    double spectrum = Edndp3_2bodyN(
-                            y, particleList[pn].pt[l], phi,
-                            m1, m2, mr,
-                            particleList[pnR].number);
-                    if (std::isnan(spectrum)) {
-                        fprintf(stderr, "2 pt=%f\n",
-                                particleList[pn].pt[l]);
-                        fprintf(stderr, "2 number=%d\n",
-                                particleList[pnR].number);
-                        fprintf(stderr, "2 Edn..=%f\n", spectrum);
-                    } else {
-                        // Call the 2-body decay integral and
-                        // add its contribution to the daughter
-                        // particle of interest
-                        particleList[pn].dNdydptdphi[n][l][i] += (
-                                            decay[j].branch*spectrum);
-                        //if (n == ny/2 && i==0) {
-                        //    particleList[pn].resCont[n][l][i] += (
-                        //                    decay[j].branch*spectrum);
-                        //}
-                    }
-                }
+            feed.m1 = particleList[pn].mass;
+            feed.m2 = particleList[pn2].mass;
+            feed.mr = particleList[pnR].mass;
+
+            while ((feed.m1 + feed.m2) > feed.mr) {
+                feed.mr += 0.25*particleList[pnR].width;
+                feed.m1 -= 0.5*particleList[pn].width;
+                feed.m2 -= 0.5*particleList[pn2].width;
             }
             break;
         }
@@ -555,93 +459,10 @@ void Freeze::add_reso(int pn, int pnR, int k, int j) {
                 }
             }
 
-            m1 = particleList[pn].mass;
-            m2 = particleList[pn2].mass;
-            m3 = particleList[pn3].mass;
-            mr = particleList[pnR].mass;
-            paranorm.a = (mr + m1)*(mr + m1);
-            paranorm.b = (mr - m1)*(mr - m1);
-            paranorm.c = (m2 + m3)*(m2 + m3);
-            paranorm.d = (m2 - m3)*(m2 - m3);
-            norm3 = mr*mr/(2*M_PI*gauss(PTS3, &Freeze::norm3int, paranorm.c,
-                                      paranorm.b, &paranorm));
-    
-            if (boost_invariant) {
-                y = 0.0;
-                #pragma omp parallel for collapse(2)
-                for (int l = 0; l < npt; l++)
-                for (int i = 0; i < nphi; i++) {
-                    if (pseudofreeze) {
-                        y = Rap(y, particleList[pn].pt[l], m1);
-                    }
-                    double phi;
-                    if (pseudofreeze) {
-                        phi = i*deltaphi;
-                    } else {
-                        phi = phiArray[i];
-                    }
-                    double spectrum = Edndp3_3bodyN(
-                            y, particleList[pn].pt[l], phi,
-                            m1, m2, m3, mr, norm3, 
-                            particleList[pnR].number);
-                    if (std::isnan(spectrum)) {
-                        fprintf(stderr,"3 number=%d\n",
-                                particleList[pnR].number);
-                        fprintf(stderr,"3 Edn..=%f\n", spectrum);
-                    } else {
-                        // Call the 3-body decay integral and
-                        // add its contribution to the daughter
-                        // particle of interest 
-                        for (int n = 0; n < ny; n++) {
-                            particleList[pn].dNdydptdphi[n][l][i] += (
-                                            decay[j].branch*spectrum);
-                            //if (n == ny/2 && i==0) {
-                            //    particleList[pn].resCont[n][l][i]+= (
-                            //                    decay[j].branch*spectrum);
-                
-                            //}
-                        }
-                    }
-                }
-            } else {
-                #pragma omp parallel for collapse(3)
-                for (int n = 0; n < ny; n++)
-                for (int l = 0; l < npt; l++)
-                for (int i = 0; i < nphi; i++) {
-                    y = particleList[pn].y[n];
-                    if (pseudofreeze) {
-                        y = Rap(particleList[pn].y[n],
-                                particleList[pn].pt[l], m1);
-                    }
-                    double phi;
-                    if (pseudofreeze) {
-                        phi = i*deltaphi;
-                    } else {
-                        phi = phiArray[i];
-                    }
-                    double spectrum = Edndp3_3bodyN(
-                            y, particleList[pn].pt[l], phi,
-                            m1, m2, m3, mr, norm3, 
-                            particleList[pnR].number);
-                    if (std::isnan(spectrum)) {
-                        fprintf(stderr,"3 number=%d\n",
-                                particleList[pnR].number);
-                        fprintf(stderr,"3 Edn..=%f\n", spectrum);
-                    } else {
-                        // Call the 3-body decay integral and
-                        // add its contribution to the daughter
-                        // particle of interest 
-                        particleList[pn].dNdydptdphi[n][l][i] += (
-                                            decay[j].branch*spectrum);
-                    }
-                
-                    //if (n == ny/2 && i==0) {
-                    //    particleList[pn].resCont[n][l][i]+= (
-                    //                        decay[j].branch*spectrum);
-                
-                    //}
-                }
-            }
+            feed.m1 = particleList[pn].mass;
+            feed.m2 = particleList[pn2].mass;
+            feed.m3 = particleList[pn3].mass;
+            feed.mr = particleList[pnR].mass;
             break;
         }
 
@@ -666,205 +487,174 @@ void Freeze::add_reso(int pn, int pnR, int k, int j) {
             }
             // approximate the 4-body with a 3-body decay with the 4th particle
             // being the center of mass of 2 particles.
-            m1 = particleList[pn].mass;
-            m2 = particleList[pn2].mass;
-            mr = particleList[pnR].mass;
-            m3 = 0.5*(particleList[pn3].mass + particleList[pn4].mass
-                      + mr - m1 - m2);
-            paranorm.a = (mr + m1)*(mr + m1);
-            paranorm.b = (mr - m1)*(mr - m1);
-            paranorm.c = (m2 + m3)*(m2 + m3);
-            paranorm.d = (m2 - m3)*(m2 - m3);
-            norm3 = mr*mr/(2*M_PI*gauss(PTS3, &Freeze::norm3int, paranorm.c,
-                                      paranorm.b, &paranorm));
-    
-            if (boost_invariant) {
-                y = 0.0;
-                #pragma omp parallel for collapse(2)
-                for (int i = 0; i < nphi; i++)
-                for (int l = 0; l < npt; l++) {
-                    double phi;
-                    if (pseudofreeze) {
-                        phi = i*deltaphi;
-                    } else {
-                        phi = phiArray[i];
-                    }
-                    if (pseudofreeze) {
-                        y = Rap(y, particleList[pn].pt[l], m1);
-                    }
-                    double spectrum = Edndp3_3bodyN(
-                            y, particleList[pn].pt[l], phi,
-                            m1, m2, m3, mr, norm3,
-                            particleList[pnR].number);
-                    if (std::isnan(spectrum)) {
-                        fprintf(stderr, "3 number=%d\n",
-                                particleList[pnR].number);
-                    } else {
-                        for (int n = 0; n < ny; n++) {
-                            particleList[pn].dNdydptdphi[n][l][i] += (
-                                    decay[j].branch*spectrum);
-                        }
-                    }
-                }
-            } else {
-                #pragma omp parallel for collapse(3)
-                for (int n = 0; n < ny; n++)
-                for (int i = 0; i < nphi; i++)
-                for (int l = 0; l < npt; l++) {
-                    y = particleList[pn].y[n];
-                    double phi;
-                    if (pseudofreeze) {
-                        phi = i*deltaphi;
-                    } else {
-                        phi = phiArray[i];
-                    }
-                    if (pseudofreeze) {
-                        y = Rap(particleList[pn].y[n],
-                                particleList[pn].pt[l], m1);
-                    }
-                    double spectrum = Edndp3_3bodyN(
-                            y, particleList[pn].pt[l], phi,
-                            m1, m2, m3, mr, norm3,
-                            particleList[pnR].number);
-                    if (std::isnan(spectrum)) {
-                        fprintf(stderr, "3 number=%d\n",
-                                particleList[pnR].number);
-                    } else {
-                        particleList[pn].dNdydptdphi[n][l][i] += (
-                                decay[j].branch*spectrum);
-                    }
-                }
-            }
+            feed.m1 = particleList[pn].mass;
+            feed.m2 = particleList[pn2].mass;
+            feed.mr = particleList[pnR].mass;
+            feed.m3 = 0.5*(particleList[pn3].mass + particleList[pn4].mass
+                           + feed.mr - feed.m1 - feed.m2);
             break;
         }
       
         default:
         {
-            printf ("ERROR in add_reso! \n");
+            printf ("ERROR in set_reso_feed! \n");
             printf ("%i decay not implemented ! \n", abs (decay[j].numpart));
             exit (0);
         }
     }
+
+    if (feed.numpart > 2) {
+        const double m1 = feed.m1;
+        const double m2 = feed.m2;
+        const double m3 = feed.m3;
+        const double mr = feed.mr;
+        const double a = (mr + m1)*(mr + m1);
+        const double b = (mr - m1)*(mr - m1);
+        const double c = (m2 + m3)*(m2 + m3);
+        const double d = (m2 - m3)*(m2 - m3);
+        // this computes "Q(m_R,m_1,m_2,m_3)"
+        const auto norm3int = [&](const double x) {
+            return(sqrt((a - x)*(b - x)*(x - c)*(x - d))/x);
+        };
+        feed.norm3 = mr*mr/(2*M_PI*get_gauss_rule(PTS3).integrate(norm3int,
+                                                                  c, b));
+    }
 }
 
-void Freeze::cal_reso_decays(int maxpart, int maxdecay, int bound) {
-    music_message << "CALCULATE RESONANCE DECAYS (as fast as I can) ...";
-    music_message.flush("info");
-    int pn = partid[MHALF + bound];
-    //int ny = particleList[pn].ny;
-    //int npt = particleList[pn].npt;
-    //int nphi = particleList[pn].nphi;
-  
-    for (int i = maxpart-1; i > pn - 1; i--) {
-        // Cycle the particles known from the particle.dat input
-        //for (int n1 = 0; n1 < ny; n1++) {
-        //    for (int n2 = 0; n2 < npt; n2++) {
-        //        for (int n3 = 0; n3 < nphi; n3++) {
-        //            particleList[pn].resCont[n1][n2][n3] =0.;
-        //        }
-        //    }
-        //}
-
-        int part = particleList[i].number;
-        music_message << "Calculating the decays with "
-                      << particleList[i].name;
-        music_message.flush("info");
-        switch (particleList[i].baryon) {
-            // Check the particle is baryon, anti-baryon or meson
-            case 1:  // Baryon
-            {
-                for (int j = 0; j < maxdecay; j++) {
-                    // Cycle through every decay channel known
-                    // to see if the particle was a daughter particle
-                    // in a decay channel
-                    int pnR = partid[MHALF + decay[j].reso];
-                    for (int k = 0; k < abs(decay[j].numpart); k++) {
-                        if ((part == decay[j].part[k])
-                                && (decay[j].numpart != 1)) {
-                            // Make sure that the decay channel isn't trivial
-                            // and contains the daughter particle
-                            music_message << "Partid is " << pnR << ". "
-                                          << particleList[pnR].name << " into "
-                                          << particleList[i].name;
-                            music_message.flush("info");
-                            add_reso(i, pnR, k, j);
-                        }
+
+//! adds the contribution of the decay channel feed to the spectrum of the
+//! daughter pn at the pT point l and the phi point i, at the rapidity point
+//! n, or at all rapidity points at y = 0 for boost-invariant spectra
+void Freeze::add_reso_feed(const reso_feed &feed, int pn, int n, int l,
+                           int i) {
+    if (feed.numpart < 2) return;
+    double y = 0.0;
+    if (!boost_invariant) {
+        y = particleList[pn].y[n];
+    }
+    if (pseudofreeze) {
+        y = Rap(y, particleList[pn].pt[l], feed.m1);
+    }
+    double phi = 0.0;
+    if (pseudofreeze) {
+        phi = i*2*M_PI/particleList[pn].nphi;
+    } else {
+        phi = phiArray[i];
+    }
+    const int res_num = particleList[feed.pnR].number;
+    double spectrum;
+    if (feed.numpart == 2) {
+        spectrum = Edndp3_2bodyN(y, particleList[pn].pt[l], phi,
+                                 feed.m1, feed.m2, feed.mr, res_num);
+    } else {
+        spectrum = Edndp3_3bodyN(y, particleList[pn].pt[l], phi,
+                                 feed.m1, feed.m2, feed.m3, feed.mr,
+                                 feed.norm3, res_num);
+    }
+    if (std::isnan(spectrum)) {
+        fprintf(stderr, "%d pt=%f\n", feed.numpart, particleList[pn].pt[l]);
+        fprintf(stderr, "%d number=%d\n", feed.numpart, res_num);
+        fprintf(stderr, "%d Edn..=%f\n", feed.numpart, spectrum);
+        return;
+    }
+    // add the contribution of the decay integral to the daughter
+    // particle of interest
+    if (boost_invariant) {
+        for (int iy = 0; iy < particleList[pn].ny; iy++) {
+            particleList[pn].dNdydptdphi[iy][l][i] += (
+                                            decay[feed.j].branch*spectrum);
+        }
+    } else {
+        particleList[pn].dNdydptdphi[n][l][i] += (
+                                            decay[feed.j].branch*spectrum);
+    }
+}
+
+
+//! collects the decay channels that feed the daughter particle i, in the
+//! order of the decay table
+void Freeze::collect_reso_feeds(int i, int maxdecay,
+                                std::vector<reso_feed> &feeds) {
+    int part = particleList[i].number;
+    reso_feed feed;
+    switch (particleList[i].baryon) {
+        // Check the particle is baryon, anti-baryon or meson
+        case 1:  // Baryon
+        {
+            for (int j = 0; j < maxdecay; j++) {
+                // Cycle through every decay channel known
+                // to see if the particle was a daughter particle
+                // in a decay channel
+                int pnR = partid[MHALF + decay[j].reso];
+                for (int k = 0; k < abs(decay[j].numpart); k++) {
+                    if ((part == decay[j].part[k])
+                            && (decay[j].numpart != 1)) {
+                        // Make sure that the decay channel isn't trivial
+                        // and contains the daughter particle
+                        music_message << "Partid is " << pnR << ". "
+                                      << particleList[pnR].name << " into "
+                                      << particleList[i].name;
+                        music_message.flush("info");
+                        set_reso_feed(i, pnR, k, j, feed);
+                        feeds.push_back(feed);
                     }
                 }
-                break;
             }
+            break;
+        }
 
-            case -1:  // Anti-Baryon
-            {
-                for (int j = 0; j < maxdecay; j++) {
-                    // Cycle through every decay channel known
-                    // to see if the particle was a daughter particle
-                    // in a decay channel
-                    int pnaR = partid[MHALF - decay[j].reso];
-                    for (int k = 0; k < abs(decay[j].numpart); k++) {
-                        if ((-part == decay[j].part[k])
-                                && (decay[j].numpart != 1)) {
-                            // Make sure that the decay channel isn't trivial
-                            // and contains the daughter particle
-                            music_message << "Partid is " << pnaR << ". "
-                                          << particleList[pnaR].name
-                                          << " into "
-                                          << particleList[i].name;
-                            music_message.flush("info");
-                            add_reso(i, pnaR, k, j);
-                        }
+        case -1:  // Anti-Baryon
+        {
+            for (int j = 0; j < maxdecay; j++) {
+                // Cycle through every decay channel known
+                // to see if the particle was a daughter particle
+                // in a decay channel
+                int pnaR = partid[MHALF - decay[j].reso];
+                for (int k = 0; k < abs(decay[j].numpart); k++) {
+                    if ((-part == decay[j].part[k])
+                            && (decay[j].numpart != 1)) {
+                        // Make sure that the decay channel isn't trivial
+                        // and contains the daughter particle
+                        music_message << "Partid is " << pnaR << ". "
+                                      << particleList[pnaR].name
+                                      << " into "
+                                      << particleList[i].name;
+                        music_message.flush("info");
+                        set_reso_feed(i, pnaR, k, j, feed);
+                        feeds.push_back(feed);
                     }
                 }
-                break;
             }
+            break;
+        }
 
-            case 0:  // Meson
-            {
-                for (int j = 0; j < maxdecay; j++) {
-                    int pnR = partid[MHALF + decay[j].reso];
-                    for (int k = 0; k < abs (decay[j].numpart); k++) {
-                        if (particleList[pnR].baryon == 1) {
-                            int pnaR = partid[MHALF - decay[j].reso];
-                            if ((particleList[i].charge == 0)
-                                 && (particleList[i].strange == 0)) {
-                                if ((part == decay[j].part[k])
-                                    && (decay[j].numpart != 1)) {
-                                    music_message << "Partid is " << pnR
-                                                  << ". "
-                                                  << particleList[pnR].name
-                                                  << " into "
-                                                  << particleList[i].name;
-                                    music_message.flush("info");
-                                    music_message << "Partid is " << pnaR
-                                                  << ". "
-                                                  << particleList[pnaR].name
-                                                  << " into "
-                                                  << particleList[i].name;
-                                    music_message.flush("info");
-                                    add_reso(i, pnR, k, j);
-                                    add_reso(i, pnaR, k, j);
-                                }
-                            } else {
-                                if ((part == decay[j].part[k])
-                                    && (decay[j].numpart != 1)) {
-                                    music_message << "Partid is " << pnR
-                                                  << ". "
-                                                  << particleList[pnR].name
-                                                  << " into "
-                                                  << particleList[i].name;
-                                    music_message.flush("info");
-                                    add_reso (i, pnR, k, j);
-                                }
-                                if ((-part == decay[j].part[k])
-                                    && (decay[j].numpart != 1)) {
-                                    music_message << "Partid is " << pnaR
-                                                  << ". "
-                                                  << particleList[pnaR].name
-                                                  << " into "
-                                                  << particleList[i].name;
-                                    music_message.flush("info");
-                                    add_reso(i, pnaR, k, j);
-                                }
+        case 0:  // Meson
+        {
+            for (int j = 0; j < maxdecay; j++) {
+                int pnR = partid[MHALF + decay[j].reso];
+                for (int k = 0; k < abs (decay[j].numpart); k++) {
+                    if (particleList[pnR].baryon == 1) {
+                        int pnaR = partid[MHALF - decay[j].reso];
+                        if ((particleList[i].charge == 0)
+                             && (particleList[i].strange == 0)) {
+                            if ((part == decay[j].part[k])
+                                && (decay[j].numpart != 1)) {
+                                music_message << "Partid is " << pnR
+                                              << ". "
+                                              << particleList[pnR].name
+                                              << " into "
+                                              << particleList[i].name;
+                                music_message.flush("info");
+                                music_message << "Partid is " << pnaR
+                                              << ". "
+                                              << particleList[pnaR].name
+                                              << " into "
+                                              << particleList[i].name;
+                                music_message.flush("info");
+                                set_reso_feed(i, pnR, k, j, feed);
+                                feeds.push_back(feed);
+                                set_reso_feed(i, pnaR, k, j, feed);
+                                feeds.push_back(feed);
                             }
                         } else {
                             if ((part == decay[j].part[k])
@@ -875,17 +665,109 @@ void Freeze::cal_reso_decays(int maxpart, int maxdecay, int bound) {
                                               << " into "
                                               << particleList[i].name;
                                 music_message.flush("info");
-                                add_reso(i, pnR, k, j);
+                                set_reso_feed(i, pnR, k, j, feed);
+                                feeds.push_back(feed);
+                            }
+                            if ((-part == decay[j].part[k])
+                                && (decay[j].numpart != 1)) {
+                                music_message << "Partid is " << pnaR
+                                              << ". "
+                                              << particleList[pnaR].name
+                                              << " into "
+                                              << particleList[i].name;
+                                music_message.flush("info");
+                                set_reso_feed(i, pnaR, k, j, feed);
+                                feeds.push_back(feed);
                             }
                         }
+                    } else {
+                        if ((part == decay[j].part[k])
+                            && (decay[j].numpart != 1)) {
+                            music_message << "Partid is " << pnR
+                                          << ". "
+                                          << particleList[pnR].name
+                                          << " into "
+                                          << particleList[i].name;
+                            music_message.flush("info");
+                            set_reso_feed(i, pnR, k, j, feed);
+                            feeds.push_back(feed);
+                        }
                     }
                 }
-                break;
             }
-            default:
-                music_message << "Error in switch in func partden_wdecay";
-                music_message.flush("error");
-                exit(1);
+            break;
+        }
+        default:
+            music_message << "Error in switch in func partden_wdecay";
+            music_message.flush("error");
+            exit(1);
+    }
+}
+
+
+void Freeze::cal_reso_decays(int maxpart, int maxdecay, int bound) {
+    music_message << "CALCULATE RESONANCE DECAYS (as fast as I can) ...";
+    music_message.flush("info");
+    int pn = partid[MHALF + bound];
+    int ny = particleList[pn].ny;
+    int npt = particleList[pn].npt;
+    int nphi = particleList[pn].nphi;
+
+    // collect the decay channels feeding every particle known from the
+    // particle.dat input, from the heaviest one down to bound
+    std::vector<std::vector<reso_feed>> feeds(maxpart);
+    for (int i = maxpart-1; i > pn - 1; i--) {
+        music_message << "Calculating the decays with "
+                      << particleList[i].name;
+        music_message.flush("info");
+        collect_reso_feeds(i, maxdecay, feeds[i]);
+    }
+
+    // The daughters are final in the order of the scan from the heaviest
+    // particle. A daughter is computed after the resonances scanned before
+    // it, whose spectra are final then, and after the daughters scanned
+    // before it that read its spectrum as a resonance. The daughters of one
+    // level of this ordering are independent of each other.
+    std::vector<int> level(maxpart, 0);
+    std::vector<std::vector<int>> daughters_of_level;
+    for (int i = maxpart-1; i > pn - 1; i--) {
+        for (const auto &feed : feeds[i]) {
+            if (feed.pnR > i && feed.pnR < maxpart) {
+                level[i] = std::max(level[i], level[feed.pnR] + 1);
+            }
+        }
+        for (int i2 = maxpart-1; i2 > i; i2--) {
+            for (const auto &feed : feeds[i2]) {
+                if (feed.pnR == i) {
+                    level[i] = std::max(level[i], level[i2] + 1);
+                }
+            }
+        }
+        if (level[i] >= static_cast<int>(daughters_of_level.size())) {
+            daughters_of_level.resize(level[i] + 1);
+        }
+        daughters_of_level[level[i]].push_back(i);
+    }
+    music_message << "resonance decays of " << maxpart - pn
+                  << " particles in " << daughters_of_level.size()
+                  << " dependent steps";
+    music_message.flush("info");
+
+    // all grid points of the daughters of a level in parallel, every point
+    // adds the decay channels of its daughter in the order of the decay
+    // table as the decays one daughter at a time did
+    const int n_y_points = boost_invariant ? 1 : ny;
+    for (const auto &daughters : daughters_of_level) {
+        const int n_daughters = static_cast<int>(daughters.size());
+        #pragma omp parallel for collapse(4) schedule(dynamic, 16)
+        for (int id = 0; id < n_daughters; id++)
+        for (int n = 0; n < n_y_points; n++)
+        for (int l = 0; l < npt; l++)
+        for (int i = 0; i < nphi; i++) {
+            const int i_daughter = daughters[id];
+            for (const auto &feed : feeds[i_daughter]) {
+                add_reso_feed(feed, i_daughter, n, l, i);
+            }
         }
     }
 }
@@ -0,0 +1,14 @@
+#include "rk_scheme.h"
+
+RKScheme::RKScheme(const int rk_order) {
+    if (rk_order == 1) {
+        q0_weight_    = {0.};
+        tau_fraction_ = {0.};
+    } else if (rk_order == 3) {
+        q0_weight_    = {0., 3./4., 1./3.};
+        tau_fraction_ = {0., 1., 1./2.};
+    } else {
+        q0_weight_    = {0., 1./2.};
+        tau_fraction_ = {0., 1.};
+    }
+}
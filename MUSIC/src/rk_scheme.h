@@ -0,0 +1,51 @@
+#ifndef SRC_RK_SCHEME_H_
+#define SRC_RK_SCHEME_H_
+
+#include <vector>
+
+//! This class describes the explicit Runge-Kutta time integrator chosen
+//! by Runge_Kutta_order, written in the Shu-Osher form. Stage k evaluates
+//! the right hand side L at the state q_k at tau + c_k*dtau, and gives
+//!   q_{k+1} = a_k q_0 + (1 - a_k) (q_k + dtau L(q_k)),
+//! with q_0 the state at tau.
+//!   1: forward Euler
+//!   2: SSP-RK2 (Heun)
+//!   3: SSP-RK3 (Shu and Osher)
+//! Every stage only needs q_0 (arena_prev) and q_k (arena_current), so the
+//! schemes share the rotation of the three grids in Evolve::AdvanceRK.
+class RKScheme {
+ private:
+    std::vector<double> q0_weight_;      //!< a_k
+    std::vector<double> tau_fraction_;   //!< c_k
+
+ public:
+    explicit RKScheme(const int rk_order);
+
+    int get_number_of_stages() const {
+        return(static_cast<int>(q0_weight_.size()));
+    }
+
+    //! number of grids the stages need: q_0, q_k, and q_{k+1}
+    int get_number_of_stage_buffers() const {return(3);}
+
+    //! time of the state q_k the stage k starts from, in units of dtau
+    double get_stage_tau_fraction(const int k) const {
+        return(tau_fraction_[k]);
+    }
+
+    //! time of the state q_{k+1} the stage k gives, in units of dtau
+    double get_output_tau_fraction(const int k) const {
+        return(k + 1 < get_number_of_stages() ? tau_fraction_[k + 1] : 1.);
+    }
+
+    //! the stage k gives (q0_ratio*q_0 + q_k + dtau L(q_k))*stage_weight,
+    //! which is 1*(q_k + dtau L(q_k)) in the first stage
+    double get_q0_ratio(const int k) const {
+        return(q0_weight_[k]/(1. - q0_weight_[k]));
+    }
+    double get_stage_weight(const int k) const {
+        return(1. - q0_weight_[k]);
+    }
+};
+
+#endif  // SRC_RK_SCHEME_H_
@@ -0,0 +1,39 @@
+#include "doctest.h"
+#include "rk_scheme.h"
+
+//! one step of dq/dtau = lambda q with the stage combinations of RKScheme
+double rk_step(const RKScheme &scheme, const double q0,
+               const double lambda, const double dtau) {
+    double q = q0;
+    for (int k = 0; k < scheme.get_number_of_stages(); k++) {
+        q = (scheme.get_q0_ratio(k)*q0 + q + dtau*lambda*q)
+            *scheme.get_stage_weight(k);
+    }
+    return(q);
+}
+
+TEST_CASE("Check the Runge-Kutta schemes") {
+    // the schemes of order p give the Taylor series of exp(z) up to z^p
+    const double z = 0.1;
+    const double taylor[4] = {1., 1. + z, 1. + z + z*z/2.,
+                              1. + z + z*z/2. + z*z*z/6.};
+    for (int order = 1; order <= 3; order++) {
+        RKScheme scheme(order);
+        CHECK(scheme.get_number_of_stages() == order);
+        CHECK(scheme.get_number_of_stage_buffers() == 3);
+        CHECK(rk_step(scheme, 1., z, 1.) == doctest::Approx(taylor[order]));
+        CHECK(scheme.get_stage_tau_fraction(0) == 0.);
+        CHECK(scheme.get_output_tau_fraction(order - 1) == 1.);
+    }
+
+    // SSP-RK2 is the average of q0 and the Euler step from the Euler step
+    RKScheme rk2(2);
+    CHECK(rk2.get_q0_ratio(1) == 1.);
+    CHECK(rk2.get_stage_weight(1) == 0.5);
+    CHECK(rk2.get_stage_tau_fraction(1) == 1.);
+
+    // the second stage of SSP-RK3 is at tau + dtau/2
+    RKScheme rk3(3);
+    CHECK(rk3.get_stage_tau_fraction(2) == 0.5);
+    CHECK(rk3.get_output_tau_fraction(1) == 0.5);
+}
@@ -0,0 +1,77 @@
+#ifndef SRC_SLOPE_LIMITER_H_
+#define SRC_SLOPE_LIMITER_H_
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+//! The slope limiters of the Kurganov-Tadmor reconstruction. A limiter
+//! returns the limited difference of f across a cell from the values
+//! (f_{i+1}, f_i, f_{i-1}) with min, max and abs instead of branches, so
+//! the loops over a row of cells vectorize. The kernels take the limiter as a
+//! template parameter, and limit_row limits a whole row at once.
+namespace SlopeLimiter {
+
+//! the values of the slope_limiter parameter
+enum Kind {
+    kMinmod = 0,                //!< generalized minmod with minmod_theta
+    kMonotonizedCentral = 1,    //!< generalized minmod with theta = 2
+    kVanLeer = 2,               //!< harmonic mean of the one-sided slopes
+};
+
+//! minmod(a, b, c): the argument of the smallest magnitude if they all
+//! have the same sign, 0 otherwise. Only one of the two terms is nonzero,
+//! the minimum of positive arguments or the maximum of negative ones.
+inline double minmod(const double a, const double b, const double c) {
+    return(  std::max(0., std::min(a, std::min(b, c)))
+           + std::min(0., std::max(a, std::max(b, c))));
+}
+
+//! minmod(theta (f_{i+1} - f_i), theta (f_i - f_{i-1}),
+//!        (f_{i+1} - f_{i-1})/2), without divisions
+struct Minmod {
+    double theta;
+
+    double operator()(const double up1, const double u,
+                      const double um1) const {
+        return(minmod((up1 - u)*theta, (u - um1)*theta, (up1 - um1)*0.5));
+    }
+};
+
+//! the generalized minmod at the largest theta = 2
+struct MonotonizedCentral {
+    double operator()(const double up1, const double u,
+                      const double um1) const {
+        return(minmod((up1 - u)*2., (u - um1)*2., (up1 - um1)*0.5));
+    }
+};
+
+//! 2 a b/(a + b) for one-sided slopes a and b of the same sign, 0
+//! otherwise, as (a |b| + |a| b)/(|a| + |b|), whose numerator vanishes
+//! at the extrema. It is the one limiter with a division.
+struct VanLeer {
+    double operator()(const double up1, const double u,
+                      const double um1) const {
+        const double a = up1 - u;
+        const double b = u - um1;
+        const double abs_a = std::fabs(a);
+        const double abs_b = std::fabs(b);
+        return((a*abs_b + abs_a*b)
+               /std::max(abs_a + abs_b, std::numeric_limits<double>::min()));
+    }
+};
+
+//! the limited slopes of the n cells of a row, slope[i] from
+//! (up1[i], u[i], um1[i])
+template <class Limiter>
+void limit_row(const Limiter &limiter, const int n, const double *up1,
+               const double *u, const double *um1, double *slope) {
+    #pragma omp simd
+    for (int i = 0; i < n; i++) {
+        slope[i] = limiter(up1[i], u[i], um1[i]);
+    }
+}
+
+}  // namespace SlopeLimiter
+
+#endif  // SRC_SLOPE_LIMITER_H_
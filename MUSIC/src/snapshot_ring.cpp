@@ -0,0 +1,94 @@
+#include <algorithm>
+#include <cstdlib>
+#include <mutex>
+#include "checkpoint.h"
+#include "memory_accounting.h"
+#include "pretty_ostream.h"
+#include "snapshot_ring.h"
+
+SnapshotRing *SnapshotRing::armed_ = nullptr;
+
+namespace {
+    std::once_flag exit_handler_registered;
+}
+
+
+SnapshotRing::SnapshotRing(const std::string &filename, const int capacity) :
+        filename_(filename), snapshots_(capacity), n_pushed_(0) {}
+
+
+SnapshotRing::~SnapshotRing() {
+    disarm();
+}
+
+
+void SnapshotRing::push(const int it, const double tau, const SCGrid &arena) {
+    const int capacity = static_cast<int>(snapshots_.size());
+    if (capacity == 0) return;
+    Snapshot &snapshot = snapshots_[n_pushed_%capacity];
+    if (   snapshot.grid.nX() != arena.nX() || snapshot.grid.nY() != arena.nY()
+        || snapshot.grid.nEta() != arena.nEta()) {
+        MemoryScope memory_scope(MemorySubsystem::evolution_output);
+        snapshot.grid = SCGrid(arena.nX(), arena.nY(), arena.nEta());
+    }
+    const int n_cells = arena.size();
+    #pragma omp parallel for schedule(static)
+    for (int i = 0; i < n_cells; i++) {
+        snapshot.grid(i) = arena(i);
+    }
+    snapshot.it = it;
+    snapshot.tau = tau;
+    n_pushed_++;
+}
+
+
+int SnapshotRing::get_number_of_snapshots() const {
+    return(static_cast<int>(std::min<long>(n_pushed_, snapshots_.size())));
+}
+
+
+const SnapshotRing::Snapshot &SnapshotRing::get_snapshot(const int k) const {
+    const long capacity = static_cast<long>(snapshots_.size());
+    return(snapshots_[(n_pushed_ - get_number_of_snapshots() + k)%capacity]);
+}
+
+
+void SnapshotRing::write() const {
+    CheckpointWriter writer(filename_);
+    writer.begin();
+    const int n_snapshots = get_number_of_snapshots();
+    writer.add(n_snapshots);
+    for (int k = 0; k < n_snapshots; k++) {
+        const Snapshot &snapshot = get_snapshot(k);
+        writer.add(snapshot.it);
+        writer.add(snapshot.tau);
+        writer.add_grid(snapshot.grid);
+    }
+    writer.write();
+    writer.wait();
+}
+
+
+void SnapshotRing::write_armed() {
+    if (armed_ == nullptr) return;
+    SnapshotRing *ring = armed_;
+    armed_ = nullptr;
+    pretty_ostream music_message;
+    music_message << "The run stopped before its end, writing the last "
+                  << ring->get_number_of_snapshots() << " grids to "
+                  << ring->filename_;
+    music_message.flush("warning");
+    ring->write();
+}
+
+
+void SnapshotRing::arm() {
+    armed_ = this;
+    std::call_once(exit_handler_registered,
+                   []() {std::atexit(&SnapshotRing::write_armed);});
+}
+
+
+void SnapshotRing::disarm() {
+    if (armed_ == this) armed_ = nullptr;
+}
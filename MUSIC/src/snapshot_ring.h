@@ -0,0 +1,64 @@
+#ifndef SRC_SNAPSHOT_RING_H_
+#define SRC_SNAPSHOT_RING_H_
+
+#include <string>
+#include <vector>
+#include "grid.h"
+
+//! This class keeps copies of the grids of the last time steps in memory
+//! for the post-mortem debugging of crashed events (debug_snapshot_ring).
+//! An armed ring is written by exit(), so a run stopped by a fatal error
+//! leaves the grids before the error in filename. A run which ends
+//! normally disarms its ring and writes nothing. A crash by a signal
+//! does not call exit() and leaves no snapshots.
+//!
+//! The file is a checkpoint file (see CheckpointWriter) with the int
+//! number of snapshots and, oldest first, the int time step, the double
+//! tau and the grid of each snapshot.
+class SnapshotRing {
+ private:
+    struct Snapshot {
+        int it = 0;
+        double tau = 0.;
+        SCGrid grid;
+    };
+    const std::string filename_;
+    std::vector<Snapshot> snapshots_;
+    //! the number of snapshots pushed so far
+    long n_pushed_;
+
+    //! the snapshot k, 0 is the oldest one
+    const Snapshot &get_snapshot(const int k) const;
+
+    //! the ring written by exit()
+    static SnapshotRing *armed_;
+    static void write_armed();
+
+ public:
+    SnapshotRing(const std::string &filename, const int capacity);
+    //! disarms the ring
+    ~SnapshotRing();
+
+    SnapshotRing(const SnapshotRing&) = delete;
+    SnapshotRing& operator=(const SnapshotRing&) = delete;
+
+    //! copies arena of the time step it at tau over the oldest snapshot,
+    //! from all the threads
+    void push(const int it, const double tau, const SCGrid &arena);
+
+    int get_number_of_snapshots() const;
+
+    const SCGrid &get_grid(const int k) const {
+        return(get_snapshot(k).grid);
+    }
+    double get_tau(const int k) const {return(get_snapshot(k).tau);}
+
+    //! writes the snapshots to the file
+    void write() const;
+
+    //! the ring is written by exit() until disarm()
+    void arm();
+    void disarm();
+};
+
+#endif  // SRC_SNAPSHOT_RING_H_
@@ -0,0 +1,51 @@
+#include <cstdio>
+#include "doctest.h"
+#include "checkpoint.h"
+#include "snapshot_ring.h"
+
+namespace {
+    SCGrid make_test_grid(const double e) {
+        SCGrid arena(3, 2, 2);
+        for (int i = 0; i < arena.size(); i++) {
+            arena(i).epsilon = e + 0.01*i;
+        }
+        return(arena);
+    }
+}
+
+TEST_CASE("Check SnapshotRing keeps the last grids and writes them") {
+    const std::string filename = "test_debug_snapshots.dat";
+    SnapshotRing ring(filename, 3);
+    CHECK(ring.get_number_of_snapshots() == 0);
+    ring.push(0, 0.4, make_test_grid(1.));
+    ring.push(1, 0.5, make_test_grid(2.));
+    CHECK(ring.get_number_of_snapshots() == 2);
+    CHECK(ring.get_grid(0)(5).epsilon == doctest::Approx(1.05));
+    for (int it = 2; it < 5; it++) {
+        ring.push(it, 0.4 + 0.1*it, make_test_grid(1. + it));
+    }
+    // the oldest snapshot is the one of it = 2
+    REQUIRE(ring.get_number_of_snapshots() == 3);
+    CHECK(ring.get_tau(0) == doctest::Approx(0.6));
+    CHECK(ring.get_grid(0)(0).epsilon == doctest::Approx(3.));
+    CHECK(ring.get_grid(2)(0).epsilon == doctest::Approx(5.));
+
+    ring.write();
+    CheckpointReader reader(filename);
+    int n_snapshots = 0;
+    reader.get(n_snapshots);
+    REQUIRE(n_snapshots == 3);
+    for (int k = 0; k < n_snapshots; k++) {
+        int it = 0;
+        double tau = 0.;
+        SCGrid grid;
+        reader.get(it);
+        reader.get(tau);
+        reader.get_grid(grid);
+        CHECK(it == 2 + k);
+        CHECK(tau == doctest::Approx(0.6 + 0.1*k));
+        CHECK(grid.nX() == 3);
+        CHECK(grid(11).epsilon == doctest::Approx(3. + k + 0.11));
+    }
+    remove(filename.c_str());
+}
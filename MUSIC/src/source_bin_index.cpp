@@ -0,0 +1,109 @@
+#include <algorithm>
+#include <cmath>
+#include "source_bin_index.h"
+
+namespace {
+    //! returns the number of bins of width about bin_size in [min, max]
+    int count_bins(const double min, const double max,
+                   const double bin_size, const int max_bins) {
+        if (!(bin_size > 0.)) return(1);
+        const double n_bins = std::ceil((max - min)/bin_size);
+        return(static_cast<int>(std::max(1., std::min(n_bins,
+                                static_cast<double>(max_bins)))));
+    }
+}
+
+
+int SourceBinIndex::get_bin_index(const double value, const double min,
+                                  const double bin_size,
+                                  const int n_bins) const {
+    const int idx = static_cast<int>(std::floor((value - min)/bin_size));
+    return(std::max(0, std::min(n_bins - 1, idx)));
+}
+
+
+void SourceBinIndex::build(const std::vector<Box> &boxes,
+                           const double bin_size_x,
+                           const double bin_size_eta) {
+    nx_ = ny_ = neta_ = 0;
+    bin_start_.clear();
+    source_ids_.clear();
+
+    bool first = true;
+    for (const auto &box : boxes) {
+        if (!(   box.x_min <= box.x_max && box.y_min <= box.y_max
+              && box.eta_min <= box.eta_max)) continue;
+        if (first) {
+            x0_ = box.x_min; x1_ = box.x_max;
+            y0_ = box.y_min; y1_ = box.y_max;
+            eta0_ = box.eta_min; eta1_ = box.eta_max;
+            first = false;
+        }
+        x0_ = std::min(x0_, box.x_min); x1_ = std::max(x1_, box.x_max);
+        y0_ = std::min(y0_, box.y_min); y1_ = std::max(y1_, box.y_max);
+        eta0_ = std::min(eta0_, box.eta_min);
+        eta1_ = std::max(eta1_, box.eta_max);
+    }
+    if (first) return;
+
+    nx_ = count_bins(x0_, x1_, bin_size_x, kMaxBins);
+    ny_ = count_bins(y0_, y1_, bin_size_x, kMaxBins);
+    neta_ = count_bins(eta0_, eta1_, bin_size_eta, kMaxBins);
+    dx_ = std::max((x1_ - x0_)/nx_, 1e-10);
+    dy_ = std::max((y1_ - y0_)/ny_, 1e-10);
+    deta_ = std::max((eta1_ - eta0_)/neta_, 1e-10);
+
+    // count the sources of each bin, then fill the bins in the order of
+    // the sources
+    std::vector<int> counts(nx_*ny_*neta_ + 1, 0);
+    for (int pass = 0; pass < 2; pass++) {
+        for (unsigned int i = 0; i < boxes.size(); i++) {
+            const Box &box = boxes[i];
+            if (!(   box.x_min <= box.x_max && box.y_min <= box.y_max
+                  && box.eta_min <= box.eta_max)) continue;
+            const int ix0 = get_bin_index(box.x_min, x0_, dx_, nx_);
+            const int ix1 = get_bin_index(box.x_max, x0_, dx_, nx_);
+            const int iy0 = get_bin_index(box.y_min, y0_, dy_, ny_);
+            const int iy1 = get_bin_index(box.y_max, y0_, dy_, ny_);
+            const int ieta0 = get_bin_index(box.eta_min, eta0_, deta_,
+                                            neta_);
+            const int ieta1 = get_bin_index(box.eta_max, eta0_, deta_,
+                                            neta_);
+            for (int ieta = ieta0; ieta <= ieta1; ieta++) {
+                for (int iy = iy0; iy <= iy1; iy++) {
+                    for (int ix = ix0; ix <= ix1; ix++) {
+                        const int ibin = ix + nx_*(iy + ny_*ieta);
+                        if (pass == 0) {
+                            counts[ibin + 1]++;
+                        } else {
+                            source_ids_[counts[ibin]++] = i;
+                        }
+                    }
+                }
+            }
+        }
+        if (pass == 0) {
+            for (unsigned int ibin = 1; ibin < counts.size(); ibin++) {
+                counts[ibin] += counts[ibin - 1];
+            }
+            bin_start_ = counts;
+            source_ids_.resize(counts.back());
+        }
+    }
+}
+
+
+SourceBinIndex::Range SourceBinIndex::get_sources(const double x,
+                                                  const double y,
+                                                  const double eta_s) const {
+    if (nx_ == 0 || !(x >= x0_ && x <= x1_) || !(y >= y0_ && y <= y1_)
+            || !(eta_s >= eta0_ && eta_s <= eta1_)) {
+        return(Range{nullptr, nullptr});
+    }
+    const int ix = get_bin_index(x, x0_, dx_, nx_);
+    const int iy = get_bin_index(y, y0_, dy_, ny_);
+    const int ieta = get_bin_index(eta_s, eta0_, deta_, neta_);
+    const int ibin = ix + nx_*(iy + ny_*ieta);
+    const int *ids = source_ids_.data();
+    return(Range{ids + bin_start_[ibin], ids + bin_start_[ibin + 1]});
+}
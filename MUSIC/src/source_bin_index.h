@@ -0,0 +1,65 @@
+#ifndef SRC_SOURCE_BIN_INDEX_H_
+#define SRC_SOURCE_BIN_INDEX_H_
+
+#include <vector>
+
+//! This class is a uniform bin grid over (x, y, eta_s) for the hydro
+//! source terms of one tau frame. Every source is listed in the bins its
+//! footprint (the box beyond which it does not contribute) overlaps, so a
+//! cell only loops over the sources of its bin. The sources of a bin are
+//! in increasing order, so the sums over them keep the order of a loop
+//! over the whole list.
+class SourceBinIndex {
+ public:
+    //! the footprint of a source, a box with min <= max
+    struct Box {
+        double x_min, x_max;
+        double y_min, y_max;
+        double eta_min, eta_max;
+    };
+
+    //! the indices of the sources of a bin, for range-based for loops
+    struct Range {
+        const int *first;
+        const int *last;
+        const int *begin() const {return(first);}
+        const int *end() const {return(last);}
+        bool empty() const {return(first == last);}
+    };
+
+    //! builds the index of the sources 0, ..., boxes.size() - 1. The bins
+    //! are about bin_size_x wide in x and y and bin_size_eta in eta_s. The
+    //! boxes with max < min are not listed anywhere.
+    void build(const std::vector<Box> &boxes, const double bin_size_x,
+               const double bin_size_eta);
+
+    //! returns the sources whose footprints may contain (x, y, eta_s)
+    Range get_sources(const double x, const double y,
+                      const double eta_s) const;
+
+    int get_number_of_bins() const {return(nx_*ny_*neta_);}
+
+    //! sets box to the union of the footprints, returns false if there
+    //! are no sources
+    bool get_extent(Box &box) const {
+        box = {x0_, x1_, y0_, y1_, eta0_, eta1_};
+        return(nx_ > 0);
+    }
+
+ private:
+    //! the maximum number of bins along each direction
+    static const int kMaxBins = 128;
+
+    int nx_ = 0, ny_ = 0, neta_ = 0;
+    double x0_ = 0., y0_ = 0., eta0_ = 0.;
+    double x1_ = 0., y1_ = 0., eta1_ = 0.;
+    double dx_ = 1., dy_ = 1., deta_ = 1.;
+    //! the sources of bin i are source_ids_[bin_start_[i]:bin_start_[i+1]]
+    std::vector<int> bin_start_;
+    std::vector<int> source_ids_;
+
+    int get_bin_index(const double value, const double min,
+                      const double bin_size, const int n_bins) const;
+};
+
+#endif  // SRC_SOURCE_BIN_INDEX_H_
@@ -0,0 +1,52 @@
+#include "doctest.h"
+#include "source_bin_index.h"
+#include <cmath>
+#include <vector>
+
+namespace {
+    bool is_inside(const SourceBinIndex::Box &box, const double x,
+                   const double y, const double eta_s) {
+        return(   x >= box.x_min && x <= box.x_max
+               && y >= box.y_min && y <= box.y_max
+               && eta_s >= box.eta_min && eta_s <= box.eta_max);
+    }
+}
+
+TEST_CASE("Check SourceBinIndex lists every source of a point in order") {
+    std::vector<SourceBinIndex::Box> boxes;
+    for (int i = 0; i < 300; i++) {
+        const double x = 8.*sin(1.3*i);
+        const double y = 6.*cos(0.7*i);
+        const double eta = 3.*sin(0.37*i);
+        const double length = 2.*fabs(sin(0.11*i));
+        boxes.push_back({x - 1., x + 1., y - 1., y + 1.,
+                         eta - 1., eta + 1. + length});
+    }
+    // an empty footprint
+    boxes.push_back({1., 0., 0., 1., 0., 1.});
+
+    SourceBinIndex index;
+    index.build(boxes, 1., 0.5);
+    CHECK(index.get_number_of_bins() > 1);
+    for (int ip = 0; ip < 2000; ip++) {
+        const double x = 9.5*sin(0.91*ip);
+        const double y = 7.*sin(0.53*ip + 1.);
+        const double eta = 4.5*cos(0.29*ip);
+        std::vector<int> listed;
+        for (const int i: index.get_sources(x, y, eta)) listed.push_back(i);
+        for (unsigned int j = 1; j < listed.size(); j++) {
+            CHECK(listed[j - 1] < listed[j]);
+        }
+        unsigned int j = 0;
+        for (unsigned int i = 0; i < boxes.size(); i++) {
+            if (!is_inside(boxes[i], x, y, eta)) continue;
+            while (j < listed.size() && listed[j] < static_cast<int>(i)) j++;
+            REQUIRE(j < listed.size());
+            CHECK(listed[j] == static_cast<int>(i));
+        }
+    }
+    CHECK(index.get_sources(0., 0., 100.).empty());
+
+    index.build({}, 1., 1.);
+    CHECK(index.get_sources(0., 0., 0.).empty());
+}
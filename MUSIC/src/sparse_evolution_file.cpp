@@ -0,0 +1,207 @@
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include "sparse_evolution_file.h"
+
+namespace {
+    const char kMagic[8] = {'M', 'U', 'S', 'I', 'C', 'E', 'V', 'S'};
+    const char kFrameTag[4] = {'F', 'R', 'M', 'E'};
+
+    //! the header size before the field names
+    const size_t kHeaderSize = (8 + 2*sizeof(int32_t)
+                                + sizeof(ChunkedEvolutionGrid)
+                                + sizeof(int32_t));
+    const size_t kFrameHeaderSize = 32;
+
+    //! the frame header, in the order of the file
+    struct FrameHeader {
+        char tag[4];
+        int32_t selection;
+        double tau;
+        int32_t itau;
+        int32_t n_points;
+        int64_t data_size;
+    };
+    static_assert(sizeof(FrameHeader) == kFrameHeaderSize,
+                  "unexpected padding of the frame header");
+
+    size_t get_number_of_words(const int64_t n_points) {
+        return(static_cast<size_t>((n_points + 63)/64));
+    }
+}
+
+const int32_t SparseEvolutionWriter::kFormatVersion;
+
+
+SparseEvolutionWriter::SparseEvolutionWriter(
+        const std::string &filename, const ChunkedEvolutionGrid &grid,
+        const std::vector<std::string> &field_names) :
+        file_(nullptr), grid_(grid),
+        n_fields_(static_cast<int>(field_names.size())), n_frames_(0) {
+    if (grid_.get_number_of_points() > UINT32_MAX) {
+        music_message << "SparseEvolutionWriter: "
+                      << grid_.get_number_of_points()
+                      << " output points do not fit the uint32 indices";
+        music_message.flush("error");
+        exit(1);
+    }
+    file_ = fopen(filename.c_str(), "wb");
+    if (file_ == nullptr) {
+        music_message << "SparseEvolutionWriter: can not open file "
+                      << filename;
+        music_message.flush("error");
+        exit(1);
+    }
+    std::string names;
+    for (int i = 0; i < n_fields_; i++) {
+        if (i > 0) names += ",";
+        names += field_names[i];
+    }
+    names.resize(names.size() + (8 - (kHeaderSize + names.size())%8)%8,
+                 '\0');
+    const int32_t header[2] = {kFormatVersion, n_fields_};
+    const int32_t names_length = static_cast<int32_t>(names.size());
+    fwrite(kMagic, sizeof(char), 8, file_);
+    fwrite(header, sizeof(int32_t), 2, file_);
+    fwrite(&grid_, sizeof(ChunkedEvolutionGrid), 1, file_);
+    fwrite(&names_length, sizeof(int32_t), 1, file_);
+    fwrite(names.data(), sizeof(char), names_length, file_);
+}
+
+
+SparseEvolutionWriter::~SparseEvolutionWriter() {
+    close();
+}
+
+
+void SparseEvolutionWriter::write_frame(const double tau,
+                                        const std::vector<uint32_t> &points,
+                                        const float *fields) {
+    const size_t n_points = points.size();
+    const size_t n_words = get_number_of_words(grid_.get_number_of_points());
+    const int32_t selection = (
+        n_words*sizeof(uint64_t) < n_points*sizeof(uint32_t) ? kBitmask
+                                                             : kIndexList);
+    const size_t selection_size = (
+        selection == kBitmask ? n_words*sizeof(uint64_t)
+                              : n_points*sizeof(uint32_t));
+
+    FrameHeader frame_header;
+    std::memcpy(frame_header.tag, kFrameTag, 4);
+    frame_header.selection = selection;
+    frame_header.tau = tau;
+    frame_header.itau = n_frames_;
+    frame_header.n_points = static_cast<int32_t>(n_points);
+    frame_header.data_size = static_cast<int64_t>(
+                selection_size + n_fields_*n_points*sizeof(float));
+    fwrite(&frame_header, sizeof(FrameHeader), 1, file_);
+    if (selection == kBitmask) {
+        bitmask_.assign(n_words, 0);
+        for (const uint32_t point : points) {
+            bitmask_[point/64] |= (uint64_t(1) << (point%64));
+        }
+        fwrite(bitmask_.data(), sizeof(uint64_t), n_words, file_);
+    } else {
+        fwrite(points.data(), sizeof(uint32_t), n_points, file_);
+    }
+    fwrite(fields, sizeof(float), n_fields_*n_points, file_);
+    n_frames_++;
+}
+
+
+void SparseEvolutionWriter::close() {
+    if (file_ == nullptr) return;
+    fclose(file_);
+    file_ = nullptr;
+}
+
+
+SparseEvolutionReader::SparseEvolutionReader(const std::string &filename) :
+        file_(nullptr) {
+    file_ = fopen(filename.c_str(), "rb");
+    if (file_ == nullptr) {
+        music_message << "SparseEvolutionReader: can not open file "
+                      << filename;
+        music_message.flush("error");
+        exit(1);
+    }
+    char magic[8];
+    int32_t header[2] = {0, 0};
+    int32_t names_length = 0;
+    bool valid = (fread(magic, sizeof(char), 8, file_) == 8
+                  && std::memcmp(magic, kMagic, 8) == 0
+                  && fread(header, sizeof(int32_t), 2, file_) == 2
+                  && header[0] == SparseEvolutionWriter::kFormatVersion
+                  && fread(&grid_, sizeof(ChunkedEvolutionGrid), 1,
+                           file_) == 1
+                  && fread(&names_length, sizeof(int32_t), 1, file_) == 1
+                  && names_length >= 0);
+    std::string names(valid ? names_length : 0, '\0');
+    if (valid) {
+        valid = (fread(&names[0], sizeof(char), names_length, file_)
+                 == static_cast<size_t>(names_length));
+    }
+    if (!valid) {
+        music_message << "SparseEvolutionReader: " << filename
+                      << " is not a sparse evolution file";
+        music_message.flush("error");
+        exit(1);
+    }
+    names.resize(std::strlen(names.c_str()));
+    size_t start = 0;
+    for (int i = 0; i < header[1]; i++) {
+        const size_t end = std::min(names.find(',', start), names.size());
+        field_names_.push_back(names.substr(start, end - start));
+        start = end + 1;
+    }
+}
+
+
+SparseEvolutionReader::~SparseEvolutionReader() {
+    if (file_ != nullptr) fclose(file_);
+}
+
+
+bool SparseEvolutionReader::read_frame(SparseEvolutionFrame &frame) {
+    FrameHeader frame_header;
+    if (fread(&frame_header, sizeof(FrameHeader), 1, file_) != 1
+            || std::memcmp(frame_header.tag, kFrameTag, 4) != 0
+            || frame_header.n_points < 0) {
+        return(false);
+    }
+    const size_t n_points = frame_header.n_points;
+    const int64_t n_grid = grid_.get_number_of_points();
+    frame.tau = frame_header.tau;
+    frame.itau = frame_header.itau;
+    frame.points.resize(n_points);
+    if (frame_header.selection == SparseEvolutionWriter::kBitmask) {
+        std::vector<uint64_t> bitmask(get_number_of_words(n_grid));
+        if (fread(bitmask.data(), sizeof(uint64_t), bitmask.size(), file_)
+                != bitmask.size()) {
+            return(false);
+        }
+        size_t i = 0;
+        for (int64_t point = 0; point < n_grid && i < n_points; point++) {
+            if ((bitmask[point/64] >> (point%64)) & 1) {
+                frame.points[i++] = static_cast<uint32_t>(point);
+            }
+        }
+        if (i != n_points) return(false);
+    } else if (frame_header.selection == SparseEvolutionWriter::kIndexList) {
+        if (fread(frame.points.data(), sizeof(uint32_t), n_points, file_)
+                != n_points) {
+            return(false);
+        }
+    } else {
+        return(false);
+    }
+    frame.fields.resize(get_number_of_fields());
+    for (auto &field : frame.fields) {
+        field.resize(n_points);
+        if (fread(field.data(), sizeof(float), n_points, file_)
+                != n_points) {
+            return(false);
+        }
+    }
+    return(true);
+}
@@ -0,0 +1,105 @@
+#ifndef SRC_SPARSE_EVOLUTION_FILE_H_
+#define SRC_SPARSE_EVOLUTION_FILE_H_
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "chunked_evolution_file.h"
+#include "pretty_ostream.h"
+
+//! one tau of a sparse evolution file: the output points above the cut
+//! (in increasing order, ix innermost and ieta outermost) and the fields
+//! of these points, fields[field][i] for the point points[i]
+struct SparseEvolutionFrame {
+    double tau = 0.;
+    int itau = 0;
+    std::vector<uint32_t> points;
+    std::vector<std::vector<float>> fields;
+};
+
+
+//! This class writes a sparse hydro evolution file. Each frame holds the
+//! output points of one tau above the cut of the evolution output and
+//! the fields of these points only, so the late stages with few cells
+//! above the cut take little space.
+//!
+//! File layout: the 8 char magic "MUSICEVS", the int32 format version,
+//! the int32 number of fields, the ChunkedEvolutionGrid, the int32 length
+//! of the comma separated field names and the names padded with '\0' to a
+//! multiple of 8 bytes of the header. The frames follow, each a 32 byte
+//! header (the 4 char tag "FRME", the int32 selection, the double tau,
+//! the int32 tau index, the int32 number of points, the int64 size of
+//! the data after the header), the selection of the points and the
+//! fields one after the other, each with one float per point. The
+//! selection is a bitmask (bit i%64 of the uint64 word i/64 for the
+//! output point i) or the uint32 list of the points, whichever is
+//! smaller.
+class SparseEvolutionWriter {
+ public:
+    //! the encodings of the points of a frame
+    enum Selection {
+        kBitmask = 0,    //!< one bit per output point
+        kIndexList = 1,  //!< the uint32 index of each point
+    };
+    static const int32_t kFormatVersion = 1;
+
+ private:
+    FILE *file_;
+    const ChunkedEvolutionGrid grid_;
+    const int n_fields_;
+    int n_frames_;
+    std::vector<uint64_t> bitmask_;
+    pretty_ostream music_message;
+
+ public:
+    SparseEvolutionWriter(const std::string &filename,
+                          const ChunkedEvolutionGrid &grid,
+                          const std::vector<std::string> &field_names);
+    ~SparseEvolutionWriter();
+
+    SparseEvolutionWriter(const SparseEvolutionWriter&) = delete;
+    SparseEvolutionWriter& operator=(const SparseEvolutionWriter&) = delete;
+
+    //! appends the frame at tau with the output points in increasing
+    //! order and the fields of the points, fields[field*n_points + i] for
+    //! the point points[i]
+    void write_frame(const double tau, const std::vector<uint32_t> &points,
+                     const float *fields);
+
+    void close();
+};
+
+
+//! This class reads the frames of a file written by SparseEvolutionWriter
+//! one after the other
+class SparseEvolutionReader {
+ private:
+    FILE *file_;
+    ChunkedEvolutionGrid grid_;
+    std::vector<std::string> field_names_;
+    pretty_ostream music_message;
+
+ public:
+    //! opens filename, exits with an error if it is not a sparse
+    //! evolution file
+    explicit SparseEvolutionReader(const std::string &filename);
+    ~SparseEvolutionReader();
+
+    SparseEvolutionReader(const SparseEvolutionReader&) = delete;
+    SparseEvolutionReader& operator=(const SparseEvolutionReader&) = delete;
+
+    const ChunkedEvolutionGrid &get_grid() const {return(grid_);}
+    int get_number_of_fields() const {
+        return(static_cast<int>(field_names_.size()));
+    }
+    const std::string &get_field_name(const int field) const {
+        return(field_names_[field]);
+    }
+
+    //! reads the next frame. It returns false at the end of the file or
+    //! at a frame cut off by the end of the file.
+    bool read_frame(SparseEvolutionFrame &frame);
+};
+
+#endif  // SRC_SPARSE_EVOLUTION_FILE_H_
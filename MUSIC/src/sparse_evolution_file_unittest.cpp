@@ -0,0 +1,116 @@
+#include "doctest.h"
+#include "sparse_evolution_file.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+    ChunkedEvolutionGrid get_test_grid() {
+        ChunkedEvolutionGrid grid;
+        grid.nx = 10;
+        grid.ny = 8;
+        grid.neta = 2;
+        grid.tau0 = 0.4;
+        grid.dtau = 0.1;
+        grid.dx = 0.5;
+        grid.dy = 0.5;
+        grid.deta = 0.2;
+        grid.x_min = -2.5;
+        grid.y_min = -2.0;
+        grid.eta_min = -0.2;
+        return(grid);
+    }
+
+    //! every step-th output point above the cut, a shrinking fireball
+    std::vector<uint32_t> get_test_points(const int itau) {
+        const int step = 1 + 3*itau;
+        std::vector<uint32_t> points;
+        for (uint32_t i = 0; i < 160; i += step) points.push_back(i);
+        return(points);
+    }
+
+    float get_test_value(const int itau, const int field, const uint32_t i) {
+        return(0.25f*itau + 10.f*field + 0.001f*i);
+    }
+}
+
+TEST_CASE("Check SparseEvolutionWriter and Reader round trip") {
+    const std::string filename = "test_sparse_evolution.dat";
+    const int n_tau = 4;
+    {
+        const ChunkedEvolutionGrid grid = get_test_grid();
+        SparseEvolutionWriter writer(filename, grid, {"T", "ux", "muB"});
+        for (int itau = 0; itau < n_tau; itau++) {
+            const std::vector<uint32_t> points = get_test_points(itau);
+            std::vector<float> fields;
+            for (int field = 0; field < 3; field++) {
+                for (const uint32_t point : points) {
+                    fields.push_back(get_test_value(itau, field, point));
+                }
+            }
+            writer.write_frame(grid.tau0 + itau*grid.dtau, points,
+                               fields.data());
+        }
+        // a frame without any cell above the cut
+        writer.write_frame(grid.tau0 + n_tau*grid.dtau, {}, nullptr);
+    }
+
+    SparseEvolutionReader reader(filename);
+    CHECK(reader.get_grid().nx == 10);
+    CHECK(reader.get_grid().eta_min == -0.2);
+    REQUIRE(reader.get_number_of_fields() == 3);
+    CHECK(reader.get_field_name(2) == "muB");
+    SparseEvolutionFrame frame;
+    for (int itau = 0; itau < n_tau; itau++) {
+        REQUIRE(reader.read_frame(frame));
+        CHECK(frame.itau == itau);
+        CHECK(frame.tau == doctest::Approx(0.4 + 0.1*itau));
+        const std::vector<uint32_t> points = get_test_points(itau);
+        REQUIRE(frame.points == points);
+        bool all_equal = true;
+        for (int field = 0; field < 3; field++) {
+            for (size_t i = 0; i < points.size(); i++) {
+                all_equal = (all_equal && frame.fields[field][i]
+                             == get_test_value(itau, field, points[i]));
+            }
+        }
+        CHECK(all_equal);
+    }
+    REQUIRE(reader.read_frame(frame));
+    CHECK(frame.points.empty());
+    CHECK(!reader.read_frame(frame));
+    remove(filename.c_str());
+}
+
+TEST_CASE("Check SparseEvolutionWriter stores the smaller selection") {
+    const std::string filename = "test_sparse_evolution_size.dat";
+    const ChunkedEvolutionGrid grid = get_test_grid();
+    {
+        SparseEvolutionWriter writer(filename, grid, {"T"});
+        // all 160 points: the bitmask of 3 words is smaller than the list
+        std::vector<uint32_t> all_points(160);
+        for (uint32_t i = 0; i < 160; i++) all_points[i] = i;
+        const std::vector<float> all_fields(160, 1.f);
+        writer.write_frame(0.4, all_points, all_fields.data());
+        // 3 points: the list is smaller than the bitmask
+        const std::vector<float> few_fields(3, 2.f);
+        writer.write_frame(0.5, {5, 70, 159}, few_fields.data());
+    }
+    FILE *file = fopen(filename.c_str(), "rb");
+    fseek(file, 0, SEEK_END);
+    const long file_size = ftell(file);
+    fclose(file);
+    // the header with the names padded to 8 bytes, then the two frames
+    const long header_size = 8 + 8 + 80 + 4 + 4;
+    CHECK(file_size == header_size + (32 + 3*8 + 160*4) + (32 + 3*4 + 3*4));
+
+    SparseEvolutionReader reader(filename);
+    SparseEvolutionFrame frame;
+    REQUIRE(reader.read_frame(frame));
+    CHECK(frame.points.size() == 160);
+    CHECK(frame.points[159] == 159);
+    REQUIRE(reader.read_frame(frame));
+    CHECK(frame.points == std::vector<uint32_t>({5, 70, 159}));
+    CHECK(frame.fields[0][2] == 2.f);
+    remove(filename.c_str());
+}
@@ -0,0 +1,160 @@
+#include <algorithm>
+#include <cmath>
+#include "spectrum_moments.h"
+
+SpectrumMoments::SpectrumMoments(const int n_harmonics,
+                                 const std::vector<double> &pt,
+                                 const int n_rap)
+    : n_harmonics_(n_harmonics), n_rap_(n_rap), pt_(pt),
+      rap_(pt.size()*n_rap, 0.),
+      moments_(pt.size()*n_rap*2*n_harmonics, 0.),
+      cumulative_(pt.size()*n_rap*2*n_harmonics, 0.) {}
+
+
+void SpectrumMoments::set_node(const int ipt, const int irap,
+                               const double rap, const double *moments) {
+    rap_[static_cast<size_t>(ipt)*n_rap_ + irap] = rap;
+    double *node = &moments_[(static_cast<size_t>(ipt)*n_rap_ + irap)
+                             *get_n_values()];
+    std::copy(moments, moments + get_n_values(), node);
+}
+
+
+void SpectrumMoments::add(const SpectrumMoments &other) {
+    for (size_t i = 0; i < moments_.size(); i++) {
+        moments_[i] += other.moments_[i];
+    }
+}
+
+
+void SpectrumMoments::integrate() {
+    const int n_values = get_n_values();
+    const int npt = static_cast<int>(pt_.size());
+    for (int ipt = 0; ipt < npt; ipt++) {
+        const double *rap = &rap_[static_cast<size_t>(ipt)*n_rap_];
+        double *cumulative = &cumulative_[static_cast<size_t>(ipt)*n_rap_
+                                          *n_values];
+        std::fill(cumulative, cumulative + n_values, 0.);
+        for (int irap = 1; irap < n_rap_; irap++) {
+            const double h = rap[irap] - rap[irap - 1];
+            const double *f_low = get_moments(ipt, irap - 1);
+            const double *f_high = get_moments(ipt, irap);
+            for (int i = 0; i < n_values; i++) {
+                cumulative[irap*n_values + i] = (
+                    cumulative[(irap - 1)*n_values + i]
+                    + 0.5*h*(f_low[i] + f_high[i]));
+            }
+        }
+    }
+}
+
+
+int SpectrumMoments::get_segment(const int ipt, const double rap) const {
+    if (n_rap_ < 2) return(0);
+    const double *nodes = &rap_[static_cast<size_t>(ipt)*n_rap_];
+    const int i = static_cast<int>(
+                std::upper_bound(nodes, nodes + n_rap_, rap) - nodes) - 1;
+    return(std::max(0, std::min(n_rap_ - 2, i)));
+}
+
+
+void SpectrumMoments::add_interpolation(const int ipt, const int i,
+                                        const double frac,
+                                        const double weight,
+                                        double *values) const {
+    const double *f_low = get_moments(ipt, i);
+    const double *f_high = (n_rap_ > 1) ? get_moments(ipt, i + 1) : f_low;
+    for (int k = 0; k < get_n_values(); k++) {
+        values[k] += weight*(f_low[k] + frac*(f_high[k] - f_low[k]));
+    }
+}
+
+
+void SpectrumMoments::add_primitive(const int ipt, const double rap,
+                                    const double weight,
+                                    double *values) const {
+    const int n_values = get_n_values();
+    const double *nodes = &rap_[static_cast<size_t>(ipt)*n_rap_];
+    if (n_rap_ < 2) {
+        // a boost-invariant spectrum is flat in rapidity
+        add_interpolation(ipt, 0, 0., weight*(rap - nodes[0]), values);
+        return;
+    }
+    const int i = get_segment(ipt, rap);
+    const double delta = rap - nodes[i];
+    const double frac = delta/(nodes[i + 1] - nodes[i]);
+    const double *cumulative = &cumulative_[(static_cast<size_t>(ipt)*n_rap_
+                                             + i)*n_values];
+    const double *f_low = get_moments(ipt, i);
+    const double *f_high = get_moments(ipt, i + 1);
+    for (int k = 0; k < n_values; k++) {
+        values[k] += weight*(cumulative[k]
+                             + delta*(f_low[k]
+                                      + 0.5*frac*(f_high[k] - f_low[k])));
+    }
+}
+
+
+void SpectrumMoments::get_rapidity_integrated(const int ipt,
+                                              const double minrap,
+                                              const double maxrap,
+                                              double *values) const {
+    std::fill(values, values + get_n_values(), 0.);
+    if (minrap < maxrap) {
+        add_primitive(ipt, maxrap, 1., values);
+        add_primitive(ipt, minrap, -1., values);
+        return;
+    }
+    const int i = get_segment(ipt, maxrap);
+    double frac = 0.;
+    if (n_rap_ > 1) {
+        const double *nodes = &rap_[static_cast<size_t>(ipt)*n_rap_];
+        frac = (maxrap - nodes[i])/(nodes[i + 1] - nodes[i]);
+    }
+    add_interpolation(ipt, i, frac, 1., values);
+}
+
+
+void SpectrumMoments::get_integrated(const double minpt, const double maxpt,
+                                     const double minrap,
+                                     const double maxrap,
+                                     double *values) const {
+    const int n_values = get_n_values();
+    const int npt = static_cast<int>(pt_.size());
+    std::fill(values, values + n_values, 0.);
+
+    // the rapidity-integrated moments of the nodes of a pT segment
+    std::vector<double> low(n_values), high(n_values);
+    const auto segment = [&](const double pt) {
+        const int i = static_cast<int>(
+            std::upper_bound(pt_.begin(), pt_.end(), pt) - pt_.begin()) - 1;
+        return(std::max(0, std::min(npt - 2, i)));
+    };
+    const auto add_linear = [&](const int i, const double pt,
+                                const double weight) {
+        const double frac = (pt - pt_[i])/(pt_[i + 1] - pt_[i]);
+        for (int k = 0; k < n_values; k++) {
+            values[k] += weight*(low[k] + frac*(high[k] - low[k]));
+        }
+    };
+
+    const int i_min = segment(minpt);
+    if (std::abs(minpt - maxpt) <= 1e-6) {
+        get_rapidity_integrated(i_min, minrap, maxrap, low.data());
+        get_rapidity_integrated(i_min + 1, minrap, maxrap, high.data());
+        add_linear(i_min, minpt, 1.);
+        return;
+    }
+    const int i_max = segment(maxpt);
+    get_rapidity_integrated(i_min, minrap, maxrap, high.data());
+    for (int i = i_min; i <= i_max; i++) {
+        low.swap(high);
+        get_rapidity_integrated(i + 1, minrap, maxrap, high.data());
+        // the trapezoid of the part of the segment in [minpt, maxpt]
+        const double pt_low = std::max(minpt, pt_[i]);
+        const double pt_high = std::min(maxpt, pt_[i + 1]);
+        const double half_width = 0.5*(pt_high - pt_low);
+        add_linear(i, pt_low, half_width);
+        add_linear(i, pt_high, half_width);
+    }
+}
@@ -0,0 +1,78 @@
+#ifndef SRC_SPECTRUM_MOMENTS_H_
+#define SRC_SPECTRUM_MOMENTS_H_
+
+#include <cstddef>
+#include <vector>
+
+//! This class holds the Fourier moments in phi of the spectrum of a
+//! particle species (or the sum of several species on the same grid),
+//!     M_n(pT, y) = int dphi {cos(n phi), sin(n phi)} dN/(dy dpT dphi),
+//! on its pT and (pseudo-)rapidity nodes, with their cumulative integrals
+//! over the rapidity nodes of each pT. Like the linear splines of the flow
+//! integrals, the moments are linear between the nodes, so the integral of
+//! a rapidity range is the difference of two cumulative sums, and the pT
+//! integral is the trapezoid sum over the pT nodes of these.
+class SpectrumMoments {
+ private:
+    const int n_harmonics_;
+    const int n_rap_;
+    std::vector<double> pt_;
+    //! [ipt][irap] the rapidity nodes
+    std::vector<double> rap_;
+    //! [ipt][irap][n][cos, sin] the moments and their integrals from the
+    //! first rapidity node
+    std::vector<double> moments_;
+    std::vector<double> cumulative_;
+
+    int get_n_values() const {return(2*n_harmonics_);}
+    const double *get_moments(const int ipt, const int irap) const {
+        return(&moments_[(static_cast<size_t>(ipt)*n_rap_ + irap)
+                         *get_n_values()]);
+    }
+
+    //! the index i of the rapidity segment [rap_i, rap_{i+1}] of rap at the
+    //! pT node ipt, the last one beyond the nodes
+    int get_segment(const int ipt, const double rap) const;
+
+    //! the linear interpolation of the moments with the weight of the node
+    //! i + 1 frac, e.g. at the end of an integrated segment
+    void add_interpolation(const int ipt, const int i, const double frac,
+                           const double weight, double *values) const;
+
+    //! adds weight times the integral of the moments from the first
+    //! rapidity node to rap
+    void add_primitive(const int ipt, const double rap, const double weight,
+                       double *values) const;
+
+ public:
+    SpectrumMoments(const int n_harmonics, const std::vector<double> &pt,
+                    const int n_rap);
+
+    int get_number_of_harmonics() const {return(n_harmonics_);}
+
+    //! sets the moments of the node (ipt, irap) at the rapidity rap,
+    //! moments[2*n + k] of cos (k = 0) and sin (k = 1). The rapidity nodes
+    //! of a pT have to increase.
+    void set_node(const int ipt, const int irap, const double rap,
+                  const double *moments);
+
+    //! adds the moments of other, which has to have the same nodes
+    void add(const SpectrumMoments &other);
+
+    //! computes the cumulative integrals, once all the nodes are set
+    void integrate();
+
+    //! the moments of the pT node ipt integrated over [minrap, maxrap], or
+    //! their value at minrap if minrap == maxrap
+    void get_rapidity_integrated(const int ipt, const double minrap,
+                                 const double maxrap, double *values) const;
+
+    //! the moments integrated over [minpt, maxpt] and [minrap, maxrap],
+    //! or their values at minpt (minrap) if the pT (rapidity) range is
+    //! shorter than 1e-6 (empty)
+    void get_integrated(const double minpt, const double maxpt,
+                        const double minrap, const double maxrap,
+                        double *values) const;
+};
+
+#endif  // SRC_SPECTRUM_MOMENTS_H_
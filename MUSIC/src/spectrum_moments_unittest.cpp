@@ -0,0 +1,90 @@
+#include <vector>
+#include "doctest.h"
+#include "spectrum_moments.h"
+
+namespace {
+    //! moments linear in pT and in y, which the linear interpolation of
+    //! the nodes reproduces
+    double get_moment(const int k, const double pt, const double y) {
+        return((k + 1)*(1. + 2.*y + 3.*pt + 0.5*pt*y));
+    }
+
+    //! its integral over [pt_1, pt_2] x [y_1, y_2]
+    double get_integral(const int k, const double pt_1, const double pt_2,
+                        const double y_1, const double y_2) {
+        const double dpt = pt_2 - pt_1;
+        const double dy = y_2 - y_1;
+        const double pt_mean = 0.5*(pt_1 + pt_2);
+        const double y_mean = 0.5*(y_1 + y_2);
+        return((k + 1)*dpt*dy*(1. + 2.*y_mean + 3.*pt_mean
+                               + 0.5*pt_mean*y_mean));
+    }
+}
+
+TEST_CASE("Check SpectrumMoments integrates the linear interpolation") {
+    const int n_harmonics = 3;
+    const int npt = 6;
+    const int n_rap = 5;
+    std::vector<double> pt(npt);
+    for (int ipt = 0; ipt < npt; ipt++) pt[ipt] = 0.01 + 0.1*ipt*ipt;
+    SpectrumMoments moments(n_harmonics, pt, n_rap);
+    for (int ipt = 0; ipt < npt; ipt++)
+    for (int irap = 0; irap < n_rap; irap++) {
+        // the rapidity nodes depend on pT, as for the pseudo-rapidity grid
+        const double y = -2. + irap*(1. - 0.02*ipt) + 0.01*ipt*irap*irap;
+        double node[2*n_harmonics];
+        for (int k = 0; k < 2*n_harmonics; k++) {
+            node[k] = get_moment(k, pt[ipt], y);
+        }
+        moments.set_node(ipt, irap, y, node);
+    }
+    moments.integrate();
+
+    double values[2*n_harmonics];
+    moments.get_integrated(0.05, 1.7, -0.7, 1.1, values);
+    for (int k = 0; k < 2*n_harmonics; k++) {
+        CHECK(values[k]
+              == doctest::Approx(get_integral(k, 0.05, 1.7, -0.7, 1.1)));
+    }
+
+    // the values at a pT and a rapidity
+    moments.get_integrated(0.5, 0.5, 0.2, 0.2, values);
+    for (int k = 0; k < 2*n_harmonics; k++) {
+        CHECK(values[k] == doctest::Approx(get_moment(k, 0.5, 0.2)));
+    }
+    moments.get_rapidity_integrated(2, 0., 0., values);
+    CHECK(values[1] == doctest::Approx(get_moment(1, pt[2], 0.)));
+    moments.get_integrated(0.3, 0.3, -1., 1., values);
+    CHECK(values[0] == doctest::Approx(2.*get_moment(0, 0.3, 0.)));
+
+    // the sum of two species on the same nodes
+    SpectrumMoments sum(moments);
+    sum.add(moments);
+    sum.integrate();
+    // dN/dy at y = -1, the integral over a unit range around it
+    sum.get_integrated(pt[0], pt[npt - 1], -1., -1., values);
+    CHECK(values[5] == doctest::Approx(
+                    2.*get_integral(5, pt[0], pt[npt - 1], -1.5, -0.5)));
+    double single[2*n_harmonics];
+    moments.get_integrated(pt[1], pt[4], -1., 0.5, single);
+    sum.get_integrated(pt[1], pt[4], -1., 0.5, values);
+    for (int k = 0; k < 2*n_harmonics; k++) {
+        CHECK(values[k] == doctest::Approx(2.*single[k]));
+    }
+}
+
+TEST_CASE("Check SpectrumMoments of a boost-invariant spectrum") {
+    std::vector<double> pt = {0.1, 0.5, 1.0};
+    SpectrumMoments moments(1, pt, 1);
+    for (int ipt = 0; ipt < 3; ipt++) {
+        double node[2] = {2.*pt[ipt], 0.};
+        moments.set_node(ipt, 0, 0., node);
+    }
+    moments.integrate();
+    double values[2];
+    moments.get_integrated(0.1, 1.0, -0.5, 0.5, values);
+    CHECK(values[0] == doctest::Approx(1.0*1.0 - 0.1*0.1));
+    CHECK(values[1] == 0.);
+    moments.get_integrated(0.3, 0.3, 1.2, 1.2, values);
+    CHECK(values[0] == doctest::Approx(0.6));
+}
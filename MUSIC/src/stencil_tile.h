@@ -0,0 +1,64 @@
+#ifndef SRC_STENCIL_TILE_H_
+#define SRC_STENCIL_TILE_H_
+
+#include <array>
+#include <cassert>
+#include <cstdlib>
+#include "cell.h"
+#include "grid.h"
+
+//! local copy of the 13-point KT stencil of the cell (cx, cy, ceta):
+//! the cell itself and its 2 neighbours on each side along x, y, and eta.
+//! It has the operator() and getHalo of a grid for the cells of the
+//! stencil, so the sweeps and Neighbourloop run on it unchanged while the
+//! stencil is read from the grid only once.
+template<class T>
+class StencilTile {
+ private:
+    // slot 0 is the center, then m2, m1, p1, p2 along x, y, and eta
+    std::array<T, 13> cells;
+    int cx, cy, ceta;
+
+    static int slot(const int dx, const int dy, const int deta) {
+        static const int offset_slot[5] = {0, 1, -1, 2, 3};
+        if (dx != 0) return 1 + offset_slot[dx + 2];
+        if (dy != 0) return 5 + offset_slot[dy + 2];
+        if (deta != 0) return 9 + offset_slot[deta + 2];
+        return 0;
+    }
+
+ public:
+    template<class Grid>
+    StencilTile(Grid &arena, const int cx_in, const int cy_in,
+                const int ceta_in) : cx(cx_in), cy(cy_in), ceta(ceta_in) {
+        cells[0] = arena(cx, cy, ceta);
+        for (int d = -2; d <= 2; d++) {
+            if (d == 0) continue;
+            cells[slot(d, 0, 0)] = arena.getHalo(cx + d, cy, ceta);
+            cells[slot(0, d, 0)] = arena.getHalo(cx, cy + d, ceta);
+            cells[slot(0, 0, d)] = arena.getHalo(cx, cy, ceta + d);
+        }
+    }
+
+    T& operator()(const int x, const int y, const int eta) {
+        assert(x == cx && y == cy && eta == ceta);
+        return cells[0];
+    }
+
+    const T& operator()(const int x, const int y, const int eta) const {
+        assert(x == cx && y == cy && eta == ceta);
+        return cells[0];
+    }
+
+    const T& getHalo(const int x, const int y, const int eta) const {
+        assert(   (x != cx) + (y != cy) + (eta != ceta) <= 1);
+        assert(std::abs(x - cx) <= 2 && std::abs(y - cy) <= 2
+               && std::abs(eta - ceta) <= 2);
+        return cells[slot(x - cx, y - cy, eta - ceta)];
+    }
+};
+
+typedef StencilTile<Cell_small> SCStencil;
+typedef StencilTile<Cell_thermo> ThermoStencil;
+
+#endif  // SRC_STENCIL_TILE_H_
@@ -0,0 +1,193 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include "surface_coarsening.h"
+
+SurfaceCoarsening::SurfaceCoarsening(const InitData &DATA_in,
+                                     const bool boost_invariant)
+    : DATA(DATA_in), boost_invariant_(boost_invariant) {
+    const int factor = std::max(1, DATA.surface_coarsening_factor);
+    block_size_[0] = factor*DATA.facTau*DATA.delta_tau;
+    block_size_[1] = factor*DATA.fac_x*DATA.delta_x;
+    block_size_[2] = factor*DATA.fac_y*DATA.delta_y;
+    block_size_[3] = factor*DATA.fac_eta*DATA.delta_eta;
+}
+
+
+double SurfaceCoarsening::get_weight(const CompactSurface &surface,
+                                     const int i) {
+    const double tau = surface.get(SurfaceField::tau, i);
+    double sum = 0.;
+    for (int ii = 0; ii < 4; ii++) {
+        double dsigma = surface.get(SurfaceField::s + ii, i);
+        if (ii < 3) dsigma *= tau;
+        sum += dsigma*dsigma;
+    }
+    return(sqrt(sum));
+}
+
+
+bool SurfaceCoarsening::is_similar(const CompactSurface &surface,
+                                   const int i, const int i_first) const {
+    for (int ii = 0; ii < 4; ii++) {
+        if (std::abs(surface.get(SurfaceField::u + ii, i)
+                     - surface.get(SurfaceField::u + ii, i_first))
+                > DATA.surface_coarsening_u_tolerance) {
+            return(false);
+        }
+    }
+    const double T_first = surface.get(SurfaceField::T_f, i_first);
+    if (std::abs(surface.get(SurfaceField::T_f, i) - T_first)
+            > DATA.surface_coarsening_T_tolerance*T_first) {
+        return(false);
+    }
+    if (std::abs(surface.get(SurfaceField::mu_B, i)
+                 - surface.get(SurfaceField::mu_B, i_first))
+            > DATA.surface_coarsening_muB_tolerance*T_first) {
+        return(false);
+    }
+    const double e_plus_P = (
+        surface.get(SurfaceField::eps_plus_p_over_T, i_first)*T_first);
+    for (int ii = 0; ii < 10; ii++) {
+        if (std::abs(surface.get(SurfaceField::W + ii, i)
+                     - surface.get(SurfaceField::W + ii, i_first))
+                > DATA.surface_coarsening_W_tolerance*e_plus_P) {
+            return(false);
+        }
+    }
+    return(true);
+}
+
+
+void SurfaceCoarsening::coarsen(const CompactSurface &surface,
+                                CompactSurface &coarse) const {
+    const int n_cells = surface.size();
+    const int coordinate[4] = {SurfaceField::tau, SurfaceField::x,
+                               SurfaceField::y, SurfaceField::eta_s};
+    const int n_directions = boost_invariant_ ? 3 : 4;
+    double coordinate_min[4] = {0., 0., 0., 0.};
+    int64_t n_blocks[4] = {1, 1, 1, 1};
+    for (int d = 0; d < n_directions && n_cells > 0; d++) {
+        double x_min = surface.get(coordinate[d], 0);
+        double x_max = x_min;
+        for (int i = 1; i < n_cells; i++) {
+            const double x = surface.get(coordinate[d], i);
+            x_min = std::min(x_min, x);
+            x_max = std::max(x_max, x);
+        }
+        coordinate_min[d] = x_min;
+        n_blocks[d] = static_cast<int64_t>(
+                            std::floor((x_max - x_min)/block_size_[d])) + 1;
+    }
+
+    // the groups of the elements
+    std::unordered_map<int64_t, std::vector<int>> block_groups;
+    std::vector<int> group_first;
+    std::vector<int> group_of(n_cells);
+    for (int i = 0; i < n_cells; i++) {
+        int64_t key = 0;
+        for (int d = 0; d < 4; d++) {
+            int64_t index = 0;
+            if (d < n_directions) {
+                index = static_cast<int64_t>(std::floor(
+                    (surface.get(coordinate[d], i) - coordinate_min[d])
+                    /block_size_[d]));
+                index = std::min(std::max(index, int64_t(0)),
+                                 n_blocks[d] - 1);
+            }
+            key = key*n_blocks[d] + index;
+        }
+        std::vector<int> &groups = block_groups[key];
+        int group = -1;
+        for (const int g : groups) {
+            if (is_similar(surface, i, group_first[g])) {
+                group = g;
+                break;
+            }
+        }
+        if (group < 0) {
+            group = static_cast<int>(group_first.size());
+            group_first.push_back(i);
+            groups.push_back(group);
+        }
+        group_of[i] = group;
+    }
+
+    // the sums of the normals and the weighted sums of the other fields
+    const int n_groups = static_cast<int>(group_first.size());
+    const int n_fields = SurfaceField::n_fields;
+    std::vector<double> weighted_sum(
+                        static_cast<size_t>(n_groups)*n_fields, 0.);
+    std::vector<double> weight_sum(n_groups, 0.);
+    std::vector<double> normal_sum(static_cast<size_t>(n_groups)*4, 0.);
+    for (int i = 0; i < n_cells; i++) {
+        const int g = group_of[i];
+        const double weight = get_weight(surface, i);
+        const double tau = surface.get(SurfaceField::tau, i);
+        weight_sum[g] += weight;
+        for (int field = 0; field < n_fields; field++) {
+            weighted_sum[static_cast<size_t>(g)*n_fields + field] += (
+                                        weight*surface.get(field, i));
+        }
+        for (int ii = 0; ii < 4; ii++) {
+            double dsigma = surface.get(SurfaceField::s + ii, i);
+            if (ii < 3) dsigma *= tau;
+            normal_sum[static_cast<size_t>(g)*4 + ii] += dsigma;
+        }
+    }
+
+    coarse.resize(n_groups);
+    for (int g = 0; g < n_groups; g++) {
+        const double *sum = &weighted_sum[static_cast<size_t>(g)*n_fields];
+        for (int field = 0; field < n_fields; field++) {
+            // the fields of the first element for a group of zero weight
+            const double value = (
+                weight_sum[g] > 0. ? sum[field]/weight_sum[g]
+                                   : surface.get(field, group_first[g]));
+            coarse.set(field, g, value);
+        }
+        const double tau = coarse.get(SurfaceField::tau, g);
+        for (int ii = 0; ii < 4; ii++) {
+            double dsigma = normal_sum[static_cast<size_t>(g)*4 + ii];
+            if (ii < 3) dsigma /= tau;
+            coarse.set(SurfaceField::s + ii, g, dsigma);
+        }
+        double u_spatial_sq = 0.;
+        for (int ii = 1; ii < 4; ii++) {
+            const double u = coarse.get(SurfaceField::u + ii, g);
+            u_spatial_sq += u*u;
+        }
+        coarse.set(SurfaceField::u, g, sqrt(1. + u_spatial_sq));
+        const double eta_s = (
+                boost_invariant_ ? 0. : coarse.get(SurfaceField::eta_s, g));
+        coarse.set(SurfaceField::eta_s, g, eta_s);
+        coarse.set(SurfaceField::sinh_eta_s, g, sinh(eta_s));
+        coarse.set(SurfaceField::cosh_eta_s, g, cosh(eta_s));
+    }
+}
+
+
+void SurfaceCoarsening::get_spectra_deviation(const double *full,
+                                              const double *coarse,
+                                              const int n,
+                                              double &sum_deviation,
+                                              double &max_deviation) {
+    double sum_full = 0., sum_coarse = 0., max_full = 0.;
+    for (int i = 0; i < n; i++) {
+        sum_full += full[i];
+        sum_coarse += coarse[i];
+        max_full = std::max(max_full, std::abs(full[i]));
+    }
+    sum_deviation = 0.;
+    if (sum_full != 0.) {
+        sum_deviation = std::abs(sum_coarse - sum_full)/std::abs(sum_full);
+    }
+    max_deviation = 0.;
+    for (int i = 0; i < n; i++) {
+        if (std::abs(full[i]) > 1e-3*max_full) {
+            max_deviation = std::max(
+                max_deviation, std::abs(coarse[i] - full[i])/std::abs(full[i]));
+        }
+    }
+}
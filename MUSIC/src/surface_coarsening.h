@@ -0,0 +1,59 @@
+#ifndef SRC_SURFACE_COARSENING_H_
+#define SRC_SURFACE_COARSENING_H_
+
+#include <vector>
+#include "compact_surface.h"
+#include "data.h"
+
+//! This class merges the neighbouring elements of a freeze-out surface
+//! with similar fluid fields, to cut the cost of Cooper-Frye, which is
+//! linear in the number of elements. The (tau, x, y, eta_s) space is cut
+//! into blocks of surface_coarsening_factor freeze-out cells
+//! (facTau*delta_tau, fac_x*delta_x, fac_y*delta_y, fac_eta*delta_eta) in
+//! every direction. The elements of a block are taken in order, and each
+//! joins the first group of the block whose first element is within the
+//! tolerances of it:
+//!
+//!     max |u^mu - u^mu_1| <= surface_coarsening_u_tolerance
+//!     |T - T_1| <= surface_coarsening_T_tolerance*T_1
+//!     |mu_B - mu_B_1| <= surface_coarsening_muB_tolerance*T_1
+//!     max |W^{mu nu} - W^{mu nu}_1|
+//!                <= surface_coarsening_W_tolerance*(e + P)_1
+//!
+//! The element of a group has the sum of the normals tau*d^3 sigma_mu
+//! (d^3 sigma_eta for eta) of its elements, and the averages of the
+//! other fields weighted by |d^3 sigma| (get_weight); u^tau is set from
+//! the averaged u^x, u^y, u^eta to keep u.u = 1. The groups are in the
+//! order of their first elements, so the coarse surface does not depend
+//! on the number of threads.
+class SurfaceCoarsening {
+ private:
+    const InitData &DATA;
+    const bool boost_invariant_;
+    //! the edges of the blocks in tau, x, y, eta_s
+    double block_size_[4];
+
+    bool is_similar(const CompactSurface &surface, const int i,
+                    const int i_first) const;
+
+ public:
+    SurfaceCoarsening(const InitData &DATA_in, const bool boost_invariant);
+
+    //! this function returns the coarse surface of surface
+    void coarsen(const CompactSurface &surface,
+                 CompactSurface &coarse) const;
+
+    //! the weight of the element i: the euclidean norm of
+    //! (tau*d^3 sigma_tau, tau*d^3 sigma_x, tau*d^3 sigma_y, d^3 sigma_eta)
+    static double get_weight(const CompactSurface &surface, const int i);
+
+    //! this function compares the n spectra of the coarse surface with the
+    //! ones of the full surface: the relative deviation of their sums, and
+    //! the largest one of the bins above 1e-3 of the largest bin
+    static void get_spectra_deviation(const double *full,
+                                      const double *coarse, const int n,
+                                      double &sum_deviation,
+                                      double &max_deviation);
+};
+
+#endif  // SRC_SURFACE_COARSENING_H_
@@ -0,0 +1,117 @@
+#include "surface_coarsening.h"
+#include "doctest.h"
+#include <cmath>
+#include <vector>
+
+namespace {
+
+InitData make_test_data() {
+    InitData DATA;
+    DATA.surface_coarsening_factor        = 2;
+    DATA.surface_coarsening_u_tolerance   = 0.02;
+    DATA.surface_coarsening_T_tolerance   = 0.005;
+    DATA.surface_coarsening_muB_tolerance = 0.01;
+    DATA.surface_coarsening_W_tolerance   = 0.02;
+    DATA.facTau    = 1;
+    DATA.fac_x     = 1;
+    DATA.fac_y     = 1;
+    DATA.fac_eta   = 1;
+    DATA.delta_tau = 0.1;
+    DATA.delta_x   = 0.5;
+    DATA.delta_y   = 0.5;
+    DATA.delta_eta = 0.2;
+    return(DATA);
+}
+
+//! a binary surface row (see freezeout_surface.h) at x with the normal
+//! d^3 sigma_tau = s_tau and the temperature T
+std::vector<float> make_row(const double x, const double s_tau,
+                            const double T) {
+    std::vector<float> row(34, 0.f);
+    row[0] = 1.0;           // tau
+    row[1] = x;
+    row[2] = 0.1;           // y
+    row[3] = 0.05;          // eta_s
+    row[4] = s_tau;
+    row[5] = 0.1*s_tau;
+    row[7] = 0.2*s_tau;     // d^3 sigma_eta
+    row[8] = std::sqrt(1. + 0.3*0.3);
+    row[9] = 0.3;           // u^x
+    row[13] = T;
+    row[14] = 0.1;          // mu_B
+    row[17] = 4.*T*T*T;     // (e + P)/T
+    row[22] = 1e-3;         // W^{xx}
+    return(row);
+}
+
+}
+
+TEST_CASE("the similar elements of a block are merged") {
+    const InitData DATA = make_test_data();
+    // the first two are merged, the third one is too hot, the fourth one
+    // is in the next block in x
+    const std::vector<std::vector<float>> rows = {
+        make_row(0.1, 1.0, 0.750), make_row(0.6, 3.0, 0.752),
+        make_row(0.3, 1.0, 0.770), make_row(1.2, 1.0, 0.750)};
+    CompactSurface surface;
+    surface.resize(static_cast<int>(rows.size()));
+    for (unsigned int i = 0; i < rows.size(); i++) {
+        surface.set_element(i, rows[i].data(), false);
+    }
+    CompactSurface coarse;
+    SurfaceCoarsening(DATA, false).coarsen(surface, coarse);
+    REQUIRE(coarse.size() == 3);
+
+    // the normals are summed, the fields weighted by |d^3 sigma|
+    const double w0 = SurfaceCoarsening::get_weight(surface, 0);
+    const double w1 = SurfaceCoarsening::get_weight(surface, 1);
+    CHECK(w1 == doctest::Approx(3.*w0));
+    CHECK(coarse.get(SurfaceField::s, 0) == doctest::Approx(4.0));
+    CHECK(coarse.get(SurfaceField::s + 1, 0) == doctest::Approx(0.4));
+    CHECK(coarse.get(SurfaceField::s + 3, 0) == doctest::Approx(0.8));
+    CHECK(coarse.get(SurfaceField::x, 0)
+          == doctest::Approx((0.1*w0 + 0.6*w1)/(w0 + w1)));
+    CHECK(coarse.get(SurfaceField::T_f, 0)
+          == doctest::Approx((0.750*w0 + 0.752*w1)/(w0 + w1)));
+    CHECK(coarse.get(SurfaceField::sinh_eta_s, 0)
+          == doctest::Approx(std::sinh(0.05)));
+    double u_u = coarse.get(SurfaceField::u, 0)*coarse.get(SurfaceField::u, 0);
+    for (int ii = 1; ii < 4; ii++) {
+        u_u -= (coarse.get(SurfaceField::u + ii, 0)
+                *coarse.get(SurfaceField::u + ii, 0));
+    }
+    CHECK(u_u == doctest::Approx(1.));
+
+    // the other elements are kept in order
+    CHECK(coarse.get(SurfaceField::T_f, 1) == doctest::Approx(0.770));
+    CHECK(coarse.get(SurfaceField::x, 2) == doctest::Approx(1.2));
+    CHECK(coarse.get(SurfaceField::s, 2) == doctest::Approx(1.0));
+}
+
+TEST_CASE("the boost-invariant surface is coarsened in tau, x, y") {
+    const InitData DATA = make_test_data();
+    std::vector<float> row_a = make_row(0.1, 1.0, 0.75);
+    std::vector<float> row_b = make_row(0.2, 1.0, 0.75);
+    row_b[3] = 3.0;
+    CompactSurface surface;
+    surface.resize(2);
+    surface.set_element(0, row_a.data(), true);
+    surface.set_element(1, row_b.data(), true);
+    CompactSurface coarse;
+    SurfaceCoarsening(DATA, true).coarsen(surface, coarse);
+    REQUIRE(coarse.size() == 1);
+    CHECK(coarse.get(SurfaceField::eta_s, 0) == 0.);
+    CHECK(coarse.get(SurfaceField::cosh_eta_s, 0) == 1.);
+    CHECK(coarse.get(SurfaceField::s, 0) == doctest::Approx(2.0));
+}
+
+TEST_CASE("the deviation of the spectra of the coarse surface") {
+    const std::vector<double> full = {1., 2., 4., 1e-5};
+    const std::vector<double> coarse = {1.1, 2., 3.9, 2e-5};
+    double sum_deviation = 0., max_deviation = 0.;
+    SurfaceCoarsening::get_spectra_deviation(
+        full.data(), coarse.data(), 4, sum_deviation, max_deviation);
+    CHECK(sum_deviation == doctest::Approx(1e-5/(7. + 1e-5)));
+    // the bin below 1e-3 of the largest one is left out
+    CHECK(max_deviation == doctest::Approx(0.1));
+}
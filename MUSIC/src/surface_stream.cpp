@@ -0,0 +1,65 @@
+#ifdef _OPENMP
+    #include <omp.h>
+#endif
+
+#include <utility>
+#include "surface_stream.h"
+
+SurfaceStream::SurfaceStream(const int n_threads, const int n_fields,
+                             std::function<void()> setup,
+                             Subscriber subscriber) :
+    n_threads_(n_threads), n_fields_(n_fields), setup_(std::move(setup)),
+    subscriber_(std::move(subscriber)), n_published_(0), stop_(false) {
+    stream_ = std::thread(&SurfaceStream::run_stream, this);
+}
+
+
+SurfaceStream::~SurfaceStream() {
+    close();
+}
+
+
+void SurfaceStream::publish(std::vector<float> rows) {
+    if (rows.empty()) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        n_published_ += static_cast<int64_t>(rows.size())/n_fields_;
+        queue_.push_back(std::move(rows));
+    }
+    chunk_published_.notify_one();
+}
+
+
+int64_t SurfaceStream::close() {
+    if (stream_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        chunk_published_.notify_one();
+        stream_.join();
+    }
+    return(n_published_);
+}
+
+
+void SurfaceStream::run_stream() {
+#ifdef _OPENMP
+    // the number of threads of the regions of this thread
+    omp_set_num_threads(n_threads_);
+#endif
+    if (setup_) setup_();
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        chunk_published_.wait(lock, [this] {
+            return(stop_ || !queue_.empty());
+        });
+        if (queue_.empty()) break;  // stop_ with every chunk handed over
+        std::vector<float> rows = std::move(queue_.front());
+        queue_.pop_front();
+        lock.unlock();
+        subscriber_(rows.data(), static_cast<int64_t>(rows.size())/n_fields_,
+                    n_fields_);
+        lock.lock();
+    }
+}
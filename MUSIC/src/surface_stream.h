@@ -0,0 +1,60 @@
+#ifndef SRC_SURFACE_STREAM_H_
+#define SRC_SURFACE_STREAM_H_
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//! This class hands the freeze-out surface to a subscriber while the
+//! hydro evolution goes on. The freeze-out publishes the elements of a
+//! step as a chunk of float rows (see freezeout_surface.h), which the
+//! subscriber gets in the order they are published on the stream thread.
+//! The OpenMP regions of the stream thread have n_threads threads, so
+//! e.g. Cooper-Frye can run on the cores the evolution leaves free.
+class SurfaceStream {
+ public:
+    //! the elements of a chunk, n_fields floats each
+    typedef std::function<void(const float *rows, const int64_t n_elements,
+                               const int n_fields)> Subscriber;
+
+ private:
+    const int n_threads_;
+    const int n_fields_;
+    const std::function<void()> setup_;
+    const Subscriber subscriber_;
+    std::deque<std::vector<float>> queue_;
+    int64_t n_published_;
+    bool stop_;
+
+    std::mutex mutex_;
+    std::condition_variable chunk_published_;
+    std::thread stream_;
+
+    void run_stream();
+
+ public:
+    //! setup runs first on the stream thread, e.g. to read the tables of
+    //! the subscriber while the hydro starts
+    SurfaceStream(const int n_threads, const int n_fields,
+                  std::function<void()> setup, Subscriber subscriber);
+    //! hands the published chunks to the subscriber and stops the thread
+    ~SurfaceStream();
+
+    SurfaceStream(const SurfaceStream&) = delete;
+    SurfaceStream& operator=(const SurfaceStream&) = delete;
+
+    int get_number_of_fields() const {return(n_fields_);}
+
+    //! hands the rows of the elements to the subscriber (thread-safe)
+    void publish(std::vector<float> rows);
+
+    //! waits until the subscriber has all the published chunks, and stops
+    //! the stream thread. Returns the number of published elements.
+    int64_t close();
+};
+
+#endif  // SRC_SURFACE_STREAM_H_
@@ -0,0 +1,45 @@
+#ifdef _OPENMP
+    #include <omp.h>
+#endif
+
+#include <vector>
+#include "surface_stream.h"
+#include "doctest.h"
+
+TEST_CASE("Check SurfaceStream hands the chunks over in order") {
+    const int n_fields = 3;
+    bool set_up = false;
+    bool set_up_first = true;
+    int n_threads = 0;
+    std::vector<float> received;
+    std::vector<int64_t> chunk_sizes;
+    SurfaceStream::Subscriber subscriber = [&](const float *rows,
+                                               const int64_t n_elements,
+                                               const int n_fields_in) {
+        set_up_first = set_up_first && set_up;
+        CHECK(n_fields_in == n_fields);
+        chunk_sizes.push_back(n_elements);
+        received.insert(received.end(), rows, rows + n_elements*n_fields);
+#ifdef _OPENMP
+        n_threads = omp_get_max_threads();
+#else
+        n_threads = 2;
+#endif
+    };
+    SurfaceStream stream(2, n_fields, [&]() {set_up = true;}, subscriber);
+    CHECK(stream.get_number_of_fields() == n_fields);
+    std::vector<float> expected;
+    for (int ichunk = 0; ichunk < 20; ichunk++) {
+        std::vector<float> rows(n_fields*(ichunk % 3), 1.f*ichunk);
+        expected.insert(expected.end(), rows.begin(), rows.end());
+        stream.publish(rows);
+    }
+    CHECK(stream.close() == static_cast<int64_t>(expected.size())/n_fields);
+    CHECK(set_up);
+    CHECK(set_up_first);
+    CHECK(n_threads == 2);
+    // the empty chunks are not handed over
+    CHECK(chunk_sizes.size() == 13);
+    CHECK(received == expected);
+    CHECK(stream.close() == static_cast<int64_t>(expected.size())/n_fields);
+}
@@ -0,0 +1,24 @@
+#ifndef SRC_SWEEP_GRID_H_
+#define SRC_SWEEP_GRID_H_
+
+#include "grid.h"
+#include "grid_soa.h"
+#include "stencil_tile.h"
+
+//! grid layout read by the stencil sweeps of Advance, Diss, and
+//! U_derivative in a Runge-Kutta stage, chosen at compile time:
+//!   -DMUSIC_PADDED_SWEEPS: a copy of arena_current with 2 ghost layers
+//!   -DMUSIC_SOA_SWEEPS:    a structure-of-arrays copy of arena_current
+//!   otherwise:             arena_current itself (getHalo clamps)
+#if defined(MUSIC_PADDED_SWEEPS)
+typedef PaddedSCGrid SweepGrid;
+typedef PaddedThermoGrid SweepThermoGrid;
+#elif defined(MUSIC_SOA_SWEEPS)
+typedef SCGridSoA SweepGrid;
+typedef ThermoGrid SweepThermoGrid;
+#else
+typedef SCGrid SweepGrid;
+typedef ThermoGrid SweepThermoGrid;
+#endif
+
+#endif  // SRC_SWEEP_GRID_H_
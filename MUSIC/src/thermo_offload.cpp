@@ -0,0 +1,68 @@
+#include "thermo_offload.h"
+
+namespace {
+    //! copies the array of view to the device and points view to the copy
+    void map_to_device(EOSTableView &view) {
+        if (view.is_empty()) return;
+        const double *values = view.values;
+        const int size = view.size;
+        #pragma omp target enter data map(to: values[0:size])
+        #pragma omp target data use_device_ptr(values)
+        {
+            view.values = values;
+        }
+    }
+
+    void unmap_from_device(const EOSTableView &host_view) {
+        if (host_view.is_empty()) return;
+        const double *values = host_view.values;
+        const int size = host_view.size;
+        #pragma omp target exit data map(delete: values[0:size])
+    }
+}
+
+
+ThermoOffload::ThermoOffload(const EOS &eos) :
+        host_tables_(eos.get_thermo_tables()) {
+    if (!is_active()) return;
+    device_tables_ = *host_tables_;
+    map_to_device(device_tables_.pressure);
+    map_to_device(device_tables_.temperature);
+    map_to_device(device_tables_.mu_B);
+    map_to_device(device_tables_.mu_S);
+    map_to_device(device_tables_.mu_C);
+    map_to_device(device_tables_.dpde);
+    map_to_device(device_tables_.dpdrhob);
+}
+
+
+ThermoOffload::~ThermoOffload() {
+    if (!is_active()) return;
+    unmap_from_device(host_tables_->pressure);
+    unmap_from_device(host_tables_->temperature);
+    unmap_from_device(host_tables_->mu_B);
+    unmap_from_device(host_tables_->mu_S);
+    unmap_from_device(host_tables_->mu_C);
+    unmap_from_device(host_tables_->dpde);
+    unmap_from_device(host_tables_->dpdrhob);
+}
+
+
+void ThermoOffload::get_thermo_batch(const double *e, const double *rhob,
+                                     ThermoState *out, char *in_tables,
+                                     const int n) const {
+    const EOSThermoTables tables = device_tables_;
+    #pragma omp target teams distribute parallel for \
+                map(to: e[0:n], rhob[0:n]) \
+                map(from: out[0:n], in_tables[0:n]) firstprivate(tables)
+    for (int i = 0; i < n; i++) {
+        ThermoState thermo;
+        const bool in_derivative_tables = tables.get_thermo(e[i], rhob[i],
+                                                            thermo);
+        if (in_derivative_tables) {
+            EOSThermoTables::set_cs2_and_entropy(e[i], rhob[i], thermo);
+        }
+        out[i] = thermo;
+        in_tables[i] = in_derivative_tables;
+    }
+}
@@ -0,0 +1,36 @@
+#ifndef SRC_THERMO_OFFLOAD_H_
+#define SRC_THERMO_OFFLOAD_H_
+
+#include "eos.h"
+#include "eos_table.h"
+
+//! This class computes the ThermoState of a batch of cells with an
+//! OpenMP target region. The flattened tables of the EOS are copied to
+//! the offload device once, when the class is constructed, and only the
+//! energy and baryon densities and the results are transferred per batch.
+//! Without an offload device the target region runs on the host.
+//! For an EOS without flattened tables (see EOS::get_thermo_tables) the
+//! class is inactive.
+class ThermoOffload {
+ public:
+    explicit ThermoOffload(const EOS &eos);
+    ~ThermoOffload();
+    ThermoOffload(const ThermoOffload &) = delete;
+    ThermoOffload &operator=(const ThermoOffload &) = delete;
+
+    bool is_active() const {return(host_tables_ != nullptr);}
+
+    //! out[i] = eos.get_thermo(e[i], rhob[i]) for the cells with
+    //! in_tables[i] = 1. The cells outside the derivative tables get
+    //! in_tables[i] = 0 and are left to the host.
+    void get_thermo_batch(const double *e, const double *rhob,
+                          ThermoState *out, char *in_tables,
+                          const int n) const;
+
+ private:
+    const EOSThermoTables *host_tables_ = nullptr;
+    //! the views of host_tables_ pointing to the arrays on the device
+    EOSThermoTables device_tables_;
+};
+
+#endif  // SRC_THERMO_OFFLOAD_H_
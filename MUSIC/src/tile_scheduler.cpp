@@ -0,0 +1,97 @@
+#ifdef _OPENMP
+    #include <omp.h>
+#endif
+
+#include "instrumentation.h"
+#include "tile_scheduler.h"
+
+#ifndef _OPENMP
+    #define omp_get_thread_num() 0
+    #define omp_get_num_threads() 1
+#endif
+
+namespace {
+    uint64_t pack(const uint32_t head, const uint32_t tail) {
+        return((static_cast<uint64_t>(head) << 32) | tail);
+    }
+    uint32_t get_head(const uint64_t bounds) {return(bounds >> 32);}
+    uint32_t get_tail(const uint64_t bounds) {return(bounds & 0xffffffffu);}
+}
+
+
+void TileScheduler::plan(const int n_tiles) {
+    if (static_cast<int>(cost_.size()) != n_tiles) {
+        cost_.assign(n_tiles, 1.);
+    }
+    const int n_threads = omp_get_num_threads();
+    if (n_threads != n_threads_) {
+        ranges_.reset(new TileRange[n_threads]);
+        n_threads_ = n_threads;
+    }
+
+    // the range of a thread starts at the first tile after its share
+    // k/n_threads of the predicted cost, with the tiles of zero cost
+    // spread by their count (and half of that as the round-off margin)
+    double total = 0.;
+    for (const double cost : cost_) total += cost;
+    const double epsilon = (total > 0. ? 1e-6*total/n_tiles : 1.);
+    total += epsilon*n_tiles;
+    range_begin_.assign(n_threads + 1, n_tiles);
+    range_begin_[0] = 0;
+    double prefix = 0.;
+    int thread = 1;
+    for (int itile = 0; itile < n_tiles && thread < n_threads; itile++) {
+        while (   thread < n_threads
+               && prefix + 0.5*epsilon >= thread*total/n_threads) {
+            range_begin_[thread++] = itile;
+        }
+        prefix += cost_[itile] + epsilon;
+    }
+    for (int k = 0; k < n_threads; k++) {
+        ranges_[k].bounds.store(pack(range_begin_[k], range_begin_[k + 1]),
+                                std::memory_order_relaxed);
+    }
+}
+
+
+int TileScheduler::take_first(const int thread) {
+    std::atomic<uint64_t> &bounds = ranges_[thread].bounds;
+    uint64_t current = bounds.load(std::memory_order_relaxed);
+    while (get_head(current) < get_tail(current)) {
+        const uint64_t next = pack(get_head(current) + 1, get_tail(current));
+        if (bounds.compare_exchange_weak(current, next,
+                                         std::memory_order_relaxed)) {
+            return(get_head(current));
+        }
+    }
+    return(-1);
+}
+
+
+int TileScheduler::take_last(const int thread) {
+    std::atomic<uint64_t> &bounds = ranges_[thread].bounds;
+    uint64_t current = bounds.load(std::memory_order_relaxed);
+    while (get_head(current) < get_tail(current)) {
+        const uint64_t next = pack(get_head(current), get_tail(current) - 1);
+        if (bounds.compare_exchange_weak(current, next,
+                                         std::memory_order_relaxed)) {
+            return(get_tail(current) - 1);
+        }
+    }
+    return(-1);
+}
+
+
+int TileScheduler::get_thread() const {
+    return(omp_get_thread_num());
+}
+
+
+void TileScheduler::finish_run(
+        const double busy_seconds,
+        const std::chrono::steady_clock::time_point done) const {
+    #pragma omp barrier
+    const std::chrono::duration<double> idle = (
+                        std::chrono::steady_clock::now() - done);
+    Instrumentation::add_thread_time(busy_seconds, idle.count());
+}
@@ -0,0 +1,99 @@
+#ifndef SRC_TILE_SCHEDULER_H_
+#define SRC_TILE_SCHEDULER_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+//! This class runs the tiles of a grid sweep on the threads of a parallel
+//! region with work stealing. The cost of the cells varies a lot: the
+//! vacuum is cheap, while the cells in the fallbacks of the reconstruction
+//! or in the root finding of the causality constraints cost 10-50 times
+//! more. The tiles are dealt out to the threads in contiguous ranges of
+//! equal predicted cost, the time each tile took in the last sweep, so
+//! every thread sweeps a compact block of the grid. A thread which has
+//! finished its range takes the tiles from the ends of the ranges of the
+//! others. The thread times are added to the instrumentation as busy (in
+//! the tiles) and idle (waiting for the other threads at the end).
+//!
+//!     #pragma omp single
+//!     scheduler.plan(tiling.get_number_of_tiles());
+//!     scheduler.run([&](const int itile) {...});
+class TileScheduler {
+ private:
+    //! the tiles [head, tail) of a range which no thread has started, in
+    //! one word so that the owner and the thieves take a tile with one
+    //! compare-and-swap
+    struct alignas(64) TileRange {
+        std::atomic<uint64_t> bounds;
+    };
+
+    //! the seconds of the tiles in the last sweep
+    std::vector<double> cost_;
+    std::vector<int> range_begin_;
+    std::unique_ptr<TileRange[]> ranges_;
+    int n_threads_ = 0;
+
+    //! the first and the last tile not started in the range of thread,
+    //! -1 if it is empty
+    int take_first(const int thread);
+    int take_last(const int thread);
+
+    int get_thread() const;
+
+    //! waits for the other threads and books the busy and idle time
+    void finish_run(const double busy_seconds,
+                    const std::chrono::steady_clock::time_point done) const;
+
+ public:
+    //! deals out n_tiles to the threads of the parallel region. The
+    //! predicted costs are reset to equal costs if the number of tiles
+    //! has changed. Called by one thread before run.
+    void plan(const int n_tiles);
+
+    //! calls run_tile(itile) for every tile, on all the threads of the
+    //! parallel region, and ends with a barrier
+    template<class Func>
+    void run(Func &&run_tile);
+
+    int get_number_of_tiles() const {return(static_cast<int>(cost_.size()));}
+    double get_cost(const int itile) const {return(cost_[itile]);}
+
+    //! the tiles [get_range_begin(thread), get_range_begin(thread + 1))
+    //! dealt to thread by the last plan
+    int get_range_begin(const int thread) const {
+        return(range_begin_[thread]);
+    }
+};
+
+
+template<class Func>
+void TileScheduler::run(Func &&run_tile) {
+    const int thread = get_thread();
+    double busy_seconds = 0.;
+    auto run_timed = [&](const int itile) {
+        const auto start = std::chrono::steady_clock::now();
+        run_tile(itile);
+        const std::chrono::duration<double> elapsed = (
+                    std::chrono::steady_clock::now() - start);
+        cost_[itile] = elapsed.count();
+        busy_seconds += elapsed.count();
+    };
+    for (int itile = take_first(thread); itile >= 0;
+            itile = take_first(thread)) {
+        run_timed(itile);
+    }
+    // the ranges only shrink, so one pass over the other threads is enough
+    for (int k = 1; k < n_threads_; k++) {
+        const int victim = (thread + k)%n_threads_;
+        for (int itile = take_last(victim); itile >= 0;
+                itile = take_last(victim)) {
+            run_timed(itile);
+        }
+    }
+    finish_run(busy_seconds, std::chrono::steady_clock::now());
+}
+
+#endif  // SRC_TILE_SCHEDULER_H_
@@ -0,0 +1,91 @@
+#ifdef _OPENMP
+    #include <omp.h>
+#endif
+
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "doctest.h"
+#include "instrumentation.h"
+#include "tile_scheduler.h"
+
+#ifdef _OPENMP
+
+TEST_CASE("Check TileScheduler runs every tile once and deals by cost") {
+    const int max_threads = omp_get_max_threads();
+    const int n_threads = 4;
+    omp_set_num_threads(n_threads);
+    InitData DATA;
+    DATA.instrumentation = 1;
+    DATA.instrumentation_filename = "tile_scheduler_unittest.jsonl";
+    DATA.restart_from_checkpoint = 0;
+    Instrumentation::initialize(DATA);
+
+    const int n_tiles = 16;
+    TileScheduler scheduler;
+    std::vector<int> n_runs(n_tiles, 0);
+    // the first tile is much more expensive than the others
+    auto run_tile = [&](const int itile) {
+        #pragma omp atomic
+        n_runs[itile]++;
+        if (itile == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+    };
+    #pragma omp parallel num_threads(n_threads)
+    {
+        #pragma omp single
+        scheduler.plan(n_tiles);
+        scheduler.run(run_tile);
+    }
+    for (int itile = 0; itile < n_tiles; itile++) {
+        CHECK(n_runs[itile] == 1);
+    }
+    // the equal costs of the first plan give equal ranges
+    for (int k = 0; k <= n_threads; k++) {
+        CHECK(scheduler.get_range_begin(k) == 4*k);
+    }
+    for (int itile = 1; itile < n_tiles; itile++) {
+        CHECK(scheduler.get_cost(itile) < scheduler.get_cost(0));
+    }
+
+    #pragma omp parallel num_threads(n_threads)
+    {
+        #pragma omp single
+        scheduler.plan(n_tiles);
+        scheduler.run(run_tile);
+    }
+    // the expensive tile is the whole range of the first thread, the
+    // cheap ones go to the last
+    CHECK(scheduler.get_range_begin(1) == 1);
+    CHECK(scheduler.get_range_begin(n_threads - 1) == 1);
+    CHECK(scheduler.get_range_begin(n_threads) == n_tiles);
+    for (int itile = 0; itile < n_tiles; itile++) {
+        CHECK(n_runs[itile] == 2);
+    }
+
+    double busy = 0., idle = 0.;
+    for (int k = 0; k < n_threads; k++) {
+        busy += Instrumentation::get_thread_busy_seconds(k);
+        idle += Instrumentation::get_thread_idle_seconds(k);
+        CHECK(Instrumentation::get_thread_idle_seconds(k) >= 0.);
+    }
+    CHECK(busy >= 0.04);
+    CHECK(busy + idle < 1.);
+    CHECK(idle >= 0.);
+
+    // a new number of tiles resets the costs
+    #pragma omp parallel num_threads(n_threads)
+    {
+        #pragma omp single
+        scheduler.plan(8);
+    }
+    CHECK(scheduler.get_number_of_tiles() == 8);
+    CHECK(scheduler.get_range_begin(1) == 2);
+
+    DATA.instrumentation = 0;
+    Instrumentation::initialize(DATA);
+    omp_set_num_threads(max_threads);
+}
+
+#endif
@@ -1,7 +1,9 @@
 // Copyright 2011 @ Bjoern Schenke, Sangyong Jeon, and Charles Gale
 
+#include <algorithm>
 #include <cmath>
 #include "util.h"
+#include "pretty_ostream.h"
 #include "transport_coeffs.h"
 
 using Util::hbarc;
@@ -10,12 +12,102 @@ TransportCoeffs::TransportCoeffs(const EOS &eosIn, const InitData &Data_in)
     : DATA(Data_in), eos(eosIn) {
     shear_relax_time_factor_ = DATA.shear_relax_time_factor;
     bulk_relax_time_factor_  = DATA.bulk_relax_time_factor;
+    build_tables();
+}
+
+
+//! This function tabulates the selected T- and muB-dependent
+//! parameterizations up to 1 GeV in steps of 0.1 MeV.
+void TransportCoeffs::build_tables() {
+    if (DATA.transport_coeffs_table != 1) return;
+
+    const double T_max   = 1.0/hbarc;    // 1/fm
+    const double muB_max = 1.0/hbarc;    // 1/fm
+    const int shear_type = DATA.T_dependent_shear_to_s;
+    if (   DATA.turn_on_shear == 1
+        && (   shear_type == 1 || shear_type == 2 || shear_type == 3
+            || shear_type == 11)) {
+        build_table(eta_over_s_table_, T_max,
+                    [this](double T) {return(evaluate_eta_over_s(T));},
+                    "eta/s(T)");
+    }
+    if (DATA.turn_on_shear == 1 && DATA.muB_dependent_shear_to_s == 10) {
+        build_table(shear_muB_factor_table_, muB_max,
+                    [this](double muB) {
+                        return(get_muB_dependence_shear_profile(muB));},
+                    "eta/s(muB)");
+    }
+    const int bulk_type = DATA.T_dependent_bulk_to_s;
+    if (   DATA.turn_on_bulk == 1
+        && (   (bulk_type >= 1 && bulk_type <= 3)
+            || (bulk_type >= 7 && bulk_type <= 9))) {
+        build_table(zeta_over_s_table_, T_max,
+                    [this](double T) {return(evaluate_zeta_over_s(T));},
+                    "zeta/s(T)");
+    }
+}
+
+
+//! This function fills table with f up to x_max and checks the
+//! interpolation at the middle of every interval against f. The
+//! intervals where it deviates by more than 1e-4 of the maximum of f
+//! are evaluated directly.
+void TransportCoeffs::build_table(CoeffTable &table, const double x_max,
+                                  const std::function<double(double)> &f,
+                                  const std::string &name) const {
+    const double dx = x_max/table_intervals_;
+    table.inv_dx = 1./dx;
+    table.values.resize(table_intervals_ + 1);
+    table.evaluate_directly.assign(table_intervals_, 0);
+    double f_max = 0.;
+    for (int i = 0; i <= table_intervals_; i++) {
+        table.values[i] = f(i*dx);
+        f_max = std::max(f_max, std::abs(table.values[i]));
+    }
+
+    int n_direct = 0;
+    double max_deviation = 0.;
+    for (int i = 0; i < table_intervals_; i++) {
+        const double x_mid = (i + 0.5)*dx;
+        const double deviation = std::abs(
+                0.5*(table.values[i] + table.values[i + 1]) - f(x_mid));
+        if (deviation > 1e-4*f_max) {
+            table.evaluate_directly[i] = 1;
+            n_direct++;
+        } else {
+            max_deviation = std::max(max_deviation, deviation);
+        }
+    }
+
+    pretty_ostream music_message;
+    music_message << "Tabulated " << name << ", max deviation "
+                  << max_deviation << ", " << n_direct
+                  << " intervals evaluated directly";
+    music_message.flush("info");
 }
 
 
 double TransportCoeffs::get_eta_over_s(const double T, const double muB) const {
     // inputs T [1/fm], muB [1/fm]
     // outputs \eta/s
+    double eta_over_s = 0.;
+    if (!interpolate_table(eta_over_s_table_, T, eta_over_s)) {
+        eta_over_s = evaluate_eta_over_s(T);
+    }
+    if (DATA.muB_dependent_shear_to_s == 10) {
+        double f_muB = 1.;
+        if (!interpolate_table(shear_muB_factor_table_, muB, f_muB)) {
+            f_muB = get_muB_dependence_shear_profile(muB);
+        }
+        eta_over_s *= f_muB;
+    }
+    return eta_over_s;
+}
+
+
+//! This function evaluates the selected eta/s(T), without the muB
+//! dependence
+double TransportCoeffs::evaluate_eta_over_s(const double T) const {
     double eta_over_s = DATA.shear_to_s;
     if (DATA.T_dependent_shear_to_s == 1) {
         eta_over_s = get_temperature_dependent_eta_over_s_default(T);
@@ -28,9 +120,6 @@ double TransportCoeffs::get_eta_over_s(const double T, const double muB) const {
     } else {
         eta_over_s = DATA.shear_to_s;
     }
-    if (DATA.muB_dependent_shear_to_s == 10) {
-        eta_over_s *= get_muB_dependence_shear_profile(muB);
-    }
     return eta_over_s;
 }
 
@@ -117,6 +206,16 @@ double TransportCoeffs::get_temperature_dependent_eta_over_s_sims(
 
 double TransportCoeffs::get_zeta_over_s(const double T) const {
     // input T [1/fm]
+    double zeta_over_s = 0.;
+    if (!interpolate_table(zeta_over_s_table_, T, zeta_over_s)) {
+        zeta_over_s = evaluate_zeta_over_s(T);
+    }
+    return(zeta_over_s);
+}
+
+
+//! This function evaluates the selected zeta/s(T)
+double TransportCoeffs::evaluate_zeta_over_s(const double T) const {
     double zeta_over_s = 0.;
     if (DATA.T_dependent_bulk_to_s == 2) {
         zeta_over_s = get_temperature_dependent_zeta_over_s_duke(T);
@@ -2,6 +2,9 @@
 #ifndef SRC_TRANSPORT_H_
 #define SRC_TRANSPORT_H_
 
+#include <functional>
+#include <string>
+#include <vector>
 #include "data.h"
 #include "eos.h"
 
@@ -12,6 +15,45 @@ class TransportCoeffs {
     double shear_relax_time_factor_;
     double bulk_relax_time_factor_;
 
+    //! a parameterization on table_intervals_ equal intervals from 0.
+    //! The intervals where the interpolation misses the parameterization,
+    //! e.g. at a jump, are flagged to be evaluated directly.
+    struct CoeffTable {
+        std::vector<double> values;
+        std::vector<unsigned char> evaluate_directly;
+        double inv_dx = 0.;
+    };
+    static constexpr int table_intervals_ = 10000;
+
+    //! eta/s(T) without the muB factor, the muB factor of eta/s, and
+    //! zeta/s(T). An empty table means the parameterization is
+    //! evaluated directly.
+    CoeffTable eta_over_s_table_;
+    CoeffTable shear_muB_factor_table_;
+    CoeffTable zeta_over_s_table_;
+
+    void build_tables();
+    void build_table(CoeffTable &table, const double x_max,
+                     const std::function<double(double)> &f,
+                     const std::string &name) const;
+
+    //! interpolates table at x, returns false if x is outside the table
+    //! or in a flagged interval
+    bool interpolate_table(const CoeffTable &table, const double x,
+                           double &result) const {
+        if (table.values.empty()) return(false);
+        const double x_over_dx = x*table.inv_dx;
+        if (!(x_over_dx >= 0. && x_over_dx < table_intervals_)) return(false);
+        const int idx = static_cast<int>(x_over_dx);
+        if (table.evaluate_directly[idx]) return(false);
+        const double frac = x_over_dx - idx;
+        result = table.values[idx]*(1. - frac) + table.values[idx + 1]*frac;
+        return(true);
+    }
+
+    double evaluate_eta_over_s(const double T) const;
+    double evaluate_zeta_over_s(const double T) const;
+
  public:
     TransportCoeffs(const EOS &eosIn, const InitData &DATA_in);
 
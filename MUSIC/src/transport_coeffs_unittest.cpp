@@ -0,0 +1,67 @@
+#include "transport_coeffs.h"
+#include "doctest.h"
+#include "eos.h"
+#include "util.h"
+
+namespace {
+
+InitData make_test_data(const int use_table) {
+    InitData DATA;
+    DATA.shear_relax_time_factor     = 5.;
+    DATA.bulk_relax_time_factor      = 1./14.55;
+    DATA.turn_on_shear               = 1;
+    DATA.turn_on_bulk                = 1;
+    DATA.shear_to_s                  = 0.08;
+    DATA.T_dependent_shear_to_s      = 3;
+    DATA.muB_dependent_shear_to_s    = 10;
+    DATA.shear_3_T_kink_in_GeV       = 0.223;
+    DATA.shear_3_low_T_slope_in_GeV  = -0.776;
+    DATA.shear_3_high_T_slope_in_GeV = 0.37;
+    DATA.shear_3_at_kink             = 0.096;
+    DATA.T_dependent_bulk_to_s       = 8;
+    DATA.transport_coeffs_table      = use_table;
+    return(DATA);
+}
+
+}
+
+TEST_CASE("tabulated transport coefficients against the parameterizations") {
+    EOS eos_ideal(0);
+    const InitData DATA_table  = make_test_data(1);
+    const InitData DATA_direct = make_test_data(0);
+    TransportCoeffs coeffs_table(eos_ideal, DATA_table);
+    TransportCoeffs coeffs_direct(eos_ideal, DATA_direct);
+
+    for (double T_in_GeV = 0.0013; T_in_GeV < 0.6; T_in_GeV += 0.0037)
+    for (double muB_in_GeV : {0.0, 0.013, 0.2, 0.45}) {
+        const double T   = T_in_GeV/Util::hbarc;
+        const double muB = muB_in_GeV/Util::hbarc;
+        CHECK(coeffs_table.get_eta_over_s(T, muB)
+              == doctest::Approx(coeffs_direct.get_eta_over_s(T, muB))
+                 .epsilon(1e-4));
+        CHECK(coeffs_table.get_zeta_over_s(T)
+              == doctest::Approx(coeffs_direct.get_zeta_over_s(T))
+                 .epsilon(1e-4));
+    }
+
+    // the default zeta/s(T) has jumps, which are evaluated directly
+    InitData DATA_jump_table  = make_test_data(1);
+    InitData DATA_jump_direct = make_test_data(0);
+    DATA_jump_table.T_dependent_bulk_to_s  = 1;
+    DATA_jump_direct.T_dependent_bulk_to_s = 1;
+    TransportCoeffs coeffs_jump_table(eos_ideal, DATA_jump_table);
+    TransportCoeffs coeffs_jump_direct(eos_ideal, DATA_jump_direct);
+    for (double T_in_GeV = 0.17; T_in_GeV < 0.2; T_in_GeV += 0.00001) {
+        const double T = T_in_GeV/Util::hbarc;
+        CHECK(coeffs_jump_table.get_zeta_over_s(T)
+              == doctest::Approx(coeffs_jump_direct.get_zeta_over_s(T))
+                 .epsilon(1e-3));
+    }
+
+    // outside the tables the parameterizations are evaluated
+    const double T_high = 1.5/Util::hbarc;
+    CHECK(coeffs_table.get_eta_over_s(T_high, 0.)
+          == coeffs_direct.get_eta_over_s(T_high, 0.));
+    CHECK(coeffs_table.get_zeta_over_s(T_high)
+          == coeffs_direct.get_zeta_over_s(T_high));
+}
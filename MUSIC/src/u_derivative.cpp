@@ -9,15 +9,17 @@
 U_derivative::U_derivative(const InitData &DATA_in, const EOS &eosIn) :
     DATA(DATA_in),
     eos(eosIn),
-    minmod(DATA_in) {
+    minmod(DATA_in),
+    eta_grid_(DATA_in) {
     dUsup = {0.0};        // dUsup[m][n] = partial^n u^m
     dUoverTsup = {0.0};   // dUoverTsup[m][n] = partial^n (u^m/T)
     dUTsup = {0.0};       // dUTsup[m][n] = partial^n (Tu^m)
 }
 
 //! This function is a shell function to calculate parital^\nu u^\mu
+template<class Grid>
 void U_derivative::MakedU(const double tau, SCGrid &arena_prev,
-                          SCGrid &arena_current,
+                          Grid &arena_current,
                           const int ix, const int iy, const int ieta) {
     dUsup = {0.0};
     dUoverTsup = {0.0};
@@ -26,20 +28,27 @@ void U_derivative::MakedU(const double tau, SCGrid &arena_prev,
     // this calculates du/dx, du/dy, (du/deta)/tau
     MakeDSpatial(tau, arena_current, ix, iy, ieta);
     // this calculates du/dtau
-    MakeDTau(tau, &arena_prev(ix, iy, ieta), &arena_current(ix, iy, ieta));
+    const Cell_small &grid_c = arena_current(ix, iy, ieta);
+    MakeDTau(tau, &arena_prev(ix, iy, ieta), &grid_c);
 }
 
 
 //! this function returns the expansion rate on the grid
 double U_derivative::calculate_expansion_rate(
         double tau, SCGrid &arena, int ieta, int ix, int iy) {
+    return(get_expansion_rate(tau, arena(ix, iy, ieta).u, dUsup));
+}
+
+
+double U_derivative::get_expansion_rate(const double tau, const FlowVec &u,
+                                        const dUsupMat &dU) const {
     double partial_mu_u_supmu = 0.0;
     for (int mu = 0; mu < 4; mu++) {
         double gfac = (mu == 0 ? -1.0 : 1.0);
         // for expansion rate: theta
-        partial_mu_u_supmu += dUsup[mu][mu]*gfac;
+        partial_mu_u_supmu += dU[mu][mu]*gfac;
     }
-    double theta = partial_mu_u_supmu + arena(ix,iy,ieta).u[0]/tau;
+    double theta = partial_mu_u_supmu + u[0]/tau;
     return(theta);
 }
 
@@ -48,12 +57,17 @@ double U_derivative::calculate_expansion_rate(
 void U_derivative::calculate_Du_supmu(const double tau, SCGrid &arena,
                                       const int ieta, const int ix,
                                       const int iy, DumuVec &a) {
+    get_Du_supmu(arena(ix, iy, ieta).u, dUsup, a);
+}
+
+
+void U_derivative::get_Du_supmu(const FlowVec &u, const dUsupMat &dU,
+                                DumuVec &a) const {
     for (int mu = 0; mu <= 4; mu++) {
         double u_supnu_partial_nu_u_supmu = 0.0;
         for (int nu = 0; nu < 4; nu++) {
             double tfac = (nu==0 ? -1.0 : 1.0);
-            u_supnu_partial_nu_u_supmu += (
-                tfac*arena(ix,iy,ieta).u[nu]*dUsup[mu][nu]);
+            u_supnu_partial_nu_u_supmu += tfac*u[nu]*dU[mu][nu];
         }
         a[mu] = u_supnu_partial_nu_u_supmu;
     }
@@ -66,21 +80,43 @@ void U_derivative::compute_vorticity_shell(
         const int ieta, const int ix, const int iy, const double eta,
         VorticityVec &omega_local_kSP, VorticityVec &omega_local_knoSP,
         VorticityVec &omega_local_th, VorticityVec &omega_local_T) {
+    Cell_aux omega_Mline;
+    compute_vorticity_Milne(tau, arena_prev, arena_curr, ieta, ix, iy,
+                            omega_Mline);
+    omega_local_kSP = transform_vorticity_to_tz(omega_Mline.omega_kSP, eta);
+    omega_local_knoSP = transform_vorticity_to_tz(omega_Mline.omega_k, eta);
+    omega_local_th = transform_vorticity_to_tz(omega_Mline.omega_th, eta);
+    omega_local_T = transform_vorticity_to_tz(omega_Mline.omega_T, eta);
+}
+
+
+void U_derivative::compute_vorticity_Milne(
+        const double tau, SCGrid &arena_prev, SCGrid &arena_curr,
+        const int ieta, const int ix, const int iy, Cell_aux &omega_Mline) {
     MakedU(tau, arena_prev, arena_curr, ix, iy, ieta);
     DumuVec a_local;
     calculate_Du_supmu(tau, arena_curr, ieta, ix, iy, a_local);
 
-    VorticityVec omega_local;
     calculate_kinetic_vorticity_with_spatial_projector(
-            tau, arena_curr, ieta, ix, iy, a_local, omega_local);
-    omega_local_kSP = transform_vorticity_to_tz(omega_local, eta);
+            tau, arena_curr, ieta, ix, iy, a_local, omega_Mline.omega_kSP);
     calculate_kinetic_vorticity_no_spatial_projection(
-            tau, arena_curr, ieta, ix, iy, omega_local);
-    omega_local_knoSP = transform_vorticity_to_tz(omega_local, eta);
-    calculate_thermal_vorticity(tau, arena_curr, ieta, ix, iy, omega_local);
-    omega_local_th = transform_vorticity_to_tz(omega_local, eta);
-    calculate_T_vorticity(tau, arena_curr, ieta, ix, iy, omega_local);
-    omega_local_T = transform_vorticity_to_tz(omega_local, eta);
+            tau, arena_curr, ieta, ix, iy, omega_Mline.omega_k);
+    calculate_thermal_vorticity(tau, arena_curr, ieta, ix, iy,
+                                omega_Mline.omega_th);
+    calculate_T_vorticity(tau, arena_curr, ieta, ix, iy,
+                          omega_Mline.omega_T);
+}
+
+
+Cell_aux U_derivative::transform_vorticity_to_tz(const Cell_aux &omega_Mline,
+                                                 const double eta) {
+    Cell_aux omega_Cart;
+    omega_Cart.omega_kSP = transform_vorticity_to_tz(omega_Mline.omega_kSP,
+                                                     eta);
+    omega_Cart.omega_k = transform_vorticity_to_tz(omega_Mline.omega_k, eta);
+    omega_Cart.omega_th = transform_vorticity_to_tz(omega_Mline.omega_th, eta);
+    omega_Cart.omega_T = transform_vorticity_to_tz(omega_Mline.omega_T, eta);
+    return(omega_Cart);
 }
 
 
@@ -112,11 +148,18 @@ void U_derivative::calculate_kinetic_vorticity_with_spatial_projector(
             const double tau, SCGrid &arena,
             const int ieta, const int ix, const int iy,
             const DumuVec &a_local, VorticityVec &omega) {
-    FlowVec u_local = arena(ix, iy, ieta).u;
+    get_kinetic_vorticity_with_spatial_projector(
+                        tau, arena(ix, iy, ieta).u, dUsup, a_local, omega);
+}
+
+
+void U_derivative::get_kinetic_vorticity_with_spatial_projector(
+            const double tau, const FlowVec &u_local, const dUsupMat &dU,
+            const DumuVec &a_local, VorticityVec &omega) const {
     double dUsup_local[4][4];
     for (int i = 0; i < 4; i++) {
         for (int j = 0; j < 4; j++) {
-            dUsup_local[i][j] = dUsup[i][j];
+            dUsup_local[i][j] = dU[i][j];
         }
     }
 
@@ -168,14 +211,21 @@ void U_derivative::calculate_thermal_vorticity(
             const double tau, SCGrid &arena, const int ieta,
             const int ix, const int iy, VorticityVec &omega) {
     // this function computes the thermal vorticity
-    FlowVec u_local = arena(ix, iy, ieta).u;
-    double T_local  = eos.get_temperature(arena(ix, iy, ieta).epsilon,
-                                          arena(ix, iy, ieta).rhob);
+    const double T_local = eos.get_temperature(arena(ix, iy, ieta).epsilon,
+                                               arena(ix, iy, ieta).rhob);
+    get_thermal_vorticity(tau, arena(ix, iy, ieta).u, T_local, dUoverTsup,
+                          omega);
+}
+
+
+void U_derivative::get_thermal_vorticity(
+            const double tau, const FlowVec &u_local, const double T_local,
+            const Mat4x4 &dUoverT, VorticityVec &omega) const {
     if (T_local > T_tol) {
         double dUsup_local[4][4];
         for (int i = 0; i < 4; i++) {
             for (int j = 0; j < 4; j++) {
-                dUsup_local[i][j] = dUoverTsup[i][j];
+                dUsup_local[i][j] = dUoverT[i][j];
             }
         }
 
@@ -215,13 +265,19 @@ void U_derivative::calculate_T_vorticity(
             const double tau, SCGrid &arena, const int ieta,
             const int ix, const int iy, VorticityVec &omega) {
     // this function computes the T-vorticity
-    FlowVec u_local = arena(ix, iy, ieta).u;
-    double T_local  = eos.get_temperature(arena(ix, iy, ieta).epsilon,
-                                          arena(ix, iy, ieta).rhob);
+    const double T_local = eos.get_temperature(arena(ix, iy, ieta).epsilon,
+                                               arena(ix, iy, ieta).rhob);
+    get_T_vorticity(tau, arena(ix, iy, ieta).u, T_local, dUTsup, omega);
+}
+
+
+void U_derivative::get_T_vorticity(
+            const double tau, const FlowVec &u_local, const double T_local,
+            const Mat4x4 &dUT, VorticityVec &omega) const {
     double dUsup_local[4][4];
     for (int i = 0; i < 4; i++) {
         for (int j = 0; j < 4; j++) {
-            dUsup_local[i][j] = dUTsup[i][j];
+            dUsup_local[i][j] = dUT[i][j];
         }
     }
 
@@ -252,14 +308,21 @@ void U_derivative::calculate_T_vorticity(
 void U_derivative::calculate_kinetic_vorticity_no_spatial_projection(
             const double tau, SCGrid &arena, const int ieta,
             const int ix, const int iy, VorticityVec &omega) {
+    get_kinetic_vorticity_no_spatial_projection(tau, arena(ix, iy, ieta).u,
+                                                dUsup, omega);
+}
+
+
+void U_derivative::get_kinetic_vorticity_no_spatial_projection(
+            const double tau, const FlowVec &u_local, const dUsupMat &dU,
+            VorticityVec &omega) const {
     // this function computes the full kinetic vorticity without the spatial
     // projection
     // omega^{\mu\nu} = \partial^\mu u^\nu - \partial^\nu u^\mu
-    FlowVec u_local = arena(ix, iy, ieta).u;
     double dUsup_local[4][4];
     for (int i = 0; i < 4; i++) {
         for (int j = 0; j < 4; j++) {
-            dUsup_local[i][j] = dUsup[i][j];
+            dUsup_local[i][j] = dU[i][j];
         }
     }
 
@@ -291,14 +354,21 @@ void U_derivative::calculate_kinetic_vorticity_no_spatial_projection(
 void U_derivative::calculate_velocity_shear_tensor(
         const double tau, SCGrid &arena, const int ieta, const int ix,
         const int iy, const DumuVec &a_local, VelocityShearVec &sigma) {
-    FlowVec u_local = arena(ix, iy, ieta).u;
+    get_velocity_shear_tensor(tau, arena(ix, iy, ieta).u, dUsup, a_local,
+                              sigma);
+}
+
+
+void U_derivative::get_velocity_shear_tensor(
+        const double tau, const FlowVec &u_local, const dUsupMat &dU,
+        const DumuVec &a_local, VelocityShearVec &sigma) const {
     double dUsup_local[4][4];
     for (int i = 0; i < 4; i++) {
         for (int j = 0; j < 4; j++) {
-            dUsup_local[i][j] = dUsup[i][j];
+            dUsup_local[i][j] = dU[i][j];
         }
     }
-    double theta_u_local = calculate_expansion_rate(tau, arena, ieta, ix, iy);
+    double theta_u_local = get_expansion_rate(tau, u_local, dU);
     double gfac = 0.0;
     double sigma_local[4][4];
     for (int a = 1; a < 4; a++) {
@@ -359,14 +429,16 @@ void U_derivative::get_DmuMuBoverTVec(DmuMuBoverTVec &vec) {
 }
 
 
-int U_derivative::MakeDSpatial(const double tau, SCGrid &arena,
+template<class Grid>
+int U_derivative::MakeDSpatial(const double tau, Grid &arena,
                                const int ix, const int iy, const int ieta) {
-    // taken care of the tau factor
+    // taken care of the tau factor, the centred differences in eta over
+    // the metric spacing of the cell
     const double delta[4] = {0.0, DATA.delta_x, DATA.delta_y,
-                             DATA.delta_eta*tau};
+                             eta_grid_.get_spacing(ieta)*tau};
 
     // calculate dUsup[m][n] = partial^n u^m
-    Neighbourloop(arena, ix, iy, ieta, NLAMBDAS{
+    const auto velocity_stencil = NLAMBDAS_GENERIC{
         for (int m = 1; m <= 3; m++) {
             const double f   = c.u[m];
             const double fp1 = p1.u[m];
@@ -394,7 +466,22 @@ int U_derivative::MakeDSpatial(const double tau, SCGrid &arena,
                     minmod.minmod_dx(fp1*Tp1, f*T, fm1*Tm1)/delta[direction]);
             }
         }
-    });
+    };
+    if (DATA.boost_invariant) {
+        // the eta derivatives vanish on the single slice
+        Neighbourloop2D(arena, ix, iy, ieta, velocity_stencil);
+        for (int m = 0; m <= 4; m++) {
+            dUsup[m][3] = 0.;
+        }
+        if (DATA.include_vorticity_terms == 1) {
+            for (int m = 0; m <= 3; m++) {
+                dUoverTsup[m][3] = 0.;
+                dUTsup[m][3] = 0.;
+            }
+        }
+    } else {
+        Neighbourloop(arena, ix, iy, ieta, velocity_stencil);
+    }
 
     /* for u[0], use u[0]u[0] = 1 + u[i]u[i] */
     /* u[0]_m = u[i]_m (u[i]/u[0]) */
@@ -419,16 +506,35 @@ int U_derivative::MakeDSpatial(const double tau, SCGrid &arena,
     const double muB = eos.get_muB(eps, rhob);
     const double T = eos.get_temperature(eps, rhob);
     const double f = muB/T;
-    Neighbourloop(arena, ix, iy, ieta, NLAMBDAS{
+    const auto muB_over_T_stencil = NLAMBDAS_GENERIC{
         const double fp1 = (eos.get_muB(p1.epsilon, p1.rhob)
                             /eos.get_temperature(p1.epsilon, p1.rhob));
         const double fm1 = (eos.get_muB(m1.epsilon, m1.rhob)
                             /eos.get_temperature(m1.epsilon, m1.rhob));
         dUsup[m][direction] = minmod.minmod_dx(fp1, f, fm1)/delta[direction];
-    });
+    };
+    if (DATA.boost_invariant) {
+        Neighbourloop2D(arena, ix, iy, ieta, muB_over_T_stencil);
+    } else {
+        Neighbourloop(arena, ix, iy, ieta, muB_over_T_stencil);
+    }
     return 1;
 }/* MakeDSpatial */
 
+// the derivatives are compiled for all the sweep grid layouts
+// and for the local stencil of the fused stage kernel
+#define INSTANTIATE_U_DERIVATIVE(Grid)                                     \
+template int U_derivative::MakeDSpatial<Grid>(                            \
+    const double, Grid&, const int, const int, const int);                \
+template void U_derivative::MakedU<Grid>(                                 \
+    const double, SCGrid&, Grid&, const int, const int, const int);
+
+INSTANTIATE_U_DERIVATIVE(SCGrid)
+INSTANTIATE_U_DERIVATIVE(PaddedSCGrid)
+INSTANTIATE_U_DERIVATIVE(SCGridSoA)
+INSTANTIATE_U_DERIVATIVE(SCStencil)
+#undef INSTANTIATE_U_DERIVATIVE
+
 int U_derivative::MakeDTau(const double tau,
                            const Cell_small *grid_pt_prev,
                            const Cell_small *grid_pt) {
@@ -444,20 +550,21 @@ int U_derivative::MakeDTau(const double tau,
 
     for (int m = 0; m < 4; m++) {
         // first order is more stable
-        double f = (grid_pt->u[m] - grid_pt_prev->u[m])/DATA.delta_tau;
+        double f = ((grid_pt->u[m] - grid_pt_prev->u[m])
+                    /DATA.delta_tau_backward);
         dUsup[m][0] = -f;  // g^{00} = -1
 
         if (DATA.include_vorticity_terms == 1) {
             if (T > T_tol && T_prev > T_tol) {
                 double duoverTdtau = (
                     (grid_pt->u[m]/T - grid_pt_prev->u[m]/T_prev)
-                    /DATA.delta_tau);
+                    /DATA.delta_tau_backward);
                 dUoverTsup[m][0] = -duoverTdtau;   // g^{00} = -1
             } else {
                 dUoverTsup[m][0] = 0.;
             }
             double duTdtau = ((grid_pt->u[m]*T - grid_pt_prev->u[m]*T_prev)
-                              /DATA.delta_tau);
+                              /DATA.delta_tau_backward);
             dUTsup[m][0] = -duTdtau;   // g^{00} = -1
         }
     }
@@ -482,7 +589,7 @@ int U_derivative::MakeDTau(const double tau,
     const double tildemu = muB/T;
     const double muB_prev = eos.get_muB(eps, rhob);
     const double tildemu_prev = muB_prev/T_prev;
-    f = (tildemu - tildemu_prev)/(DATA.delta_tau);
+    f = (tildemu - tildemu_prev)/(DATA.delta_tau_backward);
     dUsup[m][0]  = -f;  // g^{00} = -1
     return 1;
 }
@@ -5,7 +5,9 @@
 #include "data.h"
 #include "cell.h"
 #include "grid.h"
+#include "sweep_grid.h"
 #include "minmod.h"
+#include "eta_grid.h"
 #include "data_struct.h"
 #include <string.h>
 #include <iostream>
@@ -16,13 +18,18 @@ class U_derivative {
      const EOS &eos;
      const double T_tol = 1e-5;
      Minmod minmod;
+     EtaGrid eta_grid_;
      dUsupMat dUsup;
      Mat4x4 dUoverTsup;
      Mat4x4 dUTsup;
 
  public:
     U_derivative(const InitData &DATA_in, const EOS &eosIn);
-    void MakedU(const double tau, SCGrid &arena_prev, SCGrid &arena_current,
+
+    //! MakedU and MakeDSpatial take any grid layout as arena_current
+    //! (explicitly instantiated in u_derivative.cpp)
+    template<class Grid>
+    void MakedU(const double tau, SCGrid &arena_prev, Grid &arena_current,
                 const int ix, const int iy, const int ieta);
 
     //! this function returns the expansion rate on the grid
@@ -60,7 +67,34 @@ class U_derivative {
         const double tau, SCGrid &arena, const int ieta, const int ix,
         const int iy, const DumuVec &a_local, VelocityShearVec &sigma);
 
-    int MakeDSpatial(const double tau, SCGrid &arena, const int ix,
+    //! the functions above for the flow u of a cell and its derivatives
+    //! dU[m][n] = partial^n u^m (dU[4][n] = partial^n (mu_B/T)),
+    //! dUoverT[m][n] = partial^n (u^m/T), and dUT[m][n] = partial^n (T u^m)
+    //! instead of the ones of the last MakedU (see UDerivativeRows)
+    double get_expansion_rate(const double tau, const FlowVec &u,
+                              const dUsupMat &dU) const;
+    void get_Du_supmu(const FlowVec &u, const dUsupMat &dU,
+                      DumuVec &a) const;
+    void get_kinetic_vorticity_with_spatial_projector(
+        const double tau, const FlowVec &u, const dUsupMat &dU,
+        const DumuVec &a_local, VorticityVec &omega) const;
+    void get_kinetic_vorticity_no_spatial_projection(
+        const double tau, const FlowVec &u, const dUsupMat &dU,
+        VorticityVec &omega) const;
+    void get_thermal_vorticity(const double tau, const FlowVec &u,
+                               const double T, const Mat4x4 &dUoverT,
+                               VorticityVec &omega) const;
+    void get_T_vorticity(const double tau, const FlowVec &u, const double T,
+                         const Mat4x4 &dUT, VorticityVec &omega) const;
+    void get_velocity_shear_tensor(
+        const double tau, const FlowVec &u, const dUsupMat &dU,
+        const DumuVec &a_local, VelocityShearVec &sigma) const;
+
+    //! the temperature [1/fm] below which the gradients of u/T vanish
+    double get_T_tol() const {return(T_tol);}
+
+    template<class Grid>
+    int MakeDSpatial(const double tau, Grid &arena, const int ix,
                      const int iy, const int ieta);
     int MakeDTau(const double tau, const Cell_small *grid_pt_prev,
                  const Cell_small *grid_pt);
@@ -72,9 +106,17 @@ class U_derivative {
         VorticityVec &omega_local_k, VorticityVec &omega_local_knoSP,
         VorticityVec &omega_local_th, VorticityVec &omega_local_T);
 
+    //! This function computes all 4 kinds of vorticity tensors in the
+    //! tau-eta frame (omega_kSP, omega_k, omega_th, omega_T of Cell_aux)
+    void compute_vorticity_Milne(
+        const double tau, SCGrid &arena_prev, SCGrid &arena_curr,
+        const int ieta, const int ix, const int iy, Cell_aux &omega_Mline);
+
     //! This function transforms the vorticity tensor from tau-eta to tz
     VorticityVec transform_vorticity_to_tz(const VorticityVec omega_Mline,
                                            const double eta);
+    Cell_aux transform_vorticity_to_tz(const Cell_aux &omega_Mline,
+                                       const double eta);
 };
 
 #endif
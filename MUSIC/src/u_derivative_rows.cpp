@@ -0,0 +1,319 @@
+#include "u_derivative_rows.h"
+#include "grid_soa.h"
+#include "slope_limiter.h"
+
+void UDerivativeRows::Row::resize(const int n) {
+    for (int m = 0; m < 4; m++) u[m].resize(n);
+    epsilon.resize(n);
+    rhob.resize(n);
+    T.resize(n);
+    muB.resize(n);
+    muB_over_T.resize(n);
+}
+
+
+UDerivativeRows::UDerivativeRows(const InitData &DATA_in,
+                                 const EOS &eos_in) :
+    DATA(DATA_in),
+    eos(eos_in),
+    tensors_(DATA_in, eos_in),
+    minmod(DATA_in),
+    eta_grid_(DATA_in) {}
+
+
+template<class Grid>
+void UDerivativeRows::load_row(Grid &arena, const int ix_begin, const int n,
+                               const int iy, const int ieta, Row &row) {
+    row.resize(n);
+    for (int i = 0; i < n; i++) {
+        const auto &cell = arena.getHalo(ix_begin + i, iy, ieta);
+        for (int m = 0; m < 4; m++) row.u[m][i] = cell.u[m];
+        row.epsilon[i] = cell.epsilon;
+        row.rhob[i]    = cell.rhob;
+    }
+}
+
+
+template<class Thermo>
+void UDerivativeRows::load_thermo(const Thermo *thermo, const int ix_begin,
+                                  const int n, const int iy, const int ieta,
+                                  Row &row) {
+    if (thermo != nullptr) {
+        for (int i = 0; i < n; i++) {
+            const auto &cell = thermo->getHalo(ix_begin + i, iy, ieta);
+            row.T[i]   = cell.temperature;
+            row.muB[i] = cell.muB;
+        }
+    } else {
+        eos.get_temperature_batch(row.epsilon.data(), row.rhob.data(),
+                                  row.T.data(), n);
+        eos.get_muB_batch(row.epsilon.data(), row.rhob.data(),
+                          row.muB.data(), n);
+    }
+    #pragma omp simd
+    for (int i = 0; i < n; i++) {
+        row.muB_over_T[i] = row.muB[i]/row.T[i];
+    }
+}
+
+
+template<class Grid, class Thermo>
+void UDerivativeRows::compute_row(const double tau, const SCGrid &arena_prev,
+                                  Grid &arena_current,
+                                  const Thermo *thermo_current,
+                                  const int ix_begin, const int ix_end,
+                                  const int iy, const int ieta) {
+    const int n = ix_end - ix_begin;
+    n_cells_  = n;
+    ix_begin_ = ix_begin;
+    dU_.assign(20*n, 0.);
+    dUoverT_.assign(16*n, 0.);
+    dUT_.assign(16*n, 0.);
+
+    // the rows of the stencil, the halo of the centre row and the
+    // neighbouring rows are clamped or padded as by getHalo
+    load_row(arena_current, ix_begin - 1, n + 2, iy, ieta, rows_[kCenter]);
+    load_thermo(thermo_current, ix_begin - 1, n + 2, iy, ieta,
+                rows_[kCenter]);
+    const int n_directions = DATA.boost_invariant ? 2 : 3;
+    const int neighbours[2][2] = {{kYMinus, kYPlus}, {kEtaMinus, kEtaPlus}};
+    const int d_iy[2]   = {1, 0};
+    const int d_ieta[2] = {0, 1};
+    for (int dir = 0; dir < n_directions - 1; dir++) {
+        for (int side = 0; side < 2; side++) {
+            const int sign = 2*side - 1;
+            Row &row = rows_[neighbours[dir][side]];
+            load_row(arena_current, ix_begin, n, iy + sign*d_iy[dir],
+                     ieta + sign*d_ieta[dir], row);
+            load_thermo(thermo_current, ix_begin, n, iy + sign*d_iy[dir],
+                        ieta + sign*d_ieta[dir], row);
+        }
+    }
+    load_row(arena_prev, ix_begin, n, iy, ieta, rows_[kPrev]);
+    load_thermo(static_cast<const ThermoGrid*>(nullptr), ix_begin, n, iy,
+                ieta, rows_[kPrev]);
+
+    // taken care of the tau factor, the centred differences in eta over
+    // the metric spacing of the row
+    const double delta[4] = {0.0, DATA.delta_x, DATA.delta_y,
+                             eta_grid_.get_spacing(ieta)*tau};
+    const Row &center = rows_[kCenter];
+    add_spatial_derivatives(1, delta[1], center, 2, center, 0);
+    add_spatial_derivatives(2, delta[2], rows_[kYPlus], 0,
+                            rows_[kYMinus], 0);
+    if (n_directions == 3) {
+        add_spatial_derivatives(3, delta[3], rows_[kEtaPlus], 0,
+                                rows_[kEtaMinus], 0);
+    }
+
+    // for u[0], use u[0]u[0] = 1 + u[i]u[i]
+    for (int dir = 1; dir <= 3; dir++) {
+        double *out = get_dU(0, dir);
+        const double *du1 = get_dU(1, dir);
+        const double *du2 = get_dU(2, dir);
+        const double *du3 = get_dU(3, dir);
+        const double *u0 = &center.u[0][1];
+        const double *u1 = &center.u[1][1];
+        const double *u2 = &center.u[2][1];
+        const double *u3 = &center.u[3][1];
+        #pragma omp simd
+        for (int i = 0; i < n; i++) {
+            double f = 0.0;
+            f += du1[i]*u1[i];
+            f += du2[i]*u2[i];
+            f += du3[i]*u3[i];
+            f /= u0[i];
+            out[i] = f;
+        }
+    }
+    add_time_derivatives();
+}
+
+
+void UDerivativeRows::add_spatial_derivatives(const int direction,
+                                              const double delta,
+                                              const Row &p1, const int i_p1,
+                                              const Row &m1, const int i_m1) {
+    const Row &c = rows_[kCenter];
+    const SlopeLimiter::Minmod limiter = minmod.get_limiter();
+    const int n = n_cells_;
+
+    // partial^n u^m
+    for (int m = 1; m <= 3; m++) {
+        const double *fp1 = &p1.u[m][i_p1];
+        const double *f   = &c.u[m][1];
+        const double *fm1 = &m1.u[m][i_m1];
+        double *out = get_dU(m, direction);
+        #pragma omp simd
+        for (int i = 0; i < n; i++) {
+            out[i] = limiter(fp1[i], f[i], fm1[i])/delta;
+        }
+    }
+
+    // partial^n (u^m/T) and partial^n (T u^m)
+    if (DATA.include_vorticity_terms == 1) {
+        const double T_tol = tensors_.get_T_tol();
+        const double *Tp1 = &p1.T[i_p1];
+        const double *T   = &c.T[1];
+        const double *Tm1 = &m1.T[i_m1];
+        for (int m = 0; m <= 3; m++) {
+            const double *fp1 = &p1.u[m][i_p1];
+            const double *f   = &c.u[m][1];
+            const double *fm1 = &m1.u[m][i_m1];
+            double *out_over_T = get_dUoverT(m, direction);
+            double *out_T = get_dUT(m, direction);
+            #pragma omp simd
+            for (int i = 0; i < n; i++) {
+                const bool hot = (T[i] > T_tol && Tp1[i] > T_tol
+                                  && Tm1[i] > T_tol);
+                out_over_T[i] = (
+                    hot ? limiter(fp1[i]/Tp1[i], f[i]/T[i], fm1[i]/Tm1[i])
+                          /delta
+                        : 0.);
+                out_T[i] = (limiter(fp1[i]*Tp1[i], f[i]*T[i], fm1[i]*Tm1[i])
+                            /delta);
+            }
+        }
+    }
+
+    // partial^n (mu_B/T)
+    const double *fp1 = &p1.muB_over_T[i_p1];
+    const double *f   = &c.muB_over_T[1];
+    const double *fm1 = &m1.muB_over_T[i_m1];
+    double *out = get_dU(4, direction);
+    #pragma omp simd
+    for (int i = 0; i < n; i++) {
+        out[i] = limiter(fp1[i], f[i], fm1[i])/delta;
+    }
+}
+
+
+void UDerivativeRows::add_time_derivatives() {
+    // the backward derivatives, with the minus sign of g^{00} = -1
+    const Row &c = rows_[kCenter];
+    const Row &prev = rows_[kPrev];
+    const double dtau = DATA.delta_tau_backward;
+    const double T_tol = tensors_.get_T_tol();
+    const int n = n_cells_;
+    const double *T = &c.T[1];
+    const double *T_prev = prev.T.data();
+    for (int m = 0; m < 4; m++) {
+        const double *u = &c.u[m][1];
+        const double *u_prev = prev.u[m].data();
+        double *out = get_dU(m, 0);
+        #pragma omp simd
+        for (int i = 0; i < n; i++) {
+            // first order is more stable
+            const double f = (u[i] - u_prev[i])/dtau;
+            out[i] = -f;
+        }
+        if (DATA.include_vorticity_terms == 1) {
+            double *out_over_T = get_dUoverT(m, 0);
+            double *out_T = get_dUT(m, 0);
+            #pragma omp simd
+            for (int i = 0; i < n; i++) {
+                const bool hot = (T[i] > T_tol && T_prev[i] > T_tol);
+                out_over_T[i] = (
+                    hot ? -((u[i]/T[i] - u_prev[i]/T_prev[i])/dtau) : 0.);
+                out_T[i] = -((u[i]*T[i] - u_prev[i]*T_prev[i])/dtau);
+            }
+        }
+    }
+
+    // d^0 u^0 = u_m d^0 u^m/u^0
+    double *out = get_dU(0, 0);
+    const double *du1 = get_dU(1, 0);
+    const double *du2 = get_dU(2, 0);
+    const double *du3 = get_dU(3, 0);
+    const double *u0 = &c.u[0][1];
+    const double *u1 = &c.u[1][1];
+    const double *u2 = &c.u[2][1];
+    const double *u3 = &c.u[3][1];
+    #pragma omp simd
+    for (int i = 0; i < n; i++) {
+        double f = 0.0;
+        f += du1[i]*u1[i];
+        f += du2[i]*u2[i];
+        f += du3[i]*u3[i];
+        out[i] = f/u0[i];
+    }
+
+    // the time derivative of mu_B/T, with mu_B of the current cell at
+    // both times as in U_derivative::MakeDTau
+    const double *muB = &c.muB[1];
+    double *out_muB = get_dU(4, 0);
+    #pragma omp simd
+    for (int i = 0; i < n; i++) {
+        const double tildemu = muB[i]/T[i];
+        const double tildemu_prev = muB[i]/T_prev[i];
+        const double f = (tildemu - tildemu_prev)/dtau;
+        out_muB[i] = -f;
+    }
+}
+
+
+void UDerivativeRows::get_cell_derivatives(const int i, FlowVec &u,
+                                           dUsupMat &dU, Mat4x4 &dUoverT,
+                                           Mat4x4 &dUT) const {
+    for (int m = 0; m < 4; m++) u[m] = rows_[kCenter].u[m][i + 1];
+    for (int m = 0; m < 5; m++) {
+        for (int n = 0; n < 4; n++) {
+            dU[m][n] = dU_[(m*4 + n)*n_cells_ + i];
+        }
+    }
+    for (int m = 0; m < 4; m++) {
+        for (int n = 0; n < 4; n++) {
+            dUoverT[m][n] = dUoverT_[(m*4 + n)*n_cells_ + i];
+            dUT[m][n] = dUT_[(m*4 + n)*n_cells_ + i];
+        }
+    }
+}
+
+
+void UDerivativeRows::get_gradients(const double tau, const int ix,
+                                    Cell_gradients &gradients) const {
+    FlowVec u;
+    dUsupMat dU;
+    Mat4x4 dUoverT, dUT;
+    get_cell_derivatives(ix - ix_begin_, u, dU, dUoverT, dUT);
+    gradients.theta = tensors_.get_expansion_rate(tau, u, dU);
+    tensors_.get_Du_supmu(u, dU, gradients.a);
+    tensors_.get_velocity_shear_tensor(tau, u, dU, gradients.a,
+                                       gradients.sigma);
+    tensors_.get_kinetic_vorticity_with_spatial_projector(
+                                tau, u, dU, gradients.a, gradients.omega);
+    for (int mu = 0; mu < 4; mu++) {
+        gradients.DmuMuBoverT[mu] = dU[4][mu];
+    }
+}
+
+
+void UDerivativeRows::get_vorticity(const double tau, const int ix,
+                                    Cell_aux &omega) const {
+    const int i = ix - ix_begin_;
+    FlowVec u;
+    dUsupMat dU;
+    Mat4x4 dUoverT, dUT;
+    get_cell_derivatives(i, u, dU, dUoverT, dUT);
+    DumuVec a;
+    tensors_.get_Du_supmu(u, dU, a);
+    tensors_.get_kinetic_vorticity_with_spatial_projector(tau, u, dU, a,
+                                                          omega.omega_kSP);
+    tensors_.get_kinetic_vorticity_no_spatial_projection(tau, u, dU,
+                                                         omega.omega_k);
+    const double T = rows_[kCenter].T[i + 1];
+    tensors_.get_thermal_vorticity(tau, u, T, dUoverT, omega.omega_th);
+    tensors_.get_T_vorticity(tau, u, T, dUT, omega.omega_T);
+}
+
+
+// the rows are compiled for the sweep grid layouts with their EOS caches
+#define INSTANTIATE_U_DERIVATIVE_ROWS(Grid, Thermo)                        \
+template void UDerivativeRows::compute_row<Grid, Thermo>(                 \
+    const double, const SCGrid&, Grid&, const Thermo*, const int,         \
+    const int, const int, const int);
+
+INSTANTIATE_U_DERIVATIVE_ROWS(SCGrid, ThermoGrid)
+INSTANTIATE_U_DERIVATIVE_ROWS(PaddedSCGrid, PaddedThermoGrid)
+INSTANTIATE_U_DERIVATIVE_ROWS(SCGridSoA, ThermoGrid)
+#undef INSTANTIATE_U_DERIVATIVE_ROWS
@@ -0,0 +1,108 @@
+#ifndef SRC_U_DERIVATIVE_ROWS_H_
+#define SRC_U_DERIVATIVE_ROWS_H_
+
+#include <vector>
+#include "cell.h"
+#include "data.h"
+#include "data_struct.h"
+#include "eos.h"
+#include "eta_grid.h"
+#include "grid.h"
+#include "minmod.h"
+#include "u_derivative.h"
+
+//! This class computes the velocity gradients of a row of cells along x
+//! (a pencil) at once, instead of one cell at a time as U_derivative.
+//! The flow and the EOS quantities of the row with its halo in x, of the
+//! neighbouring rows in y and eta, and of the row in arena_prev are read
+//! into contiguous arrays once. The temperatures and mu_B of arena_current
+//! come from the EOS cache of the stage when it is passed, and from one
+//! batched EOS call per row otherwise, so they are not evaluated again by
+//! every neighbour of a cell. The derivatives partial^n u^m,
+//! partial^n (mu_B/T), partial^n (u^m/T) and partial^n (T u^m) of the
+//! cells are then computed by loops over the row, which vectorize, with
+//! the same operations as U_derivative::MakedU. The tensors of a cell
+//! (theta, Du^mu, sigma^{mu nu}, omega^{mu nu}) are computed from them by
+//! the functions of U_derivative, so the results are the same.
+class UDerivativeRows {
+ private:
+    const InitData &DATA;
+    const EOS &eos;
+    U_derivative tensors_;
+    Minmod minmod;
+    EtaGrid eta_grid_;
+
+    //! the quantities of a row of cells
+    struct Row {
+        std::vector<double> u[4];
+        std::vector<double> epsilon, rhob;
+        std::vector<double> T, muB, muB_over_T;
+        void resize(const int n);
+    };
+    //! the rows of the stencil; the centre row carries one halo cell on
+    //! each side in x
+    enum RowIndex {
+        kCenter = 0, kYMinus, kYPlus, kEtaMinus, kEtaPlus, kPrev, kNumRows
+    };
+    Row rows_[kNumRows];
+
+    int n_cells_ = 0;
+    int ix_begin_ = 0;
+    //! the derivatives of the cells of the row, [(m*4 + n)*n_cells_ + i]
+    std::vector<double> dU_;
+    std::vector<double> dUoverT_;
+    std::vector<double> dUT_;
+
+    double *get_dU(const int m, const int n) {
+        return(&dU_[(m*4 + n)*n_cells_]);
+    }
+    double *get_dUoverT(const int m, const int n) {
+        return(&dUoverT_[(m*4 + n)*n_cells_]);
+    }
+    double *get_dUT(const int m, const int n) {
+        return(&dUT_[(m*4 + n)*n_cells_]);
+    }
+
+    //! reads the n cells from (ix_begin, iy, ieta) on of arena into row
+    template<class Grid>
+    void load_row(Grid &arena, const int ix_begin, const int n,
+                  const int iy, const int ieta, Row &row);
+    //! the EOS quantities of row from thermo, or from the EOS
+    template<class Thermo>
+    void load_thermo(const Thermo *thermo, const int ix_begin, const int n,
+                     const int iy, const int ieta, Row &row);
+
+    //! the derivatives in direction of the cells of the centre row from
+    //! the cells i_p1 + i of p1 and i_m1 + i of m1
+    void add_spatial_derivatives(const int direction, const double delta,
+                                 const Row &p1, const int i_p1,
+                                 const Row &m1, const int i_m1);
+    void add_time_derivatives();
+
+    void get_cell_derivatives(const int i, FlowVec &u, dUsupMat &dU,
+                              Mat4x4 &dUoverT, Mat4x4 &dUT) const;
+
+ public:
+    UDerivativeRows(const InitData &DATA_in, const EOS &eos_in);
+
+    //! computes the derivatives of the cells [ix_begin, ix_end) of the row
+    //! (iy, ieta) of arena_current, with the time derivatives from
+    //! arena_prev. thermo_current is the EOS cache of arena_current, or
+    //! nullptr. (explicitly instantiated in u_derivative_rows.cpp)
+    template<class Grid, class Thermo>
+    void compute_row(const double tau, const SCGrid &arena_prev,
+                     Grid &arena_current, const Thermo *thermo_current,
+                     const int ix_begin, const int ix_end,
+                     const int iy, const int ieta);
+
+    //! the gradients of the cell ix of the last row, as the ones of
+    //! MakedU in Advance::AdvanceCell
+    void get_gradients(const double tau, const int ix,
+                       Cell_gradients &gradients) const;
+
+    //! the 4 kinds of vorticity tensors of the cell ix of the last row in
+    //! the tau-eta frame, as U_derivative::compute_vorticity_Milne
+    void get_vorticity(const double tau, const int ix, Cell_aux &omega) const;
+};
+
+#endif  // SRC_U_DERIVATIVE_ROWS_H_
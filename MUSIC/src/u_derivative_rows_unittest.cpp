@@ -0,0 +1,144 @@
+#include "u_derivative_rows.h"
+#include "doctest.h"
+#include "eos.h"
+#include <cmath>
+
+namespace {
+
+InitData make_test_data(const bool boost_invariant,
+                        const int include_vorticity_terms) {
+    InitData DATA;
+    DATA.delta_x                 = 0.2;
+    DATA.delta_y                 = 0.3;
+    DATA.delta_eta               = 0.1;
+    DATA.delta_tau               = 0.02;
+    DATA.delta_tau_backward      = 0.02;
+    DATA.minmod_theta            = 1.8;
+    DATA.boost_invariant         = boost_invariant;
+    DATA.include_vorticity_terms = include_vorticity_terms;
+    return(DATA);
+}
+
+//! a grid with smooth flow and densities, with a few cells below the
+//! temperature cut of the derivatives of u/T
+void fill_test_grid(SCGrid &arena, const double phase) {
+    for (int ieta = 0; ieta < arena.nEta(); ieta++)
+    for (int ix = 0; ix < arena.nX(); ix++)
+    for (int iy = 0; iy < arena.nY(); iy++) {
+        Cell_small &cell = arena(ix, iy, ieta);
+        cell.epsilon = 2. + sin(0.7*ix + 0.4*iy - 0.3*ieta + phase);
+        if ((ix + 2*iy + ieta) % 11 == 0) cell.epsilon = 1e-30;
+        cell.rhob = 0.1 + 0.05*cos(0.3*ix - 0.6*iy + phase);
+        cell.u[1] = 0.3*sin(0.7*ix + 0.2*iy + phase);
+        cell.u[2] = 0.2*cos(0.5*iy - 0.3*ieta);
+        cell.u[3] = 0.1*sin(0.4*ieta + 0.1*ix - phase);
+        cell.u[0] = sqrt(1. + cell.u[1]*cell.u[1] + cell.u[2]*cell.u[2]
+                         + cell.u[3]*cell.u[3]);
+    }
+}
+
+void fill_thermo(const EOS &eos, const SCGrid &arena, ThermoGrid &thermo) {
+    for (int ieta = 0; ieta < arena.nEta(); ieta++)
+    for (int ix = 0; ix < arena.nX(); ix++)
+    for (int iy = 0; iy < arena.nY(); iy++) {
+        const Cell_small &cell = arena(ix, iy, ieta);
+        thermo(ix, iy, ieta).temperature = (
+                            eos.get_temperature(cell.epsilon, cell.rhob));
+        thermo(ix, iy, ieta).muB = eos.get_muB(cell.epsilon, cell.rhob);
+    }
+}
+
+template<class Vec>
+void check_equal(const Vec &a, const Vec &b) {
+    for (unsigned int i = 0; i < a.size(); i++) CHECK(a[i] == b[i]);
+}
+
+}
+
+TEST_CASE("the gradients of the rows equal the ones of MakedU") {
+    EOS eos_ideal(0);
+    const double tau = 1.3;
+    for (const bool boost_invariant : {false, true})
+    for (const int vorticity_terms : {0, 1})
+    for (const bool with_thermo : {false, true}) {
+        const InitData DATA = make_test_data(boost_invariant,
+                                             vorticity_terms);
+        const int neta = boost_invariant ? 1 : 4;
+        SCGrid arena_prev(7, 6, neta);
+        SCGrid arena_current(7, 6, neta);
+        fill_test_grid(arena_prev, 0.1);
+        fill_test_grid(arena_current, 0.);
+        ThermoGrid thermo(7, 6, neta);
+        fill_thermo(eos_ideal, arena_current, thermo);
+
+        U_derivative u_derivative(DATA, eos_ideal);
+        UDerivativeRows rows(DATA, eos_ideal);
+        for (int ieta = 0; ieta < neta; ieta++)
+        for (int iy = 0; iy < arena_current.nY(); iy++) {
+            // a part of the row, with the halo inside the grid
+            const int ix_begin = (iy % 2 == 0 ? 0 : 2);
+            const int ix_end = arena_current.nX() - (iy % 3 == 0 ? 0 : 1);
+            rows.compute_row(tau, arena_prev, arena_current,
+                             with_thermo ? &thermo : nullptr,
+                             ix_begin, ix_end, iy, ieta);
+            for (int ix = ix_begin; ix < ix_end; ix++) {
+                Cell_gradients gradients;
+                rows.get_gradients(tau, ix, gradients);
+
+                u_derivative.MakedU(tau, arena_prev, arena_current,
+                                    ix, iy, ieta);
+                CHECK(gradients.theta
+                      == u_derivative.calculate_expansion_rate(
+                                    tau, arena_current, ieta, ix, iy));
+                DumuVec a;
+                u_derivative.calculate_Du_supmu(tau, arena_current,
+                                                ieta, ix, iy, a);
+                check_equal(gradients.a, a);
+                VelocityShearVec sigma;
+                u_derivative.calculate_velocity_shear_tensor(
+                        tau, arena_current, ieta, ix, iy, a, sigma);
+                check_equal(gradients.sigma, sigma);
+                VorticityVec omega;
+                u_derivative.calculate_kinetic_vorticity_with_spatial_projector(
+                        tau, arena_current, ieta, ix, iy, a, omega);
+                check_equal(gradients.omega, omega);
+                DmuMuBoverTVec DmuMuBoverT;
+                u_derivative.get_DmuMuBoverTVec(DmuMuBoverT);
+                check_equal(gradients.DmuMuBoverT, DmuMuBoverT);
+            }
+        }
+    }
+}
+
+TEST_CASE("the vorticity of the rows equals compute_vorticity_Milne") {
+    EOS eos_ideal(0);
+    const double tau = 0.8;
+    for (const bool boost_invariant : {false, true}) {
+        const InitData DATA = make_test_data(boost_invariant, 1);
+        const int neta = boost_invariant ? 1 : 3;
+        SCGrid arena_prev(6, 5, neta);
+        SCGrid arena_current(6, 5, neta);
+        fill_test_grid(arena_prev, -0.2);
+        fill_test_grid(arena_current, 0.);
+
+        U_derivative u_derivative(DATA, eos_ideal);
+        UDerivativeRows rows(DATA, eos_ideal);
+        for (int ieta = 0; ieta < neta; ieta++)
+        for (int iy = 0; iy < arena_current.nY(); iy++) {
+            rows.compute_row(tau, arena_prev, arena_current,
+                             static_cast<const ThermoGrid*>(nullptr),
+                             0, arena_current.nX(), iy, ieta);
+            for (int ix = 0; ix < arena_current.nX(); ix++) {
+                Cell_aux omega_rows, omega_cell;
+                rows.get_vorticity(tau, ix, omega_rows);
+                u_derivative.compute_vorticity_Milne(
+                    tau, arena_prev, arena_current, ieta, ix, iy,
+                    omega_cell);
+                check_equal(omega_rows.omega_kSP, omega_cell.omega_kSP);
+                check_equal(omega_rows.omega_k, omega_cell.omega_k);
+                check_equal(omega_rows.omega_th, omega_cell.omega_th);
+                check_equal(omega_rows.omega_T, omega_cell.omega_T);
+            }
+        }
+    }
+}
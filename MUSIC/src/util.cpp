@@ -2,6 +2,7 @@
 // Copyright (C) 2017  Gabriel Denicol, Charles Gale, Sangyong Jeon, Matthew Luzum, Jean-François Paquet, Björn Schenke, Chun Shen
 
 #include "util.h"
+#include "memory_accounting.h"
 #include <iostream>
 #include <string>
 #include <execinfo.h>
@@ -30,6 +31,12 @@ double gmn(const int a) {
 }
 
 
+//! the bytes of a matrix of mtx_malloc, booked with the EOS tables
+static int64_t get_mtx_bytes(const int n1, const int n2) {
+    return(static_cast<int64_t>(n1)*(n2*sizeof(double) + sizeof(double*)));
+}
+
+
 double **mtx_malloc(const int n1, const int n2) {
     double **d1_ptr; 
     d1_ptr = new double *[n1];
@@ -41,6 +48,8 @@ double **mtx_malloc(const int n1, const int n2) {
     for(int j=0; j<n2; j++) 
         d1_ptr[i][j] = 0.0;
 
+    MemoryAccounting::allocate(MemorySubsystem::eos_tables,
+                               get_mtx_bytes(n1, n2));
     return d1_ptr;
 }
 
@@ -50,6 +59,8 @@ void mtx_free(double **m, const int n1, const int n2) {
     for (int j = 0; j < n1; j++) 
         delete [] m[j];
     delete [] m;
+    MemoryAccounting::release(MemorySubsystem::eos_tables,
+                              get_mtx_bytes(n1, n2));
 }
 
 
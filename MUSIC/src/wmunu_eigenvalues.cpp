@@ -0,0 +1,123 @@
+#include <algorithm>
+#include <cmath>
+#include <Eigen/Core>
+#include <Eigen/Eigenvalues>
+
+#include "wmunu_eigenvalues.h"
+
+namespace WmunuEigenvalues {
+
+std::array<double, 6> get_LRF_spatial_part(const FlowVec &u,
+                                           const ViscousVec &Wmunu) {
+    // pi_LRF^{ij} = L^i_mu L^j_nu pi^{mu nu} with the boost
+    // L^i_0 = -u^i, L^i_j = delta^ij + u^i u^j/(1 + u^0)
+    const double u1 = u[1];
+    const double u2 = u[2];
+    const double u3 = u[3];
+    const double fac = 1./(1. + u[0]);
+
+    const double pi00 = Wmunu[0];
+    const double pi01 = Wmunu[1];
+    const double pi02 = Wmunu[2];
+    const double pi03 = Wmunu[3];
+
+    std::array<double, 6> A;
+    A[0] = Wmunu[4] - 2.*u1*pi01*fac + u1*u1*pi00*fac*fac;
+    A[1] = Wmunu[5] - (u1*pi02 + u2*pi01)*fac + u1*u2*pi00*fac*fac;
+    A[2] = Wmunu[6] - (u1*pi03 + u3*pi01)*fac + u1*u3*pi00*fac*fac;
+    A[3] = Wmunu[7] - 2.*u2*pi02*fac + u2*u2*pi00*fac*fac;
+    A[4] = Wmunu[8] - (u2*pi03 + u3*pi02)*fac + u2*u3*pi00*fac*fac;
+    A[5] = Wmunu[9] - 2.*u3*pi03*fac + u3*u3*pi00*fac*fac;
+    return(A);
+}
+
+
+std::array<double, 3> symmetric3x3_analytic(const std::array<double, 6> &A) {
+    const double a00 = A[0];
+    const double a01 = A[1];
+    const double a02 = A[2];
+    const double a11 = A[3];
+    const double a12 = A[4];
+    const double a22 = A[5];
+
+    const double q  = (a00 + a11 + a22)/3.;
+    const double p1 = a01*a01 + a02*a02 + a12*a12;
+    const double p2 = (  (a00 - q)*(a00 - q) + (a11 - q)*(a11 - q)
+                       + (a22 - q)*(a22 - q) + 2.*p1);
+    if (p2 <= 0.) {
+        return {q, q, q};
+    }
+
+    const double p = sqrt(p2/6.);
+    const double b00 = (a00 - q)/p;
+    const double b11 = (a11 - q)/p;
+    const double b22 = (a22 - q)/p;
+    const double b01 = a01/p;
+    const double b02 = a02/p;
+    const double b12 = a12/p;
+    const double det_B = (  b00*(b11*b22 - b12*b12)
+                          - b01*(b01*b22 - b12*b02)
+                          + b02*(b01*b12 - b11*b02));
+    const double r = std::max(-1., std::min(1., det_B/2.));
+    const double phi = acos(r)/3.;
+
+    const double lambda_max = q + 2.*p*cos(phi);
+    const double lambda_min = q + 2.*p*cos(phi + 2.*M_PI/3.);
+    const double lambda_mid = 3.*q - lambda_max - lambda_min;
+    return {lambda_min, lambda_mid, lambda_max};
+}
+
+
+std::array<double, 3> symmetric3x3_Eigen(const std::array<double, 6> &A) {
+    Eigen::Matrix3d M;
+    M << A[0], A[1], A[2],
+         A[1], A[3], A[4],
+         A[2], A[4], A[5];
+    Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> es(M,
+                                                      Eigen::EigenvaluesOnly);
+    const auto &eig = es.eigenvalues();
+    return {eig[0], eig[1], eig[2]};
+}
+
+
+std::array<double, 2> general4x4_min_max(const ViscousVec &Wmunu) {
+    Eigen::MatrixXd A = Eigen::MatrixXd::Zero(4, 4);
+
+    A(0,0) = - Wmunu[0];
+    A(0,1) = Wmunu[1];
+    A(0,2) = Wmunu[2];
+    A(0,3) = Wmunu[3];
+
+    A(1,0) = - Wmunu[1];
+    A(1,1) = Wmunu[4];
+    A(1,2) = Wmunu[5];
+    A(1,3) = Wmunu[6];
+
+    A(2,0) = - Wmunu[2];
+    A(2,1) = Wmunu[5];
+    A(2,2) = Wmunu[7];
+    A(2,3) = Wmunu[8];
+
+    A(3,0) = - Wmunu[3];
+    A(3,1) = Wmunu[6];
+    A(3,2) = Wmunu[8];
+    A(3,3) = Wmunu[9];
+
+    Eigen::EigenSolver<Eigen::MatrixXd> es;
+    es.compute(A, false);
+
+    double min = es.eigenvalues().real()[0];
+    double max = min;
+
+    for (int i = 1; i < 4; i++){
+        double temp = es.eigenvalues().real()[i];
+        if (temp > max){
+            max = temp;
+        }else if (temp < min){
+            min = temp;
+        }
+    }
+    return {min, max};
+}
+
+}
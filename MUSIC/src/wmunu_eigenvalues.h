@@ -0,0 +1,31 @@
+#ifndef SRC_WMUNU_EIGENVALUES_H_
+#define SRC_WMUNU_EIGENVALUES_H_
+
+#include <array>
+#include "data_struct.h"
+
+//! helper functions to compute the eigenvalues of the shear stress tensor
+//! pi^mu_nu. pi^{mu nu} is symmetric, traceless, and transverse to u^mu,
+//! so u^mu is an eigenvector with eigenvalue 0 and the other three
+//! eigenvalues are those of the spatial part of pi in the local rest frame
+namespace WmunuEigenvalues {
+
+//! boost pi^{mu nu} (stored in Wmunu[0-9]) to the local rest frame
+//! and return the spatial components (xx, xy, xz, yy, yz, zz)
+std::array<double, 6> get_LRF_spatial_part(const FlowVec &u,
+                                           const ViscousVec &Wmunu);
+
+//! eigenvalues of a symmetric 3x3 matrix (xx, xy, xz, yy, yz, zz)
+//! in ascending order using the trigonometric solution of the cubic
+std::array<double, 3> symmetric3x3_analytic(const std::array<double, 6> &A);
+
+//! same as above using Eigen's SelfAdjointEigenSolver
+std::array<double, 3> symmetric3x3_Eigen(const std::array<double, 6> &A);
+
+//! minimum and maximum real eigenvalues of the 4x4 matrix pi^mu_nu
+//! using Eigen's general EigenSolver
+std::array<double, 2> general4x4_min_max(const ViscousVec &Wmunu);
+
+}
+
+#endif  // SRC_WMUNU_EIGENVALUES_H_
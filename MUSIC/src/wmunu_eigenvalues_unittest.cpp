@@ -0,0 +1,97 @@
+#include "wmunu_eigenvalues.h"
+#include "doctest.h"
+#include <cmath>
+#include <cstdlib>
+
+namespace {
+
+//! build a boosted traceless and transverse pi^{mu nu} from the
+//! diagonal LRF tensor diag(0, l1, l2, -l1-l2) rotated by the angle theta
+//! in the x-y plane
+ViscousVec make_boosted_Wmunu(const FlowVec &u, const double l1,
+                              const double l2, const double theta) {
+    const double c = cos(theta);
+    const double s = sin(theta);
+    double pi_LRF[4][4] = {{0.}};
+    pi_LRF[1][1] = c*c*l1 + s*s*l2;
+    pi_LRF[2][2] = s*s*l1 + c*c*l2;
+    pi_LRF[1][2] = c*s*(l1 - l2);
+    pi_LRF[2][1] = pi_LRF[1][2];
+    pi_LRF[3][3] = -l1 - l2;
+
+    // boost from the local rest frame to the lab frame
+    double L[4][4];
+    L[0][0] = u[0];
+    for (int i = 1; i < 4; i++) {
+        L[0][i] = u[i];
+        L[i][0] = u[i];
+        for (int j = 1; j < 4; j++) {
+            L[i][j] = (i == j ? 1. : 0.) + u[i]*u[j]/(1. + u[0]);
+        }
+    }
+    ViscousVec Wmunu = {0.};
+    int idx = 0;
+    for (int mu = 0; mu < 4; mu++) {
+        for (int nu = mu; nu < 4; nu++) {
+            double temp = 0.;
+            for (int a = 0; a < 4; a++)
+                for (int b = 0; b < 4; b++)
+                    temp += L[mu][a]*L[nu][b]*pi_LRF[a][b];
+            Wmunu[idx++] = temp;
+        }
+    }
+    return(Wmunu);
+}
+
+FlowVec make_u(const double ux, const double uy, const double ueta) {
+    return {sqrt(1. + ux*ux + uy*uy + ueta*ueta), ux, uy, ueta};
+}
+
+}
+
+TEST_CASE("LRF spatial part of boosted pi^{mu nu}") {
+    auto u = make_u(0.8, -1.2, 0.3);
+    auto Wmunu = make_boosted_Wmunu(u, 0.3, -0.1, 0.0);
+    auto A = WmunuEigenvalues::get_LRF_spatial_part(u, Wmunu);
+    CHECK(A[0] == doctest::Approx(0.3));
+    CHECK(A[1] == doctest::Approx(0.).epsilon(1e-10));
+    CHECK(A[2] == doctest::Approx(0.).epsilon(1e-10));
+    CHECK(A[3] == doctest::Approx(-0.1));
+    CHECK(A[4] == doctest::Approx(0.).epsilon(1e-10));
+    CHECK(A[5] == doctest::Approx(-0.2));
+}
+
+TEST_CASE("analytic 3x3 eigenvalues agree with Eigen") {
+    srand(42);
+    for (int i = 0; i < 100; i++) {
+        std::array<double, 6> A;
+        for (auto &a_i : A) {
+            a_i = 2.*static_cast<double>(rand())/RAND_MAX - 1.;
+        }
+        auto eig_analytic = WmunuEigenvalues::symmetric3x3_analytic(A);
+        auto eig_Eigen = WmunuEigenvalues::symmetric3x3_Eigen(A);
+        for (int j = 0; j < 3; j++) {
+            CHECK(eig_analytic[j] == doctest::Approx(eig_Eigen[j]));
+        }
+    }
+
+    // degenerate eigenvalues
+    std::array<double, 6> A = {0.5, 0., 0., 0.5, 0., 0.5};
+    auto eig = WmunuEigenvalues::symmetric3x3_analytic(A);
+    CHECK(eig[0] == doctest::Approx(0.5));
+    CHECK(eig[1] == doctest::Approx(0.5));
+    CHECK(eig[2] == doctest::Approx(0.5));
+}
+
+TEST_CASE("LRF eigenvalues agree with the general 4x4 solver") {
+    auto u = make_u(1.5, 0.4, -0.7);
+    auto Wmunu = make_boosted_Wmunu(u, 0.25, 0.1, 0.6);
+    auto eig = WmunuEigenvalues::symmetric3x3_analytic(
+                    WmunuEigenvalues::get_LRF_spatial_part(u, Wmunu));
+    auto min_max = WmunuEigenvalues::general4x4_min_max(Wmunu);
+    CHECK(eig[0] == doctest::Approx(-0.35));
+    CHECK(eig[1] == doctest::Approx(0.1));
+    CHECK(eig[2] == doctest::Approx(0.25));
+    CHECK(min_max[0] == doctest::Approx(eig[0]));
+    CHECK(min_max[1] == doctest::Approx(eig[2]));
+}
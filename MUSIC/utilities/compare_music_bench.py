@@ -0,0 +1,49 @@
+#!/usr/bin/env python
+"""
+    This script compares two result files of music_bench (see
+    hackathon/NOTES.md) and prints the change of the time per operation of
+    every benchmark. The benchmarks slower than the threshold (default 10%)
+    are marked, and the exit status is 1 if there are any.
+"""
+
+import json
+import sys
+
+
+def read_results(filename):
+    """returns (header, {name: ns_per_op_min})"""
+    with open(filename) as f:
+        data = json.load(f)
+    results = {entry['name']: entry['ns_per_op_min']
+               for entry in data['results']}
+    return data, results
+
+
+def main():
+    if len(sys.argv) < 3:
+        print("Usage: {} reference.json new.json [threshold]"
+              .format(sys.argv[0]))
+        exit(0)
+    threshold = float(sys.argv[3]) if len(sys.argv) > 3 else 0.1
+    ref_header, ref_results = read_results(sys.argv[1])
+    new_header, new_results = read_results(sys.argv[2])
+    print("reference: commit {} ({} threads), new: commit {} ({} threads)"
+          .format(ref_header['commit'], ref_header['threads'],
+                  new_header['commit'], new_header['threads']))
+    n_slower = 0
+    for name, new_time in new_results.items():
+        if name not in ref_results:
+            print("{:<48s} {:>12.4g} ns/op (new)".format(name, new_time))
+            continue
+        change = new_time/ref_results[name] - 1.
+        mark = ""
+        if change > threshold:
+            mark = "  <-- slower"
+            n_slower += 1
+        print("{:<48s} {:>12.4g} ns/op {:>+8.1%}{}".format(
+              name, new_time, change, mark))
+    exit(1 if n_slower > 0 else 0)
+
+
+if __name__ == "__main__":
+    main()
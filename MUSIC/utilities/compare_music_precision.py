@@ -0,0 +1,77 @@
+#!/usr/bin/env python
+"""
+    This script compares the text outputs (the evolution observables, the
+    flow and the spectra) of two MUSIC runs, e.g. a build with
+    -DMUSIC_FLOAT_DISSIPATIVE against the double build (see
+    hackathon/NOTES.md). For every column of the files in both directories
+    it prints the maximum deviation relative to the largest value of the
+    column in the reference. The files deviating more than the tolerance
+    (default 1e-3) are marked, and the exit status is 1 if there are any.
+"""
+
+import glob
+import os
+import sys
+
+import numpy as np
+
+
+def read_columns(filename):
+    """returns the numbers of the file as a 2D array, or None"""
+    try:
+        data = np.loadtxt(filename, comments="#", ndmin=2)
+    except ValueError:
+        return None
+    return data
+
+
+def compare_file(ref_file, new_file):
+    """returns the maximum relative deviation of the columns, or None if
+       the files can not be compared"""
+    ref = read_columns(ref_file)
+    new = read_columns(new_file)
+    if ref is None or new is None or ref.shape != new.shape:
+        return None
+    if ref.size == 0:
+        return 0.
+    scale = np.max(np.abs(ref), axis=0)
+    scale[scale == 0.] = 1.
+    deviation = np.max(np.abs(new - ref), axis=0)/scale
+    return np.max(deviation)
+
+
+def main():
+    if len(sys.argv) < 3:
+        print("Usage: {} reference_dir new_dir [tolerance] [pattern]"
+              .format(sys.argv[0]))
+        exit(0)
+    ref_dir, new_dir = sys.argv[1], sys.argv[2]
+    tolerance = float(sys.argv[3]) if len(sys.argv) > 3 else 1e-3
+    pattern = sys.argv[4] if len(sys.argv) > 4 else "*.dat"
+    n_failed = 0
+    n_compared = 0
+    for ref_file in sorted(glob.glob(os.path.join(ref_dir, pattern))):
+        name = os.path.basename(ref_file)
+        new_file = os.path.join(new_dir, name)
+        if not os.path.isfile(new_file):
+            print("{:<56s} missing".format(name))
+            n_failed += 1
+            continue
+        deviation = compare_file(ref_file, new_file)
+        if deviation is None:
+            print("{:<56s} differs in shape or is not numeric".format(name))
+            n_failed += 1
+            continue
+        n_compared += 1
+        mark = ""
+        if deviation > tolerance:
+            mark = "  <-- above tolerance"
+            n_failed += 1
+        print("{:<56s} {:>12.4g}{}".format(name, deviation, mark))
+    print("compared {} files, {} failed with tolerance {:g}"
+          .format(n_compared, n_failed, tolerance))
+    exit(1 if n_failed > 0 else 0)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,91 @@
+#!/usr/bin/env python
+"""
+    This script converts a text initial profile into the binary format read
+    by MUSIC (src/initial_profile_file.h). The IP-Glasma profiles of
+    Initial_profile 8 (11 columns) and 9x (18 columns or more) are converted
+    from their header line and the first nx*ny rows. With --thickness nx ny
+    a headerless MC-Glauber thickness function (Initial_profile 11, 111) is
+    converted into a binary profile with the single field "T".
+
+    usage: python convert_initial_profile_to_binary.py input output
+           python convert_initial_profile_to_binary.py --thickness nx ny \
+                  input output
+"""
+
+import sys
+import struct
+from array import array
+
+MAGIC = b"MUSICIC1"
+FORMAT_VERSION = 1
+HEADER_SIZE = 8 + 6*4 + 6*8 + 4
+
+FIELDS_8 = ["ed", "utau", "ux", "uy"]
+FIELDS_9 = ["ed", "utau", "ux", "uy", "ueta",
+            "pitautau", "pitaux", "pitauy", "pitaueta",
+            "pixx", "pixy", "pixeta", "piyy", "piyeta", "pietaeta"]
+
+
+def write_binary(filename, grid, field_names, fields):
+    """grid holds neta, nx, ny, tau0, deta, dx, dy, x_min, y_min"""
+    names = ",".join(field_names).encode()
+    names += b"\0"*((8 - (HEADER_SIZE + len(names)) % 8) % 8)
+    with open(filename, "wb") as f:
+        f.write(MAGIC)
+        f.write(struct.pack("<6i", FORMAT_VERSION, len(fields),
+                            grid["neta"], grid["nx"], grid["ny"], 0))
+        f.write(struct.pack("<6d", grid["tau0"], grid["deta"], grid["dx"],
+                            grid["dy"], grid["x_min"], grid["y_min"]))
+        f.write(struct.pack("<i", len(names)))
+        f.write(names)
+        for field in fields:
+            data = array("d", field)
+            if sys.byteorder != "little":
+                data.byteswap()
+            data.tofile(f)
+
+
+def convert_ipglasma(input_file, output_file):
+    with open(input_file, "r") as f:
+        header = f.readline().split()
+        grid = {"tau0": float(header[2]), "neta": int(header[4]),
+                "nx": int(header[6]), "ny": int(header[8]),
+                "deta": float(header[10]), "dx": float(header[12]),
+                "dy": float(header[14])}
+        n_cells = grid["nx"]*grid["ny"]
+        rows = []
+        for line in f:
+            if len(rows) == n_cells:
+                break
+            if line.strip():
+                rows.append([float(x) for x in line.split()])
+    if len(rows) != n_cells:
+        sys.exit("{} ends after {} of {} cells".format(input_file, len(rows),
+                                                       n_cells))
+    field_names = FIELDS_9 if len(rows[0]) >= 18 else FIELDS_8
+    grid["x_min"] = rows[0][1]
+    grid["y_min"] = rows[0][2]
+    fields = [[row[3 + i] for row in rows] for i in range(len(field_names))]
+    write_binary(output_file, grid, field_names, fields)
+
+
+def convert_thickness(nx, ny, input_file, output_file):
+    with open(input_file, "r") as f:
+        values = [float(x) for x in f.read().split()][:nx*ny]
+    if len(values) != nx*ny:
+        sys.exit("{} ends after {} of {} values".format(input_file,
+                                                        len(values), nx*ny))
+    grid = {"neta": 1, "nx": nx, "ny": ny, "tau0": 0., "deta": 0.,
+            "dx": 0., "dy": 0., "x_min": 0., "y_min": 0.}
+    write_binary(output_file, grid, ["T"], [values])
+
+
+if __name__ == "__main__":
+    if len(sys.argv) == 6 and sys.argv[1] == "--thickness":
+        convert_thickness(int(sys.argv[2]), int(sys.argv[3]),
+                          sys.argv[4], sys.argv[5])
+    elif len(sys.argv) == 3:
+        convert_ipglasma(sys.argv[1], sys.argv[2])
+    else:
+        print(__doc__)
+        sys.exit(1)
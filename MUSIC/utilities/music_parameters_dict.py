@@ -16,8 +16,15 @@ control_dict = {
                 #    postprocessing with the stored results
                 # 13: Compute observables from thermal spectra
                 # 14: Compute observables from post-decay spectra
+                # 9: Auto-tune the runtime knobs of the time steps and
+                #    write the profile the later runs load
     'echo_level' : 1,   # switch to control the mount of warning message output
                         # chosen from 1 to 9
+    'log_level' : 0,    # lowest severity of the messages written
+                        # 0: debug, 1: info, 2: warning, 3: error
+    'log_rate_limit' : 10,  # messages per second of a warning printed per
+                            # cell before the others are suppressed and
+                            # counted (0: no limit)
 }
 
 
@@ -79,6 +86,18 @@ hydro_dict = {
     'Total_evolution_time_tau': 50.,    # the maximum allowed running evolution time (fm/c)
                                         # need to be set to some large enough number
     'Delta_Tau': 0.04,                  # time step to use in the evolution [fm/c]
+    'adaptive_dtau': 0,                 # 1: choose every time step from the CFL
+                                        #    condition of the fastest signal
+                                        #    (fixed Delta_Tau while there are
+                                        #    source terms)
+    'adaptive_dtau_cfl': 0.25,          # Courant number of the adaptive step
+    'adaptive_dtau_growth': 1.1,        # largest ratio of successive steps
+    'adaptive_dtau_max_ratio': 5.0,     # largest step in units of Delta_Tau
+    'transverse_coarsening_levels': 0,  # number of times the transverse plane
+                                        # may be coarsened by 2 (odd nx, ny)
+    'transverse_coarsening_threshold': 0.05,  # coarsen when the jump of e
+                                        # between the coarse points over the
+                                        # largest e is below this value
     'Eta_grid_size': 14.0,              # spatial rapidity range
                                         # [-Eta_grid_size/2, Eta_grid_size/2 - delta_eta]
     'Grid_size_in_eta': 4,              # number of the grid points in spatial rapidity direction
@@ -87,6 +106,8 @@ hydro_dict = {
                                         # One cell is positioned at eta=0,
                                         # half the cells are at negative eta,
                                         # the rest (one fewer) are at positive eta
+    'eta_grid_stretching': 0.,          # c of the stretched eta grid, eta_s = Eta_grid_size/2*sinh(c*xi)/sinh(c)
+                                        # with xi uniform in [-1, 1] (0: uniform grid)
     'X_grid_size_in_fm': 26.0,          # spatial range along x direction in the transverse plane
                                         # [-X_grid_size_in_fm/2, X_grid_size_in_fm/2]
     'Y_grid_size_in_fm': 26.0,          # spatial range along y direction in the transverse plane
@@ -107,30 +128,124 @@ hydro_dict = {
                       # 10: lattice EOS at finite muB (from A. Monnai)
     'check_eos': 0,   # switch to out check files for EoS
     'Minmod_Theta': 1.8,     # theta parameter in the min-mod like limiter
-    'Runge_Kutta_order': 2,  # order of Runge_Kutta for temporal evolution (must be 1 or 2)
+    'Runge_Kutta_order': 2,  # order of Runge_Kutta for temporal evolution
+                             # 1: forward Euler
+                             # 2: SSP-RK2 (Heun)
+                             # 3: SSP-RK3 (Shu and Osher)
     'boost_invariant': 0,    # initial condition is boost invariant
+    'eta_boundary_condition': 0,    # boundary condition in eta
+                                    # 0: outflow (copy the last cell)
+                                    # 1: periodic
+    'fused_rk_stage': 1,     # 1: evolve each cell in one pass over a local
+                             #    copy of its stencil
+                             # 0: separate sweeps over the grid
+    'reconst_batch': 1,      # 1: reconstruct the half-way cells of a cell
+                             #    together, starting from its velocity
+                             # 0: one half-way cell at a time
+    'face_flux': 1,          # 1: compute the KT flux through each face once
+                             # 0: each cell computes the fluxes through
+                             #    its own faces
+    'slope_limiter': 0,      # limiter of the face fluxes (face_flux = 1)
+                             # 0: minmod with minmod_theta
+                             # 1: monotonized central, 2: van Leer
+    'source_deposition': 1,  # 1: deposit the hydro source terms of a
+                             #    Runge-Kutta stage into a grid first
+                             # 0: each cell evaluates its source terms
+    'u_derivative_rows': 0,  # 1: compute the velocity gradients of a
+                             #    Runge-Kutta stage a row at a time
+                             # 0: each cell computes its gradients
+    'grid_traversal': 1,     # loop order of the hydro update
+                             # 3: the tiles of 1 scheduled by their cost
+                             #    in the last step, with work stealing
+                             # 2: static partition of the (eta, y) rows,
+                             #    the NUMA first touch partition
+                             # 1: cache-blocked tiles in storage order
+                             # 0: collapsed (eta, x, y) loop
+    'persistent_parallel_region': 1,  # 1: the Runge-Kutta stages of a
+                                      #    time step in one OpenMP
+                                      #    parallel region
+                                      # 0: a parallel region per grid loop
+    'grid_first_touch': 1,   # 1: the threads construct the grids (NUMA
+                             #    first touch), 0: the master thread
+    'grid_huge_pages': 0,    # 1: back the grids by transparent huge pages
+    'memory_budget_MB': 0,   # memory budget of the run (0: none); the
+                             # optional copies are switched off until the
+                             # estimate fits, the memory by subsystem is
+                             # printed at the end
+    'omp_num_threads': 0,    # number of OpenMP threads (0: OMP_NUM_THREADS)
+    'autotune_steps': 4,     # time steps of a configuration in mode 9,
+                             # the first one is not timed
+    'autotune_tolerance': 1e-10,  # largest difference of the grid of a
+                                  # tuned configuration from the input one
+    'autotune_load_profile': 1,   # 1: read the runtime knobs the input
+                                  #    does not set from the profile of
+                                  #    mode 9 if it exists
+    'autotune_profile': '',  # the profile ('': music_autotune_<host>.dat)
+    'grid_tile_size_x': 0,   # tile shape of the tiled loops
+    'grid_tile_size_y': 0,   # (0: chosen from the L2 cache size)
+    'grid_tile_size_eta': 0,
+    'active_region_epsilon': 0.0,   # vacuum energy density (GeV/fm^3);
+                                    # cells farther than a few cells from
+                                    # the fluid above it are copied forward
+                                    # (0: evolve the whole grid). It must be
+                                    # below the freeze-out energy density.
 
     #viscosity and diffusion options
     'Viscosity_Flag_Yes_1_No_0': 1,               # turn on viscosity in the evolution
     'Include_Shear_Visc_Yes_1_No_0': 1,           # include shear viscous effect
     'Shear_to_S_ratio': 0.08,                     # value of \eta/s
     'T_dependent_Shear_to_S_ratio': 0,            # switch to turn on temperature dependent eta/s(T)
+    'transport_coeffs_table': 1,                  # interpolate eta/s(T, muB) and zeta/s(T) in tables
+                                                  # (0: evaluate the parameterizations every call)
     'Include_Bulk_Visc_Yes_1_No_0': 0,            # include bulk viscous effect
     'Include_second_order_terms': 0,              # include second order coupling terms
     'Include_Rhob_Yes_1_No_0': 0,                 # turn on propagation of baryon current
     'turn_on_baryon_diffusion': 0,                # turn on baryon current diffusion
     'kappa_coefficient': 0.0,                     # constant in the baryon diffusion coefficient
+    'implicit_relaxation': 0,                     # 1: integrate the relaxation terms of the dissipative currents
+                                                  #    implicitly, so relaxation times below 3 delta_tau are stable
+                                                  # 0: explicitly, the relaxation times are at least 3 delta_tau
+
+    # causality options
+    'causality_method': 2,                        # 0: without causality modification
+                                                  # 1: questrevert with necessary causality conditions
+                                                  # 2: questrevert with sufficient causality conditions
+    'Wmunu_eigenvalue_solver': 1,                 # method to compute the eigenvalues of pi^mu_nu
+                                                  # 0: general 4x4 eigenvalue solver
+                                                  # 1: analytic 3x3 solution in the local rest frame
+                                                  # 2: Eigen self-adjoint 3x3 solver in the local rest frame
+    'causality_root_tolerance': 1e-6,             # tolerance on beta for the nonlinear sufficient causality conditions
+    'causality_diagnostics_stride': 1,            # record the causality reduction factors of every n-th cell
+                                                  # in x, y, and eta to {necessary,sufficient}_causality_diagnostics.dat
+                                                  # (0: no output, see utilities/read_causality_diagnostics.py)
+    'causality_prescreen': 1,                     # skip the causality constraints of the cells whose |Lambda|/(e+P)
+                                                  # and |Pi|/(e+P) are below the safety bound of their cs^2
+    'causality_statistics': 0,                    # write the reduction factor vs eps and tau histograms and the fractions
+                                                  # of violating cells to {necessary,sufficient}_causality_statistics.dat
+                                                  # and {necessary,sufficient}_causality_factor_eps.dat
+    'causality_sample_size': 0,                   # records per time step of the reservoir sample of causality_statistics
+                                                  # in {necessary,sufficient}_causality_sample.dat (diagnostics format)
 
     'output_hydro_debug_info': 1,                 # flag to output additional evolution information for debuging
-    'output_evolution_data': 0,                   # flag to output evolution history to file
+    'output_evolution_data': 0,                   # flag to output evolution history to file (1-6), 5: chunked columnar file, 6: sparse file of the cells above output_evolution_e_cut
     'output_movie_flag': 0,                       # flag to output evolution file for making movie
+    'output_movie_reductions': 0,                 # 2D frames of the reduced movie, 1: mid-rapidity slice, 2: eta projection, 3: both
+    'output_movie_block_size': 1,                 # number of transverse cells averaged to a point of the reduced movie in x and y
+    'debug_snapshot_ring': 0,                     # number of the last time steps kept in memory and written to debug_snapshots.dat on an error
     'output_evolution_T_cut': 0.145,              # minimum temperature for outputing fluid cells [GeV]
+    'output_evolution_e_cut': 0.15,               # minimum energy density for outputing fluid cells [GeV/fm^3] (output_evolution_data = 2, 3, 6)
     'output_hydro_params_header' : 1,             # flag to output hydro evolution information header
     'outputBinaryEvolution': 1,                   # flag to output evolution history in binary format
     'output_evolution_every_N_timesteps' : 1,     # number of points to skip in tau direction for hydro evolution
+    'output_observables_every_N_timesteps' : 1,   # number of time steps between the momentum anisotropy, conservation law and vorticity outputs
     'output_evolution_every_N_x' : 1,             # number of points to skip in x direction for hydro evolution
     'output_evolution_every_N_y' : 1,             # number of points to skip in y direction for hydro evolution
     'output_evolution_every_N_eta' : 1,           # number of points to skip in eta direction for hydro evolution
+    'output_evolution_buffers' : 2,               # number of snapshot buffers of the evolution output writer thread (0: write on the main thread)
+    'output_evolution_codec' : 1,                 # codec of the chunked evolution file (output_evolution_data = 5), 0: raw, 1: zlib
+    'store_hydro_info_memory_slices' : 0,         # number of the last tau slices of the in-memory history kept in memory, the older ones are spilled to a scratch file (0: keep all)
+    'store_hydro_info_cache_slices' : 4,          # number of the spilled tau slices cached in memory
+    'store_hydro_info_spill_directory' : '.',     # directory of the scratch file of the spilled tau slices
     
     'Do_FreezeOut_Yes_1_No_0': 1,                 # flag to find freeze-out surface
     'freeze_out_method': 4,                       # method for hyper-surface finder
@@ -142,6 +257,28 @@ hydro_dict = {
                                     # cells outside the freeze-out surface
                                     # at the first time step
     'freeze_surface_in_binary': 0,   # flag to output surface file in binary format
+    'freeze_surface_single_file': 0,  # 1: keep the binary surface in memory
+                                      # and write one file with a header
+                                      # per isotherm after the evolution
+    'freeze_out_pipeline': 0,   # n > 0: n threads find the surface of a
+                                # freeze-out step while the evolution
+                                # advances the next steps (in addition to
+                                # the OMP_NUM_THREADS of the evolution)
+    'cooper_frye_streaming': 0, # n > 0: n threads compute the thermal
+                                # spectra from the surface of every
+                                # freeze-out step while the hydro runs
+                                # (mode 1, freeze_surface_single_file = 1)
+    'surface_coarsening_factor': 0,     # n > 0: merge the surface elements
+                                        # with similar fields in blocks of
+                                        # n freeze-out cells per direction
+                                        # before Cooper-Frye (0: off)
+    'surface_coarsening_u_tolerance': 0.02,     # largest |du^mu| of merged elements
+    'surface_coarsening_T_tolerance': 0.005,    # largest |dT|/T of merged elements
+    'surface_coarsening_muB_tolerance': 0.01,   # largest |dmu_B|/T of merged elements
+    'surface_coarsening_W_tolerance': 0.02,     # largest |dW^{mu nu}|/(e + P) of merged elements
+    'surface_coarsening_check': 0,      # 1: report the deviation of the
+                                        # spectra of the first species
+                                        # from the ones of the full surface
 
     'average_surface_over_this_many_time_steps': 5,   # the step skipped in the tau direction
     'freeze_Ncell_x_step': 1,              # the step skipped in x direction
@@ -167,6 +304,11 @@ freeze_out_dict = {
                                           # current maximum = 320
     'particle_spectrum_to_compute': 0,            # 0: Do all up to number_of_particles_to_include
                                           # any natural number: Do the particle with this (internal) ID
+    'output_spectra_files': 0,                    # 1: write yptphiSpectra.dat and FyptphiSpectra.dat in mode 1 too
+                                                  # (the other modes always write them for the next run)
+    'number_of_sampled_events': 0,                # the number of events of hadrons sampled from the surface to sampled_particles.dat
+                                                  # (OSCAR2013 format, in modes 1 and 3), 0: no sampling
+    'hadron_sampler_seed': 1,                     # the seed of the sampled events (the same for any number of threads)
     'pseudofreeze': 1,                            # calculated particle spectra in equally-spaced pseudorapidity
     'max_pseudorapidity': 2.5,                    # particle spectra calculated from (0, max_pseudorapidity)
     'pseudo_steps': 11,                            # number of lattice points along pseudo-rapidity
@@ -0,0 +1,54 @@
+#!/usr/bin/env python
+"""
+    This script reads in the binary causality diagnostics file written by
+    MUSIC ({necessary,sufficient}_causality_diagnostics.dat) and prints a
+    short summary. The records are returned as a numpy structured array with
+    the fields factor, epsilon [1/fm^4], tau [fm], ix, iy, ieta, violated.
+"""
+
+import sys
+import numpy as np
+
+CONDITION_NAMES = ["n1", "n3", "n5", "n6", "s1", "s2", "s6",
+                   "Suff5", "Suff7", "Suff8"]
+
+RECORD_DTYPE = np.dtype([('factor', '<f4'), ('epsilon', '<f4'),
+                         ('tau', '<f4'), ('ix', '<i2'), ('iy', '<i2'),
+                         ('ieta', '<i2'), ('violated', '<u2')])
+
+
+def read_causality_diagnostics(filename):
+    """returns (causality_method, records)"""
+    with open(filename, 'rb') as f:
+        magic = f.read(8)
+        if magic != b"MUSICCD1":
+            raise ValueError("{} is not a MUSIC causality diagnostics file"
+                             .format(filename))
+        causality_method, record_size = np.fromfile(f, dtype='<i4', count=2)
+        if record_size != RECORD_DTYPE.itemsize:
+            raise ValueError("unexpected record size {}".format(record_size))
+        records = np.fromfile(f, dtype=RECORD_DTYPE)
+    return causality_method, records
+
+
+def main():
+    if len(sys.argv) < 2:
+        print("Usage: {} causality_diagnostics.dat".format(sys.argv[0]))
+        exit(0)
+    causality_method, records = read_causality_diagnostics(sys.argv[1])
+    print("causality_method = {}, number of records = {}".format(
+          causality_method, len(records)))
+    if len(records) == 0:
+        return
+    reduced = records['factor'] < 1.
+    print("fraction of reduced cells = {:.5e}".format(np.mean(reduced)))
+    print("minimum reduction factor = {:.5e}".format(
+          records['factor'].min()))
+    for i, name in enumerate(CONDITION_NAMES):
+        n_violated = np.count_nonzero(records['violated'] & (1 << i))
+        if n_violated > 0:
+            print("{:>6s} violated in {} records".format(name, n_violated))
+
+
+if __name__ == "__main__":
+    main()
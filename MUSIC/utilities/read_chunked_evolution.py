@@ -0,0 +1,127 @@
+#!/usr/bin/env python
+"""
+    This script reads in the chunked evolution file written by MUSIC with
+    output_evolution_data = 5 (evolution_xyeta_chunked.dat). Only the header
+    and the index table are read when the file is opened, read_field()
+    seeks to the chunk of one field at one tau and returns it as a numpy
+    array of shape (neta, ny, nx).
+"""
+
+import sys
+import zlib
+import numpy as np
+
+GRID_DTYPE = np.dtype([('nx', '<i4'), ('ny', '<i4'), ('neta', '<i4'),
+                       ('reserved', '<i4'), ('tau0', '<f8'), ('dtau', '<f8'),
+                       ('dx', '<f8'), ('dy', '<f8'), ('deta', '<f8'),
+                       ('x_min', '<f8'), ('y_min', '<f8'),
+                       ('eta_min', '<f8')])
+
+CHUNK_DTYPE = np.dtype([('tag', 'S4'), ('field', '<i4'), ('tau', '<f8'),
+                        ('itau', '<i4'), ('codec', '<i4'),
+                        ('stored_size', '<i8')])
+
+INDEX_DTYPE = np.dtype([('tau', '<f8'), ('itau', '<i4'), ('field', '<i4'),
+                        ('offset', '<i8')])
+
+CODEC_RAW, CODEC_ZLIB = 0, 1
+
+
+class ChunkedEvolutionFile(object):
+    def __init__(self, filename):
+        self.file = open(filename, 'rb')
+        if self.file.read(8) != b"MUSICEVC":
+            raise ValueError("{} is not a MUSIC chunked evolution file"
+                             .format(filename))
+        self.version, n_fields = np.fromfile(self.file, dtype='<i4', count=2)
+        self.grid = np.fromfile(self.file, dtype=GRID_DTYPE, count=1)[0]
+        names_length = np.fromfile(self.file, dtype='<i4', count=1)[0]
+        names = self.file.read(names_length).rstrip(b'\0').decode()
+        self.field_names = names.split(',')[:n_fields]
+        self.n_points = int(self.grid['nx']*self.grid['ny']
+                            *self.grid['neta'])
+        self.chunks = {}
+        self.tau_list = {}
+        data_offset = self.file.tell()
+        if not self._read_index_table():
+            self._scan_chunks(data_offset)
+
+    def _read_index_table(self):
+        self.file.seek(0, 2)
+        file_size = self.file.tell()
+        if file_size < 24:
+            return False
+        self.file.seek(file_size - 24)
+        n_chunks, index_offset = np.fromfile(self.file, dtype='<i8', count=2)
+        if self.file.read(8) != b"MUSICIDX":
+            return False
+        self.file.seek(index_offset)
+        for entry in np.fromfile(self.file, dtype=INDEX_DTYPE,
+                                 count=n_chunks):
+            self._add_chunk(entry['tau'], entry['itau'], entry['field'],
+                            entry['offset'])
+        return True
+
+    def _scan_chunks(self, offset):
+        """indexes a file without the index table from the chunk headers"""
+        self.file.seek(0, 2)
+        file_size = self.file.tell()
+        while offset + CHUNK_DTYPE.itemsize <= file_size:
+            self.file.seek(offset)
+            header = np.fromfile(self.file, dtype=CHUNK_DTYPE, count=1)[0]
+            if header['tag'] != b"CHNK":
+                break
+            next_offset = (offset + CHUNK_DTYPE.itemsize
+                           + header['stored_size'])
+            if next_offset > file_size:
+                break
+            self._add_chunk(header['tau'], header['itau'], header['field'],
+                            offset)
+            offset = next_offset
+
+    def _add_chunk(self, tau, itau, field, offset):
+        self.tau_list[int(itau)] = float(tau)
+        self.chunks[(int(itau), int(field))] = int(offset)
+
+    def get_tau_list(self):
+        return [self.tau_list[i] for i in sorted(self.tau_list)]
+
+    def read_field(self, itau, field):
+        """returns the field (index or name) at the tau index itau"""
+        if not isinstance(field, int):
+            field = self.field_names.index(field)
+        self.file.seek(self.chunks[(itau, field)])
+        header = np.fromfile(self.file, dtype=CHUNK_DTYPE, count=1)[0]
+        stored = self.file.read(header['stored_size'])
+        if header['codec'] == CODEC_RAW:
+            data = np.frombuffer(stored, dtype='<f4')
+        elif header['codec'] == CODEC_ZLIB:
+            shuffled = np.frombuffer(zlib.decompress(stored), dtype=np.uint8)
+            data = (shuffled.reshape(4, self.n_points).T.copy()
+                    .view('<f4').reshape(-1))
+        else:
+            raise ValueError("unknown codec {}".format(header['codec']))
+        return data.reshape(self.grid['neta'], self.grid['ny'],
+                            self.grid['nx'])
+
+
+def main():
+    if len(sys.argv) < 2:
+        print("Usage: {} evolution_xyeta_chunked.dat".format(sys.argv[0]))
+        exit(0)
+    evo = ChunkedEvolutionFile(sys.argv[1])
+    grid = evo.grid
+    print("grid: nx = {}, ny = {}, neta = {}".format(
+          grid['nx'], grid['ny'], grid['neta']))
+    print("fields: {}".format(", ".join(evo.field_names)))
+    tau_list = evo.get_tau_list()
+    print("number of tau = {}, tau = {} - {} fm".format(
+          len(tau_list), tau_list[0], tau_list[-1]))
+    for field in evo.field_names:
+        data = evo.read_field(len(tau_list) - 1, field)
+        print("{:>5s} at the last tau: min = {:.6e}, max = {:.6e}".format(
+              field, data.min(), data.max()))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,88 @@
+#!/usr/bin/env python
+"""
+    This script reads in the sparse evolution file written by MUSIC with
+    output_evolution_data = 6 (evolution_xyeta_sparse.dat). Each frame
+    holds the output points of one tau above output_evolution_e_cut and
+    their fields, read_frames() returns them one after the other.
+"""
+
+import sys
+import numpy as np
+
+GRID_DTYPE = np.dtype([('nx', '<i4'), ('ny', '<i4'), ('neta', '<i4'),
+                       ('reserved', '<i4'), ('tau0', '<f8'), ('dtau', '<f8'),
+                       ('dx', '<f8'), ('dy', '<f8'), ('deta', '<f8'),
+                       ('x_min', '<f8'), ('y_min', '<f8'),
+                       ('eta_min', '<f8')])
+
+FRAME_DTYPE = np.dtype([('tag', 'S4'), ('selection', '<i4'), ('tau', '<f8'),
+                        ('itau', '<i4'), ('n_points', '<i4'),
+                        ('data_size', '<i8')])
+
+SELECTION_BITMASK, SELECTION_INDEX_LIST = 0, 1
+
+
+class SparseEvolutionFile(object):
+    def __init__(self, filename):
+        self.file = open(filename, 'rb')
+        if self.file.read(8) != b"MUSICEVS":
+            raise ValueError("{} is not a MUSIC sparse evolution file"
+                             .format(filename))
+        self.version, n_fields = np.fromfile(self.file, dtype='<i4', count=2)
+        self.grid = np.fromfile(self.file, dtype=GRID_DTYPE, count=1)[0]
+        names_length = np.fromfile(self.file, dtype='<i4', count=1)[0]
+        names = self.file.read(names_length).rstrip(b'\0').decode()
+        self.field_names = names.split(',')[:n_fields]
+        self.n_points = int(self.grid['nx']*self.grid['ny']
+                            *self.grid['neta'])
+
+    def read_frames(self):
+        """yields tau, the output points (ix innermost, ieta outermost)
+           and the dict of the fields of the points for every frame"""
+        while True:
+            header = np.fromfile(self.file, dtype=FRAME_DTYPE, count=1)
+            if len(header) == 0 or header[0]['tag'] != b"FRME":
+                return
+            header = header[0]
+            n_points = int(header['n_points'])
+            if header['selection'] == SELECTION_BITMASK:
+                words = np.fromfile(self.file, dtype='<u8',
+                                    count=(self.n_points + 63)//64)
+                bits = np.unpackbits(words.view(np.uint8),
+                                     bitorder='little')
+                points = np.nonzero(bits[:self.n_points])[0]
+            else:
+                points = np.fromfile(self.file, dtype='<u4', count=n_points)
+            data = np.fromfile(self.file, dtype='<f4',
+                               count=n_points*len(self.field_names))
+            if len(points) != n_points or data.size != n_points*len(
+                                                        self.field_names):
+                return   # a frame cut off by the end of file
+            fields = dict(zip(self.field_names,
+                              data.reshape(len(self.field_names),
+                                           n_points)))
+            yield float(header['tau']), points, fields
+
+    def get_indices(self, points):
+        """returns the ix, iy, ieta of the output points"""
+        nx, ny = int(self.grid['nx']), int(self.grid['ny'])
+        return points % nx, (points//nx) % ny, points//(nx*ny)
+
+
+def main():
+    if len(sys.argv) < 2:
+        print("Usage: {} evolution_xyeta_sparse.dat".format(sys.argv[0]))
+        exit(0)
+    evo = SparseEvolutionFile(sys.argv[1])
+    grid = evo.grid
+    print("grid: nx = {}, ny = {}, neta = {}".format(
+          grid['nx'], grid['ny'], grid['neta']))
+    print("fields: {}".format(", ".join(evo.field_names)))
+    for tau, points, fields in evo.read_frames():
+        print("tau = {:.4f} fm: {} cells, T max = {:.4f} GeV".format(
+              tau, len(points),
+              fields['T'].max() if len(points) > 0 else 0.))
+
+
+if __name__ == "__main__":
+    main()